@@ -17,6 +17,9 @@
 #include <match_scverify.h>
 #include <testbench/nvhls_rand.h>
 
+#include <deque>
+#include <mem_model.h>
+
 #include "MemModel.h"
 #include "mem_config.h"
 
@@ -26,6 +29,84 @@
 
 MemWord_t wideRand ();
 
+// Runs NUM_ITER cycles of random traffic on every port of a mem_model
+// configuration, checks the read data against a reference array and prints
+// the achieved accesses per cycle and bank conflicts of the configuration.
+template <typename Cfg>
+bool ExploreConfig(const char* name) {
+  typedef mem_model<MemWord_t, Cfg> Mem;
+  typedef typename Mem::Addr Addr;
+  static const int NR = Cfg::numReadPorts;
+  static const int NW = Cfg::numWritePorts;
+
+  Mem mem;
+  mem.banks.clear();
+  std::vector<MemWord_t> ref(Cfg::numEntries, 0);
+  std::deque<MemWord_t> expected[NR];
+  bool rd_valid[NR], wr_valid[NW], rd_grant[NR], wr_grant[NW], rsp_valid[NR];
+  Addr rd_addr[NR], wr_addr[NW];
+  MemWord_t wr_data[NW], rsp_data[NR];
+  for (int p = 0; p < NR; p++) rd_valid[p] = false;
+  for (int p = 0; p < NW; p++) wr_valid[p] = false;
+
+  bool ok = true;
+  bool busy = true;
+  for (int cycle = 0; busy && cycle < 4 * NUM_ITER; cycle++) {
+    bool issue = cycle < NUM_ITER;
+    // Requests that were not granted are presented again
+    for (int p = 0; p < NR; p++) {
+      if (!rd_valid[p]) {
+        rd_valid[p] = issue;
+        rd_addr[p] = rand() % Cfg::numEntries;
+      }
+    }
+    for (int p = 0; p < NW; p++) {
+      if (!wr_valid[p]) {
+        wr_valid[p] = issue;
+        wr_addr[p] = rand() % Cfg::numEntries;
+        wr_data[p] = wideRand();
+      }
+    }
+    mem.run(rd_valid, rd_addr, wr_valid, wr_addr, wr_data, rd_grant, wr_grant, rsp_valid, rsp_data);
+
+    for (int p = 0; p < NR; p++) {
+      if (rd_grant[p]) {
+        expected[p].push_back(ref[rd_addr[p].to_uint64()]);
+        rd_valid[p] = false;
+      }
+      if (rsp_valid[p]) {
+        if (expected[p].empty() || !(rsp_data[p] == expected[p].front())) {
+          DCOUT(name << ": unexpected read data on port " << p << endl);
+          ok = false;
+        } else {
+          expected[p].pop_front();
+        }
+      }
+    }
+    for (int p = 0; p < NW; p++) {
+      if (wr_grant[p]) {
+        ref[wr_addr[p].to_uint64()] = wr_data[p];
+        wr_valid[p] = false;
+      }
+    }
+
+    busy = issue;
+    for (int p = 0; p < NR; p++) busy = busy || rd_valid[p] || !expected[p].empty();
+    for (int p = 0; p < NW; p++) busy = busy || wr_valid[p];
+  }
+  ok = ok && !busy;
+
+  uint64 accesses = mem.stats.GetStat("reads") + mem.stats.GetStat("writes");
+  cout << "MEMCFG " << name << " banks=" << Cfg::numBanks << " read_ports=" << NR
+       << " write_ports=" << NW << " read_latency=" << Cfg::readLatency
+       << " dual_port=" << Cfg::dualPortBanks << dec << " accesses_per_cycle="
+       << static_cast<double>(accesses) / mem.stats.GetStat("cycles")
+       << " read_conflicts=" << mem.stats.GetStat("read_conflicts")
+       << " write_conflicts=" << mem.stats.GetStat("write_conflicts")
+       << (ok ? " PASS" : " FAIL") << endl;
+  return ok;
+}
+
 CCS_MAIN(int argc, char *argv[]) { 
 
   nvhls::set_random_seed();
@@ -67,6 +148,14 @@ CCS_MAIN(int argc, char *argv[]) {
     DCOUT("Memory Op: Read, Address: "<< addr.to_uint64() << " Data: "<< read_data.to_uint64() << " " << ref[addr] << endl);
     assert(ref[addr]==read_data);
   }
+
+  // Design space points of the multi-port, multi-bank model
+  bool ok = true;
+  ok &= ExploreConfig<mem_model_cfg<NUM_ENTRIES, 1, 1, 1, 0, true> >("1bank_1r1w_lat0");
+  ok &= ExploreConfig<mem_model_cfg<NUM_ENTRIES, 4, 2, 1, 1> >("4bank_2r1w_lat1_1rw");
+  ok &= ExploreConfig<mem_model_cfg<NUM_ENTRIES, 4, 2, 2, 2, true> >("4bank_2r2w_lat2_1r1w");
+  ok &= ExploreConfig<mem_model_cfg<NUM_ENTRIES, 8, 4, 2, 3, true> >("8bank_4r2w_lat3_1r1w");
+  assert(ok);
   CCS_RETURN(0) ;
 
 }
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_int.h>
+#include <Arbiter.h>
+#include <testbench/SimBench.h>
+#include <testbench/nvhls_rand.h>
+
+// Each cycle the DUT refills its per-input request registers, grants one of
+// the valid requests round-robin and forwards the winner.
+SC_MODULE(ArbiterBench) {
+  enum { kNumInputs = 8 };
+  typedef NVUINT32 Word_t;
+  typedef Arbiter<kNumInputs>::Mask Mask;
+
+  sc_in<bool> clk;
+  sc_in<bool> rst;
+  Connections::In<Word_t> in[kNumInputs];
+  Connections::Out<Word_t> out;
+
+  Arbiter<kNumInputs> arb;
+
+  SC_CTOR(ArbiterBench) : clk("clk"), rst("rst"), out("out") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void run() {
+    for (int i = 0; i < kNumInputs; i++) {
+      in[i].Reset();
+    }
+    out.Reset();
+    Word_t req[kNumInputs];
+    Mask valid = 0;
+    while (1) {
+      wait();
+      for (int i = 0; i < kNumInputs; i++) {
+        if (!valid[i] && in[i].PopNB(req[i])) {
+          valid[i] = 1;
+        }
+      }
+      if (valid != 0) {
+        Mask grant = arb.pick(valid);
+        for (int i = 0; i < kNumInputs; i++) {
+          if (grant[i] && out.PushNB(req[i])) {
+            valid[i] = 0;
+          }
+        }
+      }
+    }
+  }
+};
+
+static NVUINT32 gen_word(unsigned long i) { return i; }
+
+SC_MODULE(testbench) {
+  typedef ArbiterBench::Word_t Word_t;
+
+  sc_clock clk;
+  sc_signal<bool> rst;
+  SimBench bench;
+  ArbiterBench dut;
+  BenchSource<Word_t>* src[ArbiterBench::kNumInputs];
+  BenchSink<Word_t> sink;
+  Connections::Combinational<Word_t> in_chan[ArbiterBench::kNumInputs];
+  Connections::Combinational<Word_t> out_chan;
+
+  SC_CTOR(testbench)
+      : clk("clk", 1.0, SC_NS, 0.5, 0, SC_NS, true),
+        rst("rst"),
+        bench("ArbiterBench"),
+        dut("dut"),
+        sink("sink", bench) {
+    Connections::set_sim_clk(&clk);
+    dut.clk(clk);
+    dut.rst(rst);
+    for (int i = 0; i < ArbiterBench::kNumInputs; i++) {
+      src[i] = new BenchSource<Word_t>(sc_gen_unique_name("src"), gen_word);
+      src[i]->clk(clk);
+      src[i]->rst(rst);
+      src[i]->out(in_chan[i]);
+      dut.in[i](in_chan[i]);
+    }
+    sink.clk(clk);
+    sink.rst(rst);
+    sink.in(out_chan);
+    dut.out(out_chan);
+    SC_THREAD(run);
+  }
+
+  void run() {
+    rst = 0;
+    wait(2, SC_NS);
+    rst = 1;
+    wait(10, SC_NS);
+    bench.Start();
+    wait(SimBench::NumCycles(200000), SC_NS);
+    bench.Stop();
+    bench.Report();
+    if (bench.Msgs() == 0)
+      SC_REPORT_ERROR("testbench", "No requests were granted");
+    sc_stop();
+  }
+};
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  testbench tb("tb");
+  sc_report_handler::set_actions(SC_ERROR, SC_DISPLAY);
+  sc_start();
+  bool rc = (sc_report_handler::get_count(SC_ERROR) > 0);
+  if (rc)
+    DCOUT("TESTBENCH FAIL" << endl);
+  else
+    DCOUT("TESTBENCH PASS" << endl);
+  return rc;
+};
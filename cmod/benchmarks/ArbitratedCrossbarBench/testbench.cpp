@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_int.h>
+#include <arbitrated_crossbar.h>
+#include <testbench/SimBench.h>
+#include <testbench/nvhls_rand.h>
+
+// Each input message carries its destination in the low bits.  The DUT feeds
+// the inputs to an ArbitratedCrossbar every cycle and drains the output queues
+// whose message was accepted downstream.
+SC_MODULE(ArbitratedCrossbarBench) {
+  enum { kNumInputs = 4, kNumOutputs = 8, kLenInputBuffer = 4, kLenOutputBuffer = 2 };
+  typedef NVUINT32 Word_t;
+  typedef ArbitratedCrossbar<Word_t, kNumInputs, kNumOutputs, kLenInputBuffer, kLenOutputBuffer> Xbar;
+  typedef Xbar::InputIdx InputIdx;
+  typedef Xbar::OutputIdx OutputIdx;
+
+  sc_in<bool> clk;
+  sc_in<bool> rst;
+  Connections::In<Word_t> in[kNumInputs];
+  Connections::Out<Word_t> out[kNumOutputs];
+
+  Xbar xbar;
+
+  SC_CTOR(ArbitratedCrossbarBench) : clk("clk"), rst("rst") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void run() {
+    xbar.reset();
+    for (int i = 0; i < kNumInputs; i++) {
+      in[i].Reset();
+    }
+    for (int i = 0; i < kNumOutputs; i++) {
+      out[i].Reset();
+    }
+    Word_t data_in[kNumInputs];
+    OutputIdx dest_in[kNumInputs];
+    bool valid_in[kNumInputs];
+    for (int i = 0; i < kNumInputs; i++) {
+      valid_in[i] = false;
+    }
+    while (1) {
+      wait();
+      for (int i = 0; i < kNumInputs; i++) {
+        if (!valid_in[i] && in[i].PopNB(data_in[i])) {
+          dest_in[i] = nvhls::get_slc<Xbar::log2_outputs>(data_in[i], 0);
+          valid_in[i] = true;
+        }
+      }
+      Word_t data_out[kNumOutputs];
+      bool valid_out[kNumOutputs];
+      bool ready[kNumInputs];
+      InputIdx source[kNumOutputs];
+      xbar.run(data_in, dest_in, valid_in, data_out, valid_out, ready, source);
+      for (int i = 0; i < kNumInputs; i++) {
+        if (ready[i]) {
+          valid_in[i] = false;
+        }
+      }
+      for (int i = 0; i < kNumOutputs; i++) {
+        if (valid_out[i]) {
+          valid_out[i] = out[i].PushNB(data_out[i]);
+        }
+      }
+      xbar.pop_all_lanes(valid_out);
+    }
+  }
+};
+
+// Spreads the destinations of consecutive messages over all outputs
+static NVUINT32 gen_word(unsigned long i) { return (i * 2654435761UL) >> 8; }
+
+SC_MODULE(testbench) {
+  typedef ArbitratedCrossbarBench::Word_t Word_t;
+  static const int kNumInputs = ArbitratedCrossbarBench::kNumInputs;
+  static const int kNumOutputs = ArbitratedCrossbarBench::kNumOutputs;
+
+  sc_clock clk;
+  sc_signal<bool> rst;
+  SimBench bench;
+  ArbitratedCrossbarBench dut;
+  BenchSource<Word_t>* src[kNumInputs];
+  BenchSink<Word_t>* sink[kNumOutputs];
+  Connections::Combinational<Word_t> in_chan[kNumInputs];
+  Connections::Combinational<Word_t> out_chan[kNumOutputs];
+
+  SC_CTOR(testbench)
+      : clk("clk", 1.0, SC_NS, 0.5, 0, SC_NS, true),
+        rst("rst"),
+        bench("ArbitratedCrossbarBench"),
+        dut("dut") {
+    Connections::set_sim_clk(&clk);
+    dut.clk(clk);
+    dut.rst(rst);
+    for (int i = 0; i < kNumInputs; i++) {
+      src[i] = new BenchSource<Word_t>(sc_gen_unique_name("src"), gen_word);
+      src[i]->clk(clk);
+      src[i]->rst(rst);
+      src[i]->out(in_chan[i]);
+      dut.in[i](in_chan[i]);
+    }
+    for (int i = 0; i < kNumOutputs; i++) {
+      sink[i] = new BenchSink<Word_t>(sc_gen_unique_name("sink"), bench);
+      sink[i]->clk(clk);
+      sink[i]->rst(rst);
+      sink[i]->in(out_chan[i]);
+      dut.out[i](out_chan[i]);
+    }
+    SC_THREAD(run);
+  }
+
+  void run() {
+    rst = 0;
+    wait(2, SC_NS);
+    rst = 1;
+    wait(10, SC_NS);
+    bench.Start();
+    wait(SimBench::NumCycles(200000), SC_NS);
+    bench.Stop();
+    bench.Report();
+    if (bench.Msgs() == 0)
+      SC_REPORT_ERROR("testbench", "No messages got through the crossbar");
+    sc_stop();
+  }
+};
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  testbench tb("tb");
+  sc_report_handler::set_actions(SC_ERROR, SC_DISPLAY);
+  sc_start();
+  bool rc = (sc_report_handler::get_count(SC_ERROR) > 0);
+  if (rc)
+    DCOUT("TESTBENCH FAIL" << endl);
+  else
+    DCOUT("TESTBENCH PASS" << endl);
+  return rc;
+};
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_int.h>
+#include <ArbitratedScratchpad.h>
+#include <testbench/SimBench.h>
+#include <testbench/nvhls_rand.h>
+
+// The DUT presents one client request (one lane per scratchpad input) to
+// load_store() every cycle, retires the lanes that were accepted and forwards
+// load responses.  A response that is not accepted downstream stalls the
+// scratchpad until it is.
+SC_MODULE(ArbitratedScratchpadBench) {
+  enum { kNumBanks = 4, kNumInputs = 8, kBankEntries = 256, kInputQueueLen = 4 };
+  typedef NVUINT32 Word_t;
+  typedef ArbitratedScratchpad<Word_t, kNumBanks * kBankEntries, kNumInputs, kNumBanks, kInputQueueLen> Scratchpad;
+  typedef Scratchpad::req_t Req_t;
+  typedef Scratchpad::rsp_t Rsp_t;
+
+  sc_in<bool> clk;
+  sc_in<bool> rst;
+  Connections::In<Req_t> in;
+  Connections::Out<Rsp_t> out;
+
+  Scratchpad scratchpad;
+
+  SC_CTOR(ArbitratedScratchpadBench) : clk("clk"), rst("rst"), in("in"), out("out") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  static bool AnyValid(const bool valids[kNumInputs]) {
+    bool any = false;
+    for (int i = 0; i < kNumInputs; i++) {
+      any |= valids[i];
+    }
+    return any;
+  }
+
+  void run() {
+    scratchpad.reset();
+    in.Reset();
+    out.Reset();
+    Req_t req;
+    Rsp_t rsp;
+    bool req_valid = false;
+    bool rsp_valid = false;
+    while (1) {
+      wait();
+      if (rsp_valid && out.PushNB(rsp)) {
+        rsp_valid = false;
+      }
+      if (rsp_valid) {
+        continue;
+      }
+      if (!req_valid && in.PopNB(req)) {
+        req_valid = true;
+      }
+      if (!req_valid) {
+        for (int i = 0; i < kNumInputs; i++) {
+          req.valids[i] = false;
+        }
+      }
+      bool ready[kNumInputs];
+      scratchpad.load_store(req, rsp, ready);
+      for (int i = 0; i < kNumInputs; i++) {
+        if (ready[i]) {
+          req.valids[i] = false;
+        }
+      }
+      req_valid = AnyValid(req.valids);
+      rsp_valid = AnyValid(rsp.valids);
+    }
+  }
+};
+
+// Alternates stores and loads of all lanes to scattered addresses
+static ArbitratedScratchpadBench::Req_t gen_req(unsigned long i) {
+  ArbitratedScratchpadBench::Req_t req;
+  req.type.val = (i & 1) ? CLITYPE_T::LOAD : CLITYPE_T::STORE;
+  for (int j = 0; j < ArbitratedScratchpadBench::kNumInputs; j++) {
+    req.valids[j] = true;
+    req.addr[j] = ((i >> 1) * ArbitratedScratchpadBench::kNumInputs + j) * 2654435761UL >> 12;
+    req.data[j] = i + j;
+  }
+  return req;
+}
+
+SC_MODULE(testbench) {
+  typedef ArbitratedScratchpadBench::Req_t Req_t;
+  typedef ArbitratedScratchpadBench::Rsp_t Rsp_t;
+
+  sc_clock clk;
+  sc_signal<bool> rst;
+  SimBench bench;
+  ArbitratedScratchpadBench dut;
+  BenchSource<Req_t> src;
+  BenchSink<Rsp_t> sink;
+  Connections::Combinational<Req_t> in_chan;
+  Connections::Combinational<Rsp_t> out_chan;
+
+  SC_CTOR(testbench)
+      : clk("clk", 1.0, SC_NS, 0.5, 0, SC_NS, true),
+        rst("rst"),
+        bench("ArbitratedScratchpadBench"),
+        dut("dut"),
+        src("src", gen_req),
+        sink("sink", bench) {
+    Connections::set_sim_clk(&clk);
+    dut.clk(clk);
+    dut.rst(rst);
+    src.clk(clk);
+    src.rst(rst);
+    src.out(in_chan);
+    dut.in(in_chan);
+    sink.clk(clk);
+    sink.rst(rst);
+    sink.in(out_chan);
+    dut.out(out_chan);
+    SC_THREAD(run);
+  }
+
+  void run() {
+    rst = 0;
+    wait(2, SC_NS);
+    rst = 1;
+    wait(10, SC_NS);
+    bench.Start();
+    wait(SimBench::NumCycles(100000), SC_NS);
+    bench.Stop();
+    bench.Report();
+    if (bench.Msgs() == 0)
+      SC_REPORT_ERROR("testbench", "No load responses were received");
+    sc_stop();
+  }
+};
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  testbench tb("tb");
+  sc_report_handler::set_actions(SC_ERROR, SC_DISPLAY);
+  sc_start();
+  bool rc = (sc_report_handler::get_count(SC_ERROR) > 0);
+  if (rc)
+    DCOUT("TESTBENCH FAIL" << endl);
+  else
+    DCOUT("TESTBENCH PASS" << endl);
+  return rc;
+};
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+
+#include <axi/axi4.h>
+#include <axi/testbench/TrafficGen.h>
+#include <axi/AxiArbiter.h>
+#include <axi/AxiSlaveToMem.h>
+#include <testbench/SimBench.h>
+#include <testbench/nvhls_rand.h>
+
+// Four TrafficGens inject random reads and writes at full rate into an
+// AxiArbiter in front of an AxiSlaveToMem.  Messages are completed AXI
+// transactions.
+
+static const int kMemBytes = 1 << 16;
+
+typedef axi::cfg::no_wstrb BenchAxiCfg;
+
+template <int seed_>
+struct BenchTrafficCfg : public trafficGenCfg {
+  enum {
+    numTransactions = 200000,
+    readPercent = 50,
+    injectionRate = 1000,
+    minBeats = 1,
+    maxBeats = 4,
+    addrPattern = AxiTrafficRandom,
+    stride = 256,
+    hotspotPercent = 0,
+    maxOutstanding = 8,
+    histBinCycles = 8,
+    histBins = 32,
+    seed = seed_,
+  };
+  static const uint64_t addrBoundLower = 0;
+  static const uint64_t addrBoundUpper = kMemBytes - 1;
+};
+
+SC_MODULE(testbench) {
+  typedef axi::axi4<BenchAxiCfg> axi_;
+  enum { numMasters = 4, maxInFlight = 8 };
+
+  sc_clock clk;
+  sc_signal<bool> reset_bar;
+  SimBench bench;
+
+  TrafficGen<BenchAxiCfg, BenchTrafficCfg<0> > gen0;
+  TrafficGen<BenchAxiCfg, BenchTrafficCfg<1> > gen1;
+  TrafficGen<BenchAxiCfg, BenchTrafficCfg<2> > gen2;
+  TrafficGen<BenchAxiCfg, BenchTrafficCfg<3> > gen3;
+  AxiArbiter<BenchAxiCfg, numMasters, maxInFlight> axi_arbiter;
+  AxiSlaveToMem<BenchAxiCfg, kMemBytes> slave;
+
+  sc_signal<bool> done[numMasters];
+  nvhls::nv_array<typename axi_::read::template chan<>, numMasters> axi_read_m;
+  nvhls::nv_array<typename axi_::write::template chan<>, numMasters> axi_write_m;
+  typename axi_::read::template chan<> axi_read_s;
+  typename axi_::write::template chan<> axi_write_s;
+
+  SC_CTOR(testbench)
+      : clk("clk", 1.0, SC_NS, 0.5, 0, SC_NS, true),
+        reset_bar("reset_bar"),
+        bench("AxiArbiterBench"),
+        gen0("gen0"),
+        gen1("gen1"),
+        gen2("gen2"),
+        gen3("gen3"),
+        axi_arbiter("axi_arbiter"),
+        slave("slave"),
+        axi_read_m("axi_read_m"),
+        axi_write_m("axi_write_m"),
+        axi_read_s("axi_read_s"),
+        axi_write_s("axi_write_s") {
+
+    Connections::set_sim_clk(&clk);
+
+    gen0.clk(clk);
+    gen0.reset_bar(reset_bar);
+    gen0.if_rd(axi_read_m[0]);
+    gen0.if_wr(axi_write_m[0]);
+    gen0.done(done[0]);
+    gen1.clk(clk);
+    gen1.reset_bar(reset_bar);
+    gen1.if_rd(axi_read_m[1]);
+    gen1.if_wr(axi_write_m[1]);
+    gen1.done(done[1]);
+    gen2.clk(clk);
+    gen2.reset_bar(reset_bar);
+    gen2.if_rd(axi_read_m[2]);
+    gen2.if_wr(axi_write_m[2]);
+    gen2.done(done[2]);
+    gen3.clk(clk);
+    gen3.reset_bar(reset_bar);
+    gen3.if_rd(axi_read_m[3]);
+    gen3.if_wr(axi_write_m[3]);
+    gen3.done(done[3]);
+
+    axi_arbiter.clk(clk);
+    axi_arbiter.reset_bar(reset_bar);
+    for (int i = 0; i < numMasters; i++) {
+      axi_arbiter.axi_rd_m_ar[i](axi_read_m[i].ar);
+      axi_arbiter.axi_rd_m_r[i](axi_read_m[i].r);
+      axi_arbiter.axi_wr_m_aw[i](axi_write_m[i].aw);
+      axi_arbiter.axi_wr_m_w[i](axi_write_m[i].w);
+      axi_arbiter.axi_wr_m_b[i](axi_write_m[i].b);
+    }
+    axi_arbiter.axi_rd_s(axi_read_s);
+    axi_arbiter.axi_wr_s(axi_write_s);
+
+    slave.clk(clk);
+    slave.reset_bar(reset_bar);
+    slave.if_rd(axi_read_s);
+    slave.if_wr(axi_write_s);
+
+    SC_THREAD(run);
+  }
+
+  unsigned long Completed() {
+    return gen0.Completed() + gen1.Completed() + gen2.Completed() + gen3.Completed();
+  }
+
+  void run() {
+    reset_bar = 1;
+    wait(2, SC_NS);
+    reset_bar = 0;
+    wait(2, SC_NS);
+    reset_bar = 1;
+    wait(10, SC_NS);
+    bench.Start();
+    unsigned long start = Completed();
+    wait(SimBench::NumCycles(50000), SC_NS);
+    bench.AddMsgs(Completed() - start);
+    bench.Stop();
+    bench.Report();
+    if (bench.Msgs() == 0)
+      SC_REPORT_ERROR("testbench", "No AXI transactions completed");
+    sc_stop();
+  }
+};
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  testbench tb("tb");
+  sc_report_handler::set_actions(SC_ERROR, SC_DISPLAY);
+  sc_start();
+  bool rc = (sc_report_handler::get_count(SC_ERROR) > 0);
+  if (rc)
+    DCOUT("TESTBENCH FAIL" << endl);
+  else
+    DCOUT("TESTBENCH PASS" << endl);
+  return rc;
+};
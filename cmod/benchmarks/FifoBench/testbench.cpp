@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_int.h>
+#include <fifo.h>
+#include <testbench/SimBench.h>
+#include <testbench/nvhls_rand.h>
+
+// Each cycle the DUT moves the head of every FIFO bank to its output and
+// refills the banks from the inputs.
+SC_MODULE(FifoBench) {
+  enum { kNumBanks = 4, kDepth = 8 };
+  typedef NVUINT32 Word_t;
+
+  sc_in<bool> clk;
+  sc_in<bool> rst;
+  Connections::In<Word_t> in[kNumBanks];
+  Connections::Out<Word_t> out[kNumBanks];
+
+  FIFO<Word_t, kDepth, kNumBanks> fifo;
+
+  SC_CTOR(FifoBench) : clk("clk"), rst("rst") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void run() {
+    fifo.reset();
+    for (int i = 0; i < kNumBanks; i++) {
+      in[i].Reset();
+      out[i].Reset();
+    }
+    while (1) {
+      wait();
+      for (int i = 0; i < kNumBanks; i++) {
+        if (!fifo.isEmpty(i) && out[i].PushNB(fifo.peek(i))) {
+          fifo.incrHead(i);
+        }
+        Word_t word;
+        if (!fifo.isFull(i) && in[i].PopNB(word)) {
+          fifo.push(word, i);
+        }
+      }
+    }
+  }
+};
+
+static NVUINT32 gen_word(unsigned long i) { return i; }
+
+SC_MODULE(testbench) {
+  typedef FifoBench::Word_t Word_t;
+
+  sc_clock clk;
+  sc_signal<bool> rst;
+  SimBench bench;
+  FifoBench dut;
+  BenchSource<Word_t>* src[FifoBench::kNumBanks];
+  BenchSink<Word_t>* sink[FifoBench::kNumBanks];
+  Connections::Combinational<Word_t> in_chan[FifoBench::kNumBanks];
+  Connections::Combinational<Word_t> out_chan[FifoBench::kNumBanks];
+
+  SC_CTOR(testbench)
+      : clk("clk", 1.0, SC_NS, 0.5, 0, SC_NS, true),
+        rst("rst"),
+        bench("FifoBench"),
+        dut("dut") {
+    Connections::set_sim_clk(&clk);
+    dut.clk(clk);
+    dut.rst(rst);
+    for (int i = 0; i < FifoBench::kNumBanks; i++) {
+      src[i] = new BenchSource<Word_t>(sc_gen_unique_name("src"), gen_word);
+      src[i]->clk(clk);
+      src[i]->rst(rst);
+      src[i]->out(in_chan[i]);
+      dut.in[i](in_chan[i]);
+      sink[i] = new BenchSink<Word_t>(sc_gen_unique_name("sink"), bench);
+      sink[i]->clk(clk);
+      sink[i]->rst(rst);
+      sink[i]->in(out_chan[i]);
+      dut.out[i](out_chan[i]);
+    }
+    SC_THREAD(run);
+  }
+
+  void run() {
+    rst = 0;
+    wait(2, SC_NS);
+    rst = 1;
+    wait(10, SC_NS);
+    bench.Start();
+    wait(SimBench::NumCycles(200000), SC_NS);
+    bench.Stop();
+    bench.Report();
+    if (bench.Msgs() == 0)
+      SC_REPORT_ERROR("testbench", "No messages got through the FIFO");
+    sc_stop();
+  }
+};
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  testbench tb("tb");
+  sc_report_handler::set_actions(SC_ERROR, SC_DISPLAY);
+  sc_start();
+  bool rc = (sc_report_handler::get_count(SC_ERROR) > 0);
+  if (rc)
+    DCOUT("TESTBENCH FAIL" << endl);
+  else
+    DCOUT("TESTBENCH PASS" << endl);
+  return rc;
+};
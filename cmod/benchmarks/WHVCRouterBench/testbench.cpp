@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_packet.h>
+#include <WHVCRouter.h>
+#include <testbench/SimBench.h>
+#include <testbench/nvhls_rand.h>
+
+// Router configuration of unittests/WHVCRouterTop
+enum {
+  kNumVChannels = 1,
+  kBufferSize = 8,
+  kNumLPorts = 1,
+  kNumRPorts = 4,
+  kNumMaxHops = 16,
+  kNumPorts = kNumLPorts + kNumRPorts,
+  kPacketFlits = 4,
+};
+typedef Flit<64, 0, 0, 0, FlitId2bit, WormHole> Flit_t;
+typedef WHVCSourceRouter<kNumLPorts, kNumRPorts, kNumVChannels, kBufferSize, Flit_t, kNumMaxHops> Router;
+typedef Router::Credit_ret_t Credit_ret_t;
+static const int DEST_WIDTHPERHOP = kNumLPorts + nvhls::index_width<kNumRPorts>::val;
+static const int DEST_WIDTH = DEST_WIDTHPERHOP * kNumMaxHops;
+
+// Sends kPacketFlits-flit packets as fast as credits allow.  Packet n of
+// source id goes to port (id + n) % kNumPorts, so all ports are loaded evenly.
+SC_MODULE(Source) {
+  sc_in<bool> clk;
+  sc_in<bool> rst;
+  Connections::Out<Flit_t> out;
+  Connections::In<Credit_ret_t> credit;
+  const int id;
+
+  SC_HAS_PROCESS(Source);
+  Source(sc_module_name name_, int id_)
+      : sc_module(name_), clk("clk"), rst("rst"), out("out"), credit("credit"), id(id_) {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  NVUINTW(DEST_WIDTH) Route(int dest) {
+    NVUINTW(DEST_WIDTH) route = 0;
+    if (dest < kNumLPorts) {
+      route[dest] = 1;
+    } else {
+      route = ((id + 1) << DEST_WIDTHPERHOP) + ((dest - kNumLPorts) << kNumLPorts);
+    }
+    return route;
+  }
+
+  void run() {
+    out.Reset();
+    credit.Reset();
+    int credits = kBufferSize;
+    unsigned long packet = 0;
+    int flit_idx = 0;
+    while (1) {
+      wait();
+      Credit_ret_t ret;
+      if (credit.PopNB(ret)) {
+        credits += ret;
+      }
+      if (credits == 0) {
+        continue;
+      }
+      Flit_t flit;
+      flit.data = packet;
+      if (flit_idx == 0) {
+        flit.flit_id.set(FlitId2bit::HEAD);
+        flit.data = (flit.data << DEST_WIDTH) + Route((id + packet) % kNumPorts);
+      } else if (flit_idx == kPacketFlits - 1) {
+        flit.flit_id.set(FlitId2bit::TAIL);
+      } else {
+        flit.flit_id.set(FlitId2bit::BODY);
+      }
+      if (out.PushNB(flit)) {
+        credits--;
+        if (++flit_idx == kPacketFlits) {
+          flit_idx = 0;
+          packet++;
+        }
+      }
+    }
+  }
+};
+
+// Pops a flit every cycle and returns its credit
+SC_MODULE(Dest) {
+  sc_in<bool> clk;
+  sc_in<bool> rst;
+  Connections::In<Flit_t> in;
+  Connections::Out<Credit_ret_t> credit;
+  SimBench& bench;
+
+  SC_HAS_PROCESS(Dest);
+  Dest(sc_module_name name_, SimBench& bench_)
+      : sc_module(name_), clk("clk"), rst("rst"), in("in"), credit("credit"), bench(bench_) {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void run() {
+    in.Reset();
+    credit.Reset();
+    int credits = 0;
+    while (1) {
+      wait();
+      Flit_t flit;
+      if (in.PopNB(flit)) {
+        credits++;
+        bench.AddMsgs();
+      }
+      if (credits > 0) {
+        Credit_ret_t ret = 1;
+        if (credit.PushNB(ret)) {
+          credits--;
+        }
+      }
+    }
+  }
+};
+
+SC_MODULE(testbench) {
+  typedef Connections::Combinational<Credit_ret_t> CreditChan;
+  typedef Connections::Combinational<Flit_t> DataChan;
+
+  sc_clock clk;
+  sc_signal<bool> rst;
+  SimBench bench;
+  Router router;
+  Source* src[kNumPorts];
+  Dest* dest[kNumPorts];
+  DataChan in_chan[kNumPorts];
+  DataChan out_chan[kNumPorts];
+  CreditChan in_credit_chan[kNumPorts];
+  CreditChan out_credit_chan[kNumPorts];
+
+  SC_CTOR(testbench)
+      : clk("clk", 1.0, SC_NS, 0.5, 0, SC_NS, true),
+        rst("rst"),
+        bench("WHVCRouterBench"),
+        router("router") {
+    Connections::set_sim_clk(&clk);
+    router.clk(clk);
+    router.rst(rst);
+    for (int i = 0; i < kNumPorts; i++) {
+      src[i] = new Source(sc_gen_unique_name("src"), i);
+      src[i]->clk(clk);
+      src[i]->rst(rst);
+      src[i]->out(in_chan[i]);
+      router.in_port[i](in_chan[i]);
+      src[i]->credit(out_credit_chan[i]);
+      router.out_credit[i](out_credit_chan[i]);
+
+      dest[i] = new Dest(sc_gen_unique_name("dest"), bench);
+      dest[i]->clk(clk);
+      dest[i]->rst(rst);
+      dest[i]->in(out_chan[i]);
+      router.out_port[i](out_chan[i]);
+      dest[i]->credit(in_credit_chan[i]);
+      router.in_credit[i](in_credit_chan[i]);
+    }
+    SC_THREAD(run);
+  }
+
+  void run() {
+    rst = 0;
+    wait(2, SC_NS);
+    rst = 1;
+    wait(10, SC_NS);
+    bench.Start();
+    wait(SimBench::NumCycles(100000), SC_NS);
+    bench.Stop();
+    bench.Report();
+    if (bench.Msgs() == 0)
+      SC_REPORT_ERROR("testbench", "No flits got through the router");
+    sc_stop();
+  }
+};
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  testbench tb("tb");
+  sc_report_handler::set_actions(SC_ERROR, SC_DISPLAY);
+  sc_start();
+  bool rc = (sc_report_handler::get_count(SC_ERROR) > 0);
+  if (rc)
+    DCOUT("TESTBENCH FAIL" << endl);
+  else
+    DCOUT("TESTBENCH PASS" << endl);
+  return rc;
+};
@@ -22,7 +22,16 @@
 #include <nvhls_int.h>
 #include <nvhls_assert.h>
 
-enum arbiter_type { Static, Roundrobin };
+enum arbiter_type { Static, Roundrobin, Weighted, DeficitRoundRobin, Matrix };
+
+/**
+ * \def NVHLS_ARBITER_WEIGHT_WIDTH
+ * \ingroup Arbiter
+ * Bitwidth of per-requester weights used by the Weighted and DeficitRoundRobin arbiters (default: 4).
+ */
+#ifndef NVHLS_ARBITER_WEIGHT_WIDTH
+#define NVHLS_ARBITER_WEIGHT_WIDTH 4
+#endif
 
 
 /**
@@ -30,7 +39,7 @@ enum arbiter_type { Static, Roundrobin };
  * \ingroup Arbiter
  *
  * \tparam size_            Number of elements to be arbitrated.
- * \tparam ArbiterType      Selecting arbitration method. Current class implements Roundrobin, and a dedicated [class] (class_arbiter_3_01size___00_01_static_01_4.html) implements Static. (default: Roundrobin).
+ * \tparam ArbiterType      Selecting arbitration method. Current class implements Roundrobin, and dedicated specializations implement Static, Weighted, DeficitRoundRobin and Matrix. (default: Roundrobin).
  *
  * \par Overview
  * - Given a vector indicating which elements are currently valid for selection, and previous selection, a new selection will be made.
@@ -73,6 +82,10 @@ class Arbiter {
         typedef NVUINTW(UNROLLED_SIZE) UnrolledMask;
         Mask next;
 
+#ifndef __SYNTHESIS__
+        enum { HostMaskShift = (size_ <= 64) ? (64 - size_) : 0 };
+#endif
+
     public:
         Arbiter() { reset(); };
 
@@ -83,7 +96,39 @@ class Arbiter {
         // input : valid mask
         // output : select mask
         // side effect : updates internal state of next select
+        // In C++ simulation arbiters with up to 64 inputs use pick_host(),
+        // which produces the same grants as pick_hls(). Define
+        // ARBITER_SIM_USE_HLS_PICK to always use pick_hls().
         Mask pick(const Mask& valid) {
+#if !defined(__SYNTHESIS__) && !defined(ARBITER_SIM_USE_HLS_PICK)
+            if (size_ <= 64) {
+              return pick_host(valid);
+            }
+#endif
+            return pick_hls(valid);
+        }
+
+#ifndef __SYNTHESIS__
+        // Simulation-only pick() for size_ <= 64 on native 64-bit integers.
+        // next always holds the indices below the previous grant (all ones
+        // after a grant to index 0), so the winner is the highest index of
+        // valid&next, or the highest index of valid if that is empty.
+        Mask pick_host(const Mask& valid) {
+            NVHLS_ASSERT_MSG(size_ <= 64, "pick_host supports up to 64 inputs");
+            const unsigned long long all_ones = ~0ULL >> HostMaskShift;
+            unsigned long long v = valid.to_uint64() & all_ones;
+            if (v == 0) {
+              return 0;
+            }
+            unsigned long long p = v & next.to_uint64();
+            unsigned int c = 63 - __builtin_clzll((p != 0) ? p : v);
+            next = static_cast<Mask>((c == 0) ? all_ones : ((1ULL << c) - 1));
+            return static_cast<Mask>(1ULL << c);
+        }
+#endif
+
+        // Synthesizable implementation of pick()
+        Mask pick_hls(const Mask& valid) {
             if (valid == 0) {
               return 0;
             }
@@ -172,6 +217,9 @@ class Arbiter<size_, Static> {
         enum _ { log_size = nvhls::log2_ceil<size_>::val };
 
     public:
+        // no state to reset
+        inline void reset() { }
+
         // picks the next element
         // input : valid mask
         // output : select mask
@@ -188,5 +236,399 @@ class Arbiter<size_, Static> {
         }
 };
 
+/**
+ * \brief Weighted roundrobin arbitration specialization. Usage similar to generic Arbiter class.
+ * \ingroup Arbiter
+ *
+ * \tparam size_            Number of elements to be arbitrated.
+ *
+ * \par Overview
+ * - Each requester owns a credit counter that is loaded with its weight at the start of every round.
+ * - Valid requesters with remaining credits are arbitrated in roundrobin order, and a grant consumes one credit.
+ * - A new round starts when no valid requester has credits left.
+ * - Under saturation requester i receives weight[i]/sum(weight) of the grants, interleaved rather than in bursts.
+ * - Weights default to 1 and must be non-zero. They can be changed at runtime with set_weight(), or set once with constants for a fixed configuration.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <Arbiter.h>
+ *
+ *      ...
+ *      Arbiter<4, Weighted> arbiter;
+ *      arbiter.set_weight(0, 4); // requester 0 gets 4/7 of the bandwidth
+ *      arbiter.set_weight(1, 1);
+ *      arbiter.set_weight(2, 1);
+ *      arbiter.set_weight(3, 1);
+ *      arbiter.reset();
+ *
+ *      while (1) {
+ *          ...
+ *          Arbiter<4, Weighted>::Mask select = arbiter.pick(valid);
+ *          ...
+ *      };
+ *
+ * \endcode
+ * \par
+ *
+ **/
+
+template <unsigned int size_>
+class Arbiter<size_, Weighted> {
+    public:
+        typedef NVUINTW(size_) Mask;
+        static const unsigned int WeightWidth = NVHLS_ARBITER_WEIGHT_WIDTH;
+        typedef NVUINTW(WeightWidth) Weight;
+
+    protected:
+        Arbiter<size_, Roundrobin> rr;
+        Weight weights[size_];
+        Weight credits[size_];
+
+    public:
+        Arbiter() {
+#pragma hls_unroll yes
+            for (unsigned i = 0; i < size_; i++) {
+                weights[i] = 1;
+            }
+            reset();
+        }
+
+        // reset the state, reloads credits from the current weights
+        inline void reset() {
+            rr.reset();
+#pragma hls_unroll yes
+            for (unsigned i = 0; i < size_; i++) {
+                credits[i] = weights[i];
+            }
+        }
+
+        // set the weight of a requester, takes effect from the next round
+        void set_weight(unsigned int idx, const Weight& weight) {
+            NVHLS_ASSERT_MSG(idx < size_, "Arbiter weight index out of bounds");
+            NVHLS_ASSERT_MSG(weight != 0, "Arbiter weight must be non-zero");
+            weights[idx] = weight;
+        }
+
+        Weight get_weight(unsigned int idx) { return weights[idx]; }
+
+        // picks the next element
+        // input : valid mask
+        // output : select mask
+        // side effect : consumes a credit of the selected element
+        Mask pick(const Mask& valid) {
+            Mask eligible = 0;
+#pragma hls_unroll yes
+            for (unsigned i = 0; i < size_; i++) {
+                eligible[i] = (valid[i] == 1) && (credits[i] != 0);
+            }
+
+            // start a new round when all valid requesters are out of credits
+            bool new_round = (eligible == 0) && (valid != 0);
+#pragma hls_unroll yes
+            for (unsigned i = 0; i < size_; i++) {
+                if (new_round) {
+                    credits[i] = weights[i];
+                }
+            }
+            if (new_round) {
+                eligible = valid;
+            }
+
+            Mask select = rr.pick(eligible);
+#pragma hls_unroll yes
+            for (unsigned i = 0; i < size_; i++) {
+                if (select[i] == 1) {
+                    credits[i] = credits[i] - 1;
+                }
+            }
+            return select;
+        }
+};
+
+/**
+ * \brief Deficit roundrobin arbitration specialization. Usage similar to generic Arbiter class.
+ * \ingroup Arbiter
+ *
+ * \tparam size_            Number of elements to be arbitrated.
+ *
+ * \par Overview
+ * - Requesters are served in roundrobin order. When a requester's turn starts its deficit counter is increased by its weight (quantum).
+ * - The requester keeps the grant on subsequent cycles while it stays valid and its deficit is positive. Every grant subtracts the cost of the granted request from the deficit.
+ * - The last grant of a turn may overdraw the deficit. The debt is repaid from the next quantum, so long-term bandwidth (in cost units) is proportional to the weights.
+ * - A requester that goes idle forfeits its accumulated deficit, as in classic DRR.
+ * - pick(valid) uses a cost of 1 for every request, which grants each requester runs of weight[i] consecutive grants. pick(valid, cost) accepts per-request costs, e.g. packet lengths.
+ * - If a new turn starts with a non-positive deficit no grant is made in that cycle, and the turn passes to the next requester. Weights at least as large as the largest cost avoid these idle cycles.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <Arbiter.h>
+ *
+ *      ...
+ *      Arbiter<4, DeficitRoundRobin> arbiter;
+ *      arbiter.set_weight(0, 8);
+ *      ...
+ *      Arbiter<4, DeficitRoundRobin>::Weight cost[4]; // e.g. number of flits of each pending packet
+ *      Arbiter<4, DeficitRoundRobin>::Mask select = arbiter.pick(valid, cost);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ **/
+
+template <unsigned int size_>
+class Arbiter<size_, DeficitRoundRobin> {
+    public:
+        typedef NVUINTW(size_) Mask;
+        static const unsigned int WeightWidth = NVHLS_ARBITER_WEIGHT_WIDTH;
+        typedef NVUINTW(WeightWidth) Weight;
+        // Non-owners always hold a deficit <= 0, so a deficit stays within
+        // (-2^WeightWidth, 2^WeightWidth).
+        typedef NVINTW(WeightWidth + 2) Deficit;
+
+    protected:
+        Arbiter<size_, Roundrobin> rr;
+        Weight weights[size_];
+        Deficit deficit[size_];
+        Mask owner;
+
+    public:
+        Arbiter() {
+#pragma hls_unroll yes
+            for (unsigned i = 0; i < size_; i++) {
+                weights[i] = 1;
+            }
+            reset();
+        }
+
+        // reset the state
+        inline void reset() {
+            rr.reset();
+            owner = 0;
+#pragma hls_unroll yes
+            for (unsigned i = 0; i < size_; i++) {
+                deficit[i] = 0;
+            }
+        }
+
+        // set the quantum of a requester, takes effect from its next turn
+        void set_weight(unsigned int idx, const Weight& weight) {
+            NVHLS_ASSERT_MSG(idx < size_, "Arbiter weight index out of bounds");
+            NVHLS_ASSERT_MSG(weight != 0, "Arbiter weight must be non-zero");
+            weights[idx] = weight;
+        }
+
+        Weight get_weight(unsigned int idx) { return weights[idx]; }
+
+        // picks the next element, every request costs 1
+        Mask pick(const Mask& valid) {
+            Weight cost[size_];
+#pragma hls_unroll yes
+            for (unsigned i = 0; i < size_; i++) {
+                cost[i] = 1;
+            }
+            return pick(valid, cost);
+        }
+
+        // picks the next element
+        // input : valid mask, cost of the pending request of each element
+        // output : select mask
+        // side effect : charges the cost of the selected element to its deficit
+        Mask pick(const Mask& valid, const Weight cost[size_]) {
+            bool keep = false;
+#pragma hls_unroll yes
+            for (unsigned i = 0; i < size_; i++) {
+                if (owner[i] == 1) {
+                    if (valid[i] == 0) {
+                        deficit[i] = 0;
+                    } else if (deficit[i] > 0) {
+                        keep = true;
+                    }
+                }
+            }
+
+            if (!keep) {
+                owner = rr.pick(valid);
+#pragma hls_unroll yes
+                for (unsigned i = 0; i < size_; i++) {
+                    if (owner[i] == 1) {
+                        deficit[i] = deficit[i] + weights[i];
+                    }
+                }
+            }
+
+            Mask select = 0;
+#pragma hls_unroll yes
+            for (unsigned i = 0; i < size_; i++) {
+                if ((owner[i] == 1) && (deficit[i] > 0)) {
+                    select[i] = 1;
+                    deficit[i] = deficit[i] - cost[i];
+                }
+            }
+            return select;
+        }
+};
+
+/**
+ * \brief Matrix (least-recently-granted) arbitration specialization. Usage similar to generic Arbiter class.
+ * \ingroup Arbiter
+ *
+ * \tparam size_            Number of elements to be arbitrated.
+ *
+ * \par Overview
+ * - The arbiter keeps a pairwise priority bit for every pair of requesters, prio[i][j] (i < j) is set when i has priority over j.
+ * - A valid requester is granted when it has priority over every other valid requester. Each grant bit is a single AND over size_-1 terms and does not depend on the other grants, so there is no priority chain across requesters.
+ * - After a grant the winner loses priority to all other requesters, which results in least-recently-granted arbitration. Initially lower indices have higher priority.
+ * - Only the upper triangle of the matrix is stored, size_*(size_-1)/2 state bits. The roundrobin arbiter needs size_ bits, so this specialization trades area for timing and is best suited for wide arbiters on critical paths.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <Arbiter.h>
+ *
+ *      ...
+ *      Arbiter<32, Matrix> arbiter;
+ *      arbiter.reset();
+ *
+ *      while (1) {
+ *          ...
+ *          Arbiter<32, Matrix>::Mask select = arbiter.pick(valid);
+ *          ...
+ *      };
+ *
+ * \endcode
+ * \par
+ *
+ **/
+
+template <unsigned int size_>
+class Arbiter<size_, Matrix> {
+    public:
+        typedef NVUINTW(size_) Mask;
+
+    protected:
+        // prio[i][j] is only used for j > i
+        Mask prio[size_];
+
+    public:
+        Arbiter() { reset(); }
+
+        // reset the state, lower indices have higher priority
+        inline void reset() {
+#pragma hls_unroll yes
+            for (unsigned i = 0; i < size_; i++) {
+                prio[i] = 0;
+#pragma hls_unroll yes
+                for (unsigned j = i + 1; j < size_; j++) {
+                    prio[i][j] = 1;
+                }
+            }
+        }
+
+        // picks the next element
+        // input : valid mask
+        // output : select mask
+        // side effect : the selected element gets the lowest priority
+        Mask pick(const Mask& valid) {
+            Mask select = 0;
+#pragma hls_unroll yes
+            for (unsigned i = 0; i < size_; i++) {
+                bool win = (valid[i] == 1);
+#pragma hls_unroll yes
+                for (unsigned j = 0; j < size_; j++) {
+                    if (j != i) {
+                        bool i_over_j = (j > i) ? (prio[i][j] == 1) : (prio[j][i] == 0);
+                        win = win && ((valid[j] == 0) || i_over_j);
+                    }
+                }
+                select[i] = win;
+            }
+
+#pragma hls_unroll yes
+            for (unsigned i = 0; i < size_; i++) {
+#pragma hls_unroll yes
+                for (unsigned j = i + 1; j < size_; j++) {
+                    if (select[i] == 1) {
+                        prio[i][j] = 0;
+                    } else if (select[j] == 1) {
+                        prio[i][j] = 1;
+                    }
+                }
+            }
+            return select;
+        }
+};
+
+/**
+ * \brief Arbiter with a hold input that keeps the last grant, e.g. from the header to the tail flit of a packet
+ * \ingroup Arbiter
+ *
+ * \tparam size_            Number of elements to be arbitrated.
+ * \tparam ArbiterType      Arbitration between held grants, any Arbiter specialization (default: Roundrobin).
+ *
+ * \par Overview
+ * - pick(valid, hold) with hold set grants the element that was granted last again, if it is valid, without running the arbiter and without updating its priorities. If that element is not valid nothing is granted, so no other element gets in between, e.g. in a bubble of a packet.
+ * - With hold cleared, or while nothing was granted since reset, it arbitrates as Arbiter<size_, ArbiterType>. The element that held the grant was the last one picked, so a roundrobin arbiter moves past it when the hold is released.
+ * - Hold muxes the stored grant after the arbiter, so unlike masking the requests with the owner of a packet it adds no logic in front of the arbiter.
+ * - The last grant is one register of size_ bits on top of the state of the arbiter. With hold tied to false it is never read and the arbiter behaves exactly like Arbiter<size_, ArbiterType>.
+ * - arbiter() gives access to the underlying arbiter, e.g. for set_weight() of a Weighted or DeficitRoundRobin arbiter.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <Arbiter.h>
+ *
+ *      ...
+ *      LockableArbiter<4> arbiter;
+ *      arbiter.reset();
+ *
+ *      while (1) {
+ *          ...
+ *          // hold from the header flit up to and including the tail flit
+ *          LockableArbiter<4>::Mask select = arbiter.pick(valid, in_packet);
+ *          ...
+ *      };
+ *
+ * \endcode
+ * \par
+ *
+ **/
+
+template <unsigned int size_, arbiter_type ArbiterType = Roundrobin>
+class LockableArbiter {
+    public:
+        typedef typename Arbiter<size_, ArbiterType>::Mask Mask;
+
+    protected:
+        Arbiter<size_, ArbiterType> arb;
+        // last non-zero grant, 0 after reset
+        Mask grant;
+
+    public:
+        LockableArbiter() { reset(); }
+
+        // reset the arbiter and drop any held grant
+        inline void reset() {
+            arb.reset();
+            grant = 0;
+        }
+
+        Arbiter<size_, ArbiterType>& arbiter() { return arb; }
+
+        Mask last_grant() const { return grant; }
+
+        // picks the next element
+        // input : valid mask, hold
+        // output : select mask
+        // side effect : updates internal state of the arbiter unless the grant is held
+        Mask pick(const Mask& valid, bool hold = false) {
+            if (hold && grant != 0) {
+                return grant & valid;
+            }
+            Mask select = arb.pick(valid);
+            if (select != 0) {
+                grant = select;
+            }
+            return select;
+        }
+};
 
 #endif  // __ARBITER_H__
@@ -25,6 +25,15 @@
 #include <arbitrated_crossbar.h>
 #include <ArbitratedScratchpad/ArbitratedScratchpadTypes.h>
 #include <crossbar.h>
+
+/**
+ * \brief Mapping of scratchpad addresses to banks
+ * \ingroup ArbitratedScratchpad
+ *
+ * - BankLowBits: the low address bits select the bank.
+ * - BankXorSwizzle: the low address bits are XORed with the bank address folded to the bank index width. Strides that are a multiple of the number of banks then spread over all banks. The bank address is unchanged, so the mapping stays one-to-one.
+ */
+enum scratchpad_bank_map { BankLowBits, BankXorSwizzle };
 /**
  * \brief Scratchpad Memories with arbitration and queuing 
  * \ingroup ArbitratedScratchpad
@@ -35,6 +44,28 @@
  * \tparam NumBanks         Number of Banks 
  * \tparam LenInputBuffer   Length of Input Buffer 
  * \tparam LenOutputBuffer  Length of Output Buffer 
+ * \tparam ArbiterType      Arbitration method used for bank conflicts, see Arbiter (default: Roundrobin)
+ * \tparam BankMap          Address to bank mapping, see scratchpad_bank_map (default: BankLowBits)
+ * \tparam BankBypass       Let requests behind a blocked head bypass it (default: false)
+ * \tparam WideRow          Serve accesses to one row across all banks without arbitration (default: false)
+ * \tparam Atomics          Perform the CLITYPE_T::ATOMIC_* operations in the banks (default: false)
+ *
+ * \par Bank Bypass
+ * - With BankBypass the input queues are request windows. A lane whose head loses arbitration may issue a younger request of its window instead, if that request targets a bank that is still free.
+ * - A request may only bypass entries that target other banks, so accesses to the same address stay in order. Load responses of a lane are in order per bank, but loads to different banks may return out of order. map_address() gives the bank of an address.
+ * - Heads are arbitrated first, bypassing requests use the banks left free by the heads.
+ * - Requires InputQueueLen > 0.
+ *
+ * \par Wide Row Access
+ * - With WideRow, a request in which every valid lane i maps to bank i at the same bank address, e.g. a unit-stride vector access aligned to NumBanks words with BankLowBits, accesses all banks in the same cycle. It skips the request crossbar and the arbiters, and load data go straight from bank i to lane i without the response crossbar.
+ * - The fast path is only taken while no older request is queued, so it keeps the ordering of the arbitrated path. Requires NumInputs == NumBanks; otherwise WideRow has no effect.
+ *
+ * \par Atomics
+ * - With Atomics, a bank performs an atomic operation as a read and a write of the same entry in one cycle and returns the old value like a load. Lanes of one request that target the same address are serialized by the bank arbitration, so each of them sees the result of the ones granted before it; their order is the arbitration order, not the lane order.
+ * - req_t carries the cmp operand of ATOMIC_CAS. An atomic is ordered with the other requests of its lane like a store.
+ *
+ * \par Statistics
+ * - In C++ simulation the scratchpad counts calls of load_store(), bank accesses, bypass grants, atomics and bank accesses on the wide row path. DumpStats() prints them along with the bank utilization and WideRowFraction(), and ResetStats() clears them.
  *
  * \par A Simple Example
  * \code
@@ -54,7 +85,9 @@
 
 template <typename DataType, unsigned int CapacityInBytes,
           unsigned int NumInputs, unsigned int NumBanks,
-          unsigned int InputQueueLen>
+          unsigned int InputQueueLen, arbiter_type ArbiterType = Roundrobin,
+          scratchpad_bank_map BankMap = BankLowBits, bool BankBypass = false,
+          bool WideRow = false, bool Atomics = false>
 class ArbitratedScratchpad {
 
  public:
@@ -63,18 +96,23 @@ class ArbitratedScratchpad {
   static const int addr_width = nvhls::nbits<CapacityInBytes - 1>::val;
   static const int log2_nbanks = nvhls::nbits<NumBanks - 1>::val;
   static const int log2_inputs = nvhls::nbits<NumInputs - 1>::val;
+  static const bool wide_row_en = WideRow && (NumInputs == NumBanks);
 
   //------------Local typedefs---------------------------
   typedef NVUINTW(log2_nbanks) bank_sel_t;                // index of bank
   typedef NVUINTW(addr_width - log2_nbanks) bank_addr_t;  // address within bank
   typedef NVUINTW(log2_inputs) input_sel_t;               // index of input
+  typedef NVUINTW(CLITYPE_T::width) op_t;                 // atomic operation
 
   struct bank_req_t : public nvhls_message {
     NVUINT1 do_store;
     bank_addr_t addr;
     DataType    wdata;
     input_sel_t input_chan;
-    static const int width = 1 + addr_width-log2_nbanks + Wrapped<DataType>::width + log2_inputs;
+    op_t        op;
+    DataType    cmp;
+    static const int width = 1 + addr_width-log2_nbanks + Wrapped<DataType>::width + log2_inputs +
+                             (Atomics ? CLITYPE_T::width + Wrapped<DataType>::width : 0);
 
     template <unsigned int Size>
     void Marshall(Marshaller<Size>& m) {
@@ -82,6 +120,10 @@ class ArbitratedScratchpad {
       m& addr;
       m& wdata;
       m& input_chan;
+      if (Atomics) {
+        m& op;
+        m& cmp;
+      }
     }
   };
   struct bank_rsp_t : public nvhls_message {
@@ -96,17 +138,53 @@ class ArbitratedScratchpad {
     }
   };
 
-  typedef cli_req_t<DataType, addr_width, NumInputs> req_t; // request input type
+  typedef cli_req_t<DataType, addr_width, NumInputs, Atomics> req_t; // request input type
   typedef cli_rsp_t<DataType, NumInputs> rsp_t;             // response output type
+  typedef DataType data_t;                                   // entry type
+  static const unsigned int num_inputs = NumInputs;
 
   //------------Local Variables Here---------------------
   mem_array_sep<DataType, CapacityInBytes, NumBanks> banks;
   bank_req_t bank_reqs[NumInputs];
   bank_rsp_t bank_rsps[NumInputs];
 
-  ArbitratedCrossbar<bank_req_t, NumInputs, NumBanks, InputQueueLen, 0>
+  ArbitratedCrossbar<bank_req_t, NumInputs, NumBanks, InputQueueLen, 0,
+                     ArbiterType>
       request_xbar;
 
+  // Request windows for BankBypass, entries are kept in age order from slot 0
+  static const unsigned int WindowLen = (InputQueueLen > 0) ? InputQueueLen : 1;
+  bank_req_t window[NumInputs][WindowLen];
+  bank_sel_t window_bank[NumInputs][WindowLen];
+  bool window_valid[NumInputs][WindowLen];
+  Arbiter<NumInputs, ArbiterType> head_arbiters[NumBanks];
+  Arbiter<NumInputs, ArbiterType> bypass_arbiters[NumBanks];
+
+#ifndef __SYNTHESIS__
+  unsigned long long stat_cycles;
+  unsigned long long stat_bank_accesses[NumBanks];
+  unsigned long long stat_bypasses;
+  unsigned long long stat_wide_row_accesses;
+  unsigned long long stat_atomics;
+#endif
+
+ public:
+  // Bank and address within the bank of a scratchpad address
+  static void map_address(const NVUINTW(addr_width) & addr, bank_sel_t& bank,
+                          bank_addr_t& bank_addr) {
+    bank_addr = nvhls::get_slc<addr_width - log2_nbanks>(addr, log2_nbanks);
+    bank = nvhls::get_slc<log2_nbanks>(addr, 0);
+    if ((BankMap == BankXorSwizzle) && (NumBanks > 1)) {
+      #pragma hls_unroll yes
+      for (unsigned i = 0; i < addr_width - log2_nbanks; i++) {
+        bool bit = (bank[i % log2_nbanks] == 1) != (bank_addr[i] == 1);
+        bank[i % log2_nbanks] = bit;
+      }
+    }
+  }
+
+ private:
+
   void compute_bank_request(req_t &curr_cli_req, bank_req_t bank_req[NumInputs],
                             bank_sel_t bank_sel[NumInputs],
                             bool bank_req_valid[NumInputs]) {
@@ -115,18 +193,21 @@ class ArbitratedScratchpad {
     #pragma hls_unroll yes
     for (unsigned in_chan = 0; in_chan < NumInputs; in_chan++) {
 
-      // Get the target bank
-      bank_sel[in_chan] =
-          nvhls::get_slc<log2_nbanks>(curr_cli_req.addr[in_chan], 0);
+      // Get the target bank and the address within the bank
+      map_address(curr_cli_req.addr[in_chan], bank_sel[in_chan],
+                  bank_req[in_chan].addr);
 
       // Compile the bank request
       bank_req[in_chan].do_store = (curr_cli_req.valids[in_chan] == true) &&
                                    (curr_cli_req.type.val == CLITYPE_T::STORE);
-      bank_req[in_chan].addr = nvhls::get_slc<addr_width - log2_nbanks>(
-          curr_cli_req.addr[in_chan], log2_nbanks);
-      if (bank_req[in_chan].do_store) {
+      bool is_atomic = Atomics && CLITYPE_T::IsAtomic(curr_cli_req.type.val);
+      if (bank_req[in_chan].do_store || is_atomic) {
         bank_req[in_chan].wdata = curr_cli_req.data[in_chan];
       }
+      if (Atomics) {
+        bank_req[in_chan].op  = curr_cli_req.type.val;
+        bank_req[in_chan].cmp = curr_cli_req.cmp[in_chan];
+      }
 
       // Cast current input to input index type
       input_sel_t input_idx        = in_chan;
@@ -143,7 +224,17 @@ class ArbitratedScratchpad {
     #pragma hls_unroll yes
     for (unsigned bank = 0; bank < NumBanks; bank++) {
       if (bank_req_valid[bank] == true) {
-        if (!bank_req[bank].do_store) {
+        if (Atomics && CLITYPE_T::IsAtomic(bank_req[bank].op)) {
+          DataType old = banks.read(bank_req[bank].addr, bank);
+          banks.write(bank_req[bank].addr, bank,
+                      CLITYPE_T::AtomicResult(bank_req[bank].op, old, bank_req[bank].wdata,
+                                              bank_req[bank].cmp));
+          bank_rsp[bank].valid = true;
+          bank_rsp[bank].rdata = old;
+#ifndef __SYNTHESIS__
+          stat_atomics++;
+#endif
+        } else if (!bank_req[bank].do_store) {
           bank_rsp[bank].valid = true;
           bank_rsp[bank].rdata = banks.read(bank_req[bank].addr, bank);
         } else {
@@ -156,10 +247,244 @@ class ArbitratedScratchpad {
     }
   }
 
+  // True if every valid lane i targets bank i at one bank address and no
+  // older request is queued
+  bool is_wide_row(bank_req_t bank_req[NumInputs], bank_sel_t bank_sel[NumInputs],
+                   bool bank_req_valid[NumInputs]) {
+    bool wide = wide_row_en;
+    bool any = false;
+    bank_addr_t row = 0;
+    #pragma hls_unroll yes
+    for (unsigned in = 0; in < NumInputs; in++) {
+      if (bank_req_valid[in]) {
+        if (!any) {
+          row = bank_req[in].addr;
+        }
+        any = true;
+        wide = wide && (bank_sel[in] == in) && (bank_req[in].addr == row);
+      }
+    }
+    return wide && any && isIdle();
+  }
+
+  // Bank arbitration with bypass of blocked heads, interface of
+  // ArbitratedCrossbar::run()
+  void bypass_xbar(bank_req_t bank_req[NumInputs], bank_sel_t bank_sel[NumInputs],
+                   bool bank_req_valid[NumInputs],
+                   bank_req_t bank_req_winner[NumBanks],
+                   bool bank_req_winner_valid[NumBanks],
+                   bool input_ready[NumInputs]) {
+    // Append new requests to the windows
+    #pragma hls_unroll yes
+    for (unsigned in = 0; in < NumInputs; in++) {
+      bool full = window_valid[in][WindowLen - 1];
+      input_ready[in] = !full || !bank_req_valid[in];
+      bool placed = !bank_req_valid[in] || full;
+      #pragma hls_unroll yes
+      for (unsigned k = 0; k < WindowLen; k++) {
+        if (!placed && !window_valid[in][k]) {
+          window[in][k] = bank_req[in];
+          window_bank[in][k] = bank_sel[in];
+          window_valid[in][k] = true;
+          placed = true;
+        }
+      }
+    }
+
+    // A request is eligible if no older request of its window targets the
+    // same bank
+    bool eligible[NumInputs][WindowLen];
+    #pragma hls_unroll yes
+    for (unsigned in = 0; in < NumInputs; in++) {
+      NVUINTW(NumBanks) older_banks = 0;
+      #pragma hls_unroll yes
+      for (unsigned k = 0; k < WindowLen; k++) {
+        eligible[in][k] = window_valid[in][k] &&
+                          (older_banks[window_bank[in][k]] == 0);
+        if (window_valid[in][k]) {
+          older_banks[window_bank[in][k]] = 1;
+        }
+      }
+    }
+
+    // Round 1: every bank arbitrates among the heads targeting it
+    NVUINTW(NumInputs) head_grant[NumBanks];
+    NVUINTW(NumInputs) granted = 0;
+    NVUINTW(NumBanks) bank_taken = 0;
+    #pragma hls_unroll yes
+    for (unsigned bank = 0; bank < NumBanks; bank++) {
+      NVUINTW(NumInputs) requests = 0;
+      #pragma hls_unroll yes
+      for (unsigned in = 0; in < NumInputs; in++) {
+        requests[in] = window_valid[in][0] && (window_bank[in][0] == bank);
+      }
+      head_grant[bank] = head_arbiters[bank].pick(requests);
+      bank_taken[bank] = (head_grant[bank] != 0);
+      granted |= head_grant[bank];
+    }
+
+    // Round 2: lanes without a grant offer their oldest eligible younger
+    // request that targets a free bank
+    unsigned bypass_slot[NumInputs];
+    bool bypass_valid[NumInputs];
+    #pragma hls_unroll yes
+    for (unsigned in = 0; in < NumInputs; in++) {
+      bypass_slot[in] = 0;
+      bypass_valid[in] = false;
+      #pragma hls_unroll yes
+      for (unsigned k = 1; k < WindowLen; k++) {
+        if (!bypass_valid[in] && (granted[in] == 0) && eligible[in][k] &&
+            (bank_taken[window_bank[in][k]] == 0)) {
+          bypass_slot[in] = k;
+          bypass_valid[in] = true;
+        }
+      }
+    }
+    NVUINTW(NumInputs) bypass_grant[NumBanks];
+    #pragma hls_unroll yes
+    for (unsigned bank = 0; bank < NumBanks; bank++) {
+      NVUINTW(NumInputs) requests = 0;
+      #pragma hls_unroll yes
+      for (unsigned in = 0; in < NumInputs; in++) {
+        requests[in] = bypass_valid[in] && (window_bank[in][bypass_slot[in]] == bank);
+      }
+      bypass_grant[bank] = 0;
+      if (bank_taken[bank] == 0) {
+        bypass_grant[bank] = bypass_arbiters[bank].pick(requests);
+      }
+    }
+
+    // Send the winners to the banks and remove them from the windows
+    bool issued[NumInputs];
+    unsigned issued_slot[NumInputs];
+    #pragma hls_unroll yes
+    for (unsigned in = 0; in < NumInputs; in++) {
+      issued[in] = false;
+      issued_slot[in] = 0;
+    }
+    #pragma hls_unroll yes
+    for (unsigned bank = 0; bank < NumBanks; bank++) {
+      bank_req_winner_valid[bank] = false;
+      #pragma hls_unroll yes
+      for (unsigned in = 0; in < NumInputs; in++) {
+        if (head_grant[bank][in] == 1) {
+          bank_req_winner[bank] = window[in][0];
+          bank_req_winner_valid[bank] = true;
+          issued[in] = true;
+        }
+        if (bypass_grant[bank][in] == 1) {
+          bank_req_winner[bank] = window[in][bypass_slot[in]];
+          bank_req_winner_valid[bank] = true;
+          issued[in] = true;
+          issued_slot[in] = bypass_slot[in];
+#ifndef __SYNTHESIS__
+          stat_bypasses++;
+#endif
+        }
+      }
+    }
+    #pragma hls_unroll yes
+    for (unsigned in = 0; in < NumInputs; in++) {
+      if (issued[in]) {
+        #pragma hls_unroll yes
+        for (unsigned k = 0; k < WindowLen - 1; k++) {
+          if (k >= issued_slot[in]) {
+            window[in][k] = window[in][k + 1];
+            window_bank[in][k] = window_bank[in][k + 1];
+            window_valid[in][k] = window_valid[in][k + 1];
+          }
+        }
+        window_valid[in][WindowLen - 1] = false;
+      }
+    }
+  }
+
  public:
-  ArbitratedScratchpad() { reset(); }
+  ArbitratedScratchpad() {
+    NVHLS_ASSERT_MSG((!BankBypass || (InputQueueLen > 0)), "BankBypass needs non-zero input queues");
+    reset();
+  }
+
+  void reset() {
+    request_xbar.reset();
+    #pragma hls_unroll yes
+    for (unsigned in = 0; in < NumInputs; in++) {
+      #pragma hls_unroll yes
+      for (unsigned k = 0; k < WindowLen; k++) {
+        window_valid[in][k] = false;
+      }
+    }
+    #pragma hls_unroll yes
+    for (unsigned bank = 0; bank < NumBanks; bank++) {
+      head_arbiters[bank].reset();
+      bypass_arbiters[bank].reset();
+    }
+#ifndef __SYNTHESIS__
+    ResetStats();
+#endif
+  }
+
+  // True if no request is queued, so every accepted request has completed
+  bool isIdle() {
+    bool idle = (InputQueueLen == 0) || request_xbar.isAllInputEmpty();
+    if (BankBypass) {
+      #pragma hls_unroll yes
+      for (unsigned in = 0; in < NumInputs; in++) {
+        idle = idle && !window_valid[in][0];
+      }
+    }
+    return idle;
+  }
+
+#ifndef __SYNTHESIS__
+  void ResetStats() {
+    stat_cycles = 0;
+    stat_bypasses = 0;
+    stat_wide_row_accesses = 0;
+    stat_atomics = 0;
+    for (unsigned bank = 0; bank < NumBanks; bank++) {
+      stat_bank_accesses[bank] = 0;
+    }
+  }
+
+  // Fraction of bank cycles that performed an access
+  double BankUtilization() {
+    unsigned long long accesses = 0;
+    for (unsigned bank = 0; bank < NumBanks; bank++) {
+      accesses += stat_bank_accesses[bank];
+    }
+    return (stat_cycles == 0) ? 0.0 : accesses / (static_cast<double>(stat_cycles) * NumBanks);
+  }
+
+  unsigned long long Bypasses() { return stat_bypasses; }
+
+  unsigned long long AtomicOps() { return stat_atomics; }
 
-  void reset() { request_xbar.reset(); }
+  // Fraction of bank accesses that took the wide row path
+  double WideRowFraction() {
+    unsigned long long accesses = 0;
+    for (unsigned bank = 0; bank < NumBanks; bank++) {
+      accesses += stat_bank_accesses[bank];
+    }
+    return (accesses == 0) ? 0.0 : stat_wide_row_accesses / static_cast<double>(accesses);
+  }
+
+  void DumpStats(std::ostream& ofile) {
+    ofile << "cycles: " << stat_cycles << std::endl;
+    for (unsigned bank = 0; bank < NumBanks; bank++) {
+      ofile << "bank " << bank << " accesses: " << stat_bank_accesses[bank] << std::endl;
+    }
+    ofile << "bypasses: " << stat_bypasses << std::endl;
+    if (Atomics) {
+      ofile << "atomics: " << stat_atomics << std::endl;
+    }
+    ofile << "bank utilization: " << BankUtilization() << std::endl;
+    if (WideRow) {
+      ofile << "wide row accesses: " << stat_wide_row_accesses
+            << " (" << WideRowFraction() << " of bank accesses)" << std::endl;
+    }
+  }
+#endif
 
   #ifdef HLS_ALGORITHMICC
   void load_store(req_t &curr_cli_req, rsp_t &load_rsp,
@@ -190,8 +515,39 @@ class ArbitratedScratchpad {
 
     bank_req_t bank_req_winner[NumBanks];
     bool bank_req_winner_valid[NumBanks];
-    request_xbar.run(bank_req, bank_sel, bank_req_valid, bank_req_winner,
-                     bank_req_winner_valid, input_ready);
+    bool wide_row = is_wide_row(bank_req, bank_sel, bank_req_valid);
+    if (wide_row) {
+      // Lane i drives bank i directly
+      #pragma hls_unroll yes
+      for (unsigned bank = 0; bank < NumBanks; bank++) {
+        bank_req_winner_valid[bank] = false;
+        if (bank < NumInputs) {
+          bank_req_winner[bank] = bank_req[bank];
+          bank_req_winner_valid[bank] = bank_req_valid[bank];
+        }
+      }
+      #pragma hls_unroll yes
+      for (unsigned in = 0; in < NumInputs; in++) {
+        input_ready[in] = true;
+      }
+    } else if (BankBypass) {
+      bypass_xbar(bank_req, bank_sel, bank_req_valid, bank_req_winner,
+                  bank_req_winner_valid, input_ready);
+    } else {
+      request_xbar.run(bank_req, bank_sel, bank_req_valid, bank_req_winner,
+                       bank_req_winner_valid, input_ready);
+    }
+#ifndef __SYNTHESIS__
+    stat_cycles++;
+    for (unsigned i = 0; i < NumBanks; ++i) {
+      if (bank_req_winner_valid[i]) {
+        stat_bank_accesses[i]++;
+        if (wide_row) {
+          stat_wide_row_accesses++;
+        }
+      }
+    }
+#endif
 
     DCOUT("\t\tbank winner transactions:" << endl);
     for (unsigned i = 0; i < NumBanks; ++i) {
@@ -236,8 +592,19 @@ class ArbitratedScratchpad {
       }
     }
 
-    crossbar<DataType, NumBanks, NumInputs>(data_in, valid_in, source,
-                                            valid_src, data_out, valid_out);
+    if (wide_row) {
+      #pragma hls_unroll yes
+      for (unsigned out = 0; out < NumInputs; out++) {
+        valid_out[out] = false;
+        if (out < NumBanks) {
+          valid_out[out] = valid_in[out];
+          data_out[out] = data_in[out];
+        }
+      }
+    } else {
+      crossbar<DataType, NumBanks, NumInputs>(data_in, valid_in, source,
+                                              valid_src, data_out, valid_out);
+    }
 
     #pragma hls_unroll yes
     for (unsigned out = 0; out < NumInputs; out++) {
@@ -22,27 +22,52 @@
 #include <comptrees.h>
 
 // Declare client input and output interfaces as structs
+//
+// The ATOMIC_* types are read-modify-write operations performed by the bank.
+// They return the old value like a load and store the result: old + data,
+// min(old, data), max(old, data), data, or data if old equals cmp (CAS).
 class CLITYPE_T : public nvhls_message {
  public:
-  enum { LOAD, STORE };
-  sc_uint<1> val;
-  static const int width = 1;
+  enum { LOAD, STORE, ATOMIC_ADD, ATOMIC_MIN, ATOMIC_MAX, ATOMIC_SWAP, ATOMIC_CAS };
+  sc_uint<3> val;
+  static const int width = 3;
 
   template <unsigned int Size>
   void Marshall(Marshaller<Size>& m) {
     m& val;
   }
+
+  static bool IsAtomic(const sc_uint<3>& op) { return op >= ATOMIC_ADD; }
+
+  // Value stored by an atomic operation on old
+  template <typename T>
+  static T AtomicResult(const sc_uint<3>& op, const T& old, const T& data, const T& cmp) {
+    T result = data;
+    if (op == ATOMIC_ADD) {
+      result = old + data;
+    } else if (op == ATOMIC_MIN) {
+      result = (data < old) ? data : old;
+    } else if (op == ATOMIC_MAX) {
+      result = (data > old) ? data : old;
+    } else if (op == ATOMIC_CAS) {
+      result = (old == cmp) ? data : old;
+    }
+    return result;
+  }
 };
 
-template <typename T, unsigned int AddrWidth, unsigned int N>
+// HasCmp adds the cmp operand of ATOMIC_CAS to every lane
+template <typename T, unsigned int AddrWidth, unsigned int N, bool HasCmp = false>
 class cli_req_t : public nvhls_message {
  public:
   CLITYPE_T type;
   bool valids[N];
   NVUINTW(AddrWidth) addr[N];
   T data[N];
+  T cmp[HasCmp ? N : 1];
   static const unsigned int type_width = Wrapped<T>::width;
-  static const int width = 1 + N + N * (AddrWidth + type_width);
+  static const int width = CLITYPE_T::width + N + N * (AddrWidth + type_width) +
+                           (HasCmp ? N * type_width : 0);
 
   template <unsigned int Size>
   void Marshall(Marshaller<Size>& m) {
@@ -50,6 +75,9 @@ class cli_req_t : public nvhls_message {
       m& data[i];
       m& addr[i];
       m& valids[i];
+      if (HasCmp) {
+        m& cmp[i];
+      }
     }
     m& type;
   }
@@ -24,6 +24,8 @@
 #include <arbitrated_crossbar.h>
 #include <crossbar.h>
 #include <hls_globals.h>
+#include <nvhls_stats.h>
+#include <fifo.h>
 
 /**
  * \brief ArbitratedScratchpad with dual port support 
@@ -36,6 +38,20 @@
  * \tparam WordType         WordType of entry in memory 
  * \tparam isSF             Is Store-Forward enabled for simultaneous read and write to same address 
  * \tparam IsSPRAM          Is memory mapped to single-port RAM. Either read or write is allowed per cycle 
+ * \tparam kWriteBufferDepth Entries of the per-bank write buffer, 0 to disable (default: 0)
+ *
+ * \par Write buffer
+ * - With kWriteBufferDepth > 0, a write is acknowledged as soon as there is room in the write buffer of its bank, instead of stalling when another port writes the same bank. Writes to one bank are accepted in port order and each bank writes its oldest buffered entry every cycle, so writes in a cycle that does not fill the buffer are written in the same cycle.
+ * - Reads forward from the youngest buffered write to the same address, including writes accepted in the same cycle, so a read always sees every write acknowledged before or with it. This requires isSF.
+ * - With IsSPRAM, a buffered write waits while a read uses its bank unless the buffer is full, so reads are no longer dropped for writes that the buffer can hold.
+ *
+ * \par Statistics
+ * - In C++ simulation run() updates the public member stats (match::Stats). The counters compile out under __SYNTHESIS__.
+ * - Per bank: bank_reads_<i>, bank_writes_<i>, bank_idle_<i>, and read_conflicts_<i>/write_conflicts_<i>, the number of requests that lost arbitration for the bank.
+ * - Per port: read_stalls_<p>/write_stalls_<p>, cycles with a valid request that was not acknowledged.
+ * - Per port histograms read_wait_<p>_hist_<n>/write_wait_<p>_hist_<n>: number of requests acknowledged after waiting n cycles, i.e. the occupancy of the request slot of the port.
+ * - spram_read_drops counts reads dropped in favor of a write to the same single-port bank.
+ * - forwarded_reads counts reads served from a write to the same address in the same cycle (isSF), buffer_forwarded_reads reads served from the write buffer, and write_buffer_occupancy_<i>_hist_<n> samples the write buffer occupancy of each bank.
  *
  * \par A Simple Example
  * \code
@@ -55,8 +71,10 @@
  */
 
 template<unsigned int kNumBanks, unsigned int kNumReadPorts,unsigned int
-kNumWritePorts, unsigned int kEntriesPerBank, typename WordType, bool isSF=true, bool IsSPRAM=false>
+kNumWritePorts, unsigned int kEntriesPerBank, typename WordType, bool isSF=true, bool IsSPRAM=false,
+unsigned int kWriteBufferDepth=0>
 class ArbitratedScratchpadDP {
+  static_assert(kWriteBufferDepth == 0 || isSF, "The write buffer requires store forwarding (isSF)");
 
   static const unsigned int kReadPortIndexSize = nvhls::index_width<kNumReadPorts>::val;
   static const unsigned int kWritePortIndexSize = nvhls::index_width<kNumWritePorts>::val;
@@ -72,6 +90,17 @@ class ArbitratedScratchpadDP {
   typedef NVUINTW(kNumWritePorts) WritePortBitVector;
   typedef bool Ack;
 
+#ifndef __SYNTHESIS__
+  unsigned int read_wait[kNumReadPorts];
+  unsigned int write_wait[kNumWritePorts];
+  // Counters updated every cycle, registered once
+  match::Stats::StatHandle cycles_stat, spram_read_drops_stat, forwarded_reads_stat;
+  match::Stats::StatHandle buffer_forwarded_reads_stat, write_buffer_occupancy_stat;
+  match::Stats::StatHandle bank_reads_stat, bank_writes_stat, bank_idle_stat;
+  match::Stats::StatHandle read_stalls_stat, read_conflicts_stat, read_wait_stat;
+  match::Stats::StatHandle write_stalls_stat, write_conflicts_stat, write_wait_stat;
+#endif
+
 
   class bankwrite_req_t : public nvhls_message {
    public:
@@ -113,6 +142,7 @@ class ArbitratedScratchpadDP {
   mem_array_sep <WordType, kNumBanks * kEntriesPerBank, kNumBanks> banks;
   ArbitratedCrossbar<bankread_req_t, kNumReadPorts, kNumBanks, 0, 0> read_arbxbar;
   ArbitratedCrossbar<bankwrite_req_t, kNumWritePorts, kNumBanks, 0, 0> write_arbxbar;
+  FIFO<bankwrite_req_t, kWriteBufferDepth, kNumBanks> write_buffer;
 
   void compute_bankread_request(Address read_address[kNumReadPorts], bool read_req_valid[kNumReadPorts], 
                             bankread_req_t bankread_req[kNumReadPorts],
@@ -220,7 +250,84 @@ class ArbitratedScratchpadDP {
     }
   }
 
+  // Update the simulation statistics of one call of run()
+  void UpdateStats(bool read_req_valid[kNumReadPorts], BankIndex bankread_sel[kNumReadPorts],
+                   Ack read_ack[kNumReadPorts], bool write_req_valid[kNumWritePorts],
+                   BankIndex bankwrite_sel[kNumWritePorts], Ack write_ack[kNumWritePorts],
+                   bool bankread_req_winner_valid[kNumBanks],
+                   bool bankwrite_req_winner_valid[kNumBanks], unsigned int spram_drops,
+                   unsigned int forwards, unsigned int buffer_forwards) {
+#ifndef __SYNTHESIS__
+    stats.IncrStat(cycles_stat);
+    stats.IncrStat(spram_read_drops_stat, spram_drops);
+    stats.IncrStat(forwarded_reads_stat, forwards);
+    stats.IncrStat(buffer_forwarded_reads_stat, buffer_forwards);
+    if (kWriteBufferDepth > 0) {
+      for (unsigned bank = 0; bank < kNumBanks; bank++) {
+        stats.IncrStatHistogram(write_buffer_occupancy_stat, bank, write_buffer.NumFilled(bank).to_uint());
+      }
+    }
+    for (unsigned bank = 0; bank < kNumBanks; bank++) {
+      if (bankread_req_winner_valid[bank]) {
+        stats.IncrStatIndexed(bank_reads_stat, bank);
+      }
+      if (bankwrite_req_winner_valid[bank]) {
+        stats.IncrStatIndexed(bank_writes_stat, bank);
+      }
+      if (!bankread_req_winner_valid[bank] && !bankwrite_req_winner_valid[bank]) {
+        stats.IncrStatIndexed(bank_idle_stat, bank);
+      }
+    }
+    for (unsigned i = 0; i < kNumReadPorts; i++) {
+      if (read_req_valid[i] && !read_ack[i]) {
+        stats.IncrStatIndexed(read_stalls_stat, i);
+        stats.IncrStatIndexed(read_conflicts_stat, bankread_sel[i].to_uint());
+        read_wait[i]++;
+      } else if (read_req_valid[i]) {
+        stats.IncrStatHistogram(read_wait_stat, i, read_wait[i]);
+        read_wait[i] = 0;
+      }
+    }
+    for (unsigned i = 0; i < kNumWritePorts; i++) {
+      if (write_req_valid[i] && !write_ack[i]) {
+        stats.IncrStatIndexed(write_stalls_stat, i);
+        stats.IncrStatIndexed(write_conflicts_stat, bankwrite_sel[i].to_uint());
+        write_wait[i]++;
+      } else if (write_req_valid[i]) {
+        stats.IncrStatHistogram(write_wait_stat, i, write_wait[i]);
+        write_wait[i] = 0;
+      }
+    }
+#endif
+  }
+
   public:
+  match::Stats stats;
+
+  ArbitratedScratchpadDP() {
+#ifndef __SYNTHESIS__
+    cycles_stat = stats.RegisterStat("cycles");
+    spram_read_drops_stat = stats.RegisterStat("spram_read_drops");
+    forwarded_reads_stat = stats.RegisterStat("forwarded_reads");
+    buffer_forwarded_reads_stat = stats.RegisterStat("buffer_forwarded_reads");
+    write_buffer_occupancy_stat = stats.RegisterStatHistogram("write_buffer_occupancy", kNumBanks);
+    bank_reads_stat = stats.RegisterStatIndexed("bank_reads", kNumBanks);
+    bank_writes_stat = stats.RegisterStatIndexed("bank_writes", kNumBanks);
+    bank_idle_stat = stats.RegisterStatIndexed("bank_idle", kNumBanks);
+    read_stalls_stat = stats.RegisterStatIndexed("read_stalls", kNumReadPorts);
+    read_conflicts_stat = stats.RegisterStatIndexed("read_conflicts", kNumBanks);
+    read_wait_stat = stats.RegisterStatHistogram("read_wait", kNumReadPorts);
+    write_stalls_stat = stats.RegisterStatIndexed("write_stalls", kNumWritePorts);
+    write_conflicts_stat = stats.RegisterStatIndexed("write_conflicts", kNumBanks);
+    write_wait_stat = stats.RegisterStatHistogram("write_wait", kNumWritePorts);
+    for (unsigned i = 0; i < kNumReadPorts; i++) {
+      read_wait[i] = 0;
+    }
+    for (unsigned i = 0; i < kNumWritePorts; i++) {
+      write_wait[i] = 0;
+    }
+#endif
+  }
 
   // Helper Functions
   BankIndex GetBankIndex(Address a) {
@@ -245,6 +352,7 @@ class ArbitratedScratchpadDP {
      "CTC SKIP";
    #endif
     banks.reset();
+    write_buffer.reset();
    #ifdef COV_ENABLE
      "CTC ENDSKIP";
    #endif
@@ -311,21 +419,60 @@ class ArbitratedScratchpadDP {
     bool bankwrite_req_winner_valid[kNumBanks];
     bool write_ready[kNumWritePorts];
     WritePortIndex write_source[kNumBanks];
-    write_arbxbar.run(bankwrite_req, bankwrite_sel, bankwrite_req_valid, bankwrite_req_winner,
-                     bankwrite_req_winner_valid, write_ready, write_source);
+    if (kWriteBufferDepth == 0) {
+      write_arbxbar.run(bankwrite_req, bankwrite_sel, bankwrite_req_valid, bankwrite_req_winner,
+                       bankwrite_req_winner_valid, write_ready, write_source);
+    } else {
+      // Accept writes into the buffer of their bank in port order, then offer
+      // the oldest entry of every bank
+      #pragma hls_unroll yes
+      for (unsigned int i = 0; i < kNumWritePorts; i++) {
+        write_ready[i] = !write_buffer.isFull(bankwrite_sel[i]);
+        if (bankwrite_req_valid[i] && write_ready[i]) {
+          write_buffer.push(bankwrite_req[i], bankwrite_sel[i]);
+        }
+      }
+      #pragma hls_unroll yes
+      for (unsigned bank = 0; bank < kNumBanks; bank++) {
+        bankwrite_req_winner_valid[bank] = !write_buffer.isEmpty(bank);
+        if (bankwrite_req_winner_valid[bank]) {
+          bankwrite_req_winner[bank] = write_buffer.peek(bank);
+        }
+      }
+    }
 
     #pragma unroll yes
     for (unsigned int i=0; i < kNumWritePorts; i++)
       write_ack[i] = write_ready[i] && write_req_valid[i];
+    unsigned int spram_drops = 0;
     if (IsSPRAM) {
     #pragma unroll yes
     for (unsigned bank = 0; bank < kNumBanks; bank++) {
       if (bankread_req_winner_valid[bank] && bankwrite_req_winner_valid[bank]) {
-        bankread_req_winner_valid[bank] = false;
-        read_ack[read_source[bank]] = false;
+        if (kWriteBufferDepth > 0 && !write_buffer.isFull(bank)) {
+          // The buffered write waits for a cycle without a read
+          bankwrite_req_winner_valid[bank] = false;
+        } else {
+          bankread_req_winner_valid[bank] = false;
+          read_ack[read_source[bank]] = false;
+          spram_drops++;
+        }
       }
     }
     }
+
+    unsigned int forwards = 0;
+    #pragma hls_unroll yes
+    for (unsigned bank = 0; bank < kNumBanks; bank++) {
+      if (kWriteBufferDepth > 0 && bankwrite_req_winner_valid[bank]) {
+        write_buffer.incrHead(bank);
+      }
+      if (isSF && !IsSPRAM && bankread_req_winner_valid[bank] && bankwrite_req_winner_valid[bank] &&
+          (bankread_req_winner[bank].localindex == bankwrite_req_winner[bank].localindex)) {
+        forwards++;
+      }
+    }
+
     bankread_rsp_t bankread_rsp[kNumBanks];
     banks_load_store(bankread_req_winner, 
                      bankread_req_winner_valid,
@@ -333,6 +480,33 @@ class ArbitratedScratchpadDP {
                      bankwrite_req_winner_valid,
                      bankread_rsp, valid_entry); 
 
+    // Reads see the youngest write still in the buffer of their bank
+    unsigned int buffer_forwards = 0;
+    if (kWriteBufferDepth > 0) {
+      #pragma hls_unroll yes
+      for (unsigned bank = 0; bank < kNumBanks; bank++) {
+        if (bankread_req_winner_valid[bank]) {
+          bool hit = false;
+          #pragma hls_unroll yes
+          for (unsigned int e = 0; e < kWriteBufferDepth; e++) {
+            if (e < write_buffer.NumFilled(bank)) {
+              bankwrite_req_t entry = write_buffer.peekAt(e, bank);
+              if (entry.localindex == bankread_req_winner[bank].localindex) {
+                bankread_rsp[bank].rdata = entry.data;
+                hit = true;
+              }
+            }
+          }
+          if (hit) {
+            buffer_forwards++;
+          }
+        }
+      }
+    }
+    UpdateStats(read_req_valid, bankread_sel, read_ack, write_req_valid,
+                bankwrite_sel, write_ack, bankread_req_winner_valid,
+                bankwrite_req_winner_valid, spram_drops, forwards, buffer_forwards);
+
     // Prepare the inputs for response crossbar
     WordType   bank_read_out[kNumBanks];
     bool       bank_read_out_valid[kNumBanks];
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CAM_H
+#define CAM_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_assert.h>
+#include <nvhls_message.h>
+#include <TypeToBits.h>
+#include <comptrees.h>
+#if !defined(__SYNTHESIS__) && !defined(CAM_SIM_USE_COMPARE)
+#include <set>
+#include <unordered_map>
+#endif
+
+/**
+ * \brief Replacement policies of CAM
+ * \ingroup CAM
+ *
+ * A new key goes into the lowest invalid entry. Only when all entries are valid does the policy pick the entry to evict:
+ * - CamRoundRobin: a pointer that advances by one entry on every eviction, so entries are evicted in the order they were filled.
+ * - CamPseudoLRU: tree pseudo-LRU over lookup hits and writes, like the ways of AxiCache. Entries must be a power of 2.
+ * - CamRandom: the low bits of a 16-bit LFSR that advances on every eviction.
+ */
+enum cam_replacement { CamRoundRobin, CamPseudoLRU, CamRandom };
+
+/**
+ * \brief Content-addressable memory with parallel match
+ * \ingroup CAM
+ *
+ * \tparam Key              Type of the keys
+ * \tparam Value            Type of the values
+ * \tparam Entries          Number of entries
+ * \tparam Replacement      Replacement policy, see cam_replacement (default: CamPseudoLRU)
+ *
+ * \par Overview
+ * - Keys, values and valid bits are registers. lookup() compares the key with all entries in parallel and reduces the match vector with a PriEncTree, so the select logic is log2(Entries) deep. A key is in at most one entry: write() of a present key updates its value in place.
+ * - Every call is one access of one cycle; lookup(), write() and invalidate() each update the replacement state as described in cam_replacement.
+ * - C++ simulation keeps a hash map from key to entry and a set of the invalid entries next to the registers, so an access costs O(log Entries) instead of Entries compares. The results are the same, including the replacement decisions. Define CAM_SIM_USE_COMPARE to simulate the parallel compare instead. The hash map is only used for keys of at most 64 bits.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <CAM.h>
+ *
+ *      ...
+ *      typedef CAM<NVUINT20, NVUINT32, 64> tlb_t;
+ *      tlb_t tlb;
+ *      ...
+ *      NVUINT32 frame;
+ *      tlb_t::Index index;
+ *      if (!tlb.lookup(page, frame, index)) {
+ *        NVUINT20 old_page;
+ *        NVUINT32 old_frame;
+ *        tlb.write(page, walked_frame, index, old_page, old_frame);
+ *      }
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename Key, typename Value, unsigned int Entries,
+          cam_replacement Replacement = CamPseudoLRU>
+class CAM {
+  static_assert(Replacement != CamPseudoLRU || (Entries & (Entries - 1)) == 0,
+                "CamPseudoLRU needs a power of 2 Entries");
+
+ public:
+  static const int log_entries = nvhls::index_width<Entries>::val;
+  typedef NVUINTW(log_entries) Index;
+  typedef NVUINTW(Entries) EntryMask;  // one bit per entry
+
+ private:
+  typedef NVINTW(log_entries + 1) PriEncIdx;
+  static const int plru_levels = nvhls::log2_ceil<Entries>::val;
+  static const int PlruBits = (Entries > 1) ? Entries - 1 : 1;
+  typedef NVUINTW(PlruBits) Plru;
+
+  Key keys[Entries];
+  Value values[Entries];
+  EntryMask valid;
+  Index rr_ptr;
+  Plru plru;
+  NVUINTW(16) lfsr;
+
+#if !defined(__SYNTHESIS__) && !defined(CAM_SIM_USE_COMPARE)
+  static const bool use_hash = (Wrapped<Key>::width <= 64);
+  std::unordered_map<unsigned long long, unsigned int> index_of;
+  std::set<unsigned int> free_entries;
+
+  static unsigned long long hash_key(const Key& key) {
+    return TypeToNVUINT(key).to_uint64();
+  }
+#endif
+
+ public:
+  CAM() { reset(); }
+
+  // Invalidates all entries
+  void reset() {
+    valid = 0;
+    rr_ptr = 0;
+    plru = 0;
+    lfsr = 1;
+#if !defined(__SYNTHESIS__) && !defined(CAM_SIM_USE_COMPARE)
+    index_of.clear();
+    free_entries.clear();
+    for (unsigned i = 0; i < Entries; i++) {
+      free_entries.insert(i);
+    }
+#endif
+  }
+
+  bool isFull() { return valid == static_cast<EntryMask>(~EntryMask(0)); }
+
+  EntryMask ValidEntries() { return valid; }
+
+  // One bit per valid entry that holds key
+  EntryMask match(const Key& key) {
+    EntryMask hits = 0;
+    #pragma hls_unroll yes
+    for (unsigned i = 0; i < Entries; i++) {
+      hits[i] = (valid[i] == 1) && (keys[i] == key);
+    }
+    return hits;
+  }
+
+  // Finds key; on a hit returns true with its value and entry and marks the
+  // entry as used
+  bool lookup(const Key& key, Value& value, Index& index) {
+    bool hit = find(key, index);
+    if (hit) {
+      value = values[index];
+      touch(index);
+    }
+    return hit;
+  }
+
+  // Stores value under key: in place if key is present, else into the lowest
+  // invalid entry or the victim of the replacement policy, and returns the
+  // entry in index. Returns true if a valid entry of another key was evicted,
+  // with its key and value.
+  bool write(const Key& key, const Value& value, Index& index, Key& evicted_key,
+             Value& evicted_value) {
+    bool evicted = false;
+    if (!find(key, index)) {
+      PriEncIdx first_free = -1;
+#if !defined(__SYNTHESIS__) && !defined(CAM_SIM_USE_COMPARE)
+      if (use_hash) {
+        if (!free_entries.empty()) {
+          first_free = *free_entries.begin();
+        }
+      } else
+#endif
+      {
+        first_free = PriEncTree<EntryMask, bool, PriEncIdx, Entries>::val(valid, 0);
+      }
+      if (first_free != -1) {
+        index = first_free.to_uint();
+      } else {
+        index = victim();
+        evicted = true;
+        evicted_key = keys[index];
+        evicted_value = values[index];
+      }
+      set_entry(index, key);
+    }
+    values[index] = value;
+    touch(index);
+    return evicted;
+  }
+
+  // Removes key; returns true if it was present
+  bool invalidate(const Key& key) {
+    Index index;
+    bool hit = find(key, index);
+    if (hit) {
+      valid[index] = 0;
+#if !defined(__SYNTHESIS__) && !defined(CAM_SIM_USE_COMPARE)
+      if (use_hash) {
+        index_of.erase(hash_key(key));
+        free_entries.insert(index.to_uint());
+      }
+#endif
+    }
+    return hit;
+  }
+
+ private:
+  bool find(const Key& key, Index& index) {
+#if !defined(__SYNTHESIS__) && !defined(CAM_SIM_USE_COMPARE)
+    if (use_hash) {
+      typename std::unordered_map<unsigned long long, unsigned int>::iterator it =
+          index_of.find(hash_key(key));
+      if (it == index_of.end()) {
+        return false;
+      }
+      index = it->second;
+      return true;
+    }
+#endif
+    PriEncIdx first = PriEncTree<EntryMask, bool, PriEncIdx, Entries>::val(match(key), 1);
+    index = (first == -1) ? Index(0) : Index(first.to_uint());
+    return first != -1;
+  }
+
+  void set_entry(Index index, const Key& key) {
+#if !defined(__SYNTHESIS__) && !defined(CAM_SIM_USE_COMPARE)
+    if (use_hash) {
+      if (valid[index] == 1) {
+        index_of.erase(hash_key(keys[index]));
+      }
+      index_of[hash_key(key)] = index.to_uint();
+      free_entries.erase(index.to_uint());
+    }
+#endif
+    keys[index] = key;
+    valid[index] = 1;
+  }
+
+  Index victim() {
+    Index index = 0;
+    if (Replacement == CamRoundRobin) {
+      index = rr_ptr;
+      rr_ptr = (rr_ptr == Entries - 1) ? Index(0) : Index(rr_ptr + 1);
+    } else if (Replacement == CamPseudoLRU) {
+      // Bit 0 of a node points to the lower half as the next victim
+      unsigned int node = 0;
+      #pragma hls_unroll yes
+      for (int l = 0; l < plru_levels; l++) {
+        unsigned int upper = (plru[node] == 1) ? 1 : 0;
+        index[plru_levels - 1 - l] = upper;
+        node = 2 * node + 1 + upper;
+      }
+    } else {
+      // x^16 + x^14 + x^13 + x^11 + 1, Galois form
+      bool out = (lfsr[0] == 1);
+      lfsr >>= 1;
+      if (out) {
+        lfsr ^= 0xB400;
+      }
+      unsigned int low = nvhls::get_slc<log_entries>(lfsr, 0).to_uint();
+      index = (low >= Entries) ? low - Entries : low;
+    }
+    return index;
+  }
+
+  // Points the pseudo-LRU tree away from index
+  void touch(Index index) {
+    if (Replacement == CamPseudoLRU) {
+      unsigned int node = 0;
+      #pragma hls_unroll yes
+      for (int l = plru_levels - 1; l >= 0; l--) {
+        unsigned int upper = (index[l] == 1) ? 1 : 0;
+        plru[node] = upper ? 0 : 1;
+        node = 2 * node + 1 + upper;
+      }
+    }
+  }
+};
+
+#endif  // CAM_H
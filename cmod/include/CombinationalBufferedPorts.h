@@ -22,35 +22,41 @@
 #define COMBINATIONAL_BUFFERED_PORTS_H_
 
 #include <nvhls_connections.h>
+#include <nvhls_connections_direct.h>
 
 namespace Connections {
 
-  template <typename Message, int BufferSizeRead = 1, int BufferSizeWrite = 1>
-  class CombinationalBufferedPorts : public Combinational<Message> {
+  // Channel is the channel the buffers are built on, Combinational or with
+  // NVHLS_DIRECT_COMBINATIONAL the DirectCombinational of
+  // nvhls_connections_direct.h, which hands messages over without delta
+  // cycles in fast simulation
+  template <typename Message, int BufferSizeRead = 1, int BufferSizeWrite = 1,
+            typename Channel = typename CombinationalSel<Message>::chan_t>
+  class CombinationalBufferedPorts : public Channel {
     typedef NVUINTW(nvhls::index_width<BufferSizeWrite+1>::val) AddressPlusOne;
     FIFO<Message, BufferSizeRead> fifo_read;
     FIFO<Message, BufferSizeWrite> fifo_write;
 
   public:
     CombinationalBufferedPorts()
-      : Combinational<Message>(),
+      : Channel(),
       fifo_read(),
       fifo_write()
     {}
     
     explicit CombinationalBufferedPorts(const char* name)
-      : Combinational<Message>(name),
+      : Channel(name),
       fifo_read(),
       fifo_write()
     {}
     
     void ResetRead() {
-      Combinational<Message>::ResetRead();
+      Channel::ResetRead();
       fifo_read.reset();
     }
 
     void ResetWrite() {
-      Combinational<Message>::ResetWrite();
+      Channel::ResetWrite();
       fifo_write.reset();
     }
     
@@ -63,14 +69,64 @@ namespace Connections {
 
     Message PeekRead() { return fifo_read.peek(); }
 
+    // Peek without copying the message in C++ simulation, see FIFO::peekRef()
+    typename FIFO<Message, BufferSizeRead>::PeekRefType PeekReadRef() { return fifo_read.peekRef(); }
+
     void TransferNBRead() {
       if (!fifo_read.isFull()) {
 	Message msg;
-	if (Combinational<Message>::PopNB(msg)) {
+	if (Channel::PopNB(msg)) {
 	  fifo_read.push(msg);
 	}
       }
     }
+
+    // Burst transfer: move up to max_msgs messages from the channel into
+    // fifo_read, stopping at the first empty PopNB.
+    // Returns the number of messages moved.
+    unsigned int TransferNBRead(unsigned int max_msgs) {
+      unsigned int moved = 0;
+#pragma hls_unroll yes
+      for (unsigned int i = 0; i < BufferSizeRead; i++) {
+	if (moved == i && i < max_msgs && !fifo_read.isFull()) {
+	  Message msg;
+	  if (Channel::PopNB(msg)) {
+	    fifo_read.push(msg);
+	    moved++;
+	  }
+	}
+      }
+      return moved;
+    }
+
+    unsigned int TransferNBReadAll() { return TransferNBRead(BufferSizeRead); }
+
+    // Number of messages in fifo_read
+    unsigned int NumFilledRead() { return fifo_read.NumFilled(); }
+
+    // Peek the idx-th oldest message of fifo_read
+    Message PeekRead(unsigned int idx) { return fifo_read.peekAt(idx); }
+
+    // Peek the N oldest messages, or as many as there are. Returns the count.
+    template <unsigned int N>
+    unsigned int PeekNRead(Message (&msgs)[N]) {
+      unsigned int num = NumFilledRead();
+      if (num > N) num = N;
+#pragma hls_unroll yes
+      for (unsigned int i = 0; i < N; i++) {
+	if (i < num) msgs[i] = fifo_read.peekAt(i);
+      }
+      return num;
+    }
+
+    // Pop the n oldest messages
+    void PopN(unsigned int n) {
+      NVHLS_ASSERT_MSG(n <= NumFilledRead(), "Popping more messages than buffered");
+#pragma hls_unroll yes
+      for (unsigned int i = 0; i < BufferSizeRead; i++) {
+	if (i < n) fifo_read.incrHead();
+      }
+    }
     
     // Full
     bool FullWrite() { return fifo_write.isFull(); }
@@ -83,36 +139,64 @@ namespace Connections {
 
     void TransferNBWrite() {
       if (!fifo_write.isEmpty()) {
-	Message msg = fifo_write.peek();
-	if (Combinational<Message>::PushNB(msg)) {
+	if (Channel::PushNB(fifo_write.peekRef())) {
 	  fifo_write.pop();
 	}
       }
     }
 
+    // Burst transfer: move up to max_msgs messages from fifo_write into the
+    // channel, stopping at the first failed PushNB.
+    // Returns the number of messages moved.
+    unsigned int TransferNBWrite(unsigned int max_msgs) {
+      unsigned int moved = 0;
+#pragma hls_unroll yes
+      for (unsigned int i = 0; i < BufferSizeWrite; i++) {
+	if (moved == i && i < max_msgs && !fifo_write.isEmpty()) {
+	  if (Channel::PushNB(fifo_write.peekRef())) {
+	    fifo_write.pop();
+	    moved++;
+	  }
+	}
+      }
+      return moved;
+    }
+
+    unsigned int TransferNBWriteAll() { return TransferNBWrite(BufferSizeWrite); }
+
+    // Push the first n of msgs, which must fit into fifo_write
+    template <unsigned int N>
+    void PushN(const Message (&msgs)[N], unsigned int n) {
+      NVHLS_ASSERT_MSG(n <= N && n <= NumAvailableWrite(), "Pushing more messages than fit");
+#pragma hls_unroll yes
+      for (unsigned int i = 0; i < N; i++) {
+	if (i < n) fifo_write.push(msgs[i]);
+      }
+    }
+
     // Overload these so we don't accidently call them
     virtual bool PopNB(Message& data) { NVHLS_ASSERT_MSG(0,"Calling PopNB on Buffered port is not valid"); return false; }
     virtual bool PushNB(const Message& m) { NVHLS_ASSERT_MSG(0,"Calling PushNB on Buffered port is not valid"); return false; }
   };
 
 
-  template <typename Message, int BufferSizeRead>
-  class CombinationalBufferedPorts <Message,BufferSizeRead,0> : public Combinational<Message> {
+  template <typename Message, int BufferSizeRead, typename Channel>
+  class CombinationalBufferedPorts <Message,BufferSizeRead,0,Channel> : public Channel {
     FIFO<Message, BufferSizeRead> fifo_read;
 
   public:
     CombinationalBufferedPorts()
-      : Combinational<Message>(),
+      : Channel(),
       fifo_read()
     {}
     
     explicit CombinationalBufferedPorts(const char* name)
-      : Combinational<Message>(name),
+      : Channel(name),
       fifo_read()
     {}
 
     void ResetRead() {
-      Combinational<Message>::ResetRead();
+      Channel::ResetRead();
       fifo_read.reset();
     }
 
@@ -125,37 +209,87 @@ namespace Connections {
 
     Message PeekRead() { return fifo_read.peek(); }
 
+    // Peek without copying the message in C++ simulation, see FIFO::peekRef()
+    typename FIFO<Message, BufferSizeRead>::PeekRefType PeekReadRef() { return fifo_read.peekRef(); }
+
     void TransferNBRead() {
       if (!fifo_read.isFull()) {
 	Message msg;
-	if (Combinational<Message>::PopNB(msg)) {
+	if (Channel::PopNB(msg)) {
 	  fifo_read.push(msg);
 	}
       }
     }
+
+    // Burst transfer: move up to max_msgs messages from the channel into
+    // fifo_read, stopping at the first empty PopNB.
+    // Returns the number of messages moved.
+    unsigned int TransferNBRead(unsigned int max_msgs) {
+      unsigned int moved = 0;
+#pragma hls_unroll yes
+      for (unsigned int i = 0; i < BufferSizeRead; i++) {
+	if (moved == i && i < max_msgs && !fifo_read.isFull()) {
+	  Message msg;
+	  if (Channel::PopNB(msg)) {
+	    fifo_read.push(msg);
+	    moved++;
+	  }
+	}
+      }
+      return moved;
+    }
+
+    unsigned int TransferNBReadAll() { return TransferNBRead(BufferSizeRead); }
+
+    // Number of messages in fifo_read
+    unsigned int NumFilledRead() { return fifo_read.NumFilled(); }
+
+    // Peek the idx-th oldest message of fifo_read
+    Message PeekRead(unsigned int idx) { return fifo_read.peekAt(idx); }
+
+    // Peek the N oldest messages, or as many as there are. Returns the count.
+    template <unsigned int N>
+    unsigned int PeekNRead(Message (&msgs)[N]) {
+      unsigned int num = NumFilledRead();
+      if (num > N) num = N;
+#pragma hls_unroll yes
+      for (unsigned int i = 0; i < N; i++) {
+	if (i < num) msgs[i] = fifo_read.peekAt(i);
+      }
+      return num;
+    }
+
+    // Pop the n oldest messages
+    void PopN(unsigned int n) {
+      NVHLS_ASSERT_MSG(n <= NumFilledRead(), "Popping more messages than buffered");
+#pragma hls_unroll yes
+      for (unsigned int i = 0; i < BufferSizeRead; i++) {
+	if (i < n) fifo_read.incrHead();
+      }
+    }
     
     // Overload these so we don't accidently call them
     virtual bool PopNB(Message& data) { NVHLS_ASSERT_MSG(0,"Calling PopNB on Buffered port is not valid"); return false; }
   };
   
-  template <typename Message, int BufferSizeWrite>
-  class CombinationalBufferedPorts<Message,0,BufferSizeWrite> : public Combinational<Message> {
+  template <typename Message, int BufferSizeWrite, typename Channel>
+  class CombinationalBufferedPorts<Message,0,BufferSizeWrite,Channel> : public Channel {
     typedef NVUINTW(nvhls::index_width<BufferSizeWrite+1>::val) AddressPlusOne;
     FIFO<Message, BufferSizeWrite> fifo_write;
 
   public:
     CombinationalBufferedPorts()
-      : Combinational<Message>(),
+      : Channel(),
       fifo_write()
     {}
     
     explicit CombinationalBufferedPorts(const char* name)
-      : Combinational<Message>(name),
+      : Channel(name),
       fifo_write()
     {}
 
     void ResetWrite() {
-      Combinational<Message>::ResetWrite();
+      Channel::ResetWrite();
       fifo_write.reset();
     }
     
@@ -170,13 +304,41 @@ namespace Connections {
 
     void TransferNBWrite() {
       if (!fifo_write.isEmpty()) {
-	Message msg = fifo_write.peek();
-	if (Combinational<Message>::PushNB(msg)) {
+	if (Channel::PushNB(fifo_write.peekRef())) {
 	  fifo_write.pop();
 	}
       }
     }
 
+    // Burst transfer: move up to max_msgs messages from fifo_write into the
+    // channel, stopping at the first failed PushNB.
+    // Returns the number of messages moved.
+    unsigned int TransferNBWrite(unsigned int max_msgs) {
+      unsigned int moved = 0;
+#pragma hls_unroll yes
+      for (unsigned int i = 0; i < BufferSizeWrite; i++) {
+	if (moved == i && i < max_msgs && !fifo_write.isEmpty()) {
+	  if (Channel::PushNB(fifo_write.peekRef())) {
+	    fifo_write.pop();
+	    moved++;
+	  }
+	}
+      }
+      return moved;
+    }
+
+    unsigned int TransferNBWriteAll() { return TransferNBWrite(BufferSizeWrite); }
+
+    // Push the first n of msgs, which must fit into fifo_write
+    template <unsigned int N>
+    void PushN(const Message (&msgs)[N], unsigned int n) {
+      NVHLS_ASSERT_MSG(n <= N && n <= NumAvailableWrite(), "Pushing more messages than fit");
+#pragma hls_unroll yes
+      for (unsigned int i = 0; i < N; i++) {
+	if (i < n) fifo_write.push(msgs[i]);
+      }
+    }
+
     // Overload these so we don't accidently call them
     virtual bool PushNB(const Message& m) { NVHLS_ASSERT_MSG(0,"Calling PushNB on Buffered port is not valid"); return false; }
   };
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DOUBLE_BUFFERED_SCRATCHPAD_H
+#define DOUBLE_BUFFERED_SCRATCHPAD_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <ArbitratedScratchpad.h>
+
+/**
+ * \brief Ping-pong pair of scratchpads with a producer and a consumer side
+ * \ingroup ArbitratedScratchpad
+ *
+ * \tparam DataType             DataType of an entry
+ * \tparam CapacityInBytes      Capacity of each of the two buffers
+ * \tparam NumProducerPorts     Number of producer (e.g. DMA) lanes
+ * \tparam NumConsumerPorts     Number of consumer (e.g. compute) lanes
+ * \tparam NumBanks             Number of banks of each buffer
+ * \tparam InputQueueLen        Length of the input queues of each buffer
+ * \tparam ArbiterType          Arbitration of bank conflicts within one side (default: Roundrobin)
+ *
+ * \par Overview
+ * - The component holds two ArbitratedScratchpad buffers. At any time one of them belongs to the producer side and the other one to the consumer side, so the two sides never arbitrate against each other; bank conflicts are only arbitrated among the lanes of one side.
+ * - Both sides can load and store with the cli_req_t/cli_rsp_t interface of ArbitratedScratchpad, with addresses local to a buffer.
+ * - Swap handshake: a side raises its done flag once it has issued every request for the current tile and keeps it raised. The buffers swap at the end of the first cycle in which both flags are set and all accepted requests of both buffers have completed; run() reports that cycle through swapped, after which both sides start the next tile. ProducerBuffer() gives the index of the buffer the producer side currently owns.
+ *
+ * \par Statistics
+ * - In C++ simulation the component counts swaps and the cycles in which one side was done and waited for the other one (producer_wait, consumer_wait). DumpStats() prints them along with the statistics of both buffers.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <DoubleBufferedScratchpad.h>
+ *
+ *      ...
+ *      DoubleBufferedScratchpad<DataType, TileBytes, kDmaLanes, kComputeLanes, kBanks, kQueueLen> tiles;
+ *      ...
+ *      tiles.run(dma_req, dma_rsp, dma_ready, dma_done,
+ *                compute_req, compute_rsp, compute_ready, compute_done, swapped);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename DataType, unsigned int CapacityInBytes,
+          unsigned int NumProducerPorts, unsigned int NumConsumerPorts,
+          unsigned int NumBanks, unsigned int InputQueueLen,
+          arbiter_type ArbiterType = Roundrobin>
+class DoubleBufferedScratchpad {
+ public:
+  static const unsigned int NumPorts =
+      (NumProducerPorts > NumConsumerPorts) ? NumProducerPorts : NumConsumerPorts;
+
+  typedef ArbitratedScratchpad<DataType, CapacityInBytes, NumPorts, NumBanks,
+                               InputQueueLen, ArbiterType> buffer_t;
+  static const int addr_width = buffer_t::addr_width;
+
+  typedef cli_req_t<DataType, addr_width, NumProducerPorts> producer_req_t;
+  typedef cli_rsp_t<DataType, NumProducerPorts> producer_rsp_t;
+  typedef cli_req_t<DataType, addr_width, NumConsumerPorts> consumer_req_t;
+  typedef cli_rsp_t<DataType, NumConsumerPorts> consumer_rsp_t;
+
+  buffer_t buffers[2];
+
+ private:
+  NVUINT1 producer_buf;
+
+#ifndef __SYNTHESIS__
+  unsigned long long stat_swaps;
+  unsigned long long stat_producer_wait;
+  unsigned long long stat_consumer_wait;
+#endif
+
+ public:
+  DoubleBufferedScratchpad() { reset(); }
+
+  void reset() {
+    buffers[0].reset();
+    buffers[1].reset();
+    producer_buf = 0;
+#ifndef __SYNTHESIS__
+    stat_swaps = 0;
+    stat_producer_wait = 0;
+    stat_consumer_wait = 0;
+#endif
+  }
+
+  // Index of the buffer owned by the producer side
+  unsigned ProducerBuffer() { return producer_buf.to_uint(); }
+
+  void run(producer_req_t& producer_req, producer_rsp_t& producer_rsp,
+           bool producer_ready[NumProducerPorts], bool producer_done,
+           consumer_req_t& consumer_req, consumer_rsp_t& consumer_rsp,
+           bool consumer_ready[NumConsumerPorts], bool consumer_done,
+           bool& swapped) {
+    // Steer each side to the buffer it owns; lanes a side does not have
+    // stay invalid
+    typename buffer_t::req_t req[2];
+    #pragma hls_unroll yes
+    for (unsigned b = 0; b < 2; b++) {
+      bool is_producer = (producer_buf == b);
+      req[b].type = is_producer ? producer_req.type : consumer_req.type;
+      #pragma hls_unroll yes
+      for (unsigned i = 0; i < NumPorts; i++) {
+        req[b].valids[i] = false;
+        req[b].addr[i] = 0;
+        req[b].data[i] = 0;
+        if (is_producer && (i < NumProducerPorts)) {
+          req[b].valids[i] = producer_req.valids[i];
+          req[b].addr[i] = producer_req.addr[i];
+          req[b].data[i] = producer_req.data[i];
+        }
+        if (!is_producer && (i < NumConsumerPorts)) {
+          req[b].valids[i] = consumer_req.valids[i];
+          req[b].addr[i] = consumer_req.addr[i];
+          req[b].data[i] = consumer_req.data[i];
+        }
+      }
+    }
+
+    typename buffer_t::rsp_t rsp[2];
+    bool ready[2][NumPorts];
+    #pragma hls_unroll yes
+    for (unsigned b = 0; b < 2; b++) {
+#ifdef HLS_ALGORITHMICC
+      buffers[b].load_store(req[b], rsp[b], ready[b]);
+#else
+      typename buffer_t::bank_req_t bank_req[NumPorts];
+      typename buffer_t::bank_sel_t bank_sel[NumPorts];
+      bool bank_req_valid[NumPorts];
+      #pragma hls_unroll yes
+      for (unsigned i = 0; i < NumPorts; i++) {
+        buffer_t::map_address(req[b].addr[i], bank_sel[i], bank_req[i].addr);
+        bank_req[i].do_store = req[b].valids[i] && (req[b].type.val == CLITYPE_T::STORE);
+        bank_req[i].wdata = req[b].data[i];
+        bank_req[i].input_chan = i;
+        bank_req_valid[i] = req[b].valids[i];
+      }
+      buffers[b].load_store(bank_req, bank_sel, bank_req_valid, rsp[b], ready[b]);
+#endif
+    }
+
+    unsigned pb = producer_buf.to_uint();
+    #pragma hls_unroll yes
+    for (unsigned i = 0; i < NumProducerPorts; i++) {
+      producer_ready[i] = ready[pb][i];
+      producer_rsp.valids[i] = rsp[pb].valids[i];
+      producer_rsp.data[i] = rsp[pb].data[i];
+    }
+    #pragma hls_unroll yes
+    for (unsigned i = 0; i < NumConsumerPorts; i++) {
+      consumer_ready[i] = ready[1 - pb][i];
+      consumer_rsp.valids[i] = rsp[1 - pb].valids[i];
+      consumer_rsp.data[i] = rsp[1 - pb].data[i];
+    }
+
+    swapped = producer_done && consumer_done && buffers[0].isIdle() && buffers[1].isIdle();
+    if (swapped) {
+      producer_buf = 1 - pb;
+    }
+#ifndef __SYNTHESIS__
+    stat_swaps += swapped;
+    stat_producer_wait += (producer_done && !swapped && !consumer_done);
+    stat_consumer_wait += (consumer_done && !swapped && !producer_done);
+#endif
+  }
+
+#ifndef __SYNTHESIS__
+  unsigned long long Swaps() { return stat_swaps; }
+
+  void DumpStats(std::ostream& ofile) {
+    ofile << "swaps: " << stat_swaps << std::endl;
+    ofile << "producer_wait: " << stat_producer_wait << std::endl;
+    ofile << "consumer_wait: " << stat_consumer_wait << std::endl;
+    for (unsigned b = 0; b < 2; b++) {
+      ofile << "buffer " << b << ":" << std::endl;
+      buffers[b].DumpStats(ofile);
+    }
+  }
+#endif
+};
+
+#endif  // DOUBLE_BUFFERED_SCRATCHPAD_H
@@ -0,0 +1,486 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HASH_TABLE_H
+#define HASH_TABLE_H
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_message.h>
+#include <nvhls_assert.h>
+#include <TypeToBits.h>
+#include <mem_array.h>
+#ifndef __SYNTHESIS__
+#include <iostream>
+#endif
+
+/**
+ * \brief Hash functions of a HashTable, each way hashes the key differently
+ * \ingroup HashTable
+ *
+ * - HashTableH3: H3 hashing, bucket = XOR of a fixed random row per set key bit. The rows are constants, so each bucket bit is an XOR tree over about half of the key bits.
+ * - HashTableXorFold: XOR of the log2(Buckets)-bit chunks of the key, chunk j rotated by j * way bits (skewed folding). Only wires and one XOR tree per bucket bit, but keys must be wider than log2(Buckets) bits for the ways to differ.
+ */
+enum hash_table_hash { HashTableH3, HashTableXorFold };
+
+/**
+ * \brief Operations of a HashTable request
+ * \ingroup HashTable
+ *
+ * - HashTableLookup: hit and value of key.
+ * - HashTableInsert: stores value under key; hit if key was present. full if key was not present and the table has no room, in which case nothing changes.
+ * - HashTableRemove: removes key; hit if it was present.
+ */
+enum hash_table_op { HashTableLookup = 0, HashTableInsert = 1, HashTableRemove = 2 };
+
+/**
+ * \brief Request of a HashTable
+ * \ingroup HashTable
+ */
+template <typename Key, typename Value>
+class hash_table_req_t : public nvhls_message {
+ public:
+  NVUINT2 op;
+  Key key;
+  Value value;
+  static const unsigned int width = 2 + Wrapped<Key>::width + Wrapped<Value>::width;
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& op;
+    m& key;
+    m& value;
+  }
+};
+
+/**
+ * \brief Response of a HashTable, one per request in request order
+ * \ingroup HashTable
+ */
+template <typename Value>
+class hash_table_rsp_t : public nvhls_message {
+ public:
+  NVUINT2 op;
+  NVUINT1 hit;
+  NVUINT1 full;
+  Value value;
+  static const unsigned int width = 4 + Wrapped<Value>::width;
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& op;
+    m& hit;
+    m& full;
+    m& value;
+  }
+};
+
+/**
+ * \brief Bucket of a HashTable way
+ * \ingroup HashTable
+ */
+template <typename Key, typename Value>
+class hash_table_entry_t : public nvhls_message {
+ public:
+  NVUINT1 valid;
+  Key key;
+  Value value;
+  static const unsigned int width = 1 + Wrapped<Key>::width + Wrapped<Value>::width;
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& valid;
+    m& key;
+    m& value;
+  }
+};
+
+/**
+ * \brief Cycle-level d-ary cuckoo hash table on mem_array_sep banks
+ * \ingroup HashTable
+ *
+ * \tparam Key              Type of the keys
+ * \tparam Value            Type of the values
+ * \tparam Buckets          Buckets per way, a power of 2
+ * \tparam Ways             Number of ways d >= 2, one mem_array_sep bank each
+ * \tparam Hash             Hash functions, see hash_table_hash (default: HashTableH3)
+ * \tparam MaxKicks         Displacements of one insert before the table counts as full (default: 32)
+ *
+ * \par Overview
+ * - A key can live in bucket hash(key, w) of any way w. Every request reads its bucket of all ways in parallel and compares the keys, so each bank needs one read and one write port, and run() takes one request per call: lookups and removes never stall.
+ * - An insert of a new key takes the first way with a free bucket. If all d buckets are full, it evicts the entry of one way (round robin) into a one-entry stash and completes. The stash is then displaced in the background, one kick per call without an accepted request: the stash entry goes into a free bucket of its own, or evicts the entry of the next way and takes its place. Lookups and removes also check the stash, so every present key is always found.
+ * - New inserts wait while the stash is in use. After MaxKicks kicks the stash stays where it is and the table is full: inserts of new keys return full until a remove makes room, after which displacement resumes.
+ * - reset() invalidates all buckets by writing one bucket of every way per call for Buckets calls, during which run() takes no request (isReady() is false).
+ * - Occupancy() counts the stored keys, including the stash. In C++ simulation the table also counts requests and kicks; LoadFactor(), ProbeDepth() and DumpStats() report them, and ResetStats() clears them.
+ * - Define MEM_ARRAY_SPARSE (mem_array.h) to simulate tables with millions of buckets in memory proportional to the buckets touched.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <HashTable.h>
+ *
+ *      ...
+ *      typedef HashTable<NVUINT32, NVUINT16, 1024, 4> table_t;
+ *      table_t table;
+ *      ...
+ *      table_t::req_t req;
+ *      req.op = HashTableInsert;
+ *      req.key = flow_id;
+ *      req.value = counter;
+ *      bool rsp_valid;
+ *      table_t::rsp_t rsp;
+ *      bool consumed = table.run(true, req, rsp_valid, rsp);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename Key, typename Value, unsigned int Buckets, unsigned int Ways,
+          hash_table_hash Hash = HashTableH3, unsigned int MaxKicks = 32>
+class HashTable {
+  static_assert(Ways >= 2, "HashTable needs at least 2 ways");
+  static_assert(Buckets >= 2 && (Buckets & (Buckets - 1)) == 0,
+                "HashTable Buckets must be a power of 2");
+  static_assert(Buckets <= (1u << 31), "HashTable supports up to 2^31 buckets per way");
+  static_assert(MaxKicks >= 1, "HashTable needs MaxKicks >= 1");
+
+ public:
+  typedef hash_table_req_t<Key, Value> req_t;
+  typedef hash_table_rsp_t<Value> rsp_t;
+  typedef hash_table_entry_t<Key, Value> entry_t;
+  static const unsigned int Entries = Buckets * Ways;
+  static const int BucketBits = nvhls::log2_ceil<Buckets>::val;
+  static const int KeyWidth = Wrapped<Key>::width;
+  typedef NVUINTW(BucketBits) Bucket;
+  typedef NVUINTW(nvhls::index_width<Ways>::val) Way;
+  typedef NVUINTW(nvhls::index_width<Entries + 2>::val) Count;
+
+ private:
+  typedef NVUINTW(nvhls::index_width<MaxKicks + 1>::val) Kicks;
+
+  mem_array_sep<entry_t, Entries, Ways> banks;
+  bool clearing;
+  Bucket clear_bucket;
+  entry_t stash;
+  Way stash_way;        // way the stash entry was evicted from
+  Kicks kicks;          // kicks of the stash entry so far
+  bool stash_stuck;     // MaxKicks reached
+  Way insert_way;       // next way an insert evicts from
+  Count occupancy;
+
+#ifndef __SYNTHESIS__
+  unsigned long long stat_cycles, stat_lookups, stat_hits, stat_inserts, stat_removes;
+  unsigned long long stat_kicks, stat_full, stat_stuck;
+  unsigned int stat_max_kicks;
+#endif
+
+  // Row of the H3 matrix of way for key bit, a constant after unrolling
+  static unsigned int h3_row(unsigned int way, unsigned int bit) {
+    unsigned int x = (way + 1) * 0x9E3779B9u ^ (bit + 1) * 0x85EBCA6Bu;
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+  }
+
+ public:
+  HashTable() { reset(); }
+
+  void reset() {
+    clearing = true;
+    clear_bucket = 0;
+    stash.valid = 0;
+    stash_way = 0;
+    kicks = 0;
+    stash_stuck = false;
+    insert_way = 0;
+    occupancy = 0;
+#ifndef __SYNTHESIS__
+    ResetStats();
+#endif
+  }
+
+  // Bucket of key in way
+  static Bucket hash(const Key& key, unsigned int way) {
+    NVUINTW(KeyWidth) bits = TypeToNVUINT(key);
+    Bucket bucket = 0;
+    #pragma hls_unroll yes
+    for (int i = 0; i < KeyWidth; i++) {
+      if (Hash == HashTableH3) {
+        if (bits[i] == 1) {
+          bucket ^= static_cast<Bucket>(h3_row(way, i));
+        }
+      } else {
+        unsigned int pos = (i % BucketBits + (i / BucketBits) * way) % BucketBits;
+        bucket[pos] = bucket[pos] ^ bits[i];
+      }
+    }
+    return bucket;
+  }
+
+  // False while reset() clears the buckets
+  bool isReady() { return !clearing; }
+
+  // True if no background work is left: clearing or displacing the stash
+  bool isIdle() { return !clearing && (stash.valid == 0 || stash_stuck); }
+
+  Count Occupancy() { return occupancy; }
+
+  // One step. Takes the request if req_valid and returns true, with its
+  // response in rsp; inserts of new keys wait while the stash is displaced.
+  bool run(bool req_valid, const req_t& req, bool& rsp_valid, rsp_t& rsp) {
+    rsp_valid = false;
+#ifndef __SYNTHESIS__
+    stat_cycles++;
+#endif
+    if (clearing) {
+      entry_t empty;
+      empty.valid = 0;
+      empty.key = 0;
+      empty.value = 0;
+      #pragma hls_unroll yes
+      for (unsigned w = 0; w < Ways; w++) {
+        banks.write(clear_bucket, w, empty);
+      }
+      clearing = (clear_bucket != Buckets - 1);
+      clear_bucket++;
+      return false;
+    }
+
+    bool displacing = (stash.valid == 1) && !stash_stuck;
+    bool take = req_valid && !(req.op == HashTableInsert && displacing);
+    if (!take && !displacing) {
+      return false;
+    }
+
+    // Read the key's bucket of every way
+    Key key = take ? req.key : stash.key;
+    Bucket bucket[Ways];
+    entry_t entry[Ways];
+    bool free_found = false, hit_found = false;
+    Way free_way = 0, hit_way = 0;
+    #pragma hls_unroll yes
+    for (unsigned w = 0; w < Ways; w++) {
+      bucket[w] = hash(key, w);
+      entry[w] = banks.read(bucket[w], w);
+      if (entry[w].valid == 0 && !free_found) {
+        free_found = true;
+        free_way = w;
+      }
+      if (entry[w].valid == 1 && entry[w].key == key) {
+        hit_found = true;
+        hit_way = w;
+      }
+    }
+
+    if (!take) {
+      kick(bucket, entry, free_found, free_way);
+      return false;
+    }
+
+    bool stash_hit = (stash.valid == 1) && (stash.key == key);
+    rsp_valid = true;
+    rsp.op = req.op;
+    rsp.hit = hit_found || stash_hit;
+    rsp.full = 0;
+    rsp.value = hit_found ? entry[hit_way].value : stash_hit ? stash.value : Value(0);
+    if (req.op == HashTableInsert) {
+      entry_t update;
+      update.valid = 1;
+      update.key = key;
+      update.value = req.value;
+      if (hit_found) {
+        banks.write(bucket[hit_way], hit_way, update);
+      } else if (stash_hit) {
+        stash.value = req.value;
+      } else if (stash_stuck) {
+        rsp.full = 1;
+#ifndef __SYNTHESIS__
+        stat_full++;
+#endif
+      } else if (free_found) {
+        banks.write(bucket[free_way], free_way, update);
+        occupancy++;
+      } else {
+        // Evict one way into the stash and displace it in the background
+        banks.write(bucket[insert_way], insert_way, update);
+        stash = entry[insert_way];
+        stash_way = insert_way;
+        kicks = 0;
+        insert_way = (insert_way == Ways - 1) ? Way(0) : Way(insert_way + 1);
+        occupancy++;
+      }
+#ifndef __SYNTHESIS__
+      if (!hit_found && !stash_hit && rsp.full == 0) {
+        stat_inserts++;
+      }
+#endif
+    } else if (req.op == HashTableRemove) {
+      if (hit_found) {
+        entry_t empty = entry[hit_way];
+        empty.valid = 0;
+        banks.write(bucket[hit_way], hit_way, empty);
+      } else if (stash_hit) {
+        stash.valid = 0;
+      }
+      if (hit_found || stash_hit) {
+        occupancy--;
+        // The freed bucket may take the stash
+        stash_stuck = false;
+        kicks = 0;
+      }
+#ifndef __SYNTHESIS__
+      stat_removes++;
+#endif
+    }
+#ifndef __SYNTHESIS__
+    if (req.op == HashTableLookup) {
+      stat_lookups++;
+      stat_hits += rsp.hit;
+    }
+#endif
+    return true;
+  }
+
+#ifndef __SYNTHESIS__
+  void ResetStats() {
+    stat_cycles = 0;
+    stat_lookups = 0;
+    stat_hits = 0;
+    stat_inserts = 0;
+    stat_removes = 0;
+    stat_kicks = 0;
+    stat_full = 0;
+    stat_stuck = 0;
+    stat_max_kicks = 0;
+  }
+
+  // Fraction of the buckets that hold a key
+  double LoadFactor() { return occupancy.to_uint64() / static_cast<double>(Entries); }
+
+  // Average kicks per insert of a new key
+  double ProbeDepth() {
+    return (stat_inserts == 0) ? 0.0 : stat_kicks / static_cast<double>(stat_inserts);
+  }
+
+  unsigned int MaxProbeDepth() { return stat_max_kicks; }
+
+  void DumpStats(std::ostream& ofile) {
+    ofile << "cycles: " << stat_cycles << std::endl;
+    ofile << "lookups: " << stat_lookups << " (" << stat_hits << " hits)" << std::endl;
+    ofile << "inserts: " << stat_inserts << ", removes: " << stat_removes << std::endl;
+    ofile << "kicks: " << stat_kicks << ", max per insert: " << stat_max_kicks << std::endl;
+    ofile << "probe depth: " << ProbeDepth() << std::endl;
+    ofile << "full: " << stat_full << " inserts refused, " << stat_stuck
+          << " times out of kicks" << std::endl;
+    ofile << "load factor: " << LoadFactor() << std::endl;
+  }
+#endif
+
+ private:
+  // One displacement of the stash; bucket and entry are its buckets
+  void kick(Bucket bucket[Ways], entry_t entry[Ways], bool free_found, Way free_way) {
+    Way way = free_found ? free_way : Way((stash_way == Ways - 1) ? 0 : stash_way + 1);
+    banks.write(bucket[way], way, stash);
+    kicks++;
+#ifndef __SYNTHESIS__
+    stat_kicks++;
+    if (kicks > stat_max_kicks) {
+      stat_max_kicks = kicks;
+    }
+#endif
+    if (free_found) {
+      stash.valid = 0;
+    } else {
+      stash = entry[way];
+      stash_way = way;
+      if (kicks == MaxKicks) {
+        stash_stuck = true;
+#ifndef __SYNTHESIS__
+        stat_stuck++;
+#endif
+      }
+    }
+  }
+};
+
+/**
+ * \brief HashTable with latency-insensitive request and response ports
+ * \ingroup HashTable
+ *
+ * \par Overview
+ * - Takes one request per cycle and returns its response a cycle later, in order. Displacement runs in the cycles without a request, and while the response port is stalled.
+ * - Template parameters are those of HashTable.
+ *
+ */
+template <typename Key, typename Value, unsigned int Buckets, unsigned int Ways,
+          hash_table_hash Hash = HashTableH3, unsigned int MaxKicks = 32>
+class HashTableModule : public sc_module {
+ public:
+  typedef HashTable<Key, Value, Buckets, Ways, Hash, MaxKicks> core_t;
+  typedef typename core_t::req_t req_t;
+  typedef typename core_t::rsp_t rsp_t;
+
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  Connections::In<req_t> req;
+  Connections::Out<rsp_t> rsp;
+
+  SC_HAS_PROCESS(HashTableModule);
+  HashTableModule(sc_module_name name_)
+      : sc_module(name_), clk("clk"), rst("rst"), req("req"), rsp("rsp") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+ private:
+  void run() {
+    req.Reset();
+    rsp.Reset();
+    core_t core;
+    bool req_held = false, rsp_held = false;
+    req_t req_reg;
+    rsp_t rsp_reg;
+
+    #pragma hls_pipeline_init_interval 1
+    while (1) {
+      wait();
+      if (!req_held) {
+        req_held = req.PopNB(req_reg);
+      }
+      // The core keeps displacing while the response is stalled
+      bool rsp_valid = false;
+      rsp_t rsp_new;
+      if (core.run(req_held && !rsp_held, req_reg, rsp_valid, rsp_new)) {
+        req_held = false;
+      }
+      if (rsp_valid) {
+        rsp_held = true;
+        rsp_reg = rsp_new;
+      }
+      if (rsp_held) {
+        rsp_held = !rsp.PushNB(rsp_reg);
+      }
+    }
+  }
+};
+
+#endif  // HASH_TABLE_H
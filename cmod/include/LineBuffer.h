@@ -0,0 +1,381 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LINE_BUFFER_H
+#define LINE_BUFFER_H
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_message.h>
+#include <nvhls_assert.h>
+#include <mem_array.h>
+
+/**
+ * \brief Boundary handling of a LineBuffer
+ * \ingroup LineBuffer
+ *
+ * - LineBufferValid: only windows that lie inside the frame, (Height - K + 1) x (Width - K + 1) per frame. Window (r, c) has its top left pixel at (r, c).
+ * - LineBufferZero: one window centered on every pixel, Height x Width per frame; pixels outside the frame are 0. K must be odd.
+ * - LineBufferReplicate: as LineBufferZero, but pixels outside the frame repeat the nearest edge pixel.
+ */
+enum line_buffer_padding { LineBufferValid, LineBufferZero, LineBufferReplicate };
+
+/**
+ * \brief Input pixel of a LineBuffer, last marks the last pixel of a frame
+ * \ingroup LineBuffer
+ */
+template <typename T>
+class line_buffer_pixel_t : public nvhls_message {
+ public:
+  T data;
+  NVUINT1 last;
+  static const unsigned int width = Wrapped<T>::width + 1;
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& data;
+    m& last;
+  }
+};
+
+/**
+ * \brief K x K output window of a LineBuffer, last marks the last window of a frame
+ * \ingroup LineBuffer
+ */
+template <typename T, unsigned int K>
+class line_buffer_window_t : public nvhls_message {
+ public:
+  T data[K][K];  // [row][column], row 0 at the top
+  NVUINT1 last;
+  static const unsigned int width = K * K * Wrapped<T>::width + 1;
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    for (unsigned i = 0; i < K; i++) {
+      for (unsigned j = 0; j < K; j++) {
+        m& data[i][j];
+      }
+    }
+    m& last;
+  }
+};
+
+/**
+ * \brief Cycle-level sliding window over a raster-order pixel stream
+ * \ingroup LineBuffer
+ *
+ * \tparam T                Type of a pixel
+ * \tparam Width            Pixels per row of a frame
+ * \tparam K                Window size, K >= 2
+ * \tparam Padding          Boundary handling, see line_buffer_padding (default: LineBufferZero)
+ *
+ * \par Overview
+ * - K - 1 rows are stored in a mem_array_sep with one bank per row, used as a circular buffer. Every step reads one column of all banks, writes the new pixel over the oldest row and shifts the column into a K x K window register.
+ * - run() takes at most one pixel and produces at most one window per call, so a stream at one pixel per cycle gets one window per cycle. Frames may follow each other without a gap; their height is only known from the last flag, and frames must have at least K rows.
+ * - With padding, the window centered on (r, c) is complete K / 2 rows and columns after the pixel: the last K / 2 rows of a frame come out while the next frame streams in. If no pixel of the next frame arrives right after the last pixel, the line buffer flushes the frame on its own for K / 2 * (Width + 1) steps, and accepts no input meanwhile.
+ * - Rows are counted in 16 bits, so a frame has at most 65535 - K rows.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <LineBuffer.h>
+ *
+ *      ...
+ *      LineBufferCore<NVUINT8, 640, 3> lb;
+ *      ...
+ *      bool consumed = lb.run(pixel_valid, pixel, window_valid, window);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename T, unsigned int Width, unsigned int K,
+          line_buffer_padding Padding = LineBufferZero>
+class LineBufferCore {
+  static_assert(K >= 2, "LineBuffer needs K >= 2");
+  static_assert(Width >= K, "LineBuffer rows must be at least K pixels wide");
+  static_assert(Padding == LineBufferValid || (K % 2 == 1), "Padded windows need an odd K");
+
+ public:
+  typedef line_buffer_pixel_t<T> pixel_t;
+  typedef line_buffer_window_t<T, K> window_t;
+  static const unsigned int NumLines = K - 1;
+  // Rows and columns from a window to the pixel that completes it
+  static const unsigned int Lag = (Padding == LineBufferValid) ? K - 1 : K / 2;
+  typedef NVUINTW(nvhls::index_width<Width>::val) Col;
+  typedef NVUINTW(16) Row;
+  typedef NVUINTW(nvhls::index_width<NumLines>::val) Slot;
+
+ private:
+  mem_array_sep<T, Width * NumLines, NumLines> lines;
+  T win[K][K];
+  // Position of the next pixel, relative to the frame of the next window
+  Row in_row;
+  Col in_col;
+  Slot oldest;  // bank of the oldest stored row, overwritten by the current row
+  // Center of the next window (padded modes)
+  Row out_row;
+  Col out_col;
+  bool lagged;          // in is Lag rows and columns past out
+  bool height_valid;    // the last pixel of the frame of out has arrived
+  Row height;
+  bool flushing;
+
+ public:
+  LineBufferCore() {
+#ifndef __SYNTHESIS__
+    lines.clear();
+#endif
+    reset();
+  }
+
+  void reset() {
+    in_row = 0;
+    in_col = 0;
+    oldest = 0;
+    out_row = 0;
+    out_col = 0;
+    lagged = false;
+    height_valid = false;
+    height = 0;
+    flushing = false;
+  }
+
+  // True while the line buffer flushes a frame and takes no input
+  bool isFlushing() { return flushing; }
+
+  // Steps the line buffer with the pixel in if in_valid; returns true if the
+  // pixel was taken
+  bool run(bool in_valid, const pixel_t& in, bool& out_valid, window_t& out) {
+    out_valid = false;
+    // Flush once the last pixel of a frame is in and nothing follows it
+    if (Padding != LineBufferValid && !in_valid && height_valid && in_row == height &&
+        in_col == 0) {
+      flushing = true;
+    }
+    bool take = in_valid && !flushing;
+    if (!take && !flushing) {
+      return false;
+    }
+
+    // New column of the window: the stored rows, oldest first, and the pixel
+    T pixel = take ? in.data : T(0);
+    T column[K];
+    #pragma hls_unroll yes
+    for (unsigned i = 0; i < NumLines; i++) {
+      unsigned slot = oldest + i;
+      if (slot >= NumLines) {
+        slot -= NumLines;
+      }
+      column[i] = lines.read(in_col, slot);
+    }
+    column[K - 1] = pixel;
+    lines.write(in_col, oldest, pixel);
+    #pragma hls_unroll yes
+    for (unsigned i = 0; i < K; i++) {
+      #pragma hls_unroll yes
+      for (unsigned j = 0; j < K - 1; j++) {
+        win[i][j] = win[i][j + 1];
+      }
+      win[i][K - 1] = column[i];
+    }
+
+    bool last_in = take && (in.last == 1);
+    NVHLS_ASSERT_MSG(!last_in || in_col == Width - 1, "Last pixel of a frame before the end of a row");
+    if (Padding == LineBufferValid) {
+      if (in_row >= K - 1 && in_col >= K - 1) {
+        out_valid = true;
+        #pragma hls_unroll yes
+        for (unsigned i = 0; i < K; i++) {
+          #pragma hls_unroll yes
+          for (unsigned j = 0; j < K; j++) {
+            out.data[i][j] = win[i][j];
+          }
+        }
+        out.last = last_in;
+      }
+    } else {
+      lagged = lagged || (in_row == Lag && in_col == Lag);
+      if (lagged) {
+        out_valid = true;
+        pad_window(out);
+        out.last = height_valid && (out_row == height - 1) && (out_col == Width - 1);
+        if (out_col == Width - 1) {
+          out_col = 0;
+          out_row++;
+        } else {
+          out_col++;
+        }
+      }
+    }
+
+    bool row_end = (in_col == Width - 1);
+    if (row_end) {
+      in_col = 0;
+      in_row++;
+      oldest = (oldest == NumLines - 1) ? Slot(0) : Slot(oldest + 1);
+    } else {
+      in_col++;
+    }
+
+    if (Padding == LineBufferValid) {
+      if (last_in) {
+        in_row = 0;
+      }
+    } else {
+      if (last_in) {
+        NVHLS_ASSERT_MSG(!height_valid, "Frame shorter than K / 2 + 1 rows");
+        height = in_row;
+        height_valid = true;
+      }
+      if (out_valid && out.last) {
+        // The frame of out is done, the next window is (0, 0) of the next frame
+        out_row = 0;
+        out_col = 0;
+        height_valid = false;
+        if (flushing) {
+          flushing = false;
+          lagged = false;
+          in_row = 0;
+          in_col = 0;
+        } else {
+          in_row -= height;
+        }
+      }
+    }
+    return take;
+  }
+
+ private:
+  // Window centered on (out_row, out_col) with the pixels outside the frame
+  // filled in
+  void pad_window(window_t& out) {
+    #pragma hls_unroll yes
+    for (unsigned i = 0; i < K; i++) {
+      // Window row of the nearest row inside the frame
+      unsigned ri = i;
+      bool row_out = false;
+      if (out_row + i < Lag) {
+        ri = Lag - out_row;
+        row_out = true;
+      } else if (height_valid && (out_row + i >= height + Lag)) {
+        ri = height + Lag - 1 - out_row;
+        row_out = true;
+      }
+      #pragma hls_unroll yes
+      for (unsigned j = 0; j < K; j++) {
+        unsigned cj = j;
+        bool col_out = false;
+        if (out_col + j < Lag) {
+          cj = Lag - out_col;
+          col_out = true;
+        } else if (out_col + j >= Width + Lag) {
+          cj = Width + Lag - 1 - out_col;
+          col_out = true;
+        }
+        if ((Padding == LineBufferZero) && (row_out || col_out)) {
+          out.data[i][j] = 0;
+        } else {
+          out.data[i][j] = win[ri][cj];
+        }
+      }
+    }
+  }
+};
+
+/**
+ * \brief Sliding-window line buffer with Connections ports
+ * \ingroup LineBuffer
+ *
+ * \tparam T                Type of a pixel
+ * \tparam Width            Pixels per row of a frame
+ * \tparam K                Window size, K >= 2
+ * \tparam Padding          Boundary handling, see line_buffer_padding (default: LineBufferZero)
+ *
+ * \par Overview
+ * - in takes the pixels of frames in raster order, with last set on the last pixel of each frame; out gives the K x K windows, with last set on the last window of each frame. See LineBufferCore for the windows each Padding produces.
+ * - One pixel in and one window out per cycle, with II=1. A stalled out holds the line buffer.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <LineBuffer.h>
+ *
+ *      ...
+ *      typedef LineBuffer<NVUINT8, 640, 3, LineBufferReplicate> lb_t;
+ *      lb_t lb("lb");
+ *      Connections::Combinational<lb_t::pixel_t> pixel_chan;
+ *      Connections::Combinational<lb_t::window_t> window_chan;
+ *
+ *      lb.clk(clk);
+ *      lb.rst(rst);
+ *      lb.in(pixel_chan);
+ *      lb.out(window_chan);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename T, unsigned int Width, unsigned int K,
+          line_buffer_padding Padding = LineBufferZero>
+class LineBuffer : public sc_module {
+ public:
+  typedef LineBufferCore<T, Width, K, Padding> core_t;
+  typedef typename core_t::pixel_t pixel_t;
+  typedef typename core_t::window_t window_t;
+
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  Connections::In<pixel_t> in;
+  Connections::Out<window_t> out;
+
+  SC_HAS_PROCESS(LineBuffer);
+  LineBuffer(sc_module_name name_) : sc_module(name_), clk("clk"), rst("rst"), in("in"), out("out") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+ private:
+  void run() {
+    in.Reset();
+    out.Reset();
+    core_t core;
+    bool in_held = false, out_held = false;
+    pixel_t in_reg;
+    window_t out_reg;
+
+    #pragma hls_pipeline_init_interval 1
+    while (1) {
+      wait();
+      if (!in_held) {
+        in_held = in.PopNB(in_reg);
+      }
+      if (!out_held) {
+        if (core.run(in_held, in_reg, out_held, out_reg)) {
+          in_held = false;
+        }
+      }
+      if (out_held) {
+        out_held = !out.PushNB(out_reg);
+      }
+    }
+  }
+};
+
+#endif  // LINE_BUFFER_H
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MULTI_ARBITER_H__
+#define __MULTI_ARBITER_H__
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_assert.h>
+#include <comptrees.h>
+
+/**
+ * \brief Roundrobin arbiter that grants up to K of size_ requesters per call.
+ * \ingroup Arbiter
+ *
+ * \tparam size_            Number of elements to be arbitrated.
+ * \tparam K                Maximum number of grants per call.
+ *
+ * \par Overview
+ * - Valid requesters are ranked in roundrobin order starting at an internal pointer, and the first K of them are granted.
+ * - The rank of every requester is a prefix count over the valid mask, so all grants are computed in one pass instead of K arbiters chained through masking.
+ * - After a pick the pointer moves past the last granted requester. Under saturation every requester gets K/size_ of the grants.
+ * - pick(valid) returns the combined grant mask. pick(valid, grants) also returns one one-hot grant per slot, slot k holding the requester of rank k, which can drive e.g. the k-th port of a multi-ported bank directly. Unused slots are zero.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <MultiArbiter.h>
+ *
+ *      ...
+ *      MultiArbiter<8, 2> arbiter;
+ *      arbiter.reset(); // optional in this case, suitable if arbiter is a class member rather than local variable
+ *
+ *      while (1) {
+ *          ...
+ *          MultiArbiter<8, 2>::Mask grants[2];
+ *          MultiArbiter<8, 2>::Mask select = arbiter.pick(valid, grants);
+ *          ...
+ *      };
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <unsigned int size_, unsigned int K>
+class MultiArbiter {
+    public:
+        typedef NVUINTW(size_) Mask;
+
+    protected:
+        static const unsigned int CountWidth = nvhls::nbits<size_>::val;
+        typedef NVUINTW(CountWidth) Count;
+
+        // set for the indices at or above the roundrobin pointer
+        Mask prio;
+
+    public:
+        MultiArbiter() { reset(); }
+
+        // reset the state
+        inline void reset() { prio = ~static_cast<Mask>(0); }
+
+        // picks up to K elements
+        // input : valid mask
+        // output : select mask
+        // side effect : updates the roundrobin pointer
+        Mask pick(const Mask& valid) {
+            Mask grants[K];
+            return pick(valid, grants);
+        }
+
+        // picks up to K elements
+        // input : valid mask
+        // output : select mask, grants[k] is the one-hot grant of rank k
+        // side effect : updates the roundrobin pointer
+        Mask pick(const Mask& valid, Mask grants[K]) {
+            NVHLS_ASSERT_MSG(K > 0, "MultiArbiter needs at least one grant");
+            Mask hi = valid & prio;
+            Mask lo = valid & ~prio;
+
+            // Requesters at or above the pointer are ranked first, followed
+            // by the requesters below it. Both prefix counts are trees of
+            // depth log2(size_).
+            Count hi_rank[size_], lo_rank[size_], rank[size_];
+            Count hi_total = PrefixCount<Mask, bool, Count, size_>::val(hi, 1, hi_rank);
+            PrefixCount<Mask, bool, Count, size_>::val(lo, 1, lo_rank);
+#pragma hls_unroll yes
+            for (unsigned i = 0; i < size_; i++) {
+                rank[i] = (hi[i] == 1) ? hi_rank[i] : static_cast<Count>(hi_total + lo_rank[i]);
+            }
+
+            Mask select = 0;
+#pragma hls_unroll yes
+            for (unsigned k = 0; k < K; k++) {
+                grants[k] = 0;
+            }
+#pragma hls_unroll yes
+            for (unsigned i = 0; i < size_; i++) {
+                if ((valid[i] == 1) && (rank[i] < K)) {
+                    select[i] = 1;
+#pragma hls_unroll yes
+                    for (unsigned k = 0; k < K; k++) {
+                        if (rank[i] == k) {
+                            grants[k][i] = 1;
+                        }
+                    }
+                }
+            }
+
+            // The last grant in roundrobin order is the highest grant below
+            // the pointer if there is one, otherwise the highest grant at or
+            // above it. The pointer moves to the next index.
+            if (select != 0) {
+                Mask lo_select = select & ~prio;
+                Mask last = (lo_select != 0) ? lo_select : static_cast<Mask>(select & prio);
+                bool above = true;
+#pragma hls_unroll yes
+                for (unsigned i = 0; i < size_; i++) {
+                    unsigned idx = size_ - 1 - i;
+                    if (last[idx] == 1) {
+                        above = false;
+                    }
+                    prio[idx] = above;
+                }
+                if (prio == 0) {
+                    prio = ~static_cast<Mask>(0);
+                }
+            }
+            return select;
+        }
+};
+
+#endif  // __MULTI_ARBITER_H__
@@ -0,0 +1,396 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __NOCMESH_H__
+#define __NOCMESH_H__
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_packet.h>
+#include <WHVCRouter.h>
+#ifndef __SYNTHESIS__
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <vector>
+#endif
+
+/**
+ * \brief 2D mesh network of WHVCMeshRouters
+ * \ingroup WHVCRouter
+ *
+ * \tparam XDim             Number of routers in X
+ * \tparam YDim             Number of routers in Y
+ * \tparam NumLPorts        Number of local ports per router
+ * \tparam NumVchannels     Number of virtual channels
+ * \tparam BufferSize       Buffersize of input fifo
+ * \tparam FlitType         Indicates the Flit type
+ * \tparam Algo             Routing algorithm (default: XYRouting)
+ *
+ * \par Overview
+ * - Instantiates XDim * YDim WHVCMeshRouters and connects the remote ports and credit loops of neighbors. Router n = y * XDim + x sits at (x, y).
+ * - Local port l of router n is in_port/out_port[n * NumLPorts + l]; its credits are in_credit/out_credit[(n * NumLPorts + l) * NumVchannels + vc], with the same meaning as on the router.
+ * - Remote ports on the edge of the mesh are tied off with DummySource/DummySink, since minimal routing never uses them.
+ * - Header flits use the WHVCMeshRouter format <Y>:<X>:<Local Dst> with coord_width bits per coordinate.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <NoCMesh.h>
+ *
+ *      ...
+ *        typedef Flit<64, 0, 0, 0, FlitId2bit, WormHole> Flit_t;
+ *        NoCMesh<4, 4, 1, 1, 8, Flit_t> mesh("mesh");
+ *
+ *        mesh.clk(clk);
+ *        mesh.rst(rst);
+ *        for (int i = 0; i < 16; i++) {
+ *          mesh.in_port[i](in_port[i]);
+ *          mesh.out_port[i](out_port[i]);
+ *          mesh.in_credit[i](in_credit[i]);
+ *          mesh.out_credit[i](out_credit[i]);
+ *        }
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <int XDim, int YDim, int NumLPorts, int NumVchannels, int BufferSize,
+          typename FlitType = Flit<64, 0, 0, 0, FlitId2bit, WormHole>,
+          WHVCRoutingAlgo Algo = XYRouting>
+class NoCMesh : public sc_module {
+ public:
+  enum {
+    x_dim = XDim,
+    y_dim = YDim,
+    num_routers = XDim * YDim,
+    num_lports = NumLPorts,
+    num_vchannels = NumVchannels,
+    num_local = num_routers * num_lports,
+    coord_width = nvhls::index_width<(XDim > YDim) ? XDim : YDim>::val
+  };
+  typedef FlitType Flit_t;
+  typedef WHVCMeshRouter<NumLPorts, NumVchannels, BufferSize, FlitType,
+                         coord_width, Algo> Router_t;
+  typedef typename Router_t::Credit_ret_t Credit_ret_t;
+  enum {
+    num_ports = Router_t::num_ports,
+    port_east = Router_t::port_east,
+    port_west = Router_t::port_west,
+    port_north = Router_t::port_north,
+    port_south = Router_t::port_south
+  };
+
+  sc_in_clk clk;
+  sc_in<bool> rst;
+
+  Connections::In<Flit_t> in_port[num_local];
+  Connections::Out<Flit_t> out_port[num_local];
+  Connections::In<Credit_ret_t> in_credit[num_local * num_vchannels];
+  Connections::Out<Credit_ret_t> out_credit[num_local * num_vchannels];
+
+  Router_t* router[num_routers];
+
+  SC_HAS_PROCESS(NoCMesh);
+  NoCMesh(sc_module_name name_) : sc_module(name_), clk("clk"), rst("rst") {
+    for (int n = 0; n < num_routers; n++) {
+      router[n] = new Router_t(sc_gen_unique_name("router"), n % XDim, n / XDim);
+      router[n]->clk(clk);
+      router[n]->rst(rst);
+      for (int l = 0; l < num_lports; l++) {
+        router[n]->in_port[l](in_port[n * num_lports + l]);
+        router[n]->out_port[l](out_port[n * num_lports + l]);
+        for (int vc = 0; vc < num_vchannels; vc++) {
+          int idx = (n * num_lports + l) * num_vchannels + vc;
+          router[n]->in_credit[l * num_vchannels + vc](in_credit[idx]);
+          router[n]->out_credit[l * num_vchannels + vc](out_credit[idx]);
+        }
+      }
+    }
+
+    // Each router drives the link to its neighbor and receives its credits
+    for (int n = 0; n < num_routers; n++) {
+      int x = n % XDim, y = n / XDim;
+      for (int port = port_east; port <= port_south; port++) {
+        int nx = x + (port == port_east) - (port == port_west);
+        int ny = y + (port == port_north) - (port == port_south);
+        if (nx < 0 || nx >= XDim || ny < 0 || ny >= YDim) {
+          tie_off(n, port);
+          continue;
+        }
+        int m = ny * XDim + nx;
+        // Port of the neighbor that faces this router
+        int nport = num_lports + ((port - num_lports) ^ 1);
+
+        Connections::Combinational<Flit_t>* link =
+            new Connections::Combinational<Flit_t>(sc_gen_unique_name("link"));
+        router[n]->out_port[port](*link);
+        router[m]->in_port[nport](*link);
+        for (int vc = 0; vc < num_vchannels; vc++) {
+          Connections::Combinational<Credit_ret_t>* credit =
+              new Connections::Combinational<Credit_ret_t>(
+                  sc_gen_unique_name("credit"));
+          router[m]->out_credit[nport * num_vchannels + vc](*credit);
+          router[n]->in_credit[port * num_vchannels + vc](*credit);
+        }
+      }
+    }
+  }
+
+ private:
+  // Binds an unused remote port on the edge of the mesh
+  void tie_off(int n, int port) {
+    Connections::Combinational<Flit_t>* out_chan =
+        new Connections::Combinational<Flit_t>(sc_gen_unique_name("tie_off"));
+    Connections::Combinational<Flit_t>* in_chan =
+        new Connections::Combinational<Flit_t>(sc_gen_unique_name("tie_off"));
+    Connections::DummySink<Flit_t>* sink =
+        new Connections::DummySink<Flit_t>(sc_gen_unique_name("sink"));
+    Connections::DummySource<Flit_t>* source =
+        new Connections::DummySource<Flit_t>(sc_gen_unique_name("source"));
+    sink->clk(clk);
+    sink->rst(rst);
+    source->clk(clk);
+    source->rst(rst);
+    router[n]->out_port[port](*out_chan);
+    sink->in(*out_chan);
+    router[n]->in_port[port](*in_chan);
+    source->out(*in_chan);
+    for (int vc = 0; vc < num_vchannels; vc++) {
+      Connections::Combinational<Credit_ret_t>* cout_chan =
+          new Connections::Combinational<Credit_ret_t>(sc_gen_unique_name("tie_off"));
+      Connections::Combinational<Credit_ret_t>* cin_chan =
+          new Connections::Combinational<Credit_ret_t>(sc_gen_unique_name("tie_off"));
+      Connections::DummySink<Credit_ret_t>* csink =
+          new Connections::DummySink<Credit_ret_t>(sc_gen_unique_name("sink"));
+      Connections::DummySource<Credit_ret_t>* csource =
+          new Connections::DummySource<Credit_ret_t>(sc_gen_unique_name("source"));
+      csink->clk(clk);
+      csink->rst(rst);
+      csource->clk(clk);
+      csource->rst(rst);
+      router[n]->out_credit[port * num_vchannels + vc](*cout_chan);
+      csink->in(*cout_chan);
+      router[n]->in_credit[port * num_vchannels + vc](*cin_chan);
+      csource->out(*cin_chan);
+    }
+  }
+};
+
+#ifndef __SYNTHESIS__
+/**
+ * \brief Transaction-level model of NoCMesh for architecture exploration
+ * \ingroup WHVCRouter
+ *
+ * \tparam XDim             Number of routers in X
+ * \tparam YDim             Number of routers in Y
+ * \tparam NumLPorts        Number of local ports per router
+ * \tparam NumVchannels     Number of virtual channels
+ * \tparam BufferSize       Credits of each local input VC
+ * \tparam FlitType         Indicates the Flit type
+ * \tparam Algo             Routing algorithm (default: XYRouting)
+ * \tparam HopLatency       Cycles per router hop (default: 1)
+ *
+ * \par Overview
+ * - Same template parameters, port names and header format as NoCMesh, so a design can switch between the two at compile time, e.g. with a typedef under an #ifdef.
+ * - No routers are simulated. When a flit enters, its delivery cycle is computed along the route of its packet: HopLatency cycles per hop, and every link on the way carries one flit per cycle, so flits that need a busy link wait until it is free. This is the contention estimate. WestFirstAdaptive is modeled as XY routing.
+ * - Flits are delivered in order per packet, and packets are not interleaved on an output VC. Local outputs use the credits from in_credit, and local inputs return the credit of each flit in the cycle after it enters, since the model buffers without limit.
+ * - C++ simulation only; one thread serves all ports, so simulation time grows with the number of flits rather than with the number of routers.
+ *
+ */
+template <int XDim, int YDim, int NumLPorts, int NumVchannels, int BufferSize,
+          typename FlitType = Flit<64, 0, 0, 0, FlitId2bit, WormHole>,
+          WHVCRoutingAlgo Algo = XYRouting, int HopLatency = 1>
+class NoCMeshModel : public sc_module {
+ public:
+  typedef NoCMesh<XDim, YDim, NumLPorts, NumVchannels, BufferSize, FlitType, Algo> Mesh_t;
+  enum {
+    x_dim = XDim,
+    y_dim = YDim,
+    num_routers = XDim * YDim,
+    num_lports = NumLPorts,
+    num_vchannels = NumVchannels,
+    num_local = num_routers * num_lports,
+    coord_width = Mesh_t::coord_width
+  };
+  typedef FlitType Flit_t;
+  typedef typename Mesh_t::Credit_ret_t Credit_ret_t;
+
+  sc_in_clk clk;
+  sc_in<bool> rst;
+
+  Connections::In<Flit_t> in_port[num_local];
+  Connections::Out<Flit_t> out_port[num_local];
+  Connections::In<Credit_ret_t> in_credit[num_local * num_vchannels];
+  Connections::Out<Credit_ret_t> out_credit[num_local * num_vchannels];
+
+  SC_HAS_PROCESS(NoCMeshModel);
+  NoCMeshModel(sc_module_name name_) : sc_module(name_), clk("clk"), rst("rst") {
+    SC_THREAD(process);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+ private:
+  struct ModelPacket {
+    std::deque<std::pair<Flit_t, unsigned long long> > flits;  // flit, ready cycle
+    unsigned long long head_time;
+    bool complete;
+  };
+  typedef std::list<ModelPacket> PacketList;
+
+  unsigned long long cycle;
+  // Cycle from which each link (router * 4 + direction) is free
+  std::vector<unsigned long long> link_free;
+  // Packets waiting for each local output VC, ordered by head ready cycle
+  std::vector<PacketList> out_queue;
+  // Open packet of each local input VC: output VC, links and packet
+  std::vector<int> in_out_vc;
+  std::vector<std::vector<int> > in_links;
+  std::vector<typename PacketList::iterator> in_packet;
+  std::vector<unsigned long long> in_last;
+  std::vector<int> credit_recv, credit_send;
+  std::vector<int> out_rr;
+
+  // Links from router src to router dst
+  std::vector<int> route(int src, int dst) {
+    std::vector<int> links;
+    int x = src % XDim, y = src / XDim;
+    int dx = dst % XDim, dy = dst / XDim;
+    bool y_first = (Algo == YXRouting);
+    while (x != dx || y != dy) {
+      int dir;
+      if ((x != dx) && (!y_first || y == dy)) {
+        dir = (dx > x) ? 0 : 1;
+      } else {
+        dir = (dy > y) ? 2 : 3;
+      }
+      links.push_back((y * XDim + x) * 4 + dir);
+      x += (dir == 0) - (dir == 1);
+      y += (dir == 2) - (dir == 3);
+    }
+    return links;
+  }
+
+  void accept(int idx, const Flit_t& flit) {
+    int vc = (num_vchannels > 1) ? static_cast<int>(flit.get_packet_id()) : 0;
+    int in_vc = idx * num_vchannels + vc;
+    if (flit.flit_id.isHeader()) {
+      NVUINTW(num_lports) ldest = nvhls::get_slc<num_lports>(flit.data, 0);
+      int dx = nvhls::get_slc<coord_width>(flit.data, num_lports).to_int();
+      int dy = nvhls::get_slc<coord_width>(flit.data, num_lports + coord_width).to_int();
+      int lport = 0;
+      while (lport < num_lports - 1 && ldest[lport] == 0)
+        lport++;
+      in_links[in_vc] = route(idx / num_lports, dy * XDim + dx);
+      in_out_vc[in_vc] = ((dy * XDim + dx) * num_lports + lport) * num_vchannels + vc;
+    }
+    // Walk the links of the packet, waiting for each one to be free
+    unsigned long long t = cycle;
+    std::vector<int>& links = in_links[in_vc];
+    for (unsigned i = 0; i < links.size(); i++) {
+      t = std::max(t + HopLatency, link_free[links[i]]);
+      link_free[links[i]] = t + 1;
+    }
+    t = std::max(t + HopLatency, in_last[in_vc] + 1);
+    in_last[in_vc] = t;
+
+    PacketList& queue = out_queue[in_out_vc[in_vc]];
+    if (flit.flit_id.isHeader()) {
+      ModelPacket packet;
+      packet.head_time = t;
+      packet.complete = false;
+      // Insert behind all packets that started or have an earlier head
+      typename PacketList::iterator it = queue.begin();
+      if (it != queue.end())
+        it++;
+      while (it != queue.end() && it->head_time <= t)
+        it++;
+      in_packet[in_vc] = queue.insert(it, packet);
+    }
+    in_packet[in_vc]->flits.push_back(std::make_pair(flit, t));
+    if (flit.flit_id.isTail())
+      in_packet[in_vc]->complete = true;
+  }
+
+  void deliver(int idx) {
+    // One flit per output and cycle, round robin over the output VCs
+    for (int i = 0; i < num_vchannels; i++) {
+      int vc = (out_rr[idx] + i) % num_vchannels;
+      int out_vc = idx * num_vchannels + vc;
+      PacketList& queue = out_queue[out_vc];
+      if (queue.empty() || queue.front().flits.empty() ||
+          queue.front().flits.front().second > cycle || credit_recv[out_vc] == 0)
+        continue;
+      if (out_port[idx].PushNB(queue.front().flits.front().first)) {
+        credit_recv[out_vc]--;
+        queue.front().flits.pop_front();
+        if (queue.front().complete && queue.front().flits.empty())
+          queue.pop_front();
+        out_rr[idx] = (vc + 1) % num_vchannels;
+      }
+      return;
+    }
+  }
+
+  void process() {
+    for (int i = 0; i < num_local; i++) {
+      in_port[i].Reset();
+      out_port[i].Reset();
+    }
+    for (int i = 0; i < num_local * num_vchannels; i++) {
+      in_credit[i].Reset();
+      out_credit[i].Reset();
+    }
+    cycle = 0;
+    link_free.assign(num_routers * 4, 0);
+    out_queue.assign(num_local * num_vchannels, PacketList());
+    in_out_vc.assign(num_local * num_vchannels, 0);
+    in_links.assign(num_local * num_vchannels, std::vector<int>());
+    in_packet.assign(num_local * num_vchannels, typename PacketList::iterator());
+    in_last.assign(num_local * num_vchannels, 0);
+    credit_recv.assign(num_local * num_vchannels, BufferSize);
+    credit_send.assign(num_local * num_vchannels, 0);
+    out_rr.assign(num_local, 0);
+
+    while (1) {
+      wait();
+      cycle++;
+      for (int i = 0; i < num_local * num_vchannels; i++) {
+        Credit_ret_t credit;
+        if (in_credit[i].PopNB(credit))
+          credit_recv[i] += credit.to_int();
+        if (credit_send[i] > 0) {
+          Credit_ret_t credit_out = 1;
+          if (out_credit[i].PushNB(credit_out))
+            credit_send[i]--;
+        }
+      }
+      for (int i = 0; i < num_local; i++) {
+        Flit_t flit;
+        if (in_port[i].PopNB(flit)) {
+          accept(i, flit);
+          int vc = (num_vchannels > 1) ? static_cast<int>(flit.get_packet_id()) : 0;
+          credit_send[i * num_vchannels + vc]++;
+        }
+        deliver(i);
+      }
+    }
+  }
+};
+#endif  // __SYNTHESIS__
+
+#endif  // __NOCMESH_H__
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __REGFILE_H__
+#define __REGFILE_H__
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_assert.h>
+#include <mem_array.h>
+
+/**
+ * \brief Implementations of RegFile
+ * \ingroup RegFile
+ *
+ * - RegFileFlops: one flop array with R read muxes and W write decoders. Cheapest for few entries.
+ * - RegFileReplicated: R copies of a 1R1W mem_array_sep, one per read port, all written by the single write port. Requires W == 1.
+ * - RegFileLVT: W*R copies of a 1R1W mem_array_sep, one per (write port, read port) pair, plus a live-value table of Entries flops that records which write port last wrote each entry. Read port r reads the copy (lvt[addr], r).
+ */
+enum regfile_impl { RegFileFlops, RegFileReplicated, RegFileLVT };
+
+/**
+ * \brief Storage of RegFile for each implementation
+ * \ingroup RegFile
+ *
+ * read(r, addr) returns the stored value for read port r. write() takes
+ * write enables that are already free of address conflicts.
+ */
+template <typename T, unsigned int Entries, unsigned int R, unsigned int W, regfile_impl Impl>
+class regfile_storage;
+
+template <typename T, unsigned int Entries, unsigned int R, unsigned int W>
+class regfile_storage<T, Entries, R, W, RegFileFlops> {
+ public:
+  typedef NVUINTW(nvhls::index_width<Entries>::val) Address;
+  T regs[Entries];
+
+  T read(unsigned int r, Address addr) { return regs[addr]; }
+
+  void write(Address addr[W], bool en[W], T data[W]) {
+    #pragma hls_unroll yes
+    for (unsigned w = 0; w < W; w++) {
+      if (en[w]) {
+        regs[addr[w]] = data[w];
+      }
+    }
+  }
+};
+
+template <typename T, unsigned int Entries, unsigned int R, unsigned int W>
+class regfile_storage<T, Entries, R, W, RegFileReplicated> {
+ public:
+  typedef NVUINTW(nvhls::index_width<Entries>::val) Address;
+  mem_array_sep<T, Entries, 1> copies[R];
+
+  regfile_storage() {
+    NVHLS_ASSERT_MSG(W == 1, "RegFileReplicated supports a single write port");
+  }
+
+  T read(unsigned int r, Address addr) { return copies[r].read(addr); }
+
+  void write(Address addr[W], bool en[W], T data[W]) {
+    if (en[0]) {
+      #pragma hls_unroll yes
+      for (unsigned r = 0; r < R; r++) {
+        copies[r].write(addr[0], 0, data[0]);
+      }
+    }
+  }
+};
+
+template <typename T, unsigned int Entries, unsigned int R, unsigned int W>
+class regfile_storage<T, Entries, R, W, RegFileLVT> {
+ public:
+  typedef NVUINTW(nvhls::index_width<Entries>::val) Address;
+  typedef NVUINTW(nvhls::index_width<W>::val) WritePortIndex;
+  mem_array_sep<T, Entries, 1> copies[W][R];
+  WritePortIndex lvt[Entries];
+
+  T read(unsigned int r, Address addr) {
+    T data;
+    WritePortIndex live = lvt[addr];
+    #pragma hls_unroll yes
+    for (unsigned w = 0; w < W; w++) {
+      if (live == w) {
+        data = copies[w][r].read(addr);
+      }
+    }
+    return data;
+  }
+
+  void write(Address addr[W], bool en[W], T data[W]) {
+    #pragma hls_unroll yes
+    for (unsigned w = 0; w < W; w++) {
+      if (en[w]) {
+        lvt[addr[w]] = w;
+        #pragma hls_unroll yes
+        for (unsigned r = 0; r < R; r++) {
+          copies[w][r].write(addr[w], 0, data[w]);
+        }
+      }
+    }
+  }
+};
+
+/**
+ * \brief Register file with R read ports and W write ports
+ * \ingroup RegFile
+ *
+ * \tparam T                Datatype of an entry
+ * \tparam Entries          Number of entries
+ * \tparam R                Number of read ports
+ * \tparam W                Number of write ports
+ * \tparam Impl             Implementation, see regfile_impl (default: RegFileFlops)
+ * \tparam Forwarding       Forward writes to reads of the same entry in the same call (default: true)
+ *
+ * \par Overview
+ * - Each call of run() is one cycle: all read ports read, then all enabled write ports write.
+ * - Write conflicts are resolved by port priority: if several write ports write the same entry in a cycle, the highest-numbered port is written and the others are dropped.
+ * - With Forwarding, a read of an entry that is written in the same cycle returns the write data of the winning write port. Without it, the read returns the value before the write.
+ * - All implementations have the same cycle behavior, so the implementation can be chosen per port count and size for area without changing the caller. Entries that were never written have undefined contents.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <RegFile.h>
+ *
+ *      ...
+ *      typedef RegFile<NVUINT32, 32, 4, 2, RegFileLVT> regfile_t;
+ *      regfile_t regfile;
+ *
+ *      regfile_t::Address read_addr[4], write_addr[2];
+ *      NVUINT32 read_data[4], write_data[2];
+ *      bool write_en[2];
+ *      ...
+ *      regfile.run(read_addr, read_data, write_addr, write_en, write_data);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename T, unsigned int Entries, unsigned int R, unsigned int W,
+          regfile_impl Impl = RegFileFlops, bool Forwarding = true>
+class RegFile {
+ public:
+  typedef NVUINTW(nvhls::index_width<Entries>::val) Address;
+
+ private:
+  regfile_storage<T, Entries, R, W, Impl> storage;
+
+ public:
+  void run(Address read_addr[R], T read_data[R],
+           Address write_addr[W], bool write_en[W], T write_data[W]) {
+    // Drop writes that are overridden by a higher port to the same entry
+    bool write_win[W];
+    #pragma hls_unroll yes
+    for (unsigned w = 0; w < W; w++) {
+      write_win[w] = write_en[w];
+      #pragma hls_unroll yes
+      for (unsigned v = w + 1; v < W; v++) {
+        if (write_en[v] && (write_addr[v] == write_addr[w])) {
+          write_win[w] = false;
+        }
+      }
+    }
+
+    #pragma hls_unroll yes
+    for (unsigned r = 0; r < R; r++) {
+      bool forward = false;
+      T forward_data;
+      if (Forwarding) {
+        #pragma hls_unroll yes
+        for (unsigned w = 0; w < W; w++) {
+          if (write_win[w] && (write_addr[w] == read_addr[r])) {
+            forward = true;
+            forward_data = write_data[w];
+          }
+        }
+      }
+      if (forward) {
+        read_data[r] = forward_data;
+      } else {
+        read_data[r] = storage.read(r, read_addr[r]);
+      }
+    }
+
+    storage.write(write_addr, write_win, write_data);
+  }
+};
+
+#endif
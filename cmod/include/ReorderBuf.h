@@ -21,6 +21,115 @@
 #include <nvhls_types.h>
 #include <mem_array.h>
 #include <nvhls_assert.h>
+#include <comptrees.h>
+#include <Arbiter.h>
+#include <one_hot_to_bin.h>
+
+/**
+ * \brief ID allocation schemes of ReorderBuf
+ * \ingroup ReorderBuffer
+ *
+ * - RobIdLinear: lowest free ID, found by a loop over the InFlight bits.
+ * - RobIdPriEnc: lowest free ID, found by a PriEncTree over the InFlight bits, so the select logic has log2(InFlight) depth.
+ * - RobIdFreeList: IDs are handed out in order once, then recycled through a FIFO of released IDs. Allocation is a FIFO pop independent of InFlight, but IDs are no longer the lowest free ones.
+ */
+enum rob_id_alloc { RobIdLinear, RobIdPriEnc, RobIdFreeList };
+
+/**
+ * \brief Allocator of in-flight IDs for ReorderBuf and ReorderBufWide
+ * \ingroup ReorderBuffer
+ *
+ * \tparam InFlight         Number of inflight entries
+ * \tparam IdAlloc          Allocation scheme, see rob_id_alloc (default: RobIdLinear)
+ *
+ */
+template <unsigned int InFlight, rob_id_alloc IdAlloc = RobIdLinear>
+class ReorderBufIdAlloc {
+
+public:
+    ReorderBufIdAlloc(): idrep(0), num_fresh(0)
+    {
+    }
+
+    typedef sc_uint<nvhls::index_width<InFlight>::val> Id;
+    typedef NVUINTW(InFlight)   IdRepository;
+
+protected:
+    IdRepository idrep;
+
+    // Free list, only sized for RobIdFreeList
+    static const unsigned int FreeListLen = (IdAlloc == RobIdFreeList) ? InFlight : 1;
+    FIFO<Id, FreeListLen> free_ids;
+    typedef NVUINTW(nvhls::nbits<InFlight>::val) FreshCount;
+    FreshCount num_fresh;   // IDs handed out at least once
+
+    typedef NVINTW(nvhls::index_width<InFlight>::val + 1) PriEncIdx;
+
+    bool get_next_avail_id(Id& id, IdRepository& id_repository)
+    {
+        if (IdAlloc == RobIdPriEnc) {
+            PriEncIdx first_free = PriEncTree<IdRepository, bool, PriEncIdx, InFlight>::val(id_repository, 0);
+            if (first_free != -1) {
+                id = first_free.to_uint();
+                id_repository[id] = 1;
+                return true;
+            }
+            return false;
+        } else if (IdAlloc == RobIdFreeList) {
+            if (num_fresh < InFlight) {
+                id = num_fresh.to_uint();
+                num_fresh++;
+            } else if (!free_ids.isEmpty()) {
+                id = free_ids.pop();
+            } else {
+                return false;
+            }
+            id_repository[id] = 1;
+            return true;
+        }
+        #pragma hls_unroll yes
+        for (int i=0; i<static_cast<int>(InFlight); ++i)
+        {
+            if (id_repository[i]==0) 
+            {
+                id = i;
+                id_repository[i]=1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    bool isFull()
+    {
+        return (idrep == static_cast<IdRepository>(~0));
+    }
+
+    Id alloc()
+    {
+        Id id;
+        bool success = get_next_avail_id(id, idrep);
+        NVHLS_ASSERT_MSG(success, "get_next_avail_id unsuccessful");
+        return id;
+    }
+
+    void release(const Id& id)
+    {
+        NVHLS_ASSERT_MSG(idrep[static_cast<int>(id)] == 1, "idrep[id]!=1");
+        idrep[static_cast<int>(id)]=0;
+        if (IdAlloc == RobIdFreeList) {
+            free_ids.push(id);
+        }
+    }
+
+    void reset()
+    {
+        idrep = 0;
+        num_fresh = 0;
+        free_ids.reset();
+    }
+};
 
 /**
  * \brief Reorder Buffer that allows out-of-order writes to queue and in-order reads 
@@ -29,6 +138,7 @@
  * \tparam Data             DataType 
  * \tparam Depth            Depth of queue 
  * \tparam InFlight         Number of inflight entries
+ * \tparam IdAlloc          ID allocation scheme, see rob_id_alloc (default: RobIdLinear)
  *
  * \par A Simple Example
  * \code
@@ -64,55 +174,37 @@
  *
  */
 
-template <typename Data, unsigned int Depth, unsigned int InFlight>
+template <typename Data, unsigned int Depth, unsigned int InFlight, rob_id_alloc IdAlloc = RobIdLinear>
 class ReorderBuf {
 
 public:
-    ReorderBuf(): idrep(0)
+    ReorderBuf()
     {
     }
 
-    typedef sc_uint<nvhls::index_width<InFlight>::val> Id;
+    typedef ReorderBufIdAlloc<InFlight, IdAlloc> IdAllocator;
+    typedef typename IdAllocator::Id Id;
 
 protected:
     mem_array_sep<Data, Depth, 1> storage;
     typedef FIFO<bool, Depth> VBits;
     VBits vbits;
 
-    typedef NVUINTW(InFlight)   IdRepository;
-
-    IdRepository idrep;
+    IdAllocator ids;
     typedef typename VBits::FifoIdx EntryNum;
 
     typedef mem_array_sep<EntryNum, InFlight,1> Id2Entry;
     Id2Entry id2entry;
-    
-    bool get_next_avail_id(Id& id, IdRepository& id_repository)
-    {
-        #pragma hls_unroll yes
-        for (int i=0; i<static_cast<int>(InFlight); ++i)
-        {
-            if (id_repository[i]==0) 
-            {
-                id = i;
-                id_repository[i]=1;
-                return true;
-            }
-        }
-        return false;
-    }
 
 public:
     bool canAcceptRequest()
     {
-        return ((idrep != static_cast<IdRepository>(~0)) && !vbits.isFull());
+        return (!ids.isFull() && !vbits.isFull());
     }
 
     Id addRequest()
     {
-        Id id;
-        bool success = get_next_avail_id(id, idrep);
-        NVHLS_ASSERT_MSG(success, "get_next_avail_id unsuccessful");
+        Id id = ids.alloc();
 
         id2entry.write(static_cast<typename Id2Entry::LocalIndex>(id), 0, vbits.get_tail()); 
         vbits.push(false);
@@ -134,8 +226,7 @@ public:
         EntryNum entryNum = id2entry.read(static_cast<typename Id2Entry::LocalIndex>(id), 0);
         storage.write(entryNum, 0, data);
         vbits.fifo_body.write(static_cast<typename VBits::FifoIdx>(entryNum), 0, true);
-        NVHLS_ASSERT_MSG(idrep[static_cast<int>(id)] == 1, "idrep[id]!=1");
-        idrep[static_cast<int>(id)]=0;
+        ids.release(id);
     }
 
     Data popResponse()
@@ -151,7 +242,7 @@ public:
     void reset()
     {
         vbits.reset();
-        idrep = 0;
+        ids.reset();
     }
 
     bool isEmpty()
@@ -161,4 +252,357 @@ public:
     
 };
 
+/**
+ * \brief Reorder Buffer that accepts up to M out-of-order responses and drains up to M in-order entries per call
+ * \ingroup ReorderBuffer
+ *
+ * \tparam Data             DataType 
+ * \tparam Depth            Depth of queue, must be a multiple of M
+ * \tparam InFlight         Number of inflight entries
+ * \tparam M                Maximum number of responses added and popped per call
+ * \tparam IdAlloc          ID allocation scheme, see rob_id_alloc (default: RobIdLinear)
+ *
+ * \par Overview
+ * - Requests are allocated one per call with addRequest(), with the same ID allocation as ReorderBuf.
+ * - addResponses() writes up to M responses, one per valid lane, in any order.
+ * - numResponsesReady() counts the ready entries at the head, up to M, and popResponses() pops them in order. Consecutive entries are stored in different banks (entry % M), so the M-wide drain reads each bank once.
+ * - addResponse(), topResponseReady() and popResponse() keep the single-entry interface of ReorderBuf.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <ReorderBuf.h>
+ *
+ *      ...
+ *      ReorderBufWide<Data, 16, 8, 4> rob;
+ *      ...
+ *      if (rob.canAcceptRequest()) {
+ *        id = rob.addRequest();
+ *      }
+ *      ...
+ *      rob.addResponses(rsp_id, rsp_data, rsp_valid);
+ *      ...
+ *      Data out[4];
+ *      unsigned int num_out = rob.popResponses(out);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename Data, unsigned int Depth, unsigned int InFlight, unsigned int M,
+          rob_id_alloc IdAlloc = RobIdLinear>
+class ReorderBufWide {
+
+public:
+    ReorderBufWide()
+    {
+        NVHLS_ASSERT_MSG((Depth % M) == 0, "Depth must be a multiple of M");
+        reset();
+    }
+
+    typedef ReorderBufIdAlloc<InFlight, IdAlloc> IdAllocator;
+    typedef typename IdAllocator::Id Id;
+    typedef NVUINTW(nvhls::nbits<M>::val) Count;
+
+protected:
+    typedef NVUINTW(nvhls::index_width<Depth>::val) EntryNum;
+    typedef NVUINTW(nvhls::nbits<Depth>::val) Occupancy;
+    typedef mem_array_sep<Data, Depth, M> Storage;
+    Storage storage;
+
+    typedef NVUINTW(Depth)      ValidBits;
+    ValidBits vbits;
+    EntryNum head;
+    EntryNum tail;
+    Occupancy occupancy;
+
+    IdAllocator ids;
+
+    typedef mem_array_sep<EntryNum, InFlight,1> Id2Entry;
+    Id2Entry id2entry;
+
+    static EntryNum wrap(unsigned int entry)
+    {
+        return (entry >= Depth) ? (entry - Depth) : entry;
+    }
+
+
+public:
+    bool canAcceptRequest()
+    {
+        return (!ids.isFull() && (occupancy < Depth));
+    }
+
+    Id addRequest()
+    {
+        Id id = ids.alloc();
+        NVHLS_ASSERT_MSG(occupancy < Depth, "ReorderBufWide is full");
+
+        id2entry.write(static_cast<typename Id2Entry::LocalIndex>(id), 0, tail); 
+        vbits[tail] = 0;
+        tail = wrap(tail + 1);
+        occupancy++;
+
+        return id;
+    }
+
+    void addResponses(const Id id[M], const Data data[M], const bool valid[M])
+    {
+        #pragma hls_unroll yes
+        for (unsigned i = 0; i < M; i++) {
+            if (valid[i]) {
+                addResponse(id[i], data[i]);
+            }
+        }
+    }
+
+    void addResponse(const Id& id, const Data& data)
+    {
+        EntryNum entryNum = id2entry.read(static_cast<typename Id2Entry::LocalIndex>(id), 0);
+        storage.write(entryNum / M, entryNum % M, data);
+        vbits[entryNum] = 1;
+        ids.release(id);
+    }
+
+    Count numResponsesReady()
+    {
+        Count num = 0;
+        bool ready = true;
+        #pragma hls_unroll yes
+        for (unsigned i = 0; i < M; i++) {
+            ready = ready && (i < occupancy) && (vbits[wrap(head + i)] == 1);
+            if (ready) {
+                num = i + 1;
+            }
+        }
+        return num;
+    }
+
+    bool topResponseReady()
+    {
+        return (!isEmpty() && (vbits[head] == 1));
+    }
+
+    // Pops all ready entries at the head, up to M, into data[0..num-1] and
+    // returns num
+    Count popResponses(Data data[M])
+    {
+        Count num = numResponsesReady();
+        #pragma hls_unroll yes
+        for (unsigned i = 0; i < M; i++) {
+            if (i < num) {
+                EntryNum entryNum = wrap(head + i);
+                data[i] = storage.read(entryNum / M, entryNum % M);
+            }
+        }
+        head = wrap(head + num);
+        occupancy -= num;
+        return num;
+    }
+
+    Data popResponse()
+    {
+        NVHLS_ASSERT_MSG(topResponseReady(),"topResponseNotReady");
+
+        Data result = storage.read(head / M, head % M); 
+        head = wrap(head + 1);
+        occupancy--;
+
+        return result;
+    }
+
+    void reset()
+    {
+        vbits = 0;
+        head = 0;
+        tail = 0;
+        occupancy = 0;
+        ids.reset();
+    }
+
+    bool isEmpty()
+    {
+        return (occupancy == 0);
+    }
+    
+};
+
+/**
+ * \brief Reorder Buffer that keeps responses in request order within each stream, but not across streams
+ * \ingroup ReorderBuffer
+ *
+ * \tparam Data             DataType
+ * \tparam Depth            Number of entries, shared by all streams
+ * \tparam InFlight         Number of inflight entries
+ * \tparam Streams          Number of streams, e.g. 1 << AXI ID width
+ * \tparam IdAlloc          ID allocation scheme of the inflight IDs and of the entries, see rob_id_alloc (default: RobIdLinear)
+ *
+ * \par Overview
+ * - addRequest(stream) allocates an entry from the shared storage and links it to the tail of the stream, so a stream can use any number of entries up to Depth.
+ * - addResponse() is the same as in ReorderBuf.
+ * - A stream is ready when the response of its oldest entry has arrived. topResponseReady() is true if any stream is ready, and popResponse(stream) pops the head of one of the ready streams, chosen by a round-robin Arbiter, and returns its stream. A slow response therefore only blocks later responses of its own stream.
+ * - popStreamResponse(stream) pops the head of a given ready stream.
+ * - With Streams = 1 the order is the same as in ReorderBuf, at the cost of the linked lists.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <ReorderBuf.h>
+ *
+ *      ...
+ *      ReorderBufStreams<Data, 16, 8, 4> rob;
+ *      ...
+ *      if (rob.canAcceptRequest()) {
+ *        id = rob.addRequest(axi_id);
+ *      }
+ *      ...
+ *      rob.addResponse(rsp_id, rsp_data);
+ *      ...
+ *      if (rob.topResponseReady()) {
+ *        ReorderBufStreams<Data, 16, 8, 4>::Stream stream;
+ *        Data out = rob.popResponse(stream);
+ *      }
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename Data, unsigned int Depth, unsigned int InFlight, unsigned int Streams,
+          rob_id_alloc IdAlloc = RobIdLinear>
+class ReorderBufStreams {
+
+public:
+    ReorderBufStreams()
+    {
+        reset();
+    }
+
+    typedef ReorderBufIdAlloc<InFlight, IdAlloc> IdAllocator;
+    typedef typename IdAllocator::Id Id;
+    static const unsigned int StreamWidth = nvhls::index_width<Streams>::val;
+    typedef NVUINTW(StreamWidth) Stream;
+    typedef NVUINTW(Streams) StreamMask;
+
+protected:
+    typedef ReorderBufIdAlloc<Depth, IdAlloc> EntryAllocator;
+    typedef typename EntryAllocator::Id EntryNum;
+    mem_array_sep<Data, Depth, 1> storage;
+
+    // Next entry of the same stream, linking each stream's entries from head to tail
+    typedef mem_array_sep<EntryNum, Depth, 1> NextEntry;
+    NextEntry next;
+
+    typedef NVUINTW(Depth) ValidBits;
+    ValidBits vbits;
+    EntryNum head[Streams];
+    EntryNum tail[Streams];
+    StreamMask active;     // streams with at least one entry
+
+    EntryAllocator entries;
+    IdAllocator ids;
+    Arbiter<Streams> arb;
+
+    typedef mem_array_sep<EntryNum, InFlight,1> Id2Entry;
+    Id2Entry id2entry;
+
+public:
+    bool canAcceptRequest()
+    {
+        return (!ids.isFull() && !entries.isFull());
+    }
+
+    Id addRequest(const Stream& stream)
+    {
+        Id id = ids.alloc();
+        EntryNum entryNum = entries.alloc();
+
+        id2entry.write(static_cast<typename Id2Entry::LocalIndex>(id), 0, entryNum);
+        vbits[entryNum] = 0;
+        if (active[stream] == 1) {
+            next.write(tail[stream], 0, entryNum);
+        } else {
+            head[stream] = entryNum;
+            active[stream] = 1;
+        }
+        tail[stream] = entryNum;
+
+        return id;
+    }
+
+    void addResponse(const Id& id, const Data& data)
+    {
+        EntryNum entryNum = id2entry.read(static_cast<typename Id2Entry::LocalIndex>(id), 0);
+        storage.write(entryNum, 0, data);
+        vbits[entryNum] = 1;
+        ids.release(id);
+    }
+
+    // Streams whose oldest entry has its response
+    StreamMask readyStreams()
+    {
+        StreamMask ready = 0;
+        #pragma hls_unroll yes
+        for (unsigned i = 0; i < Streams; i++) {
+            ready[i] = (active[i] == 1) && (vbits[head[i]] == 1);
+        }
+        return ready;
+    }
+
+    bool topResponseReady()
+    {
+        return (readyStreams() != 0);
+    }
+
+    bool streamReady(const Stream& stream)
+    {
+        return (active[stream] == 1) && (vbits[head[stream]] == 1);
+    }
+
+    Data popResponse(Stream& stream)
+    {
+        StreamMask ready = readyStreams();
+        NVHLS_ASSERT_MSG(ready != 0,"topResponseNotReady");
+
+        StreamMask select = arb.pick(ready);
+        one_hot_to_bin<Streams, StreamWidth>(select, stream);
+        return popStreamResponse(stream);
+    }
+
+    Data popStreamResponse(const Stream& stream)
+    {
+        NVHLS_ASSERT_MSG(streamReady(stream),"streamResponseNotReady");
+
+        EntryNum entryNum = head[stream];
+        Data result = storage.read(entryNum, 0);
+        if (entryNum == tail[stream]) {
+            active[stream] = 0;
+        } else {
+            head[stream] = next.read(entryNum, 0);
+        }
+        entries.release(entryNum);
+
+        return result;
+    }
+
+    void reset()
+    {
+        vbits = 0;
+        active = 0;
+        #pragma hls_unroll yes
+        for (unsigned i = 0; i < Streams; i++) {
+            head[i] = 0;
+            tail[i] = 0;
+        }
+        entries.reset();
+        ids.reset();
+        arb.reset();
+    }
+
+    bool isEmpty()
+    {
+        return (active == 0);
+    }
+
+};
+
 #endif
@@ -23,6 +23,24 @@
 #include <hls_globals.h>
 #include <nvhls_connections.h>
 #include <crossbar.h>
+#include <nvhls_stats.h>
+#include <Scratchpad/ScratchpadTypes.h>
+#include <mem_array.h>
+#include <fifo.h>
+
+// Bank storage of Scratchpad: entries of T, or words of LANES_PER_WORD
+// entries with one byte enable per entry
+template <typename T, int CAPACITY_IN_BYTES, int N, int LANES_PER_WORD>
+struct scratchpad_banks {
+  typedef mem_array_sep<NVUINTW(Wrapped<T>::width * LANES_PER_WORD),
+                        CAPACITY_IN_BYTES / LANES_PER_WORD, N, LANES_PER_WORD>
+      type;
+};
+
+template <typename T, int CAPACITY_IN_BYTES, int N>
+struct scratchpad_banks<T, CAPACITY_IN_BYTES, N, 1> {
+  typedef mem_array_sep<T, CAPACITY_IN_BYTES, N> type;
+};
 
 /**
  * \brief Parameterized banked scratchpad memory 
@@ -31,6 +49,9 @@
  * \tparam T                   EntryType 
  * \tparam N                   Number of requests 
  * \tparam CAPACITY_IN_BYTES 
+ * \tparam ATOMICS             Perform the ATOMIC_* opcodes in the banks (default: false)
+ * \tparam RSP_QUEUE_DEPTH     Depth of the response queue, 0 for blocking responses (default: 0)
+ * \tparam LANES_PER_WORD      Entries of T per bank word, 1 for one entry per bank access (default: 1)
  *
  * \par Overview
  *   -Assumptions:  All N requests are guaranteed conflict-free.
@@ -43,6 +64,33 @@
  *     Number of banks (assumed to be same as the number of requests)
  *     Address Width
  *  
+ *   Response queue: with RSP_QUEUE_DEPTH = 0 the scratchpad blocks on
+ *     cli_rsp.Push(), so backpressure on cli_rsp stalls every request.
+ *     With RSP_QUEUE_DEPTH > 0 responses go to a queue that drains to cli_rsp
+ *     with non-blocking pushes, and a new request is accepted every cycle
+ *     while the queue had room at the start of the cycle. A depth of at least
+ *     2 sustains one request per cycle; deeper queues absorb longer stalls of
+ *     the response channel.
+ *  
+ *   Atomics: with ATOMICS, a bank performs an ATOMIC_* request as a read and
+ *     a write of the same entry and the old value is returned like a load.
+ *     Lanes of one atomic request may target the same address; the bank
+ *     applies them in lane order, and each lane gets the value left by the
+ *     lanes before it. Lanes with different addresses must still map to
+ *     different banks. cli_req_t then carries the cmp operand of ATOMIC_CAS.
+ *  
+ *   Sub-word lanes: with LANES_PER_WORD > 1 the banks store words of
+ *     LANES_PER_WORD entries of T, e.g. 8 NVINT8 entries in a 64-bit word.
+ *     Addresses still count entries of T: the low log2(LANES_PER_WORD) bits
+ *     select the entry in the word and the next bits the bank. Lanes that
+ *     fall in the same bank word are coalesced into one bank access; stores
+ *     write only their entries through the mem_array_sep byte enables, and
+ *     lanes storing to the same entry are applied in lane order. The
+ *     conflict-free assumption becomes one word per bank per request, so N
+ *     lanes reading or writing consecutive entries use only
+ *     N / LANES_PER_WORD bank accesses. Atomics are not supported in this
+ *     mode, and CAPACITY_IN_BYTES must be a multiple of N * LANES_PER_WORD.
+ *  
  *
  * \par A Simple Example
  * \code
@@ -75,26 +123,44 @@
  * \endcode
  *
  * This may reduce area/power.
+ *
+ * \par Statistics
+ * In C++ simulation the public member stats (match::Stats) counts requests,
+ * loads, stores, per-bank accesses (bank_accesses_<i>) and idle banks
+ * (bank_idle_<i>), and atomics counts atomic requests. bank_conflicts counts lanes that target a bank already
+ * targeted by another lane of the same request, which breaks the conflict-free
+ * assumption. With sub-word lanes, bank_conflicts counts lanes that target a
+ * different word of a bank than a lower lane, and coalesced_lanes lanes that
+ * share the bank access of a lower lane. With a response queue, rsp_backpressure counts cycles in which
+ * cli_rsp did not take the head of the queue, rsp_queue_full cycles in which
+ * no request could be accepted, and rsp_queue_occupancy_0_hist_<n> samples the
+ * queue occupancy. The counters compile out under __SYNTHESIS__.
  * \par
  *
  *
  */
 
-#include <Scratchpad/ScratchpadTypes.h>
-#include <mem_array.h>
-
-template <typename T, int N, int CAPACITY_IN_BYTES>
+template <typename T, int N, int CAPACITY_IN_BYTES, bool ATOMICS = false,
+          int RSP_QUEUE_DEPTH = 0, int LANES_PER_WORD = 1>
 class Scratchpad : public sc_module {
+  static_assert(LANES_PER_WORD == 1 || !ATOMICS,
+                "Scratchpad does not support atomics with LANES_PER_WORD > 1");
+  static_assert(CAPACITY_IN_BYTES % (N * LANES_PER_WORD) == 0,
+                "CAPACITY_IN_BYTES must be a multiple of N * LANES_PER_WORD");
+
  public:
   static const int ADDR_WIDTH = nvhls::nbits<CAPACITY_IN_BYTES - 1>::val;
   sc_in_clk clk;
   sc_in<bool> rst;
-  Connections::In<cli_req_t<T, ADDR_WIDTH, N> > cli_req;
+  Connections::In<cli_req_t<T, ADDR_WIDTH, N, ATOMICS> > cli_req;
   Connections::Out<cli_rsp_t<T, N> > cli_rsp;
 
   //------------Constants Here---------------------------
   // Derived parameters
   static const int NBANKS_LOG2 = nvhls::nbits<N - 1>::val;
+  static const int SUB_LOG2 =
+      (LANES_PER_WORD > 1) ? nvhls::nbits<LANES_PER_WORD - 1>::val : 0;
+  static const int LANE_WIDTH = Wrapped<T>::width;
 
   //------------Local typedefs---------------------------
   typedef NVUINTW(NBANKS_LOG2) bank_sel_t;
@@ -103,9 +169,16 @@ class Scratchpad : public sc_module {
     bank_addr_t addr;
     T wdata;
   };
+  typedef NVUINTW((SUB_LOG2 > 0) ? SUB_LOG2 : 1) sub_sel_t;
+  typedef NVUINTW(ADDR_WIDTH - NBANKS_LOG2 - SUB_LOG2) word_addr_t;
+  typedef typename scratchpad_banks<T, CAPACITY_IN_BYTES, N, LANES_PER_WORD>::type banks_t;
+  typedef NVUINTW(LANE_WIDTH * LANES_PER_WORD) word_t;
+  typedef NVUINTW(LANES_PER_WORD) word_mask_t;
+  template <bool Subword>
+  struct access_mode {};
 
   //------------Local Variables Here---------------------
-  mem_array_sep<T, CAPACITY_IN_BYTES, N> banks;
+  banks_t banks;
   bank_req_t input_reqs[N];
   bool input_reqs_valid[N];
   bank_req_t bank_reqs[N];
@@ -113,16 +186,39 @@ class Scratchpad : public sc_module {
   T bank_rsps_data[N];
   bool bank_rsps_valid[N];
   bool load_rsps_valid[N];
-  cli_req_t<T, ADDR_WIDTH, N> curr_cli_req;
+  T atomic_rsps_data[N];
+  cli_req_t<T, ADDR_WIDTH, N, ATOMICS> curr_cli_req;
   cli_rsp_t<T, N> load_rsp;
   bank_sel_t bank_src_lane[N];
   bank_sel_t bank_dst_lane[N];
+  FIFO<cli_rsp_t<T, N>, RSP_QUEUE_DEPTH> rsp_queue;
+  match::Stats stats;
+#ifndef __SYNTHESIS__
+  // Counters updated every request, registered once
+  match::Stats::StatHandle requests_stat, loads_stat, stores_stat, atomics_stat;
+  match::Stats::StatHandle bank_conflicts_stat, coalesced_lanes_stat;
+  match::Stats::StatHandle bank_accesses_stat, bank_idle_stat;
+  match::Stats::StatHandle rsp_backpressure_stat, rsp_queue_full_stat, rsp_queue_occupancy_stat;
+#endif
 
   //----------- Constructor -----------------------------
   //   -Allocate and declare sub-modules
   //   -Declare all SC_METHODs and SC_THREADs
   SC_HAS_PROCESS(Scratchpad);
   Scratchpad(sc_module_name name_) : sc_module(name_) {
+#ifndef __SYNTHESIS__
+    requests_stat = stats.RegisterStat("requests");
+    loads_stat = stats.RegisterStat("loads");
+    stores_stat = stats.RegisterStat("stores");
+    atomics_stat = stats.RegisterStat("atomics");
+    bank_conflicts_stat = stats.RegisterStat("bank_conflicts");
+    coalesced_lanes_stat = stats.RegisterStat("coalesced_lanes");
+    bank_accesses_stat = stats.RegisterStatIndexed("bank_accesses", N);
+    bank_idle_stat = stats.RegisterStatIndexed("bank_idle", N);
+    rsp_backpressure_stat = stats.RegisterStat("rsp_backpressure");
+    rsp_queue_full_stat = stats.RegisterStat("rsp_queue_full");
+    rsp_queue_occupancy_stat = stats.RegisterStatHistogram("rsp_queue_occupancy", 1);
+#endif
     SC_THREAD(run);
     sensitive << clk.pos();
     NVHLS_NEG_RESET_SIGNAL_IS(rst);
@@ -130,74 +226,230 @@ class Scratchpad : public sc_module {
     //                           << ", addr width: " << ADDR_WIDTH << endl);
   }
 
-  void run() {
+  // Perform curr_cli_req on the banks and fill load_rsp; returns true if the
+  // request has a response
+  bool access() { return access(access_mode<(LANES_PER_WORD > 1)>()); }
 
-    // Reset behavior
-    cli_req.Reset();
-    cli_rsp.Reset();
-    wait();
+  bool access(access_mode<false>) {
+    bool is_load = (curr_cli_req.opcode == LOAD);
+    bool is_atomic = ATOMICS && ScratchpadIsAtomic(curr_cli_req.opcode);
 
-    #pragma hls_pipeline_init_interval 1
-    #pragma pipeline_stall_mode flush
-    while (true) {
-
-      bool is_load;
-      is_load = false;
-
-      // Read client request
-      // (Implemented as a blocking read since there's no other work to do if no
-      // valid request in the channel)
-      curr_cli_req = cli_req.Pop();
-      is_load = (curr_cli_req.opcode == LOAD);
+    // Atomic lanes that repeat the address of a lower lane are applied by
+    // the bank of that lane
+    bool dup_lane[N];
+#pragma hls_unroll yes
+    for (int i = 0; i < N; i++) {
+      dup_lane[i] = false;
+#pragma hls_unroll yes
+      for (int j = 0; j < i; j++) {
+        if (is_atomic && (curr_cli_req.valids[j] == true) &&
+            (curr_cli_req.addr[j] == curr_cli_req.addr[i])) {
+          dup_lane[i] = true;
+        }
+      }
+    }
 
 // Pre-process the bank requests and compute lane selects from addresses
 #pragma hls_unroll yes
-      for (int i = 0; i < N; i++) {
-        // For each request, figure out the target bank and update its bank_req
-        // fields
-        bank_sel_t bank_sel;
-        bank_sel = nvhls::get_slc<NBANKS_LOG2>(curr_cli_req.addr[i], 0);
+    for (int i = 0; i < N; i++) {
+      // For each request, figure out the target bank and update its bank_req
+      // fields
+      bank_sel_t bank_sel;
+      bank_sel = nvhls::get_slc<NBANKS_LOG2>(curr_cli_req.addr[i], 0);
+      if (!dup_lane[i])
         bank_src_lane[bank_sel] = i;
 
-        // Save the lane->bank mapping for the response xbar
-        bank_dst_lane[i] = bank_sel;
+      // Save the lane->bank mapping for the response xbar
+      bank_dst_lane[i] = bank_sel;
 
-        // Convert from curr_cli_req to internal format
-        input_reqs_valid[i] = (curr_cli_req.valids[i] == true);
-        input_reqs[i].addr = nvhls::get_slc<ADDR_WIDTH - NBANKS_LOG2>(
-            curr_cli_req.addr[i], NBANKS_LOG2);
-        if (!is_load)
-          input_reqs[i].wdata = curr_cli_req.data[i];
-      }
+      // Convert from curr_cli_req to internal format
+      input_reqs_valid[i] = (curr_cli_req.valids[i] == true) && !dup_lane[i];
+      input_reqs[i].addr = nvhls::get_slc<ADDR_WIDTH - NBANKS_LOG2>(
+          curr_cli_req.addr[i], NBANKS_LOG2);
+      if (!is_load)
+        input_reqs[i].wdata = curr_cli_req.data[i];
+    }
+
+    // Bank request crossbar
+    crossbar<bank_req_t, N, N>(input_reqs, input_reqs_valid, bank_src_lane,
+                               bank_reqs, bank_reqs_valid);
 
-      // Bank request crossbar
-      crossbar<bank_req_t, N, N>(input_reqs, input_reqs_valid, bank_src_lane,
-                                 bank_reqs, bank_reqs_valid);
+#ifndef __SYNTHESIS__
+    stats.IncrStat(requests_stat);
+    stats.IncrStat(is_load ? loads_stat : (is_atomic ? atomics_stat : stores_stat));
+    bool bank_targeted[N];
+    for (int i = 0; i < N; i++) {
+      bank_targeted[i] = false;
+    }
+    for (int i = 0; i < N; i++) {
+      if (input_reqs_valid[i]) {
+        if (bank_targeted[bank_dst_lane[i]]) {
+          stats.IncrStat(bank_conflicts_stat);
+        }
+        bank_targeted[bank_dst_lane[i]] = true;
+      }
+    }
+    for (int i = 0; i < N; i++) {
+      stats.IncrStatIndexed(bank_reqs_valid[i] ? bank_accesses_stat : bank_idle_stat, i);
+    }
+#endif
 
 // Loop over scratchpad banks, execute load or store on each bank
 #pragma hls_unroll yes
-      for (int i = 0; i < N; i++) {
-        if ((bank_reqs_valid[i] == true) && is_load) {
-          bank_rsps_valid[i] = true;
-          bank_rsps_data[i] = banks.read(bank_reqs[i].addr, i);
-        } else if ((bank_reqs_valid[i] == true) && !is_load) {
-          banks.write(bank_reqs[i].addr, i, bank_reqs[i].wdata);
-          bank_rsps_valid[i] = false;
-        } else {
-          bank_rsps_valid[i] = false;
+    for (int i = 0; i < N; i++) {
+      if ((bank_reqs_valid[i] == true) && is_load) {
+        bank_rsps_valid[i] = true;
+        bank_rsps_data[i] = banks.read(bank_reqs[i].addr, i);
+      } else if ((bank_reqs_valid[i] == true) && is_atomic) {
+        // Apply the lanes with this address in lane order
+        T value = banks.read(bank_reqs[i].addr, i);
+#pragma hls_unroll yes
+        for (int j = 0; j < N; j++) {
+          if ((curr_cli_req.valids[j] == true) && (bank_dst_lane[j] == i) &&
+              (input_reqs[j].addr == bank_reqs[i].addr)) {
+            atomic_rsps_data[j] = value;
+            value = ScratchpadAtomicResult(curr_cli_req.opcode, value, input_reqs[j].wdata,
+                                           curr_cli_req.cmp[ATOMICS ? j : 0]);
+          }
         }
+        banks.write(bank_reqs[i].addr, i, value);
+        bank_rsps_valid[i] = false;
+      } else if ((bank_reqs_valid[i] == true) && !is_load) {
+        banks.write(bank_reqs[i].addr, i, bank_reqs[i].wdata);
+        bank_rsps_valid[i] = false;
+      } else {
+        bank_rsps_valid[i] = false;
       }
+    }
 
-      // Bank response crossbar
-      crossbar<T, N, N>(bank_rsps_data, bank_rsps_valid, bank_dst_lane,
-                        load_rsp.data, load_rsps_valid);
-      #pragma hls_unroll yes
-      for (int i = 0; i < N; i++) {
-        load_rsp.valids[i] = load_rsps_valid[i];  // sc_lv to bool conversion
+    // Bank response crossbar
+    crossbar<T, N, N>(bank_rsps_data, bank_rsps_valid, bank_dst_lane,
+                      load_rsp.data, load_rsps_valid);
+    #pragma hls_unroll yes
+    for (int i = 0; i < N; i++) {
+      load_rsp.valids[i] = load_rsps_valid[i];  // sc_lv to bool conversion
+      if (is_atomic) {
+        load_rsp.valids[i] = (curr_cli_req.valids[i] == true);
+        load_rsp.data[i] = atomic_rsps_data[i];
       }
-      // Write client responses
-      if (is_load) {
-        cli_rsp.Push(load_rsp);
+    }
+
+    return is_load || is_atomic;
+  }
+
+  // Sub-word lanes: each bank serves the word of its lowest valid lane and
+  // every lane in that word
+  bool access(access_mode<true>) {
+    bool is_load = (curr_cli_req.opcode == LOAD);
+    sub_sel_t lane_sub[N];
+    word_addr_t lane_addr[N];
+    word_t bank_rdata[N];
+
+#pragma hls_unroll yes
+    for (int i = 0; i < N; i++) {
+      lane_sub[i] = nvhls::get_slc<SUB_LOG2>(curr_cli_req.addr[i], 0);
+      bank_dst_lane[i] = nvhls::get_slc<NBANKS_LOG2>(curr_cli_req.addr[i], SUB_LOG2);
+      lane_addr[i] = nvhls::get_slc<ADDR_WIDTH - NBANKS_LOG2 - SUB_LOG2>(
+          curr_cli_req.addr[i], NBANKS_LOG2 + SUB_LOG2);
+    }
+
+#ifndef __SYNTHESIS__
+    stats.IncrStat(requests_stat);
+    stats.IncrStat(is_load ? loads_stat : stores_stat);
+#endif
+
+#pragma hls_unroll yes
+    for (int b = 0; b < N; b++) {
+      bool valid = false;
+      word_addr_t addr = 0;
+      word_t wdata = 0;
+      word_mask_t mask = 0;
+#pragma hls_unroll yes
+      for (int j = 0; j < N; j++) {
+        if ((curr_cli_req.valids[j] == true) && (bank_dst_lane[j] == b)) {
+#ifndef __SYNTHESIS__
+          if (valid) {
+            stats.IncrStat((lane_addr[j] == addr) ? coalesced_lanes_stat : bank_conflicts_stat);
+          }
+#endif
+          if (!valid) {
+            addr = lane_addr[j];
+          }
+          valid = true;
+          if (!is_load) {
+            wdata = nvhls::set_slc(wdata, TypeToNVUINT(curr_cli_req.data[j]),
+                                   lane_sub[j] * LANE_WIDTH);
+            mask[lane_sub[j]] = 1;
+          }
+        }
+      }
+#ifndef __SYNTHESIS__
+      stats.IncrStatIndexed(valid ? bank_accesses_stat : bank_idle_stat, b);
+#endif
+      if (valid && is_load) {
+        bank_rdata[b] = banks.read(addr, b);
+      } else if (valid) {
+        banks.write(addr, b, wdata, mask);
+      }
+    }
+
+#pragma hls_unroll yes
+    for (int i = 0; i < N; i++) {
+      load_rsp.valids[i] = curr_cli_req.valids[i];
+      load_rsp.data[i] = NVUINTToType<T>(nvhls::get_slc<LANE_WIDTH>(
+          bank_rdata[bank_dst_lane[i]], lane_sub[i] * LANE_WIDTH));
+    }
+
+    return is_load;
+  }
+
+  void run() {
+
+    // Reset behavior
+    cli_req.Reset();
+    cli_rsp.Reset();
+    rsp_queue.reset();
+    wait();
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while (true) {
+      if (RSP_QUEUE_DEPTH == 0) {
+        // Read client request
+        // (Implemented as a blocking read since there's no other work to do if no
+        // valid request in the channel)
+        curr_cli_req = cli_req.Pop();
+        if (access()) {
+          // Write client responses
+          cli_rsp.Push(load_rsp);
+        }
+      } else {
+        // A request is only taken if the response queue had room at the
+        // start of the cycle
+        bool rsp_queue_full = rsp_queue.isFull();
+        if (!rsp_queue.isEmpty()) {
+          if (cli_rsp.PushNB(rsp_queue.peek())) {
+            rsp_queue.incrHead();
+          }
+#ifndef __SYNTHESIS__
+          else {
+            stats.IncrStat(rsp_backpressure_stat);
+          }
+#endif
+        }
+        if (!rsp_queue_full) {
+          if (cli_req.PopNB(curr_cli_req)) {
+            if (access()) {
+              rsp_queue.push(load_rsp);
+            }
+          }
+        }
+#ifndef __SYNTHESIS__
+        else {
+          stats.IncrStat(rsp_queue_full_stat);
+        }
+        stats.IncrStatHistogram(rsp_queue_occupancy_stat, 0, rsp_queue.NumFilled().to_uint());
+#endif
       }
 
       wait();
@@ -23,21 +23,45 @@
 
 
 // Define enums for request type
-static const unsigned int kScratchpadOpcodeSize = 1;
-enum ScratchpadOpcode {LOAD, STORE};
+// The ATOMIC_* opcodes are read-modify-write operations performed by the bank.
+// They return the old value like a load and store the result: old + data,
+// min(old, data), max(old, data), data, or data if old equals cmp (CAS).
+static const unsigned int kScratchpadOpcodeSize = 3;
+enum ScratchpadOpcode {LOAD, STORE, ATOMIC_ADD, ATOMIC_MIN, ATOMIC_MAX, ATOMIC_SWAP, ATOMIC_CAS};
 MarshallEnum(ScratchpadOpcode, kScratchpadOpcodeSize);
 
-template <typename T, unsigned int AddrWidth, unsigned int N>
+inline bool ScratchpadIsAtomic(ScratchpadOpcode op) { return op >= ATOMIC_ADD; }
+
+// Value stored by an atomic operation on old
+template <typename T>
+T ScratchpadAtomicResult(ScratchpadOpcode op, const T& old, const T& data, const T& cmp) {
+  T result = data;
+  if (op == ATOMIC_ADD) {
+    result = old + data;
+  } else if (op == ATOMIC_MIN) {
+    result = (data < old) ? data : old;
+  } else if (op == ATOMIC_MAX) {
+    result = (data > old) ? data : old;
+  } else if (op == ATOMIC_CAS) {
+    result = (old == cmp) ? data : old;
+  }
+  return result;
+}
+
+// HasCmp adds the cmp operand of ATOMIC_CAS to every lane
+template <typename T, unsigned int AddrWidth, unsigned int N, bool HasCmp = false>
 class cli_req_t : public nvhls_message 
 {
  public:
   static const unsigned int type_width = Wrapped<T>::width;
-  static const unsigned int width = 1 + N + N * (AddrWidth + type_width);
+  static const unsigned int width = kScratchpadOpcodeSize + N + N * (AddrWidth + type_width) +
+                                    (HasCmp ? N * type_width : 0);
   
   ScratchpadOpcode opcode;
   sc_lv<N> valids;
   NVUINTW(AddrWidth) addr [N];
   T data [N];
+  T cmp [HasCmp ? N : 1];
 
   template<unsigned int Size>
   void Marshall(Marshaller<Size>& m) {
@@ -47,6 +71,10 @@ class cli_req_t : public nvhls_message
     for (unsigned int i=0; i<N; i++) m & addr[i];
     #pragma hls_unroll yes
     for (unsigned int i=0; i<N; i++) m & data[i];
+    if (HasCmp) {
+      #pragma hls_unroll yes
+      for (unsigned int i=0; i<N; i++) m & cmp[i];
+    }
   }
 };
 
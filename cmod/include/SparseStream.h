@@ -0,0 +1,712 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SPARSE_STREAM_H
+#define SPARSE_STREAM_H
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_message.h>
+#include <nvhls_assert.h>
+#include <nvhls_vector.h>
+#include <comptrees.h>
+
+/**
+ * \brief Dense vector of a sparse stream, last marks the last vector of a tensor
+ * \ingroup SparseStream
+ */
+template <typename T, unsigned int Lanes>
+class sparse_dense_t : public nvhls_message {
+ public:
+  nvhls::nv_scvector<T, Lanes> data;
+  NVUINT1 last;
+  static const unsigned int width = nvhls::nv_scvector<T, Lanes>::width + 1;
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& data;
+    m& last;
+  }
+};
+
+/**
+ * \brief Bitmap of one dense vector, bit i set if lane i is nonzero
+ * \ingroup SparseStream
+ */
+template <unsigned int Lanes>
+class sparse_bitmap_t : public nvhls_message {
+ public:
+  NVUINTW(Lanes) mask;
+  NVUINT1 last;
+  static const unsigned int width = Lanes + 1;
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& mask;
+    m& last;
+  }
+};
+
+/**
+ * \brief Beat of packed nonzero values, data[0..count-1] valid
+ * \ingroup SparseStream
+ *
+ * The values of a tensor are packed into beats of Lanes values in stream order; only the beat with last set may hold fewer. A tensor without nonzeros has no beats.
+ */
+template <typename T, unsigned int Lanes>
+class sparse_values_t : public nvhls_message {
+ public:
+  static const unsigned int CountWidth = nvhls::nbits<Lanes>::val;
+  nvhls::nv_scvector<T, Lanes> data;
+  NVUINTW(CountWidth) count;
+  NVUINT1 last;
+  static const unsigned int width = nvhls::nv_scvector<T, Lanes>::width + CountWidth + 1;
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& data;
+    m& count;
+    m& last;
+  }
+};
+
+/**
+ * \brief Beat of packed CSR nonzeros, (col[i], data[i]) valid for i < count
+ * \ingroup SparseStream
+ *
+ * The nonzeros are in row-major order with increasing columns within a row, packed as sparse_values_t.
+ */
+template <typename T, typename Col, unsigned int Lanes>
+class sparse_csr_values_t : public nvhls_message {
+ public:
+  static const unsigned int CountWidth = nvhls::nbits<Lanes>::val;
+  nvhls::nv_scvector<T, Lanes> data;
+  nvhls::nv_scvector<Col, Lanes> col;
+  NVUINTW(CountWidth) count;
+  NVUINT1 last;
+  static const unsigned int width =
+      nvhls::nv_scvector<T, Lanes>::width + nvhls::nv_scvector<Col, Lanes>::width + CountWidth + 1;
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& data;
+    m& col;
+    m& count;
+    m& last;
+  }
+};
+
+/**
+ * \brief CSR row pointer: row_ptr[r + 1] of row r, last marks the last row of a tensor
+ * \ingroup SparseStream
+ *
+ * row_ptr[0] = 0 is implicit, so a tensor of R rows sends R row pointers.
+ */
+template <typename Ptr>
+class sparse_row_ptr_t : public nvhls_message {
+ public:
+  Ptr ptr;
+  NVUINT1 last;
+  static const unsigned int width = Wrapped<Ptr>::width + 1;
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& ptr;
+    m& last;
+  }
+};
+
+/**
+ * \brief Lane compaction and expansion by prefix counts
+ * \ingroup SparseStream
+ *
+ * \tparam T                Type of a lane
+ * \tparam Lanes            Number of lanes
+ *
+ * \par Overview
+ * - The rank of lane i is the number of set mask bits below it, from a PrefixCount tree. compact() moves every lane with a set mask bit to the lane of its rank, expand() moves lane rank back to every lane with a set mask bit and zeroes the others.
+ * - Every output lane is a mux over the input lanes its rank can come from, so both are a log2(Lanes)-deep prefix tree followed by a Lanes x Lanes crossbar.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <SparseStream.h>
+ *
+ *      ...
+ *      typedef SparseLanes<NVINT8, 16> lanes_t;
+ *      lanes_t::Count nnz = lanes_t::compact(dense, mask, packed);
+ *      lanes_t::expand(packed, mask, dense);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename T, unsigned int Lanes>
+class SparseLanes {
+ public:
+  typedef nvhls::nv_scvector<T, Lanes> Vector;
+  typedef NVUINTW(Lanes) Mask;
+  typedef NVUINTW(nvhls::nbits<Lanes>::val) Count;
+
+  // Packs the lanes of in with a set mask bit to the front of out, zeroes the
+  // rest of out and returns their number
+  static Count compact(const Vector& in, const Mask& mask, Vector& out) {
+    Count rank[Lanes];
+    Count total = PrefixCount<Mask, bool, Count, Lanes>::val(mask, 1, rank);
+    #pragma hls_unroll yes
+    for (unsigned k = 0; k < Lanes; k++) {
+      out[k] = 0;
+      // Lane i has a rank of at most i
+      #pragma hls_unroll yes
+      for (unsigned i = k; i < Lanes; i++) {
+        if (mask[i] == 1 && rank[i] == k) {
+          out[k] = in[i];
+        }
+      }
+    }
+    return total;
+  }
+
+  // Moves the front lanes of in to the lanes with a set mask bit, in order,
+  // and zeroes the other lanes of out
+  static void expand(const Vector& in, const Mask& mask, Vector& out) {
+    Count rank[Lanes];
+    PrefixCount<Mask, bool, Count, Lanes>::val(mask, 1, rank);
+    #pragma hls_unroll yes
+    for (unsigned i = 0; i < Lanes; i++) {
+      out[i] = 0;
+      #pragma hls_unroll yes
+      for (unsigned k = 0; k <= i; k++) {
+        if (mask[i] == 1 && rank[i] == k) {
+          out[i] = in[k];
+        }
+      }
+    }
+  }
+
+  // One lane per set bit of mask, as a Count
+  static Count popcount(const Mask& mask) { return Popcount<Mask, Count, Lanes>::val(mask); }
+};
+
+/**
+ * \brief Window of 2 * Lanes packed elements between a beat stream and its consumer
+ * \ingroup SparseStream
+ *
+ * front() are the oldest Lanes elements. A consumer pops up to Lanes of them per step, and a beat of up to Lanes elements can be appended whenever at most Lanes are held, so a stream of full beats sustains Lanes elements per step.
+ */
+template <typename T, unsigned int Lanes>
+class SparseWindow {
+ public:
+  static const unsigned int Size = 2 * Lanes;
+  typedef NVUINTW(nvhls::nbits<Size>::val) Fill;
+  typedef NVUINTW(nvhls::nbits<Lanes>::val) Count;
+
+  T data[Size];
+  Fill fill;
+
+  SparseWindow() { reset(); }
+
+  void reset() { fill = 0; }
+
+  bool canAppend() { return fill <= Lanes; }
+
+  void front(nvhls::nv_scvector<T, Lanes>& out) {
+    #pragma hls_unroll yes
+    for (unsigned i = 0; i < Lanes; i++) {
+      out[i] = data[i];
+    }
+  }
+
+  // Drops the oldest n elements
+  void pop(Count n) {
+    NVHLS_ASSERT_MSG(n <= fill, "Popping more elements than held");
+    #pragma hls_unroll yes
+    for (unsigned s = 0; s < Size; s++) {
+      #pragma hls_unroll yes
+      for (unsigned k = 1; k <= Lanes; k++) {
+        if (n == k && s + k < Size) {
+          data[s] = data[s + k];
+        }
+      }
+    }
+    fill -= n;
+  }
+
+  // Appends in[0..count-1]; needs canAppend()
+  void append(const nvhls::nv_scvector<T, Lanes>& in, Count count) {
+    NVHLS_ASSERT_MSG(canAppend(), "Appending to a full window");
+    #pragma hls_unroll yes
+    for (unsigned s = 0; s < Size; s++) {
+      #pragma hls_unroll yes
+      for (unsigned k = 0; k < Lanes; k++) {
+        if (s == fill + k && k < count) {
+          data[s] = in[k];
+        }
+      }
+    }
+    fill += count;
+  }
+};
+
+/**
+ * \brief Cycle-level bitmap decoder: bitmaps and packed values to dense vectors
+ * \ingroup SparseStream
+ *
+ * \tparam T                Type of a lane
+ * \tparam Lanes            Lanes per dense vector
+ *
+ * \par Overview
+ * - Each run() takes at most one bitmap and one beat of values, and produces the dense vector of a bitmap as soon as its values are held. Inputs are taken by clearing their valid flag.
+ * - Values wait in a SparseWindow, so one dense vector per call is sustained at any density once the first beat has arrived.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <SparseStream.h>
+ *
+ *      ...
+ *      BitmapDecoderCore<NVINT8, 16> decoder;
+ *      ...
+ *      decoder.run(bitmap_valid, bitmap, values_valid, values, dense_valid, dense);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename T, unsigned int Lanes>
+class BitmapDecoderCore {
+ public:
+  typedef SparseLanes<T, Lanes> lanes_t;
+  typedef sparse_bitmap_t<Lanes> bitmap_t;
+  typedef sparse_values_t<T, Lanes> values_t;
+  typedef sparse_dense_t<T, Lanes> dense_t;
+
+ private:
+  SparseWindow<T, Lanes> window;
+
+ public:
+  BitmapDecoderCore() { reset(); }
+
+  void reset() { window.reset(); }
+
+  void run(bool& bitmap_valid, const bitmap_t& bitmap, bool& values_valid, const values_t& values,
+           bool& out_valid, dense_t& out) {
+    out_valid = false;
+    typename lanes_t::Count need = lanes_t::popcount(bitmap.mask);
+    if (bitmap_valid && window.fill >= need) {
+      typename lanes_t::Vector packed;
+      window.front(packed);
+      lanes_t::expand(packed, bitmap.mask, out.data);
+      out.last = bitmap.last;
+      out_valid = true;
+      window.pop(need);
+      bitmap_valid = false;
+    }
+    if (values_valid && window.canAppend()) {
+      window.append(values.data, values.count);
+      values_valid = false;
+    }
+  }
+};
+
+/**
+ * \brief Cycle-level bitmap encoder: dense vectors to bitmaps and packed values
+ * \ingroup SparseStream
+ *
+ * \tparam T                Type of a lane
+ * \tparam Lanes            Lanes per dense vector
+ *
+ * \par Overview
+ * - Each run() takes at most one dense vector and produces its bitmap, plus a beat of values whenever Lanes nonzeros are held. Nonzero lanes are those that differ from 0.
+ * - At the last vector of a tensor the remaining values go out as a short beat with last set. If a full beat goes out in the same call, the short one follows in the next call, which takes no input.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <SparseStream.h>
+ *
+ *      ...
+ *      BitmapEncoderCore<NVINT8, 16> encoder;
+ *      ...
+ *      encoder.run(dense_valid, dense, bitmap_valid, bitmap, values_valid, values);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename T, unsigned int Lanes>
+class BitmapEncoderCore {
+ public:
+  typedef SparseLanes<T, Lanes> lanes_t;
+  typedef sparse_bitmap_t<Lanes> bitmap_t;
+  typedef sparse_values_t<T, Lanes> values_t;
+  typedef sparse_dense_t<T, Lanes> dense_t;
+
+ private:
+  SparseWindow<T, Lanes> window;
+  bool flushing;
+
+  void emit(typename lanes_t::Count count, bool last, values_t& values) {
+    window.front(values.data);
+    #pragma hls_unroll yes
+    for (unsigned i = 0; i < Lanes; i++) {
+      if (i >= count) {
+        values.data[i] = 0;
+      }
+    }
+    values.count = count;
+    values.last = last;
+    window.pop(count);
+  }
+
+ public:
+  BitmapEncoderCore() { reset(); }
+
+  void reset() {
+    window.reset();
+    flushing = false;
+  }
+
+  void run(bool& in_valid, const dense_t& in, bool& bitmap_valid, bitmap_t& bitmap,
+           bool& values_valid, values_t& values) {
+    bitmap_valid = false;
+    values_valid = false;
+    if (flushing) {
+      emit(window.fill, true, values);
+      values_valid = true;
+      flushing = false;
+      return;
+    }
+    if (!in_valid) {
+      return;
+    }
+    typename lanes_t::Mask mask;
+    #pragma hls_unroll yes
+    for (unsigned i = 0; i < Lanes; i++) {
+      mask[i] = (in.data[i] != 0);
+    }
+    typename lanes_t::Vector packed;
+    typename lanes_t::Count nnz = lanes_t::compact(in.data, mask, packed);
+    window.append(packed, nnz);
+    bitmap.mask = mask;
+    bitmap.last = in.last;
+    bitmap_valid = true;
+    in_valid = false;
+    if (window.fill >= Lanes) {
+      emit(Lanes, in.last && window.fill == Lanes, values);
+      values_valid = true;
+      flushing = in.last && window.fill > 0;
+    } else if (in.last && window.fill > 0) {
+      emit(window.fill, true, values);
+      values_valid = true;
+    }
+  }
+};
+
+/**
+ * \brief Cycle-level CSR decoder: walks row pointers and expands each row to dense vectors
+ * \ingroup SparseStream
+ *
+ * \tparam T                Type of a lane
+ * \tparam Lanes            Lanes per dense vector
+ * \tparam Cols             Columns of a row, a multiple of Lanes
+ * \tparam Ptr              Type of a row pointer (default: NVUINT32)
+ *
+ * \par Overview
+ * - Every row is produced as Cols / Lanes dense vectors, columns c * Lanes .. (c + 1) * Lanes - 1 in vector c, with last set on the last vector of the tensor.
+ * - The length of a row is its row pointer minus the one before. A row starts in the call that takes its pointer, so rows follow each other without a gap.
+ * - Nonzeros wait in a SparseWindow. A vector takes the leading nonzeros of the row whose column is inside it, at most Lanes, and scatters them to their lanes. It waits until the window holds Lanes nonzeros or the rest of the row, so one vector per call is sustained once the first beat has arrived.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <SparseStream.h>
+ *
+ *      ...
+ *      typedef CsrDecoderCore<NVINT8, 16, 256> csr_t;
+ *      csr_t csr;
+ *      ...
+ *      csr.run(row_ptr_valid, row_ptr, values_valid, values, dense_valid, dense);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename T, unsigned int Lanes, unsigned int Cols, typename Ptr = NVUINT32>
+class CsrDecoderCore {
+  static_assert(Cols % Lanes == 0, "CsrDecoderCore needs Cols to be a multiple of Lanes");
+
+ public:
+  static const unsigned int Chunks = Cols / Lanes;
+  typedef NVUINTW(nvhls::index_width<Cols>::val) Col;
+  typedef SparseLanes<T, Lanes> lanes_t;
+  typedef sparse_row_ptr_t<Ptr> row_ptr_t;
+  typedef sparse_csr_values_t<T, Col, Lanes> values_t;
+  typedef sparse_dense_t<T, Lanes> dense_t;
+
+ private:
+  typedef NVUINTW(nvhls::nbits<Cols>::val) RowLen;
+  typedef NVUINTW(nvhls::index_width<Chunks>::val) Chunk;
+
+  SparseWindow<T, Lanes> value_window;
+  SparseWindow<Col, Lanes> col_window;
+  bool row_active;
+  bool row_last;
+  RowLen remaining;
+  Chunk chunk;
+  Ptr prev_ptr;
+
+ public:
+  CsrDecoderCore() { reset(); }
+
+  void reset() {
+    value_window.reset();
+    col_window.reset();
+    row_active = false;
+    row_last = false;
+    remaining = 0;
+    chunk = 0;
+    prev_ptr = 0;
+  }
+
+  void run(bool& row_ptr_valid, const row_ptr_t& row_ptr, bool& values_valid,
+           const values_t& values, bool& out_valid, dense_t& out) {
+    out_valid = false;
+    if (!row_active && row_ptr_valid) {
+      NVHLS_ASSERT_MSG(row_ptr.ptr >= prev_ptr && row_ptr.ptr - prev_ptr <= Cols,
+                       "Row pointers must increase by at most Cols per row");
+      remaining = row_ptr.ptr - prev_ptr;
+      prev_ptr = row_ptr.last ? Ptr(0) : row_ptr.ptr;
+      row_last = row_ptr.last;
+      row_active = true;
+      chunk = 0;
+      row_ptr_valid = false;
+    }
+    typename lanes_t::Count avail = (remaining < Lanes) ? typename lanes_t::Count(remaining)
+                                                        : typename lanes_t::Count(Lanes);
+    if (row_active && value_window.fill >= avail) {
+      // Leading nonzeros of the row inside this vector
+      NVUINTW(nvhls::nbits<Cols>::val) base = chunk * Lanes;
+      typename lanes_t::Mask take;
+      #pragma hls_unroll yes
+      for (unsigned i = 0; i < Lanes; i++) {
+        take[i] = (i < avail) && (col_window.data[i] < base + Lanes);
+        NVHLS_ASSERT_MSG(take[i] == 0 || col_window.data[i] >= base,
+                         "CSR columns must increase within a row");
+      }
+      typename lanes_t::Count n = lanes_t::popcount(take);
+      #pragma hls_unroll yes
+      for (unsigned j = 0; j < Lanes; j++) {
+        out.data[j] = 0;
+        #pragma hls_unroll yes
+        for (unsigned i = 0; i < Lanes; i++) {
+          if (take[i] == 1 && col_window.data[i] == base + j) {
+            out.data[j] = value_window.data[i];
+          }
+        }
+      }
+      bool row_done = (chunk == Chunks - 1);
+      out.last = row_last && row_done;
+      out_valid = true;
+      value_window.pop(n);
+      col_window.pop(n);
+      remaining -= n;
+      NVHLS_ASSERT_MSG(!row_done || remaining == 0, "CSR columns must be less than Cols");
+      chunk = row_done ? Chunk(0) : Chunk(chunk + 1);
+      row_active = !row_done;
+    }
+    if (values_valid && value_window.canAppend()) {
+      value_window.append(values.data, values.count);
+      col_window.append(values.col, values.count);
+      values_valid = false;
+    }
+  }
+};
+
+/**
+ * \brief BitmapDecoderCore with latency-insensitive ports, one dense vector per cycle
+ * \ingroup SparseStream
+ */
+template <typename T, unsigned int Lanes>
+class BitmapDecoder : public sc_module {
+ public:
+  typedef BitmapDecoderCore<T, Lanes> core_t;
+  typedef typename core_t::bitmap_t bitmap_t;
+  typedef typename core_t::values_t values_t;
+  typedef typename core_t::dense_t dense_t;
+
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  Connections::In<bitmap_t> bitmap_in;
+  Connections::In<values_t> values_in;
+  Connections::Out<dense_t> out;
+
+  SC_HAS_PROCESS(BitmapDecoder);
+  BitmapDecoder(sc_module_name name_)
+      : sc_module(name_), clk("clk"), rst("rst"), bitmap_in("bitmap_in"),
+        values_in("values_in"), out("out") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+ private:
+  void run() {
+    bitmap_in.Reset();
+    values_in.Reset();
+    out.Reset();
+    core_t core;
+    bool bitmap_held = false, values_held = false, out_held = false;
+    bitmap_t bitmap_reg;
+    values_t values_reg;
+    dense_t out_reg;
+
+    #pragma hls_pipeline_init_interval 1
+    while (1) {
+      wait();
+      if (!bitmap_held) {
+        bitmap_held = bitmap_in.PopNB(bitmap_reg);
+      }
+      if (!values_held) {
+        values_held = values_in.PopNB(values_reg);
+      }
+      if (!out_held) {
+        core.run(bitmap_held, bitmap_reg, values_held, values_reg, out_held, out_reg);
+      }
+      if (out_held) {
+        out_held = !out.PushNB(out_reg);
+      }
+    }
+  }
+};
+
+/**
+ * \brief BitmapEncoderCore with latency-insensitive ports, one dense vector per cycle
+ * \ingroup SparseStream
+ */
+template <typename T, unsigned int Lanes>
+class BitmapEncoder : public sc_module {
+ public:
+  typedef BitmapEncoderCore<T, Lanes> core_t;
+  typedef typename core_t::bitmap_t bitmap_t;
+  typedef typename core_t::values_t values_t;
+  typedef typename core_t::dense_t dense_t;
+
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  Connections::In<dense_t> in;
+  Connections::Out<bitmap_t> bitmap_out;
+  Connections::Out<values_t> values_out;
+
+  SC_HAS_PROCESS(BitmapEncoder);
+  BitmapEncoder(sc_module_name name_)
+      : sc_module(name_), clk("clk"), rst("rst"), in("in"), bitmap_out("bitmap_out"),
+        values_out("values_out") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+ private:
+  void run() {
+    in.Reset();
+    bitmap_out.Reset();
+    values_out.Reset();
+    core_t core;
+    bool in_held = false, bitmap_held = false, values_held = false;
+    dense_t in_reg;
+    bitmap_t bitmap_reg;
+    values_t values_reg;
+
+    #pragma hls_pipeline_init_interval 1
+    while (1) {
+      wait();
+      if (!in_held) {
+        in_held = in.PopNB(in_reg);
+      }
+      if (!bitmap_held && !values_held) {
+        core.run(in_held, in_reg, bitmap_held, bitmap_reg, values_held, values_reg);
+      }
+      if (bitmap_held) {
+        bitmap_held = !bitmap_out.PushNB(bitmap_reg);
+      }
+      if (values_held) {
+        values_held = !values_out.PushNB(values_reg);
+      }
+    }
+  }
+};
+
+/**
+ * \brief CsrDecoderCore with latency-insensitive ports, one dense vector per cycle
+ * \ingroup SparseStream
+ */
+template <typename T, unsigned int Lanes, unsigned int Cols, typename Ptr = NVUINT32>
+class CsrDecoder : public sc_module {
+ public:
+  typedef CsrDecoderCore<T, Lanes, Cols, Ptr> core_t;
+  typedef typename core_t::row_ptr_t row_ptr_t;
+  typedef typename core_t::values_t values_t;
+  typedef typename core_t::dense_t dense_t;
+
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  Connections::In<row_ptr_t> row_ptr_in;
+  Connections::In<values_t> values_in;
+  Connections::Out<dense_t> out;
+
+  SC_HAS_PROCESS(CsrDecoder);
+  CsrDecoder(sc_module_name name_)
+      : sc_module(name_), clk("clk"), rst("rst"), row_ptr_in("row_ptr_in"),
+        values_in("values_in"), out("out") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+ private:
+  void run() {
+    row_ptr_in.Reset();
+    values_in.Reset();
+    out.Reset();
+    core_t core;
+    bool row_ptr_held = false, values_held = false, out_held = false;
+    row_ptr_t row_ptr_reg;
+    values_t values_reg;
+    dense_t out_reg;
+
+    #pragma hls_pipeline_init_interval 1
+    while (1) {
+      wait();
+      if (!row_ptr_held) {
+        row_ptr_held = row_ptr_in.PopNB(row_ptr_reg);
+      }
+      if (!values_held) {
+        values_held = values_in.PopNB(values_reg);
+      }
+      if (!out_held) {
+        core.run(row_ptr_held, row_ptr_reg, values_held, values_reg, out_held, out_reg);
+      }
+      if (out_held) {
+        out_held = !out.PushNB(out_reg);
+      }
+    }
+  }
+};
+
+#endif  // SPARSE_STREAM_H
@@ -0,0 +1,924 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SYSTOLIC_ARRAY_H
+#define SYSTOLIC_ARRAY_H
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_vector.h>
+#include <nvhls_message.h>
+#include <nvhls_assert.h>
+#include <fifo.h>
+#include <ArbitratedScratchpad.h>
+
+/**
+ * \brief Dataflow of a SystolicArray
+ * \ingroup SystolicArray
+ *
+ * - WeightStationary: PE (k, n) holds B[k][n] of a Rows x Cols tile of B. Rows of A stream in from the left and partial sums flow down, so every cycle one row of C = A * B leaves the bottom.
+ * - OutputStationary: PE (m, n) accumulates C[m][n] of a Rows x Cols tile of C. Columns of A stream in from the left and rows of B from the top; once the last k of a tile has passed, the tile drains one row per cycle.
+ */
+enum systolic_dataflow { WeightStationary, OutputStationary };
+
+template <typename InType, typename AccType, unsigned int Rows, unsigned int Cols,
+          systolic_dataflow Dataflow>
+class SystolicArray;
+
+/**
+ * \brief Weight-stationary systolic array of Rows x Cols multiply-accumulate PEs
+ * \ingroup SystolicArray
+ *
+ * \tparam InType           Type of the elements of A and B
+ * \tparam AccType          Type of the partial sums and of C
+ * \tparam Rows             Number of PE rows, the K dimension of a tile
+ * \tparam Cols             Number of PE columns, the N dimension of a tile
+ *
+ * \par Overview
+ * - run() advances the array by one cycle. An input is a row A[m][k0..k0+Rows-1] of A, an output a row C[m][n0..n0+Cols-1] of partial sums over those Rows values of k, Latency cycles later. Rows of C leave in the order the rows of A entered.
+ * - Every PE row is one nvhls::vector_mac over the Cols PEs of the row: the activations move one PE to the right per cycle and the partial sums one PE down. Input and output skew registers turn the diagonal wavefront into whole rows at the interface.
+ * - Each PE has two weight banks. Every activation carries the bank it multiplies with, so the weights of the next tile can be loaded with load_weights() while the current tile streams, without bubbles. Only load a bank for which BankBusy() is false, and do not send activations to it in the same cycle.
+ * - Every cycle of run() produces at most one output, so a caller that stalls the array simply does not call run().
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <SystolicArray.h>
+ *
+ *      ...
+ *      typedef SystolicArray<NVINT8, NVINT32, 8, 8, WeightStationary> array_t;
+ *      array_t array;
+ *      ...
+ *      for (unsigned k = 0; k < 8; k++)
+ *        array.load_weights(k, 0, b_row[k]);  // bank 0
+ *      ...
+ *      array.run(a_valid, a_row, 0, c_valid, c_row);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename InType, typename AccType, unsigned int Rows, unsigned int Cols>
+class SystolicArray<InType, AccType, Rows, Cols, WeightStationary> {
+ public:
+  typedef nvhls::nv_scvector<InType, Rows> ActVector;
+  typedef nvhls::nv_scvector<InType, Cols> WeightVector;
+  typedef nvhls::nv_scvector<AccType, Cols> OutVector;
+  typedef NVUINTW(nvhls::index_width<Rows>::val) RowIdx;
+  // Cycles from an input row to its output row
+  static const unsigned int Latency = Rows + Cols - 1;
+
+ private:
+  WeightVector weight[2][Rows];
+  // Input skew registers, row k delays its activation by k cycles
+  InType skew_act[Rows][Rows];
+  bool skew_valid[Rows][Rows];
+  bool skew_bank[Rows][Rows];
+  // Activation of every PE, passed to the right every cycle
+  InType act[Rows][Cols];
+  bool act_valid[Rows][Cols];
+  bool act_bank[Rows][Cols];
+  // Partial sum of every PE, passed down every cycle
+  OutVector psum[Rows];
+  // Output deskew registers, column n delays its result by Cols - 1 - n cycles
+  AccType deskew[Cols][Cols];
+  bool deskew_valid[Cols][Cols];
+
+ public:
+  SystolicArray() { reset(); }
+
+  void reset() {
+#pragma hls_unroll yes
+    for (unsigned k = 0; k < Rows; k++) {
+#pragma hls_unroll yes
+      for (unsigned d = 0; d < Rows; d++) {
+        skew_valid[k][d] = false;
+      }
+#pragma hls_unroll yes
+      for (unsigned n = 0; n < Cols; n++) {
+        act_valid[k][n] = false;
+      }
+    }
+#pragma hls_unroll yes
+    for (unsigned n = 0; n < Cols; n++) {
+#pragma hls_unroll yes
+      for (unsigned d = 0; d < Cols; d++) {
+        deskew_valid[n][d] = false;
+      }
+    }
+  }
+
+  // Writes row k of the B tile into a weight bank
+  void load_weights(RowIdx row, bool bank, const WeightVector& row_weights) {
+    weight[bank ? 1 : 0][row] = row_weights;
+  }
+
+  // True while activations that use the bank are in the array
+  bool BankBusy(bool bank) {
+    bool busy = false;
+#pragma hls_unroll yes
+    for (unsigned k = 0; k < Rows; k++) {
+#pragma hls_unroll yes
+      for (unsigned d = 0; d < Rows; d++) {
+        busy = busy || (d < k && skew_valid[k][d] && skew_bank[k][d] == bank);
+      }
+#pragma hls_unroll yes
+      for (unsigned n = 0; n < Cols; n++) {
+        busy = busy || (act_valid[k][n] && act_bank[k][n] == bank);
+      }
+    }
+    return busy;
+  }
+
+  bool isEmpty() { return !BankBusy(false) && !BankBusy(true) && !OutputPending(); }
+
+  void run(bool in_valid, const ActVector& in, bool in_bank, bool& out_valid,
+           OutVector& out) {
+    // Outputs: the bottom PE row, deskewed
+#pragma hls_unroll yes
+    for (unsigned n = 0; n < Cols; n++) {
+      if (n == Cols - 1) {
+        out[n] = psum[Rows - 1][n];
+      } else {
+        out[n] = deskew[n][Cols - 2 - n];
+      }
+    }
+    out_valid = (Cols == 1) ? act_valid[Rows - 1][0] : deskew_valid[0][Cols - 2];
+
+#pragma hls_unroll yes
+    for (unsigned n = 0; n + 1 < Cols; n++) {
+#pragma hls_unroll yes
+      for (unsigned d = Cols - 2 - n; d > 0; d--) {
+        deskew[n][d] = deskew[n][d - 1];
+        deskew_valid[n][d] = deskew_valid[n][d - 1];
+      }
+      deskew[n][0] = psum[Rows - 1][n];
+      deskew_valid[n][0] = act_valid[Rows - 1][n];
+    }
+
+    // Input skew: row k enters the array k cycles after the row of A
+    InType skewed[Rows];
+    bool skewed_valid[Rows];
+    bool skewed_bank[Rows];
+#pragma hls_unroll yes
+    for (unsigned k = 0; k < Rows; k++) {
+      if (k == 0) {
+        skewed[k] = in[k];
+        skewed_valid[k] = in_valid;
+        skewed_bank[k] = in_bank;
+      } else {
+        skewed[k] = skew_act[k][k - 1];
+        skewed_valid[k] = skew_valid[k][k - 1];
+        skewed_bank[k] = skew_bank[k][k - 1];
+#pragma hls_unroll yes
+        for (unsigned d = k - 1; d > 0; d--) {
+          skew_act[k][d] = skew_act[k][d - 1];
+          skew_valid[k][d] = skew_valid[k][d - 1];
+          skew_bank[k][d] = skew_bank[k][d - 1];
+        }
+        skew_act[k][0] = in[k];
+        skew_valid[k][0] = in_valid;
+        skew_bank[k][0] = in_bank;
+      }
+    }
+
+    // PE rows from the bottom, so every row reads the partial sums of the row
+    // above from the previous cycle
+#pragma hls_unroll yes
+    for (int k = Rows - 1; k >= 0; k--) {
+      WeightVector row_act, row_weights;
+#pragma hls_unroll yes
+      for (int n = Cols - 1; n >= 0; n--) {
+        if (n == 0) {
+          act[k][n] = skewed[k];
+          act_valid[k][n] = skewed_valid[k];
+          act_bank[k][n] = skewed_bank[k];
+        } else {
+          act[k][n] = act[k][n - 1];
+          act_valid[k][n] = act_valid[k][n - 1];
+          act_bank[k][n] = act_bank[k][n - 1];
+        }
+        row_act[n] = act[k][n];
+        row_weights[n] = act_bank[k][n] ? weight[1][k][n] : weight[0][k][n];
+      }
+      OutVector psum_in;
+#pragma hls_unroll yes
+      for (unsigned n = 0; n < Cols; n++) {
+        psum_in[n] = (k == 0) ? AccType(0) : psum[(k == 0) ? 0 : k - 1][n];
+      }
+      nvhls::vector_mac<InType, InType, AccType, AccType, Cols, true>(row_act, row_weights,
+                                                                     psum_in, psum[k]);
+    }
+  }
+
+ private:
+  bool OutputPending() {
+    bool pending = false;
+#pragma hls_unroll yes
+    for (unsigned n = 0; n < Cols; n++) {
+#pragma hls_unroll yes
+      for (unsigned d = 0; d < Cols; d++) {
+        pending = pending || (d + 1 + n < Cols && deskew_valid[n][d]);
+      }
+    }
+    return pending;
+  }
+};
+
+/**
+ * \brief Output-stationary systolic array of Rows x Cols multiply-accumulate PEs
+ * \ingroup SystolicArray
+ *
+ * \tparam InType           Type of the elements of A and B
+ * \tparam AccType          Type of the accumulators and of C
+ * \tparam Rows             Number of PE rows, the M dimension of a tile
+ * \tparam Cols             Number of PE columns, the N dimension of a tile
+ *
+ * \par Overview
+ * - run() advances the array by one cycle. An input is step k of a tile: the column A[m0..m0+Rows-1][k] of A and the row B[k][n0..n0+Cols-1] of B; last marks the final k of the tile.
+ * - Every PE row is one nvhls::vector_mac over the Cols PEs of the row, into the accumulators of the row: A moves one PE to the right and B one PE down per cycle, behind input skew registers.
+ * - When the last step of a tile reaches a PE, the PE hands its sum to the drain of its column and restarts from 0, so the next tile follows without bubbles. The tile leaves as Rows rows of C in order, the first one Latency cycles after the last step, through output deskew registers.
+ * - Tiles shorter than Rows steps would drain two PEs of a column in the same cycle, so ready(last) holds a last step until Rows cycles after the previous one.
+ * - Every cycle of run() produces at most one output, so a caller that stalls the array simply does not call run().
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <SystolicArray.h>
+ *
+ *      ...
+ *      typedef SystolicArray<NVINT8, NVINT32, 8, 8, OutputStationary> array_t;
+ *      array_t array;
+ *      ...
+ *      bool last = (k == K - 1);
+ *      if (array.ready(last)) {
+ *        array.run(true, a_col, b_row, last, c_valid, c_row);
+ *      }
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename InType, typename AccType, unsigned int Rows, unsigned int Cols>
+class SystolicArray<InType, AccType, Rows, Cols, OutputStationary> {
+ public:
+  typedef nvhls::nv_scvector<InType, Rows> AVector;
+  typedef nvhls::nv_scvector<InType, Cols> BVector;
+  typedef nvhls::nv_scvector<AccType, Cols> OutVector;
+  // Cycles from the last step of a tile to its first output row
+  static const unsigned int Latency = Cols;
+
+ private:
+  // Input skew registers, row m of A and column n of B are delayed by m and
+  // n cycles
+  InType skew_a[Rows][Rows];
+  bool skew_valid[Rows][Rows];
+  bool skew_last[Rows][Rows];
+  InType skew_b[Cols][Cols];
+  // Operands of every PE, A passed to the right and B down every cycle
+  InType a[Rows][Cols];
+  bool a_valid[Rows][Cols];
+  bool a_last[Rows][Cols];
+  InType b[Rows][Cols];
+  OutVector acc[Rows];
+  // Finished sums of each column, then deskewed by Cols - 1 - n cycles
+  AccType result[Cols];
+  bool result_valid[Cols];
+  AccType deskew[Cols][Cols];
+  bool deskew_valid[Cols][Cols];
+  // Cycles since the last step of the previous tile, saturating at Rows
+  NVUINTW(nvhls::index_width<Rows + 1>::val) since_last;
+
+ public:
+  SystolicArray() { reset(); }
+
+  void reset() {
+#pragma hls_unroll yes
+    for (unsigned m = 0; m < Rows; m++) {
+#pragma hls_unroll yes
+      for (unsigned d = 0; d < Rows; d++) {
+        skew_valid[m][d] = false;
+      }
+#pragma hls_unroll yes
+      for (unsigned n = 0; n < Cols; n++) {
+        a_valid[m][n] = false;
+        acc[m][n] = 0;
+      }
+    }
+#pragma hls_unroll yes
+    for (unsigned n = 0; n < Cols; n++) {
+      result_valid[n] = false;
+#pragma hls_unroll yes
+      for (unsigned d = 0; d < Cols; d++) {
+        deskew_valid[n][d] = false;
+      }
+    }
+    since_last = Rows;
+  }
+
+  // True if a step with the given last flag can enter this cycle
+  bool ready(bool last) { return !last || (since_last >= Rows); }
+
+  bool isEmpty() {
+    bool empty = true;
+#pragma hls_unroll yes
+    for (unsigned m = 0; m < Rows; m++) {
+#pragma hls_unroll yes
+      for (unsigned d = 0; d < Rows; d++) {
+        empty = empty && !(d < m && skew_valid[m][d]);
+      }
+#pragma hls_unroll yes
+      for (unsigned n = 0; n < Cols; n++) {
+        empty = empty && !a_valid[m][n];
+      }
+    }
+#pragma hls_unroll yes
+    for (unsigned n = 0; n < Cols; n++) {
+      empty = empty && !result_valid[n];
+#pragma hls_unroll yes
+      for (unsigned d = 0; d < Cols; d++) {
+        empty = empty && !(d + 1 + n < Cols && deskew_valid[n][d]);
+      }
+    }
+    return empty;
+  }
+
+  void run(bool in_valid, const AVector& a_in, const BVector& b_in, bool in_last,
+           bool& out_valid, OutVector& out) {
+    NVHLS_ASSERT_MSG(!in_valid || ready(in_last), "Last step of a tile before the array is ready");
+
+    // Outputs: the drained sums, deskewed
+#pragma hls_unroll yes
+    for (unsigned n = 0; n < Cols; n++) {
+      if (n == Cols - 1) {
+        out[n] = result[n];
+      } else {
+        out[n] = deskew[n][Cols - 2 - n];
+      }
+    }
+    out_valid = (Cols == 1) ? result_valid[0] : deskew_valid[0][Cols - 2];
+
+#pragma hls_unroll yes
+    for (unsigned n = 0; n + 1 < Cols; n++) {
+#pragma hls_unroll yes
+      for (unsigned d = Cols - 2 - n; d > 0; d--) {
+        deskew[n][d] = deskew[n][d - 1];
+        deskew_valid[n][d] = deskew_valid[n][d - 1];
+      }
+      deskew[n][0] = result[n];
+      deskew_valid[n][0] = result_valid[n];
+    }
+
+    // Input skew
+    InType skewed_a[Rows];
+    bool skewed_valid[Rows];
+    bool skewed_last[Rows];
+#pragma hls_unroll yes
+    for (unsigned m = 0; m < Rows; m++) {
+      if (m == 0) {
+        skewed_a[m] = a_in[m];
+        skewed_valid[m] = in_valid;
+        skewed_last[m] = in_last;
+      } else {
+        skewed_a[m] = skew_a[m][m - 1];
+        skewed_valid[m] = skew_valid[m][m - 1];
+        skewed_last[m] = skew_last[m][m - 1];
+#pragma hls_unroll yes
+        for (unsigned d = m - 1; d > 0; d--) {
+          skew_a[m][d] = skew_a[m][d - 1];
+          skew_valid[m][d] = skew_valid[m][d - 1];
+          skew_last[m][d] = skew_last[m][d - 1];
+        }
+        skew_a[m][0] = a_in[m];
+        skew_valid[m][0] = in_valid;
+        skew_last[m][0] = in_last;
+      }
+    }
+    InType skewed_b[Cols];
+#pragma hls_unroll yes
+    for (unsigned n = 0; n < Cols; n++) {
+      if (n == 0) {
+        skewed_b[n] = b_in[n];
+      } else {
+        skewed_b[n] = skew_b[n][n - 1];
+#pragma hls_unroll yes
+        for (unsigned d = n - 1; d > 0; d--) {
+          skew_b[n][d] = skew_b[n][d - 1];
+        }
+        skew_b[n][0] = b_in[n];
+      }
+    }
+
+    // PE rows from the bottom, so every row reads the B operands of the row
+    // above from the previous cycle
+    bool drain_valid[Cols];
+    AccType drain[Cols];
+#pragma hls_unroll yes
+    for (unsigned n = 0; n < Cols; n++) {
+      drain_valid[n] = false;
+      drain[n] = 0;
+    }
+#pragma hls_unroll yes
+    for (int m = Rows - 1; m >= 0; m--) {
+      BVector row_a, row_b;
+#pragma hls_unroll yes
+      for (int n = Cols - 1; n >= 0; n--) {
+        if (n == 0) {
+          a[m][n] = skewed_a[m];
+          a_valid[m][n] = skewed_valid[m];
+          a_last[m][n] = skewed_last[m];
+        } else {
+          a[m][n] = a[m][n - 1];
+          a_valid[m][n] = a_valid[m][n - 1];
+          a_last[m][n] = a_last[m][n - 1];
+        }
+        b[m][n] = (m == 0) ? skewed_b[n] : b[(m == 0) ? 0 : m - 1][n];
+        row_a[n] = a[m][n];
+        row_b[n] = b[m][n];
+      }
+      OutVector sum;
+      nvhls::vector_mac<InType, InType, AccType, AccType, Cols, true>(row_a, row_b, acc[m], sum);
+#pragma hls_unroll yes
+      for (unsigned n = 0; n < Cols; n++) {
+        if (a_valid[m][n]) {
+          acc[m][n] = a_last[m][n] ? AccType(0) : sum[n];
+          if (a_last[m][n]) {
+            NVHLS_ASSERT_MSG(!drain_valid[n], "Two PEs of a column drain in the same cycle");
+            drain_valid[n] = true;
+            drain[n] = sum[n];
+          }
+        }
+      }
+    }
+#pragma hls_unroll yes
+    for (unsigned n = 0; n < Cols; n++) {
+      result[n] = drain[n];
+      result_valid[n] = drain_valid[n];
+    }
+
+    if (in_valid && in_last) {
+      since_last = 1;
+    } else if (since_last < Rows) {
+      since_last++;
+    }
+  }
+};
+
+/**
+ * \brief Load and store of one scratchpad cycle with either load_store() interface
+ * \ingroup SystolicArray
+ */
+template <typename Spad>
+void systolic_spad_access(Spad& spad, typename Spad::req_t& req, typename Spad::rsp_t& rsp,
+                          bool ready[Spad::num_inputs]) {
+#ifdef HLS_ALGORITHMICC
+  spad.load_store(req, rsp, ready);
+#else
+  typename Spad::bank_req_t bank_req[Spad::num_inputs];
+  typename Spad::bank_sel_t bank_sel[Spad::num_inputs];
+  bool bank_req_valid[Spad::num_inputs];
+#pragma hls_unroll yes
+  for (unsigned i = 0; i < Spad::num_inputs; i++) {
+    Spad::map_address(req.addr[i], bank_sel[i], bank_req[i].addr);
+    bank_req[i].do_store = req.valids[i] && (req.type.val == CLITYPE_T::STORE);
+    bank_req[i].wdata = req.data[i];
+    bank_req[i].op = req.type.val;
+    bank_req[i].input_chan = i;
+    bank_req_valid[i] = req.valids[i];
+  }
+  spad.load_store(bank_req, bank_sel, bank_req_valid, rsp, ready);
+#endif
+}
+
+/**
+ * \brief Streams vectors from an ArbitratedScratchpad into a SystolicArray
+ * \ingroup SystolicArray
+ *
+ * \tparam Spad             ArbitratedScratchpad type, one lane per vector element
+ * \tparam QueueLen         Depth of the response queue of each lane (default: 4)
+ *
+ * \par Overview
+ * - start() sets up a stream of count vectors: element i of vector v is the entry at base + v * outer_stride + i * inner_stride. Lanes from lanes on are 0 and access no memory, for tiles narrower than the array.
+ * - Every cycle, request() fills the load request of the scratchpad and response() takes its ready flags and load responses. Each lane issues on its own, as long as its response queue has room, so bank conflicts only delay the lanes involved.
+ * - valid() is true when every lane has its next element; peek() gives the vector and pop() consumes it.
+ * - A new stream can start as soon as all lanes have issued the current one (IssueDone()); the vectors of both streams come out in order.
+ * - Relies on the load responses of a lane coming back in order, so the scratchpad must not use BankBypass.
+ *
+ */
+template <typename Spad, unsigned int QueueLen = 4>
+class SystolicFeeder {
+ public:
+  static const unsigned int NumLanes = Spad::num_inputs;
+  typedef typename Spad::data_t DataType;
+  typedef typename Spad::req_t req_t;
+  typedef typename Spad::rsp_t rsp_t;
+  typedef NVUINTW(Spad::addr_width) Addr;
+  typedef nvhls::nv_scvector<DataType, NumLanes> Vector;
+
+ private:
+  FIFO<DataType, QueueLen, NumLanes> lane_queues;
+  Addr next_addr[NumLanes];
+  unsigned int remaining[NumLanes];
+  unsigned int in_flight[NumLanes];  // issued and not popped
+  unsigned int pending[NumLanes];    // issued to the scratchpad and not returned
+  unsigned int outer_stride;
+  unsigned int lanes;
+
+ public:
+  SystolicFeeder() { reset(); }
+
+  void reset() {
+    lane_queues.reset();
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumLanes; i++) {
+      remaining[i] = 0;
+      in_flight[i] = 0;
+      pending[i] = 0;
+    }
+    outer_stride = 0;
+    lanes = NumLanes;
+  }
+
+  void start(Addr base, unsigned int count, unsigned int outer_stride_,
+             unsigned int inner_stride, unsigned int lanes_ = NumLanes) {
+    NVHLS_ASSERT_MSG(IssueDone(), "Feeder stream started before the previous one was issued");
+    outer_stride = outer_stride_;
+    lanes = lanes_;
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumLanes; i++) {
+      next_addr[i] = base + i * inner_stride;
+      remaining[i] = count;
+    }
+  }
+
+  bool IssueDone() {
+    bool done = true;
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumLanes; i++) {
+      done = done && (remaining[i] == 0);
+    }
+    return done;
+  }
+
+  // Nothing issued or queued
+  bool isIdle() {
+    bool idle = IssueDone();
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumLanes; i++) {
+      idle = idle && (in_flight[i] == 0);
+    }
+    return idle;
+  }
+
+  void request(req_t& req) {
+    req.type.val = CLITYPE_T::LOAD;
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumLanes; i++) {
+      req.valids[i] = (i < lanes) && (remaining[i] > 0) && (in_flight[i] < QueueLen);
+      req.addr[i] = next_addr[i];
+      req.data[i] = 0;
+    }
+  }
+
+  void response(const req_t& req, const rsp_t& rsp, const bool ready[NumLanes]) {
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumLanes; i++) {
+      bool issued = req.valids[i] && ready[i];
+      // Lanes past the tile queue a 0 without a request, once the loads of
+      // the previous stream have returned
+      bool zero = (i >= lanes) && (remaining[i] > 0) && (in_flight[i] < QueueLen) &&
+                  (pending[i] == 0) && !rsp.valids[i];
+      if (issued || zero) {
+        next_addr[i] += outer_stride;
+        remaining[i]--;
+        in_flight[i]++;
+      }
+      if (issued) {
+        pending[i]++;
+      }
+      if (rsp.valids[i]) {
+        lane_queues.push(rsp.data[i], i);
+        pending[i]--;
+      } else if (zero) {
+        lane_queues.push(DataType(0), i);
+      }
+    }
+  }
+
+  bool valid() {
+    bool all = true;
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumLanes; i++) {
+      all = all && !lane_queues.isEmpty(i);
+    }
+    return all;
+  }
+
+  Vector peek() {
+    Vector v;
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumLanes; i++) {
+      v[i] = lane_queues.peek(i);
+    }
+    return v;
+  }
+
+  void pop() {
+    NVUINTW(NumLanes) mask = ~NVUINTW(NumLanes)(0);
+    lane_queues.incrHead_all(mask);
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumLanes; i++) {
+      in_flight[i]--;
+    }
+  }
+};
+
+/**
+ * \brief Stores the output vectors of a SystolicArray into an ArbitratedScratchpad
+ * \ingroup SystolicArray
+ *
+ * \tparam Spad             ArbitratedScratchpad type, one lane per vector element
+ * \tparam QueueLen         Depth of the store queue of each lane (default: 4)
+ * \tparam Accumulate       Add the vectors to the memory with CLITYPE_T::ATOMIC_ADD instead of storing them, for partial sums over several tiles; needs a scratchpad with Atomics (default: false)
+ *
+ * \par Overview
+ * - push() queues a vector whose element i goes to base + i * inner_stride; lanes from lanes on are dropped. ready() is true when every lane has room.
+ * - Every cycle, request() fills the store request of the scratchpad and response() takes its ready flags. Each lane issues on its own.
+ * - isIdle() is true once every queued element has been issued; the scratchpad may still hold them in its input queues.
+ *
+ */
+template <typename Spad, unsigned int QueueLen = 4, bool Accumulate = false>
+class SystolicDrainer {
+ public:
+  static const unsigned int NumLanes = Spad::num_inputs;
+  typedef typename Spad::data_t DataType;
+  typedef typename Spad::req_t req_t;
+  typedef NVUINTW(Spad::addr_width) Addr;
+  typedef nvhls::nv_scvector<DataType, NumLanes> Vector;
+
+ private:
+  FIFO<DataType, QueueLen, NumLanes> data_queues;
+  FIFO<Addr, QueueLen, NumLanes> addr_queues;
+
+ public:
+  SystolicDrainer() { reset(); }
+
+  void reset() {
+    data_queues.reset();
+    addr_queues.reset();
+  }
+
+  bool ready() {
+    bool room = true;
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumLanes; i++) {
+      room = room && !data_queues.isFull(i);
+    }
+    return room;
+  }
+
+  void push(const Vector& v, Addr base, unsigned int inner_stride,
+            unsigned int lanes = NumLanes) {
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumLanes; i++) {
+      if (i < lanes) {
+        data_queues.push(v[i], i);
+        addr_queues.push(base + i * inner_stride, i);
+      }
+    }
+  }
+
+  bool isIdle() {
+    bool idle = true;
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumLanes; i++) {
+      idle = idle && data_queues.isEmpty(i);
+    }
+    return idle;
+  }
+
+  void request(req_t& req) {
+    req.type.val = Accumulate ? CLITYPE_T::ATOMIC_ADD : CLITYPE_T::STORE;
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumLanes; i++) {
+      req.valids[i] = !data_queues.isEmpty(i);
+      req.addr[i] = 0;
+      req.data[i] = 0;
+      if (req.valids[i]) {
+        req.addr[i] = addr_queues.peek(i);
+        req.data[i] = data_queues.peek(i);
+      }
+    }
+  }
+
+  void response(const req_t& req, const bool ready[NumLanes]) {
+    NVUINTW(NumLanes) mask = 0;
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumLanes; i++) {
+      mask[i] = (req.valids[i] && ready[i]) ? 1 : 0;
+    }
+    data_queues.incrHead_all(mask);
+    addr_queues.incrHead_all(mask);
+  }
+};
+
+/**
+ * \brief Row k of the B tile for a weight bank of a weight-stationary SystolicArray
+ * \ingroup SystolicArray
+ */
+template <typename InType, unsigned int Rows, unsigned int Cols>
+class systolic_weight_t : public nvhls_message {
+ public:
+  NVUINTW(nvhls::index_width<Rows>::val) row;
+  NVUINT1 bank;
+  nvhls::nv_scvector<InType, Cols> weights;
+  static const unsigned int width =
+      nvhls::index_width<Rows>::val + 1 + nvhls::nv_scvector<InType, Cols>::width;
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& row;
+    m& bank;
+    m& weights;
+  }
+};
+
+/**
+ * \brief One input step of a SystolicArray
+ * \ingroup SystolicArray
+ *
+ * WeightStationary: a row of A in a and its weight bank. OutputStationary: a
+ * column of A in a, a row of B in b and the last flag of the tile.
+ */
+template <typename InType, unsigned int Rows, unsigned int Cols, systolic_dataflow Dataflow>
+class systolic_in_t : public nvhls_message {
+ public:
+  nvhls::nv_scvector<InType, Rows> a;
+  nvhls::nv_scvector<InType, Cols> b;
+  NVUINT1 bank;
+  NVUINT1 last;
+  static const unsigned int width =
+      nvhls::nv_scvector<InType, Rows>::width + 2 +
+      ((Dataflow == OutputStationary) ? nvhls::nv_scvector<InType, Cols>::width : 0);
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& a;
+    if (Dataflow == OutputStationary) {
+      m& b;
+    }
+    m& bank;
+    m& last;
+  }
+};
+
+/**
+ * \brief One cycle of a weight-stationary SystolicArray with held inputs
+ * \ingroup SystolicArray
+ *
+ * Runs the array with the held input and loads the held weight row, unless
+ * its bank is busy or used by the held input. The input is then the older of
+ * the two: the rows of a bank are only sent after the previous activations of
+ * that bank. Clears weight_held and in_held for the inputs it consumed.
+ */
+template <typename InType, typename AccType, unsigned int Rows, unsigned int Cols>
+void systolic_array_step(SystolicArray<InType, AccType, Rows, Cols, WeightStationary>& array,
+                         bool& weight_held, const systolic_weight_t<InType, Rows, Cols>& weight,
+                         bool& in_held,
+                         const systolic_in_t<InType, Rows, Cols, WeightStationary>& in,
+                         bool& out_valid, nvhls::nv_scvector<AccType, Cols>& out) {
+  bool weight_bank = (weight.bank == 1);
+  if (weight_held && !array.BankBusy(weight_bank) && !(in_held && (in.bank == weight.bank))) {
+    array.load_weights(weight.row, weight_bank, weight.weights);
+    weight_held = false;
+  }
+  array.run(in_held, in.a, in.bank == 1, out_valid, out);
+  in_held = false;
+}
+
+/**
+ * \brief One cycle of an output-stationary SystolicArray with held inputs
+ * \ingroup SystolicArray
+ *
+ * Runs the array with the held input if SystolicArray::ready() accepts it and
+ * clears in_held then. There are no weights, weight_held is left as it is.
+ */
+template <typename InType, typename AccType, unsigned int Rows, unsigned int Cols>
+void systolic_array_step(SystolicArray<InType, AccType, Rows, Cols, OutputStationary>& array,
+                         bool& weight_held, const systolic_weight_t<InType, Rows, Cols>& weight,
+                         bool& in_held,
+                         const systolic_in_t<InType, Rows, Cols, OutputStationary>& in,
+                         bool& out_valid, nvhls::nv_scvector<AccType, Cols>& out) {
+  bool in_go = in_held && array.ready(in.last == 1);
+  array.run(in_go, in.a, in.b, in.last == 1, out_valid, out);
+  if (in_go) {
+    in_held = false;
+  }
+}
+
+/**
+ * \brief SystolicArray as an sc_module with Connections ports
+ * \ingroup SystolicArray
+ *
+ * \tparam InType           Type of the elements of A and B
+ * \tparam AccType          Type of the partial sums and of C
+ * \tparam Rows             Number of PE rows
+ * \tparam Cols             Number of PE columns
+ * \tparam Dataflow         WeightStationary or OutputStationary
+ *
+ * \par Overview
+ * - in carries the inputs of SystolicArray::run() and out the rows of C. Every cycle the module runs systolic_array_step() on the inputs it holds, unless an output is still waiting for out; a stalled output holds the array.
+ * - WeightStationary: weight_in carries the rows of B for load_weights(); a row waits while its bank is busy. The producer sends the activations of a tile only once all of its rows have been accepted, and the rows of a bank only once every activation of the previous tile on that bank has been accepted.
+ * - OutputStationary: weight_in is not used and may be tied off with a DummySource. A last step waits until SystolicArray::ready() accepts it.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <SystolicArray.h>
+ *
+ *      ...
+ *      typedef SystolicArrayModule<NVINT8, NVINT32, 8, 8, WeightStationary> array_t;
+ *      array_t array("array");
+ *      Connections::Combinational<array_t::weight_t> weight_chan;
+ *      Connections::Combinational<array_t::in_t> in_chan;
+ *      Connections::Combinational<array_t::OutVector> out_chan;
+ *
+ *      array.clk(clk);
+ *      array.rst(rst);
+ *      array.weight_in(weight_chan);
+ *      array.in(in_chan);
+ *      array.out(out_chan);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename InType, typename AccType, unsigned int Rows, unsigned int Cols,
+          systolic_dataflow Dataflow>
+class SystolicArrayModule : public sc_module {
+ public:
+  typedef SystolicArray<InType, AccType, Rows, Cols, Dataflow> array_t;
+  typedef systolic_weight_t<InType, Rows, Cols> weight_t;
+  typedef systolic_in_t<InType, Rows, Cols, Dataflow> in_t;
+  typedef nvhls::nv_scvector<AccType, Cols> OutVector;
+
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  Connections::In<weight_t> weight_in;
+  Connections::In<in_t> in;
+  Connections::Out<OutVector> out;
+
+  SC_HAS_PROCESS(SystolicArrayModule);
+  SystolicArrayModule(sc_module_name name_)
+      : sc_module(name_), clk("clk"), rst("rst"), weight_in("weight_in"), in("in"), out("out") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+ private:
+  void run() {
+    weight_in.Reset();
+    in.Reset();
+    out.Reset();
+    array_t array;
+    bool weight_held = false, in_held = false, out_held = false;
+    weight_t weight_reg;
+    in_t in_reg;
+    OutVector out_reg;
+
+    #pragma hls_pipeline_init_interval 1
+    while (1) {
+      wait();
+      if (!weight_held && (Dataflow == WeightStationary)) {
+        weight_held = weight_in.PopNB(weight_reg);
+      }
+      if (!in_held) {
+        in_held = in.PopNB(in_reg);
+      }
+      if (!out_held) {
+        systolic_array_step(array, weight_held, weight_reg, in_held, in_reg, out_held, out_reg);
+      }
+      if (out_held) {
+        out_held = !out.PushNB(out_reg);
+      }
+    }
+  }
+};
+
+#endif  // SYSTOLIC_ARRAY_H
@@ -21,6 +21,274 @@
 #include <nvhls_types.h>
 #include <nvhls_marshaller.h>
 
+namespace nvhls {
+
+/**
+ * \brief Trait for types that C++ simulation packs with shifts instead of the Marshaller
+ * \ingroup TypeToBits
+ *
+ * \tparam T    DataType
+ *
+ * \par Overview
+ * - TypeToBits, BitsToType, TypeToNVUINT and NVUINTToType normally build a Marshaller and run the Marshall() visitor of the type.  For types with packed_bits<T>::value == true, C++ simulation instead packs the bits LSB first into an array of uint64 words and converts the words directly. TypeToNVUINT and NVUINTToType then never build an sc_lv.
+ * - The trait is specialized for bool, sc_uint, sc_int, sc_biguint, sc_bigint, native_int (NVHLS_NATIVE_INT) and ac_int of up to 64 bits (HLS_CATAPULT), i.e. for every NVUINT/NVINT in C++ simulation except ac_int wider than 64 bits.
+ * - Messages declared with NVHLS_FIELDS (nvhls_message.h) are packed through their generated Pack()/Unpack().
+ * - A struct whose fields are all such integers can opt in by specializing packed_bits with value, words, Pack() and Unpack().  The layout must match its Marshall(): the first marshalled field occupies the least significant bits.
+ * - Synthesis always uses the Marshaller path.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <TypeToBits.h>
+ *
+ *      struct Flit {
+ *        NVUINT4 dest;
+ *        NVUINT12 data;
+ *        static const unsigned int width = 16;
+ *        template <unsigned int Size>
+ *        void Marshall(Marshaller<Size>& m) { m & dest; m & data; }
+ *      };
+ *
+ *      namespace nvhls {
+ *      template <>
+ *      struct packed_bits<Flit> {
+ *        static const bool value = true;
+ *        static const unsigned int words = 1;
+ *        static void Pack(const Flit& in, uint64* w) {
+ *          w[0] = in.dest.to_uint64() | (in.data.to_uint64() << 4);
+ *        }
+ *        static void Unpack(const uint64* w, Flit& out) {
+ *          out.dest = w[0] & 0xf;
+ *          out.data = w[0] >> 4;
+ *        }
+ *      };
+ *      }
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename T, typename Enable = void>
+struct packed_bits {
+  static const bool value = false;
+};
+
+#ifndef __SYNTHESIS__
+// Integers of up to 64 bits that convert to and from uint64
+template <typename T, unsigned int W>
+struct packed_bits_word {
+  static const bool value = true;
+  static const unsigned int words = 1;
+  static void Pack(const T& in, uint64* w) {
+    w[0] = static_cast<uint64>(in.to_uint64()) & (~static_cast<uint64>(0) >> (64 - W));
+  }
+  static void Unpack(const uint64* w, T& out) { out = w[0]; }
+};
+
+// Integers wider than 64 bits, copied 64 bits at a time through range()
+template <typename T, unsigned int W>
+struct packed_bits_wide {
+  static const bool value = true;
+  static const unsigned int words = (W + 63) / 64;
+  static void Pack(const T& in, uint64* w) {
+    for (unsigned int i = 0; i < words; i++) {
+      unsigned int hi = (64 * i + 63 < W) ? 64 * i + 63 : W - 1;
+      w[i] = in.range(hi, 64 * i).to_uint64();
+    }
+  }
+  static void Unpack(const uint64* w, T& out) {
+    for (unsigned int i = 0; i < words; i++) {
+      unsigned int hi = (64 * i + 63 < W) ? 64 * i + 63 : W - 1;
+      out.range(hi, 64 * i) = w[i];
+    }
+  }
+};
+
+template <>
+struct packed_bits<bool> {
+  static const bool value = true;
+  static const unsigned int words = 1;
+  static void Pack(const bool& in, uint64* w) { w[0] = in; }
+  static void Unpack(const uint64* w, bool& out) { out = (w[0] & 1) != 0; }
+};
+
+template <int W>
+struct packed_bits<sc_uint<W> > : packed_bits_word<sc_uint<W>, W> {};
+
+template <int W>
+struct packed_bits<sc_int<W> > : packed_bits_word<sc_int<W>, W> {};
+
+template <int W>
+struct packed_bits<sc_biguint<W> > : packed_bits_wide<sc_biguint<W>, W> {};
+
+template <int W>
+struct packed_bits<sc_bigint<W> > : packed_bits_wide<sc_bigint<W>, W> {};
+
+#if defined(NVHLS_NATIVE_INT)
+template <unsigned int W, bool S>
+struct packed_bits<native_int<W, S> > : packed_bits_word<native_int<W, S>, W> {};
+#endif
+
+#ifdef HLS_CATAPULT
+template <int W, bool S, bool Word = (W <= 64)>
+struct packed_bits_ac {
+  static const bool value = false;
+};
+
+template <int W, bool S>
+struct packed_bits_ac<W, S, true> : packed_bits_word<ac_int<W, S>, W> {};
+
+template <int W, bool S>
+struct packed_bits<ac_int<W, S> > : packed_bits_ac<W, S> {};
+#endif
+
+// Messages declared with NVHLS_FIELDS pack through their Pack()/Unpack()
+template <typename T>
+struct packed_bits<T, typename T::nvhls_fields_tag> {
+  typedef NVUINTW(T::width) Bits;
+  static const bool value = packed_bits<Bits>::value;
+  static const unsigned int words = (T::width + 63) / 64;
+  static void Pack(const T& in, uint64* w) { packed_bits<Bits>::Pack(in.Pack(), w); }
+  static void Unpack(const uint64* w, T& out) {
+    Bits bits;
+    packed_bits<Bits>::Unpack(w, bits);
+    out.Unpack(bits);
+  }
+};
+
+// Copies the W least significant bits of src to bit offset off of dst, which
+// must be zero there
+inline void insert_packed(uint64* dst, unsigned int off, const uint64* src, unsigned int W) {
+  for (unsigned int b = 0; b < W; b += 64) {
+    unsigned int n = (W - b < 64) ? W - b : 64;
+    uint64 v = src[b / 64] & (~static_cast<uint64>(0) >> (64 - n));
+    unsigned int pos = off + b, sh = pos % 64;
+    dst[pos / 64] |= v << sh;
+    if (sh != 0 && sh + n > 64) dst[pos / 64 + 1] |= v >> (64 - sh);
+  }
+}
+
+// Copies the W bits at bit offset off of src to the least significant bits
+// of dst
+inline void extract_packed(const uint64* src, unsigned int off, uint64* dst, unsigned int W) {
+  for (unsigned int b = 0; b < W; b += 64) {
+    unsigned int n = (W - b < 64) ? W - b : 64;
+    unsigned int pos = off + b, sh = pos % 64;
+    uint64 v = src[pos / 64] >> sh;
+    if (sh != 0 && sh + n > 64) v |= src[pos / 64 + 1] << (64 - sh);
+    dst[b / 64] = v & (~static_cast<uint64>(0) >> (64 - n));
+  }
+}
+
+#endif
+
+// Arrays of N packed elements of T, indexed with operator[], element 0 in
+// the least significant bits as in an element-by-element Marshall()
+template <typename T, unsigned int N>
+struct packed_bits_array {
+  static const unsigned int W = Wrapped<T>::width;
+  static const bool value = packed_bits<T>::value && (N > 0);
+  static const unsigned int words = (W * N + 63) / 64;
+#ifndef __SYNTHESIS__
+  template <typename A>
+  static void Pack(const A& in, uint64* w) {
+    for (unsigned int i = 0; i < words; i++) w[i] = 0;
+    for (unsigned int i = 0; i < N; i++) {
+      uint64 e[packed_bits<T>::words];
+      T val = in[i];
+      packed_bits<T>::Pack(val, e);
+      insert_packed(w, i * W, e, W);
+    }
+  }
+  template <typename A>
+  static void Unpack(const uint64* w, A& out) {
+    for (unsigned int i = 0; i < N; i++) {
+      uint64 e[packed_bits<T>::words];
+      extract_packed(w, i * W, e, W);
+      T val;
+      packed_bits<T>::Unpack(e, val);
+      out[i] = val;
+    }
+  }
+#endif
+};
+
+// Conversions of T through the Marshaller, used by synthesis and by types
+// without packed_bits
+template <typename T, bool Packed = packed_bits<T>::value>
+struct type_bits {
+  static const unsigned int width = Wrapped<T>::width;
+
+  static sc_lv<width> ToBits(const T& in) {
+    Marshaller<width> marshaller;
+    Wrapped<T> wm(in);
+    wm.Marshall(marshaller);
+    sc_lv<width> bits = marshaller.GetResult();
+    return bits;
+  }
+
+  static T FromBits(const sc_lv<width>& mbits) {
+    Marshaller<width> marshaller(mbits);
+    Wrapped<T> result;
+    result.Marshall(marshaller);
+    return result.val;
+  }
+};
+
+#ifndef __SYNTHESIS__
+template <typename T>
+struct type_bits<T, true> {
+  static const unsigned int width = Wrapped<T>::width;
+  static const unsigned int words = packed_bits<T>::words;
+
+  static sc_lv<width> ToBits(const T& in) {
+    uint64 w[words];
+    packed_bits<T>::Pack(in, w);
+    sc_lv<width> bits;
+    for (unsigned int i = 0; i < words; i++) {
+      unsigned int hi = (64 * i + 63 < width) ? 64 * i + 63 : width - 1;
+      bits.range(hi, 64 * i) = w[i];
+    }
+    return bits;
+  }
+
+  static T FromBits(const sc_lv<width>& mbits) {
+    uint64 w[words];
+    for (unsigned int i = 0; i < words; i++) {
+      unsigned int hi = (64 * i + 63 < width) ? 64 * i + 63 : width - 1;
+      w[i] = mbits.range(hi, 64 * i).to_uint64();
+    }
+    T result;
+    packed_bits<T>::Unpack(w, result);
+    return result;
+  }
+};
+#endif
+
+// Conversion between two types of the same width; packed types are copied
+// word by word without an sc_lv
+template <typename To, typename From,
+          bool Packed = packed_bits<To>::value && packed_bits<From>::value>
+struct convert_bits {
+  static To Convert(const From& in) {
+    return type_bits<To>::FromBits(type_bits<From>::ToBits(in));
+  }
+};
+
+#ifndef __SYNTHESIS__
+template <typename To, typename From>
+struct convert_bits<To, From, true> {
+  static To Convert(const From& in) {
+    uint64 w[packed_bits<From>::words];
+    packed_bits<From>::Pack(in, w);
+    To result;
+    packed_bits<To>::Unpack(w, result);
+    return result;
+  }
+};
+#endif
+
+}  // namespace nvhls
+
 /**
  * \brief Convert Type to logic vector 
  * \ingroup TypeToBits
@@ -47,11 +315,7 @@
 template <typename T>
 sc_lv<Wrapped<T>::width> TypeToBits(T in)
 {
-  Marshaller<Wrapped<T>::width> marshaller;
-  Wrapped<T> wm(in);
-  wm.Marshall(marshaller);
-  sc_lv<Wrapped<T>::width>  bits = marshaller.GetResult();
-  return bits;
+  return nvhls::type_bits<T>::ToBits(in);
 }
 
 /**
@@ -80,10 +344,7 @@ sc_lv<Wrapped<T>::width> TypeToBits(T in)
 template <typename T>
 T BitsToType(sc_lv<Wrapped<T>::width> mbits)
 {
-  Marshaller<Wrapped<T>::width> marshaller(mbits);
-  Wrapped<T> result;
-  result.Marshall(marshaller);
-  return result.val;
+  return nvhls::type_bits<T>::FromBits(mbits);
 }
 
 /**
@@ -114,7 +375,7 @@ T BitsToType(sc_lv<Wrapped<T>::width> mbits)
 template <typename T>
 NVUINTW(Wrapped<T>::width) TypeToNVUINT(T in)
 {
-  return BitsToType<NVUINTW(Wrapped<T>::width)>(TypeToBits(in));
+  return nvhls::convert_bits<NVUINTW(Wrapped<T>::width), T>::Convert(in);
 }
 
 /**
@@ -143,7 +404,113 @@ NVUINTW(Wrapped<T>::width) TypeToNVUINT(T in)
 template <typename T>
 T NVUINTToType(const NVUINTW(Wrapped<T>::width) & uintbits)
 {
-  return BitsToType<T>(TypeToBits(uintbits));
+  return nvhls::convert_bits<T, NVUINTW(Wrapped<T>::width)>::Convert(uintbits);
+}
+
+namespace nvhls {
+
+// Marshall of N elements of T as one NVUINTW(N * width) field. C++
+// simulation packs elements with packed_bits into words, synthesis with
+// set_slc/get_slc at constant offsets; other element types are marshalled
+// one by one.
+template <typename T, unsigned int N,
+          bool Packed = packed_bits_array<T, N>::value &&
+                        packed_bits<NVUINTW(Wrapped<T>::width * N)>::value>
+struct array_marshaller {
+  static const unsigned int W = Wrapped<T>::width;
+  typedef NVUINTW(W * N) Bits;
+
+  template <unsigned int Size, typename A>
+  static void Marshall(Marshaller<Size>& m, A& a) {
+#ifdef __SYNTHESIS__
+    Bits bits = 0;
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < N; i++) {
+      T val = a[i];
+      bits = nvhls::set_slc(bits, TypeToNVUINT(val), i * W);
+    }
+    m& bits;
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < N; i++) {
+      a[i] = NVUINTToType<T>(nvhls::get_slc<W>(bits, i * W));
+    }
+#else
+    for (unsigned int i = 0; i < N; i++) {
+      T val = a[i];
+      m& val;
+      a[i] = val;
+    }
+#endif
+  }
+};
+
+#ifndef __SYNTHESIS__
+template <typename T, unsigned int N>
+struct array_marshaller<T, N, true> {
+  typedef NVUINTW(Wrapped<T>::width * N) Bits;
+
+  template <unsigned int Size, typename A>
+  static void Marshall(Marshaller<Size>& m, A& a) {
+    static const unsigned int words = packed_bits_array<T, N>::words;
+    uint64 w[words], back[words];
+    packed_bits_array<T, N>::Pack(a, w);
+    Bits bits;
+    packed_bits<Bits>::Unpack(w, bits);
+    m& bits;
+    // Only an unmarshalling Marshaller changes the bits
+    packed_bits<Bits>::Pack(bits, back);
+    for (unsigned int i = 0; i < words; i++) {
+      if (back[i] != w[i]) {
+        packed_bits_array<T, N>::Unpack(back, a);
+        return;
+      }
+    }
+  }
+};
+#endif
+
+/**
+ * \brief Marshall a C array of messages as one contiguous field
+ * \ingroup TypeToBits
+ *
+ * \tparam T    Element type
+ * \tparam N    Number of elements
+ *
+ * \param[in,out]  m    Marshaller of the enclosing message
+ * \param[in,out]  a    Array, element 0 in the least significant bits
+ *
+ * \par Overview
+ * - Produces the same bits as m & a[0]; ... m & a[N-1]; but moves the whole
+ * array through the Marshaller in one NVUINTW(N * width) field instead of N
+ * fields.
+ * - In C++ simulation, elements with packed_bits are packed into 64-bit words
+ * with shifts. Synthesis packs them with set_slc/get_slc at constant offsets.
+ * - nvhls::nv_array uses it for its Marshall().
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <TypeToBits.h>
+ *
+ *      template <unsigned int N>
+ *      class Lanes : public nvhls_message {
+ *       public:
+ *        NVUINT8 data[N];
+ *        static const unsigned int width = 8 * N;
+ *        template <unsigned int Size>
+ *        void Marshall(Marshaller<Size>& m) {
+ *          nvhls::marshall_array(m, data);
+ *        }
+ *      };
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <unsigned int Size, typename T, unsigned int N>
+void marshall_array(Marshaller<Size>& m, T (&a)[N]) {
+  array_marshaller<T, N>::Marshall(m, a);
 }
 
+}  // namespace nvhls
+
 #endif
@@ -44,9 +44,223 @@
 #include <one_hot_to_bin.h>
 #include <nvhls_assert.h>
 #include <crossbar.h>
+#include <nvhls_stats.h>
+
+/**
+ * \brief Default VC configuration of WHVCRouter: every VC has BufferSize entries and all VCs are in one class
+ * \ingroup WHVCRouter
+ *
+ * \tparam BufferSize       Buffersize of input fifo
+ *
+ * \par Overview
+ * A VC configuration is a class with two constexpr static functions of the VC index:
+ * - Depth(vc): number of input buffer entries of the VC, from 1 to BufferSize. The credits of an output VC start at its depth, so the routers and endpoints on both ends of a link must use the same configuration.
+ * - Class(vc): arbitration class of the VC. Flits of a higher class win the input VC selection and the output arbitration over flits of a lower class. Within a class the input VC selection prefers VC 0 and the output arbiters stay round-robin.
+ * - With any configuration other than WHVCUniformVCs, each input port gets a WHVCPartitionedBuffer in which VC v owns Depth(v) entries, so a port holds the sum of the depths instead of NumVchannels * BufferSize entries. BufferSize is then the largest depth and sets the width of the credit counters.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <WHVCRouter.h>
+ *
+ *      ...
+ *        // Shallow request VC 0 and deep response VC 1, responses first
+ *        struct ReqRspVCs {
+ *          static constexpr int Depth(int vc) { return (vc == 0) ? 2 : 8; }
+ *          static constexpr int Class(int vc) { return (vc == 0) ? 0 : 1; }
+ *        };
+ *        WHVCSourceRouter<kNumLPorts, kNumRPorts, 2, 8, Flit_t, kNumMaxHops, ReqRspVCs> router;
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <int BufferSize>
+struct WHVCUniformVCs {
+  static constexpr int Depth(int) { return BufferSize; }
+  static constexpr int Class(int) { return 0; }
+};
+
+// Compile-time properties of the first NumVchannels VCs of a VC configuration
+template <typename VCConfig>
+constexpr int WHVCSumDepth(int num_vcs) {
+  return (num_vcs <= 0) ? 0 : VCConfig::Depth(num_vcs - 1) + WHVCSumDepth<VCConfig>(num_vcs - 1);
+}
+
+template <typename VCConfig>
+constexpr int WHVCMaxDepth(int num_vcs) {
+  return (num_vcs <= 0) ? 0
+         : (VCConfig::Depth(num_vcs - 1) > WHVCMaxDepth<VCConfig>(num_vcs - 1))
+             ? VCConfig::Depth(num_vcs - 1) : WHVCMaxDepth<VCConfig>(num_vcs - 1);
+}
+
+template <typename VCConfig>
+constexpr int WHVCMinDepth(int num_vcs) {
+  return (num_vcs <= 1) ? VCConfig::Depth(0)
+         : (VCConfig::Depth(num_vcs - 1) < WHVCMinDepth<VCConfig>(num_vcs - 1))
+             ? VCConfig::Depth(num_vcs - 1) : WHVCMinDepth<VCConfig>(num_vcs - 1);
+}
+
+template <typename VCConfig>
+constexpr bool WHVCHasClasses(int num_vcs) {
+  return (num_vcs <= 1) ? false
+         : (VCConfig::Class(num_vcs - 1) != VCConfig::Class(0)) || WHVCHasClasses<VCConfig>(num_vcs - 1);
+}
+
+/**
+ * \brief Input buffer of WHVCRouter with a different depth per VC
+ * \ingroup WHVCRouter
+ *
+ * \tparam DataType         DataType of entry
+ * \tparam NumPorts         Number of input ports
+ * \tparam NumVchannels     Number of virtual channels
+ * \tparam VCConfig         VC configuration, see WHVCUniformVCs
+ *
+ * \par Overview
+ * - Has the interface of FIFO<DataType, BufferSize, NumPorts * NumVchannels> that WHVCRouter uses, with bank port * NumVchannels + vc.
+ * - Each port has one memory of WHVCSumDepth(NumVchannels) entries, in which VC v owns the VCConfig::Depth(v) entries after those of VCs 0 to v-1. Head and tail pointers are per VC and wrap at the depth of their VC.
+ *
+ */
+template <typename DataType, int NumPorts, int NumVchannels, typename VCConfig>
+class WHVCPartitionedBuffer {
+ public:
+  static const int num_banks = NumPorts * NumVchannels;
+  static const int total_depth = WHVCSumDepth<VCConfig>(NumVchannels);
+  static const int max_depth = WHVCMaxDepth<VCConfig>(NumVchannels);
+  static_assert(WHVCMinDepth<VCConfig>(NumVchannels) >= 1, "Every VC needs at least one buffer entry");
+  static const int BankSelWidth = (num_banks == 1) ? 1 : nvhls::nbits<num_banks - 1>::val;
+  static const int AddrWidth = (max_depth == 1) ? 1 : nvhls::nbits<max_depth - 1>::val;
+  typedef NVUINTW(BankSelWidth) BankIdx;
+  typedef NVUINTW(AddrWidth) FifoIdx;
+  typedef NVUINTW(AddrWidth+1) FifoIdxPlusOne;
+  typedef NVUINTW(num_banks) BankMask;
+
+  // Same storage selection as FIFO
+#if defined(__SYNTHESIS__) || defined(FIFO_SIM_USE_MEM_ARRAY)
+  typedef mem_array_sep<DataType, total_depth * NumPorts, NumPorts> Body;
+  typedef DataType PeekRefType;
+#else
+  typedef fifo_ring_mem<DataType, total_depth, NumPorts> Body;
+  typedef const DataType& PeekRefType;
+#endif
+
+  FifoIdx head[num_banks];
+  FifoIdx tail[num_banks];
+  Body body;
+  bool last_action_was_push[num_banks];
+
+  WHVCPartitionedBuffer() { reset(); }
+
+  static int Depth(BankIdx bidx) { return VCConfig::Depth(bidx % NumVchannels); }
+
+  // First entry of the VC of bank bidx in the memory of its port
+  static int Base(BankIdx bidx) {
+    int vc = bidx % NumVchannels;
+    int base = 0;
+#pragma hls_unroll yes
+    for (int j = 0; j < NumVchannels; j++) {
+      if (j < vc)
+        base += VCConfig::Depth(j);
+    }
+    return base;
+  }
+
+  FifoIdx ModIncr(FifoIdx curr_idx, BankIdx bidx) {
+    if (curr_idx == Depth(bidx) - 1) {
+      return 0;
+    }
+    return curr_idx + 1;
+  }
+
+  void push(DataType wr_data, BankIdx bidx = 0) {
+    NVHLS_ASSERT_MSG(!isFull(bidx), "Pushing data to full FIFO");
+    body.write(Base(bidx) + tail[bidx], bidx / NumVchannels, wr_data);
+    tail[bidx] = ModIncr(tail[bidx], bidx);
+    last_action_was_push[bidx] = true;
+  }
+
+  void incrHead(BankIdx bidx = 0) {
+    NVHLS_ASSERT_MSG(!isEmpty(bidx), "Incrementing Head of empty FIFO");
+    head[bidx] = ModIncr(head[bidx], bidx);
+    last_action_was_push[bidx] = false;
+  }
+
+  DataType peek(BankIdx bidx = 0) {
+    NVHLS_ASSERT_MSG(!isEmpty(bidx), "Peeking data from empty FIFO");
+    return body.read(Base(bidx) + head[bidx], bidx / NumVchannels);
+  }
+
+  PeekRefType peekRef(BankIdx bidx = 0) {
+    NVHLS_ASSERT_MSG(!isEmpty(bidx), "Peeking data from empty FIFO");
+#if defined(__SYNTHESIS__) || defined(FIFO_SIM_USE_MEM_ARRAY)
+    return body.read(Base(bidx) + head[bidx], bidx / NumVchannels);
+#else
+    return body.readRef(Base(bidx) + head[bidx], bidx / NumVchannels);
+#endif
+  }
+
+  void incrHead_all(BankMask valid) {
+#pragma hls_unroll yes
+    for (int i = 0; i < num_banks; i++) {
+      if (valid[i] == 1) {
+        incrHead(i);
+      }
+    }
+  }
+
+  bool isEmpty(BankIdx bidx = 0) {
+    return (tail[bidx] == head[bidx]) && (!last_action_was_push[bidx]);
+  }
+
+  bool isFull(BankIdx bidx = 0) {
+    return (tail[bidx] == head[bidx]) && (last_action_was_push[bidx]);
+  }
+
+  FifoIdxPlusOne NumFilled(BankIdx bidx = 0) {
+    if (isEmpty(bidx)) {
+      return 0;
+    }
+    if (isFull(bidx)) {
+      return Depth(bidx);
+    }
+    if (head[bidx] < tail[bidx]) {
+      return (tail[bidx] - head[bidx]);
+    } else {
+      return (Depth(bidx) - head[bidx] + tail[bidx]);
+    }
+  }
+
+  FifoIdxPlusOne NumAvailable(BankIdx bidx = 0) {
+    return (Depth(bidx) - NumFilled(bidx));
+  }
+
+  void reset() {
+#pragma hls_unroll yes
+    for (int i = 0; i < num_banks; i++) {
+      head[i] = 0;
+      tail[i] = 0;
+      last_action_was_push[i] = false;
+    }
+  }
+};
+
+// Input buffer type of WHVCRouter: FIFO for the default VC configuration,
+// WHVCPartitionedBuffer for all others
+template <typename Flit_t, int NumPorts, int NumVchannels, int BufferSize,
+          typename VCConfig>
+struct WHVCInputBuffer {
+  typedef WHVCPartitionedBuffer<Flit_t, NumPorts, NumVchannels, VCConfig> type;
+};
+
+template <typename Flit_t, int NumPorts, int NumVchannels, int BufferSize>
+struct WHVCInputBuffer<Flit_t, NumPorts, NumVchannels, BufferSize,
+                       WHVCUniformVCs<BufferSize> > {
+  typedef FIFO<Flit_t, BufferSize, NumPorts * NumVchannels> type;
+};
 
 template <int NumLPorts, int NumRports, int NumVchannels, int BufferSize,
-          typename FlitType = Flit<64, 0, 0, 0, FlitId2bit, WormHole> >
+          typename FlitType = Flit<64, 0, 0, 0, FlitId2bit, WormHole>,
+          typename VCConfig = WHVCUniformVCs<BufferSize> >
 class WHVCRouterBase : public sc_module {
 public:
   typedef FlitType Flit_t;
@@ -62,8 +276,12 @@ public:
     log_num_ports = nvhls::index_width<num_ports>::val,
     buffersize = BufferSize,
     log_buffersize = nvhls::index_width<buffersize>::val,
-    log_buffersizeplus1 = nvhls::index_width<buffersize + 1>::val
+    log_buffersizeplus1 = nvhls::index_width<buffersize + 1>::val,
+    has_vc_classes = WHVCHasClasses<VCConfig>(NumVchannels)
   };
+  static_assert(WHVCMinDepth<VCConfig>(NumVchannels) >= 1 &&
+                WHVCMaxDepth<VCConfig>(NumVchannels) <= BufferSize,
+                "VC depths must be between 1 and BufferSize");
   typedef NVUINTW(log_buffersizeplus1) Credit_t;
   typedef NVUINTW(1) Credit_ret_t;
 
@@ -81,7 +299,7 @@ public:
   sc_in<bool> rst;
 
   // Input FIFO Buffer
-  FIFO<Flit_t, buffersize, num_ports * num_vchannels> ififo;
+  typename WHVCInputBuffer<Flit_t, num_ports, num_vchannels, buffersize, VCConfig>::type ififo;
 
   // Credit registers to store credits for both producer and consumer
   Credit_t credit_recv[num_ports * num_vchannels];
@@ -90,9 +308,26 @@ public:
   // Variable to register outputs
   Flit_t flit_out[num_ports];
 
+  // Simulation statistics, see WHVCSourceRouter
+  match::Stats stats;
+#ifndef __SYNTHESIS__
+  // Counters updated every cycle, registered once
+  match::Stats::StatHandle cycles_stat, flits_in_stat, flits_out_stat;
+  match::Stats::StatHandle credit_stalls_stat, arb_losses_stat, ififo_occupancy_stat;
+#endif
+
   // Constructor
   SC_HAS_PROCESS(WHVCRouterBase);
   WHVCRouterBase(sc_module_name name_) : sc_module(name_) {
+#ifndef __SYNTHESIS__
+    cycles_stat = stats.RegisterStat("cycles");
+    flits_in_stat = stats.RegisterStatIndexed("flits_in", num_ports * num_vchannels);
+    flits_out_stat = stats.RegisterStatIndexed("flits_out", num_ports * num_vchannels);
+    credit_stalls_stat = stats.RegisterStatIndexed("credit_stalls", num_ports * num_vchannels);
+    arb_losses_stat = stats.RegisterStatIndexed("arb_losses", num_ports * num_vchannels);
+    ififo_occupancy_stat =
+        stats.RegisterStatHistogram("ififo_occupancy", num_ports * num_vchannels);
+#endif
     SC_THREAD(process);
     sensitive << clk.pos();
     NVHLS_NEG_RESET_SIGNAL_IS(rst);
@@ -109,7 +344,7 @@ public:
         //          << " Read credit from credit port-"
         //          << i << " " << credit_recv[i] << endl);
       }
-      NVHLS_ASSERT_MSG(credit_recv[i] <= buffersize, "Total credits received cannot be larger than Buffer size");
+      NVHLS_ASSERT_MSG(credit_recv[i] <= VCConfig::Depth(i % num_vchannels), "Total credits received cannot be larger than Buffer size");
     }
   }
 
@@ -142,9 +377,15 @@ public:
           NVUINTW(log_num_vchannels) vcin_tmp = inflit[i].get_packet_id();
           NVHLS_ASSERT_MSG(!ififo.isFull(i * num_vchannels + vcin_tmp), "Input fifo is full");
           ififo.push(inflit[i], i * num_vchannels + vcin_tmp);
+#ifndef __SYNTHESIS__
+          stats.IncrStatIndexed(flits_in_stat, i * num_vchannels + vcin_tmp);
+#endif
         } else {
           NVHLS_ASSERT_MSG(!ififo.isFull(i), "Input fifo is full");
           ififo.push(inflit[i], i);
+#ifndef __SYNTHESIS__
+          stats.IncrStatIndexed(flits_in_stat, i);
+#endif
         }
       }
     }
@@ -158,7 +399,7 @@ public:
     for (int i = 0; i < num_ports; i++) { // Iterating through the inputs here
       // FIFO Read
       if (in_valid[i]) {
-        flit_in[i] = ififo.peek(i * num_vchannels + vcin[i]);
+        flit_in[i] = ififo.peekRef(i * num_vchannels + vcin[i]);
         DCOUT(sc_time_stamp()
               << ": " << name() << hex << " Read from FIFO:"
               << i * num_vchannels + vcin[i] << " Flit< " << flit_in[i].flit_id
@@ -199,7 +440,7 @@ public:
     // Reset credit registers
     for (int i = 0; i < num_ports * num_vchannels; i++) {
       credit_send[i] = 0;
-      credit_recv[i] = buffersize;
+      credit_recv[i] = VCConfig::Depth(i % num_vchannels);
     }
 
     #pragma hls_pipeline_init_interval 1
@@ -221,6 +462,14 @@ public:
  * \tparam BufferSize       Buffersize of input fifo 
  * \tparam FlitType         Indicates the Flit type 
  * \tparam MaxHops          Indicates Max. number of hops for SourceRouting
+ * \tparam VCConfig         Depth and arbitration class of every VC, see WHVCUniformVCs (default: BufferSize entries and one class for all VCs)
+ *
+ * \par Statistics
+ * - In C++ simulation the public member stats (match::Stats) counts per (port, VC) index port * NumVchannels + vc. The counters compile out under __SYNTHESIS__; dump them with stats.DumpStats() or stats.DumpStatsJson() at the end of simulation.
+ * - flits_in_<i>/flits_out_<i>: flits received on an input VC and sent on an output VC.
+ * - ififo_occupancy_<i>_hist_<n>: cycles with n flits in the input buffer of the VC; cycles counts all cycles.
+ * - credit_stalls_<i>: cycles in which a flit waited for the output VC and no credits were left.
+ * - arb_losses_<i>: cycles in which the flit at the input VC could go to an output but another input got it.
  *
  * \par A Simple Example
  * \code
@@ -253,11 +502,12 @@ public:
  *
  */
 template <int NumLPorts, int NumRports, int NumVchannels, int BufferSize,
-          typename FlitType, int MaxHops>
-class WHVCSourceRouter: public WHVCRouterBase<NumLPorts, NumRports, NumVchannels, BufferSize, FlitType> {
+          typename FlitType, int MaxHops,
+          typename VCConfig = WHVCUniformVCs<BufferSize> >
+class WHVCSourceRouter: public WHVCRouterBase<NumLPorts, NumRports, NumVchannels, BufferSize, FlitType, VCConfig> {
 public:
   // Declare constants
-  typedef WHVCRouterBase<NumLPorts, NumRports, NumVchannels, BufferSize, FlitType> BaseClass;
+  typedef WHVCRouterBase<NumLPorts, NumRports, NumVchannels, BufferSize, FlitType, VCConfig> BaseClass;
   typedef FlitType Flit_t;
   enum {
     num_lports = BaseClass::num_lports,
@@ -267,6 +517,7 @@ public:
     log_num_rports = BaseClass::log_num_rports,
     log_num_ports = BaseClass::log_num_ports,
     log_num_vchannels = BaseClass::log_num_vchannels,
+    has_vc_classes = BaseClass::has_vc_classes,
     dest_width_per_hop = log_num_rports + num_lports,
     dest_width = MaxHops * dest_width_per_hop,
   };
@@ -295,7 +546,19 @@ public:
       // Doing static arbitration across input VCs here. VC0 has
       // highest priority. We are assuming that input and output VCs
       // are same.
-      if (num_vchannels > 1) {
+      if (has_vc_classes) {
+        // Highest class first, then the lowest VC within the class
+        int best_class = 0;
+#pragma hls_unroll yes
+        for (int j = 0; j < num_vchannels; j++) {
+          if (!this->ififo.isEmpty(i * num_vchannels + j) &&
+              (in_valid[i] == 0 || VCConfig::Class(j) > best_class)) {
+            vcin[i] = j;
+            best_class = VCConfig::Class(j);
+            in_valid[i] = 1;
+          }
+        }
+      } else if (num_vchannels > 1) {
         NVUINTW(num_vchannels) vcin_valid = 0;
         NVUINTW(log_num_vchannels) vcin_local = 0;
 #pragma hls_unroll yes
@@ -323,7 +586,50 @@ public:
 
     }
   }
-  void compute_route(Flit_t flit_in[num_ports],
+  // Drop the requests for an output whose VC class is lower than that of
+  // another request for the same output
+  void filter_classes(NVUINTW(num_ports) in_valid,
+                      NVUINTW(log_num_vchannels) vcin[num_ports],
+                      NVUINTW(num_ports) valid[num_ports]) {
+    if (!has_vc_classes)
+      return;
+#pragma hls_unroll yes
+    for (int k = 0; k < num_ports; k++) { // Iterating through the outputs here
+      int best_class = 0;
+      bool any = false;
+#pragma hls_unroll yes
+      for (int i = 0; i < num_ports; i++) {
+        if (valid[k][i] == 1 && (!any || VCConfig::Class(vcin[i]) > best_class)) {
+          best_class = VCConfig::Class(vcin[i]);
+          any = true;
+        }
+      }
+#pragma hls_unroll yes
+      for (int i = 0; i < num_ports; i++) {
+        if (valid[k][i] == 1 && VCConfig::Class(vcin[i]) < best_class)
+          valid[k][i] = 0;
+      }
+    }
+  }
+
+  // Hook to drop requests in favor of higher priority ones before the output
+  // arbiters pick. The default keeps all requests.
+  virtual void filter_requests(NVUINTW(num_ports) in_valid,
+                               NVUINTW(log_num_vchannels) vcin[num_ports],
+                               NVUINTW(num_ports) valid[num_ports]) {}
+
+  // Hooks for flits that go to several outputs over more than one cycle:
+  // filter_pops() can keep a flit in its input buffer although it was sent,
+  // update_copies() can change the copies in flit_out before they are sent.
+  // The defaults pop every flit that was sent and keep the copies unchanged.
+  virtual void filter_pops(NVUINTW(log_num_vchannels) vcin[num_ports],
+                           bool is_push[num_ports],
+                           NVUINTW(log_num_ports) select_id[num_ports],
+                           NVUINTW(num_ports) & is_popfifo) {}
+  virtual void update_copies(bool is_push[num_ports],
+                             NVUINTW(log_num_ports) select_id[num_ports]) {}
+
+  virtual void compute_route(Flit_t flit_in[num_ports],
                      NVUINTW(log_num_vchannels) vcin[num_ports],
                      NVUINTW(num_ports) in_valid) {
 
@@ -372,6 +678,9 @@ public:
         else {
           out_stall[i] = 0;
           this->credit_recv[i * num_vchannels + vcout[i]]--;
+#ifndef __SYNTHESIS__
+          this->stats.IncrStatIndexed(this->flits_out_stat, i * num_vchannels + vcout[i]);
+#endif
         }
         DCOUT(sc_time_stamp()
               << ": " << this->name() << " OutPort " << i
@@ -458,17 +767,20 @@ public:
     }
 #endif
 
+    filter_classes(in_valid, vcin, valid);
+    filter_requests(in_valid, vcin, valid);
+
 // Arbitrate for output port if it is header flit
 #pragma hls_unroll yes
     for (int i = 0; i < num_ports; i++) { // Iterating through the outputs here
       select[i] = 0;
       if (valid[i] != 0) { // There is an input waiting to send to output
                            // i, credits are available at output
-        select[i] = arbiter[i].pick(valid[i]);
-
-        NVUINTW(num_ports) select_temp = select[i];
+        NVUINTW(num_ports) select_temp;
         NVUINTW(log_num_ports) select_id_temp;
-        one_hot_to_bin<num_ports, log_num_ports>(select_temp, select_id_temp);
+        arbitrate_and_encode<num_ports, log_num_ports>(arbiter[i], valid[i], select_temp,
+                                                       select_id_temp);
+        select[i] = select_temp;
         select_id[i] = select_id_temp;
         // DCOUT(sc_time_stamp() << ": " << name() << hex << " Output Port:" <<
         // i
@@ -517,6 +829,32 @@ public:
 #endif
   }
 
+  // Update the simulation statistics of one call of run()
+  void UpdateStats(NVUINTW(num_ports) in_valid,
+                   NVUINTW(log_num_vchannels) vcin[num_ports],
+                   NVUINTW(num_ports) valid[num_ports],
+                   NVUINTW(num_ports) select[num_ports]) {
+#ifndef __SYNTHESIS__
+    this->stats.IncrStat(this->cycles_stat);
+    for (int i = 0; i < num_ports * num_vchannels; i++) {
+      this->stats.IncrStatHistogram(this->ififo_occupancy_stat, i, this->ififo.NumFilled(i));
+    }
+    for (int i = 0; i < num_ports; i++) {
+      if (!in_valid[i])
+        continue;
+      for (int k = 0; k < num_ports; k++) {
+        int out_idx = k * num_vchannels + vcin[i];
+        if (out_dest[i][vcin[i]][k] == 1 && this->credit_recv[out_idx] == 0) {
+          this->stats.IncrStatIndexed(this->credit_stalls_stat, out_idx);
+        }
+        if (valid[k][i] == 1 && select[k][i] == 0) {
+          this->stats.IncrStatIndexed(this->arb_losses_stat, i * num_vchannels + vcin[i]);
+        }
+      }
+    }
+#endif
+  }
+
   void reset() {
     out_stall = 0;
     for (int i = 0; i < num_ports * num_vchannels; i++) {
@@ -561,6 +899,7 @@ public:
     // select[x] - bitmap of selected input port (one hot) for output port x
     // select_id[x] - selected input port for output port x
     arbitration(flit_in, in_valid, vcin, valid, select, select_id);
+    UpdateStats(in_valid, vcin, valid, select);
 
     // decide which port is going to push data out
     // side effect updating is_push[x] to indicate that output port x is going
@@ -582,24 +921,29 @@ public:
       }
     }
 
+    filter_pops(vcin, is_push, select_id, is_popfifo);
+
 // pop input fifos and prepare credits to be returned to sources
+    NVUINTW(num_ports * num_vchannels) pop_mask = 0;
 #pragma hls_unroll yes
     for (int i = 0; i < num_ports; i++) { // Iterating over inputs here
       if (is_popfifo[i] == 1) {
-        this->ififo.incrHead(i * num_vchannels + vcin[i]);
+        pop_mask[i * num_vchannels + vcin[i]] = 1;
         // DCOUT(sc_time_stamp() << ": " << name() << " Popped FIFO of port-"
         // << i
         //          << " VC-" << vcin[i] << endl);
         this->credit_send[i * num_vchannels + vcin[i]]++;
-        NVHLS_ASSERT_MSG(this->credit_send[i * num_vchannels + vcin[i]] <= BaseClass::buffersize, "Total credits cannot be larger than buffer size");
+        NVHLS_ASSERT_MSG(this->credit_send[i * num_vchannels + vcin[i]] <= VCConfig::Depth(vcin[i]), "Total credits cannot be larger than buffer size");
       }
     }
+    this->ififo.incrHead_all(pop_mask);
 
     // fill_ififo();
     this->send_credit();
     NVUINTW(log_num_vchannels) vcout[num_ports];
 
     this->crossbar_traversal(flit_in, is_push, select_id, vcin, vcout);
+    update_copies(is_push, select_id);
 
     // sends out flits to be sent
     // side effect: updating is_get_new_packet[x] when tail goes through port
@@ -609,4 +953,274 @@ public:
   }
 };
 
+// Routing on a 2D mesh from destination coordinates
+/**
+ * \brief Routing algorithms of WHVCMeshRouter
+ * \ingroup WHVCRouter
+ *
+ * - XYRouting: dimension order, X first.
+ * - YXRouting: dimension order, Y first.
+ * - WestFirstAdaptive: minimal adaptive routing under the west-first turn model. Packets that still have to travel west go west first; all others choose among the productive east/north/south ports the one with more credits for their virtual channel, preferring X on ties. Like dimension-order routing it is deadlock-free on a mesh.
+ */
+enum WHVCRoutingAlgo { XYRouting, YXRouting, WestFirstAdaptive };
+
+// Specialization for routing on a 2D mesh
+/**
+ * \brief Wormhole Router with virtual channels for a 2D mesh that computes routes from destination coordinates
+ * \ingroup WHVCRouter
+ *
+ * \tparam NumLPorts        Number of local ingress/egress ports
+ * \tparam NumVchannels     Number of virtual channels
+ * \tparam BufferSize       Buffersize of input fifo
+ * \tparam FlitType         Indicates the Flit type
+ * \tparam CoordWidth       Width of the X and the Y coordinate
+ * \tparam Algo             Routing algorithm (default: XYRouting)
+ * \tparam Lookahead        Enable lookahead routing (default: false)
+ * \tparam ExpressVC        Virtual channel for express traffic, -1 for none (default: -1)
+ * \tparam Multicast        Route on a destination bitmap and replicate flits (default: false)
+ * \tparam Concentrated     Binary local destination for many local ports per router (default: false)
+ * \tparam VCConfig         Depth and arbitration class of every VC, see WHVCUniformVCs (default: BufferSize entries and one class for all VCs)
+ *
+ * \par Overview
+ * - Remote ports are num_lports + {0, 1, 2, 3} = {east (+X), west (-X), north (+Y), south (-Y)}.
+ * - The header flit carries <Y>:<X>:<Local Dst> in its LSBs: the destination coordinate and the 1-hot local destination at that router, i.e. 2 * CoordWidth + NumLPorts bits instead of MaxHops * dest_width_per_hop for source routing.
+ * - The coordinate of each router is given to the constructor. Everything else, including arbitration, virtual channels and credits, is the same as WHVCSourceRouter.
+ * - With Lookahead, the header carries <Next Dst>:<Y>:<X>:<Local Dst>, where Next Dst is the 1-hot output port at the receiving router. A router uses Next Dst as its route and computes Next Dst for the neighbor on the chosen port, so the coordinate comparison happens in parallel with switch arbitration instead of before it. A Next Dst of 0 (e.g. from the injecting source) makes the router compute its own route first. Lookahead needs a deterministic algorithm, since the credits of the next router are not known.
+ * - With ExpressVC, flits on that VC that go straight through the router (e.g. in from west, out to east) win the output over all other requests, so long-distance traffic on the express VC is not delayed by turning and local traffic at intermediate routers. Other requests for that output wait while such a flit is waiting. Express flits are still buffered and use credits like all other flits. Use VC 0 where possible, since the input VC selection already prefers VC 0.
+ * - With Multicast, the header flit carries <Nodes>:<Local Dst>, where bit y * 2^CoordWidth + x of Nodes selects the router at (x, y). Each node is routed with the deterministic algorithm, which builds a tree. The flit is sent to every output port that leads to one of the nodes, and each copy of the header only keeps the nodes behind its port. Copies may leave in different cycles; the flit stays in its input buffer until all copies are sent, and each copy uses the credits of its own output. Unicast is a bitmap with one bit set. On the source side nothing changes: a Packet with DestWidthPerHop = NumLPorts + 2^(2 * CoordWidth) and MaxHops = 1 carries the bitmap in dest, which OutNetwork sets from its route port and serializer puts into the header flit. OutNetworkCredit does not fit, since every receiver of a multicast packet would return a credit. Multi-flit packets hold all their outputs until the tail, so multicast trees that overlap can deadlock; send multicast packets as single flits or on their own VC. Do not combine with ENABLE_MULTICAST.
+ * - With Concentrated, the header flit carries <Y>:<X>:<Local Id>, where Local Id is the binary index of the local port, i.e. log2(NumLPorts) bits instead of the NumLPorts bits of the 1-hot Local Dst. This keeps the header small with 8 to 16 endpoints per router, which cuts the number of routers and hops of a large mesh. The crossbar of the router already connects every local port to every other one, so traffic between endpoints of the same router never uses a remote port. Lookahead works as before, with Next Dst above the Local Id. Not with Multicast, whose header is a node bitmap.
+ * - VC and switch allocation are already done in the same step: a header only requests an output if its VC there is free (is_get_new_packet), so there is no separate VC allocation stage to speculate on.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <WHVCRouter.h>
+ *
+ *      ...
+ *        typedef Flit<64, 0, 0, 0, FlitId2bit, WormHole> Flit_t;
+ *        WHVCMeshRouter<1, 2, 8, Flit_t, 3, WestFirstAdaptive> router("router", x, y);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <int NumLPorts, int NumVchannels, int BufferSize, typename FlitType,
+          int CoordWidth, WHVCRoutingAlgo Algo = XYRouting, bool Lookahead = false,
+          int ExpressVC = -1, bool Multicast = false, bool Concentrated = false,
+          typename VCConfig = WHVCUniformVCs<BufferSize> >
+class WHVCMeshRouter
+    : public WHVCSourceRouter<NumLPorts, 4, NumVchannels, BufferSize, FlitType, 1, VCConfig> {
+public:
+  typedef WHVCSourceRouter<NumLPorts, 4, NumVchannels, BufferSize, FlitType, 1, VCConfig> BaseClass;
+  typedef FlitType Flit_t;
+  enum {
+    num_lports = BaseClass::num_lports,
+    num_ports = BaseClass::num_ports,
+    num_vchannels = BaseClass::num_vchannels,
+    log_num_vchannels = BaseClass::log_num_vchannels,
+    log_num_ports = BaseClass::log_num_ports,
+    coord_width = CoordWidth,
+    num_nodes = 1 << (2 * coord_width),
+    local_width = Concentrated ? nvhls::index_width<num_lports>::val : num_lports,
+    next_dest_lsb = 2 * coord_width + local_width,
+    dest_width = Multicast ? (local_width + num_nodes)
+                           : (next_dest_lsb + (Lookahead ? num_ports : 0)),
+    port_east = num_lports,
+    port_west = num_lports + 1,
+    port_north = num_lports + 2,
+    port_south = num_lports + 3
+  };
+  typedef NVUINTW(coord_width) Coord_t;
+  static_assert(dest_width <= FlitType::data_width,
+                "Mesh destination does not fit into the header flit");
+  static_assert(!Lookahead || Algo != WestFirstAdaptive,
+                "Lookahead routing needs a deterministic routing algorithm");
+  static_assert(ExpressVC < num_vchannels, "Express VC does not exist");
+  static_assert(!Multicast || (!Lookahead && Algo != WestFirstAdaptive),
+                "Multicast needs a deterministic routing algorithm without lookahead");
+  static_assert(!Multicast || !Concentrated,
+                "Multicast needs the 1-hot local destination");
+  typedef NVUINTW(num_nodes) Nodes_t;
+
+  // Coordinate of this router
+  Coord_t pos_x, pos_y;
+
+  // Multicast: nodes behind each remote output for the header at each input
+  Nodes_t copy_nodes[num_ports][4];
+  // Multicast: outputs that already got the flit at the top of each input VC
+  NVUINTW(num_ports) served[num_ports * num_vchannels];
+
+  WHVCMeshRouter(sc_module_name name_, unsigned int x = 0, unsigned int y = 0)
+      : BaseClass(name_), pos_x(x), pos_y(y) {}
+
+  // Deterministic route at router (at_x, at_y), 1-hot over output ports
+  NVUINTW(num_ports) route_at(Coord_t at_x, Coord_t at_y, Coord_t dst_x,
+                              Coord_t dst_y, NVUINTW(num_lports) ldest) {
+    NVUINTW(num_ports) dest = 0;
+    bool go_x = (dst_x != at_x);
+    bool go_y = (dst_y != at_y);
+    int port_x = (dst_x > at_x) ? port_east : port_west;
+    int port_y = (dst_y > at_y) ? port_north : port_south;
+    if (!go_x && !go_y) {
+      dest = ldest;
+    } else if (Algo == YXRouting) {
+      dest[go_y ? port_y : port_x] = 1;
+    } else {
+      dest[go_x ? port_x : port_y] = 1;
+    }
+    return dest;
+  }
+
+  void compute_route(Flit_t flit_in[num_ports],
+                     NVUINTW(log_num_vchannels) vcin[num_ports],
+                     NVUINTW(num_ports) in_valid) {
+
+#pragma hls_unroll yes
+    for (int i = 0; i < num_ports; i++) { // Iterating through the inputs here
+      if (in_valid[i] && flit_in[i].flit_id.isHeader()) {
+        NVUINTW(num_lports) ldest = 0;
+        if (Concentrated) {
+          NVUINTW(local_width) local_id = nvhls::get_slc<local_width>(flit_in[i].data, 0);
+          NVHLS_ASSERT_MSG(local_id < num_lports, "Local destination does not exist");
+          ldest[local_id] = 1;
+        } else {
+          ldest = nvhls::get_slc<num_lports>(flit_in[i].data, 0);
+        }
+        Coord_t dst_x = nvhls::get_slc<coord_width>(flit_in[i].data, local_width);
+        Coord_t dst_y = nvhls::get_slc<coord_width>(flit_in[i].data, local_width + coord_width);
+
+        NVUINTW(num_ports) dest = route_at(pos_x, pos_y, dst_x, dst_y, ldest);
+        if (Multicast) {
+          // Route every node and collect the nodes behind each output
+          Nodes_t nodes = nvhls::get_slc<num_nodes>(flit_in[i].data, local_width);
+          dest = 0;
+#pragma hls_unroll yes
+          for (int r = 0; r < 4; r++) {
+            copy_nodes[i][r] = 0;
+          }
+#pragma hls_unroll yes
+          for (int n = 0; n < num_nodes; n++) {
+            if (nodes[n] == 1) {
+              NVUINTW(num_ports) node_dest =
+                  route_at(pos_x, pos_y, n % (1 << coord_width), n >> coord_width, ldest);
+              dest |= node_dest;
+#pragma hls_unroll yes
+              for (int r = 0; r < 4; r++) {
+                if (node_dest[num_lports + r] == 1)
+                  copy_nodes[i][r][n] = 1;
+              }
+            }
+          }
+        } else if (Lookahead) {
+          NVUINTW(num_ports)
+          next_dest = nvhls::get_slc<num_ports>(flit_in[i].data, next_dest_lsb);
+          if (next_dest != 0)
+            dest = next_dest;
+          // Route at the neighbor on each remote port, selected by dest
+          NVUINTW(num_ports) la_dest = 0;
+          if (dest[port_east])
+            la_dest = route_at(pos_x + 1, pos_y, dst_x, dst_y, ldest);
+          if (dest[port_west])
+            la_dest = route_at(pos_x - 1, pos_y, dst_x, dst_y, ldest);
+          if (dest[port_north])
+            la_dest = route_at(pos_x, pos_y + 1, dst_x, dst_y, ldest);
+          if (dest[port_south])
+            la_dest = route_at(pos_x, pos_y - 1, dst_x, dst_y, ldest);
+          flit_in[i].data = nvhls::set_slc(flit_in[i].data, la_dest, next_dest_lsb);
+        } else if (Algo == WestFirstAdaptive) {
+          // West first, then adaptive among the productive ports
+          bool go_x = (dst_x != pos_x);
+          bool go_y = (dst_y != pos_y);
+          if (go_x && go_y && (dst_x > pos_x)) {
+            int port_y = (dst_y > pos_y) ? port_north : port_south;
+            int out_vc_x = port_east * num_vchannels + vcin[i];
+            int out_vc_y = port_y * num_vchannels + vcin[i];
+            if (this->credit_recv[out_vc_y] > this->credit_recv[out_vc_x]) {
+              dest = 0;
+              dest[port_y] = 1;
+            }
+          }
+        }
+        this->out_dest[i][vcin[i]] = dest;
+      }
+    }
+  }
+
+  // Express flits going straight through win their output
+  void filter_requests(NVUINTW(num_ports) in_valid,
+                       NVUINTW(log_num_vchannels) vcin[num_ports],
+                       NVUINTW(num_ports) valid[num_ports]) {
+    if (Multicast) {
+#pragma hls_unroll yes
+      for (int i = 0; i < num_ports; i++) { // Iterating through the inputs here
+#pragma hls_unroll yes
+        for (int k = 0; k < num_ports; k++) {
+          if (served[i * num_vchannels + vcin[i]][k] == 1)
+            valid[k][i] = 0;
+        }
+      }
+    }
+    if (ExpressVC < 0)
+      return;
+#pragma hls_unroll yes
+    for (int k = num_lports; k < num_ports; k++) { // Iterating through the remote outputs here
+      // Input on the opposite side of output k
+      int i = num_lports + ((k - num_lports) ^ 1);
+      if (valid[k][i] && vcin[i] == ExpressVC) {
+        valid[k] = 0;
+        valid[k][i] = 1;
+      }
+    }
+  }
+
+  // Multicast: pop a flit only once all its outputs got a copy
+  void filter_pops(NVUINTW(log_num_vchannels) vcin[num_ports],
+                   bool is_push[num_ports],
+                   NVUINTW(log_num_ports) select_id[num_ports],
+                   NVUINTW(num_ports) & is_popfifo) {
+    if (!Multicast)
+      return;
+#pragma hls_unroll yes
+    for (int i = 0; i < num_ports; i++) { // Iterating through the inputs here
+      NVUINTW(num_ports) granted = 0;
+#pragma hls_unroll yes
+      for (int k = 0; k < num_ports; k++) {
+        if (is_push[k] && select_id[k] == i)
+          granted[k] = 1;
+      }
+      if (granted != 0) {
+        int idx = i * num_vchannels + vcin[i];
+        NVUINTW(num_ports) all_served = served[idx] | granted;
+        if (all_served == this->out_dest[i][vcin[i]]) {
+          served[idx] = 0;
+        } else {
+          served[idx] = all_served;
+          is_popfifo[i] = 0;
+        }
+      }
+    }
+  }
+
+  // Multicast: each copy of a header keeps the nodes behind its output
+  void update_copies(bool is_push[num_ports],
+                     NVUINTW(log_num_ports) select_id[num_ports]) {
+    if (!Multicast)
+      return;
+#pragma hls_unroll yes
+    for (int k = num_lports; k < num_ports; k++) { // Iterating through the remote outputs here
+      if (is_push[k] && this->flit_out[k].flit_id.isHeader()) {
+        this->flit_out[k].data = nvhls::set_slc(
+            this->flit_out[k].data, copy_nodes[select_id[k]][k - num_lports], local_width);
+      }
+    }
+  }
+
+  void reset() {
+    BaseClass::reset();
+    for (int i = 0; i < num_ports * num_vchannels; i++) {
+      served[i] = 0;
+    }
+  }
+};
+
 #endif //__WHVCROUTER_H__
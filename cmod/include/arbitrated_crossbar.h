@@ -36,6 +36,26 @@
  * \tparam NumOutputs       Number of Outputs 
  * \tparam LenInputBuffer   Length of Input Buffer 
  * \tparam LenOutputBuffer  Length of Output Buffer 
+ * \tparam ArbiterType      Arbitration method of the per-output arbiters, see Arbiter (default: Roundrobin)
+ * \tparam NumPipelineStages Number of register stages between arbitration and data traversal to the outputs (default: 0)
+ * \tparam Speedup          Internal speedup, the number of inputs that can write to the same output buffer per cycle, 1 to 4 (default: 1)
+ *
+ * \par Pipelining
+ * - With NumPipelineStages > 0 the arbitrated data, valid and source of every output pass through that many registers before they reach the output buffer, or the outputs if there is no output buffer.
+ * - Input queues are popped at arbitration time, so input readiness is unaffected.
+ * - With an output buffer an output is only arbitrated while its free entries exceed the number of entries in flight in the pipeline for it, so the pipeline never pushes into a full output buffer.
+ * - isAllOutputEmpty() also requires the pipeline to be empty.
+ *
+ * \par Speedup
+ * - With Speedup > 1 the arbiter of each output grants up to Speedup requesting inputs per cycle, so several inputs contending for one output all advance. This approximates an output-queued switch and removes most of the head-of-line blocking of the input queues under bursty traffic (see the ArbitratedCrossbarTop benchmark).
+ * - The output buffer of each output is split into Speedup banks of ceil(LenOutputBuffer / Speedup) entries. Granted data is written to consecutive banks and read from them in the same roundrobin order, so every bank has one write port and the outputs still deliver one flit per cycle, in order.
+ * - An output grants as many inputs as its output buffer has free entries, up to Speedup, so Speedup > 1 needs LenOutputBuffer > 0.
+ * - source returns the input of the first grant of each output.
+ *
+ * \par Packet hold
+ * - run() with a hold array keeps every output whose hold is set on the input it granted last, e.g. from the header to the tail flit of a packet, so flits of different packets to one output do not interleave (wormhole allocation).
+ * - A held output only forwards that input, one flit per cycle, and grants nothing while the input has no flit for it. The arbiter priorities are not updated while held, and the arbiter moves past the input when the hold is released.
+ * - The per-output arbiters are LockableArbiter, so the hold only adds a mux after each arbiter. run() without hold ties it to false.
  *
  * \par A Simple Example
  * \code
@@ -62,8 +82,12 @@
  */
 
 template <typename DataType, unsigned int NumInputs, unsigned int NumOutputs,
-          unsigned int LenInputBuffer, unsigned int LenOutputBuffer>
+          unsigned int LenInputBuffer, unsigned int LenOutputBuffer,
+          arbiter_type ArbiterType = Roundrobin,
+          unsigned int NumPipelineStages = 0, unsigned int Speedup = 1>
 class ArbitratedCrossbar {
+  static_assert(Speedup >= 1 && Speedup <= 4, "Speedup must be 1 to 4");
+  static_assert(Speedup == 1 || LenOutputBuffer > 0, "Speedup needs an output buffer");
 
  public:
   // Define int types for input and output indices
@@ -113,9 +137,27 @@ class ArbitratedCrossbar {
   #else
   FIFO<DataDestType, LenInputBuffer,  NumInputs> input_queues;
   #endif
-  FIFO<DataType, LenOutputBuffer, NumOutputs> output_queues;
-
-  Arbiter<NumInputs> arbiters[NumOutputs];
+  // Lane out * Speedup + k carries the k-th grant of output out, and bank
+  // out * Speedup + b of the output queues is bank b of output out
+  static const unsigned int NumLanes = NumOutputs * Speedup;
+  static const unsigned int LenOutputBank = (LenOutputBuffer + Speedup - 1) / Speedup;
+  typedef NVUINTW(nvhls::index_width<Speedup>::val) BankIdx;
+  FIFO<DataType, LenOutputBank, NumLanes> output_queues;
+  BankIdx write_bank[NumOutputs];
+  BankIdx read_bank[NumOutputs];
+
+  LockableArbiter<NumInputs, ArbiterType> arbiters[NumOutputs];
+
+  // Pipeline registers between arbitration and the outputs, stage 0 is
+  // written by the arbiters
+  static const unsigned int PipeDepth = (NumPipelineStages > 0) ? NumPipelineStages : 1;
+  DataType pipe_data[PipeDepth][NumLanes];
+  bool pipe_valid[PipeDepth][NumLanes];
+  InputIdx pipe_source[PipeDepth][NumLanes];
+
+  static BankIdx next_bank(BankIdx bank) {
+    return (bank == Speedup - 1) ? BankIdx(0) : BankIdx(bank + 1);
+  }
 
  public:
   ArbitratedCrossbar() { reset(); }
@@ -130,6 +172,15 @@ class ArbitratedCrossbar {
     for (unsigned out = 0; out < NumOutputs; out++) {
       output_queues.reset();
       arbiters[out].reset();
+      write_bank[out] = 0;
+      read_bank[out] = 0;
+    }
+#pragma hls_unroll yes
+    for (unsigned stage = 0; stage < PipeDepth; stage++) {
+#pragma hls_unroll yes
+      for (unsigned lane = 0; lane < NumLanes; lane++) {
+        pipe_valid[stage][lane] = false;
+      }
     }
   }
 
@@ -141,7 +192,7 @@ class ArbitratedCrossbar {
 
   bool isOutputEmpty(OutputIdx index) {
     NVHLS_ASSERT_MSG(index <= NumOutputs, "Output index greater than number of outputs");
-    return output_queues.isEmpty(index);
+    return output_queues.isEmpty(index * Speedup + read_bank[index]);
   }
 
   bool isInputFull(InputIdx index) {
@@ -151,7 +202,17 @@ class ArbitratedCrossbar {
 
   bool isOutputFull(OutputIdx index) {
     NVHLS_ASSERT_MSG(index <= NumOutputs, "Output index greater than number of outputs");
-    return output_queues.isFull(index);
+    return output_queues.isFull(index * Speedup + write_bank[index]);
+  }
+
+  // Free entries of the output buffer of a given output lane, over all banks
+  unsigned int OutputSpace(OutputIdx index) {
+    unsigned int space = 0;
+#pragma hls_unroll yes
+    for (unsigned bank = 0; bank < Speedup; bank++) {
+      space += output_queues.NumAvailable(index * Speedup + bank);
+    }
+    return space;
   }
 
   // Add data to a specified input lane, with a specified destination lane
@@ -169,15 +230,25 @@ class ArbitratedCrossbar {
     #endif
   }
 
-  DataType peek(OutputIdx index) { return output_queues.peek(index); }
+  DataType peek(OutputIdx index) {
+    return output_queues.peek(index * Speedup + read_bank[index]);
+  }
 
   // Pop the data from a specified output lane
-  DataType pop(OutputIdx index) { return output_queues.pop(index); }
+  DataType pop(OutputIdx index) {
+    BankIdx bank = read_bank[index];
+    read_bank[index] = next_bank(bank);
+    return output_queues.pop(index * Speedup + bank);
+  }
 
-  // Run the crossbar (not the queues)
+  // Run the crossbar (not the queues). The outputs are per lane: lane
+  // out * Speedup + k carries the k-th grant of output out, and may only be
+  // granted if output_ready of the lane is set. An output with hold set only
+  // grants its last granted input, on its first lane
   void xbar(DataDest input_data[NumInputs], bool input_valid[NumInputs],
-            bool input_consumed[NumInputs], DataType data_out[NumOutputs],
-            bool valid_out[NumOutputs], bool output_ready[NumOutputs], InputIdx source[NumOutputs]) {
+            bool input_consumed[NumInputs], DataType data_out[NumLanes],
+            bool valid_out[NumLanes], bool output_ready[NumLanes], InputIdx source[NumLanes],
+            const bool hold[NumOutputs]) {
 
     // For each input lane, read the data at the head of the queue, and store it
     // in a temporary array
@@ -223,34 +294,42 @@ class ArbitratedCrossbar {
 // Loop over output lanes: run arbiter, then resolve contention
 #pragma hls_unroll yes
     for (unsigned out = 0; out < NumOutputs; out++) {
-      valid_out[out] = false;
-
-      NVUINTW(NumInputs) one_hot_grant = 0;
-      InputIdx source_local;
-
-      // Stall the arbiters and the crossbar if the output is full
-      // This is also needed to get any pipelining (otherwise the tool will
-      // infer that you want to write in a single cycle)
-      // For some reason separating these two if statements gives better results
-      if (output_ready[out]) {
-
-        // Run through the Arbiter pick() function, convert to binary
-        one_hot_grant = arbiters[out].pick(requests[out]);
-        one_hot_to_bin<NumInputs, log2_inputs>(one_hot_grant, source_local);
-      }
+      // Inputs not granted by the previous lanes of this output
+      NVUINTW(NumInputs) remaining = requests[out];
+#pragma hls_unroll yes
+      for (unsigned k = 0; k < Speedup; k++) {
+        unsigned lane = out * Speedup + k;
+        valid_out[lane] = false;
+
+        NVUINTW(NumInputs) one_hot_grant = 0;
+        InputIdx source_local;
+        bool granted = false;
+
+        // Stall the arbiters and the crossbar if the output is full
+        // This is also needed to get any pipelining (otherwise the tool will
+        // infer that you want to write in a single cycle)
+        // For some reason separating these two if statements gives better results
+        if (output_ready[lane] && (k == 0 || !hold[out])) {
+
+          // Run through the Arbiter pick() function, convert to binary
+          granted = arbitrate_and_encode<NumInputs, log2_inputs>(
+              arbiters[out], remaining, k == 0 && hold[out], one_hot_grant, source_local);
+        }
+        remaining &= ~one_hot_grant;
 
 // Grant logic on input queues (OR gate)
 #pragma hls_unroll
-      for (unsigned in = 0; in < NumInputs; in++) {
-        // pop_inputs[in] = pop_inputs[in] | (one_hot_grant[in] == 1);
-        input_consumed[in] = input_consumed[in] | (one_hot_grant[in] == 1);
-      }
+        for (unsigned in = 0; in < NumInputs; in++) {
+          // pop_inputs[in] = pop_inputs[in] | (one_hot_grant[in] == 1);
+          input_consumed[in] = input_consumed[in] | (one_hot_grant[in] == 1);
+        }
 
-      // XBAR (using the data that was staged in the temporary array input_data)
-      if ((!(one_hot_grant == 0)) && (output_ready[out])) {
-        data_out[out] = input_data[source_local].data;
-        valid_out[out] = true;
-        source[out] = source_local;
+        // XBAR (using the data that was staged in the temporary array input_data)
+        if (granted && (output_ready[lane])) {
+          data_out[lane] = input_data[source_local].data;
+          valid_out[lane] = true;
+          source[lane] = source_local;
+        }
       }
     }
   }  // end xbar() function
@@ -273,7 +352,21 @@ class ArbitratedCrossbar {
     for (unsigned i = 0; i < NumOutputs; i++) {
       fifo_empty_internal[i + 1] = (isOutputEmpty(i)) & fifo_empty_internal[i];
     }
-    return fifo_empty_internal[NumOutputs];
+    return fifo_empty_internal[NumOutputs] && isPipelineEmpty();
+  }
+
+  bool isPipelineEmpty() {
+    bool empty = true;
+    if (NumPipelineStages > 0) {
+#pragma hls_unroll yes
+      for (unsigned stage = 0; stage < PipeDepth; stage++) {
+#pragma hls_unroll yes
+        for (unsigned lane = 0; lane < NumLanes; lane++) {
+          empty = empty && !pipe_valid[stage][lane];
+        }
+      }
+    }
+    return empty;
   }
 
   bool isAllInputReady() {
@@ -288,12 +381,15 @@ class ArbitratedCrossbar {
 
   // Pop the data from all selected output lanes, data is already got from peek
   void pop_all_lanes(bool valid_out[NumOutputs]) {
+    NVUINTW(NumLanes) pop_mask = 0;
 #pragma hls_unroll yes
     for (unsigned i = 0; i < NumOutputs; i++) {
+      pop_mask[i * Speedup + read_bank[i]] = valid_out[i] ? 1 : 0;
       if (valid_out[i]) {
-        output_queues.pop(i);
+        read_bank[i] = next_bank(read_bank[i]);
       }
     }
+    output_queues.incrHead_all(pop_mask);
     return;
   }
 /**
@@ -310,10 +406,12 @@ class ArbitratedCrossbar {
   // valid_out - Array of outputs indicating if the output is valid
   // ready - Array of outputs indicating if an input was ready. This also
   // indicates of the input was successfully received by arbitrated Xbar
+  // source - Array of outputs containing the input forwarded to each output
+  // hold - Array of inputs, keeps each output on its last granted input
   void run(DataType data_in[NumInputs], OutputIdx dest_in[NumInputs],
            bool valid_in[NumInputs], DataType data_out[NumOutputs],
-           bool valid_out[NumOutputs], bool ready[NumInputs], InputIdx source[NumOutputs]
-    ) {
+           bool valid_out[NumOutputs], bool ready[NumInputs], InputIdx source[NumOutputs],
+           const bool hold[NumOutputs]) {
     // Need to read data into temporary variables to avoid scheduling problem in
     // Catapult
     OutputIdx destin_tmp[NumInputs];
@@ -332,11 +430,12 @@ class ArbitratedCrossbar {
     for (unsigned i = 0; i < NumInputs; i++) {
       input_data[i] = BitsToType<DataDest>(0);
     }
-    DataType output_data[NumOutputs];
-    bool output_valid[NumOutputs];
-    bool output_ready[NumOutputs];
+    DataType output_data[NumLanes];
+    bool output_valid[NumLanes];
+    bool output_ready[NumLanes];
+    InputIdx lane_source[NumLanes];
 #pragma hls_unroll yes
-    for (unsigned i = 0; i < NumOutputs; i++) {
+    for (unsigned i = 0; i < NumLanes; i++) {
       output_data[i] = BitsToType<DataType>(0);
     }
 
@@ -352,9 +451,9 @@ class ArbitratedCrossbar {
         input_valid[in] = !isInputEmpty(in);
         if (input_valid[in]) {
 	  #ifndef SKIP_LV2TYPE
-          input_data[in] = input_queues.peek(in);
+          input_data[in] = input_queues.peekRef(in);
 	  #else
-	  input_data[in].data_dest = input_queues.peek(in);
+	  input_data[in].data_dest = input_queues.peekRef(in);
 	  input_data[in].extract_data_dest();
 	  #endif
         }
@@ -374,18 +473,67 @@ class ArbitratedCrossbar {
     if (LenOutputBuffer > 0) {
 #pragma hls_unroll yes
       for (unsigned out = 0; out < NumOutputs; out++) {
-        output_ready[out] = !isOutputFull(out);
+        if (NumPipelineStages > 0 || Speedup > 1) {
+          // Credit check: the k-th grant needs room for k entries besides the
+          // entries in flight
+          unsigned in_flight = 0;
+          if (NumPipelineStages > 0) {
+#pragma hls_unroll yes
+            for (unsigned stage = 0; stage < PipeDepth; stage++) {
+#pragma hls_unroll yes
+              for (unsigned k = 0; k < Speedup; k++) {
+                in_flight += pipe_valid[stage][out * Speedup + k] ? 1 : 0;
+              }
+            }
+          }
+          unsigned space = OutputSpace(out);
+#pragma hls_unroll yes
+          for (unsigned k = 0; k < Speedup; k++) {
+            output_ready[out * Speedup + k] = (space > in_flight + k);
+          }
+        } else {
+          output_ready[out * Speedup] = !isOutputFull(out);
+        }
       }
     } else {
 #pragma hls_unroll yes
-      for (unsigned out = 0; out < NumOutputs; out++) {
-        output_ready[out] = true;
+      for (unsigned lane = 0; lane < NumLanes; lane++) {
+        output_ready[lane] = true;
       }
     }
 
     // Process the XBAR and arbiters
     xbar(input_data, input_valid, input_consumed, output_data, output_valid,
-         output_ready, source);
+         output_ready, lane_source, hold);
+
+    if (NumPipelineStages > 0) {
+      // The last stage leaves the pipeline, the arbitrated data enters it
+#pragma hls_unroll yes
+      for (unsigned lane = 0; lane < NumLanes; lane++) {
+        DataType data_last = pipe_data[PipeDepth - 1][lane];
+        bool valid_last = pipe_valid[PipeDepth - 1][lane];
+        InputIdx source_last = pipe_source[PipeDepth - 1][lane];
+#pragma hls_unroll yes
+        for (unsigned stage = PipeDepth - 1; stage > 0; stage--) {
+          pipe_data[stage][lane] = pipe_data[stage - 1][lane];
+          pipe_valid[stage][lane] = pipe_valid[stage - 1][lane];
+          pipe_source[stage][lane] = pipe_source[stage - 1][lane];
+        }
+        pipe_data[0][lane] = output_data[lane];
+        pipe_valid[0][lane] = output_valid[lane];
+        pipe_source[0][lane] = lane_source[lane];
+        output_data[lane] = data_last;
+        output_valid[lane] = valid_last;
+        lane_source[lane] = source_last;
+      }
+    }
+
+#pragma hls_unroll yes
+    for (unsigned out = 0; out < NumOutputs; out++) {
+      if (output_valid[out * Speedup]) {
+        source[out] = lane_source[out * Speedup];
+      }
+    }
 	for (unsigned out = 0; out < NumOutputs; out++) {
       //DCOUT("DUT - Output: " << out << "\t valid: " << output_valid[out] << "\t data: " << output_data[out] << "\tReady: " << output_ready[out] << endl);
 	}
@@ -395,12 +543,12 @@ class ArbitratedCrossbar {
 // Do this in a single loop over input lanes so it's clear to the tool that each
 // input channel
 // is only popped once
+      NVUINTW(NumInputs) consumed_mask = 0;
 #pragma hls_unroll yes
       for (unsigned in = 0; in < NumInputs; in++) {
-        if (input_consumed[in]) {
-          input_queues.incrHead(in);
-        }
+        consumed_mask[in] = input_consumed[in] ? 1 : 0;
       }
+      input_queues.incrHead_all(consumed_mask);
     } else {
 #pragma hls_unroll yes
       for (unsigned in = 0; in < NumInputs; in++) {
@@ -412,12 +560,19 @@ class ArbitratedCrossbar {
 // Read from each output channel if it is not empty
 #pragma hls_unroll yes
       for (unsigned out = 0; out < NumOutputs; out++) {
-        if (output_valid[out]) {
-          output_queues.push(output_data[out], out);
+        // The grants of this cycle go to consecutive banks
+        BankIdx bank = write_bank[out];
+#pragma hls_unroll yes
+        for (unsigned k = 0; k < Speedup; k++) {
+          if (output_valid[out * Speedup + k]) {
+            output_queues.push(output_data[out * Speedup + k], out * Speedup + bank);
+            bank = next_bank(bank);
+          }
         }
+        write_bank[out] = bank;
         valid_out[out] = !isOutputEmpty(out);
         if (!isOutputEmpty(out)) {
-          data_out[out] = peek(out);
+          data_out[out] = output_queues.peekRef(out * Speedup + read_bank[out]);
         }
         /*peek only
         if (!isOutputEmpty(out)) {
@@ -431,8 +586,8 @@ class ArbitratedCrossbar {
     } else {
 #pragma hls_unroll yes
       for (unsigned out = 0; out < NumOutputs; out++) {
-        data_out[out] = output_data[out];
-        valid_out[out] = output_valid[out];
+        data_out[out] = output_data[out * Speedup];
+        valid_out[out] = output_valid[out * Speedup];
       }
     }
   }  // end run() function
@@ -450,7 +605,327 @@ class ArbitratedCrossbar {
            valid_out, ready, source);
   } // end run() function
 
+/**
+ * \brief Top-Level function for Arbitrated Crossbar without packet hold
+ * \ingroup ArbitratedCrossbar
+ *
+ */
+  void run(DataType data_in[NumInputs], OutputIdx dest_in[NumInputs],
+           bool valid_in[NumInputs], DataType data_out[NumOutputs],
+           bool valid_out[NumOutputs], bool ready[NumInputs], InputIdx source[NumOutputs]) {
+    bool hold[NumOutputs];
+#pragma hls_unroll yes
+    for (unsigned out = 0; out < NumOutputs; out++) {
+      hold[out] = false;
+    }
+    run(data_in, dest_in, valid_in, data_out, valid_out, ready, source, hold);
+  } // end run() function
+
 
 };  // end ArbitratedCrossbar class
 
+/**
+ * \brief Crossbar with virtual output queues and iSLIP allocation
+ * \ingroup ArbitratedCrossbar
+ *
+ * \tparam DataType         DataType if input and output
+ * \tparam NumInputs        Number of Inputs
+ * \tparam NumOutputs       Number of Outputs
+ * \tparam LenInputBuffer   Length of each virtual output queue, must be non-zero
+ * \tparam LenOutputBuffer  Length of Output Buffer
+ * \tparam NumIters         Number of iSLIP request-grant-accept iterations per cycle (default: log2 of NumInputs)
+ *
+ * \par Overview
+ * - Drop-in alternative to ArbitratedCrossbar with the same run() and output queue interface.
+ * - Every input keeps one queue per output (virtual output queue), so a packet waiting for a busy output does not block packets of the same input to other outputs.
+ * - Each cycle an iSLIP allocator matches inputs to outputs. In every iteration unmatched outputs grant one requesting unmatched input in roundrobin order, and each input accepts one of its grants in roundrobin order.
+ * - Grant and accept pointers only move on matches made in the first iteration, which keeps the pointers desynchronized under load. Later iterations fill the remaining unmatched pairs.
+ * - ArbitratedCrossbar is limited by head-of-line blocking to roughly 60% throughput under saturated uniform random traffic. This crossbar reaches above 90% for the same traffic with deep enough queues (see the ArbitratedCrossbarTop benchmark), at the cost of NumInputs*NumOutputs queues.
+ * - An input is ready when the virtual output queue for its current destination has space.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <arbitrated_crossbar.h>
+ *
+ *      ...
+ *      VOQArbitratedCrossbar<DataType, NumInputs, NumOutputs, InputQueueLen, OutputQueueLen> xbar;
+ *      ...
+ *      xbar.run(data_in, dest_in, valid_in, data_out, valid_out, ready, source);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+
+template <typename DataType, unsigned int NumInputs, unsigned int NumOutputs,
+          unsigned int LenInputBuffer, unsigned int LenOutputBuffer,
+          unsigned int NumIters = nvhls::index_width<NumInputs>::val>
+class VOQArbitratedCrossbar {
+
+ public:
+  static const int log2_inputs = nvhls::index_width<NumInputs>::val;
+  static const int log2_outputs = nvhls::index_width<NumOutputs>::val;
+
+  typedef NVUINTW(log2_inputs) InputIdx;
+  typedef NVUINTW(log2_outputs) OutputIdx;
+  typedef NVUINTW(NumInputs) InputMask;
+  typedef NVUINTW(NumOutputs) OutputMask;
+
+ private:
+  // The queue of input in for output out is bank in*NumOutputs+out
+  FIFO<DataType, LenInputBuffer, NumInputs * NumOutputs> voqs;
+  FIFO<DataType, LenOutputBuffer, NumOutputs> output_queues;
+
+  // iSLIP pointers, set for the indices at or above the pointer
+  InputMask grant_prio[NumOutputs];
+  OutputMask accept_prio[NumInputs];
+
+  // Roundrobin select: lowest valid index at or above the pointer, otherwise
+  // the lowest valid index
+  template <unsigned int N>
+  NVUINTW(N) rr_select(const NVUINTW(N)& valid, const NVUINTW(N)& prio) {
+    NVUINTW(N) hi = valid & prio;
+    NVUINTW(N) candidates = (hi != 0) ? hi : valid;
+    NVUINTW(N) select = 0;
+    bool found = false;
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < N; i++) {
+      if (!found && (candidates[i] == 1)) {
+        select[i] = 1;
+        found = true;
+      }
+    }
+    return select;
+  }
+
+  // Pointer one past a one-hot selection
+  template <unsigned int N>
+  NVUINTW(N) next_prio(const NVUINTW(N)& select) {
+    NVUINTW(N) prio = 0;
+    bool above = true;
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < N; i++) {
+      unsigned idx = N - 1 - i;
+      if (select[idx] == 1) {
+        above = false;
+      }
+      prio[idx] = above;
+    }
+    if (prio == 0) {
+      prio = ~static_cast<NVUINTW(N)>(0);
+    }
+    return prio;
+  }
+
+ public:
+  VOQArbitratedCrossbar() {
+    NVHLS_ASSERT_MSG(LenInputBuffer > 0, "VOQArbitratedCrossbar needs non-zero input queues");
+    reset();
+  }
+
+  void reset() {
+    voqs.reset();
+    output_queues.reset();
+#pragma hls_unroll yes
+    for (unsigned out = 0; out < NumOutputs; out++) {
+      grant_prio[out] = ~static_cast<InputMask>(0);
+    }
+#pragma hls_unroll yes
+    for (unsigned in = 0; in < NumInputs; in++) {
+      accept_prio[in] = ~static_cast<OutputMask>(0);
+    }
+  }
+
+  bool isInputEmpty(InputIdx index) {
+    NVHLS_ASSERT_MSG(index < NumInputs, "Input index greater than number of inputs");
+    bool empty = true;
+#pragma hls_unroll yes
+    for (unsigned out = 0; out < NumOutputs; out++) {
+      empty = empty && voqs.isEmpty(index * NumOutputs + out);
+    }
+    return empty;
+  }
+
+  bool isInputFull(InputIdx index, OutputIdx dest) {
+    NVHLS_ASSERT_MSG(index < NumInputs, "Input index greater than number of inputs");
+    NVHLS_ASSERT_MSG(dest < NumOutputs, "Output index greater than number of outputs");
+    return voqs.isFull(index * NumOutputs + dest);
+  }
+
+  bool isOutputEmpty(OutputIdx index) {
+    NVHLS_ASSERT_MSG(index < NumOutputs, "Output index greater than number of outputs");
+    return output_queues.isEmpty(index);
+  }
+
+  bool isOutputFull(OutputIdx index) {
+    NVHLS_ASSERT_MSG(index < NumOutputs, "Output index greater than number of outputs");
+    return output_queues.isFull(index);
+  }
+
+  bool isAllInputEmpty() {
+    bool empty = true;
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumInputs; i++) {
+      empty = empty && isInputEmpty(i);
+    }
+    return empty;
+  }
+
+  bool isAllOutputEmpty() {
+    bool empty = true;
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumOutputs; i++) {
+      empty = empty && isOutputEmpty(i);
+    }
+    return empty;
+  }
+
+  // Add data to a specified input lane, with a specified destination lane
+  void push(DataType data, InputIdx src, OutputIdx dest) {
+    voqs.push(data, src * NumOutputs + dest);
+  }
+
+  DataType peek(OutputIdx index) { return output_queues.peek(index); }
+
+  // Pop the data from a specified output lane
+  DataType pop(OutputIdx index) { return output_queues.pop(index); }
+
+  // Pop the data from all selected output lanes, data is already got from peek
+  void pop_all_lanes(bool valid_out[NumOutputs]) {
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumOutputs; i++) {
+      if (valid_out[i]) {
+        output_queues.pop(i);
+      }
+    }
+  }
+
+  // iSLIP allocation over the virtual output queues
+  // output : match[out] is the one-hot input matched to out, or 0
+  // side effect : updates grant and accept pointers
+  void allocate(bool output_ready[NumOutputs], InputMask match[NumOutputs]) {
+    InputMask requests[NumOutputs];
+#pragma hls_unroll yes
+    for (unsigned out = 0; out < NumOutputs; out++) {
+      match[out] = 0;
+#pragma hls_unroll yes
+      for (unsigned in = 0; in < NumInputs; in++) {
+        requests[out][in] = output_ready[out] && !voqs.isEmpty(in * NumOutputs + out);
+      }
+    }
+
+    InputMask in_matched = 0;
+    OutputMask out_matched = 0;
+#pragma hls_unroll yes
+    for (unsigned iter = 0; iter < NumIters; iter++) {
+      // Grant: every unmatched output grants one unmatched requesting input
+      OutputMask grants[NumInputs];
+#pragma hls_unroll yes
+      for (unsigned in = 0; in < NumInputs; in++) {
+        grants[in] = 0;
+      }
+#pragma hls_unroll yes
+      for (unsigned out = 0; out < NumOutputs; out++) {
+        InputMask req = requests[out] & ~in_matched;
+        if (out_matched[out] == 1) {
+          req = 0;
+        }
+        InputMask grant = rr_select<NumInputs>(req, grant_prio[out]);
+#pragma hls_unroll yes
+        for (unsigned in = 0; in < NumInputs; in++) {
+          grants[in][out] = grant[in];
+        }
+      }
+
+      // Accept: every input accepts one of its grants
+#pragma hls_unroll yes
+      for (unsigned in = 0; in < NumInputs; in++) {
+        OutputMask accept = rr_select<NumOutputs>(grants[in], accept_prio[in]);
+        if (accept != 0) {
+          in_matched[in] = 1;
+          if (iter == 0) {
+            accept_prio[in] = next_prio<NumOutputs>(accept);
+          }
+        }
+#pragma hls_unroll yes
+        for (unsigned out = 0; out < NumOutputs; out++) {
+          if (accept[out] == 1) {
+            out_matched[out] = 1;
+            match[out][in] = 1;
+            if (iter == 0) {
+              InputMask in_one_hot = 0;
+              in_one_hot[in] = 1;
+              grant_prio[out] = next_prio<NumInputs>(in_one_hot);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // Top-Level function, interface identical to ArbitratedCrossbar::run()
+  void run(DataType data_in[NumInputs], OutputIdx dest_in[NumInputs],
+           bool valid_in[NumInputs], DataType data_out[NumOutputs],
+           bool valid_out[NumOutputs], bool ready[NumInputs], InputIdx source[NumOutputs]) {
+#pragma hls_unroll yes
+    for (unsigned in = 0; in < NumInputs; in++) {
+      bool full = isInputFull(in, dest_in[in]);
+      ready[in] = !full || !valid_in[in];
+      if (valid_in[in] && !full) {
+        push(data_in[in], in, dest_in[in]);
+      }
+    }
+
+    bool output_ready[NumOutputs];
+#pragma hls_unroll yes
+    for (unsigned out = 0; out < NumOutputs; out++) {
+      output_ready[out] = (LenOutputBuffer > 0) ? !isOutputFull(out) : true;
+    }
+
+    InputMask match[NumOutputs];
+    allocate(output_ready, match);
+
+    DataType output_data[NumOutputs];
+    bool output_valid[NumOutputs];
+#pragma hls_unroll yes
+    for (unsigned out = 0; out < NumOutputs; out++) {
+      output_data[out] = BitsToType<DataType>(0);
+      output_valid[out] = (match[out] != 0);
+      if (output_valid[out]) {
+        InputIdx source_local;
+        one_hot_to_bin<NumInputs, log2_inputs>(match[out], source_local);
+        output_data[out] = voqs.pop(source_local * NumOutputs + out);
+        source[out] = source_local;
+      }
+    }
+
+    if (LenOutputBuffer > 0) {
+#pragma hls_unroll yes
+      for (unsigned out = 0; out < NumOutputs; out++) {
+        if (output_valid[out]) {
+          output_queues.push(output_data[out], out);
+        }
+        valid_out[out] = !isOutputEmpty(out);
+        if (!isOutputEmpty(out)) {
+          data_out[out] = output_queues.peekRef(out);
+        }
+      }
+    } else {
+#pragma hls_unroll yes
+      for (unsigned out = 0; out < NumOutputs; out++) {
+        data_out[out] = output_data[out];
+        valid_out[out] = output_valid[out];
+      }
+    }
+  }  // end run() function
+
+  void run(DataType data_in[NumInputs], OutputIdx dest_in[NumInputs],
+           bool valid_in[NumInputs], DataType data_out[NumOutputs],
+           bool valid_out[NumOutputs], bool ready[NumInputs]) {
+    InputIdx source[NumOutputs];
+    run(data_in, dest_in, valid_in, data_out, valid_out, ready, source);
+  }
+};  // end VOQArbitratedCrossbar class
+
 #endif  // end ARBITRATED_CROSSBAR_H
@@ -28,10 +28,12 @@
  *
  * \tparam CfgMaster                A valid AXI config describing the master port, with no write responses.
  * \tparam CfgSlave                 A valid AXI config describing the slave port, with write responses.
+ * \tparam maxInFlight              Writes that can wait for their response from the slave, or 0 not to track them (default: 0).
  *
  * \par Overview
  * This block converts between an AXI master that does not use write responses and an AXI slave that does use write responses.  Most signals are simply passed through from master to slave.  Write responses generated by the slave are received and discarded.
  * - Apart from support for write responses, the two AXI configs must otherwise be the same.
+ * - With maxInFlight > 0, a counter tracks the writes whose response has not come back, and AW stalls while maxInFlight are outstanding, e.g. for a slave that can only track a few writes. Write bandwidth then follows min(1, maxInFlight * burst length / round-trip cycles) beats per cycle, so maxInFlight should cover the write response latency of the slave.
  *
  * \par Usage Guidelines
  *
@@ -47,12 +49,13 @@
  * This may reduce area/power.
  * \par
  */
-template <typename CfgMaster, typename CfgSlave>
+template <typename CfgMaster, typename CfgSlave, int maxInFlight = 0>
 class AxiAddWriteResponse : public sc_module {
   SC_HAS_PROCESS(AxiAddWriteResponse);
   // Local typedefs and derived constants
   typedef axi::axi4<CfgMaster> axiM;
   typedef axi::axi4<CfgSlave> axiS;
+  typedef NVUINTW(nvhls::index_width<maxInFlight + 1>::val) InFlight;
 
  public:
   // External interface
@@ -70,7 +73,7 @@ class AxiAddWriteResponse : public sc_module {
   typename axiM::WritePayload W;
   typename axiM::AddrPayload AR;
   typename axiS::ReadPayload R;
-  Connections::Sink<typename axiS::WRespPayload> B;
+  typename axiS::WRespPayload B;
   // Ideally we'd remove the B field entirely, but a stub of it still exists,
   // so we need to connect it to something
   Connections::DummySource<typename axiM::WRespPayload> dummyB;
@@ -85,14 +88,9 @@ class AxiAddWriteResponse : public sc_module {
         axiM_write("axiM_write"),
         axiS_read("axiS_read"),
         axiS_write("axiS_write"),
-        B("B"),
         dummyB("dummyB")
   {
 
-    B.clk(clk);
-    B.rst(rst);
-    B.in(axiS_write.b);
-
     dummyB.clk(clk);
     dummyB.rst(rst);
     dummyB.out(axiM_write.b);
@@ -141,15 +139,27 @@ class AxiAddWriteResponse : public sc_module {
     }
   }
 
+  // Also receives the write responses, which retire outstanding writes
   void axi_write_aw() {
     axiM_write.aw.Reset();
     axiS_write.aw.Reset();
+    axiS_write.b.Reset();
+    InFlight in_flight = 0;
+    bool aw_valid = 0;
     #pragma hls_pipeline_init_interval 1
     #pragma pipeline_stall_mode flush
     while(1) {
       wait();
-      if (axiM_write.aw.PopNB(AW)) {
-        axiS_write.aw.Push(BitsToType<typename axiS::AddrPayload>(TypeToBits(AW)));
+      bool retired = axiS_write.b.PopNB(B);
+      if (aw_valid) {
+        if (axiS_write.aw.PushNB(BitsToType<typename axiS::AddrPayload>(TypeToBits(AW)))) {
+          aw_valid = 0;
+          if (maxInFlight > 0) in_flight++;
+        }
+      }
+      if (maxInFlight > 0 && retired) in_flight--;
+      if (!aw_valid && (maxInFlight == 0 || in_flight != maxInFlight)) {
+        aw_valid = axiM_write.aw.PopNB(AW);
       }
     }
   }
@@ -157,13 +167,15 @@ class AxiAddWriteResponse : public sc_module {
   void axi_write_w() {
     axiM_write.w.Reset();
     axiS_write.w.Reset();
+    bool w_valid = 0;
     #pragma hls_pipeline_init_interval 1
     #pragma pipeline_stall_mode flush
     while(1) {
       wait();
-      if (axiM_write.w.PopNB(W)) {
-        axiS_write.w.Push(BitsToType<typename axiS::WritePayload>(TypeToBits(W)));
+      if (w_valid) {
+        if (axiS_write.w.PushNB(BitsToType<typename axiS::WritePayload>(TypeToBits(W)))) w_valid = 0;
       }
+      if (!w_valid) w_valid = axiM_write.w.PopNB(W);
     }
   }
 };
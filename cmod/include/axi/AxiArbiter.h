@@ -33,10 +33,13 @@
  * \tparam axiCfg                   A valid AXI config.
  * \tparam numMasters               The number of masters to arbitrate between.
  * \tparam maxOutstandingRequests   The number of oustanding read or write requests that can be tracked with internal state.
+ * \tparam remapIds                 If true, the master index is encoded in the upper ID bits of downstream requests and responses are routed by ID (default: false).
  *
  * \par Overview
  * AxiArbiter connects one or more AXI masters to a single AXI slave.  In the case of contention, a round-robin Arbiter selects the next request to pass through.
- * - The arbiter assumes that responses are returned in the order that requests are sent.  Downstream request reordering is currently not supported. 
+ * - If the AXI config has useQoS set, only the pending requests with the highest AxQOS take part in the round-robin, so urgent requests overtake the requests of other masters. A master that keeps sending high-QoS requests can then starve the others; AxiQosRegulator bounds the bandwidth and outstanding requests of a master to prevent that.
+ * - By default the arbiter assumes that responses are returned in the order that requests are sent, so a slow response will stall responses to every master.
+ * - With remapIds set, the upper numMasters_width bits of the downstream AR/AW ID carry the index of the issuing master, and R/B responses are routed back by ID with the original ID restored.  Responses may then return out of order across masters (and across IDs of one master), and up to maxOutstandingRequests reads and writes can be in flight.  Masters must leave the upper numMasters_width ID bits zero, and the AXI config needs idWidth >= numMasters_width.
  * - The AXI configs of all ports must be the same.
  *
  * \par Usage Guidelines
@@ -54,7 +57,7 @@
  * \par
  *
  */
-template <typename axiCfg, int numMasters, int maxOutstandingRequests>
+template <typename axiCfg, int numMasters, int maxOutstandingRequests, bool remapIds = false>
 class AxiArbiter : public sc_module {
  public:
   static const int kDebugLevel = 5;
@@ -63,6 +66,9 @@ class AxiArbiter : public sc_module {
 
   typedef typename axi::axi4<axiCfg> axi_;
   static const int numMasters_width = nvhls::log2_ceil<numMasters>::val;
+  static const int idShift = remapIds ? axi_::ID_WIDTH - numMasters_width : 0;
+  static_assert(!remapIds || axi_::ID_WIDTH >= numMasters_width,
+                "remapIds needs idWidth >= log2(numMasters)");
 
   typedef typename axi_::read::template slave<>::ARPort axi_rd_slave_ar;
   typedef typename axi_::read::template slave<>::RPort axi_rd_slave_r;
@@ -89,6 +95,8 @@ class AxiArbiter : public sc_module {
   Connections::Combinational<inFlight_t> active_write_master;
   Connections::Combinational<NVUINT1> w_last; // true iff w item last bit is set
 
+  typedef NVUINTW(nvhls::nbits<maxOutstandingRequests>::val) outstanding_t;
+
   SC_HAS_PROCESS(AxiArbiter);
 
   AxiArbiter(sc_module_name name)
@@ -124,6 +132,46 @@ class AxiArbiter : public sc_module {
     async_reset_signal_is(reset_bar, false);
   }
 
+  // Masks valid down to the requests of the highest QoS; all of valid
+  // without QoS
+  static NVUINTW(numMasters) QosMask(nvhls::nv_array<typename axi_::AddrPayload, numMasters>& reqs,
+                                     NVUINTW(numMasters) valid) {
+    if (axi_::QOS_WIDTH == 0)
+      return valid;
+    typedef NVUINTW(axi_::Enc::AXQOS::_WIDTH) Qos;
+    Qos top = 0;
+    #pragma hls_unroll yes
+    for (int i = 0; i < numMasters; i++) {
+      Qos qos = reqs[i].qos.to_uint64();
+      if (nvhls::get_slc<1>(valid, i) == 1 && qos > top)
+        top = qos;
+    }
+    NVUINTW(numMasters) mask = 0;
+    #pragma hls_unroll yes
+    for (int i = 0; i < numMasters; i++) {
+      Qos qos = reqs[i].qos.to_uint64();
+      if (nvhls::get_slc<1>(valid, i) == 1 && qos == top)
+        mask = mask | (static_cast<NVUINTW(numMasters)>(1) << i);
+    }
+    return mask;
+  }
+
+  // Encodes the master index in the upper ID bits of a downstream request
+  template <typename Payload>
+  static void RemapId(Payload& pld, int master) {
+    uint64 id = pld.id.to_uint64();
+    NVHLS_ASSERT_MSG((id >> idShift) == 0, "Upstream ID uses the bits reserved for the master index");
+    pld.id = id | (static_cast<uint64>(master) << idShift);
+  }
+
+  // Restores the upstream ID of a response and returns the master it belongs to
+  template <typename Payload>
+  static inFlight_t UnmapId(Payload& pld) {
+    uint64 id = pld.id.to_uint64();
+    pld.id = id & ((static_cast<uint64>(1) << idShift) - 1);
+    return static_cast<inFlight_t>(id >> idShift);
+  }
+
   void run_ar() {
     #pragma hls_unroll yes
     for (int i = 0; i < numMasters; i++) {
@@ -150,10 +198,13 @@ class AxiArbiter : public sc_module {
         }
       }
 
-      select_mask = arb.pick(valid_mask);
+      select_mask = arb.pick(QosMask(AR_reg, valid_mask));
 
       for (int i = 0; i < numMasters; i++) {
         if (nvhls::get_slc<1>(select_mask, i) == 1) {
+          if (remapIds) {
+            RemapId(AR_reg[i], i);
+          }
           axi_rd_s.ar.Push(AR_reg[i]);
           select_mask = 0;
           valid_mask = ~(~valid_mask | (1 << i));
@@ -181,32 +232,55 @@ class AxiArbiter : public sc_module {
     inFlight_t inFlight_resp_reg;
 
     bool read_inProgress = 0;
+    outstanding_t read_outstanding = 0;
 
     #pragma hls_pipeline_init_interval 1
     #pragma pipeline_stall_mode flush
     while (1) {
       wait();
 
-      if (!readQ.isFull()) {
-        if (read_in_flight.PopNB(inFlight_reg)) {
-          readQ.push(inFlight_reg);
-        }
-      }
-
-      if (!read_inProgress) {
-        if (!readQ.isEmpty()) {
-          inFlight_resp_reg = readQ.pop();
-          read_inProgress = 1;
+      if (remapIds) {
+        // Responses carry their master index, so only the number of reads in
+        // flight is tracked.
+        outstanding_t read_outstanding_local = read_outstanding;
+        if (read_outstanding_local != maxOutstandingRequests) {
+          if (read_in_flight.PopNB(inFlight_reg)) {
+            ++read_outstanding_local;
+          }
         }
-      } else {
         if (axi_rd_s.r.PopNB(R_reg)) {
+          inFlight_resp_reg = UnmapId(R_reg);
           axi_rd_m_r[inFlight_resp_reg].Push(R_reg);
           CDCOUT(sc_time_stamp() << " " << name() << " Pushed read response:"
                         << " to_port=" << inFlight_resp_reg
                         << " response=[" << R_reg << "]"
                         << endl, kDebugLevel);
           if (R_reg.last == 1)
-            read_inProgress = 0;
+            --read_outstanding_local;
+        }
+        read_outstanding = read_outstanding_local;
+      } else {
+        if (!readQ.isFull()) {
+          if (read_in_flight.PopNB(inFlight_reg)) {
+            readQ.push(inFlight_reg);
+          }
+        }
+
+        if (!read_inProgress) {
+          if (!readQ.isEmpty()) {
+            inFlight_resp_reg = readQ.pop();
+            read_inProgress = 1;
+          }
+        } else {
+          if (axi_rd_s.r.PopNB(R_reg)) {
+            axi_rd_m_r[inFlight_resp_reg].Push(R_reg);
+            CDCOUT(sc_time_stamp() << " " << name() << " Pushed read response:"
+                          << " to_port=" << inFlight_resp_reg
+                          << " response=[" << R_reg << "]"
+                          << endl, kDebugLevel);
+            if (R_reg.last == 1)
+              read_inProgress = 0;
+          }
         }
       }
     }
@@ -241,7 +315,7 @@ class AxiArbiter : public sc_module {
         }
       }
 
-      select_mask = arb.pick(valid_mask);
+      select_mask = arb.pick(QosMask(AW_reg, valid_mask));
 
       if (select_mask != 0) {
         #pragma hls_unroll yes
@@ -251,6 +325,9 @@ class AxiArbiter : public sc_module {
           }
         }
 
+        if (remapIds) {
+          RemapId(AW_reg[active_master], active_master);
+        }
         axi_wr_s.aw.Push(AW_reg[active_master]);
         active_write_master.Push(active_master);
         write_in_flight.Push(active_master);
@@ -304,31 +381,47 @@ class AxiArbiter : public sc_module {
     inFlight_t inFlight_reg;
     inFlight_t inFlight_resp_reg;
     bool write_inProgress = 0;
+    outstanding_t write_outstanding = 0;
 
     #pragma hls_pipeline_init_interval 1
     #pragma pipeline_stall_mode flush
     while (1) {
       wait();
 
-      if (!writeQ.isFull()) {
-        if (write_in_flight.PopNB(inFlight_reg)) {
-          writeQ.push(inFlight_reg);
+      if (remapIds && axiCfg::useWriteResponses) {
+        outstanding_t write_outstanding_local = write_outstanding;
+        if (write_outstanding_local != maxOutstandingRequests) {
+          if (write_in_flight.PopNB(inFlight_reg)) {
+            ++write_outstanding_local;
+          }
         }
-      }
-
-      if (!write_inProgress) {
-        if (!writeQ.isEmpty()) {
-          inFlight_resp_reg = writeQ.pop();
-          write_inProgress = 1;
+        if (axi_wr_s.b.PopNB(B_reg)) {
+          inFlight_resp_reg = UnmapId(B_reg);
+          axi_wr_m_b[inFlight_resp_reg].Push(B_reg);
+          --write_outstanding_local;
         }
+        write_outstanding = write_outstanding_local;
       } else {
-        if (axiCfg::useWriteResponses) {
-          if (axi_wr_s.b.PopNB(B_reg)) {
-            axi_wr_m_b[inFlight_resp_reg].Push(B_reg);
-            write_inProgress = 0;
+        if (!writeQ.isFull()) {
+          if (write_in_flight.PopNB(inFlight_reg)) {
+            writeQ.push(inFlight_reg);
+          }
+        }
+
+        if (!write_inProgress) {
+          if (!writeQ.isEmpty()) {
+            inFlight_resp_reg = writeQ.pop();
+            write_inProgress = 1;
           }
         } else {
-          write_inProgress = 0;
+          if (axiCfg::useWriteResponses) {
+            if (axi_wr_s.b.PopNB(B_reg)) {
+              axi_wr_m_b[inFlight_resp_reg].Push(B_reg);
+              write_inProgress = 0;
+            }
+          } else {
+            write_inProgress = 0;
+          }
         }
       }
     }
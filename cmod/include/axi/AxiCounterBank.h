@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2017-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __AXI_COUNTER_BANK_H__
+#define __AXI_COUNTER_BANK_H__
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_int.h>
+#include <hls_globals.h>
+#include <axi/axi4.h>
+
+/**
+ * \brief An AXI slave that reads the counters of a set of Connections::ChannelCounter instances.
+ * \ingroup AXI
+ *
+ * \tparam axiCfg                   A valid AXI config.
+ * \tparam numChannels              The number of counted channels.
+ * \tparam counterWidth             The width of the channel counters.  (Default: 32)
+ * \tparam numAddrBitsToInspect     The number of address bits to inspect, as in AxiSlaveToReg.  (Default: axiCfg::addrWidth)
+ *
+ * \par Overview
+ * AxiCounterBank collects the transfers, stalls and idle counters of numChannels ChannelCounter or CountedChannel
+ * instances, and drives their common enable and clear inputs.  Like AxiSlaveToReg, register i is the AXI data word
+ * at baseAddr + i * (axiCfg::dataWidth / 8); bursts step through the registers as INCR bursts, and accesses outside
+ * the bank return SLVERR.
+ * - 0: Control.  Bit 0 enables counting (set at reset).  Writing 1 to bit 1 clears all counters; it reads as 0.
+ *   Only this register is writable.
+ * - 1: Cycles counted.  It counts the same cycles as the channels, so the three counters of each channel add up to
+ *   it.  2-3: Reserved, read as 0.
+ * - 4 + 4 * channel + {0 transfers, 1 stalls, 2 idle}.  4 * channel + 7 is reserved.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <axi/AxiCounterBank.h>
+ *      #include <nvhls_connections_counters.h>
+ *
+ *      ...
+ *      AxiCounterBank<axi::cfg::lite, 2> bank;
+ *      sc_signal<bool> enable, clear;
+ *      sc_signal<NVUINTW(32)> transfers[2], stalls[2], idle[2];
+ *      ...
+ *          bank.enable(enable);
+ *          bank.clear(clear);
+ *          for (int i = 0; i < 2; i++) {
+ *            bank.transfers[i](transfers[i]);
+ *            bank.stalls[i](stalls[i]);
+ *            bank.idle[i](idle[i]);
+ *          }
+ *          buffer.enable(enable);
+ *          buffer.clear(clear);
+ *          buffer.transfers(transfers[0]);
+ *          buffer.stalls(stalls[0]);
+ *          buffer.idle(idle[0]);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename axiCfg, int numChannels, int counterWidth = 32,
+          int numAddrBitsToInspect = axiCfg::addrWidth>
+class AxiCounterBank : public sc_module {
+ public:
+  static const int kDebugLevel = 5;
+  typedef typename axi::axi4<axiCfg> axi4_;
+
+  enum {
+    channelsBase = 4,
+    regsPerChannel = 4,
+    numReg = channelsBase + regsPerChannel * numChannels,
+    bytesPerReg = axi4_::DATA_WIDTH >> 3,
+    axiAddrBitsPerReg = nvhls::log2_ceil<bytesPerReg>::val,
+  };
+
+  // Registers
+  enum { CTRL = 0, CYCLES = 1 };
+  enum { TRANSFERS = 0, STALLS = 1, IDLE = 2 };
+  enum { CTRL_ENABLE = 1, CTRL_CLEAR = 2 };
+
+  static_assert(counterWidth <= axi4_::DATA_WIDTH, "Counters must fit in a register");
+
+  typedef NVUINTW(counterWidth) Counter;
+  typedef NVUINTW(nvhls::index_width<numReg>::val) RegIdx;
+  typedef NVUINTW(axi4_::DATA_WIDTH) RegData;
+
+  sc_in<bool> clk;
+  sc_in<bool> reset_bar;
+
+  typename axi4_::read::template slave<> if_axi_rd;
+  typename axi4_::write::template slave<> if_axi_wr;
+  sc_in<NVUINTW(numAddrBitsToInspect)> baseAddr;
+
+  // To all channels
+  sc_out<bool> enable;
+  sc_out<bool> clear;
+
+  // From each channel
+  sc_in<Counter> transfers[numChannels];
+  sc_in<Counter> stalls[numChannels];
+  sc_in<Counter> idle[numChannels];
+
+  SC_HAS_PROCESS(AxiCounterBank);
+
+  AxiCounterBank(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        reset_bar("reset_bar"),
+        if_axi_rd("if_axi_rd"),
+        if_axi_wr("if_axi_wr"),
+        baseAddr("baseAddr"),
+        enable("enable"),
+        clear("clear") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+  }
+
+ protected:
+  RegData ReadReg(RegIdx idx, bool ctrl_enable, Counter cycles) {
+    RegData data = 0;
+    if (idx == CTRL) {
+      data = ctrl_enable ? CTRL_ENABLE : 0;
+    } else if (idx == CYCLES) {
+      data = cycles;
+    } else if (idx >= channelsBase) {
+      RegIdx channel = (idx - channelsBase) >> nvhls::log2_ceil<regsPerChannel>::val;
+      NVUINTW(2) counter = static_cast<NVUINTW(2)>(idx - channelsBase);
+      if (counter == TRANSFERS)
+        data = transfers[channel].read();
+      else if (counter == STALLS)
+        data = stalls[channel].read();
+      else if (counter == IDLE)
+        data = idle[channel].read();
+    }
+    return data;
+  }
+
+  void run() {
+    if_axi_rd.reset();
+    if_axi_wr.reset();
+    bool ctrl_enable = 1, ctrl_clear = 0;
+    enable.write(ctrl_enable);
+    clear.write(ctrl_clear);
+
+    typename axi4_::AddrPayload axi_rd_req, axi_wr_req_addr;
+    typename axi4_::ReadPayload axi_rd_resp;
+    typename axi4_::WritePayload axi_wr_req_data;
+    typename axi4_::WRespPayload axi_wr_resp;
+    bool rd_valid = 0, rd_resp_valid = 0, wr_valid = 0, wr_resp_valid = 0, wr_err = 0;
+    NVUINTW(numAddrBitsToInspect) axiRdAddr = 0, axiWrAddr = 0;
+    NVUINTW(axi4_::ALEN_WIDTH + 1) axiRdLen = 0;
+    Counter cycles = 0;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while (1) {
+      wait();
+
+      // The channels see the same enable and clear in this cycle
+      if (ctrl_clear)
+        cycles = 0;
+      else if (ctrl_enable)
+        cycles++;
+      ctrl_clear = 0;
+
+      // Reads, one beat per cycle
+      if (rd_resp_valid) {
+        if (if_axi_rd.nb_rwrite(axi_rd_resp))
+          rd_resp_valid = 0;
+      }
+      if (!rd_valid) {
+        if (if_axi_rd.nb_aread(axi_rd_req)) {
+          rd_valid = 1;
+          axiRdAddr = static_cast<sc_uint<numAddrBitsToInspect> >(axi_rd_req.addr);
+          axiRdLen = axi_rd_req.len.to_uint64();
+        }
+      }
+      if (rd_valid && !rd_resp_valid) {
+        bool valid_addr = (axiRdAddr >= baseAddr.read() &&
+                           axiRdAddr - baseAddr.read() < static_cast<NVUINTW(numAddrBitsToInspect + 1)>(numReg) * bytesPerReg);
+        RegIdx idx = static_cast<RegIdx>((axiRdAddr - baseAddr.read()) >> axiAddrBitsPerReg);
+        axi_rd_resp.id = axi_rd_req.id;
+        axi_rd_resp.data = valid_addr ? ReadReg(idx, ctrl_enable, cycles) : RegData(0);
+        axi_rd_resp.resp = valid_addr ? axi4_::Enc::XRESP::OKAY : axi4_::Enc::XRESP::SLVERR;
+        axi_rd_resp.last = (axiRdLen == 0);
+        rd_resp_valid = 1;
+        CDCOUT(sc_time_stamp() << " " << name() << " Read counter:"
+                               << " reg=" << idx << " data=" << hex << axi_rd_resp.data << dec
+                               << endl, kDebugLevel);
+        if (axiRdLen == 0) {
+          rd_valid = 0;
+        } else {
+          axiRdLen--;
+          axiRdAddr = static_cast<sc_uint<numAddrBitsToInspect> >(axi4_::NextBeatAddr(axi_rd_req, axiRdAddr));
+        }
+      }
+
+      // Writes; only the control register is writable
+      if (axiCfg::useWriteResponses && wr_resp_valid) {
+        if (if_axi_wr.nb_bwrite(axi_wr_resp))
+          wr_resp_valid = 0;
+      }
+      if (!wr_valid) {
+        if (if_axi_wr.aw.PopNB(axi_wr_req_addr)) {
+          wr_valid = 1;
+          wr_err = 0;
+          axiWrAddr = static_cast<sc_uint<numAddrBitsToInspect> >(axi_wr_req_addr.addr);
+        }
+      }
+      if (wr_valid && !wr_resp_valid) {
+        if (if_axi_wr.w.PopNB(axi_wr_req_data)) {
+          if (axiWrAddr == baseAddr.read()) {
+            RegData data = axi_wr_req_data.data;
+            ctrl_enable = (data & CTRL_ENABLE) != 0;
+            ctrl_clear = (data & CTRL_CLEAR) != 0;
+            CDCOUT(sc_time_stamp() << " " << name() << " Wrote control: " << hex << data << dec
+                                   << endl, kDebugLevel);
+          } else {
+            wr_err = 1;
+          }
+          if (axi4_::LAST_WIDTH == 0 || axi_wr_req_data.last.to_uint64() == 1) {
+            wr_valid = 0;
+            if (axiCfg::useWriteResponses) {
+              axi_wr_resp.id = axi_wr_req_addr.id;
+              axi_wr_resp.resp = wr_err ? axi4_::Enc::XRESP::SLVERR : axi4_::Enc::XRESP::OKAY;
+              wr_resp_valid = 1;
+            }
+          } else {
+            axiWrAddr = static_cast<sc_uint<numAddrBitsToInspect> >(axi4_::NextBeatAddr(axi_wr_req_addr, axiWrAddr));
+          }
+        }
+      }
+      enable.write(ctrl_enable);
+      clear.write(ctrl_clear);
+    }
+  }
+};
+
+#endif
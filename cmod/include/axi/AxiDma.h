@@ -0,0 +1,529 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __AXIDMA_H__
+#define __AXIDMA_H__
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+#include <axi/axi4.h>
+#include <fifo.h>
+#include <nvhls_connections.h>
+#include <nvhls_assert.h>
+#include <axi/AxiMasterGate.h>
+#include <axi/AxiMasterGate/AxiMasterGateIf.h>
+
+/**
+ * \brief An AxiDma transfer descriptor, as stored in memory.
+ * \ingroup AXI
+ *
+ * \par Overview
+ * A descriptor occupies 32 bytes at a 32-byte aligned address and consists of
+ * eight little-endian 32-bit words:
+ *
+ * | Word | Field     | Meaning                                                  |
+ * |------|-----------|----------------------------------------------------------|
+ * | 0    | src       | Source address of the first row                          |
+ * | 1    | dst       | Destination address of the first row                     |
+ * | 2    | rowBytes  | Bytes per row, a nonzero multiple of the data width      |
+ * | 3    | rows      | Number of rows, at least 1                               |
+ * | 4    | srcStride | Bytes between the starts of consecutive source rows      |
+ * | 5    | dstStride | Bytes between the starts of consecutive destination rows |
+ * | 6    | next      | Address of the next descriptor, 0 at the end of a chain  |
+ * | 7    | ctrl      | Bit 0: raise an interrupt when the descriptor completes  |
+ *
+ * A 1D copy is a descriptor with rows = 1.  Addresses and strides must be
+ * aligned to the data width.
+ *
+ */
+struct AxiDmaDesc : public nvhls_message {
+  enum { CTRL_IRQ = 1 };
+
+  NVUINT32 src;
+  NVUINT32 dst;
+  NVUINT32 rowBytes;
+  NVUINT32 rows;
+  NVUINT32 srcStride;
+  NVUINT32 dstStride;
+  NVUINT32 next;
+  NVUINT32 ctrl;
+
+  static const unsigned int width = 8 * 32;
+  static const unsigned int bytes = width >> 3;
+
+  typedef NVUINTW(width) Bits;
+
+  // Memory image of the descriptor
+  Bits ToBits() const {
+    Bits bits = 0;
+    bits = nvhls::set_slc(bits, src, 0);
+    bits = nvhls::set_slc(bits, dst, 32);
+    bits = nvhls::set_slc(bits, rowBytes, 64);
+    bits = nvhls::set_slc(bits, rows, 96);
+    bits = nvhls::set_slc(bits, srcStride, 128);
+    bits = nvhls::set_slc(bits, dstStride, 160);
+    bits = nvhls::set_slc(bits, next, 192);
+    bits = nvhls::set_slc(bits, ctrl, 224);
+    return bits;
+  }
+
+  void FromBits(const Bits& bits) {
+    src = nvhls::get_slc<32>(bits, 0);
+    dst = nvhls::get_slc<32>(bits, 32);
+    rowBytes = nvhls::get_slc<32>(bits, 64);
+    rows = nvhls::get_slc<32>(bits, 96);
+    srcStride = nvhls::get_slc<32>(bits, 128);
+    dstStride = nvhls::get_slc<32>(bits, 160);
+    next = nvhls::get_slc<32>(bits, 192);
+    ctrl = nvhls::get_slc<32>(bits, 224);
+  }
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& src;
+    m& dst;
+    m& rowBytes;
+    m& rows;
+    m& srcStride;
+    m& dstStride;
+    m& next;
+    m& ctrl;
+  }
+};
+
+/**
+ * \brief The completion interrupt of an AxiDma descriptor.
+ *
+ * \tparam Cfg    A valid AXI config.
+ */
+template <typename Cfg>
+struct AxiDmaIrq : public nvhls_message {
+  typedef axi::axi4<Cfg> axi4_;
+
+  typename axi4_::Addr desc;   // address of the completed descriptor
+  typename axi4_::Resp resp;   // worst response of its reads and writes
+  NVUINT1 chainEnd;            // 1 if this was the last descriptor of the chain
+
+  static const unsigned int width = axi4_::ADDR_WIDTH + axi4_::RESP_WIDTH + 1;
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& desc;
+    m& resp;
+    m& chainEnd;
+  }
+};
+
+/**
+ * \brief A scatter-gather DMA engine built on AxiMasterGate.
+ * \ingroup AXI
+ *
+ * \tparam Cfg               A valid AXI config with bursts and write responses.
+ * \tparam MaxBurst          The maximum length of a read or write burst. (default: 16)
+ * \tparam MaxInFlightTrans  The number of write bursts in flight, passed to AxiMasterGate. (default: 4)
+ * \tparam ROBDepth          The reorder buffer depth of AxiMasterGate. (default: 8)
+ *
+ * \par Overview
+ * AxiDma copies memory as described by chains of AxiDmaDesc descriptors.
+ * Writing the address of the first descriptor to startIn starts a chain; the
+ * engine fetches each descriptor over AXI, copies its rows, and follows the
+ * next pointer until it is 0.  Every row is copied with INCR bursts of up to
+ * MaxBurst beats that cross neither a source nor a destination 4KB boundary.
+ *
+ * Reads are issued as soon as the previous read burst has been accepted, and
+ * the write of a burst starts as its read data returns, so reads, writes and
+ * up to MaxInFlightTrans write responses overlap.  The next descriptor is
+ * fetched while the writes of the current one complete.  AxiMasterGate
+ * returns read bursts in order and does not overlap two read bursts, so long
+ * bursts amortize the read round trip.
+ *
+ * When the last write of a descriptor has been acknowledged, an AxiDmaIrq is
+ * sent on irqOut if the descriptor has the CTRL_IRQ bit set or ends the
+ * chain.  A new chain can be started once every read of the previous one
+ * has been issued.
+ *
+ * \code
+ *      AxiDma<axi::cfg::standard> dma;
+ *      ...
+ *      dma.if_rd(axi_read);    dma.if_wr(axi_write);
+ *      dma.startIn(start);     dma.irqOut(irq);
+ * \endcode
+ * \par
+ *
+ */
+template <typename Cfg, int MaxBurst = 16, int MaxInFlightTrans = 4, int ROBDepth = 8>
+class AxiDma : public sc_module {
+  typedef axi::axi4<Cfg> axi4_;
+
+  static_assert(Cfg::useBurst && Cfg::useWriteResponses,
+                "AxiDma requires an AXI config with bursts and write responses");
+  static_assert(Cfg::addrWidth <= 32, "AxiDma descriptors hold 32-bit addresses");
+  static_assert(MaxBurst >= 1 && MaxBurst <= Cfg::maxBurstSize,
+                "MaxBurst must be between 1 and maxBurstSize");
+  static_assert(Cfg::dataWidth <= static_cast<int>(AxiDmaDesc::width),
+                "AxiDma requires a data width of at most 256 bits");
+
+  static const int bytesPerBeat = Cfg::dataWidth >> 3;
+  static const int log_bytesPerBeat = nvhls::log2_ceil<bytesPerBeat>::val;
+  static const int descBeats = AxiDmaDesc::width / Cfg::dataWidth;
+  static const int pageBytes = 4096;
+  static const int queueDepth = 2 * MaxInFlightTrans;
+
+  static_assert(descBeats <= Cfg::maxBurstSize, "A descriptor must fit in one burst");
+
+  typedef typename axi4_::Addr Addr;
+  typedef typename axi4_::Resp Resp;
+  typedef NVUINTW(nvhls::nbits<descBeats>::val) DescBeat;
+
+  // A data burst, sent from run_rd to run_wr when its read is issued
+  struct Burst : public nvhls_message {
+    Addr addr;                  // write address
+    typename axi4_::BeatNum len;
+    Resp resp;                  // descriptor fetch response, then worst read response
+    Addr desc;                  // address of the descriptor
+    NVUINT1 descEnd;            // last burst of the descriptor
+    NVUINT1 irq;
+    NVUINT1 chainEnd;
+
+    static const unsigned int width =
+        2 * axi4_::ADDR_WIDTH + axi4_::ALEN_WIDTH + axi4_::RESP_WIDTH + 3;
+
+    template <unsigned int Size>
+    void Marshall(Marshaller<Size>& m) {
+      m& addr;
+      m& len;
+      m& resp;
+      m& desc;
+      m& descEnd;
+      m& irq;
+      m& chainEnd;
+    }
+  };
+
+  AxiMasterGate<Cfg, ROBDepth, MaxInFlightTrans> gate;
+
+ public:
+  typename axi4_::read::template master<> if_rd;
+  typename axi4_::write::template master<> if_wr;
+
+  sc_in<bool> reset_bar;
+  sc_in<bool> clk;
+
+  Connections::In<Addr> startIn;
+  Connections::Out<AxiDmaIrq<Cfg> > irqOut;
+
+  SC_HAS_PROCESS(AxiDma);
+
+  AxiDma(sc_module_name name)
+      : sc_module(name),
+        gate("gate"),
+        if_rd("if_rd"),
+        if_wr("if_wr"),
+        reset_bar("reset_bar"),
+        clk("clk"),
+        startIn("startIn"),
+        irqOut("irqOut"),
+        rdRequest("rdRequest"),
+        rdResp("rdResp"),
+        wrRequest("wrRequest"),
+        wrResp("wrResp"),
+        burst("burst"),
+        data("data") {
+    gate.clk(clk);
+    gate.reset_bar(reset_bar);
+    gate.if_rd(if_rd);
+    gate.if_wr(if_wr);
+    gate.rdRequestIn(rdRequest);
+    gate.rdRespOut(rdResp);
+    gate.wrRequestIn(wrRequest);
+    gate.wrRespOut(wrResp);
+
+    SC_THREAD(run_rd);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(run_wr);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+  }
+
+ protected:
+  Connections::Combinational<RdRequest<Cfg> > rdRequest;
+  Connections::Combinational<RdResp<Cfg> > rdResp;
+  Connections::Combinational<WrRequest<Cfg> > wrRequest;
+  Connections::Combinational<WrResp<Cfg> > wrResp;
+
+  Connections::Combinational<Burst> burst;
+  Connections::Combinational<RdResp<Cfg> > data;
+
+  static Resp Worse(Resp a, Resp b) { return (b > a) ? b : a; }
+
+  // Beats from addr to the next 4KB boundary
+  static NVUINTW(14) PageBeats(Addr addr) {
+    NVUINTW(14) left = pageBytes - nvhls::get_slc<12>(addr, 0);
+    return left >> log_bytesPerBeat;
+  }
+
+  void run_rd() {
+    startIn.Reset();
+    rdRequest.ResetWrite();
+    rdResp.ResetRead();
+    burst.ResetWrite();
+    data.ResetWrite();
+
+    // One entry per issued read: true for a descriptor fetch
+    FIFO<bool, queueDepth> tagQ;
+    tagQ.reset();
+
+    bool chain_active = false;
+    bool fetch_pending = false;     // the descriptor at fetch_addr must be read
+    bool fetch_wait = false;        // its beats have not all returned yet
+    Addr fetch_addr = 0;
+    AxiDmaDesc::Bits desc_bits = 0;
+    DescBeat desc_beat = 0;
+    Resp fetch_resp = axi4_::Enc::XRESP::OKAY;
+
+    // Descriptor being copied
+    bool xfer_active = false;
+    AxiDmaDesc cur;
+    Addr cur_addr = 0;
+    NVUINT32 row = 0;
+    NVUINT32 offset = 0;            // bytes of the row already issued
+    Addr src_row = 0;
+    Addr dst_row = 0;
+
+    Burst pending;
+    bool burst_pending = false;     // pending is waiting to be sent to run_wr
+
+    RdResp<Cfg> beat;
+    bool beat_valid = false;        // a data beat is waiting to be sent to run_wr
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while (1) {
+      wait();
+
+      // Issue side
+      if (burst_pending) {
+        if (burst.PushNB(pending)) {
+          burst_pending = false;
+        }
+      } else if (fetch_pending) {
+        if (!tagQ.isFull()) {
+          RdRequest<Cfg> req;
+          req.addr = fetch_addr;
+          req.len = descBeats - 1;
+          req.size = log_bytesPerBeat;
+          req.burst = axi4_::Enc::AXBURST::INCR;
+          req.cache = 0;
+          req.auser = 0;
+          if (rdRequest.PushNB(req)) {
+            tagQ.push(true);
+            fetch_pending = false;
+            fetch_wait = true;
+          }
+        }
+      } else if (xfer_active) {
+        if (!tagQ.isFull()) {
+          NVUINT32 row_beats = (cur.rowBytes - offset) >> log_bytesPerBeat;
+          Addr src = src_row + offset;
+          Addr dst = dst_row + offset;
+          NVUINTW(14) src_beats = PageBeats(src);
+          NVUINTW(14) dst_beats = PageBeats(dst);
+          NVUINT32 beats = MaxBurst;
+          if (row_beats < beats) beats = row_beats;
+          if (src_beats < beats) beats = src_beats;
+          if (dst_beats < beats) beats = dst_beats;
+
+          RdRequest<Cfg> req;
+          req.addr = src;
+          req.len = beats - 1;
+          req.size = log_bytesPerBeat;
+          req.burst = axi4_::Enc::AXBURST::INCR;
+          req.cache = 0;
+          req.auser = 0;
+          if (rdRequest.PushNB(req)) {
+            tagQ.push(false);
+            offset += beats << log_bytesPerBeat;
+            bool row_end = (offset == cur.rowBytes);
+            bool desc_end = row_end && (row == cur.rows - 1);
+
+            pending.addr = dst;
+            pending.len = beats - 1;
+            pending.resp = fetch_resp;
+            pending.desc = cur_addr;
+            pending.descEnd = desc_end;
+            pending.irq = (cur.ctrl & AxiDmaDesc::CTRL_IRQ) != 0;
+            pending.chainEnd = desc_end && (cur.next == 0);
+            burst_pending = true;
+            fetch_resp = axi4_::Enc::XRESP::OKAY;
+
+            if (row_end) {
+              offset = 0;
+              ++row;
+              src_row += cur.srcStride;
+              dst_row += cur.dstStride;
+            }
+            if (desc_end) {
+              xfer_active = false;
+              if (cur.next == 0) {
+                chain_active = false;
+              } else {
+                fetch_addr = cur.next;
+                fetch_pending = true;
+              }
+            }
+          }
+        }
+      } else if (!chain_active) {
+        Addr start;
+        if (startIn.PopNB(start)) {
+          chain_active = true;
+          fetch_addr = start;
+          fetch_pending = true;
+        }
+      }
+
+      // Response side
+      if (beat_valid) {
+        if (data.PushNB(beat)) {
+          beat_valid = false;
+        }
+      } else if (!tagQ.isEmpty()) {
+        RdResp<Cfg> resp;
+        if (rdResp.PopNB(resp)) {
+          bool last = (resp.last == 1);
+          if (tagQ.peek()) {
+            desc_bits = nvhls::set_slc(desc_bits, resp.data, desc_beat.to_uint() * Cfg::dataWidth);
+            fetch_resp = Worse(fetch_resp, resp.resp);
+            ++desc_beat;
+          } else {
+            beat = resp;
+            beat_valid = !data.PushNB(beat);
+          }
+          if (last) {
+            tagQ.incrHead();
+          }
+        }
+      }
+
+      // Descriptors are only fetched once the previous one has been issued
+      if (fetch_wait && desc_beat == descBeats) {
+        cur.FromBits(desc_bits);
+        NVHLS_ASSERT_MSG(cur.rows != 0 && cur.rowBytes != 0, "AxiDma descriptors must copy at least one row");
+        NVHLS_ASSERT_MSG(nvhls::get_slc<log_bytesPerBeat>(cur.src | cur.dst | cur.rowBytes |
+                                                          cur.srcStride | cur.dstStride, 0) == 0,
+                         "AxiDma addresses, row sizes and strides must be aligned to the data width");
+        cur_addr = fetch_addr;
+        row = 0;
+        offset = 0;
+        src_row = cur.src;
+        dst_row = cur.dst;
+        xfer_active = true;
+        fetch_wait = false;
+        desc_beat = 0;
+      }
+    }
+  }
+
+  void run_wr() {
+    burst.ResetRead();
+    data.ResetRead();
+    wrRequest.ResetWrite();
+    wrResp.ResetRead();
+    irqOut.Reset();
+
+    FIFO<Burst, queueDepth> burstQ;    // bursts waiting for their data
+    FIFO<Burst, queueDepth> respQ;     // bursts waiting for their write response
+    burstQ.reset();
+    respQ.reset();
+
+    RdResp<Cfg> beat;
+    bool beat_valid = false;
+    typename axi4_::BeatNum beat_cnt = 0;
+    Resp burst_resp = axi4_::Enc::XRESP::OKAY;
+
+    Resp desc_resp = axi4_::Enc::XRESP::OKAY;
+    AxiDmaIrq<Cfg> irq;
+    bool irq_pending = false;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while (1) {
+      wait();
+
+      if (irq_pending) {
+        if (irqOut.PushNB(irq)) {
+          irq_pending = false;
+        }
+      } else if (!respQ.isEmpty()) {
+        WrResp<Cfg> resp;
+        if (wrResp.PopNB(resp)) {
+          Burst done = respQ.pop();
+          desc_resp = Worse(desc_resp, Worse(done.resp, resp.resp));
+          if (done.descEnd == 1) {
+            irq.desc = done.desc;
+            irq.resp = desc_resp;
+            irq.chainEnd = done.chainEnd;
+            irq_pending = (done.irq == 1) || (done.chainEnd == 1);
+            desc_resp = axi4_::Enc::XRESP::OKAY;
+          }
+        }
+      }
+
+      if (!beat_valid) {
+        beat_valid = data.PopNB(beat);
+      }
+      if (beat_valid && !burstQ.isEmpty() && !respQ.isFull()) {
+        Burst head = burstQ.peek();
+        bool last = (beat_cnt == head.len);
+        WrRequest<Cfg> req;
+        req.addr = head.addr;
+        req.len = head.len;
+        req.size = log_bytesPerBeat;
+        req.burst = axi4_::Enc::AXBURST::INCR;
+        req.cache = 0;
+        req.auser = 0;
+        req.data = beat.data;
+        req.wuser = 0;
+        req.last = last;
+        if (wrRequest.PushNB(req)) {
+          beat_valid = false;
+          Resp resp = Worse(burst_resp, beat.resp);
+          if (last) {
+            head.resp = Worse(head.resp, resp);
+            respQ.push(head);
+            burstQ.incrHead();
+            beat_cnt = 0;
+            burst_resp = axi4_::Enc::XRESP::OKAY;
+          } else {
+            burst_resp = resp;
+            ++beat_cnt;
+          }
+        }
+      }
+
+      if (!burstQ.isFull()) {
+        Burst next;
+        if (burst.PopNB(next)) {
+          burstQ.push(next);
+        }
+      }
+    }
+  }
+};
+
+#endif
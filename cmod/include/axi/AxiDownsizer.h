@@ -0,0 +1,391 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __AXIDOWNSIZER_H__
+#define __AXIDOWNSIZER_H__
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_assert.h>
+#include <nvhls_int.h>
+#include <axi/axi4.h>
+#include <fifo.h>
+
+/**
+ * \brief A data-width converter from a wide AXI master to a narrow AXI slave.
+ * \ingroup AXI
+ *
+ * \tparam CfgMaster          A valid AXI config describing the (wide) master port.
+ * \tparam CfgSlave           A valid AXI config describing the (narrow) slave port.
+ * \tparam maxOutstanding     The number of requests per channel that may be awaiting data or responses. (default: 8)
+ *
+ * \par Overview
+ * AxiDownsizer connects an AXI master whose data bus is a power-of-two multiple
+ * of the slave's data bus.  Every master beat is split into
+ * ratio = CfgMaster::dataWidth / CfgSlave::dataWidth consecutive slave beats,
+ * lowest byte lanes first, and the write strobes are split with the data.  On
+ * the read side, ratio slave beats are packed back into one master beat, and the
+ * worst RRESP among them is returned.
+ *
+ * A master burst of len+1 beats becomes (len+1)*ratio slave beats.  If that
+ * exceeds CfgSlave::maxBurstSize, the request is issued as several slave bursts
+ * of up to maxBurstSize beats; their write responses are merged into one B
+ * beat carrying the worst BRESP.  Each channel moves one slave beat per cycle, so
+ * the narrow port runs at full throughput.
+ *
+ * - Apart from the data width and maximum burst length, the two AXI configs must otherwise be the same.
+ * - Both configs must use bursts and write strobes.
+ * - Requests must be INCR bursts of full-width beats aligned to the master data width.
+ * - The slave must return read data and write responses in request order (e.g. all requests use one ID).
+ *
+ * \par Usage Guidelines
+ *
+ * This module sets the stall mode to flush by default to mitigate possible RTL
+ * bugs that can occur in the default stall mode. If you are confident that
+ * this class of bugs will not occur in your use case, you can change the stall
+ * mode via TCL directive:
+ *
+ * \code
+ * directive set /path/to/AxiDownsizer/axi_read_ar/while -PIPELINE_STALL_MODE stall
+ * \endcode
+ *
+ * This may reduce area/power.
+ * \par
+ */
+template <typename CfgMaster, typename CfgSlave, int maxOutstanding = 8>
+class AxiDownsizer : public sc_module {
+  SC_HAS_PROCESS(AxiDownsizer);
+  // Local typedefs and derived constants
+  typedef axi::axi4<CfgMaster> axiM;
+  typedef axi::axi4<CfgSlave> axiS;
+
+  static const int ratio = CfgMaster::dataWidth / CfgSlave::dataWidth;
+  static const int log_ratio = nvhls::log2_ceil<ratio>::val;
+  static const int bytesM = CfgMaster::dataWidth >> 3;
+  static const int bytesS = CfgSlave::dataWidth >> 3;
+  static const int log_bytesM = nvhls::log2_ceil<bytesM>::val;
+  static const int log_bytesS = nvhls::log2_ceil<bytesS>::val;
+  static const int log_maxBurstS = nvhls::log2_ceil<CfgSlave::maxBurstSize>::val;
+
+  static_assert(ratio >= 2 && (ratio & (ratio - 1)) == 0,
+                "The master data width must be a power-of-two multiple of the slave data width");
+  static_assert(CfgMaster::useBurst && CfgSlave::useBurst, "AxiDownsizer requires AXI configs with bursts");
+  static_assert(CfgMaster::useWriteStrobes && CfgSlave::useWriteStrobes,
+                "AxiDownsizer requires AXI configs with write strobes");
+  static_assert((CfgSlave::maxBurstSize & (CfgSlave::maxBurstSize - 1)) == 0 &&
+                CfgSlave::maxBurstSize >= ratio,
+                "The slave maxBurstSize must be a power of two of at least the width ratio");
+  static_assert(CfgMaster::addrWidth == CfgSlave::addrWidth && CfgMaster::idWidth == CfgSlave::idWidth,
+                "Address and ID widths must match");
+  static_assert(CfgMaster::useWriteResponses == CfgSlave::useWriteResponses,
+                "Both configs must agree on write responses");
+
+  // Slave beats of one master burst, and their count minus one
+  typedef NVUINTW(axiM::ALEN_WIDTH + log_ratio + 1) Beats;
+  typedef NVUINTW(axiM::ALEN_WIDTH + log_ratio) Pieces;
+  typedef NVUINTW(log_ratio) Lane;
+  typedef NVUINTW(log_maxBurstS) PieceBeat;
+
+ public:
+  // External interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+
+  typename axiM::read::template slave<> axiM_read;
+  typename axiM::write::template slave<> axiM_write;
+  typename axiS::read::template master<> axiS_read;
+  typename axiS::write::template master<> axiS_write;
+
+ private:
+  // Burst lengths from the address threads to the data threads, and the
+  // number of slave bursts per master write to the B thread
+  Connections::Combinational<typename axiM::BeatNum> rd_len;
+  Connections::Combinational<typename axiM::BeatNum> wr_len;
+  Connections::Combinational<Pieces> wr_pieces;
+
+ public:
+  // Constructor
+  AxiDownsizer(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        rst("rst"),
+        axiM_read("axiM_read"),
+        axiM_write("axiM_write"),
+        axiS_read("axiS_read"),
+        axiS_write("axiS_write"),
+        rd_len("rd_len"),
+        wr_len("wr_len"),
+        wr_pieces("wr_pieces")
+  {
+    SC_THREAD(axi_read_ar);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    SC_THREAD(axi_read_r);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    SC_THREAD(axi_write_aw);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    SC_THREAD(axi_write_w);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    SC_THREAD(axi_write_b);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+ private:
+  static void CheckRequest(const typename axiM::AddrPayload& req) {
+    NVHLS_ASSERT_MSG(nvhls::get_slc<log_bytesM>(req.addr, 0) == 0,
+                     "AxiDownsizer requires addresses aligned to the master data width");
+    NVHLS_ASSERT_MSG(!CfgMaster::useVariableBeatSize || req.size.to_uint64() == log_bytesM,
+                     "AxiDownsizer requires full-width beats");
+    NVHLS_ASSERT_MSG(axiM::BURST_WIDTH == 0 || req.burst.to_uint64() == axiM::Enc::AXBURST::INCR,
+                     "AxiDownsizer only supports INCR bursts");
+  }
+
+  // The next slave burst of a master request; advances addr and left
+  static typename axiS::AddrPayload NextPiece(const typename axiM::AddrPayload& req,
+                                              typename axiM::Addr& addr, Beats& left) {
+    typename axiS::AddrPayload out;
+    Beats beats = (left > CfgSlave::maxBurstSize) ? Beats(CfgSlave::maxBurstSize) : left;
+    out.id = req.id;
+    out.addr = addr;
+    out.len = beats - 1;
+    out.size = log_bytesS;
+    out.burst = axiS::Enc::AXBURST::INCR;
+    out.cache = req.cache;
+    out.qos = req.qos;
+    out.auser = req.auser;
+    addr += static_cast<typename axiM::Addr>(beats) << log_bytesS;
+    left -= beats;
+    return out;
+  }
+
+  void axi_read_ar() {
+    axiM_read.ar.Reset();
+    axiS_read.ar.Reset();
+    rd_len.ResetWrite();
+
+    typename axiM::AddrPayload AR;
+    typename axiM::Addr addr = 0;
+    Beats left = 0;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while(1) {
+      wait();
+      if (left == 0) {
+        if (axiM_read.ar.PopNB(AR)) {
+          CheckRequest(AR);
+          rd_len.Push(AR.len);
+          addr = AR.addr;
+          left = static_cast<Beats>(AR.len + 1) << log_ratio;
+        }
+      }
+      if (left != 0) {
+        typename axiM::Addr next_addr = addr;
+        Beats next_left = left;
+        typename axiS::AddrPayload out = NextPiece(AR, next_addr, next_left);
+        if (axiS_read.ar.PushNB(out)) {
+          addr = next_addr;
+          left = next_left;
+        }
+      }
+    }
+  }
+
+  void axi_read_r() {
+    axiM_read.r.Reset();
+    axiS_read.r.Reset();
+    rd_len.ResetRead();
+
+    FIFO<typename axiM::BeatNum, maxOutstanding> lenQ;
+    lenQ.reset();
+    typename axiM::ReadPayload R;
+    Lane lane = 0;
+    typename axiM::BeatNum beat = 0;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while(1) {
+      wait();
+      if (!lenQ.isEmpty()) {
+        typename axiS::ReadPayload Rs;
+        if (axiS_read.r.PopNB(Rs)) {
+          R.data = nvhls::set_slc(R.data, Rs.data, lane * CfgSlave::dataWidth);
+          if (lane == 0 || Rs.resp > R.resp) {
+            R.resp = Rs.resp;
+          }
+          R.id = Rs.id;
+          R.ruser = Rs.ruser;
+          if (lane == ratio - 1) {
+            bool last = (beat == lenQ.peek());
+            R.last = last;
+            axiM_read.r.Push(R);
+            if (last) {
+              lenQ.pop();
+              beat = 0;
+            } else {
+              ++beat;
+            }
+          }
+          ++lane;
+        }
+      }
+      if (!lenQ.isFull()) {
+        typename axiM::BeatNum len;
+        if (rd_len.PopNB(len)) {
+          lenQ.push(len);
+        }
+      }
+    }
+  }
+
+  void axi_write_aw() {
+    axiM_write.aw.Reset();
+    axiS_write.aw.Reset();
+    wr_len.ResetWrite();
+    wr_pieces.ResetWrite();
+
+    typename axiM::AddrPayload AW;
+    typename axiM::Addr addr = 0;
+    Beats left = 0;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while(1) {
+      wait();
+      if (left == 0) {
+        if (axiM_write.aw.PopNB(AW)) {
+          CheckRequest(AW);
+          wr_len.Push(AW.len);
+          addr = AW.addr;
+          left = static_cast<Beats>(AW.len + 1) << log_ratio;
+          if (CfgMaster::useWriteResponses) {
+            wr_pieces.Push((left - 1) >> log_maxBurstS);
+          }
+        }
+      }
+      if (left != 0) {
+        typename axiM::Addr next_addr = addr;
+        Beats next_left = left;
+        typename axiS::AddrPayload out = NextPiece(AW, next_addr, next_left);
+        if (axiS_write.aw.PushNB(out)) {
+          addr = next_addr;
+          left = next_left;
+        }
+      }
+    }
+  }
+
+  void axi_write_w() {
+    axiM_write.w.Reset();
+    axiS_write.w.Reset();
+    wr_len.ResetRead();
+
+    FIFO<typename axiM::BeatNum, maxOutstanding> lenQ;
+    lenQ.reset();
+    typename axiM::WritePayload W;
+    bool w_valid = false;
+    Lane lane = 0;
+    typename axiM::BeatNum beat = 0;
+    PieceBeat piece_beat = 0;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while(1) {
+      wait();
+      if (!w_valid) {
+        w_valid = axiM_write.w.PopNB(W);
+      }
+      if (w_valid && !lenQ.isEmpty()) {
+        bool burst_end = (lane == ratio - 1) && (beat == lenQ.peek());
+        bool last = burst_end || (piece_beat == CfgSlave::maxBurstSize - 1);
+        typename axiS::WritePayload Ws;
+        Ws.data = nvhls::get_slc<CfgSlave::dataWidth>(W.data, lane * CfgSlave::dataWidth);
+        Ws.wstrb = nvhls::get_slc<bytesS>(W.wstrb, lane * bytesS);
+        Ws.last = last;
+        Ws.wuser = W.wuser;
+        if (axiS_write.w.PushNB(Ws)) {
+          piece_beat = last ? PieceBeat(0) : PieceBeat(piece_beat + 1);
+          if (lane == ratio - 1) {
+            w_valid = false;
+            if (burst_end) {
+              lenQ.pop();
+              beat = 0;
+            } else {
+              ++beat;
+            }
+          }
+          ++lane;
+        }
+      }
+      if (!lenQ.isFull()) {
+        typename axiM::BeatNum len;
+        if (wr_len.PopNB(len)) {
+          lenQ.push(len);
+        }
+      }
+    }
+  }
+
+  void axi_write_b() {
+    axiM_write.b.Reset();
+    axiS_write.b.Reset();
+    wr_pieces.ResetRead();
+
+    FIFO<Pieces, maxOutstanding> piecesQ;
+    piecesQ.reset();
+    typename axiM::WRespPayload B;
+    Pieces piece = 0;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while(1) {
+      wait();
+      if (!piecesQ.isEmpty()) {
+        typename axiS::WRespPayload Bs;
+        if (axiS_write.b.PopNB(Bs)) {
+          if (piece == 0 || Bs.resp > B.resp) {
+            B.resp = Bs.resp;
+          }
+          B.id = Bs.id;
+          B.buser = Bs.buser;
+          if (piece == piecesQ.peek()) {
+            axiM_write.b.Push(B);
+            piecesQ.pop();
+            piece = 0;
+          } else {
+            ++piece;
+          }
+        }
+      }
+      if (!piecesQ.isFull()) {
+        Pieces pieces;
+        if (wr_pieces.PopNB(pieces)) {
+          piecesQ.push(pieces);
+        }
+      }
+    }
+  }
+};
+
+#endif
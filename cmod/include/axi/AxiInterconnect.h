@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __AXI_INTERCONNECT_H__
+#define __AXI_INTERCONNECT_H__
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_int.h>
+#include <nvhls_array.h>
+#include <axi/axi4.h>
+#include <axi/AxiArbiter.h>
+#include <axi/AxiSplitter.h>
+
+/**
+ * \brief An AXI crossbar that connects multiple AXI masters to multiple AXI slaves.
+ * \ingroup AXI
+ *
+ * \tparam axiCfg                   A valid AXI config.
+ * \tparam numMasters               The number of master ports.
+ * \tparam numSlaves                The number of slave ports.
+ * \tparam maxOutstandingRequests   The number of outstanding read or write requests tracked by each per-slave arbiter.  (Default: 16)
+ * \tparam numAddrBitsToInspect     The number of address LSBs used for address decode, as in AxiSplitter.  (Default: axiCfg::addrWidth)
+ * \tparam remapIds                 If true, the per-slave arbiters extend the ID with the master index, so slaves may return responses out of order across masters.  (Default: true)
+ *
+ * \par Overview
+ * AxiInterconnect is a full crossbar built from one AxiSplitter per master and one AxiArbiter per slave.
+ * Each master's splitter decodes the request address and forwards it to the arbiter of the target slave, which arbitrates round-robin among the masters.
+ * Transfers between different master/slave pairs proceed in parallel; only masters targeting the same slave contend.
+ * - Address bounds for the slaves are set by writing to a (numSlaves x 2) array of sc_in, and are shared by all masters.
+ * - Each master has one outstanding request at a time, as in AxiSplitter.
+ * - With remapIds, masters must leave the upper log2(numMasters) ID bits zero (see AxiArbiter).
+ * - The AXI configs of all ports must be the same.
+ *
+ */
+template <typename axiCfg, int numMasters, int numSlaves,
+          int maxOutstandingRequests = 16,
+          int numAddrBitsToInspect = axiCfg::addrWidth, bool remapIds = true>
+class AxiInterconnect : public sc_module {
+ public:
+  static const int kDebugLevel = 5;
+  sc_in<bool> clk;
+  sc_in<bool> reset_bar;
+
+  typedef typename axi::axi4<axiCfg> axi_;
+
+  typedef typename axi_::read::template slave<>::ARPort axi_rd_slave_ar;
+  typedef typename axi_::read::template slave<>::RPort axi_rd_slave_r;
+  typedef typename axi_::write::template slave<>::AWPort axi_wr_slave_aw;
+  typedef typename axi_::write::template slave<>::WPort axi_wr_slave_w;
+  typedef typename axi_::write::template slave<>::BPort axi_wr_slave_b;
+
+  typedef typename axi_::read::template master<>::ARPort axi_rd_master_ar;
+  typedef typename axi_::read::template master<>::RPort axi_rd_master_r;
+  typedef typename axi_::write::template master<>::AWPort axi_wr_master_aw;
+  typedef typename axi_::write::template master<>::WPort axi_wr_master_w;
+  typedef typename axi_::write::template master<>::BPort axi_wr_master_b;
+
+  typedef AxiSplitter<axiCfg, numSlaves, numAddrBitsToInspect> Splitter;
+  typedef AxiArbiter<axiCfg, numMasters, maxOutstandingRequests, remapIds> Arb;
+
+  // Master-facing ports
+  nvhls::nv_array<axi_rd_slave_ar, numMasters> axi_rd_m_ar;
+  nvhls::nv_array<axi_rd_slave_r, numMasters> axi_rd_m_r;
+  nvhls::nv_array<axi_wr_slave_aw, numMasters> axi_wr_m_aw;
+  nvhls::nv_array<axi_wr_slave_w, numMasters> axi_wr_m_w;
+  nvhls::nv_array<axi_wr_slave_b, numMasters> axi_wr_m_b;
+
+  // Slave-facing ports
+  nvhls::nv_array<axi_rd_master_ar, numSlaves> axi_rd_s_ar;
+  nvhls::nv_array<axi_rd_master_r, numSlaves> axi_rd_s_r;
+  nvhls::nv_array<axi_wr_master_aw, numSlaves> axi_wr_s_aw;
+  nvhls::nv_array<axi_wr_master_w, numSlaves> axi_wr_s_w;
+  nvhls::nv_array<axi_wr_master_b, numSlaves> axi_wr_s_b;
+
+  sc_in<NVUINTW(numAddrBitsToInspect)> addrBound[numSlaves][2];
+
+  nvhls::nv_array<Splitter, numMasters> splitter;
+  nvhls::nv_array<Arb, numSlaves> arbiter;
+
+  // Point-to-point links, indexed by master * numSlaves + slave
+  nvhls::nv_array<Connections::Combinational<typename axi_::AddrPayload>, numMasters * numSlaves> link_ar;
+  nvhls::nv_array<Connections::Combinational<typename axi_::ReadPayload>, numMasters * numSlaves> link_r;
+  nvhls::nv_array<Connections::Combinational<typename axi_::AddrPayload>, numMasters * numSlaves> link_aw;
+  nvhls::nv_array<Connections::Combinational<typename axi_::WritePayload>, numMasters * numSlaves> link_w;
+  nvhls::nv_array<Connections::Combinational<typename axi_::WRespPayload>, numMasters * numSlaves> link_b;
+
+  SC_HAS_PROCESS(AxiInterconnect);
+
+  AxiInterconnect(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        reset_bar("reset_bar"),
+        axi_rd_m_ar("axi_rd_m_ar"),
+        axi_rd_m_r("axi_rd_m_r"),
+        axi_wr_m_aw("axi_wr_m_aw"),
+        axi_wr_m_w("axi_wr_m_w"),
+        axi_wr_m_b("axi_wr_m_b"),
+        axi_rd_s_ar("axi_rd_s_ar"),
+        axi_rd_s_r("axi_rd_s_r"),
+        axi_wr_s_aw("axi_wr_s_aw"),
+        axi_wr_s_w("axi_wr_s_w"),
+        axi_wr_s_b("axi_wr_s_b"),
+        splitter("splitter"),
+        arbiter("arbiter"),
+        link_ar("link_ar"),
+        link_r("link_r"),
+        link_aw("link_aw"),
+        link_w("link_w"),
+        link_b("link_b") {
+
+    for (int m = 0; m < numMasters; m++) {
+      splitter[m].clk(clk);
+      splitter[m].reset_bar(reset_bar);
+      splitter[m].axi_rd_m.ar(axi_rd_m_ar[m]);
+      splitter[m].axi_rd_m.r(axi_rd_m_r[m]);
+      splitter[m].axi_wr_m.aw(axi_wr_m_aw[m]);
+      splitter[m].axi_wr_m.w(axi_wr_m_w[m]);
+      splitter[m].axi_wr_m.b(axi_wr_m_b[m]);
+      for (int s = 0; s < numSlaves; s++) {
+        splitter[m].axi_rd_s_ar[s](link_ar[m * numSlaves + s]);
+        splitter[m].axi_rd_s_r[s](link_r[m * numSlaves + s]);
+        splitter[m].axi_wr_s_aw[s](link_aw[m * numSlaves + s]);
+        splitter[m].axi_wr_s_w[s](link_w[m * numSlaves + s]);
+        splitter[m].axi_wr_s_b[s](link_b[m * numSlaves + s]);
+        for (int j = 0; j < 2; j++) {
+          splitter[m].addrBound[s][j](addrBound[s][j]);
+        }
+      }
+    }
+
+    for (int s = 0; s < numSlaves; s++) {
+      arbiter[s].clk(clk);
+      arbiter[s].reset_bar(reset_bar);
+      for (int m = 0; m < numMasters; m++) {
+        arbiter[s].axi_rd_m_ar[m](link_ar[m * numSlaves + s]);
+        arbiter[s].axi_rd_m_r[m](link_r[m * numSlaves + s]);
+        arbiter[s].axi_wr_m_aw[m](link_aw[m * numSlaves + s]);
+        arbiter[s].axi_wr_m_w[m](link_w[m * numSlaves + s]);
+        arbiter[s].axi_wr_m_b[m](link_b[m * numSlaves + s]);
+      }
+      arbiter[s].axi_rd_s.ar(axi_rd_s_ar[s]);
+      arbiter[s].axi_rd_s.r(axi_rd_s_r[s]);
+      arbiter[s].axi_wr_s.aw(axi_wr_s_aw[s]);
+      arbiter[s].axi_wr_s.w(axi_wr_s_w[s]);
+      arbiter[s].axi_wr_s.b(axi_wr_s_b[s]);
+    }
+  }
+};
+
+#endif
@@ -23,17 +23,21 @@
 #include <hls_globals.h>
 #include <axi/axi4.h>
 #include <mem_array.h>
+#include <fifo.h>
 
 /**
  * \brief An AXI slave SRAM for the AXI-Lite protocol.
  * \ingroup AXI
  *
  * \tparam capacity   The capacity in bytes of the local SRAM.
+ * \tparam fifoDepth  Depth of the read and write response queues. (default: 2)
  *
  * \par Overview
  * AxiLiteSlaveToMem is an AXI slave compliant with the AXI-Lite protocol (32-bit data words, no bursts).
  * The module only handles AXI addresses within the range of its internal memory, with a base address of 0.
  * It does not support write strobes.
+ * The read and write paths are pipelined independently: a new AR and a new AW/W can be accepted every cycle
+ * while up to fifoDepth responses per channel wait in order for the master to accept them.
  *
  * \par Usage Guidelines
  *
@@ -50,7 +54,7 @@
  * \par
  *
  */
-template <int capacity>
+template <int capacity, int fifoDepth = 2>
 class AxiLiteSlaveToMem : public sc_module {
  private:
   typedef typename axi::axi4<axi::cfg::lite_nowstrb> axi_;
@@ -79,60 +83,57 @@ class AxiLiteSlaveToMem : public sc_module {
 
  protected:
   void run() {
-    axi_::AddrPayload rd_addr_pld;
-    axi_::AddrPayload wr_addr_pld;
-    axi_::ReadPayload data_pld;
-    axi_::WritePayload write_pld;
-    axi_::WRespPayload resp_pld;
-    bool rd_resp_pend;
-    bool wr_resp_pend;
+    FIFO<axi_::ReadPayload, fifoDepth> rd_resp;
+    FIFO<axi_::WRespPayload, fifoDepth> wr_resp;
 
     if_rd.reset();
     if_wr.reset();
+    rd_resp.reset();
+    wr_resp.reset();
 
-    rd_resp_pend = false;
-    wr_resp_pend = false;
-
-    #pragma hls_pipeline_init_interval 4
+    #pragma hls_pipeline_init_interval 1
     #pragma pipeline_stall_mode flush
     while (1) {
       wait();
 
-      bool rd_resp_pend_local = rd_resp_pend;
-      bool wr_resp_pend_local = wr_resp_pend;
-      bool rd_mem;
-      bool wr_mem;
-
-      if (!rd_resp_pend_local) {
-        rd_mem = (if_rd.nb_aread(rd_addr_pld));
-        if (rd_mem) {
-          data_pld.resp = axi_::Enc::XRESP::OKAY;
-          rd_resp_pend_local = true;
+      // Responses leave in order; draining first lets a full queue accept a
+      // new request in the same cycle
+      if (!rd_resp.isEmpty()) {
+        axi_::ReadPayload data_pld;
+        data_pld = rd_resp.peek();
+        if (if_rd.nb_rwrite(data_pld)) {
+          rd_resp.incrHead();
         }
       }
 
-      if (!wr_resp_pend_local) {
-        wr_mem = if_wr.nb_wread(wr_addr_pld, write_pld);
-
-        if (wr_mem) {
-          resp_pld.resp = axi_::Enc::XRESP::OKAY;
-          wr_resp_pend_local = true;
+      if (!wr_resp.isEmpty()) {
+        axi_::WRespPayload resp_pld;
+        resp_pld = wr_resp.peek();
+        if (if_wr.nb_bwrite(resp_pld)) {
+          wr_resp.incrHead();
         }
       }
 
-      if (rd_mem)
-        data_pld.data = memarray.read(rd_addr_pld.addr);
-      if (wr_mem)
-        memarray.write(wr_addr_pld.addr,0,write_pld.data);
-      if (rd_resp_pend_local) {
-        rd_resp_pend_local = !(if_rd.nb_rwrite(data_pld));
+      if (!rd_resp.isFull()) {
+        axi_::AddrPayload rd_addr_pld;
+        if (if_rd.nb_aread(rd_addr_pld)) {
+          axi_::ReadPayload data_pld;
+          data_pld.data = memarray.read(rd_addr_pld.addr);
+          data_pld.resp = axi_::Enc::XRESP::OKAY;
+          rd_resp.push(data_pld);
+        }
       }
 
-      if (wr_resp_pend_local) {
-        wr_resp_pend_local = !(if_wr.nb_bwrite(resp_pld));
+      if (!wr_resp.isFull()) {
+        axi_::AddrPayload wr_addr_pld;
+        axi_::WritePayload write_pld;
+        if (if_wr.nb_wread(wr_addr_pld, write_pld)) {
+          memarray.write(wr_addr_pld.addr, 0, write_pld.data);
+          axi_::WRespPayload resp_pld;
+          resp_pld.resp = axi_::Enc::XRESP::OKAY;
+          wr_resp.push(resp_pld);
+        }
       }
-      rd_resp_pend = rd_resp_pend_local;
-      wr_resp_pend = wr_resp_pend_local;
     }
   }
 };
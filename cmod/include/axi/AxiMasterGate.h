@@ -35,11 +35,29 @@
  * \tparam Cfg                A valid AXI config.
  * \tparam ROBDepth           The depth of the reorder buffers.
  * \tparam MaxInFlightTrans   The number of independent AXI requests that can be in flight simultaneously.
+ * \tparam outOfOrder         If true, return responses in the order they arrive, tagged with the id of their request.  (Default: false)
+ * \tparam perIdOrder         If true, return responses in request order within each request id only, tagged with the id.  (Default: false)
  *
  * \par Overview
  * This block takes as inputs RdRequest and WrRequest Connections. The block converts the requests into
  * AXI format, sends them to AXI master ports, and processes the responses into RdResponse and WrResponse ports.
  * ReorderBuf and ReorderBufWBeats are used to allow reordering via use of the AXI ID field.
+ * Requests are converted one-for-one; AxiWriteCombiner and AxiReadPrefetcher can be placed in front of
+ * the request/response ports to merge sequential writes into bursts and to prefetch lines for streaming reads.
+ * AxiCache can be placed in the same position to cache single-beat reads in a set-associative, write-through cache.
+ * AxiStreamToMem drives the write ports from an AXI4-Stream, writing packets into descriptor-defined buffers.
+ *
+ * With outOfOrder set, the id of each request is sent as its AXI ID and returned in the id field of its responses,
+ * which are passed on as soon as they arrive.  The reorder buffers are not used, so there is no head-of-line
+ * blocking behind a slow response and no reorder storage, and bursts need not wait for earlier reads to complete.
+ * Up to MaxInFlightTrans reads and writes can be in flight; ROBDepth is unused.  Responses to requests with the same
+ * id return in request order, as AXI requires.  In the default in-order mode the id of a request is ignored.
+ *
+ * With perIdOrder set (and outOfOrder clear), the reorder buffers are ReorderBufStreams with one stream per
+ * request id, so responses are only kept in request order within an id.  A response is passed on, tagged with
+ * its id, as soon as all earlier requests with the same id have been answered, and a slow response does not
+ * block completed responses of other ids.  AXI IDs are still allocated by the reorder buffers, and read bursts
+ * still wait for all earlier reads to complete.
  *
  * \par Usage Guidelines
  *
@@ -56,15 +74,35 @@
  * \par
  *
  */
-template <typename Cfg, int ROBDepth = 8, int MaxInFlightTrans = 4>
+// Selects the reorder buffer of AxiMasterGate
+template <typename InOrder, typename PerId, bool UsePerId>
+struct axi_master_gate_rob_select {
+  typedef InOrder type;
+};
+
+template <typename InOrder, typename PerId>
+struct axi_master_gate_rob_select<InOrder, PerId, true> {
+  typedef PerId type;
+};
+
+template <typename Cfg, int ROBDepth = 8, int MaxInFlightTrans = 4, bool outOfOrder = false,
+          bool perIdOrder = false>
 class AxiMasterGate : public sc_module {
  private:
   typedef axi::axi4<Cfg> axi4_;
 
   typedef NVUINTW(axi4_::DATA_WIDTH) Data;
 
-  ReorderBuf<WrResp<Cfg>, ROBDepth, MaxInFlightTrans> wr_rob;
-  ReorderBufWBeats<RdResp<Cfg>, ROBDepth, MaxInFlightTrans> rd_rob;
+  static const unsigned int NumIds = 1 << axi4_::ID_WIDTH;
+  typedef typename axi_master_gate_rob_select<
+      ReorderBuf<WrResp<Cfg>, ROBDepth, MaxInFlightTrans>,
+      ReorderBufStreams<WrResp<Cfg>, ROBDepth, MaxInFlightTrans, NumIds>, perIdOrder>::type WrRob;
+  typedef typename axi_master_gate_rob_select<
+      ReorderBufWBeats<RdResp<Cfg>, ROBDepth, MaxInFlightTrans>,
+      ReorderBufStreamsWBeats<RdResp<Cfg>, ROBDepth, MaxInFlightTrans, NumIds>, perIdOrder>::type RdRob;
+
+  WrRob wr_rob;
+  RdRob rd_rob;
 
   FIFO<RdRequest<Cfg>, 4> rdReqFifo;
   FIFO<WrRequest<Cfg>, 4> wrReqFifo;
@@ -84,17 +122,55 @@ class AxiMasterGate : public sc_module {
 
   SC_CTOR(AxiMasterGate)
       : if_rd("if_rd"), if_wr("if_wr"), reset_bar("reset_bar"), clk("clk") {
-    SC_THREAD(run_rd);
-    sensitive << clk.pos();
-    async_reset_signal_is(reset_bar, false);
-
-    SC_THREAD(run_wr);
-    sensitive << clk.pos();
-    async_reset_signal_is(reset_bar, false);
+    if (outOfOrder) {
+      SC_THREAD(run_rd_ooo);
+      sensitive << clk.pos();
+      async_reset_signal_is(reset_bar, false);
+
+      SC_THREAD(run_wr_ooo);
+      sensitive << clk.pos();
+      async_reset_signal_is(reset_bar, false);
+    } else {
+      SC_THREAD(run_rd);
+      sensitive << clk.pos();
+      async_reset_signal_is(reset_bar, false);
+
+      SC_THREAD(run_wr);
+      sensitive << clk.pos();
+      async_reset_signal_is(reset_bar, false);
+    }
   }
 
  protected:
   typedef sc_uint<axi4_::ID_WIDTH> Id;
+  typedef NVUINTW(nvhls::index_width<MaxInFlightTrans + 1>::val) Outstanding;
+
+  // Only the overloads matching perIdOrder are instantiated
+  template <bool PerId>
+  struct OrderTag {};
+
+  template <typename Rob>
+  static Id robAddRequest(Rob& rob, const typename axi4_::Id& id, OrderTag<false>) {
+    return rob.addRequest();
+  }
+
+  template <typename Rob>
+  static Id robAddRequest(Rob& rob, const typename axi4_::Id& id, OrderTag<true>) {
+    return rob.addRequest(id);
+  }
+
+  template <typename Rob, typename Resp>
+  static void robPopResponse(Rob& rob, Resp& resp, OrderTag<false>) {
+    resp = rob.popResponse();
+  }
+
+  // Tags the response with the id of its stream
+  template <typename Rob, typename Resp>
+  static void robPopResponse(Rob& rob, Resp& resp, OrderTag<true>) {
+    typename Rob::Stream stream;
+    resp = rob.popResponse(stream);
+    resp.id = stream;
+  }
 
   void run_wr() {
 
@@ -122,7 +198,7 @@ class AxiMasterGate : public sc_module {
       // send response
       if (wr_rob.topResponseReady()) {
         WrResp<Cfg> wrResp;
-        wrResp = wr_rob.popResponse();
+        robPopResponse(wr_rob, wrResp, OrderTag<perIdOrder>());
 
 #ifdef DEBUGMODE
         cout << "@" << sc_time_stamp()
@@ -182,7 +258,7 @@ class AxiMasterGate : public sc_module {
 
         // allocate a new id
         if (!wrRequestIdValid_local && wr_rob.canAcceptRequest()) {
-          wrRequestId_local = wr_rob.addRequest();
+          wrRequestId_local = robAddRequest(wr_rob, wrRequest_local.id, OrderTag<perIdOrder>());
           wrRequestIdValid_local = true;
 #ifdef DEBUGMODE
           cout << "@" << sc_time_stamp()
@@ -284,7 +360,7 @@ class AxiMasterGate : public sc_module {
       // send response
       if (rd_rob.topResponseReady()) {
         RdResp<Cfg> rdResp;
-        rdResp = rd_rob.popResponse();
+        robPopResponse(rd_rob, rdResp, OrderTag<perIdOrder>());
 
 #ifdef DEBUGMODE
         cout << "@" << sc_time_stamp()
@@ -328,7 +404,7 @@ class AxiMasterGate : public sc_module {
             (isBurst ? rd_rob.isEmpty() : rd_rob.canAcceptRequest());
 
         if (!rdRequestIdValid_local && robReady && !rdBurstInFlight_local) {
-          rdRequestId_local = rd_rob.addRequest();
+          rdRequestId_local = robAddRequest(rd_rob, rdRequest_local.id, OrderTag<perIdOrder>());
           rdRequestIdValid_local = true;
           rdBurstInFlight_local = isBurst;
 #ifdef DEBUGMODE
@@ -400,6 +476,127 @@ class AxiMasterGate : public sc_module {
       rdBurstInFlight = rdBurstInFlight_local;
     }
   }
+
+  void run_wr_ooo() {
+    if_wr.reset();
+    wrRequestIn.Reset();
+    wrRespOut.Reset();
+
+    WrRequest<Cfg> wrRequest;
+    bool wrRequestValid = false;
+    bool addr_sent = false;
+    typename axi4_::WRespPayload resp_pld;
+    bool wrRespValid = false;
+    Outstanding wrOutstanding = 0;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while (1) {
+      wait();
+
+      Outstanding wrOutstanding_local = wrOutstanding;
+
+      // send response, tagged with the AXI ID
+      if (wrRespValid) {
+        WrResp<Cfg> wrResp;
+        wrResp.resp = resp_pld.resp;
+        wrResp.id = resp_pld.id;
+        if (wrRespOut.PushNB(wrResp)) {
+          wrRespValid = false;
+          --wrOutstanding_local;
+        }
+      }
+      if (Cfg::useWriteResponses && !wrRespValid) {
+        wrRespValid = if_wr.b.PopNB(resp_pld);
+      }
+
+      if (!wrRequestValid) {
+        wrRequestValid = wrRequestIn.PopNB(wrRequest);
+      }
+
+      if (wrRequestValid) {
+        // send addr with the first beat; without write responses the number
+        // of writes in flight is not known and not limited
+        bool addr_sent_local = addr_sent;
+        if (!addr_sent_local && (!Cfg::useWriteResponses || wrOutstanding != MaxInFlightTrans)) {
+          typename axi4_::AddrPayload addr_pld;
+          wrRequest.copyToAddrPayload(addr_pld);
+          addr_pld.id = wrRequest.id;
+          addr_sent_local = if_wr.aw.PushNB(addr_pld);
+          if (addr_sent_local && Cfg::useWriteResponses)
+            ++wrOutstanding_local;
+        }
+        // send data
+        if (addr_sent_local) {
+          typename axi4_::WritePayload write_pld;
+          write_pld.data = wrRequest.data;
+          write_pld.last = wrRequest.last;
+          write_pld.wstrb = ~0;
+          if (if_wr.w.PushNB(write_pld)) {
+            wrRequestValid = false;
+            addr_sent_local = (wrRequest.last != 1);
+          }
+        }
+        addr_sent = addr_sent_local;
+      }
+
+      wrOutstanding = wrOutstanding_local;
+    }
+  }
+
+  void run_rd_ooo() {
+    if_rd.reset();
+    rdRequestIn.Reset();
+    rdRespOut.Reset();
+
+    RdRequest<Cfg> rdRequest;
+    bool rdRequestValid = false;
+    typename axi4_::ReadPayload data_pld;
+    bool rdRespValid = false;
+    Outstanding rdOutstanding = 0;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while (1) {
+      wait();
+
+      Outstanding rdOutstanding_local = rdOutstanding;
+
+      // send response, tagged with the AXI ID
+      if (rdRespValid) {
+        RdResp<Cfg> rdResp;
+        rdResp.data = data_pld.data;
+        rdResp.resp = data_pld.resp;
+        rdResp.last = data_pld.last;
+        rdResp.id = data_pld.id;
+        if (rdRespOut.PushNB(rdResp)) {
+          rdRespValid = false;
+          if (axi4_::LAST_WIDTH == 0 || static_cast<sc_uint<1> >(data_pld.last) == 1)
+            --rdOutstanding_local;
+        }
+      }
+      if (!rdRespValid) {
+        rdRespValid = if_rd.r.PopNB(data_pld);
+      }
+
+      if (!rdRequestValid) {
+        rdRequestValid = rdRequestIn.PopNB(rdRequest);
+      }
+
+      // send request
+      if (rdRequestValid && rdOutstanding != MaxInFlightTrans) {
+        typename axi4_::AddrPayload addr_pld;
+        rdRequest.copyToAddrPayload(addr_pld);
+        addr_pld.id = rdRequest.id;
+        if (if_rd.ar.PushNB(addr_pld)) {
+          rdRequestValid = false;
+          ++rdOutstanding_local;
+        }
+      }
+
+      rdOutstanding = rdOutstanding_local;
+    }
+  }
 };
 
 #endif
@@ -0,0 +1,542 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __AXICACHE_H__
+#define __AXICACHE_H__
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+#include <axi/axi4.h>
+#include <fifo.h>
+#include <mem_array.h>
+#include <nvhls_connections.h>
+#include <nvhls_assert.h>
+#include <nvhls_stats.h>
+#include <axi/AxiMasterGate/AxiMasterGateIf.h>
+#ifndef __SYNTHESIS__
+#include <iostream>
+#endif
+
+/**
+ * \brief A set-associative, non-blocking, write-through cache for the request/response interface of AxiMasterGate.
+ * \ingroup AXI
+ *
+ * \tparam Cfg          A valid AXI config with bursts.
+ * \tparam NumSets      Number of sets, a power of two. (default: 64)
+ * \tparam NumWays      Number of ways, a power of two. (default: 4)
+ * \tparam LineBeats    Beats per line; lines are aligned to LineBeats * bytesPerBeat. (default: 4)
+ * \tparam NumMSHRs     Number of miss status holding registers, i.e. outstanding line fills. (default: 4)
+ * \tparam RespQDepth   Number of host reads that can be in flight, in request order. (default: 8)
+ *
+ * \par Overview
+ * AxiCache sits between a host and the request/response ports of AxiMasterGate, in the same place
+ * as AxiReadPrefetcher and AxiWriteCombiner.  The tags and the data are two mem_array_sep with one
+ * bank per way, so a lookup reads all ways of a set in parallel.  Replacement is tree pseudo-LRU
+ * with NumWays-1 bits per set, updated on every hit and fill.
+ *
+ * A single-beat read that hits is answered from the data array.  A read that misses allocates an
+ * MSHR and fetches the line as one INCR burst into a victim way; further reads of the same line
+ * while the fill is outstanding are merged into that MSHR as secondary misses.  Hits and misses of
+ * other lines continue while up to NumMSHRs fills are outstanding, and responses are returned in
+ * request order from a RespQDepth-entry response queue.  Read bursts (len != 0) bypass the cache.
+ *
+ * Writes are write-through and no-write-allocate: every beat updates the line if it is cached and
+ * is forwarded downstream, and write responses are passed back unchanged.  To keep the cache
+ * coherent with memory, a write to a line with an outstanding fill waits for the fill, and a
+ * read miss is issued only when no write is waiting for its response, so a fill never returns
+ * data older than a write the cache has forwarded.  A line whose fill returns an error response
+ * is not cached; the error is returned to all reads merged into the MSHR.
+ *
+ * \par Statistics
+ * In C++ simulation the public member stats (match::Stats) counts hits, misses (primary misses,
+ * one line fill each), secondary_misses (reads merged into an outstanding fill), bypassed read
+ * bursts, writes and write_hits, and samples the number of busy MSHRs every cycle in the histogram
+ * mshr_occupancy_0_hist_<n>.  PrintStats() reports hit rate and mean MSHR occupancy.
+ *
+ * \par Usage Guidelines
+ * The data array is read by hits and written by fills and write hits in the same cycle, so it
+ * should be mapped to a memory with separate read and write ports.
+ *
+ * \par
+ *
+ */
+template <typename Cfg, int NumSets = 64, int NumWays = 4, int LineBeats = 4, int NumMSHRs = 4,
+          int RespQDepth = 8>
+class AxiCache : public sc_module {
+  typedef axi::axi4<Cfg> axi4_;
+
+  static_assert(Cfg::useBurst, "AxiCache requires an AXI config with bursts");
+  static_assert(NumSets >= 2 && (NumSets & (NumSets - 1)) == 0, "NumSets must be a power of two");
+  static_assert(NumWays >= 1 && (NumWays & (NumWays - 1)) == 0, "NumWays must be a power of two");
+  static_assert(LineBeats >= 2 && (LineBeats & (LineBeats - 1)) == 0 &&
+                LineBeats <= Cfg::maxBurstSize,
+                "LineBeats must be a power of two no larger than maxBurstSize");
+
+  static const int bytesPerBeat = Cfg::dataWidth >> 3;
+  static const int log_bytesPerBeat = nvhls::log2_ceil<bytesPerBeat>::val;
+  static const int log_lineBeats = nvhls::log2_ceil<LineBeats>::val;
+  static const int log_lineBytes = log_bytesPerBeat + log_lineBeats;
+  static const int log_sets = nvhls::log2_ceil<NumSets>::val;
+  static const int log_ways = nvhls::log2_ceil<NumWays>::val;
+  static const int TagWidth = axi4_::ADDR_WIDTH - log_lineBytes - log_sets;
+  static const int PlruBits = (NumWays > 1) ? NumWays - 1 : 1;
+  static const int FillQDepth = NumMSHRs + RespQDepth;
+  static const int MaxWrOutstanding = 8;
+
+  typedef typename axi4_::Data Data;
+  typedef typename axi4_::Addr Addr;
+  typedef typename axi4_::Resp Resp;
+  typedef NVUINTW(axi4_::ADDR_WIDTH - log_lineBytes) LineAddr;
+  typedef NVUINTW(TagWidth) Tag;
+  typedef NVUINTW(log_sets) SetIdx;
+  typedef NVUINTW(nvhls::index_width<NumWays>::val) Way;
+  typedef NVUINTW(log_lineBeats) BeatIdx;
+  typedef NVUINTW(nvhls::nbits<NumMSHRs>::val) MshrIdx;   // NumMSHRs marks a bypassed burst
+  typedef NVUINTW(nvhls::nbits<RespQDepth>::val) QCount;
+  typedef NVUINTW(nvhls::index_width<RespQDepth>::val) QIdx;
+  typedef NVUINTW(nvhls::nbits<MaxWrOutstanding>::val) WrCount;
+  typedef NVUINTW(NumWays) WayMask;
+  typedef NVUINTW(PlruBits) Plru;
+
+  typedef mem_array_sep<Data, NumSets * NumWays * LineBeats, NumWays> DataArray;
+  typedef mem_array_sep<Tag, NumSets * NumWays, NumWays> TagArray;
+  typedef typename DataArray::LocalIndex DataIdx;
+
+  DataArray data_array;
+  TagArray tag_array;
+
+ public:
+  sc_in<bool> reset_bar;
+  sc_in<bool> clk;
+
+  Connections::In<RdRequest<Cfg> > rdRequestIn;
+  Connections::Out<RdResp<Cfg> > rdRespOut;
+  Connections::In<WrRequest<Cfg> > wrRequestIn;
+  Connections::Out<WrResp<Cfg> > wrRespOut;
+
+  Connections::Out<RdRequest<Cfg> > rdRequestOut;
+  Connections::In<RdResp<Cfg> > rdRespIn;
+  Connections::Out<WrRequest<Cfg> > wrRequestOut;
+  Connections::In<WrResp<Cfg> > wrRespIn;
+
+  match::Stats stats;
+
+  SC_HAS_PROCESS(AxiCache);
+
+  AxiCache(sc_module_name name)
+      : sc_module(name),
+        reset_bar("reset_bar"),
+        clk("clk"),
+        rdRequestIn("rdRequestIn"),
+        rdRespOut("rdRespOut"),
+        wrRequestIn("wrRequestIn"),
+        wrRespOut("wrRespOut"),
+        rdRequestOut("rdRequestOut"),
+        rdRespIn("rdRespIn"),
+        wrRequestOut("wrRequestOut"),
+        wrRespIn("wrRespIn") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+  }
+
+#ifndef __SYNTHESIS__
+  // Reports hit rate and mean MSHR occupancy
+  void PrintStats(std::ostream& os = std::cout) {
+    uint64 hits = stats.GetStat("hits");
+    uint64 misses = stats.GetStat("misses");
+    uint64 secondary = stats.GetStat("secondary_misses");
+    uint64 reads = hits + misses + secondary;
+    uint64 cycles = stats.GetStat("cycles");
+    os << name() << ": " << reads << " single-beat reads, " << hits << " hits, " << misses
+       << " misses, " << secondary << " secondary misses, " << stats.GetStat("bypassed_bursts")
+       << " bursts bypassed, " << stats.GetStat("writes") << " writes, "
+       << stats.GetStat("write_hits") << " write hits";
+    if (reads != 0)
+      os << ", hit rate " << static_cast<double>(hits) / reads;
+    if (cycles != 0)
+      os << ", mean MSHR occupancy "
+         << static_cast<double>(stats.GetStat("mshr_busy")) / cycles;
+    os << std::endl;
+  }
+#endif
+
+ protected:
+  static LineAddr LineOf(Addr addr) { return addr >> log_lineBytes; }
+  static SetIdx SetOf(LineAddr line) { return nvhls::get_slc<log_sets>(line, 0); }
+  static Tag TagOf(LineAddr line) { return line >> log_sets; }
+  static BeatIdx BeatOf(Addr addr) { return nvhls::get_slc<log_lineBeats>(addr, log_bytesPerBeat); }
+
+  static DataIdx IndexOf(SetIdx set, BeatIdx beat) {
+    DataIdx idx = set;
+    return (idx << log_lineBeats) | static_cast<DataIdx>(beat);
+  }
+
+  // Tree pseudo-LRU: bit 0 of a node points to the left (lower) half as the next victim
+  static Way PlruVictim(Plru bits) {
+    unsigned int way = 0;
+    unsigned int node = 0;
+    #pragma hls_unroll yes
+    for (int l = 0; l < log_ways; l++) {
+      unsigned int right = (bits[node] == 1) ? 1 : 0;
+      way = (way << 1) | right;
+      node = 2 * node + 1 + right;
+    }
+    return way;
+  }
+
+  static Plru PlruTouch(Plru bits, Way way) {
+    unsigned int w = way.to_uint64();
+    unsigned int node = 0;
+    #pragma hls_unroll yes
+    for (int l = log_ways - 1; l >= 0; l--) {
+      unsigned int right = (w >> l) & 1;
+      bits[node] = right ? 0 : 1;
+      node = 2 * node + 1 + right;
+    }
+    return bits;
+  }
+
+  static RdRequest<Cfg> lineRequest(LineAddr line) {
+    RdRequest<Cfg> req;
+    req.addr = static_cast<Addr>(line) << log_lineBytes;
+    req.len = LineBeats - 1;
+    req.size = log_bytesPerBeat;
+    req.burst = axi::AXI4_Encoding::AXBURST::INCR;
+    req.cache = 0;
+    req.auser = 0;
+    return req;
+  }
+
+  void run() {
+    rdRequestIn.Reset();
+    rdRespOut.Reset();
+    wrRequestIn.Reset();
+    wrRespOut.Reset();
+    rdRequestOut.Reset();
+    rdRespIn.Reset();
+    wrRequestOut.Reset();
+    wrRespIn.Reset();
+
+    WayMask line_valid[NumSets];
+    WayMask line_pending[NumSets];
+    Plru plru[NumSets];
+    #pragma hls_unroll yes
+    for (int s = 0; s < NumSets; s++) {
+      line_valid[s] = 0;
+      line_pending[s] = 0;
+      plru[s] = 0;
+    }
+
+    bool mshr_valid[NumMSHRs];
+    bool mshr_done[NumMSHRs];
+    LineAddr mshr_line[NumMSHRs];
+    Way mshr_way[NumMSHRs];
+    QCount mshr_targets[NumMSHRs];
+    Resp mshr_resp[NumMSHRs];
+    Data mshr_data[NumMSHRs][LineBeats];
+    #pragma hls_unroll yes
+    for (int m = 0; m < NumMSHRs; m++) {
+      mshr_valid[m] = false;
+      mshr_done[m] = false;
+      mshr_line[m] = 0;
+      mshr_way[m] = 0;
+      mshr_targets[m] = 0;
+      mshr_resp[m] = 0;
+    }
+
+    // Host reads in request order; a slot is answered by a hit, by an MSHR or by a
+    // bypassed burst (slot_mshr == NumMSHRs)
+    bool slot_ready[RespQDepth];
+    MshrIdx slot_mshr[RespQDepth];
+    BeatIdx slot_beat[RespQDepth];
+    Data slot_data[RespQDepth];
+    QIdx q_head = 0;
+    QIdx q_tail = 0;
+    QCount q_count = 0;
+
+    // Destination of each outstanding downstream read, in issue order
+    FIFO<MshrIdx, FillQDepth> fillQ;
+    fillQ.reset();
+    BeatIdx fill_beat = 0;
+
+    RdResp<Cfg> resp;
+    bool resp_valid = false;
+    WrResp<Cfg> wresp;
+    bool wresp_valid = false;
+    WrCount wr_outstanding = 0;
+
+    RdRequest<Cfg> rd_req;
+    bool rd_req_valid = false;
+    WrRequest<Cfg> wr_req;
+    bool wr_req_valid = false;
+    typename axi4_::BeatNum wr_beat = 0;
+    bool prefer_wr = false;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while (1) {
+      wait();
+
+      // Return a response to the host
+      if (resp_valid) {
+        resp_valid = !rdRespOut.PushNB(resp);
+      }
+
+      // Accept a downstream read beat: fill a line or forward a bypassed burst
+      if (!fillQ.isEmpty()) {
+        MshrIdx tag = fillQ.peek();
+        if (tag == NumMSHRs) {
+          if (!resp_valid && q_count != 0 && slot_mshr[q_head] == NumMSHRs) {
+            RdResp<Cfg> beat;
+            if (rdRespIn.PopNB(beat)) {
+              resp = beat;
+              resp_valid = true;
+              if (beat.last == 1) {
+                fillQ.incrHead();
+                q_head = (q_head == RespQDepth - 1) ? QIdx(0) : QIdx(q_head + 1);
+                --q_count;
+              }
+            }
+          }
+        } else {
+          RdResp<Cfg> beat;
+          if (rdRespIn.PopNB(beat)) {
+            LineAddr line = mshr_line[tag];
+            SetIdx set = SetOf(line);
+            mshr_data[tag][fill_beat] = beat.data;
+            if (fill_beat == 0 || beat.resp > mshr_resp[tag])
+              mshr_resp[tag] = beat.resp;
+            data_array.write(IndexOf(set, fill_beat), mshr_way[tag], beat.data);
+            if (fill_beat == LineBeats - 1) {
+              fill_beat = 0;
+              mshr_done[tag] = true;
+              tag_array.write(set, mshr_way[tag], TagOf(line));
+              line_pending[set][mshr_way[tag]] = 0;
+              if (mshr_resp[tag] == axi4_::Enc::XRESP::OKAY)
+                line_valid[set][mshr_way[tag]] = 1;
+              fillQ.incrHead();
+            } else {
+              ++fill_beat;
+            }
+          }
+        }
+      }
+
+      // Answer the oldest host read if its data is available
+      if (!resp_valid && q_count != 0 && slot_mshr[q_head] != NumMSHRs) {
+        bool ready = slot_ready[q_head];
+        MshrIdx m = slot_mshr[q_head];
+        if (ready) {
+          resp.data = slot_data[q_head];
+          resp.resp = axi4_::Enc::XRESP::OKAY;
+        } else if (mshr_done[m]) {
+          resp.data = mshr_data[m][slot_beat[q_head]];
+          resp.resp = mshr_resp[m];
+          --mshr_targets[m];
+          ready = true;
+        }
+        if (ready) {
+          resp.last = 1;
+          resp.ruser = 0;
+          resp_valid = true;
+          q_head = (q_head == RespQDepth - 1) ? QIdx(0) : QIdx(q_head + 1);
+          --q_count;
+        }
+      }
+
+      // Free MSHRs whose fill completed and whose reads were all answered
+      #pragma hls_unroll yes
+      for (int m = 0; m < NumMSHRs; m++) {
+        if (mshr_valid[m] && mshr_done[m] && mshr_targets[m] == 0)
+          mshr_valid[m] = false;
+      }
+
+      // Pass write responses back
+      if (!wresp_valid) {
+        wresp_valid = wrRespIn.PopNB(wresp);
+      }
+      if (wresp_valid && wrRespOut.PushNB(wresp)) {
+        wresp_valid = false;
+        --wr_outstanding;
+      }
+
+      if (!rd_req_valid) {
+        rd_req_valid = rdRequestIn.PopNB(rd_req);
+      }
+      if (!wr_req_valid) {
+        wr_req_valid = wrRequestIn.PopNB(wr_req);
+      }
+
+      // One tag lookup per cycle, alternating between reads and writes
+      bool do_wr = wr_req_valid && (prefer_wr || !rd_req_valid);
+      bool do_rd = rd_req_valid && !do_wr;
+      prefer_wr = do_rd;
+
+      bool q_full = (q_count == RespQDepth);
+
+      if (do_rd && rd_req.len != 0) {
+        if (!q_full && !fillQ.isFull() && rdRequestOut.PushNB(rd_req)) {
+          slot_mshr[q_tail] = NumMSHRs;
+          q_tail = (q_tail == RespQDepth - 1) ? QIdx(0) : QIdx(q_tail + 1);
+          ++q_count;
+          fillQ.push(NumMSHRs);
+          rd_req_valid = false;
+#ifndef __SYNTHESIS__
+          stats.IncrStat("bypassed_bursts");
+#endif
+        }
+      } else if (do_rd && !q_full) {
+        LineAddr line = LineOf(rd_req.addr);
+        SetIdx set = SetOf(line);
+        BeatIdx beat = BeatOf(rd_req.addr);
+
+        bool hit = false;
+        Way hit_way = 0;
+        #pragma hls_unroll yes
+        for (int w = 0; w < NumWays; w++) {
+          if (line_valid[set][w] == 1 && tag_array.read(set, w) == TagOf(line)) {
+            hit = true;
+            hit_way = w;
+          }
+        }
+
+        bool merge = false;
+        MshrIdx merge_mshr = 0;
+        MshrIdx free_mshr = NumMSHRs;
+        #pragma hls_unroll yes
+        for (int m = NumMSHRs - 1; m >= 0; m--) {
+          if (mshr_valid[m] && !mshr_done[m] && mshr_line[m] == line) {
+            merge = true;
+            merge_mshr = m;
+          }
+          if (!mshr_valid[m])
+            free_mshr = m;
+        }
+
+        if (hit) {
+          slot_ready[q_tail] = true;
+          slot_mshr[q_tail] = 0;
+          slot_data[q_tail] = data_array.read(IndexOf(set, beat), hit_way);
+          plru[set] = PlruTouch(plru[set], hit_way);
+          rd_req_valid = false;
+#ifndef __SYNTHESIS__
+          stats.IncrStat("hits");
+#endif
+        } else if (merge) {
+          slot_ready[q_tail] = false;
+          slot_mshr[q_tail] = merge_mshr;
+          slot_beat[q_tail] = beat;
+          ++mshr_targets[merge_mshr];
+          rd_req_valid = false;
+#ifndef __SYNTHESIS__
+          stats.IncrStat("secondary_misses");
+#endif
+        } else {
+          // Victim: the pseudo-LRU way, or the lowest way without an outstanding fill
+          Way victim = PlruVictim(plru[set]);
+          bool victim_ok = (line_pending[set][victim] == 0);
+          #pragma hls_unroll yes
+          for (int w = NumWays - 1; w >= 0; w--) {
+            if (!victim_ok && line_pending[set][w] == 0) {
+              victim = w;
+            }
+          }
+          victim_ok = victim_ok || (line_pending[set] != static_cast<WayMask>(~WayMask(0)));
+
+          if (victim_ok && free_mshr != NumMSHRs && wr_outstanding == 0 && !fillQ.isFull() &&
+              rdRequestOut.PushNB(lineRequest(line))) {
+            mshr_valid[free_mshr] = true;
+            mshr_done[free_mshr] = false;
+            mshr_line[free_mshr] = line;
+            mshr_way[free_mshr] = victim;
+            mshr_targets[free_mshr] = 1;
+            fillQ.push(free_mshr);
+            line_valid[set][victim] = 0;
+            line_pending[set][victim] = 1;
+            plru[set] = PlruTouch(plru[set], victim);
+            slot_ready[q_tail] = false;
+            slot_mshr[q_tail] = free_mshr;
+            slot_beat[q_tail] = beat;
+            rd_req_valid = false;
+#ifndef __SYNTHESIS__
+            stats.IncrStat("misses");
+#endif
+          }
+        }
+        if (!rd_req_valid) {
+          q_tail = (q_tail == RespQDepth - 1) ? QIdx(0) : QIdx(q_tail + 1);
+          ++q_count;
+        }
+      }
+
+      if (do_wr) {
+        typename axi4_::AddrPayload wr_addr;
+        wr_req.copyToAddrPayload(wr_addr);
+        Addr addr = axi4_::BeatAddr(wr_addr, wr_beat);
+        LineAddr line = LineOf(addr);
+        SetIdx set = SetOf(line);
+
+        bool filling = false;
+        #pragma hls_unroll yes
+        for (int m = 0; m < NumMSHRs; m++) {
+          if (mshr_valid[m] && !mshr_done[m] && mshr_line[m] == line)
+            filling = true;
+        }
+        bool hit = false;
+        Way hit_way = 0;
+        #pragma hls_unroll yes
+        for (int w = 0; w < NumWays; w++) {
+          if (line_valid[set][w] == 1 && tag_array.read(set, w) == TagOf(line)) {
+            hit = true;
+            hit_way = w;
+          }
+        }
+
+        bool last = (wr_req.last == 1);
+        if (!filling && !(last && wr_outstanding == MaxWrOutstanding) &&
+            wrRequestOut.PushNB(wr_req)) {
+          if (hit) {
+            data_array.write(IndexOf(set, BeatOf(addr)), hit_way, wr_req.data);
+          }
+          if (last) {
+            wr_beat = 0;
+            ++wr_outstanding;
+          } else {
+            ++wr_beat;
+          }
+          wr_req_valid = false;
+#ifndef __SYNTHESIS__
+          stats.IncrStat("writes");
+          if (hit) stats.IncrStat("write_hits");
+#endif
+        }
+      }
+
+#ifndef __SYNTHESIS__
+      unsigned int busy = 0;
+      for (int m = 0; m < NumMSHRs; m++) {
+        if (mshr_valid[m]) busy++;
+      }
+      stats.IncrStat("cycles");
+      stats.IncrStat("mshr_busy", busy);
+      stats.IncrStatHistogram("mshr_occupancy", 0, busy);
+#endif
+    }
+  }
+};
+
+#endif
@@ -36,6 +36,7 @@ struct Request : public nvhls_message {
     size = rhs.size;
     cache = rhs.cache;
     auser = rhs.auser;
+    id = rhs.id;
   };
   
   typedef axi::axi4<Cfg> axi4_;
@@ -46,10 +47,12 @@ struct Request : public nvhls_message {
   typename axi4_::Burst burst;
   typename axi4_::Cache cache;
   typename axi4_::AUser auser;
+  typename axi4_::Id id;  // Tag returned with the response in out-of-order mode
 
   static const unsigned int width = axi4_::ADDR_WIDTH + axi4_::ALEN_WIDTH +
                                     axi4_::ASIZE_WIDTH + axi4_::BURST_WIDTH +
-                                    axi4_::CACHE_WIDTH + axi4_::AUSER_WIDTH;
+                                    axi4_::CACHE_WIDTH + axi4_::AUSER_WIDTH +
+                                    axi4_::ID_WIDTH;
 
   template <unsigned int Size>
   void Marshall(Marshaller<Size>& m) {
@@ -59,6 +62,7 @@ struct Request : public nvhls_message {
     m& burst;
     m& cache;
     m& auser;
+    m& id;
   }
 
   void copyToAddrPayload(typename axi4_::AddrPayload& payload) const {
@@ -110,6 +114,7 @@ struct WrRequest : public Request<Cfg> {
     m& Request<Cfg>::burst;
     m& Request<Cfg>::cache;
     m& Request<Cfg>::auser;
+    m& Request<Cfg>::id;
     m& last;
     m& wuser;
   }
@@ -126,13 +131,15 @@ struct WrResp : public nvhls_message
   typedef axi::axi4<Cfg> axi4_;
   typename axi4_::Resp resp;
   typename axi4_::BUser buser;
+  typename axi4_::Id id;  // Tag of the request in out-of-order mode
 
-  static const unsigned int width = axi4_::RESP_WIDTH + axi4_::BUSER_WIDTH;
+  static const unsigned int width = axi4_::RESP_WIDTH + axi4_::BUSER_WIDTH + axi4_::ID_WIDTH;
 
   template <unsigned int Size>
   void Marshall(Marshaller<Size>& m) {
     m& resp;
     m& buser;
+    m& id;
   }
 };
 
@@ -149,9 +156,11 @@ struct RdResp : public nvhls_message
   typename axi4_::Data data;
   typename axi4_::Last last;
   typename axi4_::RUser ruser;
+  typename axi4_::Id id;  // Tag of the request in out-of-order mode
 
   static const unsigned int width = axi4_::RESP_WIDTH + axi4_::DATA_WIDTH +
-                                    axi4_::LAST_WIDTH + axi4_::RUSER_WIDTH;
+                                    axi4_::LAST_WIDTH + axi4_::RUSER_WIDTH +
+                                    axi4_::ID_WIDTH;
 
   template <unsigned int Size>
   void Marshall(Marshaller<Size>& m) {
@@ -159,6 +168,7 @@ struct RdResp : public nvhls_message
     m& data;
     m& last;
     m& ruser;
+    m& id;
   }
 };
 
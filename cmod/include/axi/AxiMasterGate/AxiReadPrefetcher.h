@@ -0,0 +1,357 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __AXIREADPREFETCHER_H__
+#define __AXIREADPREFETCHER_H__
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+#include <axi/axi4.h>
+#include <fifo.h>
+#include <nvhls_connections.h>
+#include <nvhls_assert.h>
+#include <axi/AxiMasterGate/AxiMasterGateIf.h>
+#ifndef __SYNTHESIS__
+#include <iostream>
+#endif
+
+/**
+ * \brief A next-line read prefetcher for the request/response interface of AxiMasterGate.
+ * \ingroup AXI
+ *
+ * \tparam Cfg           A valid AXI config.
+ * \tparam LineBeats     Beats per line; lines are aligned to LineBeats * bytesPerBeat. (default: 4)
+ * \tparam NumLines      Number of line buffers, at least 2. (default: 2)
+ * \tparam MaxInFlight   Number of downstream reads that can be outstanding. (default: 4)
+ *
+ * \par Overview
+ * AxiReadPrefetcher sits between a host and the rdRequestIn/rdRespOut ports of
+ * AxiMasterGate.  A single-beat host read that misses the line buffers fetches
+ * its whole line as one INCR burst.  Every access to line L also prefetches
+ * line L+1 if it is in the same 4KB page and not already buffered, so a
+ * streaming reader finds its next line already buffered.  Host bursts
+ * (len != 0) are passed through.  Responses are returned in request order.
+ *
+ * The prefetcher does not observe writes, so it is meant for read-only
+ * streams; buffered lines can be stale if the same addresses are written
+ * while buffered.
+ *
+ * In C++ simulation the block counts hits, demand misses and prefetches;
+ * PrintStats() reports hit rate and prefetch accuracy (prefetched lines that
+ * were read at least once).
+ *
+ * \par
+ *
+ */
+template <typename Cfg, int LineBeats = 4, int NumLines = 2, int MaxInFlight = 4>
+class AxiReadPrefetcher : public sc_module {
+  typedef axi::axi4<Cfg> axi4_;
+
+  static_assert(Cfg::useBurst, "AxiReadPrefetcher requires an AXI config with bursts");
+  static_assert(NumLines >= 2, "AxiReadPrefetcher needs at least two line buffers");
+  static_assert(LineBeats >= 2 && (LineBeats & (LineBeats - 1)) == 0 &&
+                LineBeats <= Cfg::maxBurstSize,
+                "LineBeats must be a power of two no larger than maxBurstSize");
+
+  static const int bytesPerBeat = Cfg::dataWidth >> 3;
+  static const int log_bytesPerBeat = nvhls::log2_ceil<bytesPerBeat>::val;
+  static const int log_lineBeats = nvhls::log2_ceil<LineBeats>::val;
+  static const int log_lineBytes = log_bytesPerBeat + log_lineBeats;
+  static const int log_linesPerPage = 12 - log_lineBytes;
+  static_assert(log_linesPerPage >= 0, "A line may not exceed 4KB");
+
+  typedef typename axi4_::Data Data;
+  typedef typename axi4_::Addr Addr;
+  typedef NVUINTW(axi4_::ADDR_WIDTH - log_lineBytes) LineAddr;
+  typedef NVUINTW(nvhls::nbits<NumLines>::val) Slot;   // NumLines means pass-through
+  typedef NVUINTW(log_lineBeats) BeatIdx;
+
+ public:
+  sc_in<bool> reset_bar;
+  sc_in<bool> clk;
+
+  Connections::In<RdRequest<Cfg> > rdRequestIn;
+  Connections::Out<RdResp<Cfg> > rdRespOut;
+  Connections::Out<RdRequest<Cfg> > rdRequestOut;
+  Connections::In<RdResp<Cfg> > rdRespIn;
+
+  SC_HAS_PROCESS(AxiReadPrefetcher);
+
+  AxiReadPrefetcher(sc_module_name name)
+      : sc_module(name),
+        reset_bar("reset_bar"),
+        clk("clk"),
+        rdRequestIn("rdRequestIn"),
+        rdRespOut("rdRespOut"),
+        rdRequestOut("rdRequestOut"),
+        rdRespIn("rdRespIn") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+#ifndef __SYNTHESIS__
+    hits_ = 0;
+    misses_ = 0;
+    passthrough_ = 0;
+    prefetches_ = 0;
+    useful_prefetches_ = 0;
+#endif
+  }
+
+#ifndef __SYNTHESIS__
+  // Reports hit rate and prefetch accuracy
+  void PrintStats(std::ostream& os = std::cout) const {
+    unsigned long accesses = hits_ + misses_;
+    os << name() << ": " << accesses << " single-beat reads, " << hits_
+       << " hits, " << misses_ << " misses, " << passthrough_
+       << " bursts passed through, " << prefetches_ << " prefetches, "
+       << useful_prefetches_ << " useful";
+    if (accesses != 0)
+      os << ", hit rate " << static_cast<double>(hits_) / accesses;
+    if (prefetches_ != 0)
+      os << ", prefetch accuracy "
+         << static_cast<double>(useful_prefetches_) / prefetches_;
+    os << std::endl;
+  }
+
+  unsigned long hits() const { return hits_; }
+  unsigned long prefetches() const { return prefetches_; }
+  unsigned long useful_prefetches() const { return useful_prefetches_; }
+#endif
+
+ protected:
+#ifndef __SYNTHESIS__
+  unsigned long hits_;
+  unsigned long misses_;
+  unsigned long passthrough_;
+  unsigned long prefetches_;
+  unsigned long useful_prefetches_;
+#endif
+
+  static RdRequest<Cfg> lineRequest(LineAddr line) {
+    RdRequest<Cfg> req;
+    req.addr = static_cast<Addr>(line) << log_lineBytes;
+    req.len = LineBeats - 1;
+    req.size = log_bytesPerBeat;
+    req.burst = axi::AXI4_Encoding::AXBURST::INCR;
+    req.cache = 0;
+    req.auser = 0;
+    return req;
+  }
+
+  void run() {
+    rdRequestIn.Reset();
+    rdRespOut.Reset();
+    rdRequestOut.Reset();
+    rdRespIn.Reset();
+
+    Data line_data[NumLines][LineBeats];
+    typename axi4_::Resp line_resp[NumLines];
+    LineAddr line_addr[NumLines];
+    bool line_valid[NumLines];     // data present
+    bool line_pending[NumLines];   // fill in flight
+    bool line_prefetched[NumLines];
+    bool line_used[NumLines];
+    BeatIdx fill_beat[NumLines];
+#pragma hls_unroll yes
+    for (int i = 0; i < NumLines; i++) {
+      line_addr[i] = 0;
+      line_valid[i] = false;
+      line_pending[i] = false;
+      line_prefetched[i] = false;
+      line_used[i] = false;
+      fill_beat[i] = 0;
+    }
+    Slot victim_ptr = 0;
+    Slot last_used = 0;
+
+    // Destination of each outstanding downstream read, in issue order
+    FIFO<Slot, MaxInFlight> tagQ;
+    tagQ.reset();
+    NVUINTW(nvhls::nbits<MaxInFlight>::val) pass_outstanding = 0;
+
+    RdRequest<Cfg> req;
+    bool req_valid = false;
+    bool req_missed = false;
+
+    RdResp<Cfg> resp;
+    bool resp_valid = false;
+
+    LineAddr pf_line = 0;
+    bool pf_valid = false;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while (1) {
+      wait();
+
+      // Return a response to the host
+      if (resp_valid) {
+        resp_valid = !rdRespOut.PushNB(resp);
+      }
+
+      // Accept a downstream response: fill a line or forward a burst beat
+      if (!tagQ.isEmpty()) {
+        Slot tag = tagQ.peek();
+        if (tag == NumLines) {
+          if (!resp_valid) {
+            RdResp<Cfg> beat;
+            if (rdRespIn.PopNB(beat)) {
+              resp = beat;
+              resp_valid = true;
+              if (beat.last == 1) {
+                tagQ.incrHead();
+                --pass_outstanding;
+              }
+            }
+          }
+        } else {
+          RdResp<Cfg> beat;
+          if (rdRespIn.PopNB(beat)) {
+            line_data[tag][fill_beat[tag]] = beat.data;
+            if (fill_beat[tag] == 0 || beat.resp > line_resp[tag])
+              line_resp[tag] = beat.resp;
+            if (fill_beat[tag] == LineBeats - 1) {
+              fill_beat[tag] = 0;
+              line_pending[tag] = false;
+              line_valid[tag] = true;
+              tagQ.incrHead();
+            } else {
+              ++fill_beat[tag];
+            }
+          }
+        }
+      }
+
+      if (!req_valid) {
+        req_valid = rdRequestIn.PopNB(req);
+        req_missed = false;
+      }
+
+      bool issued = false;
+      if (req_valid) {
+        if (req.len != 0) {
+          // Bursts bypass the line buffers
+          if (!tagQ.isFull() && rdRequestOut.PushNB(req)) {
+            tagQ.push(NumLines);
+            ++pass_outstanding;
+            req_valid = false;
+            issued = true;
+#ifndef __SYNTHESIS__
+            ++passthrough_;
+#endif
+          }
+        } else {
+          LineAddr line = req.addr >> log_lineBytes;
+          BeatIdx beat_idx = nvhls::get_slc<log_lineBeats>(req.addr, log_bytesPerBeat);
+          Slot slot = NumLines;
+#pragma hls_unroll yes
+          for (int i = 0; i < NumLines; i++) {
+            if ((line_valid[i] || line_pending[i]) && line_addr[i] == line)
+              slot = i;
+          }
+
+          if (slot == NumLines) {
+            // Demand miss: fetch the line into the next victim that is not
+            // being filled or just used
+            Slot victim = NumLines;
+#pragma hls_unroll yes
+            for (int k = NumLines - 1; k >= 0; k--) {
+              Slot i = (victim_ptr + k) % NumLines;
+              if (!line_pending[i] && i != last_used)
+                victim = i;
+            }
+            if (victim != NumLines && !tagQ.isFull() &&
+                rdRequestOut.PushNB(lineRequest(line))) {
+              line_valid[victim] = false;
+              line_addr[victim] = line;
+              line_pending[victim] = true;
+              line_prefetched[victim] = false;
+              line_used[victim] = false;
+              tagQ.push(victim);
+              victim_ptr = (victim + 1) % NumLines;
+              req_missed = true;
+              issued = true;
+#ifndef __SYNTHESIS__
+              ++misses_;
+#endif
+            }
+          } else if (line_valid[slot] && !resp_valid && pass_outstanding == 0) {
+            // Data is buffered and no earlier burst is still returning
+            resp.data = line_data[slot][beat_idx];
+            resp.resp = line_resp[slot];
+            resp.last = 1;
+            resp_valid = true;
+            req_valid = false;
+            last_used = slot;
+            if (line_prefetched[slot] && !line_used[slot]) {
+#ifndef __SYNTHESIS__
+              ++useful_prefetches_;
+#endif
+            }
+            line_used[slot] = true;
+#ifndef __SYNTHESIS__
+            if (!req_missed)
+              ++hits_;
+#endif
+            // Next-line prefetch within the 4KB page
+            LineAddr next = line + 1;
+            if (log_linesPerPage > 0 &&
+                nvhls::get_slc<(log_linesPerPage > 0 ? log_linesPerPage : 1)>(next, 0) != 0) {
+              pf_line = next;
+              pf_valid = true;
+            }
+          }
+        }
+      }
+
+      // Issue a pending prefetch when the request port is free
+      if (pf_valid && !issued) {
+        bool present = false;
+#pragma hls_unroll yes
+        for (int i = 0; i < NumLines; i++) {
+          if ((line_valid[i] || line_pending[i]) && line_addr[i] == pf_line)
+            present = true;
+        }
+        Slot victim = NumLines;
+#pragma hls_unroll yes
+        for (int k = NumLines - 1; k >= 0; k--) {
+          Slot i = (victim_ptr + k) % NumLines;
+          if (!line_pending[i] && i != last_used)
+            victim = i;
+        }
+        if (present) {
+          pf_valid = false;
+        } else if (victim != NumLines && !tagQ.isFull() &&
+                   rdRequestOut.PushNB(lineRequest(pf_line))) {
+          line_valid[victim] = false;
+          line_addr[victim] = pf_line;
+          line_pending[victim] = true;
+          line_prefetched[victim] = true;
+          line_used[victim] = false;
+          tagQ.push(victim);
+          victim_ptr = (victim + 1) % NumLines;
+          pf_valid = false;
+#ifndef __SYNTHESIS__
+          ++prefetches_;
+#endif
+        }
+      }
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,346 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __AXISTREAMTOMEM_H__
+#define __AXISTREAMTOMEM_H__
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+#include <axi/axi4.h>
+#include <axi/axi4_stream.h>
+#include <fifo.h>
+#include <nvhls_connections.h>
+#include <nvhls_assert.h>
+#include <axi/AxiMasterGate/AxiMasterGateIf.h>
+
+/**
+ * \brief A buffer descriptor for AxiStreamToMem.
+ *
+ * \tparam Cfg    A valid AXI config.
+ */
+template <typename Cfg>
+struct AxiStreamDmaDesc : public nvhls_message {
+  typedef axi::axi4<Cfg> axi4_;
+
+  typename axi4_::Addr addr;      // start address, aligned to the data width
+  typename axi4_::Addr maxBeats;  // buffer size in data words, at least 1
+
+  static const unsigned int width = 2 * axi4_::ADDR_WIDTH;
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& addr;
+    m& maxBeats;
+  }
+};
+
+/**
+ * \brief The completion status of an AxiStreamToMem descriptor.
+ *
+ * \tparam Cfg    A valid AXI config.
+ */
+template <typename Cfg>
+struct AxiStreamDmaStatus : public nvhls_message {
+  typedef axi::axi4<Cfg> axi4_;
+
+  typename axi4_::Addr bytes;  // kept (TKEEP) bytes written to the buffer
+  typename axi4_::Resp resp;   // worst write response of the buffer
+  NVUINT1 eop;                 // 1 if the buffer ends with TLAST, 0 if it filled up
+
+  static const unsigned int width = axi4_::ADDR_WIDTH + axi4_::RESP_WIDTH + 1;
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& bytes;
+    m& resp;
+    m& eop;
+  }
+};
+
+/**
+ * \brief A stream-to-memory DMA engine for the request/response interface of AxiMasterGate.
+ * \ingroup AXI
+ *
+ * \tparam StreamCfg   A valid AXI4-Stream config; its data width must match Cfg.
+ * \tparam Cfg         A valid AXI config with bursts and write responses.
+ * \tparam MaxBeats    The maximum length of a write burst. (default: 16)
+ * \tparam DataDepth   The number of stream beats buffered ahead of the bursts. (default: 2*MaxBeats)
+ * \tparam MaxInFlight The number of completed descriptors awaiting write responses. (default: 4)
+ *
+ * \par Overview
+ * AxiStreamToMem writes an AXI4-Stream into memory buffers described by
+ * AxiStreamDmaDesc.  For each descriptor, stream beats are written to
+ * consecutive words starting at addr until a beat with TLAST arrives or
+ * maxBeats words have been written; the rest of a packet that overflows a
+ * buffer continues in the next descriptor.  Beats are collected into INCR
+ * bursts of up to MaxBeats beats that do not cross a 4KB boundary, and sent
+ * to AxiMasterGate on wrRequestOut, so stream data reaches memory with one
+ * address beat per burst rather than per word.  Once every burst of a buffer
+ * has been acknowledged, an AxiStreamDmaStatus is sent on statusOut.
+ *
+ * The engine accepts one stream beat per cycle while DataDepth leaves room for
+ * the next burst.  A burst is only sent once it is complete, so a stream that
+ * pauses in the middle of a burst holds that burst back until more data, TLAST
+ * or the end of the buffer arrives.  Whole words are written: AxiMasterGate sets
+ * every write strobe, and TKEEP only determines the byte count in the status.
+ * Use AxiStreamWidthConverter to match a stream of a different width.
+ *
+ * \code
+ *      AxiStreamToMem<axi::cfg::stream, axi::cfg::standard> dma;
+ *      AxiMasterGate<axi::cfg::standard> gate;
+ *      ...
+ *      dma.axis_in(stream_chan);       dma.descIn(desc);    dma.statusOut(status);
+ *      dma.wrRequestOut(gate_wr_req);  dma.wrRespIn(gate_wr_resp);
+ *      gate.wrRequestIn(gate_wr_req);  gate.wrRespOut(gate_wr_resp);
+ * \endcode
+ * \par
+ *
+ */
+template <typename StreamCfg, typename Cfg, int MaxBeats = 16, int DataDepth = 2 * MaxBeats,
+          int MaxInFlight = 4>
+class AxiStreamToMem : public sc_module {
+  typedef axi::axi4<Cfg> axi4_;
+  typedef axi::axi4_stream<StreamCfg> axis_;
+
+  static_assert(StreamCfg::dataWidth == Cfg::dataWidth,
+                "The stream and AXI data widths must match");
+  static_assert(Cfg::useBurst && Cfg::useWriteResponses,
+                "AxiStreamToMem requires an AXI config with bursts and write responses");
+  static_assert(MaxBeats >= 1 && MaxBeats <= Cfg::maxBurstSize,
+                "MaxBeats must be between 1 and maxBurstSize");
+  static_assert(DataDepth >= MaxBeats, "DataDepth must hold at least one burst");
+
+  static const int bytesPerBeat = Cfg::dataWidth >> 3;
+  static const int log_bytesPerBeat = nvhls::log2_ceil<bytesPerBeat>::val;
+
+  typedef typename axi4_::Addr Addr;
+  typedef NVUINTW(nvhls::nbits<MaxBeats>::val) Count;
+  typedef NVUINTW(nvhls::nbits<bytesPerBeat>::val) ByteCount;
+
+  // A finished descriptor: its status and the number of bursts minus one
+  struct Done : public nvhls_message {
+    AxiStreamDmaStatus<Cfg> status;
+    Addr bursts;
+
+    static const unsigned int width = AxiStreamDmaStatus<Cfg>::width + axi4_::ADDR_WIDTH;
+
+    template <unsigned int Size>
+    void Marshall(Marshaller<Size>& m) {
+      m& status;
+      m& bursts;
+    }
+  };
+
+ public:
+  sc_in<bool> reset_bar;
+  sc_in<bool> clk;
+
+  typename axis_::template slave<> axis_in;
+  Connections::In<AxiStreamDmaDesc<Cfg> > descIn;
+  Connections::Out<AxiStreamDmaStatus<Cfg> > statusOut;
+  Connections::Out<WrRequest<Cfg> > wrRequestOut;
+  Connections::In<WrResp<Cfg> > wrRespIn;
+
+  SC_HAS_PROCESS(AxiStreamToMem);
+
+  AxiStreamToMem(sc_module_name name)
+      : sc_module(name),
+        reset_bar("reset_bar"),
+        clk("clk"),
+        axis_in("axis_in"),
+        descIn("descIn"),
+        statusOut("statusOut"),
+        wrRequestOut("wrRequestOut"),
+        wrRespIn("wrRespIn"),
+        done("done") {
+    SC_THREAD(run_data);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(run_status);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+  }
+
+ protected:
+  Connections::Combinational<Done> done;
+
+  void run_data() {
+    axis_in.reset();
+    descIn.Reset();
+    wrRequestOut.Reset();
+    done.ResetWrite();
+
+    FIFO<typename axi4_::Data, DataDepth> dataQ;
+    FIFO<Addr, MaxInFlight> burstAddrQ;
+    FIFO<typename axi4_::BeatNum, MaxInFlight> burstLenQ;
+    dataQ.reset();
+    burstAddrQ.reset();
+    burstLenQ.reset();
+
+    // Descriptor being filled
+    bool desc_valid = false;
+    Addr addr = 0;           // address of the next stream beat
+    Addr left = 0;           // words left in the buffer
+    Addr burst_addr = 0;     // start of the burst being collected
+    Count burst_beats = 0;
+    Done fin;
+    bool fin_pending = false;  // fin is waiting to be handed to run_status
+
+    // Burst being sent
+    bool sending = false;
+    Addr send_addr = 0;
+    typename axi4_::BeatNum send_len = 0;
+    typename axi4_::BeatNum send_beat = 0;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while (1) {
+      wait();
+
+      bool data_full = dataQ.isFull();
+      bool burst_full = burstLenQ.isFull();
+
+      if (!sending && !burstLenQ.isEmpty()) {
+        send_addr = burstAddrQ.pop();
+        send_len = burstLenQ.pop();
+        send_beat = 0;
+        sending = true;
+      }
+      if (sending && !dataQ.isEmpty()) {
+        WrRequest<Cfg> req;
+        req.addr = send_addr;
+        req.len = send_len;
+        req.size = log_bytesPerBeat;
+        req.burst = axi4_::Enc::AXBURST::INCR;
+        req.cache = 0;
+        req.auser = 0;
+        req.data = dataQ.peek();
+        req.wuser = 0;
+        req.last = (send_beat == send_len);
+        if (wrRequestOut.PushNB(req)) {
+          dataQ.incrHead();
+          if (send_beat == send_len) {
+            sending = false;
+          } else {
+            ++send_beat;
+          }
+        }
+      }
+
+      if (!desc_valid) {
+        AxiStreamDmaDesc<Cfg> desc;
+        if (descIn.PopNB(desc)) {
+          NVHLS_ASSERT_MSG(desc.maxBeats != 0, "AxiStreamToMem descriptors must hold at least one word");
+          NVHLS_ASSERT_MSG(nvhls::get_slc<log_bytesPerBeat>(desc.addr, 0) == 0,
+                           "AxiStreamToMem buffers must be aligned to the data width");
+          desc_valid = true;
+          addr = desc.addr;
+          left = desc.maxBeats;
+          burst_addr = desc.addr;
+          burst_beats = 0;
+          fin.status.bytes = 0;
+          fin.status.resp = axi4_::Enc::XRESP::OKAY;
+          fin.bursts = 0;
+        }
+      } else if (!fin_pending && !data_full && !burst_full) {
+        typename axis_::Payload beat;
+        if (axis_in.nb_read(beat)) {
+          typename axis_::Bytes keep = axis_::KeepOf(beat);
+          ByteCount kept = 0;
+          #pragma hls_unroll yes
+          for (int i = 0; i < bytesPerBeat; i++) {
+            if (keep[i] == 1) {
+              ++kept;
+            }
+          }
+          dataQ.push(beat.data);
+          fin.status.bytes += kept;
+          ++burst_beats;
+          --left;
+          addr += bytesPerBeat;
+
+          bool eop = axis_::LastOf(beat);
+          bool buffer_end = eop || (left == 0);
+          bool page_end = (nvhls::get_slc<12>(addr, 0) == 0);
+          if (buffer_end || page_end || burst_beats == MaxBeats) {
+            burstAddrQ.push(burst_addr);
+            burstLenQ.push(burst_beats - 1);
+            burst_addr = addr;
+            burst_beats = 0;
+            if (buffer_end) {
+              fin.status.eop = eop;
+              fin_pending = true;
+            } else {
+              ++fin.bursts;
+            }
+          }
+        }
+      }
+
+      // Never block here: the bursts of earlier buffers must keep draining
+      // for run_status to make room
+      if (fin_pending && done.PushNB(fin)) {
+        fin_pending = false;
+        desc_valid = false;
+      }
+    }
+  }
+
+  void run_status() {
+    wrRespIn.Reset();
+    statusOut.Reset();
+    done.ResetRead();
+
+    FIFO<Done, MaxInFlight> doneQ;
+    doneQ.reset();
+    typename axi4_::Resp resp = axi4_::Enc::XRESP::OKAY;
+    Addr burst = 0;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while (1) {
+      wait();
+
+      if (!doneQ.isEmpty()) {
+        WrResp<Cfg> wr_resp;
+        if (wrRespIn.PopNB(wr_resp)) {
+          if (burst == 0 || wr_resp.resp > resp) {
+            resp = wr_resp.resp;
+          }
+          Done head = doneQ.peek();
+          if (burst == head.bursts) {
+            head.status.resp = resp;
+            statusOut.Push(head.status);
+            doneQ.incrHead();
+            burst = 0;
+          } else {
+            ++burst;
+          }
+        }
+      }
+
+      if (!doneQ.isFull()) {
+        Done fin;
+        if (done.PopNB(fin)) {
+          doneQ.push(fin);
+        }
+      }
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __AXIWRITECOMBINER_H__
+#define __AXIWRITECOMBINER_H__
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+#include <axi/axi4.h>
+#include <fifo.h>
+#include <nvhls_connections.h>
+#include <nvhls_assert.h>
+#include <axi/AxiMasterGate/AxiMasterGateIf.h>
+#ifndef __SYNTHESIS__
+#include <iostream>
+#endif
+
+/**
+ * \brief A write-combining buffer for the request/response interface of AxiMasterGate.
+ * \ingroup AXI
+ *
+ * \tparam Cfg             A valid AXI config.
+ * \tparam MaxBeats        The maximum length of a combined burst. (default: 16)
+ * \tparam TimeoutCycles   Idle cycles after which a partially filled buffer is flushed. (default: 8)
+ * \tparam MaxInFlight     The number of combined bursts awaiting a write response. (default: 4)
+ *
+ * \par Overview
+ * AxiWriteCombiner sits between a host and the wrRequestIn/wrRespOut ports of
+ * AxiMasterGate.  Write transactions (single beats or short bursts) whose
+ * addresses continue the buffered run are appended to it, and the run is sent
+ * downstream as one INCR burst of up to MaxBeats beats.  The run is flushed when
+ * a non-contiguous transaction arrives, when it is full, when the next beat
+ * would cross a 4KB boundary, or after TimeoutCycles idle cycles.  The single
+ * write response of a combined burst is replicated so the host still receives
+ * one WrResp per transaction it issued.
+ *
+ * Host transactions longer than MaxBeats are passed through unchanged.  Only
+ * full-width beats are combined; AxiMasterGate writes every beat with all
+ * strobes set, so combining does not change the written bytes.
+ *
+ * In C++ simulation the block counts host transactions and downstream bursts;
+ * PrintStats() reports the combine rate.
+ *
+ * \code
+ *      AxiWriteCombiner<axi::cfg::standard> wc;
+ *      ...
+ *      wc.wrRequestIn(host_wr_req);    wc.wrRespOut(host_wr_resp);
+ *      wc.wrRequestOut(gate_wr_req);   wc.wrRespIn(gate_wr_resp);
+ *      gate.wrRequestIn(gate_wr_req);  gate.wrRespOut(gate_wr_resp);
+ * \endcode
+ * \par
+ *
+ */
+template <typename Cfg, int MaxBeats = 16, int TimeoutCycles = 8, int MaxInFlight = 4>
+class AxiWriteCombiner : public sc_module {
+  typedef axi::axi4<Cfg> axi4_;
+
+  static_assert(Cfg::useBurst, "AxiWriteCombiner requires an AXI config with bursts");
+  static_assert(MaxBeats >= 2 && MaxBeats <= Cfg::maxBurstSize,
+                "MaxBeats must be between 2 and maxBurstSize");
+  static_assert(TimeoutCycles >= 1, "TimeoutCycles must be at least 1");
+
+  static const int bytesPerBeat = Cfg::dataWidth >> 3;
+  static const int log_bytesPerBeat = nvhls::log2_ceil<bytesPerBeat>::val;
+  static const int pageBytes = 4096;
+
+  typedef typename axi4_::Data Data;
+  typedef NVUINTW(nvhls::nbits<MaxBeats>::val) Count;
+  typedef NVUINTW(nvhls::nbits<TimeoutCycles>::val) Timer;
+
+ public:
+  sc_in<bool> reset_bar;
+  sc_in<bool> clk;
+
+  Connections::In<WrRequest<Cfg> > wrRequestIn;
+  Connections::Out<WrResp<Cfg> > wrRespOut;
+  Connections::Out<WrRequest<Cfg> > wrRequestOut;
+  Connections::In<WrResp<Cfg> > wrRespIn;
+
+  SC_HAS_PROCESS(AxiWriteCombiner);
+
+  AxiWriteCombiner(sc_module_name name)
+      : sc_module(name),
+        reset_bar("reset_bar"),
+        clk("clk"),
+        wrRequestIn("wrRequestIn"),
+        wrRespOut("wrRespOut"),
+        wrRequestOut("wrRequestOut"),
+        wrRespIn("wrRespIn"),
+        resp_count("resp_count") {
+    SC_THREAD(run_req);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(run_resp);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+#ifndef __SYNTHESIS__
+    host_transactions_ = 0;
+    host_beats_ = 0;
+    axi_bursts_ = 0;
+#endif
+  }
+
+#ifndef __SYNTHESIS__
+  // Reports host transactions, downstream bursts and the combine rate
+  void PrintStats(std::ostream& os = std::cout) const {
+    os << name() << ": " << host_transactions_ << " host writes ("
+       << host_beats_ << " beats) sent as " << axi_bursts_ << " AXI bursts";
+    if (axi_bursts_ != 0) {
+      os << ", combine rate " << static_cast<double>(host_transactions_) / axi_bursts_
+         << " writes/burst, " << static_cast<double>(host_beats_) / axi_bursts_
+         << " beats/burst";
+    }
+    os << std::endl;
+  }
+
+  unsigned long host_transactions() const { return host_transactions_; }
+  unsigned long axi_bursts() const { return axi_bursts_; }
+#endif
+
+ protected:
+  // Number of host transactions covered by each downstream burst
+  Connections::Combinational<Count> resp_count;
+
+#ifndef __SYNTHESIS__
+  unsigned long host_transactions_;
+  unsigned long host_beats_;
+  unsigned long axi_bursts_;
+#endif
+
+  void run_req() {
+    wrRequestIn.Reset();
+    wrRequestOut.Reset();
+    resp_count.ResetWrite();
+
+    Data buf[MaxBeats];
+    WrRequest<Cfg> run_first;          // first beat of the buffered run
+    Count run_beats = 0;               // beats in the buffer
+    Count run_trans = 0;               // host transactions in the buffer
+    Timer idle = 0;
+    bool flushing = false;
+    Count flush_idx = 0;
+
+    WrRequest<Cfg> in;
+    bool in_valid = false;
+    bool in_burst = false;             // a host burst is being appended
+    bool pass_burst = false;           // a host burst is being passed through
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while (1) {
+      wait();
+
+      if (!in_valid) {
+        in_valid = wrRequestIn.PopNB(in);
+      }
+
+      if (flushing) {
+        // Send the buffered run as one burst
+        WrRequest<Cfg> out = run_first;
+        out.len = run_beats - 1;
+        out.data = buf[flush_idx];
+        out.last = (flush_idx == run_beats - 1);
+        if (wrRequestOut.PushNB(out)) {
+          if (flush_idx == run_beats - 1) {
+            resp_count.Push(run_trans);
+            flushing = false;
+            run_beats = 0;
+            run_trans = 0;
+#ifndef __SYNTHESIS__
+            ++axi_bursts_;
+#endif
+          } else {
+            ++flush_idx;
+          }
+        }
+      } else if (!in_valid) {
+        if (run_beats != 0 && !in_burst && ++idle == TimeoutCycles) {
+          flushing = true;
+          flush_idx = 0;
+        }
+      } else if (pass_burst) {
+        // Remaining beats of a passed-through host burst
+        if (wrRequestOut.PushNB(in)) {
+          in_valid = false;
+          pass_burst = (in.last != 1);
+#ifndef __SYNTHESIS__
+          ++host_beats_;
+#endif
+        }
+      } else if (in_burst) {
+        // Remaining beats of a host burst that is being combined
+        buf[run_beats] = in.data;
+        ++run_beats;
+        in_valid = false;
+        in_burst = (in.last != 1);
+#ifndef __SYNTHESIS__
+        ++host_beats_;
+#endif
+      } else {
+        // First beat of a host transaction
+        NVUINTW(axi4_::ALEN_WIDTH + 1) beats = in.len.to_uint64() + 1;
+        typename axi4_::Addr run_end =
+            run_first.addr + (static_cast<typename axi4_::Addr>(run_beats) << log_bytesPerBeat);
+        bool full_width = !Cfg::useVariableBeatSize || (in.size.to_uint64() == log_bytesPerBeat);
+        NVUINTW(13) page_offset = nvhls::get_slc<12>(run_first.addr, 0);
+        bool fits = (run_beats + beats <= MaxBeats) &&
+                    (page_offset + ((run_beats + beats) << log_bytesPerBeat) <= pageBytes);
+
+        if (run_beats != 0 && !(in.addr == run_end && full_width && fits)) {
+          // Not contiguous: flush first and keep the request
+          flushing = true;
+          flush_idx = 0;
+        } else if (beats > MaxBeats || !full_width) {
+          if (wrRequestOut.PushNB(in)) {
+            resp_count.Push(1);
+            in_valid = false;
+            pass_burst = (in.last != 1);
+#ifndef __SYNTHESIS__
+            ++host_transactions_;
+            ++host_beats_;
+            ++axi_bursts_;
+#endif
+          }
+        } else {
+          if (run_beats == 0) {
+            run_first = in;
+          }
+          buf[run_beats] = in.data;
+          ++run_beats;
+          ++run_trans;
+          in_valid = false;
+          in_burst = (in.last != 1);
+#ifndef __SYNTHESIS__
+          ++host_transactions_;
+          ++host_beats_;
+#endif
+        }
+      }
+
+      if (in_valid || flushing) {
+        idle = 0;
+      }
+      if (!flushing && !in_burst && run_beats == MaxBeats) {
+        flushing = true;
+        flush_idx = 0;
+      }
+    }
+  }
+
+  void run_resp() {
+    wrRespIn.Reset();
+    wrRespOut.Reset();
+    resp_count.ResetRead();
+
+    FIFO<Count, MaxInFlight> countQ;
+    countQ.reset();
+    WrResp<Cfg> resp;
+    Count remaining = 0;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while (1) {
+      wait();
+
+      if (remaining != 0) {
+        if (wrRespOut.PushNB(resp)) {
+          --remaining;
+        }
+      } else if (!countQ.isEmpty()) {
+        if (wrRespIn.PopNB(resp)) {
+          remaining = countQ.pop();
+        }
+      }
+
+      if (!countQ.isFull()) {
+        Count count;
+        if (resp_count.PopNB(count)) {
+          countQ.push(count);
+        }
+      }
+    }
+  }
+};
+
+#endif
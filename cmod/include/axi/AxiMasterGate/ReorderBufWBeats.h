@@ -50,4 +50,60 @@ class ReorderBufWBeats : public ReorderBuf<Data, Depth, InFlight> {
   }
 };
 
+/**
+ * \brief An extension of ReorderBufStreams that allows one entry to contain multiple beats of data.
+ * \ingroup ReorderBuffer
+ *
+ * \tparam Data             DataType
+ * \tparam Depth            Number of entries, shared by all streams
+ * \tparam InFlight         Number of inflight entries
+ * \tparam Streams          Number of streams
+ *
+ * \par Overview
+ * addBeat() appends a ready entry to the stream of the last request, so the
+ * beats of a burst follow its first beat.
+ */
+template <typename Data, unsigned int Depth, unsigned int InFlight, unsigned int Streams>
+class ReorderBufStreamsWBeats : public ReorderBufStreams<Data, Depth, InFlight, Streams> {
+  typedef ReorderBufStreams<Data, Depth, InFlight, Streams> Base;
+
+ public:
+  ReorderBufStreamsWBeats() : Base(), last_stream(0) {}
+
+  typename Base::Id addRequest(const typename Base::Stream& stream)
+  {
+    last_stream = stream;
+    return Base::addRequest(stream);
+  }
+
+  bool canReceiveBeats()
+  {
+    // Beats take a free entry of the shared storage
+    return (!Base::entries.isFull());
+  }
+
+  void addBeat(const Data& data) {
+    typename Base::EntryNum entryNum = Base::entries.alloc();
+    Base::storage.write(entryNum, 0, data);
+    // so that response can be read out later
+    Base::vbits[entryNum] = 1;
+    if (Base::active[last_stream] == 1) {
+      Base::next.write(Base::tail[last_stream], 0, entryNum);
+    } else {
+      Base::head[last_stream] = entryNum;
+      Base::active[last_stream] = 1;
+    }
+    Base::tail[last_stream] = entryNum;
+  }
+
+  void reset()
+  {
+    Base::reset();
+    last_stream = 0;
+  }
+
+ protected:
+  typename Base::Stream last_stream;
+};
+
 #endif
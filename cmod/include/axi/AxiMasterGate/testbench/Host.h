@@ -22,22 +22,25 @@
 
 #include <axi/axi4.h>
 #include <nvhls_connections.h>
+#include <testbench/nvhls_rand.h>
 
 #include <queue>
 #include <deque>
+#include <vector>
 
 /**
  * \brief A testbench component to verify AxiMasterGate.
  * \ingroup AXI
  *
- * \tparam Cfg     A valid AXI config.
+ * \tparam Cfg          A valid AXI config.
+ * \tparam outOfOrder   If true, tag each request and match responses to requests by their id.  (Default: false)
  *
  * \par Overview
  *
  * This component connects to the request-response (non-AXI) interface of AXIMasterGate.
  * It launches read and write requests and checks for appropriate responses.
  */
-template <typename Cfg>
+template <typename Cfg, bool outOfOrder = false>
 SC_MODULE(Host) {
  public:
   sc_in<bool> reset_bar;
@@ -55,11 +58,17 @@ SC_MODULE(Host) {
 
   static const int write_count = 400;
   static const int read_count = 50;
+  static const int numTags = 1 << axi::axi4<Cfg>::ID_WIDTH;
 
   std::deque<unsigned int> read_ref;
   std::queue<typename axi::axi4<Cfg>::Data> dataQ;
+  // Out-of-order mode: expected read data and writes in flight per tag
+  std::vector<std::deque<typename axi::axi4<Cfg>::Data> > rd_expected;
+  std::vector<int> wr_pending;
+  nvhls::RandStream rng;
 
-  SC_CTOR(Host) : reset_bar("reset_bar"), clk("clk") {
+  SC_CTOR(Host)
+      : reset_bar("reset_bar"), clk("clk"), rng(name()), rd_expected(numTags), wr_pending(numTags, 0) {
     SC_THREAD(run_wr_source);
     sensitive << clk.pos();
     async_reset_signal_is(reset_bar, false);
@@ -102,17 +111,19 @@ SC_MODULE(Host) {
         WrRequest<Cfg> wrRequest;
         wrRequest.addr = addr;
 
-        int len = rand() % 6;
+        int len = rng.uniform(6);
 
         wrRequest.len = len;
         wrRequest.last = 0;
+        wrRequest.id = ctr % numTags;
 
         for (int i = 0; i <= len; ++i) {
           if (i == len) {
             wrRequest.last = 1;
+            wr_pending[ctr % numTags]++;
             ctr++;
           }
-          wrRequest.data = nvhls::gen_random_payload<Data>().d;
+          wrRequest.data = rng.gen_random_payload<Data>().d;
           std::cout << "@" << sc_time_stamp()
                     << " write source initiated a request:"
                     << "\t addr = " << hex << wrRequest.addr
@@ -138,7 +149,12 @@ SC_MODULE(Host) {
 
       std::cout << "@" << sc_time_stamp() << " write sink received response:"
                 << "\t resp = " << dec << wrResp.resp
+                << "\t id = " << dec << wrResp.id
                 << std::endl;
+      if (outOfOrder) {
+        NVHLS_ASSERT_MSG(wr_pending[wrResp.id.to_uint64()] > 0, "Write response with the tag of no write in flight");
+        wr_pending[wrResp.id.to_uint64()]--;
+      }
       if (++ctr == write_count) done_write = 1;
     }
   }
@@ -154,12 +170,20 @@ SC_MODULE(Host) {
       wait();
 
       if (ctr < read_count) {
-        if (rand() % 5 == 0) { // Really need to pace ourselves here
+        if (rng.uniform(5) == 0) { // Really need to pace ourselves here
           RdRequest<Cfg> rdRequest;
           rdRequest.addr = addr;
-          int len = rand() % 3;
+          int len = rng.uniform(3);
 
           rdRequest.len = len;
+          rdRequest.id = ctr % numTags;
+          if (outOfOrder) {
+            for (int i = 0; i <= len; ++i) {
+              NVHLS_ASSERT_MSG(!dataQ.empty(), "Read request of data that has not been written");
+              rd_expected[ctr % numTags].push_back(dataQ.front());
+              dataQ.pop();
+            }
+          }
 
           std::cout << "@" << sc_time_stamp() << " read source initiated a request:"
                     << "\t addr = " << hex << rdRequest.addr
@@ -181,10 +205,18 @@ SC_MODULE(Host) {
     while (1) {
       wait();
       RdResp<Cfg> rdResp = rdRespIn.Pop();
-      typename axi::axi4<Cfg>::Data rd_data_expected = dataQ.front(); dataQ.pop();
+      typename axi::axi4<Cfg>::Data rd_data_expected;
+      if (outOfOrder) {
+        std::deque<typename axi::axi4<Cfg>::Data>& expected = rd_expected[rdResp.id.to_uint64()];
+        NVHLS_ASSERT_MSG(!expected.empty(), "Read response with the tag of no read in flight");
+        rd_data_expected = expected.front(); expected.pop_front();
+      } else {
+        rd_data_expected = dataQ.front(); dataQ.pop();
+      }
 
       std::cout << "@" << sc_time_stamp() << " read sink received response:"
                 << "\t last = " << rdResp.last
+                << "\t id = " << dec << rdResp.id
                 << "\t data = " << hex << rdResp.data
                 << "\t expected = " << hex << rd_data_expected
                 << std::endl;
@@ -0,0 +1,530 @@
+/*
+ * Copyright (c) 2017-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __AXI_PERF_MONITOR_H__
+#define __AXI_PERF_MONITOR_H__
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_int.h>
+#include <nvhls_array.h>
+#include <nvhls_assert.h>
+#include <hls_globals.h>
+#include <axi/axi4.h>
+#include <mem_array.h>
+#include <fifo.h>
+
+/**
+ * \brief The default config of AxiPerfMonitor.
+ *
+ * \par The following constants must be defined:
+ *
+ * - numClasses: The number of ID classes, a power of two.  The class of a transaction is given by the upper log2(numClasses) bits of its ID.
+ * - counterWidth: The width of the byte, transaction, latency-sum and histogram counters.
+ * - latencyWidth: The width of timestamps, and so of the longest latency that is measured correctly.
+ * - histBins: The number of latency histogram bins per class and direction, a power of two.
+ * - histShift: Bin b counts the latencies from b << histShift to ((b + 1) << histShift) - 1; the last bin also counts all longer ones.
+ * - timedPerId: The number of transactions per ID whose latency can be measured at the same time.  Later transactions of an ID with this many in flight are counted, but not timed.
+ */
+struct perfMonitorDefault {
+  enum {
+    numClasses = 1,
+    counterWidth = 32,
+    latencyWidth = 16,
+    histBins = 16,
+    histShift = 2,
+    timedPerId = 4,
+  };
+};
+
+/**
+ * \brief A synthesizable AXI performance monitor with a register window.
+ * \ingroup AXI
+ *
+ * \tparam axiCfg                   The AXI config of the monitored link.
+ * \tparam monCfg                   A config for the monitor (such as perfMonitorDefault).  (Default: perfMonitorDefault)
+ * \tparam regCfg                   The AXI config of the register window.  (Default: axiCfg)
+ * \tparam numAddrBitsToInspect     The number of register address bits to inspect, as in AxiSlaveToReg.  (Default: regCfg::addrWidth)
+ *
+ * \par Overview
+ * AxiPerfMonitor is placed between an AXI master and an AXI slave.  It forwards every AR, AW, W, R and B beat
+ * unchanged and in order through a one-entry register per channel, which adds one cycle of latency and does not
+ * reduce throughput, and never holds back a beat to count it.  For reads and for writes of each ID class it counts:
+ * - the bytes requested and the transactions issued, when the AR or AW is passed on;
+ * - the sum, minimum and maximum latency, from passing on the AR (AW) to passing on the last R beat (the B response);
+ * - a latency histogram of histBins bins, kept in one mem_array_sep bank for reads and one for writes.
+ *
+ * Up to timedPerId transactions per ID are timed at once; transactions issued while an ID has that many in flight,
+ * and timed transactions that complete while the histograms are cleared, are counted in the untimed register
+ * instead of the latency statistics, so the histogram bins and the untimed count add up to the transactions.
+ * Writes are not timed without write responses.
+ *
+ * The counters are read through an AXI slave port laid out like AxiSlaveToReg: register i is the AXI data word at
+ * baseAddr + i * (regCfg::dataWidth / 8).  Accesses outside the window return SLVERR.
+ * - 0: Control.  Bit 0 enables counting (set at reset).  Writing 1 to bit 1 clears all counters; it reads as 1 until
+ *   the histograms are cleared, which takes numClasses * histBins cycles.  Other registers are read-only.
+ * - 1: Cycles counted while enabled.  2: Untimed transactions.  3-7: Reserved, read as 0.
+ * - 8 + 8 * (direction * numClasses + class) + {0 bytes, 1 transactions, 2 latency sum, 3 latency min, 4 latency
+ *   max}, where direction is 0 for reads and 1 for writes.  The minimum reads as all ones before the first sample.
+ * - histBase + direction * numClasses * histBins + class * histBins + bin, with histBase = 8 + 16 * numClasses.
+ *
+ * A histogram read waits for a cycle in which that bank is not updated; clear the enable bit first to read a
+ * consistent snapshot under heavy traffic.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <axi/AxiPerfMonitor.h>
+ *
+ *      ...
+ *      AxiPerfMonitor<axi::cfg::standard, perfMonitorDefault, axi::cfg::lite> monitor;
+ *      ...
+ *          monitor.axi_rd_m(master_rd);
+ *          monitor.axi_wr_m(master_wr);
+ *          monitor.axi_rd_s(slave_rd);
+ *          monitor.axi_wr_s(slave_wr);
+ *          monitor.if_reg_rd(csr_rd);
+ *          monitor.if_reg_wr(csr_wr);
+ *          monitor.baseAddr(perf_base);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename axiCfg, typename monCfg = perfMonitorDefault, typename regCfg = axiCfg,
+          int numAddrBitsToInspect = regCfg::addrWidth>
+class AxiPerfMonitor : public sc_module {
+ public:
+  static const int kDebugLevel = 5;
+  typedef typename axi::axi4<axiCfg> axi_;
+  typedef typename axi::axi4<regCfg> reg_;
+
+  enum {
+    numClasses = monCfg::numClasses,
+    histBins = monCfg::histBins,
+    classWidth = nvhls::log2_ceil<numClasses>::val,
+    numIds = 1 << axi_::ID_WIDTH,
+    histEntries = numClasses * histBins,
+    log_histEntries = nvhls::log2_ceil<histEntries>::val,
+    statSlots = 8,
+    statsBase = 8,
+    histBase = statsBase + 2 * numClasses * statSlots,
+    numReg = histBase + 2 * histEntries,
+    bytesPerBeat = axi_::DATA_WIDTH >> 3,
+    log_bytesPerBeat = nvhls::log2_ceil<bytesPerBeat>::val,
+    bytesPerReg = reg_::DATA_WIDTH >> 3,
+    axiAddrBitsPerReg = nvhls::log2_ceil<bytesPerReg>::val,
+    untimedWidth = 8,
+  };
+
+  // Registers
+  enum { CTRL = 0, CYCLES = 1, UNTIMED = 2 };
+  enum { BYTES = 0, TRANSACTIONS = 1, LATENCY_SUM = 2, LATENCY_MIN = 3, LATENCY_MAX = 4 };
+  enum { CTRL_ENABLE = 1, CTRL_CLEAR = 2 };
+
+  static_assert(numClasses == (1 << classWidth), "numClasses must be a power of two");
+  static_assert(classWidth <= axi_::ID_WIDTH, "numClasses cannot exceed the number of IDs");
+  static_assert(histBins == (1 << nvhls::log2_ceil<histBins>::val), "histBins must be a power of two");
+  static_assert(monCfg::counterWidth <= reg_::DATA_WIDTH, "Counters must fit in a register");
+  static_assert(monCfg::latencyWidth <= monCfg::counterWidth, "Latencies must fit in a counter");
+
+  typedef NVUINTW(monCfg::counterWidth) Counter;
+  typedef NVUINTW(monCfg::latencyWidth) Latency;
+  typedef NVUINTW(untimedWidth) Untimed;
+  typedef NVUINTW(nvhls::index_width<numIds>::val) IdIdx;
+  typedef NVUINTW(nvhls::index_width<2 * numClasses>::val) StatIdx;
+  typedef NVUINTW(nvhls::index_width<histEntries>::val) HistIdx;
+  typedef NVUINTW(nvhls::index_width<numReg>::val) RegIdx;
+  typedef NVUINTW(reg_::DATA_WIDTH) RegData;
+
+  sc_in<bool> clk;
+  sc_in<bool> reset_bar;
+
+  // Monitored link: from the master and to the slave
+  typename axi_::read::template slave<> axi_rd_m;
+  typename axi_::write::template slave<> axi_wr_m;
+  typename axi_::read::template master<> axi_rd_s;
+  typename axi_::write::template master<> axi_wr_s;
+
+  // Register window
+  typename reg_::read::template slave<> if_reg_rd;
+  typename reg_::write::template slave<> if_reg_wr;
+  sc_in<NVUINTW(numAddrBitsToInspect)> baseAddr;
+
+  SC_HAS_PROCESS(AxiPerfMonitor);
+
+  AxiPerfMonitor(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        reset_bar("reset_bar"),
+        axi_rd_m("axi_rd_m"),
+        axi_wr_m("axi_wr_m"),
+        axi_rd_s("axi_rd_s"),
+        axi_wr_s("axi_wr_s"),
+        if_reg_rd("if_reg_rd"),
+        if_reg_wr("if_reg_wr"),
+        baseAddr("baseAddr") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+  }
+
+ protected:
+  // Latency histograms: bank 0 for reads, bank 1 for writes
+  mem_array_sep<Counter, 2 * histEntries, 2> hist;
+  // Start times of the timed transactions in flight, per ID
+  FIFO<Latency, monCfg::timedPerId, numIds> rd_start;
+  FIFO<Latency, monCfg::timedPerId, numIds> wr_start;
+
+  // Statistics, indexed by direction * numClasses + class
+  nvhls::nv_array<Counter, 2 * numClasses> bytes;
+  nvhls::nv_array<Counter, 2 * numClasses> transactions;
+  nvhls::nv_array<Counter, 2 * numClasses> latency_sum;
+  nvhls::nv_array<Latency, 2 * numClasses> latency_min;
+  nvhls::nv_array<Latency, 2 * numClasses> latency_max;
+  Counter cycles;
+  Counter untimed;
+
+  template <typename Id>
+  static IdIdx IdOf(Id id) {
+    return static_cast<IdIdx>(id.to_uint64());
+  }
+
+  static StatIdx StatOf(bool write, IdIdx id) {
+    StatIdx cls = 0;
+    if (classWidth > 0)
+      cls = static_cast<StatIdx>(id >> (axi_::ID_WIDTH - classWidth));
+    return write ? static_cast<StatIdx>(cls + numClasses) : cls;
+  }
+
+  static Counter RequestBytes(typename axi_::AddrPayload& req) {
+    Counter beats = static_cast<Counter>(req.len.to_uint64()) + 1;
+    if (axi_::ASIZE_WIDTH > 0)
+      return beats << req.size.to_uint64();
+    return beats << log_bytesPerBeat;
+  }
+
+  void ClearStats() {
+    #pragma hls_unroll yes
+    for (int i = 0; i < 2 * numClasses; i++) {
+      bytes[i] = 0;
+      transactions[i] = 0;
+      latency_sum[i] = 0;
+      latency_min[i] = ~Latency(0);
+      latency_max[i] = 0;
+    }
+    cycles = 0;
+    untimed = 0;
+  }
+
+  // Counts a request passed on to the slave, and records its start time
+  void Issue(bool write, IdIdx id, typename axi_::AddrPayload& req, Latency now,
+             nvhls::nv_array<Untimed, numIds>& untimed_pending, bool enable) {
+    FIFO<Latency, monCfg::timedPerId, numIds>& start = write ? wr_start : rd_start;
+    bool timed = (untimed_pending[id] == 0 && !start.isFull(id));
+    if (write && !axiCfg::useWriteResponses)
+      timed = false;
+    if (timed) {
+      start.push(now, id);
+    } else if (!write || axiCfg::useWriteResponses) {
+      NVHLS_ASSERT_MSG(untimed_pending[id] != static_cast<Untimed>(~Untimed(0)),
+                       "Too many untimed transactions in flight");
+      untimed_pending[id]++;
+    }
+    if (enable) {
+      StatIdx s = StatOf(write, id);
+      bytes[s] += RequestBytes(req);
+      transactions[s]++;
+      if (!timed)
+        untimed++;
+    }
+  }
+
+  // Completes the oldest transaction of an ID; returns true and its latency if
+  // it was timed
+  bool Complete(bool write, IdIdx id, Latency now,
+                nvhls::nv_array<Untimed, numIds>& untimed_pending, Latency& latency) {
+    FIFO<Latency, monCfg::timedPerId, numIds>& start = write ? wr_start : rd_start;
+    // Timed transactions of an ID are always older than its untimed ones
+    if (!start.isEmpty(id)) {
+      latency = now - start.pop(id);
+      return true;
+    }
+    NVHLS_ASSERT_MSG(untimed_pending[id] != 0, "Response without a transaction in flight");
+    untimed_pending[id]--;
+    return false;
+  }
+
+  void Sample(bool write, IdIdx id, Latency latency) {
+    StatIdx s = StatOf(write, id);
+    latency_sum[s] += latency;
+    if (latency < latency_min[s])
+      latency_min[s] = latency;
+    if (latency > latency_max[s])
+      latency_max[s] = latency;
+    Latency bin = latency >> monCfg::histShift;
+    if (bin > histBins - 1)
+      bin = histBins - 1;
+    HistIdx idx = static_cast<HistIdx>((s - (write ? numClasses : 0)) * histBins + bin);
+    hist.write(idx, write, hist.read(idx, write) + 1);
+  }
+
+  // Value of a register; false if it is a histogram bin that cannot be read
+  // in this cycle
+  bool ReadReg(RegIdx idx, bool ctrl_enable, bool clearing, bool rd_hist_busy,
+               bool wr_hist_busy, RegData& data) {
+    data = 0;
+    if (idx == CTRL) {
+      data = (ctrl_enable ? CTRL_ENABLE : 0) | (clearing ? CTRL_CLEAR : 0);
+    } else if (idx == CYCLES) {
+      data = cycles;
+    } else if (idx == UNTIMED) {
+      data = untimed;
+    } else if (idx >= statsBase && idx < histBase) {
+      StatIdx s = static_cast<StatIdx>((idx - statsBase) >> nvhls::log2_ceil<statSlots>::val);
+      NVUINTW(3) stat = static_cast<NVUINTW(3)>(idx - statsBase);
+      if (stat == BYTES)
+        data = bytes[s];
+      else if (stat == TRANSACTIONS)
+        data = transactions[s];
+      else if (stat == LATENCY_SUM)
+        data = latency_sum[s];
+      else if (stat == LATENCY_MIN)
+        data = latency_min[s];
+      else if (stat == LATENCY_MAX)
+        data = latency_max[s];
+    } else if (idx >= histBase) {
+      bool write = ((idx - histBase) >> log_histEntries) != 0;
+      HistIdx local = static_cast<HistIdx>((idx - histBase) & (histEntries - 1));
+      if (write ? wr_hist_busy : rd_hist_busy)
+        return false;
+      data = hist.read(local, write);
+    }
+    return true;
+  }
+
+  void run() {
+    axi_rd_m.reset();
+    axi_wr_m.reset();
+    axi_rd_s.reset();
+    axi_wr_s.reset();
+    if_reg_rd.reset();
+    if_reg_wr.reset();
+    rd_start.reset();
+    wr_start.reset();
+    ClearStats();
+
+    nvhls::nv_array<Untimed, numIds> rd_untimed_pending;
+    nvhls::nv_array<Untimed, numIds> wr_untimed_pending;
+    #pragma hls_unroll yes
+    for (int i = 0; i < numIds; i++) {
+      rd_untimed_pending[i] = 0;
+      wr_untimed_pending[i] = 0;
+    }
+
+    typename axi_::AddrPayload AR_reg, AW_reg;
+    typename axi_::ReadPayload R_reg;
+    typename axi_::WritePayload W_reg;
+    typename axi_::WRespPayload B_reg;
+    bool ar_valid = 0, aw_valid = 0, r_valid = 0, w_valid = 0, b_valid = 0;
+
+    typename reg_::AddrPayload reg_ar, reg_aw;
+    typename reg_::ReadPayload reg_r;
+    typename reg_::WritePayload reg_w;
+    typename reg_::WRespPayload reg_b;
+    bool reg_ar_valid = 0, reg_aw_valid = 0, reg_r_valid = 0, reg_b_valid = 0;
+    bool reg_wr_err = 0;
+    NVUINTW(numAddrBitsToInspect) regRdAddr = 0, regWrAddr = 0;
+    NVUINTW(reg_::ALEN_WIDTH + 1) regRdLen = 0;
+
+    Latency now = 0;
+    bool ctrl_enable = 1;
+    // The histograms are cleared one entry per cycle, starting at reset
+    bool clearing = 1;
+    HistIdx clear_idx = 0;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while (1) {
+      wait();
+
+      now++;
+      bool enable = ctrl_enable;
+      bool rd_hist_busy = clearing, wr_hist_busy = clearing;
+      if (enable)
+        cycles++;
+
+      if (clearing) {
+        hist.write(clear_idx, 0, 0);
+        hist.write(clear_idx, 1, 0);
+        if (clear_idx == histEntries - 1) {
+          clearing = 0;
+          clear_idx = 0;
+        } else {
+          clear_idx++;
+        }
+      }
+
+      // R: slave to master; the last beat completes a read
+      if (r_valid) {
+        if (axi_rd_m.r.PushNB(R_reg)) {
+          r_valid = 0;
+          if (axi_::LAST_WIDTH == 0 || R_reg.last.to_uint64() == 1) {
+            IdIdx id = IdOf(R_reg.id);
+            Latency latency;
+            if (Complete(false, id, now, rd_untimed_pending, latency) && enable) {
+              if (clearing) {
+                untimed++;
+              } else {
+                Sample(false, id, latency);
+                rd_hist_busy = 1;
+              }
+            }
+          }
+        }
+      }
+      if (!r_valid) {
+        r_valid = axi_rd_s.r.PopNB(R_reg);
+      }
+
+      // B: slave to master
+      if (axiCfg::useWriteResponses) {
+        if (b_valid) {
+          if (axi_wr_m.b.PushNB(B_reg)) {
+            b_valid = 0;
+            IdIdx id = IdOf(B_reg.id);
+            Latency latency;
+            if (Complete(true, id, now, wr_untimed_pending, latency) && enable) {
+              if (clearing) {
+                untimed++;
+              } else {
+                Sample(true, id, latency);
+                wr_hist_busy = 1;
+              }
+            }
+          }
+        }
+        if (!b_valid) {
+          b_valid = axi_wr_s.b.PopNB(B_reg);
+        }
+      }
+
+      // AR, AW and W: master to slave
+      if (ar_valid) {
+        if (axi_rd_s.ar.PushNB(AR_reg)) {
+          ar_valid = 0;
+          Issue(false, IdOf(AR_reg.id), AR_reg, now, rd_untimed_pending, enable);
+        }
+      }
+      if (!ar_valid) {
+        ar_valid = axi_rd_m.ar.PopNB(AR_reg);
+      }
+      if (aw_valid) {
+        if (axi_wr_s.aw.PushNB(AW_reg)) {
+          aw_valid = 0;
+          Issue(true, IdOf(AW_reg.id), AW_reg, now, wr_untimed_pending, enable);
+        }
+      }
+      if (!aw_valid) {
+        aw_valid = axi_wr_m.aw.PopNB(AW_reg);
+      }
+      if (w_valid) {
+        if (axi_wr_s.w.PushNB(W_reg))
+          w_valid = 0;
+      }
+      if (!w_valid) {
+        w_valid = axi_wr_m.w.PopNB(W_reg);
+      }
+
+      // Register window reads, one beat per cycle
+      if (reg_r_valid) {
+        if (if_reg_rd.nb_rwrite(reg_r))
+          reg_r_valid = 0;
+      }
+      if (!reg_ar_valid) {
+        if (if_reg_rd.nb_aread(reg_ar)) {
+          reg_ar_valid = 1;
+          regRdAddr = static_cast<sc_uint<numAddrBitsToInspect> >(reg_ar.addr);
+          regRdLen = reg_ar.len.to_uint64();
+        }
+      }
+      if (reg_ar_valid && !reg_r_valid) {
+        bool valid_addr = (regRdAddr >= baseAddr.read() &&
+                           regRdAddr - baseAddr.read() < static_cast<NVUINTW(numAddrBitsToInspect + 1)>(numReg) * bytesPerReg);
+        RegIdx idx = static_cast<RegIdx>((regRdAddr - baseAddr.read()) >> axiAddrBitsPerReg);
+        RegData data = 0;
+        if (!valid_addr || ReadReg(idx, ctrl_enable, clearing, rd_hist_busy, wr_hist_busy, data)) {
+          reg_r.id = reg_ar.id;
+          reg_r.data = data;
+          reg_r.resp = valid_addr ? reg_::Enc::XRESP::OKAY : reg_::Enc::XRESP::SLVERR;
+          reg_r.last = (regRdLen == 0);
+          reg_r_valid = 1;
+          CDCOUT(sc_time_stamp() << " " << name() << " Read register:"
+                                 << " reg=" << idx << " data=" << hex << data << dec
+                                 << endl, kDebugLevel);
+          if (regRdLen == 0) {
+            reg_ar_valid = 0;
+          } else {
+            regRdLen--;
+            regRdAddr = static_cast<sc_uint<numAddrBitsToInspect> >(reg_::NextBeatAddr(reg_ar, regRdAddr));
+          }
+        }
+      }
+
+      // Register window writes; only the control register is writable
+      if (regCfg::useWriteResponses && reg_b_valid) {
+        if (if_reg_wr.nb_bwrite(reg_b))
+          reg_b_valid = 0;
+      }
+      if (!reg_aw_valid) {
+        if (if_reg_wr.aw.PopNB(reg_aw)) {
+          reg_aw_valid = 1;
+          reg_wr_err = 0;
+          regWrAddr = static_cast<sc_uint<numAddrBitsToInspect> >(reg_aw.addr);
+        }
+      }
+      if (reg_aw_valid && !reg_b_valid) {
+        if (if_reg_wr.w.PopNB(reg_w)) {
+          if (regWrAddr == baseAddr.read()) {
+            RegData data = reg_w.data;
+            ctrl_enable = (data & CTRL_ENABLE) != 0;
+            if ((data & CTRL_CLEAR) != 0) {
+              ClearStats();
+              clearing = 1;
+              clear_idx = 0;
+            }
+            CDCOUT(sc_time_stamp() << " " << name() << " Wrote control: " << hex << data << dec
+                                   << endl, kDebugLevel);
+          } else {
+            reg_wr_err = 1;
+          }
+          if (reg_::LAST_WIDTH == 0 || reg_w.last.to_uint64() == 1) {
+            reg_aw_valid = 0;
+            if (regCfg::useWriteResponses) {
+              reg_b.id = reg_aw.id;
+              reg_b.resp = reg_wr_err ? reg_::Enc::XRESP::SLVERR : reg_::Enc::XRESP::OKAY;
+              reg_b_valid = 1;
+            }
+          } else {
+            regWrAddr = static_cast<sc_uint<numAddrBitsToInspect> >(reg_::NextBeatAddr(reg_aw, regWrAddr));
+          }
+        }
+      }
+    }
+  }
+};
+
+#endif
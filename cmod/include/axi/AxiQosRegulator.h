@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __AXI_QOS_REGULATOR_H__
+#define __AXI_QOS_REGULATOR_H__
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_int.h>
+#include <nvhls_assert.h>
+#include <axi/axi4.h>
+
+/**
+ * \brief A token-bucket bandwidth regulator for the requests of one AXI master.
+ * \ingroup AXI
+ *
+ * \tparam axiCfg                   A valid AXI config.
+ * \tparam regCfg                   A config for the regulator: bytesPerPeriod, period, bucketBytes and maxOutstanding.
+ *
+ * \par Overview
+ * AxiQosRegulator sits between an AXI master and an interconnect port, e.g. an AxiArbiter input, and passes AR and AW requests on only while the master is within its budget.  Responses and write data pass through unchanged.
+ * - A token bucket limits the bytes requested to bytesPerPeriod every period cycles on average (reads and writes together), with bursts of up to bucketBytes.  A request costs (len + 1) beats of its size, and waits until the bucket holds that many bytes.  bucketBytes must cover the largest request.  With bytesPerPeriod = 0 the bandwidth is not limited.
+ * - At most maxOutstanding reads and writes can be in flight, counted from the request until its last R beat or its B response (writes are not counted without write responses).  With maxOutstanding = 0 they are not limited.
+ * - Together with QoS-priority arbitration in AxiArbiter, this bounds the load that best-effort masters put on a slave, so that high-QoS masters still meet their latency targets.
+ * - One request passes per cycle.  While both an AR and an AW are waiting they take turns, so a stream of small requests cannot starve large ones.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <axi/AxiQosRegulator.h>
+ *
+ *      ...
+ *      // 2 bytes per cycle, bursts of up to 256 bytes, 4 transactions in flight
+ *      struct beCfg {
+ *        enum { bytesPerPeriod = 2, period = 1, bucketBytes = 256, maxOutstanding = 4 };
+ *      };
+ *      AxiQosRegulator<axi::cfg::standard, beCfg> regulator;
+ *      ...
+ *          regulator.axi_rd_m(master_rd);
+ *          regulator.axi_wr_m(master_wr);
+ *          regulator.axi_rd_s(arbiter_rd);
+ *          regulator.axi_wr_s(arbiter_wr);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename axiCfg, typename regCfg>
+class AxiQosRegulator : public sc_module {
+ public:
+  static const int kDebugLevel = 5;
+  typedef typename axi::axi4<axiCfg> axi_;
+
+  enum {
+    bytesPerBeat = axi_::DATA_WIDTH >> 3,
+    log_bytesPerBeat = nvhls::log2_ceil<bytesPerBeat>::val,
+    // The bucket counts bytes in units of 1/period
+    bucketMax = regCfg::bucketBytes * regCfg::period,
+    tokens_width = nvhls::nbits<bucketMax + 1>::val,
+    cost_width = axi_::ALEN_WIDTH + 1 + log_bytesPerBeat + nvhls::nbits<regCfg::period>::val,
+    outstanding_width = nvhls::index_width<regCfg::maxOutstanding + 1>::val,
+  };
+  static_assert(regCfg::period >= 1, "period must be at least one cycle");
+  static_assert(regCfg::bytesPerPeriod <= bucketMax,
+                "bucketBytes must hold at least bytesPerPeriod / period bytes");
+
+  typedef NVUINTW(tokens_width) Tokens;
+  typedef NVUINTW(cost_width) Cost;
+  typedef NVUINTW(outstanding_width) Outstanding;
+
+  sc_in<bool> clk;
+  sc_in<bool> reset_bar;
+
+  // From the master
+  typename axi_::read::template slave<> axi_rd_m;
+  typename axi_::write::template slave<> axi_wr_m;
+  // To the interconnect
+  typename axi_::read::template master<> axi_rd_s;
+  typename axi_::write::template master<> axi_wr_s;
+
+#ifndef __SYNTHESIS__
+  // Cycles in which a request waited for tokens, or for a transaction to
+  // complete
+  unsigned long rate_stall_cycles;
+  unsigned long outstanding_stall_cycles;
+#endif
+
+  SC_HAS_PROCESS(AxiQosRegulator);
+
+  AxiQosRegulator(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        reset_bar("reset_bar"),
+        axi_rd_m("axi_rd_m"),
+        axi_wr_m("axi_wr_m"),
+        axi_rd_s("axi_rd_s"),
+        axi_wr_s("axi_wr_s") {
+#ifndef __SYNTHESIS__
+    rate_stall_cycles = 0;
+    outstanding_stall_cycles = 0;
+#endif
+
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(run_w);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+  }
+
+  // Bytes of a request in units of 1/period
+  static Cost RequestCost(typename axi_::AddrPayload& req) {
+    Cost beats = static_cast<Cost>(req.len.to_uint64()) + 1;
+    Cost bytes = (axi_::ASIZE_WIDTH > 0) ? static_cast<Cost>(beats << req.size.to_uint64())
+                                         : static_cast<Cost>(beats << log_bytesPerBeat);
+    return bytes * regCfg::period;
+  }
+
+ protected:
+  void run() {
+    axi_rd_m.reset();
+    axi_rd_s.reset();
+    axi_wr_m.aw.Reset();
+    axi_wr_m.b.Reset();
+    axi_wr_s.aw.Reset();
+    axi_wr_s.b.Reset();
+
+    typename axi_::AddrPayload AR_reg, AW_reg;
+    typename axi_::ReadPayload R_reg;
+    typename axi_::WRespPayload B_reg;
+    bool ar_valid = 0, aw_valid = 0, r_valid = 0, b_valid = 0;
+    bool prefer_write = 0;
+    Tokens tokens = bucketMax;
+    Outstanding outstanding = 0;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while (1) {
+      wait();
+
+      Outstanding outstanding_local = outstanding;
+
+      // Responses pass through; the last beat of a read and the response of a
+      // write complete a transaction.
+      if (r_valid) {
+        if (axi_rd_m.r.PushNB(R_reg)) {
+          r_valid = 0;
+          if (regCfg::maxOutstanding > 0 &&
+              (axi_::LAST_WIDTH == 0 || R_reg.last.to_uint64() == 1))
+            --outstanding_local;
+        }
+      }
+      if (!r_valid) {
+        r_valid = axi_rd_s.r.PopNB(R_reg);
+      }
+      if (axiCfg::useWriteResponses) {
+        if (b_valid) {
+          if (axi_wr_m.b.PushNB(B_reg)) {
+            b_valid = 0;
+            if (regCfg::maxOutstanding > 0)
+              --outstanding_local;
+          }
+        }
+        if (!b_valid) {
+          b_valid = axi_wr_s.b.PopNB(B_reg);
+        }
+      }
+
+      // Requests
+      if (!ar_valid) {
+        ar_valid = axi_rd_m.ar.PopNB(AR_reg);
+      }
+      if (!aw_valid) {
+        aw_valid = axi_wr_m.aw.PopNB(AW_reg);
+      }
+
+      Cost ar_cost = RequestCost(AR_reg);
+      Cost aw_cost = RequestCost(AW_reg);
+      if (regCfg::bytesPerPeriod > 0) {
+        NVHLS_ASSERT_MSG(!ar_valid || ar_cost <= bucketMax,
+                         "Read request larger than the token bucket");
+        NVHLS_ASSERT_MSG(!aw_valid || aw_cost <= bucketMax,
+                         "Write request larger than the token bucket");
+      }
+
+      bool room = (regCfg::maxOutstanding == 0 || outstanding != regCfg::maxOutstanding);
+      bool ar_fits = ar_valid && (regCfg::bytesPerPeriod == 0 || ar_cost <= tokens);
+      bool aw_fits = aw_valid && (regCfg::bytesPerPeriod == 0 || aw_cost <= tokens);
+      bool ar_go = false, aw_go = false;
+      if (room) {
+        if (ar_valid && aw_valid) {
+          // Reads and writes take turns, so that small requests cannot keep the
+          // bucket from filling up for a large one.
+          aw_go = aw_fits && prefer_write;
+          ar_go = ar_fits && !prefer_write;
+        } else {
+          ar_go = ar_fits;
+          aw_go = aw_fits;
+        }
+      }
+
+#ifndef __SYNTHESIS__
+      if ((ar_valid || aw_valid) && !ar_go && !aw_go) {
+        if (!room)
+          outstanding_stall_cycles++;
+        else
+          rate_stall_cycles++;
+      }
+#endif
+
+      Tokens tokens_local = tokens;
+      if (ar_go) {
+        if (axi_rd_s.ar.PushNB(AR_reg)) {
+          ar_valid = 0;
+          prefer_write = 1;
+          if (regCfg::bytesPerPeriod > 0)
+            tokens_local -= ar_cost;
+          if (regCfg::maxOutstanding > 0)
+            ++outstanding_local;
+          CDCOUT(sc_time_stamp() << " " << name() << " Admitted read: [" << AR_reg << "]"
+                                 << endl, kDebugLevel);
+        }
+      } else if (aw_go) {
+        if (axi_wr_s.aw.PushNB(AW_reg)) {
+          aw_valid = 0;
+          prefer_write = 0;
+          if (regCfg::bytesPerPeriod > 0)
+            tokens_local -= aw_cost;
+          if (regCfg::maxOutstanding > 0 && axiCfg::useWriteResponses)
+            ++outstanding_local;
+          CDCOUT(sc_time_stamp() << " " << name() << " Admitted write: [" << AW_reg << "]"
+                                 << endl, kDebugLevel);
+        }
+      }
+
+      // Refill
+      if (regCfg::bytesPerPeriod > 0) {
+        if (tokens_local > bucketMax - regCfg::bytesPerPeriod)
+          tokens = bucketMax;
+        else
+          tokens = tokens_local + regCfg::bytesPerPeriod;
+      }
+      outstanding = outstanding_local;
+    }
+  }
+
+  void run_w() {
+    axi_wr_m.w.Reset();
+    axi_wr_s.w.Reset();
+
+    typename axi_::WritePayload W_reg;
+    bool w_valid = 0;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while (1) {
+      wait();
+
+      if (w_valid) {
+        if (axi_wr_s.w.PushNB(W_reg))
+          w_valid = 0;
+      }
+      if (!w_valid) {
+        w_valid = axi_wr_m.w.PopNB(W_reg);
+      }
+    }
+  }
+};
+
+#endif
@@ -30,10 +30,12 @@
  *
  * \tparam CfgMaster                A valid AXI config describing the master port, with write responses.
  * \tparam CfgSlave                 A valid AXI config describing the slave port, with no write responses.
+ * \tparam maxInFlight              Writes that can be tracked at a time, from their AW until their write response is sent.
  *
  * \par Overview
- * This block converts between an AXI master that uses write responses and an AXI slave that does not use write responses.  Most signals are simply passed through from master to slave.  When a write request is received from the master, it is passed through to the slave, and a write response is also sent back to the master.
+ * This block converts between an AXI master that uses write responses and an AXI slave that does not use write responses.  Most signals are simply passed through from master to slave.  When a write request is received from the master, it is passed through to the slave, and a write response is also sent back to the master after the last beat of the write has been passed on.
  * - Apart from support for write responses, the two AXI configs must otherwise be the same.
+ * - The IDs of tracked writes are kept in two FIFOs of maxInFlight entries: one for writes whose data is still being passed on, one for write responses waiting for the B channel. AW stalls while the first is full, and the last beat of a write while the second is full. Writes stream at one beat per cycle as long as maxInFlight covers the AWs the master issues ahead of their data and the responses it has not taken yet.
  *
  * \par Usage Guidelines
  *
@@ -151,38 +153,42 @@ class AxiRemoveWriteResponse : public sc_module {
     wresp_id_q.reset();
     wresp_id_q_out.reset();
 
-    bool wresp_id_q_full = 0;
-    bool wresp_id_q_empty = 0;
-    bool wresp_id_q_out_full = 0;
-    bool wresp_id_q_out_empty = 0;
+    // AW, W beat and write response waiting for their channel
+    bool aw_valid = 0;
+    bool w_valid = 0;
+    bool b_valid = 0;
 
-    #pragma hls_pipeline_init_interval 2
+    #pragma hls_pipeline_init_interval 1
     #pragma pipeline_stall_mode flush
     while(1) {
       wait();
 
-      wresp_id_q_full = wresp_id_q.isFull();
-      wresp_id_q_empty = wresp_id_q.isEmpty();
-      wresp_id_q_out_full = wresp_id_q_out.isFull();
-      wresp_id_q_out_empty = wresp_id_q_out.isEmpty();
+      if (b_valid) {
+        if (axiM_write.nb_bwrite(B)) b_valid = 0;
+      }
+      if (!b_valid && !wresp_id_q_out.isEmpty()) {
+        B.id = wresp_id_q_out.pop();
+        b_valid = 1;
+      }
 
-      if (!wresp_id_q_full) {
-        if (axiM_write.aw.PopNB(AW)) {
-          axiS_write.aw.Push(BitsToType<typename axiS::AddrPayload>(TypeToBits(AW)));
+      // The data of a write follows its AW to the slave
+      if (aw_valid) {
+        if (axiS_write.aw.PushNB(BitsToType<typename axiS::AddrPayload>(TypeToBits(AW)))) {
           wresp_id_q.push(AW.id);
+          aw_valid = 0;
         }
       }
+      if (!aw_valid && !wresp_id_q.isFull()) aw_valid = axiM_write.aw.PopNB(AW);
 
-      if (!wresp_id_q_empty && !wresp_id_q_out_full) {
-        if (axiM_write.w.PopNB(W)) {
-          axiS_write.w.Push(BitsToType<typename axiS::WritePayload>(TypeToBits(W)));
+      // The response of a write is queued once its last beat is passed on
+      if (w_valid && (W.last == 0 || !wresp_id_q_out.isFull())) {
+        if (axiS_write.w.PushNB(BitsToType<typename axiS::WritePayload>(TypeToBits(W)))) {
+          w_valid = 0;
           if (W.last == 1) wresp_id_q_out.push(wresp_id_q.pop());
         }
       }
-
-      if (!wresp_id_q_out_empty) {
-        B.id = wresp_id_q_out.pop();
-        axiM_write.b.Push(B);
+      if (!w_valid && !wresp_id_q.isEmpty()) {
+        w_valid = axiM_write.w.PopNB(W);
       }
     }
   }
@@ -36,7 +36,8 @@
  * AxiSlaveToMem is an AXI slave with an internal dual-ported memory used for storage.
  * The module only handles AXI addresses within the range of its internal memory, with a base address of 0.
  * It does not support write strobes.
- * It has internal queues to handle multiple simultaneous requests in flight, and can handle read and write requests independently, but it does not reorder requests.
+ * Bursts are INCR, or FIXED and WRAP if axiCfg enables them (see axi4::BeatAddr()); WRAP bursts serve cache-line refills critical-word first.
+ * It has internal queues to handle multiple simultaneous requests in flight, and can handle read and write requests independently, but it does not reorder requests (see AxiSlaveToMemReorder for a variant that reorders reads across AXI IDs).
  *
  * \par Usage Guidelines
  *
@@ -125,7 +126,7 @@ class AxiSlaveToMem : public sc_module {
                       << endl, kDebugLevel);
 
         typename axi4_::ReadPayload data_pld;
-        data_pld.data = memarray.read(rd_addr_pld.addr + bytesPerWord*rd_beat_cnt);
+        data_pld.data = memarray.read(axi4_::BeatAddr(rd_addr_pld, rd_beat_cnt));
         data_pld.resp = axi4_::Enc::XRESP::OKAY;
         data_pld.id = rd_addr_pld.id;
 
@@ -171,7 +172,7 @@ class AxiSlaveToMem : public sc_module {
         if (if_wr.w.PopNB(write_pld)) {
           auto wr_beat_cnt_local = wr_beat_cnt;
           memarray.write(static_cast<typename Memarray::LocalIndex>(static_cast<sc_uint<axi4_::ADDR_WIDTH> >
-                        (wr_addr_pld.addr) + bytesPerWord*wr_beat_cnt_local), 0, write_pld.data);
+                        (axi4_::BeatAddr(wr_addr_pld, wr_beat_cnt_local))), 0, write_pld.data);
           CDCOUT(sc_time_stamp() << " " << name() << " Received write request:"
                         << " addr=[" << wr_addr_pld << "]"
                         << " data=[" << write_pld << "]"
@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __AXISLAVETOMEMREORDER_H__
+#define __AXISLAVETOMEMREORDER_H__
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+#include <hls_globals.h>
+#include <axi/axi4.h>
+#include <mem_array.h>
+#include <fifo.h>
+#include <Arbiter.h>
+#include <one_hot_to_bin.h>
+
+/**
+ * \brief Read scheduling policies for AxiSlaveToMemReorder.
+ * \ingroup AXI
+ *
+ * - AxiSchedRoundRobin: round-robin across the per-ID read queues.
+ * - AxiSchedFRFCFS: first-ready first; queues whose next beat falls in the
+ *   currently open row are served before others, and ties (or a miss on every
+ *   queue) fall back to round-robin across queues.
+ */
+enum axi_sched_type { AxiSchedRoundRobin, AxiSchedFRFCFS };
+
+/**
+ * \brief An AXI slave SRAM that reorders reads across AXI IDs.
+ * \ingroup AXI
+ *
+ * \tparam axiCfg        A valid AXI config.
+ * \tparam capacity      The capacity in bytes of the local SRAM.
+ * \tparam fifoDepth     Depth of each per-ID read queue and of the other queues.
+ * \tparam numIdQueues   Number of read queues (power of two). A request with ID
+ *                       i goes to queue i % numIdQueues.
+ * \tparam sched         Read scheduling policy (see axi_sched_type).
+ * \tparam interleave    If true, read beats of bursts with different IDs may be
+ *                       interleaved on the R channel; otherwise the scheduler
+ *                       only switches queues at burst boundaries.
+ * \tparam rowBytesLog2  log2 of the row size in bytes used by AxiSchedFRFCFS.
+ *
+ * \par Overview
+ * AxiSlaveToMemReorder has the same interface, address range and write path as
+ * AxiSlaveToMem, but read requests are sorted into per-ID queues and a
+ * scheduler picks one queue to serve every cycle.  Requests with the same ID
+ * always map to the same queue and are served in order, so AXI same-ID
+ * ordering is preserved while bursts from different IDs can complete out of
+ * order.  Writes are handled in order, as the W channel carries no ID.
+ *
+ * With interleave=false (the default) the R channel never interleaves beats of
+ * different bursts, which is required by masters that cannot reassemble
+ * interleaved read data.
+ *
+ * \par Usage Guidelines
+ *
+ * As with AxiSlaveToMem, the stall mode is set to flush by default and can be
+ * changed via TCL directive:
+ *
+ * \code
+ * directive set /path/to/AxiSlaveToMemReorder/run/while -PIPELINE_STALL_MODE stall
+ * \endcode
+ *
+ * \par
+ *
+ */
+template <typename axiCfg, int capacity, int fifoDepth = 8,
+          int numIdQueues = 4, axi_sched_type sched = AxiSchedRoundRobin,
+          bool interleave = false, int rowBytesLog2 = 10>
+class AxiSlaveToMemReorder : public sc_module {
+ private:
+  static const int capacity_in_bytes = capacity;
+  static const int banks = 1;
+
+  typedef NVUINTW(axiCfg::dataWidth) Data;
+  typedef mem_array_sep<Data, capacity_in_bytes, banks> Memarray;
+
+  Memarray memarray;
+
+ public:
+  static const int kDebugLevel = 1;
+
+  typedef typename axi::axi4<axiCfg> axi4_;
+  static const int bytesPerWord = axiCfg::dataWidth >> 3;
+
+  typedef FIFO<typename axi4_::AddrPayload, fifoDepth, numIdQueues> RdAddrQueue;
+  typedef typename RdAddrQueue::BankIdx Lane;
+  typedef typename Arbiter<numIdQueues>::Mask LaneMask;
+
+  typename axi4_::read::template slave<> if_rd;
+  typename axi4_::write::template slave<> if_wr;
+
+  sc_in<bool> reset_bar;
+  sc_in<bool> clk;
+
+  FIFO<typename axi4_::ReadPayload, fifoDepth> rd_resp;
+  FIFO<typename axi4_::AddrPayload, fifoDepth> wr_addr;
+  RdAddrQueue rd_addr;
+  FIFO<typename axi4_::WRespPayload, fifoDepth> wr_resp;
+
+  SC_CTOR(AxiSlaveToMemReorder)
+      : if_rd("if_rd"), if_wr("if_wr"), reset_bar("reset_bar"), clk("clk") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+  }
+
+ protected:
+  // Queue index for a read request
+  static Lane LaneOf(typename axi4_::AddrPayload pld) {
+    return static_cast<Lane>(pld.id.to_uint64() % numIdQueues);
+  }
+
+  void run() {
+    if_rd.reset();
+    if_wr.reset();
+
+    rd_resp.reset();
+    rd_addr.reset();
+    wr_resp.reset();
+    wr_addr.reset();
+
+    sc_uint<axi4_::ALEN_WIDTH> rd_beat_cnt[numIdQueues];
+    #pragma hls_unroll yes
+    for (int i = 0; i < numIdQueues; i++) {
+      rd_beat_cnt[i] = 0;
+    }
+    sc_uint<axi4_::ALEN_WIDTH> wr_beat_cnt = 0;
+
+    Arbiter<numIdQueues> rd_arb;
+    bool rd_locked = false;
+    Lane rd_lock_lane = 0;
+    typename axi4_::Addr open_row = 0;
+
+    bool ar_pending = false;
+    typename axi4_::AddrPayload ar_pending_pld;
+
+    #pragma hls_pipeline_init_interval 2
+    #pragma pipeline_stall_mode flush
+    while (1) {
+      wait();
+
+      bool rd_resp_full = rd_resp.isFull();
+
+      if (!rd_resp.isEmpty()) {
+        typename axi4_::ReadPayload data_pld;
+        data_pld = rd_resp.peek();
+        if (if_rd.nb_rwrite(data_pld)) {
+          rd_resp.incrHead();
+        }
+      }
+
+      if (!rd_resp_full) {
+        LaneMask valid = 0;
+        LaneMask hit = 0;
+        #pragma hls_unroll yes
+        for (int i = 0; i < numIdQueues; i++) {
+          if (!rd_addr.isEmpty(i)) {
+            valid[i] = 1;
+            if (sched == AxiSchedFRFCFS) {
+              typename axi4_::AddrPayload head = rd_addr.peek(i);
+              typename axi4_::Addr beat_addr = axi4_::BeatAddr(head, rd_beat_cnt[i]);
+              if ((beat_addr >> rowBytesLog2) == open_row) {
+                hit[i] = 1;
+              }
+            }
+          }
+        }
+
+        Lane lane = rd_lock_lane;
+        bool serve = rd_locked;
+        if (!rd_locked && valid != 0) {
+          LaneMask grant = rd_arb.pick((hit != 0) ? hit : valid);
+          one_hot_to_bin<numIdQueues, RdAddrQueue::BankSelWidth>(grant, lane);
+          serve = true;
+        }
+
+        if (serve) {
+          typename axi4_::AddrPayload rd_addr_pld;
+          rd_addr_pld = rd_addr.peek(lane);
+
+          auto rd_beat_cnt_local = rd_beat_cnt[lane];
+          typename axi4_::Addr beat_addr = axi4_::BeatAddr(rd_addr_pld, rd_beat_cnt_local);
+
+          CDCOUT(sc_time_stamp() << " " << name() << " Serving read request: "
+                        << rd_addr_pld << " queue=" << lane
+                        << " beat=" << dec << rd_beat_cnt_local
+                        << endl, kDebugLevel);
+
+          typename axi4_::ReadPayload data_pld;
+          data_pld.data = memarray.read(beat_addr);
+          data_pld.resp = axi4_::Enc::XRESP::OKAY;
+          data_pld.id = rd_addr_pld.id;
+          open_row = beat_addr >> rowBytesLog2;
+
+          if (rd_beat_cnt_local == rd_addr_pld.len) {
+            rd_beat_cnt_local = 0;
+            rd_addr.incrHead(lane);
+            data_pld.last = 1;
+            rd_locked = false;
+          } else {
+            data_pld.last = 0;
+            ++rd_beat_cnt_local;
+            rd_locked = !interleave;
+            rd_lock_lane = lane;
+          }
+
+          rd_beat_cnt[lane] = rd_beat_cnt_local;
+          rd_resp.push(data_pld);
+        }
+      }
+
+      // Requests are taken off AR in order; one that targets a full queue is
+      // held until that queue drains.
+      if (!ar_pending) {
+        ar_pending = if_rd.nb_aread(ar_pending_pld);
+      }
+      if (ar_pending) {
+        Lane lane = LaneOf(ar_pending_pld);
+        if (!rd_addr.isFull(lane)) {
+          rd_addr.push(ar_pending_pld, lane);
+          ar_pending = false;
+        }
+      }
+
+      bool wr_resp_full = wr_resp.isFull();
+      bool wr_addr_full = wr_addr.isFull();
+
+      if (!wr_resp.isEmpty()) {
+        typename axi4_::WRespPayload resp_pld;
+        resp_pld = wr_resp.peek();
+        if (if_wr.nb_bwrite(resp_pld)) {
+          wr_resp.incrHead();
+        }
+      }
+
+      if (!wr_resp_full && !wr_addr.isEmpty()) {
+        typename axi4_::AddrPayload wr_addr_pld;
+        wr_addr_pld = wr_addr.peek();
+
+        typename axi4_::WritePayload write_pld;
+
+        if (if_wr.w.PopNB(write_pld)) {
+          auto wr_beat_cnt_local = wr_beat_cnt;
+          memarray.write(static_cast<typename Memarray::LocalIndex>(static_cast<sc_uint<axi4_::ADDR_WIDTH> >
+                        (axi4_::BeatAddr(wr_addr_pld, wr_beat_cnt_local))), 0, write_pld.data);
+          CDCOUT(sc_time_stamp() << " " << name() << " Received write request:"
+                        << " addr=[" << wr_addr_pld << "]"
+                        << " data=[" << write_pld << "]"
+                        << " beat=" << dec << wr_beat_cnt_local
+                        << endl, kDebugLevel);
+
+          if (wr_beat_cnt_local == wr_addr_pld.len) {
+            wr_beat_cnt_local = 0;
+            NVHLS_ASSERT_MSG(write_pld.last == true, "WRLEN indicates that this should be the last beat, but WRLAST is not set");
+            wr_addr.incrHead();
+
+            // push resp
+            typename axi4_::WRespPayload resp_pld;
+            resp_pld.resp = axi4_::Enc::XRESP::OKAY;
+            resp_pld.id = wr_addr_pld.id;
+            wr_resp.push(resp_pld);
+          } else {
+            NVHLS_ASSERT_MSG(write_pld.last == false, "WRLEN indicates that this should not be the last beat, but WRLAST is set");
+            ++wr_beat_cnt_local;
+          }
+
+          wr_beat_cnt = wr_beat_cnt_local;
+        }
+      }
+
+      if (!wr_addr_full) {
+        typename axi4_::AddrPayload wr_addr_pld;
+        if (if_wr.aw.PopNB(wr_addr_pld)) {
+          wr_addr.push(wr_addr_pld);
+        }
+      }
+    }
+  }
+};
+
+#endif
@@ -32,9 +32,12 @@
  *
  * \tparam axiCfg    A valid AXI config.
  * \tparam rvCfg     A config for the ready-valid interface that is the output of the slave. The data and strobe fields are assumed to match the widths of their AXI counterparts.
+ * \tparam maxInFlight  Reads that can be outstanding on the ready-valid interface (default: 4).
  *
  * \par Overview
  * This block converts AXI read and write requests into a simplified format consisting of a single ready-valid interface that has address, data, and write strobe fields, as well as a read/write indicator.  Read responses are returned to the block via a second ready-valid interface (there are no write responses expected).  AxiSlaveToReadyValid handles all of the AXI-specific protocol, generating write responses and packing/unpacking bursts as necessary.
+ * - Bursts stream at one beat per cycle. The read requests of a burst are issued without waiting for their responses, up to maxInFlight at a time, so maxInFlight should cover the read latency of the local unit. The local unit must return read responses in request order.
+ * - The next AR (or AW) is accepted in the cycle the last beat of the current burst is issued, while its read data is still in flight. Read and write bursts are arbitrated whole, in round-robin order.
  *
  * \par Usage Guidelines
  *
@@ -51,7 +54,7 @@
  * \par
  *
  */
-template <typename axiCfg, typename rvCfg>
+template <typename axiCfg, typename rvCfg, int maxInFlight = 4>
 class AxiSlaveToReadyValid : public sc_module {
  public:
   static const int kDebugLevel = 5;
@@ -108,107 +111,134 @@ class AxiSlaveToReadyValid : public sc_module {
 
     Write rv_wr;
     Read rv_rd;
-    rvAddr addr_temp;
     
     NVUINTW(axi4_::ADDR_WIDTH) read_addr;
     NVUINTW(axi4_::ALEN_WIDTH) axiRdLen;
     NVUINTW(rvAddrW) write_addr;
 
+    // id, resp and last of the reads issued on if_rv_wr, in order, until
+    // their data comes back on if_rv_rd
+    FIFO<typename axi4_::ReadPayload, maxInFlight> rd_inflight;
+    rd_inflight.reset();
+
     bool read_arb_req = 0;
     bool write_arb_req = 0;
     NVUINTW(2) valid_mask = 0;
     NVUINTW(2) select_mask = 0;
     Arbiter<2> arb;
 
-    bool read_inFlight = 0;
     bool arb_needs_update = 1;
+
+    // Registered outputs waiting for their channel, and the W beat waiting
+    // for if_rv_wr
+    bool rd_resp_valid = 0;
+    bool wr_resp_valid = 0;
+    bool wr_data_valid = 0;
     
     #pragma hls_pipeline_init_interval 1
     #pragma pipeline_stall_mode flush
     while (1) {
       wait();
 
-      valid_mask = write_arb_req << 1 | read_arb_req;
-      if (arb_needs_update) {
-        select_mask = arb.pick(valid_mask);
-        if (select_mask != 0) arb_needs_update = 0;
+      if (rd_resp_valid) {
+        if (if_axi_rd.r.PushNB(axi_rd_resp)) rd_resp_valid = 0;
+      }
+      if (wr_resp_valid) {
+        if (if_axi_wr.nb_bwrite(axi_wr_resp)) wr_resp_valid = 0;
       }
 
-      if (!read_arb_req) {
-        if (if_axi_rd.ar.PopNB(axi_rd_req)) { 
-          read_arb_req = 1;
-          NVUINTW(axi4_::ADDR_WIDTH) addr_temp_cast(static_cast<sc_uint<axi4_::ADDR_WIDTH> >(axi_rd_req.addr));
-          NVUINTW(axi4_::ALEN_WIDTH) len_temp(static_cast< sc_uint<axi4_::ALEN_WIDTH> >(axi_rd_req.len));
-          read_addr = addr_temp_cast;
-          axiRdLen = len_temp;
-          axi_rd_resp.resp = axi4_::Enc::XRESP::OKAY;
-          axi_rd_resp.id = axi_rd_req.id;
+      if (!rd_resp_valid && !rd_inflight.isEmpty()) {
+        if (if_rv_rd.PopNB(rv_rd)) {
+          axi_rd_resp = rd_inflight.pop();
+          axi_rd_resp.data = rv_rd.data;
+          rd_resp_valid = 1;
+          CDCOUT(sc_time_stamp() << " " << name() << " RV read response:"
+                        << axi_rd_resp
+                        << endl, kDebugLevel);
         }
       }
 
-      if (!write_arb_req) {
-        if (if_axi_wr.aw.PopNB(axi_wr_req_addr)) {
-          write_arb_req = 1;
-          NVUINTW(rvAddrW) addr_temp_cast(static_cast< sc_uint<rvAddrW> >(axi_wr_req_addr.addr));
-          write_addr = addr_temp_cast;
-        }
+      valid_mask = write_arb_req << 1 | read_arb_req;
+      if (arb_needs_update) {
+        select_mask = arb.pick(valid_mask);
+        if (select_mask != 0) arb_needs_update = 0;
       }
 
       if (select_mask == 1) {
-        if (!read_inFlight) {
+        if (read_arb_req && !rd_inflight.isFull()) {
           rv_wr.rw = 0;
           rv_wr.addr = nvhls::get_slc<rvAddrW>(read_addr,0);
-          if_rv_wr.Push(rv_wr);
-          CDCOUT(sc_time_stamp() << " " << name() << " RV read:"
-                        << " addr=" << hex << rv_wr.addr.to_int64()
-                        << endl, kDebugLevel);
-          read_inFlight = 1;
-        } else {
-          if (if_rv_rd.PopNB(rv_rd)) {
-            axi_rd_resp.data = rv_rd.data;
+          if (if_rv_wr.PushNB(rv_wr)) {
+            CDCOUT(sc_time_stamp() << " " << name() << " RV read:"
+                          << " addr=" << hex << rv_wr.addr.to_int64()
+                          << endl, kDebugLevel);
+            typename axi4_::ReadPayload rd_tag;
+            rd_tag.resp = axi4_::Enc::XRESP::OKAY;
+            rd_tag.id = axi_rd_req.id;
             if (axiRdLen == 0) {
-              axi_rd_resp.last = 1;
+              rd_tag.last = 1;
               read_arb_req = 0;
               arb_needs_update = 1;
             } else {
-              axi_rd_resp.last = 0;
+              rd_tag.last = 0;
               axiRdLen--;
               read_addr += bytesPerBeat;
             }
-            if_axi_rd.r.Push(axi_rd_resp);
-            CDCOUT(sc_time_stamp() << " " << name() << " RV read response:"
-                          << axi_rd_resp
-                          << endl, kDebugLevel);
-            read_inFlight = 0;
+            rd_inflight.push(rd_tag);
           }
         }
       } else if (select_mask == 2) {
-        if (if_axi_wr.w.PopNB(axi_wr_req_data)) {
+        if (!wr_data_valid) wr_data_valid = if_axi_wr.w.PopNB(axi_wr_req_data);
+        // The last beat waits until the write response register is free
+        bool wr_resp_blocked = axiCfg::useWriteResponses && wr_resp_valid;
+        if (wr_data_valid && !(axi_wr_req_data.last == 1 && wr_resp_blocked)) {
           rv_wr.addr = write_addr;
           rv_wr.rw = 1;
           NVUINTW(axi4_::WSTRB_WIDTH) wstrb_temp_cast(static_cast<sc_uint<axi4_::WSTRB_WIDTH> >(axi_wr_req_data.wstrb));
           rv_wr.wstrb = wstrb_temp_cast;
           NVUINTW(axi4_::DATA_WIDTH) data_temp_cast(static_cast<typename axi4_::Data>(axi_wr_req_data.data));
           rv_wr.data = data_temp_cast;
-          if_rv_wr.Push(rv_wr);
-          CDCOUT(sc_time_stamp() << " " << name() << " RV write:"
-                        << " data=" << hex << rv_wr.data
-                        << " addr=" << hex << rv_wr.addr.to_uint64()
-                        << " strb=" << hex << rv_wr.wstrb.to_uint64()
-                        << endl, kDebugLevel);
-          if (axi_wr_req_data.last == 1) {
-            write_arb_req = 0;
-            arb_needs_update = 1;
-            if (axiCfg::useWriteResponses) {
-              axi_wr_resp.resp = axi4_::Enc::XRESP::OKAY;
-              axi_wr_resp.id = axi_wr_req_addr.id;
-              if_axi_wr.bwrite(axi_wr_resp);
+          if (if_rv_wr.PushNB(rv_wr)) {
+            CDCOUT(sc_time_stamp() << " " << name() << " RV write:"
+                          << " data=" << hex << rv_wr.data
+                          << " addr=" << hex << rv_wr.addr.to_uint64()
+                          << " strb=" << hex << rv_wr.wstrb.to_uint64()
+                          << endl, kDebugLevel);
+            wr_data_valid = 0;
+            if (axi_wr_req_data.last == 1) {
+              write_arb_req = 0;
+              arb_needs_update = 1;
+              if (axiCfg::useWriteResponses) {
+                axi_wr_resp.resp = axi4_::Enc::XRESP::OKAY;
+                axi_wr_resp.id = axi_wr_req_addr.id;
+                wr_resp_valid = 1;
+              }
+            } else {
+              write_addr += bytesPerBeat;
             }
-          } else {
-            write_addr += bytesPerBeat;
           }
         }
       }
+
+      // New requests are accepted after the issue above, so a burst can
+      // follow the last beat of the previous one without a bubble
+      if (!read_arb_req) {
+        if (if_axi_rd.ar.PopNB(axi_rd_req)) { 
+          read_arb_req = 1;
+          NVUINTW(axi4_::ADDR_WIDTH) addr_temp_cast(static_cast<sc_uint<axi4_::ADDR_WIDTH> >(axi_rd_req.addr));
+          NVUINTW(axi4_::ALEN_WIDTH) len_temp(static_cast< sc_uint<axi4_::ALEN_WIDTH> >(axi_rd_req.len));
+          read_addr = addr_temp_cast;
+          axiRdLen = len_temp;
+        }
+      }
+
+      if (!write_arb_req) {
+        if (if_axi_wr.aw.PopNB(axi_wr_req_addr)) {
+          write_arb_req = 1;
+          NVUINTW(rvAddrW) addr_temp_cast(static_cast< sc_uint<rvAddrW> >(axi_wr_req_addr.addr));
+          write_addr = addr_temp_cast;
+        }
+      }
     }
   }
 };
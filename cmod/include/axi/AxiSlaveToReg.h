@@ -32,9 +32,15 @@
  * \tparam axiCfg                   A valid AXI config.
  * \tparam numReg                   The number of registers in the slave.  Each register has a width equivalent to the AXI data width.
  * \tparam numAddrBitsToInspect     The number of address bits to inspect when determining which slave to direct traffic to.  If this is less than the full address width, the routing determination will be made based on the number of address LSBs specified.  (Default: axiCfg::addrWidth)
+ * \tparam fifoDepth                Depth of the read and write response queues.  (Default: 2)
  *
  * \par Overview
  * AxiSlaveToReg is an AXI slave that saves its state in a bank of registers.  The register state is accessible as an array of sc_out.
+ * Bursts step through the registers as INCR bursts, or as FIXED and WRAP bursts if axiCfg enables them; a FIXED burst
+ * repeatedly accesses one register, e.g. to drain or fill a FIFO-mapped peripheral.
+ * Reads and writes are arbitrated one burst at a time and each beat takes one cycle.  A new AR or AW can be
+ * accepted in the cycle the previous burst completes, so back-to-back single-beat accesses run at one per cycle,
+ * while up to fifoDepth responses per channel wait in order for the master to accept them.
  *
  * \par Usage Guidelines
  *
@@ -51,7 +57,7 @@
  * \par
  *
  */
-template <typename axiCfg, int numReg, int numAddrBitsToInspect = axiCfg::addrWidth>
+template <typename axiCfg, int numReg, int numAddrBitsToInspect = axiCfg::addrWidth, int fifoDepth = 2>
 class AxiSlaveToReg : public sc_module {
  public:
   static const int kDebugLevel = 5;
@@ -105,6 +111,11 @@ class AxiSlaveToReg : public sc_module {
     typename axi4_::WritePayload axi_wr_req_data;
     typename axi4_::WRespPayload axi_wr_resp;
 
+    FIFO<typename axi4_::ReadPayload, fifoDepth> rd_resp;
+    FIFO<typename axi4_::WRespPayload, fifoDepth> wr_resp;
+    rd_resp.reset();
+    wr_resp.reset();
+
     NVUINTW(numAddrBitsToInspect) axiRdAddr;
     NVUINTW(axi4_::ALEN_WIDTH) axiRdLen;
     bool valid_rd_addr;
@@ -123,10 +134,20 @@ class AxiSlaveToReg : public sc_module {
     while (1) {
       wait();
 
-      valid_mask = write_arb_req << 1 | read_arb_req;
-      if (arb_needs_update) {
-        select_mask = arb.pick(valid_mask);
-        if (select_mask != 0) arb_needs_update = 0;
+      // Responses leave in order; draining first lets a full queue accept a
+      // new beat in the same cycle
+      if (!rd_resp.isEmpty()) {
+        axi_rd_resp = rd_resp.peek();
+        if (if_axi_rd.nb_rwrite(axi_rd_resp)) {
+          rd_resp.incrHead();
+        }
+      }
+
+      if (!wr_resp.isEmpty()) {
+        axi_wr_resp = wr_resp.peek();
+        if (if_axi_wr.nb_bwrite(axi_wr_resp)) {
+          wr_resp.incrHead();
+        }
       }
 
       if (!read_arb_req) {
@@ -147,7 +168,13 @@ class AxiSlaveToReg : public sc_module {
         }
       }
 
-      if (select_mask == 1) {
+      valid_mask = write_arb_req << 1 | read_arb_req;
+      if (arb_needs_update) {
+        select_mask = arb.pick(valid_mask);
+        if (select_mask != 0) arb_needs_update = 0;
+      }
+
+      if (select_mask == 1 && !rd_resp.isFull()) {
         valid_rd_addr = (axiRdAddr >= baseAddr.read() && axiRdAddr <= maxValidAddr);
         NVHLS_ASSERT_MSG(valid_rd_addr, "Read address is out of bounds");
         NVUINTW(regAddrWidth) regAddr = (axiRdAddr - baseAddr.read()) >> axiAddrBitsPerReg;
@@ -167,15 +194,15 @@ class AxiSlaveToReg : public sc_module {
         } else {
           axi_rd_resp.last = 0;
           axiRdLen--;
-          axiRdAddr += bytesPerReg;
+          axiRdAddr = static_cast<sc_uint<numAddrBitsToInspect> >(axi4_::NextBeatAddr(axi_rd_req, axiRdAddr));
         }
-        if_axi_rd.rwrite(axi_rd_resp);
+        rd_resp.push(axi_rd_resp);
         CDCOUT(sc_time_stamp() << " " << name() << " Read from local reg:"
                       << " axi_addr=" << hex << axiRdAddr.to_int64()
                       << " reg_addr=" << regAddr.to_int64()
                       << " data=" << hex << axi_rd_resp.data
                       << endl, kDebugLevel);
-      } else if (select_mask == 2) {
+      } else if (select_mask == 2 && !wr_resp.isFull()) {
         if (if_axi_wr.w.PopNB(axi_wr_req_data)) {
           valid_wr_addr = (axiWrAddr >= baseAddr.read() && axiWrAddr <= maxValidAddr);
           NVHLS_ASSERT_MSG(valid_wr_addr, "Write address is out of bounds");
@@ -212,10 +239,10 @@ class AxiSlaveToReg : public sc_module {
               } else {
                 axi_wr_resp.resp = axi4_::Enc::XRESP::SLVERR;
               }
-              if_axi_wr.bwrite(axi_wr_resp);
+              wr_resp.push(axi_wr_resp);
             }
           } else {
-            axiWrAddr += bytesPerReg;
+            axiWrAddr = static_cast<sc_uint<numAddrBitsToInspect> >(axi4_::NextBeatAddr(axi_wr_req_addr, axiWrAddr));
           }
         }
       }
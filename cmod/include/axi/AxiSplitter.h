@@ -26,6 +26,88 @@
 #include "Arbiter.h"
 #include "TypeToBits.h"
 
+/**
+ * \brief Address decode inputs of AxiSplitter
+ * \ingroup AXI
+ *
+ * Without regions, one [lower, upper] range per slave in addrBound, checked
+ * in slave order. With numRegions > 0, a table of regions in regionTable,
+ * each a base, an inclusive limit and a control word, compared in parallel;
+ * see AxiSplitter.
+ */
+template <int numSlaves, int numAddrBits, int dataWidth, int numRegions,
+          bool useRegions = (numRegions > 0)>
+class AxiSplitterMap {
+ public:
+  typedef NVUINTW(numAddrBits) AddrBits;
+  sc_in<AddrBits> addrBound[numSlaves][2];
+
+ protected:
+  // Slave of addr and the bounds of its range; dest is numSlaves if no range
+  // contains addr
+  template <typename SlaveIdx>
+  void decode(const AddrBits& addr, SlaveIdx& dest, AddrBits& lower, AddrBits& upper) {
+    // The lowest-indexed matching range wins
+    dest = numSlaves;
+#pragma hls_unroll yes
+    for (int i = numSlaves - 1; i >= 0; i--) {
+      if (addr >= addrBound[i][0].read() && addr <= addrBound[i][1].read()) {
+        dest = i;
+      }
+    }
+  }
+
+  // Bounds of the range of a slave that is not given by decode
+  void bounds(int dest, AddrBits& lower, AddrBits& upper) {
+    lower = addrBound[dest][0].read();
+    upper = addrBound[dest][1].read();
+  }
+};
+
+template <int numSlaves, int numAddrBits, int dataWidth, int numRegions>
+class AxiSplitterMap<numSlaves, numAddrBits, dataWidth, numRegions, true> {
+ public:
+  typedef NVUINTW(numAddrBits) AddrBits;
+  typedef NVUINTW(dataWidth) Reg;
+  static const int log_numSlaves = nvhls::log2_ceil<numSlaves>::val + 1;
+  enum { REGION_BASE = 0, REGION_LIMIT = 1, REGION_CTRL = 2, REGION_REGS = 3 };
+
+  sc_in<Reg> regionTable[numRegions][REGION_REGS];
+
+  // Control word of an enabled region that routes to slave
+  static Reg regionCtrl(unsigned int slave) { return (static_cast<Reg>(slave) << 1) | 1; }
+
+ protected:
+  template <typename SlaveIdx>
+  void decode(const AddrBits& addr, SlaveIdx& dest, AddrBits& lower, AddrBits& upper) {
+    bool hit[numRegions];
+#pragma hls_unroll yes
+    for (int r = 0; r < numRegions; r++) {
+      AddrBits base = nvhls::get_slc<numAddrBits>(regionTable[r][REGION_BASE].read(), 0);
+      AddrBits limit = nvhls::get_slc<numAddrBits>(regionTable[r][REGION_LIMIT].read(), 0);
+      hit[r] = (regionTable[r][REGION_CTRL].read()[0] == 1) && addr >= base && addr <= limit;
+    }
+    // The lowest-indexed matching region wins
+    dest = numSlaves;
+#pragma hls_unroll yes
+    for (int r = numRegions - 1; r >= 0; r--) {
+      if (hit[r]) {
+        Reg ctrl = regionTable[r][REGION_CTRL].read();
+        SlaveIdx slave = nvhls::get_slc<log_numSlaves>(ctrl, 1);
+        dest = (slave < numSlaves) ? slave : static_cast<SlaveIdx>(numSlaves);
+        lower = nvhls::get_slc<numAddrBits>(regionTable[r][REGION_BASE].read(), 0);
+        upper = nvhls::get_slc<numAddrBits>(regionTable[r][REGION_LIMIT].read(), 0);
+      }
+    }
+  }
+
+  // Addresses outside every region have no bounds
+  void bounds(int dest, AddrBits& lower, AddrBits& upper) {
+    lower = 0;
+    upper = ~static_cast<AddrBits>(0);
+  }
+};
+
 /**
  * \brief An n-way splitter that connects a single AXI master port to a multiple AXI slave ports.
  * \ingroup AXI
@@ -35,14 +117,40 @@
  * \tparam numAddrBitsToInspect     The number of address bits to inspect when determining which slave to direct traffic to.  If this is less than the full address width, the routing determination will be made based on the number of address LSBs specified.  (Default: axiCfg::addrWidth)
  * \tparam default_output           If true, requests with addresses that do not fall in any of the specified address ranges will be directed to the highest-indexed slave port.  (Default: false)
  * \tparam translate_addr           If true, requests are re-addressed relative to the base address of the receiving slave when they are passed through the splitter.  (Default: false)
+ * \tparam split_bursts             If true, bursts are cut into several downstream bursts at slave address range boundaries and 4KB boundaries, and the responses are reassembled into a single burst response.  (Default: false)
+ * \tparam numRegions               If nonzero, the address map is a table of numRegions base/limit regions in regionTable instead of one range per slave in addrBound.  (Default: 0)
  *
  * \par Overview
  * AxiSplitter connects one or more AXI slaves to a single AXI master.  Requests from the master are routed by address to the appropriate slave.
  * - The address ranges for each slave must be contiguous (except for the highest-indexed slave if default_output is true).  Address bounds for each slave are set by writing to a (numSlaves x 2) array of sc_in.
  * - Only a single outstanding request to all slaves is allowed; AxiSplitter blocks further requests until the response has been returned.
- * - As implemented, the splitter directs all writes from a burst to the destination indicated by the base address of the burst.  Guards against crossing address boundaries are not implemented.
+ * - By default the splitter directs all beats of a burst to the destination indicated by the base address of the burst.  Guards against crossing address boundaries are not implemented.
+ * - With split_bursts, each burst is issued as a sequence of downstream bursts that neither cross a slave address range boundary nor a 4KB boundary, so masters may issue maximal bursts anywhere.  Read data beats are forwarded with RLAST only on the final beat, and a single write response carrying the most severe BRESP of the pieces is returned.  Only INCR bursts are split: a WRAP burst stays within its wrap window, which never crosses a 4KB boundary, and a FIXED burst does not move, so both are forwarded whole.  Split bursts are assumed to be of full-width beats; the pieces after one that starts at an unaligned address start at beat-aligned addresses.
  * - The AXI configs of all ports must be the same.
  *
+ * \par Region table
+ * With numRegions > 0, addrBound is replaced by regionTable[numRegions][3], and each region r is
+ * - regionTable[r][REGION_BASE]: the lowest address of the region,
+ * - regionTable[r][REGION_LIMIT]: the highest address of the region,
+ * - regionTable[r][REGION_CTRL]: bit 0 enables the region, and the bits above it hold the index of the slave, see regionCtrl().
+ *
+ * All regions are compared with the address in parallel in the decode cycle, and the lowest-indexed enabled region that contains the address wins, so regions may overlap and a slave may own any number of regions of any size and alignment.  Regions that select a slave index of numSlaves or more, and addresses outside every region, are misses, which go to the highest-indexed slave with default_output and are not translated.  With translate_addr, addresses are made relative to the base of the matching region, and with split_bursts, bursts are cut at region limits.
+ *
+ * The table entries are AXI data words, so regionTable can be driven through signals by the regOut of an AxiSlaveToReg with numReg = 3 * numRegions and the same data width, which makes the map programmable at runtime.  Regions reset to disabled with the registers.
+ *
+ * \code
+ *      AxiSlaveToReg<axiCfg, 3 * numRegions> map_regs;
+ *      AxiSplitter<axiCfg, numSlaves, axiCfg::addrWidth, false, false, false, numRegions> splitter;
+ *      sc_signal<NVUINTW(axiCfg::dataWidth)> map[3 * numRegions];
+ *      ...
+ *      for (int r = 0; r < numRegions; r++) {
+ *        for (int k = 0; k < 3; k++) {
+ *          map_regs.regOut[3 * r + k](map[3 * r + k]);
+ *          splitter.regionTable[r][k](map[3 * r + k]);
+ *        }
+ *      }
+ * \endcode
+ *
  * \par Usage Guidelines
  *
  * This module sets the stall mode to flush by default to mitigate possible RTL
@@ -58,8 +166,9 @@
  * \par
  *
  */
-template <typename axiCfg, int numSlaves, int numAddrBitsToInspect = axiCfg::addrWidth, bool default_output = false, bool translate_addr = false>
-class AxiSplitter : public sc_module {
+template <typename axiCfg, int numSlaves, int numAddrBitsToInspect = axiCfg::addrWidth, bool default_output = false, bool translate_addr = false, bool split_bursts = false, int numRegions = 0>
+class AxiSplitter : public sc_module,
+                    public AxiSplitterMap<numSlaves, numAddrBitsToInspect, axiCfg::dataWidth, numRegions> {
  public:
   static const int kDebugLevel = 5;
   sc_in<bool> clk;
@@ -74,6 +183,14 @@ class AxiSplitter : public sc_module {
   typedef typename axi4_::write::template master<>::BPort axi_wr_master_b;
 
   static const unsigned int log_numSlaves = nvhls::log2_ceil<numSlaves>::val + 1;
+  static const int bytesPerBeat = axi4_::DATA_WIDTH >> 3;
+  static const int log_bytesPerBeat = nvhls::log2_ceil<bytesPerBeat>::val;
+  static const int pageBytes = 4096;
+
+  typedef NVUINTW(axi4_::ALEN_WIDTH + 1) Beats;
+  typedef NVUINTW(log_numSlaves) SlaveIdx;
+  typedef NVUINTW(numAddrBitsToInspect) AddrBits;
+  typedef AxiSplitterMap<numSlaves, numAddrBitsToInspect, axiCfg::dataWidth, numRegions> Map;
 
   // [ben] Unfortunately HLS cannot handle an nv_array of the master/slave wrapper classes.
   // It will work fine in C but die mysteriously in Catapult 10.1b when methods of the
@@ -86,8 +203,6 @@ class AxiSplitter : public sc_module {
   typename axi4_::read::template slave<> axi_rd_m;
   typename axi4_::write::template slave<> axi_wr_m;
 
-  sc_in<NVUINTW(numAddrBitsToInspect)> addrBound[numSlaves][2];
-
   SC_HAS_PROCESS(AxiSplitter);
 
   AxiSplitter(sc_module_name name)
@@ -115,6 +230,68 @@ class AxiSplitter : public sc_module {
   // As an optimization, responses with different IDs could be allowed
   // through, since it is safe to return them out of order.
 
+ protected:
+  // Index of the slave whose address range contains addr (numSlaves if none),
+  // and the bounds of that range
+  SlaveIdx route(typename axi4_::Addr addr_full, AddrBits& lower, AddrBits& upper) {
+    AddrBits addr(static_cast<sc_uint<numAddrBitsToInspect> >(addr_full)); // Cast larger to smaller
+    SlaveIdx dest;
+    lower = 0;
+    upper = 0;
+    Map::decode(addr, dest, lower, upper);
+    if (default_output && dest == numSlaves) {
+      dest = numSlaves-1;
+      Map::bounds(dest, lower, upper);
+    } else if (numRegions == 0 && dest != numSlaves) {
+      Map::bounds(dest, lower, upper);
+    }
+    return dest;
+  }
+
+  // Address of the beat that contains addr
+  static typename axi4_::Addr beatAddr(typename axi4_::Addr addr) {
+    return addr & ~static_cast<typename axi4_::Addr>(bytesPerBeat - 1);
+  }
+
+  // Whether the burst req is cut into pieces: only INCR bursts are
+  static bool splitBurst(typename axi4_::AddrPayload req) {
+    return split_bursts &&
+           (axi4_::BURST_WIDTH == 0 || req.burst.to_uint64() == axi4_::Enc::AXBURST::INCR);
+  }
+
+  // Number of beats of the remaining burst req that can go to the range
+  // ending at upper in one piece. Counted from the beat that contains addr, so
+  // an unaligned start in the last beat of a page or range still gets one beat.
+  Beats segmentBeats(const typename axi4_::AddrPayload& req, typename axi4_::Addr addr_full,
+                     Beats remaining, const AddrBits& upper) {
+    if (!splitBurst(req))
+      return remaining;
+
+    Beats seg = remaining;
+    typename axi4_::Addr beat_full = beatAddr(addr_full);
+    NVUINTW(13) page_offset = nvhls::get_slc<12>(beat_full, 0);
+    NVUINTW(13) to_page = (pageBytes - page_offset) >> log_bytesPerBeat;
+    if (to_page < seg)
+      seg = to_page;
+
+    AddrBits addr(static_cast<sc_uint<numAddrBitsToInspect> >(beat_full));
+    if (addr <= upper) {
+      NVUINTW(numAddrBitsToInspect + 1) to_end = ((upper - addr) >> log_bytesPerBeat) + 1;
+      if (to_end < seg)
+        seg = to_end;
+    }
+    NVHLS_ASSERT_MSG(seg != 0, "Split burst piece has no beats");
+    return seg;
+  }
+
+  // Address of the piece that follows a piece of seg beats at addr: beats
+  // after the first one of an INCR burst are aligned
+  static typename axi4_::Addr nextPieceAddr(typename axi4_::Addr addr, Beats seg) {
+    return beatAddr(addr) + (static_cast<typename axi4_::Addr>(seg) << log_bytesPerBeat);
+  }
+
+ public:
+
   void run_r() {
 #pragma hls_unroll yes
     for (int i=0; i<numSlaves; i++) {
@@ -129,6 +306,8 @@ class AxiSplitter : public sc_module {
 
     bool read_inFlight = 0;
     NVUINTW(log_numSlaves) pushedTo = numSlaves;
+    typename axi4_::Addr rd_addr = 0;  // address of the next piece of a split burst
+    Beats rd_remaining = 0;            // beats of the burst not yet requested downstream
     
       #pragma hls_pipeline_init_interval 1
       #pragma pipeline_stall_mode flush
@@ -137,33 +316,39 @@ class AxiSplitter : public sc_module {
 
       switch (read_inFlight) {
         case false:
-          if (axi_rd_m.ar.PopNB(AR_reg)) {
-            NVUINTW(numAddrBitsToInspect)
-                addr(static_cast<sc_uint<numAddrBitsToInspect> >(AR_reg.addr)); // Cast larger to smaller
-            pushedTo = numSlaves;
-            // TODO - refactor this so it can be unrolled
-            for (int i=0; i<numSlaves; i++) {
-              if (addr >= addrBound[i][0].read() && addr <= addrBound[i][1].read() && pushedTo == numSlaves) {
-                pushedTo = i;
-              }
-            }
-            if (default_output && pushedTo == numSlaves) {
-              pushedTo = numSlaves-1;
+          if (rd_remaining != 0 || axi_rd_m.ar.PopNB(AR_reg)) {
+            if (rd_remaining == 0) {
+              rd_addr = AR_reg.addr;
+              rd_remaining = axiCfg::useBurst ? AR_reg.len.to_uint64() + 1 : 1;
             }
+            AddrBits lower, upper;
+            pushedTo = route(rd_addr, lower, upper);
             // If the address did not fall in any valid range, that's bad
             NVHLS_ASSERT_MSG(pushedTo != numSlaves, "Read address did not fall into any output address range, and default output is not set");
 
+            Beats seg = segmentBeats(AR_reg, rd_addr, rd_remaining, upper);
+            typename axi4_::AddrPayload seg_pld = AR_reg;
+            seg_pld.addr = rd_addr;
+            if (split_bursts)
+              seg_pld.len = seg - 1;
+            rd_addr = nextPieceAddr(rd_addr, seg);
+            rd_remaining -= seg;
+
             if (translate_addr)
-              AR_reg.addr -= addrBound[pushedTo][0].read();
+              seg_pld.addr -= lower;
 
-            axi_rd_s_ar[pushedTo].Push(AR_reg);
+            axi_rd_s_ar[pushedTo].Push(seg_pld);
             read_inFlight = 1;
           }
           break;
         case true:
           if (axi_rd_s_r[pushedTo].PopNB(R_reg)) {
+            if (R_reg.last == 1) {
+              read_inFlight = 0;
+              // Only the final piece of a split burst ends the burst upstream
+              if (rd_remaining != 0) R_reg.last = 0;
+            }
             axi_rd_m.r.Push(R_reg);
-            if (R_reg.last == 1) read_inFlight = 0;
           }
           break;
       }
@@ -186,6 +371,10 @@ class AxiSplitter : public sc_module {
     typename axi4_::WRespPayload B_reg;
     
     NVUINTW(log_numSlaves) pushedTo = numSlaves;
+    typename axi4_::Addr wr_addr = 0;  // address of the next piece of a split burst
+    Beats wr_remaining = 0;            // beats of the burst not yet requested downstream
+    Beats wr_seg_left = 0;             // W beats left in the current piece
+    typename axi4_::Resp wr_resp = axi4_::Enc::XRESP::OKAY;  // most severe BRESP of the pieces
     enum {
       IDLE = 0,
       WRITE_INFLIGHT = 1,
@@ -200,32 +389,42 @@ class AxiSplitter : public sc_module {
 
       switch (s) {
         case IDLE:
-          if (axi_wr_m.aw.PopNB(AW_reg)) {
-            NVUINTW(numAddrBitsToInspect)
-                addr(static_cast<sc_uint<numAddrBitsToInspect> >(AW_reg.addr)); // Cast larger to smaller
-            pushedTo = numSlaves;
-            // TODO - refactor this so it can be unrolled
-            for (int i=0; i<numSlaves; i++) {
-              if (addr >= addrBound[i][0].read() && addr <= addrBound[i][1].read() && pushedTo == numSlaves) {
-                pushedTo = i;
-              }
-            }
-            if (default_output && pushedTo == numSlaves) {
-              pushedTo = numSlaves-1;
+          if (wr_remaining != 0 || axi_wr_m.aw.PopNB(AW_reg)) {
+            if (wr_remaining == 0) {
+              wr_addr = AW_reg.addr;
+              wr_remaining = axiCfg::useBurst ? AW_reg.len.to_uint64() + 1 : 1;
             }
+            AddrBits lower, upper;
+            pushedTo = route(wr_addr, lower, upper);
             NVHLS_ASSERT_MSG(pushedTo != numSlaves, "Write address did not fall into any output address range, and default output is not set");
+
+            Beats seg = segmentBeats(AW_reg, wr_addr, wr_remaining, upper);
+            typename axi4_::AddrPayload seg_pld = AW_reg;
+            seg_pld.addr = wr_addr;
+            if (split_bursts)
+              seg_pld.len = seg - 1;
+            wr_addr = nextPieceAddr(wr_addr, seg);
+            wr_remaining -= seg;
+            wr_seg_left = seg;
+
             if (translate_addr)
-              AW_reg.addr -= addrBound[pushedTo][0].read();
+              seg_pld.addr -= lower;
 
-            axi_wr_s_aw[pushedTo].Push(AW_reg);
+            axi_wr_s_aw[pushedTo].Push(seg_pld);
             s = WRITE_INFLIGHT;
           }
           break;
         case WRITE_INFLIGHT:
           NVHLS_ASSERT_MSG(pushedTo != numSlaves, "Write address did not fall into any output address range, and default output is not set");
           if (axi_wr_m.w.PopNB(W_reg)) {
+            bool seg_last = (W_reg.last == 1);
+            if (split_bursts) {
+              seg_last = (wr_seg_left == 1);
+              W_reg.last = seg_last;
+              --wr_seg_left;
+            }
             axi_wr_s_w[pushedTo].Push(W_reg);
-            if (W_reg.last == 1) {
+            if (seg_last) {
               if (axiCfg::useWriteResponses) {
                 s = RESP_INFLIGHT;
               } else {
@@ -237,7 +436,13 @@ class AxiSplitter : public sc_module {
         case RESP_INFLIGHT:
           if (axiCfg::useWriteResponses) {
             if (axi_wr_s_b[pushedTo].PopNB(B_reg)) {
-              axi_wr_m.b.Push(B_reg);
+              if (B_reg.resp > wr_resp)
+                wr_resp = B_reg.resp;
+              if (wr_remaining == 0) {
+                B_reg.resp = wr_resp;
+                axi_wr_m.b.Push(B_reg);
+                wr_resp = axi4_::Enc::XRESP::OKAY;
+              }
               s = IDLE;
             }
           } 
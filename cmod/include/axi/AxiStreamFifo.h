@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __AXISTREAMFIFO_H__
+#define __AXISTREAMFIFO_H__
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+#include <axi/axi4_stream.h>
+#include <fifo.h>
+
+/**
+ * \brief A FIFO for an AXI4-Stream channel.
+ * \ingroup AXI
+ *
+ * \tparam Cfg          A valid AXI4-Stream config.
+ * \tparam depth        The number of beats the FIFO holds. (default: 16)
+ * \tparam packetMode   If true, beats are only forwarded once the FIFO holds a
+ *                      complete packet (a beat with TLAST), or when it is full.
+ *                      (default: false)
+ *
+ * \par Overview
+ * AxiStreamFifo buffers up to depth beats between a stream master and slave,
+ * accepting and forwarding one beat per cycle.  In packet mode, a packet is
+ * held back until its last beat has arrived, so the downstream block sees it
+ * without bubbles; a packet longer than the FIFO is forwarded as soon as the
+ * FIFO fills, so packet mode cannot deadlock.
+ *
+ * \par Usage Guidelines
+ *
+ * This module sets the stall mode to flush by default to mitigate possible RTL
+ * bugs that can occur in the default stall mode. If you are confident that
+ * this class of bugs will not occur in your use case, you can change the stall
+ * mode via TCL directive:
+ *
+ * \code
+ * directive set /path/to/AxiStreamFifo/run/while -PIPELINE_STALL_MODE stall
+ * \endcode
+ *
+ * This may reduce area/power.
+ * \par
+ *
+ */
+template <typename Cfg, int depth = 16, bool packetMode = false>
+class AxiStreamFifo : public sc_module {
+  typedef axi::axi4_stream<Cfg> axis_;
+  typedef NVUINTW(nvhls::nbits<depth>::val) Count;
+
+  static_assert(!packetMode || Cfg::useLast, "Packet mode requires a stream config with TLAST");
+
+ public:
+  sc_in<bool> clk;
+  sc_in<bool> reset_bar;
+
+  typename axis_::template slave<> axis_in;
+  typename axis_::template master<> axis_out;
+
+  SC_CTOR(AxiStreamFifo)
+      : clk("clk"), reset_bar("reset_bar"), axis_in("axis_in"), axis_out("axis_out") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+  }
+
+ protected:
+  void run() {
+    axis_in.reset();
+    axis_out.reset();
+
+    FIFO<typename axis_::Payload, depth> fifo;
+    fifo.reset();
+    Count packets = 0;  // beats with TLAST in the FIFO
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while (1) {
+      wait();
+
+      bool full = fifo.isFull();
+      bool out_last = false;
+      bool in_last = false;
+
+      if (!fifo.isEmpty() && (!packetMode || packets != 0 || full)) {
+        typename axis_::Payload beat = fifo.peek();
+        if (axis_out.nb_write(beat)) {
+          fifo.incrHead();
+          out_last = axis_::LastOf(beat);
+        }
+      }
+
+      if (!full) {
+        typename axis_::Payload beat;
+        if (axis_in.nb_read(beat)) {
+          fifo.push(beat);
+          in_last = axis_::LastOf(beat);
+        }
+      }
+
+      if (packetMode) {
+        if (in_last && !out_last) {
+          ++packets;
+        } else if (out_last && !in_last) {
+          --packets;
+        }
+      }
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __AXISTREAMWIDTHCONVERTER_H__
+#define __AXISTREAMWIDTHCONVERTER_H__
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+#include <nvhls_int.h>
+#include <axi/axi4_stream.h>
+
+/**
+ * \brief A data-width converter between two AXI4-Stream configs.
+ * \ingroup AXI
+ *
+ * \tparam CfgIn      A valid AXI4-Stream config describing the input.
+ * \tparam CfgOut     A valid AXI4-Stream config describing the output.
+ * \tparam upsize     Selects the implementation; leave at its default.
+ *
+ * \par Overview
+ * The two data widths must differ by a power-of-two ratio, and TID, TDEST and
+ * TUSER must have the same widths on both sides.
+ *
+ * - Upsizing packs ratio consecutive input beats into one output beat, lowest
+ *   byte lanes first.  A beat with TLAST closes the output beat early; the
+ *   unused lanes have TKEEP cleared.  TID, TDEST and TUSER are taken from the
+ *   last packed beat, so packets with different TID/TDEST must not share an
+ *   output beat (i.e. each packet must end with TLAST).
+ * - Downsizing splits each input beat into up to ratio output beats.  Output
+ *   beats with no kept bytes are dropped, and TLAST moves to the last output
+ *   beat that carries data, so a short final beat takes fewer cycles.  An input
+ *   beat with no kept bytes at all is still forwarded as one null beat.
+ *
+ * The narrow side transfers one beat per cycle.
+ *
+ * \par Usage Guidelines
+ *
+ * This module sets the stall mode to flush by default to mitigate possible RTL
+ * bugs that can occur in the default stall mode. If you are confident that
+ * this class of bugs will not occur in your use case, you can change the stall
+ * mode via TCL directive:
+ *
+ * \code
+ * directive set /path/to/AxiStreamWidthConverter/run/while -PIPELINE_STALL_MODE stall
+ * \endcode
+ *
+ * This may reduce area/power.
+ * \par
+ *
+ */
+template <typename CfgIn, typename CfgOut,
+          bool upsize = (CfgOut::dataWidth > CfgIn::dataWidth)>
+class AxiStreamWidthConverter;
+
+/**
+ * \brief Upsizing implementation of AxiStreamWidthConverter.
+ * \ingroup AXI
+ */
+template <typename CfgIn, typename CfgOut>
+class AxiStreamWidthConverter<CfgIn, CfgOut, true> : public sc_module {
+  typedef axi::axi4_stream<CfgIn> axisIn;
+  typedef axi::axi4_stream<CfgOut> axisOut;
+
+  static const int ratio = CfgOut::dataWidth / CfgIn::dataWidth;
+  static const int log_ratio = nvhls::log2_ceil<ratio>::val;
+  typedef NVUINTW(log_ratio) Lane;
+
+  static_assert(ratio >= 2 && (ratio & (ratio - 1)) == 0 && ratio * CfgIn::dataWidth == CfgOut::dataWidth,
+                "The data widths must differ by a power-of-two ratio");
+  static_assert(CfgOut::useKeep || !(CfgIn::useKeep || CfgIn::useLast),
+                "Packets that end inside an output beat need TKEEP on the output");
+  static_assert(CfgIn::idWidth == CfgOut::idWidth && CfgIn::destWidth == CfgOut::destWidth &&
+                CfgIn::userWidth == CfgOut::userWidth,
+                "TID, TDEST and TUSER widths must match");
+
+ public:
+  sc_in<bool> clk;
+  sc_in<bool> reset_bar;
+
+  typename axisIn::template slave<> axis_in;
+  typename axisOut::template master<> axis_out;
+
+  SC_CTOR(AxiStreamWidthConverter)
+      : clk("clk"), reset_bar("reset_bar"), axis_in("axis_in"), axis_out("axis_out") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+  }
+
+ protected:
+  void run() {
+    axis_in.reset();
+    axis_out.reset();
+
+    typename axisOut::Payload out;
+    typename axisOut::Bytes keep = 0;
+    bool out_valid = false;
+    Lane lane = 0;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while (1) {
+      wait();
+
+      if (!out_valid) {
+        typename axisIn::Payload in;
+        if (axis_in.nb_read(in)) {
+          bool last = axisIn::LastOf(in);
+          out.data = nvhls::set_slc(out.data, in.data, lane * CfgIn::dataWidth);
+          keep = nvhls::set_slc(keep, axisIn::KeepOf(in), lane * axisIn::BYTES_PER_BEAT);
+          out.id = in.id;
+          out.dest = in.dest;
+          out.user = in.user;
+          if (lane == ratio - 1 || last) {
+            out.keep = keep;
+            out.last = last;
+            out_valid = true;
+            lane = 0;
+          } else {
+            ++lane;
+          }
+        }
+      }
+
+      if (out_valid) {
+        if (axis_out.nb_write(out)) {
+          out_valid = false;
+          keep = 0;
+        }
+      }
+    }
+  }
+};
+
+/**
+ * \brief Downsizing implementation of AxiStreamWidthConverter.
+ * \ingroup AXI
+ */
+template <typename CfgIn, typename CfgOut>
+class AxiStreamWidthConverter<CfgIn, CfgOut, false> : public sc_module {
+  typedef axi::axi4_stream<CfgIn> axisIn;
+  typedef axi::axi4_stream<CfgOut> axisOut;
+
+  static const int ratio = CfgIn::dataWidth / CfgOut::dataWidth;
+  static const int log_ratio = nvhls::log2_ceil<ratio>::val;
+  typedef NVUINTW(log_ratio) Lane;
+  typedef NVUINTW(ratio) LaneMask;
+
+  static_assert(ratio >= 2 && (ratio & (ratio - 1)) == 0 && ratio * CfgOut::dataWidth == CfgIn::dataWidth,
+                "The data widths must differ by a power-of-two ratio");
+  static_assert(CfgOut::useKeep || !CfgIn::useKeep,
+                "Null bytes on the input need TKEEP on the output");
+  static_assert(CfgIn::idWidth == CfgOut::idWidth && CfgIn::destWidth == CfgOut::destWidth &&
+                CfgIn::userWidth == CfgOut::userWidth,
+                "TID, TDEST and TUSER widths must match");
+
+ public:
+  sc_in<bool> clk;
+  sc_in<bool> reset_bar;
+
+  typename axisIn::template slave<> axis_in;
+  typename axisOut::template master<> axis_out;
+
+  SC_CTOR(AxiStreamWidthConverter)
+      : clk("clk"), reset_bar("reset_bar"), axis_in("axis_in"), axis_out("axis_out") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+  }
+
+ protected:
+  void run() {
+    axis_in.reset();
+    axis_out.reset();
+
+    typename axisIn::Payload in;
+    typename axisIn::Bytes keep = 0;
+    LaneMask lanes = 0;       // lanes of the input beat with kept bytes
+    bool in_valid = false;
+    bool in_last = false;
+    Lane lane = 0;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while (1) {
+      wait();
+
+      if (!in_valid) {
+        if (axis_in.nb_read(in)) {
+          in_valid = true;
+          in_last = axisIn::LastOf(in);
+          keep = axisIn::KeepOf(in);
+          #pragma hls_unroll yes
+          for (int i = 0; i < ratio; i++) {
+            lanes[i] = (nvhls::get_slc<axisOut::BYTES_PER_BEAT>(keep, i * axisOut::BYTES_PER_BEAT) != 0);
+          }
+          lane = 0;
+        }
+      }
+
+      if (in_valid) {
+        // No kept bytes above this lane: this is the last output beat of the input beat
+        bool rest_empty = (lane == ratio - 1);
+        LaneMask above = lanes >> 1;
+        #pragma hls_unroll yes
+        for (int i = 0; i < ratio - 1; i++) {
+          if (i == lane) {
+            rest_empty = (above == 0);
+          }
+          above >>= 1;
+        }
+        typename axisOut::Bytes sub_keep =
+            nvhls::get_slc<axisOut::BYTES_PER_BEAT>(keep, lane * axisOut::BYTES_PER_BEAT);
+
+        bool sent = true;
+        if (sub_keep != 0 || rest_empty) {
+          typename axisOut::Payload out;
+          out.data = nvhls::get_slc<CfgOut::dataWidth>(in.data, lane * CfgOut::dataWidth);
+          out.keep = sub_keep;
+          out.last = in_last && rest_empty;
+          out.id = in.id;
+          out.dest = in.dest;
+          out.user = in.user;
+          sent = axis_out.nb_write(out);
+        }
+        if (sent) {
+          if (rest_empty) {
+            in_valid = false;
+          } else {
+            ++lane;
+          }
+        }
+      }
+    }
+  }
+};
+
+#endif
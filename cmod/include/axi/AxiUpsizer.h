@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __AXIUPSIZER_H__
+#define __AXIUPSIZER_H__
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_assert.h>
+#include <nvhls_int.h>
+#include <axi/axi4.h>
+#include <fifo.h>
+
+/**
+ * \brief A data-width converter from a narrow AXI master to a wide AXI slave.
+ * \ingroup AXI
+ *
+ * \tparam CfgMaster          A valid AXI config describing the (narrow) master port.
+ * \tparam CfgSlave           A valid AXI config describing the (wide) slave port.
+ * \tparam maxOutstanding     The number of requests per channel that may be awaiting data. (default: 8)
+ *
+ * \par Overview
+ * AxiUpsizer connects an AXI master to a slave whose data bus is a power-of-two
+ * multiple of the master's data bus.  Each master burst is issued as one slave
+ * burst covering the same bytes: the address is aligned down to the slave data
+ * width and the length is reduced by up to ratio = CfgSlave::dataWidth /
+ * CfgMaster::dataWidth.  Consecutive master write beats are packed into the byte
+ * lanes of a slave beat, with the write strobes of unused lanes cleared, so a
+ * burst that starts or ends in the middle of a slave beat only writes the bytes
+ * of the original request.  Read beats are unpacked starting from the lane of
+ * the original address.  Write responses are passed through unchanged.
+ *
+ * Each channel moves one master beat per cycle, so the narrow port runs at full
+ * throughput while the wide port carries 1/ratio as many beats.
+ *
+ * - Apart from the data width and maximum burst length, the two AXI configs must otherwise be the same.
+ * - Both configs must use bursts and write strobes.
+ * - Requests must be INCR bursts of full-width beats aligned to the master data width.
+ * - The slave must return read data in request order (e.g. all requests use one ID).
+ *
+ * \par Usage Guidelines
+ *
+ * This module sets the stall mode to flush by default to mitigate possible RTL
+ * bugs that can occur in the default stall mode. If you are confident that
+ * this class of bugs will not occur in your use case, you can change the stall
+ * mode via TCL directive:
+ *
+ * \code
+ * directive set /path/to/AxiUpsizer/axi_read_ar/while -PIPELINE_STALL_MODE stall
+ * \endcode
+ *
+ * This may reduce area/power.
+ * \par
+ */
+template <typename CfgMaster, typename CfgSlave, int maxOutstanding = 8>
+class AxiUpsizer : public sc_module {
+  SC_HAS_PROCESS(AxiUpsizer);
+  // Local typedefs and derived constants
+  typedef axi::axi4<CfgMaster> axiM;
+  typedef axi::axi4<CfgSlave> axiS;
+
+  static const int ratio = CfgSlave::dataWidth / CfgMaster::dataWidth;
+  static const int log_ratio = nvhls::log2_ceil<ratio>::val;
+  static const int bytesM = CfgMaster::dataWidth >> 3;
+  static const int bytesS = CfgSlave::dataWidth >> 3;
+  static const int log_bytesM = nvhls::log2_ceil<bytesM>::val;
+  static const int log_bytesS = nvhls::log2_ceil<bytesS>::val;
+
+  static_assert(ratio >= 2 && (ratio & (ratio - 1)) == 0,
+                "The slave data width must be a power-of-two multiple of the master data width");
+  static_assert(CfgMaster::useBurst && CfgSlave::useBurst, "AxiUpsizer requires AXI configs with bursts");
+  static_assert(CfgMaster::useWriteStrobes && CfgSlave::useWriteStrobes,
+                "AxiUpsizer requires AXI configs with write strobes");
+  static_assert(CfgSlave::maxBurstSize * ratio >= CfgMaster::maxBurstSize + ratio - 1,
+                "The slave maxBurstSize is too small for the longest master burst");
+  static_assert(CfgMaster::addrWidth == CfgSlave::addrWidth && CfgMaster::idWidth == CfgSlave::idWidth,
+                "Address and ID widths must match");
+  static_assert(CfgMaster::useWriteResponses == CfgSlave::useWriteResponses,
+                "Both configs must agree on write responses");
+
+  typedef NVUINTW(log_ratio) Lane;
+  // Request context for the data threads: {len, starting lane}
+  typedef NVUINTW(axiM::ALEN_WIDTH + log_ratio) Ctx;
+
+ public:
+  // External interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+
+  typename axiM::read::template slave<> axiM_read;
+  typename axiM::write::template slave<> axiM_write;
+  typename axiS::read::template master<> axiS_read;
+  typename axiS::write::template master<> axiS_write;
+
+ private:
+  Connections::Combinational<Ctx> rd_ctx;
+  Connections::Combinational<Ctx> wr_ctx;
+
+ public:
+  // Constructor
+  AxiUpsizer(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        rst("rst"),
+        axiM_read("axiM_read"),
+        axiM_write("axiM_write"),
+        axiS_read("axiS_read"),
+        axiS_write("axiS_write"),
+        rd_ctx("rd_ctx"),
+        wr_ctx("wr_ctx")
+  {
+    SC_THREAD(axi_read_ar);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    SC_THREAD(axi_read_r);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    SC_THREAD(axi_write_aw);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    SC_THREAD(axi_write_w);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    SC_THREAD(axi_write_b);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+ private:
+  // Converts a master request into the slave request covering the same bytes
+  static typename axiS::AddrPayload Widen(const typename axiM::AddrPayload& req, Ctx& ctx) {
+    NVHLS_ASSERT_MSG(nvhls::get_slc<log_bytesM>(req.addr, 0) == 0,
+                     "AxiUpsizer requires addresses aligned to the master data width");
+    NVHLS_ASSERT_MSG(!CfgMaster::useVariableBeatSize || req.size.to_uint64() == log_bytesM,
+                     "AxiUpsizer requires full-width beats");
+    NVHLS_ASSERT_MSG(axiM::BURST_WIDTH == 0 || req.burst.to_uint64() == axiM::Enc::AXBURST::INCR,
+                     "AxiUpsizer only supports INCR bursts");
+
+    Lane lane = nvhls::get_slc<log_ratio>(req.addr, log_bytesM);
+    typename axiS::AddrPayload out;
+    out.id = req.id;
+    out.addr = (req.addr >> log_bytesS) << log_bytesS;
+    out.len = (lane + req.len) >> log_ratio;
+    out.size = log_bytesS;
+    out.burst = axiS::Enc::AXBURST::INCR;
+    out.cache = req.cache;
+    out.qos = req.qos;
+    out.auser = req.auser;
+    ctx = (static_cast<Ctx>(req.len) << log_ratio) | lane;
+    return out;
+  }
+
+  void axi_read_ar() {
+    axiM_read.ar.Reset();
+    axiS_read.ar.Reset();
+    rd_ctx.ResetWrite();
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while(1) {
+      wait();
+      typename axiM::AddrPayload AR;
+      if (axiM_read.ar.PopNB(AR)) {
+        Ctx ctx;
+        typename axiS::AddrPayload out = Widen(AR, ctx);
+        rd_ctx.Push(ctx);
+        axiS_read.ar.Push(out);
+      }
+    }
+  }
+
+  void axi_read_r() {
+    axiM_read.r.Reset();
+    axiS_read.r.Reset();
+    rd_ctx.ResetRead();
+
+    FIFO<Ctx, maxOutstanding> ctxQ;
+    ctxQ.reset();
+    typename axiS::ReadPayload Rs;
+    bool r_valid = false;
+    bool active = false;
+    Lane lane = 0;
+    typename axiM::BeatNum len = 0;
+    typename axiM::BeatNum beat = 0;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while(1) {
+      wait();
+      if (!active && !ctxQ.isEmpty()) {
+        Ctx ctx = ctxQ.pop();
+        lane = nvhls::get_slc<log_ratio>(ctx, 0);
+        len = ctx >> log_ratio;
+        beat = 0;
+        active = true;
+      }
+      if (!r_valid) {
+        r_valid = axiS_read.r.PopNB(Rs);
+      }
+      if (active && r_valid) {
+        bool last = (beat == len);
+        typename axiM::ReadPayload R;
+        R.data = nvhls::get_slc<CfgMaster::dataWidth>(Rs.data, lane * CfgMaster::dataWidth);
+        R.id = Rs.id;
+        R.resp = Rs.resp;
+        R.last = last;
+        R.ruser = Rs.ruser;
+        if (axiM_read.r.PushNB(R)) {
+          if (lane == ratio - 1 || last) {
+            r_valid = false;
+          }
+          ++lane;
+          ++beat;
+          active = !last;
+        }
+      }
+      if (!ctxQ.isFull()) {
+        Ctx ctx;
+        if (rd_ctx.PopNB(ctx)) {
+          ctxQ.push(ctx);
+        }
+      }
+    }
+  }
+
+  void axi_write_aw() {
+    axiM_write.aw.Reset();
+    axiS_write.aw.Reset();
+    wr_ctx.ResetWrite();
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while(1) {
+      wait();
+      typename axiM::AddrPayload AW;
+      if (axiM_write.aw.PopNB(AW)) {
+        Ctx ctx;
+        typename axiS::AddrPayload out = Widen(AW, ctx);
+        wr_ctx.Push(ctx);
+        axiS_write.aw.Push(out);
+      }
+    }
+  }
+
+  void axi_write_w() {
+    axiM_write.w.Reset();
+    axiS_write.w.Reset();
+    wr_ctx.ResetRead();
+
+    FIFO<Ctx, maxOutstanding> ctxQ;
+    ctxQ.reset();
+    typename axiS::WritePayload Ws;
+    Ws.wstrb = 0;
+    bool active = false;
+    Lane lane = 0;
+    typename axiM::BeatNum len = 0;
+    typename axiM::BeatNum beat = 0;
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while(1) {
+      wait();
+      if (!active && !ctxQ.isEmpty()) {
+        Ctx ctx = ctxQ.pop();
+        lane = nvhls::get_slc<log_ratio>(ctx, 0);
+        len = ctx >> log_ratio;
+        beat = 0;
+        active = true;
+      }
+      if (active) {
+        typename axiM::WritePayload W;
+        if (axiM_write.w.PopNB(W)) {
+          bool last = (beat == len);
+          Ws.data = nvhls::set_slc(Ws.data, W.data, lane * CfgMaster::dataWidth);
+          Ws.wstrb = nvhls::set_slc(Ws.wstrb, W.wstrb, lane * bytesM);
+          Ws.wuser = W.wuser;
+          if (lane == ratio - 1 || last) {
+            Ws.last = last;
+            axiS_write.w.Push(Ws);
+            Ws.wstrb = 0;
+          }
+          ++lane;
+          ++beat;
+          active = !last;
+        }
+      }
+      if (!ctxQ.isFull()) {
+        Ctx ctx;
+        if (wr_ctx.PopNB(ctx)) {
+          ctxQ.push(ctx);
+        }
+      }
+    }
+  }
+
+  void axi_write_b() {
+    axiM_write.b.Reset();
+    axiS_write.b.Reset();
+
+    #pragma hls_pipeline_init_interval 1
+    #pragma pipeline_stall_mode flush
+    while(1) {
+      wait();
+      typename axiS::WRespPayload Bs;
+      if (axiS_write.b.PopNB(Bs)) {
+        typename axiM::WRespPayload B;
+        B.id = Bs.id;
+        B.resp = Bs.resp;
+        B.buser = Bs.buser;
+        axiM_write.b.Push(B);
+      }
+    }
+  }
+};
+
+#endif
@@ -69,6 +69,7 @@ class axi4 {
     ASIZE_WIDTH = (Cfg::useVariableBeatSize != 0 ? 3 : 0),
     LAST_WIDTH = (Cfg::useLast != 0 ? 1 : 0),
     CACHE_WIDTH = (Cfg::useCache != 0 ? Enc::ARCACHE::_WIDTH : 0),
+    QOS_WIDTH = (Cfg::useQoS != 0 ? Enc::AXQOS::_WIDTH : 0),
     BURST_WIDTH = ((Cfg::useBurst != 0 &&
                     (Cfg::useFixedBurst != 0 || Cfg::useWrapBurst != 0))
                        ? Enc::AXBURST::_WIDTH
@@ -94,6 +95,7 @@ class axi4 {
   typedef typename nvhls::UIntOrEmpty<LAST_WIDTH>::T Last;
   typedef typename nvhls::UIntOrEmpty<WSTRB_WIDTH>::T Wstrb;
   typedef typename nvhls::UIntOrEmpty<CACHE_WIDTH>::T Cache;
+  typedef typename nvhls::UIntOrEmpty<QOS_WIDTH>::T Qos;
   typedef typename nvhls::UIntOrEmpty<BURST_WIDTH>::T Burst;
   typedef NVUINTW(RESP_WIDTH) Resp;
 
@@ -112,11 +114,12 @@ class axi4 {
     BeatNum len;    // A*LEN
     BeatSize size;  // A*SIZE
     Cache cache;
+    Qos qos;        // A*QOS, higher is more urgent
     AUser auser;
 
     static const unsigned int width = ADDR_WIDTH + ID_WIDTH + ALEN_WIDTH +
                                       ASIZE_WIDTH + BURST_WIDTH + CACHE_WIDTH +
-                                      AUSER_WIDTH;
+                                      QOS_WIDTH + AUSER_WIDTH;
 
    AddrPayload() {
      if(ID_WIDTH > 0)
@@ -127,9 +130,11 @@ class axi4 {
      if(ASIZE_WIDTH > 0)
        size = 0;
      if(BURST_WIDTH > 0)
-       burst = 0;
+       burst = Enc::AXBURST::INCR;
      if(CACHE_WIDTH > 0)
        cache = 0;
+     if(QOS_WIDTH > 0)
+       qos = 0;
      if(AUSER_WIDTH > 0)
        auser = 0;
     }
@@ -142,6 +147,7 @@ class axi4 {
       m &size;
       m &burst;
       m &cache;
+      m &qos;
       m &auser;
     }
 
@@ -166,6 +172,8 @@ class axi4 {
         os << dec << "burst:" << rhs.burst << " ";
       if (CACHE_WIDTH > 0)
         os << dec << "cache:" << rhs.cache << " ";
+      if (QOS_WIDTH > 0)
+        os << dec << "qos:" << rhs.qos << " ";
       if (AUSER_WIDTH > 0)
         os << hex << "auser:" << rhs.auser << " ";
       return os;
@@ -325,6 +333,55 @@ class axi4 {
     }
   };
 
+  /**
+   * \brief The byte-offset mask of the wrap window of a WRAP burst.
+   *
+   * A WRAP burst of len+1 full-width beats wraps within (len+1) data words
+   * aligned to that size; len must be 1, 3, 7 or 15.
+   */
+  static Addr WrapMask(AddrPayload req) {
+    return (static_cast<Addr>(req.len.to_uint64()) << nvhls::log2_ceil<(DATA_WIDTH >> 3)>::val) |
+           static_cast<Addr>((DATA_WIDTH >> 3) - 1);
+  }
+
+  /**
+   * \brief The address of beat number beat (counting from 0) of the burst req.
+   *
+   * Beats are full data words.  FIXED bursts (if Cfg::useFixedBurst) repeat the
+   * start address, WRAP bursts (if Cfg::useWrapBurst) wrap within WrapMask(req),
+   * and every other request, including those of configs without a burst field,
+   * is treated as INCR.
+   */
+  template <typename T>
+  static Addr BeatAddr(AddrPayload req, T beat) {
+    Addr offset = static_cast<Addr>(beat) << nvhls::log2_ceil<(DATA_WIDTH >> 3)>::val;
+    if (Cfg::useFixedBurst && BURST_WIDTH > 0 && req.burst.to_uint64() == Enc::AXBURST::FIXED) {
+      return req.addr;
+    } else if (Cfg::useWrapBurst && BURST_WIDTH > 0 && req.burst.to_uint64() == Enc::AXBURST::WRAP) {
+      Addr mask = WrapMask(req);
+      return (req.addr & ~mask) | ((req.addr + offset) & mask);
+    } else {
+      return req.addr + offset;
+    }
+  }
+
+  /**
+   * \brief The address of the beat that follows the beat at addr in the burst req.
+   *
+   * Same burst handling as BeatAddr(), for slaves that track the current beat
+   * address rather than a beat count.
+   */
+  static Addr NextBeatAddr(AddrPayload req, Addr addr) {
+    if (Cfg::useFixedBurst && BURST_WIDTH > 0 && req.burst.to_uint64() == Enc::AXBURST::FIXED) {
+      return addr;
+    } else if (Cfg::useWrapBurst && BURST_WIDTH > 0 && req.burst.to_uint64() == Enc::AXBURST::WRAP) {
+      Addr mask = WrapMask(req);
+      return (addr & ~mask) | ((addr + (DATA_WIDTH >> 3)) & mask);
+    } else {
+      return addr + (DATA_WIDTH >> 3);
+    }
+  }
+
   /**
    * \brief The AXI read class.
    *
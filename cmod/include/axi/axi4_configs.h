@@ -36,6 +36,7 @@ namespace axi {
  * - useBurst: Set to 1 if bursts are supported, 0 otherwise
  * - useFixedBurst: Set to 1 if fixed-type bursts are supported, 0 otherwise.
  * - useWrapBurst: Set to 1 if wrap-type bursts are supported, 0 otherwise.
+ * If either is set, requests carry an AxBURST field, which defaults to INCR.
  * - maxBurstSize: The maximum burst length.
  * - useQoS: Set to 1 if the QoS field is supported, 0 otherwise.
  * - useLock: Set to 1 if the Lock field is supported, 0 otherwise.
@@ -104,6 +105,24 @@ struct no_wstrb {
     useWriteResponses = 1,
   };
 };
+/**
+ * \brief A standard AXI configuration that also supports FIXED and WRAP bursts.
+ */
+struct all_bursts {
+  enum {
+    dataWidth = 64,
+    useVariableBeatSize = 0,
+    useMisalignedAddresses = 0,
+    useLast = 1,
+    useWriteStrobes = 1,
+    useBurst = 1, useFixedBurst = 1, useWrapBurst = 1, maxBurstSize = 256,
+    useQoS = 0, useLock = 0, useProt = 0, useCache = 0, useRegion = 0,
+    aUserWidth = 0, wUserWidth = 0, bUserWidth = 0, rUserWidth = 0,
+    addrWidth = 32,
+    idWidth = 4,
+    useWriteResponses = 1,
+  };
+};
 /**
  * \brief An AXI configuration corresponding to the AXI4-Lite standard.
  */
@@ -89,6 +89,19 @@ class AXI4_Encoding {
     };
   };
 
+  /**
+  * \brief Hardcoded values shared by the ARQOS and AWQOS fields.
+  */
+  class AXQOS {
+   public:
+    enum {
+      _WIDTH = 4,  // bits
+
+      LOWEST = 0,
+      HIGHEST = 15,
+    };
+  };
+
   /**
   * \brief Hardcoded values shared by the RRESP and BRESP fields.
   */
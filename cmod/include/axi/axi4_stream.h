@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _AXI_AXI4_STREAM_H_
+#define _AXI_AXI4_STREAM_H_
+
+#include <systemc>
+#include <nvhls_connections.h>
+#include <nvhls_message.h>
+#include <nvhls_module.h>
+#include <UIntOrEmpty.h>
+
+namespace axi {
+
+namespace cfg {
+
+/**
+ * \brief Examples of valid AXI4-Stream configs.
+ * \ingroup AXI
+ *
+ * \par  An AXI4-Stream config consists of a struct with an enum defining the following constants:
+ * - dataWidth: The bitwidth of TDATA, a multiple of 8.
+ * - useKeep: Set to 1 if TKEEP is used, 0 if every byte of every beat is valid.
+ * - useLast: Set to 1 if TLAST is used, 0 otherwise.
+ * - idWidth: The bitwidth of TID.
+ * - destWidth: The bitwidth of TDEST.
+ * - userWidth: The bitwidth of TUSER.
+ */
+struct stream {
+  enum {
+    dataWidth = 64,
+    useKeep = 1,
+    useLast = 1,
+    idWidth = 0,
+    destWidth = 0,
+    userWidth = 0,
+  };
+};
+/**
+ * \brief A 32-bit AXI4-Stream configuration.
+ */
+struct stream_narrow {
+  enum {
+    dataWidth = 32,
+    useKeep = 1,
+    useLast = 1,
+    idWidth = 0,
+    destWidth = 0,
+    userWidth = 0,
+  };
+};
+}; // namespace cfg
+
+/**
+ * \brief The base axi4_stream class parameterized according a valid config.
+ * \ingroup AXI
+ *
+ * \tparam Cfg        A valid AXI4-Stream config.
+ *
+ * \par Overview
+ * axi4_stream defines the AXI4-Stream channel: a single ready-valid interface
+ * from master to slave carrying TDATA and the optional TKEEP, TLAST, TID, TDEST
+ * and TUSER signals.  As in axi4, each signal is a UIntOrEmpty of the width
+ * given by the config, so unused signals take no wires.  Streams have no
+ * address phase, so every cycle of the channel carries payload data.
+ *
+ * - TKEEP marks the valid bytes of a beat; without it all bytes are valid.
+ * - TSTRB (position bytes) is not modeled.
+ *
+ */
+template <typename Cfg>
+class axi4_stream {
+ public:
+  enum {
+    DATA_WIDTH = Cfg::dataWidth,
+    KEEP_WIDTH = (Cfg::useKeep != 0 ? (DATA_WIDTH >> 3) : 0),
+    LAST_WIDTH = (Cfg::useLast != 0 ? 1 : 0),
+    ID_WIDTH = Cfg::idWidth,
+    DEST_WIDTH = Cfg::destWidth,
+    USER_WIDTH = Cfg::userWidth,
+    BYTES_PER_BEAT = DATA_WIDTH >> 3,
+  };
+
+  typedef NVUINTW(DATA_WIDTH) Data;
+  typedef NVUINTW(BYTES_PER_BEAT) Bytes;
+  typedef typename nvhls::UIntOrEmpty<KEEP_WIDTH>::T Keep;
+  typedef typename nvhls::UIntOrEmpty<LAST_WIDTH>::T Last;
+  typedef typename nvhls::UIntOrEmpty<ID_WIDTH>::T Id;
+  typedef typename nvhls::UIntOrEmpty<DEST_WIDTH>::T Dest;
+  typedef typename nvhls::UIntOrEmpty<USER_WIDTH>::T User;
+
+  /**
+   * \brief A struct composed of the signals of one AXI4-Stream beat.
+   */
+  struct Payload : public nvhls_message {
+    Data data;
+    Keep keep;
+    Last last;
+    Id id;
+    Dest dest;
+    User user;
+
+    static const unsigned int width =
+        DATA_WIDTH + KEEP_WIDTH + LAST_WIDTH + ID_WIDTH + DEST_WIDTH + USER_WIDTH;
+
+    Payload() {
+      data = 0; // NVUINT, DATA_WIDTH always > 0
+      if (KEEP_WIDTH > 0)
+        keep = ~0;
+      if (LAST_WIDTH > 0)
+        last = 0;
+      if (ID_WIDTH > 0)
+        id = 0;
+      if (DEST_WIDTH > 0)
+        dest = 0;
+      if (USER_WIDTH > 0)
+        user = 0;
+    }
+
+    template <unsigned int Size>
+    void Marshall(Marshaller<Size> &m) {
+      m &data;
+      m &keep;
+      m &last;
+      m &id;
+      m &dest;
+      m &user;
+    }
+
+#ifdef CONNECTIONS_SIM_ONLY
+    inline friend void sc_trace(sc_trace_file *tf, const Payload& v, const std::string& NAME ) {
+      sc_trace(tf,v.data,  NAME + ".data");
+      sc_trace(tf,v.keep,  NAME + ".keep");
+      sc_trace(tf,v.last,  NAME + ".last");
+    }
+#endif
+
+    inline friend std::ostream& operator<<(ostream& os, const Payload& rhs)
+    {
+      os << hex << "data:" << rhs.data << " ";
+      if (KEEP_WIDTH > 0)
+        os << hex << "keep:" << rhs.keep << " ";
+      if (LAST_WIDTH > 0)
+        os << dec << "last:" << rhs.last << " ";
+      if (ID_WIDTH > 0)
+        os << dec << "id:" << rhs.id << " ";
+      if (DEST_WIDTH > 0)
+        os << dec << "dest:" << rhs.dest << " ";
+      if (USER_WIDTH > 0)
+        os << hex << "user:" << rhs.user << " ";
+      return os;
+    }
+  };
+
+  /**
+   * \brief The byte-valid mask of a beat: TKEEP, or all ones without TKEEP.
+   */
+  static Bytes KeepOf(const Payload& p) { return KeepBits(p.keep); }
+
+  /**
+   * \brief TLAST of a beat, or false without TLAST.
+   */
+  static bool LastOf(const Payload& p) { return LastBit(p.last); }
+
+  /**
+   * \brief The AXI4-Stream channel, used for connecting a stream master and slave.
+   */
+  template <Connections::connections_port_t PortType = AUTO_PORT>
+  class chan {
+   public:
+    typedef Connections::Combinational<Payload, PortType> TChan;
+
+    TChan t;  // master to slave
+
+    chan(const char *name) : t(nvhls_concat(name, "_t")) {};
+  }; // chan
+
+  /**
+   * \brief The AXI4-Stream master port.
+   */
+  template <Connections::connections_port_t PortType = AUTO_PORT>
+  class master {
+   public:
+    typedef Connections::Out<Payload, PortType> TPort;
+
+    TPort t;
+
+    master(const char *name) : t(nvhls_concat(name, "_t")) {}
+
+    void reset() { t.Reset(); }
+
+    void write(const Payload &p) { t.Push(p); }
+
+    bool nb_write(const Payload &p) { return t.PushNB(p); }
+
+    template <class C>
+    void operator()(C &c) {
+      t(c.t);
+    }
+  }; // master
+
+  /**
+   * \brief The AXI4-Stream slave port.
+   */
+  template <Connections::connections_port_t PortType = AUTO_PORT>
+  class slave {
+   public:
+    typedef Connections::In<Payload, PortType> TPort;
+
+    TPort t;
+
+    slave(const char *name) : t(nvhls_concat(name, "_t")) {}
+
+    void reset() { t.Reset(); }
+
+    Payload read() { return t.Pop(); }
+
+    bool nb_read(Payload &p) { return t.PopNB(p); }
+
+    template <class C>
+    void operator()(C &c) {
+      t(c.t);
+    }
+  }; // slave
+
+ private:
+  static Bytes KeepBits(const Bytes& keep) { return keep; }
+  static Bytes KeepBits(const nvhls::EmptyField&) { return ~Bytes(0); }
+  static bool LastBit(const NVUINTW(1)& last) { return last == 1; }
+  static bool LastBit(const nvhls::EmptyField&) { return false; }
+}; // axi4_stream
+}; // axi
+
+#endif
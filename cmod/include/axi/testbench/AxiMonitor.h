@@ -0,0 +1,418 @@
+/*
+ * Copyright (c) 2017-2020, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __AXI_T_MONITOR__
+#define __AXI_T_MONITOR__
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+
+#include <axi/axi4.h>
+#include <nvhls_connections.h>
+#include <hls_globals.h>
+#include <axi/testbench/SparseMem.h>
+#include <axi/testbench/TraceReader.h>
+
+#include <deque>
+#include <map>
+#include <string>
+#include <fstream>
+#include <iomanip>
+#include <boost/assert.hpp>
+
+/**
+ * \brief An AXI monitor that records the traffic between a master and a slave as a replayable trace.
+ * \ingroup AXI
+ *
+ * \tparam axiCfg                   A valid AXI config.
+ *
+ * \par Overview
+ * AxiMonitor is placed between an AXI master and an AXI slave in a testbench.  It forwards every AR, AW, W, R and
+ * B beat unchanged and in order.  Each channel goes through its own one-entry register, which adds one cycle of
+ * latency and does not reduce throughput.  Beat handshakes are timestamped in cycles since reset when the master
+ * side accepts them.
+ *
+ * The monitor writes a binary trace (see TraceReader) with one record per beat.  Records are in the order the
+ * transactions were issued on AR and AW:
+ * - 'W' records hold the address and data of each write beat.  Partial strobes are merged with the bytes seen so far
+ *   on this port, so replaying the beat with all strobes set writes the same memory state.
+ * - 'R' records hold the address and the data returned for each read beat.
+ * - 'M' records hold the data of beats read from addresses that were not written before, i.e. the initial memory
+ *   contents.
+ * The delay of the first beat of a transaction is the number of cycles since the previous transaction was issued;
+ * later beats have delay 0.  MasterFromFile replays the 'R' and 'W' records and SlaveFromFile preloads the 'M'
+ * records, so the same file drives both sides of a replay.  Replay with one outstanding request issues one beat at a
+ * time, so it reproduces the traffic and the memory contents, not the recorded concurrency.  With a larger
+ * maxOutstanding window, MasterFromFile issues each beat its recorded delay after the previous one while the window has
+ * room.  Each 'R' or 'W' record depends (see TraceRecord) on the last record of the other kind at the same
+ * address, so a windowed replay cannot reorder a read and a write of one address.
+ *
+ * If a beat log file is given, every handshake is also written to it as a CSV line, with hexadecimal fields:
+ * - cycle,AR,id,addr,len and cycle,AW,id,addr,len
+ * - cycle,W,data,wstrb,last
+ * - cycle,R,id,data,resp,last
+ * - cycle,B,id,resp
+ *
+ * \code
+ *      AxiMonitor<axi::cfg::standard> monitor("monitor", "port.bin", "port.csv");
+ *      master.if_rd(m_rd);   monitor.if_rd_m(m_rd);   monitor.if_rd_s(s_rd);   slave.if_rd(s_rd);
+ *      master.if_wr(m_wr);   monitor.if_wr_m(m_wr);   monitor.if_wr_s(s_wr);   slave.if_wr(s_wr);
+ * \endcode
+ * \par
+ *
+ */
+template <typename axiCfg>
+class AxiMonitor : public sc_module {
+ public:
+  static const int kDebugLevel = 0;
+  typedef axi::axi4<axiCfg> axi4_;
+
+  // Master-facing ports
+  typename axi4_::read::template slave<> if_rd_m;
+  typename axi4_::write::template slave<> if_wr_m;
+  // Slave-facing ports
+  typename axi4_::read::template master<> if_rd_s;
+  typename axi4_::write::template master<> if_wr_s;
+
+  sc_in<bool> reset_bar;
+  sc_in<bool> clk;
+
+  static const int bytesPerBeat = axi4_::DATA_WIDTH >> 3;
+
+  SC_HAS_PROCESS(AxiMonitor);
+
+  AxiMonitor(sc_module_name name_, std::string traceFile, std::string beatLogFile = "")
+      : sc_module(name_), if_rd_m("if_rd_m"), if_wr_m("if_wr_m"), if_rd_s("if_rd_s"), if_wr_s("if_wr_s"),
+        reset_bar("reset_bar"), clk("clk"), trace(traceFile, bytesPerBeat), lastIssue(0), numRecords(0),
+        numRequests(0) {
+    BOOST_ASSERT_MSG(trace.IsOpen(), "Could not open the trace file");
+    if (beatLogFile != "") {
+      beatLog.open(beatLogFile.c_str());
+      BOOST_ASSERT_MSG(static_cast<bool>(beatLog), "Could not open the beat log file");
+    }
+
+    SC_THREAD(run_ar);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(run_r);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(run_aw);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(run_w);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(run_b);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+  }
+
+  ~AxiMonitor() {
+    for (unsigned int i = 0; i < pending.size(); i++) {
+      delete pending[i];
+    }
+  }
+
+  // Number of records written to the trace
+  unsigned long NumRecords() const { return numRecords; }
+
+  void Flush() {
+    trace.Flush();
+    if (beatLog.is_open()) beatLog.flush();
+  }
+
+ protected:
+  // A transaction in issue order, with the data of the beats seen so far
+  struct Transaction {
+    bool read;
+    bool complete;
+    unsigned long issue;
+    typename axi4_::AddrPayload pld;
+    std::deque<typename axi4_::Data> data;
+  };
+
+  TraceWriter trace;
+  std::ofstream beatLog;
+  unsigned long lastIssue;
+  unsigned long numRecords;
+  unsigned long numRequests;  // 'R' and 'W' records, as indexed by dependencies
+
+  // Request index and kind of the last 'R' or 'W' record of each address
+  std::map<unsigned long long, std::pair<unsigned long, char> > lastAccess;
+
+  std::deque<Transaction*> pending;                    // Issue order
+  std::map<unsigned long long, std::deque<Transaction*> > reads;  // By ID, awaiting R beats
+  std::deque<Transaction*> writes;                     // AW order, awaiting W beats
+  std::deque<typename axi4_::WritePayload> earlyData;  // W beats ahead of their AW
+
+  // Bytes seen on this port, for merging partial writes; addresses marked valid have been written or read
+  SparseMem<axi4_::ADDR_WIDTH, axi4_::DATA_WIDTH> shadow;
+
+  static unsigned int BeatCount(typename axi4_::AddrPayload pld) {
+    return axiCfg::useBurst ? static_cast<unsigned int>(pld.len.to_uint64()) + 1 : 1;
+  }
+
+  void WriteRecord(char op, unsigned long delay, typename axi4_::Addr addr, typename axi4_::Data data) {
+    TraceRecord rec;
+    rec.delay = delay;
+    rec.op = op;
+    rec.addr = addr.to_uint64();
+    if (op != 'M') {
+      std::map<unsigned long long, std::pair<unsigned long, char> >::iterator it = lastAccess.find(rec.addr);
+      if (it != lastAccess.end() && it->second.second != op) rec.dep = static_cast<long>(it->second.first);
+      lastAccess[rec.addr] = std::make_pair(numRequests++, op);
+    }
+    rec.data.resize(bytesPerBeat);
+    for (int i = 0; i < bytesPerBeat; i++) {
+      rec.data[i] = static_cast<unsigned char>(nvhls::get_slc<8>(data, 8 * i).to_uint64());
+    }
+    trace.Write(rec);
+    numRecords++;
+  }
+
+  // Writes the completed transactions at the head of the issue order
+  void Retire() {
+    while (!pending.empty() && pending.front()->complete) {
+      Transaction* t = pending.front();
+      pending.pop_front();
+      typename axi4_::Addr addr = t->pld.addr;
+      for (unsigned int i = 0; i < t->data.size(); i++) {
+        WriteRecord(t->read ? 'R' : 'W', i == 0 ? t->issue - lastIssue : 0, addr, t->data[i]);
+        addr = axi4_::NextBeatAddr(t->pld, addr);
+      }
+      lastIssue = t->issue;
+      delete t;
+    }
+  }
+
+  void LogHex(unsigned long long v) {
+    beatLog << "," << std::hex << v << std::dec;
+  }
+
+  void LogData(typename axi4_::Data data) {
+    beatLog << "," << std::hex << std::setfill('0');
+    for (int i = bytesPerBeat - 1; i >= 0; i--) {
+      beatLog << std::setw(2) << nvhls::get_slc<8>(data, 8 * i).to_uint64();
+    }
+    beatLog << std::dec << std::setfill(' ');
+  }
+
+  // Applies a W beat to the oldest write that still expects data
+  void WriteBeat(typename axi4_::WritePayload w) {
+    Transaction* t = writes.front();
+    typename axi4_::Addr addr = t->pld.addr;
+    for (unsigned int i = 0; i < t->data.size(); i++) {
+      addr = axi4_::NextBeatAddr(t->pld, addr);
+    }
+    if (axiCfg::useWriteStrobes) {
+      shadow.Write(addr, w.data, w.wstrb);
+    } else {
+      shadow.Write(addr, w.data);
+    }
+    shadow.MarkValid(addr);
+    t->data.push_back(shadow.Read(addr));
+    if (t->data.size() == BeatCount(t->pld)) {
+      NVHLS_ASSERT_MSG(w.last == 1, "WLAST must be set on the last beat of a burst");
+      t->complete = true;
+      writes.pop_front();
+      Retire();
+    }
+  }
+
+  void run_ar() {
+    if_rd_m.ar.Reset();
+    if_rd_s.ar.Reset();
+    unsigned long cycle = 0;
+    typename axi4_::AddrPayload pld;
+    bool full = false;
+
+    #pragma hls_pipeline_init_interval 1
+    while (1) {
+      wait();
+      cycle++;
+      if (full && if_rd_s.ar.PushNB(pld)) {
+        full = false;
+      }
+      if (!full && if_rd_m.ar.PopNB(pld)) {
+        full = true;
+        Transaction* t = new Transaction;
+        t->read = true;
+        t->complete = false;
+        t->issue = cycle;
+        t->pld = pld;
+        pending.push_back(t);
+        reads[pld.id.to_uint64()].push_back(t);
+        if (beatLog.is_open()) {
+          beatLog << cycle << ",AR";
+          LogHex(pld.id.to_uint64());
+          LogHex(pld.addr.to_uint64());
+          LogHex(axiCfg::useBurst ? pld.len.to_uint64() : 0);
+          beatLog << "\n";
+        }
+      }
+    }
+  }
+
+  void run_r() {
+    if_rd_s.r.Reset();
+    if_rd_m.r.Reset();
+    unsigned long cycle = 0;
+    typename axi4_::ReadPayload pld;
+    bool full = false;
+
+    #pragma hls_pipeline_init_interval 1
+    while (1) {
+      wait();
+      cycle++;
+      if (full && if_rd_m.r.PushNB(pld)) {
+        full = false;
+      }
+      if (!full && if_rd_s.r.PopNB(pld)) {
+        full = true;
+        std::deque<Transaction*>& q = reads[pld.id.to_uint64()];
+        NVHLS_ASSERT_MSG(!q.empty(), "Read response without an outstanding read request");
+        Transaction* t = q.front();
+        typename axi4_::Addr addr = t->pld.addr;
+        for (unsigned int i = 0; i < t->data.size(); i++) {
+          addr = axi4_::NextBeatAddr(t->pld, addr);
+        }
+        if (!shadow.IsValid(addr)) {
+          // First access to this address: part of the initial memory contents
+          WriteRecord('M', 0, addr, pld.data);
+          shadow.Write(addr, pld.data);
+          shadow.MarkValid(addr);
+        }
+        t->data.push_back(pld.data);
+        if (t->data.size() == BeatCount(t->pld)) {
+          t->complete = true;
+          q.pop_front();
+          Retire();
+        }
+        if (beatLog.is_open()) {
+          beatLog << cycle << ",R";
+          LogHex(pld.id.to_uint64());
+          LogData(pld.data);
+          LogHex(pld.resp.to_uint64());
+          LogHex(pld.last.to_uint64());
+          beatLog << "\n";
+        }
+      }
+    }
+  }
+
+  void run_aw() {
+    if_wr_m.aw.Reset();
+    if_wr_s.aw.Reset();
+    unsigned long cycle = 0;
+    typename axi4_::AddrPayload pld;
+    bool full = false;
+
+    #pragma hls_pipeline_init_interval 1
+    while (1) {
+      wait();
+      cycle++;
+      if (full && if_wr_s.aw.PushNB(pld)) {
+        full = false;
+      }
+      if (!full && if_wr_m.aw.PopNB(pld)) {
+        full = true;
+        Transaction* t = new Transaction;
+        t->read = false;
+        t->complete = false;
+        t->issue = cycle;
+        t->pld = pld;
+        pending.push_back(t);
+        writes.push_back(t);
+        if (beatLog.is_open()) {
+          beatLog << cycle << ",AW";
+          LogHex(pld.id.to_uint64());
+          LogHex(pld.addr.to_uint64());
+          LogHex(axiCfg::useBurst ? pld.len.to_uint64() : 0);
+          beatLog << "\n";
+        }
+        // Data that arrived ahead of its address
+        while (!earlyData.empty() && !writes.empty()) {
+          WriteBeat(earlyData.front());
+          earlyData.pop_front();
+        }
+      }
+    }
+  }
+
+  void run_w() {
+    if_wr_m.w.Reset();
+    if_wr_s.w.Reset();
+    unsigned long cycle = 0;
+    typename axi4_::WritePayload pld;
+    bool full = false;
+
+    #pragma hls_pipeline_init_interval 1
+    while (1) {
+      wait();
+      cycle++;
+      if (full && if_wr_s.w.PushNB(pld)) {
+        full = false;
+      }
+      if (!full && if_wr_m.w.PopNB(pld)) {
+        full = true;
+        if (writes.empty()) {
+          earlyData.push_back(pld);
+        } else {
+          WriteBeat(pld);
+        }
+        if (beatLog.is_open()) {
+          beatLog << cycle << ",W";
+          LogData(pld.data);
+          LogHex(axiCfg::useWriteStrobes ? pld.wstrb.to_uint64() : 0);
+          LogHex(pld.last.to_uint64());
+          beatLog << "\n";
+        }
+      }
+    }
+  }
+
+  void run_b() {
+    if_wr_s.b.Reset();
+    if_wr_m.b.Reset();
+    unsigned long cycle = 0;
+    typename axi4_::WRespPayload pld;
+    bool full = false;
+
+    #pragma hls_pipeline_init_interval 1
+    while (1) {
+      wait();
+      cycle++;
+      if (full && if_wr_m.b.PushNB(pld)) {
+        full = false;
+      }
+      if (!full && if_wr_s.b.PopNB(pld)) {
+        full = true;
+        if (beatLog.is_open()) {
+          beatLog << cycle << ",B";
+          LogHex(pld.id.to_uint64());
+          LogHex(pld.resp.to_uint64());
+          beatLog << "\n";
+        }
+      }
+    }
+  }
+};
+
+#endif
@@ -22,17 +22,17 @@
 #include <axi/axi4.h>
 #include <nvhls_connections.h>
 #include <hls_globals.h>
+#include <axi/testbench/SparseMem.h>
 
 #include <queue>
 #include <string>
 #include <sstream>
 #include <vector>
-#include <map>
 #include <math.h>
 #include <boost/assert.hpp>
 
-#include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_int_distribution.hpp>
+#include <testbench/nvhls_rand.h>
 #include <algorithm>
 
 /**
@@ -45,7 +45,7 @@
  * - readDelay: The number of cycles to wait after a write to an address before permitting reads to that address.  (If write responses are supported, this can safely be set to 0.)
  * - addrBoundLower: The lower bound of generated addresses.
  * - addrBoundUpper: The upper bound of generated addresses.
- * - seed: The random seed.
+ * - seed: The random seed, combined with the instance name into an nvhls::RandStream.
  */
 struct masterCfg {
   enum {
@@ -97,8 +97,8 @@ class Master : public sc_module {
   sc_in<bool> reset_bar;
   sc_in<bool> clk;
 
-  std::map<typename axi4_::Addr, typename axi4_::Data> localMem;
-  std::map<typename axi4_::Addr, NVUINT8 > localMem_wstrb;
+  // Written data, with the addresses of written beats marked valid for reads
+  SparseMem<axi4_::ADDR_WIDTH, axi4_::DATA_WIDTH> localMem;
   std::vector<typename axi4_::Addr> validReadAddresses;
   std::vector<typename axi4_::Addr> validReadAddresses_q;
   std::vector< long long > validReadAddresses_ctr;
@@ -117,6 +117,37 @@ class Master : public sc_module {
   }
 
  protected:
+  // Burst type of a new burst of len+1 beats.  With FIXED and WRAP bursts
+  // enabled, each burst type is picked a third of the time; WRAP bursts are
+  // shortened to 2, 4, 8 or 16 beats.
+  template <typename Gen, typename Len>
+  NVUINTW(axi4_::Enc::AXBURST::_WIDTH) RandomBurst(Gen& gen, Len& len) {
+    if (!(axiCfg::useFixedBurst || axiCfg::useWrapBurst) || len == 0) {
+      return axi4_::Enc::AXBURST::INCR;
+    }
+    boost::random::uniform_int_distribution<> random_type(0, 2);
+    int type = random_type(gen);
+    if (type == 1 && axiCfg::useFixedBurst) {
+      return axi4_::Enc::AXBURST::FIXED;
+    }
+    if (type == 2 && axiCfg::useWrapBurst) {
+      unsigned int beats = 2;
+      while (beats < 16 && 2*beats <= len+1) beats *= 2;
+      len = beats - 1;
+      return axi4_::Enc::AXBURST::WRAP;
+    }
+    return axi4_::Enc::AXBURST::INCR;
+  }
+
+  // Lowest address touched by a burst: a WRAP burst starts its window below
+  // the request address
+  typename axi4_::Addr SpanStart(typename axi4_::AddrPayload pld) {
+    if (axiCfg::useWrapBurst && pld.burst.to_uint64() == axi4_::Enc::AXBURST::WRAP) {
+      return pld.addr & ~axi4_::WrapMask(pld);
+    }
+    return pld.addr;
+  }
+
   void run() {
     static const int bytesPerWord = axi4_::DATA_WIDTH >> 3;
     static const int axiAddrBitsPerWord = nvhls::log2_ceil<bytesPerWord>::val;
@@ -140,7 +171,7 @@ class Master : public sc_module {
 #endif
     const char* env_rand_seed = std::getenv("RAND_SEED");
     if (env_rand_seed != NULL) seed = atoi(env_rand_seed);
-    boost::random::mt19937 gen(seed);
+    nvhls::RandStream gen(seed, name());
     boost::random::uniform_int_distribution<uint64_t> random_addr(cfg::addrBoundLower, cfg::addrBoundUpper);
     boost::random::uniform_int_distribution<> random_wstrb(1, pow(2,WSTRB_W)-1);
     boost::random::uniform_int_distribution<> random_burstlen(0, axiCfg::maxBurstSize-1);
@@ -150,6 +181,7 @@ class Master : public sc_module {
     typename axi4_::Data wr_data = 0xf00dcafe12345678;
     NVUINTW(WSTRB_W) wstrb = ~0;
     NVUINTW(ALEN_W) wr_len = 0;
+    NVUINTW(axi4_::Enc::AXBURST::_WIDTH) wr_burst = axi4_::Enc::AXBURST::INCR;
     typename axi4_::Addr rd_addr_next;
     typename axi4_::Addr rd_addr;
     NVUINTW(ALEN_W) rd_len;
@@ -185,11 +217,12 @@ class Master : public sc_module {
           } else {
             rd_len = 0;
           }
+          addr_pld.burst = RandomBurst(gen, rd_len);
           addr_pld.len = rd_len;
         }
         wr_conflict = false;
         for (unsigned int i=0; i<(rd_len+1); i++) {
-          if (!localMem.count(rd_addr_next+bytesPerBeat*i)) {
+          if (!localMem.IsValid(axi4_::BeatAddr(addr_pld, i))) {
             wr_conflict = true; // Not actually a conflict, but the read should be cancelled nonetheless
           }
         }
@@ -198,9 +231,10 @@ class Master : public sc_module {
             << ": Testharness attempted to read an address that it never wrote to"
             << ", read_addr=" << hex << rd_addr_next
             << endl;
-        BOOST_ASSERT_MSG( localMem.count(rd_addr_next), ms3.str().c_str() );
+        BOOST_ASSERT_MSG( localMem.IsValid(rd_addr_next), ms3.str().c_str() );
+        typename axi4_::Addr rd_lo = SpanStart(addr_pld);
         for (unsigned int j=0; j<waddr_queue.size(); j++) {
-          if ((rd_addr_next+bytesPerBeat*rd_len) >= waddr_queue.front() && rd_addr_next <= waddr_queue.front())
+          if ((rd_lo+bytesPerBeat*rd_len) >= waddr_queue.front() && rd_lo <= waddr_queue.front())
                 wr_conflict = true;
           waddr_queue.push(waddr_queue.front());
           waddr_queue.pop();
@@ -214,7 +248,7 @@ class Master : public sc_module {
             numReads++;
             for (unsigned int i=0; i<(rd_len+1); i++) {
               raddr_queue.push(rd_addr_next);
-              rd_addr_next += bytesPerBeat;
+              rd_addr_next = axi4_::NextBeatAddr(addr_pld, rd_addr_next);
             }
             rlen_queue.push(rd_len);
           }
@@ -225,9 +259,9 @@ class Master : public sc_module {
         if (axiCfg::useWriteStrobes) {
           bool checked_one = false;
           for (int i=0; i<axi4_::WSTRB_WIDTH; i++) {
-            if (localMem_wstrb.count(rd_addr+i)) {
+            if (localMem.IsWritten(rd_addr+i)) {
               rcv_data_wstrb = nvhls::get_slc<8>(data_pld.data,8*i);
-              check_data_wstrb = localMem_wstrb[rd_addr+i];
+              check_data_wstrb = localMem.ReadByte(rd_addr+i);
               std::ostringstream msg;
               msg << "\nError @" << sc_time_stamp() << " from " << name()
                   << ": Incorrect read data response"
@@ -245,7 +279,7 @@ class Master : public sc_module {
               << ": Testbench did not check any bytes of a read response" << std::endl;
           BOOST_ASSERT_MSG( checked_one, msg3.str().c_str() );
         } else {
-          check_data = localMem[rd_addr];
+          check_data = localMem.Read(rd_addr);
           std::ostringstream msg;
           msg << "\nError @" << sc_time_stamp() << " from " << name()
               << ": Incorrect read data response"
@@ -278,10 +312,12 @@ class Master : public sc_module {
       wr_data_pld.data = wr_data;
       wr_data_pld.wstrb = wstrb;
       wr_addr_pld.len = wr_len;
+      wr_addr_pld.burst = wr_burst;
       if (!writeInProgress && numWrites < cfg::numWrites) {
         rd_conflict = false;
+        typename axi4_::Addr wr_lo = SpanStart(wr_addr_pld);
         for (unsigned int j=0; j<raddr_queue.size(); j++) {
-          if ((wr_addr+bytesPerBeat*wr_len) >= raddr_queue.front() && wr_addr <= raddr_queue.front())
+          if ((wr_lo+bytesPerBeat*wr_len) >= raddr_queue.front() && wr_lo <= raddr_queue.front())
                 rd_conflict = true;
           raddr_queue.push(raddr_queue.front());
           raddr_queue.pop();
@@ -292,7 +328,7 @@ class Master : public sc_module {
                           << wr_addr_pld << "]"
                           << endl, kDebugLevel);
             for (unsigned int i=0; i<(wr_len+1); i++) {
-              waddr_queue.push(wr_addr+bytesPerBeat*i);
+              waddr_queue.push(axi4_::BeatAddr(wr_addr_pld, i));
               // If the address was already written to once, it needs to be removed from the list of valid addresses
               // because a read after this second write could return incorrect data
               validReadAddresses.erase(std::remove(validReadAddresses.begin(), validReadAddresses.end(), waddr_queue.front()), validReadAddresses.end());
@@ -329,13 +365,11 @@ class Master : public sc_module {
                         << " beat=" << dec << numWritesOfBurst
                         << endl, kDebugLevel);
           if (axiCfg::useWriteStrobes) {
-            for (int i=0; i<axi4_::WSTRB_WIDTH; i++) {
-              if (wr_data_pld.wstrb[i] == 1) {
-                localMem_wstrb[wr_addr+i] = nvhls::get_slc<8>(wr_data_pld.data, 8*i);
-              }
-            }
+            localMem.Write(wr_addr, wr_data_pld.data, wr_data_pld.wstrb);
+          } else {
+            localMem.Write(wr_addr, wr_data_pld.data);
           }
-          localMem[wr_addr] = wr_data_pld.data; // Need to keep track of base addresses, even for wstrb case
+          localMem.MarkValid(wr_addr); // Need to keep track of base addresses, even for wstrb case
           if (++numWritesOfBurst == (wr_len+1)) { // Whole burst is done
             wr_addr = (random_addr(gen) >> axiAddrBitsPerWord) << axiAddrBitsPerWord; // Keep all requests word-aligned
             if (axiCfg::useBurst) {
@@ -345,12 +379,19 @@ class Master : public sc_module {
               } else {
                 wr_len = 0;
               }
+              wr_burst = RandomBurst(gen, wr_len);
+              wr_addr_pld.burst = wr_burst;
+              wr_addr_pld.len = wr_len;
+              wr_addr_pld.addr = wr_addr;
+              if (SpanStart(wr_addr_pld) < cfg::addrBoundLower) {
+                wr_burst = axi4_::Enc::AXBURST::INCR;
+              }
             }
             writeInProgress = false;
             numWrites++;
             numWritesOfBurst = 0;
           } else { // Only this beat is done
-            wr_addr += bytesPerBeat;
+            wr_addr = axi4_::NextBeatAddr(wr_addr_pld, wr_addr);
           }
           wr_data = 0xf00dcafe12345678
                       ^ ((static_cast<typename axi4_::Data>(wr_addr)) << 16) // Typically touches bits 47:16
@@ -22,10 +22,11 @@
 #include <ac_reset_signal_is.h>
 
 #include <axi/axi4.h>
-#include <axi/testbench/CSVFileReader.h>
+#include <axi/testbench/TraceReader.h>
 #include <nvhls_connections.h>
 #include <hls_globals.h>
 
+#include <deque>
 #include <queue>
 #include <string>
 #include <sstream>
@@ -42,12 +43,27 @@
  *
  * \par Overview
  * AxiMasterFromFile reads write and read requests from a CSV and issues them as an AXI master.  Read responses are checked agains the expected values provided in the file.  If enable_interrupts is true, the file can also specify a wait-for-interrupt mode in which the interrupt input must go high before further instructions are processed. The format of the CSV is as follows:
- * - Writes: delay_from_previous_request,W,address_in_hex,data_in_hex
- * - Reads: delay_from_previous_request,R,address_in_hex,expected_response_data_in_hex
- * - Interrupts: delay_from_previous_request,Q,arbitrary,arbitrary
+ * - Writes: delay,W,address_in_hex,data_in_hex[,dependency]
+ * - Reads: delay,R,address_in_hex,expected_response_data_in_hex[,dependency]
+ * - Interrupts: delay,Q,arbitrary,arbitrary[,dependency]
  * 
  *  For reads, it's best to specify the full DATA_WIDTH of expected response data.
  *
+ * Up to maxOutstanding (default 1) reads and writes are in flight at a time; responses return in order on each of R
+ * and B.  A request issues once the window has room, once the response to its dependency has arrived, and then
+ * after its delay:
+ * - A decimal delay is the number of cycles after that point, i.e. the inter-arrival time from the previous request
+ *   while the window is not full.  With one outstanding request it is the delay from the previous response.
+ * - A delay written as @cycle is an absolute issue cycle, counted from the start of the replay.  A request that
+ *   cannot issue by then, because the window is full, its dependency has not responded or the channel stalls, issues
+ *   as soon as it can and counts in LateIssues().
+ * - The dependency is the index of an earlier request in the file, counting every request from 0, e.g. a read that
+ *   must not pass the write of its address.  Binary traces carry delays and dependencies as well.
+ *
+ * The file may also be a binary trace written by TraceReader::ConvertCSV() or recorded by AxiMonitor; memory
+ * records ('M') in a binary trace are skipped.  Requests are parsed as they are issued, so the size of a trace is
+ * not limited by memory.
+ *
  */
 
 // Allow an sc_in to be present only if a template parameter is enabled
@@ -71,13 +87,8 @@ template <typename axiCfg, bool enable_interrupts = false> class MasterFromFile
   static const int bytesPerWord = axi4_::DATA_WIDTH >> 3;
   static const int axiAddrBitsPerWord = nvhls::log2_ceil<bytesPerWord>::val;
 
-  std::queue< int > delay_q;
-  std::queue< int > req_q;
-  std::queue< typename axi4_::AddrPayload > raddr_q;
-  std::queue< typename axi4_::AddrPayload > waddr_q;
-  std::queue< typename axi4_::WritePayload > wdata_q;
-  std::queue<typename axi4_::Data> rresp_q;
-    
+  TraceReader reader;
+
   typename axi4_::AddrPayload addr_pld;
   typename axi4_::WritePayload wr_data_pld;
   typename axi4_::ReadPayload data_pld;
@@ -88,111 +99,160 @@ template <typename axiCfg, bool enable_interrupts = false> class MasterFromFile
 
   SC_HAS_PROCESS(MasterFromFile);
 
-  MasterFromFile(sc_module_name name_, std::string filename="requests.csv")
-      : sc_module(name_), if_rd("if_rd"), if_wr("if_wr"), reset_bar("reset_bar"), clk("clk") {
+  MasterFromFile(sc_module_name name_, std::string filename="requests.csv", unsigned int maxOutstanding = 1)
+      : sc_module(name_), if_rd("if_rd"), if_wr("if_wr"), reset_bar("reset_bar"), clk("clk"), reader(filename),
+        maxOutstanding_(maxOutstanding ? maxOutstanding : 1), cycle(0), outstanding(0), numRequests(0),
+        maxOutstandingSeen(0), lateIssues(0) {
 
     CDCOUT("Reading file: " << filename << endl, kDebugLevel);
-    CSVFileReader reader(filename);
-    std::vector< std::vector<std::string> > dataList = reader.readCSV();
-    for (unsigned int i=0; i < dataList.size(); i++) {
-      std::vector<std::string> vec = dataList[i];
-      NVHLS_ASSERT_MSG(vec.size() == 4, "Each request must have four elements");
-      delay_q.push(atoi(vec[0].c_str()));
-      if (vec[1] == "R") {
-        req_q.push(0);
-        std::stringstream ss;
-        sc_uint<axi4_::ADDR_WIDTH> addr;
-        ss << hex << vec[2];
-        ss >> addr;
-        addr_pld.addr = static_cast<typename axi4_::Addr>(addr);
-        addr_pld.len = 0;
-        raddr_q.push(addr_pld);
-        std::stringstream ss_data;
-        sc_biguint<axi4_::DATA_WIDTH> data;
-        ss_data << hex << vec[3];
-        ss_data >> data;
-        rresp_q.push(TypeToNVUINT(data));
-      } else if (vec[1] == "W") {
-        req_q.push(1);
-        std::stringstream ss;
-        sc_uint<axi4_::ADDR_WIDTH> addr;
-        ss << hex << vec[2];
-        ss >> addr;
-        addr_pld.addr = static_cast<typename axi4_::Addr>(addr);
-        addr_pld.len = 0;
-        waddr_q.push(addr_pld);
-        std::stringstream ss_data;
-        sc_biguint<axi4_::DATA_WIDTH> data;
-        ss_data << hex << vec[3];
-        ss_data >> data;
-        wr_data_pld.data = TypeToNVUINT(data);
-        wr_data_pld.wstrb = ~0;
-        wr_data_pld.last = 1;
-        wdata_q.push(wr_data_pld);
-      } else if (vec[1] == "Q") {
-        NVHLS_ASSERT_MSG(enable_interrupts,"Interrupt command read, but interrupts are not enabled");
-        req_q.push(2);
-      } else {
-        NVHLS_ASSERT_MSG(1,"Requests must be R or W or Q");
-      }
-    }
+    NVHLS_ASSERT_MSG(reader.IsOpen(), "Could not open the request file");
 
     SC_THREAD(run);
     sensitive << clk.pos();
     async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(run_r);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(run_b);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(run_cycles);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
   }
 
+  // Replay statistics
+  unsigned long NumRequests() const { return numRequests; }
+  unsigned int MaxOutstanding() const { return maxOutstandingSeen; }
+  unsigned long LateIssues() const { return lateIssues; }
+
  protected:
+  struct PendingRead {
+    unsigned long index;
+    typename axi4_::Data expected;
+  };
+
+  unsigned int maxOutstanding_;
+  unsigned long cycle;
+  unsigned int outstanding;
+  std::vector<bool> completed;  // By request index
+  std::deque<PendingRead> reads;
+  std::deque<unsigned long> writes;
+
+  unsigned long numRequests;
+  unsigned int maxOutstandingSeen;
+  unsigned long lateIssues;
+
+  void run_cycles() {
+    cycle = 0;
+    while (1) {
+      wait();
+      cycle++;
+    }
+  }
+
   void run() {
 
     done = 0;
 
-    if_rd.reset();
-    if_wr.reset();
+    if_rd.ar.Reset();
+    if_wr.aw.Reset();
+    if_wr.w.Reset();
 
     wait(20);
 
-    while (!delay_q.empty()) {
-      int delay = delay_q.front();
-      if (delay > 0) wait(delay);
-      delay_q.pop();
-      if (req_q.front() == 2) {
+    // Requests are parsed from the trace as they are issued
+    unsigned long start = cycle;
+    TraceRecord rec;
+    while (reader.Next(rec)) {
+      // Binary traces recorded by AxiMonitor also hold the memory contents for SlaveFromFile
+      if (rec.op == 'M' && reader.IsBinary()) continue;
+      NVHLS_ASSERT_MSG(rec.op != 'M', "Each request must have four or five elements");
+      unsigned long index = numRequests++;
+      completed.push_back(false);
+      NVHLS_ASSERT_MSG(rec.dep < static_cast<long>(index), "A request can only depend on an earlier request");
+      while (outstanding >= maxOutstanding_) wait();
+      if (rec.dep >= 0) {
+        while (!completed[rec.dep]) wait();
+      }
+      if (rec.absolute) {
+        while (cycle < start + rec.delay) wait();
+      } else if (rec.delay > 0) {
+        wait(rec.delay);
+      }
+      addr_pld.addr = static_cast<typename axi4_::Addr>(rec.addr);
+      addr_pld.len = 0;
+      if (rec.op == 'Q') {
         NVHLS_ASSERT_MSG(enable_interrupts,"Interrupt command found, but interrupts are not enabled");
         CDCOUT(sc_time_stamp() << " " << name() << " Beginning wait for interrupt"
                       << endl, kDebugLevel);
         while (interrupt.read() == 0) wait();
         CDCOUT(sc_time_stamp() << " " << name() << " Interrupt received"
                       << endl, kDebugLevel);
-      } else if (req_q.front() == 1) {
-        addr_pld = waddr_q.front();
+        completed[index] = true;
+        continue;
+      }
+      if (rec.absolute && cycle > start + rec.delay) lateIssues++;
+      outstanding++;
+      maxOutstandingSeen = (outstanding > maxOutstandingSeen) ? outstanding : maxOutstandingSeen;
+      if (rec.op == 'W') {
+        writes.push_back(index);
         if_wr.aw.Push(addr_pld);
-        waddr_q.pop();
-        wr_data_pld = wdata_q.front();
+        wr_data_pld.data = rec.Data<axi4_::DATA_WIDTH>();
+        wr_data_pld.wstrb = ~0;
+        wr_data_pld.last = 1;
         if_wr.w.Push(wr_data_pld);
-        wdata_q.pop();
-        if_wr.b.Pop();
         CDCOUT(sc_time_stamp() << " " << name() << " Sent write request:"
                       << " addr=[" << addr_pld << "]"
                       << " data=[" << wr_data_pld << "]"
                       << endl, kDebugLevel);
-      } else {
-        addr_pld = raddr_q.front();
+      } else if (rec.op == 'R') {
+        PendingRead pr;
+        pr.index = index;
+        pr.expected = rec.Data<axi4_::DATA_WIDTH>();
+        reads.push_back(pr);
         if_rd.ar.Push(addr_pld);
-        raddr_q.pop();
         CDCOUT(sc_time_stamp() << " " << name() << " Sent read request: "
                       << addr_pld
                       << endl, kDebugLevel);
-        data_pld = if_rd.r.Pop();
-        CDCOUT(sc_time_stamp() << " " << name() << " Received read response: ["
-                      << data_pld << "]"
-                      << endl, kDebugLevel);
-        NVHLS_ASSERT_MSG(data_pld.data == rresp_q.front(),"Read response did not match expected value");
-        rresp_q.pop();
+      } else {
+        NVHLS_ASSERT_MSG(false,"Requests must be R or W or Q");
       }
-      req_q.pop();
     }
+    while (outstanding > 0) wait();
     done = 1;
   }
+
+  void run_r() {
+    if_rd.r.Reset();
+    wait();
+    while (1) {
+      data_pld = if_rd.r.Pop();
+      CDCOUT(sc_time_stamp() << " " << name() << " Received read response: ["
+                    << data_pld << "]"
+                    << endl, kDebugLevel);
+      NVHLS_ASSERT_MSG(!reads.empty(), "Read response without an outstanding read");
+      NVHLS_ASSERT_MSG(data_pld.data == reads.front().expected,"Read response did not match expected value");
+      completed[reads.front().index] = true;
+      reads.pop_front();
+      outstanding--;
+    }
+  }
+
+  void run_b() {
+    if_wr.b.Reset();
+    wait();
+    while (1) {
+      wr_resp_pld = if_wr.b.Pop();
+      NVHLS_ASSERT_MSG(!writes.empty(), "Write response without an outstanding write");
+      completed[writes.front()] = true;
+      writes.pop_front();
+      outstanding--;
+    }
+  }
 };
 
 #endif
@@ -23,25 +23,87 @@
 #include <axi/axi4.h>
 #include <nvhls_connections.h>
 #include <hls_globals.h>
+#include <axi/testbench/SparseMem.h>
 
 #include <queue>
-#include <map>
+#include <vector>
+#include <iostream>
+#include <cstdlib>
 #include <boost/assert.hpp>
 #include <algorithm>
 
+#include <boost/random/uniform_int_distribution.hpp>
+#include <testbench/nvhls_rand.h>
+
+/**
+ * \brief The default timing config for the AXI slave: every request is served as soon as it arrives.
+ *
+ * \par The following constants must be defined:
+ *
+ * - latencyMin, latencyMax: The base latency in cycles of each request is uniformly distributed between these bounds.
+ * - tailPercent, tailLatency: tailPercent percent of requests take tailLatency additional cycles (e.g., refresh).
+ * - numBanks: The number of banks of the row-buffer model, or 0 to disable it.
+ * - rowBytes: The row size in bytes.  Consecutive rows are interleaved across banks.
+ * - rowHitLatency, rowMissLatency: Cycles added to a request that hits or misses the open row of its bank.
+ * - bytesPerCycle: The bandwidth shared by read and write data beats, or 0 for no cap.
+ * - maxOutstanding: The number of requests that may be accepted and not yet responded to, or 0 for no limit.
+ * - seed: The random seed, combined with the instance name into an nvhls::RandStream.
+ */
+struct slaveTimingIdeal {
+  enum {
+    latencyMin = 0,
+    latencyMax = 0,
+    tailPercent = 0,
+    tailLatency = 0,
+    numBanks = 0,
+    rowBytes = 2048,
+    rowHitLatency = 0,
+    rowMissLatency = 0,
+    bytesPerCycle = 0,
+    maxOutstanding = 0,
+    seed = 0,
+  };
+};
+
+/**
+ * \brief An example timing config for the AXI slave that approximates a DRAM channel.
+ */
+struct slaveTimingDram : public slaveTimingIdeal {
+  enum {
+    latencyMin = 20,
+    latencyMax = 30,
+    tailPercent = 1,
+    tailLatency = 100,
+    numBanks = 8,
+    rowBytes = 2048,
+    rowHitLatency = 0,
+    rowMissLatency = 15,
+    bytesPerCycle = 4,
+    maxOutstanding = 16,
+  };
+};
+
 /**
  * \brief An AXI slave for use in a testbench.
  * \ingroup AXI
  *
  * \tparam axiCfg                   A valid AXI config.
+ * \tparam timingCfg                A timing config (such as slaveTimingIdeal or slaveTimingDram).  (Default: slaveTimingIdeal)
  *
  * \par Overview
  * This test structure acts as an AXI slave memory, responding to read and write requests and generating responses.  An internal memory, initially unpopulated, stores the values of AXI write requests and is accessed for read requests.  The block enforces the following by assertion:
  * - Read requests are only valid if the address has previously been written to.
  * - Write data beats must each assert at least one strobe bit.
  *
+ * The timing config models the latency and bandwidth of a real memory.  The first data beat of a read and the
+ * response of a write are held back by the access latency, which is counted from when the request (for writes, the
+ * last data beat) is taken in.  The latency is the sum of a uniformly distributed base latency, an occasional tail
+ * latency, and the row hit or miss latency of the bank that holds the start address.  Read and write data beats
+ * share a bandwidth of bytesPerCycle, and no new request is taken once maxOutstanding requests are in flight.
+ * PrintStats() reports the requests served and the row hit rate.
+ *
  */
-template <typename axiCfg>
+template <typename axiCfg, typename timingCfg = slaveTimingIdeal>
 class Slave : public sc_module {
  public:
   static const int kDebugLevel = 0;
@@ -58,15 +120,28 @@ class Slave : public sc_module {
   std::queue <typename axi4_::AddrPayload> wr_addr;
   std::queue <typename axi4_::WritePayload> wr_data;
   std::queue <typename axi4_::WRespPayload> wr_resp;
+  // First cycle at which the head of rd_resp and wr_resp may be sent
+  std::queue <unsigned long> rd_resp_ready;
+  std::queue <unsigned long> wr_resp_ready;
 
-  std::map<typename axi4_::Addr, typename axi4_::Data> localMem;
-  std::map<typename axi4_::Addr, NVUINT8 > localMem_wstrb;
-  std::vector<typename axi4_::Addr> validReadAddresses;
+  // Written data, with the addresses of written beats marked valid for reads
+  SparseMem<axi4_::ADDR_WIDTH, axi4_::DATA_WIDTH> localMem;
 
   static const int bytesPerBeat = axi4_::DATA_WIDTH >> 3;
 
   SC_CTOR(Slave)
-      : if_rd("if_rd"), if_wr("if_wr"), reset_bar("reset_bar"), clk("clk") {
+      : if_rd("if_rd"), if_wr("if_wr"), reset_bar("reset_bar"), clk("clk"),
+        gen(timingCfg::seed, name()), openRow(timingCfg::numBanks, ~0ULL), rdOutstanding(0), wrOutstanding(0),
+        channelBytes(0), channelCycle(0), readsServed(0), writesServed(0), rowHits(0), rowMisses(0) {
+    // Follow the same priority as nvhls_rand: environment, then preprocessor define, then config
+    unsigned int seed = timingCfg::seed;
+#ifdef RAND_SEED
+    seed = (RAND_SEED);
+#endif
+    const char* env_rand_seed = std::getenv("RAND_SEED");
+    if (env_rand_seed != NULL) seed = atoi(env_rand_seed);
+    gen.seed(seed, name());
+
     SC_THREAD(run_rd);
     sensitive << clk.pos();
     async_reset_signal_is(reset_bar, false);
@@ -76,16 +151,88 @@ class Slave : public sc_module {
     async_reset_signal_is(reset_bar, false);
   }
 
+  // Reports the requests served and the row hit rate
+  void PrintStats(std::ostream& os = std::cout) const {
+    os << name() << ": " << readsServed << " reads, " << writesServed << " writes";
+    if (rowHits + rowMisses != 0) {
+      os << ", row hit rate " << static_cast<double>(rowHits) / (rowHits + rowMisses);
+    }
+    os << std::endl;
+  }
+
  protected:
+  nvhls::RandStream gen;
+  std::vector<unsigned long long> openRow;
+  unsigned int rdOutstanding;
+  unsigned int wrOutstanding;
+  unsigned long channelBytes;
+  unsigned long channelCycle;
+  unsigned long readsServed;
+  unsigned long writesServed;
+  unsigned long rowHits;
+  unsigned long rowMisses;
+
+  // Cycles from taking in a request to its first read beat or its write response
+  unsigned long AccessLatency(typename axi4_::Addr addr) {
+    unsigned long latency = timingCfg::latencyMin;
+    if (timingCfg::latencyMax > timingCfg::latencyMin) {
+      boost::random::uniform_int_distribution<> random_latency(timingCfg::latencyMin, timingCfg::latencyMax);
+      latency = random_latency(gen);
+    }
+    if (timingCfg::tailPercent > 0) {
+      boost::random::uniform_int_distribution<> percent(0, 99);
+      if (percent(gen) < timingCfg::tailPercent) latency += timingCfg::tailLatency;
+    }
+    if (timingCfg::numBanks > 0) {
+      unsigned long long row = addr.to_uint64() / timingCfg::rowBytes;
+      unsigned int bank = row % timingCfg::numBanks;
+      row /= timingCfg::numBanks;
+      if (openRow[bank] == row) {
+        latency += timingCfg::rowHitLatency;
+        rowHits++;
+      } else {
+        latency += timingCfg::rowMissLatency;
+        openRow[bank] = row;
+        rowMisses++;
+      }
+    }
+    return latency;
+  }
+
+  bool CanAccept() const {
+    return timingCfg::maxOutstanding == 0 || rdOutstanding + wrOutstanding < timingCfg::maxOutstanding;
+  }
+
+  // True if the bandwidth cap allows another data beat in this cycle
+  bool BeatAvailable(unsigned long cycle) {
+    if (timingCfg::bytesPerCycle == 0) return true;
+    static const unsigned long maxBytes = bytesPerBeat > timingCfg::bytesPerCycle ? bytesPerBeat : timingCfg::bytesPerCycle;
+    if (cycle > channelCycle) {
+      channelBytes += (cycle - channelCycle) * timingCfg::bytesPerCycle;
+      if (channelBytes > maxBytes) channelBytes = maxBytes;
+      channelCycle = cycle;
+    }
+    return channelBytes >= bytesPerBeat;
+  }
+
+  void ConsumeBeat() {
+    if (timingCfg::bytesPerCycle != 0) channelBytes -= bytesPerBeat;
+  }
+
   void run_rd() {
     if_rd.reset();
     unsigned int rdBeatInFlight = 0;
+    unsigned long cycle = 0;
+    rdOutstanding = 0;
 
     while (1) {
       wait();
+      cycle++;
 
       typename axi4_::AddrPayload rd_addr_pld;
-      if (if_rd.nb_aread(rd_addr_pld)) {
+      if (CanAccept() && if_rd.nb_aread(rd_addr_pld)) {
+        unsigned long ready = cycle + AccessLatency(rd_addr_pld.addr);
+        rdOutstanding++;
         typename axi4_::Addr addr = rd_addr_pld.addr;
         NVHLS_ASSERT_MSG(addr % bytesPerBeat == 0, "Addresses must be word aligned");
         CDCOUT(sc_time_stamp() << " " << name() << " Received read request: ["
@@ -98,33 +245,21 @@ class Slave : public sc_module {
               << ": Received a read request from an address that has not yet been written to"
               << ", addr=" << hex << addr
               << endl;
-          bool validAddr = false;
-          for (unsigned int j=0; j<validReadAddresses.size(); j++) {
-            if (validReadAddresses[j] == rd_addr_pld.addr) validAddr = true;
-          }
+          bool validAddr = localMem.IsValid(rd_addr_pld.addr);
           BOOST_ASSERT_MSG( validAddr, msg.str().c_str() );
           typename axi4_::ReadPayload data_pld;
-          if (axiCfg::useWriteStrobes) {
-            for (int k=0; k<axi4_::WSTRB_WIDTH; k++) {
-              if (localMem_wstrb.find(addr+k) != localMem_wstrb.end()) {
-                data_pld.data = nvhls::set_slc(data_pld.data, localMem_wstrb[addr+k], 8*k);
-              } else {
-                data_pld.data = nvhls::set_slc(data_pld.data, NVUINT8(0), 8*k);
-              }
-            }
-          } else {
-            data_pld.data = localMem[addr];
-          }
+          data_pld.data = localMem.Read(addr);
           data_pld.resp = axi4_::Enc::XRESP::OKAY;
           data_pld.id = rd_addr_pld.id;
           data_pld.last = (i == len);
           rd_resp.push(data_pld);
           rd_resp_addr.push(addr);
-          addr += bytesPerBeat;
+          rd_resp_ready.push(ready);
+          addr = axi4_::NextBeatAddr(rd_addr_pld, addr);
         }
       }
 
-      if (!rd_resp.empty()) {
+      if (!rd_resp.empty() && rd_resp_ready.front() <= cycle && BeatAvailable(cycle)) {
         typename axi4_::ReadPayload data_pld;
         data_pld = rd_resp.front();
         typename axi4_::Addr addr = rd_resp_addr.front();
@@ -134,11 +269,15 @@ class Slave : public sc_module {
                         << " addr=" << hex << addr.to_uint64()
                         << " beat=" << dec << (axiCfg::useBurst ? static_cast< sc_uint<32> >(rdBeatInFlight++) : "N/A")
                         << endl, kDebugLevel);
+          ConsumeBeat();
           if (data_pld.last == 1) {
             rdBeatInFlight = 0;
+            rdOutstanding--;
+            readsServed++;
           }
           rd_resp.pop();
           rd_resp_addr.pop();
+          rd_resp_ready.pop();
         }
       }
     }
@@ -155,16 +294,21 @@ class Slave : public sc_module {
     unsigned int wrBeatInFlight = 0;
     bool first_beat = 1;
     typename axi4_::Addr wresp_addr;
+    unsigned long cycle = 0;
+    wrOutstanding = 0;
 
     while (1) {
       wait();
+      cycle++;
 
       // Send a write response out of the local queue
       if (axiCfg::useWriteResponses) {
-        if (!wr_resp.empty()) {
+        if (!wr_resp.empty() && wr_resp_ready.front() <= cycle) {
           resp_pld = wr_resp.front();
           if (if_wr.nb_bwrite(resp_pld)) {
             wr_resp.pop();
+            wr_resp_ready.pop();
+            wrOutstanding--;
             CDCOUT(sc_time_stamp() << " " << name() << " Sent write response: ["
                                    << resp_pld << "]"
                                    << endl, kDebugLevel);
@@ -173,7 +317,8 @@ class Slave : public sc_module {
       }
 
       // Grab a write request (addr) and put it in the local queue
-      if (if_wr.aw.PopNB(wr_addr_pld)) {
+      if (CanAccept() && if_wr.aw.PopNB(wr_addr_pld)) {
+        wrOutstanding++;
         NVHLS_ASSERT_MSG(wr_addr_pld.addr.to_uint64() % bytesPerBeat == 0, "Addresses must be word aligned");
         wr_addr.push(wr_addr_pld);
         CDCOUT(sc_time_stamp() << " " << name() << " Received write request: ["
@@ -194,7 +339,8 @@ class Slave : public sc_module {
       }
 
       // Handle a write request in the local queues
-      if (!wr_addr.empty() & !wr_data.empty()) {
+      if (!wr_addr.empty() & !wr_data.empty() && BeatAvailable(cycle)) {
+        ConsumeBeat();
         if (first_beat) {
           wr_addr_pld_out = wr_addr.front();
           wresp_addr = wr_addr_pld_out.addr;
@@ -207,24 +353,25 @@ class Slave : public sc_module {
           msg << "\nError @" << sc_time_stamp() << " from " << name()
               << ": Wstrb cannot be all zeros" << endl;
           BOOST_ASSERT_MSG( wr_data_pld_out.wstrb != 0, msg.str().c_str() );
-          for (int j=0; j<axi4_::WSTRB_WIDTH; j++) {
-            if (wr_data_pld_out.wstrb[j] == 1) {
-              localMem_wstrb[wresp_addr+j] = nvhls::get_slc<8>(wr_data_pld_out.data, 8*j);
-            }
-          }
+          localMem.Write(wresp_addr, wr_data_pld_out.data, wr_data_pld_out.wstrb);
         } else {
-          localMem[wresp_addr] = wr_data_pld_out.data;
+          localMem.Write(wresp_addr, wr_data_pld_out.data);
         }
-        validReadAddresses.push_back(wresp_addr);
-        wresp_addr += bytesPerBeat;
+        localMem.MarkValid(wresp_addr);
+        wresp_addr = axi4_::NextBeatAddr(wr_addr_pld_out, wresp_addr);
         if (wr_data_pld_out.last == 1) {
           wr_addr.pop();
           first_beat = 1;
           // Generate a response
+          writesServed++;
+          unsigned long ready = cycle + AccessLatency(wr_addr_pld_out.addr);
           if (axiCfg::useWriteResponses) {
             resp_pld.resp = axi4_::Enc::XRESP::OKAY;
             resp_pld.id = wr_addr_pld_out.id;
             wr_resp.push(resp_pld);
+            wr_resp_ready.push(ready);
+          } else {
+            wrOutstanding--;
           }
         }
       }
@@ -21,12 +21,12 @@
 #include <ac_reset_signal_is.h>
 
 #include <axi/axi4.h>
-#include <axi/testbench/CSVFileReader.h>
+#include <axi/testbench/TraceReader.h>
 #include <nvhls_connections.h>
 #include <hls_globals.h>
+#include <axi/testbench/SparseMem.h>
 
 #include <queue>
-#include <map>
 #include <boost/assert.hpp>
 #include <algorithm>
 #include <string>
@@ -44,6 +44,9 @@
  * 
  *  It's best to specify the full DATA_WIDTH of data.
  *
+ * The file may also be a binary trace written by TraceReader::ConvertCSV() or recorded by AxiMonitor; only its
+ * memory records ('M') are loaded.
+ *
  */
 template <typename axiCfg> class SlaveFromFile : public sc_module {
  public:
@@ -62,11 +65,8 @@ template <typename axiCfg> class SlaveFromFile : public sc_module {
   std::queue <typename axi4_::WritePayload> wr_data;
   std::queue <typename axi4_::WRespPayload> wr_resp;
 
-  std::map<typename axi4_::Addr, typename axi4_::Data> localMem;
-  std::map<typename axi4_::Addr, NVUINT8> localMem_wstrb;
-  std::vector<typename axi4_::Addr> validReadAddresses;
-
-  typename axi4_::WritePayload load_data_pld;
+  // Written data, with the addresses of written beats marked valid for reads
+  SparseMem<axi4_::ADDR_WIDTH, axi4_::DATA_WIDTH> localMem;
 
   static const int bytesPerBeat = axi4_::DATA_WIDTH >> 3;
 
@@ -75,29 +75,16 @@ template <typename axiCfg> class SlaveFromFile : public sc_module {
   SlaveFromFile(sc_module_name name_, std::string filename="mem.csv")
       : sc_module(name_), if_rd("if_rd"), if_wr("if_wr"), reset_bar("reset_bar"), clk("clk") {
 
-    CSVFileReader reader(filename);
-    std::vector< std::vector<std::string> > dataList = reader.readCSV();
-    for (unsigned int i=0; i < dataList.size(); i++) {
-      std::vector<std::string> vec = dataList[i];
-      NVHLS_ASSERT_MSG(vec.size() == 2, "Each request must have two elements");
-      std::stringstream ss;
-      sc_uint<axi4_::ADDR_WIDTH> addr_sc_uint;
-      ss << hex << vec[0];
-      ss >> addr_sc_uint;
-      std::stringstream ss_data;
-      sc_biguint<axi4_::DATA_WIDTH> data;
-      ss_data << hex << vec[1];
-      ss_data >> data;
-      load_data_pld.data = TypeToNVUINT(data);
-      typename axi4_::Addr addr = static_cast<typename axi4_::Addr>(addr_sc_uint);
-      if (axiCfg::useWriteStrobes) {
-        for (int j=0; j<axi4_::WSTRB_WIDTH; j++) {
-          localMem_wstrb[addr+j] = nvhls::get_slc<8>(load_data_pld.data, 8*j);
-        }
-      } else {
-        localMem[addr] = load_data_pld.data;
-      }  
-      validReadAddresses.push_back(addr);
+    TraceReader reader(filename);
+    NVHLS_ASSERT_MSG(reader.IsOpen(), "Could not open the memory file");
+    TraceRecord rec;
+    while (reader.Next(rec)) {
+      // Binary traces recorded by AxiMonitor also hold the requests for MasterFromFile
+      if (rec.op != 'M' && reader.IsBinary()) continue;
+      NVHLS_ASSERT_MSG(rec.op == 'M', "Each request must have two elements");
+      typename axi4_::Addr addr = static_cast<typename axi4_::Addr>(rec.addr);
+      localMem.Write(addr, rec.Data<axi4_::DATA_WIDTH>());
+      localMem.MarkValid(addr);
     }
 
     SC_THREAD(run_rd);
@@ -130,23 +117,10 @@ protected:
               << ": Received a read request from an address that has not yet been written to"
               << ", addr=" << hex << addr
               << endl;
-          bool validAddr = false;
-          for (unsigned int j=0; j<validReadAddresses.size(); j++) {
-            if (validReadAddresses[j] == rd_addr_pld.addr) validAddr = true;
-          }
+          bool validAddr = localMem.IsValid(rd_addr_pld.addr);
           BOOST_ASSERT_MSG( validAddr, msg.str().c_str() );
           typename axi4_::ReadPayload data_pld;
-          if (axiCfg::useWriteStrobes) {
-            for (int k=0; k<axi4_::WSTRB_WIDTH; k++) {
-              if (localMem_wstrb.find(addr+k) != localMem_wstrb.end()) {
-                data_pld.data = nvhls::set_slc(data_pld.data, localMem_wstrb[addr+k], 8*k);
-              } else {
-                data_pld.data = nvhls::set_slc(data_pld.data, NVUINT8(0), 8*k);
-              }
-            }
-          } else {
-            data_pld.data = localMem[addr];
-          }
+          data_pld.data = localMem.Read(addr);
           data_pld.resp = axi4_::Enc::XRESP::OKAY;
           data_pld.id = rd_addr_pld.id;
           data_pld.last = (i == len);
@@ -234,15 +208,11 @@ protected:
           msg << "\nError @" << sc_time_stamp() << " from " << name()
               << ": Wstrb cannot be all zeros" << endl;
           BOOST_ASSERT_MSG( wr_data_pld.wstrb != 0, msg.str().c_str() );
-          for (int j=0; j<axi4_::WSTRB_WIDTH; j++) {
-            if (wr_data_pld.wstrb[j] == 1) {
-              localMem_wstrb[wresp_addr+j] = nvhls::get_slc<8>(wr_data_pld.data, 8*j);
-            }
-          }
+          localMem.Write(wresp_addr, wr_data_pld.data, wr_data_pld.wstrb);
         } else {
-          localMem[wresp_addr] = wr_data_pld.data;
+          localMem.Write(wresp_addr, wr_data_pld.data);
         }
-        validReadAddresses.push_back(wresp_addr);
+        localMem.MarkValid(wresp_addr);
         wresp_addr += bytesPerBeat;
         if (wr_data_pld.last == 1) {
           wr_addr.pop();
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __AXI_T_SPARSE_MEM__
+#define __AXI_T_SPARSE_MEM__
+
+#include <nvhls_int.h>
+#include <nvhls_memory.h>
+
+#include <unordered_map>
+#include <cstring>
+#include <stdint.h>
+
+/**
+ * \brief A paged sparse memory for use in testbenches.
+ * \ingroup AXI
+ *
+ * \tparam AddrWidth   The address width in bits.
+ * \tparam DataWidth   The word width in bits, a multiple of 8.
+ * \tparam PageBits    log2 of the page size in bytes. (default: 12)
+ *
+ * \par Overview
+ * SparseMem stores bytes in pages of 2^PageBits bytes that are allocated on
+ * first write and looked up in a hash map, with the most recently used page
+ * cached, so every access takes constant time however much of the address
+ * space has been touched.  Each page keeps two bitmaps alongside its data:
+ * - written: the byte has been written, for byte-accurate write strobe tracking.
+ * - valid: the address has been marked with MarkValid(), e.g. as the address of
+ *   a write beat that may later be read.
+ *
+ * Unwritten bytes read as 0.  Words need not be aligned and may straddle
+ * pages.
+ *
+ * \code
+ *      SparseMem<32, 64> mem;
+ *      mem.Write(addr, data, wstrb);   // only bytes whose strobe is set
+ *      mem.MarkValid(addr);
+ *      ...
+ *      if (mem.IsValid(addr)) data = mem.Read(addr);
+ * \endcode
+ * \par
+ *
+ */
+template <int AddrWidth, int DataWidth, int PageBits = 12>
+class SparseMem {
+ public:
+  typedef NVUINTW(AddrWidth) Addr;
+  typedef NVUINTW(DataWidth) Data;
+
+  static const int bytesPerWord = DataWidth >> 3;
+  static const unsigned int pageBytes = 1u << PageBits;
+
+  static_assert(DataWidth % 8 == 0, "DataWidth must be a multiple of 8");
+  static_assert(PageBits >= 6, "Pages must hold at least 64 bytes");
+
+  SparseMem() : cached_num_(0), cached_(0) { NVHLS_MEMORY("SparseMem", sizeof(*this)); }
+
+  // Byte access
+  void WriteByte(Addr addr, NVUINT8 byte) {
+    uint64_t a = addr.to_uint64();
+    Page* page = Lookup(a, true);
+    unsigned int off = a & (pageBytes - 1);
+    page->data[off] = byte.to_uint();
+    page->written[off >> 6] |= Bit(off);
+  }
+
+  NVUINT8 ReadByte(Addr addr) {
+    uint64_t a = addr.to_uint64();
+    Page* page = Lookup(a, false);
+    return page ? NVUINT8(page->data[a & (pageBytes - 1)]) : NVUINT8(0);
+  }
+
+  bool IsWritten(Addr addr) {
+    uint64_t a = addr.to_uint64();
+    Page* page = Lookup(a, false);
+    unsigned int off = a & (pageBytes - 1);
+    return page && (page->written[off >> 6] & Bit(off)) != 0;
+  }
+
+  // Word access; bytes lie at increasing addresses starting from addr
+  void Write(Addr addr, Data data) {
+    for (int i = 0; i < bytesPerWord; i++) {
+      WriteByte(addr + i, nvhls::get_slc<8>(data, 8 * i));
+    }
+  }
+
+  // Writes only the bytes whose strobe bit is set
+  template <typename Strb>
+  void Write(Addr addr, Data data, Strb strb) {
+    for (int i = 0; i < bytesPerWord; i++) {
+      if (strb[i] == 1) {
+        WriteByte(addr + i, nvhls::get_slc<8>(data, 8 * i));
+      }
+    }
+  }
+
+  Data Read(Addr addr) {
+    Data data = 0;
+    for (int i = 0; i < bytesPerWord; i++) {
+      data = nvhls::set_slc(data, ReadByte(addr + i), 8 * i);
+    }
+    return data;
+  }
+
+  // Address validity, independent of the data
+  void MarkValid(Addr addr) {
+    uint64_t a = addr.to_uint64();
+    Page* page = Lookup(a, true);
+    unsigned int off = a & (pageBytes - 1);
+    page->valid[off >> 6] |= Bit(off);
+  }
+
+  bool IsValid(Addr addr) {
+    uint64_t a = addr.to_uint64();
+    Page* page = Lookup(a, false);
+    unsigned int off = a & (pageBytes - 1);
+    return page && (page->valid[off >> 6] & Bit(off)) != 0;
+  }
+
+  unsigned long NumPages() const { return pages_.size(); }
+
+  void Clear() {
+    pages_.clear();
+    cached_ = 0;
+  }
+
+ private:
+  struct Page {
+    unsigned char data[pageBytes];
+    uint64_t written[pageBytes / 64];
+    uint64_t valid[pageBytes / 64];
+
+    Page() {
+      std::memset(data, 0, sizeof(data));
+      std::memset(written, 0, sizeof(written));
+      std::memset(valid, 0, sizeof(valid));
+    }
+  };
+
+  static uint64_t Bit(unsigned int off) { return uint64_t(1) << (off & 63); }
+
+  // Pages are never moved by the map, so the cached pointer stays valid
+  Page* Lookup(uint64_t addr, bool create) {
+    uint64_t num = addr >> PageBits;
+    if (cached_ && cached_num_ == num) {
+      return cached_;
+    }
+    typename std::unordered_map<uint64_t, Page>::iterator it = pages_.find(num);
+    if (it == pages_.end()) {
+      if (!create) {
+        return 0;
+      }
+      it = pages_.emplace(num, Page()).first;
+      NVHLS_MEMORY_GROW("SparseMem", sizeof(Page));
+    }
+    cached_num_ = num;
+    cached_ = &it->second;
+    return cached_;
+  }
+
+  std::unordered_map<uint64_t, Page> pages_;
+  uint64_t cached_num_;
+  Page* cached_;
+};
+
+#endif
@@ -0,0 +1,384 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __AXI_T_TRACE_READER__
+#define __AXI_T_TRACE_READER__
+
+#include <nvhls_int.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <boost/assert.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * \brief One request of a trace file.
+ *
+ * CSV lines with four or five fields (delay,op,address,data[,dependency]) are
+ * requests for MasterFromFile; lines with two fields (address,data) are memory
+ * contents for SlaveFromFile and are returned with op 'M' and delay 0.  A delay
+ * written as @cycle is absolute: the request issues at that cycle since the
+ * start of the replay.  The optional dependency is the index of an earlier
+ * request, counting every request from 0, whose response must arrive before
+ * this one issues; an empty or missing field is no dependency (dep -1).  Data
+ * is stored little-endian, one byte per element, least significant byte first.
+ */
+struct TraceRecord {
+  unsigned long delay;
+  bool absolute;
+  long dep;
+  char op;
+  unsigned long long addr;
+  std::vector<unsigned char> data;
+
+  TraceRecord() : delay(0), absolute(false), dep(-1), op('M'), addr(0) {}
+
+  // The data as a W-bit integer, truncated or zero-extended
+  template <int W>
+  NVUINTW(W) Data() const {
+    NVUINTW(W) value = 0;
+    for (unsigned int i = 0; i < data.size() && 8 * i < static_cast<unsigned int>(W); i++) {
+      value = nvhls::set_slc(value, NVUINT8(data[i]), 8 * i);
+    }
+    return value;
+  }
+};
+
+/**
+ * \brief A writer for binary request traces.
+ * \ingroup AXI
+ *
+ * Writes the binary format read by TraceReader, with dataBytes bytes of data
+ * per record.  Data beyond dataBytes is dropped and shorter data is
+ * zero-padded.
+ */
+class TraceWriter {
+ public:
+  static const unsigned int headerBytes = 16;
+  static const unsigned int recordBytes = 24;  // Per record, without the data
+
+  TraceWriter(const std::string& filename, unsigned int dataBytes)
+      : out_(filename.c_str(), std::ios::binary), data_bytes_(dataBytes),
+        buf_(recordBytes + dataBytes) {
+    char header[headerBytes] = {0};
+    std::memcpy(header, "MLTRACE2", 8);
+    StoreLE(header + 8, dataBytes, 4);
+    out_.write(header, headerBytes);
+  }
+
+  bool IsOpen() const { return static_cast<bool>(out_); }
+
+  void Write(const TraceRecord& rec) {
+    std::fill(buf_.begin(), buf_.end(), 0);
+    StoreLE(&buf_[0], rec.delay, 4);
+    buf_[4] = rec.op;
+    buf_[5] = rec.absolute ? 1 : 0;
+    StoreLE(&buf_[8], rec.addr, 8);
+    StoreLE(&buf_[16], (rec.dep < 0) ? 0xffffffffULL : static_cast<unsigned long long>(rec.dep), 4);
+    for (unsigned int i = 0; i < data_bytes_ && i < rec.data.size(); i++) {
+      buf_[recordBytes + i] = rec.data[i];
+    }
+    out_.write(&buf_[0], buf_.size());
+  }
+
+  void Flush() { out_.flush(); }
+
+ private:
+  std::ofstream out_;
+  unsigned int data_bytes_;
+  std::vector<char> buf_;
+
+  static void StoreLE(char* p, unsigned long long v, int n) {
+    for (int i = 0; i < n; i++) {
+      p[i] = static_cast<char>(v & 0xff);
+      v >>= 8;
+    }
+  }
+};
+
+/**
+ * \brief A streaming reader for CSV and binary request traces.
+ * \ingroup AXI
+ *
+ * \par Overview
+ * TraceReader maps a trace file into memory and parses records on demand, so
+ * a trace is never held in memory as text or as a table of strings.  At most
+ * lookahead parsed records are buffered ahead of the consumer.
+ *
+ * Two formats are recognised:
+ * - CSV, as read by MasterFromFile and SlaveFromFile (see TraceRecord).
+ *   Addresses and data are hexadecimal with an optional 0x prefix, delays are
+ *   decimal.
+ * - A compact binary format, detected by its leading magic "MLTRACE2".  The
+ *   header is the magic followed by the number of data bytes per record as a
+ *   32-bit little-endian word and 4 reserved bytes.  Each record holds a
+ *   32-bit delay, an op byte, a flags byte (bit 0: absolute delay), 2 padding
+ *   bytes, a 64-bit address, a 32-bit dependency (all ones for none), 4
+ *   padding bytes and the data bytes, all little-endian.  Traces with the
+ *   magic "MLTRACE1" have 16-byte records without the flags and dependency.
+ *
+ * ConvertCSV() writes the binary form of a CSV trace, which skips text
+ * parsing entirely and is several times smaller for wide data.  TraceWriter
+ * and AxiMonitor write binary traces directly.
+ *
+ * \code
+ *      TraceReader::ConvertCSV("requests.csv", "requests.bin", 8);
+ *      TraceReader reader("requests.bin");
+ *      TraceRecord rec;
+ *      while (reader.Next(rec)) { ... }
+ * \endcode
+ * \par
+ *
+ */
+class TraceReader {
+ public:
+  static const unsigned int headerBytes = 16;
+
+  TraceReader(const std::string& filename, unsigned int lookahead = 64, char sep = ',')
+      : file_name_(filename), sep_(sep), lookahead_(lookahead ? lookahead : 1),
+        base_(0), size_(0), pos_(0), line_(0), binary_(false), record_bytes_(0), data_bytes_(0) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd >= 0) {
+      struct stat st;
+      if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* p = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+          base_ = static_cast<const char*>(p);
+          size_ = st.st_size;
+          madvise(p, size_, MADV_SEQUENTIAL);
+        }
+      }
+      close(fd);
+    }
+    if (size_ >= headerBytes && (std::memcmp(base_, "MLTRACE1", 8) == 0 ||
+                                 std::memcmp(base_, "MLTRACE2", 8) == 0)) {
+      binary_ = true;
+      record_bytes_ = (base_[7] == '1') ? 16 : TraceWriter::recordBytes;
+      data_bytes_ = static_cast<unsigned int>(LoadLE(base_ + 8, 4));
+      pos_ = headerBytes;
+    }
+  }
+
+  ~TraceReader() {
+    if (base_) {
+      munmap(const_cast<char*>(base_), size_);
+    }
+  }
+
+  bool IsOpen() const { return base_ != 0; }
+  bool IsBinary() const { return binary_; }
+
+  // Returns the next record, or false at the end of the trace
+  bool Next(TraceRecord& rec) {
+    while (ahead_.size() < lookahead_) {
+      TraceRecord next;
+      if (!Parse(next)) break;
+      ahead_.push_back(next);
+    }
+    if (ahead_.empty()) {
+      return false;
+    }
+    rec = ahead_.front();
+    ahead_.pop_front();
+    return true;
+  }
+
+  // Writes the binary form of a CSV trace with dataBytes bytes of data per record
+  static bool ConvertCSV(const std::string& csv, const std::string& bin, unsigned int dataBytes,
+                         char sep = ',') {
+    TraceReader reader(csv, 64, sep);
+    if (!reader.IsOpen() || reader.IsBinary()) {
+      return false;
+    }
+    TraceWriter out(bin, dataBytes);
+    if (!out.IsOpen()) {
+      return false;
+    }
+    TraceRecord rec;
+    while (reader.Next(rec)) {
+      out.Write(rec);
+    }
+    return out.IsOpen();
+  }
+
+ private:
+  std::string file_name_;
+  char sep_;
+  unsigned int lookahead_;
+  const char* base_;
+  size_t size_;
+  size_t pos_;
+  unsigned long line_;
+  bool binary_;
+  unsigned int record_bytes_;
+  unsigned int data_bytes_;
+  std::deque<TraceRecord> ahead_;
+
+  static unsigned long long LoadLE(const char* p, int n) {
+    unsigned long long v = 0;
+    for (int i = n - 1; i >= 0; i--) {
+      v = (v << 8) | static_cast<unsigned char>(p[i]);
+    }
+    return v;
+  }
+
+  static int HexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  }
+
+  // Field [b, e) of the current line, without surrounding blanks
+  static void Trim(const char*& b, const char*& e) {
+    while (b < e && (*b == ' ' || *b == '\t')) ++b;
+    while (e > b && (e[-1] == ' ' || e[-1] == '\t' || e[-1] == '\r')) --e;
+  }
+
+  void Error(const char* what) const {
+    std::string msg = file_name_ + ": " + what + " on line " + std::to_string(line_);
+    BOOST_ASSERT_MSG(false, msg.c_str());
+  }
+
+  unsigned long long ParseHex(const char* b, const char* e, std::vector<unsigned char>* bytes) {
+    Trim(b, e);
+    if (e - b >= 2 && b[0] == '0' && (b[1] == 'x' || b[1] == 'X')) b += 2;
+    if (b == e) Error("empty hexadecimal field");
+    unsigned long long v = 0;
+    if (bytes) bytes->clear();
+    int nibble = 0;
+    for (const char* p = e; p > b; --p, ++nibble) {
+      int d = HexDigit(p[-1]);
+      if (d < 0) Error("bad hexadecimal digit");
+      if (nibble < 16) v |= static_cast<unsigned long long>(d) << (4 * nibble);
+      if (bytes) {
+        if ((nibble & 1) == 0) {
+          bytes->push_back(d);
+        } else {
+          bytes->back() |= d << 4;
+        }
+      }
+    }
+    return v;
+  }
+
+  unsigned long ParseDec(const char* b, const char* e) {
+    Trim(b, e);
+    if (b == e) Error("empty decimal field");
+    unsigned long v = 0;
+    for (const char* p = b; p < e; ++p) {
+      if (*p < '0' || *p > '9') Error("bad decimal digit");
+      v = v * 10 + (*p - '0');
+    }
+    return v;
+  }
+
+  bool Parse(TraceRecord& rec) {
+    if (binary_) {
+      size_t recBytes = record_bytes_ + data_bytes_;
+      if (pos_ + recBytes > size_) {
+        return false;
+      }
+      const char* p = base_ + pos_;
+      rec.delay = LoadLE(p, 4);
+      rec.op = p[4];
+      rec.addr = LoadLE(p + 8, 8);
+      rec.absolute = false;
+      rec.dep = -1;
+      if (record_bytes_ > 16) {
+        rec.absolute = (p[5] & 1) != 0;
+        unsigned long long dep = LoadLE(p + 16, 4);
+        rec.dep = (dep == 0xffffffffULL) ? -1 : static_cast<long>(dep);
+      }
+      rec.data.assign(p + record_bytes_, p + record_bytes_ + data_bytes_);
+      pos_ += recBytes;
+      ++line_;
+      return true;
+    }
+
+    while (pos_ < size_) {
+      const char* b = base_ + pos_;
+      const char* end = static_cast<const char*>(std::memchr(b, '\n', size_ - pos_));
+      if (!end) end = base_ + size_;
+      pos_ = (end - base_) + 1;
+      ++line_;
+
+      const char* fb[5];
+      const char* fe[5];
+      int n = 0;
+      const char* f = b;
+      for (const char* p = b; p <= end; ++p) {
+        if (p == end || *p == sep_) {
+          if (n < 5) {
+            fb[n] = f;
+            fe[n] = p;
+          }
+          ++n;
+          f = p + 1;
+        }
+      }
+      const char* lb = b;
+      const char* le = end;
+      Trim(lb, le);
+      if (lb == le) {
+        continue;  // blank line
+      }
+
+      if (n == 4 || n == 5) {
+        const char* db = fb[0];
+        const char* de = fe[0];
+        Trim(db, de);
+        rec.absolute = (db < de && *db == '@');
+        rec.delay = ParseDec(rec.absolute ? db + 1 : db, de);
+        const char* ob = fb[1];
+        const char* oe = fe[1];
+        Trim(ob, oe);
+        if (oe - ob != 1) Error("the request type must be a single character");
+        rec.op = *ob;
+        rec.addr = ParseHex(fb[2], fe[2], 0);
+        ParseHex(fb[3], fe[3], &rec.data);
+        rec.dep = -1;
+        if (n == 5) {
+          const char* kb = fb[4];
+          const char* ke = fe[4];
+          Trim(kb, ke);
+          if (kb != ke) rec.dep = static_cast<long>(ParseDec(kb, ke));
+        }
+      } else if (n == 2) {
+        rec.delay = 0;
+        rec.absolute = false;
+        rec.dep = -1;
+        rec.op = 'M';
+        rec.addr = ParseHex(fb[0], fe[0], 0);
+        ParseHex(fb[1], fe[1], &rec.data);
+      } else {
+        Error("a record must have two, four or five fields");
+      }
+      return true;
+    }
+    return false;
+  }
+};
+
+#endif
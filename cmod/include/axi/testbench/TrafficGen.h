@@ -0,0 +1,453 @@
+/*
+ * Copyright (c) 2017-2020, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __AXI_T_TRAFFIC_GEN__
+#define __AXI_T_TRAFFIC_GEN__
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+
+#include <axi/axi4.h>
+#include <nvhls_connections.h>
+#include <hls_globals.h>
+
+#include <deque>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <boost/assert.hpp>
+
+#include <boost/random/uniform_int_distribution.hpp>
+#include <testbench/nvhls_rand.h>
+
+/**
+ * \brief Address patterns of TrafficGen.
+ * \ingroup AXI
+ *
+ * - AxiTrafficSequential: each transaction starts where the previous one ended.
+ * - AxiTrafficStrided: each transaction starts cfg::stride bytes after the previous one.
+ * - AxiTrafficRandom: start addresses are uniformly distributed over the address range.
+ * - AxiTrafficHotspot: cfg::hotspotPercent of transactions go to the hotspot window
+ *   [hotspotBase, hotspotBase+hotspotBytes), the rest are uniformly distributed.
+ *
+ * Sequential and strided patterns wrap around to addrBoundLower at the end of the range.
+ */
+enum axi_traffic_pattern { AxiTrafficSequential, AxiTrafficStrided, AxiTrafficRandom, AxiTrafficHotspot };
+
+/**
+ * \brief An example config for the AXI traffic generator.
+ *
+ * \par The following constants must be defined:
+ *
+ * - numTransactions: The number of transactions to generate.
+ * - readPercent: The percentage of transactions that are reads.
+ * - injectionRate: The offered load, in transactions per 1000 cycles.
+ * - minBeats, maxBeats: The burst length in beats is uniformly distributed between these bounds.
+ * - addrPattern: The address pattern (see axi_traffic_pattern).
+ * - stride: The address increment in bytes of AxiTrafficStrided.
+ * - hotspotPercent: The percentage of AxiTrafficHotspot transactions that target the hotspot window.
+ * - maxOutstanding: The number of transactions that may be in flight on the AXI interface.
+ * - histBinCycles: The width in cycles of each latency histogram bin.
+ * - histBins: The number of latency histogram bins.  The last bin collects all larger latencies.
+ * - seed: The random seed, combined with the instance name into an nvhls::RandStream.
+ * - addrBoundLower, addrBoundUpper: The bounds of generated addresses.
+ * - hotspotBase, hotspotBytes: The hotspot window of AxiTrafficHotspot.
+ */
+struct trafficGenCfg {
+  enum {
+    numTransactions = 1000,
+    readPercent = 50,
+    injectionRate = 100,
+    minBeats = 1,
+    maxBeats = 4,
+    addrPattern = AxiTrafficRandom,
+    stride = 256,
+    hotspotPercent = 0,
+    maxOutstanding = 8,
+    histBinCycles = 4,
+    histBins = 32,
+    seed = 0,
+  };
+  static const uint64_t addrBoundLower = 0;
+  static const uint64_t addrBoundUpper = 0xFFFF;
+  static const uint64_t hotspotBase = 0;
+  static const uint64_t hotspotBytes = 0x400;
+};
+
+/**
+ * \brief A latency histogram with fixed-width bins.
+ * \ingroup AXI
+ *
+ * The last bin collects all latencies beyond the range of the others.  Every sample is also kept so
+ * percentiles are exact.
+ */
+class TrafficHistogram {
+ public:
+  TrafficHistogram(unsigned int binCycles, unsigned int numBins)
+      : binCycles_(binCycles), bins_(numBins, 0), sorted_(true) {}
+
+  void Add(unsigned long latency) {
+    unsigned long bin = latency / binCycles_;
+    if (bin >= bins_.size()) bin = bins_.size() - 1;
+    bins_[bin]++;
+    samples_.push_back(latency);
+    sorted_ = false;
+  }
+
+  unsigned long Count() const { return samples_.size(); }
+
+  double Mean() const {
+    if (samples_.empty()) return 0;
+    double sum = 0;
+    for (unsigned int i = 0; i < samples_.size(); i++) sum += samples_[i];
+    return sum / samples_.size();
+  }
+
+  // Smallest latency that is not exceeded by pct percent of the samples
+  unsigned long Percentile(double pct) {
+    if (samples_.empty()) return 0;
+    if (!sorted_) {
+      std::sort(samples_.begin(), samples_.end());
+      sorted_ = true;
+    }
+    unsigned long idx = static_cast<unsigned long>(pct / 100.0 * (samples_.size() - 1) + 0.5);
+    return samples_[idx];
+  }
+
+  unsigned long Max() { return Percentile(100); }
+
+  const std::vector<unsigned long>& Bins() const { return bins_; }
+  unsigned int BinCycles() const { return binCycles_; }
+
+  // Prints the summary line and every non-empty bin
+  void Print(std::ostream& os, const std::string& label) {
+    os << "  " << label << " latency: n=" << Count() << " mean=" << Mean()
+       << " p50=" << Percentile(50) << " p90=" << Percentile(90)
+       << " p99=" << Percentile(99) << " max=" << Max() << std::endl;
+    for (unsigned int i = 0; i < bins_.size(); i++) {
+      if (bins_[i] == 0) continue;
+      os << "    [" << i * binCycles_ << ", ";
+      if (i == bins_.size() - 1)
+        os << "inf";
+      else
+        os << (i + 1) * binCycles_;
+      os << ") " << bins_[i] << std::endl;
+    }
+  }
+
+ private:
+  unsigned int binCycles_;
+  std::vector<unsigned long> bins_;
+  std::vector<unsigned long> samples_;
+  bool sorted_;
+};
+
+/**
+ * \brief An AXI master that generates open-loop, rate-controlled traffic for latency and throughput measurements.
+ * \ingroup AXI
+ *
+ * \tparam axiCfg                   A valid AXI config.
+ * \tparam cfg                      A valid config for the traffic generator (such as trafficGenCfg).
+ *
+ * \par Overview
+ * Unlike Master, which issues requests as fast as backpressure allows, TrafficGen creates
+ * transactions at a fixed offered load and measures how long the system under test takes to complete
+ * them.  Every cycle a new transaction is created with probability injectionRate/1000, independently
+ * of backpressure.  Created transactions wait in an unbounded source queue and are issued in order
+ * whenever fewer than maxOutstanding transactions are in flight.  Latency is measured from creation to
+ * the last read data beat or the write response (or the last write data beat without write
+ * responses), so it includes queueing in the source and grows without bound once the offered load
+ * exceeds what the system can accept.
+ *
+ * Read and write latencies are recorded in separate TrafficHistogram objects.  When all transactions
+ * have completed, done is asserted; PrintStats() then reports the offered and accepted load together
+ * with the latency distributions, which gives one point of a latency/throughput curve.  The
+ * TRAFFIC_RATE environment variable overrides injectionRate, so a curve can be swept without
+ * recompiling:
+ *
+ * \code
+ *      for r in 50 100 200 400; do TRAFFIC_RATE=$r ./sim_test; done
+ * \endcode
+ *
+ * Write data is not checked, and reads may target addresses that were never written, so the slave
+ * must not require reads to follow writes (the testbench Slave does).  All transactions use ID 0,
+ * and bursts never cross a 4KB boundary.
+ *
+ */
+template <typename axiCfg, typename cfg>
+class TrafficGen : public sc_module {
+  BOOST_STATIC_ASSERT_MSG(cfg::minBeats >= 1 && cfg::minBeats <= cfg::maxBeats,
+                "minBeats must be at least 1 and no larger than maxBeats");
+  BOOST_STATIC_ASSERT_MSG(axiCfg::useBurst ? cfg::maxBeats <= axiCfg::maxBurstSize : cfg::maxBeats == 1,
+                "maxBeats must not exceed the burst size of the AXI config");
+  BOOST_STATIC_ASSERT_MSG(cfg::readPercent <= 100 && cfg::injectionRate <= 1000,
+                "readPercent must be at most 100 and injectionRate at most 1000");
+  BOOST_STATIC_ASSERT_MSG(cfg::maxOutstanding >= 1 && cfg::histBins >= 1 && cfg::histBinCycles >= 1,
+                "maxOutstanding, histBins and histBinCycles must be positive");
+ public:
+  static const int kDebugLevel = 0;
+  typedef axi::axi4<axiCfg> axi4_;
+
+  typename axi4_::read::template master<> if_rd;
+  typename axi4_::write::template master<> if_wr;
+
+  sc_in<bool> reset_bar;
+  sc_in<bool> clk;
+
+  static const int bytesPerBeat = axi4_::DATA_WIDTH >> 3;
+  static const bool wResp = axiCfg::useWriteResponses;
+
+  sc_out<bool> done;
+
+  SC_CTOR(TrafficGen)
+      : if_rd("if_rd"), if_wr("if_wr"), reset_bar("reset_bar"), clk("clk"),
+        rd_latency(cfg::histBinCycles, cfg::histBins),
+        wr_latency(cfg::histBinCycles, cfg::histBins),
+        rate(cfg::injectionRate), generated(0), completed(0), beats_completed(0),
+        first_created(0), last_completed(0) {
+    const char* env_rate = std::getenv("TRAFFIC_RATE");
+    if (env_rate != NULL) rate = atoi(env_rate);
+    BOOST_ASSERT_MSG(rate <= 1000, "TRAFFIC_RATE must be at most 1000 transactions per 1000 cycles");
+    BOOST_ASSERT_MSG(cfg::addrBoundUpper - cfg::addrBoundLower + 1 >= cfg::maxBeats * bytesPerBeat,
+                     "The address range must hold a burst of maxBeats beats");
+
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+  }
+
+  TrafficHistogram& ReadLatency() { return rd_latency; }
+  TrafficHistogram& WriteLatency() { return wr_latency; }
+
+  // Offered load in transactions per cycle
+  double OfferedRate() const { return rate / 1000.0; }
+
+  // Cycles from the first created to the last completed transaction
+  unsigned long Cycles() const { return completed == 0 ? 0 : last_completed - first_created + 1; }
+
+  // Number of completed transactions
+  unsigned long Completed() const { return completed; }
+
+  // Accepted load in transactions per cycle
+  double AcceptedRate() const { return Cycles() == 0 ? 0 : static_cast<double>(completed) / Cycles(); }
+
+  // Reports offered and accepted load and both latency histograms
+  void PrintStats(std::ostream& os = std::cout) {
+    os << name() << ": offered " << OfferedRate() << " txn/cycle, accepted "
+       << AcceptedRate() << " txn/cycle ("
+       << (Cycles() == 0 ? 0 : static_cast<double>(beats_completed) / Cycles())
+       << " beats/cycle) over " << Cycles() << " cycles" << std::endl;
+    rd_latency.Print(os, "read ");
+    wr_latency.Print(os, "write");
+  }
+
+ protected:
+  struct Request {
+    bool read;
+    uint64_t addr;
+    unsigned int beats;
+    unsigned long created;
+  };
+
+  TrafficHistogram rd_latency;
+  TrafficHistogram wr_latency;
+  unsigned int rate;
+  unsigned long generated;
+  unsigned long completed;
+  unsigned long beats_completed;
+  unsigned long first_created;
+  unsigned long last_completed;
+
+  // Start address of the next transaction; may shorten the burst so that it stays within the address
+  // range and does not cross a 4KB boundary
+  template <typename Gen>
+  uint64_t NextAddr(Gen& gen, uint64_t& next_addr, unsigned int& beats) {
+    static const uint64_t lower = (cfg::addrBoundLower + bytesPerBeat - 1) / bytesPerBeat * bytesPerBeat;
+    boost::random::uniform_int_distribution<uint64_t> random_addr(cfg::addrBoundLower, cfg::addrBoundUpper);
+    boost::random::uniform_int_distribution<uint64_t> hotspot_addr(cfg::hotspotBase,
+                                                                   cfg::hotspotBase + cfg::hotspotBytes - 1);
+    boost::random::uniform_int_distribution<> percent(0, 99);
+
+    uint64_t addr;
+    if (cfg::addrPattern == AxiTrafficSequential || cfg::addrPattern == AxiTrafficStrided) {
+      addr = next_addr;
+      if (addr + beats * bytesPerBeat - 1 > cfg::addrBoundUpper) addr = lower;
+      next_addr = addr + (cfg::addrPattern == AxiTrafficSequential ? beats * bytesPerBeat
+                                                                   : static_cast<uint64_t>(cfg::stride));
+    } else if (cfg::addrPattern == AxiTrafficHotspot && percent(gen) < cfg::hotspotPercent) {
+      addr = hotspot_addr(gen);
+    } else {
+      addr = random_addr(gen);
+    }
+    addr = addr / bytesPerBeat * bytesPerBeat; // Keep all requests beat-aligned
+    if (addr < lower) addr = lower;
+    while (addr + beats * bytesPerBeat - 1 > cfg::addrBoundUpper) beats--;
+    if (beats == 0) {
+      addr = lower;
+      beats = 1;
+    }
+    unsigned int page_beats = (4096 - (addr & 4095)) / bytesPerBeat;
+    if (beats > page_beats) beats = page_beats;
+    return addr;
+  }
+
+  void run() {
+    std::deque<Request> source;   // Created but not yet issued
+    std::deque<Request> rd_q;     // Reads awaiting data
+    std::deque<Request> wr_q;     // Writes awaiting completion
+    std::deque<Request> wdata_q;  // Writes whose data has not been sent
+    unsigned int outstanding = 0;
+    unsigned int rd_beat = 0;
+    unsigned int wr_beat = 0;
+    unsigned long cycle = 0;
+
+    // Follow the same priority as nvhls_rand: environment, then preprocessor define, then config
+    unsigned int seed = cfg::seed;
+#ifdef RAND_SEED
+    seed = (RAND_SEED);
+#endif
+    const char* env_rand_seed = std::getenv("RAND_SEED");
+    if (env_rand_seed != NULL) seed = atoi(env_rand_seed);
+    nvhls::RandStream gen(seed, name());
+    boost::random::uniform_int_distribution<> permille(0, 999);
+    boost::random::uniform_int_distribution<> percent(0, 99);
+    boost::random::uniform_int_distribution<> random_beats(cfg::minBeats, cfg::maxBeats);
+    uint64_t next_addr = cfg::addrBoundLower;
+
+    typename axi4_::AddrPayload addr_pld;
+    typename axi4_::WritePayload wr_data_pld;
+    typename axi4_::ReadPayload data_pld;
+    typename axi4_::WRespPayload wr_resp_pld;
+
+    done = 0;
+
+    if_rd.reset();
+    if_wr.reset();
+
+    wait(20);
+    while (1) {
+      wait();
+      cycle++;
+
+      // CREATE: open loop, independent of backpressure
+      if (generated < cfg::numTransactions && static_cast<unsigned int>(permille(gen)) < rate) {
+        Request req;
+        req.read = percent(gen) < cfg::readPercent;
+        req.beats = random_beats(gen);
+        req.addr = NextAddr(gen, next_addr, req.beats);
+        req.created = cycle;
+        if (generated++ == 0) first_created = cycle;
+        source.push_back(req);
+      }
+
+      // ISSUE
+      if (!source.empty() && outstanding < cfg::maxOutstanding) {
+        Request& req = source.front();
+        addr_pld.addr = static_cast<typename axi4_::Addr>(req.addr);
+        if (axiCfg::useBurst) {
+          addr_pld.len = req.beats - 1;
+        }
+        if (req.read ? if_rd.ar.PushNB(addr_pld) : if_wr.aw.PushNB(addr_pld)) {
+          CDCOUT(sc_time_stamp() << " " << name() << " Sent " << (req.read ? "read" : "write")
+                        << " request: [" << addr_pld << "]"
+                        << " queued=" << dec << cycle - req.created
+                        << endl, kDebugLevel);
+          if (req.read) {
+            rd_q.push_back(req);
+          } else {
+            wr_q.push_back(req);
+            wdata_q.push_back(req);
+          }
+          outstanding++;
+          source.pop_front();
+        }
+      }
+
+      // WRITE DATA
+      if (!wdata_q.empty()) {
+        Request& req = wdata_q.front();
+        typename axi4_::Addr beat_addr = static_cast<typename axi4_::Addr>(req.addr + wr_beat * bytesPerBeat);
+        wr_data_pld.data = 0xf00dcafe12345678 ^ (static_cast<typename axi4_::Data>(beat_addr) << 16);
+        wr_data_pld.wstrb = ~0;
+        wr_data_pld.last = (wr_beat == req.beats - 1);
+        if (if_wr.w.PushNB(wr_data_pld)) {
+          if (++wr_beat == req.beats) {
+            wr_beat = 0;
+            wdata_q.pop_front();
+            if (!wResp) {
+              wr_latency.Add(cycle - wr_q.front().created);
+              beats_completed += wr_q.front().beats;
+              wr_q.pop_front();
+              outstanding--;
+              completed++;
+              last_completed = cycle;
+            }
+          }
+        }
+      }
+
+      // RESPONSES
+      if (if_rd.r.PopNB(data_pld)) {
+        std::ostringstream msg;
+        msg << "\nError @" << sc_time_stamp() << " from " << name()
+            << ": Read response protocol error"
+            << ", rresp=" << data_pld.resp.to_uint64()
+            << std::endl;
+        BOOST_ASSERT_MSG( !rd_q.empty(), msg.str().c_str() );
+        BOOST_ASSERT_MSG( (data_pld.resp == axi4_::Enc::XRESP::OKAY) |
+                          (data_pld.resp == axi4_::Enc::XRESP::EXOKAY), msg.str().c_str() );
+        if (++rd_beat == rd_q.front().beats) {
+          rd_beat = 0;
+          rd_latency.Add(cycle - rd_q.front().created);
+          CDCOUT(sc_time_stamp() << " " << name() << " Read complete, latency="
+                        << dec << cycle - rd_q.front().created
+                        << endl, kDebugLevel);
+          beats_completed += rd_q.front().beats;
+          rd_q.pop_front();
+          outstanding--;
+          completed++;
+          last_completed = cycle;
+        }
+      }
+      if (wResp && if_wr.b.PopNB(wr_resp_pld)) {
+        std::ostringstream msg;
+        msg << "\nError @" << sc_time_stamp() << " from " << name()
+            << ": Write response protocol error"
+            << ", bresp=" << wr_resp_pld.resp.to_uint64()
+            << std::endl;
+        BOOST_ASSERT_MSG( !wr_q.empty() && wr_q.size() > wdata_q.size(), msg.str().c_str() );
+        BOOST_ASSERT_MSG( (wr_resp_pld.resp == axi4_::Enc::XRESP::OKAY) |
+                          (wr_resp_pld.resp == axi4_::Enc::XRESP::EXOKAY), msg.str().c_str() );
+        wr_latency.Add(cycle - wr_q.front().created);
+        CDCOUT(sc_time_stamp() << " " << name() << " Write complete, latency="
+                      << dec << cycle - wr_q.front().created
+                      << endl, kDebugLevel);
+        beats_completed += wr_q.front().beats;
+        wr_q.pop_front();
+        outstanding--;
+        completed++;
+        last_completed = cycle;
+      }
+
+      if (generated == cfg::numTransactions && completed == cfg::numTransactions)
+        done = 1;
+    }
+  }
+};
+
+#endif
@@ -24,6 +24,7 @@
 
 #include <iostream>
 #include <nvhls_marshaller.h>
+#include <nvhls_int.h>
 
 using namespace std;
 
@@ -46,8 +47,8 @@ using namespace std;
  * input array, which must be sized to a power of two.
  *
  * This specialization is for arrays implemented as a bitvector in which each
- * element is of the same bitwidth as that of ElemT. As SC datatypes do not
- * have a slice operator, we use bitshifts to access the corresponding element.
+ * element is of the same bitwidth as that of ElemT. Elements are read with
+ * nvhls::get_slc, so ArrT can be an SC or AC type.
  * 
  * \par A Simple Example
  * \code
@@ -78,7 +79,7 @@ class Minmax {
     ElemT temp[TotalElems];
 #pragma hls_unroll yes
     for (unsigned i = 0; i < TotalElems; i++)
-      temp[i] = inputs.range((i + 1) * ElemWidth - 1, i * ElemWidth);
+      temp[i] = nvhls::get_slc<ElemWidth>(inputs, i * ElemWidth);
 
     IdxT upper_branch = Minmax<ArrT, ElemT, IdxT, is_max, Width / 2>::minmax(
         inputs, (start + end) / 2 + 1, end);
@@ -103,7 +104,7 @@ class Minmax<ArrT, ElemT, IdxT, is_max, 2> {
     ElemT temp[TotalElems];
 #pragma hls_unroll yes
     for (unsigned i = 0; i < TotalElems; i++)
-      temp[i] = inputs.range((i + 1) * ElemWidth - 1, i * ElemWidth);
+      temp[i] = nvhls::get_slc<ElemWidth>(inputs, i * ElemWidth);
 
     if (is_max)
       return temp[start] > temp[end] ? start : end;
@@ -233,4 +234,698 @@ class PriEnc<VecT, ValT, IdxT, 1> {
   }
 };
 
+/**
+ * \brief Compile-time priority encoder tree
+ * \ingroup comptrees
+ *
+ * \tparam VecT   Bitvector type
+ * \tparam ValT   Value type
+ * \tparam IdxT   Signed type of the return value, of size log2(Width)+1
+ * \tparam Width  The number of bits this instance of the tree searches
+ *
+ * \par Overview
+ * Same result as PriEnc: the position of the first (starting from LSB) bit
+ * equal to comp_value, or -1 if there is none. The search splits the range in
+ * halves and selects the lower half result if it found a match, so the
+ * select logic has a depth of log2(Width) instead of a chain of Width
+ * comparisons. Width does not need to be a power of 2.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <comptrees.h>
+ *
+ *      ...
+ *      typedef NVUINTW(64) vec_t;
+ *      typedef NVINTW(7) idx_t;
+ *      vec_t busy;
+ *      idx_t first_free = PriEncTree<vec_t, bool, idx_t, 64>::val(busy, 0);
+ *      ...
+ *
+ * \endcode
+ *
+ */
+template <typename VecT, typename ValT, typename IdxT, unsigned Width>
+class PriEncTree {
+ public:
+  static IdxT val(VecT inputs, ValT comp_value) {
+    return PriEncTree<VecT, ValT, IdxT, Width>::val(inputs, comp_value, 0);
+  }
+
+  static IdxT val(VecT inputs, ValT comp_value, unsigned start) {
+    static const unsigned LowerWidth = Width / 2;
+    IdxT lower_branch = PriEncTree<VecT, ValT, IdxT, LowerWidth>::val(
+        inputs, comp_value, start);
+    IdxT upper_branch = PriEncTree<VecT, ValT, IdxT, Width - LowerWidth>::val(
+        inputs, comp_value, start + LowerWidth);
+    return (lower_branch != -1) ? lower_branch : upper_branch;
+  }
+};
+
+// Base condition for Width = 1.
+template <typename VecT, typename ValT, typename IdxT>
+class PriEncTree<VecT, ValT, IdxT, 1> {
+ public:
+  static IdxT val(VecT inputs, ValT comp_value) {
+    return PriEncTree<VecT, ValT, IdxT, 1>::val(inputs, comp_value, 0);
+  }
+
+  static IdxT val(VecT inputs, ValT comp_value, unsigned start) {
+    IdxT retval = -1;
+    if (inputs[start] == comp_value) {
+      retval = start;
+    }
+    return retval;
+  }
+};
+
+/**
+ * \brief Compile-time one-hot priority encoder tree
+ * \ingroup comptrees
+ *
+ * \tparam VecT   Bitvector type
+ * \tparam ValT   Value type
+ * \tparam OutT   One-hot output type, at least Width bits wide
+ * \tparam Width  The number of bits this instance of the tree searches
+ *
+ * \par Overview
+ * Returns a one-hot vector with the position of the first (starting from LSB)
+ * bit equal to comp_value set, or 0 if there is none. The result can drive
+ * one-hot mux selects directly, without decoding the index returned by
+ * PriEncTree. Like PriEncTree the select logic has a depth of log2(Width).
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <comptrees.h>
+ *
+ *      ...
+ *      typedef NVUINTW(16) vec_t;
+ *      vec_t requests;
+ *      vec_t grant = PriEncOneHot<vec_t, bool, vec_t, 16>::val(requests, 1);
+ *      ...
+ *
+ * \endcode
+ *
+ */
+template <typename VecT, typename ValT, typename OutT, unsigned Width>
+class PriEncOneHot {
+ public:
+  static OutT val(VecT inputs, ValT comp_value) {
+    bool found;
+    return PriEncOneHot<VecT, ValT, OutT, Width>::val(inputs, comp_value, 0,
+                                                      found);
+  }
+
+  static OutT val(VecT inputs, ValT comp_value, unsigned start, bool& found) {
+    static const unsigned LowerWidth = Width / 2;
+    bool lower_found, upper_found;
+    OutT lower_branch = PriEncOneHot<VecT, ValT, OutT, LowerWidth>::val(
+        inputs, comp_value, start, lower_found);
+    OutT upper_branch = PriEncOneHot<VecT, ValT, OutT, Width - LowerWidth>::val(
+        inputs, comp_value, start + LowerWidth, upper_found);
+    found = lower_found || upper_found;
+    return lower_found ? lower_branch : upper_branch;
+  }
+};
+
+// Base condition for Width = 1.
+template <typename VecT, typename ValT, typename OutT>
+class PriEncOneHot<VecT, ValT, OutT, 1> {
+ public:
+  static OutT val(VecT inputs, ValT comp_value) {
+    bool found;
+    return PriEncOneHot<VecT, ValT, OutT, 1>::val(inputs, comp_value, 0, found);
+  }
+
+  static OutT val(VecT inputs, ValT comp_value, unsigned start, bool& found) {
+    OutT retval = 0;
+    found = (inputs[start] == comp_value);
+    if (found) {
+      retval[start] = 1;
+    }
+    return retval;
+  }
+};
+
+/**
+ * \brief Compile-time priority encoder tree returning the first K matches
+ * \ingroup comptrees
+ *
+ * \tparam VecT   Bitvector type
+ * \tparam ValT   Value type
+ * \tparam IdxT   Signed type of the indices, of size log2(Width)+1
+ * \tparam Width  The number of bits this instance of the tree searches
+ * \tparam K      Number of indices returned
+ *
+ * \par Overview
+ * Writes the positions of the first K (starting from LSB) bits equal to
+ * comp_value to idx[0..K-1] in increasing order, and -1 to the remaining
+ * entries if there are fewer matches. Returns the number of valid entries.
+ * The two halves of the range are searched independently and their lists
+ * merged, so the depth is log2(Width) merge steps. Useful for allocators that
+ * hand out up to K entries per cycle.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <comptrees.h>
+ *
+ *      ...
+ *      typedef NVUINTW(32) vec_t;
+ *      typedef NVINTW(6) idx_t;
+ *      vec_t busy;
+ *      idx_t free_ids[4];
+ *      unsigned num_free = PriEncFirstK<vec_t, bool, idx_t, 32, 4>::val(busy, 0, free_ids);
+ *      ...
+ *
+ * \endcode
+ *
+ */
+template <typename VecT, typename ValT, typename IdxT, unsigned Width,
+          unsigned K>
+class PriEncFirstK {
+ public:
+  typedef NVUINTW(nvhls::nbits<K>::val) count_t;
+
+  static count_t val(VecT inputs, ValT comp_value, IdxT (&idx)[K]) {
+    return PriEncFirstK<VecT, ValT, IdxT, Width, K>::val(inputs, comp_value, 0,
+                                                         idx);
+  }
+
+  static count_t val(VecT inputs, ValT comp_value, unsigned start,
+                     IdxT (&idx)[K]) {
+    static const unsigned LowerWidth = Width / 2;
+    IdxT lower_idx[K], upper_idx[K];
+    count_t lower_count = PriEncFirstK<VecT, ValT, IdxT, LowerWidth, K>::val(
+        inputs, comp_value, start, lower_idx);
+    count_t upper_count =
+        PriEncFirstK<VecT, ValT, IdxT, Width - LowerWidth, K>::val(
+            inputs, comp_value, start + LowerWidth, upper_idx);
+#pragma hls_unroll yes
+    for (unsigned j = 0; j < K; j++) {
+      idx[j] = (j < lower_count) ? lower_idx[j] : upper_idx[j - lower_count];
+    }
+    NVUINTW(nvhls::nbits<K>::val + 1) count = lower_count + upper_count;
+    return (count > K) ? count_t(K) : count_t(count);
+  }
+};
+
+// Base condition for Width = 1.
+template <typename VecT, typename ValT, typename IdxT, unsigned K>
+class PriEncFirstK<VecT, ValT, IdxT, 1, K> {
+ public:
+  typedef NVUINTW(nvhls::nbits<K>::val) count_t;
+
+  static count_t val(VecT inputs, ValT comp_value, IdxT (&idx)[K]) {
+    return PriEncFirstK<VecT, ValT, IdxT, 1, K>::val(inputs, comp_value, 0,
+                                                     idx);
+  }
+
+  static count_t val(VecT inputs, ValT comp_value, unsigned start,
+                     IdxT (&idx)[K]) {
+#pragma hls_unroll yes
+    for (unsigned j = 0; j < K; j++) {
+      idx[j] = -1;
+    }
+    count_t count = 0;
+    if (inputs[start] == comp_value) {
+      idx[0] = start;
+      count = 1;
+    }
+    return count;
+  }
+};
+
+/**
+ * \brief Compile-time thermometer code generator tree
+ * \ingroup comptrees
+ *
+ * \tparam VecT   Bitvector type
+ * \tparam ValT   Value type
+ * \tparam OutT   Output type, at least Width bits wide
+ * \tparam Width  The number of bits this instance of the tree searches
+ *
+ * \par Overview
+ * Returns a vector in which bit i is set if any of the bits 0..i of the
+ * input equals comp_value, i.e. all bits from the first match (starting from
+ * LSB) upwards are set. This is the mask used by round-robin arbiters; the
+ * one-hot first match is out & ~(out << 1). The prefix is built from the two
+ * halves of the range, so the depth is log2(Width).
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <comptrees.h>
+ *
+ *      ...
+ *      typedef NVUINTW(8) vec_t;
+ *      vec_t x = 0x24;
+ *      vec_t mask = Thermometer<vec_t, bool, vec_t, 8>::val(x, 1);  // 0xfc
+ *      ...
+ *
+ * \endcode
+ *
+ */
+template <typename VecT, typename ValT, typename OutT, unsigned Width>
+class Thermometer {
+ public:
+  static OutT val(VecT inputs, ValT comp_value) {
+    bool found;
+    return Thermometer<VecT, ValT, OutT, Width>::val(inputs, comp_value, 0,
+                                                     found);
+  }
+
+  static OutT val(VecT inputs, ValT comp_value, unsigned start, bool& found) {
+    static const unsigned LowerWidth = Width / 2;
+    bool lower_found, upper_found;
+    OutT lower_branch = Thermometer<VecT, ValT, OutT, LowerWidth>::val(
+        inputs, comp_value, start, lower_found);
+    OutT upper_branch = Thermometer<VecT, ValT, OutT, Width - LowerWidth>::val(
+        inputs, comp_value, start + LowerWidth, upper_found);
+    if (lower_found) {
+#pragma hls_unroll yes
+      for (unsigned i = LowerWidth; i < Width; i++) {
+        upper_branch[start + i] = 1;
+      }
+    }
+    found = lower_found || upper_found;
+    return lower_branch | upper_branch;
+  }
+};
+
+// Base condition for Width = 1.
+template <typename VecT, typename ValT, typename OutT>
+class Thermometer<VecT, ValT, OutT, 1> {
+ public:
+  static OutT val(VecT inputs, ValT comp_value) {
+    bool found;
+    return Thermometer<VecT, ValT, OutT, 1>::val(inputs, comp_value, 0, found);
+  }
+
+  static OutT val(VecT inputs, ValT comp_value, unsigned start, bool& found) {
+    OutT retval = 0;
+    found = (inputs[start] == comp_value);
+    if (found) {
+      retval[start] = 1;
+    }
+    return retval;
+  }
+};
+
+/**
+ * \brief Compile-time exclusive prefix count tree
+ * \ingroup comptrees
+ *
+ * \tparam VecT   Bitvector type
+ * \tparam ValT   Value type
+ * \tparam CountT Type of the counts, of size log2(N)+1
+ * \tparam Width  The number of bits this instance of the tree counts
+ * \tparam N      Size of the count array (default: Width)
+ *
+ * \par Overview
+ * Writes to count[i] the number of bits 0..i-1 equal to comp_value and
+ * returns the number over all Width bits. The two halves of the range are
+ * counted independently and the lower total is added to the upper counts, so
+ * the depth is log2(Width) adders. count[i] is the lane that element i moves
+ * to when the elements with a matching bit are packed to the front.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <comptrees.h>
+ *
+ *      ...
+ *      typedef NVUINTW(8) vec_t;
+ *      typedef NVUINTW(4) count_t;
+ *      vec_t mask = 0x5a;
+ *      count_t rank[8];
+ *      count_t total = PrefixCount<vec_t, bool, count_t, 8>::val(mask, 1, rank);  // 4, rank = {0, 0, 1, 2, 2, 3, 3, 4}
+ *      ...
+ *
+ * \endcode
+ *
+ */
+template <typename VecT, typename ValT, typename CountT, unsigned Width,
+          unsigned N = Width>
+class PrefixCount {
+ public:
+  static CountT val(VecT inputs, ValT comp_value, CountT (&count)[N]) {
+    return PrefixCount<VecT, ValT, CountT, Width, N>::val(inputs, comp_value, 0,
+                                                          count);
+  }
+
+  static CountT val(VecT inputs, ValT comp_value, unsigned start,
+                    CountT (&count)[N]) {
+    static const unsigned LowerWidth = Width / 2;
+    CountT lower_total = PrefixCount<VecT, ValT, CountT, LowerWidth, N>::val(
+        inputs, comp_value, start, count);
+    CountT upper_total =
+        PrefixCount<VecT, ValT, CountT, Width - LowerWidth, N>::val(
+            inputs, comp_value, start + LowerWidth, count);
+#pragma hls_unroll yes
+    for (unsigned i = LowerWidth; i < Width; i++) {
+      count[start + i] += lower_total;
+    }
+    return lower_total + upper_total;
+  }
+};
+
+// Base condition for Width = 1.
+template <typename VecT, typename ValT, typename CountT, unsigned N>
+class PrefixCount<VecT, ValT, CountT, 1, N> {
+ public:
+  static CountT val(VecT inputs, ValT comp_value, CountT (&count)[N]) {
+    return PrefixCount<VecT, ValT, CountT, 1, N>::val(inputs, comp_value, 0,
+                                                      count);
+  }
+
+  static CountT val(VecT inputs, ValT comp_value, unsigned start,
+                    CountT (&count)[N]) {
+    count[start] = 0;
+    return (inputs[start] == comp_value) ? CountT(1) : CountT(0);
+  }
+};
+
+/**
+ * \brief Minmax tree registered every LevelsPerStage levels
+ * \ingroup comptrees
+ *
+ * \tparam ArrT           Array type, a bitvector of N elements
+ * \tparam ElemT          Element type
+ * \tparam IdxT           Type of the index
+ * \tparam is_max         true if this is a max function, false for min
+ * \tparam N              Number of elements. Need not be a power of 2
+ * \tparam LevelsPerStage Number of comparator levels between pipeline registers
+ *
+ * \par Overview
+ * - Each call of run() is one cycle and accepts a new input. The index (and value) of the largest or smallest element appears Latency calls later, with Latency = ceil(log2(N) / LevelsPerStage) - 1.
+ * - Ties are broken as in Minmax: the upper element of each leaf pair and the lower branch above the leaves. For a power-of-2 N the index is the same as the one Minmax returns for the range 0..N-1.
+ * - reduce_levels(vals, idx, lo, hi) applies comparator levels [lo, hi) of the tree and is the combinational step of each pipeline stage.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <comptrees.h>
+ *
+ *      ...
+ *      typedef NVUINTW(8) score_t;
+ *      typedef NVUINTW(8 * 256) scores_t;
+ *      typedef NVUINTW(8) idx_t;
+ *      PipelinedMinmax<scores_t, score_t, idx_t, true, 256, 2> argmax;  // Latency 3
+ *      ...
+ *      bool out_valid = argmax.run(in_valid, scores, best_idx);
+ *      ...
+ *
+ * \endcode
+ *
+ */
+template <typename ArrT, typename ElemT, typename IdxT, bool is_max, unsigned N,
+          unsigned LevelsPerStage>
+class PipelinedMinmax {
+ public:
+  static const unsigned Levels = nvhls::log2_ceil<N>::val;
+  static const unsigned NumGroups =
+      (Levels > 0) ? (Levels + LevelsPerStage - 1) / LevelsPerStage : 1;
+  static const unsigned Latency = NumGroups - 1;
+
+ private:
+  static const unsigned NumRegs = (Latency > 0) ? Latency : 1;
+  ElemT regs_val[NumRegs][N];
+  IdxT regs_idx[NumRegs][N];
+  bool regs_valid[NumRegs];
+
+ public:
+  PipelinedMinmax() { reset(); }
+
+  void reset() {
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumRegs; i++) {
+      regs_valid[i] = false;
+    }
+  }
+
+  // After level l, vals[i] and idx[i] hold the result of elements
+  // i .. i + 2^(l+1) - 1 for every i that is a multiple of 2^(l+1)
+  static void reduce_levels(ElemT (&vals)[N], IdxT (&idx)[N], unsigned lo,
+                            unsigned hi) {
+#pragma hls_unroll yes
+    for (unsigned l = 0; l < Levels; l++) {
+      if ((l >= lo) && (l < hi)) {
+        const unsigned dist = 1u << l;
+#pragma hls_unroll yes
+        for (unsigned i = 0; i < N; i++) {
+          if (((i % (2 * dist)) == 0) && (i + dist < N)) {
+            bool take_upper = (l == 0) ? (is_max ? !(vals[i] > vals[i + dist])
+                                                 : !(vals[i] < vals[i + dist]))
+                                       : (is_max ? (vals[i + dist] > vals[i])
+                                                 : (vals[i + dist] < vals[i]));
+            if (take_upper) {
+              vals[i] = vals[i + dist];
+              idx[i] = idx[i + dist];
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // Returns true if out_idx and out_val hold a valid result in this cycle
+  bool run(bool in_valid, ArrT inputs, IdxT& out_idx, ElemT& out_val) {
+    const unsigned ElemWidth = Wrapped<ElemT>::width;
+    bool out_valid = false;
+#pragma hls_unroll yes
+    for (int g = NumGroups - 1; g >= 0; g--) {
+      ElemT vals[N];
+      IdxT idx[N];
+      bool valid;
+#pragma hls_unroll yes
+      for (unsigned i = 0; i < N; i++) {
+        if (g == 0) {
+          vals[i] = nvhls::get_slc<ElemWidth>(inputs, i * ElemWidth);
+          idx[i] = i;
+        } else {
+          vals[i] = regs_val[(g > 0) ? g - 1 : 0][i];
+          idx[i] = regs_idx[(g > 0) ? g - 1 : 0][i];
+        }
+      }
+      valid = (g == 0) ? in_valid : regs_valid[(g > 0) ? g - 1 : 0];
+      reduce_levels(vals, idx, g * LevelsPerStage, (g + 1) * LevelsPerStage);
+      if (g == static_cast<int>(NumGroups) - 1) {
+        out_idx = idx[0];
+        out_val = vals[0];
+        out_valid = valid;
+      } else {
+#pragma hls_unroll yes
+        for (unsigned i = 0; i < N; i++) {
+          regs_val[g][i] = vals[i];
+          regs_idx[g][i] = idx[i];
+        }
+        regs_valid[g] = valid;
+      }
+    }
+    return out_valid;
+  }
+
+  bool run(bool in_valid, ArrT inputs, IdxT& out_idx) {
+    ElemT out_val;
+    return run(in_valid, inputs, out_idx, out_val);
+  }
+};
+
+/**
+ * \brief Networks of ParallelPrefix
+ * \ingroup comptrees
+ *
+ * For N elements:
+ * - PrefixKoggeStone: log2(N) levels, about N log2(N) operators, fanout 2.
+ * - PrefixBrentKung: 2 log2(N) - 1 levels, about 2N operators, fanout 2.
+ * - PrefixSklansky: log2(N) levels, about N/2 log2(N) operators, fanout up to N/2.
+ */
+enum prefix_network { PrefixKoggeStone, PrefixBrentKung, PrefixSklansky };
+
+/**
+ * \brief Associative operators of ParallelPrefix
+ * \ingroup comptrees
+ *
+ * An operator is a class with a static T apply(a, b), where a covers the
+ * lower elements. It must be associative; it need not be commutative.
+ */
+template <typename T>
+struct PrefixOpAdd {
+  static T apply(const T& a, const T& b) { return a + b; }
+};
+
+template <typename T>
+struct PrefixOpOr {
+  static T apply(const T& a, const T& b) { return a | b; }
+};
+
+template <typename T>
+struct PrefixOpAnd {
+  static T apply(const T& a, const T& b) { return a & b; }
+};
+
+template <typename T>
+struct PrefixOpMax {
+  static T apply(const T& a, const T& b) { return (b > a) ? b : a; }
+};
+
+template <typename T>
+struct PrefixOpMin {
+  static T apply(const T& a, const T& b) { return (b < a) ? b : a; }
+};
+
+/**
+ * \brief Compile-time parallel-prefix (scan) network
+ * \ingroup comptrees
+ *
+ * \tparam T        Element type
+ * \tparam N        Number of elements. Need not be a power of 2
+ * \tparam Op       Associative operator, see PrefixOpAdd
+ * \tparam Network  Network, see prefix_network (default: PrefixSklansky)
+ *
+ * \par Overview
+ * val(x) replaces x[i] with x[0] op x[1] op ... op x[i] (an inclusive scan).
+ * The networks trade depth, operator count and fanout as listed in
+ * prefix_network; all of them apply Op in the same order, so any associative
+ * operator gives the same result with each network. Levels is the depth in
+ * operators.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <comptrees.h>
+ *
+ *      ...
+ *      NVUINTW(8) credits[16];
+ *      ...
+ *      ParallelPrefix<NVUINTW(8), 16, PrefixOpAdd<NVUINTW(8)>, PrefixKoggeStone>::val(credits);
+ *      // credits[i] is now the sum of the credits 0..i
+ *      ...
+ *
+ * \endcode
+ *
+ */
+template <typename T, unsigned N, typename Op,
+          prefix_network Network = PrefixSklansky>
+class ParallelPrefix {
+ public:
+  static const unsigned LogN = (N > 1) ? nvhls::log2_ceil<N>::val : 0;
+  static const unsigned Levels =
+      (Network == PrefixBrentKung && LogN > 1) ? 2 * LogN - 1 : LogN;
+  // Largest power of 2 below N
+  static const unsigned Top = (LogN > 0) ? (1u << (LogN - 1)) : 0;
+
+  static void val(T (&x)[N]) {
+    if (Network == PrefixKoggeStone) {
+#pragma hls_unroll yes
+      for (unsigned d = 1; d < N; d *= 2) {
+        T prev[N];
+#pragma hls_unroll yes
+        for (unsigned i = 0; i < N; i++) {
+          prev[i] = x[i];
+        }
+#pragma hls_unroll yes
+        for (unsigned i = d; i < N; i++) {
+          x[i] = Op::apply(prev[i - d], prev[i]);
+        }
+      }
+    } else if (Network == PrefixBrentKung) {
+      // Up-sweep: x[i] covers the 2d elements ending at i
+#pragma hls_unroll yes
+      for (unsigned d = 1; d < N; d *= 2) {
+#pragma hls_unroll yes
+        for (unsigned i = 2 * d - 1; i < N; i += 2 * d) {
+          x[i] = Op::apply(x[i - d], x[i]);
+        }
+      }
+      // Down-sweep: fill in the prefixes between the up-sweep nodes
+#pragma hls_unroll yes
+      for (unsigned d = Top; d >= 1; d /= 2) {
+#pragma hls_unroll yes
+        for (unsigned i = 3 * d - 1; i < N; i += 2 * d) {
+          x[i] = Op::apply(x[i - d], x[i]);
+        }
+      }
+    } else {
+      // Level d: the upper half of every block of 2d takes the last of the
+      // lower half
+#pragma hls_unroll yes
+      for (unsigned d = 1; d < N; d *= 2) {
+#pragma hls_unroll yes
+        for (unsigned i = 0; i < N; i++) {
+          if ((i & d) != 0) {
+            x[i] = Op::apply(x[(i & ~(2 * d - 1)) + d - 1], x[i]);
+          }
+        }
+      }
+    }
+  }
+};
+
+/**
+ * \brief Compile-time popcount tree
+ * \ingroup comptrees
+ *
+ * \tparam VecT   Bitvector type
+ * \tparam CountT Type of the count, of size log2(Width)+1
+ * \tparam Width  The number of bits this instance of the tree counts
+ *
+ * \par Overview
+ * val(inputs) returns the number of set bits among bits 0..Width-1. The two
+ * halves of the range are counted independently and added, so the depth is
+ * log2(Width) adders whose width grows by one bit per level. C++ simulation
+ * uses the host __builtin_popcountll on 64-bit slices instead; define
+ * COMPTREES_SIM_USE_TREES to simulate the tree. val(inputs, start) is the
+ * tree for bits start..start+Width-1.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <comptrees.h>
+ *
+ *      ...
+ *      typedef NVUINTW(256) vec_t;
+ *      typedef NVUINTW(9) count_t;
+ *      vec_t conflicts;
+ *      count_t num_conflicts = Popcount<vec_t, count_t, 256>::val(conflicts);
+ *      ...
+ *
+ * \endcode
+ *
+ */
+template <typename VecT, typename CountT, unsigned Width>
+class Popcount {
+ public:
+  static CountT val(VecT inputs) {
+#if !defined(__SYNTHESIS__) && !defined(COMPTREES_SIM_USE_TREES)
+    NVUINTW(Width) bits = inputs;
+    unsigned count = 0;
+    for (unsigned lo = 0; lo < Width; lo += 64) {
+      NVUINTW(Width) slice = bits >> lo;
+      unsigned long long word = slice.to_uint64();
+      if (Width - lo < 64) {
+        word &= (1ULL << (Width - lo)) - 1;
+      }
+      count += __builtin_popcountll(word);
+    }
+    return count;
+#else
+    return Popcount<VecT, CountT, Width>::val(inputs, 0);
+#endif
+  }
+
+  static CountT val(VecT inputs, unsigned start) {
+    static const unsigned LowerWidth = Width / 2;
+    CountT lower = Popcount<VecT, CountT, LowerWidth>::val(inputs, start);
+    CountT upper =
+        Popcount<VecT, CountT, Width - LowerWidth>::val(inputs, start + LowerWidth);
+    return lower + upper;
+  }
+};
+
+// Base condition for Width = 1.
+template <typename VecT, typename CountT>
+class Popcount<VecT, CountT, 1> {
+ public:
+  static CountT val(VecT inputs) { return Popcount<VecT, CountT, 1>::val(inputs, 0); }
+
+  static CountT val(VecT inputs, unsigned start) {
+    return (inputs[start] == 1) ? CountT(1) : CountT(0);
+  }
+};
+
 #endif
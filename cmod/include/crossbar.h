@@ -18,6 +18,8 @@
 
 #include "nvhls_int.h"
 #include "nvhls_types.h"
+#include "nvhls_marshaller.h"
+#include "nvhls_energy.h"
 #include <stdio.h>
 
 // this section probably deserves it's own h file
@@ -50,6 +52,7 @@ T zero_bits() {
  * - Routing input data into output based on source information.
  * - Output will be invalid if either source information for that output was invalid or selected input lane is invalid.
  * - Invalid output will have 0 on data bits.
+ * - Area grows with NumInputLanes * NumOutputLanes; for permutations of many lanes see benes() and butterfly() in permutation_network.h.
  *
  * \par A Simple Example
  * \code
@@ -97,6 +100,7 @@ void crossbar(DataType data_in[NumInputLanes], bool valid_in[NumInputLanes],
         if (valid_source[dst] && valid_in_tmp) {
             data_out[dst] = data_in_tmp;
             valid_out[dst] = true;
+            NVHLS_ENERGY("crossbar", Wrapped<DataType>::width);
         } else {
             data_out[dst] = zero_bits<DataType>();
             valid_out[dst] = false;
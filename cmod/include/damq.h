@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DAMQ_H
+#define DAMQ_H
+
+#include <nvhls_types.h>
+#include <nvhls_int.h>
+#include <nvhls_assert.h>
+#include <mem_array.h>
+
+/**
+ * \brief Dynamically-allocated multi-queue: NumQueues FIFOs sharing one pool of entries
+ * \ingroup DAMQ
+ *
+ * \tparam DataType         DataType of entry in DAMQ
+ * \tparam NumEntries       Total number of entries shared by all queues
+ * \tparam NumQueues        Number of queues
+ * \tparam MinReserve       Entries reserved for each queue (default: 0)
+ *
+ * \par Overview
+ * - Has the same interface as a banked FIFO<DataType, FifoLen, NumBanks>, with a queue index in place of the bank
+ *   index, so it can replace per-VC or per-lane FIFOs whose occupancy is skewed.
+ * - Each queue is a linked list through a next-pointer array; unused entries form a free list.  A push takes the
+ *   head of the free list and a pop returns the entry to its tail, so push and pop are constant time.
+ * - Each queue may occupy up to NumEntries - (NumQueues - 1) * MinReserve entries.  The first MinReserve entries of
+ *   a queue always succeed, which keeps one busy queue from starving the others (e.g. to avoid deadlock across VCs).
+ * - Data is stored in a single-bank mem_array_sep; head/tail pointers, counters and next pointers are registers.
+ * - peekAt() walks the list and is meant for simulation; it costs one next-pointer lookup per offset in HLS.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <damq.h>
+ *
+ *      ...
+ *      DAMQ<DataType, 16, NumVCs, 2> damq_inst;
+ *
+ *      damq_inst.reset();
+ *
+ *      ...
+ *      if (!damq_inst.isFull(vc)) {
+ *        damq_inst.push(input_data, vc);
+ *      }
+ *      ...
+ *      if (!damq_inst.isEmpty(vc)) {
+ *        output_data = damq_inst.pop(vc);
+ *      }
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename DataType, unsigned int NumEntries, unsigned int NumQueues, unsigned int MinReserve = 0>
+class DAMQ {
+  static_assert(NumEntries >= 1 && NumQueues >= 1, "DAMQ needs at least one entry and one queue");
+  static_assert(MinReserve * NumQueues <= NumEntries, "MinReserve * NumQueues must not exceed NumEntries");
+
+ public:
+  static const int BankSelWidth = nvhls::index_width<NumQueues>::val;
+  static const int AddrWidth = nvhls::index_width<NumEntries>::val;
+  static const int CountWidth = nvhls::nbits<NumEntries>::val;
+  typedef NVUINTW(BankSelWidth) BankIdx;
+  typedef NVUINTW(AddrWidth) FifoIdx;
+  typedef NVUINTW(CountWidth) FifoIdxPlusOne;
+  typedef NVUINTW(NumQueues) BankMask;
+  typedef mem_array_sep<DataType, NumEntries, 1> DamqBody;
+
+  DamqBody damq_body;
+  FifoIdx next[NumEntries];        // next entry in the same list
+  FifoIdx head[NumQueues];         // where to read from
+  FifoIdx tail[NumQueues];         // last entry written
+  FifoIdxPlusOne count[NumQueues];
+  FifoIdx free_head;
+  FifoIdx free_tail;
+  FifoIdxPlusOne free_count;
+  FifoIdxPlusOne reserved;         // free entries held back for queues below MinReserve
+
+  static const int width = DamqBody::width + NumEntries * AddrWidth + 2 * NumQueues * AddrWidth +
+                           NumQueues * CountWidth + 2 * AddrWidth + 2 * CountWidth;
+
+  DAMQ() { reset(); }
+
+  void reset() {
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumEntries; i++) {
+      next[i] = (i == NumEntries - 1) ? 0 : i + 1;
+    }
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumQueues; i++) {
+      head[i] = 0;
+      tail[i] = 0;
+      count[i] = 0;
+    }
+    free_head = 0;
+    free_tail = NumEntries - 1;
+    free_count = NumEntries;
+    reserved = MinReserve * NumQueues;
+  }
+
+  // Function to push data to queue bidx
+  void push(DataType wr_data, BankIdx bidx = 0) {
+    NVHLS_ASSERT_MSG(bidx < NumQueues, "queue index out of bounds");
+    NVHLS_ASSERT_MSG(!isFull(bidx), "Pushing data to full DAMQ queue");
+    FifoIdx entry = free_head;
+    free_head = next[entry];
+    --free_count;
+    if (count[bidx] < MinReserve) {
+      --reserved;
+    }
+    damq_body.write(entry, 0, wr_data);
+    if (count[bidx] != 0) {
+      next[tail[bidx]] = entry;
+    } else {
+      head[bidx] = entry;
+    }
+    tail[bidx] = entry;
+    ++count[bidx];
+  }
+
+  // Function to increment the head pointer (emulate a pop)
+  void incrHead(BankIdx bidx = 0) {
+    NVHLS_ASSERT_MSG(bidx < NumQueues, "queue index out of bounds");
+    NVHLS_ASSERT_MSG(!isEmpty(bidx), "Incrementing Head of empty DAMQ queue");
+    FifoIdx entry = head[bidx];
+    head[bidx] = next[entry];
+    --count[bidx];
+    if (count[bidx] < MinReserve) {
+      ++reserved;
+    }
+    if (free_count != 0) {
+      next[free_tail] = entry;
+    } else {
+      free_head = entry;
+    }
+    free_tail = entry;
+    ++free_count;
+  }
+
+  // Function to pop data from queue bidx
+  DataType pop(BankIdx bidx = 0) {
+    DataType rd_data = peek(bidx);
+    incrHead(bidx);
+    return rd_data;
+  }
+
+  // Function to peek from queue bidx
+  DataType peek(BankIdx bidx = 0) {
+    NVHLS_ASSERT_MSG(bidx < NumQueues, "queue index out of bounds");
+    NVHLS_ASSERT_MSG(!isEmpty(bidx), "Peeking data from empty DAMQ queue");
+    return damq_body.read(head[bidx], 0);
+  }
+
+  // Same as peek(); the entry is returned by value
+  typedef DataType PeekRefType;
+  PeekRefType peekRef(BankIdx bidx = 0) { return peek(bidx); }
+
+  // Function to peek the entry offset places behind the head
+  DataType peekAt(FifoIdx offset, BankIdx bidx = 0) {
+    NVHLS_ASSERT_MSG(offset < NumFilled(bidx), "Peeking beyond the filled DAMQ entries");
+    FifoIdx entry = head[bidx];
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumEntries - 1; i++) {
+      if (i < offset) {
+        entry = next[entry];
+      }
+    }
+    return damq_body.read(entry, 0);
+  }
+
+  // Vectorized versions of push, pop, incrHead and peek, as in FIFO. Queues are
+  // served in index order, as they allocate from the same free list, so a push
+  // mask must also fit in NumAvailable() of the shared entries, not only in
+  // ~FullMask().
+  void push_all(const DataType wr_data[NumQueues], BankMask valid) {
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumQueues; i++) {
+      if (valid[i] == 1) {
+        push(wr_data[i], i);
+      }
+    }
+  }
+
+  void pop_all(DataType rd_data[NumQueues], BankMask valid) {
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumQueues; i++) {
+      if (valid[i] == 1) {
+        rd_data[i] = pop(i);
+      }
+    }
+  }
+
+  void incrHead_all(BankMask valid) {
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumQueues; i++) {
+      if (valid[i] == 1) {
+        incrHead(i);
+      }
+    }
+  }
+
+  void peek_all(DataType rd_data[NumQueues], BankMask valid) {
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumQueues; i++) {
+      if (valid[i] == 1) {
+        rd_data[i] = peek(i);
+      }
+    }
+  }
+
+  // Checks if queue bidx is empty
+  bool isEmpty(BankIdx bidx = 0) { return count[bidx] == 0; }
+
+  // Checks if queue bidx can not take another entry: its reserved entries are
+  // used up and every other free entry is reserved for the other queues
+  bool isFull(BankIdx bidx = 0) {
+    if (count[bidx] < MinReserve) {
+      return false;
+    }
+    return free_count == reserved;
+  }
+
+  // Returns number of entries filled in queue bidx
+  FifoIdxPlusOne NumFilled(BankIdx bidx = 0) { return count[bidx]; }
+
+  // Returns number of entries queue bidx can still take
+  FifoIdxPlusOne NumAvailable(BankIdx bidx = 0) {
+    FifoIdxPlusOne own = (count[bidx] < MinReserve) ? FifoIdxPlusOne(MinReserve - count[bidx])
+                                                    : FifoIdxPlusOne(0);
+    return free_count - reserved + own;
+  }
+
+  // Watermarks, as in FIFO: at most n entries can still be pushed to queue
+  // bidx, or at most n entries are filled
+  bool almostFull(unsigned int n, BankIdx bidx = 0) { return NumAvailable(bidx) <= n; }
+
+  bool almostEmpty(unsigned int n, BankIdx bidx = 0) { return count[bidx] <= n; }
+
+  // Returns number of entries not used by any queue
+  FifoIdxPlusOne NumFree() { return free_count; }
+
+  BankMask EmptyMask() {
+    BankMask mask = 0;
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumQueues; i++) {
+      mask[i] = isEmpty(i) ? 1 : 0;
+    }
+    return mask;
+  }
+
+  BankMask FullMask() {
+    BankMask mask = 0;
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumQueues; i++) {
+      mask[i] = isFull(i) ? 1 : 0;
+    }
+    return mask;
+  }
+
+  FifoIdx get_head(BankIdx bidx = 0) { return head[bidx]; }
+  FifoIdx get_tail(BankIdx bidx = 0) { return tail[bidx]; }
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    for (unsigned i = 0; i < NumEntries; i++) {
+      m & next[i];
+    }
+    for (unsigned i = 0; i < NumQueues; i++) {
+      m & head[i];
+      m & tail[i];
+      m & count[i];
+    }
+    m & free_head;
+    m & free_tail;
+    m & free_count;
+    m & reserved;
+    m & damq_body;
+  }
+};
+
+#endif  // end #define DAMQ_H macro
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ECC_MEM_ARRAY_H
+#define ECC_MEM_ARRAY_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_marshaller.h>
+#include <TypeToBits.h>
+#include <mem_array.h>
+
+/**
+ * \brief Number of Hamming check bits for K data bits: the smallest R with 2^R >= K + R + 1
+ * \ingroup MemArray
+ */
+template <unsigned int K, unsigned int R = 1, bool Done = ((1u << R) >= K + R + 1)>
+struct ecc_check_bits {
+  enum { val = ecc_check_bits<K, R + 1, ((1u << (R + 1)) >= K + R + 2)>::val };
+};
+
+template <unsigned int K, unsigned int R>
+struct ecc_check_bits<K, R, true> {
+  enum { val = R };
+};
+
+/**
+ * \brief Balanced XOR reduction of a W-bit vector, log2(W) gates deep
+ * \ingroup MemArray
+ */
+template <unsigned int W>
+struct ecc_xor_tree {
+  static const unsigned int Lo = W / 2;
+  static const unsigned int Hi = W - Lo;
+  static bool reduce(const NVUINTW(W) & v) {
+    return ecc_xor_tree<Lo>::reduce(nvhls::get_slc<Lo>(v, 0)) ^
+           ecc_xor_tree<Hi>::reduce(nvhls::get_slc<Hi>(v, Lo));
+  }
+};
+
+template <>
+struct ecc_xor_tree<1> {
+  static bool reduce(const NVUINT1& v) { return v[0] == 1; }
+};
+
+/**
+ * \brief Outcome of an ecc_mem_array read
+ * \ingroup MemArray
+ */
+enum ecc_status { ECC_OK = 0, ECC_CORRECTED = 1, ECC_UNCORRECTABLE = 2 };
+
+/**
+ * \brief SECDED-protected mem_array_sep
+ * \ingroup MemArray
+ *
+ * \tparam T                Datatype of an entry
+ * \tparam NumEntries       Number of entries in memory
+ * \tparam NumBanks         Number of banks in memory
+ * \tparam RegisteredDecode If true, read() returns the entry fetched by the previous read(), and
+ *                          decode and correction are in the cycle after the SRAM access
+ * \tparam CounterWidth     Width of the saturating error counters
+ *
+ * \par Overview
+ * Every entry is stored as a systematic extended Hamming codeword: the data bits, CheckWidth
+ * Hamming check bits and one overall parity bit, so single-bit errors are corrected and double-
+ * bit errors are detected.  Data bit j has the j-th Hamming position that is not a power of two,
+ * and check bit i is the parity of the data bits whose position has bit i set.  The encoder, the
+ * syndrome and the overall parity are balanced XOR trees, so the decoder is about
+ * log2(DataWidth) + 2 XOR levels plus the correction mux on top of the SRAM read.  With
+ * RegisteredDecode the codeword is registered first, which leaves only the SRAM access in the read
+ * cycle at the cost of one cycle of read latency.
+ *
+ * read() corrects single-bit errors and counts them in corrected_count.  Double-bit errors are
+ * counted in uncorrectable_count and returned as read, without correction.  Both counters
+ * saturate at 2^CounterWidth-1.  Corrected data is not written back; a scrubber can do that with
+ * the status returned by read().
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <ecc_mem_array.h>
+ *
+ *      ...
+ *      ecc_mem_array<MemWord_t, NUM_ENTRIES, NBANKS> banks;
+ *
+ *      banks.write(bank_addr, bank_sel, write_data);
+ *      ecc_status status;
+ *      read_data = banks.read(bank_addr, bank_sel, status);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename T, int NumEntries, int NumBanks = 1, bool RegisteredDecode = false,
+          int CounterWidth = 16>
+class ecc_mem_array {
+ public:
+  static const unsigned int DataWidth = Wrapped<T>::width;
+  static const unsigned int CheckWidth = ecc_check_bits<DataWidth>::val;
+  static const unsigned int CodeWidth = DataWidth + CheckWidth + 1;
+  typedef NVUINTW(DataWidth) Data;
+  typedef NVUINTW(CheckWidth) Check;
+  typedef NVUINTW(CodeWidth) Code;
+  typedef NVUINTW(CounterWidth) Counter;
+  typedef mem_array_sep<Code, NumEntries, NumBanks> Mem;
+  typedef typename Mem::LocalIndex LocalIndex;
+  typedef typename Mem::BankIndex BankIndex;
+
+  Mem mem;
+  Counter corrected_count;
+  Counter uncorrectable_count;
+
+  ecc_mem_array() : corrected_count(0), uncorrectable_count(0), pending(0) {}
+
+  // Hamming position of data bit j, the j-th integer >= 3 that is not a power of two
+  static unsigned int DataPosition(unsigned int j) {
+    unsigned int r = 2;
+    while ((1u << r) <= j + 1 + r) r++;
+    return j + 1 + r;
+  }
+
+  static Check ComputeCheck(const Data& d) {
+    Check check;
+    #pragma hls_unroll yes
+    for (unsigned int i = 0; i < CheckWidth; i++) {
+      Data sel = 0;
+      #pragma hls_unroll yes
+      for (unsigned int j = 0; j < DataWidth; j++) {
+        if ((DataPosition(j) >> i) & 1) sel[j] = d[j];
+      }
+      check[i] = ecc_xor_tree<DataWidth>::reduce(sel);
+    }
+    return check;
+  }
+
+  static Code Encode(const T& val) {
+    Data d = TypeToNVUINT<T>(val);
+    Check check = ComputeCheck(d);
+    Code c = 0;
+    c = nvhls::set_slc(c, d, 0);
+    c = nvhls::set_slc(c, check, DataWidth);
+    c[CodeWidth - 1] = ecc_xor_tree<DataWidth>::reduce(d) ^ ecc_xor_tree<CheckWidth>::reduce(check);
+    return c;
+  }
+
+  static T Decode(const Code& c, ecc_status& status) {
+    Data d = nvhls::get_slc<DataWidth>(c, 0);
+    Check syndrome = ComputeCheck(d) ^ nvhls::get_slc<CheckWidth>(c, DataWidth);
+    bool parity = ecc_xor_tree<CodeWidth>::reduce(c);
+    if (!parity) {
+      // Even overall parity: no error, or two errors if the syndrome is set
+      status = (syndrome == 0) ? ECC_OK : ECC_UNCORRECTABLE;
+    } else {
+      // Odd overall parity: one error, in a data bit if the syndrome names one
+      status = ECC_CORRECTED;
+      #pragma hls_unroll yes
+      for (unsigned int j = 0; j < DataWidth; j++) {
+        if (syndrome == DataPosition(j)) d[j] = (d[j] == 1) ? 0 : 1;
+      }
+    }
+    return NVUINTToType<T>(d);
+  }
+
+  void write(LocalIndex idx, BankIndex bank_sel, const T& val) {
+    mem.write(idx, bank_sel, Encode(val));
+  }
+
+  T read(LocalIndex idx, BankIndex bank_sel, ecc_status& status) {
+    Code c = mem.read(idx, bank_sel);
+    if (RegisteredDecode) {
+      Code fetched = c;
+      c = pending;
+      pending = fetched;
+    }
+    T val = Decode(c, status);
+    Counter max = ~static_cast<Counter>(0);
+    if (status == ECC_CORRECTED && corrected_count != max) corrected_count++;
+    if (status == ECC_UNCORRECTABLE && uncorrectable_count != max) uncorrectable_count++;
+    return val;
+  }
+
+  T read(LocalIndex idx, BankIndex bank_sel = 0) {
+    ecc_status status;
+    return read(idx, bank_sel, status);
+  }
+
+  void clear_counters() {
+    corrected_count = 0;
+    uncorrectable_count = 0;
+  }
+
+#ifndef __SYNTHESIS__
+  // Flips bit of the stored codeword of an entry, for fault injection in testbenches
+  void inject_error(LocalIndex idx, BankIndex bank_sel, unsigned int bit) {
+    Code c = mem.read(idx, bank_sel);
+    c[bit] = (c[bit] == 1) ? 0 : 1;
+    mem.write(idx, bank_sel, c);
+  }
+#endif
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& mem;
+  }
+
+ private:
+  Code pending;
+};
+
+#endif
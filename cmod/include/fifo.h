@@ -19,6 +19,64 @@
 #include <nvhls_types.h>
 #include <mem_array.h>
 #include <nvhls_assert.h>
+#include <nvhls_energy.h>
+#include <nvhls_memory.h>
+
+/**
+ * \brief Simulation-only storage backend for FIFO
+ * \ingroup FIFO
+ *
+ * \tparam DataType         DataType of entry in FIFO
+ * \tparam FifoLen          Length of each FIFO bank
+ * \tparam NumBanks         Number of FIFO banks
+ *
+ * \par Overview
+ * - Plain typed ring storage with the same read()/write() interface as mem_array_sep.
+ * - Each bank occupies a power-of-two sized region, so the bank offset is a shift and a mask instead of a multiply.
+ * - Entries are stored as DataType directly, avoiding the sc_lv packing, TypeToBits conversions and X-checks of mem_array_sep.
+ * - Selected automatically by FIFO when __SYNTHESIS__ is not defined. Define FIFO_SIM_USE_MEM_ARRAY to keep mem_array_sep storage in C++ simulation.
+ * - Marshall() produces the same bit layout as the equivalent mem_array_sep.
+ *
+ */
+template <typename DataType, unsigned int FifoLen, unsigned int NumBanks>
+class fifo_ring_mem {
+ public:
+  static const unsigned int BankStride = nvhls::next_pow2<FifoLen>::val;
+  static const unsigned int LogBankStride = nvhls::nbits<BankStride>::val - 1;
+  static const unsigned int IdxMask = BankStride - 1;
+  static const int width = FifoLen * NumBanks * Wrapped<DataType>::width;
+
+  DataType data[NumBanks * BankStride];
+
+  DataType read(unsigned int idx, unsigned int bank_sel = 0) {
+    NVHLS_ASSERT_MSG(bank_sel < NumBanks, "bank index out of bounds");
+    NVHLS_ASSERT_MSG(idx < FifoLen, "local index out of bounds");
+    return data[(bank_sel << LogBankStride) | (idx & IdxMask)];
+  }
+
+  // Reference to the stored entry, used by FIFO::peekRef()
+  const DataType& readRef(unsigned int idx, unsigned int bank_sel = 0) const {
+    NVHLS_ASSERT_MSG(bank_sel < NumBanks, "bank index out of bounds");
+    NVHLS_ASSERT_MSG(idx < FifoLen, "local index out of bounds");
+    return data[(bank_sel << LogBankStride) | (idx & IdxMask)];
+  }
+
+  void write(unsigned int idx, unsigned int bank_sel, const DataType& val) {
+    NVHLS_ASSERT_MSG(bank_sel < NumBanks, "bank index out of bounds");
+    NVHLS_ASSERT_MSG(idx < FifoLen, "local index out of bounds");
+    data[(bank_sel << LogBankStride) | (idx & IdxMask)] = val;
+  }
+
+  template<unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    for (unsigned i = 0; i < NumBanks; i++) {
+      for (unsigned j = 0; j < FifoLen; j++) {
+        m & data[(i << LogBankStride) | j];
+      }
+    }
+  }
+};
+
 /**
  * \brief Configurable FIFO class 
  * \ingroup FIFO
@@ -55,6 +113,10 @@
  *      ...
  *      // IncrHead without reading data from FIFO
  *      fifo_inst.incrHead(bank_id);
+ *      ...
+ *      // Push to and pop from several banks in one call, one mask bit per bank
+ *      fifo_inst.push_all(input_array, push_mask & ~fifo_inst.FullMask());
+ *      fifo_inst.pop_all(output_array, pop_mask & ~fifo_inst.EmptyMask());
  *
  * \endcode
  * \par
@@ -72,13 +134,24 @@ class FIFO {
   typedef NVUINTW(BankSelWidth) BankIdx;
   typedef NVUINTW(AddrWidth) FifoIdx;
   typedef NVUINTW(AddrWidth+1) FifoIdxPlusOne;
+  typedef NVUINTW(NumBanks) BankMask;  // one bit per bank, for the *_all functions
+
+  // Storage is a mem_array_sep for synthesis, and a typed ring buffer in C++
+  // simulation. Both expose the same read()/write() interface.
+#if defined(__SYNTHESIS__) || defined(FIFO_SIM_USE_MEM_ARRAY)
+  typedef mem_array_sep<DataType, FifoLen * NumBanks, NumBanks> FifoBody;
+  typedef DataType PeekRefType;
+#else
+  typedef fifo_ring_mem<DataType, FifoLen, NumBanks> FifoBody;
+  typedef const DataType& PeekRefType;
+#endif
 
   FifoIdx head[NumBanks];  // where to read from
   FifoIdx tail[NumBanks];  // where to write to
   // FifoLen is number of entries in each bank
-  mem_array_sep<DataType, FifoLen * NumBanks, NumBanks> fifo_body;
+  FifoBody fifo_body;
   bool last_action_was_push[NumBanks];
-  static const int width =  mem_array_sep<DataType, FifoLen * NumBanks, NumBanks>::width + 2 * NumBanks * AddrWidth + NumBanks; 
+  static const int width =  FifoBody::width + 2 * NumBanks * AddrWidth + NumBanks; 
 
   // Function to do modulo increment of pointer
   FifoIdx ModIncr(FifoIdx curr_idx) {
@@ -90,6 +163,12 @@ class FIFO {
 
   // Constructor
   FIFO() {
+#ifdef FIFO_SIM_USE_MEM_ARRAY
+    // fifo_body counts itself as a mem_array_sep
+    NVHLS_MEMORY("FIFO", sizeof(*this) - sizeof(fifo_body));
+#else
+    NVHLS_MEMORY("FIFO", sizeof(*this));
+#endif
 #pragma hls_unroll yes
     for (unsigned i = 0; i < NumBanks; i++) {
       head[i] = 0;
@@ -105,6 +184,7 @@ class FIFO {
     fifo_body.write(tail_local, bidx, wr_data);
     tail[bidx] = ModIncr(tail_local);
     last_action_was_push[bidx] = true;
+    NVHLS_ENERGY("fifo.push", Wrapped<DataType>::width);
   }
 
   // Function to pop data from FIFO
@@ -114,6 +194,7 @@ class FIFO {
     DataType rd_data = fifo_body.read(head_local, bidx);
     head[bidx] = ModIncr(head_local);
     last_action_was_push[bidx] = false;
+    NVHLS_ENERGY("fifo.pop", Wrapped<DataType>::width);
     return rd_data;
   }
 
@@ -123,6 +204,7 @@ class FIFO {
     FifoIdx head_local = head[bidx];
     head[bidx] = ModIncr(head_local);
     last_action_was_push[bidx] = false;
+    NVHLS_ENERGY("fifo.pop", Wrapped<DataType>::width);
   }
 
   // Function to peek from FIFO
@@ -132,6 +214,81 @@ class FIFO {
     return fifo_body.read(head_local, bidx);
   }
 
+  // Function to peek from FIFO without copying the entry. In C++ simulation
+  // this is a const reference into the storage, valid until the entry is
+  // overwritten; for synthesis and with FIFO_SIM_USE_MEM_ARRAY it is a copy.
+  PeekRefType peekRef(BankIdx bidx = 0) {
+    NVHLS_ASSERT_MSG(!isEmpty(bidx), "Peeking data from empty FIFO");
+    FifoIdx head_local = head[bidx];
+#if defined(__SYNTHESIS__) || defined(FIFO_SIM_USE_MEM_ARRAY)
+    return fifo_body.read(head_local, bidx);
+#else
+    return fifo_body.readRef(head_local, bidx);
+#endif
+  }
+
+  // Vectorized versions of push, pop, incrHead and peek. Every bank whose bit
+  // is set in valid is accessed in one call; each bank only updates its own
+  // head or tail, so the banks are independent logic in HLS.
+  void push_all(const DataType wr_data[NumBanks], BankMask valid) {
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumBanks; i++) {
+      if (valid[i] == 1) {
+        NVHLS_ASSERT_MSG(!isFull(i), "Pushing data to full FIFO");
+        FifoIdx tail_local = tail[i];
+        fifo_body.write(tail_local, i, wr_data[i]);
+        tail[i] = ModIncr(tail_local);
+        last_action_was_push[i] = true;
+        NVHLS_ENERGY("fifo.push", Wrapped<DataType>::width);
+      }
+    }
+  }
+
+  void pop_all(DataType rd_data[NumBanks], BankMask valid) {
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumBanks; i++) {
+      if (valid[i] == 1) {
+        NVHLS_ASSERT_MSG(!isEmpty(i), "Popping data from empty FIFO");
+        FifoIdx head_local = head[i];
+        rd_data[i] = fifo_body.read(head_local, i);
+        head[i] = ModIncr(head_local);
+        last_action_was_push[i] = false;
+        NVHLS_ENERGY("fifo.pop", Wrapped<DataType>::width);
+      }
+    }
+  }
+
+  void incrHead_all(BankMask valid) {
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumBanks; i++) {
+      if (valid[i] == 1) {
+        NVHLS_ASSERT_MSG(!isEmpty(i), "Incrementing Head of empty FIFO");
+        head[i] = ModIncr(head[i]);
+        last_action_was_push[i] = false;
+        NVHLS_ENERGY("fifo.pop", Wrapped<DataType>::width);
+      }
+    }
+  }
+
+  void peek_all(DataType rd_data[NumBanks], BankMask valid) {
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumBanks; i++) {
+      if (valid[i] == 1) {
+        NVHLS_ASSERT_MSG(!isEmpty(i), "Peeking data from empty FIFO");
+        rd_data[i] = fifo_body.read(head[i], i);
+      }
+    }
+  }
+
+  // Function to peek the entry offset places behind the head
+  DataType peekAt(FifoIdx offset, BankIdx bidx = 0) {
+    NVHLS_ASSERT_MSG(offset < NumFilled(bidx), "Peeking beyond the filled FIFO entries");
+    FifoIdx head_local = head[bidx];
+    FifoIdx idx = (head_local >= FifoLen - offset) ? FifoIdx(head_local + offset - FifoLen)
+                                                   : FifoIdx(head_local + offset);
+    return fifo_body.read(idx, bidx);
+  }
+
   // Checks if FIFO is empty
   bool isEmpty(BankIdx bidx = 0) {
     FifoIdx head_local = head[bidx];
@@ -168,6 +325,36 @@ class FIFO {
       return (FifoLen - NumFilled(bidx));
   }
 
+  // Watermarks: true when at most n entries are free (almostFull) or filled
+  // (almostEmpty); n = 0 is the same as isFull() and isEmpty(). With a
+  // constant n these reduce to one comparator on the pointers.
+  bool almostFull(unsigned int n, BankIdx bidx = 0) {
+    return NumAvailable(bidx) <= n;
+  }
+
+  bool almostEmpty(unsigned int n, BankIdx bidx = 0) {
+    return NumFilled(bidx) <= n;
+  }
+
+  // Masks of the empty and full banks, bit i for bank i
+  BankMask EmptyMask() {
+    BankMask mask = 0;
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumBanks; i++) {
+      mask[i] = isEmpty(i) ? 1 : 0;
+    }
+    return mask;
+  }
+
+  BankMask FullMask() {
+    BankMask mask = 0;
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumBanks; i++) {
+      mask[i] = isFull(i) ? 1 : 0;
+    }
+    return mask;
+  }
+
   // Reset head and tail pointers
   void reset() {
 #pragma hls_unroll yes
@@ -203,6 +390,7 @@ class FIFO<DataType, 0, NumBanks> {  // 0 entries, NumBanks
  public:
   typedef NVUINTW(BankSelWidth) BankIdx;
   typedef NVUINTW(1) FifoIdx;
+  typedef NVUINTW(NumBanks) BankMask;
   FIFO() {}
 
   void push(DataType wr_data, BankIdx bidx = 0) {NVHLS_ASSERT_MSG(0, "FIFO size is zero");}
@@ -213,6 +401,23 @@ class FIFO<DataType, 0, NumBanks> {  // 0 entries, NumBanks
 
   DataType peek(BankIdx bidx = 0) { NVHLS_ASSERT_MSG(0, "FIFO size is zero"); return DataType(); }
 
+  DataType peekAt(FifoIdx offset, BankIdx bidx = 0) { NVHLS_ASSERT_MSG(0, "FIFO size is zero"); return DataType(); }
+
+  void push_all(const DataType wr_data[NumBanks], BankMask valid) { NVHLS_ASSERT_MSG(valid == 0, "FIFO size is zero"); }
+
+  void pop_all(DataType rd_data[NumBanks], BankMask valid) { NVHLS_ASSERT_MSG(valid == 0, "FIFO size is zero"); }
+
+  void incrHead_all(BankMask valid) { NVHLS_ASSERT_MSG(valid == 0, "FIFO size is zero"); }
+
+  void peek_all(DataType rd_data[NumBanks], BankMask valid) { NVHLS_ASSERT_MSG(valid == 0, "FIFO size is zero"); }
+
+  BankMask EmptyMask() { NVHLS_ASSERT_MSG(0, "FIFO size is zero"); return 0; }
+
+  BankMask FullMask() { NVHLS_ASSERT_MSG(0, "FIFO size is zero"); return 0; }
+
+  typedef DataType PeekRefType;
+  PeekRefType peekRef(BankIdx bidx = 0) { NVHLS_ASSERT_MSG(0, "FIFO size is zero"); return DataType(); }
+
   bool isEmpty(BankIdx bidx = 0) {NVHLS_ASSERT_MSG(0, "FIFO size is zero"); return true; }
 
   bool isFull(BankIdx bidx = 0) {NVHLS_ASSERT_MSG(0, "FIFO size is zero"); return true; }
@@ -221,6 +426,10 @@ class FIFO<DataType, 0, NumBanks> {  // 0 entries, NumBanks
 
   FifoIdx NumAvailable(BankIdx bidx = 0) {NVHLS_ASSERT_MSG(0, "FIFO size is zero"); return 0; }
 
+  bool almostFull(unsigned int n, BankIdx bidx = 0) {NVHLS_ASSERT_MSG(0, "FIFO size is zero"); return true; }
+
+  bool almostEmpty(unsigned int n, BankIdx bidx = 0) {NVHLS_ASSERT_MSG(0, "FIFO size is zero"); return true; }
+
   void reset() {}
 };
 
@@ -239,14 +448,19 @@ class FIFO<DataType, 1, 1> {
  public:
     static const int width =  Wrapped<DataType>::width + 1; 
     typedef NVUINTW(1) T;  //redundant
+    typedef NVUINTW(1) BankMask;
 
-    FIFO() {reset();}
+    FIFO() {
+      NVHLS_MEMORY("FIFO", sizeof(*this));
+      reset();
+    }
 
     inline void push(DataType wr_data, T bidx = 0) 
     {        
         NVHLS_ASSERT_MSG(!isFull(), "Pushing data to full FIFO");
         data = wr_data;
         valid = true;
+        NVHLS_ENERGY("fifo.push", Wrapped<DataType>::width);
     }
 
     inline DataType pop(T bidx = 0)
@@ -259,6 +473,7 @@ class FIFO<DataType, 1, 1> {
     {
         NVHLS_ASSERT_MSG(!isEmpty(), "Incrementing head of empty FIFO");
         valid = false;
+        NVHLS_ENERGY("fifo.pop", Wrapped<DataType>::width);
     }
 
     inline DataType peek(T bidx = 0) 
@@ -267,6 +482,53 @@ class FIFO<DataType, 1, 1> {
         return data;
     }
 
+#ifdef __SYNTHESIS__
+    typedef DataType PeekRefType;
+#else
+    typedef const DataType& PeekRefType;
+#endif
+    inline PeekRefType peekRef(T bidx = 0)
+    {
+        NVHLS_ASSERT_MSG(!isEmpty(), "Peeking data from empty FIFO");
+        return data;
+    }
+
+    inline DataType peekAt(T offset, T bidx = 0)
+    {
+        NVHLS_ASSERT_MSG(offset == 0, "Peeking beyond the filled FIFO entries");
+        return peek();
+    }
+
+    inline void push_all(const DataType wr_data[1], BankMask valid)
+    {
+        if (valid == 1) push(wr_data[0]);
+    }
+
+    inline void pop_all(DataType rd_data[1], BankMask valid)
+    {
+        if (valid == 1) rd_data[0] = pop();
+    }
+
+    inline void incrHead_all(BankMask valid)
+    {
+        if (valid == 1) incrHead();
+    }
+
+    inline void peek_all(DataType rd_data[1], BankMask valid)
+    {
+        if (valid == 1) rd_data[0] = peek();
+    }
+
+    inline BankMask EmptyMask()
+    {
+        return !valid;
+    }
+
+    inline BankMask FullMask()
+    {
+        return valid;
+    }
+
     inline bool isEmpty(T bidx = 0)
     {   
         return !valid; 
@@ -285,6 +547,16 @@ class FIFO<DataType, 1, 1> {
       return !valid;
     }
 
+    inline bool almostFull(unsigned int n, T bidx = 0)
+    {
+        return (n != 0) || valid;
+    }
+
+    inline bool almostEmpty(unsigned int n, T bidx = 0)
+    {
+        return (n != 0) || !valid;
+    }
+
     inline void reset() 
     {
         valid = false;
@@ -314,8 +586,10 @@ class FIFO<DataType, 1, NumBanks> {
       (NumBanks == 1) ? 1 : nvhls::nbits<NumBanks - 1>::val;
     typedef NVUINTW(BankSelWidth) BankIdx;
     typedef NVUINTW(1) T;
+    typedef NVUINTW(NumBanks) BankMask;
 
     FIFO() {
+      NVHLS_MEMORY("FIFO", sizeof(*this));
       reset();
     }
 
@@ -323,6 +597,7 @@ class FIFO<DataType, 1, NumBanks> {
       NVHLS_ASSERT_MSG(!isFull(bidx), "Pushing data to full FIFO");
       data[bidx]  = wr_data;
       valid[bidx] = true;
+      NVHLS_ENERGY("fifo.push", Wrapped<DataType>::width);
     }
 
     inline DataType pop(BankIdx bidx = 0) {      
@@ -333,6 +608,7 @@ class FIFO<DataType, 1, NumBanks> {
     inline void incrHead(BankIdx bidx = 0) {
       NVHLS_ASSERT_MSG(!isEmpty(bidx), "Incrementing Head of empty FIFO");
       valid[bidx] = false;
+      NVHLS_ENERGY("fifo.pop", Wrapped<DataType>::width);
     }
 
     inline DataType peek(BankIdx bidx = 0) { 
@@ -340,6 +616,84 @@ class FIFO<DataType, 1, NumBanks> {
       return data[bidx];
     }
 
+#ifdef __SYNTHESIS__
+    typedef DataType PeekRefType;
+#else
+    typedef const DataType& PeekRefType;
+#endif
+    inline PeekRefType peekRef(BankIdx bidx = 0) {
+      NVHLS_ASSERT_MSG(!isEmpty(bidx), "Peeking data from empty FIFO");
+      return data[bidx];
+    }
+
+    inline DataType peekAt(T offset, BankIdx bidx = 0) {
+      NVHLS_ASSERT_MSG(offset == 0, "Peeking beyond the filled FIFO entries");
+      return peek(bidx);
+    }
+
+    inline void push_all(const DataType wr_data[NumBanks], BankMask valid_mask) {
+      #pragma hls_unroll yes
+      for (unsigned i = 0; i < NumBanks; i++) {
+        if (valid_mask[i] == 1) {
+          NVHLS_ASSERT_MSG(!valid[i], "Pushing data to full FIFO");
+          data[i] = wr_data[i];
+          valid[i] = true;
+          NVHLS_ENERGY("fifo.push", Wrapped<DataType>::width);
+        }
+      }
+    }
+
+    inline void pop_all(DataType rd_data[NumBanks], BankMask valid_mask) {
+      #pragma hls_unroll yes
+      for (unsigned i = 0; i < NumBanks; i++) {
+        if (valid_mask[i] == 1) {
+          NVHLS_ASSERT_MSG(valid[i], "Popping data from empty FIFO");
+          rd_data[i] = data[i];
+          valid[i] = false;
+          NVHLS_ENERGY("fifo.pop", Wrapped<DataType>::width);
+        }
+      }
+    }
+
+    inline void incrHead_all(BankMask valid_mask) {
+      #pragma hls_unroll yes
+      for (unsigned i = 0; i < NumBanks; i++) {
+        if (valid_mask[i] == 1) {
+          NVHLS_ASSERT_MSG(valid[i], "Incrementing Head of empty FIFO");
+          valid[i] = false;
+          NVHLS_ENERGY("fifo.pop", Wrapped<DataType>::width);
+        }
+      }
+    }
+
+    inline void peek_all(DataType rd_data[NumBanks], BankMask valid_mask) {
+      #pragma hls_unroll yes
+      for (unsigned i = 0; i < NumBanks; i++) {
+        if (valid_mask[i] == 1) {
+          NVHLS_ASSERT_MSG(valid[i], "Peeking data from empty FIFO");
+          rd_data[i] = data[i];
+        }
+      }
+    }
+
+    inline BankMask EmptyMask() {
+      BankMask mask = 0;
+      #pragma hls_unroll yes
+      for (unsigned i = 0; i < NumBanks; i++) {
+        mask[i] = valid[i] ? 0 : 1;
+      }
+      return mask;
+    }
+
+    inline BankMask FullMask() {
+      BankMask mask = 0;
+      #pragma hls_unroll yes
+      for (unsigned i = 0; i < NumBanks; i++) {
+        mask[i] = valid[i] ? 1 : 0;
+      }
+      return mask;
+    }
+
     inline bool isEmpty(BankIdx bidx = 0) {   
       return !valid[bidx]; 
     }
@@ -348,12 +702,20 @@ class FIFO<DataType, 1, NumBanks> {
       return valid[bidx]; 
     }
 
-    inline T NumFilled(T bidx = 0) {
-        return valid; 
+    inline T NumFilled(BankIdx bidx = 0) {
+        return valid[bidx];
     }
 
-    inline T NumAvailable(T bidx = 0) {
-      return !valid;
+    inline T NumAvailable(BankIdx bidx = 0) {
+      return !valid[bidx];
+    }
+
+    inline bool almostFull(unsigned int n, BankIdx bidx = 0) {
+      return (n != 0) || valid[bidx];
+    }
+
+    inline bool almostEmpty(unsigned int n, BankIdx bidx = 0) {
+      return (n != 0) || !valid[bidx];
     }
 
     inline void reset() {
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MATCHLIB_PCH_H
+#define MATCHLIB_PCH_H
+
+// Common SystemC, Connections and MatchLib headers that cmod_Makefile
+// precompiles with PCH=1 and force-includes ahead of every source file.
+//
+// Only headers whose contents do not depend on macros that sources define
+// before including them belong here.  For example nvhls_rand.h (RAND_SEED)
+// and nvhls_verify.h (NVHLS_VERIFY_BLOCKS) must stay out.  Macros passed on
+// the command line are fine: if they differ from the precompiled ones, GCC
+// ignores the precompiled header and parses this file instead.
+
+#include <systemc.h>
+#include <hls_globals.h>
+#include <nvhls_types.h>
+#include <nvhls_int.h>
+#include <nvhls_message.h>
+#include <nvhls_marshaller.h>
+#include <nvhls_module.h>
+#include <nvhls_assert.h>
+#include <nvhls_array.h>
+#include <nvhls_connections.h>
+#include <nvhls_packet.h>
+#include <fifo.h>
+#include <Arbiter.h>
+#include <one_hot_to_bin.h>
+
+#endif  // MATCHLIB_PCH_H
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MATCHLIB_PREBUILT_H
+#define MATCHLIB_PREBUILT_H
+
+#include <nvhls_int.h>
+#include <nvhls_packet.h>
+#include <fifo.h>
+#include <Arbiter.h>
+
+/**
+ * \brief Explicit instantiations of common MatchLib classes for C++ simulation
+ * \ingroup Prebuilt
+ *
+ * \par Overview
+ * With PREBUILT=1, cmod_Makefile compiles this header once per set of
+ * compiler flags into libmatchlib_prebuilt.so, with
+ * MATCHLIB_PREBUILT_INSTANTIATE defined.  It then force-includes the header
+ * into every build with MATCHLIB_PREBUILT defined and links the library.  The
+ * extern template declarations below stop every translation unit from
+ * instantiating these classes again.
+ *
+ * Only classes listed in MATCHLIB_PREBUILT_LIST benefit, so the list holds
+ * the FIFO, Arbiter and Packet/Flit instances that the unittests use most.
+ * Without MATCHLIB_PREBUILT, and in synthesis, the header has no effect.
+ */
+
+#if !defined(__SYNTHESIS__) && \
+    (defined(MATCHLIB_PREBUILT) || defined(MATCHLIB_PREBUILT_INSTANTIATE))
+
+#ifdef MATCHLIB_PREBUILT_INSTANTIATE
+#define MATCHLIB_PREBUILT_CLASS(...) template class __VA_ARGS__;
+#else
+#define MATCHLIB_PREBUILT_CLASS(...) extern template class __VA_ARGS__;
+#endif
+
+#define MATCHLIB_PREBUILT_FIFOS(T)              \
+  MATCHLIB_PREBUILT_CLASS(FIFO<T, 2>)           \
+  MATCHLIB_PREBUILT_CLASS(FIFO<T, 4>)           \
+  MATCHLIB_PREBUILT_CLASS(FIFO<T, 8>)           \
+  MATCHLIB_PREBUILT_CLASS(FIFO<T, 16>)
+
+#define MATCHLIB_PREBUILT_LIST                                          \
+  MATCHLIB_PREBUILT_FIFOS(NVUINT8)                                      \
+  MATCHLIB_PREBUILT_FIFOS(NVUINT16)                                     \
+  MATCHLIB_PREBUILT_FIFOS(NVUINT32)                                     \
+  MATCHLIB_PREBUILT_FIFOS(NVUINT64)                                     \
+  MATCHLIB_PREBUILT_CLASS(Arbiter<2>)                                   \
+  MATCHLIB_PREBUILT_CLASS(Arbiter<4>)                                   \
+  MATCHLIB_PREBUILT_CLASS(Arbiter<8>)                                   \
+  MATCHLIB_PREBUILT_CLASS(Arbiter<16>)                                  \
+  MATCHLIB_PREBUILT_CLASS(Flit<64, 0, 0, 0, FlitId2bit, WormHole>)      \
+  MATCHLIB_PREBUILT_CLASS(Flit<16, 0, 0, 2, FlitId2bit, WormHole>)      \
+  MATCHLIB_PREBUILT_CLASS(Packet<64, 4, 1, 2>)                          \
+  MATCHLIB_PREBUILT_CLASS(Packet<64, 4, 1, 8>)
+
+MATCHLIB_PREBUILT_LIST
+
+#endif
+
+#endif  // MATCHLIB_PREBUILT_H
@@ -21,6 +21,11 @@
 #include <nvhls_array.h>
 #include <nvhls_marshaller.h>
 #include <TypeToBits.h>
+#include <nvhls_energy.h>
+#include <nvhls_memory.h>
+#ifndef __SYNTHESIS__
+#include <vector>
+#endif
 
 // T: data type
 // N: number of lines
@@ -53,6 +58,63 @@ class mem_array_2d_transp {
   T data[A][N / A];
 };
 
+#ifndef __SYNTHESIS__
+/**
+ * \brief Simulation-only sparse backing store for one bank of mem_array_sep
+ * \ingroup MemArray
+ *
+ * \tparam Elem_t           Type of a stored element (a slice or a word)
+ * \tparam NumElems         Number of elements in the bank
+ * \tparam PageSize         Number of elements per page
+ *
+ * \par Overview
+ * - Pages are allocated on the first write to any of their elements.
+ * - Elements of pages that were never written read as the fill value: X after construction and 0 after clear(), as in the dense store.
+ * - clear() releases all pages instead of visiting every element.
+ */
+template <typename Elem_t, unsigned int NumElems, unsigned int PageSize>
+class mem_array_sparse_bank {
+  static const unsigned int NumPages = (NumElems + PageSize - 1) / PageSize;
+  std::vector<std::vector<Elem_t> > pages;
+  Elem_t fill;
+
+ public:
+  mem_array_sparse_bank() : pages(NumPages) {
+    NVHLS_MEMORY("mem_array_sparse_bank", sizeof(*this) + NumPages * sizeof(pages[0]));
+  }
+
+  void clear() {
+    for (unsigned i = 0; i < NumPages; i++) {
+      std::vector<Elem_t>().swap(pages[i]);
+    }
+    fill = 0;
+  }
+
+  Elem_t get(unsigned int idx) const {
+    const std::vector<Elem_t>& page = pages[idx / PageSize];
+    return page.empty() ? fill : page[idx % PageSize];
+  }
+
+  void set(unsigned int idx, const Elem_t& val) {
+    std::vector<Elem_t>& page = pages[idx / PageSize];
+    if (page.empty()) {
+      page.assign(PageSize, fill);
+      NVHLS_MEMORY_GROW("mem_array_sparse_bank",
+                        PageSize * (sizeof(Elem_t) + match::HeapBytes<Elem_t>::value));
+    }
+    page[idx % PageSize] = val;
+  }
+
+  unsigned int NumAllocatedPages() const {
+    unsigned int n = 0;
+    for (unsigned i = 0; i < NumPages; i++) {
+      n += pages[i].empty() ? 0 : 1;
+    }
+    return n;
+  }
+};
+#endif
+
 /**
  * \brief Abstract Memory Class 
  * \ingroup MemArray
@@ -60,7 +122,22 @@ class mem_array_2d_transp {
  * \tparam T                Datatype of an entry to be stored in memory 
  * \tparam NumEntries       Number of entries in memory 
  * \tparam NumBanks         Number of banks in memory
+ * \tparam NumByteEnables   Number of independently writable slices per entry
  *
+ * \par Simulation storage
+ * - In C++ simulation each entry is stored as one contiguous word, and a
+ *   partial write_mask is applied with bitwise operations on the whole word.
+ *   Define MEM_ARRAY_SIM_USE_SLICES to keep the per-slice store used for
+ *   synthesis.
+ * - X checks on read and write data are opt-in in the word store: define
+ *   MEM_ARRAY_XCHECK to assert that no X is read or written.
+ * - Define MEM_ARRAY_SPARSE to back each bank with a mem_array_sparse_bank,
+ *   which allocates pages of MEM_ARRAY_SPARSE_PAGE_SIZE elements (default
+ *   1024) on first write. This keeps startup time and memory proportional to
+ *   the touched footprint for large memories. Untouched entries read as X, or
+ *   as 0 after clear().
+ * - Read, write and write_mask semantics are the same for all stores, and the
+ *   flags are ignored under __SYNTHESIS__.
  *
  * \par A Simple Example
  * \code
@@ -94,14 +171,48 @@ class mem_array_sep {
   typedef NVUINTW(NumByteEnables) WriteMask;
   typedef NVUINTW(nvhls::index_width<NumByteEnables>::val) ByteEnableIndex;
 
-  typedef Slice_t BankType[NumEntriesPerBank*NumByteEnables];
-  nvhls::nv_array<BankType, NumBanks> bank;
   static const int width =  NumEntries * WordWidth;
 
+ private:
+#if !defined(__SYNTHESIS__) && !defined(MEM_ARRAY_SIM_USE_SLICES)
+  // C++ simulation: one contiguous word per entry
+  static const unsigned int ElemsPerEntry = 1;
+  typedef Data_t Elem_t;
+#else
+  static const unsigned int ElemsPerEntry = NumByteEnables;
+  typedef Slice_t Elem_t;
+#endif
+  static const unsigned int ElemsPerBank = NumEntriesPerBank * ElemsPerEntry;
+
+ public:
+#if defined(MEM_ARRAY_SPARSE) && !defined(__SYNTHESIS__)
+#ifndef MEM_ARRAY_SPARSE_PAGE_SIZE
+#define MEM_ARRAY_SPARSE_PAGE_SIZE 1024
+#endif
+  typedef mem_array_sparse_bank<Elem_t, ElemsPerBank, MEM_ARRAY_SPARSE_PAGE_SIZE> BankType;
+  BankType bank[NumBanks];
+
+  void clear() {
+    for (unsigned i = 0; i < NumBanks; i++) {
+      bank[i].clear();
+    }
+  }
+
+ private:
+  Elem_t get_elem(unsigned int bank_sel, unsigned int idx) const { return bank[bank_sel].get(idx); }
+  void set_elem(unsigned int bank_sel, unsigned int idx, const Elem_t& val) { bank[bank_sel].set(idx, val); }
+
+ public:
+#else
+  typedef Elem_t BankType[ElemsPerBank];
+  nvhls::nv_array<BankType, NumBanks> bank;
+
   mem_array_sep() {
-    Slice_t value;
+    NVHLS_MEMORY("mem_array_sep", sizeof(*this) + NumBanks * ElemsPerBank *
+                                                      match::HeapBytes<Elem_t>::value);
+    Elem_t value;
     for (unsigned i = 0; i < NumBanks; i++) {
-      for (unsigned j = 0; j < NumByteEnables* NumEntriesPerBank; j++) {
+      for (unsigned j = 0; j < ElemsPerBank; j++) {
 #ifndef SLEC_CPC
         bank[i][j] = value;
 #endif
@@ -110,14 +221,58 @@ class mem_array_sep {
   }
  
   void clear() {
-    Slice_t value = 0;
+    Elem_t value = 0;
     for (unsigned i = 0; i < NumBanks; i++) {
-      for (unsigned j = 0; j < NumByteEnables * NumEntriesPerBank; j++) {
+      for (unsigned j = 0; j < ElemsPerBank; j++) {
         bank[i][j] = value;
       }
     }
   }
 
+ private:
+  Elem_t get_elem(BankIndex bank_sel, LocalSliceIndex idx) { return bank[bank_sel][idx]; }
+  void set_elem(BankIndex bank_sel, LocalSliceIndex idx, const Elem_t& val) { bank[bank_sel][idx] = val; }
+
+ public:
+#endif
+
+#if !defined(__SYNTHESIS__) && !defined(MEM_ARRAY_SIM_USE_SLICES)
+  T read(LocalIndex idx, BankIndex bank_sel=0) {
+    NVHLS_ASSERT_MSG(bank_sel<NumBanks, "bank index out of bounds");
+    NVHLS_ASSERT_MSG(idx<NumEntriesPerBank, "local index out of bounds");
+    Data_t read_data = get_elem(bank_sel, idx);
+#ifdef MEM_ARRAY_XCHECK
+    CMOD_ASSERT_MSG(read_data.xor_reduce()!=sc_logic('X'), "Read data is X");
+#endif
+    NVHLS_ENERGY("mem_array_sep.read", WordWidth);
+    return BitsToType<T>(read_data);
+  }
+
+  void write(LocalIndex idx, BankIndex bank_sel, T val, WriteMask write_mask=~static_cast<WriteMask>(0), bool wce=1) {
+    if (!wce || (write_mask == 0)) {
+      return;
+    }
+    NVHLS_ASSERT_MSG(bank_sel<NumBanks, "bank index out of bounds");
+    NVHLS_ASSERT_MSG(idx<NumEntriesPerBank, "local index out of bounds");
+    Data_t write_data = TypeToBits<T>(val);
+#ifdef MEM_ARRAY_XCHECK
+    CMOD_ASSERT_MSG(write_data.xor_reduce()!=sc_logic('X'), "Write data is X");
+#endif
+    if (write_mask != static_cast<WriteMask>(~static_cast<WriteMask>(0))) {
+      // Merge with the stored word; X in unwritten slices is preserved
+      Data_t mask = 0;
+      Slice_t ones = ~Slice_t(0);
+      for (int i = 0; i < NumByteEnables; i++) {
+        if (write_mask[i] == 1) {
+          mask.range((i+1)*SliceWidth-1, i*SliceWidth) = ones;
+        }
+      }
+      write_data = (get_elem(bank_sel, idx) & ~mask) | (write_data & mask);
+    }
+    set_elem(bank_sel, idx, write_data);
+    NVHLS_ENERGY("mem_array_sep.write", WordWidth);
+  }
+#else
   T read(LocalIndex idx, BankIndex bank_sel=0) {
     Data_t read_data = TypeToBits<NVUINTW(WordWidth)>(0);
     #pragma hls_unroll yes
@@ -125,9 +280,10 @@ class mem_array_sep {
       LocalSliceIndex local_slice_index = idx * NumByteEnables + i;
       NVHLS_ASSERT_MSG(bank_sel<NumBanks, "bank index out of bounds");
       NVHLS_ASSERT_MSG(idx<NumEntriesPerBank, "local index out of bounds");
-      read_data.range((i+1)*SliceWidth-1, i*SliceWidth) = bank[bank_sel][local_slice_index];
+      read_data.range((i+1)*SliceWidth-1, i*SliceWidth) = get_elem(bank_sel, local_slice_index);
     } 
-    CMOD_ASSERT_MSG(read_data.xor_reduce()!=sc_logic('X'), "Read data is X");
+    CMOD_PARANOID_ASSERT_MSG(read_data.xor_reduce()!=sc_logic('X'), "Read data is X");
+    NVHLS_ENERGY("mem_array_sep.read", WordWidth);
     return BitsToType<T>(read_data);
   }
 
@@ -145,18 +301,32 @@ class mem_array_sep {
           LocalSliceIndex local_slice_index = idx * NumByteEnables + i;
           NVHLS_ASSERT_MSG(bank_sel<NumBanks, "bank index out of bounds");
           NVHLS_ASSERT_MSG(idx<NumEntriesPerBank, "local index out of bounds");
-          bank[bank_sel][local_slice_index] = tmp[i];
-          CMOD_ASSERT_MSG(tmp[i].xor_reduce()!=sc_logic('X'), "Write data is X");
+          set_elem(bank_sel, local_slice_index, tmp[i]);
+          CMOD_PARANOID_ASSERT_MSG(tmp[i].xor_reduce()!=sc_logic('X'), "Write data is X");
         }
       }
+      NVHLS_ENERGY("mem_array_sep.write", WordWidth);
     }
   }
+#endif
 
+  // The word store marshalls whole words, which gives the same bit layout as
+  // the slices of an entry in order
   template<unsigned int Size>
   void Marshall(Marshaller<Size>& m) {
     for (unsigned i = 0; i < NumBanks; i++) {
-      for (unsigned j = 0; j < NumByteEnables* NumEntriesPerBank; j++) {
+      for (unsigned j = 0; j < ElemsPerBank; j++) {
+#if defined(MEM_ARRAY_SPARSE) && !defined(__SYNTHESIS__)
+        Elem_t old_elem = get_elem(i, j);
+        Elem_t elem = old_elem;
+        m & elem;
+        // Only unmarshalling a different value allocates a page
+        if (!(elem == old_elem)) {
+          set_elem(i, j, elem);
+        }
+#else
         m & bank[i][j];
+#endif
       }
     }
   } 
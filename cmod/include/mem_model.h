@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MEM_MODEL_H_
+#define MEM_MODEL_H_
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_assert.h>
+#include <hls_globals.h>
+#include <mem_array.h>
+#include <nvhls_stats.h>
+
+/**
+ * \brief Configuration of a mem_model
+ * \ingroup MemArray
+ *
+ * \tparam NumEntries      Number of entries in memory
+ * \tparam NumBanks        Number of banks; address bits below log2(NumBanks) select the bank
+ * \tparam NumReadPorts    Number of read ports
+ * \tparam NumWritePorts   Number of write ports
+ * \tparam ReadLatency     Number of run() calls between a granted read and its response; 0 returns
+ *                         the data in the same call
+ * \tparam DualPortBanks   If true every bank serves one read and one write per cycle (1R1W macro),
+ *                         otherwise one access per cycle (1RW macro)
+ */
+template <int NumEntries, int NumBanks = 1, int NumReadPorts = 1, int NumWritePorts = 1,
+          int ReadLatency = 1, bool DualPortBanks = false>
+struct mem_model_cfg {
+  enum {
+    numEntries = NumEntries,
+    numBanks = NumBanks,
+    numReadPorts = NumReadPorts,
+    numWritePorts = NumWritePorts,
+    readLatency = ReadLatency,
+    dualPortBanks = DualPortBanks
+  };
+};
+
+/**
+ * \brief Multi-port, multi-bank memory with a configurable read latency
+ * \ingroup MemArray
+ *
+ * \tparam T    Datatype of an entry
+ * \tparam Cfg  A mem_model_cfg
+ *
+ * \par Overview
+ * mem_model models the memory-compiler view of an SRAM: NumBanks banks of NumEntries/NumBanks
+ * entries, each mapped to one SRAM macro, behind NumReadPorts read and NumWritePorts write ports.
+ * The banks are a mem_array_sep, so the same source synthesizes to one macro per bank and simulates
+ * with the word store of mem_array_sep in C++.  A configuration is a type, so several points of an
+ * SRAM design space can be simulated from one binary without changing any defines.
+ *
+ * run() models one clock cycle:
+ * - Every bank grants one access per cycle, or one read and one write if DualPortBanks is set.
+ *   Writes are granted before reads, and lower port indices before higher ones.  Requests that are
+ *   not granted are not performed and must be presented again.
+ * - A granted read sees the contents before the writes of the same cycle.
+ * - The response of a granted read is returned on the same port ReadLatency calls later, so up to
+ *   ReadLatency reads per port are in flight.
+ *
+ * \par Statistics
+ * In C++ simulation the public member stats (match::Stats) counts cycles, reads, writes,
+ * read_conflicts and write_conflicts (requests not granted because their bank was busy) and per
+ * bank accesses (bank_accesses_<i>).  The counters compile out under __SYNTHESIS__.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <mem_model.h>
+ *
+ *      ...
+ *      typedef mem_model_cfg<4096, 4, 2, 1, 2> Cfg;  // 4 banks, 2 read ports, 1 write port, latency 2
+ *      mem_model<NVUINTW(64), Cfg> mem;
+ *
+ *      mem.run(rd_valid, rd_addr, wr_valid, wr_addr, wr_data,
+ *              rd_grant, wr_grant, rsp_valid, rsp_data);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename T, typename Cfg>
+class mem_model {
+ public:
+  static const int NumEntries = Cfg::numEntries;
+  static const int NumBanks = Cfg::numBanks;
+  static const int NumReadPorts = Cfg::numReadPorts;
+  static const int NumWritePorts = Cfg::numWritePorts;
+  static const int ReadLatency = Cfg::readLatency;
+  static const bool DualPortBanks = Cfg::dualPortBanks;
+
+  typedef mem_array_sep<T, NumEntries, NumBanks> Banks;
+  typedef typename Banks::LocalIndex LocalIndex;
+  typedef typename Banks::BankIndex BankIndex;
+  static const unsigned int AddrWidth = nvhls::index_width<NumEntries>::val;
+  typedef NVUINTW(AddrWidth) Addr;
+
+  Banks banks;
+  match::Stats stats;
+
+  mem_model() { reset(); }
+
+  // Drops the reads in flight; the memory contents are kept
+  void reset() {
+    #pragma hls_unroll yes
+    for (int s = 0; s <= ReadLatency; s++) {
+      #pragma hls_unroll yes
+      for (int p = 0; p < NumReadPorts; p++) {
+        pipe_valid[s][p] = false;
+      }
+    }
+  }
+
+  static BankIndex GetBankIndex(Addr addr) {
+    return (NumBanks == 1) ? BankIndex(0) : BankIndex(addr % NumBanks);
+  }
+
+  static LocalIndex GetLocalIndex(Addr addr) {
+    return (NumBanks == 1) ? LocalIndex(addr) : LocalIndex(addr / NumBanks);
+  }
+
+  void run(const bool rd_valid[NumReadPorts], const Addr rd_addr[NumReadPorts],
+           const bool wr_valid[NumWritePorts], const Addr wr_addr[NumWritePorts],
+           const T wr_data[NumWritePorts], bool rd_grant[NumReadPorts],
+           bool wr_grant[NumWritePorts], bool rsp_valid[NumReadPorts], T rsp_data[NumReadPorts]) {
+    bool bank_wr_busy[NumBanks];
+    bool bank_rd_busy[NumBanks];
+    #pragma hls_unroll yes
+    for (int b = 0; b < NumBanks; b++) {
+      bank_wr_busy[b] = false;
+      bank_rd_busy[b] = false;
+    }
+
+    // Bank arbitration
+    #pragma hls_unroll yes
+    for (int p = 0; p < NumWritePorts; p++) {
+      BankIndex b = GetBankIndex(wr_addr[p]);
+      wr_grant[p] = wr_valid[p] && !bank_wr_busy[b];
+      if (wr_grant[p]) {
+        bank_wr_busy[b] = true;
+        if (!DualPortBanks) bank_rd_busy[b] = true;
+      }
+    }
+    #pragma hls_unroll yes
+    for (int p = 0; p < NumReadPorts; p++) {
+      BankIndex b = GetBankIndex(rd_addr[p]);
+      rd_grant[p] = rd_valid[p] && !bank_rd_busy[b];
+      if (rd_grant[p]) {
+        bank_rd_busy[b] = true;
+      }
+    }
+
+    // Read response pipeline; stage 0 is filled by the reads of this cycle
+    #pragma hls_unroll yes
+    for (int s = ReadLatency; s > 0; s--) {
+      #pragma hls_unroll yes
+      for (int p = 0; p < NumReadPorts; p++) {
+        pipe_valid[s][p] = pipe_valid[s - 1][p];
+        pipe_data[s][p] = pipe_data[s - 1][p];
+      }
+    }
+    #pragma hls_unroll yes
+    for (int p = 0; p < NumReadPorts; p++) {
+      pipe_valid[0][p] = rd_grant[p];
+      if (rd_grant[p]) {
+        pipe_data[0][p] = banks.read(GetLocalIndex(rd_addr[p]), GetBankIndex(rd_addr[p]));
+      }
+      rsp_valid[p] = pipe_valid[ReadLatency][p];
+      rsp_data[p] = pipe_data[ReadLatency][p];
+    }
+
+    #pragma hls_unroll yes
+    for (int p = 0; p < NumWritePorts; p++) {
+      if (wr_grant[p]) {
+        banks.write(GetLocalIndex(wr_addr[p]), GetBankIndex(wr_addr[p]), wr_data[p]);
+      }
+    }
+
+#ifndef __SYNTHESIS__
+    stats.IncrStat("cycles");
+    for (int p = 0; p < NumWritePorts; p++) {
+      if (wr_grant[p]) {
+        stats.IncrStat("writes");
+        stats.IncrStatIndexed("bank_accesses",
+                              static_cast<unsigned int>(GetBankIndex(wr_addr[p]).to_uint64()));
+      } else if (wr_valid[p]) {
+        stats.IncrStat("write_conflicts");
+      }
+    }
+    for (int p = 0; p < NumReadPorts; p++) {
+      if (rd_grant[p]) {
+        stats.IncrStat("reads");
+        stats.IncrStatIndexed("bank_accesses",
+                              static_cast<unsigned int>(GetBankIndex(rd_addr[p]).to_uint64()));
+      } else if (rd_valid[p]) {
+        stats.IncrStat("read_conflicts");
+      }
+    }
+#endif
+  }
+
+ private:
+  bool pipe_valid[ReadLatency + 1][NumReadPorts];
+  T pipe_data[ReadLatency + 1][NumReadPorts];
+};
+
+#endif  // MEM_MODEL_H_
@@ -18,13 +18,228 @@
 #define NVHLS_ANNOTATE_H_
 
 #include <nvhls_connections_utils.h>
+#include <nvhls_connections.h>
 
 #include <connections/annotate.h>
+#include <rapidjson/document.h>
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 
 namespace nvhls {
   void annotate_design(const sc_object &root, std::string base_name = "", std::string input_dir_path = "", std::string output_dir_path = "") {
     Connections::annotate_design(root, base_name, input_dir_path, output_dir_path);
   }
+
+/**
+ * \brief Profile-guided capacities of the Connections buffered channels
+ * \ingroup Connections
+ *
+ * \par Overview
+ * - Load() reads the profile that Connections::ChannelProfiler::Save() wrote at the end of a previous run: per channel its capacity, message width, stall counters, maximum occupancy and maximum producer backlog, the most cycles its producer was blocked since it was last idle.
+ * - Propose() sizes every channel. A channel whose producer was blocked grows by its backlog, the messages its producer could have pushed on top of a full channel, up to max_capacity; a channel that would grow beyond max_capacity is marked consumer-bound, since a producer that never idles is faster than its consumer and no capacity removes its stalls. A channel whose producer was never blocked shrinks to its maximum occupancy, at least 1. All others keep their capacity.
+ * - The capacity of a buffered channel is a template parameter, so Report() lists the proposals and the storage they add or save in bits. Growing a channel feeds back into the simulation: as the stalls change with the capacity, repeat the profile and sizing runs until the proposals no longer grow.
+ * - annotate_design() with a ChannelSizing calls Connections::annotate_design() as usual and prints the proposals. With apply set, it adds the extra capacity of every grown channel to the annotated capacity of the Combinational bound to the channel's enq port, in <base_name>.sized.input.json in output_dir_path, and annotates the design again from that file, so the run already simulates the larger buffers. This needs the annotated channels of SIM_MODE 1; channels without such a Combinational are only reported.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_annotate.h>
+ *
+ *      ...
+ *      // First run
+ *      Connections::ChannelProfiler::Get().Enable();
+ *      sc_start();
+ *      std::ofstream profile("channels.profile");
+ *      Connections::ChannelProfiler::Get().Save(profile);
+ *
+ *      // Follow-up run
+ *      nvhls::ChannelSizing sizing(true);
+ *      std::ifstream profile("channels.profile");
+ *      sizing.Load(profile);
+ *      nvhls::annotate_design(tb, sizing);
+ *      sc_start();
+ *
+ * \endcode
+ * \par
+ *
+ */
+class ChannelSizing {
+ public:
+  struct Channel {
+    std::string name;
+    unsigned int capacity, bits;
+    uint64 cycles, transfers, backpressure, blocked, max_occupancy, max_backlog;
+    unsigned int proposed;
+    bool consumer_bound;
+  };
+
+  ChannelSizing(bool apply = false, unsigned int max_capacity = 64)
+      : apply_(apply), max_capacity_(max_capacity) {}
+
+  bool apply() const { return apply_; }
+
+  // Reads lines written by ChannelProfiler::Save(); false on a bad line.
+  bool Load(std::istream& in) {
+    std::string line;
+    while (std::getline(in, line)) {
+      std::istringstream ss(line);
+      std::string kind;
+      Channel c;
+      if (!(ss >> kind))
+        continue;
+      if (kind != "channel" ||
+          !(ss >> c.name >> c.capacity >> c.bits >> c.cycles >> c.transfers >> c.backpressure >>
+            c.blocked >> c.max_occupancy >> c.max_backlog))
+        return false;
+      c.proposed = c.capacity;
+      c.consumer_bound = false;
+      channels_.push_back(c);
+    }
+    return true;
+  }
+
+  void Propose() {
+    for (unsigned int i = 0; i < channels_.size(); i++) {
+      Channel& c = channels_[i];
+      c.proposed = c.capacity;
+      c.consumer_bound = false;
+      if (c.blocked != 0) {
+        uint64 grown = c.capacity + c.max_backlog;
+        c.consumer_bound = (grown > max_capacity_);
+        if (c.consumer_bound)
+          grown = (c.capacity > max_capacity_) ? c.capacity : max_capacity_;
+        c.proposed = grown;
+      } else if (c.max_occupancy < c.capacity) {
+        c.proposed = (c.max_occupancy > 1) ? c.max_occupancy : 1;
+      }
+    }
+  }
+
+  const std::vector<Channel>& Channels() const { return channels_; }
+
+  // Prints the channels whose proposed capacity differs from their own, and
+  // the storage added and saved.
+  void Report(std::ostream& out) const {
+    uint64 added = 0, saved = 0;
+    out << "Channel sizing (capacity -> proposed; max occupancy, % of cycles blocked)" << std::endl;
+    std::streamsize precision = out.precision();
+    for (unsigned int i = 0; i < channels_.size(); i++) {
+      const Channel& c = channels_[i];
+      if (c.proposed == c.capacity && !c.consumer_bound)
+        continue;
+      if (c.proposed > c.capacity)
+        added += static_cast<uint64>(c.proposed - c.capacity) * c.bits;
+      else
+        saved += static_cast<uint64>(c.capacity - c.proposed) * c.bits;
+      out << "  " << c.name << ": " << c.capacity << " -> " << c.proposed << "; "
+          << c.max_occupancy << ", " << std::fixed << std::setprecision(1)
+          << (c.cycles ? 100.0 * c.blocked / c.cycles : 0.0);
+      out.unsetf(std::ios::floatfield);
+      if (c.consumer_bound)
+        out << " (consumer-bound)";
+      out << std::endl;
+    }
+    out.precision(precision);
+    out << "Storage: " << added << " bits added, " << saved << " bits saved" << std::endl;
+  }
+
+  // Adds the extra capacity of the grown channels to the Combinationals bound
+  // to their enq ports in the Connections annotation file input_path, and
+  // writes the result to output_path. root_name is the name of the annotated
+  // root, which the port names of the file are relative to. Returns the number
+  // of grown channels, or -1 if input_path cannot be read or output_path
+  // written.
+  int Apply(const std::string& input_path, const std::string& output_path,
+            const std::string& root_name) const {
+    std::ifstream file(input_path.c_str());
+    if (!file)
+      return -1;
+    std::stringstream text;
+    text << file.rdbuf();
+    rapidjson::Document doc;
+    doc.Parse(text.str().c_str());
+    if (doc.HasParseError() || !doc.IsObject() || !doc.HasMember("channels") ||
+        !doc["channels"].IsObject())
+      return -1;
+    std::ofstream json(output_path.c_str());
+    if (!json)
+      return -1;
+    int grown = 0;
+    const rapidjson::Value& channels = doc["channels"];
+    json << "{" << std::endl << "    \"channels\": {";
+    bool first = true;
+    for (rapidjson::Value::ConstMemberIterator it = channels.MemberBegin();
+         it != channels.MemberEnd(); ++it) {
+      const rapidjson::Value& v = it->value;
+      uint64 latency = Member(v, "latency"), capacity = Member(v, "capacity");
+      std::string src = String(v, "src_name"), dest = String(v, "dest_name");
+      for (unsigned int i = 0; i < channels_.size(); i++) {
+        const Channel& c = channels_[i];
+        if (c.proposed > c.capacity && dest == Relative(c.name, root_name) + ".enq") {
+          capacity += c.proposed - c.capacity;
+          grown++;
+        }
+      }
+      json << (first ? "" : ",") << std::endl
+           << "        \"" << it->name.GetString() << "\": {" << std::endl
+           << "            \"latency\": " << latency << "," << std::endl
+           << "            \"capacity\": " << capacity << "," << std::endl
+           << "            \"src_name\": \"" << src << "\"," << std::endl
+           << "            \"dest_name\": \"" << dest << "\"" << std::endl
+           << "        }";
+      first = false;
+    }
+    json << std::endl << "    }" << std::endl << "}" << std::endl;
+    return grown;
+  }
+
+ private:
+  bool apply_;
+  unsigned int max_capacity_;
+  std::vector<Channel> channels_;
+
+  static uint64 Member(const rapidjson::Value& v, const char* name) {
+    return (v.HasMember(name) && v[name].IsUint64()) ? v[name].GetUint64() : 0;
+  }
+
+  static std::string String(const rapidjson::Value& v, const char* name) {
+    return (v.HasMember(name) && v[name].IsString()) ? v[name].GetString() : "";
+  }
+
+  // name without the "<root_name>." prefix
+  static std::string Relative(const std::string& name, const std::string& root_name) {
+    std::string prefix = root_name + ".";
+    if (name.compare(0, prefix.size(), prefix) == 0)
+      return name.substr(prefix.size());
+    return name;
+  }
+};
+
+  // Profile-guided mode: annotates the design as above, then proposes the
+  // capacities of sizing and, if sizing.apply(), applies them through the
+  // annotated Combinationals (see ChannelSizing).
+  inline void annotate_design(const sc_object &root, ChannelSizing &sizing, std::string base_name = "", std::string input_dir_path = "", std::string output_dir_path = "") {
+    Connections::annotate_design(root, base_name, input_dir_path, output_dir_path);
+    sizing.Propose();
+    sizing.Report(std::cout);
+    if (!sizing.apply())
+      return;
+    if (base_name == "")
+      base_name = root.name();
+    std::string dir = (output_dir_path == "") ? "" : output_dir_path + "/";
+    int grown = sizing.Apply(dir + base_name + ".output.json",
+                             dir + base_name + ".sized.input.json", root.name());
+    if (grown < 0) {
+      std::cout << "Channel sizing: cannot read " << dir << base_name << ".output.json" << std::endl;
+      return;
+    }
+    std::cout << "Channel sizing: applied to " << grown << " channels" << std::endl;
+    Connections::annotate_design(root, base_name + ".sized", output_dir_path, output_dir_path);
+  }
 }
 
 #endif // NVHLS_ANNOTATE_H_
@@ -16,18 +16,264 @@
 #ifndef NVHLS_ARRAY
 #define NVHLS_ARRAY
 
-#include <boost/preprocessor/arithmetic/add.hpp>
-#include <boost/preprocessor/punctuation/comma_if.hpp>
-#include <boost/preprocessor/control/if.hpp>
-#include <boost/preprocessor/repetition/repeat.hpp>
-#include <boost/preprocessor/repetition/enum_params.hpp>
-#include <boost/preprocessor/iteration/local.hpp>
-
+#include <nvhls_assert.h>
+#include <nvhls_int.h>
 #include <nvhls_marshaller.h>
 #include <nvhls_message.h>
 #include <nvhls_module.h>
+#include <TypeToBits.h>
 
 namespace nvhls {
+
+/**
+ * \brief Trait for element types that nv_array stores packed with NVHLS_ARRAY_PACKED
+ * \ingroup nv_array
+ *
+ * True in C++ simulation with NVHLS_ARRAY_PACKED for element types with a
+ * nvhls::packed_bits conversion that are at most NVHLS_ARRAY_PACKED_MAX_WIDTH
+ * (default 8) bits wide, e.g. bool and NVUINT1 to NVUINT8.
+ */
+#ifndef NVHLS_ARRAY_PACKED_MAX_WIDTH
+#define NVHLS_ARRAY_PACKED_MAX_WIDTH 8
+#endif
+
+template <typename Type, bool Packable = packed_bits<Type>::value>
+struct nv_array_packed {
+  static const bool value = false;
+};
+
+#if defined(NVHLS_ARRAY_PACKED) && !defined(__SYNTHESIS__)
+template <typename Type>
+struct nv_array_packed<Type, true> {
+  static const bool value = (Wrapped<Type>::width <= NVHLS_ARRAY_PACKED_MAX_WIDTH);
+};
+
+// Proxy for an element of nv_array_packed_impl: converts to Type and supports
+// the assignment, increment and binary operators of Type
+template <typename Type>
+class nv_array_packed_ref {
+ public:
+  static const unsigned int W = Wrapped<Type>::width;
+  static const uint64 mask = (static_cast<uint64>(1) << W) - 1;
+
+  nv_array_packed_ref(uint64* word, unsigned int shift) : word_(word), shift_(shift) {}
+
+  operator Type() const {
+    uint64 bits = (*word_ >> shift_) & mask;
+    Type val;
+    packed_bits<Type>::Unpack(&bits, val);
+    return val;
+  }
+
+  nv_array_packed_ref& operator=(const Type& val) {
+    uint64 bits;
+    packed_bits<Type>::Pack(val, &bits);
+    *word_ = (*word_ & ~(mask << shift_)) | ((bits & mask) << shift_);
+    return *this;
+  }
+
+  nv_array_packed_ref& operator=(const nv_array_packed_ref& that) {
+    return *this = static_cast<Type>(that);
+  }
+
+  template <typename T2>
+  nv_array_packed_ref& operator=(const T2& val) {
+    Type t;
+    t = val;
+    return *this = t;
+  }
+
+  bool operator!() const { return !static_cast<Type>(*this); }
+
+#define NVHLS_ARRAY_REF_COMPOUND(OP)                       \
+  template <typename T2>                                   \
+  nv_array_packed_ref& operator OP##=(const T2& val) {     \
+    Type t = *this;                                        \
+    t OP##= val;                                           \
+    return *this = t;                                      \
+  }
+  NVHLS_ARRAY_REF_COMPOUND(+)
+  NVHLS_ARRAY_REF_COMPOUND(-)
+  NVHLS_ARRAY_REF_COMPOUND(*)
+  NVHLS_ARRAY_REF_COMPOUND(&)
+  NVHLS_ARRAY_REF_COMPOUND(|)
+  NVHLS_ARRAY_REF_COMPOUND(^)
+  NVHLS_ARRAY_REF_COMPOUND(<<)
+  NVHLS_ARRAY_REF_COMPOUND(>>)
+#undef NVHLS_ARRAY_REF_COMPOUND
+
+  nv_array_packed_ref& operator++() { return *this += 1; }
+  nv_array_packed_ref& operator--() { return *this -= 1; }
+  Type operator++(int) {
+    Type t = *this;
+    *this += 1;
+    return t;
+  }
+  Type operator--(int) {
+    Type t = *this;
+    *this -= 1;
+    return t;
+  }
+
+#define NVHLS_ARRAY_REF_BINOP(OP)                                              \
+  friend Type operator OP(const nv_array_packed_ref& a,                       \
+                          const nv_array_packed_ref& b) {                     \
+    return static_cast<Type>(a) OP static_cast<Type>(b);                      \
+  }                                                                           \
+  template <typename T2>                                                      \
+  friend auto operator OP(const nv_array_packed_ref& a, const T2& b)          \
+      -> decltype(Type() OP b) {                                              \
+    return static_cast<Type>(a) OP b;                                         \
+  }                                                                           \
+  template <typename T2>                                                      \
+  friend auto operator OP(const T2& a, const nv_array_packed_ref& b)          \
+      -> decltype(a OP Type()) {                                              \
+    return a OP static_cast<Type>(b);                                         \
+  }
+  NVHLS_ARRAY_REF_BINOP(==)
+  NVHLS_ARRAY_REF_BINOP(!=)
+  NVHLS_ARRAY_REF_BINOP(<)
+  NVHLS_ARRAY_REF_BINOP(>)
+  NVHLS_ARRAY_REF_BINOP(<=)
+  NVHLS_ARRAY_REF_BINOP(>=)
+  NVHLS_ARRAY_REF_BINOP(+)
+  NVHLS_ARRAY_REF_BINOP(-)
+  NVHLS_ARRAY_REF_BINOP(&)
+  NVHLS_ARRAY_REF_BINOP(|)
+  NVHLS_ARRAY_REF_BINOP(^)
+#undef NVHLS_ARRAY_REF_BINOP
+
+ private:
+  uint64* word_;
+  unsigned int shift_;
+};
+
+// Storage of nv_array with NVHLS_ARRAY_PACKED: elements packed into 64-bit
+// words, 64 / W per word
+template <typename Type, unsigned int VectorLength>
+class nv_array_packed_impl {
+ public:
+  typedef nv_array_packed_ref<Type> reference;
+  typedef Type const_reference;
+  static const unsigned int W = Wrapped<Type>::width;
+  static const unsigned int per_word = 64 / W;
+  static const unsigned int num_words = (VectorLength + per_word - 1) / per_word;
+
+  nv_array_packed_impl() {
+    for (unsigned int i = 0; i < num_words; i++) words[i] = 0;
+  }
+  nv_array_packed_impl(sc_module_name nm) {
+    for (unsigned int i = 0; i < num_words; i++) words[i] = 0;
+  }
+  nv_array_packed_impl(sc_module_name nm, const unsigned& id) {
+    for (unsigned int i = 0; i < num_words; i++) words[i] = 0;
+  }
+
+  reference Get(unsigned int idx) {
+    return reference(&words[idx / per_word], (idx % per_word) * W);
+  }
+  const_reference Get(unsigned int idx) const {
+    uint64 bits = (words[idx / per_word] >> ((idx % per_word) * W)) & reference::mask;
+    Type val;
+    packed_bits<Type>::Unpack(&bits, val);
+    return val;
+  }
+
+ private:
+  uint64 words[num_words];
+};
+#endif
+
+// Decimal index suffix of the element names of nv_array_node
+struct nv_array_index_name {
+  char str[11];
+  explicit nv_array_index_name(unsigned int idx) {
+    char digits[10];
+    unsigned int n = 0;
+    do {
+      digits[n++] = '0' + idx % 10;
+      idx /= 10;
+    } while (idx != 0);
+    for (unsigned int i = 0; i < n; i++) str[i] = digits[n - 1 - i];
+    str[n] = 0;
+  }
+};
+
+// Constructor tags of nv_array_node: name every element, or name it and pass
+// its index as a second constructor argument
+struct nv_array_named {};
+struct nv_array_named_id {};
+
+// Storage of nv_array: N separately declared elements in a binary tree of
+// nodes. The lower subtree holds the first Split elements, a power of two, so
+// Get() selects a subtree with one bit of the index: a mux tree in HLS with
+// every element in its own registers. An nv_array of length N instantiates
+// O(log N) node types.
+template <typename A, unsigned int N>
+class nv_array_node {
+ public:
+  static const unsigned int Split = 1 << (log2_ceil<N>::val - 1);
+  typedef A& reference;
+  typedef const A& const_reference;
+
+  nv_array_node() {}
+  nv_array_node(const char* nm)
+      : lo(nm, 0, nv_array_named()), hi(nm, Split, nv_array_named()) {}
+  nv_array_node(const char* nm, const unsigned& id)
+      : lo(nm, 0, nv_array_named_id()), hi(nm, Split, nv_array_named_id()) {}
+  template <typename Tag>
+  nv_array_node(const char* nm, unsigned int base, Tag tag)
+      : lo(nm, base, tag), hi(nm, base + Split, tag) {}
+
+  A& Get(unsigned int idx) {
+    if (idx & Split)
+      return hi.Get(idx & (Split - 1));
+    else
+      return lo.Get(idx & (Split - 1));
+  }
+  const A& Get(unsigned int idx) const {
+    if (idx & Split)
+      return hi.Get(idx & (Split - 1));
+    else
+      return lo.Get(idx & (Split - 1));
+  }
+
+ private:
+  nv_array_node<A, Split> lo;
+  nv_array_node<A, N - Split> hi;
+};
+
+template <typename A>
+class nv_array_node<A, 1> {
+ public:
+  typedef A& reference;
+  typedef const A& const_reference;
+
+  nv_array_node() {}
+  nv_array_node(const char* nm) : data(nvhls_concat(nm, "0")) {}
+  nv_array_node(const char* nm, const unsigned& id) : data(nvhls_concat(nm, "0"), 0) {}
+  nv_array_node(const char* nm, unsigned int base, nv_array_named)
+      : data(nvhls_concat(nm, nv_array_index_name(base).str)) {}
+  nv_array_node(const char* nm, unsigned int base, nv_array_named_id)
+      : data(nvhls_concat(nm, nv_array_index_name(base).str), base) {}
+
+  A& Get(unsigned int idx) { return data; }
+  const A& Get(unsigned int idx) const { return data; }
+
+ private:
+  A data;
+};
+
+// Selects the storage of nv_array
+template <typename Unpacked, typename Packed, bool UsePacked>
+struct nv_array_impl_select {
+  typedef Unpacked type;
+};
+
+template <typename Unpacked, typename Packed>
+struct nv_array_impl_select<Unpacked, Packed, true> {
+  typedef Packed type;
+};
 /**
  * \brief An implementation of array that declares \a VectorLength variables for
  * array of size \a VectorLength
@@ -41,6 +287,20 @@ namespace nvhls {
  * - Helpful when HLS tool does not recognize your array correctly and requires
  * unrolling array
  * - nv_array also has specialization for size 0 arrays
+ * - The variables are the leaves of a binary tree of nv_array_node, so
+ * VectorLength is not limited and an array instantiates O(log VectorLength)
+ * types. operator[] selects a leaf with one index bit per tree level.
+ * - With NVHLS_ARRAY_PACKED (cmod_Makefile ARRAY_PACKED=1), C++ simulation
+ * stores elements of up to NVHLS_ARRAY_PACKED_MAX_WIDTH (default 8) bits,
+ * e.g. bool and NVUINT1 to NVUINT8, packed into 64-bit words. operator[]
+ * then returns a proxy that converts to Type and supports assignment,
+ * compound assignment, increment and decrement, comparison and arithmetic;
+ * other uses, e.g. bit selects, need an explicit conversion to Type first.
+ * Marshall() produces the same bits in both layouts.
+ * - Marshall() moves the whole array through the Marshaller as one field of
+ * width bits, element 0 in the least significant bits (see
+ * nvhls::marshall_array), and TypeToBits conversions of arrays of
+ * NVUINT/NVINT elements use the nvhls::packed_bits fast path.
  *
  * \par A Simple Example
  * \code
@@ -60,43 +320,16 @@ namespace nvhls {
 template <typename Type, unsigned int VectorLength>
 class nv_array {
  public:
-  // Alternate array class with no arrays using boost preprocessor to
-  // define template secializations.
-  template <typename A, unsigned int K>
-  class NNode;
-
-#define ACCESSOR(Z, N, TEXT) \
-  BOOST_PP_IF(N, else, ) if (idx == N) return data##N;
-#define NMINIT(Z, N, TEXT) BOOST_PP_COMMA_IF(N) data##N(nvhls_concat(nm, #N))
-#define NMIDINIT(Z, N, TEXT) \
-  BOOST_PP_COMMA_IF(N) data##N(nvhls_concat(nm, #N), N)
-#define DECL(Z, N, TEXT) TEXT data##N;
-
-#define SPECIALIZATION(Z, N, TEXT)                                         \
-  template <typename A>                                                    \
-  class NNode<A, N> {                                                      \
-   public:                                                                 \
-    BOOST_PP_REPEAT(BOOST_PP_ADD(N, 1), DECL, A)                           \
-    NNode() {}                                                             \
-    NNode(sc_module_name nm)                                               \
-        : BOOST_PP_REPEAT(BOOST_PP_ADD(N, 1), NMINIT, BOOST_PP_EMPTY) {}   \
-    NNode(sc_module_name nm, const unsigned& id)                           \
-        : BOOST_PP_REPEAT(BOOST_PP_ADD(N, 1), NMIDINIT, BOOST_PP_EMPTY) {} \
-    A& Get(unsigned int idx) {                                             \
-      BOOST_PP_REPEAT(BOOST_PP_ADD(N, 1), ACCESSOR, BOOST_PP_EMPTY)        \
-      else return data0;                                                   \
-    }                                                                      \
-    const A& Get(unsigned int idx) const {                                 \
-      BOOST_PP_REPEAT(BOOST_PP_ADD(N, 1), ACCESSOR, BOOST_PP_EMPTY)        \
-      else return data0;                                                   \
-    }                                                                      \
-  };
-
-#define MAX_SPECIALIZATIONS 256
-
-  BOOST_PP_REPEAT(MAX_SPECIALIZATIONS, SPECIALIZATION, BOOST_PP_EMPTY)
-
-  NNode<Type, VectorLength - 1> array_impl;
+#if defined(NVHLS_ARRAY_PACKED) && !defined(__SYNTHESIS__)
+  typedef typename nv_array_impl_select<
+      nv_array_node<Type, VectorLength>, nv_array_packed_impl<Type, VectorLength>,
+      nv_array_packed<Type>::value>::type Impl;
+#else
+  typedef nv_array_node<Type, VectorLength> Impl;
+#endif
+  typedef typename Impl::reference reference;
+  typedef typename Impl::const_reference const_reference;
+  Impl array_impl;
   // END WORKAROUND
   // Type array_impl[VectorLength];
 
@@ -127,20 +360,22 @@ class nv_array {
     for (unsigned i = 0; i < VectorLength; i++)
       out.array_impl.Get(i) = array_impl.Get(i);
   }
-  Type& operator[](unsigned int i) {
-    // assert(i<VectorLength);
+  reference operator[](unsigned int i) {
+#ifndef __SYNTHESIS__
+    NVHLS_ASSERT_MSG(i < VectorLength, "nv_array index out of range");
+#endif
     return this->array_impl.Get(i);
   }
-  const Type& operator[](unsigned int i) const {
-    // assert(i<VectorLength);
+  const_reference operator[](unsigned int i) const {
+#ifndef __SYNTHESIS__
+    NVHLS_ASSERT_MSG(i < VectorLength, "nv_array index out of range");
+#endif
     return this->array_impl.Get(i);
   }
   static const unsigned int width = Wrapped<Type>::width * VectorLength;
   template <unsigned int Size>
   void Marshall(Marshaller<Size>& m) {
-    for (unsigned int x = 0; x < VectorLength; x++) {
-      m& array_impl.Get(x);
-    }
+    array_marshaller<Type, VectorLength>::Marshall(m, *this);
   }
 
 };  // class nv_array
@@ -164,6 +399,13 @@ class nv_array<Type, 0> : public nvhls_message {
   template <unsigned int Size>
   void Marshall(Marshaller<Size>& m) {}
 };
+
+#ifndef __SYNTHESIS__
+// nv_arrays of packed elements convert with shifts in TypeToBits as well
+template <typename Type, unsigned int VectorLength>
+struct packed_bits<nv_array<Type, VectorLength> >
+    : packed_bits_array<Type, VectorLength> {};
+#endif
 };
 
 #endif
@@ -31,6 +31,74 @@
    #define CTC_ENDSKIP_ASSERT ((void)"CTC ENDSKIP");
 #endif
 
+/**
+ * \def NVHLS_ASSERT_LEVEL
+ * \ingroup Assertions
+ * Checking level of the assertions in C++ simulation, selected at compile time
+ * (e.g. with ASSERT_LEVEL=1 in the cmod Makefiles). Synthesis is not affected.
+ * - 0: off. No assertion condition is evaluated.
+ * - 1: cheap. NVHLS_ASSERT, NVHLS_ASSERT_MSG, CMOD_ASSERT and CMOD_ASSERT_MSG are checked; the paranoid assertions are not. Meant for long performance simulations.
+ * - 2: paranoid (default, or 0 if NDEBUG is defined). NVHLS_PARANOID_ASSERT_MSG and CMOD_PARANOID_ASSERT_MSG, used for checks that cost more than a compare such as the X checks of mem_array_sep, are checked as well.
+ *
+ * A checked assertion costs one branch that is predicted not taken; the
+ * failure is reported by an out-of-line cold function. A failing NVHLS_ASSERT*
+ * is an SC_FATAL report of type "NVHLS assertion failed", a failing
+ * CMOD_ASSERT* prints the condition and aborts, as assert() does.
+ */
+#ifndef NVHLS_ASSERT_LEVEL
+#ifdef NDEBUG
+#define NVHLS_ASSERT_LEVEL 0
+#else
+#define NVHLS_ASSERT_LEVEL 2
+#endif
+#endif
+
+#if defined(__GNUC__)
+#define NVHLS_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#define NVHLS_COLD __attribute__((cold, noinline))
+#else
+#define NVHLS_UNLIKELY(x) (x)
+#define NVHLS_COLD
+#endif
+
+#ifndef __SYNTHESIS__
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace nvhls {
+
+NVHLS_COLD inline void assert_failed(const char* expr, const char* msg,
+                                     const char* file, int line) {
+  std::string text(expr);
+  if (msg != NULL)
+    text = text + ": " + msg;
+  sc_core::sc_report_handler::report(sc_core::SC_FATAL, "NVHLS assertion failed",
+                                     text.c_str(), file, line);
+}
+
+NVHLS_COLD inline void cmod_assert_failed(const char* expr, const char* file, int line) {
+  std::cerr << file << ":" << line << ": Assertion `" << expr << "' failed." << std::endl;
+  std::abort();
+}
+
+}  // namespace nvhls
+
+#define NVHLS_ASSERT_CHECK(X, MSG)                                  \
+  do {                                                              \
+    if (NVHLS_UNLIKELY(!(X)))                                       \
+      nvhls::assert_failed(#X, MSG, __FILE__, __LINE__);            \
+  } while (0)
+
+#define CMOD_ASSERT_CHECK(X, PRINT)                                 \
+  do {                                                              \
+    if (NVHLS_UNLIKELY(!(X))) {                                     \
+      PRINT;                                                        \
+      nvhls::cmod_assert_failed(#X, __FILE__, __LINE__);            \
+    }                                                               \
+  } while (0)
+#endif
+
 /**
  * \def NVHLS_ASSERT(x)
  * \ingroup Assertions
@@ -50,15 +118,17 @@
  * \par
  */
 
-#ifdef HLS_CATAPULT
-#include <ac_assert.h>
-#define NVHLS_ASSERT(X) CTC_SKIP_ASSERT assert(X); CTC_ENDSKIP_ASSERT
-#else
-  #ifndef __SYNTHESIS__
-    #define NVHLS_ASSERT(X) CTC_SKIP_ASSERT sc_assert(X); CTC_ENDSKIP_ASSERT
+#ifndef __SYNTHESIS__
+  #if NVHLS_ASSERT_LEVEL >= 1
+    #define NVHLS_ASSERT(X) CTC_SKIP_ASSERT NVHLS_ASSERT_CHECK(X, NULL); CTC_ENDSKIP_ASSERT
   #else
     #define NVHLS_ASSERT(X) CTC_SKIP_ASSERT ((void)0); CTC_ENDSKIP_ASSERT
   #endif
+#elif defined(HLS_CATAPULT)
+#include <ac_assert.h>
+#define NVHLS_ASSERT(X) CTC_SKIP_ASSERT assert(X); CTC_ENDSKIP_ASSERT
+#else
+#define NVHLS_ASSERT(X) CTC_SKIP_ASSERT ((void)0); CTC_ENDSKIP_ASSERT
 #endif
 
 
@@ -81,8 +151,9 @@
  * \par
  */
 
-#ifndef __SYNTHESIS__
-#define CMOD_ASSERT(x) CTC_SKIP_ASSERT assert(x); CTC_ENDSKIP_ASSERT
+#if !defined(__SYNTHESIS__) && NVHLS_ASSERT_LEVEL >= 1
+#define CMOD_ASSERT(x) \
+  CTC_SKIP_ASSERT CMOD_ASSERT_CHECK(x, (void)0); CTC_ENDSKIP_ASSERT
 #else
 #define CMOD_ASSERT(x) CTC_SKIP_ASSERT ((void)0); CTC_ENDSKIP_ASSERT
 #endif
@@ -107,17 +178,19 @@
  */
 
 
-#ifdef HLS_CATAPULT
-#include <ac_assert.h>
-#define NVHLS_ASSERT_MSG(X,MSG) \
-     CTC_SKIP_ASSERT assert(X && MSG); CTC_ENDSKIP_ASSERT
-#else
-  #ifndef __SYNTHESIS__
+#ifndef __SYNTHESIS__
+  #if NVHLS_ASSERT_LEVEL >= 1
     #define NVHLS_ASSERT_MSG(X,MSG)  \
-     CTC_SKIP_ASSERT sc_assert(X && MSG); CTC_ENDSKIP_ASSERT
+     CTC_SKIP_ASSERT NVHLS_ASSERT_CHECK(X, MSG); CTC_ENDSKIP_ASSERT
   #else
     #define NVHLS_ASSERT_MSG(X,MSG) CTC_SKIP_ASSERT ((void)0); CTC_ENDSKIP_ASSERT
   #endif
+#elif defined(HLS_CATAPULT)
+#include <ac_assert.h>
+#define NVHLS_ASSERT_MSG(X,MSG) \
+     CTC_SKIP_ASSERT assert(X && MSG); CTC_ENDSKIP_ASSERT
+#else
+#define NVHLS_ASSERT_MSG(X,MSG) CTC_SKIP_ASSERT ((void)0); CTC_ENDSKIP_ASSERT
 #endif
 
 
@@ -140,15 +213,37 @@
  * \par
  */
 
-#ifndef __SYNTHESIS__
-#define CMOD_ASSERT_MSG(X,MSG)			    \
-  if (!(X)) {					    \
-    DCOUT("Assertion Failed. " << MSG << endl);	    \
-  }						    \
-  CTC_SKIP_ASSERT assert(X); CTC_ENDSKIP_ASSERT
+#if !defined(__SYNTHESIS__) && NVHLS_ASSERT_LEVEL >= 1
+#define CMOD_ASSERT_MSG(X,MSG)                                                  \
+  CTC_SKIP_ASSERT CMOD_ASSERT_CHECK(X, DCOUT("Assertion Failed. " << MSG << endl)); \
+  CTC_ENDSKIP_ASSERT
 #else
 #define CMOD_ASSERT_MSG(X,MSG) CTC_SKIP_ASSERT ((void)0); CTC_ENDSKIP_ASSERT
 #endif
 
+/**
+ * \def NVHLS_PARANOID_ASSERT_MSG(x,msg)
+ * \ingroup Assertions
+ * NVHLS_ASSERT_MSG for checks too costly for the hot path of long simulations. Checked in C++ simulation only at NVHLS_ASSERT_LEVEL 2, and synthesized as NVHLS_ASSERT_MSG.
+ */
+
+#if !defined(__SYNTHESIS__) && NVHLS_ASSERT_LEVEL < 2
+#define NVHLS_PARANOID_ASSERT_MSG(X,MSG) CTC_SKIP_ASSERT ((void)0); CTC_ENDSKIP_ASSERT
+#else
+#define NVHLS_PARANOID_ASSERT_MSG(X,MSG) NVHLS_ASSERT_MSG(X,MSG)
+#endif
+
+/**
+ * \def CMOD_PARANOID_ASSERT_MSG(x,msg)
+ * \ingroup Assertions
+ * CMOD_ASSERT_MSG for checks too costly for the hot path of long simulations. Checked in C++ simulation only at NVHLS_ASSERT_LEVEL 2.
+ */
+
+#if !defined(__SYNTHESIS__) && NVHLS_ASSERT_LEVEL >= 2
+#define CMOD_PARANOID_ASSERT_MSG(X,MSG) CMOD_ASSERT_MSG(X,MSG)
+#else
+#define CMOD_PARANOID_ASSERT_MSG(X,MSG) CTC_SKIP_ASSERT ((void)0); CTC_ENDSKIP_ASSERT
+#endif
+
 
 #endif
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_BFP_VECTOR_H
+#define NVHLS_BFP_VECTOR_H
+
+#include <nvhls_vector.h>
+#include <nvhls_shift.h>
+#include <comptrees.h>
+
+namespace nvhls {
+
+/**
+ * \brief Block-floating-point vector
+ * \ingroup nvhls_vector
+ *
+ * \tparam MantType         Mantissa scalar type (e.g. NVINT8, NVINT4)
+ * \tparam ExpWidth         Width of the signed per-block exponent
+ * \tparam VectorLength     Length of vector
+ * \tparam BlockSize        Number of consecutive elements sharing one exponent
+ *
+ * \par Overview
+ * - Element i has the value mant[i] * 2^exp[i / BlockSize]. VectorLength must be a multiple of BlockSize.
+ * - The packed representation (to_rawbits, Marshall) holds the VectorLength mantissas followed by the NumBlocks exponents, so it takes VectorLength * W + NumBlocks * ExpWidth bits.
+ * - quantize() converts an integer nv_scvector by choosing, for every block, the smallest exponent for which all mantissas fit, and rounding with barrel_right_shift.
+ * - dp() and dpacc() compute integer dot products per block and align them to the largest block exponent, found with Minmax from comptrees.h.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_bfp_vector.h>
+ *
+ *      ...
+ *      nv_scvector<NVINT16, 64> x, w;
+ *      nvhls::nv_bfpvector<NVINT8, 6, 64, 16> xq, wq;   // 4 blocks of int8
+ *      xq.quantize(x);
+ *      wq.quantize(w);
+ *      NVINT24 out;
+ *      NVINT7 out_exp;
+ *      nvhls::dp(xq, wq, out, out_exp);                  // x . w ~ out * 2^out_exp
+ *      ...
+ * \endcode
+ * \par
+ *
+ */
+template <typename MantType, unsigned int ExpWidth, unsigned int VectorLength,
+          unsigned int BlockSize>
+class nv_bfpvector : public nvhls_message {
+ public:
+  static_assert(VectorLength % BlockSize == 0, "VectorLength must be a multiple of BlockSize");
+  typedef MantType mant_t;
+  typedef NVINTW(ExpWidth) exp_t;
+  static const unsigned int NumBlocks = VectorLength / BlockSize;
+  static const unsigned int mant_width = Wrapped<MantType>::width;
+  static const unsigned int exp_width = ExpWidth;
+  static const unsigned int length = VectorLength;
+  static const unsigned int block_size = BlockSize;
+  static const unsigned int width = mant_width * VectorLength + ExpWidth * NumBlocks;
+  static const bool is_signed = Wrapped<MantType>::is_signed;
+
+  nv_scvector<MantType, VectorLength> mant;
+  exp_t exp[NumBlocks];
+
+  nv_bfpvector() {
+#pragma hls_unroll yes
+    for (unsigned int b = 0; b < NumBlocks; b++)
+      exp[b] = 0;
+  }
+  nv_bfpvector(const NVUINTW(width) & rawbits) { to_vector(rawbits); }
+
+  exp_t block_exp(unsigned int i) const { return exp[i / BlockSize]; }
+
+  // Converting vector to rawbits of NVUINT type
+  NVUINTW(width) to_rawbits() const {
+    NVUINTW(width) rawbits = 0;
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < VectorLength; i++)
+      rawbits = nvhls::set_slc(rawbits, mant[i], i * mant_width);
+#pragma hls_unroll yes
+    for (unsigned int b = 0; b < NumBlocks; b++)
+      rawbits = nvhls::set_slc(rawbits, exp[b], VectorLength * mant_width + b * ExpWidth);
+    return rawbits;
+  }
+  // Converting rawbits to vector
+  void to_vector(const NVUINTW(width) & rawbits) {
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < VectorLength; i++)
+      mant[i] = nvhls::get_slc<mant_width>(rawbits, i * mant_width);
+#pragma hls_unroll yes
+    for (unsigned int b = 0; b < NumBlocks; b++)
+      exp[b] = nvhls::get_slc<ExpWidth>(rawbits, VectorLength * mant_width + b * ExpWidth);
+  }
+
+  /**
+   * \brief Quantize an integer vector
+   *
+   * \tparam Round     Rounding of the dropped mantissa bits
+   *
+   * Every block gets the smallest non-negative exponent for which its
+   * elements fit in MantType. Values that round up past the largest mantissa
+   * saturate.
+   */
+  template <shift_round_mode Round, typename InType>
+  void quantize(const nv_scvector<InType, VectorLength>& in) {
+    const unsigned int InWidth = Wrapped<InType>::width;
+    const bool in_signed = Wrapped<InType>::is_signed;
+    typedef NVUINTW(InWidth) bits_t;
+    typedef NVUINTW(nvhls::nbits<InWidth>::val) shift_t;
+    const unsigned int MagWidth = is_signed ? mant_width - 1 : mant_width;
+    MantType mant_max = ~MantType(0);
+    if (is_signed) {
+      mant_max[mant_width - 1] = 0;
+    }
+#pragma hls_unroll yes
+    for (unsigned int b = 0; b < NumBlocks; b++) {
+      // OR of the magnitude bits (one's complement for negative values)
+      bits_t mag = 0;
+#pragma hls_unroll yes
+      for (unsigned int j = 0; j < BlockSize; j++) {
+        bits_t x = in[b * BlockSize + j];
+        if (in_signed && (x[InWidth - 1] == 1)) {
+          x = ~x;
+        }
+        mag = mag | x;
+      }
+      unsigned int bitlen = (mag == 0) ? 0 : InWidth - nvhls::lzd(mag);
+      shift_t shift = (bitlen > MagWidth) ? bitlen - MagWidth : 0;
+      exp[b] = shift;
+#pragma hls_unroll yes
+      for (unsigned int j = 0; j < BlockSize; j++) {
+        InType r = barrel_right_shift<InType, Round>(in[b * BlockSize + j], shift);
+        mant[b * BlockSize + j] = (r > mant_max) ? static_cast<InType>(mant_max) : r;
+      }
+    }
+  }
+
+  template <typename InType>
+  void quantize(const nv_scvector<InType, VectorLength>& in) {
+    quantize<RoundNearestEven>(in);
+  }
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& mant;
+#pragma hls_unroll yes
+    for (unsigned int b = 0; b < NumBlocks; b++) {
+      m& exp[b];
+    }
+  }
+};
+
+template <typename MantType, unsigned int ExpWidth, unsigned int VectorLength,
+          unsigned int BlockSize>
+inline bool operator==(const nv_bfpvector<MantType, ExpWidth, VectorLength, BlockSize>& lhs,
+                       const nv_bfpvector<MantType, ExpWidth, VectorLength, BlockSize>& rhs) {
+  bool is_equal = (lhs.mant == rhs.mant);
+#pragma hls_unroll yes
+  for (unsigned int b = 0; b < lhs.NumBlocks; b++)
+    is_equal &= (lhs.exp[b] == rhs.exp[b]);
+  return is_equal;
+}
+
+template <typename MantType, unsigned int ExpWidth, unsigned int VectorLength,
+          unsigned int BlockSize>
+inline std::ostream& operator<<(std::ostream& os,
+                                const nv_bfpvector<MantType, ExpWidth, VectorLength, BlockSize>& vec) {
+  for (unsigned int b = 0; b < vec.NumBlocks; b++) {
+    os << "[2^" << vec.exp[b] << ":";
+    for (unsigned int j = 0; j < BlockSize; j++) {
+      os << " " << vec.mant[b * BlockSize + j];
+    }
+    os << "] ";
+  }
+  return os;
+}
+
+// Aligns the block partial sums to the largest exponent (found with Minmax)
+// and adds them, truncating the bits shifted out
+template <typename OutType, typename ExpT, unsigned int N>
+void bfp_align_sum(const OutType (&partial)[N], const ExpT (&e)[N], OutType& out, ExpT& out_exp) {
+  const unsigned int EW = Wrapped<ExpT>::width;
+  typedef NVUINTW(EW * N) packed_t;
+  typedef NVUINTW(nvhls::index_width<N>::val) idx_t;
+  typedef NVUINTW(EW) shift_t;
+  packed_t packed = 0;
+#pragma hls_unroll yes
+  for (unsigned int i = 0; i < N; i++)
+    packed = nvhls::set_slc(packed, e[i], i * EW);
+  idx_t max_idx = Minmax<packed_t, ExpT, idx_t, true, nvhls::next_pow2<N>::val>::minmax(packed, 0, N - 1);
+  ExpT e_max = e[max_idx];
+  OutType sum = 0;
+#pragma hls_unroll yes
+  for (unsigned int i = 0; i < N; i++) {
+    shift_t shift = e_max - e[i];
+    sum += barrel_right_shift<OutType, RoundTruncate>(partial[i], shift);
+  }
+  out = sum;
+  out_exp = e_max;
+}
+
+/**
+ * \brief Dot-product of two block-floating-point vectors
+ * \ingroup nvhls_vector
+ *
+ * \par Overview
+ * - Every block computes an integer dot product of its mantissas (nvhls::dp) with exponent exp1[b] + exp2[b]. The block results are shifted right to the largest of these exponents and added, so the result is out * 2^out_exp, out_exp = max(exp1[b] + exp2[b]).
+ * - OutType must hold the per-block dot products. out_exp should be at least ExpWidth + 1 bits wide.
+ */
+template <typename MantType1, typename MantType2, unsigned int ExpWidth, unsigned int VectorLength,
+          unsigned int BlockSize, typename OutType, typename OutExpType>
+void dp(const nv_bfpvector<MantType1, ExpWidth, VectorLength, BlockSize>& in1,
+        const nv_bfpvector<MantType2, ExpWidth, VectorLength, BlockSize>& in2, OutType& out,
+        OutExpType& out_exp) {
+  const unsigned int NumBlocks = VectorLength / BlockSize;
+  typedef NVINTW(ExpWidth + 1) sum_exp_t;
+  OutType partial[NumBlocks];
+  sum_exp_t e[NumBlocks];
+#pragma hls_unroll yes
+  for (unsigned int b = 0; b < NumBlocks; b++) {
+    nv_scvector<MantType1, BlockSize> x;
+    nv_scvector<MantType2, BlockSize> y;
+#pragma hls_unroll yes
+    for (unsigned int j = 0; j < BlockSize; j++) {
+      x[j] = in1.mant[b * BlockSize + j];
+      y[j] = in2.mant[b * BlockSize + j];
+    }
+    dp<MantType1, MantType2, OutType, BlockSize, true>(x, y, partial[b]);
+    e[b] = in1.exp[b] + in2.exp[b];
+  }
+  sum_exp_t e_max;
+  bfp_align_sum(partial, e, out, e_max);
+  out_exp = e_max;
+}
+
+/**
+ * \brief Dot-product of two block-floating-point vectors followed by accumulate
+ * \ingroup nvhls_vector
+ *
+ * \par Overview
+ * Same as dp, with the accumulator acc * 2^acc_exp aligned together with the
+ * block results.
+ */
+template <typename MantType1, typename MantType2, unsigned int ExpWidth, unsigned int VectorLength,
+          unsigned int BlockSize, typename OutType, typename OutExpType>
+void dpacc(const nv_bfpvector<MantType1, ExpWidth, VectorLength, BlockSize>& in1,
+           const nv_bfpvector<MantType2, ExpWidth, VectorLength, BlockSize>& in2, OutType acc,
+           OutExpType acc_exp, OutType& out, OutExpType& out_exp) {
+  const unsigned int NumBlocks = VectorLength / BlockSize;
+  typedef NVINTW(Wrapped<OutExpType>::width) sum_exp_t;
+  OutType partial[NumBlocks + 1];
+  sum_exp_t e[NumBlocks + 1];
+#pragma hls_unroll yes
+  for (unsigned int b = 0; b < NumBlocks; b++) {
+    nv_scvector<MantType1, BlockSize> x;
+    nv_scvector<MantType2, BlockSize> y;
+#pragma hls_unroll yes
+    for (unsigned int j = 0; j < BlockSize; j++) {
+      x[j] = in1.mant[b * BlockSize + j];
+      y[j] = in2.mant[b * BlockSize + j];
+    }
+    dp<MantType1, MantType2, OutType, BlockSize, true>(x, y, partial[b]);
+    e[b] = in1.exp[b] + in2.exp[b];
+  }
+  partial[NumBlocks] = acc;
+  e[NumBlocks] = acc_exp;
+  sum_exp_t e_max;
+  bfp_align_sum(partial, e, out, e_max);
+  out_exp = e_max;
+}
+
+}  // namespace nvhls
+
+#endif
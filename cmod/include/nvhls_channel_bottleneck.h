@@ -0,0 +1,381 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_CHANNEL_BOTTLENECK_H
+#define NVHLS_CHANNEL_BOTTLENECK_H
+
+#include <systemc.h>
+#ifndef __SYNTHESIS__
+#include <nvhls_channel_dump.h>
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#endif
+
+namespace match {
+
+#ifndef __SYNTHESIS__
+/**
+ * \brief Offline stall root-cause analysis of ChannelDump files
+ * \ingroup Connections
+ *
+ * \par Overview
+ * - Reads a file written by match::ChannelDump and attributes every stalled cycle of a channel, a cycle in which its deq is valid but not ready, to a root cause, by following the stall downstream:
+ *   - If a channel fed by the consumer of the stalled channel is full (enq valid but not ready) and is itself stalled, the walk continues there.
+ *   - If that channel is full but draining, its capacity is the root cause: "<channel> full", add buffering there.
+ *   - If no channel fed by the consumer is full, the consumer itself is the root cause: "consumer of <channel>", add throughput there.
+ * - The dump does not hold the topology: AddEdge(upstream, downstream) declares that the block that pops upstream pushes downstream. Without edges every stall is charged to the consumer of its own channel.
+ * - A full channel with no upstream edge is also counted as stalled, since its producer, e.g. a testbench source, is not a channel of the dump.
+ * - SetMark() marks transactions: a message at the deq of a channel for which the predicate returns true is followed until it is transferred, and the stall cycles it spends there are counted separately, so the report ranks the causes of the latency of the marked transactions.
+ * - Channels keep the state of their last sample until the next one, except that a transfer lasts one cycle. The cycle is the smallest interval between two samples of a channel unless set with SetPeriodPs().
+ * - Report() prints the root causes ranked by stalled cycles, or by marked stalled cycles if a mark is set, and the most frequent stall chains.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_channel_bottleneck.h>
+ *
+ *      ...
+ *      match::ChannelBottlenecks analysis;
+ *      analysis.AddEdge("top.dut.in_buffer", "top.dut.out_buffer");
+ *      std::ifstream in("channels.dump", std::ios::binary);
+ *      if (analysis.Analyze(in))
+ *        analysis.Report(std::cout, 10);
+ *
+ * \endcode
+ * \par
+ *
+ */
+class ChannelBottlenecks {
+ public:
+  // Returns true for a deq message of channel that starts a marked
+  // transaction; msg holds the message LSB first, as in the dump.
+  typedef bool (*Mark)(const std::string& channel, const std::vector<unsigned char>& msg);
+
+  struct Cause {
+    std::string channel;
+    bool full;  // channel full while draining; else its consumer is not ready
+    uint64 cycles;
+    uint64 marked_cycles;
+  };
+
+  ChannelBottlenecks()
+      : mark_(NULL), period_ps_(0), stall_cycles_(0), marked_(0), marked_cycles_(0) {}
+
+  void AddEdge(const std::string& upstream, const std::string& downstream) {
+    edges_.push_back(std::make_pair(upstream, downstream));
+  }
+
+  void SetMark(Mark mark) { mark_ = mark; }
+
+  // 0: the smallest sample interval
+  void SetPeriodPs(uint64 period_ps) { period_ps_ = period_ps; }
+
+  // Analyzes a dump; returns false if in is not a dump file or is truncated.
+  bool Analyze(std::istream& in) {
+    causes_.clear();
+    chains_.clear();
+    stall_cycles_ = marked_ = marked_cycles_ = 0;
+    std::vector<Channel> channels;
+    if (!Read(in, channels))
+      return false;
+
+    uint64 period = period_ps_;
+    if (period == 0) {
+      for (unsigned int c = 0; c < channels.size(); c++) {
+        for (unsigned int i = 1; i < channels[c].samples.size(); i++) {
+          uint64 gap = channels[c].samples[i].time_ps - channels[c].samples[i - 1].time_ps;
+          if (gap != 0 && (period == 0 || gap < period))
+            period = gap;
+        }
+      }
+      if (period == 0)
+        period = 1;
+    }
+    period_used_ = period;
+
+    // Topology
+    std::map<std::string, unsigned int> ids;
+    for (unsigned int c = 0; c < channels.size(); c++)
+      ids[channels[c].name] = c;
+    for (unsigned int e = 0; e < edges_.size(); e++) {
+      std::map<std::string, unsigned int>::iterator up = ids.find(edges_[e].first);
+      std::map<std::string, unsigned int>::iterator down = ids.find(edges_[e].second);
+      if (up == ids.end() || down == ids.end())
+        continue;
+      channels[up->second].downstream.push_back(down->second);
+      channels[down->second].has_upstream = true;
+    }
+
+    // Every time at which some channel changes state
+    std::vector<uint64> times;
+    for (unsigned int c = 0; c < channels.size(); c++) {
+      for (unsigned int i = 0; i < channels[c].samples.size(); i++) {
+        const Sample& s = channels[c].samples[i];
+        times.push_back(s.time_ps);
+        if (Transfer(s.flags))
+          times.push_back(s.time_ps + period);
+      }
+    }
+    std::sort(times.begin(), times.end());
+    times.erase(std::unique(times.begin(), times.end()), times.end());
+
+    std::map<std::pair<unsigned int, bool>, unsigned int> cause_ids;
+    std::map<std::string, uint64> chains;
+    for (unsigned int t = 0; t < times.size(); t++) {
+      uint64 now = times[t];
+      for (unsigned int c = 0; c < channels.size(); c++) {
+        Channel& ch = channels[c];
+        if (ch.transfer_end != 0 && now >= ch.transfer_end) {
+          ch.flags = 0;
+          ch.transfer_end = 0;
+        }
+        while (ch.next < ch.samples.size() && ch.samples[ch.next].time_ps == now) {
+          const Sample& s = ch.samples[ch.next++];
+          ch.flags = s.flags;
+          ch.transfer_end = Transfer(s.flags) ? now + period : 0;
+          if (s.has_msg && s.marked && !ch.marked_open) {
+            ch.marked_open = true;
+            marked_++;
+          } else if (s.has_msg && !s.marked) {
+            ch.marked_open = false;
+          }
+          ch.close_marked = Transfer(s.flags);
+        }
+      }
+      uint64 end = (t + 1 < times.size()) ? times[t + 1] : now + period;
+      uint64 cycles = (end - now + period - 1) / period;
+      for (unsigned int c = 0; c < channels.size(); c++) {
+        Channel& ch = channels[c];
+        bool stalled = DeqStalled(ch.flags) || (!ch.has_upstream && EnqStalled(ch.flags));
+        if (stalled) {
+          std::string chain;
+          std::pair<unsigned int, bool> root = Root(channels, c, chain);
+          std::map<std::pair<unsigned int, bool>, unsigned int>::iterator it =
+              cause_ids.find(root);
+          if (it == cause_ids.end()) {
+            Cause cause;
+            cause.channel = channels[root.first].name;
+            cause.full = root.second;
+            cause.cycles = cause.marked_cycles = 0;
+            causes_.push_back(cause);
+            it = cause_ids.insert(std::make_pair(root, causes_.size() - 1)).first;
+          }
+          bool marked = ch.marked_open && DeqStalled(ch.flags);
+          causes_[it->second].cycles += cycles;
+          stall_cycles_ += cycles;
+          if (marked) {
+            causes_[it->second].marked_cycles += cycles;
+            marked_cycles_ += cycles;
+          }
+          chains[chain] += cycles;
+        }
+        if (ch.close_marked) {
+          ch.marked_open = false;
+          ch.close_marked = false;
+        }
+      }
+    }
+
+    std::sort(causes_.begin(), causes_.end(), Order(mark_ != NULL));
+    for (std::map<std::string, uint64>::iterator it = chains.begin(); it != chains.end(); ++it)
+      chains_.push_back(std::make_pair(it->second, it->first));
+    std::sort(chains_.begin(), chains_.end());
+    std::reverse(chains_.begin(), chains_.end());
+    return true;
+  }
+
+  // Root causes, ranked as in Report()
+  const std::vector<Cause>& Causes() const { return causes_; }
+  uint64 StallCycles() const { return stall_cycles_; }
+  uint64 MarkedTransactions() const { return marked_; }
+  uint64 MarkedStallCycles() const { return marked_cycles_; }
+  uint64 PeriodPs() const { return period_used_; }
+
+  // Prints the num_causes (0: all) highest-ranked root causes and as many
+  // stall chains.
+  void Report(std::ostream& out, unsigned int num_causes = 0) const {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << "Channel stalls: " << stall_cycles_ << " stalled cycles, cycle " << period_used_
+        << " ps" << std::endl;
+    if (mark_ != NULL)
+      out << "Marked transactions: " << marked_ << ", " << marked_cycles_
+          << " stalled cycles" << std::endl;
+    unsigned int n = (num_causes == 0 || num_causes > causes_.size()) ? causes_.size()
+                                                                      : num_causes;
+    out << "Root causes:" << std::endl;
+    out << std::setw(12) << "cycles" << std::setw(8) << "share" << std::setw(12) << "marked"
+        << "  root cause" << std::endl;
+    for (unsigned int i = 0; i < n; i++) {
+      const Cause& c = causes_[i];
+      out << std::setw(12) << c.cycles << std::fixed << std::setprecision(1) << std::setw(7)
+          << (stall_cycles_ ? 100.0 * c.cycles / stall_cycles_ : 0.0) << "%" << std::setw(12)
+          << c.marked_cycles << "  ";
+      if (c.full)
+        out << c.channel << " full: add buffering" << std::endl;
+      else
+        out << "consumer of " << c.channel << ": add throughput" << std::endl;
+    }
+    n = (num_causes == 0 || num_causes > chains_.size()) ? chains_.size() : num_causes;
+    out << "Stall chains:" << std::endl;
+    for (unsigned int i = 0; i < n; i++)
+      out << std::setw(12) << chains_[i].first << "  " << chains_[i].second << std::endl;
+    out.flags(flags);
+    out.precision(precision);
+  }
+
+ private:
+  struct Sample {
+    uint64 time_ps;
+    unsigned char flags;
+    bool has_msg;
+    bool marked;
+  };
+
+  struct Channel {
+    std::string name;
+    unsigned int msg_bits;
+    std::vector<Sample> samples;
+    std::vector<unsigned int> downstream;
+    bool has_upstream;
+    // State while analyzing
+    unsigned int next;
+    unsigned char flags;
+    uint64 transfer_end;
+    bool marked_open, close_marked;
+  };
+
+  struct Order {
+    bool marked;
+    explicit Order(bool marked_) : marked(marked_) {}
+    bool operator()(const Cause& a, const Cause& b) const {
+      if (marked && a.marked_cycles != b.marked_cycles)
+        return a.marked_cycles > b.marked_cycles;
+      if (a.cycles != b.cycles)
+        return a.cycles > b.cycles;
+      return a.channel < b.channel;
+    }
+  };
+
+  Mark mark_;
+  uint64 period_ps_, period_used_;
+  std::vector<std::pair<std::string, std::string> > edges_;
+  std::vector<Cause> causes_;
+  std::vector<std::pair<uint64, std::string> > chains_;
+  uint64 stall_cycles_, marked_, marked_cycles_;
+
+  static bool Transfer(unsigned char f) {
+    return (f & ChannelDump::kDeqVal) && (f & ChannelDump::kDeqRdy);
+  }
+  static bool DeqStalled(unsigned char f) {
+    return (f & ChannelDump::kDeqVal) && !(f & ChannelDump::kDeqRdy);
+  }
+  static bool EnqStalled(unsigned char f) {
+    return (f & ChannelDump::kEnqVal) && !(f & ChannelDump::kEnqRdy);
+  }
+
+  // Follows the stall of channel c downstream; returns (channel, full) and
+  // the names along the way in chain.
+  static std::pair<unsigned int, bool> Root(const std::vector<Channel>& channels,
+                                            unsigned int c, std::string& chain) {
+    std::vector<bool> visited(channels.size(), false);
+    chain = channels[c].name;
+    if (!DeqStalled(channels[c].flags)) {
+      chain += " (full)";
+      return std::make_pair(c, true);
+    }
+    while (1) {
+      visited[c] = true;
+      const Channel& ch = channels[c];
+      int next = -1;
+      for (unsigned int i = 0; i < ch.downstream.size() && next < 0; i++) {
+        if (EnqStalled(channels[ch.downstream[i]].flags))
+          next = ch.downstream[i];
+      }
+      if (next < 0) {
+        chain += " (consumer)";
+        return std::make_pair(c, false);
+      }
+      chain += " -> " + channels[next].name;
+      if (!DeqStalled(channels[next].flags) || visited[next]) {
+        chain += " (full)";
+        return std::make_pair(static_cast<unsigned int>(next), true);
+      }
+      c = next;
+    }
+  }
+
+  bool Read(std::istream& in, std::vector<Channel>& channels) const {
+    BinaryTraceReader reader(in);
+    char magic[4];
+    unsigned int version;
+    if (!in.read(magic, 4) || memcmp(magic, "MCHD", 4) != 0 || !reader.Int(version) ||
+        version != ChannelDump::kVersion)
+      return false;
+    std::map<unsigned int, unsigned int> index;
+    std::vector<unsigned char> msg;
+    unsigned char type;
+    while (reader.Int(type)) {
+      uint64 time_ps;
+      unsigned int id, capacity, occupancy;
+      std::string name;
+      if (type == ChannelDump::kChannelRecord) {
+        Channel c;
+        if (!reader.Int(id) || !reader.Int(capacity) || !reader.Int(c.msg_bits) ||
+            !reader.String(c.name))
+          return false;
+        c.has_upstream = false;
+        c.next = 0;
+        c.flags = 0;
+        c.transfer_end = 0;
+        c.marked_open = c.close_marked = false;
+        index[id] = channels.size();
+        channels.push_back(c);
+      } else if (type == ChannelDump::kSampleRecord) {
+        Sample s;
+        if (!reader.Int(time_ps) || !reader.Int(id) || !reader.Int(s.flags) ||
+            !reader.Int(occupancy) || index.find(id) == index.end())
+          return false;
+        Channel& c = channels[index[id]];
+        s.time_ps = time_ps;
+        s.has_msg = (s.flags & ChannelDump::kMsg) != 0;
+        s.marked = false;
+        if (s.has_msg) {
+          msg.resize((c.msg_bits + 7) / 8);
+          if (!msg.empty() && !in.read(reinterpret_cast<char*>(&msg[0]), msg.size()))
+            return false;
+          s.marked = mark_ != NULL && mark_(c.name, msg);
+        }
+        c.samples.push_back(s);
+      } else if (type == ChannelDump::kTriggerRecord) {
+        if (!reader.Int(time_ps) || !reader.String(name))
+          return false;
+      } else {
+        return false;
+      }
+    }
+    return in.eof();
+  }
+};
+#endif
+
+}  // namespace match
+
+#endif  // NVHLS_CHANNEL_BOTTLENECK_H
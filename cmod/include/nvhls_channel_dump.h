@@ -0,0 +1,504 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_CHANNEL_DUMP_H
+#define NVHLS_CHANNEL_DUMP_H
+
+#include <systemc.h>
+#ifndef __SYNTHESIS__
+#include <TypeToBits.h>
+#include <nvhls_trace_sink.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#endif
+
+namespace match {
+
+#ifndef __SYNTHESIS__
+// Handshakes of one channel in one cycle, as seen by a ChannelDump trigger.
+struct ChannelState {
+  const char* name;
+  unsigned int capacity;
+  unsigned int occupancy;
+  bool enq_val, enq_rdy, deq_val, deq_rdy;
+};
+
+// What a ChannelDump keeps per channel; owned by the channel's probe.
+struct ChannelDumpState {
+  ChannelDumpState()
+      : generation(0), id(-1), selected(false), flags(0), occupancy(0), msg_bits(0),
+        has_msg(false) {}
+
+  // Packs the deq message of this cycle, call before ChannelDump::Sample().
+  template <int W>
+  void SetMsg(const sc_lv<W>& bits) {
+    msg.assign((W + 7) / 8, 0);
+    for (int i = 0; i < (W + 31) / 32; i++) {
+      sc_digit word = bits.get_word(i);
+      for (int b = 0; b < 4 && 4 * i + b < (W + 7) / 8; b++)
+        msg[4 * i + b] = (word >> (8 * b)) & 0xff;
+    }
+    if (W % 8 != 0)
+      msg.back() &= (1 << (W % 8)) - 1;
+    has_msg = true;
+  }
+
+  template <typename T>
+  void SetMsg(const T& m) {
+    SetMsg(TypeToBits(m));
+  }
+
+  unsigned int generation;  // Open() the fields below belong to
+  int id;
+  bool selected;
+  unsigned char flags;
+  unsigned int occupancy;
+  unsigned int msg_bits;
+  bool has_msg;
+  std::vector<unsigned char> msg, last_msg;
+};
+
+/**
+ * \brief Trigger-windowed waveform dump of the Connections buffered channels
+ * \ingroup Connections
+ *
+ * \par Overview
+ * - Records the enq and deq valid and ready, the occupancy and the deq message of the Bypass, Pipeline, SkidBuffer, BypassBuffered and Buffer channels, the signals a waveform of the design would be read for, at a fraction of the size and cost of sc_trace on all signals.
+ * - Opt-in at run time: nothing is recorded until Open() is called, and every channel only checks Enabled() until then.
+ * - Select() limits the dump to the channels whose hierarchical name starts with one of the given prefixes; without it every channel is recorded.
+ * - SetWindow() limits it to an interval of simulated time. SetTrigger() holds it back until a predicate on the state of any channel (selected or not) is true for the first time, e.g. TriggerOnFull("top.buffer"), and then records for a given duration or until the window ends.
+ * - Each channel is written when its state changes and on every transfer, so idle and stalled stretches cost nothing and every transferred message is in the file.
+ * - The file starts with the 4 bytes "MCHD" and a uint32 version. Then each record starts with a uint8 type:
+ *   - kChannelRecord: uint32 channel id, uint32 capacity, uint32 message width, uint32 length, name. Written before the first sample of a channel.
+ *   - kSampleRecord: uint64 time in ps, uint32 channel id, uint8 flags (kEnqVal, kEnqRdy, kDeqVal, kDeqRdy, kMsg), uint32 occupancy, and with kMsg the deq message in (width + 7) / 8 bytes, LSB first.
+ *   - kTriggerRecord: uint64 time in ps, uint32 length, name of the channel that fired the trigger.
+ * - Integers are written in host byte order. ChannelDumpToVcd() converts a file to VCD offline, which waveform viewers open directly or convert further, e.g. with vcd2fst.
+ * - Select(), SetWindow() and SetTrigger() take effect at the next Open().
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_connections.h>
+ *
+ *      ...
+ *      match::ChannelDump& dump = match::ChannelDump::Get();
+ *      dump.Select("top.dut.core");
+ *      dump.TriggerOnFull("top.dut.core.in_buffer", sc_time(10, SC_US));
+ *      dump.Open("channels.dump");
+ *      sc_start();
+ *      dump.Close();
+ *
+ *      // Offline:
+ *      std::ifstream in("channels.dump", std::ios::binary);
+ *      std::ofstream out("channels.vcd");
+ *      match::ChannelDumpToVcd(in, out);
+ *
+ * \endcode
+ * \par
+ *
+ */
+class ChannelDump {
+ public:
+  enum { kVersion = 1, kChannelRecord = 0, kSampleRecord = 1, kTriggerRecord = 2 };
+  enum { kEnqVal = 1, kEnqRdy = 2, kDeqVal = 4, kDeqRdy = 8, kMsg = 16 };
+
+  typedef bool (*Trigger)(const ChannelState& state);
+
+  static ChannelDump& Get() {
+    static ChannelDump dump;
+    return dump;
+  }
+
+  ~ChannelDump() { Close(); }
+
+  // Returns false if the file cannot be opened.
+  bool Open(const std::string& filename, unsigned int buffer_size = 1 << 20) {
+    Close();
+    file_.open(filename.c_str(), std::ios::binary | std::ios::trunc);
+    if (!file_)
+      return false;
+    buffer_size_ = buffer_size;
+    buffer_.reserve(buffer_size_);
+    Append("MCHD", 4);
+    AppendInt<unsigned int>(kVersion);
+    generation_++;
+    num_channels_ = 0;
+    triggered_ = false;
+    enabled_ = true;
+    return true;
+  }
+
+  void Close() {
+    if (!enabled_)
+      return;
+    WriteBuffer();
+    file_.close();
+    enabled_ = false;
+  }
+
+  bool Enabled() const { return enabled_; }
+
+  void Select(const std::string& prefix) { prefixes_.push_back(prefix); }
+  void ClearSelection() { prefixes_.clear(); }
+
+  void SetWindow(const sc_time& start, const sc_time& stop) {
+    start_ps_ = Ps(start);
+    stop_ps_ = Ps(stop);
+  }
+
+  // duration 0: until the end of the window
+  void SetTrigger(Trigger trigger, const sc_time& duration = SC_ZERO_TIME) {
+    trigger_ = trigger;
+    full_name_.clear();
+    duration_ps_ = Ps(duration);
+  }
+
+  // Triggers the first time the named channel is full.
+  void TriggerOnFull(const std::string& channel, const sc_time& duration = SC_ZERO_TIME) {
+    trigger_ = NULL;
+    full_name_ = channel;
+    duration_ps_ = Ps(duration);
+  }
+
+  void ClearTrigger() {
+    trigger_ = NULL;
+    full_name_.clear();
+  }
+
+  bool Triggered() const { return triggered_; }
+
+  // Records one cycle of a channel.
+  void Sample(const ChannelState& s, ChannelDumpState& st) {
+    uint64 now = Ps(sc_time_stamp());
+    if (st.generation != generation_) {
+      st.generation = generation_;
+      st.id = -1;
+      st.selected = Selected(s.name);
+    }
+    bool in_window = now >= start_ps_ && now < stop_ps_;
+    bool armed = trigger_ != NULL || !full_name_.empty();
+    if (armed && in_window && !triggered_ && Fires(s)) {
+      triggered_ = true;
+      trigger_ps_ = now;
+      AppendInt<unsigned char>(kTriggerRecord);
+      AppendInt<uint64>(now);
+      AppendString(s.name);
+    }
+    bool recording = in_window && (!armed || (triggered_ && (duration_ps_ == 0 ||
+                                                             now < trigger_ps_ + duration_ps_)));
+    bool has_msg = st.has_msg && s.deq_val;
+    st.has_msg = false;
+    if (!recording || !st.selected)
+      return;
+
+    unsigned char flags = (s.enq_val ? kEnqVal : 0) | (s.enq_rdy ? kEnqRdy : 0) |
+                          (s.deq_val ? kDeqVal : 0) | (s.deq_rdy ? kDeqRdy : 0) |
+                          (has_msg ? kMsg : 0);
+    bool changed = st.id < 0 || flags != st.flags || s.occupancy != st.occupancy ||
+                   (s.deq_val && s.deq_rdy) || (has_msg && st.msg != st.last_msg);
+    if (!changed)
+      return;
+    if (st.id < 0) {
+      st.id = num_channels_++;
+      AppendInt<unsigned char>(kChannelRecord);
+      AppendInt<unsigned int>(st.id);
+      AppendInt<unsigned int>(s.capacity);
+      AppendInt<unsigned int>(st.msg_bits);
+      AppendString(s.name);
+    }
+    AppendInt<unsigned char>(kSampleRecord);
+    AppendInt<uint64>(now);
+    AppendInt<unsigned int>(st.id);
+    AppendInt<unsigned char>(flags);
+    AppendInt<unsigned int>(s.occupancy);
+    if (has_msg) {
+      st.msg.resize((st.msg_bits + 7) / 8, 0);
+      Append(reinterpret_cast<const char*>(&st.msg[0]), st.msg.size());
+      st.last_msg = st.msg;
+    }
+    st.flags = flags;
+    st.occupancy = s.occupancy;
+    if (buffer_.size() >= buffer_size_)
+      WriteBuffer();
+  }
+
+ private:
+  std::ofstream file_;
+  bool enabled_;
+  unsigned int generation_;
+  int num_channels_;
+  unsigned int buffer_size_;
+  std::vector<char> buffer_;
+  std::vector<std::string> prefixes_;
+  uint64 start_ps_, stop_ps_;
+  Trigger trigger_;
+  std::string full_name_;
+  uint64 duration_ps_;
+  bool triggered_;
+  uint64 trigger_ps_;
+
+  ChannelDump()
+      : enabled_(false), generation_(0), num_channels_(0), buffer_size_(0), start_ps_(0),
+        stop_ps_(~static_cast<uint64>(0)), trigger_(NULL), duration_ps_(0),
+        triggered_(false), trigger_ps_(0) {}
+
+  static uint64 Ps(const sc_time& t) {
+    return static_cast<uint64>(t.to_seconds() * 1e12 + 0.5);
+  }
+
+  bool Selected(const char* name) const {
+    if (prefixes_.empty())
+      return true;
+    for (unsigned int i = 0; i < prefixes_.size(); i++) {
+      if (strncmp(name, prefixes_[i].c_str(), prefixes_[i].size()) == 0)
+        return true;
+    }
+    return false;
+  }
+
+  bool Fires(const ChannelState& s) const {
+    if (trigger_ != NULL)
+      return trigger_(s);
+    return s.occupancy >= s.capacity && full_name_ == s.name;
+  }
+
+  void Append(const char* data, size_t size) {
+    buffer_.insert(buffer_.end(), data, data + size);
+  }
+
+  template <typename T>
+  void AppendInt(T value) {
+    char bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+    Append(bytes, sizeof(T));
+  }
+
+  void AppendString(const char* str) {
+    unsigned int size = strlen(str);
+    AppendInt<unsigned int>(size);
+    Append(str, size);
+  }
+
+  void WriteBuffer() {
+    if (!buffer_.empty())
+      file_.write(&buffer_[0], buffer_.size());
+    buffer_.clear();
+  }
+};
+
+/**
+ * \brief Offline converter of ChannelDump files to VCD
+ * \ingroup Connections
+ *
+ * Writes a VCD file with a timescale of 1 ps and one scope per channel,
+ * nested along its hierarchical name, with the signals enq_val, enq_rdy,
+ * deq_val, deq_rdy, occupancy and deq_msg, which is x while deq is not
+ * valid. The trigger signal of the channel_dump scope pulses when the
+ * trigger fires. in must be seekable, as it is read twice. Returns false if
+ * in is not a dump file or is truncated.
+ */
+inline bool ChannelDumpToVcd(std::istream& in, std::ostream& out) {
+  struct Channel {
+    std::string name;
+    unsigned int capacity, msg_bits, occupancy_bits;
+    unsigned int code;  // of the first of its signals
+    unsigned char flags;
+    unsigned int occupancy;
+    bool valid;
+  };
+  BinaryTraceReader reader(in);
+
+  char magic[4];
+  unsigned int version;
+  if (!in.read(magic, 4) || memcmp(magic, "MCHD", 4) != 0 || !reader.Int(version) ||
+      version != ChannelDump::kVersion)
+    return false;
+  std::streampos records = in.tellg();
+
+  // Pass 1: the channels
+  std::map<unsigned int, Channel> channels;
+  unsigned char type;
+  while (reader.Int(type)) {
+    uint64 time_ps;
+    unsigned int id, occupancy;
+    unsigned char flags;
+    std::string name;
+    if (type == ChannelDump::kChannelRecord) {
+      Channel c;
+      if (!reader.Int(id) || !reader.Int(c.capacity) || !reader.Int(c.msg_bits) ||
+          !reader.String(c.name))
+        return false;
+      c.occupancy_bits = 1;
+      while ((1u << c.occupancy_bits) <= c.capacity && c.occupancy_bits < 32)
+        c.occupancy_bits++;
+      channels[id] = c;
+    } else if (type == ChannelDump::kSampleRecord) {
+      if (!reader.Int(time_ps) || !reader.Int(id) || !reader.Int(flags) ||
+          !reader.Int(occupancy) || channels.find(id) == channels.end())
+        return false;
+      if (flags & ChannelDump::kMsg)
+        in.ignore((channels[id].msg_bits + 7) / 8);
+    } else if (type == ChannelDump::kTriggerRecord) {
+      if (!reader.Int(time_ps) || !reader.String(name))
+        return false;
+    } else {
+      return false;
+    }
+  }
+  if (!in.eof())
+    return false;
+
+  // Header: the trigger, then 6 signals per channel
+  unsigned int next_code = 0;
+  struct Code {
+    static std::string Of(unsigned int n) {
+      std::string s;
+      do {
+        s += static_cast<char>('!' + n % 94);
+        n /= 94;
+      } while (n != 0);
+      return s;
+    }
+  };
+  std::string trigger_code = Code::Of(next_code++);
+  out << "$timescale 1ps $end\n";
+  out << "$scope module channel_dump $end\n";
+  out << "$var wire 1 " << trigger_code << " trigger $end\n";
+  out << "$upscope $end\n";
+  std::vector<std::pair<std::string, unsigned int> > by_name;
+  for (std::map<unsigned int, Channel>::iterator it = channels.begin(); it != channels.end();
+       ++it)
+    by_name.push_back(std::make_pair(it->second.name, it->first));
+  std::sort(by_name.begin(), by_name.end());
+  std::vector<std::string> scopes;
+  static const char* const kSignals[] = {"enq_val", "enq_rdy", "deq_val", "deq_rdy",
+                                         "occupancy", "deq_msg"};
+  for (unsigned int i = 0; i < by_name.size(); i++) {
+    Channel& c = channels[by_name[i].second];
+    std::vector<std::string> path;
+    for (size_t start = 0, dot; start <= c.name.size(); start = dot + 1) {
+      dot = c.name.find('.', start);
+      if (dot == std::string::npos)
+        dot = c.name.size();
+      path.push_back(c.name.substr(start, dot - start));
+    }
+    unsigned int common = 0;
+    while (common < scopes.size() && common < path.size() && scopes[common] == path[common])
+      common++;
+    for (unsigned int j = scopes.size(); j > common; j--)
+      out << "$upscope $end\n";
+    scopes.resize(common);
+    for (unsigned int j = common; j < path.size(); j++) {
+      out << "$scope module " << path[j] << " $end\n";
+      scopes.push_back(path[j]);
+    }
+    c.code = next_code;
+    next_code += 6;
+    for (unsigned int j = 0; j < 6; j++) {
+      unsigned int width = (j < 4) ? 1 : (j == 4 ? c.occupancy_bits : c.msg_bits);
+      if (width == 0)
+        continue;
+      out << "$var wire " << width << " " << Code::Of(c.code + j) << " " << kSignals[j]
+          << " $end\n";
+    }
+    c.flags = 0;
+    c.occupancy = 0;
+    c.valid = false;
+  }
+  for (unsigned int j = scopes.size(); j > 0; j--)
+    out << "$upscope $end\n";
+  out << "$enddefinitions $end\n";
+
+  // Pass 2: the value changes
+  in.clear();
+  in.seekg(records);
+  uint64 last_ps = ~static_cast<uint64>(0);
+  bool trigger_high = false;
+  std::vector<unsigned char> msg;
+  while (reader.Int(type)) {
+    uint64 time_ps;
+    unsigned int id, occupancy;
+    unsigned char flags;
+    std::string name;
+    if (type == ChannelDump::kChannelRecord) {
+      Channel c;
+      reader.Int(id);
+      reader.Int(c.capacity);
+      reader.Int(c.msg_bits);
+      reader.String(c.name);
+      continue;
+    }
+    if (type == ChannelDump::kTriggerRecord) {
+      reader.Int(time_ps);
+      reader.String(name);
+    } else {
+      reader.Int(time_ps);
+      reader.Int(id);
+      reader.Int(flags);
+      reader.Int(occupancy);
+    }
+    if (time_ps != last_ps) {
+      out << "#" << time_ps << "\n";
+      last_ps = time_ps;
+      if (trigger_high) {
+        out << "0" << trigger_code << "\n";
+        trigger_high = false;
+      }
+    }
+    if (type == ChannelDump::kTriggerRecord) {
+      out << "1" << trigger_code << "\n";
+      trigger_high = true;
+      continue;
+    }
+    Channel& c = channels[id];
+    unsigned int base = c.code;
+    for (unsigned int j = 0; j < 4; j++) {
+      unsigned char bit = 1 << j;
+      if (!c.valid || ((flags ^ c.flags) & bit))
+        out << ((flags & bit) ? "1" : "0") << Code::Of(base + j) << "\n";
+    }
+    if (!c.valid || occupancy != c.occupancy) {
+      out << "b";
+      for (int b = c.occupancy_bits - 1; b >= 0; b--)
+        out << ((occupancy >> b) & 1);
+      out << " " << Code::Of(base + 4) << "\n";
+    }
+    if (c.msg_bits > 0) {
+      if (flags & ChannelDump::kMsg) {
+        msg.resize((c.msg_bits + 7) / 8);
+        in.read(reinterpret_cast<char*>(&msg[0]), msg.size());
+        out << "b";
+        for (int b = c.msg_bits - 1; b >= 0; b--)
+          out << ((msg[b / 8] >> (b % 8)) & 1);
+        out << " " << Code::Of(base + 5) << "\n";
+      } else if (!c.valid || (c.flags & ChannelDump::kMsg)) {
+        out << "bx " << Code::Of(base + 5) << "\n";
+      }
+    }
+    c.flags = flags;
+    c.occupancy = occupancy;
+    c.valid = true;
+  }
+  return true;
+}
+#endif
+
+}  // namespace match
+
+#endif  // NVHLS_CHANNEL_DUMP_H
@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_CHECKPOINT_H
+#define NVHLS_CHECKPOINT_H
+
+#include <systemc.h>
+#include <nvhls_assert.h>
+#include <TypeToBits.h>
+#ifndef __SYNTHESIS__
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#endif
+
+namespace match {
+
+#ifndef __SYNTHESIS__
+/**
+ * \brief Registry of the state saved and restored by Checkpointer
+ * \ingroup nvhls_module
+ *
+ * Every entry is an object with a Marshall() method, e.g. a FIFO, a
+ * mem_array_sep, a Packet or an NVUINT, under a unique name.  Entries are
+ * normally added by match::Module::RegisterCheckpoint(), which prefixes the
+ * module name.
+ */
+class CheckpointRegistry {
+ public:
+  struct Entry {
+    unsigned int width;
+    void* obj;
+    void (*save)(void* obj, std::vector<unsigned char>& bytes);
+    void (*restore)(void* obj, const std::vector<unsigned char>& bytes);
+  };
+  typedef std::map<std::string, Entry> Entries;
+
+  template <typename T>
+  static void Add(const std::string& name, T& obj) {
+    Entry e;
+    e.width = Wrapped<T>::width;
+    e.obj = &obj;
+    e.save = &Save<T>;
+    e.restore = &Restore<T>;
+    NVHLS_ASSERT_MSG(Get().count(name) == 0, "Checkpoint entry registered twice");
+    Get()[name] = e;
+  }
+
+  static Entries& Get() {
+    static Entries entries;
+    return entries;
+  }
+
+ private:
+  // Bits are packed LSB first, 32 per step
+  template <typename T>
+  static void Save(void* obj, std::vector<unsigned char>& bytes) {
+    static const int W = Wrapped<T>::width;
+    sc_lv<W> bits = TypeToBits<T>(*static_cast<T*>(obj));
+    bytes.assign((W + 7) / 8, 0);
+    for (int lo = 0; lo < W; lo += 32) {
+      int hi = (lo + 31 < W) ? lo + 31 : W - 1;
+      unsigned int word = bits.range(hi, lo).to_uint();
+      for (int b = 0; b * 8 <= hi - lo; b++) bytes[lo / 8 + b] = (word >> (8 * b)) & 0xff;
+    }
+  }
+
+  template <typename T>
+  static void Restore(void* obj, const std::vector<unsigned char>& bytes) {
+    static const int W = Wrapped<T>::width;
+    sc_lv<W> bits;
+    for (int lo = 0; lo < W; lo += 32) {
+      int hi = (lo + 31 < W) ? lo + 31 : W - 1;
+      unsigned int word = 0;
+      for (int b = 0; b * 8 <= hi - lo; b++) word |= static_cast<unsigned int>(bytes[lo / 8 + b]) << (8 * b);
+      bits.range(hi, lo) = word;
+    }
+    *static_cast<T*>(obj) = BitsToType<T>(bits);
+  }
+};
+
+/**
+ * \brief Saves and restores the registered simulation state
+ * \ingroup nvhls_module
+ *
+ * \par Overview
+ * - Save() writes every entry of CheckpointRegistry, with the cycle count, to a file.  Restore() loads a file back into the registered objects of the same names.  An entry with a different width, or one missing from either side, is an error.
+ * - Register members whose state must survive with Module::RegisterCheckpoint().  Only registered state is saved: thread-local variables, Connections channels and testbench state are not.  So take the checkpoint when channels are idle, e.g. between workload phases, and keep loop state in registered members.
+ * - Cycles are counted from the release of rst.  With save_cycle > 0, Save() runs on the falling edge of that cycle, after all clk.pos() processes of the cycle.  With a restore file, Restore() runs when rst is released, before the first cycle.  The resumed run counts cycles from the saved cycle.
+ * - The environment variables NVHLS_CHECKPOINT_SAVE=<cycle>:<file> and NVHLS_CHECKPOINT_RESTORE=<file> override the constructor arguments, so one binary can save a warmed-up state once and resume from it many times.
+ * - C++ simulation only.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_checkpoint.h>
+ *
+ *      // In a match::Module constructor
+ *      RegisterCheckpoint("fifo", fifo);
+ *      RegisterCheckpoint("mem", mem);
+ *      ...
+ *      // In the testbench: save at cycle 100000 unless NVHLS_CHECKPOINT_* says otherwise
+ *      match::Checkpointer checkpointer("checkpointer", 100000, "warm.ckpt");
+ *      checkpointer.clk(clk);
+ *      checkpointer.rst(rst);
+ *
+ * \endcode
+ * \par
+ *
+ */
+class Checkpointer : public sc_module {
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+
+  SC_HAS_PROCESS(Checkpointer);
+  Checkpointer(sc_module_name name_, uint64 save_cycle = 0, const std::string& save_file = "",
+               const std::string& restore_file = "")
+      : sc_module(name_), clk("clk"), rst("rst"), save_cycle_(save_cycle),
+        save_file_(save_file), restore_file_(restore_file), cycle_(0) {
+    const char* env_save = std::getenv("NVHLS_CHECKPOINT_SAVE");
+    if (env_save != NULL) {
+      std::string s(env_save);
+      size_t colon = s.find(':');
+      NVHLS_ASSERT_MSG(colon != std::string::npos, "NVHLS_CHECKPOINT_SAVE must be <cycle>:<file>");
+      save_cycle_ = std::strtoull(s.substr(0, colon).c_str(), NULL, 10);
+      save_file_ = s.substr(colon + 1);
+    }
+    const char* env_restore = std::getenv("NVHLS_CHECKPOINT_RESTORE");
+    if (env_restore != NULL) restore_file_ = env_restore;
+
+    SC_METHOD(tick);
+    sensitive << clk.neg();
+    dont_initialize();
+
+    SC_METHOD(on_reset_release);
+    sensitive << rst.pos();
+    dont_initialize();
+  }
+
+  // Cycles since the release of rst, including those of a restored checkpoint
+  uint64 Cycle() const { return cycle_; }
+
+  bool Save(const std::string& filename) {
+    std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+    if (!file) {
+      SC_REPORT_ERROR("Checkpointer", ("Cannot write checkpoint " + filename).c_str());
+      return false;
+    }
+    CheckpointRegistry::Entries& entries = CheckpointRegistry::Get();
+    file.write(Magic().data(), Magic().size());
+    WriteU64(file, cycle_);
+    WriteU64(file, entries.size());
+    std::vector<unsigned char> bytes;
+    for (CheckpointRegistry::Entries::iterator it = entries.begin(); it != entries.end(); ++it) {
+      it->second.save(it->second.obj, bytes);
+      WriteU64(file, it->first.size());
+      file.write(it->first.data(), it->first.size());
+      WriteU64(file, it->second.width);
+      if (!bytes.empty()) file.write(reinterpret_cast<const char*>(&bytes[0]), bytes.size());
+    }
+    std::cout << sc_time_stamp() << " " << name() << ": saved " << entries.size()
+              << " entries at cycle " << cycle_ << " to " << filename << std::endl;
+    return true;
+  }
+
+  bool Restore(const std::string& filename) {
+    std::ifstream file(filename.c_str(), std::ios::binary);
+    std::string magic(Magic().size(), '\0');
+    if (!file || !file.read(&magic[0], magic.size()) || magic != Magic()) {
+      SC_REPORT_ERROR("Checkpointer", ("Cannot read checkpoint " + filename).c_str());
+      return false;
+    }
+    CheckpointRegistry::Entries& entries = CheckpointRegistry::Get();
+    uint64 cycle = ReadU64(file);
+    uint64 count = ReadU64(file);
+    bool ok = (count == entries.size());
+    std::vector<unsigned char> bytes;
+    for (uint64 i = 0; i < count && ok && file; i++) {
+      std::string entry_name(ReadU64(file), '\0');
+      if (!entry_name.empty()) file.read(&entry_name[0], entry_name.size());
+      unsigned int width = ReadU64(file);
+      bytes.resize((width + 7) / 8);
+      if (!bytes.empty()) file.read(reinterpret_cast<char*>(&bytes[0]), bytes.size());
+      CheckpointRegistry::Entries::iterator it = entries.find(entry_name);
+      ok = file && it != entries.end() && it->second.width == width;
+      if (ok) it->second.restore(it->second.obj, bytes);
+    }
+    if (!ok) {
+      SC_REPORT_ERROR("Checkpointer", ("Checkpoint " + filename + " does not match the registered state").c_str());
+      return false;
+    }
+    cycle_ = cycle;
+    std::cout << sc_time_stamp() << " " << name() << ": restored " << count
+              << " entries of cycle " << cycle_ << " from " << filename << std::endl;
+    return true;
+  }
+
+ private:
+  uint64 save_cycle_;
+  std::string save_file_;
+  std::string restore_file_;
+  uint64 cycle_;
+
+  static std::string Magic() { return std::string("NVCKPT1\n"); }
+
+  static void WriteU64(std::ostream& os, uint64 v) {
+    for (int b = 0; b < 8; b++) os.put(static_cast<char>((v >> (8 * b)) & 0xff));
+  }
+
+  static uint64 ReadU64(std::istream& is) {
+    uint64 v = 0;
+    for (int b = 0; b < 8; b++) v |= static_cast<uint64>(static_cast<unsigned char>(is.get())) << (8 * b);
+    return v;
+  }
+
+  void on_reset_release() {
+    if (!restore_file_.empty()) Restore(restore_file_);
+  }
+
+  void tick() {
+    if (!rst.read()) return;
+    cycle_++;
+    if (save_cycle_ != 0 && cycle_ == save_cycle_ && !save_file_.empty()) Save(save_file_);
+  }
+};
+#endif
+
+}  // namespace match
+
+#endif  // NVHLS_CHECKPOINT_H
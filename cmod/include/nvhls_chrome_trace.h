@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_CHROME_TRACE_H
+#define NVHLS_CHROME_TRACE_H
+
+#include <systemc.h>
+#ifndef __SYNTHESIS__
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <string>
+#include <vector>
+#endif
+
+namespace match {
+
+#ifndef __SYNTHESIS__
+/**
+ * \brief Recorder of simulation activity in the Chrome trace event format
+ * \ingroup nvhls_module
+ *
+ * \par Overview
+ * - Writes a JSON file that chrome://tracing and the Perfetto UI (ui.perfetto.dev) open directly.
+ * - Opt-in at run time: nothing is recorded until Open() is called, and every recording call only checks Enabled() until then.
+ * - Each traced object (a Connections channel, a match::Module) registers a track, shown as one row. Begin()/End() mark spans such as cycles a channel transfers or stalls, Counter() records values such as occupancy and Instant() records events.
+ * - Events are kept in a buffer of buffer_events records and formatted into the file only when the buffer is full or on Close().
+ * - Connections channels record their handshakes and occupancy; Module::RecordEvent() records instant events.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_chrome_trace.h>
+ *
+ *      ...
+ *      match::ChromeTrace::Get().Open("trace.json");
+ *      sc_start();
+ *      match::ChromeTrace::Get().Close();
+ *
+ * \endcode
+ * \par
+ *
+ */
+class ChromeTrace {
+ public:
+  static ChromeTrace& Get() {
+    static ChromeTrace trace;
+    return trace;
+  }
+
+  ~ChromeTrace() { Close(); }
+
+  void Open(const std::string& filename, unsigned int buffer_events = 1 << 16) {
+    Close();
+    file_.open(filename.c_str(), std::ios::trunc);
+    file_ << "{\"traceEvents\":[";
+    first_ = true;
+    buffer_events_ = buffer_events;
+    buffer_.reserve(buffer_events_);
+    enabled_ = true;
+  }
+
+  void Close() {
+    if (!enabled_)
+      return;
+    WriteBuffer();
+    file_ << "\n]}\n";
+    file_.close();
+    enabled_ = false;
+    num_tracks_ = 0;
+  }
+
+  bool Enabled() const { return enabled_; }
+
+  // Returns the id of a new track shown with the given name.
+  int RegisterTrack(const std::string& name) {
+    int tid = num_tracks_++;
+    Record(tid, 'M', Intern(name), 0);
+    return tid;
+  }
+
+  void Begin(int tid, const char* name) { Record(tid, 'B', name, 0); }
+  void End(int tid) { Record(tid, 'E', "", 0); }
+  void Counter(int tid, const char* name, uint64 value) {
+    Record(tid, 'C', name, value);
+  }
+  void Instant(int tid, const std::string& name, uint64 param) {
+    Record(tid, 'i', Intern(name), param);
+  }
+
+ private:
+  struct Event {
+    uint64 ts_ps;
+    int tid;
+    char ph;
+    const char* name;
+    uint64 value;
+  };
+
+  std::ofstream file_;
+  bool enabled_;
+  bool first_;
+  int num_tracks_;
+  unsigned int buffer_events_;
+  std::vector<Event> buffer_;
+  std::set<std::string> names_;
+
+  ChromeTrace() : enabled_(false), first_(true), num_tracks_(0), buffer_events_(0) {}
+
+  // Keeps a copy of name for events that are written later.
+  const char* Intern(const std::string& name) {
+    return names_.insert(name).first->c_str();
+  }
+
+  void Record(int tid, char ph, const char* name, uint64 value) {
+    Event e;
+    e.ts_ps = static_cast<uint64>(sc_time_stamp().to_seconds() * 1e12 + 0.5);
+    e.tid = tid;
+    e.ph = ph;
+    e.name = name;
+    e.value = value;
+    buffer_.push_back(e);
+    if (buffer_.size() >= buffer_events_)
+      WriteBuffer();
+  }
+
+  void WriteString(const char* str) {
+    file_ << '"';
+    for (const char* c = str; *c; c++) {
+      if (*c == '"' || *c == '\\')
+        file_ << '\\';
+      file_ << *c;
+    }
+    file_ << '"';
+  }
+
+  void WriteBuffer() {
+    for (unsigned int i = 0; i < buffer_.size(); i++) {
+      const Event& e = buffer_[i];
+      file_ << (first_ ? "\n" : ",\n");
+      first_ = false;
+      file_ << "{\"pid\":1,\"tid\":" << e.tid << ",\"ph\":\"" << e.ph << "\"";
+      if (e.ph == 'M') {
+        file_ << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+        WriteString(e.name);
+        file_ << "}}";
+        continue;
+      }
+      // Timestamps are in microseconds
+      file_ << ",\"ts\":" << e.ts_ps / 1000000 << "." << std::setfill('0')
+            << std::setw(6) << e.ts_ps % 1000000 << std::setfill(' ');
+      if (e.ph != 'E') {
+        file_ << ",\"name\":";
+        WriteString(e.name);
+      }
+      if (e.ph == 'C')
+        file_ << ",\"args\":{\"value\":" << e.value << "}";
+      if (e.ph == 'i')
+        file_ << ",\"s\":\"t\",\"args\":{\"param\":" << e.value << "}";
+      file_ << "}";
+    }
+    buffer_.clear();
+  }
+};
+#endif
+
+}  // namespace match
+
+#endif  // NVHLS_CHROME_TRACE_H
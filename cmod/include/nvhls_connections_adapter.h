@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//========================================================================
+// nvhls_connections_adapter.h
+//========================================================================
+
+#ifndef NVHLS_CONNECTIONS_ADAPTER_H_
+#define NVHLS_CONNECTIONS_ADAPTER_H_
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+
+namespace Connections {
+
+//------------------------------------------------------------------------
+// PortAdapter
+//------------------------------------------------------------------------
+/**
+ * \brief Pipeline stage between Connections ports of two port types
+ * \ingroup Connections
+ *
+ * \tparam Message      Message type
+ * \tparam EnqPortType  Port type of enq, e.g. TLM_PORT
+ * \tparam DeqPortType  Port type of deq, e.g. MARSHALL_PORT
+ *
+ * \par Overview
+ * - SIM_MODE selects AUTO_PORT, the port type of every port and channel that does not name one, for the whole binary. A module that takes its port type as a template parameter, as the AXI ports of axi4.h and the buffered channels do, can instead be instantiated at another fidelity than the rest of the simulation, e.g. a Block<MARSHALL_PORT> under study inside a CONNECTIONS_FAST_SIM testbench of Block<TLM_PORT>. Inside, it passes PortType to its ports, channels and submodules, so the whole hierarchy below it is switched.
+ * - Ports of different types cannot be bound to the same channel. A PortAdapter connects them: it moves messages from enq to deq through one register, like a Pipeline, one message per cycle with one cycle of latency, so the block under study sees the same traffic as in a simulation at its own fidelity, delayed by a cycle per boundary.
+ * - The RTL wrappers of nvhls_verify.h have the signal-level ports of MARSHALL_PORT or SYN_PORT, so PortAdapters also connect an RTL unit to a TLM_PORT testbench.
+ * - Needs both port types in one binary, so C++ simulation only: SIM_MODE 1 or 2 (CONNECTIONS_SIM_ONLY).
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_connections_adapter.h>
+ *
+ *      ...
+ *      using namespace Connections;
+ *      Block<TLM_PORT> producer;                       // fast
+ *      Block<MARSHALL_PORT> dut;                       // cycle-accurate
+ *      Combinational<Msg, TLM_PORT> fast_chan;
+ *      Combinational<Msg, MARSHALL_PORT> accurate_chan;
+ *      PortAdapter<Msg, TLM_PORT, MARSHALL_PORT> adapter;
+ *
+ *      producer.out(fast_chan);
+ *      adapter.enq(fast_chan);
+ *      adapter.deq(accurate_chan);
+ *      dut.in(accurate_chan);
+ *      adapter.clk(clk);
+ *      adapter.rst(rst);
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename Message, connections_port_t EnqPortType, connections_port_t DeqPortType>
+class PortAdapter : public sc_module {
+  SC_HAS_PROCESS(PortAdapter);
+
+ public:
+  // Interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  In<Message, EnqPortType> enq;
+  Out<Message, DeqPortType> deq;
+
+  PortAdapter()
+      : sc_module(sc_module_name(sc_gen_unique_name("port_adapter"))),
+        clk("clk"),
+        rst("rst"),
+        enq("enq"),
+        deq("deq") {
+    Init();
+  }
+
+  PortAdapter(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        rst("rst"),
+        enq("enq"),
+        deq("deq") {
+    Init();
+  }
+
+ protected:
+  void Init() {
+    SC_THREAD(Process);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void Process() {
+    enq.Reset();
+    deq.Reset();
+    Message msg;
+    bool full = false;
+    wait();
+    while (1) {
+      if (full && deq.PushNB(msg))
+        full = false;
+      if (!full)
+        full = enq.PopNB(msg);
+      wait();
+    }
+  }
+};
+
+}  // namespace Connections
+
+#endif  // NVHLS_CONNECTIONS_ADAPTER_H_
@@ -24,37 +24,104 @@
 #include <nvhls_assert.h>
 #include <nvhls_marshaller.h>
 #include <nvhls_module.h>
+#include <nvhls_chrome_trace.h>
+#include <nvhls_channel_dump.h>
+#include <nvhls_fast_forward.h>
+#include <nvhls_energy.h>
+#include <nvhls_memory.h>
 #include <fifo.h>
 #include <ccs_p2p.h>
+#ifndef __SYNTHESIS__
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+#endif
 
 namespace Connections {
 
-template <typename Message, int BufferSize = 1, connections_port_t port_marshall_type = AUTO_PORT>
+/**
+ * \brief Input port with a FIFO buffer
+ * \ingroup Connections
+ *
+ * \tparam Message          Message type
+ * \tparam BufferSize       Number of buffer entries
+ * \tparam EnableBypass     Forward a message arriving at an empty buffer in the same cycle
+ *
+ * \par Overview
+ * - TransferNB() moves a message from the port into the buffer if it is not full; Empty(), Peek() and Pop() access the buffer.
+ * - AlmostEmpty(n) and AlmostFull(n) compare the buffer occupancy with a watermark, e.g. to batch work once n messages are buffered.
+ * - With EnableBypass, Empty(), Peek() and Pop() read the port themselves when the buffer is empty and the port has not been read in this cycle, so a message that arrives in this cycle can be popped right away. Call TransferNB() at the end of the cycle, after the buffer accesses; it only reads the port if they did not. Full and empty behave as without bypass.
+ */
+template <typename Message, int BufferSize = 1, connections_port_t port_marshall_type = AUTO_PORT,
+          bool EnableBypass = false>
 class InBuffered : public InBlocking<Message, port_marshall_type> {
   FIFO<Message, BufferSize> fifo;
+  bool port_read;
+  typedef NVUINTW(nvhls::index_width<BufferSize+1>::val) AddressPlusOne;
 
  public:
-   InBuffered() : InBlocking<Message, port_marshall_type>(), fifo() {}
+   InBuffered() : InBlocking<Message, port_marshall_type>(), fifo(), port_read(false) {}
 
-  explicit InBuffered(const char* name) : InBlocking<Message, port_marshall_type>(name), fifo() {}
+  explicit InBuffered(const char* name)
+      : InBlocking<Message, port_marshall_type>(name), fifo(), port_read(false) {}
 
   void Reset() {
     InBlocking<Message,port_marshall_type>::Reset();
     fifo.reset();
+    port_read = false;
   }
 
   // Empty
-  bool Empty() { return fifo.isEmpty(); }
+  bool Empty() {
+    ReadThrough();
+    return fifo.isEmpty();
+  }
 
-  Message Pop() { return fifo.pop(); }
+  // Watermarks on the buffer, see FIFO::almostFull() and FIFO::almostEmpty().
+  // They do not read the port, so a bypassed message is not counted.
+  bool AlmostFull(unsigned int n) { return fifo.almostFull(n); }
+  bool AlmostEmpty(unsigned int n) { return fifo.almostEmpty(n); }
+  AddressPlusOne NumFilled() { return fifo.NumFilled(); }
+
+  Message Pop() {
+    ReadThrough();
+    return fifo.pop();
+  }
 
   void IncrHead() { fifo.incrHead(); }
 
-  Message Peek() { return fifo.peek(); }
+  Message Peek() {
+    ReadThrough();
+    return fifo.peek();
+  }
+
+  // Peek without copying the message in C++ simulation, see FIFO::peekRef()
+  typename FIFO<Message, BufferSize>::PeekRefType PeekRef() {
+    ReadThrough();
+    return fifo.peekRef();
+  }
 
   void TransferNB() {
 
-    if (!fifo.isFull()) {
+    if (!fifo.isFull() && !port_read) {
+      Message msg;
+      if (this->PopNB(msg)) {
+        fifo.push(msg);
+      }
+    }
+    port_read = false;
+#ifndef __SYNTHESIS__
+    if (!fifo.isEmpty()) {
+      match::Quiescence::Get().MarkActive();
+    }
+#endif
+  }
+
+ private:
+  // Bypass: an empty buffer reads the port once per cycle on access
+  void ReadThrough() {
+    if (EnableBypass && fifo.isEmpty() && !port_read) {
+      port_read = true;
       Message msg;
       if (this->PopNB(msg)) {
         fifo.push(msg);
@@ -63,18 +130,35 @@ class InBuffered : public InBlocking<Message, port_marshall_type> {
   }
 };
 
-template <typename Message, int BufferSize = 1, connections_port_t port_marshall_type = AUTO_PORT>
+/**
+ * \brief Output port with a FIFO buffer
+ * \ingroup Connections
+ *
+ * \tparam Message          Message type
+ * \tparam BufferSize       Number of buffer entries
+ * \tparam EnableBypass     Send a message pushed to an empty buffer in the same cycle
+ *
+ * \par Overview
+ * - Push() writes a message into the buffer; TransferNB() sends the oldest buffered message on the port.
+ * - AlmostFull(n) and AlmostEmpty(n) compare the buffer occupancy with a watermark, so a producer can throttle before the buffer is full.
+ * - With EnableBypass, Push() on an empty buffer sends the message on the port directly if TransferNB() has not used the port in this cycle, and only buffers it if the port does not accept it. Call TransferNB() at the start of the cycle, before Push(). Full, Empty and NumAvailable behave as without bypass.
+ */
+template <typename Message, int BufferSize = 1, connections_port_t port_marshall_type = AUTO_PORT,
+          bool EnableBypass = false>
 class OutBuffered : public OutBlocking<Message, port_marshall_type> {
   FIFO<Message, BufferSize> fifo;
+  bool port_written;
   typedef NVUINTW(nvhls::index_width<BufferSize+1>::val) AddressPlusOne;
  public:
-  OutBuffered() : OutBlocking<Message, port_marshall_type>(), fifo() {}
+  OutBuffered() : OutBlocking<Message, port_marshall_type>(), fifo(), port_written(false) {}
 
-  explicit OutBuffered(const char* name) : OutBlocking<Message, port_marshall_type>(name), fifo() {}
+  explicit OutBuffered(const char* name)
+      : OutBlocking<Message, port_marshall_type>(name), fifo(), port_written(false) {}
 
   void Reset() {
     OutBlocking<Message,port_marshall_type>::Reset();
     fifo.reset();
+    port_written = false;
   }
 
   // Full
@@ -83,13 +167,32 @@ class OutBuffered : public OutBlocking<Message, port_marshall_type> {
   bool Empty() { return fifo.isEmpty(); }
 
   AddressPlusOne NumAvailable() { return fifo.NumAvailable(); }
+  AddressPlusOne NumFilled() { return fifo.NumFilled(); }
+
+  // Watermarks on the buffer, see FIFO::almostFull() and FIFO::almostEmpty().
+  // A producer that stops pushing at AlmostFull(n) keeps n entries of slack
+  // for messages already in flight in its own pipeline.
+  bool AlmostFull(unsigned int n) { return fifo.almostFull(n); }
+  bool AlmostEmpty(unsigned int n) { return fifo.almostEmpty(n); }
 
-  void Push(const Message& msg) { fifo.push(msg); }
+  void Push(const Message& msg) {
+    if (EnableBypass && fifo.isEmpty() && !port_written) {
+      port_written = true;
+      if (this->PushNB(msg)) {
+        return;
+      }
+    }
+    fifo.push(msg);
+  }
 
   void TransferNB() {
+    port_written = false;
     if (!fifo.isEmpty()) {
-      Message msg = fifo.peek();
-      if (this->PushNB(msg)) {
+#ifndef __SYNTHESIS__
+      match::Quiescence::Get().MarkActive();
+#endif
+      port_written = true;
+      if (this->PushNB(fifo.peekRef())) {
         fifo.pop();
       }
     }
@@ -166,6 +269,352 @@ class StateSignal<Message, TLM_PORT> : public StateSignal<Message, DIRECT_PORT>
  StateSignal(sc_module_name name) : StateSignal<Message, DIRECT_PORT>(name) {}
 };
  
+#ifndef __SYNTHESIS__
+class ChannelProbe;
+
+/**
+ * \brief Utilization and backpressure profiler of the Connections buffered channels
+ * \ingroup Connections
+ *
+ * \par Overview
+ * - Every Bypass, Pipeline, SkidBuffer, BypassBuffered, Buffer and Fork instance registers itself at construction. C++ simulation only.
+ * - Each channel reports the cycles in which it holds or sees a message to the match::Quiescence tracker, which FastForwardClock uses to skip idle cycles.
+ * - After Enable(), each channel counts per cycle: transfers (deq val && rdy), backpressure (deq val && !rdy), starvation (!deq val), cycles its producer is blocked (enq val && !rdy) and an occupancy histogram.
+ * - Report() prints the channels ranked by the fraction of cycles with backpressure or a blocked producer, i.e. the channels whose consumer is the bottleneck come first. Channels with a high starvation fraction are waiting for their producer.
+ * - Save() writes the counters of every profiled channel, with its maximum occupancy and producer backlog, for nvhls::ChannelSizing (nvhls_annotate.h) in a follow-up run.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_connections.h>
+ *
+ *      ...
+ *      Connections::ChannelProfiler::Get().Enable();
+ *      sc_start();
+ *      Connections::ChannelProfiler::Get().Report(std::cout);
+ *
+ * \endcode
+ * \par
+ *
+ */
+class ChannelProfiler {
+ public:
+  static ChannelProfiler& Get() {
+    static ChannelProfiler profiler;
+    return profiler;
+  }
+
+  void Enable(bool enable = true) { enabled_ = enable; }
+  bool Enabled() const { return enabled_; }
+
+  void Register(ChannelProbe* probe) { probes_.push_back(probe); }
+  // Channels are usually destroyed in reverse order, so search from the back
+  void Unregister(ChannelProbe* probe) {
+    for (unsigned int i = probes_.size(); i > 0; i--) {
+      if (probes_[i - 1] == probe) {
+        probes_.erase(probes_.begin() + (i - 1));
+        return;
+      }
+    }
+  }
+
+  // Prints the num_channels (0: all) most stalled channels.
+  void Report(std::ostream& ofile, unsigned int num_channels = 0);
+
+  // Writes one line "channel <name> <capacity> <bits> <cycles> <transfers>
+  // <backpressure> <blocked> <max occupancy> <max backlog>" per profiled
+  // channel.
+  void Save(std::ostream& ofile) const;
+
+  // Every channel constructed so far, in construction order
+  const std::vector<ChannelProbe*>& Probes() const { return probes_; }
+
+ private:
+  bool enabled_;
+  std::vector<ChannelProbe*> probes_;
+
+  ChannelProfiler() : enabled_(false) {}
+};
+
+// Helper class for the channels below: samples the handshakes and occupancy
+// of a channel once per cycle. It counts them for the ChannelProfiler,
+// records them while a match::ChromeTrace is open and dumps them with the
+// deq message while a match::ChannelDump is open. The deq track shows
+// "transfer" (val && rdy) and "stall" (val && !rdy) spans and the occupancy,
+// the enq track shows "blocked" (val && !rdy) spans.
+class ChannelProbe {
+ public:
+  ChannelProbe()
+      : cycles(0), transfers(0), backpressure(0), starvation(0), blocked(0),
+        max_backlog(0), backlog_(0), name_(""), capacity_(0), bits_(0), deq_track_(-1), enq_track_(-1),
+        deq_state_(0), enq_state_(0), occupancy_(0) {}
+
+  ~ChannelProbe() { ChannelProfiler::Get().Unregister(this); }
+
+  // name must live as long as the probe, e.g. the name() of its channel. The
+  // histogram is only allocated once the profiler samples the channel. bits
+  // is the message width charged per transfer to the match::Energy estimate.
+  void Init(const char* name, unsigned int capacity, unsigned int bits = 0) {
+    name_ = name;
+    capacity_ = capacity;
+    bits_ = bits;
+    dump_.msg_bits = bits;
+    ChannelProfiler::Get().Register(this);
+  }
+
+  bool Dumping() const { return match::ChannelDump::Get().Enabled(); }
+
+  // Passes the deq message of this cycle to the ChannelDump; call before
+  // Sample() while Dumping().
+  template <typename Msg>
+  void DumpMsg(const Msg& msg) {
+    dump_.SetMsg(msg);
+  }
+
+  const char* name() const { return name_; }
+  unsigned int capacity() const { return capacity_; }
+  unsigned int bits() const { return bits_; }
+
+  // Highest occupancy sampled by the profiler
+  unsigned int max_occupancy() const {
+    for (unsigned int o = occupancy_hist.size(); o > 0; o--) {
+      if (occupancy_hist[o - 1] != 0)
+        return o - 1;
+    }
+    return 0;
+  }
+
+  void Sample(bool enq_val, bool enq_rdy, bool deq_val, bool deq_rdy,
+              unsigned int occupancy) {
+    if (enq_val || deq_val || occupancy != 0) {
+      match::Quiescence::Get().MarkActive();
+    }
+    if (deq_val && deq_rdy)
+      NVHLS_ENERGY("channel.transfer", bits_);
+    if (ChannelProfiler::Get().Enabled()) {
+      if (occupancy_hist.empty())
+        occupancy_hist.assign(capacity_ + 1, 0);
+      cycles++;
+      transfers += deq_val && deq_rdy;
+      backpressure += deq_val && !deq_rdy;
+      starvation += !deq_val;
+      blocked += enq_val && !enq_rdy;
+      occupancy_hist[occupancy]++;
+      if (!enq_val)
+        backlog_ = 0;
+      else if (!enq_rdy && ++backlog_ > max_backlog)
+        max_backlog = backlog_;
+    }
+    if (Dumping()) {
+      match::ChannelState state = {name_, capacity_, occupancy, enq_val, enq_rdy,
+                                   deq_val, deq_rdy};
+      match::ChannelDump::Get().Sample(state, dump_);
+    }
+
+    match::ChromeTrace& trace = match::ChromeTrace::Get();
+    if (!trace.Enabled()) {
+      deq_track_ = enq_track_ = -1;
+      return;
+    }
+    if (deq_track_ < 0) {
+      deq_track_ = trace.RegisterTrack(std::string(name_) + ".deq");
+      enq_track_ = trace.RegisterTrack(std::string(name_) + ".enq");
+      deq_state_ = enq_state_ = 0;
+      occupancy_ = 0;
+    }
+    static const char* const kDeqSpans[] = {"", "transfer", "stall"};
+    int deq_state = !deq_val ? 0 : (deq_rdy ? 1 : 2);
+    if (deq_state != deq_state_) {
+      if (deq_state_ != 0)
+        trace.End(deq_track_);
+      if (deq_state != 0)
+        trace.Begin(deq_track_, kDeqSpans[deq_state]);
+      deq_state_ = deq_state;
+    }
+    int enq_state = enq_val && !enq_rdy;
+    if (enq_state != enq_state_) {
+      if (enq_state)
+        trace.Begin(enq_track_, "blocked");
+      else
+        trace.End(enq_track_);
+      enq_state_ = enq_state;
+    }
+    if (occupancy != occupancy_) {
+      trace.Counter(deq_track_, "occupancy", occupancy);
+      occupancy_ = occupancy;
+    }
+  }
+
+  // Profile counters
+  uint64 cycles, transfers, backpressure, starvation, blocked;
+  // Most cycles the producer was blocked since it was last idle (!enq val):
+  // the messages it could have pushed into an unbounded channel on top of
+  // the occupancy
+  uint64 max_backlog;
+  std::vector<uint64> occupancy_hist;
+
+ protected:
+  uint64 backlog_;
+  const char* name_;
+  unsigned int capacity_, bits_;
+  int deq_track_, enq_track_;
+  int deq_state_, enq_state_;
+  unsigned int occupancy_;
+  match::ChannelDumpState dump_;
+};
+
+inline void ChannelProfiler::Report(std::ostream& ofile, unsigned int num_channels) {
+  std::vector<std::pair<double, ChannelProbe*> > ranked;
+  for (unsigned int i = 0; i < probes_.size(); i++) {
+    ChannelProbe* p = probes_[i];
+    if (p->cycles == 0)
+      continue;
+    uint64 stalled = (p->backpressure > p->blocked) ? p->backpressure : p->blocked;
+    ranked.push_back(std::make_pair(-static_cast<double>(stalled) / p->cycles, p));
+  }
+  std::stable_sort(ranked.begin(), ranked.end());
+  if (num_channels == 0 || num_channels > ranked.size())
+    num_channels = ranked.size();
+
+  std::streamsize precision = ofile.precision();
+  ofile << "Channel profile (% of cycles: transfer, backpressure, starvation, "
+        << "blocked producer; mean occupancy; occupancy histogram)" << std::endl;
+  for (unsigned int i = 0; i < num_channels; i++) {
+    ChannelProbe* p = ranked[i].second;
+    double c = static_cast<double>(p->cycles);
+    double occ_sum = 0;
+    for (unsigned int o = 0; o < p->occupancy_hist.size(); o++)
+      occ_sum += static_cast<double>(o) * p->occupancy_hist[o];
+    ofile << std::setw(3) << std::dec << i + 1 << ". " << p->name() << ": "
+          << std::fixed << std::setprecision(1) << 100.0 * p->transfers / c << " "
+          << 100.0 * p->backpressure / c << " " << 100.0 * p->starvation / c
+          << " " << 100.0 * p->blocked / c << "; " << std::setprecision(2)
+          << occ_sum / c << ";";
+    for (unsigned int o = 0; o < p->occupancy_hist.size(); o++)
+      ofile << " " << o << ":" << p->occupancy_hist[o];
+    ofile << std::endl;
+  }
+  ofile.unsetf(std::ios::floatfield);
+  ofile.precision(precision);
+}
+
+inline void ChannelProfiler::Save(std::ostream& ofile) const {
+  for (unsigned int i = 0; i < probes_.size(); i++) {
+    const ChannelProbe* p = probes_[i];
+    if (p->cycles == 0)
+      continue;
+    ofile << "channel " << p->name() << " " << p->capacity() << " " << p->bits() << " "
+          << p->cycles << " " << p->transfers << " " << p->backpressure << " " << p->blocked
+          << " " << p->max_occupancy() << " " << p->max_backlog << std::endl;
+  }
+}
+#endif
+
+//------------------------------------------------------------------------
+// TlmChannel: TLM_PORT view of Bypass, Pipeline, BypassBuffered and Buffer
+//------------------------------------------------------------------------
+
+/**
+ * \brief Thread-based channel with pooled message storage for TLM_PORT
+ * \ingroup Connections
+ *
+ * \tparam Message          Message type
+ * \tparam NumEntries       Number of buffer entries
+ * \tparam SameCycle        A message arriving at an empty channel can leave in the same cycle (Bypass, BypassBuffered)
+ * \tparam FreeOnDeq        An entry dequeued in a cycle can be refilled in the same cycle (Pipeline)
+ *
+ * \par Overview
+ * The DIRECT_PORT channels keep every entry in an sc_signal, so a message is
+ * copied into and out of several signals, and compared with their old value
+ * on every write, on its way through the channel.  With wide messages in
+ * CONNECTIONS_FAST_SIM this dominates the simulation time.  TlmChannel is the
+ * TLM_PORT view of the same channels, in the style of the TLM_PORT WideBuffer:
+ * one thread per channel and a ring of NumEntries message slots that are
+ * constructed once.  PopNB() writes each arriving message straight into its
+ * slot and PushNB() sends it from there, so a message is copied once in and
+ * once out and never constructed or compared by the channel.
+ *
+ * The ready and valid behavior of each channel is kept at cycle granularity;
+ * the ChannelProbe of a TlmChannel only sees transfers, not stalled valids.
+ */
+template <typename Message, unsigned int NumEntries, bool SameCycle, bool FreeOnDeq>
+class TlmChannel : public sc_module {
+  SC_HAS_PROCESS(TlmChannel);
+
+ public:
+  // Interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  In<Message, TLM_PORT> enq;
+  Out<Message, TLM_PORT> deq;
+
+  TlmChannel(sc_module_name name) : sc_module(name), clk("clk"), rst("rst") {
+#ifndef __SYNTHESIS__
+    probe_.Init(this->name(), NumEntries, Wrapped<Message>::width);
+    NVHLS_MEMORY("Connections::TlmChannel", sizeof(*this));
+#endif
+    SC_THREAD(Seq);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+ protected:
+  Message pool[NumEntries];
+  unsigned int head;
+  unsigned int count;
+
+#ifndef __SYNTHESIS__
+  ChannelProbe probe_;
+#endif
+
+  unsigned int Tail() const { return (head + NumEntries - count) % NumEntries; }
+
+  void Seq() {
+    enq.Reset();
+    deq.Reset();
+    head = 0;
+    count = 0;
+
+    wait();
+
+    while (1) {
+      unsigned int old_count = count;
+      bool pushed = false;
+      bool popped = false;
+#ifndef __SYNTHESIS__
+      if (count > 0 && probe_.Dumping())
+        probe_.DumpMsg(pool[Tail()]);
+#endif
+      if (count > 0 && deq.PushNB(pool[Tail()], false)) {
+        count--;
+        pushed = true;
+      }
+      bool rdy = (FreeOnDeq ? count : old_count) < NumEntries;
+      if (rdy && enq.PopNB(pool[head], false)) {
+        head = (head + 1) % NumEntries;
+        count++;
+        popped = true;
+      }
+#ifndef __SYNTHESIS__
+      if (SameCycle && old_count == 0 && popped && probe_.Dumping())
+        probe_.DumpMsg(pool[Tail()]);
+#endif
+      if (SameCycle && old_count == 0 && popped && deq.PushNB(pool[Tail()], false)) {
+        count--;
+        pushed = true;
+      }
+#ifndef __SYNTHESIS__
+      probe_.Sample(popped, rdy, old_count > 0 || pushed, pushed, old_count);
+#endif
+      wait();
+    }
+  }
+
+#ifndef __SYNTHESIS__
+ public:
+  void line_trace() { std::cout << " ( " << std::dec << count << " ) | "; }
+#endif
+};
+
 //------------------------------------------------------------------------
 // Bypass
 //------------------------------------------------------------------------
@@ -202,13 +651,25 @@ class Bypass : public sc_module {
   sc_signal<Bit> full;
   StateSignal<Message, port_marshall_type> state;
 
+#ifndef __SYNTHESIS__
+  ChannelProbe probe_;
+#endif
+
   // Helper functions
   void Init() {
+#ifndef __SYNTHESIS__
+    probe_.Init(name(), 1, Wrapped<Message>::width);
+    NVHLS_MEMORY("Connections::Bypass", sizeof(*this));
+#endif
 #ifdef CONNECTIONS_SIM_ONLY
     enq.disable_spawn();
     deq.disable_spawn();
 #endif
     
+#ifdef CONNECTIONS_SIM_ONLY
+    SC_METHOD(Comb);
+    sensitive << full << enq.val << deq.rdy << enq.msg << state.msg;
+#else
     SC_METHOD(EnqRdy);
     sensitive << full;
 
@@ -220,6 +681,7 @@ class Bypass : public sc_module {
 
     SC_METHOD(BypassMux);
     sensitive << enq.msg << state.msg << full;
+#endif
 
     SC_THREAD(Seq);
     sensitive << clk.pos();
@@ -228,6 +690,17 @@ class Bypass : public sc_module {
 
   // Combinational logic
 
+#ifdef CONNECTIONS_SIM_ONLY
+  // C++ simulation evaluates all of the logic below in one process, so a
+  // channel elaborates one SC_METHOD instead of one per output
+  void Comb() {
+    EnqRdy();
+    DeqVal();
+    WriteEn();
+    BypassMux();
+  }
+#endif
+
   // Write enable
   void WriteEn() {
     wen.write(enq.val.read() && !deq.rdy.read() && !full.read());
@@ -259,6 +732,12 @@ class Bypass : public sc_module {
     wait();
 
     while (1) {
+#ifndef __SYNTHESIS__
+      if (probe_.Dumping())
+        probe_.DumpMsg(deq.msg.read());
+      probe_.Sample(enq.val.read(), enq.rdy.read(), deq.val.read(), deq.rdy.read(),
+                    full.read());
+#endif
       // Full update
       if (deq.rdy.read()) {
         full.write(false);
@@ -300,14 +779,13 @@ class Bypass : public sc_module {
 #endif
 };
  
-// Because of ports not existing in TLM_PORT and the code depending on it,
-// we remap to DIRECT_PORT here.
+// TLM_PORT view with pooled storage, see TlmChannel
 template <typename Message>
-class Bypass<Message, TLM_PORT> : public Bypass<Message, DIRECT_PORT>
+class Bypass<Message, TLM_PORT> : public TlmChannel<Message, 1, true, false>
 {
  public:
- Bypass() : Bypass<Message, DIRECT_PORT>() {}
- Bypass(sc_module_name name) : Bypass<Message, DIRECT_PORT>(name) {}
+ Bypass() : TlmChannel<Message, 1, true, false>(sc_gen_unique_name("byp")) {}
+ Bypass(sc_module_name name) : TlmChannel<Message, 1, true, false>(name) {}
 };
  
 //------------------------------------------------------------------------
@@ -346,13 +824,25 @@ class Pipeline : public sc_module {
   sc_signal<Bit> full;
   StateSignal<Message, port_marshall_type> state;
 
+#ifndef __SYNTHESIS__
+  ChannelProbe probe_;
+#endif
+
   // Helper functions
   void Init() {
+#ifndef __SYNTHESIS__
+    probe_.Init(name(), 1, Wrapped<Message>::width);
+    NVHLS_MEMORY("Connections::Pipeline", sizeof(*this));
+#endif
 #ifdef CONNECTIONS_SIM_ONLY
     enq.disable_spawn();
     deq.disable_spawn();
 #endif
     
+#ifdef CONNECTIONS_SIM_ONLY
+    SC_METHOD(Comb);
+    sensitive << full << deq.rdy << enq.val << state.msg;
+#else
     SC_METHOD(EnqRdy);
     sensitive << full << deq.rdy;
 
@@ -364,6 +854,7 @@ class Pipeline : public sc_module {
 
     SC_METHOD(DeqMsg);
     sensitive << state.msg;
+#endif
 
     SC_THREAD(Seq);
     sensitive << clk.pos();
@@ -372,6 +863,15 @@ class Pipeline : public sc_module {
 
   // Combinational logic
 
+#ifdef CONNECTIONS_SIM_ONLY
+  void Comb() {
+    EnqRdy();
+    DeqVal();
+    WriteEn();
+    DeqMsg();
+  }
+#endif
+
   // Internal state write enable: incoming msg is valid and (internal state is
   // not set or outgoing channel is ready.
   void WriteEn() {
@@ -397,6 +897,12 @@ class Pipeline : public sc_module {
     wait();
 
     while (1) {
+#ifndef __SYNTHESIS__
+      if (probe_.Dumping())
+        probe_.DumpMsg(deq.msg.read());
+      probe_.Sample(enq.val.read(), enq.rdy.read(), deq.val.read(), deq.rdy.read(),
+                    full.read());
+#endif
       // Full update
       if (full.read() && deq.rdy.read() && !enq.val.read()) {
         full.write(false);
@@ -439,30 +945,28 @@ class Pipeline : public sc_module {
 #endif
 };
 
-// Because of ports not existing in TLM_PORT and the code depending on it,
-// we remap to DIRECT_PORT here.
+// TLM_PORT view with pooled storage, see TlmChannel
 template <typename Message>
-class Pipeline<Message, TLM_PORT> : public Pipeline<Message, DIRECT_PORT>
+class Pipeline<Message, TLM_PORT> : public TlmChannel<Message, 1, false, true>
 {
  public:
- Pipeline() : Pipeline<Message, DIRECT_PORT>() {}
- Pipeline(sc_module_name name) : Pipeline<Message, DIRECT_PORT>(name) {}
+ Pipeline() : TlmChannel<Message, 1, false, true>(sc_gen_unique_name("byp")) {}
+ Pipeline(sc_module_name name) : TlmChannel<Message, 1, false, true>(name) {}
 };
 
- 
-//
-// NEW FEATURE: Buffered Bypass Channel.
-// This is a BypassBuffered channel that can have depth > 1.
-// W.r.t the Bypass it takes one more template parameter.
-// TODO: It may also work with depth = 1, but it hasn't been tested.
-
 //------------------------------------------------------------------------
-// BypassBuffered
+// SkidBuffer
 //------------------------------------------------------------------------
 
-template <typename Message, unsigned int NumEntries, connections_port_t port_marshall_type = AUTO_PORT>
-class BypassBuffered : public sc_module {
-  SC_HAS_PROCESS(BypassBuffered);
+// Two-entry pipeline stage whose enq.rdy comes straight from a register.
+// Pipeline computes enq.rdy from deq.rdy, so a chain of Pipelines forms one
+// combinational ready path. SkidBuffer breaks that path: when deq stalls,
+// the message accepted on that cycle is parked in a skid register, so enq
+// can be made ready one cycle ahead without losing data. With deq.rdy held
+// high it sustains one message per cycle, like Pipeline.
+template <typename Message, connections_port_t port_marshall_type = AUTO_PORT>
+class SkidBuffer : public sc_module {
+  SC_HAS_PROCESS(SkidBuffer);
 
  public:
   // Interface
@@ -471,108 +975,306 @@ class BypassBuffered : public sc_module {
   In<Message, port_marshall_type> enq;
   Out<Message, port_marshall_type> deq;
 
-  BypassBuffered()
-      : sc_module(sc_module_name(sc_gen_unique_name("byp"))),
+  SkidBuffer()
+      : sc_module(sc_module_name(sc_gen_unique_name("skid"))),
         clk("clk"),
         rst("rst") {
     Init();
   }
 
-  BypassBuffered(sc_module_name name) : sc_module(name), clk("clk"), rst("rst") {
+  SkidBuffer(sc_module_name name) : sc_module(name), clk("clk"), rst("rst") {
     Init();
   }
 
  protected:
   typedef bool Bit;
-  static const int AddrWidth = nvhls::nbits<NumEntries - 1>::val;
-  typedef NVUINTW(AddrWidth) BuffIdx;
-
-  // Internal wires
-  sc_signal<Bit> full_next;
-  sc_signal<BuffIdx> head_next;
-  sc_signal<BuffIdx> tail_next;
 
   // Internal state
   sc_signal<Bit> full;
-  sc_signal<BuffIdx> head;
-  sc_signal<BuffIdx> tail;
-  StateSignal<Message, port_marshall_type> buffer[NumEntries];
+  sc_signal<Bit> skid_full;
+  StateSignal<Message, port_marshall_type> state;
+  StateSignal<Message, port_marshall_type> skid;
+
+#ifndef __SYNTHESIS__
+  ChannelProbe probe_;
+#endif
 
   // Helper functions
   void Init() {
+#ifndef __SYNTHESIS__
+    probe_.Init(name(), 2, Wrapped<Message>::width);
+    NVHLS_MEMORY("Connections::SkidBuffer", sizeof(*this));
+#endif
 #ifdef CONNECTIONS_SIM_ONLY
     enq.disable_spawn();
     deq.disable_spawn();
 #endif
-    
+
+#ifdef CONNECTIONS_SIM_ONLY
+    SC_METHOD(Comb);
+    sensitive << skid_full << full << state.msg;
+#else
     SC_METHOD(EnqRdy);
-    sensitive << full;
+    sensitive << skid_full;
 
     SC_METHOD(DeqVal);
-    sensitive << full << head << tail << enq.val;
+    sensitive << full;
 
     SC_METHOD(DeqMsg);
-#ifndef __SYNTHESIS__
-    sensitive << deq.rdy << full << head << tail << enq.val << enq.msg;
-#else
-    sensitive << full << head << tail << enq.msg;
+    sensitive << state.msg;
 #endif
 
-    SC_METHOD(HeadNext);
-    sensitive << enq.val << full << head << tail << deq.rdy;
-
-    SC_METHOD(TailNext);
-    sensitive << deq.rdy << full << head << tail;
-
-    SC_METHOD(FullNext);
-    sensitive << enq.val << deq.rdy << full << head << tail;
-
     SC_THREAD(Seq);
     sensitive << clk.pos();
     NVHLS_NEG_RESET_SIGNAL_IS(rst);
-
-    // Needed so that DeqMsg always has a good tail value
-    tail.write(0);
   }
 
   // Combinational logic
 
-  // Enqueue ready
-  void EnqRdy() { enq.rdy.write(!full.read()); }
-
-  // Dequeue valid
-  void DeqVal() {
-    bool empty = (!full.read() && (head.read() == tail.read()));
-    deq.val.write(!empty || enq.val.read());
+#ifdef CONNECTIONS_SIM_ONLY
+  void Comb() {
+    EnqRdy();
+    DeqVal();
+    DeqMsg();
   }
+#endif
 
-  // Dequeue messsage
-  void DeqMsg() {
-    bool empty = (!full.read() && (head.read() == tail.read()));
+  // Enqueue ready if the skid register is free. This only depends on state.
+  void EnqRdy() { enq.rdy.write(!skid_full.read()); }
+
+  // Dequeue valid if the main register is set.
+  void DeqVal() { deq.val.write(full.read()); }
+
+  // Dequeue Msg is from the main register.
+  void DeqMsg() { deq.msg.write(state.msg.read()); }
+
+  // Sequential logic
+  void Seq() {
+    // Reset state
+    full.write(0);
+    skid_full.write(0);
+    state.reset_state();
+    skid.reset_state();
+
+    wait();
+
+    while (1) {
 #ifndef __SYNTHESIS__
-    bool do_deq = !empty || enq.val.read();
-    if (do_deq) {
+      if (probe_.Dumping())
+        probe_.DumpMsg(deq.msg.read());
+      probe_.Sample(enq.val.read(), enq.rdy.read(), deq.val.read(), deq.rdy.read(),
+                    full.read() + skid_full.read());
 #endif
-      if (!empty) {
-	deq.msg.write(buffer[tail.read()].msg.read());
-      } else {
-	deq.msg.write(enq.msg.read());
+      bool deq_fire = full.read() && deq.rdy.read();
+      bool enq_fire = enq.val.read() && !skid_full.read();
+
+      if (skid_full.read()) {
+        // Drain the skid register into the main register.
+        if (deq_fire) {
+          state.msg.write(skid.msg.read());
+          skid_full.write(false);
+        }
+      } else if (enq_fire) {
+        if (!full.read() || deq_fire) {
+          // Main register is free or being emptied: move into it.
+          state.msg.write(enq.msg.read());
+          full.write(true);
+        } else {
+          // Output stalled: park the message in the skid register.
+          skid.msg.write(enq.msg.read());
+          skid_full.write(true);
+        }
+      } else if (deq_fire) {
+        full.write(false);
       }
-#ifndef __SYNTHESIS__
-    } else {
-      deq.msg.write(0);
+      wait();
     }
-#endif
   }
 
-  // Head next calculations
-  void HeadNext() {
-    bool empty = (!full.read() && (head.read() == tail.read()));
-    bool do_enq = (enq.val.read() && !full.read() &&
-		   !(empty && deq.rdy.read()));
-    BuffIdx head_inc;
-    if ((head.read() + 1) == NumEntries)
-      head_inc = 0;
+#ifndef __SYNTHESIS__
+ public:
+  void line_trace() {
+    if (rst.read()) {
+      unsigned int width = (Message().length() / 4);
+      // Enqueue port
+      if (enq.val.read() && enq.rdy.read()) {
+        std::cout << std::hex << std::setw(width) << enq.msg.read();
+      } else {
+        std::cout << std::setw(width + 1) << " ";
+      }
+
+      std::cout << " ( " << full.read() << skid_full.read() << " ) ";
+
+      // Dequeue port
+      if (deq.val.read() && deq.rdy.read()) {
+        std::cout << std::hex << std::setw(width) << deq.msg.read();
+      } else {
+        std::cout << std::setw(width + 1) << " ";
+      }
+      std::cout << " | ";
+    }
+  }
+#endif
+};
+
+// Because of ports not existing in TLM_PORT and the code depending on it,
+// we remap to DIRECT_PORT here.
+template <typename Message>
+class SkidBuffer<Message, TLM_PORT> : public SkidBuffer<Message, DIRECT_PORT>
+{
+ public:
+ SkidBuffer() : SkidBuffer<Message, DIRECT_PORT>() {}
+ SkidBuffer(sc_module_name name) : SkidBuffer<Message, DIRECT_PORT>(name) {}
+};
+
+ 
+//
+// NEW FEATURE: Buffered Bypass Channel.
+// This is a BypassBuffered channel that can have depth > 1.
+// W.r.t the Bypass it takes one more template parameter.
+// TODO: It may also work with depth = 1, but it hasn't been tested.
+
+//------------------------------------------------------------------------
+// BypassBuffered
+//------------------------------------------------------------------------
+
+template <typename Message, unsigned int NumEntries, connections_port_t port_marshall_type = AUTO_PORT>
+class BypassBuffered : public sc_module {
+  SC_HAS_PROCESS(BypassBuffered);
+
+ public:
+  // Interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  In<Message, port_marshall_type> enq;
+  Out<Message, port_marshall_type> deq;
+
+  BypassBuffered()
+      : sc_module(sc_module_name(sc_gen_unique_name("byp"))),
+        clk("clk"),
+        rst("rst") {
+    Init();
+  }
+
+  BypassBuffered(sc_module_name name) : sc_module(name), clk("clk"), rst("rst") {
+    Init();
+  }
+
+ protected:
+  typedef bool Bit;
+  static const int AddrWidth = nvhls::nbits<NumEntries - 1>::val;
+  typedef NVUINTW(AddrWidth) BuffIdx;
+
+  // Internal wires
+  sc_signal<Bit> full_next;
+  sc_signal<BuffIdx> head_next;
+  sc_signal<BuffIdx> tail_next;
+
+  // Internal state
+  sc_signal<Bit> full;
+  sc_signal<BuffIdx> head;
+  sc_signal<BuffIdx> tail;
+  StateSignal<Message, port_marshall_type> buffer[NumEntries];
+
+#ifndef __SYNTHESIS__
+  ChannelProbe probe_;
+#endif
+
+  // Helper functions
+  void Init() {
+#ifndef __SYNTHESIS__
+    probe_.Init(name(), NumEntries, Wrapped<Message>::width);
+    NVHLS_MEMORY("Connections::BypassBuffered", sizeof(*this));
+#endif
+#ifdef CONNECTIONS_SIM_ONLY
+    enq.disable_spawn();
+    deq.disable_spawn();
+#endif
+    
+#ifdef CONNECTIONS_SIM_ONLY
+    SC_METHOD(Comb);
+    sensitive << full << head << tail << enq.val << deq.rdy << enq.msg;
+#else
+    SC_METHOD(EnqRdy);
+    sensitive << full;
+
+    SC_METHOD(DeqVal);
+    sensitive << full << head << tail << enq.val;
+
+    SC_METHOD(DeqMsg);
+#ifndef __SYNTHESIS__
+    sensitive << deq.rdy << full << head << tail << enq.val << enq.msg;
+#else
+    sensitive << full << head << tail << enq.msg;
+#endif
+
+    SC_METHOD(HeadNext);
+    sensitive << enq.val << full << head << tail << deq.rdy;
+
+    SC_METHOD(TailNext);
+    sensitive << deq.rdy << full << head << tail;
+
+    SC_METHOD(FullNext);
+    sensitive << enq.val << deq.rdy << full << head << tail;
+#endif
+
+    SC_THREAD(Seq);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    // Needed so that DeqMsg always has a good tail value
+    tail.write(0);
+  }
+
+  // Combinational logic
+
+#ifdef CONNECTIONS_SIM_ONLY
+  void Comb() {
+    EnqRdy();
+    DeqVal();
+    DeqMsg();
+    HeadNext();
+    TailNext();
+    FullNext();
+  }
+#endif
+
+  // Enqueue ready
+  void EnqRdy() { enq.rdy.write(!full.read()); }
+
+  // Dequeue valid
+  void DeqVal() {
+    bool empty = (!full.read() && (head.read() == tail.read()));
+    deq.val.write(!empty || enq.val.read());
+  }
+
+  // Dequeue messsage
+  void DeqMsg() {
+    bool empty = (!full.read() && (head.read() == tail.read()));
+#ifndef __SYNTHESIS__
+    bool do_deq = !empty || enq.val.read();
+    if (do_deq) {
+#endif
+      if (!empty) {
+	deq.msg.write(buffer[tail.read()].msg.read());
+      } else {
+	deq.msg.write(enq.msg.read());
+      }
+#ifndef __SYNTHESIS__
+    } else {
+      deq.msg.write(0);
+    }
+#endif
+  }
+
+  // Head next calculations
+  void HeadNext() {
+    bool empty = (!full.read() && (head.read() == tail.read()));
+    bool do_enq = (enq.val.read() && !full.read() &&
+		   !(empty && deq.rdy.read()));
+    BuffIdx head_inc;
+    if ((head.read() + 1) == NumEntries)
+      head_inc = 0;
     else
       head_inc = head.read() + 1;
 
@@ -632,6 +1334,14 @@ class BypassBuffered : public sc_module {
     wait();
 
     while (1) {
+#ifndef __SYNTHESIS__
+      unsigned int occupancy =
+          (head.read().to_uint() + NumEntries - tail.read().to_uint()) % NumEntries;
+      if (probe_.Dumping())
+        probe_.DumpMsg(deq.msg.read());
+      probe_.Sample(enq.val.read(), enq.rdy.read(), deq.val.read(), deq.rdy.read(),
+                    full.read() ? NumEntries : occupancy);
+#endif
 
       // Head update
       head.write(head_next);
@@ -680,14 +1390,13 @@ class BypassBuffered : public sc_module {
 #endif
 };
 
-// Because of ports not existing in TLM_PORT and the code depending on it,
-// we remap to DIRECT_PORT here.
+// TLM_PORT view with pooled storage, see TlmChannel
 template <typename Message, unsigned int NumEntries>
-class BypassBuffered<Message, NumEntries, TLM_PORT> : public BypassBuffered<Message, NumEntries, DIRECT_PORT>
+class BypassBuffered<Message, NumEntries, TLM_PORT> : public TlmChannel<Message, NumEntries, true, false>
 {
  public:
- BypassBuffered() : BypassBuffered<Message, NumEntries, DIRECT_PORT>() {}
- BypassBuffered(sc_module_name name) : BypassBuffered<Message, NumEntries, DIRECT_PORT>(name) {}
+ BypassBuffered() : TlmChannel<Message, NumEntries, true, false>(sc_gen_unique_name("byp")) {}
+ BypassBuffered(sc_module_name name) : TlmChannel<Message, NumEntries, true, false>(name) {}
 };
 
  
@@ -733,13 +1442,25 @@ class Buffer : public sc_module {
   sc_signal<BuffIdx> tail;
   StateSignal<Message, port_marshall_type> buffer[NumEntries];
 
+#ifndef __SYNTHESIS__
+  ChannelProbe probe_;
+#endif
+
   // Helper functions
   void Init() {
+#ifndef __SYNTHESIS__
+    probe_.Init(name(), NumEntries, Wrapped<Message>::width);
+    NVHLS_MEMORY("Connections::Buffer", sizeof(*this));
+#endif
 #ifdef CONNECTIONS_SIM_ONLY
     enq.disable_spawn();
     deq.disable_spawn();
 #endif
     
+#ifdef CONNECTIONS_SIM_ONLY
+    SC_METHOD(Comb);
+    sensitive << full << head << tail << deq.rdy << enq.val;
+#else
     SC_METHOD(EnqRdy);
     sensitive << full;
 
@@ -761,6 +1482,7 @@ class Buffer : public sc_module {
 
     SC_METHOD(FullNext);
     sensitive << enq.val << deq.rdy << full << head << tail;
+#endif
 
     SC_THREAD(Seq);
     sensitive << clk.pos();
@@ -772,6 +1494,17 @@ class Buffer : public sc_module {
 
   // Combinational logic
 
+#ifdef CONNECTIONS_SIM_ONLY
+  void Comb() {
+    EnqRdy();
+    DeqVal();
+    DeqMsg();
+    HeadNext();
+    TailNext();
+    FullNext();
+  }
+#endif
+
   // Enqueue ready
   void EnqRdy() { enq.rdy.write(!full.read()); }
 
@@ -860,6 +1593,14 @@ class Buffer : public sc_module {
     wait();
 
     while (1) {
+#ifndef __SYNTHESIS__
+      unsigned int occupancy =
+          (head.read().to_uint() + NumEntries - tail.read().to_uint()) % NumEntries;
+      if (probe_.Dumping())
+        probe_.DumpMsg(deq.msg.read());
+      probe_.Sample(enq.val.read(), enq.rdy.read(), deq.val.read(), deq.rdy.read(),
+                    full.read() ? NumEntries : occupancy);
+#endif
       // Head update
       head.write(head_next);
 
@@ -904,14 +1645,539 @@ class Buffer : public sc_module {
 #endif
 };
 
-// Because of ports not existing in TLM_PORT and the code depending on it,
-// we remap to DIRECT_PORT here.
+// TLM_PORT view with pooled storage, see TlmChannel
 template <typename Message, unsigned int NumEntries>
-class Buffer<Message, NumEntries, TLM_PORT> : public Buffer<Message, NumEntries, DIRECT_PORT>
+class Buffer<Message, NumEntries, TLM_PORT> : public TlmChannel<Message, NumEntries, false, false>
 {
  public:
- Buffer() : Buffer<Message, NumEntries, DIRECT_PORT>() {}
- Buffer(sc_module_name name) : Buffer<Message, NumEntries, DIRECT_PORT>(name) {}
+ Buffer() : TlmChannel<Message, NumEntries, false, false>(sc_gen_unique_name("buffer")) {}
+ Buffer(sc_module_name name) : TlmChannel<Message, NumEntries, false, false>(name) {}
+};
+
+//------------------------------------------------------------------------
+// WideBuffer
+//------------------------------------------------------------------------
+
+/**
+ * \brief Buffer channel that enqueues up to NumEnq and dequeues up to NumDeq messages per cycle
+ * \ingroup Connections
+ *
+ * \tparam Message          Message type
+ * \tparam NumEntries       Number of buffer entries, at least max(NumEnq, NumDeq)
+ * \tparam NumEnq           Number of enq ports
+ * \tparam NumDeq           Number of deq ports
+ *
+ * \par Overview
+ * - enq[i].rdy is set when at least i + 1 entries are free and only depends on the occupancy, so it is registered. All enq ports with val and rdy set are accepted in a cycle, lower ports first; a producer with k messages uses enq[0..k-1].
+ * - deq[j].val is set when the buffer holds more than j messages, and deq[j] carries the j-th oldest message. A consumer takes messages in order, i.e. deq[j].rdy may only be set if deq[0..j-1].rdy are set.
+ * - Messages leave in the order they were accepted. An enqueued message can be dequeued in the next cycle.
+ * - In C++ simulation (CONNECTIONS_SIM_ONLY) the ports do not spawn their own processes and line_trace() prints the accepted and dequeued messages and the occupancy. With TLM_PORT the channel is a thread that moves messages with PopNB/PushNB.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_connections.h>
+ *
+ *      ...
+ *      Connections::WideBuffer<Flit, 8, 4, 2> buf;  // 4 messages in, 2 out per cycle
+ *      Connections::Combinational<Flit> enq_chan[4], deq_chan[2];
+ *      ...
+ *      for (unsigned i = 0; i < 4; i++) buf.enq[i](enq_chan[i]);
+ *      for (unsigned j = 0; j < 2; j++) buf.deq[j](deq_chan[j]);
+ *      ...
+ * \endcode
+ * \par
+ *
+ */
+template <typename Message, unsigned int NumEntries, unsigned int NumEnq, unsigned int NumDeq,
+          connections_port_t port_marshall_type = AUTO_PORT>
+class WideBuffer : public sc_module {
+  SC_HAS_PROCESS(WideBuffer);
+
+ public:
+  // Interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  In<Message, port_marshall_type> enq[NumEnq];
+  Out<Message, port_marshall_type> deq[NumDeq];
+
+  WideBuffer()
+      : sc_module(sc_module_name(sc_gen_unique_name("wide_buffer"))),
+        clk("clk"),
+        rst("rst") {
+    Init();
+  }
+
+  WideBuffer(sc_module_name name) : sc_module(name), clk("clk"), rst("rst") {
+    Init();
+  }
+
+ protected:
+  static_assert(NumEntries >= NumEnq && NumEntries >= NumDeq,
+                "WideBuffer needs at least max(NumEnq, NumDeq) entries");
+  static const int AddrWidth = nvhls::index_width<NumEntries>::val;
+  static const int CountWidth = nvhls::index_width<NumEntries + 1>::val;
+  typedef NVUINTW(AddrWidth) BuffIdx;
+  typedef NVUINTW(CountWidth) BuffCount;
+
+  // Internal state
+  sc_signal<BuffIdx> head;
+  sc_signal<BuffIdx> tail;
+  sc_signal<BuffCount> count;
+  StateSignal<Message, port_marshall_type> buffer[NumEntries];
+
+  // Helper functions
+  void Init() {
+    NVHLS_MEMORY("Connections::WideBuffer", sizeof(*this));
+#ifdef CONNECTIONS_SIM_ONLY
+    for (unsigned int i = 0; i < NumEnq; ++i)
+      enq[i].disable_spawn();
+    for (unsigned int j = 0; j < NumDeq; ++j)
+      deq[j].disable_spawn();
+#endif
+
+#ifdef CONNECTIONS_SIM_ONLY
+    SC_METHOD(Comb);
+    sensitive << count << tail;
+#else
+    SC_METHOD(EnqRdy);
+    sensitive << count;
+
+    SC_METHOD(DeqVal);
+    sensitive << count;
+
+    SC_METHOD(DeqMsg);
+    sensitive << count << tail;
+#endif
+
+    SC_THREAD(Seq);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    // Needed so that DeqMsg always has a good tail value
+    tail.write(0);
+  }
+
+  static BuffIdx Wrap(unsigned int idx) {
+    return (idx >= NumEntries) ? BuffIdx(idx - NumEntries) : BuffIdx(idx);
+  }
+
+  // Combinational logic
+
+#ifdef CONNECTIONS_SIM_ONLY
+  void Comb() {
+    EnqRdy();
+    DeqVal();
+    DeqMsg();
+  }
+#endif
+
+  // Enqueue ready: enq[i] needs i + 1 free entries
+  void EnqRdy() {
+    unsigned int num_free = NumEntries - count.read();
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumEnq; ++i)
+      enq[i].rdy.write(num_free > i);
+  }
+
+  // Dequeue valid
+  void DeqVal() {
+#pragma hls_unroll yes
+    for (unsigned int j = 0; j < NumDeq; ++j)
+      deq[j].val.write(count.read() > j);
+  }
+
+  // Dequeue messages: the j-th oldest entry
+  void DeqMsg() {
+#pragma hls_unroll yes
+    for (unsigned int j = 0; j < NumDeq; ++j) {
+#ifndef __SYNTHESIS__
+      if (count.read() > j) {
+#endif
+        deq[j].msg.write(buffer[Wrap(tail.read() + j)].msg.read());
+#ifndef __SYNTHESIS__
+      } else {
+        deq[j].msg.write(0);
+      }
+#endif
+    }
+  }
+
+  // Sequential logic
+  void Seq() {
+    // Reset state
+    head.write(0);
+    tail.write(0);
+    count.write(0);
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumEntries; ++i)
+      buffer[i].reset_state();
+
+    wait();
+
+    while (1) {
+      unsigned int num_free = NumEntries - count.read();
+
+      // Enqueue messages, packed in port order
+      unsigned int num_enq = 0;
+#pragma hls_unroll yes
+      for (unsigned int i = 0; i < NumEnq; ++i) {
+        if (enq[i].val.read() && (num_free > i)) {
+          buffer[Wrap(head.read() + num_enq)].msg.write(enq[i].msg.read());
+          num_enq++;
+        }
+      }
+
+      // Dequeue the leading messages taken by the consumer
+      unsigned int num_deq = 0;
+      bool in_order = true;
+#pragma hls_unroll yes
+      for (unsigned int j = 0; j < NumDeq; ++j) {
+        if (deq[j].rdy.read() && (count.read() > j)) {
+          NVHLS_ASSERT_MSG(in_order, "WideBuffer deq ports must be taken in order");
+          num_deq++;
+        } else {
+          in_order = false;
+        }
+      }
+
+      head.write(Wrap(head.read() + num_enq));
+      tail.write(Wrap(tail.read() + num_deq));
+      count.write(count.read() + num_enq - num_deq);
+
+      wait();
+    }
+  }
+
+#ifndef __SYNTHESIS__
+ public:
+  void line_trace() {
+    if (rst.read()) {
+      unsigned int width = (Message().length() / 4);
+      // Enqueue ports
+      for (unsigned int i = 0; i < NumEnq; ++i) {
+        if (enq[i].val.read() && enq[i].rdy.read()) {
+          std::cout << std::hex << std::setw(width) << enq[i].msg.read() << " ";
+        } else {
+          std::cout << std::setw(width + 1) << " ";
+        }
+      }
+
+      std::cout << " ( " << std::dec << count.read() << " ) ";
+
+      // Dequeue ports
+      for (unsigned int j = 0; j < NumDeq; ++j) {
+        if (deq[j].val.read() && deq[j].rdy.read()) {
+          std::cout << std::hex << std::setw(width) << deq[j].msg.read() << " ";
+        } else {
+          std::cout << std::setw(width + 1) << " ";
+        }
+      }
+      std::cout << " | ";
+    }
+  }
+#endif
+};
+
+// Fast simulation model: TLM ports have no val/rdy signals, so the channel
+// is a thread that accepts messages while entries are free and sends the
+// oldest ones until a deq port refuses. Same throughput and ordering as the
+// signal-level channel.
+template <typename Message, unsigned int NumEntries, unsigned int NumEnq, unsigned int NumDeq>
+class WideBuffer<Message, NumEntries, NumEnq, NumDeq, TLM_PORT> : public sc_module {
+  SC_HAS_PROCESS(WideBuffer);
+
+ public:
+  // Interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  In<Message, TLM_PORT> enq[NumEnq];
+  Out<Message, TLM_PORT> deq[NumDeq];
+
+  WideBuffer()
+      : sc_module(sc_module_name(sc_gen_unique_name("wide_buffer"))),
+        clk("clk"),
+        rst("rst") {
+    Init();
+  }
+
+  WideBuffer(sc_module_name name) : sc_module(name), clk("clk"), rst("rst") {
+    Init();
+  }
+
+ protected:
+  Message buffer[NumEntries];
+  unsigned int head;
+  unsigned int count;
+
+  void Init() {
+    NVHLS_MEMORY("Connections::WideBuffer", sizeof(*this));
+    SC_THREAD(Seq);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void Seq() {
+    for (unsigned int i = 0; i < NumEnq; ++i)
+      enq[i].Reset();
+    for (unsigned int j = 0; j < NumDeq; ++j)
+      deq[j].Reset();
+    head = 0;
+    count = 0;
+
+    wait();
+
+    while (1) {
+      // Messages enqueued in this cycle are dequeued from the next one
+      unsigned int old_count = count;
+      unsigned int num_deq = 0;
+      for (unsigned int j = 0; (j < NumDeq) && (j < old_count); ++j) {
+        if (!deq[j].PushNB(buffer[(head + NumEntries - count + j) % NumEntries], false))
+          break;
+        num_deq++;
+      }
+      unsigned int num_free = NumEntries - old_count;
+      for (unsigned int i = 0; (i < NumEnq) && (i < num_free); ++i) {
+        Message msg;
+        if (enq[i].PopNB(msg, false)) {
+          buffer[head] = msg;
+          head = (head + 1) % NumEntries;
+          count++;
+        }
+      }
+      count -= num_deq;
+      wait();
+    }
+  }
+
+ public:
+  void line_trace() { std::cout << " ( " << std::dec << count << " ) | "; }
+};
+
+//------------------------------------------------------------------------
+// AsyncFifo
+//------------------------------------------------------------------------
+
+/**
+ * \brief Dual-clock FIFO channel with gray-code pointers for clock domain crossings
+ * \ingroup Connections
+ *
+ * \tparam Message          Message type
+ * \tparam NumEntries       Number of FIFO entries, a power of two and at least 2
+ * \tparam SyncStages       Number of synchronizer flops for each pointer crossing (default: 2)
+ *
+ * \par Overview
+ * - enq is clocked by enq_clk/enq_rst and deq by deq_clk/deq_rst. Each side keeps a binary pointer with one wrap bit and publishes its gray-coded version. The other side samples it through SyncStages registers.
+ * - enq.rdy is a registered "not full" and deq.val a registered "not empty". Both compare the local gray pointer with the synchronized remote one, so they are conservative: a pop is seen by the enq side, and a push by the deq side, after SyncStages + 1 edges of the receiving clock.
+ * - The storage is written on enq_clk and read combinationally on the deq side, like a flop array in RTL. Messages only become visible through the synchronized pointer, so an entry is never read while it is written.
+ * - The SystemC model is cycle-accurate on both clocks. Metastability is not modeled. With the default two sync stages, a FIFO needs about 2 * (SyncStages + 1) entries to sustain one message per cycle of the slower clock.
+ * - TLM_PORT is remapped to DIRECT_PORT.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_connections.h>
+ *
+ *      ...
+ *      Connections::AsyncFifo<Flit, 8> cdc;  // 8 entries, 2 sync stages
+ *      ...
+ *      cdc.enq_clk(noc_clk);
+ *      cdc.enq_rst(noc_rst);
+ *      cdc.deq_clk(tile_clk);
+ *      cdc.deq_rst(tile_rst);
+ *      cdc.enq(noc_to_cdc);
+ *      cdc.deq(cdc_to_tile);
+ *      ...
+ * \endcode
+ * \par
+ *
+ */
+template <typename Message, unsigned int NumEntries, unsigned int SyncStages = 2,
+          connections_port_t port_marshall_type = AUTO_PORT>
+class AsyncFifo : public sc_module {
+  SC_HAS_PROCESS(AsyncFifo);
+
+ public:
+  // Interface
+  sc_in_clk enq_clk;
+  sc_in<bool> enq_rst;
+  sc_in_clk deq_clk;
+  sc_in<bool> deq_rst;
+  In<Message, port_marshall_type> enq;
+  Out<Message, port_marshall_type> deq;
+
+  AsyncFifo()
+      : sc_module(sc_module_name(sc_gen_unique_name("async_fifo"))),
+        enq_clk("enq_clk"),
+        enq_rst("enq_rst"),
+        deq_clk("deq_clk"),
+        deq_rst("deq_rst") {
+    Init();
+  }
+
+  AsyncFifo(sc_module_name name)
+      : sc_module(name),
+        enq_clk("enq_clk"),
+        enq_rst("enq_rst"),
+        deq_clk("deq_clk"),
+        deq_rst("deq_rst") {
+    Init();
+  }
+
+ protected:
+  static_assert(NumEntries >= 2 && (NumEntries & (NumEntries - 1)) == 0,
+                "AsyncFifo needs a power-of-two number of entries");
+  static_assert(SyncStages >= 1, "AsyncFifo needs at least one sync stage");
+  static const int AddrWidth = nvhls::index_width<NumEntries>::val;
+  static const int PtrWidth = AddrWidth + 1;
+  typedef NVUINTW(AddrWidth) BuffIdx;
+  typedef NVUINTW(PtrWidth) Ptr;
+  typedef bool Bit;
+
+  // Internal state, enq_clk domain
+  sc_signal<Ptr> wptr_gray;
+  sc_signal<Bit> full;
+  StateSignal<Message, port_marshall_type> buffer[NumEntries];
+
+  // Internal state, deq_clk domain
+  sc_signal<Ptr> rptr_gray;
+  sc_signal<BuffIdx> raddr;
+  sc_signal<Bit> empty;
+
+  // Helper functions
+  void Init() {
+    NVHLS_MEMORY("Connections::AsyncFifo", sizeof(*this));
+#ifdef CONNECTIONS_SIM_ONLY
+    enq.disable_spawn();
+    deq.disable_spawn();
+#endif
+
+    SC_METHOD(EnqRdy);
+    sensitive << full;
+
+    SC_METHOD(DeqVal);
+    sensitive << empty;
+
+    SC_METHOD(DeqMsg);
+    sensitive << raddr;
+    for (unsigned int i = 0; i < NumEntries; ++i)
+      sensitive << buffer[i].msg;
+
+    SC_THREAD(EnqSeq);
+    sensitive << enq_clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(enq_rst);
+
+    SC_THREAD(DeqSeq);
+    sensitive << deq_clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(deq_rst);
+
+    // Needed so that DeqMsg always has a good address
+    raddr.write(0);
+  }
+
+  static Ptr BinToGray(Ptr bin) { return bin ^ (bin >> 1); }
+
+  // Combinational logic
+
+  // Enqueue ready if not full
+  void EnqRdy() { enq.rdy.write(!full.read()); }
+
+  // Dequeue valid if not empty
+  void DeqVal() { deq.val.write(!empty.read()); }
+
+  // Dequeue Msg is the oldest entry
+  void DeqMsg() { deq.msg.write(buffer[raddr.read()].msg.read()); }
+
+  // Sequential logic, enq_clk domain
+  void EnqSeq() {
+    // Reset state
+    Ptr wptr = 0;
+    Ptr rptr_sync[SyncStages];
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < SyncStages; ++i)
+      rptr_sync[i] = 0;
+    wptr_gray.write(0);
+    full.write(false);
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumEntries; ++i)
+      buffer[i].reset_state();
+
+    wait();
+
+    while (1) {
+      // Write
+      if (enq.val.read() && !full.read()) {
+        BuffIdx waddr = nvhls::get_slc<AddrWidth>(wptr, 0);
+        buffer[waddr].msg.write(enq.msg.read());
+        wptr++;
+      }
+
+      // Synchronize the read pointer
+#pragma hls_unroll yes
+      for (unsigned int i = SyncStages - 1; i > 0; --i)
+        rptr_sync[i] = rptr_sync[i - 1];
+      rptr_sync[0] = rptr_gray.read();
+
+      // Full if the pointers differ only in the two MSBs of the gray code
+      Ptr wgray = BinToGray(wptr);
+      Ptr wrap_mask = Ptr(3) << (PtrWidth - 2);
+      wptr_gray.write(wgray);
+      full.write(wgray == (rptr_sync[SyncStages - 1] ^ wrap_mask));
+      wait();
+    }
+  }
+
+  // Sequential logic, deq_clk domain
+  void DeqSeq() {
+    // Reset state
+    Ptr rptr = 0;
+    Ptr wptr_sync[SyncStages];
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < SyncStages; ++i)
+      wptr_sync[i] = 0;
+    rptr_gray.write(0);
+    raddr.write(0);
+    empty.write(true);
+
+    wait();
+
+    while (1) {
+      // Read
+      if (deq.rdy.read() && !empty.read()) {
+        rptr++;
+      }
+
+      // Synchronize the write pointer
+#pragma hls_unroll yes
+      for (unsigned int i = SyncStages - 1; i > 0; --i)
+        wptr_sync[i] = wptr_sync[i - 1];
+      wptr_sync[0] = wptr_gray.read();
+
+      // Empty if the pointers are equal
+      Ptr rgray = BinToGray(rptr);
+      rptr_gray.write(rgray);
+      raddr.write(nvhls::get_slc<AddrWidth>(rptr, 0));
+      empty.write(rgray == wptr_sync[SyncStages - 1]);
+      wait();
+    }
+  }
+
+#ifndef __SYNTHESIS__
+ public:
+  void line_trace() {
+    std::cout << " ( " << std::hex << wptr_gray.read() << " " << rptr_gray.read()
+              << " " << full.read() << empty.read() << " ) | ";
+  }
+#endif
+};
+
+// Because of ports not existing in TLM_PORT and the code depending on it,
+// we remap to DIRECT_PORT here.
+template <typename Message, unsigned int NumEntries, unsigned int SyncStages>
+class AsyncFifo<Message, NumEntries, SyncStages, TLM_PORT>
+    : public AsyncFifo<Message, NumEntries, SyncStages, DIRECT_PORT> {
+ public:
+  AsyncFifo() : AsyncFifo<Message, NumEntries, SyncStages, DIRECT_PORT>() {}
+  AsyncFifo(sc_module_name name)
+      : AsyncFifo<Message, NumEntries, SyncStages, DIRECT_PORT>(name) {}
 };
 
 //////////////////////////////////////////////////////////////////////////////////
@@ -1130,6 +2396,22 @@ class ChannelBinder {
     in(deq);
   }
 
+ // SkidBuffer binding w/ clk and rst arguments.
+ ChannelBinder(InBlocking<Message>& in,
+	       OutBlocking<Message>& out,
+	       SkidBuffer<Message>& chan,
+	       sc_in_clk& clk, sc_in<bool>& rst)
+   : enq(sc_gen_unique_name("bind_enq")),
+    deq(sc_gen_unique_name("bind_deq")) {
+
+    out(enq);
+    chan.clk(clk);
+    chan.rst(rst);
+    chan.enq(enq);
+    chan.deq(deq);
+    in(deq);
+  }
+
  // Buffer binding w/ clk and rst arguments.
  ChannelBinder(InBlocking<Message>& in,
 	       OutBlocking<Message>& out,
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//========================================================================
+// nvhls_connections_counters.h
+//========================================================================
+
+#ifndef NVHLS_CONNECTIONS_COUNTERS_H_
+#define NVHLS_CONNECTIONS_COUNTERS_H_
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+
+namespace Connections {
+
+//------------------------------------------------------------------------
+// ChannelCounter
+//------------------------------------------------------------------------
+/**
+ * \brief Synthesizable pipeline stage with transfer, stall and idle counters
+ * \ingroup Connections
+ *
+ * \tparam Message      Message type
+ * \tparam CounterWidth Width of each counter
+ *
+ * \par Overview
+ * - Passes messages from enq to deq through one register, like a Pipeline: one message per cycle, one cycle of latency.
+ * - While enable is set, every cycle counts in exactly one of: transfers (the register holds a message and deq takes it), stalls (it holds a message and deq is not ready) and idle (it is empty). These are the deq-side transfer, backpressure and starvation cycles of the simulation-only ChannelProfiler, measured in hardware.
+ * - clear zeroes all three counters; a cycle with clear set is not counted. The counters wrap.
+ * - enable and clear are meant to be driven by a counter bank such as AxiCounterBank, which reads the counters.
+ *
+ */
+template <typename Message, unsigned int CounterWidth = 32>
+class ChannelCounter : public sc_module {
+  SC_HAS_PROCESS(ChannelCounter);
+
+ public:
+  typedef NVUINTW(CounterWidth) Counter;
+
+  // Interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  In<Message> enq;
+  Out<Message> deq;
+  sc_in<bool> enable;
+  sc_in<bool> clear;
+  sc_out<Counter> transfers;
+  sc_out<Counter> stalls;
+  sc_out<Counter> idle;
+
+  ChannelCounter()
+      : sc_module(sc_module_name(sc_gen_unique_name("channel_counter"))),
+        clk("clk"),
+        rst("rst"),
+        enq("enq"),
+        deq("deq"),
+        enable("enable"),
+        clear("clear"),
+        transfers("transfers"),
+        stalls("stalls"),
+        idle("idle") {
+    Init();
+  }
+
+  ChannelCounter(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        rst("rst"),
+        enq("enq"),
+        deq("deq"),
+        enable("enable"),
+        clear("clear"),
+        transfers("transfers"),
+        stalls("stalls"),
+        idle("idle") {
+    Init();
+  }
+
+ protected:
+  void Init() {
+    SC_THREAD(Process);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void Process() {
+    enq.Reset();
+    deq.Reset();
+    Counter transfer_count = 0, stall_count = 0, idle_count = 0;
+    transfers.write(0);
+    stalls.write(0);
+    idle.write(0);
+    Message msg;
+    bool full = false;
+    wait();
+
+#pragma hls_pipeline_init_interval 1
+#pragma pipeline_stall_mode flush
+    while (1) {
+      bool transfer = false, stall = false;
+      if (full) {
+        if (deq.PushNB(msg)) {
+          full = false;
+          transfer = true;
+        } else {
+          stall = true;
+        }
+      }
+      bool count = enable.read() && !clear.read();
+      if (clear.read()) {
+        transfer_count = 0;
+        stall_count = 0;
+        idle_count = 0;
+      } else if (count) {
+        if (transfer)
+          transfer_count++;
+        else if (stall)
+          stall_count++;
+        else
+          idle_count++;
+      }
+      transfers.write(transfer_count);
+      stalls.write(stall_count);
+      idle.write(idle_count);
+      if (!full) {
+        full = enq.PopNB(msg);
+      }
+      wait();
+    }
+  }
+};
+
+//------------------------------------------------------------------------
+// CountedChannel
+//------------------------------------------------------------------------
+/**
+ * \brief A Connections channel followed by a ChannelCounter
+ * \ingroup Connections
+ *
+ * \tparam Message      Message type
+ * \tparam Channel      Channel to count, with clk, rst, enq and deq ports, such as Buffer<Message, 4> or Pipeline<Message>
+ * \tparam CounterWidth Width of each counter
+ *
+ * \par Overview
+ * - Drop-in replacement for Channel with the ChannelCounter counters, enable and clear as extra ports. The counters see the handshake between the ChannelCounter and the consumer, so a stall means the consumer is the bottleneck and idle means the producer is.
+ * - The ChannelCounter adds one register stage: one cycle of latency and one entry of storage.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_connections_counters.h>
+ *
+ *      ...
+ *      Connections::CountedChannel<Msg, Connections::Buffer<Msg, 4> > buffer;
+ *      ...
+ *          buffer.clk(clk);
+ *          buffer.rst(rst);
+ *          buffer.enq(in_chan);
+ *          buffer.deq(out_chan);
+ *          buffer.enable(bank.enable);
+ *          buffer.clear(bank.clear);
+ *          buffer.transfers(bank_transfers[0]);
+ *          buffer.stalls(bank_stalls[0]);
+ *          buffer.idle(bank_idle[0]);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename Message, typename Channel, unsigned int CounterWidth = 32>
+class CountedChannel : public sc_module {
+ public:
+  typedef typename ChannelCounter<Message, CounterWidth>::Counter Counter;
+
+  // Interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  In<Message> enq;
+  Out<Message> deq;
+  sc_in<bool> enable;
+  sc_in<bool> clear;
+  sc_out<Counter> transfers;
+  sc_out<Counter> stalls;
+  sc_out<Counter> idle;
+
+  Channel chan;
+  ChannelCounter<Message, CounterWidth> counter;
+  Combinational<Message> counted;
+
+  CountedChannel()
+      : sc_module(sc_module_name(sc_gen_unique_name("counted_channel"))),
+        clk("clk"),
+        rst("rst"),
+        enq("enq"),
+        deq("deq"),
+        enable("enable"),
+        clear("clear"),
+        transfers("transfers"),
+        stalls("stalls"),
+        idle("idle"),
+        chan("chan"),
+        counter("counter"),
+        counted("counted") {
+    Init();
+  }
+
+  CountedChannel(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        rst("rst"),
+        enq("enq"),
+        deq("deq"),
+        enable("enable"),
+        clear("clear"),
+        transfers("transfers"),
+        stalls("stalls"),
+        idle("idle"),
+        chan("chan"),
+        counter("counter"),
+        counted("counted") {
+    Init();
+  }
+
+ protected:
+  void Init() {
+    chan.clk(clk);
+    chan.rst(rst);
+    chan.enq(enq);
+    chan.deq(counted);
+    counter.clk(clk);
+    counter.rst(rst);
+    counter.enq(counted);
+    counter.deq(deq);
+    counter.enable(enable);
+    counter.clear(clear);
+    counter.transfers(transfers);
+    counter.stalls(stalls);
+    counter.idle(idle);
+  }
+};
+
+}  // namespace Connections
+
+#endif  // NVHLS_CONNECTIONS_COUNTERS_H_
@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+//========================================================================
+// nvhls_connections_credit.h
+//========================================================================
+
+#ifndef NVHLS_CONNECTIONS_CREDIT_H_
+#define NVHLS_CONNECTIONS_CREDIT_H_
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_assert.h>
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <TypeToBits.h>
+#include <fifo.h>
+
+namespace Connections {
+
+//------------------------------------------------------------------------
+// CreditLink
+//------------------------------------------------------------------------
+/**
+ * \brief Wires of a credit-based point-to-point link
+ * \ingroup Connections
+ *
+ * \tparam Message      Message type
+ *
+ * \par Overview
+ * - val and msg carry one message per cycle from OutCredit (or a CreditPipe) towards InCredit; credit carries one credit per cycle back. There is no ready: the sender only sends while it holds a credit.
+ * - Every end of a link drives its outputs from registers, so a link can be cut into register stages (CreditPipe) anywhere without a combinational path between the ends.
+ *
+ */
+template <typename Message>
+class CreditLink : public sc_module {
+ public:
+  typedef sc_lv<Wrapped<Message>::width> MsgBits;
+
+  sc_signal<bool> val;
+  sc_signal<MsgBits> msg;
+  sc_signal<bool> credit;
+
+  CreditLink()
+      : sc_module(sc_module_name(sc_gen_unique_name("credit_link"))),
+        val("val"),
+        msg("msg"),
+        credit("credit") {}
+
+  CreditLink(sc_module_name name)
+      : sc_module(name), val("val"), msg("msg"), credit("credit") {}
+};
+
+//------------------------------------------------------------------------
+// OutCredit
+//------------------------------------------------------------------------
+/**
+ * \brief Sender end of a credit-based point-to-point link
+ * \ingroup Connections
+ *
+ * \tparam Message      Message type
+ * \tparam Credits      Entries of the buffer of the InCredit at the other end
+ *
+ * \par Overview
+ * - Takes one message per cycle from enq and sends it on the link while it holds a credit. It starts with Credits credits, spends one per message and gets one back for every message the InCredit hands on.
+ * - A credit that comes back can be spent in the same cycle. With Stages register stages in each direction of the link (CreditPipe), a credit returns 2 * Stages + 3 cycles after it was spent, so Credits >= 2 * Stages + 3 sustains one message per cycle; with fewer credits the throughput is Credits / (2 * Stages + 3) messages per cycle.
+ * - Unlike a valid/ready channel cut into stages, no end waits for a ready from the other one, so the link needs no skid buffer per stage: the only storage is the Credits entries of the InCredit.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_connections_credit.h>
+ *
+ *      ...
+ *      Connections::OutCredit<Msg, 7> tx;
+ *      Connections::CreditPipe<Msg, 2> pipe;
+ *      Connections::InCredit<Msg, 7> rx;
+ *      Connections::CreditLink<Msg> tx_link, rx_link;
+ *      ...
+ *          tx.enq(in_chan);
+ *          tx.Bind(tx_link);
+ *          pipe.BindIn(tx_link);
+ *          pipe.BindOut(rx_link);
+ *          rx.Bind(rx_link);
+ *          rx.deq(out_chan);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename Message, unsigned int Credits>
+class OutCredit : public sc_module {
+  SC_HAS_PROCESS(OutCredit);
+  static_assert(Credits >= 1, "OutCredit needs at least one credit");
+
+ public:
+  typedef typename CreditLink<Message>::MsgBits MsgBits;
+  typedef NVUINTW(nvhls::nbits<Credits>::val) Credit_t;
+
+  // Interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  In<Message> enq;
+  sc_out<bool> link_val;
+  sc_out<MsgBits> link_msg;
+  sc_in<bool> link_credit;
+
+  OutCredit()
+      : sc_module(sc_module_name(sc_gen_unique_name("out_credit"))),
+        clk("clk"),
+        rst("rst"),
+        enq("enq"),
+        link_val("link_val"),
+        link_msg("link_msg"),
+        link_credit("link_credit") {
+    Init();
+  }
+
+  OutCredit(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        rst("rst"),
+        enq("enq"),
+        link_val("link_val"),
+        link_msg("link_msg"),
+        link_credit("link_credit") {
+    Init();
+  }
+
+  void Bind(CreditLink<Message>& link) {
+    link_val(link.val);
+    link_msg(link.msg);
+    link_credit(link.credit);
+  }
+
+ protected:
+  void Init() {
+    SC_THREAD(Process);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void Process() {
+    enq.Reset();
+    link_val.write(false);
+    link_msg.write(0);
+    Credit_t credits = Credits;
+    wait();
+
+#pragma hls_pipeline_init_interval 1
+#pragma pipeline_stall_mode flush
+    while (1) {
+      Credit_t avail = credits + (link_credit.read() ? 1 : 0);
+      bool send = false;
+      if (avail != 0) {
+        Message msg;
+        if (enq.PopNB(msg)) {
+          link_msg.write(TypeToBits(msg));
+          send = true;
+        }
+      }
+      link_val.write(send);
+      credits = avail - (send ? 1 : 0);
+      wait();
+    }
+  }
+};
+
+//------------------------------------------------------------------------
+// InCredit
+//------------------------------------------------------------------------
+/**
+ * \brief Receiver end of a credit-based point-to-point link
+ * \ingroup Connections
+ *
+ * \tparam Message      Message type
+ * \tparam Credits      Entries of the buffer, the Credits of the OutCredit at the other end
+ *
+ * \par Overview
+ * - Buffers every message from the link in a FIFO of Credits entries and hands them on to deq in order, one per cycle. Every message deq takes returns a credit on the link.
+ * - A message that arrives while the buffer is full means the OutCredit has more credits than this buffer has entries, and asserts.
+ *
+ */
+template <typename Message, unsigned int Credits>
+class InCredit : public sc_module {
+  SC_HAS_PROCESS(InCredit);
+  static_assert(Credits >= 1, "InCredit needs at least one buffer entry");
+
+ public:
+  typedef typename CreditLink<Message>::MsgBits MsgBits;
+
+  // Interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  sc_in<bool> link_val;
+  sc_in<MsgBits> link_msg;
+  sc_out<bool> link_credit;
+  Out<Message> deq;
+
+  InCredit()
+      : sc_module(sc_module_name(sc_gen_unique_name("in_credit"))),
+        clk("clk"),
+        rst("rst"),
+        link_val("link_val"),
+        link_msg("link_msg"),
+        link_credit("link_credit"),
+        deq("deq") {
+    Init();
+  }
+
+  InCredit(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        rst("rst"),
+        link_val("link_val"),
+        link_msg("link_msg"),
+        link_credit("link_credit"),
+        deq("deq") {
+    Init();
+  }
+
+  void Bind(CreditLink<Message>& link) {
+    link_val(link.val);
+    link_msg(link.msg);
+    link_credit(link.credit);
+  }
+
+ protected:
+  void Init() {
+    SC_THREAD(Process);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void Process() {
+    FIFO<Message, Credits> buffer;
+    deq.Reset();
+    link_credit.write(false);
+    buffer.reset();
+    wait();
+
+#pragma hls_pipeline_init_interval 1
+#pragma pipeline_stall_mode flush
+    while (1) {
+      bool credit = false;
+      if (!buffer.isEmpty()) {
+        if (deq.PushNB(buffer.peek())) {
+          buffer.incrHead();
+          credit = true;
+        }
+      }
+      if (link_val.read()) {
+        NVHLS_ASSERT_MSG(!buffer.isFull(), "InCredit_buffer_overflow_more_credits_than_entries");
+        buffer.push(BitsToType<Message>(link_msg.read()));
+      }
+      link_credit.write(credit);
+      wait();
+    }
+  }
+};
+
+//------------------------------------------------------------------------
+// CreditPipe
+//------------------------------------------------------------------------
+/**
+ * \brief Register stages of a credit-based point-to-point link
+ * \ingroup Connections
+ *
+ * \tparam Message      Message type
+ * \tparam Stages       Register stages in each direction (default: 1)
+ *
+ * \par Overview
+ * - Delays val and msg from the OutCredit side to the InCredit side, and credit the other way, by Stages cycles each, e.g. to cross a long distance between blocks. Pipes can be chained; their stages add up.
+ * - Holds no flow control state: a stage takes a message every cycle.
+ *
+ */
+template <typename Message, unsigned int Stages = 1>
+class CreditPipe : public sc_module {
+  SC_HAS_PROCESS(CreditPipe);
+  static_assert(Stages >= 1, "CreditPipe needs at least one stage");
+
+ public:
+  typedef typename CreditLink<Message>::MsgBits MsgBits;
+
+  // Interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  sc_in<bool> in_val;
+  sc_in<MsgBits> in_msg;
+  sc_out<bool> in_credit;
+  sc_out<bool> out_val;
+  sc_out<MsgBits> out_msg;
+  sc_in<bool> out_credit;
+
+  CreditPipe()
+      : sc_module(sc_module_name(sc_gen_unique_name("credit_pipe"))),
+        clk("clk"),
+        rst("rst"),
+        in_val("in_val"),
+        in_msg("in_msg"),
+        in_credit("in_credit"),
+        out_val("out_val"),
+        out_msg("out_msg"),
+        out_credit("out_credit") {
+    Init();
+  }
+
+  CreditPipe(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        rst("rst"),
+        in_val("in_val"),
+        in_msg("in_msg"),
+        in_credit("in_credit"),
+        out_val("out_val"),
+        out_msg("out_msg"),
+        out_credit("out_credit") {
+    Init();
+  }
+
+  // Binds the OutCredit side
+  void BindIn(CreditLink<Message>& link) {
+    in_val(link.val);
+    in_msg(link.msg);
+    in_credit(link.credit);
+  }
+
+  // Binds the InCredit side
+  void BindOut(CreditLink<Message>& link) {
+    out_val(link.val);
+    out_msg(link.msg);
+    out_credit(link.credit);
+  }
+
+ protected:
+  void Init() {
+    SC_THREAD(Process);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void Process() {
+    bool val_reg[Stages];
+    MsgBits msg_reg[Stages];
+    bool credit_reg[Stages];
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < Stages; i++) {
+      val_reg[i] = false;
+      msg_reg[i] = 0;
+      credit_reg[i] = false;
+    }
+    in_credit.write(false);
+    out_val.write(false);
+    out_msg.write(0);
+    wait();
+
+#pragma hls_pipeline_init_interval 1
+#pragma pipeline_stall_mode flush
+    while (1) {
+      // The last stage is the output signal itself
+#pragma hls_unroll yes
+      for (unsigned int i = Stages - 1; i > 0; i--) {
+        val_reg[i] = val_reg[i - 1];
+        msg_reg[i] = msg_reg[i - 1];
+        credit_reg[i] = credit_reg[i - 1];
+      }
+      val_reg[0] = in_val.read();
+      msg_reg[0] = in_msg.read();
+      credit_reg[0] = out_credit.read();
+      out_val.write(val_reg[Stages - 1]);
+      out_msg.write(msg_reg[Stages - 1]);
+      in_credit.write(credit_reg[Stages - 1]);
+      wait();
+    }
+  }
+};
+
+}  // namespace Connections
+
+#endif  // NVHLS_CONNECTIONS_CREDIT_H_
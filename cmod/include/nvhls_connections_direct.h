@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+// nvhls_connections_direct.h
+//========================================================================
+
+#ifndef NVHLS_CONNECTIONS_DIRECT_H_
+#define NVHLS_CONNECTIONS_DIRECT_H_
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_assert.h>
+
+/**
+ * \def NVHLS_DIRECT_COMBINATIONAL
+ * \ingroup Connections
+ * Selects DirectCombinational, DirectIn and DirectOut in CombinationalSel and as the channel of CombinationalBufferedPorts (default: 1 with CONNECTIONS_FAST_SIM, else 0; always 0 in synthesis).
+ */
+#ifndef NVHLS_DIRECT_COMBINATIONAL
+#if defined(CONNECTIONS_FAST_SIM) && !defined(__SYNTHESIS__)
+#define NVHLS_DIRECT_COMBINATIONAL 1
+#else
+#define NVHLS_DIRECT_COMBINATIONAL 0
+#endif
+#endif
+
+namespace Connections {
+
+//------------------------------------------------------------------------
+// DirectCombinational
+//------------------------------------------------------------------------
+/**
+ * \brief Fast simulation model of a Combinational channel as a shared slot between producer and consumer
+ * \ingroup Connections
+ *
+ * \tparam Message          Message type
+ * \tparam NumSlots         Number of message slots (default: 2)
+ *
+ * \par Overview
+ * A Combinational channel moves every message through SystemC signals or a
+ * tlm_fifo, so each transfer costs update requests, delta cycles and the
+ * activation of the processes waiting on them, even in CONNECTIONS_FAST_SIM.
+ * In a long chain of combinational hops this dominates the simulation time.
+ * DirectCombinational is a ring of NumSlots messages that both ends access
+ * with plain function calls: PushNB() copies the message into a free slot
+ * and PopNB() copies it out, with no signal, event or notification.
+ *
+ * - The ends have the interface of a Combinational used as ports:
+ *   ResetWrite(), PushNB(), Push() and Full() for the producer, ResetRead(),
+ *   PopNB(), Pop(), PeekNB() and Empty() for the consumer.  Like Connections
+ *   Push() and Pop(), the blocking calls retry once per cycle and return
+ *   after the wait() of the cycle in which they succeed.
+ * - As with TLM_PORT, transfers are only modeled at cycle granularity.  A
+ *   message pushed in a cycle is popped in the same cycle if the consumer
+ *   runs after the producer, else in the next one, and up to NumSlots
+ *   messages are in flight.  The default of 2 slots sustains one message per
+ *   cycle independently of the order of the two processes.
+ * - Both ends must be SC_THREADs clocked by the same clock, or two threads of
+ *   one module as with CombinationalBufferedPorts.  DirectIn and DirectOut
+ *   connect the channel to other modules.
+ * - It is a simulation model only; CombinationalSel and
+ *   CombinationalBufferedPorts select it with NVHLS_DIRECT_COMBINATIONAL and
+ *   use Combinational otherwise.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_connections_direct.h>
+ *
+ *      ...
+ *      Connections::DirectCombinational<Msg> chan;
+ *      ...
+ *      producer.out(chan);      // DirectOut<Msg> out
+ *      consumer.in(chan);       // DirectIn<Msg> in
+ *      ...
+ * \endcode
+ * \par
+ *
+ */
+template <typename Message, unsigned int NumSlots = 2>
+class DirectCombinational {
+ public:
+  DirectCombinational() : name_(sc_gen_unique_name("direct_comb")) { Clear(); }
+
+  explicit DirectCombinational(const char* name) : name_(name) { Clear(); }
+
+  const char* name() const { return name_.c_str(); }
+
+  // Producer end
+  void ResetWrite() { Clear(); }
+
+  bool Full() const { return count_ == NumSlots; }
+
+  virtual bool PushNB(const Message& m) {
+    if (Full())
+      return false;
+    slots_[(head_ + count_) % NumSlots] = m;
+    count_++;
+    return true;
+  }
+
+  void Push(const Message& m) {
+    while (!PushNB(m))
+      sc_core::wait();
+    sc_core::wait();
+  }
+
+  // Consumer end
+  void ResetRead() { Clear(); }
+
+  bool Empty() const { return count_ == 0; }
+
+  virtual bool PopNB(Message& m) {
+    if (Empty())
+      return false;
+    m = slots_[head_];
+    head_ = (head_ + 1) % NumSlots;
+    count_--;
+    return true;
+  }
+
+  bool PeekNB(Message& m) const {
+    if (Empty())
+      return false;
+    m = slots_[head_];
+    return true;
+  }
+
+  Message Pop() {
+    Message m;
+    while (!PopNB(m))
+      sc_core::wait();
+    sc_core::wait();
+    return m;
+  }
+
+  virtual ~DirectCombinational() {}
+
+ protected:
+  std::string name_;
+  Message slots_[NumSlots];
+  unsigned int head_;
+  unsigned int count_;
+
+  void Clear() {
+    head_ = 0;
+    count_ = 0;
+  }
+};
+
+/**
+ * \brief Producer port of a DirectCombinational
+ * \ingroup Connections
+ *
+ * \tparam Message          Message type
+ * \tparam NumSlots         Number of message slots of the channel (default: 2)
+ *
+ * \par Overview
+ * A handle to the channel it is bound to with operator(), with the
+ * interface of Connections::Out.  The do_wait argument of PushNB() is only
+ * accepted for source compatibility.
+ */
+template <typename Message, unsigned int NumSlots = 2>
+class DirectOut {
+ public:
+  typedef DirectCombinational<Message, NumSlots> Channel;
+
+  DirectOut() : chan_(0) {}
+
+  explicit DirectOut(const char* name) : chan_(0) {}
+
+  void operator()(Channel& chan) { chan_ = &chan; }
+
+  void Reset() { Chan().ResetWrite(); }
+
+  bool Full() { return Chan().Full(); }
+
+  bool PushNB(const Message& m, const bool& do_wait = true) { return Chan().PushNB(m); }
+
+  void Push(const Message& m) { Chan().Push(m); }
+
+ protected:
+  Channel* chan_;
+
+  Channel& Chan() {
+    NVHLS_ASSERT_MSG(chan_ != 0, "DirectOut is not bound to a channel");
+    return *chan_;
+  }
+};
+
+/**
+ * \brief Consumer port of a DirectCombinational
+ * \ingroup Connections
+ *
+ * \tparam Message          Message type
+ * \tparam NumSlots         Number of message slots of the channel (default: 2)
+ *
+ * \par Overview
+ * A handle to the channel it is bound to with operator(), with the
+ * interface of Connections::In.  The do_wait argument of PopNB() is only
+ * accepted for source compatibility.
+ */
+template <typename Message, unsigned int NumSlots = 2>
+class DirectIn {
+ public:
+  typedef DirectCombinational<Message, NumSlots> Channel;
+
+  DirectIn() : chan_(0) {}
+
+  explicit DirectIn(const char* name) : chan_(0) {}
+
+  void operator()(Channel& chan) { chan_ = &chan; }
+
+  void Reset() { Chan().ResetRead(); }
+
+  bool Empty() { return Chan().Empty(); }
+
+  bool PopNB(Message& m, const bool& do_wait = true) { return Chan().PopNB(m); }
+
+  Message Pop() { return Chan().Pop(); }
+
+  Message Peek() {
+    Message m;
+    bool valid = Chan().PeekNB(m);
+    NVHLS_ASSERT_MSG(valid, "Peek on an empty DirectIn");
+    return m;
+  }
+
+ protected:
+  Channel* chan_;
+
+  Channel& Chan() {
+    NVHLS_ASSERT_MSG(chan_ != 0, "DirectIn is not bound to a channel");
+    return *chan_;
+  }
+};
+
+/**
+ * \brief Selects the combinational channel and its ports
+ * \ingroup Connections
+ *
+ * \tparam Message          Message type
+ * \tparam Direct           Select DirectCombinational, DirectIn and DirectOut (default: NVHLS_DIRECT_COMBINATIONAL)
+ *
+ * \par Overview
+ * chan_t, in_t and out_t are Combinational, In and Out, or with Direct set
+ * DirectCombinational, DirectIn and DirectOut.  A block declared with them
+ * keeps its Connections ports in synthesis and in the accurate simulation
+ * modes, and hands messages over through a shared slot in
+ * CONNECTIONS_FAST_SIM.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_connections_direct.h>
+ *
+ *      ...
+ *      Connections::CombinationalSel<Msg>::out_t out;
+ *      ...
+ *      Connections::CombinationalSel<Msg>::chan_t chan;
+ *      ...
+ * \endcode
+ * \par
+ *
+ */
+template <typename Message, bool Direct = NVHLS_DIRECT_COMBINATIONAL>
+struct CombinationalSel {
+  typedef Combinational<Message> chan_t;
+  typedef In<Message> in_t;
+  typedef Out<Message> out_t;
+};
+
+template <typename Message>
+struct CombinationalSel<Message, true> {
+  typedef DirectCombinational<Message> chan_t;
+  typedef DirectIn<Message> in_t;
+  typedef DirectOut<Message> out_t;
+};
+
+}  // namespace Connections
+
+#endif  // NVHLS_CONNECTIONS_DIRECT_H_
@@ -0,0 +1,810 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+//========================================================================
+// nvhls_connections_fork_join.h
+//========================================================================
+
+#ifndef NVHLS_CONNECTIONS_FORK_JOIN_H_
+#define NVHLS_CONNECTIONS_FORK_JOIN_H_
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_message.h>
+#include <TypeToBits.h>
+#include <Arbiter.h>
+
+namespace Connections {
+
+//------------------------------------------------------------------------
+// Fork
+//------------------------------------------------------------------------
+/**
+ * \brief Broadcasts every message of enq to NumDeq consumers
+ * \ingroup Connections
+ *
+ * \tparam Message          Message type
+ * \tparam NumDeq           Number of deq ports
+ *
+ * \par Overview
+ * - Eager fork: a message is offered to all deq ports in the cycle it arrives, and every consumer takes it independently. There is no added latency, and with every consumer ready the fork forwards one message per cycle.
+ * - A message that some consumers did not take is kept in one register, with a pending bit per deq port, and offered to those consumers only until they take it. enq.rdy is set when nothing is pending, so it comes from a register and the fork has no combinational path from any deq.rdy to enq.rdy.
+ * - Like a Bypass, a consumer that stalls costs one cycle: the next message is accepted in the cycle after the last pending consumer took the message.
+ * - With TLM_PORT the fork is a thread with the same behavior at cycle granularity.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_connections_fork_join.h>
+ *
+ *      ...
+ *      Connections::Fork<Flit, 2> fork;
+ *      Connections::Combinational<Flit> in_chan, out_chan[2];
+ *      ...
+ *      fork.enq(in_chan);
+ *      for (unsigned j = 0; j < 2; j++) fork.deq[j](out_chan[j]);
+ *      ...
+ * \endcode
+ * \par
+ *
+ */
+template <typename Message, unsigned int NumDeq, connections_port_t port_marshall_type = AUTO_PORT>
+class Fork : public sc_module {
+  SC_HAS_PROCESS(Fork);
+
+ public:
+  // Interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  In<Message, port_marshall_type> enq;
+  Out<Message, port_marshall_type> deq[NumDeq];
+
+  Fork()
+      : sc_module(sc_module_name(sc_gen_unique_name("fork"))),
+        clk("clk"),
+        rst("rst") {
+    Init();
+  }
+
+  Fork(sc_module_name name) : sc_module(name), clk("clk"), rst("rst") {
+    Init();
+  }
+
+ protected:
+  typedef NVUINTW(NumDeq) Mask;
+
+  // Internal state
+  sc_signal<Mask> pending;
+  StateSignal<Message, port_marshall_type> state;
+
+#ifndef __SYNTHESIS__
+  ChannelProbe probe_;
+#endif
+
+  // Helper functions
+  void Init() {
+#ifndef __SYNTHESIS__
+    probe_.Init(name(), 1, Wrapped<Message>::width);
+    NVHLS_MEMORY("Connections::Fork", sizeof(*this));
+#endif
+#ifdef CONNECTIONS_SIM_ONLY
+    enq.disable_spawn();
+    for (unsigned int j = 0; j < NumDeq; ++j)
+      deq[j].disable_spawn();
+#endif
+
+#ifdef CONNECTIONS_SIM_ONLY
+    SC_METHOD(Comb);
+    sensitive << pending << enq.val << enq.msg << state.msg;
+#else
+    SC_METHOD(EnqRdy);
+    sensitive << pending;
+
+    SC_METHOD(DeqVal);
+    sensitive << pending << enq.val;
+
+    SC_METHOD(DeqMsg);
+    sensitive << pending << enq.msg << state.msg;
+#endif
+
+    SC_THREAD(Seq);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  // Combinational logic
+
+#ifdef CONNECTIONS_SIM_ONLY
+  void Comb() {
+    EnqRdy();
+    DeqVal();
+    DeqMsg();
+  }
+#endif
+
+  // Enqueue ready if no consumer still has to take the last message
+  void EnqRdy() { enq.rdy.write(pending.read() == 0); }
+
+  // Dequeue valid for a pending consumer, or for all of them when a new
+  // message is accepted
+  void DeqVal() {
+    Mask p = pending.read();
+#pragma hls_unroll yes
+    for (unsigned int j = 0; j < NumDeq; ++j)
+      deq[j].val.write(p[j] == 1 || (p == 0 && enq.val.read()));
+  }
+
+  // Dequeue Msg is the kept message while one is pending, else the enq Msg
+  void DeqMsg() {
+    bool kept = (pending.read() != 0);
+#pragma hls_unroll yes
+    for (unsigned int j = 0; j < NumDeq; ++j)
+      deq[j].msg.write(kept ? state.msg.read() : enq.msg.read());
+  }
+
+  // Sequential logic
+  void Seq() {
+    // Reset state
+    pending.write(0);
+    state.reset_state();
+
+    wait();
+
+    while (1) {
+      Mask p = pending.read();
+      Mask next = 0;
+      bool accept = (p == 0) && enq.val.read();
+#ifndef __SYNTHESIS__
+      if (probe_.Dumping())
+        probe_.DumpMsg(deq[0].msg.read());
+      bool deq_val = (p != 0) || accept;
+      bool deq_done = true;
+#endif
+#pragma hls_unroll yes
+      for (unsigned int j = 0; j < NumDeq; ++j) {
+        next[j] = (p[j] == 1 || accept) && !deq[j].rdy.read();
+#ifndef __SYNTHESIS__
+        deq_done = deq_done && next[j] == 0;
+#endif
+      }
+#ifndef __SYNTHESIS__
+      probe_.Sample(enq.val.read(), enq.rdy.read(), deq_val, deq_done, p != 0);
+#endif
+      // Keep the message for the consumers that did not take it
+      if (accept && next != 0) {
+        state.msg.write(enq.msg.read());
+      }
+      pending.write(next);
+      wait();
+    }
+  }
+
+#ifndef __SYNTHESIS__
+ public:
+  void line_trace() {
+    if (rst.read()) {
+      unsigned int width = (Message().length() / 4);
+      // Enqueue port
+      if (enq.val.read() && enq.rdy.read()) {
+        std::cout << std::hex << std::setw(width) << enq.msg.read();
+      } else {
+        std::cout << std::setw(width + 1) << " ";
+      }
+
+      std::cout << " ( " << std::hex << pending.read() << " ) ";
+      std::cout << " | ";
+    }
+  }
+#endif
+};
+
+// Fast simulation model: the thread offers each message to the deq ports
+// in the cycle it takes it from enq, and keeps offering it to the ports that
+// refused until all of them took it
+template <typename Message, unsigned int NumDeq>
+class Fork<Message, NumDeq, TLM_PORT> : public sc_module {
+  SC_HAS_PROCESS(Fork);
+
+ public:
+  // Interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  In<Message, TLM_PORT> enq;
+  Out<Message, TLM_PORT> deq[NumDeq];
+
+  Fork()
+      : sc_module(sc_module_name(sc_gen_unique_name("fork"))),
+        clk("clk"),
+        rst("rst") {
+    Init();
+  }
+
+  Fork(sc_module_name name) : sc_module(name), clk("clk"), rst("rst") {
+    Init();
+  }
+
+ protected:
+  Message msg;
+  bool pending[NumDeq];
+  unsigned int num_pending;
+
+#ifndef __SYNTHESIS__
+  ChannelProbe probe_;
+#endif
+
+  void Init() {
+#ifndef __SYNTHESIS__
+    probe_.Init(name(), 1, Wrapped<Message>::width);
+    NVHLS_MEMORY("Connections::Fork", sizeof(*this));
+#endif
+    SC_THREAD(Seq);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void Seq() {
+    enq.Reset();
+    for (unsigned int j = 0; j < NumDeq; ++j) {
+      deq[j].Reset();
+      pending[j] = false;
+    }
+    num_pending = 0;
+
+    wait();
+
+    while (1) {
+      unsigned int old_pending = num_pending;
+      bool popped = false;
+      if (num_pending == 0 && enq.PopNB(msg, false)) {
+        for (unsigned int j = 0; j < NumDeq; ++j)
+          pending[j] = true;
+        num_pending = NumDeq;
+        popped = true;
+      }
+      bool offered = (num_pending != 0);
+#ifndef __SYNTHESIS__
+      if (offered && probe_.Dumping())
+        probe_.DumpMsg(msg);
+#endif
+      for (unsigned int j = 0; j < NumDeq; ++j) {
+        if (pending[j] && deq[j].PushNB(msg, false)) {
+          pending[j] = false;
+          num_pending--;
+        }
+      }
+#ifndef __SYNTHESIS__
+      probe_.Sample(popped, old_pending == 0, offered, offered && num_pending == 0,
+                    old_pending != 0);
+#endif
+      wait();
+    }
+  }
+
+#ifndef __SYNTHESIS__
+ public:
+  void line_trace() { std::cout << " ( " << std::dec << num_pending << " ) | "; }
+#endif
+};
+
+//------------------------------------------------------------------------
+// Merge
+//------------------------------------------------------------------------
+/**
+ * \brief Forwards the messages of NumEnq producers to one consumer, arbitrated by an Arbiter
+ * \ingroup Connections
+ *
+ * \tparam Message          Message type
+ * \tparam NumEnq           Number of enq ports
+ * \tparam ArbiterType      Arbitration between the enq ports, see Arbiter (default: Roundrobin)
+ *
+ * \par Overview
+ * - Every cycle one valid enq port is granted and its message is offered on deq in the same cycle, so there is no added latency and no storage, and the merge forwards one message per cycle.
+ * - The grant is held while deq stalls (see LockableArbiter), so deq.msg stays stable until the consumer takes it, even if other producers become valid meanwhile. The arbiter priorities are updated once per message.
+ * - enq[i].rdy is the grant of port i and deq.rdy, like a Combinational channel the merge passes deq.rdy on combinationally.
+ * - The arbiter state is only updated by the clocked process; the combinational processes evaluate a copy of it.
+ * - With TLM_PORT the merge is a thread that takes at most one message per enq port into a slot and sends the granted slot in the same cycle, with the same ordering and throughput.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_connections_fork_join.h>
+ *
+ *      ...
+ *      Connections::Merge<Flit, 4> merge;
+ *      Connections::Combinational<Flit> in_chan[4], out_chan;
+ *      ...
+ *      for (unsigned i = 0; i < 4; i++) merge.enq[i](in_chan[i]);
+ *      merge.deq(out_chan);
+ *      ...
+ * \endcode
+ * \par
+ *
+ */
+template <typename Message, unsigned int NumEnq, arbiter_type ArbiterType = Roundrobin,
+          connections_port_t port_marshall_type = AUTO_PORT>
+class Merge : public sc_module {
+  SC_HAS_PROCESS(Merge);
+
+ public:
+  // Interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  In<Message, port_marshall_type> enq[NumEnq];
+  Out<Message, port_marshall_type> deq;
+
+  Merge()
+      : sc_module(sc_module_name(sc_gen_unique_name("merge"))),
+        clk("clk"),
+        rst("rst") {
+    Init();
+  }
+
+  Merge(sc_module_name name) : sc_module(name), clk("clk"), rst("rst") {
+    Init();
+  }
+
+ protected:
+  typedef LockableArbiter<NumEnq, ArbiterType> Arb;
+  typedef typename Arb::Mask Mask;
+
+  // Internal state
+  Arb arb;
+  // deq was valid and not ready in the last cycle: hold the grant
+  sc_signal<bool> stalled;
+  // Toggles whenever arb changes, so the combinational processes see it
+  sc_signal<bool> arb_changed;
+
+  // Helper functions
+  void Init() {
+#ifndef __SYNTHESIS__
+    NVHLS_MEMORY("Connections::Merge", sizeof(*this));
+#endif
+#ifdef CONNECTIONS_SIM_ONLY
+    for (unsigned int i = 0; i < NumEnq; ++i)
+      enq[i].disable_spawn();
+    deq.disable_spawn();
+#endif
+
+#ifdef CONNECTIONS_SIM_ONLY
+    SC_METHOD(Comb);
+    sensitive << deq.rdy << stalled << arb_changed;
+    for (unsigned int i = 0; i < NumEnq; ++i)
+      sensitive << enq[i].val << enq[i].msg;
+#else
+    SC_METHOD(EnqRdy);
+    sensitive << deq.rdy << stalled << arb_changed;
+    for (unsigned int i = 0; i < NumEnq; ++i)
+      sensitive << enq[i].val;
+
+    SC_METHOD(DeqVal);
+    sensitive << stalled << arb_changed;
+    for (unsigned int i = 0; i < NumEnq; ++i)
+      sensitive << enq[i].val;
+
+    SC_METHOD(DeqMsg);
+    sensitive << stalled << arb_changed;
+    for (unsigned int i = 0; i < NumEnq; ++i)
+      sensitive << enq[i].val << enq[i].msg;
+#endif
+
+    SC_THREAD(Seq);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  Mask Valid() {
+    Mask valid = 0;
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumEnq; ++i)
+      valid[i] = enq[i].val.read();
+    return valid;
+  }
+
+  // Grant of this cycle, without updating the arbiter
+  Mask Grant() {
+    Arb next = arb;
+    return next.pick(Valid(), stalled.read());
+  }
+
+  // Combinational logic
+
+#ifdef CONNECTIONS_SIM_ONLY
+  void Comb() {
+    EnqRdy();
+    DeqVal();
+    DeqMsg();
+  }
+#endif
+
+  // Enqueue ready for the granted port if deq is ready
+  void EnqRdy() {
+    Mask grant = Grant();
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumEnq; ++i)
+      enq[i].rdy.write(grant[i] == 1 && deq.rdy.read());
+  }
+
+  // Dequeue valid if a port is granted
+  void DeqVal() { deq.val.write(Grant() != 0); }
+
+  // Dequeue Msg is the Msg of the granted port
+  void DeqMsg() {
+    Mask grant = Grant();
+    unsigned int sel = 0;
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumEnq; ++i) {
+      if (grant[i] == 1)
+        sel = i;
+    }
+    deq.msg.write(enq[sel].msg.read());
+  }
+
+  // Sequential logic
+  void Seq() {
+    // Reset state
+    arb.reset();
+    stalled.write(false);
+    arb_changed.write(false);
+
+    wait();
+
+    while (1) {
+      Mask valid = Valid();
+      Mask grant = 0;
+      if (valid != 0) {
+        // Commits the grant of this cycle, a no-op while it is held
+        grant = arb.pick(valid, stalled.read());
+        if (!stalled.read())
+          arb_changed.write(!arb_changed.read());
+      }
+      stalled.write(grant != 0 && !deq.rdy.read());
+      wait();
+    }
+  }
+
+#ifndef __SYNTHESIS__
+ public:
+  void line_trace() {
+    if (rst.read()) {
+      unsigned int width = (Message().length() / 4);
+      // Dequeue port
+      if (deq.val.read() && deq.rdy.read()) {
+        std::cout << std::hex << std::setw(width) << deq.msg.read();
+      } else {
+        std::cout << std::setw(width + 1) << " ";
+      }
+      std::cout << " | ";
+    }
+  }
+#endif
+};
+
+// Fast simulation model: the thread takes at most one message per enq port
+// into a slot and sends the granted slot to deq in the same cycle
+template <typename Message, unsigned int NumEnq, arbiter_type ArbiterType>
+class Merge<Message, NumEnq, ArbiterType, TLM_PORT> : public sc_module {
+  SC_HAS_PROCESS(Merge);
+
+ public:
+  // Interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  In<Message, TLM_PORT> enq[NumEnq];
+  Out<Message, TLM_PORT> deq;
+
+  Merge()
+      : sc_module(sc_module_name(sc_gen_unique_name("merge"))),
+        clk("clk"),
+        rst("rst") {
+    Init();
+  }
+
+  Merge(sc_module_name name) : sc_module(name), clk("clk"), rst("rst") {
+    Init();
+  }
+
+ protected:
+  typedef LockableArbiter<NumEnq, ArbiterType> Arb;
+  typedef typename Arb::Mask Mask;
+
+  Arb arb;
+  Message slot[NumEnq];
+  Mask full;
+  bool stalled;
+
+  void Init() {
+#ifndef __SYNTHESIS__
+    NVHLS_MEMORY("Connections::Merge", sizeof(*this));
+#endif
+    SC_THREAD(Seq);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void Seq() {
+    for (unsigned int i = 0; i < NumEnq; ++i)
+      enq[i].Reset();
+    deq.Reset();
+    arb.reset();
+    full = 0;
+    stalled = false;
+
+    wait();
+
+    while (1) {
+      for (unsigned int i = 0; i < NumEnq; ++i) {
+        if (full[i] == 0 && enq[i].PopNB(slot[i], false))
+          full[i] = 1;
+      }
+      if (full != 0) {
+        Mask grant = arb.pick(full, stalled);
+        unsigned int sel = 0;
+        for (unsigned int i = 0; i < NumEnq; ++i) {
+          if (grant[i] == 1)
+            sel = i;
+        }
+        stalled = !deq.PushNB(slot[sel], false);
+        if (!stalled)
+          full[sel] = 0;
+      }
+      wait();
+    }
+  }
+
+#ifndef __SYNTHESIS__
+ public:
+  void line_trace() { std::cout << " ( " << std::hex << full << " ) | "; }
+#endif
+};
+
+//------------------------------------------------------------------------
+// Join
+//------------------------------------------------------------------------
+/**
+ * \brief Message of a Join: one message of each enq port, data[i] from enq[i]
+ * \ingroup Connections
+ *
+ * \tparam Message          Message type of the enq ports
+ * \tparam NumEnq           Number of enq ports
+ *
+ */
+template <typename Message, unsigned int NumEnq>
+class JoinMessage : public nvhls_message {
+ public:
+  Message data[NumEnq];
+
+  static const unsigned int width = Wrapped<Message>::width * NumEnq;
+
+  Message& operator[](unsigned int i) { return data[i]; }
+  const Message& operator[](unsigned int i) const { return data[i]; }
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumEnq; ++i)
+      m& data[i];
+  }
+};
+
+/**
+ * \brief Combines one message of each of NumEnq producers into one JoinMessage
+ * \ingroup Connections
+ *
+ * \tparam Message          Message type of the enq ports
+ * \tparam NumEnq           Number of enq ports
+ *
+ * \par Overview
+ * - deq is valid when every enq port is valid, and carries their messages in a JoinMessage. All enq ports are taken together when deq is taken, so the producers stay in lock step (zip).
+ * - enq[i].rdy is deq.rdy and the valids of the other enq ports, so enq[i].rdy does not depend on enq[i].val. The join has no state and no added latency, and forwards one message per cycle.
+ * - With TLM_PORT the join is a thread that takes at most one message per enq port into a slot and sends them as soon as all slots are full.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_connections_fork_join.h>
+ *
+ *      ...
+ *      Connections::Join<NVUINT16, 2> join;
+ *      Connections::Combinational<NVUINT16> in_chan[2];
+ *      Connections::Combinational<Connections::JoinMessage<NVUINT16, 2> > out_chan;
+ *      ...
+ *      for (unsigned i = 0; i < 2; i++) join.enq[i](in_chan[i]);
+ *      join.deq(out_chan);
+ *      ...
+ * \endcode
+ * \par
+ *
+ */
+template <typename Message, unsigned int NumEnq, connections_port_t port_marshall_type = AUTO_PORT>
+class Join : public sc_module {
+  SC_HAS_PROCESS(Join);
+
+ public:
+  typedef JoinMessage<Message, NumEnq> Joined;
+
+  // Interface, clk and rst are only used by the TLM_PORT model
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  In<Message, port_marshall_type> enq[NumEnq];
+  Out<Joined, port_marshall_type> deq;
+
+  Join()
+      : sc_module(sc_module_name(sc_gen_unique_name("join"))),
+        clk("clk"),
+        rst("rst") {
+    Init();
+  }
+
+  Join(sc_module_name name) : sc_module(name), clk("clk"), rst("rst") {
+    Init();
+  }
+
+ protected:
+  // Helper functions
+  void Init() {
+#ifdef CONNECTIONS_SIM_ONLY
+    for (unsigned int i = 0; i < NumEnq; ++i)
+      enq[i].disable_spawn();
+    deq.disable_spawn();
+#endif
+
+#ifdef CONNECTIONS_SIM_ONLY
+    SC_METHOD(Comb);
+    sensitive << deq.rdy;
+    for (unsigned int i = 0; i < NumEnq; ++i)
+      sensitive << enq[i].val << enq[i].msg;
+#else
+    SC_METHOD(EnqRdy);
+    sensitive << deq.rdy;
+    for (unsigned int i = 0; i < NumEnq; ++i)
+      sensitive << enq[i].val;
+
+    SC_METHOD(DeqVal);
+    for (unsigned int i = 0; i < NumEnq; ++i)
+      sensitive << enq[i].val;
+
+    SC_METHOD(DeqMsg);
+    for (unsigned int i = 0; i < NumEnq; ++i)
+      sensitive << enq[i].msg;
+#endif
+  }
+
+  // The enq and deq Msg are bits with SYN_PORT and MARSHALL_PORT
+  static const Message& ToMessage(const Message& msg) { return msg; }
+  static Message ToMessage(const sc_lv<Wrapped<Message>::width>& bits) {
+    return BitsToType<Message>(bits);
+  }
+  static void WriteMsg(sc_out<Joined>& port, const Joined& msg) { port.write(msg); }
+  static void WriteMsg(sc_out<sc_lv<Joined::width> >& port, const Joined& msg) {
+    port.write(TypeToBits<Joined>(msg));
+  }
+
+  // Combinational logic
+
+#ifdef CONNECTIONS_SIM_ONLY
+  void Comb() {
+    EnqRdy();
+    DeqVal();
+    DeqMsg();
+  }
+#endif
+
+  // Enqueue ready if deq is ready and all other enq ports are valid
+  void EnqRdy() {
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumEnq; ++i) {
+      bool others = true;
+#pragma hls_unroll yes
+      for (unsigned int k = 0; k < NumEnq; ++k) {
+        if (k != i)
+          others = others && enq[k].val.read();
+      }
+      enq[i].rdy.write(others && deq.rdy.read());
+    }
+  }
+
+  // Dequeue valid if all enq ports are valid
+  void DeqVal() {
+    bool all = true;
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumEnq; ++i)
+      all = all && enq[i].val.read();
+    deq.val.write(all);
+  }
+
+  // Dequeue Msg is the Msgs of all enq ports
+  void DeqMsg() {
+    Joined msg;
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumEnq; ++i)
+      msg[i] = ToMessage(enq[i].msg.read());
+    WriteMsg(deq.msg, msg);
+  }
+};
+
+// Fast simulation model: the thread takes at most one message per enq port
+// into a slot and sends them to deq in the cycle the last slot fills
+template <typename Message, unsigned int NumEnq>
+class Join<Message, NumEnq, TLM_PORT> : public sc_module {
+  SC_HAS_PROCESS(Join);
+
+ public:
+  typedef JoinMessage<Message, NumEnq> Joined;
+
+  // Interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  In<Message, TLM_PORT> enq[NumEnq];
+  Out<Joined, TLM_PORT> deq;
+
+  Join()
+      : sc_module(sc_module_name(sc_gen_unique_name("join"))),
+        clk("clk"),
+        rst("rst") {
+    Init();
+  }
+
+  Join(sc_module_name name) : sc_module(name), clk("clk"), rst("rst") {
+    Init();
+  }
+
+ protected:
+  Joined slots;
+  bool full[NumEnq];
+  unsigned int num_full;
+
+  void Init() {
+#ifndef __SYNTHESIS__
+    NVHLS_MEMORY("Connections::Join", sizeof(*this));
+#endif
+    SC_THREAD(Seq);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void Seq() {
+    for (unsigned int i = 0; i < NumEnq; ++i) {
+      enq[i].Reset();
+      full[i] = false;
+    }
+    deq.Reset();
+    num_full = 0;
+
+    wait();
+
+    while (1) {
+      for (unsigned int i = 0; i < NumEnq; ++i) {
+        if (!full[i] && enq[i].PopNB(slots[i], false)) {
+          full[i] = true;
+          num_full++;
+        }
+      }
+      if (num_full == NumEnq && deq.PushNB(slots, false)) {
+        for (unsigned int i = 0; i < NumEnq; ++i)
+          full[i] = false;
+        num_full = 0;
+      }
+      wait();
+    }
+  }
+
+#ifndef __SYNTHESIS__
+ public:
+  void line_trace() { std::cout << " ( " << std::dec << num_full << " ) | "; }
+#endif
+};
+
+}  // namespace Connections
+
+#endif  // NVHLS_CONNECTIONS_FORK_JOIN_H_
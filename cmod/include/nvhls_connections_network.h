@@ -247,16 +247,171 @@ class OutNetwork : public sc_module {
 #endif
 };
 
+//------------------------------------------------------------------------
+// OutNetworkTable
+//------------------------------------------------------------------------
+// OutNetwork with a route table: the sender only sets a logical destination
+// on dest_id, and the route and packet id (the VC in the WHVC routers) of
+// each packet are looked up in table[dest_id]. Entry i holds
+// <Packet Id>:<Route> in its LSBs. The table can be driven by the regOut
+// ports of an AxiSlaveToReg with EntryWidth = axiCfg::dataWidth and
+// 2^LogicalIdWidth registers, so endpoints can be remapped at runtime, e.g.
+// to balance load, without any change to the senders. As route and id of
+// OutNetwork, dest_id is kept until it is set again, and a changed table
+// entry takes effect with the next packet.
+
+template <typename Message, unsigned int LogicalIdWidth,
+          unsigned int DestWidthPerHop, unsigned int MaxHops,
+          unsigned int PacketIdWidth, unsigned int EntryWidth = 32>
+class OutNetworkTable : public sc_module {
+  SC_HAS_PROCESS(OutNetworkTable);
+  static_assert(DestWidthPerHop * MaxHops + PacketIdWidth <= EntryWidth,
+                "Route and packet id must fit into a table entry");
+
+ public:
+  typedef Wrapped<Message> WMessage;
+  static const unsigned int width = WMessage::width;
+  static const unsigned int num_entries = 1 << LogicalIdWidth;
+  typedef sc_lv<WMessage::width> MsgBits;
+  typedef Packet<WMessage::width, DestWidthPerHop, MaxHops, PacketIdWidth>
+      Packet_t;
+  typedef NVUINTW(EntryWidth) Entry_t;
+
+  // Interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  In<Message> enq;
+  Out<Packet_t> deq;
+  In<sc_lv<LogicalIdWidth> > dest_id;
+  sc_in<Entry_t> table[num_entries];
+
+  // Internal State
+  sc_signal<sc_lv<LogicalIdWidth> > dest_state;
+
+  OutNetworkTable()
+      : sc_module(sc_module_name(sc_gen_unique_name("out_nw_table"))),
+        clk("clk"),
+        rst("rst") {
+    Init();
+  }
+
+  OutNetworkTable(sc_module_name name)
+      : sc_module(name), clk("clk"), rst("rst") {
+    Init();
+  }
+
+ protected:
+  void Init() {
+#ifdef CONNECTIONS_SIM_ONLY
+    enq.disable_spawn();
+    deq.disable_spawn();
+    dest_id.disable_spawn();
+#endif
+
+    SC_METHOD(AssignMsg);
+    sensitive << enq.msg << dest_state << rst;
+    for (unsigned int i = 0; i < num_entries; i++) {
+      sensitive << table[i];
+    }
+
+    SC_METHOD(AssignVal);
+    sensitive << enq.val;
+
+    SC_METHOD(AssignRdy);
+    sensitive << deq.rdy;
+
+    SC_METHOD(TieToHigh);
+    sensitive << clk.pos();
+
+    SC_THREAD(SetState);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void AssignMsg() {
+    if (!rst.read()) {
+      deq.msg.write(0);
+    } else if (enq.val.read()) {
+      Entry_t entry = table[dest_state.read().to_uint()].read();
+      Packet_t packet;
+      packet.dest = nvhls::get_slc<DestWidthPerHop * MaxHops>(entry, 0);
+      packet.packet_id =
+          nvhls::get_slc<PacketIdWidth>(entry, DestWidthPerHop * MaxHops);
+      vector_to_type(enq.msg.read(), false, &packet.data);
+      Marshaller<Wrapped<Packet_t>::width> pmarshaller;
+      packet.Marshall(pmarshaller);
+      deq.msg.write(pmarshaller.GetResult());
+    }
+  }
+
+  void AssignVal() { deq.val.write(enq.val.read()); }
+  void AssignRdy() { enq.rdy.write(deq.rdy.read()); }
+
+  void TieToHigh() { dest_id.rdy.write(1); }
+
+  void SetState() {
+    dest_state.write(0);
+    wait();
+    while (1) {
+      if (dest_id.val.read()) {
+        dest_state.write(dest_id.msg.read());
+      }
+      wait();
+    }
+  }
+
+#ifndef __SYNTHESIS__
+ public:
+  void line_trace() {
+    if (rst.read()) {
+      unsigned int mwidth = (Message().length() / 4);
+      // Enqueue port
+      if (enq.val.read() && enq.rdy.read()) {
+        std::cout << std::hex << std::setw(mwidth) << enq.msg.read();
+      } else {
+        std::cout << std::setw(mwidth + 1) << " ";
+      }
+      std::cout << " | ";
+
+      // Logical destination
+      std::cout << std::hex << " ( " << dest_state.read() << " ) ";
+
+      // Dequeue port
+      unsigned int pwidth = (Packet_t::width / 4);
+      if (deq.val.read() && deq.rdy.read()) {
+        std::cout << std::hex << std::setw(pwidth) << deq.msg.read();
+      } else {
+        std::cout << std::setw(pwidth + 1) << " ";
+      }
+      std::cout << " | ";
+    }
+  }
+#endif
+};
+
 //------------------------------------------------------------------------
 // InNetworkCredit
 //------------------------------------------------------------------------
 // NOTE: Currently, the PacketIdWidth, DestWidthPerHop, MaxHops parameters
 // are assumed to be the same for a packet and a credit_packet
+//
+// Credit return batching: by default, every dequeued message returns its
+// credit right away. With CreditBatch > 1, credits are accumulated and only
+// sent once CreditBatch of them are pending, or, with CreditTimeout > 0, once
+// pending credits have waited CreditTimeout cycles. OutNetworkCredit already
+// adds the count carried by each credit packet, and init_credits works as
+// before. Without a timeout the initial credits must be at least
+// CreditBatch, otherwise the sender can run out of credits while fewer than
+// CreditBatch are pending here.
 
 template <typename Message, unsigned int DestWidthPerHop, unsigned int MaxHops,
-          unsigned int PacketIdWidth, unsigned int CreditWidth>
+          unsigned int PacketIdWidth, unsigned int CreditWidth,
+          unsigned int CreditBatch = 1, unsigned int CreditTimeout = 0>
 class InNetworkCredit : public sc_module {
   SC_HAS_PROCESS(InNetworkCredit);
+  static_assert(CreditBatch >= 1 && (CreditWidth >= 32 ||
+                                     CreditBatch < (1ULL << CreditWidth)),
+                "CreditBatch must fit into a credit message");
 
  public:
   typedef Wrapped<Message> WMessage;
@@ -287,6 +442,7 @@ class InNetworkCredit : public sc_module {
   // Internal State
   sc_signal<Credit_t> credits;
   sc_signal<Credit_t> credits_next;
+  sc_signal<NVUINTW(nvhls::index_width<CreditTimeout + 1>::val)> credit_timer;
 
   InNetworkCredit()
       : sc_module(sc_module_name(sc_gen_unique_name("in_nw_credit"))),
@@ -340,7 +496,7 @@ class InNetworkCredit : public sc_module {
               << credits;
 
     SC_METHOD(AssignCreditVal);
-    sensitive << deq.val << deq.rdy << credits;
+    sensitive << deq.val << deq.rdy << credits << credit_timer;
 
     SC_THREAD(UpdateCredit);
     sensitive << clk.pos();
@@ -395,7 +551,10 @@ class InNetworkCredit : public sc_module {
 
   void AssignCreditVal() {
     bool do_deq = deq.val.read() && deq.rdy.read();
-    if (do_deq || (credits.read() != 0)) {
+    unsigned int pending = credits.read().to_uint() + (do_deq ? 1 : 0);
+    bool timeout = (CreditTimeout > 0) && (credits.read() != 0) &&
+                   (credit_timer.read() == CreditTimeout);
+    if ((pending >= CreditBatch) || timeout) {
       credit_enq.val.write(1);
     } else {
       credit_enq.val.write(0);
@@ -404,6 +563,7 @@ class InNetworkCredit : public sc_module {
 
   void UpdateCredit() {
     credits.write(0);
+    credit_timer.write(0);
     wait();
     while (1) {
       if (init_credits.val.read()) {
@@ -411,6 +571,16 @@ class InNetworkCredit : public sc_module {
       } else {
         credits.write(credits_next.read());
       }
+
+      // Cycles the pending credits have waited
+      if (CreditTimeout > 0) {
+        bool do_credit = credit_enq.val.read() && credit_enq.rdy.read();
+        if (do_credit || (credits_next.read() == 0)) {
+          credit_timer.write(0);
+        } else if (credit_timer.read() != CreditTimeout) {
+          credit_timer.write(credit_timer.read() + 1);
+        }
+      }
       wait();
     }
   }
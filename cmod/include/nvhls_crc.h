@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_CRC_H
+#define NVHLS_CRC_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <ecc_mem_array.h>
+
+/**
+ * \brief Parallel CRC of a DataWidth-bit word
+ * \ingroup SerDes
+ *
+ * \tparam DataWidth   Width of the data word
+ * \tparam CrcWidth    Width of the CRC
+ * \tparam Poly        Generator polynomial without the x^CrcWidth term, e.g. 0x1021 for CRC-16-CCITT
+ *
+ * \par Overview
+ * Compute() returns the CRC of the data word shifted in MSB first with an initial value of 0, the
+ * value a serial LFSR would hold after DataWidth cycles.  The CRC is linear in the data, so every
+ * CRC bit is the parity of a fixed set of data bits: data bit j contributes x^(j + CrcWidth) mod
+ * Poly, which is one LFSR step (Step()) from the contribution of bit j - 1.  After unrolling the
+ * masks are constants and each CRC bit is a balanced XOR tree (ecc_xor_tree), so the CRC is
+ * log2(DataWidth) XOR levels deep instead of the DataWidth levels of the serial LFSR.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_crc.h>
+ *
+ *      ...
+ *      typedef crc_gen<64, 16, 0x1021> Crc_t;
+ *      Crc_t::Crc crc = Crc_t::Compute(data);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <unsigned int DataWidth, unsigned int CrcWidth, unsigned long long Poly>
+class crc_gen {
+  static_assert(CrcWidth >= 1 && CrcWidth <= 64, "CrcWidth must be 1 to 64 bits");
+
+ public:
+  typedef NVUINTW(DataWidth) Data;
+  typedef NVUINTW(CrcWidth) Crc;
+
+  // One LFSR step without input: crc * x mod Poly
+  static Crc Step(const Crc& crc) {
+    Crc next = crc << 1;
+    if (crc[CrcWidth - 1] == 1) next ^= static_cast<Crc>(Poly);
+    return next;
+  }
+
+  static Crc Compute(const Data& d) {
+    Data mask[CrcWidth];
+    // Contribution of data bit 0: x^CrcWidth mod Poly
+    Crc contrib = static_cast<Crc>(Poly);
+    #pragma hls_unroll yes
+    for (unsigned int j = 0; j < DataWidth; j++) {
+      #pragma hls_unroll yes
+      for (unsigned int k = 0; k < CrcWidth; k++) {
+        mask[k][j] = contrib[k];
+      }
+      contrib = Step(contrib);
+    }
+    Crc crc;
+    #pragma hls_unroll yes
+    for (unsigned int k = 0; k < CrcWidth; k++) {
+      Data sel = d & mask[k];
+      crc[k] = ecc_xor_tree<DataWidth>::reduce(sel);
+    }
+    return crc;
+  }
+};
+
+#endif  // NVHLS_CRC_H
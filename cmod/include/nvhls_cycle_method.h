@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_CYCLE_METHOD_H
+#define NVHLS_CYCLE_METHOD_H
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_parallel_sim.h>
+
+namespace match {
+
+/**
+ * \brief Clocks the CycleProcesses of a ParallelSim from one SC_METHOD
+ * \ingroup ParallelSim
+ *
+ * \par Overview
+ * Every SC_THREAD that wait()s each cycle costs two thread switches per
+ * cycle.  Blocks written as CycleProcesses, i.e. with explicit state and an
+ * Eval() that is called once per cycle, need none: CycleMethodHost steps all
+ * processes and then commits all CycleChannels of a ParallelSim in a single
+ * SC_METHOD on the rising clock edge, and resets them while rst is low.  The
+ * same process graph runs standalone in ParallelSim::Run() or, with this
+ * host, inside a SystemC simulation next to thread-based blocks.
+ *
+ * Processes in the method domain talk to each other through CycleChannels.
+ * MethodIn and MethodOut connect the domain to Connections ports; each of
+ * them keeps one SC_THREAD, so threads are only left at the boundary and
+ * not in every block.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_cycle_method.h>
+ *
+ *      match::ParallelSim sim;
+ *      match::CycleMethodHost host("host", sim);
+ *      match::MethodIn<Req> req("req", sim);     // Connections::In<Req> req.in
+ *      match::MethodOut<Rsp> rsp("rsp", sim);    // Connections::Out<Rsp> rsp.out
+ *      Block block(req, rsp);                    // a CycleProcess, PopNB()/PushNB() in Eval()
+ *      sim.Add(&block);
+ *      ...
+ *          host.clk(clk);
+ *          host.rst(rst);
+ *          req.clk(clk);
+ *          req.rst(rst);
+ *          ...
+ * \endcode
+ * \par
+ *
+ */
+class CycleMethodHost : public sc_module {
+  SC_HAS_PROCESS(CycleMethodHost);
+
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+
+  CycleMethodHost(sc_module_name name, ParallelSim& sim_)
+      : sc_module(name), clk("clk"), rst("rst"), sim(sim_) {
+    SC_METHOD(Tick);
+    sensitive << clk.pos();
+    dont_initialize();
+  }
+
+ protected:
+  ParallelSim& sim;
+
+  void Tick() {
+    if (!rst.read()) {
+      sim.Reset();
+    } else {
+      sim.Step();
+    }
+  }
+};
+
+/**
+ * \brief Connections::In for CycleProcesses clocked by CycleMethodHost
+ * \ingroup ParallelSim
+ *
+ * \tparam T      Message type
+ * \tparam Depth  Entries of the CycleChannel between the port and the process
+ *
+ * A thread pops messages from in while the channel has room, and the process
+ * takes them with PopNB() in Eval().  A message popped from in can be taken
+ * in the next cycle or the one after, depending on the order of the thread
+ * and the host at the clock edge.  The default Depth of 2 sustains one
+ * message per cycle.
+ */
+template <typename T, unsigned int Depth = 2>
+class MethodIn : public sc_module {
+  SC_HAS_PROCESS(MethodIn);
+
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  Connections::In<T> in;
+
+  MethodIn(sc_module_name name, ParallelSim& sim, int partition = -1)
+      : sc_module(name), clk("clk"), rst("rst"), in("in"), chan(sim, partition) {
+    SC_THREAD(Fill);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  bool PopNB(T& msg) { return chan.PopNB(msg); }
+  bool Empty() const { return chan.Empty(); }
+
+ protected:
+  CycleChannel<T, Depth> chan;
+
+  void Fill() {
+    in.Reset();
+    wait();
+    while (1) {
+      T msg;
+      if (!chan.Full() && in.PopNB(msg)) {
+        chan.PushNB(msg);
+      }
+      wait();
+    }
+  }
+};
+
+/**
+ * \brief Connections::Out for CycleProcesses clocked by CycleMethodHost
+ * \ingroup ParallelSim
+ *
+ * \tparam T      Message type
+ * \tparam Depth  Entries of the CycleChannel between the process and the port
+ *
+ * The process sends with PushNB() in Eval(), and a thread pushes the
+ * messages out in order, holding a message while out stalls.
+ */
+template <typename T, unsigned int Depth = 2>
+class MethodOut : public sc_module {
+  SC_HAS_PROCESS(MethodOut);
+
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  Connections::Out<T> out;
+
+  MethodOut(sc_module_name name, ParallelSim& sim, int partition = -1)
+      : sc_module(name), clk("clk"), rst("rst"), out("out"), chan(sim, partition) {
+    SC_THREAD(Drain);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  bool PushNB(const T& msg) { return chan.PushNB(msg); }
+  bool Full() const { return chan.Full(); }
+
+ protected:
+  CycleChannel<T, Depth> chan;
+
+  void Drain() {
+    out.Reset();
+    T msg;
+    bool held = false;
+    wait();
+    while (1) {
+      if (!held) {
+        held = chan.PopNB(msg);
+      }
+      if (held && out.PushNB(msg)) {
+        held = false;
+      }
+      wait();
+    }
+  }
+};
+
+}  // namespace match
+
+#endif  // NVHLS_CYCLE_METHOD_H
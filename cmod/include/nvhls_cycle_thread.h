@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_CYCLE_THREAD_H
+#define NVHLS_CYCLE_THREAD_H
+
+#include <nvhls_parallel_sim.h>
+
+namespace match {
+
+/**
+ * \brief A CycleProcess written in the style of an SC_THREAD, without a stack
+ * \ingroup ParallelSim
+ *
+ * \par Overview
+ * Every SC_THREAD owns a stack (64 KB by default with QuickThreads), and
+ * every wait() is a switch between stacks.  A CycleThread keeps the control
+ * flow of a thread body but runs it as a stackless coroutine: Eval() holds
+ * the body between NVHLS_CO_BEGIN and NVHLS_CO_END, and each wait point
+ * saves the line to resume from and returns.  The next Eval(), one cycle
+ * later, jumps back to that line.  A resume is one switch on an int, so
+ * thousands of CycleThreads cost no stacks and no thread switches; they run
+ * in ParallelSim::Run() or, clocked by CycleMethodHost, inside a SystemC
+ * simulation.
+ *
+ * The wait points are:
+ * - NVHLS_CO_WAIT(): resumes in the next cycle, like wait().
+ * - NVHLS_CO_PUSH(port, msg): retries PushNB() once per cycle until it
+ *   succeeds, like Push().
+ * - NVHLS_CO_POP(port, msg): retries PopNB() once per cycle until it
+ *   succeeds, like Pop().
+ *
+ * The ports are anything with PushNB()/PopNB(), i.e. CycleChannels and the
+ * MethodIn/MethodOut of CycleMethodHost.  Unlike Connections Push() and
+ * Pop(), NVHLS_CO_PUSH() and NVHLS_CO_POP() do not wait when they succeed
+ * at once, so a loop body needs an explicit NVHLS_CO_WAIT().
+ *
+ * As in an SC_THREAD, the code before the first wait point is the reset
+ * section: Reset() rewinds the body and runs it up to that point.
+ *
+ * \par Restrictions
+ * The body is re-entered through a switch statement, so:
+ * - Local variables of Eval() do not survive a wait point; state that lives
+ *   across one must be a member.
+ * - Wait points cannot be inside a switch statement of the body, and at
+ *   most one wait point may be on a source line.
+ * - Code after NVHLS_CO_END runs on every call; a body that leaves its
+ *   loop ends the thread, and later calls do nothing until Reset().
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_cycle_thread.h>
+ *
+ *      class Stage : public match::CycleThread {
+ *       public:
+ *        Stage(In& in_, Out& out_) : in(in_), out(out_) {}
+ *
+ *        void Eval() {
+ *          NVHLS_CO_BEGIN;
+ *          count = 0;                  // reset section
+ *          NVHLS_CO_WAIT();
+ *          while (1) {
+ *            NVHLS_CO_POP(in, reg);
+ *            count++;
+ *            NVHLS_CO_PUSH(out, reg);
+ *            NVHLS_CO_WAIT();
+ *          }
+ *          NVHLS_CO_END;
+ *        }
+ *
+ *       private:
+ *        In& in;
+ *        Out& out;
+ *        Msg reg;                      // lives across wait points
+ *        unsigned int count;
+ *      };
+ * \endcode
+ * \par
+ *
+ */
+class CycleThread : public CycleProcess {
+ public:
+  CycleThread() : co_line_(0) {}
+
+  void Reset() {
+    co_line_ = 0;
+    Eval();
+  }
+
+  // True once the body has left NVHLS_CO_END
+  bool Done() const { return co_line_ < 0; }
+
+ protected:
+  // Line of the wait point to resume from; 0 before the body, -1 after it
+  int co_line_;
+};
+
+}  // namespace match
+
+/**
+ * \brief NVHLS_CO_BEGIN define: Start of the body of a CycleThread.
+ * \ingroup ParallelSim
+ */
+#define NVHLS_CO_BEGIN       \
+  switch (this->co_line_) {  \
+    case 0:
+
+/**
+ * \brief NVHLS_CO_END define: End of the body of a CycleThread.
+ * \ingroup ParallelSim
+ */
+#define NVHLS_CO_END         \
+  this->co_line_ = -1;       \
+  default:;                  \
+  }
+
+/**
+ * \brief NVHLS_CO_WAIT define: Resume the CycleThread in the next cycle.
+ * \ingroup ParallelSim
+ */
+#define NVHLS_CO_WAIT()          \
+  do {                           \
+    this->co_line_ = __LINE__;   \
+    return;                      \
+    case __LINE__:;              \
+  } while (0)
+
+/**
+ * \brief NVHLS_CO_PUSH define: Push msg to port, waiting for cycles in which it is full.
+ * \ingroup ParallelSim
+ */
+#define NVHLS_CO_PUSH(port, msg)           \
+  do {                                     \
+    this->co_line_ = __LINE__;             \
+    case __LINE__:                         \
+      if (!(port).PushNB(msg)) return;     \
+  } while (0)
+
+/**
+ * \brief NVHLS_CO_POP define: Pop msg from port, waiting for cycles in which it is empty.
+ * \ingroup ParallelSim
+ */
+#define NVHLS_CO_POP(port, msg)            \
+  do {                                     \
+    this->co_line_ = __LINE__;             \
+    case __LINE__:                         \
+      if (!(port).PopNB(msg)) return;      \
+  } while (0)
+
+#endif  // NVHLS_CYCLE_THREAD_H
@@ -0,0 +1,537 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_DIVSQRT_H
+#define NVHLS_DIVSQRT_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_marshaller.h>
+#ifndef __SYNTHESIS__
+#include <cmath>
+#endif
+
+namespace nvhls {
+
+// C++ simulation computes results that fit in 64 bits on host integers; the
+// iterations are then skipped and the pipelines only carry the results. For
+// synthesis the iterations are always built.
+#ifndef __SYNTHESIS__
+static const bool divsqrt_host_model = true;
+#else
+static const bool divsqrt_host_model = false;
+#endif
+
+/**
+ * \brief State of a restoring division between iterations
+ * \ingroup nvhls_int
+ *
+ * Each iteration shifts the top bit of quo into the partial remainder rem,
+ * subtracts den if it fits and shifts the quotient bit into quo, so after
+ * QW iterations quo holds the quotient and rem the remainder. Host is set if
+ * the C++ model computes the final state when the state is initialized.
+ */
+template <unsigned int W, unsigned int QW, bool HostModel>
+struct div_state {
+  static const bool Host = HostModel;
+  typename nvhls_t<W>::nvuint_t rem;
+  typename nvhls_t<QW>::nvuint_t quo;
+  typename nvhls_t<W>::nvuint_t den;
+};
+
+/**
+ * \brief State of a digit-by-digit square root between iterations
+ * \ingroup nvhls_int
+ *
+ * XW is the radicand width rounded up to even. Each iteration brings the top
+ * two bits of x into the partial remainder and appends one bit to root.
+ */
+template <unsigned int XW, bool HostModel>
+struct sqrt_state {
+  static const bool Host = HostModel;
+  static const unsigned int RW = XW / 2;
+  typename nvhls_t<RW + 2>::nvuint_t rem;
+  typename nvhls_t<RW>::nvuint_t root;
+  typename nvhls_t<XW>::nvuint_t x;
+};
+
+// Applies iterations [lo, hi) of a restoring division
+template <unsigned int W, unsigned int QW, bool Host>
+void div_stages(div_state<W, QW, Host>& s, unsigned int lo, unsigned int hi) {
+  if (Host)
+    return;
+  typedef typename nvhls_t<W + 1>::nvuint_t ext_t;
+#pragma hls_unroll yes
+  for (unsigned int k = 0; k < QW; k++) {
+    if ((k >= lo) && (k < hi)) {
+      ext_t r = s.rem;
+      r = r << 1;
+      bool in_bit = (s.quo[QW - 1] == 1);
+      r[0] = in_bit;
+      bool fits = (r >= s.den);
+      if (fits) {
+        r = r - s.den;
+      }
+      s.rem = r;
+      s.quo = s.quo << 1;
+      s.quo[0] = fits;
+    }
+  }
+}
+
+// Applies iterations [lo, hi) of a square root
+template <unsigned int XW, bool Host>
+void sqrt_stages(sqrt_state<XW, Host>& s, unsigned int lo, unsigned int hi) {
+  static const unsigned int RW = XW / 2;
+  if (Host)
+    return;
+  typedef typename nvhls_t<RW + 3>::nvuint_t ext_t;
+#pragma hls_unroll yes
+  for (unsigned int k = 0; k < RW; k++) {
+    if ((k >= lo) && (k < hi)) {
+      ext_t r = s.rem;
+      r = r << 2;
+      bool hi_bit = (s.x[XW - 1] == 1);
+      bool lo_bit = (s.x[XW - 2] == 1);
+      r[1] = hi_bit;
+      r[0] = lo_bit;
+      ext_t trial = s.root;
+      trial = trial << 2;
+      trial[0] = 1;
+      bool fits = (r >= trial);
+      if (fits) {
+        r = r - trial;
+      }
+      s.rem = r;
+      s.root = s.root << 1;
+      s.root[0] = fits;
+      s.x = s.x << 2;
+    }
+  }
+}
+
+template <unsigned int W, bool Host, typename type>
+div_state<W, W, Host> divide_init(type num, type den) {
+  div_state<W, W, Host> s;
+  s.den = den;
+#ifndef __SYNTHESIS__
+  if (Host) {
+    typename nvhls_t<W>::nvuint_t n = num;
+    unsigned long long n64 = n.to_uint64();
+    unsigned long long d64 = s.den.to_uint64();
+    // A zero divisor gives an all-ones quotient and the dividend as the
+    // remainder, as the iterations do
+    unsigned long long ones = (W >= 64) ? ~0ULL : ((1ULL << W) - 1);
+    s.quo = (d64 == 0) ? ones : (n64 / d64);
+    s.rem = (d64 == 0) ? n64 : (n64 % d64);
+    return s;
+  }
+#endif
+  s.rem = 0;
+  s.quo = num;
+  return s;
+}
+
+template <unsigned int W, unsigned int QW, bool Host, typename type>
+div_state<W, QW, Host> reciprocal_init(type X) {
+  div_state<W, QW, Host> s;
+  s.den = X;
+#ifndef __SYNTHESIS__
+  if (Host) {
+    unsigned long long x64 = s.den.to_uint64();
+    unsigned long long n64 = 1ULL << (Host ? (W + QW - 2) : 0);
+    s.quo = n64 / x64;
+    s.rem = n64 % x64;
+    return s;
+  }
+#endif
+  // The numerator is 2^(W + QW - 2): its bits above the quotient are the
+  // initial remainder, the ones below are zero
+  s.rem = 0;
+  s.rem[W - 2] = 1;
+  s.quo = 0;
+  return s;
+}
+
+template <unsigned int XW, bool Host, typename type>
+sqrt_state<XW, Host> sqrt_init(type X) {
+  static const unsigned int RW = XW / 2;
+  sqrt_state<XW, Host> s;
+  s.x = X;
+#ifndef __SYNTHESIS__
+  if (Host) {
+    unsigned long long x64 = s.x.to_uint64();
+    unsigned long long r = static_cast<unsigned long long>(std::sqrt(static_cast<double>(x64)));
+    while (static_cast<unsigned __int128>(r) * r > x64)
+      r--;
+    while (static_cast<unsigned __int128>(r + 1) * (r + 1) <= x64)
+      r++;
+    s.root = r;
+    s.rem = x64 - r * r;
+    return s;
+  }
+#endif
+  s.rem = 0;
+  s.root = 0;
+  return s;
+}
+
+// Iteration counts and state types of the units. The host model is used if
+// the numerator fits in 64 bits.
+template <typename type>
+struct divide_traits {
+  static const unsigned int W = Wrapped<type>::width;
+  static const unsigned int Iterations = W;
+  typedef div_state<W, W, divsqrt_host_model && (W <= 64)> state_t;
+};
+
+template <typename type, unsigned int OutW>
+struct reciprocal_traits {
+  static const unsigned int W = Wrapped<type>::width;
+  static const unsigned int QW = OutW + 1;
+  static const unsigned int Iterations = QW;
+  typedef typename nvhls_t<QW>::nvuint_t out_t;
+  typedef div_state<W, QW, divsqrt_host_model && (W + QW <= 65)> state_t;
+};
+
+template <typename type>
+struct sqrt_traits {
+  static const unsigned int W = Wrapped<type>::width;
+  static const unsigned int XW = W + (W & 1);
+  static const unsigned int Iterations = XW / 2;
+  typedef typename nvhls_t<XW / 2>::nvuint_t out_t;
+  typedef sqrt_state<XW, divsqrt_host_model && (XW <= 64)> state_t;
+};
+
+/**
+ * \brief Unsigned integer division
+ * \ingroup nvhls_int
+ *
+ * \tparam type                 Datatype, nvuint type of W bits
+ *
+ * \param[in]  num             Dividend
+ * \param[in]  den             Divisor
+ * \param[out] quo             Quotient, num / den
+ * \param[out] rem             Remainder, num % den
+ *
+ * \par Overview
+ * - Restoring division, one quotient bit per iteration: W iterations of a W-bit compare and subtract. Use PipelinedDivide to register between iterations.
+ * - A zero divisor gives an all-ones quotient and num as the remainder.
+ * - C++ simulation uses host integer division for W <= 64; the results are identical.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_divsqrt.h>
+ *
+ *      ...
+ *      NVUINT16 quo, rem;
+ *      nvhls::divide<NVUINT16>(1000, 7, quo, rem); // 142, 6
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename type>
+void divide(type num, type den, type& quo, type& rem) {
+  typedef divide_traits<type> T;
+  typename T::state_t s = divide_init<T::W, T::state_t::Host>(num, den);
+  div_stages(s, 0, T::Iterations);
+  quo = s.quo;
+  rem = s.rem;
+}
+
+/**
+ * \brief Fixed-point reciprocal
+ * \ingroup nvhls_int
+ *
+ * \tparam OutW                 Number of fraction bits of the result
+ * \tparam type                 Datatype, nvuint type of W >= 2 bits
+ *
+ * \param[in]  X               Value in [1, 2) with W-1 fraction bits, i.e. its top bit is set
+ * \param[out] ReturnVal       floor(2^OutW / X) with OutW fraction bits, in (0.5, 1]
+ *
+ * \par Overview
+ * - Restoring division of 2^(W-1+OutW) by X, OutW+1 iterations. Use PipelinedReciprocal to register between iterations.
+ * - X should be normalized first, e.g. with nvhls::normalize(); the result of an X whose top bit is clear is unspecified.
+ * - C++ simulation uses host integer division for W + OutW <= 64.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_divsqrt.h>
+ *
+ *      ...
+ *      NVUINT8 X = 192; // 1.5
+ *      NVUINT17 R = nvhls::reciprocal<16, NVUINT8>(X); // 43690, i.e. 0.6667
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <unsigned int OutW, typename type>
+typename reciprocal_traits<type, OutW>::out_t reciprocal(type X) {
+  typedef reciprocal_traits<type, OutW> T;
+  typename T::state_t s = reciprocal_init<T::W, T::QW, T::state_t::Host>(X);
+  div_stages(s, 0, T::Iterations);
+  return s.quo;
+}
+
+/**
+ * \brief Integer square root
+ * \ingroup nvhls_int
+ *
+ * \tparam type                 Datatype, nvuint type of W bits
+ *
+ * \param[in]  X               Radicand
+ * \param[out] ReturnVal       floor(sqrt(X)), of ceil(W/2) bits
+ *
+ * \par Overview
+ * - Digit-by-digit (restoring) square root, one result bit per iteration: ceil(W/2) iterations. Use PipelinedSquareRoot to register between iterations.
+ * - For a fixed-point X with an even number F of fraction bits the result has F/2 fraction bits.
+ * - C++ simulation computes the root on the host for W <= 64.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_divsqrt.h>
+ *
+ *      ...
+ *      NVUINT16 X = 1000;
+ *      NVUINT8 R = nvhls::square_root<NVUINT16>(X); // 31
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename type>
+typename sqrt_traits<type>::out_t square_root(type X) {
+  typedef sqrt_traits<type> T;
+  typename T::state_t s = sqrt_init<T::XW, T::state_t::Host>(X);
+  sqrt_stages(s, 0, T::Iterations);
+  return s.root;
+}
+
+/**
+ * \brief Pipelined unsigned integer division
+ * \ingroup nvhls_int
+ *
+ * \tparam type                 Datatype, nvuint type of W bits
+ * \tparam IterationsPerCycle   Number of division iterations between pipeline registers
+ *
+ * \par Overview
+ * - Each call of run() is one cycle and accepts a new input, i.e. II=1. The result of an input appears Latency calls later, with Latency = ceil(W / IterationsPerCycle) - 1, and is identical to divide().
+ * - IterationsPerCycle trades latency against the delay of a stage: 2 iterations per cycle retire two quotient bits per cycle, like a radix-4 divider.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_divsqrt.h>
+ *
+ *      ...
+ *      nvhls::PipelinedDivide<NVUINT32, 4> divider;
+ *      ...
+ *      bool out_valid = divider.run(in_valid, num, den, quo, rem);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename type, unsigned int IterationsPerCycle>
+class PipelinedDivide {
+  typedef divide_traits<type> T;
+  typedef typename T::state_t state_t;
+
+ public:
+  static const unsigned int NumGroups =
+      (T::Iterations + IterationsPerCycle - 1) / IterationsPerCycle;
+  static const unsigned int Latency = NumGroups - 1;
+
+ private:
+  static const unsigned int NumRegs = (Latency > 0) ? Latency : 1;
+  state_t regs[NumRegs];
+  bool regs_valid[NumRegs];
+
+ public:
+  PipelinedDivide() { reset(); }
+
+  void reset() {
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumRegs; i++) {
+      regs_valid[i] = false;
+    }
+  }
+
+  // Returns true if quo and rem hold a valid result in this cycle
+  bool run(bool in_valid, type num, type den, type& quo, type& rem) {
+    bool out_valid = false;
+#pragma hls_unroll yes
+    for (int g = NumGroups - 1; g >= 0; g--) {
+      state_t s;
+      bool valid;
+      if (g == 0) {
+        s = divide_init<T::W, state_t::Host>(num, den);
+        valid = in_valid;
+      } else {
+        s = regs[g - 1];
+        valid = regs_valid[g - 1];
+      }
+      div_stages(s, g * IterationsPerCycle, (g + 1) * IterationsPerCycle);
+      if (g == static_cast<int>(NumGroups) - 1) {
+        quo = s.quo;
+        rem = s.rem;
+        out_valid = valid;
+      } else {
+        regs[g] = s;
+        regs_valid[g] = valid;
+      }
+    }
+    return out_valid;
+  }
+};
+
+/**
+ * \brief Pipelined fixed-point reciprocal
+ * \ingroup nvhls_int
+ *
+ * \tparam type                 Datatype, nvuint type of W >= 2 bits
+ * \tparam OutW                 Number of fraction bits of the result
+ * \tparam IterationsPerCycle   Number of division iterations between pipeline registers
+ *
+ * \par Overview
+ * - II=1; the result of an input appears Latency calls of run() later, with Latency = ceil((OutW + 1) / IterationsPerCycle) - 1, and is identical to reciprocal().
+ *
+ */
+template <typename type, unsigned int OutW, unsigned int IterationsPerCycle>
+class PipelinedReciprocal {
+  typedef reciprocal_traits<type, OutW> T;
+  typedef typename T::state_t state_t;
+
+ public:
+  typedef typename T::out_t out_t;
+  static const unsigned int NumGroups =
+      (T::Iterations + IterationsPerCycle - 1) / IterationsPerCycle;
+  static const unsigned int Latency = NumGroups - 1;
+
+ private:
+  static const unsigned int NumRegs = (Latency > 0) ? Latency : 1;
+  state_t regs[NumRegs];
+  bool regs_valid[NumRegs];
+
+ public:
+  PipelinedReciprocal() { reset(); }
+
+  void reset() {
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumRegs; i++) {
+      regs_valid[i] = false;
+    }
+  }
+
+  // Returns true if out holds a valid result in this cycle
+  bool run(bool in_valid, type X, out_t& out) {
+    bool out_valid = false;
+#pragma hls_unroll yes
+    for (int g = NumGroups - 1; g >= 0; g--) {
+      state_t s;
+      bool valid;
+      if (g == 0) {
+        s = reciprocal_init<T::W, T::QW, state_t::Host>(X);
+        valid = in_valid;
+      } else {
+        s = regs[g - 1];
+        valid = regs_valid[g - 1];
+      }
+      div_stages(s, g * IterationsPerCycle, (g + 1) * IterationsPerCycle);
+      if (g == static_cast<int>(NumGroups) - 1) {
+        out = s.quo;
+        out_valid = valid;
+      } else {
+        regs[g] = s;
+        regs_valid[g] = valid;
+      }
+    }
+    return out_valid;
+  }
+};
+
+/**
+ * \brief Pipelined integer square root
+ * \ingroup nvhls_int
+ *
+ * \tparam type                 Datatype, nvuint type of W bits
+ * \tparam IterationsPerCycle   Number of square-root iterations between pipeline registers
+ *
+ * \par Overview
+ * - II=1; the result of an input appears Latency calls of run() later, with Latency = ceil(ceil(W / 2) / IterationsPerCycle) - 1, and is identical to square_root().
+ *
+ */
+template <typename type, unsigned int IterationsPerCycle>
+class PipelinedSquareRoot {
+  typedef sqrt_traits<type> T;
+  typedef typename T::state_t state_t;
+
+ public:
+  typedef typename T::out_t out_t;
+  static const unsigned int NumGroups =
+      (T::Iterations + IterationsPerCycle - 1) / IterationsPerCycle;
+  static const unsigned int Latency = NumGroups - 1;
+
+ private:
+  static const unsigned int NumRegs = (Latency > 0) ? Latency : 1;
+  state_t regs[NumRegs];
+  bool regs_valid[NumRegs];
+
+ public:
+  PipelinedSquareRoot() { reset(); }
+
+  void reset() {
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumRegs; i++) {
+      regs_valid[i] = false;
+    }
+  }
+
+  // Returns true if out holds a valid result in this cycle
+  bool run(bool in_valid, type X, out_t& out) {
+    bool out_valid = false;
+#pragma hls_unroll yes
+    for (int g = NumGroups - 1; g >= 0; g--) {
+      state_t s;
+      bool valid;
+      if (g == 0) {
+        s = sqrt_init<T::XW, state_t::Host>(X);
+        valid = in_valid;
+      } else {
+        s = regs[g - 1];
+        valid = regs_valid[g - 1];
+      }
+      sqrt_stages(s, g * IterationsPerCycle, (g + 1) * IterationsPerCycle);
+      if (g == static_cast<int>(NumGroups) - 1) {
+        out = s.root;
+        out_valid = valid;
+      } else {
+        regs[g] = s;
+        regs_valid[g] = valid;
+      }
+    }
+    return out_valid;
+  }
+};
+
+}  // namespace nvhls
+
+#endif
@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_ENERGY_H
+#define NVHLS_ENERGY_H
+
+#include <systemc.h>
+#ifndef __SYNTHESIS__
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <rapidjson/document.h>
+#endif
+
+namespace match {
+
+#ifndef __SYNTHESIS__
+/**
+ * \brief Activity-based dynamic energy estimate of a simulation
+ * \ingroup nvhls_module
+ *
+ * \par Overview
+ * - Opt-in at run time: nothing is counted until a coefficient table is loaded with Load() or named by the NVHLS_ENERGY environment variable, and every hook only checks Enabled() until then.
+ * - The table is a JSON object from component name to its energy in pJ, either a number (per operation) or {"op": pJ per operation, "bit": pJ per bit}. Components missing from the table count operations at zero energy.
+ * - The components are "fifo.push", "fifo.pop" (FIFO, including incrHead() and the *_all() calls per bank), "mem_array_sep.read" and "mem_array_sep.write" (per word of WordWidth bits), "crossbar" (per valid output lane) and "channel.transfer" (per message through a Connections buffered channel).
+ * - Each event is charged to the match::Module that contains the process it happens in, or to "unowned" outside of any Module. Module::DumpStats() prints the energy of each Module as the counters energy_fJ and energy_fJ.<component>, so sub-totals add up the energy of a subtree.
+ * - Report() prints the operations and energy per component; comparing its output between SIM_MODE runs shows where the estimates of the views differ.
+ * - FIFOs built on mem_array_sep (FIFO_SIM_USE_MEM_ARRAY) count both their FIFO and their memory accesses.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_energy.h>
+ *
+ *      ...
+ *      // energy.json: {"fifo.push": {"op": 0.5, "bit": 0.02}, "mem_array_sep.read": 4.0}
+ *      match::Energy::Get().Load("energy.json");
+ *      sc_start();
+ *      top.DumpStats(std::cout, 0, NULL);
+ *      match::Energy::Get().Report(std::cout);
+ *
+ * \endcode
+ * \par
+ *
+ */
+class Energy {
+ public:
+  static Energy& Get() {
+    static Energy energy;
+    return energy;
+  }
+
+  bool Enabled() const { return enabled_; }
+
+  // Loads a coefficient table and enables counting. Returns false, and leaves
+  // counting as it was, if the file cannot be read or parsed.
+  bool Load(const std::string& filename) {
+    std::ifstream file(filename.c_str());
+    if (!file)
+      return false;
+    std::stringstream text;
+    text << file.rdbuf();
+    rapidjson::Document doc;
+    doc.Parse(text.str().c_str());
+    if (doc.HasParseError() || !doc.IsObject())
+      return false;
+    for (rapidjson::Value::ConstMemberIterator it = doc.MemberBegin();
+         it != doc.MemberEnd(); ++it) {
+      const rapidjson::Value& v = it->value;
+      double op_pj = 0, bit_pj = 0;
+      if (v.IsNumber()) {
+        op_pj = v.GetDouble();
+      } else if (v.IsObject()) {
+        if (v.HasMember("op") && v["op"].IsNumber())
+          op_pj = v["op"].GetDouble();
+        if (v.HasMember("bit") && v["bit"].IsNumber())
+          bit_pj = v["bit"].GetDouble();
+      } else {
+        return false;
+      }
+      SetCost(it->name.GetString(), op_pj, bit_pj);
+    }
+    return true;
+  }
+
+  // Sets the energy of one component and enables counting.
+  void SetCost(const std::string& component, double op_pj, double bit_pj = 0) {
+    unsigned int id = Id(component);
+    op_fj_[id] = op_pj * 1000;
+    bit_fj_[id] = bit_pj * 1000;
+    enabled_ = true;
+  }
+
+  // Returns the id of a component, used by Record().
+  unsigned int Id(const std::string& component) {
+    std::map<std::string, unsigned int>::iterator it = ids_.find(component);
+    if (it != ids_.end())
+      return it->second;
+    unsigned int id = names_.size();
+    ids_[component] = id;
+    names_.push_back(component);
+    op_fj_.push_back(0);
+    bit_fj_.push_back(0);
+    return id;
+  }
+
+  // Charges count operations of bits each to the Module of the running
+  // process.
+  void Record(unsigned int id, unsigned int bits, unsigned int count = 1) {
+    Account& acct = CurrentAccount();
+    if (acct.ops.size() <= id) {
+      acct.ops.resize(names_.size(), 0);
+      acct.fj.resize(names_.size(), 0);
+    }
+    acct.ops[id] += count;
+    acct.fj[id] += count * (op_fj_[id] + bit_fj_[id] * bits);
+  }
+
+  // Appends (energy_fJ[.<component>], fJ) of owner to out; nothing if owner
+  // has no energy.
+  void OwnerStats(const sc_object* owner,
+                  std::vector<std::pair<std::string, uint64> >& out) const {
+    std::map<const sc_object*, Account>::const_iterator it = accounts_.find(owner);
+    if (it == accounts_.end())
+      return;
+    double total = 0;
+    for (unsigned int i = 0; i < it->second.fj.size(); i++) {
+      if (it->second.ops[i] == 0)
+        continue;
+      out.push_back(std::make_pair("energy_fJ." + names_[i], Round(it->second.fj[i])));
+      total += it->second.fj[i];
+    }
+    out.push_back(std::make_pair(std::string("energy_fJ"), Round(total)));
+  }
+
+  bool HasEnergy(const sc_object* owner) const {
+    return accounts_.find(owner) != accounts_.end();
+  }
+
+  // Prints operations and energy per component, then per owner.
+  void Report(std::ostream& ofile) const {
+    std::vector<uint64> ops(names_.size(), 0);
+    std::vector<double> fj(names_.size(), 0);
+    double total = 0;
+    for (std::map<const sc_object*, Account>::const_iterator it = accounts_.begin();
+         it != accounts_.end(); it++) {
+      for (unsigned int i = 0; i < it->second.ops.size(); i++) {
+        ops[i] += it->second.ops[i];
+        fj[i] += it->second.fj[i];
+        total += it->second.fj[i];
+      }
+    }
+    ofile << "Energy by component (total " << std::fixed << std::setprecision(3)
+          << total / 1000 << " pJ):" << std::endl;
+    ofile << std::setw(24) << std::left << "  component" << std::right << std::setw(12)
+          << "ops" << std::setw(16) << "pJ" << std::setw(12) << "pJ/op" << std::endl;
+    for (unsigned int i = 0; i < names_.size(); i++) {
+      if (ops[i] == 0)
+        continue;
+      ofile << "  " << std::setw(22) << std::left << names_[i] << std::right
+            << std::setw(12) << ops[i] << std::setw(16) << fj[i] / 1000 << std::setw(12)
+            << fj[i] / 1000 / ops[i] << std::endl;
+    }
+    ofile << "Energy by module:" << std::endl;
+    for (std::map<const sc_object*, Account>::const_iterator it = accounts_.begin();
+         it != accounts_.end(); it++) {
+      double sum = 0;
+      for (unsigned int i = 0; i < it->second.fj.size(); i++)
+        sum += it->second.fj[i];
+      ofile << "  " << (it->first ? it->first->name() : "unowned") << ": " << sum / 1000
+            << " pJ" << std::endl;
+    }
+    ofile.unsetf(std::ios::floatfield);
+  }
+
+  // Clears the counted energy; the table stays loaded.
+  void Reset() {
+    accounts_.clear();
+    owners_.clear();
+    last_process_ = NULL;
+    last_account_ = NULL;
+  }
+
+ private:
+  struct Account {
+    std::vector<uint64> ops;
+    std::vector<double> fj;
+  };
+
+  bool enabled_;
+  std::map<std::string, unsigned int> ids_;
+  std::vector<std::string> names_;
+  std::vector<double> op_fj_, bit_fj_;
+  // Energy per owning Module (NULL: unowned)
+  std::map<const sc_object*, Account> accounts_;
+  // Account of each process seen so far, and of the last one
+  std::map<const sc_object*, Account*> owners_;
+  const sc_object* last_process_;
+  Account* last_account_;
+
+  Energy() : enabled_(false), last_process_(NULL), last_account_(NULL) {
+    const char* filename = std::getenv("NVHLS_ENERGY");
+    if (filename != NULL && *filename != '\0' && !Load(filename))
+      std::cerr << "NVHLS_ENERGY: cannot load " << filename << std::endl;
+  }
+
+  static uint64 Round(double fj) { return static_cast<uint64>(fj + 0.5); }
+
+  Account& CurrentAccount() {
+    sc_process_handle handle = sc_get_current_process_handle();
+    const sc_object* process = handle.valid() ? handle.get_process_object() : NULL;
+    if (last_account_ != NULL && process == last_process_)
+      return *last_account_;
+    std::map<const sc_object*, Account*>::iterator it = owners_.find(process);
+    if (it == owners_.end()) {
+      // The first match::Module above the process
+      const sc_object* owner = process ? process->get_parent_object() : NULL;
+      while (owner != NULL &&
+             const_cast<sc_object*>(owner)->get_attribute("match_module") == NULL)
+        owner = owner->get_parent_object();
+      it = owners_.insert(std::make_pair(process, &accounts_[owner])).first;
+    }
+    last_process_ = process;
+    last_account_ = it->second;
+    return *last_account_;
+  }
+};
+#endif
+
+}  // namespace match
+
+/**
+ * \brief Charges one operation of bits bits of component to the energy estimate
+ * \ingroup nvhls_module
+ *
+ * component must be a string literal or otherwise constant per call site: its
+ * id is looked up once. Compiles to nothing for synthesis.
+ */
+#ifndef __SYNTHESIS__
+#define NVHLS_ENERGY(component, bits)                                        \
+  do {                                                                       \
+    if (match::Energy::Get().Enabled()) {                                    \
+      static const unsigned int nvhls_energy_id = match::Energy::Get().Id(component); \
+      match::Energy::Get().Record(nvhls_energy_id, bits);                    \
+    }                                                                        \
+  } while (0)
+#else
+#define NVHLS_ENERGY(component, bits) do {} while (0)
+#endif
+
+#endif  // NVHLS_ENERGY_H
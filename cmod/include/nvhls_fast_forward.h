@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_FAST_FORWARD_H
+#define NVHLS_FAST_FORWARD_H
+
+#include <systemc.h>
+#ifndef __SYNTHESIS__
+#include <iomanip>
+#include <iostream>
+#endif
+
+namespace match {
+
+#ifndef __SYNTHESIS__
+/**
+ * \brief Global activity tracker of the Connections buffered channels and ports
+ * \ingroup nvhls_module
+ *
+ * \par Overview
+ * - Bypass, Pipeline, SkidBuffer, BypassBuffered and Buffer call MarkActive() in every cycle in which they hold a message or see a valid one on either side; InBuffered and OutBuffered call it from TransferNB() while their buffer holds a message or one is popped. C++ simulation only.
+ * - Other blocks call MarkActive() themselves in cycles in which they make progress without using these channels.
+ * - A block that must see every clock edge even while nothing moves, e.g. because it counts cycles, holds the tracker with Hold() and releases it with Release().
+ * - FastForwardClock reads the activity counter once per cycle and skips cycles in which the design is quiescent; Report() prints how many.
+ */
+class Quiescence {
+ public:
+  static Quiescence& Get() {
+    static Quiescence tracker;
+    return tracker;
+  }
+
+  void MarkActive() { activity_++; }
+  void Hold() { holds_++; }
+  void Release() { holds_--; }
+
+  uint64 Activity() const { return activity_; }
+  bool Held() const { return holds_ > 0; }
+
+  // Called by FastForwardClock
+  void CountCycles(uint64 ticked, uint64 skipped) {
+    ticked_cycles += ticked;
+    skipped_cycles += skipped;
+    skips += (skipped != 0);
+  }
+
+  void Report(std::ostream& ofile) {
+    uint64 total = ticked_cycles + skipped_cycles;
+    ofile << "Fast-forward: " << std::dec << skipped_cycles << " of " << total
+          << " cycles skipped in " << skips << " skips (" << std::fixed
+          << std::setprecision(1)
+          << (total ? 100.0 * skipped_cycles / total : 0.0) << "%)" << std::endl;
+    ofile.unsetf(std::ios::floatfield);
+  }
+
+  // Stats
+  uint64 ticked_cycles, skipped_cycles, skips;
+
+ private:
+  uint64 activity_;
+  int holds_;
+
+  Quiescence()
+      : ticked_cycles(0), skipped_cycles(0), skips(0), activity_(0), holds_(0) {}
+};
+
+/**
+ * \brief A clock that skips the cycles in which the design is quiescent
+ * \ingroup nvhls_module
+ *
+ * \par Overview
+ * FastForwardClock drives clk like an sc_clock with a 50% duty cycle that
+ * starts low.  Before each rising edge it checks the Quiescence tracker: when
+ * nothing was active and nothing held the tracker for idle_cycles cycles in a
+ * row, every channel is empty and every block is waiting for a message, so
+ * the next edges would change nothing.  The clock then stays low until the
+ * cycle of the next timed event of the simulation, e.g. a wait(time) of a
+ * timer or of an external model, and skips all cycles before it in one step.
+ * If no event is pending at all, the clock stops and sc_start() returns, as
+ * the design can never become active again.
+ *
+ * \par Usage Guidelines
+ * - All blocks of the clock domain must see their activity through the Quiescence tracker (see Quiescence). Messages that only travel through Connections::Combinational channels are not seen.
+ * - Threads that count clock edges while the design is idle, e.g. a testbench that waits wait(n) cycles before sending, must Hold() the tracker or use timed waits.
+ * - Another sc_clock in the same simulation is a pending event on every edge and keeps cycles from being skipped.
+ * - clk is an sc_signal, not an sc_clock, so Connections ports in CONNECTIONS_ACCURATE_SIM mode, which look up the sc_clock that drives them, cannot use it.
+ * - Skipping can be turned off with SetEnabled(false), e.g. to compare both runs.
+ * - After a skip the clock ticks at least idle_cycles cycles again, so blocks woken by the event have time to become active.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_connections.h>
+ *
+ *      ...
+ *      match::FastForwardClock clk("clk", sc_time(1, SC_NS));
+ *      ...
+ *      dut.clk(clk.clk);
+ *      ...
+ *      sc_start();
+ *      match::Quiescence::Get().Report(std::cout);
+ *
+ * \endcode
+ * \par
+ *
+ */
+class FastForwardClock : public sc_module {
+  SC_HAS_PROCESS(FastForwardClock);
+
+ public:
+  sc_signal<bool> clk;
+
+  FastForwardClock(sc_module_name name, const sc_time& period_,
+                   unsigned int idle_cycles_ = 4)
+      : sc_module(name), clk("clk"), period(period_), idle_cycles(idle_cycles_),
+        enabled(true) {
+    SC_THREAD(Run);
+  }
+
+  void SetEnabled(bool enable) { enabled = enable; }
+  const sc_time& Period() const { return period; }
+
+ protected:
+  sc_time period;
+  unsigned int idle_cycles;
+  bool enabled;
+
+  void Run() {
+    Quiescence& tracker = Quiescence::Get();
+    sc_time half = period / 2;
+    uint64 last_activity = tracker.Activity();
+    unsigned int quiet = 0;
+    wait(half);
+    while (1) {
+      uint64 activity = tracker.Activity();
+      quiet = (activity == last_activity && !tracker.Held()) ? quiet + 1 : 0;
+      last_activity = activity;
+      if (enabled && quiet >= idle_cycles) {
+        sc_time next = sc_time_to_pending_activity();
+        if (next == sc_max_time() - sc_time_stamp()) {
+          return;  // nothing can wake the design up
+        }
+        // Whole cycles before the one in which the next event happens
+        uint64 skipped = static_cast<uint64>(next / period);
+        if (skipped > 0) {
+          wait(period * static_cast<double>(skipped));
+          tracker.CountCycles(0, skipped);
+          quiet = 0;
+        }
+      }
+      tracker.CountCycles(1, 0);
+      clk.write(true);
+      wait(half);
+      clk.write(false);
+      wait(half);
+    }
+  }
+};
+
+#endif
+
+}  // namespace match
+
+#endif  // NVHLS_FAST_FORWARD_H
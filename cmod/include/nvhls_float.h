@@ -0,0 +1,849 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_FLOAT_H
+#define NVHLS_FLOAT_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_marshaller.h>
+#include <nvhls_vector.h>
+#include <nvhls_mult.h>
+#ifndef __SYNTHESIS__
+#include <cstring>
+#endif
+
+namespace nvhls {
+
+/**
+ * \brief Binary floating-point format with E exponent and M mantissa bits
+ * \ingroup nvhls_float
+ *
+ * \tparam E                    Number of exponent bits, at least 2
+ * \tparam M                    Number of stored mantissa bits, at least 1
+ *
+ * \par Overview
+ * - Values are stored as bits_t, sign, exponent and mantissa from MSB to LSB, with the IEEE 754 encoding: bias 2^(E-1)-1, subnormals, infinities and NaNs.
+ * - All units round to nearest, ties to even, and return the canonical quiet NaN (sign 0, mantissa MSB set) for every NaN result. There are no exception flags.
+ * - native_float is true if C++ simulation can compute additions and products of the format with native float and round the result to the format bit-exactly: the format itself, or formats of at most 8 exponent and 10 mantissa bits, for which rounding twice is known to be innocuous.
+ * - Presets: fp32_format, bf16_format, fp16_format, fp8_e5m2_format and fp8_e4m3_format. fp8_e4m3_format uses the IEEE-style encoding, with infinities and 2^(E-1)-1 NaN codes per sign, not the OCP FP8 E4M3 encoding without infinities.
+ *
+ */
+template <unsigned int E, unsigned int M>
+struct float_format {
+  static const unsigned int exp_width = E;
+  static const unsigned int mant_width = M;
+  static const unsigned int width = 1 + E + M;
+  static const int bias = (1 << (E - 1)) - 1;
+  static const unsigned int exp_max = (1u << E) - 1;
+  static const bool native_float = (E <= 8) && ((M <= 10) || (M == 23 && E == 8));
+  typedef typename nvhls_t<width>::nvuint_t bits_t;
+  // Signed exponent of intermediate results, wide enough for the exponents
+  // of products and normalization shifts
+  static const unsigned int ExpW = E + nbits<2 * M + 8>::val + 1;
+  typedef typename nvhls_t<ExpW>::nvint_t exp_t;
+};
+
+typedef float_format<8, 23> fp32_format;
+typedef float_format<8, 7> bf16_format;
+typedef float_format<5, 10> fp16_format;
+typedef float_format<5, 2> fp8_e5m2_format;
+typedef float_format<4, 3> fp8_e4m3_format;
+
+// Fields of a value: sig holds the hidden bit at bit M, and exp is 1 for
+// subnormals and zeros, so that the value is sig * 2^(exp - bias - M)
+template <typename Fmt>
+struct fp_unpacked {
+  typedef typename nvhls_t<Fmt::mant_width + 1>::nvuint_t sig_t;
+  bool sign;
+  typename Fmt::exp_t exp;
+  sig_t sig;
+  bool zero, inf, nan;
+};
+
+template <typename Fmt>
+fp_unpacked<Fmt> fp_unpack(typename Fmt::bits_t x) {
+  static const unsigned int E = Fmt::exp_width;
+  static const unsigned int M = Fmt::mant_width;
+  fp_unpacked<Fmt> u;
+  typename nvhls_t<E>::nvuint_t e = nvhls::get_slc<E>(x, M);
+  typename nvhls_t<M>::nvuint_t f = nvhls::get_slc<M>(x, 0);
+  u.sign = (x[E + M] == 1);
+  u.sig = f;
+  u.sig[M] = (e != 0);
+  u.exp = (e == 0) ? typename Fmt::exp_t(1) : typename Fmt::exp_t(e);
+  u.zero = (e == 0) && (f == 0);
+  u.inf = (e == Fmt::exp_max) && (f == 0);
+  u.nan = (e == Fmt::exp_max) && (f != 0);
+  return u;
+}
+
+template <typename Fmt>
+typename Fmt::bits_t fp_inf(bool sign) {
+  typename Fmt::bits_t x = 0;
+  x = nvhls::set_slc(x, typename nvhls_t<Fmt::exp_width>::nvuint_t(Fmt::exp_max), Fmt::mant_width);
+  x[Fmt::width - 1] = sign;
+  return x;
+}
+
+template <typename Fmt>
+typename Fmt::bits_t fp_nan() {
+  typename Fmt::bits_t x = fp_inf<Fmt>(false);
+  x[Fmt::mant_width - 1] = 1;
+  return x;
+}
+
+// x >> s, with bit 0 set if any bit shifted out was set
+template <unsigned int W>
+typename nvhls_t<W>::nvuint_t fp_shift_right_sticky(typename nvhls_t<W>::nvuint_t x, unsigned int s) {
+  typename nvhls_t<W>::nvuint_t r = 0;
+  bool sticky;
+  if (s >= W) {
+    sticky = (x != 0);
+  } else {
+    r = x >> s;
+    typename nvhls_t<W>::nvuint_t back = r << s;
+    sticky = (back != x);
+  }
+  if (sticky) {
+    r[0] = 1;
+  }
+  return r;
+}
+
+// Shifts x left until its MSB is set and lowers exp by the shift; x = 0 is
+// left as it is
+template <unsigned int W, typename exp_type>
+void fp_normalize(typename nvhls_t<W>::nvuint_t& x, exp_type& exp) {
+  if (x != 0) {
+    unsigned int lz = nvhls::lzd(x);
+    x = x << lz;
+    exp = exp - lz;
+  }
+}
+
+/**
+ * \brief Rounds a normalized significand to a format
+ * \ingroup nvhls_float
+ *
+ * \tparam Fmt                  Result format
+ * \tparam W                    Width of x, at least M + 3
+ *
+ * \param[in]  sign            Sign of the result
+ * \param[in]  exp             Exponent: the MSB of x has the weight 2^(exp - bias)
+ * \param[in]  x               Significand with its MSB set, or 0 for a zero result
+ * \param[out] ReturnVal       Value rounded to nearest even, with subnormal and infinite results
+ *
+ */
+template <typename Fmt, unsigned int W, typename exp_type>
+typename Fmt::bits_t fp_round_pack(bool sign, exp_type exp, typename nvhls_t<W>::nvuint_t x) {
+  static const unsigned int E = Fmt::exp_width;
+  static const unsigned int M = Fmt::mant_width;
+  typename Fmt::bits_t out = 0;
+  out[E + M] = sign;
+  if (x == 0) {
+    return out;
+  }
+  if (exp < 1) {
+    // Subnormal: align to the exponent of the smallest normal
+    exp_type under = 1 - exp;
+    unsigned int shift = (under > exp_type(W)) ? W : static_cast<unsigned int>(under.to_uint());
+    x = fp_shift_right_sticky<W>(x, shift);
+    exp = 1;
+  }
+  typename nvhls_t<M + 2>::nvuint_t mant = nvhls::get_slc<M + 1>(x, W - M - 1);
+  bool half = (x[W - M - 2] == 1);
+  typename nvhls_t<W - M - 2>::nvuint_t below = nvhls::get_slc<W - M - 2>(x, 0);
+  bool round_up = half && ((below != 0) || (mant[0] == 1));
+  if (round_up) {
+    mant = mant + 1;
+  }
+  if (mant[M + 1] == 1) {
+    mant = mant >> 1;
+    exp = exp + 1;
+  }
+  if (exp >= exp_type(Fmt::exp_max)) {
+    return fp_inf<Fmt>(sign);
+  }
+  typename nvhls_t<E>::nvuint_t e = 0;
+  if (mant[M] == 1) {
+    e = exp.to_uint();
+  }
+  out = nvhls::set_slc(out, e, M);
+  out = nvhls::set_slc(out, typename nvhls_t<M>::nvuint_t(mant), 0);
+  return out;
+}
+
+/**
+ * \brief Converts a value between floating-point formats
+ * \ingroup nvhls_float
+ *
+ * \tparam From                 Source format
+ * \tparam To                   Result format
+ *
+ * \par Overview
+ * - Rounds to nearest even, with subnormal and infinite results; NaNs become the canonical NaN of To.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_float.h>
+ *
+ *      ...
+ *      nvhls::fp32_format::bits_t x;
+ *      nvhls::bf16_format::bits_t y = nvhls::fp_convert<nvhls::fp32_format, nvhls::bf16_format>(x);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename From, typename To>
+typename To::bits_t fp_convert(typename From::bits_t x) {
+  static const unsigned int W = From::mant_width + To::mant_width + 4;
+  static const unsigned int EW = ((From::ExpW > To::ExpW) ? From::ExpW : To::ExpW) + 2;
+  typedef typename nvhls_t<EW>::nvint_t exp_type;
+  fp_unpacked<From> u = fp_unpack<From>(x);
+  if (u.nan) {
+    return fp_nan<To>();
+  }
+  if (u.inf) {
+    return fp_inf<To>(u.sign);
+  }
+  typename nvhls_t<W>::nvuint_t sig = u.sig;
+  sig = sig << (W - From::mant_width - 1);
+  exp_type exp = u.exp;
+  exp = exp - From::bias + To::bias;
+  fp_normalize<W>(sig, exp);
+  return fp_round_pack<To, W>(u.sign, exp, sig);
+}
+
+#ifndef __SYNTHESIS__
+// Native float model of the formats with native_float set
+template <typename Fmt>
+float fp_to_float(typename Fmt::bits_t x) {
+  fp32_format::bits_t f = fp_convert<Fmt, fp32_format>(x);
+  unsigned int u = f.to_uint();
+  float v;
+  std::memcpy(&v, &u, sizeof(v));
+  return v;
+}
+
+template <typename Fmt>
+typename Fmt::bits_t fp_from_float(float v) {
+  unsigned int u;
+  std::memcpy(&u, &v, sizeof(u));
+  fp32_format::bits_t f = u;
+  return fp_convert<fp32_format, Fmt>(f);
+}
+#endif
+
+/**
+ * \brief State of an addition between the steps of a floating-point unit
+ * \ingroup nvhls_float
+ *
+ * big and small are the aligned significands of IW bits followed by guard,
+ * round and sticky bits; the MSB of big has the weight 2^(exp - bias). The
+ * sum of IW + 4 bits has its MSB at weight 2^(exp - bias) once normalized.
+ * zero_sign is the sign of an exact zero result, and result is set by the
+ * last step, or by the first one if special or host_model is set.
+ */
+template <typename Fmt, unsigned int IW>
+struct fp_sum_state {
+  static const unsigned int SW = IW + 3;
+  typedef typename nvhls_t<SW>::nvuint_t sig_t;
+  typedef typename nvhls_t<SW + 1>::nvuint_t sum_t;
+  bool special;
+  bool sign, sub, zero_sign;
+  typename Fmt::exp_t exp;
+  sig_t big, small;
+  sum_t sum;
+  typename Fmt::bits_t result;
+};
+
+// Orders two operands by magnitude and aligns the smaller one. Operands are
+// either normalized or have the smallest exponent, so that (exp, sig)
+// compares as their magnitude.
+template <typename Fmt, unsigned int IW>
+void fp_align(fp_sum_state<Fmt, IW>& s, bool sign_a, typename Fmt::exp_t exp_a,
+              typename nvhls_t<IW>::nvuint_t sig_a, bool sign_b,
+              typename Fmt::exp_t exp_b, typename nvhls_t<IW>::nvuint_t sig_b) {
+  typedef fp_sum_state<Fmt, IW> S;
+  bool zero_a = (sig_a == 0);
+  bool zero_b = (sig_b == 0);
+  bool a_big = !zero_a && (zero_b || (exp_a > exp_b) || ((exp_a == exp_b) && (sig_a >= sig_b)));
+  typename nvhls_t<IW>::nvuint_t sig_big = a_big ? sig_a : sig_b;
+  typename nvhls_t<IW>::nvuint_t sig_small = a_big ? sig_b : sig_a;
+  typename Fmt::exp_t exp_big = a_big ? exp_a : exp_b;
+  typename Fmt::exp_t exp_small = a_big ? exp_b : exp_a;
+  s.sign = a_big ? sign_a : sign_b;
+  s.sub = (sign_a != sign_b);
+  s.zero_sign = zero_a && zero_b && sign_a && sign_b;
+  s.exp = exp_big;
+  s.big = sig_big;
+  s.big = s.big << 3;
+  typename S::sig_t small = sig_small;
+  small = small << 3;
+  typename Fmt::exp_t diff = exp_big - exp_small;
+  unsigned int shift = (zero_a || zero_b || (diff > typename Fmt::exp_t(S::SW)))
+                           ? S::SW
+                           : static_cast<unsigned int>(diff.to_uint());
+  s.small = fp_shift_right_sticky<S::SW>(small, shift);
+}
+
+// Adds or subtracts the aligned significands and normalizes the sum
+template <typename Fmt, unsigned int IW>
+void fp_sum(fp_sum_state<Fmt, IW>& s) {
+  typedef fp_sum_state<Fmt, IW> S;
+  typename S::sum_t sum = s.big;
+  if (s.sub) {
+    sum = sum - s.small;
+  } else {
+    sum = sum + s.small;
+  }
+  s.sum = sum;
+  s.exp = s.exp + 1;
+  fp_normalize<S::SW + 1>(s.sum, s.exp);
+}
+
+template <typename Fmt, unsigned int IW>
+void fp_round(fp_sum_state<Fmt, IW>& s) {
+  typedef fp_sum_state<Fmt, IW> S;
+  if (!s.special) {
+    s.result = fp_round_pack<Fmt, S::SW + 1>((s.sum == 0) ? s.zero_sign : s.sign, s.exp, s.sum);
+  }
+}
+
+// Step 0 of the adder: special cases and alignment, or the native model
+template <typename Fmt, bool Host>
+fp_sum_state<Fmt, Fmt::mant_width + 1> fp_add_init(typename Fmt::bits_t a, typename Fmt::bits_t b) {
+  fp_sum_state<Fmt, Fmt::mant_width + 1> s;
+  s.special = false;
+#ifndef __SYNTHESIS__
+  if (Host) {
+    volatile float sum = fp_to_float<Fmt>(a) + fp_to_float<Fmt>(b);
+    s.result = fp_from_float<Fmt>(sum);
+    s.special = true;
+    return s;
+  }
+#endif
+  fp_unpacked<Fmt> ua = fp_unpack<Fmt>(a);
+  fp_unpacked<Fmt> ub = fp_unpack<Fmt>(b);
+  if (ua.nan || ub.nan || (ua.inf && ub.inf && (ua.sign != ub.sign))) {
+    s.special = true;
+    s.result = fp_nan<Fmt>();
+  } else if (ua.inf || ub.inf) {
+    s.special = true;
+    s.result = fp_inf<Fmt>(ua.inf ? ua.sign : ub.sign);
+  }
+  fp_align<Fmt, Fmt::mant_width + 1>(s, ua.sign, ua.exp, ua.sig, ub.sign, ub.exp, ub.sig);
+  return s;
+}
+
+// Step 0 of the multiplier: special cases and the significand product
+template <typename Fmt, bool Host>
+fp_sum_state<Fmt, 2 * Fmt::mant_width + 2> fp_mul_init(typename Fmt::bits_t a, typename Fmt::bits_t b) {
+  static const unsigned int IW = 2 * Fmt::mant_width + 2;
+  typedef fp_sum_state<Fmt, IW> S;
+  S s;
+  s.special = false;
+#ifndef __SYNTHESIS__
+  if (Host) {
+    volatile float prod = fp_to_float<Fmt>(a) * fp_to_float<Fmt>(b);
+    s.result = fp_from_float<Fmt>(prod);
+    s.special = true;
+    return s;
+  }
+#endif
+  fp_unpacked<Fmt> ua = fp_unpack<Fmt>(a);
+  fp_unpacked<Fmt> ub = fp_unpack<Fmt>(b);
+  bool sign = (ua.sign != ub.sign);
+  if (ua.nan || ub.nan || (ua.inf && ub.zero) || (ua.zero && ub.inf)) {
+    s.special = true;
+    s.result = fp_nan<Fmt>();
+  } else if (ua.inf || ub.inf) {
+    s.special = true;
+    s.result = fp_inf<Fmt>(sign);
+  }
+  typename nvhls_t<IW>::nvuint_t prod =
+      booth_multiply<typename fp_unpacked<Fmt>::sig_t, typename fp_unpacked<Fmt>::sig_t>(ua.sig, ub.sig);
+  s.sign = sign;
+  s.zero_sign = sign;
+  s.sum = prod;
+  s.sum = s.sum << 4;
+  s.exp = ua.exp + ub.exp - Fmt::bias + 1;
+  return s;
+}
+
+template <typename Fmt, unsigned int IW>
+void fp_mul_normalize(fp_sum_state<Fmt, IW>& s) {
+  fp_normalize<fp_sum_state<Fmt, IW>::SW + 1>(s.sum, s.exp);
+}
+
+/**
+ * \brief State of a fused multiply-add between its first two steps
+ * \ingroup nvhls_float
+ *
+ * prod is a * b with its MSB at weight 2^(prod_exp - bias) and c_sig is c
+ * shifted to the same width, next to the sum state of the last steps.
+ */
+template <typename Fmt>
+struct fp_fma_state {
+  static const unsigned int IW = 2 * Fmt::mant_width + 2;
+  typedef typename nvhls_t<IW>::nvuint_t wide_t;
+  bool prod_sign, c_sign;
+  typename Fmt::exp_t prod_exp, c_exp;
+  wide_t prod, c_sig;
+  fp_sum_state<Fmt, IW> sum;
+};
+
+template <typename Fmt>
+fp_fma_state<Fmt> fp_fma_init(typename Fmt::bits_t a, typename Fmt::bits_t b, typename Fmt::bits_t c) {
+  static const unsigned int M = Fmt::mant_width;
+  typedef fp_fma_state<Fmt> S;
+  S s;
+  fp_unpacked<Fmt> ua = fp_unpack<Fmt>(a);
+  fp_unpacked<Fmt> ub = fp_unpack<Fmt>(b);
+  fp_unpacked<Fmt> uc = fp_unpack<Fmt>(c);
+  bool prod_sign = (ua.sign != ub.sign);
+  bool prod_inf = ua.inf || ub.inf;
+  s.sum.special = false;
+  if (ua.nan || ub.nan || uc.nan || (ua.inf && ub.zero) || (ua.zero && ub.inf) ||
+      (prod_inf && uc.inf && (prod_sign != uc.sign))) {
+    s.sum.special = true;
+    s.sum.result = fp_nan<Fmt>();
+  } else if (prod_inf || uc.inf) {
+    s.sum.special = true;
+    s.sum.result = fp_inf<Fmt>(prod_inf ? prod_sign : uc.sign);
+  }
+  s.prod_sign = prod_sign;
+  s.c_sign = uc.sign;
+  s.prod = booth_multiply<typename fp_unpacked<Fmt>::sig_t, typename fp_unpacked<Fmt>::sig_t>(ua.sig, ub.sig);
+  s.prod_exp = ua.exp + ub.exp - Fmt::bias + 1;
+  s.c_sig = uc.sig;
+  s.c_sig = s.c_sig << (M + 1);
+  s.c_exp = uc.exp;
+  return s;
+}
+
+// Normalizes the product and c, then aligns them
+template <typename Fmt>
+void fp_fma_align(fp_fma_state<Fmt>& s) {
+  static const unsigned int IW = fp_fma_state<Fmt>::IW;
+  fp_normalize<IW>(s.prod, s.prod_exp);
+  fp_normalize<IW>(s.c_sig, s.c_exp);
+  fp_align<Fmt, IW>(s.sum, s.prod_sign, s.prod_exp, s.prod, s.c_sign, s.c_exp, s.c_sig);
+}
+
+// Host model selection: only additions and products are computed natively
+template <typename Fmt>
+struct fp_host {
+#ifndef __SYNTHESIS__
+  static const bool native = Fmt::native_float;
+#else
+  static const bool native = false;
+#endif
+};
+
+/**
+ * \brief Floating-point addition
+ * \ingroup nvhls_float
+ *
+ * \tparam Fmt                  Format, e.g. nvhls::bf16_format
+ *
+ * \param[in]  a               Addend
+ * \param[in]  b               Addend
+ * \param[out] ReturnVal       a + b, rounded to nearest even
+ *
+ * \par Overview
+ * - Steps: align the smaller operand with guard, round and sticky bits; add and normalize with lzd; round. PipelinedFpAdd registers between the steps.
+ * - C++ simulation uses native float for formats with native_float set.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_float.h>
+ *
+ *      ...
+ *      typedef nvhls::bf16_format bf16;
+ *      bf16::bits_t a = 0x3fc0, b = 0x4000;                // 1.5, 2.0
+ *      bf16::bits_t sum = nvhls::fp_add<bf16>(a, b);         // 0x4060, 3.5
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename Fmt>
+typename Fmt::bits_t fp_add(typename Fmt::bits_t a, typename Fmt::bits_t b) {
+  fp_sum_state<Fmt, Fmt::mant_width + 1> s = fp_add_init<Fmt, fp_host<Fmt>::native>(a, b);
+  if (!s.special) {
+    fp_sum(s);
+    fp_round(s);
+  }
+  return s.result;
+}
+
+/**
+ * \brief Floating-point multiplication
+ * \ingroup nvhls_float
+ *
+ * \tparam Fmt                  Format, e.g. nvhls::bf16_format
+ *
+ * \param[in]  a               Multiplicand
+ * \param[in]  b               Multiplier
+ * \param[out] ReturnVal       a * b, rounded to nearest even
+ *
+ * \par Overview
+ * - Steps: significand product with booth_multiply; normalize with lzd; round. PipelinedFpMul registers between the steps.
+ * - C++ simulation uses native float for formats with native_float set.
+ *
+ */
+template <typename Fmt>
+typename Fmt::bits_t fp_mul(typename Fmt::bits_t a, typename Fmt::bits_t b) {
+  fp_sum_state<Fmt, 2 * Fmt::mant_width + 2> s = fp_mul_init<Fmt, fp_host<Fmt>::native>(a, b);
+  if (!s.special) {
+    fp_mul_normalize(s);
+    fp_round(s);
+  }
+  return s.result;
+}
+
+/**
+ * \brief Fused floating-point multiply-add
+ * \ingroup nvhls_float
+ *
+ * \tparam Fmt                  Format, e.g. nvhls::bf16_format
+ *
+ * \param[in]  a               Multiplicand
+ * \param[in]  b               Multiplier
+ * \param[in]  c               Addend
+ * \param[out] ReturnVal       a * b + c with a single rounding to nearest even
+ *
+ * \par Overview
+ * - Steps: exact significand product; normalize the product and c and align them; add and normalize; round. PipelinedFpFma registers between the steps.
+ * - Rounding a native float or double FMA to the format again is not always exact, so C++ simulation runs the same steps as the hardware.
+ *
+ */
+template <typename Fmt>
+typename Fmt::bits_t fp_fma(typename Fmt::bits_t a, typename Fmt::bits_t b, typename Fmt::bits_t c) {
+  fp_fma_state<Fmt> s = fp_fma_init<Fmt>(a, b, c);
+  if (!s.sum.special) {
+    fp_fma_align(s);
+    fp_sum(s.sum);
+    fp_round(s.sum);
+  }
+  return s.sum.result;
+}
+
+/**
+ * \brief Pipelined floating-point adder
+ * \ingroup nvhls_float
+ *
+ * \tparam Fmt                  Format, e.g. nvhls::bf16_format
+ * \tparam StepsPerStage        Number of the Steps = 3 steps of fp_add() between pipeline registers
+ *
+ * \par Overview
+ * - Each call of run() is one cycle and accepts a new input, i.e. II=1. The sum appears Latency calls later, with Latency = ceil(3 / StepsPerStage) - 1, and is identical to fp_add().
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_float.h>
+ *
+ *      ...
+ *      nvhls::PipelinedFpAdd<nvhls::bf16_format, 1> adder;   // Latency 2
+ *      ...
+ *      bool out_valid = adder.run(in_valid, a, b, sum);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename Fmt, unsigned int StepsPerStage>
+class PipelinedFpAdd {
+  typedef fp_sum_state<Fmt, Fmt::mant_width + 1> state_t;
+  typedef typename Fmt::bits_t bits_t;
+
+ public:
+  static const unsigned int Steps = 3;
+  static const unsigned int NumGroups = (Steps + StepsPerStage - 1) / StepsPerStage;
+  static const unsigned int Latency = NumGroups - 1;
+
+ private:
+  static const unsigned int NumRegs = (Latency > 0) ? Latency : 1;
+  state_t regs[NumRegs];
+  bool regs_valid[NumRegs];
+
+  static void steps(state_t& s, unsigned int lo, unsigned int hi) {
+    if (s.special)
+      return;
+    if ((lo <= 1) && (hi > 1))
+      fp_sum(s);
+    if ((lo <= 2) && (hi > 2))
+      fp_round(s);
+  }
+
+ public:
+  PipelinedFpAdd() { reset(); }
+
+  void reset() {
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumRegs; i++) {
+      regs_valid[i] = false;
+    }
+  }
+
+  // Returns true if out holds a valid sum in this cycle
+  bool run(bool in_valid, bits_t a, bits_t b, bits_t& out) {
+    bool out_valid = false;
+#pragma hls_unroll yes
+    for (int g = NumGroups - 1; g >= 0; g--) {
+      state_t s;
+      bool valid;
+      if (g == 0) {
+        s = fp_add_init<Fmt, fp_host<Fmt>::native>(a, b);
+        valid = in_valid;
+      } else {
+        s = regs[g - 1];
+        valid = regs_valid[g - 1];
+      }
+      steps(s, g * StepsPerStage, (g + 1) * StepsPerStage);
+      if (g == static_cast<int>(NumGroups) - 1) {
+        out = s.result;
+        out_valid = valid;
+      } else {
+        regs[g] = s;
+        regs_valid[g] = valid;
+      }
+    }
+    return out_valid;
+  }
+};
+
+/**
+ * \brief Pipelined floating-point multiplier
+ * \ingroup nvhls_float
+ *
+ * \tparam Fmt                  Format, e.g. nvhls::bf16_format
+ * \tparam StepsPerStage        Number of the Steps = 3 steps of fp_mul() between pipeline registers
+ *
+ * \par Overview
+ * - II=1; the product appears Latency calls of run() later, with Latency = ceil(3 / StepsPerStage) - 1, and is identical to fp_mul().
+ *
+ */
+template <typename Fmt, unsigned int StepsPerStage>
+class PipelinedFpMul {
+  typedef fp_sum_state<Fmt, 2 * Fmt::mant_width + 2> state_t;
+  typedef typename Fmt::bits_t bits_t;
+
+ public:
+  static const unsigned int Steps = 3;
+  static const unsigned int NumGroups = (Steps + StepsPerStage - 1) / StepsPerStage;
+  static const unsigned int Latency = NumGroups - 1;
+
+ private:
+  static const unsigned int NumRegs = (Latency > 0) ? Latency : 1;
+  state_t regs[NumRegs];
+  bool regs_valid[NumRegs];
+
+  static void steps(state_t& s, unsigned int lo, unsigned int hi) {
+    if (s.special)
+      return;
+    if ((lo <= 1) && (hi > 1))
+      fp_mul_normalize(s);
+    if ((lo <= 2) && (hi > 2))
+      fp_round(s);
+  }
+
+ public:
+  PipelinedFpMul() { reset(); }
+
+  void reset() {
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumRegs; i++) {
+      regs_valid[i] = false;
+    }
+  }
+
+  // Returns true if out holds a valid product in this cycle
+  bool run(bool in_valid, bits_t a, bits_t b, bits_t& out) {
+    bool out_valid = false;
+#pragma hls_unroll yes
+    for (int g = NumGroups - 1; g >= 0; g--) {
+      state_t s;
+      bool valid;
+      if (g == 0) {
+        s = fp_mul_init<Fmt, fp_host<Fmt>::native>(a, b);
+        valid = in_valid;
+      } else {
+        s = regs[g - 1];
+        valid = regs_valid[g - 1];
+      }
+      steps(s, g * StepsPerStage, (g + 1) * StepsPerStage);
+      if (g == static_cast<int>(NumGroups) - 1) {
+        out = s.result;
+        out_valid = valid;
+      } else {
+        regs[g] = s;
+        regs_valid[g] = valid;
+      }
+    }
+    return out_valid;
+  }
+};
+
+/**
+ * \brief Pipelined fused floating-point multiply-add
+ * \ingroup nvhls_float
+ *
+ * \tparam Fmt                  Format, e.g. nvhls::bf16_format
+ * \tparam StepsPerStage        Number of the Steps = 4 steps of fp_fma() between pipeline registers
+ *
+ * \par Overview
+ * - II=1; a * b + c appears Latency calls of run() later, with Latency = ceil(4 / StepsPerStage) - 1, and is identical to fp_fma().
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_float.h>
+ *
+ *      ...
+ *      nvhls::PipelinedFpFma<nvhls::fp16_format, 2> fma;    // Latency 1
+ *      ...
+ *      bool out_valid = fma.run(in_valid, a, b, c, out);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename Fmt, unsigned int StepsPerStage>
+class PipelinedFpFma {
+  typedef fp_fma_state<Fmt> state_t;
+  typedef typename Fmt::bits_t bits_t;
+
+ public:
+  static const unsigned int Steps = 4;
+  static const unsigned int NumGroups = (Steps + StepsPerStage - 1) / StepsPerStage;
+  static const unsigned int Latency = NumGroups - 1;
+
+ private:
+  static const unsigned int NumRegs = (Latency > 0) ? Latency : 1;
+  state_t regs[NumRegs];
+  bool regs_valid[NumRegs];
+
+  static void steps(state_t& s, unsigned int lo, unsigned int hi) {
+    if (s.sum.special)
+      return;
+    if ((lo <= 1) && (hi > 1))
+      fp_fma_align(s);
+    if ((lo <= 2) && (hi > 2))
+      fp_sum(s.sum);
+    if ((lo <= 3) && (hi > 3))
+      fp_round(s.sum);
+  }
+
+ public:
+  PipelinedFpFma() { reset(); }
+
+  void reset() {
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumRegs; i++) {
+      regs_valid[i] = false;
+    }
+  }
+
+  // Returns true if out holds a valid result in this cycle
+  bool run(bool in_valid, bits_t a, bits_t b, bits_t c, bits_t& out) {
+    bool out_valid = false;
+#pragma hls_unroll yes
+    for (int g = NumGroups - 1; g >= 0; g--) {
+      state_t s;
+      bool valid;
+      if (g == 0) {
+        s = fp_fma_init<Fmt>(a, b, c);
+        valid = in_valid;
+      } else {
+        s = regs[g - 1];
+        valid = regs_valid[g - 1];
+      }
+      steps(s, g * StepsPerStage, (g + 1) * StepsPerStage);
+      if (g == static_cast<int>(NumGroups) - 1) {
+        out = s.sum.result;
+        out_valid = valid;
+      } else {
+        regs[g] = s;
+        regs_valid[g] = valid;
+      }
+    }
+    return out_valid;
+  }
+};
+
+/**
+ * \brief Element-wise floating-point vector addition
+ * \ingroup nvhls_float
+ *
+ * \tparam Fmt                  Format, e.g. nvhls::bf16_format
+ * \tparam VectorLength         Length of vector
+ *
+ * \par Overview
+ * - out[i] = fp_add(in1[i], in2[i]) with one adder per element. vector_fp_mul() and vector_fp_fma() are the multiplier and FMA counterparts.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_float.h>
+ *
+ *      ...
+ *      typedef nvhls::bf16_format bf16;
+ *      nvhls::nv_scvector<bf16::bits_t, 16> x, y, acc;
+ *      ...
+ *      nvhls::vector_fp_fma<bf16, 16>(x, y, acc, acc);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename Fmt, unsigned int VectorLength>
+void vector_fp_add(nv_scvector<typename Fmt::bits_t, VectorLength> in1,
+                   nv_scvector<typename Fmt::bits_t, VectorLength> in2,
+                   nv_scvector<typename Fmt::bits_t, VectorLength>& out) {
+#pragma hls_unroll yes
+  for (unsigned int i = 0; i < VectorLength; i++)
+    out[i] = fp_add<Fmt>(in1[i], in2[i]);
+}
+
+template <typename Fmt, unsigned int VectorLength>
+void vector_fp_mul(nv_scvector<typename Fmt::bits_t, VectorLength> in1,
+                   nv_scvector<typename Fmt::bits_t, VectorLength> in2,
+                   nv_scvector<typename Fmt::bits_t, VectorLength>& out) {
+#pragma hls_unroll yes
+  for (unsigned int i = 0; i < VectorLength; i++)
+    out[i] = fp_mul<Fmt>(in1[i], in2[i]);
+}
+
+template <typename Fmt, unsigned int VectorLength>
+void vector_fp_fma(nv_scvector<typename Fmt::bits_t, VectorLength> in1,
+                   nv_scvector<typename Fmt::bits_t, VectorLength> in2,
+                   nv_scvector<typename Fmt::bits_t, VectorLength> in3,
+                   nv_scvector<typename Fmt::bits_t, VectorLength>& out) {
+#pragma hls_unroll yes
+  for (unsigned int i = 0; i < VectorLength; i++)
+    out[i] = fp_fma<Fmt>(in1[i], in2[i], in3[i]);
+}
+
+}  // namespace nvhls
+
+#endif
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+//========================================================================
+// nvhls_host_bridge.h
+//========================================================================
+
+#ifndef NVHLS_HOST_BRIDGE_H_
+#define NVHLS_HOST_BRIDGE_H_
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <algorithm>
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+namespace match {
+
+/**
+ * \brief Lock-free single-producer single-consumer ring between two OS threads
+ * \ingroup HostBridge
+ *
+ * \tparam T         Message type, copied by assignment
+ * \tparam Capacity  Number of entries, a power of two
+ *
+ * \par Overview
+ * - One thread calls Push()/PushBatch() and one other thread calls Pop()/PopBatch(); neither ever blocks or takes a lock.
+ * - Head and tail indices sit on separate cache lines, and each side keeps a private copy of the other side's index that it only refreshes when the ring looks full or empty, so a batch of n messages costs one acquire load and one release store instead of n of each.
+ * - The batch calls transfer as many messages as fit, possibly none, and return the number transferred.
+ *
+ */
+template <typename T, unsigned int Capacity = 1024>
+class SpscRing {
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                "Capacity must be a power of two of at least 2");
+
+ public:
+  SpscRing() : head_(0), tail_cache_(0), tail_(0), head_cache_(0), buf_(Capacity) {}
+
+  // Producer side
+  unsigned int PushBatch(const T* msgs, unsigned int n) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    uint64_t free = Capacity - (tail - head_cache_);
+    if (free < n) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      free = Capacity - (tail - head_cache_);
+    }
+    n = static_cast<unsigned int>(std::min<uint64_t>(n, free));
+    for (unsigned int i = 0; i < n; i++) buf_[(tail + i) & (Capacity - 1)] = msgs[i];
+    if (n != 0) tail_.store(tail + n, std::memory_order_release);
+    return n;
+  }
+
+  bool Push(const T& msg) { return PushBatch(&msg, 1) == 1; }
+
+  // Consumer side
+  unsigned int PopBatch(T* msgs, unsigned int max) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t avail = tail_cache_ - head;
+    if (avail < max) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      avail = tail_cache_ - head;
+    }
+    unsigned int n = static_cast<unsigned int>(std::min<uint64_t>(max, avail));
+    for (unsigned int i = 0; i < n; i++) msgs[i] = buf_[(head + i) & (Capacity - 1)];
+    if (n != 0) head_.store(head + n, std::memory_order_release);
+    return n;
+  }
+
+  bool Pop(T& msg) { return PopBatch(&msg, 1) == 1; }
+
+  // Messages in the ring; exact only while neither side is active
+  unsigned int Size() const {
+    return static_cast<unsigned int>(tail_.load(std::memory_order_acquire) -
+                                     head_.load(std::memory_order_acquire));
+  }
+
+ private:
+  alignas(64) std::atomic<uint64_t> head_;  // Written by the consumer
+  uint64_t tail_cache_;                     // Consumer's copy of tail_
+  alignas(64) std::atomic<uint64_t> tail_;  // Written by the producer
+  uint64_t head_cache_;                     // Producer's copy of head_
+  alignas(64) std::vector<T> buf_;
+};
+
+}  // namespace match
+
+namespace Connections {
+
+//------------------------------------------------------------------------
+// HostToSim
+//------------------------------------------------------------------------
+/**
+ * \brief Bridge from a host thread into a Connections channel
+ * \ingroup HostBridge
+ *
+ * \tparam Message   Message type
+ * \tparam Capacity  Entries of the ring, a power of two
+ * \tparam Batch     Most messages taken from the ring at once
+ *
+ * \par Overview
+ * - A software model in another OS thread calls HostPush() or HostPushBatch(); they return false or the number of messages accepted when the ring is full, and never wait for the SystemC kernel.
+ * - Every clock cycle the bridge pushes at most one message to out. When its local batch is used up it takes up to Batch messages from the ring, so the SystemC side pays for the cross-thread synchronization once per batch, and an empty ring costs one atomic load per cycle: the kernel keeps simulating while the host is idle.
+ * - The host thread is not synchronized with simulated time: a message enters out some cycles after HostPush() returns, depending on how far the simulation has run.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_host_bridge.h>
+ *
+ *      Connections::HostToSim<Msg> to_dut("to_dut");   // to_dut.out -> DUT
+ *      Connections::SimToHost<Msg> from_dut("from_dut");  // DUT -> from_dut.in
+ *      ...
+ *      std::thread driver([&] {
+ *        to_dut.HostPush(request);
+ *        Msg response;
+ *        while (!from_dut.HostPop(response)) std::this_thread::yield();
+ *      });
+ *      sc_start();
+ *      driver.join();
+ * \endcode
+ * \par
+ *
+ */
+template <typename Message, unsigned int Capacity = 1024, unsigned int Batch = 32>
+class HostToSim : public sc_module {
+  SC_HAS_PROCESS(HostToSim);
+
+ public:
+  // Interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  Out<Message> out;
+
+  HostToSim(sc_module_name name) : sc_module(name), clk("clk"), rst("rst"), out("out") {
+    SC_THREAD(Process);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  // Host side, from one thread
+  bool HostPush(const Message& msg) { return ring_.Push(msg); }
+  unsigned int HostPushBatch(const Message* msgs, unsigned int n) { return ring_.PushBatch(msgs, n); }
+
+  // Messages pushed to out so far
+  uint64_t Forwarded() const { return forwarded_; }
+
+ protected:
+  match::SpscRing<Message, Capacity> ring_;
+  uint64_t forwarded_;
+
+  void Process() {
+    out.Reset();
+    forwarded_ = 0;
+    std::vector<Message> batch(Batch);
+    unsigned int head = 0, count = 0;
+    wait();
+    while (1) {
+      if (head == count) {
+        count = ring_.PopBatch(&batch[0], Batch);
+        head = 0;
+      }
+      if (head < count && out.PushNB(batch[head])) {
+        head++;
+        forwarded_++;
+      }
+      wait();
+    }
+  }
+};
+
+//------------------------------------------------------------------------
+// SimToHost
+//------------------------------------------------------------------------
+/**
+ * \brief Bridge from a Connections channel to a host thread
+ * \ingroup HostBridge
+ *
+ * \tparam Message   Message type
+ * \tparam Capacity  Entries of the ring, a power of two
+ * \tparam Batch     Most messages handed to the ring at once
+ *
+ * \par Overview
+ * - Every clock cycle the bridge pops at most one message from in into a local batch. A full batch, or a partial one in a cycle without a new message, goes to the ring in one PushBatch(), so bursts cost one synchronization per Batch messages and a lone message is never held back for more than a cycle.
+ * - When the ring is full the bridge keeps its batch and stops popping once the batch is full too, which backpressures in instead of blocking the kernel.
+ * - A software model in one other OS thread calls HostPop() or HostPopBatch(), which return false or 0 while the ring is empty.
+ *
+ */
+template <typename Message, unsigned int Capacity = 1024, unsigned int Batch = 32>
+class SimToHost : public sc_module {
+  SC_HAS_PROCESS(SimToHost);
+
+ public:
+  // Interface
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  In<Message> in;
+
+  SimToHost(sc_module_name name) : sc_module(name), clk("clk"), rst("rst"), in("in") {
+    SC_THREAD(Process);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  // Host side, from one thread
+  bool HostPop(Message& msg) { return ring_.Pop(msg); }
+  unsigned int HostPopBatch(Message* msgs, unsigned int max) { return ring_.PopBatch(msgs, max); }
+
+  // Messages handed to the ring so far
+  uint64_t Forwarded() const { return forwarded_; }
+
+ protected:
+  match::SpscRing<Message, Capacity> ring_;
+  uint64_t forwarded_;
+
+  void Process() {
+    in.Reset();
+    forwarded_ = 0;
+    std::vector<Message> batch(Batch);
+    unsigned int count = 0;
+    wait();
+    while (1) {
+      bool popped = false;
+      if (count < Batch && in.PopNB(batch[count])) {
+        count++;
+        popped = true;
+      }
+      if (count == Batch || (count != 0 && !popped)) {
+        unsigned int n = ring_.PushBatch(&batch[0], count);
+        std::copy(batch.begin() + n, batch.begin() + count, batch.begin());
+        count -= n;
+        forwarded_ += n;
+      }
+      wait();
+    }
+  }
+};
+
+}  // namespace Connections
+
+#endif  // NVHLS_HOST_BRIDGE_H_
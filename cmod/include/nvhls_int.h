@@ -61,6 +61,12 @@
 #include <ac_sc.h>
 #include <ac_int.h>
 #endif
+#if defined(NVHLS_NATIVE_INT) && !defined(__SYNTHESIS__)
+#ifdef HLS_CATAPULT
+#error "NVHLS_NATIVE_INT models the SystemC integer view, build with HLS_CATAPULT=0"
+#endif
+#include <nvhls_native_int.h>
+#endif
 
 namespace nvhls {
 
@@ -299,6 +305,7 @@ struct index_width {
  * - Contains nvuint_t and nvint_t typedefs that conditionally map to ac_int or sc_int types based on CFLAG
  * - Specifying CFLAG HLS_CATAPULT typedefs ac_int to nvint, otherwise typedefs sc_int to nvint 
  * - nvint also supports conditional typedef of sc_int and sc_bigint depending on bitwidth 
+ * - With CFLAG NVHLS_NATIVE_INT (and without HLS_CATAPULT), widths up to 64 map to the native-integer wrapper native_int in C++ simulation for faster bit-accurate regressions
  * - Simple macros to declare integers are defined in nvhls_types.h 
  *
  * \par A Simple Example
@@ -337,8 +344,13 @@ struct nvhls_t;
 
 template <unsigned int N>
 struct nvhls_t<N, true> {
+#if defined(NVHLS_NATIVE_INT) && !defined(__SYNTHESIS__)
+  typedef native_int<N, true> nvint_t;
+  typedef native_int<N, false> nvuint_t;
+#else
   typedef sc_int<N> nvint_t;
   typedef sc_uint<N> nvuint_t;
+#endif
 };
 
 template <unsigned int N>
@@ -519,11 +531,65 @@ type get_slc(type X, const unsigned int i, const unsigned int j) {
 //  return Z;
 //}
 
-/**************************************************************************
- *  Begin                                                                 *
- *  Algorithmic C (tm) Datatypes                                          *
- *************************************************************************/
-// Based on MG implementation
+/**
+ * \brief Compile-time leading one detector tree
+ * \ingroup nvhls_int
+ *
+ * \tparam Width                 Number of bits searched, must be a power of 2
+ *
+ * \par Overview
+ * - find(X, start, idx) searches bits [start, start+Width) of X, returns true if any of them is set and the offset of the most significant set bit in idx.
+ * - Every node combines the (valid, index) pairs of its halves: the index is the upper index with the MSB set if the upper half is valid, else the lower index. The select logic has log2(Width) levels, in the style of Minmax in comptrees.h.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_int.h>
+ *
+ *      ...
+ *      NVUINT8 X = 5;
+ *      nvhls::leading_ones_tree<8>::idx_t pos;
+ *      bool any = nvhls::leading_ones_tree<8>::find(X, 0, pos); // pos = 2
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <unsigned int Width>
+class leading_ones_tree {
+ public:
+  enum { IdxW = (log2_ceil<Width>::val > 0) ? log2_ceil<Width>::val : 1 };
+  typedef typename nvhls_t<IdxW>::nvuint_t idx_t;
+
+  template <typename type1>
+  static bool find(const type1& X, unsigned int start, idx_t& idx) {
+    enum { Half = Width / 2 };
+    typename leading_ones_tree<Half>::idx_t idx_upper, idx_lower;
+    bool valid_upper = leading_ones_tree<Half>::find(X, start + Half, idx_upper);
+    bool valid_lower = leading_ones_tree<Half>::find(X, start, idx_lower);
+    if (valid_upper) {
+      idx = static_cast<idx_t>(idx_upper) | Half;
+    } else {
+      idx = idx_lower;
+    }
+    return (valid_upper || valid_lower);
+  }
+};
+
+// Base condition for Width = 1.
+template <>
+class leading_ones_tree<1> {
+ public:
+  enum { IdxW = 1 };
+  typedef nvhls_t<1>::nvuint_t idx_t;
+
+  template <typename type1>
+  static bool find(const type1& X, unsigned int start, idx_t& idx) {
+    idx = 0;
+    return (X[start] == 1);
+  }
+};
+
 /**
  * \brief LeadingOne Detector 
  * \ingroup nvhls_int
@@ -537,8 +603,10 @@ type get_slc(type X, const unsigned int i, const unsigned int j) {
 
 
  * \par Overview
- * - Function that returns position of leading one. 
+ * - Function that returns position of leading one, or 0 if X is 0. 
  * - type can be: nvint or nvuint type.
+ * - Implemented with leading_ones_tree, zero-extended to a power of 2 width.
+ * - C++ simulation uses the host __builtin_clzll for W1 <= 64.
  *
  * \par A Simple Example
  * \code
@@ -559,34 +627,23 @@ type get_slc(type X, const unsigned int i, const unsigned int j) {
 
 template <unsigned int W1, typename type1, typename type2>
 inline type2 leading_ones(type1 X) {
-  const unsigned int W2 = log2_ceil<W1>::val;
-  enum { P2 = next_pow2<(W1 + 1) / 2>::val };
-
   typename nvhls_t<W1>::nvuint_t X_temp = X;
-  enum { Wu = (W1 > P2) ? (W1 - P2) : 1 };
-  typename nvhls_t<Wu>::nvuint_t upper = get_slc<Wu>(X_temp, P2);
-  typename nvhls_t<P2>::nvuint_t lower = get_slc<P2>(X_temp, 0);
-  typename nvhls_t<W2>::nvuint_t idx = 0;
-
-  enum { logWu = (log2_ceil<Wu>::val > 0) ? log2_ceil<Wu>::val : 1 };
-  enum { logP2 = (log2_ceil<P2>::val > 0) ? log2_ceil<P2>::val : 1 };
-  typename nvhls_t<logWu>::nvuint_t idxu = 0;
-  typename nvhls_t<P2>::nvuint_t idxl = 0;
-  if (upper != 0) {
-    idxu = leading_ones<Wu, typename nvhls_t<Wu>::nvuint_t,
-                        typename nvhls_t<logWu>::nvuint_t>(upper);
-    idx = idxu | P2;
-  } else {
-    idxl = leading_ones<P2, typename nvhls_t<P2>::nvuint_t,
-                        typename nvhls_t<logP2>::nvuint_t>(lower);
-    idx = idxl;
+#ifndef __SYNTHESIS__
+  if (W1 <= 64) {
+    unsigned long long bits = X_temp.to_uint64();
+    type2 idx = 0;
+    if (bits != 0) {
+      idx = 63 - __builtin_clzll(bits);
+    }
+    return idx;
   }
+#endif
+  enum { P2 = next_pow2<W1>::val };
+  typename nvhls_t<P2>::nvuint_t X_pad = X_temp;
+  typename leading_ones_tree<P2>::idx_t idx = 0;
+  leading_ones_tree<P2>::find(X_pad, 0, idx);
   return idx;
 }
-/**************************************************************************
- *  End                                                                   *
- *  Algorithmic C (tm) Datatypes                                          *
- *************************************************************************/
 
 template <>
 inline nvhls_t<1>::nvuint_t leading_ones<
@@ -627,6 +684,29 @@ template <typename type1>
 unsigned int lzd(type1 X) {
   unsigned int l;
 #ifdef HLS_CATAPULT
+#ifndef __SYNTHESIS__
+  // C++ simulation: leading_sign() on the host for W1 <= 64
+  const unsigned int W = Wrapped<type1>::width;
+  if (W <= 64) {
+    typename nvhls_t<W>::nvuint_t X_bits = X;
+    unsigned long long bits = X_bits.to_uint64();
+    unsigned int W_mag = W;
+    if (Wrapped<type1>::is_signed) {
+      // count the bits below the sign bit that equal the sign bit
+      W_mag = W - 1;
+      if ((bits >> W_mag) & 1) {
+        bits = ~bits;
+      }
+    }
+    if (W_mag < 64) {
+      bits &= (1ULL << W_mag) - 1;
+    }
+    if (bits == 0) {
+      return W - 1;
+    }
+    return __builtin_clzll(bits) - (64 - W_mag);
+  }
+#endif
   if (X!=0) {
     l = X.leading_sign();
   } else {
@@ -639,7 +719,7 @@ unsigned int lzd(type1 X) {
   HLS_CONSTRAIN_REGION(0, 1);
 #endif
   const unsigned int W1 = Wrapped<type1>::width;
-  const unsigned int W2 = log2_ceil<W1>::val;
+  const unsigned int W2 = (log2_ceil<W1>::val > 0) ? log2_ceil<W1>::val : 1;
   typedef typename nvhls_t<W2>::nvuint_t type2;
   const bool is_signed = Wrapped<type1>::is_signed;
   l = leading_ones<W1, type1, type2>(X);
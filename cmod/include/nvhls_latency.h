@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_LATENCY_H
+#define NVHLS_LATENCY_H
+
+#include <systemc.h>
+#include <nvhls_types.h>
+#include <nvhls_marshaller.h>
+#include <nvhls_message.h>
+#ifndef __SYNTHESIS__
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <vector>
+#endif
+
+namespace match {
+
+/**
+ * \brief Message wrapper that carries a simulation-only latency tag
+ * \ingroup nvhls_module
+ *
+ * \tparam Message          Wrapped message type
+ *
+ * \par Overview
+ * - Tagged<Message> holds msg and, in C++ simulation only, an id and the time at which Stamp() was called. Under __SYNTHESIS__ it is exactly as wide as Message.
+ * - The tag is marshalled with the message, so it survives every Connections channel in both CONNECTIONS_ACCURATE_SIM and CONNECTIONS_FAST_SIM.
+ * - Stamp() the message where the transaction starts, e.g. before a Push(), and pass it to LatencyRecorder::Record() where it ends, e.g. after a Pop() further downstream. CopyTag() moves the tag into a different message type, e.g. from a request to its response.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_latency.h>
+ *
+ *      Connections::Out<match::Tagged<Data> > out;  // Producer
+ *      ...
+ *      match::Tagged<Data> t(data);
+ *      t.Stamp();
+ *      out.Push(t);
+ *
+ *      match::LatencyRecorder latency("dut_latency", sc_time(1, SC_NS));  // Consumer
+ *      ...
+ *      match::Tagged<Data> t = in.Pop();
+ *      latency.Record(t);
+ *      ...
+ *      match::LatencyRecorder::DumpAll(std::cout);  // End of simulation
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename Message>
+class Tagged : public nvhls_message {
+ public:
+#ifndef __SYNTHESIS__
+  enum { tag_width = 64 + 32 };
+#else
+  enum { tag_width = 0 };
+#endif
+  enum { width = Wrapped<Message>::width + tag_width };
+
+  Message msg;
+#ifndef __SYNTHESIS__
+  NVUINTW(64) tag_time_ps;
+  NVUINTW(32) tag_id;
+#endif
+
+  Tagged() : msg() { ClearTag(); }
+  Tagged(const Message& m) : msg(m) { ClearTag(); }
+
+  void ClearTag() {
+#ifndef __SYNTHESIS__
+    tag_time_ps = 0;
+    tag_id = 0;
+#endif
+  }
+
+  // Tags the message with the current time and a new id.
+  void Stamp() {
+#ifndef __SYNTHESIS__
+    static unsigned int next_id = 0;
+    tag_time_ps = static_cast<uint64>(sc_time_stamp().to_seconds() * 1e12 + 0.5);
+    tag_id = ++next_id;
+#endif
+  }
+
+  template <typename Other>
+  void CopyTag(const Tagged<Other>& other) {
+#ifndef __SYNTHESIS__
+    tag_time_ps = other.tag_time_ps;
+    tag_id = other.tag_id;
+#endif
+  }
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& msg;
+#ifndef __SYNTHESIS__
+    m& tag_time_ps;
+    m& tag_id;
+#endif
+  }
+
+#ifdef CONNECTIONS_SIM_ONLY
+  inline friend void sc_trace(sc_trace_file* tf, const Tagged& v, const std::string& NAME) {
+    sc_trace(tf, v.msg, NAME);
+  }
+#endif
+
+  inline friend std::ostream& operator<<(ostream& os, const Tagged& rhs) {
+    os << rhs.msg;
+    return os;
+  }
+};
+
+#ifndef __SYNTHESIS__
+/**
+ * \brief Latency distribution of tagged transactions
+ * \ingroup nvhls_module
+ *
+ * \par Overview
+ * - Record() adds the time since the Stamp() of a Tagged message. Start(key) and Stop(key) measure transactions whose messages cannot carry a tag, keyed by e.g. an AXI ID and address.
+ * - Latencies are kept in units of unit (e.g. the clock period, for cycles): count, min, max, mean, percentile() and a log2 histogram.
+ * - Every recorder registers itself; DumpAll() prints all of them.
+ *
+ */
+class LatencyRecorder {
+ public:
+  explicit LatencyRecorder(const std::string& name, const sc_time& unit = sc_time(1, SC_NS))
+      : name_(name), unit_ps_(unit.to_seconds() * 1e12), count_(0), sum_(0), min_(0), max_(0) {
+    Recorders().push_back(this);
+  }
+
+  ~LatencyRecorder() {
+    std::vector<LatencyRecorder*>& recorders = Recorders();
+    for (unsigned int i = 0; i < recorders.size(); i++) {
+      if (recorders[i] == this) {
+        recorders.erase(recorders.begin() + i);
+        break;
+      }
+    }
+  }
+
+  template <typename Message>
+  void Record(const Tagged<Message>& t) {
+    Add(Now() - t.tag_time_ps.to_uint64());
+  }
+
+  void Start(uint64 key) { open_[key] = Now(); }
+
+  // Returns false if Start(key) was not called.
+  bool Stop(uint64 key) {
+    std::map<uint64, uint64>::iterator it = open_.find(key);
+    if (it == open_.end())
+      return false;
+    Add(Now() - it->second);
+    open_.erase(it);
+    return true;
+  }
+
+  uint64 count() const { return count_; }
+  double min() const { return min_ / unit_ps_; }
+  double max() const { return max_ / unit_ps_; }
+  double mean() const { return (count_ == 0) ? 0 : sum_ / count_ / unit_ps_; }
+
+  // Smallest latency that is not exceeded by p percent of the samples
+  double percentile(double p) const {
+    if (count_ == 0)
+      return 0;
+    std::vector<uint64> sorted(samples_);
+    uint64 rank = static_cast<uint64>(p / 100.0 * sorted.size() + 0.5);
+    rank = std::min<uint64>(std::max<uint64>(rank, 1), sorted.size()) - 1;
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank] / unit_ps_;
+  }
+
+  void Print(std::ostream& ofile) const {
+    ofile << name_ << ": count " << count_;
+    if (count_ != 0) {
+      ofile << ", min " << min() << ", max " << max() << ", mean " << mean();
+    }
+    ofile << std::endl;
+    for (unsigned int b = 0; b < hist_.size(); b++) {
+      if (hist_[b] == 0)
+        continue;
+      ofile << "  [" << ((b == 0) ? 0 : (static_cast<uint64>(1) << (b - 1))) << ", "
+            << (static_cast<uint64>(1) << b) << "): " << hist_[b] << std::endl;
+    }
+  }
+
+  static void DumpAll(std::ostream& ofile) {
+    std::vector<LatencyRecorder*>& recorders = Recorders();
+    for (unsigned int i = 0; i < recorders.size(); i++)
+      recorders[i]->Print(ofile);
+  }
+
+ private:
+  std::string name_;
+  double unit_ps_;
+  uint64 count_;
+  double sum_;
+  uint64 min_, max_;
+  std::vector<uint64> hist_;  // Bucket b: latency in units in [2^(b-1), 2^b)
+  std::vector<uint64> samples_;  // Every latency in ps, for percentile()
+  std::map<uint64, uint64> open_;
+
+  static std::vector<LatencyRecorder*>& Recorders() {
+    static std::vector<LatencyRecorder*> recorders;
+    return recorders;
+  }
+
+  static uint64 Now() {
+    return static_cast<uint64>(sc_time_stamp().to_seconds() * 1e12 + 0.5);
+  }
+
+  void Add(uint64 latency_ps) {
+    min_ = (count_ == 0 || latency_ps < min_) ? latency_ps : min_;
+    max_ = (count_ == 0 || latency_ps > max_) ? latency_ps : max_;
+    count_++;
+    sum_ += latency_ps;
+    samples_.push_back(latency_ps);
+    uint64 units = static_cast<uint64>(latency_ps / unit_ps_);
+    unsigned int bucket = 0;
+    while (units >> bucket)
+      bucket++;
+    if (bucket >= hist_.size())
+      hist_.resize(bucket + 1, 0);
+    hist_[bucket]++;
+  }
+};
+#endif
+
+}  // namespace match
+
+#endif  // NVHLS_LATENCY_H
@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+//========================================================================
+// nvhls_link_retry.h
+//========================================================================
+// Implements a CRC-protected flit link with go-back-N retry
+
+#ifndef NVHLS_LINK_RETRY_H
+#define NVHLS_LINK_RETRY_H
+
+#include <systemc.h>
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_message.h>
+#include <nvhls_connections.h>
+#include <nvhls_crc.h>
+#include <TypeToBits.h>
+
+/**
+ * \brief A flit on a retry link: <CRC>:<Sequence>:<Flit>
+ * \ingroup SerDes
+ *
+ * The CRC covers the flit and the sequence number.  The sequence number has one bit more than
+ * needed to index the RetryDepth entries of the retry buffer, so it is unambiguous over the
+ * RetryDepth flits that can be unacknowledged at a time.
+ */
+template <typename flit_t, int RetryDepth, int CrcWidth, unsigned long long CrcPoly>
+class RetryLinkFlit : public nvhls_message {
+ public:
+  static const int seq_width = nvhls::index_width<RetryDepth>::val + 1;
+  static const int payload_width = Wrapped<flit_t>::width + seq_width;
+  enum { width = payload_width + CrcWidth };
+  typedef crc_gen<payload_width, CrcWidth, CrcPoly> crc_t;
+
+  flit_t flit;
+  NVUINTW(seq_width) seq;
+  NVUINTW(CrcWidth) crc;
+
+  RetryLinkFlit() : seq(0), crc(0) {}
+
+  typename crc_t::Crc ComputeCrc() const {
+    NVUINTW(payload_width) payload = 0;
+    payload = nvhls::set_slc(payload, TypeToNVUINT(flit), 0);
+    payload = nvhls::set_slc(payload, seq, Wrapped<flit_t>::width);
+    return crc_t::Compute(payload);
+  }
+
+  bool CrcOk() const { return ComputeCrc() == crc; }
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& flit;
+    m& seq;
+    m& crc;
+  }
+};
+
+/**
+ * \brief Acknowledgment on a retry link
+ * \ingroup SerDes
+ *
+ * A positive acknowledgment (nack == false) acknowledges every flit up to and including seq.  A
+ * negative one acknowledges every flit before seq and requests a retransmission from seq on.
+ */
+template <int RetryDepth>
+class RetryLinkAck : public nvhls_message {
+ public:
+  static const int seq_width = nvhls::index_width<RetryDepth>::val + 1;
+  enum { width = seq_width + 1 };
+
+  NVUINTW(seq_width) seq;
+  bool nack;
+
+  RetryLinkAck() : seq(0), nack(false) {}
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& seq;
+    m& nack;
+  }
+};
+
+//------------------------------------------------------------------------
+// retry_link_sender
+//------------------------------------------------------------------------
+/**
+ * \brief Sender side of a CRC-protected flit link with retry
+ * \ingroup SerDes
+ *
+ * \tparam flit_t         FlitType
+ * \tparam RetryDepth     Entries of the retry buffer, a power of two (default: 8)
+ * \tparam CrcWidth       Width of the CRC (default: 16)
+ * \tparam CrcPoly        CRC polynomial without the x^CrcWidth term (default: 0x1021, CRC-16-CCITT)
+ *
+ * \par Overview
+ * - Sits between a serializer and the link, with a retry_link_receiver before the deserializer on the other side. The link may corrupt flits; Packet, Flit and the serdes are unchanged.
+ * - Every flit gets a sequence number and a CRC (crc_gen) and is kept in the retry buffer until it is acknowledged on in_ack. A negative acknowledgment rewinds the sender to the flit it names, which is sent again together with all flits after it (go-back-N).
+ * - One flit is accepted and one sent per cycle. in_flit stalls while RetryDepth flits are unacknowledged, so RetryDepth must cover the round trip of a flit and its acknowledgment for full throughput.
+ * - The acknowledgment path is assumed to be error free, e.g. a narrow sideband that is protected separately.
+ * - retry_count counts rewinds and saturates.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_link_retry.h>
+ *
+ *      ...
+ *      retry_link_sender<Flit_t, 8> sender;
+ *      retry_link_receiver<Flit_t, 8> receiver;
+ *      ...
+ *          sender.in_flit(ser_out);
+ *          sender.out_link(link_tx);
+ *          sender.in_ack(link_ack);
+ *          receiver.in_link(link_rx);
+ *          receiver.out_flit(deser_in);
+ *          receiver.out_ack(link_ack);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename flit_t, int RetryDepth = 8, int CrcWidth = 16,
+          unsigned long long CrcPoly = 0x1021>
+class retry_link_sender : public sc_module {
+  static_assert(RetryDepth >= 2 && (RetryDepth & (RetryDepth - 1)) == 0,
+                "RetryDepth must be a power of two");
+
+ public:
+  typedef RetryLinkFlit<flit_t, RetryDepth, CrcWidth, CrcPoly> link_flit_t;
+  typedef RetryLinkAck<RetryDepth> link_ack_t;
+  static const int seq_width = link_flit_t::seq_width;
+  static const int log_depth = seq_width - 1;
+  typedef NVUINTW(seq_width) Seq;
+
+  sc_in_clk clk;
+  sc_in<bool> rst;
+
+  Connections::In<flit_t> in_flit;
+  Connections::Out<link_flit_t> out_link;
+  Connections::In<link_ack_t> in_ack;
+
+  NVUINT16 retry_count;
+
+  void Process() {
+    in_flit.Reset();
+    out_link.Reset();
+    in_ack.Reset();
+    flit_t buffer[RetryDepth];
+    // head: oldest unacknowledged flit, send: next flit to send, tail: next free entry
+    Seq head = 0, send = 0, tail = 0;
+    retry_count = 0;
+    wait();
+
+    while (1) {
+      link_ack_t ack;
+      if (in_ack.PopNB(ack)) {
+        if (ack.nack) {
+          head = ack.seq;
+          send = ack.seq;
+          if (retry_count != 0xffff) retry_count++;
+        } else {
+          Seq acked = ack.seq + 1;
+          // Flits a late acknowledgment covers are not sent again
+          if (static_cast<Seq>(tail - send) > static_cast<Seq>(tail - acked)) send = acked;
+          head = acked;
+        }
+      }
+
+      if (static_cast<Seq>(tail - head) != RetryDepth) {
+        flit_t flit;
+        if (in_flit.PopNB(flit)) {
+          buffer[nvhls::get_slc<log_depth>(tail, 0)] = flit;
+          tail++;
+        }
+      }
+
+      if (send != tail) {
+        link_flit_t link;
+        link.flit = buffer[nvhls::get_slc<log_depth>(send, 0)];
+        link.seq = send;
+        link.crc = link.ComputeCrc();
+        if (out_link.PushNB(link)) send++;
+      }
+      wait();
+    }
+  }
+
+  SC_HAS_PROCESS(retry_link_sender);
+  retry_link_sender(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        rst("rst"),
+        in_flit("in_flit"),
+        out_link("out_link"),
+        in_ack("in_ack"),
+        retry_count(0) {
+    SC_THREAD(Process);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+};
+
+//------------------------------------------------------------------------
+// retry_link_receiver
+//------------------------------------------------------------------------
+/**
+ * \brief Receiver side of a CRC-protected flit link with retry
+ * \ingroup SerDes
+ *
+ * \tparam flit_t         FlitType
+ * \tparam RetryDepth     Entries of the retry buffer of the sender (default: 8)
+ * \tparam CrcWidth       Width of the CRC (default: 16)
+ * \tparam CrcPoly        CRC polynomial without the x^CrcWidth term (default: 0x1021, CRC-16-CCITT)
+ *
+ * \par Overview
+ * - Checks the CRC of every flit from retry_link_sender and passes on the flits with the expected sequence number, in order and each exactly once. Every such flit is acknowledged on out_ack.
+ * - A flit with a CRC error is dropped and answered with a negative acknowledgment for the expected flit. Flits after it are dropped until the expected flit arrives again; a later flit with a good CRC only sends a negative acknowledgment if none was sent yet. Copies of flits that were already passed on (after a repeated rewind) are dropped silently.
+ * - Acknowledgments that out_ack cannot take yet are merged, as every acknowledgment supersedes the earlier ones.
+ * - crc_error_count counts flits with a CRC error and saturates.
+ *
+ */
+template <typename flit_t, int RetryDepth = 8, int CrcWidth = 16,
+          unsigned long long CrcPoly = 0x1021>
+class retry_link_receiver : public sc_module {
+ public:
+  typedef RetryLinkFlit<flit_t, RetryDepth, CrcWidth, CrcPoly> link_flit_t;
+  typedef RetryLinkAck<RetryDepth> link_ack_t;
+  static const int seq_width = link_flit_t::seq_width;
+  typedef NVUINTW(seq_width) Seq;
+
+  sc_in_clk clk;
+  sc_in<bool> rst;
+
+  Connections::In<link_flit_t> in_link;
+  Connections::Out<flit_t> out_flit;
+  Connections::Out<link_ack_t> out_ack;
+
+  NVUINT16 crc_error_count;
+
+  void Process() {
+    in_link.Reset();
+    out_flit.Reset();
+    out_ack.Reset();
+    Seq expected = 0;
+    bool nacked = false;
+    flit_t flit_reg;
+    bool flit_valid = false;
+    link_ack_t ack_reg;
+    bool ack_valid = false;
+    crc_error_count = 0;
+    wait();
+
+    while (1) {
+      link_flit_t link;
+      if (!flit_valid && in_link.PopNB(link)) {
+        bool crc_ok = link.CrcOk();
+        // Sequence numbers in [expected - RetryDepth, expected) were passed on already
+        bool behind = (static_cast<Seq>(expected - link.seq) <= RetryDepth) && (link.seq != expected);
+        if (!crc_ok && crc_error_count != 0xffff) crc_error_count++;
+        if (crc_ok && link.seq == expected) {
+          flit_reg = link.flit;
+          flit_valid = true;
+          ack_reg.seq = expected;
+          ack_reg.nack = false;
+          ack_valid = true;
+          expected++;
+          nacked = false;
+        } else if (!crc_ok || (!behind && !nacked)) {
+          ack_reg.seq = expected;
+          ack_reg.nack = true;
+          ack_valid = true;
+          nacked = true;
+        }
+      }
+
+      if (flit_valid && out_flit.PushNB(flit_reg)) flit_valid = false;
+      if (ack_valid && out_ack.PushNB(ack_reg)) ack_valid = false;
+      wait();
+    }
+  }
+
+  SC_HAS_PROCESS(retry_link_receiver);
+  retry_link_receiver(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        rst("rst"),
+        in_link("in_link"),
+        out_flit("out_flit"),
+        out_ack("out_ack"),
+        crc_error_count(0) {
+    SC_THREAD(Process);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+};
+
+#endif  // NVHLS_LINK_RETRY_H
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_MEMORY_H
+#define NVHLS_MEMORY_H
+
+#include <systemc.h>
+#ifndef __SYNTHESIS__
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#endif
+
+namespace match {
+
+#ifndef __SYNTHESIS__
+/**
+ * \brief Heap bytes of a value of type T beyond sizeof(T), for the match::Memory estimate
+ * \ingroup nvhls_module
+ *
+ * Only sc_lv words wider than the inline storage of sc_lv_base keep their bits on the heap.
+ */
+template <typename T>
+struct HeapBytes {
+  static const unsigned int value = 0;
+};
+
+template <int W>
+struct HeapBytes<sc_lv<W> > {
+#ifdef SC_BASE_VEC_DIGITS
+  static const unsigned int value = (W > SC_BASE_VEC_DIGITS * 32) ? 8 * ((W + 31) / 32) : 0;
+#else
+  static const unsigned int value = 8 * ((W + 31) / 32);
+#endif
+};
+
+/**
+ * \brief Approximate simulation memory footprint per match::Module and per component
+ * \ingroup nvhls_module
+ *
+ * \par Overview
+ * - Opt-in at run time: nothing is counted unless Enable() is called before the design is built or
+ *   the NVHLS_MEMORY_REPORT environment variable is set, and every hook only checks Enabled() until
+ *   then.
+ * - The components are "mem_array_sep", "mem_array_sparse_bank", "FIFO" (the FIFO and its storage in
+ *   C++ simulation, without a mem_array_sep body of FIFO_SIM_USE_MEM_ARRAY), the buffered Connections
+ *   channels as "Connections::<channel>" and the pages of the testbench "SparseMem".
+ * - An object counts sizeof() of itself plus the heap storage of wide sc_lv words (HeapBytes), at
+ *   construction. Heap storage of the SystemC kernel, such as process stacks and object names, is
+ *   not counted.
+ * - Each object is charged to the match::Module that is being constructed when it is, or to
+ *   "unowned" outside of any Module. Objects constructed while the simulation runs are not
+ *   counted, so temporaries are not counted at every call; this also skips objects constructed at
+ *   the first call of a function, such as the static state of a CCS_DESIGN function.
+ * - Storage allocated on demand, the pages of mem_array_sparse_bank and SparseMem, is added with
+ *   Grow() whenever it is allocated and charged to the Module of the running process; it is not
+ *   subtracted again when it is freed.
+ * - Report() prints the objects and bytes per component and the largest Modules. With
+ *   NVHLS_MEMORY_REPORT set it is printed at the end of elaboration of the first match::Module, and
+ *   a number N > 0 limits it to the N largest Modules.
+ * - Module::DumpStats() prints the bytes of each Module as the counters mem_bytes and
+ *   mem_bytes.<component>, so sub-totals add up the bytes of a subtree.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_memory.h>
+ *
+ *      ...
+ *      match::Memory::Get().Enable();
+ *      testbench tb("tb");
+ *      sc_start(SC_ZERO_TIME);
+ *      match::Memory::Get().Report(std::cout, 20);
+ *
+ * \endcode
+ * \par
+ *
+ */
+class Memory {
+ public:
+  static Memory& Get() {
+    static Memory memory;
+    return memory;
+  }
+
+  bool Enabled() const { return enabled_; }
+  void Enable(bool enable = true) { enabled_ = enable; }
+
+  // Returns the id of a component, used by Record() and Grow().
+  unsigned int Id(const std::string& component) {
+    std::map<std::string, unsigned int>::iterator it = ids_.find(component);
+    if (it != ids_.end())
+      return it->second;
+    unsigned int id = names_.size();
+    ids_[component] = id;
+    names_.push_back(component);
+    return id;
+  }
+
+  // Charges one object of bytes bytes to the Module under construction.
+  void Record(unsigned int id, uint64 bytes) {
+    if (sc_is_running())
+      return;
+    Account& acct = CurrentAccount(id);
+    acct.objects[id]++;
+    acct.bytes[id] += bytes;
+  }
+
+  // Charges bytes allocated on demand to the Module of the running process,
+  // or under construction.
+  void Grow(unsigned int id, uint64 bytes) { CurrentAccount(id).bytes[id] += bytes; }
+
+  // Appends (mem_bytes[.<component>], bytes) of owner to out; nothing if
+  // owner has no memory.
+  void OwnerStats(const sc_object* owner,
+                  std::vector<std::pair<std::string, uint64> >& out) const {
+    std::map<const sc_object*, Account>::const_iterator it = accounts_.find(owner);
+    if (it == accounts_.end())
+      return;
+    for (unsigned int i = 0; i < it->second.bytes.size(); i++) {
+      if (it->second.bytes[i] != 0)
+        out.push_back(std::make_pair("mem_bytes." + names_[i], it->second.bytes[i]));
+    }
+    out.push_back(std::make_pair(std::string("mem_bytes"), it->second.Total()));
+  }
+
+  bool HasMemory(const sc_object* owner) const {
+    return accounts_.find(owner) != accounts_.end();
+  }
+
+  // Prints objects and bytes per component, then the num_owners (0: all)
+  // largest owners.
+  void Report(std::ostream& ofile, unsigned int num_owners = 0) const {
+    std::vector<uint64> objects(names_.size(), 0), bytes(names_.size(), 0);
+    std::vector<std::pair<uint64, const sc_object*> > owners;
+    uint64 total = 0;
+    for (std::map<const sc_object*, Account>::const_iterator it = accounts_.begin();
+         it != accounts_.end(); it++) {
+      for (unsigned int i = 0; i < it->second.bytes.size(); i++) {
+        objects[i] += it->second.objects[i];
+        bytes[i] += it->second.bytes[i];
+      }
+      owners.push_back(std::make_pair(it->second.Total(), it->first));
+      total += owners.back().first;
+    }
+    ofile << "Memory by component (total " << total << " bytes):" << std::endl;
+    ofile << std::setw(32) << std::left << "  component" << std::right << std::setw(12)
+          << "objects" << std::setw(16) << "bytes" << std::setw(12) << "bytes/obj" << std::endl;
+    for (unsigned int i = 0; i < names_.size(); i++) {
+      if (bytes[i] == 0)
+        continue;
+      ofile << "  " << std::setw(30) << std::left << names_[i] << std::right
+            << std::setw(12) << objects[i] << std::setw(16) << bytes[i] << std::setw(12);
+      if (objects[i] != 0)
+        ofile << bytes[i] / objects[i];
+      else
+        ofile << "-";
+      ofile << std::endl;
+    }
+    std::sort(owners.begin(), owners.end());
+    std::reverse(owners.begin(), owners.end());
+    if (num_owners == 0 || num_owners > owners.size())
+      num_owners = owners.size();
+    ofile << "Memory by module (largest " << num_owners << " of " << owners.size()
+          << "):" << std::endl;
+    for (unsigned int i = 0; i < num_owners; i++) {
+      ofile << "  " << (owners[i].second ? owners[i].second->name() : "unowned") << ": "
+            << owners[i].first << " bytes" << std::endl;
+    }
+  }
+
+  // Prints the report once if NVHLS_MEMORY_REPORT is set; called at the end
+  // of elaboration.
+  void ElaborationReport() {
+    if (!report_at_elaboration_)
+      return;
+    report_at_elaboration_ = false;
+    Report(std::cout, report_owners_);
+  }
+
+  void Reset() {
+    accounts_.clear();
+    owners_.clear();
+    last_object_ = NULL;
+    last_account_ = NULL;
+  }
+
+ private:
+  struct Account {
+    std::vector<uint64> objects;
+    std::vector<uint64> bytes;
+
+    uint64 Total() const {
+      uint64 total = 0;
+      for (unsigned int i = 0; i < bytes.size(); i++)
+        total += bytes[i];
+      return total;
+    }
+  };
+
+  bool enabled_;
+  bool report_at_elaboration_;
+  unsigned int report_owners_;
+  std::map<std::string, unsigned int> ids_;
+  std::vector<std::string> names_;
+  // Memory per owning Module (NULL: unowned)
+  std::map<const sc_object*, Account> accounts_;
+  // Account of each process or module seen so far, and of the last one
+  std::map<const sc_object*, Account*> owners_;
+  const sc_object* last_object_;
+  Account* last_account_;
+
+  Memory()
+      : enabled_(false), report_at_elaboration_(false), report_owners_(0),
+        last_object_(NULL), last_account_(NULL) {
+    const char* report = std::getenv("NVHLS_MEMORY_REPORT");
+    if (report != NULL) {
+      enabled_ = true;
+      report_at_elaboration_ = true;
+      report_owners_ = std::atoi(report);
+    }
+  }
+
+  Account& CurrentAccount(unsigned int id) {
+    // The running process, or the module under construction
+    const sc_object* object = sc_get_curr_simcontext()->active_object();
+    if (last_account_ == NULL || object != last_object_) {
+      std::map<const sc_object*, Account*>::iterator it = owners_.find(object);
+      if (it == owners_.end()) {
+        // The first match::Module at or above the object
+        const sc_object* owner = object;
+        while (owner != NULL &&
+               const_cast<sc_object*>(owner)->get_attribute("match_module") == NULL)
+          owner = owner->get_parent_object();
+        it = owners_.insert(std::make_pair(object, &accounts_[owner])).first;
+      }
+      last_object_ = object;
+      last_account_ = it->second;
+    }
+    if (last_account_->bytes.size() <= id) {
+      last_account_->objects.resize(names_.size(), 0);
+      last_account_->bytes.resize(names_.size(), 0);
+    }
+    return *last_account_;
+  }
+};
+#endif
+
+}  // namespace match
+
+/**
+ * \brief Charges one object of bytes bytes of component to the memory estimate
+ * \ingroup nvhls_module
+ *
+ * Called from constructors. component must be a string literal or otherwise
+ * constant per call site: its id is looked up once. Compiles to nothing for
+ * synthesis.
+ */
+#ifndef __SYNTHESIS__
+#define NVHLS_MEMORY(component, bytes)                                       \
+  do {                                                                       \
+    if (match::Memory::Get().Enabled()) {                                    \
+      static const unsigned int nvhls_memory_id = match::Memory::Get().Id(component); \
+      match::Memory::Get().Record(nvhls_memory_id, bytes);                   \
+    }                                                                        \
+  } while (0)
+
+/**
+ * \brief Charges bytes allocated on demand by component to the memory estimate
+ * \ingroup nvhls_module
+ */
+#define NVHLS_MEMORY_GROW(component, bytes)                                  \
+  do {                                                                       \
+    if (match::Memory::Get().Enabled()) {                                    \
+      static const unsigned int nvhls_memory_id = match::Memory::Get().Id(component); \
+      match::Memory::Get().Grow(nvhls_memory_id, bytes);                     \
+    }                                                                        \
+  } while (0)
+#else
+#define NVHLS_MEMORY(component, bytes) do {} while (0)
+#define NVHLS_MEMORY_GROW(component, bytes) do {} while (0)
+#endif
+
+#endif  // NVHLS_MEMORY_H
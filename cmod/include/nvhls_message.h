@@ -20,7 +20,108 @@
 #include <nvhls_connections_utils.h>
 
 #include <connections/message.h>
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <TypeToBits.h>
 
 class nvhls_message : public Connections::message {};
 
+/**
+ * \brief Declares the fields of a message once
+ * \ingroup nvhls_message
+ *
+ * \par Overview
+ * NVHLS_FIELDS(f1, f2, ...) goes in the class body after the field
+ * declarations and generates:
+ * - width: the sum of Wrapped<>::width of the fields, computed at compile time.
+ * - Marshall(): a Marshall of the fields in the listed order, f1 in the least significant bits.
+ * - NVHLS_FIELD_OFFSET(f) and NVHLS_FIELD_WIDTH(f): compile-time LSB position and width of field f.
+ * - Pack() and Unpack(): synthesizable conversion to and from NVUINTW(width) with set_slc/get_slc, in the same layout as Marshall().
+ * - In C++ simulation, TypeToBits, BitsToType, TypeToNVUINT and NVUINTToType (and therefore mem_array_sep and the MARSHALL_PORT paths that use them) go through Pack()/Unpack() and the nvhls::packed_bits fast path instead of the Marshaller.
+ *
+ * Fields can be of any type with a Wrapped<> width, including other
+ * NVHLS_FIELDS messages, but not C arrays or zero-width integers.  Up to 16
+ * fields are supported.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_message.h>
+ *
+ *      template <int AddrWidth>
+ *      class Request : public nvhls_message {
+ *       public:
+ *        NVUINTW(AddrWidth) addr;
+ *        NVUINT4 len;
+ *        bool write;
+ *
+ *        NVHLS_FIELDS(addr, len, write)
+ *      };
+ *      ...
+ *      // Request<32>::width == 37, NVHLS_FIELD_OFFSET(len) == 32
+ *      NVUINTW(Request<32>::width) bits = req.Pack();
+ *
+ * \endcode
+ * \par
+ *
+ */
+#define NVHLS_FIELDS(...)                                                       \
+  static const unsigned int nvhls_fields_begin_nvhls_offset = 0;               \
+  static const unsigned int nvhls_fields_begin_nvhls_width = 0;                \
+  NVHLS_FIELDS_EACH(NVHLS_FIELDS_LAYOUT, nvhls_fields_begin, __VA_ARGS__)       \
+  static const unsigned int width =                                            \
+      0 NVHLS_FIELDS_EACH(NVHLS_FIELDS_WIDTH, _, __VA_ARGS__);                  \
+  typedef void nvhls_fields_tag;                                               \
+  template <unsigned int Size>                                                 \
+  void Marshall(Marshaller<Size>& m) {                                         \
+    NVHLS_FIELDS_EACH(NVHLS_FIELDS_MARSHALL, _, __VA_ARGS__)                    \
+  }                                                                            \
+  NVUINTW(width) Pack() const {                                                \
+    NVUINTW(width) bits = 0;                                                   \
+    NVHLS_FIELDS_EACH(NVHLS_FIELDS_PACK, _, __VA_ARGS__)                        \
+    return bits;                                                               \
+  }                                                                            \
+  void Unpack(const NVUINTW(width) & bits) {                                   \
+    NVHLS_FIELDS_EACH(NVHLS_FIELDS_UNPACK, _, __VA_ARGS__)                      \
+  }
+
+#define NVHLS_FIELD_OFFSET(f) f##_nvhls_offset
+#define NVHLS_FIELD_WIDTH(f) f##_nvhls_width
+
+// Per-field expansions of NVHLS_FIELDS; P is the previous field
+#define NVHLS_FIELDS_LAYOUT(P, f)                                               \
+  static const unsigned int f##_nvhls_width = Wrapped<decltype(f)>::width;     \
+  static const unsigned int f##_nvhls_offset =                                 \
+      P##_nvhls_offset + P##_nvhls_width;
+#define NVHLS_FIELDS_WIDTH(P, f) +f##_nvhls_width
+#define NVHLS_FIELDS_MARSHALL(P, f) m& f;
+#define NVHLS_FIELDS_PACK(P, f) \
+  bits = nvhls::set_slc(bits, TypeToNVUINT(f), f##_nvhls_offset);
+#define NVHLS_FIELDS_UNPACK(P, f)                                          \
+  f = NVUINTToType<decltype(f)>(                                            \
+      nvhls::get_slc<f##_nvhls_width>(bits, f##_nvhls_offset));
+
+// Applies M(previous, field) to each of up to 16 fields
+#define NVHLS_FIELDS_CAT(a, b) NVHLS_FIELDS_CAT_(a, b)
+#define NVHLS_FIELDS_CAT_(a, b) a##b
+#define NVHLS_FIELDS_NARG(...) NVHLS_FIELDS_NARG_(__VA_ARGS__, 16,15,14,13,12,11,10,9,8,7,6,5,4,3,2,1)
+#define NVHLS_FIELDS_NARG_(_1,_2,_3,_4,_5,_6,_7,_8,_9,_10,_11,_12,_13,_14,_15,_16, N, ...) N
+#define NVHLS_FIELDS_EACH(M, P, ...) \
+  NVHLS_FIELDS_CAT(NVHLS_FIELDS_EACH_, NVHLS_FIELDS_NARG(__VA_ARGS__))(M, P, __VA_ARGS__)
+#define NVHLS_FIELDS_EACH_1(M, P, a) M(P, a)
+#define NVHLS_FIELDS_EACH_2(M, P, a, ...) M(P, a) NVHLS_FIELDS_EACH_1(M, a, __VA_ARGS__)
+#define NVHLS_FIELDS_EACH_3(M, P, a, ...) M(P, a) NVHLS_FIELDS_EACH_2(M, a, __VA_ARGS__)
+#define NVHLS_FIELDS_EACH_4(M, P, a, ...) M(P, a) NVHLS_FIELDS_EACH_3(M, a, __VA_ARGS__)
+#define NVHLS_FIELDS_EACH_5(M, P, a, ...) M(P, a) NVHLS_FIELDS_EACH_4(M, a, __VA_ARGS__)
+#define NVHLS_FIELDS_EACH_6(M, P, a, ...) M(P, a) NVHLS_FIELDS_EACH_5(M, a, __VA_ARGS__)
+#define NVHLS_FIELDS_EACH_7(M, P, a, ...) M(P, a) NVHLS_FIELDS_EACH_6(M, a, __VA_ARGS__)
+#define NVHLS_FIELDS_EACH_8(M, P, a, ...) M(P, a) NVHLS_FIELDS_EACH_7(M, a, __VA_ARGS__)
+#define NVHLS_FIELDS_EACH_9(M, P, a, ...) M(P, a) NVHLS_FIELDS_EACH_8(M, a, __VA_ARGS__)
+#define NVHLS_FIELDS_EACH_10(M, P, a, ...) M(P, a) NVHLS_FIELDS_EACH_9(M, a, __VA_ARGS__)
+#define NVHLS_FIELDS_EACH_11(M, P, a, ...) M(P, a) NVHLS_FIELDS_EACH_10(M, a, __VA_ARGS__)
+#define NVHLS_FIELDS_EACH_12(M, P, a, ...) M(P, a) NVHLS_FIELDS_EACH_11(M, a, __VA_ARGS__)
+#define NVHLS_FIELDS_EACH_13(M, P, a, ...) M(P, a) NVHLS_FIELDS_EACH_12(M, a, __VA_ARGS__)
+#define NVHLS_FIELDS_EACH_14(M, P, a, ...) M(P, a) NVHLS_FIELDS_EACH_13(M, a, __VA_ARGS__)
+#define NVHLS_FIELDS_EACH_15(M, P, a, ...) M(P, a) NVHLS_FIELDS_EACH_14(M, a, __VA_ARGS__)
+#define NVHLS_FIELDS_EACH_16(M, P, a, ...) M(P, a) NVHLS_FIELDS_EACH_15(M, a, __VA_ARGS__)
+
 #endif
@@ -17,7 +17,15 @@
 #define MATCH_MODULE_H
 
 #ifndef __SYNTHESIS__
+#include <algorithm>
+#include <cstdlib>
 #include <map>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <rapidjson/document.h>
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
 #endif
 
 /**
@@ -40,9 +48,39 @@
 #define NVHLS_POS_RESET_SIGNAL_IS(port) async_reset_signal_is(port,true)
 #endif // defined(ENABLE_SYNC_RESET)
 
+#include <nvhls_assert.h>
 #include <nvhls_trace.h>
+#include <nvhls_chrome_trace.h>
 #include <nvhls_marshaller.h>
 #include <nvhls_message.h>
+#include <nvhls_checkpoint.h>
+#include <nvhls_energy.h>
+#include <nvhls_memory.h>
+
+/**
+ * \brief NVHLS_TRACE_MAX_LEVEL define: Highest trace level compiled into the simulation.
+ * \ingroup nvhls_module
+ *
+ * Trace statements written with NVHLS_T(l) above this level are removed at
+ * compile time. Defaults to no limit.
+ */
+#ifndef NVHLS_TRACE_MAX_LEVEL
+#define NVHLS_TRACE_MAX_LEVEL 0x7fffffff
+#endif
+
+/**
+ * \brief NVHLS_T define: Trace statement of a match::Module that costs nothing when disabled.
+ * \ingroup nvhls_module
+ *
+ * NVHLS_T(l) << a << b << EndT; behaves like T(l) << a << b << EndT; but
+ * evaluates neither the prefix nor the arguments unless level l is traced,
+ * and compiles to nothing if l is a constant above NVHLS_TRACE_MAX_LEVEL.
+ * Use it in hot loops, where T(l) still formats its arguments.
+ */
+#define NVHLS_T(l)                                                     \
+  if (((l) > NVHLS_TRACE_MAX_LEVEL) || !this->TraceEnabled(l)) {       \
+  } else                                                               \
+    this->T(l)
 
 /**
  * \brief nvhls_concat define: Concatenate two strings, separate with an underscore.
@@ -102,6 +140,67 @@ namespace match {
  *
  * \endcode
  *
+ * \par Stats
+ * IncrStat() and IncrStatIndexed() look the stat up by name on every call.
+ * For stats that are updated every cycle, register them once in the
+ * constructor and increment through the returned handle, which is an index
+ * into a flat array:
+ * \code
+ *   StatHandle flits_ = RegisterStat("flits");
+ *   StatHandle lane_flits_ = RegisterStatIndexed("lane_flits", NumLanes);
+ *   ...
+ *   IncrStat(flits_);
+ *   IncrStatIndexed(lane_flits_, lane);
+ * \endcode
+ * Both kinds of stats are printed together by DumpStats(), under the same
+ * names.
+ *
+ * Distributions, e.g. of latencies, are registered the same way and record
+ * samples with RecordSample(). Each one keeps the count, min, max and mean
+ * of its samples and, depending on how it was registered, buckets of fixed
+ * width (RegisterHistogram()), power-of-two buckets (RegisterLog2Histogram())
+ * or the sum of the samples in each period of simulated time
+ * (RegisterTimeSeries()):
+ * \code
+ *   DistHandle latency_ = RegisterLog2Histogram("latency", 16);
+ *   DistHandle flits_per_us_ = RegisterTimeSeries("flits", sc_time(1, SC_US));
+ *   ...
+ *   RecordSample(latency_, done_cycle - start_cycle);
+ *   RecordSample(flits_per_us_, 1);
+ * \endcode
+ * DumpStats() prints each distribution that has samples after the counters.
+ * Distributions are not added into the totals of parent modules.
+ *
+ * When a match::Energy coefficient table is loaded, DumpStats() also prints
+ * the energy charged to each module by the FIFOs, memories, crossbars and
+ * buffered channels inside it, as energy_fJ and energy_fJ.<component>
+ * (see nvhls_energy.h). These are added into the totals like counters.
+ * Likewise, when match::Memory is enabled, DumpStats() prints the approximate
+ * simulation memory of the components built inside each module as mem_bytes
+ * and mem_bytes.<component> (see nvhls_memory.h).
+ *
+ * \par Run-time configuration
+ * Rules read at the end of elaboration override the trace levels set in code
+ * and select the modules that collect stats without recompiling. A rule is a
+ * <pattern> and a <value>. A pattern is a full hierarchical module name, or a
+ * prefix followed by '*' ("*" matches every module). The last rule that
+ * matches a module applies.
+ * - NVHLS_TRACE rules set the trace level, e.g. NVHLS_TRACE="tb.dut.noc*=3,tb.dut.noc.r0=0".
+ * - NVHLS_STATS rules enable (1) or disable (0) stats; a rule without a value enables. If there are stats rules, modules that match none collect no stats, e.g. NVHLS_STATS="tb.dut.noc*". Without stats rules, all modules collect stats.
+ *
+ * The rules come from a JSON file named by the NVHLS_CONFIG environment
+ * variable, followed by the comma-separated rules of the NVHLS_TRACE and
+ * NVHLS_STATS environment variables, so the environment overrides the file
+ * for a single run. The file maps patterns to values in the order they
+ * apply, e.g.
+ * \code
+ *   {"trace": {"tb.dut.noc*": 3, "tb.dut.noc.r0": 0},
+ *    "stats": {"tb.dut.noc*": 1}}
+ * \endcode
+ *
+ * Modules that collect no stats return from IncrStat(), RecordSample() and
+ * RecordEvent() after one check.
+ *
  */
 
 class Module : public sc_module, public nvhls_message {
@@ -115,34 +214,86 @@ class Module : public sc_module, public nvhls_message {
 
   Module() : sc_module(sc_gen_unique_name("module")), clk("clk"), rst("rst") {
 #ifndef __SYNTHESIS__
-    module_indicator = new sc_attr_base("match_module");
+    module_indicator = &ModuleIndicator();
     this->add_attribute(*module_indicator);
+    tracer_.SetSource(name());
+    chrome_track_ = -1;
+    children_cached_ = false;
+    subtree_has_stats_ = children_have_stats_ = false;
+    stats_enabled_ = true;
 #endif
   }
   Module(sc_module_name nm) : sc_module(nm), clk("clk"), rst("rst") {
 #ifndef __SYNTHESIS__
-    module_indicator = new sc_attr_base("match_module");
+    module_indicator = &ModuleIndicator();
     this->add_attribute(*module_indicator);
+    tracer_.SetSource(name());
+    chrome_track_ = -1;
+    children_cached_ = false;
+    subtree_has_stats_ = children_have_stats_ = false;
+    stats_enabled_ = true;
 #endif
   }
 
-  ~Module() {
-#ifndef __SYNTHESIS__
-    delete module_indicator;
-#endif
-  }
+  ~Module() {}
 
  protected:
+  /* Handle of a registered stat: index of its first counter. */
+  struct StatHandle {
+    unsigned int idx;
+  };
+  /* Handle of a registered distribution. */
+  struct DistHandle {
+    unsigned int idx;
+  };
 
 #ifndef __SYNTHESIS__
   /* A map to store simulation stats. Not instantiated for synthesis. */
   std::map<std::string, uint64> stats_;
+  /* Names and counters of registered stats. Not instantiated for synthesis. */
+  std::vector<std::string> stat_names_;
+  std::vector<uint64> stat_values_;
+  /* Registered distributions. Not instantiated for synthesis. */
+  enum DistKind { kHistogram, kLog2Histogram, kTimeSeries };
+  struct Distribution {
+    std::string name;
+    DistKind kind;
+    uint64 bucket_width;
+    sc_time period;
+    std::vector<uint64> buckets;
+    uint64 count, sum, min, max;
+  };
+  std::vector<Distribution> dists_;
+  /* Track of RecordEvent() in the Chrome trace, registered on first use. */
+  int chrome_track_;
+
+  DistHandle RegisterDist(const std::string& name, DistKind kind,
+                          unsigned int num_buckets, uint64 bucket_width,
+                          const sc_time& period) {
+    Distribution d;
+    d.name = name;
+    d.kind = kind;
+    d.bucket_width = (bucket_width == 0) ? 1 : bucket_width;
+    d.period = period;
+    d.buckets.assign(num_buckets, 0);
+    d.count = d.sum = d.max = 0;
+    d.min = ~static_cast<uint64>(0);
+    dists_.push_back(d);
+    DistHandle h;
+    h.idx = dists_.size() - 1;
+    return h;
+  }
 #endif
   Tracer tracer_;
   Flusher EndT;  // Note: this variable is excused from following naming
                  // conventions.
 #ifndef __SYNTHESIS__
-
+  /* The attribute that marks match::Modules. IsModule() only looks it up by
+   * name, so all Modules share one instance instead of allocating one each. */
+  static sc_attr_base& ModuleIndicator() {
+    static sc_attr_base indicator("match_module");
+    return indicator;
+  }
 
   bool IsModule(sc_object* obj) {
     if (!obj)
@@ -184,6 +335,8 @@ class Module : public sc_module, public nvhls_message {
 
   void IncrStat(const std::string& name, unsigned int num = 1) {
 #ifndef __SYNTHESIS__
+    if (!stats_enabled_)
+      return;
     stats_[name] = stats_[name] + num;
 #endif
   }
@@ -191,18 +344,165 @@ class Module : public sc_module, public nvhls_message {
   void IncrStatIndexed(const std::string& name, unsigned int idx,
                        unsigned int num = 1) {
 #ifndef __SYNTHESIS__
+    if (!stats_enabled_)
+      return;
     std::stringstream final_name;
     final_name << name << "_" << idx;
     stats_[final_name.str()] = stats_[final_name.str()] + num;
 #endif
   }
 
+  /* Register a stat and return its handle. Call at elaboration time. */
+  StatHandle RegisterStat(const std::string& name) {
+    StatHandle h;
+#ifndef __SYNTHESIS__
+    h.idx = stat_names_.size();
+    stat_names_.push_back(name);
+    stat_values_.push_back(0);
+#else
+    h.idx = 0;
+#endif
+    return h;
+  }
+
+  /* Register num stats named name_0 ... name_<num-1>. */
+  StatHandle RegisterStatIndexed(const std::string& name, unsigned int num) {
+    StatHandle h;
+#ifndef __SYNTHESIS__
+    h.idx = stat_names_.size();
+    for (unsigned int i = 0; i < num; i++) {
+      std::stringstream final_name;
+      final_name << name << "_" << i;
+      stat_names_.push_back(final_name.str());
+      stat_values_.push_back(0);
+    }
+#else
+    h.idx = 0;
+#endif
+    return h;
+  }
+
+  /* Register a member with a Marshall() method (FIFO, mem_array_sep, Packet,
+   * NVUINT, ...) for match::Checkpointer under <module name>.<name>. Call at
+   * elaboration time. */
+  template <typename T>
+  void RegisterCheckpoint(const std::string& name, T& obj) {
+#ifndef __SYNTHESIS__
+    CheckpointRegistry::Add(std::string(this->name()) + "." + name, obj);
+#endif
+  }
+
+  void IncrStat(StatHandle h, unsigned int num = 1) {
+#ifndef __SYNTHESIS__
+    if (stats_enabled_)
+      stat_values_[h.idx] += num;
+#endif
+  }
+
+  void IncrStatIndexed(StatHandle h, unsigned int idx, unsigned int num = 1) {
+#ifndef __SYNTHESIS__
+    if (stats_enabled_)
+      stat_values_[h.idx + idx] += num;
+#endif
+  }
+
+  /* Register a histogram with num_buckets (at least 1) buckets of
+   * bucket_width values. Samples above the last bucket are counted in the
+   * last bucket. */
+  DistHandle RegisterHistogram(const std::string& name, unsigned int num_buckets,
+                               uint64 bucket_width = 1) {
+#ifndef __SYNTHESIS__
+    NVHLS_ASSERT_MSG(num_buckets > 0, "Histogram needs at least one bucket");
+    return RegisterDist(name, kHistogram, num_buckets, bucket_width, SC_ZERO_TIME);
+#else
+    DistHandle h;
+    h.idx = 0;
+    return h;
+#endif
+  }
+
+  /* Register a histogram with bucket 0 for the value 0 and bucket i for
+   * values in [2^(i-1), 2^i), num_buckets being at least 1. Samples above
+   * the last bucket are counted in the last bucket. */
+  DistHandle RegisterLog2Histogram(const std::string& name,
+                                   unsigned int num_buckets = 32) {
+#ifndef __SYNTHESIS__
+    NVHLS_ASSERT_MSG(num_buckets > 0, "Histogram needs at least one bucket");
+    return RegisterDist(name, kLog2Histogram, num_buckets, 1, SC_ZERO_TIME);
+#else
+    DistHandle h;
+    h.idx = 0;
+    return h;
+#endif
+  }
+
+  /* Register a time series that sums the samples of each period of
+   * simulated time. */
+  DistHandle RegisterTimeSeries(const std::string& name, const sc_time& period) {
+#ifndef __SYNTHESIS__
+    return RegisterDist(name, kTimeSeries, 0, 1, period);
+#else
+    DistHandle h;
+    h.idx = 0;
+    return h;
+#endif
+  }
+
+  void RecordSample(DistHandle h, uint64 value) {
+#ifndef __SYNTHESIS__
+    if (!stats_enabled_)
+      return;
+    Distribution& d = dists_[h.idx];
+    d.count++;
+    d.sum += value;
+    d.min = (value < d.min) ? value : d.min;
+    d.max = (value > d.max) ? value : d.max;
+    uint64 bucket;
+    if (d.kind == kTimeSeries) {
+      bucket = static_cast<uint64>(sc_time_stamp() / d.period);
+      if (bucket >= d.buckets.size())
+        d.buckets.resize(bucket + 1, 0);
+    } else {
+      if (d.kind == kHistogram) {
+        bucket = value / d.bucket_width;
+      } else {
+        bucket = 0;
+        while (value >> bucket)
+          bucket++;
+      }
+      if (bucket >= d.buckets.size())
+        bucket = d.buckets.size() - 1;
+    }
+    d.buckets[bucket] += (d.kind == kTimeSeries) ? value : 1;
+#endif
+  }
+
+  /* Whether T(l) prints. */
+  bool TraceEnabled(int l) {
+#ifdef NOPRINT
+    l = 10;
+#endif
+#ifndef __SYNTHESIS__
+    return (l <= NVHLS_TRACE_MAX_LEVEL) && (l <= tracer_.GetTraceLevel());
+#else
+    return false;
+#endif
+  }
+
   Tracer& T(int l = 0) {
 #ifdef NOPRINT
     l = 10;
 #endif
 #ifndef __SYNTHESIS__
+    // Nothing is printed, so skip the prefix.
+    if ((l > NVHLS_TRACE_MAX_LEVEL) || (l > tracer_.GetTraceLevel())) {
+      tracer_.SetCurrentLevel(tracer_.GetTraceLevel() + 1);
+      return tracer_;
+    }
     tracer_.SetCurrentLevel(l);
+    // A trace sink records time and module with each message.
+    if (Tracer::GetSink() != NULL)
+      return tracer_;
     tracer_ << sc_time_stamp() << ": ";
     if (get_parent() != NULL) {
       if (get_parent()->get_parent() != NULL) {
@@ -272,16 +572,38 @@ class Module : public sc_module, public nvhls_message {
 
  protected:
   void RecordEvent(const std::string& name, uint64 param = 0) {
-// Param is ignored fore now.
+// Counted as a stat; recorded with param while a ChromeTrace is open.
 #ifndef __SYNTHESIS__
+    if (!stats_enabled_)
+      return;
     IncrStat(name);
+    ChromeTrace& trace = ChromeTrace::Get();
+    if (trace.Enabled()) {
+      if (chrome_track_ < 0)
+        chrome_track_ = trace.RegisterTrack(sc_module::name());
+      trace.Instant(chrome_track_, name, param);
+    }
 #endif
   }
 
   void PrintStats(std::ostream& ofile, unsigned int lvl, Module* aggregator) {
 #ifndef __SYNTHESIS__
-      for (std::map<std::string, uint64>::iterator it = stats_.begin();
-           it != stats_.end(); it++) {
+      // Merge registered stats that were incremented into the named ones.
+      std::map<std::string, uint64> all_stats = stats_;
+      for (unsigned int i = 0; i < stat_values_.size(); i++) {
+        if (stat_values_[i] != 0)
+          all_stats[stat_names_[i]] += stat_values_[i];
+      }
+      std::vector<std::pair<std::string, uint64> > energy;
+      Energy::Get().OwnerStats(this, energy);
+      for (unsigned int i = 0; i < energy.size(); i++)
+        all_stats[energy[i].first] += energy[i].second;
+      std::vector<std::pair<std::string, uint64> > memory;
+      Memory::Get().OwnerStats(this, memory);
+      for (unsigned int i = 0; i < memory.size(); i++)
+        all_stats[memory[i].first] += memory[i].second;
+      for (std::map<std::string, uint64>::iterator it = all_stats.begin();
+           it != all_stats.end(); it++) {
         Indent(ofile, lvl);
         ofile << it->first << ": " << it->second << std::endl;
         // Add stat into subtotal if necessary.
@@ -290,6 +612,38 @@ class Module : public sc_module, public nvhls_message {
       }
 #endif
   }
+#ifndef __SYNTHESIS__
+  void PrintDist(std::ostream& ofile, unsigned int lvl, const Distribution& d) {
+    if (d.count == 0)
+      return;
+    Indent(ofile, lvl);
+    ofile << d.name << ": count " << d.count << ", min " << d.min << ", max "
+          << d.max << ", mean " << static_cast<double>(d.sum) / d.count
+          << std::endl;
+    for (unsigned int b = 0; b < d.buckets.size(); b++) {
+      if (d.buckets[b] == 0)
+        continue;
+      Indent(ofile, lvl + 1);
+      if (d.kind == kTimeSeries) {
+        ofile << "[" << d.period * b << ", " << d.period * (b + 1) << ")";
+      } else if (d.kind == kHistogram) {
+        ofile << "[" << b * d.bucket_width << ", ";
+        if (b + 1 == d.buckets.size())
+          ofile << "inf)";
+        else
+          ofile << (b + 1) * d.bucket_width << ")";
+      } else {
+        ofile << "[" << ((b == 0) ? 0 : (static_cast<uint64>(1) << (b - 1)))
+              << ", ";
+        if (b + 1 == d.buckets.size())
+          ofile << "inf)";
+        else
+          ofile << (static_cast<uint64>(1) << b) << ")";
+      }
+      ofile << ": " << d.buckets[b] << std::endl;
+    }
+  }
+#endif
   void Indent(std::ostream& ofile, unsigned int lvl) {
 #ifndef __SYNTHESIS__
     for (unsigned int x = 0; x < 2 * lvl; x++) {
@@ -301,7 +655,17 @@ class Module : public sc_module, public nvhls_message {
  public:
   bool HasStats() {
 #ifndef __SYNTHESIS__
-    return (stats_.size() != 0);
+    if (stats_.size() != 0)
+      return true;
+    for (unsigned int i = 0; i < stat_values_.size(); i++) {
+      if (stat_values_[i] != 0)
+        return true;
+    }
+    for (unsigned int i = 0; i < dists_.size(); i++) {
+      if (dists_[i].count != 0)
+        return true;
+    }
+    return Energy::Get().HasEnergy(this) || Memory::Get().HasMemory(this);
 #else
     return false;
 #endif
@@ -309,50 +673,402 @@ class Module : public sc_module, public nvhls_message {
   bool ChildrenHaveStats() {
     bool has_stats = false;
 #ifndef __SYNTHESIS__
-    std::vector<Module*> children = GetChildren();
-    if(children.size() != 0) {
-        for (unsigned int x = 0; x < children.size(); x++) {
-          has_stats |= children[x]->HasStats();
-          if(!has_stats) {
-            has_stats |= children[x]->ChildrenHaveStats();
-          }
+    const std::vector<Module*>& children = Children();
+    for (unsigned int x = 0; x < children.size() && !has_stats; x++) {
+      has_stats |= children[x]->HasStats();
+      if(!has_stats) {
+        has_stats |= children[x]->ChildrenHaveStats();
       }
     }
 #endif
     return has_stats;
   }
+  /* Appends the counters of this module, and with recursive of its child
+   * Modules, to out as (<module name>.<stat name>, value). */
+  void CollectStats(std::vector<std::pair<std::string, uint64> >& out,
+                    bool recursive = true) {
+#ifndef __SYNTHESIS__
+    StatVec own;
+    OwnStats(own);
+    std::string prefix = std::string(name()) + ".";
+    for (unsigned int i = 0; i < own.size(); i++)
+      out.push_back(std::make_pair(prefix + StatNames()[own[i].first], own[i].second));
+    if (recursive) {
+      const std::vector<Module*>& children = Children();
+      for (unsigned int x = 0; x < children.size(); x++)
+        children[x]->CollectStats(out, true);
+    }
+#endif
+  }
   void DumpStats(std::ostream& ofile, unsigned int lvl, Module* aggregator) {
 #ifndef __SYNTHESIS__
-    if (!HasStats() && !ChildrenHaveStats()) {
-      return;
+    MarkStats();
+    StatVec totals;
+    DumpStatsTree(ofile, lvl, totals);
+    // Callers outside the hierarchy get the totals by name.
+    if (aggregator) {
+      for (unsigned int i = 0; i < totals.size(); i++)
+        aggregator->IncrStat(StatNames()[totals[i].first], totals[i].second);
     }
+#endif
+  }
+  /* Writes the stats of this module and its children as nested JSON objects:
+   * {"name": ..., "stats": {...}, "distributions": [...], "children": [...],
+   * "totals": {...}}.
+   * Each distribution with samples is {"name", "kind", "count", "min", "max",
+   * "mean", "buckets"}, kind being "histogram", "log2_histogram" or
+   * "time_series", with one {"lo", "hi", "value"} per non-empty bucket. "hi"
+   * is null for the open last bucket of a histogram, and time-series bounds
+   * are in seconds. "totals" sums the counters of the subtree and is only
+   * written for modules with children that have stats. */
+  void DumpStatsJson(std::ostream& ofile) {
+#ifndef __SYNTHESIS__
+    MarkStats();
+    StatVec totals;
+    rapidjson::StringBuffer buffer;
+    JsonWriter writer(buffer);
+    writer.SetIndent(' ', 2);
+    DumpStatsJsonTree(writer, totals);
+    ofile << buffer.GetString() << std::endl;
+#endif
+  }
 
-    Indent(ofile, lvl);
-    ofile << name() << ":" << std::endl;
-    Module* final_aggregator = ChildrenHaveStats() ? NULL : aggregator;
-    if(HasStats())
-      PrintStats(ofile, lvl + 1, final_aggregator);
+ protected:
+#ifndef __SYNTHESIS__
+  /* Children Modules, collected once after elaboration. */
+  std::vector<Module*> children_cache_;
+  bool children_cached_;
+  /* Set by MarkStats(): this module or one of its children has stats. */
+  bool subtree_has_stats_;
+  bool children_have_stats_;
 
-    std::vector<Module*> children = GetChildren();
+  /* Cleared for modules that the stats rules exclude. */
+  bool stats_enabled_;
+
+  void end_of_elaboration() {
+    sc_module::end_of_elaboration();
+    Children();
+    ApplyConfig();
+    Memory::Get().ElaborationReport();
+  }
+
+  /* Applies the trace and stats rules to this module. */
+  void ApplyConfig() {
+    int value;
+    if (ConfigLookup("NVHLS_TRACE", "trace", name(), value))
+      tracer_.SetTraceLevel(value);
+    if (!ConfigRules("NVHLS_STATS", "stats").empty())
+      stats_enabled_ = ConfigLookup("NVHLS_STATS", "stats", name(), value) && (value != 0);
+  }
+
+  typedef std::vector<std::pair<std::string, int> > ConfigRuleVec;
+
+  /* The rules of member key of the NVHLS_CONFIG file followed by those of
+   * environment variable env. Parsed once per variable. */
+  static const ConfigRuleVec& ConfigRules(const char* env, const char* key) {
+    static std::map<std::string, ConfigRuleVec> parsed;
+    std::map<std::string, ConfigRuleVec>::iterator it = parsed.find(env);
+    if (it != parsed.end())
+      return it->second;
+    ConfigRuleVec rules;
+    const char* file_name = std::getenv("NVHLS_CONFIG");
+    if (file_name != NULL) {
+      std::ifstream file(file_name);
+      std::stringstream text;
+      text << file.rdbuf();
+      rapidjson::Document doc;
+      doc.Parse(text.str().c_str());
+      if (!file || doc.HasParseError() || !doc.IsObject()) {
+        SC_REPORT_ERROR("Module", (std::string("NVHLS_CONFIG ") + file_name +
+                                   " is not a readable JSON object").c_str());
+      } else if (doc.HasMember(key) && doc[key].IsObject()) {
+        const rapidjson::Value& obj = doc[key];
+        for (rapidjson::Value::ConstMemberIterator m = obj.MemberBegin();
+             m != obj.MemberEnd(); ++m) {
+          int rule_value = m->value.IsInt() ? m->value.GetInt() : 1;
+          rules.push_back(std::make_pair(std::string(m->name.GetString()), rule_value));
+        }
+      }
+    }
+    const char* text = std::getenv(env);
+    std::stringstream ss((text != NULL) ? text : "");
+    std::string rule;
+    while (std::getline(ss, rule, ',')) {
+      if (rule.empty())
+        continue;
+      size_t eq = rule.find('=');
+      if (eq == std::string::npos)
+        rules.push_back(std::make_pair(rule, 1));
+      else
+        rules.push_back(std::make_pair(rule.substr(0, eq), atoi(rule.c_str() + eq + 1)));
+    }
+    return parsed.insert(std::make_pair(std::string(env), rules)).first->second;
+  }
+
+  /* Finds the value of the last rule of env and key that matches module. */
+  static bool ConfigLookup(const char* env, const char* key, const std::string& module,
+                           int& value) {
+    bool found = false;
+    const ConfigRuleVec& rules = ConfigRules(env, key);
+    for (unsigned int i = 0; i < rules.size(); i++) {
+      const std::string& pattern = rules[i].first;
+      bool match;
+      if (!pattern.empty() && pattern[pattern.size() - 1] == '*')
+        match = (module.compare(0, pattern.size() - 1, pattern, 0, pattern.size() - 1) == 0);
+      else
+        match = (module == pattern);
+      if (match) {
+        value = rules[i].second;
+        found = true;
+      }
+    }
+    return found;
+  }
+
+  const std::vector<Module*>& Children() {
+    // The hierarchy is fixed once elaboration is done.
+    if (!children_cached_) {
+      children_cache_ = GetChildren();
+      children_cached_ = (sc_get_status() != SC_ELABORATION);
+    }
+    return children_cache_;
+  }
 
-    if (ChildrenHaveStats()) {
+  /* Counters keyed by an id that is unique per stat name, sorted by id. */
+  typedef std::vector<std::pair<unsigned int, uint64> > StatVec;
 
+  static std::map<std::string, unsigned int>& StatIds() {
+    static std::map<std::string, unsigned int> ids;
+    return ids;
+  }
+  static std::vector<std::string>& StatNames() {
+    static std::vector<std::string> names;
+    return names;
+  }
+  static unsigned int StatId(const std::string& name) {
+    std::map<std::string, unsigned int>::iterator it = StatIds().find(name);
+    if (it != StatIds().end())
+      return it->second;
+    unsigned int id = StatNames().size();
+    StatIds()[name] = id;
+    StatNames().push_back(name);
+    return id;
+  }
+
+  // Adds src into dst; both are sorted by id.
+  static void MergeStats(StatVec& dst, const StatVec& src) {
+    StatVec merged;
+    merged.reserve(dst.size() + src.size());
+    unsigned int i = 0, j = 0;
+    while (i < dst.size() || j < src.size()) {
+      if (j == src.size() || (i < dst.size() && dst[i].first < src[j].first)) {
+        merged.push_back(dst[i++]);
+      } else if (i == dst.size() || src[j].first < dst[i].first) {
+        merged.push_back(src[j++]);
+      } else {
+        merged.push_back(std::make_pair(dst[i].first, dst[i].second + src[j].second));
+        i++;
+        j++;
+      }
+    }
+    dst.swap(merged);
+  }
+
+  // The counters of this module, printed by PrintStats().
+  void OwnStats(StatVec& own) {
+    own.clear();
+    for (std::map<std::string, uint64>::iterator it = stats_.begin();
+         it != stats_.end(); it++) {
+      own.push_back(std::make_pair(StatId(it->first), it->second));
+    }
+    for (unsigned int i = 0; i < stat_values_.size(); i++) {
+      if (stat_values_[i] != 0)
+        own.push_back(std::make_pair(StatId(stat_names_[i]), stat_values_[i]));
+    }
+    std::vector<std::pair<std::string, uint64> > energy;
+    Energy::Get().OwnerStats(this, energy);
+    for (unsigned int i = 0; i < energy.size(); i++)
+      own.push_back(std::make_pair(StatId(energy[i].first), energy[i].second));
+    std::vector<std::pair<std::string, uint64> > memory;
+    Memory::Get().OwnerStats(this, memory);
+    for (unsigned int i = 0; i < memory.size(); i++)
+      own.push_back(std::make_pair(StatId(memory[i].first), memory[i].second));
+    std::sort(own.begin(), own.end());
+    // A name may be both registered and used by name.
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < own.size(); i++) {
+      if (n > 0 && own[n - 1].first == own[i].first)
+        own[n - 1].second += own[i].second;
+      else
+        own[n++] = own[i];
+    }
+    own.resize(n);
+  }
+
+  // Prints counters sorted by name, as PrintStats() does.
+  void PrintStatVec(std::ostream& ofile, unsigned int lvl, const StatVec& stats) {
+    std::vector<std::pair<std::string, uint64> > named;
+    for (unsigned int i = 0; i < stats.size(); i++)
+      named.push_back(std::make_pair(StatNames()[stats[i].first], stats[i].second));
+    std::sort(named.begin(), named.end());
+    for (unsigned int i = 0; i < named.size(); i++) {
+      Indent(ofile, lvl);
+      ofile << named[i].first << ": " << named[i].second << std::endl;
+    }
+  }
+
+  // One pass over the tree: sets subtree_has_stats_ and children_have_stats_.
+  bool MarkStats() {
+    children_have_stats_ = false;
+    const std::vector<Module*>& children = Children();
+    for (unsigned int x = 0; x < children.size(); x++) {
+      children_have_stats_ |= children[x]->MarkStats();
+    }
+    subtree_has_stats_ = children_have_stats_ || HasStats();
+    return subtree_has_stats_;
+  }
+
+  // Prints the subtree after MarkStats() and adds its totals to totals.
+  void DumpStatsTree(std::ostream& ofile, unsigned int lvl, StatVec& totals) {
+    if (!subtree_has_stats_)
+      return;
+
+    Indent(ofile, lvl);
+    ofile << name() << ":" << std::endl;
+    StatVec subtotals;
+    OwnStats(subtotals);
+    if (HasStats()) {
+      PrintStats(ofile, lvl + 1, NULL);
+      for (unsigned int i = 0; i < dists_.size(); i++) {
+        PrintDist(ofile, lvl + 1, dists_[i]);
+      }
+    }
+
+    if (children_have_stats_) {
+      const std::vector<Module*>& children = Children();
       for (unsigned int x = 0; x < children.size(); x++) {
-        children[x]->DumpStats(ofile, lvl + 1, this);
+        children[x]->DumpStatsTree(ofile, lvl + 1, subtotals);
       }
 
       if (lvl == 0) {
         Indent(ofile, 0);
         ofile << "Totals:" << std::endl;
-        PrintStats(ofile, 1, aggregator);
+        PrintStatVec(ofile, 1, subtotals);
       } else {
         Indent(ofile, lvl + 1);
         ofile << "Sub-totals (" << name() << "):" << std::endl;
-        PrintStats(ofile, lvl + 2, aggregator);
+        PrintStatVec(ofile, lvl + 2, subtotals);
       }
     }
-#endif
+    MergeStats(totals, subtotals);
+  }
+
+  typedef rapidjson::PrettyWriter<rapidjson::StringBuffer> JsonWriter;
+
+  static void WriteJsonString(JsonWriter& writer, const std::string& str) {
+    writer.String(str.c_str(), static_cast<rapidjson::SizeType>(str.size()));
+  }
+
+  void WriteJsonStats(JsonWriter& writer, const StatVec& stats) {
+    writer.StartObject();
+    for (unsigned int i = 0; i < stats.size(); i++) {
+      const std::string& name = StatNames()[stats[i].first];
+      writer.Key(name.c_str(), static_cast<rapidjson::SizeType>(name.size()));
+      writer.Uint64(stats[i].second);
+    }
+    writer.EndObject();
   }
+
+  void WriteJsonDist(JsonWriter& writer, const Distribution& d) {
+    static const char* kinds[] = {"histogram", "log2_histogram", "time_series"};
+    writer.StartObject();
+    writer.Key("name");
+    WriteJsonString(writer, d.name);
+    writer.Key("kind");
+    writer.String(kinds[d.kind]);
+    writer.Key("count");
+    writer.Uint64(d.count);
+    writer.Key("min");
+    writer.Uint64(d.min);
+    writer.Key("max");
+    writer.Uint64(d.max);
+    writer.Key("mean");
+    writer.Double(static_cast<double>(d.sum) / d.count);
+    writer.Key("buckets");
+    writer.StartArray();
+    for (unsigned int b = 0; b < d.buckets.size(); b++) {
+      if (d.buckets[b] == 0)
+        continue;
+      bool last = (b + 1 == d.buckets.size());
+      writer.StartObject();
+      if (d.kind == kTimeSeries) {
+        writer.Key("lo");
+        writer.Double((d.period * b).to_seconds());
+        writer.Key("hi");
+        writer.Double((d.period * (b + 1)).to_seconds());
+      } else if (d.kind == kHistogram) {
+        writer.Key("lo");
+        writer.Uint64(b * d.bucket_width);
+        writer.Key("hi");
+        if (last)
+          writer.Null();
+        else
+          writer.Uint64((b + 1) * d.bucket_width);
+      } else {
+        writer.Key("lo");
+        writer.Uint64((b == 0) ? 0 : (static_cast<uint64>(1) << (b - 1)));
+        writer.Key("hi");
+        if (last)
+          writer.Null();
+        else
+          writer.Uint64(static_cast<uint64>(1) << b);
+      }
+      writer.Key("value");
+      writer.Uint64(d.buckets[b]);
+      writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+  }
+
+  void DumpStatsJsonTree(JsonWriter& writer, StatVec& totals) {
+    StatVec subtotals;
+    OwnStats(subtotals);
+    writer.StartObject();
+    writer.Key("name");
+    WriteJsonString(writer, name());
+    writer.Key("stats");
+    WriteJsonStats(writer, subtotals);
+    bool has_dists = false;
+    for (unsigned int i = 0; i < dists_.size(); i++)
+      has_dists |= (dists_[i].count != 0);
+    if (has_dists) {
+      writer.Key("distributions");
+      writer.StartArray();
+      for (unsigned int i = 0; i < dists_.size(); i++) {
+        if (dists_[i].count != 0)
+          WriteJsonDist(writer, dists_[i]);
+      }
+      writer.EndArray();
+    }
+    if (children_have_stats_) {
+      writer.Key("children");
+      writer.StartArray();
+      const std::vector<Module*>& children = Children();
+      for (unsigned int x = 0; x < children.size(); x++) {
+        if (children[x]->subtree_has_stats_)
+          children[x]->DumpStatsJsonTree(writer, subtotals);
+      }
+      writer.EndArray();
+      writer.Key("totals");
+      WriteJsonStats(writer, subtotals);
+    }
+    writer.EndObject();
+    MergeStats(totals, subtotals);
+  }
+#endif
+
+ public:
   static const unsigned int width = 0;
   template <unsigned int Size>
   void Marshall(Marshaller<Size>& m) {
@@ -0,0 +1,363 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_MULT_H
+#define NVHLS_MULT_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_marshaller.h>
+
+namespace nvhls {
+
+// Number of rows left after one level of 3:2 carry-save adders on R rows
+template <unsigned int R>
+struct csa_rows_after {
+  static const unsigned int val = (R <= 2) ? R : 2 * (R / 3) + R % 3;
+};
+
+// Number of carry-save levels that reduce R rows to two
+template <unsigned int R, bool Done = (R <= 2)>
+struct csa_levels {
+  static const unsigned int val = 1 + csa_levels<csa_rows_after<R>::val>::val;
+};
+
+template <unsigned int R>
+struct csa_levels<R, true> {
+  static const unsigned int val = 0;
+};
+
+/**
+ * \brief Structure of a Booth multiplier of an AW-bit by a BW-bit unsigned operand
+ * \ingroup nvhls_int
+ *
+ * NumPP radix-4 Booth partial products plus one row of negation bits are
+ * reduced to two rows by CsaLevels levels of 3:2 carry-save adders (a
+ * Wallace tree on rows) and added by one carry-propagate adder, so a
+ * pipeline can be cut after any of the Levels = CsaLevels + 1 levels. All
+ * rows are kept modulo 2^(AW+BW), the width of the product.
+ */
+template <unsigned int AW, unsigned int BW>
+struct mult_traits {
+  static const unsigned int PW = AW + BW;
+  // One extra digit, as the top bit of an unsigned B must not be read as a sign
+  static const unsigned int NumPP = BW / 2 + 1;
+  static const unsigned int NumRows = NumPP + 1;
+  static const unsigned int CsaLevels = csa_levels<NumRows>::val;
+  static const unsigned int Levels = CsaLevels + 1;
+  typedef typename nvhls_t<PW>::nvuint_t row_t;
+};
+
+/**
+ * \brief Radix-4 Booth partial products of a * b
+ * \ingroup nvhls_int
+ *
+ * Row i is digit i of b, in {-2, -1, 0, 1, 2}, times a shifted by 2i. A
+ * negative row is stored as the complement of its magnitude, and the +1 that
+ * completes its negation is set at bit 2i of the last row, so that no row
+ * needs an adder. The rows add up to a * b modulo 2^(AW+BW).
+ */
+template <typename atype, typename btype>
+void booth_partial_products(
+    atype a, btype b,
+    typename mult_traits<Wrapped<atype>::width, Wrapped<btype>::width>::row_t
+        (&rows)[mult_traits<Wrapped<atype>::width, Wrapped<btype>::width>::NumRows]) {
+  static const unsigned int AW = Wrapped<atype>::width;
+  static const unsigned int BW = Wrapped<btype>::width;
+  typedef mult_traits<AW, BW> T;
+  typedef typename T::row_t row_t;
+  // b with a zero below bit 0 and zeros above its top bit
+  typename nvhls_t<2 * T::NumPP + 1>::nvuint_t bx = b;
+  bx = bx << 1;
+  row_t a1 = a;
+  row_t a2 = a1 << 1;
+  row_t neg_bits = 0;
+#pragma hls_unroll yes
+  for (unsigned int i = 0; i < T::NumPP; i++) {
+    bool lo = (bx[2 * i] == 1);
+    bool mid = (bx[2 * i + 1] == 1);
+    bool hi = (bx[2 * i + 2] == 1);
+    bool one = (mid != lo);
+    bool two = (hi && !mid && !lo) || (!hi && mid && lo);
+    row_t mag = 0;
+    if (one) {
+      mag = a1;
+    } else if (two) {
+      mag = a2;
+    }
+    if (hi) {
+      mag = ~mag;
+      neg_bits[2 * i] = 1;
+    }
+    rows[i] = mag << (2 * i);
+  }
+  rows[T::NumPP] = neg_bits;
+}
+
+/**
+ * \brief Applies levels [lo, hi) of the reduction of a Booth multiplier
+ * \ingroup nvhls_int
+ *
+ * Level l < CsaLevels replaces each group of three of the current rows by
+ * their carry-save sum and carry and moves the remaining rows down; level
+ * CsaLevels adds the last two rows. After all levels rows[0] holds the
+ * product.
+ */
+template <unsigned int AW, unsigned int BW>
+void mult_reduce_levels(typename mult_traits<AW, BW>::row_t (&rows)[mult_traits<AW, BW>::NumRows],
+                        unsigned int lo, unsigned int hi) {
+  typedef mult_traits<AW, BW> T;
+  typedef typename T::row_t row_t;
+  unsigned int num_rows = T::NumRows;
+#pragma hls_unroll yes
+  for (unsigned int l = 0; l < T::Levels; l++) {
+    unsigned int groups = num_rows / 3;
+    if ((l >= lo) && (l < hi)) {
+      if (l == T::CsaLevels) {
+        rows[0] = rows[0] + rows[1];
+      } else {
+        row_t next[T::NumRows];
+#pragma hls_unroll yes
+        for (unsigned int j = 0; j < T::NumRows; j++) {
+          if (j < groups) {
+            row_t x = rows[3 * j], y = rows[3 * j + 1], z = rows[3 * j + 2];
+            row_t carry = (x & y) | (x & z) | (y & z);
+            next[2 * j] = x ^ y ^ z;
+            next[2 * j + 1] = carry << 1;
+          } else if (j < groups + num_rows % 3) {
+            next[j + groups] = rows[j + 2 * groups];
+          }
+        }
+#pragma hls_unroll yes
+        for (unsigned int j = 0; j < T::NumRows; j++) {
+          if (j < 2 * groups + num_rows % 3) {
+            rows[j] = next[j];
+          }
+        }
+      }
+    }
+    num_rows = 2 * groups + num_rows % 3;
+  }
+}
+
+/**
+ * \brief Unsigned multiplier with radix-4 Booth partial products and a carry-save tree
+ * \ingroup nvhls_int
+ *
+ * \tparam atype                Datatype of a, nvuint type of AW bits
+ * \tparam btype                Datatype of b, nvuint type of BW bits
+ *
+ * \param[in]  a               Multiplicand
+ * \param[in]  b               Multiplier, Booth encoded
+ * \param[out] ReturnVal       a * b, of AW + BW bits
+ *
+ * \par Overview
+ * - Builds BW/2 + 1 partial products (booth_partial_products()), reduces them with a tree of 3:2 carry-save adders and adds the last two rows with one adder of AW + BW bits, instead of leaving the architecture of a * b to HLS.
+ * - The depth of the tree is mult_traits<AW, BW>::CsaLevels; PipelinedMultiply registers between its levels.
+ * - Booth encoding halves the partial products of the wider operand, so b should be the wider one for unequal widths.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_mult.h>
+ *
+ *      ...
+ *      NVUINTW(64) a, b;
+ *      NVUINTW(128) p = nvhls::booth_multiply<NVUINTW(64), NVUINTW(64)>(a, b);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename atype, typename btype>
+typename mult_traits<Wrapped<atype>::width, Wrapped<btype>::width>::row_t
+booth_multiply(atype a, btype b) {
+  static const unsigned int AW = Wrapped<atype>::width;
+  static const unsigned int BW = Wrapped<btype>::width;
+  typedef mult_traits<AW, BW> T;
+  typename T::row_t rows[T::NumRows];
+  booth_partial_products(a, b, rows);
+  mult_reduce_levels<AW, BW>(rows, 0, T::Levels);
+  return rows[0];
+}
+
+// Karatsuba recursion on W-bit operands; operands of at most Threshold bits
+// use booth_multiply. Widths of 3 or less are not split, as their middle
+// product would be as wide as the operands.
+template <unsigned int W, unsigned int Threshold, bool Split = (W > Threshold) && (W > 3)>
+struct karatsuba_mult {
+  typedef typename nvhls_t<W>::nvuint_t in_t;
+  typedef typename nvhls_t<2 * W>::nvuint_t out_t;
+
+  static out_t mult(in_t a, in_t b) {
+    return booth_multiply<in_t, in_t>(a, b);
+  }
+};
+
+template <unsigned int W, unsigned int Threshold>
+struct karatsuba_mult<W, Threshold, true> {
+  static const unsigned int H = W / 2;
+  static const unsigned int L = W - H;
+  typedef typename nvhls_t<W>::nvuint_t in_t;
+  typedef typename nvhls_t<2 * W>::nvuint_t out_t;
+  typedef typename nvhls_t<L>::nvuint_t half_t;
+  typedef typename nvhls_t<L + 1>::nvuint_t sum_t;
+
+  static out_t mult(in_t a, in_t b) {
+    half_t a0 = nvhls::get_slc<H>(a, 0);
+    half_t b0 = nvhls::get_slc<H>(b, 0);
+    half_t a1 = nvhls::get_slc<L>(a, H);
+    half_t b1 = nvhls::get_slc<L>(b, H);
+    sum_t a01 = a0;
+    sum_t b01 = b0;
+    a01 = a01 + a1;
+    b01 = b01 + b1;
+    out_t z0 = karatsuba_mult<L, Threshold>::mult(a0, b0);
+    out_t z2 = karatsuba_mult<L, Threshold>::mult(a1, b1);
+    out_t z1 = karatsuba_mult<L + 1, Threshold>::mult(a01, b01);
+    // (a0 + a1)(b0 + b1) - z0 - z2 = a0 b1 + a1 b0 >= 0, so the middle term
+    // is exact modulo 2^(2W)
+    z1 = z1 - z0;
+    z1 = z1 - z2;
+    out_t p = z2 << (2 * H);
+    out_t mid = z1 << H;
+    p = p + mid;
+    p = p + z0;
+    return p;
+  }
+};
+
+/**
+ * \brief Unsigned multiplier with Karatsuba decomposition
+ * \ingroup nvhls_int
+ *
+ * \tparam Threshold            Width at and below which booth_multiply is used
+ * \tparam type                 Datatype, nvuint type of W bits
+ *
+ * \param[in]  a               Multiplicand
+ * \param[in]  b               Multiplier
+ * \param[out] ReturnVal       a * b, of 2W bits
+ *
+ * \par Overview
+ * - Operands wider than Threshold are split into halves of floor(W/2) and ceil(W/2) bits and multiplied with three half-width products, (a0 + a1)(b0 + b1), a0 b0 and a1 b1, instead of four, recursively until the operands are at most Threshold bits wide.
+ * - Each level saves a quarter of the multiplier area at the cost of some adders of 2W bits, so Karatsuba pays off for wide operands. Threshold = W gives booth_multiply.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_mult.h>
+ *
+ *      ...
+ *      NVUINTW(256) a, b;
+ *      NVUINTW(512) p = nvhls::karatsuba_multiply<64, NVUINTW(256)>(a, b);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <unsigned int Threshold, typename type>
+typename nvhls_t<2 * Wrapped<type>::width>::nvuint_t karatsuba_multiply(type a, type b) {
+  return karatsuba_mult<Wrapped<type>::width, Threshold>::mult(a, b);
+}
+
+/**
+ * \brief Pipelined unsigned Booth multiplier
+ * \ingroup nvhls_int
+ *
+ * \tparam atype                Datatype of a, nvuint type of AW bits
+ * \tparam btype                Datatype of b, nvuint type of BW bits
+ * \tparam LevelsPerStage       Number of levels of the multiplier between pipeline registers
+ *
+ * \par Overview
+ * - The same multiplier as booth_multiply(), registered every LevelsPerStage of its Levels = mult_traits<AW, BW>::CsaLevels + 1 levels; the last level is the final adder.
+ * - Each call of run() is one cycle and accepts a new input, i.e. II=1. The product appears Latency calls later, with Latency = ceil(Levels / LevelsPerStage) - 1.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_mult.h>
+ *
+ *      ...
+ *      nvhls::PipelinedMultiply<NVUINTW(64), NVUINTW(64), 3> mult;
+ *      ...
+ *      bool out_valid = mult.run(in_valid, a, b, product);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename atype, typename btype, unsigned int LevelsPerStage>
+class PipelinedMultiply {
+  static const unsigned int AW = Wrapped<atype>::width;
+  static const unsigned int BW = Wrapped<btype>::width;
+  typedef mult_traits<AW, BW> T;
+
+ public:
+  typedef typename T::row_t out_t;
+  static const unsigned int NumGroups = (T::Levels + LevelsPerStage - 1) / LevelsPerStage;
+  static const unsigned int Latency = NumGroups - 1;
+
+ private:
+  static const unsigned int NumRegs = (Latency > 0) ? Latency : 1;
+  out_t regs[NumRegs][T::NumRows];
+  bool regs_valid[NumRegs];
+
+ public:
+  PipelinedMultiply() { reset(); }
+
+  void reset() {
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumRegs; i++) {
+      regs_valid[i] = false;
+    }
+  }
+
+  // Returns true if out holds a valid product in this cycle
+  bool run(bool in_valid, atype a, btype b, out_t& out) {
+    bool out_valid = false;
+#pragma hls_unroll yes
+    for (int g = NumGroups - 1; g >= 0; g--) {
+      out_t rows[T::NumRows];
+      bool valid;
+      if (g == 0) {
+        booth_partial_products(a, b, rows);
+        valid = in_valid;
+      } else {
+#pragma hls_unroll yes
+        for (unsigned int j = 0; j < T::NumRows; j++) {
+          rows[j] = regs[g - 1][j];
+        }
+        valid = regs_valid[g - 1];
+      }
+      mult_reduce_levels<AW, BW>(rows, g * LevelsPerStage, (g + 1) * LevelsPerStage);
+      if (g == static_cast<int>(NumGroups) - 1) {
+        out = rows[0];
+        out_valid = valid;
+      } else {
+#pragma hls_unroll yes
+        for (unsigned int j = 0; j < T::NumRows; j++) {
+          regs[g][j] = rows[j];
+        }
+        regs_valid[g] = valid;
+      }
+    }
+    return out_valid;
+  }
+};
+
+}  // namespace nvhls
+
+#endif
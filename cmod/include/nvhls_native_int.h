@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_NATIVE_INT_H
+#define NVHLS_NATIVE_INT_H
+
+#include <systemc.h>
+#include <nvhls_marshaller.h>
+#include <utility>
+
+namespace nvhls {
+
+template <bool S>
+struct native_int_value {
+  typedef uint64 type;
+};
+
+template <>
+struct native_int_value<true> {
+  typedef int64 type;
+};
+
+// Raw bits of an assigned value: native integers are cast, integer classes
+// (SystemC types, native_int and their slices) are read with to_uint64()
+#define NVHLS_NATIVE_BITS(T) \
+  inline uint64 native_bits(T v) { return static_cast<uint64>(v); }
+NVHLS_NATIVE_BITS(bool)
+NVHLS_NATIVE_BITS(char)
+NVHLS_NATIVE_BITS(signed char)
+NVHLS_NATIVE_BITS(unsigned char)
+NVHLS_NATIVE_BITS(short)
+NVHLS_NATIVE_BITS(unsigned short)
+NVHLS_NATIVE_BITS(int)
+NVHLS_NATIVE_BITS(unsigned int)
+NVHLS_NATIVE_BITS(long)
+NVHLS_NATIVE_BITS(unsigned long)
+NVHLS_NATIVE_BITS(long long)
+NVHLS_NATIVE_BITS(unsigned long long)
+#undef NVHLS_NATIVE_BITS
+inline uint64 native_bits(double v) { return static_cast<uint64>(static_cast<int64>(v)); }
+
+template <typename T>
+uint64 native_bits(const T& v) {
+  return v.to_uint64();
+}
+
+template <typename T>
+struct native_bits_enable {
+  typedef void type;
+};
+
+/**
+ * \brief Native-integer simulation model of nvint/nvuint
+ * \ingroup nvhls_int
+ *
+ * \tparam W         Bitwidth of integer, at most 64
+ * \tparam S         Signed if true
+ *
+ * \par Overview
+ * - Stores the value in a 64-bit host integer that is masked (unsigned) or sign-extended (signed) to W bits on every assignment. Arithmetic goes through the implicit conversion to uint64/int64, exactly like sc_uint/sc_int, so results are bit-identical to the SystemC view.
+ * - Provides the sc_uint/sc_int API used by MatchLib: bit select, range(), to_uint64() and friends, length() and compound assignment. It also provides ac_int style slc<W2>() and set_slc().
+ * - nvhls_t maps widths up to 64 to native_int when NVHLS_NATIVE_INT is defined in C++ simulation without HLS_CATAPULT (make NATIVE_INT=1). Wider types stay sc_bigint/sc_biguint, and synthesis always uses the SystemC or AC types.
+ * - Derives from sc_generic_base, so SystemC integers can be constructed from and assigned native_int values.
+ *
+ * \par A Simple Example
+ * \code
+ *      // g++ ... -DNVHLS_NATIVE_INT
+ *      #include <nvhls_types.h>
+ *
+ *      ...
+ *      NVUINT8 X = 250;       // nvhls::native_int<8, false>
+ *      X += 10;               // 4
+ *      NVUINT4 Y = X.range(5, 2);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <unsigned int W, bool S>
+class native_int : public sc_dt::sc_generic_base<native_int<W, S> > {
+ public:
+  typedef typename native_int_value<S>::type value_t;
+  static const int width = W;
+  static const bool sign = S;
+
+ private:
+  static const unsigned int Pad = 64 - W;
+  value_t val;
+
+  static value_t norm(uint64 bits) {
+    if (S) {
+      return static_cast<value_t>(static_cast<int64>(bits << Pad) >> Pad);
+    } else {
+      return static_cast<value_t>((bits << Pad) >> Pad);
+    }
+  }
+
+ public:
+  // Proxy for a writable bit
+  class bitref {
+    native_int* obj;
+    int index;
+
+   public:
+    bitref(native_int* o, int i) : obj(o), index(i) {}
+    operator bool() const { return obj->test(index); }
+    bool to_bool() const { return obj->test(index); }
+    bitref& operator=(bool b) {
+      obj->set(index, b);
+      return *this;
+    }
+    bitref& operator=(const bitref& b) { return *this = static_cast<bool>(b); }
+    bitref& operator&=(bool b) { return *this = (obj->test(index) && b); }
+    bitref& operator|=(bool b) { return *this = (obj->test(index) || b); }
+    bitref& operator^=(bool b) { return *this = (obj->test(index) != b); }
+  };
+
+  // Proxy for a writable bit range [hi, lo]
+  class rangeref {
+    native_int* obj;
+    int hi, lo;
+
+   public:
+    rangeref(native_int* o, int h, int l) : obj(o), hi(h), lo(l) {}
+    uint64 to_uint64() const { return (static_cast<uint64>(obj->val) >> lo) & mask(); }
+    int64 to_int64() const { return static_cast<int64>(to_uint64()); }
+    unsigned int to_uint() const { return static_cast<unsigned int>(to_uint64()); }
+    int to_int() const { return static_cast<int>(to_uint64()); }
+    int length() const { return hi - lo + 1; }
+    operator uint64() const { return to_uint64(); }
+    uint64 mask() const { return (~static_cast<uint64>(0)) >> (64 - length()); }
+    template <typename T>
+    rangeref& operator=(const T& v) {
+      uint64 bits = static_cast<uint64>(obj->val) & ~(mask() << lo);
+      *obj = bits | ((native_bits(v) & mask()) << lo);
+      return *this;
+    }
+    rangeref& operator=(const rangeref& v) { return *this = v.to_uint64(); }
+  };
+
+  native_int() : val(0) {}
+  native_int(bool v) : val(norm(v)) {}
+  native_int(char v) : val(norm(v)) {}
+  native_int(signed char v) : val(norm(v)) {}
+  native_int(unsigned char v) : val(norm(v)) {}
+  native_int(short v) : val(norm(v)) {}
+  native_int(unsigned short v) : val(norm(v)) {}
+  native_int(int v) : val(norm(v)) {}
+  native_int(unsigned int v) : val(norm(v)) {}
+  native_int(long v) : val(norm(v)) {}
+  native_int(unsigned long v) : val(norm(v)) {}
+  native_int(long long v) : val(norm(v)) {}
+  native_int(unsigned long long v) : val(norm(v)) {}
+  native_int(double v) : val(norm(native_bits(v))) {}
+  // SystemC integers, native_int of any width and their slices
+  template <typename T>
+  native_int(const T& v,
+             typename native_bits_enable<decltype(std::declval<const T&>().to_uint64())>::type* = 0)
+      : val(norm(v.to_uint64())) {}
+
+  operator value_t() const { return val; }
+
+  uint64 to_uint64() const { return static_cast<uint64>(val); }
+  int64 to_int64() const { return static_cast<int64>(val); }
+  unsigned int to_uint() const { return static_cast<unsigned int>(val); }
+  int to_int() const { return static_cast<int>(val); }
+  unsigned long to_ulong() const { return static_cast<unsigned long>(val); }
+  long to_long() const { return static_cast<long>(val); }
+  double to_double() const { return static_cast<double>(val); }
+  int length() const { return W; }
+
+  // sc_generic_base interface
+  void to_sc_signed(sc_dt::sc_signed& x) const { x = val; }
+  void to_sc_unsigned(sc_dt::sc_unsigned& x) const { x = val; }
+
+  bool test(int i) const { return (static_cast<uint64>(val) >> i) & 1; }
+  void set(int i, bool b) {
+    uint64 bits = static_cast<uint64>(val);
+    uint64 one = static_cast<uint64>(1) << i;
+    val = norm(b ? (bits | one) : (bits & ~one));
+  }
+
+  bitref operator[](int i) { return bitref(this, i); }
+  bool operator[](int i) const { return test(i); }
+
+  rangeref range(int hi, int lo) { return rangeref(this, hi, lo); }
+  native_int<W, false> range(int hi, int lo) const {
+    return native_int<W, false>((static_cast<uint64>(val) >> lo) &
+                                ((~static_cast<uint64>(0)) >> (63 - (hi - lo))));
+  }
+
+  // ac_int style slices
+  template <unsigned int W2>
+  native_int<W2, S> slc(int lsb) const {
+    return native_int<W2, S>(static_cast<uint64>(val) >> lsb);
+  }
+
+  template <typename T>
+  native_int& set_slc(int lsb, const T& v) {
+    range(lsb + Wrapped<T>::width - 1, lsb) = v;
+    return *this;
+  }
+
+  bool iszero() const { return val == 0; }
+  bool and_reduce() const { return norm(~static_cast<uint64>(0)) == val; }
+  bool or_reduce() const { return val != 0; }
+  bool xor_reduce() const { return __builtin_parityll(static_cast<uint64>(val) & ((~static_cast<uint64>(0)) >> Pad)); }
+
+  template <typename T>
+  native_int& operator+=(const T& v) { val = norm(val + static_cast<value_t>(native_bits(v))); return *this; }
+  template <typename T>
+  native_int& operator-=(const T& v) { val = norm(val - static_cast<value_t>(native_bits(v))); return *this; }
+  template <typename T>
+  native_int& operator*=(const T& v) { val = norm(val * static_cast<value_t>(native_bits(v))); return *this; }
+  template <typename T>
+  native_int& operator/=(const T& v) { val = norm(val / static_cast<value_t>(native_bits(v))); return *this; }
+  template <typename T>
+  native_int& operator%=(const T& v) { val = norm(val % static_cast<value_t>(native_bits(v))); return *this; }
+  template <typename T>
+  native_int& operator&=(const T& v) { val = norm(val & static_cast<value_t>(native_bits(v))); return *this; }
+  template <typename T>
+  native_int& operator|=(const T& v) { val = norm(val | static_cast<value_t>(native_bits(v))); return *this; }
+  template <typename T>
+  native_int& operator^=(const T& v) { val = norm(val ^ static_cast<value_t>(native_bits(v))); return *this; }
+  native_int& operator<<=(int s) { val = norm(static_cast<uint64>(val) << s); return *this; }
+  native_int& operator>>=(int s) { val = norm(val >> s); return *this; }
+
+  native_int& operator++() { val = norm(val + 1); return *this; }
+  native_int operator++(int) { native_int t = *this; ++*this; return t; }
+  native_int& operator--() { val = norm(val - 1); return *this; }
+  native_int operator--(int) { native_int t = *this; --*this; return t; }
+
+  const value_t& value() const { return val; }
+
+  friend std::ostream& operator<<(std::ostream& os, const native_int& v) { return os << v.val; }
+};
+
+}  // namespace nvhls
+
+template <unsigned int W, bool S>
+struct native_int_sc_t {
+  typedef sc_uint<W> type;
+};
+
+template <unsigned int W>
+struct native_int_sc_t<W, true> {
+  typedef sc_int<W> type;
+};
+
+// Marshalled like the sc_uint/sc_int of the same width
+template <unsigned int W, bool S>
+class Wrapped<nvhls::native_int<W, S> > {
+ public:
+  nvhls::native_int<W, S> val;
+  Wrapped() {}
+  Wrapped(const nvhls::native_int<W, S>& v) : val(v) {}
+  static const unsigned int width = W;
+  static const bool is_signed = S;
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    typename native_int_sc_t<W, S>::type bits = val.to_uint64();
+    m &bits;
+    val = bits.to_uint64();
+  }
+};
+
+template <unsigned int W, bool S>
+inline void sc_trace(sc_trace_file* tf, const nvhls::native_int<W, S>& v, const std::string& name) {
+  sc_trace(tf, v.value(), name, W);
+}
+
+#endif
@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_PARALLEL_SIM_H
+#define NVHLS_PARALLEL_SIM_H
+
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace match {
+
+/**
+ * \brief A process of the experimental parallel cycle simulator
+ * \ingroup ParallelSim
+ *
+ * Eval() models one clock cycle.  It may only communicate with other
+ * processes through CycleChannels, and it must not touch state that a process
+ * in another partition reads or writes during the same cycle.
+ */
+class CycleProcess {
+ public:
+  virtual ~CycleProcess() {}
+  virtual void Reset() {}
+  virtual void Eval() = 0;
+};
+
+class CycleChannelBase {
+ public:
+  virtual ~CycleChannelBase() {}
+  virtual void Reset() = 0;
+  virtual void Commit() = 0;
+};
+
+/**
+ * \brief Experimental multi-threaded cycle simulator, independent of SystemC
+ * \ingroup ParallelSim
+ *
+ * \par Overview
+ * ParallelSim runs a graph of CycleProcesses connected by registered
+ * CycleChannels.  Each cycle has two phases, separated by barriers:
+ * - Eval: every process evaluates one cycle.  Channels only expose the state
+ *   they had at the start of the cycle, so processes of different partitions
+ *   can be evaluated concurrently and in any order.
+ * - Commit: every channel applies the pushes and pops of the cycle.
+ *
+ * The result is independent of the number of threads.  Processes and channels
+ * are grouped into partitions, e.g. one per tile of a tiled design, and each
+ * thread handles a contiguous range of partitions, so a design with P equal
+ * tiles scales up to P threads as long as a tile's work per cycle dominates the
+ * cost of the two barriers.  The number of threads defaults to the number of
+ * hardware threads and can be set with SetNumThreads() or with the
+ * NVHLS_SIM_THREADS environment variable.
+ *
+ * This kernel does not run SystemC processes, so it cannot host
+ * match::Modules or Connections ports directly: their SC_THREADs need the
+ * SystemC scheduler.  A model targeting it describes each block's cycle
+ * behavior in CycleProcess::Eval(), in the same way as the registered
+ * boundaries of Connections Buffers and Pipelines.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_parallel_sim.h>
+ *
+ *      match::ParallelSim sim;
+ *      match::CycleChannel<int> ch(sim, 0);
+ *      Producer prod(ch);           // calls ch.PushNB() in Eval()
+ *      Consumer cons(ch);           // calls ch.PopNB() in Eval()
+ *      sim.Add(&prod, 0);
+ *      sim.Add(&cons, 1);
+ *      sim.Reset();
+ *      sim.Run(100000);
+ * \endcode
+ * \par
+ *
+ */
+class ParallelSim {
+ public:
+  ParallelSim() : num_threads_(0), next_proc_part_(0), next_chan_part_(0), cycle_(0), stop_(false) {
+    const char* env_threads = std::getenv("NVHLS_SIM_THREADS");
+    if (env_threads != NULL) num_threads_ = std::atoi(env_threads);
+  }
+
+  // Adds a process to a partition; a negative partition picks an existing one
+  // round-robin
+  void Add(CycleProcess* proc, int partition = -1) {
+    Part(partition, next_proc_part_).procs.push_back(proc);
+  }
+
+  void AddChannel(CycleChannelBase* chan, int partition = -1) {
+    Part(partition, next_chan_part_).chans.push_back(chan);
+  }
+
+  unsigned int NumPartitions() const { return parts_.size(); }
+
+  // Threads used by Run(), at most one per partition
+  unsigned int NumThreads() const {
+    unsigned int n = num_threads_;
+    if (n == 0) n = std::thread::hardware_concurrency();
+    if (n > parts_.size()) n = parts_.size();
+    return n == 0 ? 1 : n;
+  }
+
+  void SetNumThreads(unsigned int n) { num_threads_ = n; }
+
+  uint64_t Cycle() const { return cycle_; }
+
+  // Ends Run() after the current cycle; may be called from Eval()
+  void Stop() { stop_.store(true, std::memory_order_relaxed); }
+
+  void Reset() {
+    for (unsigned int p = 0; p < parts_.size(); p++) {
+      for (unsigned int i = 0; i < parts_[p].procs.size(); i++) parts_[p].procs[i]->Reset();
+      for (unsigned int i = 0; i < parts_[p].chans.size(); i++) parts_[p].chans[i]->Reset();
+    }
+    cycle_ = 0;
+    stop_.store(false);
+  }
+
+  // Simulates one cycle on the calling thread, e.g. from the SC_METHOD of
+  // CycleMethodHost
+  void Step() {
+    for (unsigned int p = 0; p < parts_.size(); p++) {
+      for (unsigned int i = 0; i < parts_[p].procs.size(); i++) parts_[p].procs[i]->Eval();
+    }
+    for (unsigned int p = 0; p < parts_.size(); p++) {
+      for (unsigned int i = 0; i < parts_[p].chans.size(); i++) parts_[p].chans[i]->Commit();
+    }
+    cycle_++;
+  }
+
+  // Simulates up to max_cycles cycles and returns the number simulated
+  uint64_t Run(uint64_t max_cycles) {
+    uint64_t start = cycle_;
+    stop_.store(false);
+    unsigned int n = NumThreads();
+    Barrier barrier(n);
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < n; t++) {
+      threads.push_back(std::thread(&ParallelSim::Worker, this, t, n, max_cycles, &barrier));
+    }
+    Worker(0, n, max_cycles, &barrier);
+    for (unsigned int t = 0; t < threads.size(); t++) threads[t].join();
+    return cycle_ - start;
+  }
+
+ private:
+  struct Partition {
+    std::vector<CycleProcess*> procs;
+    std::vector<CycleChannelBase*> chans;
+  };
+
+  // Sense-reversing barrier; spins briefly and then yields
+  class Barrier {
+   public:
+    explicit Barrier(unsigned int n) : n_(n), count_(0), phase_(0) {}
+    void Wait() {
+      if (n_ == 1) return;
+      unsigned int phase = phase_.load(std::memory_order_acquire);
+      if (count_.fetch_add(1, std::memory_order_acq_rel) + 1 == n_) {
+        count_.store(0, std::memory_order_relaxed);
+        phase_.fetch_add(1, std::memory_order_release);
+      } else {
+        unsigned int spins = 0;
+        while (phase_.load(std::memory_order_acquire) == phase) {
+          if (++spins > 1024) std::this_thread::yield();
+        }
+      }
+    }
+
+   private:
+    const unsigned int n_;
+    std::atomic<unsigned int> count_;
+    std::atomic<unsigned int> phase_;
+  };
+
+  std::vector<Partition> parts_;
+  unsigned int num_threads_;
+  unsigned int next_proc_part_;
+  unsigned int next_chan_part_;
+  uint64_t cycle_;
+  std::atomic<bool> stop_;
+
+  Partition& Part(int partition, unsigned int& next) {
+    unsigned int p = partition < 0 ? next++ % (parts_.empty() ? 1 : parts_.size()) : partition;
+    if (p >= parts_.size()) parts_.resize(p + 1);
+    return parts_[p];
+  }
+
+  void Worker(unsigned int t, unsigned int n, uint64_t max_cycles, Barrier* barrier) {
+    unsigned int first = t * parts_.size() / n;
+    unsigned int last = (t + 1) * parts_.size() / n;
+    for (uint64_t c = 0; c < max_cycles; c++) {
+      for (unsigned int p = first; p < last; p++) {
+        std::vector<CycleProcess*>& procs = parts_[p].procs;
+        for (unsigned int i = 0; i < procs.size(); i++) procs[i]->Eval();
+      }
+      barrier->Wait();
+      // No process runs between the barriers, so every thread sees the same flag
+      bool stop = stop_.load(std::memory_order_relaxed);
+      for (unsigned int p = first; p < last; p++) {
+        std::vector<CycleChannelBase*>& chans = parts_[p].chans;
+        for (unsigned int i = 0; i < chans.size(); i++) chans[i]->Commit();
+      }
+      if (t == 0) cycle_++;
+      barrier->Wait();
+      if (stop) break;
+    }
+  }
+};
+
+/**
+ * \brief A registered single-producer single-consumer channel of ParallelSim
+ * \ingroup ParallelSim
+ *
+ * \tparam T      Message type
+ * \tparam Depth  Number of entries
+ *
+ * A message pushed in one cycle can be popped from the next cycle on, and an
+ * entry popped in one cycle can be refilled from the next cycle on, so a
+ * channel with Depth >= 2 sustains one message per cycle.  During Eval the
+ * producer only writes free entries and the consumer only reads full ones,
+ * which is what lets both sides run on different threads.
+ */
+template <typename T, unsigned int Depth = 2>
+class CycleChannel : public CycleChannelBase {
+ public:
+  explicit CycleChannel(ParallelSim& sim, int partition = -1)
+      : head_(0), count_(0), pushes_(0), pops_(0) {
+    sim.AddChannel(this, partition);
+  }
+
+  bool PushNB(const T& msg) {
+    if (count_ + pushes_ >= Depth) return false;
+    buf_[(head_ + count_ + pushes_) % Depth] = msg;
+    pushes_++;
+    return true;
+  }
+
+  bool PopNB(T& msg) {
+    if (pops_ >= count_) return false;
+    msg = buf_[(head_ + pops_) % Depth];
+    pops_++;
+    return true;
+  }
+
+  bool Full() const { return count_ + pushes_ >= Depth; }
+  bool Empty() const { return pops_ >= count_; }
+
+  void Reset() { head_ = count_ = pushes_ = pops_ = 0; }
+
+  void Commit() {
+    head_ = (head_ + pops_) % Depth;
+    count_ = count_ + pushes_ - pops_;
+    pushes_ = pops_ = 0;
+  }
+
+ private:
+  T buf_[Depth];
+  unsigned int head_;
+  unsigned int count_;
+  unsigned int pushes_;
+  unsigned int pops_;
+};
+
+}  // namespace match
+
+#endif  // NVHLS_PARALLEL_SIM_H
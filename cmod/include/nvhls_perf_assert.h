@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_PERF_ASSERT_H
+#define NVHLS_PERF_ASSERT_H
+
+#include <systemc.h>
+#include <nvhls_types.h>
+#include <nvhls_latency.h>
+#include <nvhls_stats.h>
+#ifndef __SYNTHESIS__
+#include <string>
+#include <vector>
+#endif
+
+namespace match {
+
+#ifndef __SYNTHESIS__
+/**
+ * \brief Transfers per cycle of a channel or module, for PerfAssert
+ * \ingroup nvhls_module
+ *
+ * \par Overview
+ * - Call Transfer() wherever a transfer completes, e.g. after every successful PopNB() of a consumer. It counts the transfers of every unit (e.g. the clock period) of simulation time from the first transfer on.
+ * - rate() is the average number of transfers per unit from the first to the last transfer; min_rate(window) is the lowest average of any window units in that span, so a burst of bubbles in a long run is not hidden by the average. Idle time before the first and after the last transfer is never counted.
+ *
+ */
+class ThroughputMonitor {
+ public:
+  explicit ThroughputMonitor(const std::string& name, const sc_time& unit = sc_time(1, SC_NS))
+      : name_(name), unit_ps_(unit.to_seconds() * 1e12), first_(0), count_(0) {}
+
+  void Transfer(unsigned int num = 1) {
+    uint64 unit = static_cast<uint64>(sc_time_stamp().to_seconds() * 1e12 / unit_ps_ + 0.5);
+    if (counts_.empty())
+      first_ = unit;
+    if (unit - first_ >= counts_.size())
+      counts_.resize(unit - first_ + 1, 0);
+    counts_[unit - first_] += num;
+    count_ += num;
+  }
+
+  const std::string& name() const { return name_; }
+  uint64 count() const { return count_; }
+  uint64 span() const { return counts_.size(); }
+  double rate() const { return counts_.empty() ? 0 : static_cast<double>(count_) / counts_.size(); }
+
+  // Lowest transfers per unit over any window units from the first to the
+  // last transfer; rate() if the span is shorter than the window
+  double min_rate(unsigned int window) const {
+    if (window == 0 || counts_.size() <= window)
+      return rate();
+    uint64 sum = 0;
+    for (unsigned int i = 0; i < window; i++)
+      sum += counts_[i];
+    uint64 min_sum = sum;
+    for (unsigned int i = window; i < counts_.size(); i++) {
+      sum = sum + counts_[i] - counts_[i - window];
+      min_sum = (sum < min_sum) ? sum : min_sum;
+    }
+    return static_cast<double>(min_sum) / window;
+  }
+
+ private:
+  std::string name_;
+  double unit_ps_;
+  uint64 first_;
+  uint64 count_;
+  std::vector<uint64> counts_;  // Transfers in unit first_ + i
+};
+
+/**
+ * \brief End-of-simulation performance assertions for regression tests
+ * \ingroup nvhls_module
+ *
+ * \par Overview
+ * - MinThroughput() requires at least per_unit transfers per unit of a ThroughputMonitor over every window of window units (see ThroughputMonitor::min_rate()).
+ * - MaxLatency() requires the pct percentile of a LatencyRecorder to be at most max_units, e.g. pct = 99 for the p99 latency or 100 for the maximum.
+ * - MinStat() and MaxStat() bound a counter of a match::Stats, e.g. the bank conflicts of a Scratchpad.
+ * - The assertions only hold pointers, so the monitors, recorders and stats must outlive Check(). Check() evaluates them after sc_start() returns, prints one PERF line per assertion and returns false if any of them fails. Every PerfAssert registers itself; CheckAll() checks all of them.
+ * - A test should fail when Check() does, so that a performance regression fails the regression like a functional one.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_perf_assert.h>
+ *
+ *      match::ThroughputMonitor tput("dut_out");        // Consumer: tput.Transfer() after every Pop()
+ *      match::LatencyRecorder latency("dut_latency");   // Consumer: latency.Record(t) after every Pop()
+ *      match::PerfAssert perf;
+ *      perf.MinThroughput(tput, 0.9, 100);  // At least 0.9 messages per cycle in every 100 cycles
+ *      perf.MaxLatency(latency, 99, 12);    // p99 latency at most 12 cycles
+ *      ...
+ *      sc_start();
+ *      return match::PerfAssert::CheckAll(std::cout) ? 0 : 1;
+ *
+ * \endcode
+ * \par
+ *
+ */
+class PerfAssert {
+ public:
+  PerfAssert() { Asserts().push_back(this); }
+
+  ~PerfAssert() {
+    std::vector<PerfAssert*>& asserts = Asserts();
+    for (unsigned int i = 0; i < asserts.size(); i++) {
+      if (asserts[i] == this) {
+        asserts.erase(asserts.begin() + i);
+        break;
+      }
+    }
+  }
+
+  void MinThroughput(const ThroughputMonitor& monitor, double per_unit, unsigned int window) {
+    Assertion a(MIN_THROUGHPUT, monitor.name());
+    a.monitor = &monitor;
+    a.bound = per_unit;
+    a.param = window;
+    checks_.push_back(a);
+  }
+
+  void MaxLatency(const LatencyRecorder& recorder, double pct, double max_units,
+                  const std::string& name = "latency") {
+    Assertion a(MAX_LATENCY, name);
+    a.recorder = &recorder;
+    a.bound = max_units;
+    a.param = pct;
+    checks_.push_back(a);
+  }
+
+  void MinStat(Stats& stats, const std::string& stat, uint64 min) {
+    Assertion a(MIN_STAT, stat);
+    a.stats = &stats;
+    a.bound = static_cast<double>(min);
+    checks_.push_back(a);
+  }
+
+  void MaxStat(Stats& stats, const std::string& stat, uint64 max) {
+    Assertion a(MAX_STAT, stat);
+    a.stats = &stats;
+    a.bound = static_cast<double>(max);
+    checks_.push_back(a);
+  }
+
+  bool Check(std::ostream& ofile) const {
+    bool pass = true;
+    for (unsigned int i = 0; i < checks_.size(); i++) {
+      const Assertion& a = checks_[i];
+      double value = 0;
+      bool ok = false;
+      ofile << "PERF " << a.name << ": ";
+      switch (a.kind) {
+        case MIN_THROUGHPUT:
+          value = a.monitor->min_rate(static_cast<unsigned int>(a.param));
+          ok = value >= a.bound;
+          ofile << "min throughput " << value << " per unit over " << a.param << " of "
+                << a.monitor->span() << " units, bound " << a.bound;
+          break;
+        case MAX_LATENCY:
+          value = a.recorder->percentile(a.param);
+          ok = a.recorder->count() != 0 && value <= a.bound;
+          ofile << "p" << a.param << " latency " << value << " of " << a.recorder->count()
+                << " samples, bound " << a.bound;
+          break;
+        case MIN_STAT:
+          value = static_cast<double>(a.stats->GetStat(a.name));
+          ok = value >= a.bound;
+          ofile << value << ", min " << a.bound;
+          break;
+        case MAX_STAT:
+          value = static_cast<double>(a.stats->GetStat(a.name));
+          ok = value <= a.bound;
+          ofile << value << ", max " << a.bound;
+          break;
+      }
+      ofile << (ok ? " PASS" : " FAILED") << std::endl;
+      pass = pass && ok;
+    }
+    return pass;
+  }
+
+  static bool CheckAll(std::ostream& ofile) {
+    std::vector<PerfAssert*>& asserts = Asserts();
+    bool pass = true;
+    for (unsigned int i = 0; i < asserts.size(); i++)
+      pass = asserts[i]->Check(ofile) && pass;
+    return pass;
+  }
+
+ private:
+  enum Kind { MIN_THROUGHPUT, MAX_LATENCY, MIN_STAT, MAX_STAT };
+
+  struct Assertion {
+    Kind kind;
+    std::string name;
+    const ThroughputMonitor* monitor;
+    const LatencyRecorder* recorder;
+    Stats* stats;
+    double bound;
+    double param;  // Window of MIN_THROUGHPUT, percentile of MAX_LATENCY
+
+    Assertion(Kind k, const std::string& n)
+        : kind(k), name(n), monitor(0), recorder(0), stats(0), bound(0), param(0) {}
+  };
+
+  std::vector<Assertion> checks_;
+
+  static std::vector<PerfAssert*>& Asserts() {
+    static std::vector<PerfAssert*> asserts;
+    return asserts;
+  }
+};
+#endif
+
+}  // namespace match
+
+#endif  // NVHLS_PERF_ASSERT_H
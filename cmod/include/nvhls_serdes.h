@@ -687,4 +687,712 @@ void deserializer<
   }
 }
 
+//------------------------------------------------------------------------
+// PartialPacket: a packet that is assembled while its flits arrive
+//------------------------------------------------------------------------
+/**
+ * \brief Partially assembled packet delivered by the cut-through deserializer
+ * \ingroup SerDes
+ *
+ * \tparam packet_t       PacketType
+ * \tparam NumFlits       Number of data flits of a packet, route flits are not counted
+ *
+ * \par Overview
+ * - packet holds the dest field and the data bits received so far; bits of flits that have not arrived yet are 0.
+ * - num_flits is the number of data flits received. It is 0 for the header, which carries dest and the data bits of the head flit.
+ * - last is set on the partial packet of the tail flit, when packet is complete.
+ *
+ */
+template <typename packet_t, int NumFlits>
+class PartialPacket : public nvhls_message {
+ public:
+  static const int count_width = nvhls::index_width<NumFlits + 1>::val;
+  enum { width = Wrapped<packet_t>::width + count_width + 1 };
+
+  packet_t packet;
+  NVUINTW(count_width) num_flits;
+  bool last;
+
+  PartialPacket() : num_flits(0), last(false) {}
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& packet;
+    m& num_flits;
+    m& last;
+  }
+};
+
+//------------------------------------------------------------------------
+// cut_through_deserializer for Wormhole Router
+//------------------------------------------------------------------------
+/**
+ * \brief Cut-through deserializer for Wormhole router
+ * \ingroup SerDes
+ *
+ * \tparam packet_t       PacketType
+ * \tparam flit_t         FlitType
+ *
+ * \par Overview
+ * - Accepts the flits of serializer<packet_t, flit_t, WormHole>: a head flit with dest and the first data bits, followed by the data flits. Packets arrive one after the other, as in the deserializer without input buffer.
+ * - Instead of one packet after the tail flit, out_partial delivers a PartialPacket in the cycle each flit arrives. The header (num_flits == 0) is delivered with the head flit, so the destination can be decoded while the data flits are still in flight, and every following PartialPacket adds the bits of one data flit.
+ * - The PartialPacket with last set holds the same packet that deserializer<packet_t, flit_t, 0, WormHole> delivers.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_serdes.h>
+ *
+ *      ...
+ *      typedef PartialPacket<Packet_t, cut_through_deserializer<Packet_t, Flit_t>::num_flits> Partial_t;
+ *      cut_through_deserializer<Packet_t, Flit_t> deserializer_inst;
+ *      Connections::In<Flit_t>      in_flit;
+ *      Connections::Out<Partial_t>  out_partial;
+ *      ...
+ *          deserializer_inst.clk(clk);
+ *          deserializer_inst.rst(rst);
+ *          deserializer_inst.in_flit(in_flit);
+ *          deserializer_inst.out_partial(out_partial);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename packet_t, typename flit_t>
+class cut_through_deserializer;
+
+template <int PacketDataWidth, int DestWidthPerHop, int MaxHops,
+          int PacketIdWidth, int FlitDataWidth, class FlitId>
+class cut_through_deserializer<
+    Packet<PacketDataWidth, DestWidthPerHop, MaxHops, PacketIdWidth>,
+    Flit<FlitDataWidth, 0, 0, PacketIdWidth, FlitId, WormHole> >
+    : public sc_module {
+  typedef Packet<PacketDataWidth, DestWidthPerHop, MaxHops, PacketIdWidth> packet_t;
+  typedef Flit<FlitDataWidth, 0, 0, PacketIdWidth, FlitId, WormHole> flit_t;
+
+ public:
+  static const int header_data_width = flit_t::data_width - packet_t::dest_width;
+  // num_flits indicates number of data flits. route flits are not counted.
+  static const int num_flits = (((packet_t::data_width-header_data_width) % flit_t::data_width) == 0) ? ((packet_t::data_width-header_data_width) / flit_t::data_width) : ((packet_t::data_width-header_data_width) / flit_t::data_width+1) ;
+  typedef PartialPacket<packet_t, num_flits> partial_t;
+
+  sc_in_clk clk;
+  sc_in<bool> rst;
+
+  Connections::Out<partial_t> out_partial;
+  Connections::In<flit_t> in_flit;
+  enum { width = 0 };
+
+  void Process() {
+    out_partial.Reset();
+    in_flit.Reset();
+    partial_t partial;
+    wait();
+
+    while (1) {
+      flit_t flit_reg;
+      if (in_flit.PopNB(flit_reg)) {
+        if (flit_reg.flit_id.isHeader()) {
+          // Early header delivery: dest and the data bits of the head flit
+          partial.packet.dest = static_cast<NVUINTW(packet_t::dest_width)> (flit_reg.data);
+          partial.packet.data = nvhls::get_slc<header_data_width>(flit_reg.data, packet_t::dest_width);
+          partial.num_flits = 0;
+        } else {
+          partial.packet.data |= (static_cast<NVUINTW(PacketDataWidth)>(flit_reg.data) << partial.num_flits * flit_t::data_width + header_data_width);
+          partial.num_flits++;
+        }
+        partial.last = flit_reg.flit_id.isTail();
+        out_partial.Push(partial);
+        if (partial.last) {
+          partial.packet.data = 0;
+          partial.num_flits = 0;
+        }
+      }
+      wait();
+    }
+  }
+
+  SC_HAS_PROCESS(cut_through_deserializer);
+  cut_through_deserializer(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        rst("rst"),
+        out_partial("out_partial"),
+        in_flit("in_flit") {
+    SC_THREAD(Process);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+};
+
+//------------------------------------------------------------------------
+// packing_serializer / unpacking_deserializer
+//------------------------------------------------------------------------
+// Packs several narrow packets into the slots of one store-forward flit
+// and unpacks them again. Slot s occupies data bits
+// [s * slot_width, (s + 1) * slot_width) of the flit, with the layout
+// <VALID>:<DEST>:<DATA>. The packet-id is not carried.
+/**
+ * \brief Serializer that packs several narrow packets into one store-forward flit
+ * \ingroup SerDes
+ *
+ * \tparam packet_t       PacketType
+ * \tparam flit_t         FlitType (StoreForward)
+ * \tparam NumSlots       Number of packets per flit (default: as many as fit)
+ * \tparam MaxWait        Number of idle input cycles a partly filled flit waits for more packets (default: 0)
+ *
+ * \par Overview
+ * - Packets are placed into consecutive slots of a SNGL flit, each slot with a valid bit and the packet's dest.
+ * - A flit is sent when all slots are filled, when a packet with a different dest arrives (so flit.dest, which is slot 0's dest, is valid for all slots and the flit can be routed), or after MaxWait cycles without a new packet.
+ * - With one packet per cycle, a flit carries NumSlots packets, so the link is busy for 1 / NumSlots of the cycles it would be with serializer.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_serdes.h>
+ *
+ *      ...
+ *      typedef Packet<32, 4> Packet_t;
+ *      typedef Flit<256, 4, 1, 0, FlitId2bit, StoreForward> Flit_t;  // 6 slots of 37 bits
+ *      packing_serializer<Packet_t, Flit_t> ser;
+ *      unpacking_deserializer<Packet_t, Flit_t> deser;
+ *      ...
+ * \endcode
+ * \par
+ *
+ */
+template <typename packet_t, typename flit_t,
+          int NumSlots = flit_t::data_width / (packet_t::data_width + packet_t::dest_width + 1),
+          int MaxWait = 0>
+class packing_serializer : public sc_module {
+ public:
+  static const int slot_width = packet_t::data_width + packet_t::dest_width + 1;
+  static const int num_slots = NumSlots;
+  static const int log_num_slots = nvhls::index_width<NumSlots + 1>::val;
+  static const int log_max_wait = nvhls::index_width<MaxWait + 1>::val;
+  static_assert(NumSlots >= 1 && NumSlots * slot_width <= flit_t::data_width,
+                "packing_serializer slots do not fit into a flit");
+
+  sc_in_clk clk;
+  sc_in<bool> rst;
+
+  Connections::In<packet_t> in_packet;
+  Connections::Out<flit_t> out_flit;
+  enum { width = 0 };
+
+  void Process() {
+    in_packet.Reset();
+    out_flit.Reset();
+    flit_t flit_reg;
+    NVUINTW(log_num_slots) num = 0;
+    NVUINTW(log_max_wait) idle = 0;
+    wait();
+
+    while (1) {
+      packet_t packet_reg;
+      if (in_packet.PopNB(packet_reg)) {
+        // A different dest cannot share the flit: send what we have
+        if ((num != 0) && (packet_reg.dest != flit_reg.dest)) {
+          out_flit.Push(flit_reg);
+          num = 0;
+        }
+        if (num == 0) {
+          flit_reg.reset();
+          flit_reg.flit_id.set(FlitId2bit::SNGL);
+          flit_reg.dest = packet_reg.dest;
+        }
+        NVUINTW(slot_width) slot = packet_reg.data;
+        slot = nvhls::set_slc(slot, packet_reg.dest, packet_t::data_width);
+        slot[slot_width - 1] = 1;
+        flit_reg.data = nvhls::set_slc(flit_reg.data, slot, num * slot_width);
+        num++;
+        idle = 0;
+        if (num == NumSlots) {
+          out_flit.Push(flit_reg);
+          num = 0;
+        }
+      } else if (num != 0) {
+        if (idle == MaxWait) {
+          out_flit.Push(flit_reg);
+          num = 0;
+          idle = 0;
+        } else {
+          idle++;
+        }
+      }
+      wait();
+    }
+  }
+
+  SC_HAS_PROCESS(packing_serializer);
+  packing_serializer(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        rst("rst"),
+        in_packet("in_packet"),
+        out_flit("out_flit") {
+    SC_THREAD(Process);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+};
+
+/**
+ * \brief Deserializer that unpacks the flits of packing_serializer
+ * \ingroup SerDes
+ *
+ * \tparam packet_t       PacketType
+ * \tparam flit_t         FlitType (StoreForward)
+ * \tparam NumSlots       Number of packets per flit, same as in packing_serializer
+ *
+ * \par Overview
+ * - Delivers the packets of the valid slots of every flit in slot order, one per cycle.
+ *
+ */
+template <typename packet_t, typename flit_t,
+          int NumSlots = flit_t::data_width / (packet_t::data_width + packet_t::dest_width + 1)>
+class unpacking_deserializer : public sc_module {
+ public:
+  static const int slot_width = packet_t::data_width + packet_t::dest_width + 1;
+  static const int num_slots = NumSlots;
+  static_assert(NumSlots >= 1 && NumSlots * slot_width <= flit_t::data_width,
+                "unpacking_deserializer slots do not fit into a flit");
+
+  sc_in_clk clk;
+  sc_in<bool> rst;
+
+  Connections::Out<packet_t> out_packet;
+  Connections::In<flit_t> in_flit;
+  enum { width = 0 };
+
+  void Process() {
+    out_packet.Reset();
+    in_flit.Reset();
+    wait();
+
+    while (1) {
+      flit_t flit_reg;
+      if (in_flit.PopNB(flit_reg)) {
+        for (int s = 0; s < NumSlots; s++) {
+          NVUINTW(slot_width) slot = nvhls::get_slc<slot_width>(flit_reg.data, s * slot_width);
+          if (slot[slot_width - 1] == 1) {
+            packet_t packet_reg;
+            packet_reg.data = nvhls::get_slc<packet_t::data_width>(slot, 0);
+            packet_reg.dest = nvhls::get_slc<packet_t::dest_width>(slot, packet_t::data_width);
+            out_packet.Push(packet_reg);
+          }
+        }
+      }
+      wait();
+    }
+  }
+
+  SC_HAS_PROCESS(unpacking_deserializer);
+  unpacking_deserializer(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        rst("rst"),
+        out_packet("out_packet"),
+        in_flit("in_flit") {
+    SC_THREAD(Process);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+};
+
+//------------------------------------------------------------------------
+// compact serializer/deserializer for WormHole flits without VC interleaving
+//------------------------------------------------------------------------
+/**
+ * \brief Serializer for WormHole router that also carries data in the packet-id field of body flits
+ * \ingroup SerDes
+ *
+ * \tparam packet_t       PacketType
+ * \tparam flit_t         FlitType (WormHole with packet id)
+ *
+ * \par Overview
+ * - The head flit is the same as with serializer: <Header Data>:<Dest> in data and the packet id in packet_id.
+ * - Body and tail flits carry packet data in both data and packet_id, i.e. FlitDataWidth + PacketIdWidth payload bits per flit. Packets whose data fits into the head flit are sent as one SNGL flit.
+ * - Only the head flit identifies the packet, so the flits of different packets must not interleave between compact_serializer and compact_deserializer. This holds for a single-VC network, where WHVCRouter ignores packet_id, and for point-to-point links. Routers that select VCs by packet_id need serializer.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_serdes.h>
+ *
+ *      ...
+ *      typedef Packet<64, 4, 1, 8> Packet_t;
+ *      typedef Flit<16, 0, 0, 8, FlitId2bit, WormHole> Flit_t;  // 24 payload bits per body flit
+ *      compact_serializer<Packet_t, Flit_t> ser;
+ *      compact_deserializer<Packet_t, Flit_t> deser;
+ *      ...
+ * \endcode
+ * \par
+ *
+ */
+template <typename packet_t, typename flit_t>
+class compact_serializer;
+
+template <int PacketDataWidth, int DestWidthPerHop, int MaxHops,
+          int PacketIdWidth, int FlitDataWidth, class FlitId>
+class compact_serializer<
+    Packet<PacketDataWidth, DestWidthPerHop, MaxHops, PacketIdWidth>,
+    Flit<FlitDataWidth, 0, 0, PacketIdWidth, FlitId, WormHole> >
+    : public sc_module {
+  typedef Packet<PacketDataWidth, DestWidthPerHop, MaxHops, PacketIdWidth>
+      packet_t;
+  typedef Flit<FlitDataWidth, 0, 0, PacketIdWidth, FlitId, WormHole> flit_t;
+
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+
+  static const int header_data_width = flit_t::data_width - packet_t::dest_width;
+  static const int body_width = flit_t::data_width + flit_t::packet_id_width;
+  // num_flits indicates number of body and tail flits
+  static const int num_flits = (packet_t::data_width <= header_data_width) ? 0 :
+      (packet_t::data_width - header_data_width + body_width - 1) / body_width;
+  static const int padded_width = header_data_width + num_flits * body_width;
+  static const int log_num_flits = nvhls::index_width<num_flits+1>::val;
+  static_assert(PacketIdWidth > 0, "Without packet id, compact_serializer is the same as serializer");
+  static_assert(header_data_width > 0, "Dest leaves no data bits in the head flit");
+
+  Connections::In<packet_t> in_packet;
+  Connections::Out<flit_t> out_flit;
+  enum { width = 0 };
+
+  void Process() {
+    in_packet.Reset();
+    out_flit.Reset();
+    NVUINTW(log_num_flits) num = 0;
+    packet_t packet_reg;
+    NVUINTW(padded_width) data_reg = 0;
+    wait();
+    while (1) {
+      flit_t flit_reg;
+      if (num == 0) {
+        packet_reg = in_packet.Pop();
+        data_reg = packet_reg.data;
+        flit_reg.packet_id = packet_reg.packet_id;
+        flit_reg.data = packet_reg.dest;
+        flit_reg.data = nvhls::set_slc(flit_reg.data, nvhls::get_slc<header_data_width>(data_reg, 0), packet_t::dest_width);
+        flit_reg.flit_id.set((num_flits == 0) ? FlitId2bit::SNGL : FlitId2bit::HEAD);
+        if (num_flits != 0)
+          num++;
+      } else {
+        int offset = header_data_width + (num - 1) * body_width;
+        flit_reg.data = nvhls::get_slc<flit_t::data_width>(data_reg, offset);
+        flit_reg.packet_id = nvhls::get_slc<flit_t::packet_id_width>(data_reg, offset + flit_t::data_width);
+        if (num == num_flits) {
+          flit_reg.flit_id.set(FlitId2bit::TAIL);
+          num = 0;
+        } else {
+          flit_reg.flit_id.set(FlitId2bit::BODY);
+          num++;
+        }
+      }
+      out_flit.Push(flit_reg);
+      wait();
+    }
+  }
+
+  SC_HAS_PROCESS(compact_serializer);
+  compact_serializer(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        rst("rst"),
+        in_packet("in_packet"),
+        out_flit("out_flit") {
+    SC_THREAD(Process);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+};
+
+/**
+ * \brief Deserializer for the flits of compact_serializer
+ * \ingroup SerDes
+ *
+ * \tparam packet_t       PacketType
+ * \tparam flit_t         FlitType (WormHole with packet id)
+ *
+ * \par Overview
+ * - Assembles one packet at a time, like deserializer without input buffer. The packet id is taken from the head flit; packet_id of the other flits is data.
+ *
+ */
+template <typename packet_t, typename flit_t>
+class compact_deserializer;
+
+template <int PacketDataWidth, int DestWidthPerHop, int MaxHops,
+          int PacketIdWidth, int FlitDataWidth, class FlitId>
+class compact_deserializer<
+    Packet<PacketDataWidth, DestWidthPerHop, MaxHops, PacketIdWidth>,
+    Flit<FlitDataWidth, 0, 0, PacketIdWidth, FlitId, WormHole> >
+    : public sc_module {
+  typedef Packet<PacketDataWidth, DestWidthPerHop, MaxHops, PacketIdWidth>
+      packet_t;
+  typedef Flit<FlitDataWidth, 0, 0, PacketIdWidth, FlitId, WormHole> flit_t;
+  typedef compact_serializer<packet_t, flit_t> ser_t;
+
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+
+  static const int header_data_width = ser_t::header_data_width;
+  static const int body_width = ser_t::body_width;
+  static const int num_flits = ser_t::num_flits;
+  static const int padded_width = ser_t::padded_width;
+  static const int log_num_flits = ser_t::log_num_flits;
+
+  Connections::Out<packet_t> out_packet;
+  Connections::In<flit_t> in_flit;
+  enum { width = 0 };
+
+  void Process() {
+    out_packet.Reset();
+    in_flit.Reset();
+    packet_t buffer;
+    NVUINTW(padded_width) data_reg = 0;
+    NVUINTW(log_num_flits) num_flits_received = 0;
+    wait();
+
+    while (1) {
+      flit_t flit_reg;
+      if (in_flit.PopNB(flit_reg)) {
+        if (flit_reg.flit_id.isHeader()) {
+          buffer.dest = static_cast<NVUINTW(packet_t::dest_width)> (flit_reg.data);
+          buffer.packet_id = flit_reg.packet_id;
+          data_reg = 0;
+          data_reg = nvhls::set_slc(data_reg, nvhls::get_slc<header_data_width>(flit_reg.data, packet_t::dest_width), 0);
+          num_flits_received = 0;
+        } else {
+          int offset = header_data_width + num_flits_received * body_width;
+          data_reg = nvhls::set_slc(data_reg, flit_reg.data, offset);
+          data_reg = nvhls::set_slc(data_reg, flit_reg.packet_id, offset + flit_t::data_width);
+          num_flits_received++;
+        }
+        // Last flit or Single-flit packet. Write data out.
+        if (flit_reg.flit_id.isTail()) {
+          buffer.data = nvhls::get_slc<packet_t::data_width>(data_reg, 0);
+          out_packet.Push(buffer);
+        }
+      }
+      wait();
+    }
+  }
+
+  SC_HAS_PROCESS(compact_deserializer);
+  compact_deserializer(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        rst("rst"),
+        out_packet("out_packet"),
+        in_flit("in_flit") {
+    SC_THREAD(Process);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+};
+
+//------------------------------------------------------------------------
+// double-buffered serializer
+//------------------------------------------------------------------------
+/**
+ * \brief Serializer that takes the next packet while sending the flits of the current one
+ * \ingroup SerDes
+ *
+ * \tparam packet_t       PacketType
+ * \tparam flit_t         FlitType
+ * \tparam Rtype          RouterType (StoreForward, or WormHole with packet id)
+ *
+ * \par Overview
+ * - Sends the same flits as serializer, so it works with the existing deserializers.
+ * - Holds two packets: the one being sent and the next one. The next packet is popped as soon as its register is free, at the latest together with the last flit of the current packet, so the head flit of the next packet follows the tail flit in the next cycle.
+ * - Every loop iteration sends at most one flit and pops at most one packet, and both are non-blocking, so a stalled flit link does not stop the input handshake until both registers are full.
+ * - With back-to-back packets the flit link is busy every cycle, where serializer leaves a bubble between packets.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_serdes.h>
+ *
+ *      ...
+ *      double_buffered_serializer<packet_t, flit_t, StoreForward> serializer_inst;
+ *      ...
+ *          serializer_inst.clk(clk);
+ *          serializer_inst.rst(rst);
+ *          serializer_inst.in_packet(in_packet);
+ *          serializer_inst.out_flit(out_flit);
+ *      ...
+ * \endcode
+ * \par
+ *
+ */
+template <typename packet_t, typename flit_t, RouterType Rtype = StoreForward>
+class double_buffered_serializer : public sc_module {
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+
+  Connections::In<packet_t> in_packet;
+  Connections::Out<flit_t> out_flit;
+  static const int num_flits = serializer<packet_t, flit_t, StoreForward>::num_flits;
+  static const int log_num_flits = nvhls::index_width<num_flits+1>::val;
+  enum { width = 0 };
+
+  void Process() {
+    in_packet.Reset();
+    out_flit.Reset();
+    packet_t cur_reg, next_reg;
+    bool cur_valid = false;
+    bool next_valid = false;
+    NVUINTW(log_num_flits) num = 0;
+    wait();
+
+    while (1) {
+      if (cur_valid) {
+        flit_t flit_reg;
+        flit_reg.dest = cur_reg.dest;
+        flit_reg.packet_id = cur_reg.packet_id;
+        if (num_flits == 1) {
+          flit_reg.flit_id.set(FlitId2bit::SNGL);
+        } else if (num == 0) {
+          flit_reg.flit_id.set(FlitId2bit::HEAD);
+        } else if (num == num_flits - 1) {
+          flit_reg.flit_id.set(FlitId2bit::TAIL);
+        } else {
+          flit_reg.flit_id.set(FlitId2bit::BODY);
+        }
+        flit_reg.data =
+            nvhls::get_slc<flit_t::data_width>(cur_reg.data, num * flit_t::data_width);
+        if (out_flit.PushNB(flit_reg)) {
+          if (num == num_flits - 1) {
+            num = 0;
+            cur_valid = false;
+          } else {
+            num++;
+          }
+        }
+      }
+
+      if (!next_valid) {
+        next_valid = in_packet.PopNB(next_reg);
+      }
+      if (!cur_valid && next_valid) {
+        cur_reg = next_reg;
+        cur_valid = true;
+        next_valid = false;
+      }
+      wait();
+    }
+  }
+
+  SC_HAS_PROCESS(double_buffered_serializer);
+  double_buffered_serializer(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        rst("rst"),
+        in_packet("in_packet"),
+        out_flit("out_flit") {
+    SC_THREAD(Process);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+};
+
+/**
+ * \brief Double-buffered serializer for WormHole router
+ * \ingroup SerDes
+ *
+ * \par Overview
+ * - Sends the same flits as serializer for WormHole router: a head flit with <Header Data>:<Dest>, then the body and tail flits.
+ *
+ */
+template <int PacketDataWidth, int DestWidthPerHop, int MaxHops,
+          int PacketIdWidth, int FlitDataWidth, class FlitId>
+class double_buffered_serializer<
+    Packet<PacketDataWidth, DestWidthPerHop, MaxHops, PacketIdWidth>,
+    Flit<FlitDataWidth, 0, 0, PacketIdWidth, FlitId, WormHole>, WormHole>
+    : public sc_module {
+  typedef Packet<PacketDataWidth, DestWidthPerHop, MaxHops, PacketIdWidth>
+      packet_t;
+  typedef Flit<FlitDataWidth, 0, 0, PacketIdWidth, FlitId, WormHole> flit_t;
+  typedef serializer<packet_t, flit_t, WormHole> ser_t;
+
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+
+  static const int header_data_width = ser_t::header_data_width;
+  // num_flits indicates number of data flits. route flits are not counted
+  static const int num_flits = ser_t::num_flits;
+  static const int log_num_flits = ser_t::log_num_flits;
+  static_assert(PacketIdWidth > 0, "double_buffered_serializer needs flits with packet id for WormHole router");
+
+  Connections::In<packet_t> in_packet;
+  Connections::Out<flit_t> out_flit;
+  enum { width = 0 };
+
+  void Process() {
+    in_packet.Reset();
+    out_flit.Reset();
+    packet_t cur_reg, next_reg;
+    bool cur_valid = false;
+    bool next_valid = false;
+    NVUINTW(log_num_flits) num = 0;
+    wait();
+
+    while (1) {
+      if (cur_valid) {
+        flit_t flit_reg;
+        flit_reg.packet_id = cur_reg.packet_id;
+        if (num == 0) {
+          flit_reg.data = cur_reg.dest;
+          NVUINTW(header_data_width) header_data = nvhls::get_slc<header_data_width>(cur_reg.data, 0);
+          flit_reg.data = nvhls::set_slc(flit_reg.data, header_data, packet_t::dest_width);
+          flit_reg.flit_id.set(FlitId2bit::HEAD);  // Destination is sent in first flit
+        } else {
+          int num_minus_one = num - 1;
+          if (num == num_flits) {
+            flit_reg.flit_id.set(FlitId2bit::TAIL);
+            flit_reg.data = nvhls::get_slc(
+                cur_reg.data, packet_t::data_width - 1, num_minus_one * flit_t::data_width + header_data_width);
+          } else {
+            flit_reg.flit_id.set(FlitId2bit::BODY);
+            flit_reg.data = nvhls::get_slc<flit_t::data_width>(
+                cur_reg.data, num_minus_one * flit_t::data_width + header_data_width);
+          }
+        }
+        if (out_flit.PushNB(flit_reg)) {
+          if (num == num_flits) {
+            num = 0;
+            cur_valid = false;
+          } else {
+            num++;
+          }
+        }
+      }
+
+      if (!next_valid) {
+        next_valid = in_packet.PopNB(next_reg);
+      }
+      if (!cur_valid && next_valid) {
+        cur_reg = next_reg;
+        cur_valid = true;
+        next_valid = false;
+      }
+      wait();
+    }
+  }
+
+  SC_HAS_PROCESS(double_buffered_serializer);
+  double_buffered_serializer(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        rst("rst"),
+        in_packet("in_packet"),
+        out_flit("out_flit") {
+    SC_THREAD(Process);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+};
+
 #endif /*NVHLS_SERDES_H*/
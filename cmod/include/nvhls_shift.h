@@ -0,0 +1,420 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_SHIFT_H
+#define NVHLS_SHIFT_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_marshaller.h>
+
+namespace nvhls {
+
+/**
+ * \brief Rounding modes of barrel_right_shift
+ * \ingroup nvhls_int
+ *
+ * - RoundTruncate: drop the shifted-out bits (round towards minus infinity).
+ * - RoundNearestEven: round to nearest, ties to even.
+ * - RoundStochastic: round up with probability equal to the shifted-out fraction, using a caller-provided uniform random word.
+ */
+enum shift_round_mode { RoundTruncate, RoundNearestEven, RoundStochastic };
+
+// Signed or unsigned integer of width W
+template <unsigned int W, bool is_signed>
+struct shift_int_t {
+  typedef typename nvhls_t<W>::nvuint_t type;
+};
+
+template <unsigned int W>
+struct shift_int_t<W, true> {
+  typedef typename nvhls_t<W>::nvint_t type;
+};
+
+/**
+ * \brief State of a left barrel shift between stages
+ * \ingroup nvhls_int
+ */
+template <typename type, typename shift_type>
+struct left_shift_state {
+  type val;
+  bool overflow;
+  shift_type shift;
+};
+
+/**
+ * \brief State of a right barrel shift between stages
+ * \ingroup nvhls_int
+ *
+ * The value is kept in the upper half of a 2W-bit register, the lower half
+ * holds the shifted-out fraction and lost is set if a one was shifted out of
+ * the fraction.
+ */
+template <typename type, typename shift_type>
+struct right_shift_state {
+  static const unsigned int W = Wrapped<type>::width;
+  typedef typename shift_int_t<2 * W, Wrapped<type>::is_signed>::type ext_t;
+  ext_t ext;
+  bool lost;
+  shift_type shift;
+  typename nvhls_t<W>::nvuint_t rnd;
+};
+
+// Applies stages [lo, hi) of a left barrel shift: stage k shifts by 2^k if
+// bit k of the shift amount is set and records whether significant bits were
+// shifted out.
+template <typename type, typename shift_type>
+void left_shift_stages(left_shift_state<type, shift_type>& s, unsigned int lo, unsigned int hi) {
+  const unsigned int W = Wrapped<type>::width;
+  const bool is_signed = Wrapped<type>::is_signed;
+  const unsigned int ShiftW = Wrapped<shift_type>::width;
+#pragma hls_unroll yes
+  for (unsigned int k = 0; k < ShiftW; k++) {
+    if ((k >= lo) && (k < hi) && (s.shift[k] == 1)) {
+      const unsigned int a = 1u << k;
+      if (a >= W) {
+        s.overflow = s.overflow || (s.val != 0);
+        s.val = 0;
+      } else {
+        if (is_signed) {
+          // the top a+1 bits must all equal the sign bit
+          type top = s.val >> (W - 1 - a);
+          s.overflow = s.overflow || !((top == 0) || (top == -1));
+        } else {
+          type top = s.val >> (W - a);
+          s.overflow = s.overflow || (top != 0);
+        }
+        s.val = s.val << a;
+      }
+    }
+  }
+}
+
+// Applies stages [lo, hi) of a right barrel shift
+template <typename type, typename shift_type>
+void right_shift_stages(right_shift_state<type, shift_type>& s, unsigned int lo, unsigned int hi) {
+  const unsigned int W = Wrapped<type>::width;
+  const unsigned int ShiftW = Wrapped<shift_type>::width;
+  typedef typename nvhls_t<2 * W>::nvuint_t ext_bits_t;
+#pragma hls_unroll yes
+  for (unsigned int k = 0; k < ShiftW; k++) {
+    if ((k >= lo) && (k < hi) && (s.shift[k] == 1)) {
+      const unsigned int a = 1u << k;
+      ext_bits_t bits = s.ext;
+      if (a >= 2 * W) {
+        s.lost = s.lost || (bits != 0);
+        s.ext = (s.ext < 0) ? -1 : 0;
+      } else {
+        ext_bits_t dropped = bits << (2 * W - a);
+        s.lost = s.lost || (dropped != 0);
+        s.ext = s.ext >> a;
+      }
+    }
+  }
+}
+
+template <typename type, typename shift_type>
+left_shift_state<type, shift_type> left_shift_init(type X, shift_type shift) {
+  left_shift_state<type, shift_type> s;
+  s.val = X;
+  s.overflow = false;
+  s.shift = shift;
+  return s;
+}
+
+template <typename type, bool Saturate, typename shift_type>
+type left_shift_result(const left_shift_state<type, shift_type>& s, bool negative) {
+  const unsigned int W = Wrapped<type>::width;
+  const bool is_signed = Wrapped<type>::is_signed;
+  type out = s.val;
+  if (Saturate && s.overflow) {
+    typename nvhls_t<W>::nvuint_t bits = 0;
+    if (is_signed) {
+      bits[W - 1] = negative ? 1 : 0;
+      if (!negative) {
+        bits = ~bits;
+        bits[W - 1] = 0;
+      }
+    } else {
+      bits = ~bits;
+    }
+    out = bits;
+  }
+  return out;
+}
+
+template <typename type, typename shift_type>
+right_shift_state<type, shift_type> right_shift_init(type X, shift_type shift,
+                                                     typename nvhls_t<Wrapped<type>::width>::nvuint_t rnd) {
+  const unsigned int W = Wrapped<type>::width;
+  right_shift_state<type, shift_type> s;
+  s.ext = X;
+  s.ext = s.ext << W;
+  s.lost = false;
+  s.shift = shift;
+  s.rnd = rnd;
+  return s;
+}
+
+template <typename type, shift_round_mode Round, typename shift_type>
+type right_shift_result(const right_shift_state<type, shift_type>& s) {
+  const unsigned int W = Wrapped<type>::width;
+  typedef typename nvhls_t<W>::nvuint_t word_t;
+  word_t upper = get_slc<W>(s.ext, W);
+  word_t frac = get_slc<W>(s.ext, 0);
+  type out = upper;
+  bool round_up = false;
+  if (Round == RoundNearestEven) {
+    word_t below_guard = frac;
+    below_guard[W - 1] = 0;
+    bool guard = (frac[W - 1] == 1);
+    bool sticky = (below_guard != 0) || s.lost;
+    round_up = guard && (sticky || (upper[0] == 1));
+  } else if (Round == RoundStochastic) {
+    round_up = (frac > s.rnd);
+  }
+  // The increment cannot overflow: a non-zero fraction needs a shift of at
+  // least one bit
+  if (round_up) {
+    out = out + 1;
+  }
+  return out;
+}
+
+/**
+ * \brief Barrel-shifter left shift with optional saturation
+ * \ingroup nvhls_int
+ *
+ * \tparam type                 Datatype, nvint or nvuint type
+ * \tparam Saturate             Saturate on overflow instead of wrapping
+ * \tparam shift_type           Unsigned type of the shift amount; its width sets the number of stages
+ *
+ * \param[in]  X               Input variable 
+ * \param[in]  shift           Number of bits to be shifted
+ * \param[out] ReturnVal       X shifted left
+ *
+ * \par Overview
+ * - An explicit barrel shifter of Wrapped<shift_type>::width stages, stage k shifting by 2^k. Use PipelinedLeftShift to register between stages.
+ * - Signed values are shifted arithmetically. With Saturate, a result that does not fit returns the largest value of the sign of X (for signed types, -2^(W-1) or 2^(W-1)-1).
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_shift.h>
+ *
+ *      ...
+ *      NVINT8 X = -5;
+ *      NVUINT3 shift = 2;
+ *      NVINT8 ShiftedX = nvhls::barrel_left_shift<NVINT8, true>(X, shift); // -20
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename type, bool Saturate, typename shift_type>
+type barrel_left_shift(type X, shift_type shift) {
+  const unsigned int ShiftW = Wrapped<shift_type>::width;
+  left_shift_state<type, shift_type> s = left_shift_init(X, shift);
+  left_shift_stages(s, 0, ShiftW);
+  return left_shift_result<type, Saturate>(s, X < 0);
+}
+
+/**
+ * \brief Barrel-shifter right shift with rounding
+ * \ingroup nvhls_int
+ *
+ * \tparam type                 Datatype, nvint or nvuint type
+ * \tparam Round                Rounding mode, see shift_round_mode
+ * \tparam shift_type           Unsigned type of the shift amount; its width sets the number of stages
+ *
+ * \param[in]  X               Input variable 
+ * \param[in]  shift           Number of bits to be shifted
+ * \param[in]  rnd             Uniform random word, used by RoundStochastic only
+ * \param[out] ReturnVal       X shifted right and rounded
+ *
+ * \par Overview
+ * - An explicit barrel shifter of Wrapped<shift_type>::width stages over a 2W-bit register, so the shifted-out fraction is available for rounding. Use PipelinedRightShift to register between stages.
+ * - Signed values are shifted arithmetically, so RoundTruncate rounds towards minus infinity.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_shift.h>
+ *
+ *      ...
+ *      NVINT8 X = 10;
+ *      NVUINT3 shift = 2;
+ *      NVINT8 ShiftedX = nvhls::barrel_right_shift<NVINT8, nvhls::RoundNearestEven>(X, shift); // 2
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename type, shift_round_mode Round, typename shift_type>
+type barrel_right_shift(type X, shift_type shift,
+                        typename nvhls_t<Wrapped<type>::width>::nvuint_t rnd = 0) {
+  const unsigned int ShiftW = Wrapped<shift_type>::width;
+  right_shift_state<type, shift_type> s = right_shift_init(X, shift, rnd);
+  right_shift_stages(s, 0, ShiftW);
+  return right_shift_result<type, Round>(s);
+}
+
+/**
+ * \brief Pipelined barrel-shifter left shift
+ * \ingroup nvhls_int
+ *
+ * \tparam type                 Datatype, nvint or nvuint type
+ * \tparam shift_type           Unsigned type of the shift amount
+ * \tparam StagesPerCycle       Number of shifter stages between pipeline registers
+ * \tparam Saturate             Saturate on overflow instead of wrapping
+ *
+ * \par Overview
+ * - Each call of run() is one cycle. The result of an input appears Latency calls later, with Latency = ceil(stages / StagesPerCycle) - 1, and is identical to barrel_left_shift.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_shift.h>
+ *
+ *      ...
+ *      nvhls::PipelinedLeftShift<NVINT32, NVUINT5, 2, true> shifter;
+ *      ...
+ *      bool out_valid = shifter.run(in_valid, X, shift, out);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename type, typename shift_type, unsigned int StagesPerCycle, bool Saturate = false>
+class PipelinedLeftShift {
+ public:
+  static const unsigned int ShiftW = Wrapped<shift_type>::width;
+  static const unsigned int NumGroups = (ShiftW + StagesPerCycle - 1) / StagesPerCycle;
+  static const unsigned int Latency = NumGroups - 1;
+
+ private:
+  static const unsigned int NumRegs = (Latency > 0) ? Latency : 1;
+  left_shift_state<type, shift_type> regs[NumRegs];
+  bool regs_negative[NumRegs];
+  bool regs_valid[NumRegs];
+
+ public:
+  PipelinedLeftShift() { reset(); }
+
+  void reset() {
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumRegs; i++) {
+      regs_valid[i] = false;
+    }
+  }
+
+  // Returns true if out holds a valid result in this cycle
+  bool run(bool in_valid, type X, shift_type shift, type& out) {
+    bool out_valid = false;
+#pragma hls_unroll yes
+    for (int g = NumGroups - 1; g >= 0; g--) {
+      left_shift_state<type, shift_type> s;
+      bool negative, valid;
+      if (g == 0) {
+        s = left_shift_init(X, shift);
+        negative = (X < 0);
+        valid = in_valid;
+      } else {
+        s = regs[g - 1];
+        negative = regs_negative[g - 1];
+        valid = regs_valid[g - 1];
+      }
+      left_shift_stages(s, g * StagesPerCycle, (g + 1) * StagesPerCycle);
+      if (g == static_cast<int>(NumGroups) - 1) {
+        out = left_shift_result<type, Saturate>(s, negative);
+        out_valid = valid;
+      } else {
+        regs[g] = s;
+        regs_negative[g] = negative;
+        regs_valid[g] = valid;
+      }
+    }
+    return out_valid;
+  }
+};
+
+/**
+ * \brief Pipelined barrel-shifter right shift with rounding
+ * \ingroup nvhls_int
+ *
+ * \tparam type                 Datatype, nvint or nvuint type
+ * \tparam shift_type           Unsigned type of the shift amount
+ * \tparam StagesPerCycle       Number of shifter stages between pipeline registers
+ * \tparam Round                Rounding mode, see shift_round_mode
+ *
+ * \par Overview
+ * - Each call of run() is one cycle. The result of an input appears Latency calls later, with Latency = ceil(stages / StagesPerCycle) - 1, and is identical to barrel_right_shift.
+ *
+ */
+template <typename type, typename shift_type, unsigned int StagesPerCycle,
+          shift_round_mode Round = RoundTruncate>
+class PipelinedRightShift {
+ public:
+  static const unsigned int ShiftW = Wrapped<shift_type>::width;
+  static const unsigned int NumGroups = (ShiftW + StagesPerCycle - 1) / StagesPerCycle;
+  static const unsigned int Latency = NumGroups - 1;
+
+ private:
+  static const unsigned int NumRegs = (Latency > 0) ? Latency : 1;
+  right_shift_state<type, shift_type> regs[NumRegs];
+  bool regs_valid[NumRegs];
+
+ public:
+  PipelinedRightShift() { reset(); }
+
+  void reset() {
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumRegs; i++) {
+      regs_valid[i] = false;
+    }
+  }
+
+  // Returns true if out holds a valid result in this cycle
+  bool run(bool in_valid, type X, shift_type shift, type& out,
+           typename nvhls_t<Wrapped<type>::width>::nvuint_t rnd = 0) {
+    bool out_valid = false;
+#pragma hls_unroll yes
+    for (int g = NumGroups - 1; g >= 0; g--) {
+      right_shift_state<type, shift_type> s;
+      bool valid;
+      if (g == 0) {
+        s = right_shift_init(X, shift, rnd);
+        valid = in_valid;
+      } else {
+        s = regs[g - 1];
+        valid = regs_valid[g - 1];
+      }
+      right_shift_stages(s, g * StagesPerCycle, (g + 1) * StagesPerCycle);
+      if (g == static_cast<int>(NumGroups) - 1) {
+        out = right_shift_result<type, Round>(s);
+        out_valid = valid;
+      } else {
+        regs[g] = s;
+        regs_valid[g] = valid;
+      }
+    }
+    return out_valid;
+  }
+};
+
+}  // namespace nvhls
+
+#endif
@@ -0,0 +1,638 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_SORT_H
+#define NVHLS_SORT_H
+
+#include <nvhls_int.h>
+#include <nvhls_vector.h>
+
+namespace nvhls {
+
+/**
+ * \brief Sorting network policies
+ * \ingroup comptrees
+ *
+ * \par Overview
+ * - BitonicNetwork: Batcher's bitonic sorter. Every stage compares N/2 pairs.
+ * - OddEvenMergeNetwork: Batcher's odd-even merge sorter. Same depth as the bitonic sorter with fewer comparators.
+ * - Both have log2(N) * (log2(N) + 1) / 2 stages for N a power of 2.
+ */
+struct BitonicNetwork {};
+struct OddEvenMergeNetwork {};
+
+// Orders a and b; swaps only if they are strictly out of order
+template <typename T>
+inline void sort_compare_exchange(T& a, T& b, bool ascending) {
+  bool swap = ascending ? (b < a) : (a < b);
+  if (swap) {
+    T tmp = a;
+    a = b;
+    b = tmp;
+  }
+}
+
+// Bitonic sort stages [lo, hi) on groups of size G. The last merge of every
+// group goes in increasing order for even groups and in decreasing order for
+// odd groups; flip inverts all directions.
+template <unsigned int N, unsigned int G, typename T>
+void bitonic_stages(T (&a)[N], unsigned int lo, unsigned int hi, bool flip) {
+  unsigned int s = 0;
+#pragma hls_unroll yes
+  for (unsigned int k = 2; k <= G; k <<= 1) {
+#pragma hls_unroll yes
+    for (unsigned int j = k >> 1; j > 0; j >>= 1) {
+      if (s >= lo && s < hi) {
+#pragma hls_unroll yes
+        for (unsigned int i = 0; i < N; i++) {
+          if ((i & j) == 0) {
+            sort_compare_exchange(a[i], a[i + j], ((i & k) == 0) != flip);
+          }
+        }
+      }
+      s++;
+    }
+  }
+}
+
+// Odd-even merge sort stages [lo, hi)
+template <unsigned int N, typename T>
+void odd_even_merge_stages(T (&a)[N], unsigned int lo, unsigned int hi, bool descending) {
+  unsigned int s = 0;
+#pragma hls_unroll yes
+  for (unsigned int p = 1; p < N; p <<= 1) {
+#pragma hls_unroll yes
+    for (unsigned int k = p; k > 0; k >>= 1) {
+      if (s >= lo && s < hi) {
+        unsigned int r = k % p;
+#pragma hls_unroll yes
+        for (unsigned int i = 0; i < N; i++) {
+          if (i >= r && ((i - r) & k) == 0 && i + k < N && (i / (2 * p)) == ((i + k) / (2 * p))) {
+            sort_compare_exchange(a[i], a[i + k], !descending);
+          }
+        }
+      }
+      s++;
+    }
+  }
+}
+
+template <typename Network, unsigned int N>
+struct sort_network;
+
+template <unsigned int N>
+struct sort_network<BitonicNetwork, N> {
+  static const unsigned int Log = nvhls::log2_ceil<N>::val;
+  static const unsigned int NumStages = Log * (Log + 1) / 2;
+
+  template <typename T>
+  static void stages(T (&a)[N], unsigned int lo, unsigned int hi, bool descending) {
+    bitonic_stages<N, N>(a, lo, hi, descending);
+  }
+};
+
+template <unsigned int N>
+struct sort_network<OddEvenMergeNetwork, N> {
+  static const unsigned int Log = nvhls::log2_ceil<N>::val;
+  static const unsigned int NumStages = Log * (Log + 1) / 2;
+
+  template <typename T>
+  static void stages(T (&a)[N], unsigned int lo, unsigned int hi, bool descending) {
+    odd_even_merge_stages<N>(a, lo, hi, descending);
+  }
+};
+
+// Element of the top-K network: the key and its position in the input
+template <typename ElemT, typename IdxT>
+struct sort_pair {
+  ElemT key;
+  IdxT idx;
+  bool operator<(const sort_pair& rhs) const { return key < rhs.key; }
+};
+
+#ifndef __SYNTHESIS__
+// C++ simulation kernels for the sorting networks. They run the same
+// compare-exchange sequence as the networks on 64-bit host integers, respect
+// the same tie rule and therefore return identical results, including the
+// indices of equal keys in top-K.
+
+template <typename T>
+inline int64 host_sort_key(const T& v) {
+  return Wrapped<T>::is_signed ? v.to_int64()
+                               : static_cast<int64>(v.to_uint64() ^ (static_cast<uint64>(1) << 63));
+}
+
+template <typename T>
+inline T host_sort_value(int64 key) {
+  T v;
+  if (Wrapped<T>::is_signed) {
+    v = key;
+  } else {
+    v = static_cast<uint64>(key) ^ (static_cast<uint64>(1) << 63);
+  }
+  return v;
+}
+
+// Compare-exchange of key[i] and key[i + d] for i in [start, start + len).
+// If prune is set, key[i] only takes the better of the two (the larger if
+// ascending is false) and key[i + d] is left as is.
+inline void host_sort_run(int64* key, int64* pay, unsigned int start, unsigned int len, unsigned int d,
+                          bool ascending, bool prune = false) {
+  unsigned int i = start;
+  unsigned int end = start + len;
+#if defined(__AVX2__)
+  for (; i + 4 <= end; i += 4) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key + i));
+    __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key + i + d));
+    __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pay + i));
+    __m256i py = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pay + i + d));
+    __m256i swap = ascending ? _mm256_cmpgt_epi64(x, y) : _mm256_cmpgt_epi64(y, x);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(key + i), _mm256_blendv_epi8(x, y, swap));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pay + i), _mm256_blendv_epi8(px, py, swap));
+    if (!prune) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(key + i + d), _mm256_blendv_epi8(y, x, swap));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(pay + i + d), _mm256_blendv_epi8(py, px, swap));
+    }
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  for (; i + 2 <= end; i += 2) {
+    int64x2_t x = vld1q_s64(key + i);
+    int64x2_t y = vld1q_s64(key + i + d);
+    int64x2_t px = vld1q_s64(pay + i);
+    int64x2_t py = vld1q_s64(pay + i + d);
+    uint64x2_t swap = ascending ? vcgtq_s64(x, y) : vcgtq_s64(y, x);
+    vst1q_s64(key + i, vbslq_s64(swap, y, x));
+    vst1q_s64(pay + i, vbslq_s64(swap, py, px));
+    if (!prune) {
+      vst1q_s64(key + i + d, vbslq_s64(swap, x, y));
+      vst1q_s64(pay + i + d, vbslq_s64(swap, px, py));
+    }
+  }
+#endif
+  for (; i < end; i++) {
+    int64 x = key[i], y = key[i + d], px = pay[i], py = pay[i + d];
+    bool swap = ascending ? (y < x) : (x < y);
+    if (swap) {
+      key[i] = y;
+      pay[i] = py;
+      if (!prune) {
+        key[i + d] = x;
+        pay[i + d] = px;
+      }
+    }
+  }
+}
+
+// Host version of bitonic_stages, running all stages
+inline void host_bitonic_stages(int64* key, int64* pay, unsigned int n, unsigned int group, bool flip) {
+  for (unsigned int k = 2; k <= group; k <<= 1) {
+    for (unsigned int j = k >> 1; j > 0; j >>= 1) {
+      for (unsigned int b = 0; b < n; b += 2 * j) {
+        host_sort_run(key, pay, b, j, j, ((b & k) == 0) != flip);
+      }
+    }
+  }
+}
+
+// Host version of odd_even_merge_stages, running all stages. Within a run
+// of k compare-exchanges the merge condition does not change.
+inline void host_odd_even_merge_stages(int64* key, int64* pay, unsigned int n, bool descending) {
+  for (unsigned int p = 1; p < n; p <<= 1) {
+    for (unsigned int k = p; k > 0; k >>= 1) {
+      for (unsigned int b = k % p; b + k < n; b += 2 * k) {
+        if ((b / (2 * p)) == ((b + k) / (2 * p))) {
+          host_sort_run(key, pay, b, k, k, !descending);
+        }
+      }
+    }
+  }
+}
+
+inline void host_network_stages(BitonicNetwork, int64* key, int64* pay, unsigned int n, bool descending) {
+  host_bitonic_stages(key, pay, n, n, descending);
+}
+
+inline void host_network_stages(OddEvenMergeNetwork, int64* key, int64* pay, unsigned int n,
+                                bool descending) {
+  host_odd_even_merge_stages(key, pay, n, descending);
+}
+
+// Host version of the TopK stages
+inline void host_top_k_stages(int64* key, int64* pay, unsigned int n, unsigned int k,
+                              unsigned int rounds, bool is_max) {
+  host_bitonic_stages(key, pay, n, k, (rounds == 0) && is_max);
+  for (unsigned int r = 1; r <= rounds; r++) {
+    unsigned int span = k << r;
+    for (unsigned int base = 0; base < n; base += span) {
+      host_sort_run(key, pay, base, k, span / 2, !is_max, true);
+      for (unsigned int j = k >> 1; j > 0; j >>= 1) {
+        for (unsigned int b = base; b < base + k; b += 2 * j) {
+          host_sort_run(key, pay, b, j, j, (r == rounds) ? !is_max : ((base & span) == 0));
+        }
+      }
+    }
+  }
+}
+
+template <bool Enable>
+struct host_sort_kernels {
+  template <typename Network, typename ElemT, unsigned int N>
+  static bool sort(ElemT (&a)[N], bool descending) {
+    return false;
+  }
+  template <typename ElemT, unsigned int N, unsigned int K, typename IdxT>
+  static bool top_k(const ElemT (&in)[N], ElemT (&out)[K], IdxT (&idx)[K], unsigned int rounds,
+                    bool is_max) {
+    return false;
+  }
+};
+
+template <>
+struct host_sort_kernels<true> {
+  template <typename Network, typename ElemT, unsigned int N>
+  static bool sort(ElemT (&a)[N], bool descending) {
+    int64 key[N], pay[N];
+    for (unsigned int i = 0; i < N; i++) {
+      key[i] = host_sort_key(a[i]);
+      pay[i] = 0;
+    }
+    host_network_stages(Network(), key, pay, N, descending);
+    for (unsigned int i = 0; i < N; i++) a[i] = host_sort_value<ElemT>(key[i]);
+    return true;
+  }
+  template <typename ElemT, unsigned int N, unsigned int K, typename IdxT>
+  static bool top_k(const ElemT (&in)[N], ElemT (&out)[K], IdxT (&idx)[K], unsigned int rounds,
+                    bool is_max) {
+    int64 key[N], pay[N];
+    for (unsigned int i = 0; i < N; i++) {
+      key[i] = host_sort_key(in[i]);
+      pay[i] = i;
+    }
+    host_top_k_stages(key, pay, N, K, rounds, is_max);
+    for (unsigned int j = 0; j < K; j++) {
+      out[j] = host_sort_value<ElemT>(key[j]);
+      idx[j] = pay[j];
+    }
+    return true;
+  }
+};
+
+template <typename Network, typename ElemT, unsigned int N>
+inline bool host_sort(ElemT (&a)[N], bool descending) {
+#ifdef VECTOR_SIM_USE_SCALAR_OPS
+  return false;
+#else
+  return host_sort_kernels<host_vector_type<ElemT>::value>::template sort<Network>(a, descending);
+#endif
+}
+
+template <typename ElemT, unsigned int N, unsigned int K, typename IdxT>
+inline bool host_top_k(const ElemT (&in)[N], ElemT (&out)[K], IdxT (&idx)[K], unsigned int rounds,
+                       bool is_max) {
+#ifdef VECTOR_SIM_USE_SCALAR_OPS
+  return false;
+#else
+  return host_sort_kernels<host_vector_type<ElemT>::value>::top_k(in, out, idx, rounds, is_max);
+#endif
+}
+#endif  // __SYNTHESIS__
+
+/**
+ * \brief Sorting network
+ * \ingroup comptrees
+ *
+ * \tparam ElemT        Element type, compared with operator<
+ * \tparam N            Number of elements, a power of 2
+ * \tparam Network      BitonicNetwork or OddEvenMergeNetwork
+ * \tparam Ascending    Sort order
+ *
+ * \par Overview
+ * - sort() orders a plain array or an nv_scvector in place in a single combinational network of NumStages compare-exchange stages.
+ * - stages(a, lo, hi) applies stages [lo, hi) only; PipelinedSort uses it to place registers between stages.
+ * - In C++ simulation nvint/nvuint elements of up to 64 bits are sorted with host SIMD kernels that run the same network. Define VECTOR_SIM_USE_SCALAR_OPS to disable them.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_sort.h>
+ *
+ *      ...
+ *      NVUINT16 scores[16];
+ *      nvhls::SortNetwork<NVUINT16, 16>::sort(scores);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename ElemT, unsigned int N, typename Network = BitonicNetwork, bool Ascending = true>
+class SortNetwork {
+ public:
+  static_assert(N > 0 && (N & (N - 1)) == 0, "N must be a power of 2");
+  static const unsigned int NumStages = sort_network<Network, N>::NumStages;
+
+  template <typename T>
+  static void stages(T (&a)[N], unsigned int lo, unsigned int hi) {
+    sort_network<Network, N>::stages(a, lo, hi, !Ascending);
+  }
+
+  static void sort(ElemT (&a)[N]) {
+#ifndef __SYNTHESIS__
+    if (host_sort<Network>(a, !Ascending)) {
+      return;
+    }
+#endif
+    stages(a, 0, NumStages);
+  }
+
+  static void sort(nv_scvector<ElemT, N>& vec) {
+    ElemT a[N];
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < N; i++) a[i] = vec[i];
+    sort(a);
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < N; i++) vec[i] = a[i];
+  }
+};
+
+/**
+ * \brief Top-K selection network
+ * \ingroup comptrees
+ *
+ * \tparam ElemT        Element type, compared with operator<
+ * \tparam N            Number of elements, a power of 2
+ * \tparam K            Number of elements selected, a power of 2 no larger than N
+ * \tparam is_max       true to select the K largest elements, false for the K smallest
+ *
+ * \par Overview
+ * - select() returns the K largest (smallest) elements, best first, and their positions in the input.
+ * - The input is sorted in groups of K with a bitonic network. log2(N/K) rounds then combine pairs of groups: the better half of two oppositely sorted groups is selected element by element and re-sorted with a bitonic merge of log2(K) stages. This takes far fewer comparators than sorting all N elements.
+ * - Ties are broken the same way in every run, so which of several equal elements is returned is deterministic.
+ * - stages(a, lo, hi) and PipelinedTopK place registers between stages. In C++ simulation nvint/nvuint elements of up to 64 bits use host SIMD kernels, as in SortNetwork.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_sort.h>
+ *
+ *      ...
+ *      typedef nvhls::TopK<NVINT16, 64, 4> TopKType;
+ *      nv_scvector<NVINT16, 64> logits;
+ *      NVINT16 best[4];
+ *      TopKType::idx_t best_idx[4];
+ *      TopKType::select(logits, best, best_idx);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename ElemT, unsigned int N, unsigned int K, bool is_max = true>
+class TopK {
+ public:
+  static_assert(N > 0 && (N & (N - 1)) == 0, "N must be a power of 2");
+  static_assert(K > 0 && (K & (K - 1)) == 0 && K <= N, "K must be a power of 2 no larger than N");
+  typedef NVUINTW(nvhls::index_width<N>::val) idx_t;
+  typedef sort_pair<ElemT, idx_t> elem_t;
+  static const unsigned int LogK = nvhls::log2_ceil<K>::val;
+  static const unsigned int Rounds = nvhls::log2_ceil<N>::val - LogK;
+  static const unsigned int NumStages = LogK * (LogK + 1) / 2 + Rounds * (LogK + 1);
+
+  static void stages(elem_t (&a)[N], unsigned int lo, unsigned int hi) {
+    // The groups are sorted in the final order if there is only one
+    bitonic_stages<N, K>(a, lo, hi, (Rounds == 0) && is_max);
+    unsigned int s = LogK * (LogK + 1) / 2;
+#pragma hls_unroll yes
+    for (unsigned int r = 1; r <= Rounds; r++) {
+      unsigned int span = K << r;
+      if (s >= lo && s < hi) {
+#pragma hls_unroll yes
+        for (unsigned int i = 0; i < N; i++) {
+          if ((i % span) < K) {
+            elem_t other = a[i + span / 2];
+            if (is_max ? (a[i] < other) : (other < a[i])) {
+              a[i] = other;
+            }
+          }
+        }
+      }
+      s++;
+#pragma hls_unroll yes
+      for (unsigned int j = K >> 1; j > 0; j >>= 1) {
+        if (s >= lo && s < hi) {
+#pragma hls_unroll yes
+          for (unsigned int i = 0; i < N; i++) {
+            if ((i % span) < K && (i & j) == 0) {
+              bool ascending = (r == Rounds) ? !is_max : ((i & span) == 0);
+              sort_compare_exchange(a[i], a[i + j], ascending);
+            }
+          }
+        }
+        s++;
+      }
+    }
+  }
+
+  static void load(const ElemT (&in)[N], elem_t (&a)[N]) {
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < N; i++) {
+      a[i].key = in[i];
+      a[i].idx = i;
+    }
+  }
+
+  static void store(const elem_t (&a)[N], ElemT (&out)[K], idx_t (&idx)[K]) {
+#pragma hls_unroll yes
+    for (unsigned int j = 0; j < K; j++) {
+      out[j] = a[j].key;
+      idx[j] = a[j].idx;
+    }
+  }
+
+  static void select(const ElemT (&in)[N], ElemT (&out)[K], idx_t (&idx)[K]) {
+#ifndef __SYNTHESIS__
+    if (host_top_k(in, out, idx, Rounds, is_max)) {
+      return;
+    }
+#endif
+    elem_t a[N];
+    load(in, a);
+    stages(a, 0, NumStages);
+    store(a, out, idx);
+  }
+
+  static void select(const nv_scvector<ElemT, N>& vec, ElemT (&out)[K], idx_t (&idx)[K]) {
+    ElemT in[N];
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < N; i++) in[i] = vec[i];
+    select(in, out, idx);
+  }
+};
+
+/**
+ * \brief Sorting network registered every StagesPerCycle stages
+ * \ingroup comptrees
+ *
+ * \tparam ElemT            Element type
+ * \tparam N                Number of elements, a power of 2
+ * \tparam StagesPerCycle   Number of compare-exchange stages between pipeline registers
+ * \tparam Network          BitonicNetwork or OddEvenMergeNetwork
+ * \tparam Ascending        Sort order
+ *
+ * \par Overview
+ * - Each call of run() is one cycle. The sorted vector of an input appears Latency calls later, with Latency = ceil(NumStages / StagesPerCycle) - 1, and is identical to SortNetwork::sort. A new input can be accepted every cycle.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_sort.h>
+ *
+ *      ...
+ *      nvhls::PipelinedSort<NVUINT16, 32, 3> sorter;
+ *      ...
+ *      bool out_valid = sorter.run(in_valid, in, out);
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename ElemT, unsigned int N, unsigned int StagesPerCycle,
+          typename Network = BitonicNetwork, bool Ascending = true>
+class PipelinedSort {
+ public:
+  typedef SortNetwork<ElemT, N, Network, Ascending> network_t;
+  static const unsigned int NumStages = network_t::NumStages;
+  static const unsigned int NumGroups =
+      (NumStages > 0) ? (NumStages + StagesPerCycle - 1) / StagesPerCycle : 1;
+  static const unsigned int Latency = NumGroups - 1;
+
+ private:
+  static const unsigned int NumRegs = (Latency > 0) ? Latency : 1;
+  ElemT regs[NumRegs][N];
+  bool regs_valid[NumRegs];
+
+ public:
+  PipelinedSort() { reset(); }
+
+  void reset() {
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumRegs; i++) {
+      regs_valid[i] = false;
+    }
+  }
+
+  // Returns true if out holds a valid result in this cycle
+  bool run(bool in_valid, const ElemT (&in)[N], ElemT (&out)[N]) {
+    bool out_valid = false;
+#pragma hls_unroll yes
+    for (int g = NumGroups - 1; g >= 0; g--) {
+      ElemT a[N];
+#pragma hls_unroll yes
+      for (unsigned int i = 0; i < N; i++) {
+        a[i] = (g == 0) ? in[i] : regs[(g > 0) ? g - 1 : 0][i];
+      }
+      bool valid = (g == 0) ? in_valid : regs_valid[(g > 0) ? g - 1 : 0];
+      network_t::stages(a, g * StagesPerCycle, (g + 1) * StagesPerCycle);
+      if (g == static_cast<int>(NumGroups) - 1) {
+#pragma hls_unroll yes
+        for (unsigned int i = 0; i < N; i++) {
+          out[i] = a[i];
+        }
+        out_valid = valid;
+      } else {
+#pragma hls_unroll yes
+        for (unsigned int i = 0; i < N; i++) {
+          regs[g][i] = a[i];
+        }
+        regs_valid[g] = valid;
+      }
+    }
+    return out_valid;
+  }
+};
+
+/**
+ * \brief Top-K selection network registered every StagesPerCycle stages
+ * \ingroup comptrees
+ *
+ * \tparam ElemT            Element type
+ * \tparam N                Number of elements, a power of 2
+ * \tparam K                Number of elements selected, a power of 2 no larger than N
+ * \tparam StagesPerCycle   Number of stages between pipeline registers
+ * \tparam is_max           true to select the K largest elements, false for the K smallest
+ *
+ * \par Overview
+ * - Each call of run() is one cycle. The result of an input appears Latency calls later, with Latency = ceil(NumStages / StagesPerCycle) - 1, and is identical to TopK::select. A new input can be accepted every cycle.
+ */
+template <typename ElemT, unsigned int N, unsigned int K, unsigned int StagesPerCycle,
+          bool is_max = true>
+class PipelinedTopK {
+ public:
+  typedef TopK<ElemT, N, K, is_max> network_t;
+  typedef typename network_t::elem_t elem_t;
+  typedef typename network_t::idx_t idx_t;
+  static const unsigned int NumStages = network_t::NumStages;
+  static const unsigned int NumGroups =
+      (NumStages > 0) ? (NumStages + StagesPerCycle - 1) / StagesPerCycle : 1;
+  static const unsigned int Latency = NumGroups - 1;
+
+ private:
+  static const unsigned int NumRegs = (Latency > 0) ? Latency : 1;
+  elem_t regs[NumRegs][N];
+  bool regs_valid[NumRegs];
+
+ public:
+  PipelinedTopK() { reset(); }
+
+  void reset() {
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumRegs; i++) {
+      regs_valid[i] = false;
+    }
+  }
+
+  // Returns true if out and idx hold a valid result in this cycle
+  bool run(bool in_valid, const ElemT (&in)[N], ElemT (&out)[K], idx_t (&idx)[K]) {
+    bool out_valid = false;
+#pragma hls_unroll yes
+    for (int g = NumGroups - 1; g >= 0; g--) {
+      elem_t a[N];
+      if (g == 0) {
+        network_t::load(in, a);
+      } else {
+#pragma hls_unroll yes
+        for (unsigned int i = 0; i < N; i++) {
+          a[i] = regs[(g > 0) ? g - 1 : 0][i];
+        }
+      }
+      bool valid = (g == 0) ? in_valid : regs_valid[(g > 0) ? g - 1 : 0];
+      network_t::stages(a, g * StagesPerCycle, (g + 1) * StagesPerCycle);
+      if (g == static_cast<int>(NumGroups) - 1) {
+        network_t::store(a, out, idx);
+        out_valid = valid;
+      } else {
+#pragma hls_unroll yes
+        for (unsigned int i = 0; i < N; i++) {
+          regs[g][i] = a[i];
+        }
+        regs_valid[g] = valid;
+      }
+    }
+    return out_valid;
+  }
+};
+
+}  // namespace nvhls
+
+#endif
@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_STATS_H
+#define NVHLS_STATS_H
+
+#include <systemc.h>
+#ifndef __SYNTHESIS__
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+#endif
+
+namespace match {
+
+/**
+ * \brief Simulation statistics for classes that are not a match::Module
+ * \ingroup nvhls_module
+ *
+ * \par Overview
+ * - Named uint64 counters with the same interface as the stats of match::Module: IncrStat(), IncrStatIndexed() and DumpStats().
+ * - IncrStatHistogram() counts samples of a value, e.g. a queue occupancy, in one counter per value.
+ * - Counters that are updated every cycle should be registered once with RegisterStat(), RegisterStatIndexed() or RegisterStatHistogram() and incremented through the returned handle, which skips building and looking up the counter name. Registered and by-name counters with the same name are added together in the dumps.
+ * - DumpStatsJson() writes the counters as a flat JSON object for post-processing scripts.
+ * - All members compile to nothing under __SYNTHESIS__, so a Stats member does not change the synthesized design.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_stats.h>
+ *
+ *      ...
+ *      match::Stats stats;
+ *      stats.IncrStatIndexed("bank_accesses", bank);  // counter bank_accesses_<bank>
+ *      stats.IncrStatHistogram("queue_occupancy", port, occupancy);
+ *
+ *      match::Stats::StatHandle lane_flits = stats.RegisterStatIndexed("lane_flits", NumLanes);
+ *      stats.IncrStatIndexed(lane_flits, lane);       // counter lane_flits_<lane>
+ *      ...
+ *      stats.DumpStats(std::cout);
+ *
+ * \endcode
+ * \par
+ *
+ */
+class Stats {
+ public:
+  /* Handle of a registered counter or histogram: index of its first entry. */
+  struct StatHandle {
+    unsigned int idx;
+  };
+
+ private:
+#ifndef __SYNTHESIS__
+  std::map<std::string, uint64> stats_;
+  /* Names and values of registered counters. */
+  std::vector<std::string> stat_names_;
+  std::vector<uint64> stat_values_;
+  /* Registered histograms, one per index; counts grow with the largest value. */
+  struct Histogram {
+    std::string name;
+    std::vector<uint64> counts;
+  };
+  std::vector<Histogram> hists_;
+
+  // All counters by name, registered ones added into the by-name ones
+  void AllStats(std::map<std::string, uint64>& all) {
+    all = stats_;
+    for (unsigned int i = 0; i < stat_values_.size(); i++) {
+      if (stat_values_[i] != 0)
+        all[stat_names_[i]] += stat_values_[i];
+    }
+    for (unsigned int i = 0; i < hists_.size(); i++) {
+      for (unsigned int v = 0; v < hists_[i].counts.size(); v++) {
+        if (hists_[i].counts[v] == 0)
+          continue;
+        std::stringstream final_name;
+        final_name << hists_[i].name << "_hist_" << v;
+        all[final_name.str()] += hists_[i].counts[v];
+      }
+    }
+  }
+#endif
+
+ public:
+  void IncrStat(const std::string& name, unsigned int num = 1) {
+#ifndef __SYNTHESIS__
+    stats_[name] = stats_[name] + num;
+#endif
+  }
+
+  void IncrStatIndexed(const std::string& name, unsigned int idx,
+                       unsigned int num = 1) {
+#ifndef __SYNTHESIS__
+    std::stringstream final_name;
+    final_name << name << "_" << idx;
+    IncrStat(final_name.str(), num);
+#endif
+  }
+
+  // Counts one sample of value in counter <name>_<idx>_hist_<value>
+  void IncrStatHistogram(const std::string& name, unsigned int idx,
+                         unsigned int value) {
+#ifndef __SYNTHESIS__
+    std::stringstream final_name;
+    final_name << name << "_" << idx << "_hist_" << value;
+    IncrStat(final_name.str());
+#endif
+  }
+
+  // Registers counter name; call at construction
+  StatHandle RegisterStat(const std::string& name) {
+    StatHandle h;
+#ifndef __SYNTHESIS__
+    h.idx = stat_names_.size();
+    stat_names_.push_back(name);
+    stat_values_.push_back(0);
+#else
+    h.idx = 0;
+#endif
+    return h;
+  }
+
+  // Registers counters name_0 ... name_<num-1>
+  StatHandle RegisterStatIndexed(const std::string& name, unsigned int num) {
+    StatHandle h;
+#ifndef __SYNTHESIS__
+    h.idx = stat_names_.size();
+    for (unsigned int i = 0; i < num; i++) {
+      std::stringstream final_name;
+      final_name << name << "_" << i;
+      stat_names_.push_back(final_name.str());
+      stat_values_.push_back(0);
+    }
+#else
+    h.idx = 0;
+#endif
+    return h;
+  }
+
+  // Registers the histograms of IncrStatHistogram(name, idx, value) for idx
+  // 0 ... num-1
+  StatHandle RegisterStatHistogram(const std::string& name, unsigned int num) {
+    StatHandle h;
+#ifndef __SYNTHESIS__
+    h.idx = hists_.size();
+    for (unsigned int i = 0; i < num; i++) {
+      std::stringstream final_name;
+      final_name << name << "_" << i;
+      Histogram hist;
+      hist.name = final_name.str();
+      hists_.push_back(hist);
+    }
+#else
+    h.idx = 0;
+#endif
+    return h;
+  }
+
+  void IncrStat(StatHandle h, unsigned int num = 1) {
+#ifndef __SYNTHESIS__
+    stat_values_[h.idx] += num;
+#endif
+  }
+
+  void IncrStatIndexed(StatHandle h, unsigned int idx, unsigned int num = 1) {
+#ifndef __SYNTHESIS__
+    stat_values_[h.idx + idx] += num;
+#endif
+  }
+
+  void IncrStatHistogram(StatHandle h, unsigned int idx, unsigned int value) {
+#ifndef __SYNTHESIS__
+    std::vector<uint64>& counts = hists_[h.idx + idx].counts;
+    if (value >= counts.size())
+      counts.resize(value + 1, 0);
+    counts[value]++;
+#endif
+  }
+
+  // Looks up registered counters too, so only meant for the end of a test
+  uint64 GetStat(const std::string& name) {
+#ifndef __SYNTHESIS__
+    std::map<std::string, uint64> all;
+    AllStats(all);
+    std::map<std::string, uint64>::iterator it = all.find(name);
+    return (it == all.end()) ? 0 : it->second;
+#else
+    return 0;
+#endif
+  }
+
+  uint64 GetStatIndexed(const std::string& name, unsigned int idx) {
+#ifndef __SYNTHESIS__
+    std::stringstream final_name;
+    final_name << name << "_" << idx;
+    return GetStat(final_name.str());
+#else
+    return 0;
+#endif
+  }
+
+  bool HasStats() {
+#ifndef __SYNTHESIS__
+    std::map<std::string, uint64> all;
+    AllStats(all);
+    return (all.size() != 0);
+#else
+    return false;
+#endif
+  }
+
+  void ResetStats() {
+#ifndef __SYNTHESIS__
+    stats_.clear();
+    stat_values_.assign(stat_values_.size(), 0);
+    for (unsigned int i = 0; i < hists_.size(); i++)
+      hists_[i].counts.clear();
+#endif
+  }
+
+  void DumpStats(std::ostream& ofile, unsigned int lvl = 0) {
+#ifndef __SYNTHESIS__
+    std::map<std::string, uint64> all;
+    AllStats(all);
+    for (std::map<std::string, uint64>::iterator it = all.begin();
+         it != all.end(); it++) {
+      for (unsigned int x = 0; x < 2 * lvl; x++) {
+        ofile << " ";
+      }
+      ofile << it->first << ": " << it->second << std::endl;
+    }
+#endif
+  }
+
+  // Writes all counters as one flat JSON object {"<name>": <value>, ...}
+  void DumpStatsJson(std::ostream& ofile) {
+#ifndef __SYNTHESIS__
+    std::map<std::string, uint64> all;
+    AllStats(all);
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+    writer.SetIndent(' ', 2);
+    writer.StartObject();
+    for (std::map<std::string, uint64>::iterator it = all.begin();
+         it != all.end(); it++) {
+      writer.Key(it->first.c_str(), static_cast<rapidjson::SizeType>(it->first.size()));
+      writer.Uint64(it->second);
+    }
+    writer.EndObject();
+    ofile << buffer.GetString() << std::endl;
+#endif
+  }
+};
+
+}  // namespace match
+
+#endif  // NVHLS_STATS_H
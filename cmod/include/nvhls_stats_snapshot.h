@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_STATS_SNAPSHOT_H
+#define NVHLS_STATS_SNAPSHOT_H
+
+#include <systemc.h>
+#include <nvhls_module.h>
+#ifndef __SYNTHESIS__
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#endif
+
+namespace match {
+
+#ifndef __SYNTHESIS__
+/**
+ * \brief Periodic snapshots of the counters of match::Modules
+ * \ingroup nvhls_module
+ *
+ * \par Overview
+ * - Every period cycles of clk after reset, and on each call of Snapshot(), writes the current counters of the registered root Modules and all their child Modules to one file. Use Snapshot() for trigger events such as the start of a workload phase. A period of 0 disables the periodic snapshots.
+ * - The file has one column per counter, named <module name>.<stat name>. Columns are appended as counters appear:
+ *   - "C <name>" adds the next column.
+ *   - "S <cycle> <n> <v0> ... <v(n-1)>" is a snapshot of the first n columns.
+ * - StatsSnapshotReader loads a file and prints the counter deltas between two snapshots, so throughput dips can be lined up with workload phases.
+ * - C++ simulation only: counters of registered stats (Module::RegisterStat()) and of named stats are included, distributions are not.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_stats_snapshot.h>
+ *
+ *      ...
+ *      match::StatsSnapshotter snapshots("snapshots", "stats.snapshots", 100000);
+ *      snapshots.clk(clk);
+ *      snapshots.rst(rst);
+ *      snapshots.AddRoot(&dut);
+ *      ...
+ *      // Offline:
+ *      match::StatsSnapshotReader reader;
+ *      reader.Load("stats.snapshots");
+ *      reader.PrintDiff(std::cout, 3, 4);  // Deltas from snapshot 3 to 4
+ *
+ * \endcode
+ * \par
+ *
+ */
+class StatsSnapshotter : public sc_module {
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+
+  SC_HAS_PROCESS(StatsSnapshotter);
+  StatsSnapshotter(sc_module_name name_, const std::string& filename, uint64 period)
+      : sc_module(name_), clk("clk"), rst("rst"),
+        file_(filename.c_str(), std::ios::trunc), period_(period), cycle_(0) {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void AddRoot(Module* root) { roots_.push_back(root); }
+
+  // Writes a snapshot of all counters at the current cycle.
+  void Snapshot() {
+    std::vector<std::pair<std::string, uint64> > stats;
+    for (unsigned int i = 0; i < roots_.size(); i++)
+      roots_[i]->CollectStats(stats);
+    std::vector<uint64> values(columns_.size(), 0);
+    for (unsigned int i = 0; i < stats.size(); i++) {
+      std::map<std::string, unsigned int>::iterator it = columns_.find(stats[i].first);
+      if (it == columns_.end()) {
+        it = columns_.insert(std::make_pair(stats[i].first, columns_.size())).first;
+        file_ << "C " << stats[i].first << '\n';
+        values.push_back(0);
+      }
+      values[it->second] += stats[i].second;
+    }
+    file_ << "S " << cycle_ << " " << values.size();
+    for (unsigned int i = 0; i < values.size(); i++)
+      file_ << " " << values[i];
+    file_ << '\n';
+  }
+
+  ~StatsSnapshotter() { file_.flush(); }
+
+ private:
+  std::ofstream file_;
+  uint64 period_;
+  uint64 cycle_;
+  std::vector<Module*> roots_;
+  std::map<std::string, unsigned int> columns_;
+
+  void run() {
+    cycle_ = 0;
+    wait();
+    while (1) {
+      wait();
+      cycle_++;
+      if (period_ != 0 && cycle_ % period_ == 0)
+        Snapshot();
+    }
+  }
+};
+
+/**
+ * \brief Reader of StatsSnapshotter files
+ * \ingroup nvhls_module
+ */
+class StatsSnapshotReader {
+ public:
+  struct Snapshot {
+    uint64 cycle;
+    std::vector<uint64> values;
+  };
+
+  std::vector<std::string> columns;
+  std::vector<Snapshot> snapshots;
+
+  // Returns false if the file cannot be read or is malformed.
+  bool Load(const std::string& filename) {
+    columns.clear();
+    snapshots.clear();
+    std::ifstream in(filename.c_str());
+    if (!in)
+      return false;
+    std::string line;
+    while (std::getline(in, line)) {
+      if (line.size() > 2 && line[0] == 'C' && line[1] == ' ') {
+        columns.push_back(line.substr(2));
+      } else if (line.size() > 2 && line[0] == 'S' && line[1] == ' ') {
+        std::istringstream ss(line.substr(2));
+        Snapshot snap;
+        unsigned int n;
+        if (!(ss >> snap.cycle >> n) || n > columns.size())
+          return false;
+        snap.values.assign(columns.size(), 0);
+        for (unsigned int i = 0; i < n; i++) {
+          if (!(ss >> snap.values[i]))
+            return false;
+        }
+        snapshots.push_back(snap);
+      } else if (!line.empty()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Value of column in snapshot idx; columns added later read as 0.
+  uint64 Value(unsigned int idx, unsigned int column) const {
+    const std::vector<uint64>& values = snapshots[idx].values;
+    return (column < values.size()) ? values[column] : 0;
+  }
+
+  // Prints the counters that changed from snapshot from to snapshot to, with
+  // their delta and delta per cycle.
+  void PrintDiff(std::ostream& ofile, unsigned int from, unsigned int to) const {
+    uint64 cycles = snapshots[to].cycle - snapshots[from].cycle;
+    ofile << "Cycles " << snapshots[from].cycle << " to " << snapshots[to].cycle
+          << ":" << std::endl;
+    for (unsigned int c = 0; c < columns.size(); c++) {
+      long long delta = static_cast<long long>(Value(to, c)) -
+                        static_cast<long long>(Value(from, c));
+      if (delta == 0)
+        continue;
+      ofile << "  " << columns[c] << ": " << delta;
+      if (cycles != 0)
+        ofile << " (" << static_cast<double>(delta) / cycles << " per cycle)";
+      ofile << std::endl;
+    }
+  }
+};
+#endif
+
+}  // namespace match
+
+#endif  // NVHLS_STATS_SNAPSHOT_H
@@ -0,0 +1,492 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_THROUGHPUT_MODEL_H
+#define NVHLS_THROUGHPUT_MODEL_H
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#ifndef __SYNTHESIS__
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#endif
+
+namespace match {
+
+#ifndef __SYNTHESIS__
+/**
+ * \brief Analytical throughput estimate of an elaborated design
+ * \ingroup Connections
+ *
+ * \par Overview
+ * - Build() walks the elaborated hierarchy below a root object and finds the blocks, the modules that drive or read the val of a Connections port, and the buffered channels (Bypass, Pipeline, SkidBuffer, BypassBuffered and Buffer) between them. Two ports are connected if their val ports are bound to the same signal or to the two sides of the same Combinational. This needs the signal-level ports of SIM_MODE 0 or 1.
+ * - A block is a node with an initiation interval (II, cycles per message) and a latency; a buffered channel is a node with a capacity and a latency of 1 cycle. A block that both feeds and drains a path, e.g. a testbench module with the source and the sink of a chain, closes a loop.
+ * - The block parameters come from, in increasing priority: the default II and latency of 1; Measure(), which derives the II of every block with a buffered input channel from the ChannelProfiler counters of the cycles run so far, or Load() of a file written by Save() after such a run; SetBlock() annotations. SetChannel() overrides the capacity and latency of channels.
+ * - Estimate() assumes every block moves one message per channel per iteration. The throughput in messages per cycle is the minimum of 1, 1 / II of every block and, for every loop of the graph, the messages the loop can hold (the capacity of its channels, at least 1) divided by its latency (the sum of the latencies of its nodes). The node or loop that sets the minimum is the bottleneck.
+ * - Report() prints the nodes, the estimate and the tightest loops. The model takes no simulation time, so design points that differ in channel capacities or block annotations are compared in a single elaboration.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_throughput_model.h>
+ *
+ *      ...
+ *      testbench tb("tb");
+ *      sc_start(SC_ZERO_TIME);
+ *      match::ThroughputModel model;
+ *      model.SetBlock("tb.dut.decoder", 4, 12);
+ *      model.Build(tb);
+ *      model.Estimate();
+ *      model.Report(std::cout, 5);
+ *
+ * \endcode
+ * \par
+ *
+ */
+class ThroughputModel {
+ public:
+  struct Node {
+    std::string name;
+    bool channel;
+    unsigned int capacity;  // channels only
+    double ii, latency;
+    const char* source;     // "default", "measured", "annotated" or "channel"
+    std::vector<unsigned int> out;
+    Connections::ChannelProbe* probe;
+  };
+
+  struct Loop {
+    std::vector<unsigned int> nodes;
+    double bound;
+  };
+
+  ThroughputModel() : throughput_(0), limiter_(-1), limiting_loop_(-1) {}
+
+  // Annotates the blocks whose name is pattern, or starts with the prefix of
+  // a pattern that ends with '*'; the last matching annotation applies.
+  void SetBlock(const std::string& pattern, double ii, double latency) {
+    Rule rule = {pattern, ii, latency};
+    block_rules_.push_back(rule);
+  }
+
+  void SetChannel(const std::string& pattern, unsigned int capacity, double latency) {
+    Rule rule = {pattern, static_cast<double>(capacity), latency};
+    channel_rules_.push_back(rule);
+  }
+
+  // Finds the blocks and channels below root; call after elaboration.
+  void Build(const sc_object& root) {
+    nodes_.clear();
+    ids_.clear();
+    std::map<std::string, Connections::ChannelProbe*> probes;
+    const std::vector<Connections::ChannelProbe*>& all =
+        Connections::ChannelProfiler::Get().Probes();
+    for (unsigned int i = 0; i < all.size(); i++)
+      probes[all[i]->name()] = all[i];
+
+    // Writer and reader of every val signal
+    std::map<const sc_object*, Link> links;
+    std::vector<const sc_object*> order;
+    Collect(root, probes, links, order);
+    std::map<const sc_object*, std::pair<int, int> > ends;
+    for (unsigned int i = 0; i < order.size(); i++) {
+      const Link& link = links[order[i]];
+      ends[order[i]] = std::make_pair(NodeId(link.writer), NodeId(link.reader));
+    }
+
+    // The two val signals of a Combinational are one link
+    std::map<const sc_object*, std::pair<int, int> > grouped;
+    std::vector<const sc_object*> grouped_order;
+    for (unsigned int i = 0; i < order.size(); i++) {
+      const std::pair<int, int>& link = ends[order[i]];
+      const sc_object* key = order[i]->get_parent_object();
+      if (key == NULL || IsNode(key))
+        key = order[i];
+      std::map<const sc_object*, std::pair<int, int> >::iterator it = grouped.find(key);
+      if (it == grouped.end()) {
+        grouped[key] = link;
+        grouped_order.push_back(key);
+        continue;
+      }
+      std::pair<int, int>& g = it->second;
+      if ((g.first >= 0 && link.first >= 0 && g.first != link.first) ||
+          (g.second >= 0 && link.second >= 0 && g.second != link.second)) {
+        // Not a single channel, e.g. plain signals of a testbench
+        grouped[order[i]] = link;
+        grouped_order.push_back(order[i]);
+        continue;
+      }
+      if (g.first < 0)
+        g.first = link.first;
+      if (g.second < 0)
+        g.second = link.second;
+    }
+    for (unsigned int i = 0; i < grouped_order.size(); i++) {
+      const std::pair<int, int>& link = grouped[grouped_order[i]];
+      if (link.first < 0 || link.second < 0 || link.first == link.second)
+        continue;
+      std::vector<unsigned int>& out = nodes_[link.first].out;
+      if (std::find(out.begin(), out.end(), static_cast<unsigned int>(link.second)) == out.end())
+        out.push_back(link.second);
+    }
+    FindLoops();
+  }
+
+  // Derives the II of every block with a buffered input channel from the
+  // ChannelProfiler counters of the cycles run so far.
+  void Measure() {
+    for (unsigned int b = 0; b < nodes_.size(); b++) {
+      if (nodes_[b].channel)
+        continue;
+      Connections::ChannelProbe* in = NULL;
+      uint64 blocked_out = 0;
+      for (unsigned int c = 0; c < nodes_.size(); c++) {
+        Connections::ChannelProbe* p = nodes_[c].probe;
+        if (p == NULL || p->cycles == 0)
+          continue;
+        if (Feeds(c, b) && (in == NULL || p->transfers > in->transfers))
+          in = p;
+        if (Feeds(b, c) && p->blocked > blocked_out)
+          blocked_out = p->blocked;
+      }
+      if (in == NULL || in->transfers == 0)
+        continue;
+      // Cycles the block holds a waiting message back, less the cycles its
+      // own output is full
+      double busy = static_cast<double>(in->transfers + in->backpressure) -
+                    static_cast<double>(blocked_out);
+      Param& param = measured_[nodes_[b].name];
+      param.ii = std::max(1.0, busy / in->transfers);
+      param.latency = nodes_[b].latency;
+      param.known_latency = false;
+    }
+  }
+
+  // Writes the measured parameters as lines "block <name> <ii> [<latency>]".
+  void Save(std::ostream& out) const {
+    for (std::map<std::string, Param>::const_iterator it = measured_.begin();
+         it != measured_.end(); ++it) {
+      out << "block " << it->first << " " << it->second.ii;
+      if (it->second.known_latency)
+        out << " " << it->second.latency;
+      out << std::endl;
+    }
+  }
+
+  // Reads lines written by Save() as measured parameters; false on a bad line.
+  bool Load(std::istream& in) {
+    std::string line;
+    while (std::getline(in, line)) {
+      std::istringstream ss(line);
+      std::string kind, name;
+      Param param;
+      if (!(ss >> kind))
+        continue;
+      if (kind != "block" || !(ss >> name >> param.ii))
+        return false;
+      param.known_latency = static_cast<bool>(ss >> param.latency);
+      measured_[name] = param;
+    }
+    return true;
+  }
+
+  // Applies the parameters and returns the throughput in messages per cycle.
+  double Estimate() {
+    for (unsigned int n = 0; n < nodes_.size(); n++) {
+      Node& node = nodes_[n];
+      if (node.channel) {
+        node.capacity = node.probe ? node.probe->capacity() : 0;
+        node.latency = 1;
+        for (unsigned int r = 0; r < channel_rules_.size(); r++) {
+          if (Matches(channel_rules_[r].pattern, node.name)) {
+            node.capacity = static_cast<unsigned int>(channel_rules_[r].ii);
+            node.latency = channel_rules_[r].latency;
+          }
+        }
+        continue;
+      }
+      node.ii = node.latency = 1;
+      node.source = "default";
+      std::map<std::string, Param>::const_iterator m = measured_.find(node.name);
+      if (m != measured_.end()) {
+        node.ii = m->second.ii;
+        if (m->second.known_latency)
+          node.latency = m->second.latency;
+        node.source = "measured";
+      }
+      for (unsigned int r = 0; r < block_rules_.size(); r++) {
+        if (Matches(block_rules_[r].pattern, node.name)) {
+          node.ii = block_rules_[r].ii;
+          node.latency = block_rules_[r].latency;
+          node.source = "annotated";
+        }
+      }
+    }
+
+    throughput_ = 1;
+    limiter_ = limiting_loop_ = -1;
+    for (unsigned int n = 0; n < nodes_.size(); n++) {
+      if (!nodes_[n].channel && 1 / nodes_[n].ii < throughput_) {
+        throughput_ = 1 / nodes_[n].ii;
+        limiter_ = n;
+      }
+    }
+    for (unsigned int l = 0; l < loops_.size(); l++) {
+      Loop& loop = loops_[l];
+      double messages = 0, latency = 0;
+      for (unsigned int i = 0; i < loop.nodes.size(); i++) {
+        const Node& node = nodes_[loop.nodes[i]];
+        messages += node.channel ? node.capacity : 0;
+        latency += node.latency;
+      }
+      loop.bound = (latency > 0) ? std::max(messages, 1.0) / latency : 1;
+      if (loop.bound < throughput_) {
+        throughput_ = loop.bound;
+        limiter_ = -1;
+        limiting_loop_ = l;
+      }
+    }
+    return throughput_;
+  }
+
+  const std::vector<Node>& Nodes() const { return nodes_; }
+  const std::vector<Loop>& Loops() const { return loops_; }
+  double Throughput() const { return throughput_; }
+
+  // Index of the node that limits the last Estimate(), or -1
+  int Limiter() const { return limiter_; }
+  // Index of the loop that limits the last Estimate(), or -1
+  int LimitingLoop() const { return limiting_loop_; }
+
+  // Index of the node named name, or -1
+  int Find(const std::string& name) const {
+    std::map<std::string, unsigned int>::const_iterator it = ids_.find(name);
+    return (it == ids_.end()) ? -1 : static_cast<int>(it->second);
+  }
+
+  // Prints the nodes, the last Estimate() and the num_loops (0: all)
+  // tightest loops.
+  void Report(std::ostream& out, unsigned int num_loops = 0) const {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    unsigned int num_channels = 0;
+    for (unsigned int n = 0; n < nodes_.size(); n++)
+      num_channels += nodes_[n].channel;
+    out << "Throughput model: " << nodes_.size() - num_channels << " blocks, " << num_channels
+        << " channels, " << loops_.size() << " loops" << std::endl;
+    out << std::setw(32) << std::left << "  node" << std::right << std::setw(8) << "ii"
+        << std::setw(10) << "latency" << std::setw(10) << "capacity" << "  source" << std::endl;
+    out << std::fixed << std::setprecision(2);
+    for (unsigned int n = 0; n < nodes_.size(); n++) {
+      const Node& node = nodes_[n];
+      out << "  " << std::setw(30) << std::left << node.name << std::right << std::setw(8);
+      if (node.channel)
+        out << "-";
+      else
+        out << node.ii;
+      out << std::setw(10) << node.latency << std::setw(10);
+      if (node.channel)
+        out << node.capacity;
+      else
+        out << "-";
+      out << "  " << node.source << std::endl;
+    }
+    out << std::setprecision(3) << "Estimate: " << throughput_ << " messages/cycle";
+    if (limiter_ >= 0)
+      out << ", limited by block " << nodes_[limiter_].name << " (ii " << std::setprecision(2)
+          << nodes_[limiter_].ii << ")";
+    else if (limiting_loop_ >= 0)
+      out << ", limited by loop " << LoopName(loops_[limiting_loop_]);
+    out << std::endl;
+
+    std::vector<std::pair<double, unsigned int> > ranked;
+    for (unsigned int l = 0; l < loops_.size(); l++)
+      ranked.push_back(std::make_pair(loops_[l].bound, l));
+    std::sort(ranked.begin(), ranked.end());
+    if (num_loops == 0 || num_loops > ranked.size())
+      num_loops = ranked.size();
+    if (num_loops > 0)
+      out << "Loops (messages/cycle):" << std::endl;
+    for (unsigned int i = 0; i < num_loops; i++)
+      out << "  " << std::setprecision(3) << ranked[i].first << "  " << LoopName(loops_[ranked[i].second]) << std::endl;
+    out.flags(flags);
+    out.precision(precision);
+  }
+
+ private:
+  static const unsigned int kMaxLoops = 1000;
+
+  struct Rule {
+    std::string pattern;
+    double ii, latency;  // ii holds the capacity of channel rules
+  };
+
+  struct Param {
+    double ii, latency;
+    bool known_latency;
+  };
+
+  struct End {
+    const sc_object* owner;
+    Connections::ChannelProbe* probe;
+    unsigned int depth;
+  };
+
+  struct Link {
+    End writer, reader;
+  };
+
+  std::vector<Node> nodes_;
+  std::map<std::string, unsigned int> ids_;
+  std::vector<Loop> loops_;
+  std::vector<Rule> block_rules_, channel_rules_;
+  std::map<std::string, Param> measured_;
+  double throughput_;
+  int limiter_, limiting_loop_;
+
+  static bool Matches(const std::string& pattern, const std::string& name) {
+    if (!pattern.empty() && pattern[pattern.size() - 1] == '*')
+      return name.compare(0, pattern.size() - 1, pattern, 0, pattern.size() - 1) == 0;
+    return name == pattern;
+  }
+
+  static unsigned int Depth(const sc_object* obj) {
+    unsigned int depth = 0;
+    for (; obj != NULL; obj = obj->get_parent_object())
+      depth++;
+    return depth;
+  }
+
+  bool IsNode(const sc_object* obj) const { return ids_.find(obj->name()) != ids_.end(); }
+
+  bool Feeds(unsigned int from, unsigned int to) const {
+    const std::vector<unsigned int>& out = nodes_[from].out;
+    return std::find(out.begin(), out.end(), to) != out.end();
+  }
+
+  // Node of the owner of a port, or -1 if there is none
+  int NodeId(const End& end) {
+    if (end.owner == NULL)
+      return -1;
+    const sc_object* obj = end.owner;
+    Connections::ChannelProbe* probe = end.probe;
+    std::map<std::string, unsigned int>::iterator it = ids_.find(obj->name());
+    if (it != ids_.end())
+      return it->second;
+    Node node;
+    node.name = obj->name();
+    node.channel = (probe != NULL);
+    node.capacity = probe ? probe->capacity() : 0;
+    node.ii = node.latency = 1;
+    node.source = probe ? "channel" : "default";
+    node.probe = probe;
+    ids_[node.name] = nodes_.size();
+    nodes_.push_back(node);
+    return nodes_.size() - 1;
+  }
+
+  void Collect(const sc_object& obj,
+               const std::map<std::string, Connections::ChannelProbe*>& probes,
+               std::map<const sc_object*, Link>& links, std::vector<const sc_object*>& order) {
+    const std::vector<sc_object*>& children = obj.get_child_objects();
+    for (unsigned int i = 0; i < children.size(); i++) {
+      sc_object* child = children[i];
+      const char* kind = child->kind();
+      std::string base = child->basename();
+      bool is_out = strcmp(kind, "sc_out") == 0;
+      bool is_in = strcmp(kind, "sc_in") == 0;
+      sc_port_base* port = dynamic_cast<sc_port_base*>(child);
+      if (port != NULL && (is_in || is_out) && base.size() >= 3 &&
+          base.compare(base.size() - 3, 3, "val") == 0) {
+        const sc_object* signal = dynamic_cast<const sc_object*>(port->get_interface());
+        if (signal != NULL) {
+          // The Connections port object that holds val, if any, is not a block
+          const sc_object* owner = &obj;
+          if (base == "val" || base == std::string(owner->basename()) + "_val")
+            owner = owner->get_parent_object() ? owner->get_parent_object() : owner;
+          Connections::ChannelProbe* probe = NULL;
+          for (const sc_object* o = owner; o != NULL && probe == NULL; o = o->get_parent_object()) {
+            std::map<std::string, Connections::ChannelProbe*>::const_iterator p =
+                probes.find(o->name());
+            if (p != probes.end()) {
+              probe = p->second;
+              owner = o;
+            }
+          }
+          std::map<const sc_object*, Link>::iterator it = links.find(signal);
+          if (it == links.end()) {
+            Link link = {{NULL, NULL, 0}, {NULL, NULL, 0}};
+            it = links.insert(std::make_pair(signal, link)).first;
+            order.push_back(signal);
+          }
+          // Ports bound through the hierarchy: the innermost one is the block
+          End& end = is_out ? it->second.writer : it->second.reader;
+          unsigned int depth = Depth(owner);
+          if (end.owner == NULL || depth > end.depth) {
+            End inner = {owner, probe, depth};
+            end = inner;
+          }
+        }
+      }
+      Collect(*child, probes, links, order);
+    }
+  }
+
+  // Simple cycles, each found once from its lowest node
+  void FindLoops() {
+    loops_.clear();
+    std::vector<unsigned int> path;
+    std::vector<bool> on_path(nodes_.size(), false);
+    for (unsigned int s = 0; s < nodes_.size() && loops_.size() < kMaxLoops; s++)
+      LoopsFrom(s, s, path, on_path);
+  }
+
+  void LoopsFrom(unsigned int start, unsigned int n, std::vector<unsigned int>& path,
+                 std::vector<bool>& on_path) {
+    path.push_back(n);
+    on_path[n] = true;
+    for (unsigned int i = 0; i < nodes_[n].out.size() && loops_.size() < kMaxLoops; i++) {
+      unsigned int next = nodes_[n].out[i];
+      if (next == start) {
+        Loop loop;
+        loop.nodes = path;
+        loop.bound = 1;
+        loops_.push_back(loop);
+      } else if (next > start && !on_path[next]) {
+        LoopsFrom(start, next, path, on_path);
+      }
+    }
+    on_path[n] = false;
+    path.pop_back();
+  }
+
+  std::string LoopName(const Loop& loop) const {
+    std::string name;
+    for (unsigned int i = 0; i < loop.nodes.size(); i++)
+      name += (i ? " -> " : "") + nodes_[loop.nodes[i]].name;
+    return name;
+  }
+};
+#endif
+
+}  // namespace match
+
+#endif  // NVHLS_THROUGHPUT_MODEL_H
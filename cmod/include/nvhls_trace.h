@@ -29,6 +29,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <string>
 
 #endif
 
@@ -41,6 +42,26 @@ class Flusher {
   ~Flusher() {}
 };
 
+#ifndef __SYNTHESIS__
+/**
+ * \brief Interface of a trace sink that receives complete Tracer messages
+ * \ingroup Tracer
+ *
+ * When a sink is installed with Tracer::SetSink(), every Tracer buffers the
+ * text of the current message and hands it to the sink when the message ends
+ * (EndT), together with the name of the traced module and the trace level.
+ * Modules then skip the time and hierarchy prefix of the text, which the sink
+ * records on its own. See BinaryTraceSink in nvhls_trace_sink.h.
+ */
+class TraceSink {
+ public:
+  virtual ~TraceSink() {}
+  virtual void Write(const std::string& source, int level,
+                     const std::string& msg) = 0;
+  virtual void Flush() {}
+};
+#endif
+
 // Buffers messages locally then dumps its local
 // contents to the shared buffer.
 // Also supports trace levels.
@@ -86,6 +107,12 @@ class Flusher {
  *
  * \endcode
  *
+ * \par Output
+ * By default each message is written to the output stream and ends with
+ * std::endl. Tracer::SetLineFlush(false) ends messages with '\n' instead, so
+ * the stream is not flushed on every line. Tracer::SetSink() sends all
+ * messages to a TraceSink instead of the stream.
+ *
  */
 
 class Tracer {
@@ -95,6 +122,17 @@ class Tracer {
   int trace_level_;
   int cur_level_;
   bool fatal_;
+  std::string source_;
+  std::ostringstream buf_;
+
+  static TraceSink*& GlobalSink() {
+    static TraceSink* sink = NULL;
+    return sink;
+  }
+  static bool& GlobalLineFlush() {
+    static bool line_flush = true;
+    return line_flush;
+  }
 #endif
  public:
 #ifndef __SYNTHESIS__
@@ -119,7 +157,8 @@ class Tracer {
       : ostr_(other.ostr_),
         trace_level_(other.trace_level_),
         cur_level_(other.cur_level_),
-        fatal_(other.fatal_)
+        fatal_(other.fatal_),
+        source_(other.source_)
 #endif
   {
   }
@@ -129,14 +168,27 @@ class Tracer {
     trace_level_ = other.trace_level_;
     cur_level_ = other.cur_level_;
     fatal_ = other.fatal_;
+    source_ = other.source_;
 #endif
     return *this;
   }
 #ifndef __SYNTHESIS__
+  // Sink for the messages of all Tracers; NULL selects the output streams.
+  static void SetSink(TraceSink* sink) { GlobalSink() = sink; }
+  static TraceSink* GetSink() { return GlobalSink(); }
+  // Whether messages written to the output streams flush them.
+  static void SetLineFlush(bool line_flush) { GlobalLineFlush() = line_flush; }
+
+  // Name of the traced module, passed to the sink.
+  void SetSource(const std::string& source) { source_ = source; }
+
   template <typename T_MSG>
-  Tracer& operator<<(T_MSG t) {
+  Tracer& operator<<(const T_MSG& t) {
     if (cur_level_ <= trace_level_) {
-      (*ostr_) << t;
+      if (GlobalSink())
+        buf_ << t;
+      else
+        (*ostr_) << t;
     }
     return *this;
   }
@@ -144,7 +196,10 @@ class Tracer {
   Tracer& operator<<(std::ostream& (*f)(std::ostream&)) {
     if (cur_level_ <= trace_level_) {
       // Handle all the std::ostream stuff
-      (*ostr_) << f;
+      if (GlobalSink())
+        buf_ << f;
+      else
+        (*ostr_) << f;
     }
     return *this;
   }
@@ -161,10 +216,21 @@ class Tracer {
 
   Tracer& FlushBuffer() {
     if (cur_level_ <= trace_level_) {
-      (*ostr_) << std::endl;
+      if (GlobalSink()) {
+        GlobalSink()->Write(source_, cur_level_, buf_.str());
+        buf_.str("");
+      } else if (GlobalLineFlush()) {
+        (*ostr_) << std::endl;
+      } else {
+        (*ostr_) << '\n';
+      }
     }
-    if (fatal_)
+    if (fatal_) {
+      if (GlobalSink())
+        GlobalSink()->Flush();
+      ostr_->flush();
       exit(1);
+    }
     return *this;
   }
 #else
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_TRACE_SINK_H
+#define NVHLS_TRACE_SINK_H
+
+#include <systemc.h>
+#include <nvhls_trace.h>
+#ifndef __SYNTHESIS__
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <vector>
+#endif
+
+namespace match {
+
+#ifndef __SYNTHESIS__
+/**
+ * \brief Trace sink that writes buffered binary records to a file
+ * \ingroup Tracer
+ *
+ * \par Overview
+ * - Records are collected in a memory buffer of buffer_size bytes and written to the file when the buffer is full, on Flush(), and when the sink is destroyed. Nothing is formatted or flushed per message.
+ * - The file starts with the 4 bytes "MTRC" and a uint32 version. Then each record starts with a uint8 type:
+ *   - kModuleRecord: uint32 module id, uint32 length, name. Written the first time a module traces.
+ *   - kMessageRecord: uint64 time in ps, uint32 module id, uint8 level, uint32 length, message text.
+ * - Integers are written in host byte order.
+ * - PrintBinaryTrace() converts a file back to text offline, one line per message.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_trace_sink.h>
+ *
+ *      ...
+ *      match::BinaryTraceSink sink("trace.bin");
+ *      match::Tracer::SetSink(&sink);
+ *      sc_start();
+ *      match::Tracer::SetSink(NULL);
+ *
+ *      // Offline:
+ *      std::ifstream in("trace.bin", std::ios::binary);
+ *      match::PrintBinaryTrace(in, std::cout);
+ *
+ * \endcode
+ * \par
+ *
+ */
+class BinaryTraceSink : public TraceSink {
+ public:
+  enum { kVersion = 1, kModuleRecord = 0, kMessageRecord = 1 };
+
+  explicit BinaryTraceSink(const std::string& filename,
+                           unsigned int buffer_size = 1 << 20)
+      : file_(filename.c_str(), std::ios::binary | std::ios::trunc),
+        buffer_size_(buffer_size) {
+    buffer_.reserve(buffer_size_);
+    Append("MTRC", 4);
+    AppendInt<unsigned int>(kVersion);
+  }
+
+  ~BinaryTraceSink() { Flush(); }
+
+  void Write(const std::string& source, int level, const std::string& msg) {
+    std::map<std::string, unsigned int>::iterator it = ids_.find(source);
+    unsigned int id;
+    if (it == ids_.end()) {
+      id = ids_.size();
+      ids_[source] = id;
+      AppendInt<unsigned char>(kModuleRecord);
+      AppendInt<unsigned int>(id);
+      AppendInt<unsigned int>(source.size());
+      Append(source.data(), source.size());
+    } else {
+      id = it->second;
+    }
+    AppendInt<unsigned char>(kMessageRecord);
+    AppendInt<uint64>(static_cast<uint64>(sc_time_stamp().to_seconds() * 1e12 + 0.5));
+    AppendInt<unsigned int>(id);
+    AppendInt<unsigned char>(level);
+    AppendInt<unsigned int>(msg.size());
+    Append(msg.data(), msg.size());
+    if (buffer_.size() >= buffer_size_)
+      WriteBuffer();
+  }
+
+  void Flush() {
+    WriteBuffer();
+    file_.flush();
+  }
+
+ private:
+  std::ofstream file_;
+  unsigned int buffer_size_;
+  std::vector<char> buffer_;
+  std::map<std::string, unsigned int> ids_;
+
+  void Append(const char* data, size_t size) {
+    buffer_.insert(buffer_.end(), data, data + size);
+  }
+
+  template <typename T>
+  void AppendInt(T value) {
+    char bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+    Append(bytes, sizeof(T));
+  }
+
+  void WriteBuffer() {
+    if (!buffer_.empty())
+      file_.write(&buffer_[0], buffer_.size());
+    buffer_.clear();
+  }
+};
+
+// Reads the integers and strings of a BinaryTraceSink file.
+class BinaryTraceReader {
+ public:
+  explicit BinaryTraceReader(std::istream& in) : in_(in) {}
+
+  template <typename T>
+  bool Int(T& value) {
+    char bytes[sizeof(T)];
+    if (!in_.read(bytes, sizeof(T)))
+      return false;
+    memcpy(&value, bytes, sizeof(T));
+    return true;
+  }
+
+  bool String(std::string& str) {
+    unsigned int size;
+    if (!Int(size))
+      return false;
+    str.resize(size);
+    return (size == 0) || static_cast<bool>(in_.read(&str[0], size));
+  }
+
+ private:
+  std::istream& in_;
+};
+
+/**
+ * \brief Offline pretty-printer of BinaryTraceSink files
+ * \ingroup Tracer
+ *
+ * Writes one line "<time> ps: <module>: <message>" per message with a level
+ * of at most max_level. Returns false if the input is not a trace file or is
+ * truncated.
+ */
+inline bool PrintBinaryTrace(std::istream& in, std::ostream& out,
+                             int max_level = 0x7fffffff) {
+  BinaryTraceReader reader(in);
+
+  char magic[4];
+  unsigned int version;
+  if (!in.read(magic, 4) || memcmp(magic, "MTRC", 4) != 0 ||
+      !reader.Int(version) || version != BinaryTraceSink::kVersion)
+    return false;
+
+  std::map<unsigned int, std::string> names;
+  unsigned char type;
+  while (reader.Int(type)) {
+    unsigned int id;
+    if (type == BinaryTraceSink::kModuleRecord) {
+      if (!reader.Int(id) || !reader.String(names[id]))
+        return false;
+    } else if (type == BinaryTraceSink::kMessageRecord) {
+      uint64 time_ps;
+      unsigned char level;
+      std::string msg;
+      if (!reader.Int(time_ps) || !reader.Int(id) || !reader.Int(level) ||
+          !reader.String(msg))
+        return false;
+      if (level <= max_level)
+        out << time_ps << " ps: " << names[id] << ": " << msg << '\n';
+    } else {
+      return false;
+    }
+  }
+  return in.eof();
+}
+#endif
+
+}  // namespace match
+
+#endif  // NVHLS_TRACE_SINK_H
@@ -24,6 +24,9 @@
 #include <ccs_p2p.h>
 #include <nvhls_assert.h>
 #include <nvhls_message.h>
+#include <nvhls_vector_host.h>
+#include <nvhls_shift.h>
+#include <crossbar.h>
 
 namespace nvhls {
 
@@ -210,6 +213,11 @@ template <typename InType1, typename InType2, typename OutType,
 void vector_mul(nv_scvector<InType1, VectorLength> in1,
                 nv_scvector<InType2, VectorLength> in2,
                 nv_scvector<OutType, VectorLength>& out) {
+#ifndef __SYNTHESIS__
+  if (host_vector_elementwise<InType1, InType2, InType1, OutType, VectorLength>(
+          HostMul, in1.data, in2.data, static_cast<const InType1*>(0), out.data))
+    return;
+#endif
 
   if (Unroll == true) {
 #pragma hls_unroll yes
@@ -258,6 +266,11 @@ template <typename InType1, typename InType2, typename OutType,
 void vector_add(nv_scvector<InType1, VectorLength> in1,
                 nv_scvector<InType2, VectorLength> in2,
                 nv_scvector<OutType, VectorLength>& out) {
+#ifndef __SYNTHESIS__
+  if (host_vector_elementwise<InType1, InType2, InType1, OutType, VectorLength>(
+          HostAdd, in1.data, in2.data, static_cast<const InType1*>(0), out.data))
+    return;
+#endif
   if (Unroll == true) {
 #pragma hls_unroll yes
     for (unsigned i = 0; i < VectorLength; i++)
@@ -304,6 +317,11 @@ template <typename InType1, typename InType2, typename OutType,
 void vector_sub(nv_scvector<InType1, VectorLength> in1,
                 nv_scvector<InType2, VectorLength> in2,
                 nv_scvector<OutType, VectorLength>& out) {
+#ifndef __SYNTHESIS__
+  if (host_vector_elementwise<InType1, InType2, InType1, OutType, VectorLength>(
+          HostSub, in1.data, in2.data, static_cast<const InType1*>(0), out.data))
+    return;
+#endif
   if (Unroll == true) {
 #pragma hls_unroll yes
     for (unsigned i = 0; i < VectorLength; i++)
@@ -348,6 +366,11 @@ void vector_sub(nv_scvector<InType1, VectorLength> in1,
 template <typename InType, typename OutType, unsigned int VectorLength,
           bool UseReduceTree>
 void reduction(nv_scvector<InType, VectorLength> in, OutType& out) {
+#ifndef __SYNTHESIS__
+  if (host_vector_dot<InType, InType, InType, OutType, VectorLength>(
+          in.data, static_cast<const InType*>(0), static_cast<const InType*>(0), out))
+    return;
+#endif
   OutType sum = 0;
 
   if (VectorLength > 1) {
@@ -405,6 +428,11 @@ template <typename InType1, typename InType2, typename OutType,
           unsigned int VectorLength, bool UseReduceTree>
 void dp(nv_scvector<InType1, VectorLength> in1,
         nv_scvector<InType2, VectorLength> in2, OutType& out) {
+#ifndef __SYNTHESIS__
+  if (host_vector_dot<InType1, InType2, InType1, OutType, VectorLength>(
+          in1.data, in2.data, static_cast<const InType1*>(0), out))
+    return;
+#endif
   OutType sum = 0;
   if (VectorLength > 1) {
     if (UseReduceTree == true) {
@@ -463,6 +491,11 @@ void vector_mac(nv_scvector<InType1, VectorLength> in1,
                 nv_scvector<InType2, VectorLength> in2,
                 nv_scvector<InType3, VectorLength> in3,
                 nv_scvector<OutType, VectorLength>& out) {
+#ifndef __SYNTHESIS__
+  if (host_vector_elementwise<InType1, InType2, InType3, OutType, VectorLength>(
+          HostMac, in1.data, in2.data, in3.data, out.data))
+    return;
+#endif
 
   if (Unroll == true) {
 #pragma hls_unroll yes
@@ -487,6 +520,11 @@ template <typename InType1, typename InType2, typename InType3,
           typename OutType, unsigned int VectorLength, bool UseReduceTree>
 void dpacc(nv_scvector<InType1, VectorLength> in1,
            nv_scvector<InType2, VectorLength> in2, InType3 in3, OutType& out) {
+#ifndef __SYNTHESIS__
+  if (host_vector_dot<InType1, InType2, InType3, OutType, VectorLength>(
+          in1.data, in2.data, &in3, out))
+    return;
+#endif
   OutType sum = in3;
   if (UseReduceTree == true) {
 #pragma hls_unroll yes
@@ -500,6 +538,754 @@ void dpacc(nv_scvector<InType1, VectorLength> in1,
   }
   out = sum;
 }
+
+/**
+ * \brief Balanced binary adder tree policy for reduction and dp
+ * \ingroup nvhls_vector
+ *
+ * \par Overview
+ * - log2(N) levels of two-input adders: level l adds the nodes that are 2^l apart. Every stage is a carry-propagate adder on OutType.
+ * - reduce_levels(vals, first, last) evaluates levels [first, last) in place, so a tree can be split across pipeline stages (see PipelinedAdderTree). vals[0] holds the sum after the last level.
+ */
+struct AdderTreeBalanced {
+  template <typename T, unsigned int N>
+  static void reduce_levels(T (&vals)[N], unsigned int first, unsigned int last) {
+    const unsigned int Levels = nvhls::log2_ceil<N>::val;
+#pragma hls_unroll yes
+    for (unsigned int l = 0; l < Levels; l++) {
+      if ((l >= first) && (l < last)) {
+        const unsigned int dist = 1u << l;
+#pragma hls_unroll yes
+        for (unsigned int i = 0; i < N; i++) {
+          if (((i % (2 * dist)) == 0) && (i + dist < N)) {
+            vals[i] = vals[i] + vals[i + dist];
+          }
+        }
+      }
+    }
+  }
+
+  template <typename T, unsigned int N>
+  static T reduce(T (&vals)[N]) {
+    reduce_levels(vals, 0, nvhls::log2_ceil<N>::val);
+    return vals[0];
+  }
+};
+
+/**
+ * \brief Wallace (3:2 compressor) adder tree policy for reduction and dp
+ * \ingroup nvhls_vector
+ *
+ * \par Overview
+ * - Every level replaces each group of three operands by a sum word (a^b^c) and a carry word (majority(a,b,c) << 1) without carry propagation, until two operands remain. A single carry-propagate adder adds them.
+ * - The bitwise identity a+b+c = (a^b^c) + (maj(a,b,c) << 1) holds modulo 2^W, so the result is bit-exact with the other trees for nvint/nvuint OutType. User-defined OutType must provide ^, &, | and <<.
+ */
+struct AdderTreeCompressor {
+  template <typename T, unsigned int N>
+  static T reduce(T (&vals)[N]) {
+    unsigned int count = N;
+    // each level reduces count to 2 * (count / 3) + count % 3
+#pragma hls_unroll yes
+    for (unsigned int level = 0; level < N; level++) {
+      if (count > 2) {
+        T next[N];
+        unsigned int next_count = 0;
+#pragma hls_unroll yes
+        for (unsigned int g = 0; g < N / 3; g++) {
+          if (3 * g + 2 < count) {
+            T a = vals[3 * g], b = vals[3 * g + 1], c = vals[3 * g + 2];
+            next[next_count++] = a ^ b ^ c;
+            next[next_count++] = ((a & b) | (a & c) | (b & c)) << 1;
+          }
+        }
+#pragma hls_unroll yes
+        for (unsigned int i = 0; i < 2; i++) {
+          if (3 * (count / 3) + i < count) {
+            next[next_count++] = vals[3 * (count / 3) + i];
+          }
+        }
+#pragma hls_unroll yes
+        for (unsigned int i = 0; i < N; i++) {
+          if (i < next_count) {
+            vals[i] = next[i];
+          }
+        }
+        count = next_count;
+      }
+    }
+    T sum = vals[0];
+    if (count > 1) {
+      sum = sum + vals[1];
+    }
+    return sum;
+  }
+};
+
+/**
+ * \brief Function implementing vector reduction with a selected adder tree
+ * \ingroup nvhls_vector
+ *
+ * \tparam InType           Input Scalar Type
+ * \tparam OutType          Output Scalar Type
+ * \tparam VectorLength     Length of vector
+ * \tparam TreePolicy       AdderTreeBalanced or AdderTreeCompressor
+ *
+ * \par Overview
+ * Same result as reduction with UseReduceTree, with the shape of the tree
+ * given by the policy instead of being left to the HLS tool. Every element is
+ * converted to OutType before the tree. Use PipelinedReduction to register
+ * the tree every K levels.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_vector.h>
+ *
+ *      ...
+ *      nv_scvector<NVUINT8, 64> v1;
+ *      NVUINT14 out;
+ *      ...
+ *      nvhls::reduction<NVUINT8, NVUINT14, 64, nvhls::AdderTreeCompressor>(v1, out);
+ *      ...
+ * \endcode
+ * \par
+ *
+ */
+template <typename InType, typename OutType, unsigned int VectorLength,
+          typename TreePolicy>
+void reduction(nv_scvector<InType, VectorLength> in, OutType& out) {
+  OutType vals[VectorLength];
+#pragma hls_unroll yes
+  for (unsigned i = 0; i < VectorLength; i++)
+    vals[i] = in[i];
+  out = TreePolicy::reduce(vals);
+}
+
+/**
+ * \brief Function implementing vector dot-product with a selected adder tree
+ * \ingroup nvhls_vector
+ *
+ * \tparam InType1          Input1 Scalar Type
+ * \tparam InType2          Input2 Scalar Type
+ * \tparam OutType          Output Scalar Type
+ * \tparam VectorLength     Length of vector
+ * \tparam TreePolicy       AdderTreeBalanced or AdderTreeCompressor
+ *
+ * \par Overview
+ * Same result as dp with UseReduceTree, with the products summed by the
+ * adder tree of the policy. Use PipelinedDP to register the tree every K
+ * levels.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_vector.h>
+ *
+ *      ...
+ *      nv_scvector<NVINT8, 64> v1, v2;
+ *      NVINT22 out;
+ *      ...
+ *      nvhls::dp<NVINT8, NVINT8, NVINT22, 64, nvhls::AdderTreeBalanced>(v1, v2, out);
+ *      ...
+ * \endcode
+ * \par
+ *
+ */
+template <typename InType1, typename InType2, typename OutType,
+          unsigned int VectorLength, typename TreePolicy>
+void dp(nv_scvector<InType1, VectorLength> in1,
+        nv_scvector<InType2, VectorLength> in2, OutType& out) {
+  OutType vals[VectorLength];
+#pragma hls_unroll yes
+  for (unsigned i = 0; i < VectorLength; i++)
+    vals[i] = in1[i] * in2[i];
+  out = TreePolicy::reduce(vals);
+}
+
+/**
+ * \brief Balanced adder tree with pipeline registers every K levels
+ * \ingroup nvhls_vector
+ *
+ * \tparam OutType          Scalar type of the tree nodes
+ * \tparam N                Number of leaves
+ * \tparam LevelsPerStage   Number of adder levels between pipeline registers (K)
+ *
+ * \par Overview
+ * - Each call of run() is one cycle. The sum of the leaves appears Latency calls later, with Latency = ceil(log2(N) / K) - 1, so that a tree that does not close timing in one cycle can still run at II=1.
+ * - The registers hold the partially reduced leaves of AdderTreeBalanced between stages.
+ */
+template <typename OutType, unsigned int N, unsigned int LevelsPerStage>
+class PipelinedAdderTree {
+ public:
+  static const unsigned int Levels = nvhls::log2_ceil<N>::val;
+  static const unsigned int NumGroups =
+      (Levels > 0) ? (Levels + LevelsPerStage - 1) / LevelsPerStage : 1;
+  static const unsigned int Latency = NumGroups - 1;
+
+ private:
+  static const unsigned int NumRegs = (Latency > 0) ? Latency : 1;
+  OutType regs[NumRegs][N];
+  bool regs_valid[NumRegs];
+
+ public:
+  PipelinedAdderTree() { reset(); }
+
+  void reset() {
+#pragma hls_unroll yes
+    for (unsigned int i = 0; i < NumRegs; i++) {
+      regs_valid[i] = false;
+    }
+  }
+
+  // Returns true if out holds a valid sum in this cycle
+  bool run(bool in_valid, const OutType (&leaves)[N], OutType& out) {
+    bool out_valid = false;
+#pragma hls_unroll yes
+    for (int g = NumGroups - 1; g >= 0; g--) {
+      OutType vals[N];
+      bool valid;
+#pragma hls_unroll yes
+      for (unsigned int i = 0; i < N; i++) {
+        vals[i] = (g == 0) ? leaves[i] : regs[(g > 0) ? g - 1 : 0][i];
+      }
+      valid = (g == 0) ? in_valid : regs_valid[(g > 0) ? g - 1 : 0];
+      AdderTreeBalanced::reduce_levels(vals, g * LevelsPerStage, (g + 1) * LevelsPerStage);
+      if (g == static_cast<int>(NumGroups) - 1) {
+        out = vals[0];
+        out_valid = valid;
+      } else {
+#pragma hls_unroll yes
+        for (unsigned int i = 0; i < N; i++) {
+          regs[g][i] = vals[i];
+        }
+        regs_valid[g] = valid;
+      }
+    }
+    return out_valid;
+  }
+};
+
+/**
+ * \brief Vector reduction on a balanced adder tree registered every K levels
+ * \ingroup nvhls_vector
+ *
+ * \tparam InType           Input Scalar Type
+ * \tparam OutType          Output Scalar Type
+ * \tparam VectorLength     Length of vector
+ * \tparam LevelsPerStage   Number of adder levels between pipeline registers (K)
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_vector.h>
+ *
+ *      ...
+ *      nvhls::PipelinedReduction<NVUINT8, NVUINT16, 256, 2> reduce;  // Latency 3
+ *      ...
+ *      bool out_valid = reduce.run(in_valid, v1, out);
+ *      ...
+ * \endcode
+ * \par
+ *
+ */
+template <typename InType, typename OutType, unsigned int VectorLength,
+          unsigned int LevelsPerStage>
+class PipelinedReduction {
+ public:
+  typedef PipelinedAdderTree<OutType, VectorLength, LevelsPerStage> tree_t;
+  static const unsigned int Latency = tree_t::Latency;
+
+ private:
+  tree_t tree;
+
+ public:
+  void reset() { tree.reset(); }
+
+  bool run(bool in_valid, const nv_scvector<InType, VectorLength>& in, OutType& out) {
+    OutType leaves[VectorLength];
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < VectorLength; i++)
+      leaves[i] = in[i];
+    return tree.run(in_valid, leaves, out);
+  }
+};
+
+/**
+ * \brief Vector dot-product on a balanced adder tree registered every K levels
+ * \ingroup nvhls_vector
+ *
+ * \tparam InType1          Input1 Scalar Type
+ * \tparam InType2          Input2 Scalar Type
+ * \tparam OutType          Output Scalar Type
+ * \tparam VectorLength     Length of vector
+ * \tparam LevelsPerStage   Number of adder levels between pipeline registers (K)
+ *
+ * \par Overview
+ * The multipliers share the first stage with the first K adder levels.
+ */
+template <typename InType1, typename InType2, typename OutType,
+          unsigned int VectorLength, unsigned int LevelsPerStage>
+class PipelinedDP {
+ public:
+  typedef PipelinedAdderTree<OutType, VectorLength, LevelsPerStage> tree_t;
+  static const unsigned int Latency = tree_t::Latency;
+
+ private:
+  tree_t tree;
+
+ public:
+  void reset() { tree.reset(); }
+
+  bool run(bool in_valid, const nv_scvector<InType1, VectorLength>& in1,
+           const nv_scvector<InType2, VectorLength>& in2, OutType& out) {
+    OutType leaves[VectorLength];
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < VectorLength; i++)
+      leaves[i] = in1[i] * in2[i];
+    return tree.run(in_valid, leaves, out);
+  }
+};
+
+/**
+ * \brief Lane permutation pattern: out[i] = in[(i + Shift) % Length]
+ * \ingroup nvhls_vector
+ *
+ * \par Overview
+ * A pattern maps every output lane to its input lane with a constant
+ * expression of the lane index. vector_permute() evaluates it in an
+ * unrolled loop, so every output lane is wired to one input lane and the
+ * permutation has no muxes. A rotate by Shift moves lane Shift to lane 0.
+ */
+template <unsigned int Shift>
+struct PermuteRotate {
+  template <unsigned int Length>
+  static unsigned int src(unsigned int dst) {
+    return (dst + Shift) % Length;
+  }
+};
+
+/**
+ * \brief Lane permutation pattern: out[i] = in[Length - 1 - i]
+ * \ingroup nvhls_vector
+ */
+struct PermuteReverse {
+  template <unsigned int Length>
+  static unsigned int src(unsigned int dst) {
+    return Length - 1 - dst;
+  }
+};
+
+/**
+ * \brief Lane permutation pattern: every output lane is input lane Lane
+ * \ingroup nvhls_vector
+ */
+template <unsigned int Lane>
+struct PermuteBroadcast {
+  template <unsigned int Length>
+  static unsigned int src(unsigned int dst) {
+    static_assert(Lane < Length, "PermuteBroadcast lane out of range");
+    return Lane;
+  }
+};
+
+/**
+ * \brief Lane permutation pattern: transposes every tile of Rows x Cols lanes
+ * \ingroup nvhls_vector
+ *
+ * \par Overview
+ * The vector is a sequence of row-major tiles of Rows x Cols lanes. Each
+ * tile becomes its row-major Cols x Rows transpose: out[c * Rows + r] =
+ * in[r * Cols + c] within the tile. Length must be a multiple of Rows *
+ * Cols.
+ */
+template <unsigned int Rows, unsigned int Cols>
+struct PermuteTranspose {
+  template <unsigned int Length>
+  static unsigned int src(unsigned int dst) {
+    static_assert(Rows > 0 && Cols > 0 && Length % (Rows * Cols) == 0,
+                  "PermuteTranspose needs a whole number of tiles");
+    const unsigned int tile = dst - dst % (Rows * Cols);
+    const unsigned int i = dst % (Rows * Cols);
+    return tile + (i % Rows) * Cols + i / Rows;
+  }
+};
+
+/**
+ * \brief Lane permutation pattern: interleaves Ways equal blocks of lanes
+ * \ingroup nvhls_vector
+ *
+ * \par Overview
+ * Output lanes w, w + Ways, w + 2 * Ways, ... come from block w: out[j *
+ * Ways + w] = in[w * (Length / Ways) + j]. This is PermuteTranspose<Ways,
+ * Length / Ways>; PermuteDeinterleave<Ways> is its inverse.
+ */
+template <unsigned int Ways>
+struct PermuteInterleave {
+  template <unsigned int Length>
+  static unsigned int src(unsigned int dst) {
+    static_assert(Ways > 0 && Length % Ways == 0, "PermuteInterleave needs equal blocks");
+    return (dst % Ways) * (Length / Ways) + dst / Ways;
+  }
+};
+
+/**
+ * \brief Lane permutation pattern: splits every Ways-th lane into its own block
+ * \ingroup nvhls_vector
+ */
+template <unsigned int Ways>
+struct PermuteDeinterleave {
+  template <unsigned int Length>
+  static unsigned int src(unsigned int dst) {
+    static_assert(Ways > 0 && Length % Ways == 0, "PermuteDeinterleave needs equal blocks");
+    return (dst % (Length / Ways)) * Ways + dst / (Length / Ways);
+  }
+};
+
+/**
+ * \brief Function implementing a fixed lane permutation
+ * \ingroup nvhls_vector
+ *
+ * \tparam Pattern          Permutation pattern, e.g. PermuteRotate, PermuteTranspose
+ * \tparam Type             Scalar Type
+ * \tparam VectorLength     Length of vector
+ *
+ * \par Overview
+ * out[i] = in[Pattern::src<VectorLength>(i)]. The pattern is a compile-time
+ * function of the lane index, so the permutation synthesizes to wiring.
+ * Permutations that depend on run-time values need vector_gather(). In C++
+ * simulation nvint/nvuint lanes of up to 64 bits are moved with the host
+ * gather kernel.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_vector.h>
+ *
+ *      ...
+ *      nv_scvector<NVUINT8, 16> v, rotated, transposed;
+ *      ...
+ *      nvhls::vector_permute<nvhls::PermuteRotate<3> >(v, rotated);
+ *      nvhls::vector_permute<nvhls::PermuteTranspose<4, 4> >(v, transposed);
+ *      ...
+ * \endcode
+ * \par
+ *
+ */
+template <typename Pattern, typename Type, unsigned int VectorLength>
+void vector_permute(nv_scvector<Type, VectorLength> in,
+                    nv_scvector<Type, VectorLength>& out) {
+#ifndef __SYNTHESIS__
+  unsigned int idx[VectorLength];
+  for (unsigned int i = 0; i < VectorLength; i++)
+    idx[i] = Pattern::template src<VectorLength>(i);
+  if (host_vector_gather<Type, VectorLength, VectorLength>(in.data, idx, out.data))
+    return;
+#endif
+
+#pragma hls_unroll yes
+  for (unsigned int i = 0; i < VectorLength; i++)
+    out[i] = in[Pattern::template src<VectorLength>(i)];
+}
+
+/**
+ * \brief Function interleaving the lanes of two vectors
+ * \ingroup nvhls_vector
+ *
+ * \par Overview
+ * out[2 * i] = in1[i] and out[2 * i + 1] = in2[i]; wiring only.
+ */
+template <typename Type, unsigned int VectorLength>
+void vector_interleave(nv_scvector<Type, VectorLength> in1,
+                       nv_scvector<Type, VectorLength> in2,
+                       nv_scvector<Type, 2 * VectorLength>& out) {
+  nv_scvector<Type, 2 * VectorLength> cat;
+#pragma hls_unroll yes
+  for (unsigned int i = 0; i < VectorLength; i++) {
+    cat[i] = in1[i];
+    cat[VectorLength + i] = in2[i];
+  }
+  vector_permute<PermuteInterleave<2> >(cat, out);
+}
+
+/**
+ * \brief Function gathering vector lanes by a run-time index vector
+ * \ingroup nvhls_vector
+ *
+ * \tparam Type             Scalar Type
+ * \tparam InLength         Length of input vector
+ * \tparam OutLength        Length of output vector
+ *
+ * \par Overview
+ * out[i] = in[index[i]], with every index below InLength. The gather is a
+ * crossbar() of InLength inputs and OutLength outputs; for a permutation
+ * known at compile time use vector_permute(), which needs no muxes. In C++
+ * simulation nvint/nvuint lanes of up to 64 bits are moved with the host
+ * gather kernel, unless the match::Energy estimate is counting crossbar
+ * lanes.
+ */
+template <typename Type, unsigned int InLength, unsigned int OutLength>
+void vector_gather(nv_scvector<Type, InLength> in,
+                   nv_scvector<NVUINTW(nvhls::index_width<InLength>::val), OutLength> index,
+                   nv_scvector<Type, OutLength>& out) {
+#ifndef __SYNTHESIS__
+  if (!match::Energy::Get().Enabled()) {
+    unsigned int idx[OutLength];
+    for (unsigned int i = 0; i < OutLength; i++)
+      idx[i] = index[i].to_uint();
+    if (host_vector_gather<Type, InLength, OutLength>(in.data, idx, out.data))
+      return;
+  }
+#endif
+  crossbar<Type, InLength, OutLength>(in.data, index.data, out.data);
+}
+
+// Bits below the guard bit of a right shift by Shift
+template <unsigned int Shift>
+struct requant_sticky {
+  template <typename T>
+  static bool get(const T& acc) {
+    return nvhls::get_slc<Shift - 1>(acc, 0) != 0;
+  }
+};
+
+template <>
+struct requant_sticky<1> {
+  template <typename T>
+  static bool get(const T& acc) {
+    return false;
+  }
+};
+
+template <>
+struct requant_sticky<0> {
+  template <typename T>
+  static bool get(const T& acc) {
+    return false;
+  }
+};
+
+/**
+ * \brief Requantization policy of the saturating and rounding vector operations
+ * \ingroup nvhls_vector
+ *
+ * \tparam Shift            Right shift of the exact result, e.g. the fraction bits dropped after a MAC
+ * \tparam Round            RoundTruncate or RoundNearestEven (see shift_round_mode)
+ * \tparam Saturate         Clamp results that do not fit OutType instead of wrapping
+ *
+ * \par Overview
+ * - apply() takes the exact result of an operation as a signed AccW-bit value. It shifts it right arithmetically by Shift and rounds the dropped bits, so RoundTruncate rounds towards minus infinity. With Saturate the result is then clamped to the range of OutType, else its low bits are kept.
+ * - Requant<0, RoundTruncate, false> is the truncating arithmetic of vector_add, vector_mul and vector_mac.
+ */
+template <unsigned int Shift, shift_round_mode Round = RoundNearestEven, bool Saturate = true>
+struct Requant {
+  static_assert(Round != RoundStochastic, "Requant supports RoundTruncate and RoundNearestEven");
+  static const unsigned int shift = Shift;
+  static const bool nearest = (Round == RoundNearestEven);
+  static const bool saturate = Saturate;
+
+  template <typename OutType, unsigned int AccW>
+  static OutType apply(typename nvhls_t<AccW>::nvint_t acc) {
+    static_assert(Shift < AccW, "Requant shift is wider than the result");
+    typedef typename nvhls_t<AccW>::nvint_t acc_t;
+    const unsigned int OutW = Wrapped<OutType>::width;
+    acc_t q = acc >> Shift;
+    if (nearest && (Shift > 0)) {
+      bool guard = (acc[(Shift > 0) ? Shift - 1 : 0] == 1);
+      bool sticky = requant_sticky<Shift>::get(acc);
+      if (guard && (sticky || (q[0] == 1)))
+        q = q + 1;
+    }
+    if (Saturate) {
+      OutType max_val = -1, min_val = 0;
+      if (Wrapped<OutType>::is_signed) {
+        max_val[OutW - 1] = 0;
+        min_val[OutW - 1] = 1;
+      }
+      acc_t hi = max_val, lo = min_val;
+      if (q > hi)
+        q = hi;
+      if (q < lo)
+        q = lo;
+    }
+    OutType out = q;
+    return out;
+  }
+
+#ifndef __SYNTHESIS__
+  // Parameters of the host kernels, which only run if the results fit 63
+  // bits, so OutType has at most 62
+  template <typename OutType>
+  static host_requant host() {
+    const unsigned int OutW = (Wrapped<OutType>::width > 62) ? 62 : Wrapped<OutType>::width;
+    host_requant q;
+    q.shift = Shift;
+    q.nearest = nearest;
+    q.saturate = Saturate;
+    q.lo = Wrapped<OutType>::is_signed ? -(static_cast<int64>(1) << (OutW - 1)) : 0;
+    q.hi = Wrapped<OutType>::is_signed ? (static_cast<int64>(1) << (OutW - 1)) - 1
+                                       : (static_cast<int64>(1) << OutW) - 1;
+    return q;
+  }
+#endif
+};
+
+// Signed widths that hold the exact results of the vector operations and
+// the range of OutType
+template <unsigned int A, unsigned int B>
+struct requant_max {
+  static const unsigned int val = (A > B) ? A : B;
+};
+
+template <typename InType1, typename InType2, typename InType3, typename OutType>
+struct requant_width {
+  static const unsigned int W1 = Wrapped<InType1>::width, W2 = Wrapped<InType2>::width;
+  static const unsigned int W3 = Wrapped<InType3>::width, OutW = Wrapped<OutType>::width;
+  static const unsigned int add = requant_max<requant_max<W1, W2>::val + 2, OutW + 1>::val;
+  static const unsigned int mul = requant_max<W1 + W2 + 1, OutW + 1>::val;
+  static const unsigned int mac =
+      requant_max<requant_max<W1 + W2 + 1, W3 + 1>::val + 1, OutW + 1>::val;
+};
+
+/**
+ * \brief Function implementing saturating and rounding vector addition
+ * \ingroup nvhls_vector
+ *
+ * \tparam Quant            Requantization policy, e.g. Requant<0> to saturate only
+ * \tparam InType1          Input1 Scalar Type
+ * \tparam InType2          Input2 Scalar Type
+ * \tparam OutType          Output Scalar Type
+ * \tparam VectorLength     Length of vector
+ *
+ * \par Overview
+ * out[i] = Quant(in1[i] + in2[i]), on the exact sum (see Requant). The loop
+ * is always unrolled. In C++ simulation nvint/nvuint lanes whose exact
+ * results fit 63 bits use the host kernels.
+ */
+template <typename Quant, typename InType1, typename InType2, typename OutType,
+          unsigned int VectorLength>
+void vector_add_quant(nv_scvector<InType1, VectorLength> in1,
+                      nv_scvector<InType2, VectorLength> in2,
+                      nv_scvector<OutType, VectorLength>& out) {
+  const unsigned int AccW = requant_width<InType1, InType2, InType1, OutType>::add;
+  typedef typename nvhls_t<AccW>::nvint_t acc_t;
+#ifndef __SYNTHESIS__
+  if (host_vector_requant<InType1, InType2, InType1, OutType, VectorLength, AccW>(
+          HostAdd, Quant::template host<OutType>(), in1.data, in2.data,
+          static_cast<const InType1*>(0), out.data))
+    return;
+#endif
+
+#pragma hls_unroll yes
+  for (unsigned i = 0; i < VectorLength; i++) {
+    acc_t a = in1[i], b = in2[i];
+    out[i] = Quant::template apply<OutType, AccW>(a + b);
+  }
+}
+
+/**
+ * \brief Function implementing saturating and rounding vector subtraction
+ * \ingroup nvhls_vector
+ *
+ * \par Overview
+ * out[i] = Quant(in1[i] - in2[i]); see vector_add_quant.
+ */
+template <typename Quant, typename InType1, typename InType2, typename OutType,
+          unsigned int VectorLength>
+void vector_sub_quant(nv_scvector<InType1, VectorLength> in1,
+                      nv_scvector<InType2, VectorLength> in2,
+                      nv_scvector<OutType, VectorLength>& out) {
+  const unsigned int AccW = requant_width<InType1, InType2, InType1, OutType>::add;
+  typedef typename nvhls_t<AccW>::nvint_t acc_t;
+#ifndef __SYNTHESIS__
+  if (host_vector_requant<InType1, InType2, InType1, OutType, VectorLength, AccW>(
+          HostSub, Quant::template host<OutType>(), in1.data, in2.data,
+          static_cast<const InType1*>(0), out.data))
+    return;
+#endif
+
+#pragma hls_unroll yes
+  for (unsigned i = 0; i < VectorLength; i++) {
+    acc_t a = in1[i], b = in2[i];
+    out[i] = Quant::template apply<OutType, AccW>(a - b);
+  }
+}
+
+/**
+ * \brief Function implementing saturating and rounding vector multiplication
+ * \ingroup nvhls_vector
+ *
+ * \par Overview
+ * out[i] = Quant(in1[i] * in2[i]); see vector_add_quant.
+ */
+template <typename Quant, typename InType1, typename InType2, typename OutType,
+          unsigned int VectorLength>
+void vector_mul_quant(nv_scvector<InType1, VectorLength> in1,
+                      nv_scvector<InType2, VectorLength> in2,
+                      nv_scvector<OutType, VectorLength>& out) {
+  const unsigned int AccW = requant_width<InType1, InType2, InType1, OutType>::mul;
+  typedef typename nvhls_t<AccW>::nvint_t acc_t;
+#ifndef __SYNTHESIS__
+  if (host_vector_requant<InType1, InType2, InType1, OutType, VectorLength, AccW>(
+          HostMul, Quant::template host<OutType>(), in1.data, in2.data,
+          static_cast<const InType1*>(0), out.data))
+    return;
+#endif
+
+#pragma hls_unroll yes
+  for (unsigned i = 0; i < VectorLength; i++) {
+    acc_t a = in1[i], b = in2[i];
+    out[i] = Quant::template apply<OutType, AccW>(a * b);
+  }
+}
+
+/**
+ * \brief Function implementing vector multiply and add with requantization
+ * \ingroup nvhls_vector
+ *
+ * \tparam Quant            Requantization policy, e.g. Requant<7> for a MAC of Q7 operands into Q0
+ * \tparam InType1          Input1 Scalar Type
+ * \tparam InType2          Input2 Scalar Type
+ * \tparam InType3          Input3 (addend) Scalar Type
+ * \tparam OutType          Output Scalar Type
+ * \tparam VectorLength     Length of vector
+ *
+ * \par Overview
+ * out[i] = Quant(in1[i] * in2[i] + in3[i]). The rounding and saturation of
+ * the exact sum are fused into the MAC, so there is no separate pass over
+ * the lanes.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <nvhls_vector.h>
+ *
+ *      ...
+ *      nv_scvector<NVINT8, 16> x, w;
+ *      nv_scvector<NVINT16, 16> bias;
+ *      nv_scvector<NVINT8, 16> y;
+ *      ...
+ *      // y = sat8(round((x * w + bias) / 2^6))
+ *      nvhls::vector_mac_quant<nvhls::Requant<6, nvhls::RoundNearestEven, true> >(x, w, bias, y);
+ *      ...
+ * \endcode
+ * \par
+ *
+ */
+template <typename Quant, typename InType1, typename InType2, typename InType3,
+          typename OutType, unsigned int VectorLength>
+void vector_mac_quant(nv_scvector<InType1, VectorLength> in1,
+                      nv_scvector<InType2, VectorLength> in2,
+                      nv_scvector<InType3, VectorLength> in3,
+                      nv_scvector<OutType, VectorLength>& out) {
+  const unsigned int AccW = requant_width<InType1, InType2, InType3, OutType>::mac;
+  typedef typename nvhls_t<AccW>::nvint_t acc_t;
+#ifndef __SYNTHESIS__
+  if (host_vector_requant<InType1, InType2, InType3, OutType, VectorLength, AccW>(
+          HostMac, Quant::template host<OutType>(), in1.data, in2.data, in3.data, out.data))
+    return;
+#endif
+
+#pragma hls_unroll yes
+  for (unsigned i = 0; i < VectorLength; i++) {
+    acc_t a = in1[i], b = in2[i], c = in3[i];
+    out[i] = Quant::template apply<OutType, AccW>(a * b + c);
+  }
+}
 };
 
 #endif
@@ -0,0 +1,469 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_VECTOR_HOST_H
+#define NVHLS_VECTOR_HOST_H
+
+// C++ simulation kernels for the nvhls_vector operations. Not used in
+// synthesis.
+#ifndef __SYNTHESIS__
+
+#include <systemc.h>
+#include <nvhls_int.h>
+#include <nvhls_marshaller.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace nvhls {
+
+template <typename T1, typename T2>
+struct host_same_type {
+  static const bool value = false;
+};
+
+template <typename T>
+struct host_same_type<T, T> {
+  static const bool value = true;
+};
+
+/**
+ * \brief Scalar types supported by the host vector kernels
+ * \ingroup nvhls_vector
+ *
+ * \par Overview
+ * - nvint/nvuint (nvhls_t) types of up to 64 bits. Their operators wrap modulo 2^W, so computing the low bits of every product and sum in 32-bit or 64-bit host integers is bit-exact with both the AC and the SystemC view.
+ * - User-defined types keep the element-by-element operators.
+ */
+template <typename T>
+struct host_vector_type {
+  static const unsigned int width = Wrapped<T>::width;
+  static const bool is_signed = Wrapped<T>::is_signed;
+  static const bool value =
+      (width <= 64) && (host_same_type<T, typename nvhls_t<width>::nvuint_t>::value ||
+                        host_same_type<T, typename nvhls_t<width>::nvint_t>::value);
+};
+
+// Host lanes: 32-bit if every operand and the result fit, else 64-bit
+template <typename T1, typename T2, typename T3, typename T4>
+struct host_vector_lanes {
+  static const bool value = host_vector_type<T1>::value && host_vector_type<T2>::value &&
+                            host_vector_type<T3>::value && host_vector_type<T4>::value;
+  static const bool narrow = (host_vector_type<T1>::width <= 32) && (host_vector_type<T2>::width <= 32) &&
+                             (host_vector_type<T3>::width <= 32) && (host_vector_type<T4>::width <= 32);
+};
+
+template <typename T>
+inline uint64 host_load(const T& v) {
+  return host_vector_type<T>::is_signed ? static_cast<uint64>(v.to_int64()) : v.to_uint64();
+}
+
+enum host_vector_op { HostMul, HostAdd, HostSub, HostMac };
+
+// Element-wise out = a op b (HostMac: a * b + c) on wrapping host integers
+inline void host_elementwise32(host_vector_op op, const unsigned int* a, const unsigned int* b,
+                               const unsigned int* c, unsigned int* out, unsigned int n) {
+  unsigned int i = 0;
+#if defined(__AVX2__)
+  for (; i + 8 <= n; i += 8) {
+    __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    __m256i vo;
+    switch (op) {
+      case HostMul: vo = _mm256_mullo_epi32(va, vb); break;
+      case HostAdd: vo = _mm256_add_epi32(va, vb); break;
+      case HostSub: vo = _mm256_sub_epi32(va, vb); break;
+      default:
+        vo = _mm256_add_epi32(_mm256_mullo_epi32(va, vb),
+                              _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + i)));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), vo);
+  }
+#elif defined(__ARM_NEON)
+  for (; i + 4 <= n; i += 4) {
+    uint32x4_t va = vld1q_u32(a + i);
+    uint32x4_t vb = vld1q_u32(b + i);
+    uint32x4_t vo;
+    switch (op) {
+      case HostMul: vo = vmulq_u32(va, vb); break;
+      case HostAdd: vo = vaddq_u32(va, vb); break;
+      case HostSub: vo = vsubq_u32(va, vb); break;
+      default: vo = vmlaq_u32(vld1q_u32(c + i), va, vb);
+    }
+    vst1q_u32(out + i, vo);
+  }
+#endif
+  for (; i < n; i++) {
+    switch (op) {
+      case HostMul: out[i] = a[i] * b[i]; break;
+      case HostAdd: out[i] = a[i] + b[i]; break;
+      case HostSub: out[i] = a[i] - b[i]; break;
+      default: out[i] = a[i] * b[i] + c[i];
+    }
+  }
+}
+
+inline void host_elementwise64(host_vector_op op, const uint64* a, const uint64* b, const uint64* c,
+                               uint64* out, unsigned int n) {
+  for (unsigned int i = 0; i < n; i++) {
+    switch (op) {
+      case HostMul: out[i] = a[i] * b[i]; break;
+      case HostAdd: out[i] = a[i] + b[i]; break;
+      case HostSub: out[i] = a[i] - b[i]; break;
+      default: out[i] = a[i] * b[i] + c[i];
+    }
+  }
+}
+
+// Sum of a[i] * b[i] (or of a[i] if b is null) modulo 2^32
+inline unsigned int host_dot32(const unsigned int* a, const unsigned int* b, unsigned int n) {
+  unsigned int i = 0;
+  unsigned int sum = 0;
+#if defined(__AVX2__)
+  __m256i acc = _mm256_setzero_si256();
+  for (; i + 8 <= n; i += 8) {
+    __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    if (b != 0) {
+      va = _mm256_mullo_epi32(va, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+    }
+    acc = _mm256_add_epi32(acc, va);
+  }
+  unsigned int lanes[8];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+  for (unsigned int l = 0; l < 8; l++) sum += lanes[l];
+#elif defined(__ARM_NEON)
+  uint32x4_t acc = vdupq_n_u32(0);
+  for (; i + 4 <= n; i += 4) {
+    uint32x4_t va = vld1q_u32(a + i);
+    acc = (b != 0) ? vmlaq_u32(acc, va, vld1q_u32(b + i)) : vaddq_u32(acc, va);
+  }
+  sum = vaddvq_u32(acc);
+#endif
+  for (; i < n; i++) sum += (b != 0) ? a[i] * b[i] : a[i];
+  return sum;
+}
+
+inline uint64 host_dot64(const uint64* a, const uint64* b, unsigned int n) {
+  uint64 sum = 0;
+  for (unsigned int i = 0; i < n; i++) sum += (b != 0) ? a[i] * b[i] : a[i];
+  return sum;
+}
+
+// Requantization of the saturating and rounding vector operations: an
+// arithmetic right shift by shift, rounded to nearest even if nearest, then
+// clamped to [lo, hi] if saturate
+struct host_requant {
+  unsigned int shift;
+  bool nearest, saturate;
+  int64 lo, hi;
+};
+
+template <typename T>
+inline T host_requant_lane(T x, const host_requant& q) {
+  if (q.shift != 0) {
+    if (q.nearest) x += ((static_cast<T>(1) << (q.shift - 1)) - 1) + ((x >> q.shift) & 1);
+    x >>= q.shift;
+  }
+  if (q.saturate) x = (x < q.lo) ? static_cast<T>(q.lo) : ((x > q.hi) ? static_cast<T>(q.hi) : x);
+  return x;
+}
+
+// out = requant(a op b) on signed 32-bit lanes that hold every result exactly
+inline void host_requant32(host_vector_op op, const int* a, const int* b, const int* c, int* out,
+                           unsigned int n, const host_requant& q) {
+  unsigned int i = 0;
+#if defined(__AVX2__)
+  const __m256i bias = _mm256_set1_epi32(q.shift ? (1 << (q.shift - 1)) - 1 : 0);
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i lo = _mm256_set1_epi32(static_cast<int>(q.lo));
+  const __m256i hi = _mm256_set1_epi32(static_cast<int>(q.hi));
+  const __m128i count = _mm_cvtsi32_si128(q.shift);
+  for (; i + 8 <= n; i += 8) {
+    __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    __m256i x;
+    switch (op) {
+      case HostMul: x = _mm256_mullo_epi32(va, vb); break;
+      case HostAdd: x = _mm256_add_epi32(va, vb); break;
+      case HostSub: x = _mm256_sub_epi32(va, vb); break;
+      default:
+        x = _mm256_add_epi32(_mm256_mullo_epi32(va, vb),
+                             _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c + i)));
+    }
+    if (q.shift != 0) {
+      if (q.nearest)
+        x = _mm256_add_epi32(_mm256_add_epi32(x, bias),
+                             _mm256_and_si256(_mm256_sra_epi32(x, count), one));
+      x = _mm256_sra_epi32(x, count);
+    }
+    if (q.saturate) x = _mm256_min_epi32(_mm256_max_epi32(x, lo), hi);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), x);
+  }
+#elif defined(__ARM_NEON)
+  const int32x4_t bias = vdupq_n_s32(q.shift ? (1 << (q.shift - 1)) - 1 : 0);
+  const int32x4_t one = vdupq_n_s32(1);
+  const int32x4_t lo = vdupq_n_s32(static_cast<int>(q.lo));
+  const int32x4_t hi = vdupq_n_s32(static_cast<int>(q.hi));
+  const int32x4_t count = vdupq_n_s32(-static_cast<int>(q.shift));
+  for (; i + 4 <= n; i += 4) {
+    int32x4_t va = vld1q_s32(a + i);
+    int32x4_t vb = vld1q_s32(b + i);
+    int32x4_t x;
+    switch (op) {
+      case HostMul: x = vmulq_s32(va, vb); break;
+      case HostAdd: x = vaddq_s32(va, vb); break;
+      case HostSub: x = vsubq_s32(va, vb); break;
+      default: x = vmlaq_s32(vld1q_s32(c + i), va, vb);
+    }
+    if (q.shift != 0) {
+      if (q.nearest) x = vaddq_s32(vaddq_s32(x, bias), vandq_s32(vshlq_s32(x, count), one));
+      x = vshlq_s32(x, count);
+    }
+    if (q.saturate) x = vminq_s32(vmaxq_s32(x, lo), hi);
+    vst1q_s32(out + i, x);
+  }
+#endif
+  for (; i < n; i++) {
+    int x;
+    switch (op) {
+      case HostMul: x = a[i] * b[i]; break;
+      case HostAdd: x = a[i] + b[i]; break;
+      case HostSub: x = a[i] - b[i]; break;
+      default: x = a[i] * b[i] + c[i];
+    }
+    out[i] = host_requant_lane(x, q);
+  }
+}
+
+inline void host_requant64(host_vector_op op, const int64* a, const int64* b, const int64* c,
+                           int64* out, unsigned int n, const host_requant& q) {
+  for (unsigned int i = 0; i < n; i++) {
+    int64 x;
+    switch (op) {
+      case HostMul: x = a[i] * b[i]; break;
+      case HostAdd: x = a[i] + b[i]; break;
+      case HostSub: x = a[i] - b[i]; break;
+      default: x = a[i] * b[i] + c[i];
+    }
+    out[i] = host_requant_lane(x, q);
+  }
+}
+
+// out[i] = in[idx[i]] for n output lanes; every idx[i] indexes in
+inline void host_gather32(const unsigned int* in, const unsigned int* idx, unsigned int* out,
+                          unsigned int n) {
+  unsigned int i = 0;
+#if defined(__AVX2__)
+  for (; i + 8 <= n; i += 8) {
+    __m256i vi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + i));
+    __m256i vo = _mm256_i32gather_epi32(reinterpret_cast<const int*>(in), vi, 4);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), vo);
+  }
+#endif
+  for (; i < n; i++) out[i] = in[idx[i]];
+}
+
+inline void host_gather64(const uint64* in, const unsigned int* idx, uint64* out, unsigned int n) {
+  unsigned int i = 0;
+#if defined(__AVX2__)
+  for (; i + 4 <= n; i += 4) {
+    __m128i vi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + i));
+    __m256i vo = _mm256_i32gather_epi64(reinterpret_cast<const long long*>(in), vi, 8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), vo);
+  }
+#endif
+  for (; i < n; i++) out[i] = in[idx[i]];
+}
+
+/**
+ * \brief Host kernels of the nvhls_vector operations
+ * \ingroup nvhls_vector
+ *
+ * \par Overview
+ * - Every function returns false, without touching its outputs, if the types are not supported (see host_vector_type). The caller then runs the element-by-element loop.
+ * - Elements are packed into host integer arrays and computed with AVX2 (x86) or NEON (ARM) when the compiler targets them, else with plain loops. The lane gather of the permutations uses the AVX2 gather instructions; NEON has no lane gather and uses the plain loop.
+ * - Defining VECTOR_SIM_USE_SCALAR_OPS disables the host kernels.
+ */
+template <bool Supported>
+struct host_vector_kernels {
+  template <typename T1, typename T2, typename T3, typename TO, unsigned int L>
+  static bool elementwise(host_vector_op op, const T1* in1, const T2* in2, const T3* in3, TO* out) {
+    return false;
+  }
+  template <typename T1, typename T2, typename T3, typename TO, unsigned int L>
+  static bool dot(const T1* in1, const T2* in2, const T3* init, TO& out) {
+    return false;
+  }
+  template <typename T, unsigned int LIn, unsigned int LOut>
+  static bool gather(const T* in, const unsigned int* idx, T* out) {
+    return false;
+  }
+  template <typename T1, typename T2, typename T3, typename TO, unsigned int L, unsigned int AccW>
+  static bool requant(host_vector_op op, const host_requant& q, const T1* in1, const T2* in2,
+                      const T3* in3, TO* out) {
+    return false;
+  }
+};
+
+template <>
+struct host_vector_kernels<true> {
+  template <typename T1, typename T2, typename T3, typename TO, unsigned int L>
+  static bool elementwise(host_vector_op op, const T1* in1, const T2* in2, const T3* in3, TO* out) {
+    if (host_vector_lanes<T1, T2, T3, TO>::narrow) {
+      unsigned int a[L], b[L], c[L], o[L];
+      for (unsigned int i = 0; i < L; i++) {
+        a[i] = static_cast<unsigned int>(host_load(in1[i]));
+        b[i] = static_cast<unsigned int>(host_load(in2[i]));
+        c[i] = (in3 != 0) ? static_cast<unsigned int>(host_load(in3[i])) : 0;
+      }
+      host_elementwise32(op, a, b, c, o, L);
+      for (unsigned int i = 0; i < L; i++) out[i] = o[i];
+    } else {
+      uint64 a[L], b[L], c[L], o[L];
+      for (unsigned int i = 0; i < L; i++) {
+        a[i] = host_load(in1[i]);
+        b[i] = host_load(in2[i]);
+        c[i] = (in3 != 0) ? host_load(in3[i]) : 0;
+      }
+      host_elementwise64(op, a, b, c, o, L);
+      for (unsigned int i = 0; i < L; i++) out[i] = o[i];
+    }
+    return true;
+  }
+
+  // out = init + sum(in1[i] * in2[i]), or of in1[i] if in2 is null
+  template <typename T1, typename T2, typename T3, typename TO, unsigned int L>
+  static bool dot(const T1* in1, const T2* in2, const T3* init, TO& out) {
+    if (host_vector_lanes<T1, T2, T3, TO>::narrow) {
+      unsigned int a[L], b[L];
+      for (unsigned int i = 0; i < L; i++) {
+        a[i] = static_cast<unsigned int>(host_load(in1[i]));
+        b[i] = (in2 != 0) ? static_cast<unsigned int>(host_load(in2[i])) : 0;
+      }
+      unsigned int sum = host_dot32(a, (in2 != 0) ? b : 0, L);
+      if (init != 0) sum += static_cast<unsigned int>(host_load(*init));
+      out = sum;
+    } else {
+      uint64 a[L], b[L];
+      for (unsigned int i = 0; i < L; i++) {
+        a[i] = host_load(in1[i]);
+        b[i] = (in2 != 0) ? host_load(in2[i]) : 0;
+      }
+      uint64 sum = host_dot64(a, (in2 != 0) ? b : 0, L);
+      if (init != 0) sum += host_load(*init);
+      out = sum;
+    }
+    return true;
+  }
+
+  // out = requant(in1 op in2 [+ in3]) computed exactly in AccW-bit signed
+  // lanes; false if they do not fit host integers with a bit of headroom
+  // for the rounding
+  template <typename T1, typename T2, typename T3, typename TO, unsigned int L, unsigned int AccW>
+  static bool requant(host_vector_op op, const host_requant& q, const T1* in1, const T2* in2,
+                      const T3* in3, TO* out) {
+    if (AccW <= 31) {
+      int a[L], b[L], c[L], o[L];
+      for (unsigned int i = 0; i < L; i++) {
+        a[i] = static_cast<int>(host_load(in1[i]));
+        b[i] = static_cast<int>(host_load(in2[i]));
+        c[i] = (in3 != 0) ? static_cast<int>(host_load(in3[i])) : 0;
+      }
+      host_requant32(op, a, b, c, o, L, q);
+      for (unsigned int i = 0; i < L; i++) out[i] = o[i];
+    } else if (AccW <= 63) {
+      int64 a[L], b[L], c[L], o[L];
+      for (unsigned int i = 0; i < L; i++) {
+        a[i] = static_cast<int64>(host_load(in1[i]));
+        b[i] = static_cast<int64>(host_load(in2[i]));
+        c[i] = (in3 != 0) ? static_cast<int64>(host_load(in3[i])) : 0;
+      }
+      host_requant64(op, a, b, c, o, L, q);
+      for (unsigned int i = 0; i < L; i++) out[i] = o[i];
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  // out[i] = in[idx[i]]; false if an index is out of range
+  template <typename T, unsigned int LIn, unsigned int LOut>
+  static bool gather(const T* in, const unsigned int* idx, T* out) {
+    for (unsigned int i = 0; i < LOut; i++) {
+      if (idx[i] >= LIn) return false;
+    }
+    if (host_vector_type<T>::width <= 32) {
+      unsigned int a[LIn], o[LOut];
+      for (unsigned int i = 0; i < LIn; i++) a[i] = static_cast<unsigned int>(host_load(in[i]));
+      host_gather32(a, idx, o, LOut);
+      for (unsigned int i = 0; i < LOut; i++) out[i] = o[i];
+    } else {
+      uint64 a[LIn], o[LOut];
+      for (unsigned int i = 0; i < LIn; i++) a[i] = host_load(in[i]);
+      host_gather64(a, idx, o, LOut);
+      for (unsigned int i = 0; i < LOut; i++) out[i] = o[i];
+    }
+    return true;
+  }
+};
+
+template <typename T1, typename T2, typename T3, typename TO, unsigned int L>
+inline bool host_vector_elementwise(host_vector_op op, const T1* in1, const T2* in2, const T3* in3, TO* out) {
+#ifdef VECTOR_SIM_USE_SCALAR_OPS
+  return false;
+#else
+  return host_vector_kernels<host_vector_lanes<T1, T2, T3, TO>::value>::template elementwise<T1, T2, T3, TO, L>(
+      op, in1, in2, in3, out);
+#endif
+}
+
+template <typename T1, typename T2, typename T3, typename TO, unsigned int L>
+inline bool host_vector_dot(const T1* in1, const T2* in2, const T3* init, TO& out) {
+#ifdef VECTOR_SIM_USE_SCALAR_OPS
+  return false;
+#else
+  return host_vector_kernels<host_vector_lanes<T1, T2, T3, TO>::value>::template dot<T1, T2, T3, TO, L>(
+      in1, in2, init, out);
+#endif
+}
+
+template <typename T1, typename T2, typename T3, typename TO, unsigned int L, unsigned int AccW>
+inline bool host_vector_requant(host_vector_op op, const host_requant& q, const T1* in1, const T2* in2,
+                                const T3* in3, TO* out) {
+#ifdef VECTOR_SIM_USE_SCALAR_OPS
+  return false;
+#else
+  return host_vector_kernels<host_vector_lanes<T1, T2, T3, TO>::value>::template requant<T1, T2, T3, TO, L, AccW>(
+      op, q, in1, in2, in3, out);
+#endif
+}
+
+template <typename T, unsigned int LIn, unsigned int LOut>
+inline bool host_vector_gather(const T* in, const unsigned int* idx, T* out) {
+#ifdef VECTOR_SIM_USE_SCALAR_OPS
+  return false;
+#else
+  return host_vector_kernels<host_vector_type<T>::value>::template gather<T, LIn, LOut>(in, idx, out);
+#endif
+}
+
+}  // namespace nvhls
+
+#endif  // __SYNTHESIS__
+
+#endif
@@ -20,6 +20,10 @@
  *
  * Replacement for Catapult's mc_verify.h, including their CCS_DESIGN() macros. NVHLS_VERIFY_BLOCKS list of units to be supported for co-simulation by NVHLS_DESIGN() And NVHLS_DESIGN_IN_CHIP() should be specified before including nvhls_verify.h. Only need to include the top-level units that will be directly under SystemC in co-simulation. Again, it's important to specify this immediately _before_ including nvhls_verify, because there may be multiple calls to nvhls_verify.h within a full design. Do not include any intermediate header files or specify any other defines in between.
  *
+ * Outside of Catapult's sc_verify, a unit X of NVHLS_VERIFY_BLOCKS is replaced by its RTL when __WRAP_X__ is defined to 1, and either of:
+ * - NVHLS_VERIFY_ISVCSMX: X_vcsmx_wrapper of X_wrapper.h, for VCS-MX co-simulation.
+ * - NVHLS_VERIFY_ISVERILATOR: X_verilator_wrapper of X_verilator_wrapper.h, which hls/verilator_wrapper.py generates around the Verilated Catapult RTL of X. Set VERILATOR_BLOCKS of cmod_Makefile to build a testbench this way. Like the VCS-MX flow, it needs the signal-level Connections ports of SIM_MODE 0 or 1.
+ *
  * \par A Simple Example
  * \code
  *      #define NVHLS_VERIFY_BLOCKS (UnitA)(UnitB)(UnitC)
@@ -95,8 +99,9 @@
 #endif
 
 /////////////////////////////////////////////////////////////////////////////
-// If this is running in CCS_SCVERIFY (instead of standalone g++ or vcsmx)
-#ifndef NVHLS_VERIFY_ISVCSMX
+// If this is running in CCS_SCVERIFY (instead of standalone g++, vcsmx or
+// verilator)
+#if !defined(NVHLS_VERIFY_ISVCSMX) && !defined(NVHLS_VERIFY_ISVERILATOR)
 
 // This section just defines a shortcut macro to be more consistent with how
 // SCVERIFY CCS_DESIGN worked
@@ -118,7 +123,7 @@
 #endif
 
 /////////////////////////////////////////////////////////////////////////////
-#else  // NVHLS_VERIFY_ISVCSMX
+#else  // NVHLS_VERIFY_ISVCSMX || NVHLS_VERIFY_ISVERILATOR
 
 // We are running the nvhls_verify stand_sim flow.
 
@@ -140,7 +145,7 @@
 
 #endif
 
-#endif  // NVHLS_VERIFY_ISVCSMX
+#endif  // NVHLS_VERIFY_ISVCSMX || NVHLS_VERIFY_ISVERILATOR
 /////////////////////////////////////////////////////////////////////////////
 
 // Undefine this so that nested uses of nvhls_verify.h doesn't throw warnings
@@ -154,6 +159,7 @@
 #define CURRENT_TYPE BOOST_PP_CAT(NVHLS_DESIGN_, CURRENT)
 #define CURRENT_WRAP_DEF BOOST_PP_CAT(BOOST_PP_CAT(__WRAP_, CURRENT), __)
 #define CURRENT_WRAP_CLASS BOOST_PP_CAT(CURRENT, _vcsmx_wrapper)
+#define CURRENT_VERILATOR_CLASS BOOST_PP_CAT(CURRENT, _verilator_wrapper)
 //#define CURRENT_MAX BOOST_PP_CAT(CURRENT, _MAX)
 //#define FOO         BOOST_PP_CAT(NVHLS_DESIGN_, CURRENT)
 
@@ -164,6 +170,13 @@
 #include BOOST_PP_STRINGIZE(BOOST_PP_CAT(CURRENT, _wrapper.h))
 typedef CURRENT_WRAP_CLASS CURRENT_TYPE;
 
+#elif CURRENT_WRAP_DEF && defined(NVHLS_VERIFY_ISVERILATOR)
+
+// If this will be a Verilated model, include the wrapper generated by
+// hls/verilator_wrapper.py and typedef it.
+#include BOOST_PP_STRINGIZE(BOOST_PP_CAT(CURRENT, _verilator_wrapper.h))
+typedef CURRENT_VERILATOR_CLASS CURRENT_TYPE;
+
 #else
 
 // If it is the normal module name.
@@ -176,5 +189,6 @@ typedef CURRENT CURRENT_TYPE;
 #undef CURRENT_TYPE
 #undef CURRENT_WRAP_DEF
 #undef CURRENT_WRAP_CLASS
+#undef CURRENT_VERILATOR_CLASS
 
 #endif  // !BOOST_PP_IS_ITERATING
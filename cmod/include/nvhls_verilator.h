@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVHLS_VERILATOR_H
+#define NVHLS_VERILATOR_H
+
+#include <systemc.h>
+#include <TypeToBits.h>
+
+namespace match {
+
+/**
+ * \brief Value type of a W-bit port of a Verilated SystemC model
+ * \ingroup NVHLSVerify
+ *
+ * Models built with "verilator --sc --pins-bv 2", as hls/verilator_wrapper.py
+ * builds them, have ports of bool for 1 bit and of sc_bv<W> for wider ones.
+ */
+template <int W>
+struct VerilatorPin {
+  typedef sc_bv<W> type;
+};
+
+template <>
+struct VerilatorPin<1> {
+  typedef bool type;
+};
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+template <int W>
+sc_bv<W> BitsToPin(const sc_lv<W>& bits) { return bits; }
+
+inline bool BitsToPin(const sc_lv<1>& bits) { return bits[0] == SC_LOGIC_1; }
+
+template <int W>
+sc_lv<W> PinToBits(const sc_bv<W>& pin) { return pin; }
+
+template <int W>
+sc_lv<W> PinToBits(bool pin) {
+  sc_lv<W> bits;
+  bits[0] = pin;
+  return bits;
+}
+#endif  // DOXYGEN_SHOULD_SKIP_THIS
+
+/**
+ * \brief Copies a port of a SystemC model to a W-bit pin of its Verilated RTL
+ * \ingroup NVHLSVerify
+ *
+ * The value is converted with TypeToBits(), so T can be any type a
+ * Connections port can carry, including the sc_lv of a Connections port's
+ * msg. Does not compile if the widths differ.
+ */
+template <int W, typename T>
+void PortToPin(const sc_in<T>& port, sc_signal<typename VerilatorPin<W>::type>& pin) {
+  static_assert(Wrapped<T>::width == W, "RTL and SystemC port widths differ");
+  pin.write(BitsToPin(TypeToBits(port.read())));
+}
+
+/**
+ * \brief Copies a W-bit pin of a Verilated RTL model to a port of its SystemC model
+ * \ingroup NVHLSVerify
+ */
+template <int W, typename T>
+void PinToPort(const sc_signal<typename VerilatorPin<W>::type>& pin, sc_out<T>& port) {
+  static_assert(Wrapped<T>::width == W, "RTL and SystemC port widths differ");
+  port.write(BitsToType<T>(PinToBits<W>(pin.read())));
+}
+
+}  // namespace match
+
+#endif  // NVHLS_VERILATOR_H
@@ -13,10 +13,70 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+
 #ifndef ONE_HOT_TO_BIN_H
 #define ONE_HOT_TO_BIN_H
 
 #include <nvhls_types.h>
+#include <nvhls_int.h>
+
+/**
+ * \brief Compile-time one-hot to binary encoder tree
+ * \ingroup one_hot_to_bin
+ *
+ * \tparam Width                 Number of one-hot bits encoded, must be a power of 2
+ *
+ * \par Overview
+ * - encode(X, start, idx) encodes bits [start, start+Width) of X, returns true if any of them is set and the offset of the set bit in idx.
+ * - Every node ORs the (valid, index) pairs of its halves and sets the MSB of the index if the upper half is valid, so the encoder is log2(Width) levels of 2-input ORs with no select logic, in the style of leading_ones_tree in nvhls_int.h.
+ * - If more than one bit is set, idx is the OR of their offsets, as for one_hot_to_bin().
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <one_hot_to_bin.h>
+ *
+ *      ...
+ *      NVUINT8 grant = 32;
+ *      one_hot_to_bin_tree<8>::idx_t idx;
+ *      bool any = one_hot_to_bin_tree<8>::encode(grant, 0, idx); // idx = 5
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <unsigned Width>
+class one_hot_to_bin_tree {
+ public:
+  enum { IdxW = (nvhls::log2_ceil<Width>::val > 0) ? nvhls::log2_ceil<Width>::val : 1 };
+  typedef NVUINTW(IdxW) idx_t;
+
+  template <typename type1>
+  static bool encode(const type1& X, unsigned start, idx_t& idx) {
+    enum { Half = Width / 2 };
+    typename one_hot_to_bin_tree<Half>::idx_t idx_upper, idx_lower;
+    bool valid_upper = one_hot_to_bin_tree<Half>::encode(X, start + Half, idx_upper);
+    bool valid_lower = one_hot_to_bin_tree<Half>::encode(X, start, idx_lower);
+    idx = static_cast<idx_t>(idx_upper) | static_cast<idx_t>(idx_lower);
+    idx[IdxW - 1] = valid_upper;
+    return (valid_upper || valid_lower);
+  }
+};
+
+// Base condition for Width = 1.
+template <>
+class one_hot_to_bin_tree<1> {
+ public:
+  enum { IdxW = 1 };
+  typedef NVUINTW(1) idx_t;
+
+  template <typename type1>
+  static bool encode(const type1& X, unsigned start, idx_t& idx) {
+    idx = 0;
+    return (X[start] == 1);
+  }
+};
+
 /**
  * \brief One hot to binary conversion 
  * \ingroup one_hot_to_bin
@@ -26,7 +86,12 @@
  *
  * \param[in]   one_hot_in     One hot input 
  * \param[out]  bin_out        Binary output 
-
+ *
+ * \par Overview
+ * - Implemented with one_hot_to_bin_tree, zero-extended to a power of 2 width, so the depth is log2(OneHotLen) OR levels.
+ * - Returns the OR of the indices of all set bits if one_hot_in is not one-hot, and 0 if it is 0.
+ * - Index bits beyond BinLen are dropped, and bits of bin_out beyond the index width are 0.
+ *
  * \par A Simple Example
  * \code
  *      #include <one_hot_to_bin.h>
@@ -46,30 +111,193 @@
 template <unsigned OneHotLen, unsigned BinLen>
 void one_hot_to_bin(const NVUINTW(OneHotLen) & one_hot_in,
                     NVUINTW(BinLen) & bin_out) {
+  enum { P2 = nvhls::next_pow2<OneHotLen>::val };
+  typedef one_hot_to_bin_tree<P2> Tree;
+  NVUINTW(P2) one_hot_pad = one_hot_in;
+  typename Tree::idx_t idx;
+  Tree::encode(one_hot_pad, 0, idx);
 
 #pragma hls_unroll yes
   for (unsigned bin = 0; bin < BinLen; bin++) {
+    if (bin < Tree::IdxW)
+      bin_out[bin] = idx[bin];
+    else
+      bin_out[bin] = 0;
+  }
+}
+
+/**
+ * \brief Compile-time binary to one-hot decoder tree
+ * \ingroup one_hot_to_bin
+ *
+ * \tparam BinLen                Width of the binary input
+ *
+ * \par Overview
+ * - decode(bin, one_hot) sets bit bin of the 2^BinLen-bit one_hot and clears the others.
+ * - Every node predecodes the upper and the lower half of the bits of bin and ANDs each pair of their outputs, so every output is log2(BinLen) levels of 2-input ANDs and the predecoded terms are shared.
+ *
+ */
+template <unsigned BinLen>
+class bin_to_one_hot_tree {
+ public:
+  enum { OneHotLen = 1 << BinLen };
 
-    // constructs mask which matches one-hot to binary outputs
-    NVUINTW(OneHotLen) tmp;
+  template <typename type1>
+  static void decode(const type1& bin, NVUINTW(OneHotLen) & one_hot) {
+    enum { LoLen = BinLen / 2, HiLen = BinLen - LoLen };
+    NVUINTW(LoLen) bin_lo = nvhls::get_slc<LoLen>(bin, 0);
+    NVUINTW(HiLen) bin_hi = nvhls::get_slc<HiLen>(bin, LoLen);
+    NVUINTW(1 << LoLen) lo;
+    NVUINTW(1 << HiLen) hi;
+    bin_to_one_hot_tree<LoLen>::decode(bin_lo, lo);
+    bin_to_one_hot_tree<HiLen>::decode(bin_hi, hi);
 #pragma hls_unroll yes
-    for (unsigned bit = 0; bit < OneHotLen; bit++) {
-      NVUINTW(OneHotLen) ind = bit;
-      tmp[bit] = ind[bin];
+    for (unsigned i = 0; i < OneHotLen; i++) {
+      one_hot[i] = hi[i >> LoLen] & lo[i & ((1 << LoLen) - 1)];
     }
+  }
+};
+
+// Base condition for BinLen = 1.
+template <>
+class bin_to_one_hot_tree<1> {
+ public:
+  enum { OneHotLen = 2 };
+
+  template <typename type1>
+  static void decode(const type1& bin, NVUINTW(2) & one_hot) {
+    one_hot[0] = !bin[0];
+    one_hot[1] = bin[0];
+  }
+};
+
+/**
+ * \brief Binary to one hot conversion
+ * \ingroup one_hot_to_bin
+ *
+ * \tparam BinLen           Width of binary input
+ * \tparam OneHotLen        Width of one-hot output
+ *
+ * \param[in]   bin_in         Binary input
+ * \param[out]  one_hot_out    One hot output
+ *
+ * \par Overview
+ * - Inverse of one_hot_to_bin(): sets bit bin_in of one_hot_out, implemented with bin_to_one_hot_tree.
+ * - one_hot_out is 0 if bin_in >= OneHotLen.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <one_hot_to_bin.h>
+ *
+ *      ...
+ *      NVUINT2 input = 2;
+ *      NVUINT4 output;
+ *      ...
+ *      bin_to_one_hot<2, 4>(input, output); // output = 4
+ *      ...
+ *
+ * \endcode
+ * \par
+ *
+ */
 
-    tmp = (tmp & one_hot_in);
+template <unsigned BinLen, unsigned OneHotLen>
+void bin_to_one_hot(const NVUINTW(BinLen) & bin_in,
+                    NVUINTW(OneHotLen) & one_hot_out) {
+  typedef bin_to_one_hot_tree<BinLen> Tree;
+  NVUINTW(Tree::OneHotLen) one_hot;
+  Tree::decode(bin_in, one_hot);
 
-    // Reduction OR
-    NVUINTW(1) bit_tmp = 0;
 #pragma hls_unroll yes
-    for (unsigned i = 0; i < OneHotLen; i++) {
-      bit_tmp = bit_tmp | tmp[i];
-    }
+  for (unsigned bit = 0; bit < OneHotLen; bit++) {
+    if (bit < Tree::OneHotLen)
+      one_hot_out[bit] = one_hot[bit];
+    else
+      one_hot_out[bit] = 0;
+  }
+}
+
+/**
+ * \brief Fused arbitration and one hot to binary conversion
+ * \ingroup one_hot_to_bin
+ *
+ * \tparam OneHotLen        Number of requesters
+ * \tparam BinLen           Width of the binary grant index
+ * \tparam ArbiterT         Arbiter type, any class with Mask pick(const Mask&), e.g. Arbiter<OneHotLen, ArbiterType>
+ *
+ * \param[in]       arbiter     Arbiter, updated by pick()
+ * \param[in]       valid       Requests
+ * \param[out]      grant       One hot grant
+ * \param[out]      grant_id    Binary index of the grant
+ *
+ * \par Overview
+ * - Returns true if a request was granted. The valid flag is the root of the encoder tree, so no separate (grant != 0) reduction follows the arbiter.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <Arbiter.h>
+ *      #include <one_hot_to_bin.h>
+ *
+ *      ...
+ *      Arbiter<4> arbiter;
+ *      NVUINT4 valid = 5, grant;
+ *      NVUINT2 grant_id;
+ *      ...
+ *      if (arbitrate_and_encode<4, 2>(arbiter, valid, grant, grant_id)) {
+ *        ... // serve requester grant_id
+ *      }
+ *
+ * \endcode
+ * \par
+ *
+ */
+
+// Binary index of a one hot grant of an arbiter, returns true if granted
+template <unsigned OneHotLen, unsigned BinLen>
+bool encode_grant(const NVUINTW(OneHotLen) & grant, NVUINTW(BinLen) & grant_id) {
+  enum { P2 = nvhls::next_pow2<OneHotLen>::val };
+  typedef one_hot_to_bin_tree<P2> Tree;
+  NVUINTW(P2) grant_pad = grant;
+  typename Tree::idx_t idx;
+  bool granted = Tree::encode(grant_pad, 0, idx);
 
-    // Update output
-    bin_out[bin] = bit_tmp;
+#pragma hls_unroll yes
+  for (unsigned bin = 0; bin < BinLen; bin++) {
+    if (bin < Tree::IdxW)
+      grant_id[bin] = idx[bin];
+    else
+      grant_id[bin] = 0;
   }
+  return granted;
+}
+
+template <unsigned OneHotLen, unsigned BinLen, typename ArbiterT>
+bool arbitrate_and_encode(ArbiterT& arbiter, const NVUINTW(OneHotLen) & valid,
+                          NVUINTW(OneHotLen) & grant, NVUINTW(BinLen) & grant_id) {
+  grant = arbiter.pick(valid);
+  return encode_grant<OneHotLen, BinLen>(grant, grant_id);
+}
+
+/**
+ * \brief Fused arbitration with a hold input and one hot to binary conversion
+ * \ingroup one_hot_to_bin
+ *
+ * \tparam OneHotLen        Number of requesters
+ * \tparam BinLen           Width of the binary grant index
+ * \tparam ArbiterT         Arbiter type with Mask pick(const Mask&, bool hold), e.g. LockableArbiter<OneHotLen, ArbiterType>
+ *
+ * \param[in]       arbiter     Arbiter, updated by pick() unless the grant is held
+ * \param[in]       valid       Requests
+ * \param[in]       hold        Keep the last grant, see LockableArbiter
+ * \param[out]      grant       One hot grant
+ * \param[out]      grant_id    Binary index of the grant
+ *
+ */
+template <unsigned OneHotLen, unsigned BinLen, typename ArbiterT>
+bool arbitrate_and_encode(ArbiterT& arbiter, const NVUINTW(OneHotLen) & valid, bool hold,
+                          NVUINTW(OneHotLen) & grant, NVUINTW(BinLen) & grant_id) {
+  grant = arbiter.pick(valid, hold);
+  return encode_grant<OneHotLen, BinLen>(grant, grant_id);
 }
 
 #endif
@@ -0,0 +1,463 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PERMUTATION_NETWORK_H
+#define PERMUTATION_NETWORK_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_assert.h>
+#include <crossbar.h>
+
+/**
+ * \brief Switch settings of a Benes network
+ * \ingroup Crossbar
+ *
+ * \tparam NumLanes     Number of lanes, a power of two
+ *
+ * \par Overview
+ * - A Benes network of N lanes has 2*log2(N)-1 stages of N/2 two-by-two switches.  Stage s pairs the lanes of
+ *   blocks of N>>d lanes, d = min(s, 2*log2(N)-2-s): input-side stages send lanes 2j and 2j+1 of a block to lanes
+ *   j and j+size/2, output-side stages do the reverse.
+ * - sw[s][k] = false passes switch k of stage s straight, true crosses it.
+ * - It can realize every permutation with about 2*N*log2(N) two-input muxes, instead of the N*N of crossbar().
+ */
+template <unsigned NumLanes>
+struct BenesCtrl {
+  static_assert(NumLanes >= 2 && (NumLanes & (NumLanes - 1)) == 0, "NumLanes must be a power of two");
+  static const unsigned LogLanes = nvhls::log2_ceil<NumLanes>::val;
+  static const unsigned NumStages = 2 * LogLanes - 1;
+  static const unsigned NumSwitches = NumLanes / 2;
+
+  bool sw[NumStages][NumSwitches];
+};
+
+namespace nvhls {
+
+// Looping algorithm on one block of Size lanes at recursion depth depth: pick
+// the upper or lower subnetwork for every input so that the two inputs of each
+// input switch, and the two sources of each output switch, use different
+// subnetworks; then route both subnetworks.
+template <unsigned NumLanes, unsigned Size>
+struct benes_router {
+  static void route(const unsigned perm[Size], unsigned depth, unsigned block, BenesCtrl<NumLanes>& ctrl) {
+    static const unsigned Half = Size / 2;
+    unsigned inv[Size];
+    int side[Size];
+    for (unsigned i = 0; i < Size; i++) {
+      inv[perm[i]] = i;
+      side[i] = -1;
+    }
+    for (unsigned start = 0; start < Size; start += 2) {
+      unsigned i = start;
+      while (side[i] == -1) {
+        side[i] = 0;
+        side[i ^ 1] = 1;
+        // The output next to the one of the lower input must come from above
+        i = inv[perm[i ^ 1] ^ 1];
+      }
+    }
+
+    unsigned upper[Half], lower[Half];
+    for (unsigned j = 0; j < Half; j++) {
+      unsigned up = (side[2 * j] == 0) ? 2 * j : 2 * j + 1;
+      ctrl.sw[depth][block * Half + j] = (up != 2 * j);
+      ctrl.sw[BenesCtrl<NumLanes>::NumStages - 1 - depth][block * Half + j] = (side[inv[2 * j]] != 0);
+      upper[j] = perm[up] / 2;
+      lower[j] = perm[up ^ 1] / 2;
+    }
+    benes_router<NumLanes, Half>::route(upper, depth + 1, 2 * block, ctrl);
+    benes_router<NumLanes, Half>::route(lower, depth + 1, 2 * block + 1, ctrl);
+  }
+};
+
+template <unsigned NumLanes>
+struct benes_router<NumLanes, 2> {
+  static void route(const unsigned perm[2], unsigned depth, unsigned block, BenesCtrl<NumLanes>& ctrl) {
+    ctrl.sw[depth][block] = (perm[0] != 0);
+  }
+};
+
+}  // namespace nvhls
+
+/**
+ * \brief Computes the Benes switch settings for a crossbar-style source selection
+ * \ingroup Crossbar
+ *
+ * \tparam NumLanes             Number of input and output lanes, a power of two
+ *
+ * \param[in]   source          Array indicating the origin lane for each output lane id, as in crossbar().
+ * \param[in]   valid_source    Array of boolean valid bits, indexed by output lane id.
+ * \param[out]  ctrl            Switch settings.
+ * \param[out]  routed          Array indexed by output lane id: true if the output receives the lane it selected.
+ *
+ * \par Overview
+ * - A permutation network can not broadcast: if several valid outputs select the same input, the lowest one gets it
+ *   and the others are not routed.  Outputs that are invalid or not routed receive unused inputs, which completes
+ *   the selection to a permutation.
+ * - The looping algorithm is sequential in N*log2(N).  When the same permutation is used for many cycles, compute
+ *   ctrl once and pass it to benes_apply(), or store BenesCtrl in a register.
+ */
+template <unsigned NumLanes>
+void benes_route(NVUINTW(nvhls::index_width<NumLanes>::val) source[NumLanes],
+                 bool valid_source[NumLanes], BenesCtrl<NumLanes>& ctrl, bool routed[NumLanes]) {
+  bool used[NumLanes];
+  unsigned perm[NumLanes];  // perm[input] = output
+  for (unsigned i = 0; i < NumLanes; i++) {
+    used[i] = false;
+  }
+  for (unsigned out = 0; out < NumLanes; out++) {
+    unsigned in = source[out].to_uint64();
+    routed[out] = valid_source[out] && !used[in];
+    if (routed[out]) {
+      used[in] = true;
+      perm[in] = out;
+    }
+  }
+  unsigned next_free = 0;
+  for (unsigned out = 0; out < NumLanes; out++) {
+    if (!routed[out]) {
+      while (used[next_free]) {
+        next_free++;
+      }
+      used[next_free] = true;
+      perm[next_free] = out;
+    }
+  }
+  nvhls::benes_router<NumLanes, NumLanes>::route(perm, 0, 0, ctrl);
+}
+
+/**
+ * \brief Passes lanes through stages first..last of a Benes network
+ * \ingroup Crossbar
+ *
+ * \par Overview
+ * - data and valid are updated in place; valid travels with its data.  Calling it for consecutive stage ranges
+ *   with registers in between pipelines the network, see BenesNetwork.
+ */
+template <typename DataType, unsigned NumLanes>
+void benes_apply(DataType data[NumLanes], bool valid[NumLanes], const BenesCtrl<NumLanes>& ctrl,
+                 unsigned first = 0, unsigned last = BenesCtrl<NumLanes>::NumStages - 1) {
+  static const unsigned LogLanes = BenesCtrl<NumLanes>::LogLanes;
+  static const unsigned NumStages = BenesCtrl<NumLanes>::NumStages;
+
+#pragma hls_unroll yes
+  for (unsigned s = 0; s < NumStages; s++) {
+    if (s >= first && s <= last) {
+      unsigned depth = (s < LogLanes) ? s : NumStages - 1 - s;
+      unsigned half = (NumLanes >> depth) / 2;
+      DataType data_tmp[NumLanes];
+      bool valid_tmp[NumLanes];
+#pragma hls_unroll yes
+      for (unsigned k = 0; k < NumLanes / 2; k++) {
+        unsigned base = (k / half) * 2 * half;
+        unsigned j = k % half;
+        unsigned a = (s < LogLanes) ? base + 2 * j : base + j;
+        unsigned b = (s < LogLanes) ? base + 2 * j + 1 : base + half + j;
+        unsigned top = (s < LogLanes) ? base + j : base + 2 * j;
+        unsigned bottom = (s < LogLanes) ? base + half + j : base + 2 * j + 1;
+        bool cross = ctrl.sw[s][k];
+        data_tmp[top] = cross ? data[b] : data[a];
+        valid_tmp[top] = cross ? valid[b] : valid[a];
+        data_tmp[bottom] = cross ? data[a] : data[b];
+        valid_tmp[bottom] = cross ? valid[a] : valid[b];
+      }
+#pragma hls_unroll yes
+      for (unsigned i = 0; i < NumLanes; i++) {
+        data[i] = data_tmp[i];
+        valid[i] = valid_tmp[i];
+      }
+    }
+  }
+}
+
+/**
+ * \brief Benes permutation network with the interface of crossbar()
+ * \ingroup Crossbar
+ *
+ * \tparam DataType             Datatype of input and output of each lane
+ * \tparam NumLanes             Number of input and output lanes, a power of two
+ *
+ * \param[in]   data_in         Array of data inputs for each lane, indexed by input lane id.
+ * \param[in]   valid_in        Array of boolean valid bits, indexed by input lane id.
+ * \param[in]   source          Array indicating the origin lane for each output lane id.
+ * \param[in]   valid_source    Array of boolean valid bits, indexed by output lane id.
+ * \param[out]  data_out        Array of outputs, indexed by output lane id.
+ * \param[out]  valid_out       Array of outputs, indexed by output lane id.
+ *
+ * \par Overview
+ * - Same behavior as crossbar() for permutations: output x gets input source[x], and is invalid with 0 on the data
+ *   bits if its source selection or the selected input is invalid.
+ * - Several outputs can not select the same input; only the lowest of them is valid (see benes_route()).
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <permutation_network.h>
+ *
+ *      ...
+ *      benes<DataType, 64>(data_in, valid_in, source, valid_source, data_out, valid_out);
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename DataType, unsigned NumLanes>
+void benes(DataType data_in[NumLanes], bool valid_in[NumLanes],
+           NVUINTW(nvhls::index_width<NumLanes>::val) source[NumLanes],
+           bool valid_source[NumLanes],
+           DataType data_out[NumLanes],
+           bool valid_out[NumLanes]) {
+  BenesCtrl<NumLanes> ctrl;
+  bool routed[NumLanes];
+  benes_route<NumLanes>(source, valid_source, ctrl, routed);
+
+  bool carry[NumLanes];
+#pragma hls_unroll yes
+  for (unsigned i = 0; i < NumLanes; i++) {
+    carry[i] = false;
+  }
+#pragma hls_unroll yes
+  for (unsigned out = 0; out < NumLanes; out++) {
+    if (routed[out]) {
+      carry[source[out]] = valid_in[source[out]];
+    }
+  }
+#pragma hls_unroll yes
+  for (unsigned i = 0; i < NumLanes; i++) {
+    data_out[i] = data_in[i];
+    valid_out[i] = carry[i];
+  }
+
+  benes_apply<DataType, NumLanes>(data_out, valid_out, ctrl);
+
+#pragma hls_unroll yes
+  for (unsigned out = 0; out < NumLanes; out++) {
+    if (!valid_out[out]) {
+      data_out[out] = zero_bits<DataType>();
+    }
+  }
+}
+
+/**
+ * \brief Pipelined Benes network
+ * \ingroup Crossbar
+ *
+ * \tparam DataType             Datatype of input and output of each lane
+ * \tparam NumLanes             Number of input and output lanes, a power of two
+ * \tparam NumPipelineStages    Number of register stages between network stages (default: 0)
+ *
+ * \par Overview
+ * - run() has the arguments and behavior of benes(), with NumPipelineStages calls of latency: the outputs of a
+ *   call belong to the inputs of NumPipelineStages calls earlier.  Call it once per cycle.
+ * - The registers split the 2*log2(N)-1 network stages into NumPipelineStages+1 groups of nearly equal depth.
+ *   Routing is done in the first group; the switch settings travel with the data.
+ */
+template <typename DataType, unsigned NumLanes, unsigned NumPipelineStages = 0>
+class BenesNetwork {
+  static const unsigned NumStages = BenesCtrl<NumLanes>::NumStages;
+  static_assert(NumPipelineStages < NumStages, "NumPipelineStages must be less than the number of network stages");
+  static const unsigned PipeDepth = (NumPipelineStages > 0) ? NumPipelineStages : 1;
+
+  DataType pipe_data[PipeDepth][NumLanes];
+  bool pipe_valid[PipeDepth][NumLanes];
+  BenesCtrl<NumLanes> pipe_ctrl[PipeDepth];
+
+  // Last network stage before register p
+  static unsigned LastStage(unsigned p) { return ((p + 1) * NumStages) / (NumPipelineStages + 1) - 1; }
+
+ public:
+  BenesNetwork() { reset(); }
+
+  void reset() {
+#pragma hls_unroll yes
+    for (unsigned p = 0; p < PipeDepth; p++) {
+#pragma hls_unroll yes
+      for (unsigned i = 0; i < NumLanes; i++) {
+        pipe_data[p][i] = zero_bits<DataType>();
+        pipe_valid[p][i] = false;
+      }
+    }
+  }
+
+  void run(DataType data_in[NumLanes], bool valid_in[NumLanes],
+           NVUINTW(nvhls::index_width<NumLanes>::val) source[NumLanes],
+           bool valid_source[NumLanes],
+           DataType data_out[NumLanes],
+           bool valid_out[NumLanes]) {
+    BenesCtrl<NumLanes> ctrl;
+    bool routed[NumLanes];
+    benes_route<NumLanes>(source, valid_source, ctrl, routed);
+
+    DataType data[NumLanes];
+    bool valid[NumLanes];
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumLanes; i++) {
+      data[i] = data_in[i];
+      valid[i] = false;
+    }
+#pragma hls_unroll yes
+    for (unsigned out = 0; out < NumLanes; out++) {
+      if (routed[out]) {
+        valid[source[out]] = valid_in[source[out]];
+      }
+    }
+
+    if (NumPipelineStages == 0) {
+      benes_apply<DataType, NumLanes>(data, valid, ctrl);
+#pragma hls_unroll yes
+      for (unsigned i = 0; i < NumLanes; i++) {
+        data_out[i] = data[i];
+        valid_out[i] = valid[i];
+      }
+    } else {
+      // The last register feeds the last group of stages
+#pragma hls_unroll yes
+      for (unsigned i = 0; i < NumLanes; i++) {
+        data_out[i] = pipe_data[PipeDepth - 1][i];
+        valid_out[i] = pipe_valid[PipeDepth - 1][i];
+      }
+      benes_apply<DataType, NumLanes>(data_out, valid_out, pipe_ctrl[PipeDepth - 1],
+                                      LastStage(PipeDepth - 1) + 1, NumStages - 1);
+#pragma hls_unroll yes
+      for (unsigned p = PipeDepth - 1; p > 0; p--) {
+        benes_apply<DataType, NumLanes>(pipe_data[p - 1], pipe_valid[p - 1], pipe_ctrl[p - 1],
+                                        LastStage(p - 1) + 1, LastStage(p));
+#pragma hls_unroll yes
+        for (unsigned i = 0; i < NumLanes; i++) {
+          pipe_data[p][i] = pipe_data[p - 1][i];
+          pipe_valid[p][i] = pipe_valid[p - 1][i];
+        }
+        pipe_ctrl[p] = pipe_ctrl[p - 1];
+      }
+      benes_apply<DataType, NumLanes>(data, valid, ctrl, 0, LastStage(0));
+#pragma hls_unroll yes
+      for (unsigned i = 0; i < NumLanes; i++) {
+        pipe_data[0][i] = data[i];
+        pipe_valid[0][i] = valid[i];
+      }
+      pipe_ctrl[0] = ctrl;
+    }
+
+#pragma hls_unroll yes
+    for (unsigned out = 0; out < NumLanes; out++) {
+      if (!valid_out[out]) {
+        data_out[out] = zero_bits<DataType>();
+      }
+    }
+  }
+};
+
+/**
+ * \brief Butterfly network for restricted permutations, with the interface of crossbar()
+ * \ingroup Crossbar
+ *
+ * \tparam DataType             Datatype of input and output of each lane
+ * \tparam NumLanes             Number of input and output lanes, a power of two
+ *
+ * \return True if every valid source selection was routed.
+ *
+ * \par Overview
+ * - log2(N) stages of N/2 switches, i.e. half of a Benes network, with no routing computation: at stage s each
+ *   lane is steered by bit s of its destination.
+ * - Routes every cyclic shift (source[x] = (x + k) % N) and every permutation that XORs the lane index with a
+ *   constant.  Permutations that would need two lanes to leave a switch on the same side lose the lane coming
+ *   from the bottom input; its output is invalid and the function returns false.
+ * - As with benes(), several outputs can not select the same input; only the lowest of them is routed.
+ */
+template <typename DataType, unsigned NumLanes>
+bool butterfly(DataType data_in[NumLanes], bool valid_in[NumLanes],
+               NVUINTW(nvhls::index_width<NumLanes>::val) source[NumLanes],
+               bool valid_source[NumLanes],
+               DataType data_out[NumLanes],
+               bool valid_out[NumLanes]) {
+  static_assert(NumLanes >= 2 && (NumLanes & (NumLanes - 1)) == 0, "NumLanes must be a power of two");
+  static const unsigned LogLanes = nvhls::log2_ceil<NumLanes>::val;
+  typedef NVUINTW(nvhls::index_width<NumLanes>::val) LaneIdx;
+
+  DataType data[NumLanes];
+  bool valid[NumLanes];
+  bool carry[NumLanes];  // the lane holds an element for a routed output
+  LaneIdx dest[NumLanes];
+#pragma hls_unroll yes
+  for (unsigned i = 0; i < NumLanes; i++) {
+    data[i] = data_in[i];
+    valid[i] = valid_in[i];
+    carry[i] = false;
+    dest[i] = 0;
+  }
+  bool routed_all = true;
+#pragma hls_unroll yes
+  for (unsigned out = 0; out < NumLanes; out++) {
+    if (valid_source[out]) {
+      if (carry[source[out]]) {
+        routed_all = false;
+      } else {
+        carry[source[out]] = true;
+        dest[source[out]] = out;
+      }
+    }
+  }
+
+#pragma hls_unroll yes
+  for (unsigned s = 0; s < LogLanes; s++) {
+    DataType data_tmp[NumLanes];
+    bool valid_tmp[NumLanes];
+    bool carry_tmp[NumLanes];
+    LaneIdx dest_tmp[NumLanes];
+#pragma hls_unroll yes
+    for (unsigned k = 0; k < NumLanes / 2; k++) {
+      // Lanes a and b differ in bit s
+      unsigned a = ((k >> s) << (s + 1)) | (k & ((1u << s) - 1));
+      unsigned b = a | (1u << s);
+      bool a_wants_b = carry[a] && (dest[a][s] == 1);
+      bool b_wants_a = carry[b] && (dest[b][s] == 0);
+      bool cross;
+      if (carry[a]) {
+        cross = a_wants_b;
+        if (carry[b] && (a_wants_b != b_wants_a)) {
+          routed_all = false;
+          carry[b] = false;
+        }
+      } else {
+        cross = b_wants_a;
+      }
+      data_tmp[a] = cross ? data[b] : data[a];
+      valid_tmp[a] = cross ? valid[b] : valid[a];
+      carry_tmp[a] = cross ? carry[b] : carry[a];
+      dest_tmp[a] = cross ? dest[b] : dest[a];
+      data_tmp[b] = cross ? data[a] : data[b];
+      valid_tmp[b] = cross ? valid[a] : valid[b];
+      carry_tmp[b] = cross ? carry[a] : carry[b];
+      dest_tmp[b] = cross ? dest[a] : dest[b];
+    }
+#pragma hls_unroll yes
+    for (unsigned i = 0; i < NumLanes; i++) {
+      data[i] = data_tmp[i];
+      valid[i] = valid_tmp[i];
+      carry[i] = carry_tmp[i];
+      dest[i] = dest_tmp[i];
+    }
+  }
+
+#pragma hls_unroll yes
+  for (unsigned out = 0; out < NumLanes; out++) {
+    valid_out[out] = carry[out] && valid[out];
+    data_out[out] = valid_out[out] ? data[out] : zero_bits<DataType>();
+  }
+  return routed_all;
+}
+
+#endif  // PERMUTATION_NETWORK_H
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRAM_FIFO_H
+#define SRAM_FIFO_H
+
+#include <nvhls_types.h>
+#include <nvhls_int.h>
+#include <nvhls_assert.h>
+#include <mem_array.h>
+#include <fifo.h>
+
+/**
+ * \brief Deep FIFO with its body in an SRAM and a small flop prefetch stage at the head
+ * \ingroup FIFO
+ *
+ * \tparam DataType         DataType of entry in FIFO
+ * \tparam Depth            Number of entries in the SRAM body
+ * \tparam PrefetchDepth    Number of flop entries at the head (default: 2)
+ * \tparam DualPort         Whether the SRAM has separate read and write ports (default: true)
+ *
+ * \par Overview
+ * - The body is a single-bank mem_array_sep, to be mapped to an SRAM with a one-cycle read latency. peek() and
+ *   pop() read a FIFO<DataType, PrefetchDepth> of flops, so the head is available without an SRAM access.
+ * - The FIFO is clocked: call push(), peek() and pop() at most once each per cycle, then tick() once at the end of
+ *   the cycle.  tick() writes the pushed entry and refills the prefetch stage from the SRAM.
+ * - A push into an empty FIFO bypasses the SRAM and can be popped in the next cycle, as with FIFO.
+ * - The refill decision uses the prefetch occupancy registered at the start of the cycle, so the SRAM read
+ *   address does not depend on this cycle's pop.  With PrefetchDepth >= 2 and a dual-port SRAM, one push and one
+ *   pop per cycle are sustained.
+ * - With a single-port SRAM (DualPort = false), a refill and a write of the body in the same cycle conflict.  The
+ *   refill goes first and the write waits one cycle, during which isFull() is true; a write that has waited goes
+ *   first in the next conflict.  A stream through a non-empty body then runs at half rate.
+ * - Total capacity is Depth + PrefetchDepth entries; isFull() is true when the SRAM body is full.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <sram_fifo.h>
+ *
+ *      ...
+ *      SramFifo<DataType, 4096> fifo_inst;
+ *
+ *      #pragma hls_pipeline_init_interval 1
+ *      while (1) {
+ *        wait();
+ *        if (!fifo_inst.isEmpty() && out.PushNB(fifo_inst.peek())) {
+ *          fifo_inst.pop();
+ *        }
+ *        if (!fifo_inst.isFull() && in.PopNB(data)) {
+ *          fifo_inst.push(data);
+ *        }
+ *        fifo_inst.tick();
+ *      }
+ *
+ * \endcode
+ * \par
+ *
+ */
+template <typename DataType, unsigned int Depth, unsigned int PrefetchDepth = 2, bool DualPort = true>
+class SramFifo {
+  static_assert(Depth >= 1, "SramFifo needs at least one SRAM entry");
+  static_assert(PrefetchDepth >= 1, "SramFifo needs at least one prefetch entry");
+
+ public:
+  static const int AddrWidth = nvhls::index_width<Depth>::val;
+  static const int CountWidth = nvhls::nbits<Depth + PrefetchDepth>::val;
+  typedef NVUINTW(AddrWidth) SramIdx;
+  typedef NVUINTW(nvhls::nbits<Depth>::val) SramCount;
+  typedef NVUINTW(CountWidth) FifoIdxPlusOne;
+  typedef mem_array_sep<DataType, Depth, 1> SramBody;
+  typedef FIFO<DataType, PrefetchDepth> Prefetch;
+
+  SramBody sram_body;
+  Prefetch prefetch;
+  SramIdx head;  // where to read from
+  SramIdx tail;  // where to write to
+  SramCount sram_count;
+  NVUINTW(nvhls::nbits<PrefetchDepth>::val) prefetch_count;  // prefetch occupancy at the start of the cycle
+  bool wr_valid;
+  bool wr_waited;  // a single-port write lost the last conflict
+  DataType wr_data;
+
+  SramFifo() { reset(); }
+
+  void reset() {
+    prefetch.reset();
+    head = 0;
+    tail = 0;
+    sram_count = 0;
+    prefetch_count = 0;
+    wr_valid = false;
+    wr_waited = false;
+  }
+
+  // Function to push data to FIFO, at most once per cycle; the entry is stored at tick()
+  void push(DataType data) {
+    NVHLS_ASSERT_MSG(!isFull(), "Pushing data to full FIFO");
+    wr_data = data;
+    wr_valid = true;
+  }
+
+  // Function to pop data from FIFO
+  DataType pop() {
+    NVHLS_ASSERT_MSG(!isEmpty(), "Popping data from empty FIFO");
+    return prefetch.pop();
+  }
+
+  // Function to increment the head pointer (emulate a pop)
+  void incrHead() {
+    NVHLS_ASSERT_MSG(!isEmpty(), "Incrementing Head of empty FIFO");
+    prefetch.incrHead();
+  }
+
+  // Function to peek from FIFO; reads the prefetch stage only
+  DataType peek() {
+    NVHLS_ASSERT_MSG(!isEmpty(), "Peeking data from empty FIFO");
+    return prefetch.peek();
+  }
+
+  // Checks if an entry is available at the head
+  bool isEmpty() { return prefetch.isEmpty(); }
+
+  // Checks if the SRAM body is full or a push is still waiting for the SRAM
+  bool isFull() { return (sram_count == Depth) || wr_valid; }
+
+  // Returns number of entries in FIFO, including a push of this cycle
+  FifoIdxPlusOne NumFilled() {
+    return FifoIdxPlusOne(sram_count) + FifoIdxPlusOne(prefetch.NumFilled()) + (wr_valid ? 1 : 0);
+  }
+
+  // Ends the cycle: refill the prefetch stage and store this cycle's push
+  void tick() {
+    // Reads land in the prefetch stage at the end of the cycle in which they
+    // are issued, which models the output register of a one-cycle SRAM
+    bool rd = (sram_count != 0) && (prefetch_count < PrefetchDepth);
+    if (!DualPort && wr_valid && wr_waited) {
+      rd = false;
+    }
+    if (rd) {
+      prefetch.push(sram_body.read(head, 0));
+      head = (head == Depth - 1) ? SramIdx(0) : SramIdx(head + 1);
+      --sram_count;
+    }
+    if (wr_valid) {
+      if (sram_count == 0 && !prefetch.isFull()) {
+        prefetch.push(wr_data);
+        wr_valid = false;
+      } else if (DualPort || !rd) {
+        sram_body.write(tail, 0, wr_data);
+        tail = (tail == Depth - 1) ? SramIdx(0) : SramIdx(tail + 1);
+        ++sram_count;
+        wr_valid = false;
+      }
+    }
+    wr_waited = wr_valid;
+    prefetch_count = prefetch.NumFilled();
+  }
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m & head;
+    m & tail;
+    m & sram_count;
+    m & prefetch_count;
+    m & wr_valid;
+    m & wr_waited;
+    m & wr_data;
+    m & prefetch;
+    m & sram_body;
+  }
+};
+
+#endif  // end #define SRAM_FIFO_H macro
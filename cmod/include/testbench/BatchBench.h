@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BATCHBENCH_H_
+#define BATCHBENCH_H_
+
+#include <systemc.h>
+#include <nvhls_module.h>
+#include <testbench/nvhls_rand.h>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * \brief One seed of a BatchBench: a DUT and its testbench in a sub-module of the batch
+ * \ingroup BatchBench
+ *
+ * \par Overview
+ * A batch instance derives from BatchInstance, builds its DUT and testbench processes in its
+ * constructor, clocked by clk and reset by rst, and calls Done() when its test is over.  An instance
+ * must be independent of the other instances and of the order in which the kernel runs them:
+ * - Random numbers come from rng, or from other nvhls::RandStream streams seeded with seed, never
+ *   from rand() or nvhls::get_rand(), which share one state between all instances.
+ * - Checks call Fail() instead of assert() or exiting, so a failure only fails its own instance.
+ *   SC_ERROR reports from the processes of an instance also fail that instance.
+ * - The DUT keeps its state in members, not in function-local statics like the CCS_DESIGN
+ *   functions of FifoTop or ArbiterTop.
+ * SC_FATAL reports, which NVHLS_ASSERT raises, and failed assert()s still end the whole batch: a
+ * failed DUT assertion cannot be isolated in one process.
+ */
+class BatchInstance : public sc_module {
+ public:
+  sc_in<bool> clk;
+  sc_in<bool> rst;
+
+  const unsigned int index;
+  const uint64 seed;
+  nvhls::RandStream rng;
+
+  BatchInstance(sc_module_name name_, unsigned int index_, uint64 seed_)
+      : sc_module(name_),
+        clk("clk"),
+        rst("rst"),
+        index(index_),
+        seed(seed_),
+        rng(seed_, "batch"),
+        errors(0),
+        done(false),
+        remaining(NULL) {}
+
+  // Counts an error of this instance; the first message is reported.
+  void Fail(const std::string& msg) {
+    if (errors++ == 0) first_error = msg;
+  }
+
+  // Ends the test of this instance; the simulation stops when all instances are done.
+  void Done() {
+    if (done) return;
+    done = true;
+    if (remaining != NULL && --*remaining == 0) sc_stop();
+  }
+
+  bool IsDone() const { return done; }
+  bool Passed() const { return done && errors == 0; }
+  unsigned int Errors() const { return errors; }
+  const std::string& FirstError() const { return first_error; }
+
+ private:
+  template <typename Instance>
+  friend class BatchBench;
+
+  unsigned int errors;
+  std::string first_error;
+  bool done;
+  unsigned int* remaining;
+};
+
+/**
+ * \brief Runs many seeds of a small testbench as independent instances of one simulation
+ * \ingroup BatchBench
+ *
+ * \par Overview
+ * A seed sweep of a small unit spends most of its time in SystemC startup and elaboration if every
+ * seed is a process of its own.  BatchBench instead builds N instances of Instance, a BatchInstance,
+ * with the seeds first_seed, first_seed + 1, ..., drives them all from one clock and reset, and runs
+ * them in a single sc_start().  Run() then reports every failing instance and a summary
+ *
+ * \code
+ * BATCH <name> instance <i> seed <s> FAIL: <first error> (<n> errors)
+ * BATCH <name> instances=<n> passed=<n> failed=<n> elab_s=<t> wall_s=<t>
+ * \endcode
+ *
+ * and returns nonzero if any instance failed or did not call Done() before the time limit.  The
+ * number of instances is taken from the BATCH_INSTANCES environment variable if set, otherwise from
+ * the BATCH_INSTANCES define, otherwise from the constructor argument.  The first seed is taken from
+ * BATCH_SEED if set, otherwise it is nvhls::RandStream::default_seed(), which follows RAND_SEED.  An
+ * instance depends only on its seed, so BATCH_INSTANCES=1 BATCH_SEED=<s> reruns a failing instance
+ * alone.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <testbench/BatchBench.h>
+ *
+ *      class FifoInstance : public BatchInstance {
+ *       public:
+ *        SC_HAS_PROCESS(FifoInstance);
+ *        FifoInstance(sc_module_name name, unsigned int index, uint64 seed)
+ *            : BatchInstance(name, index, seed) {
+ *          SC_THREAD(run);
+ *          sensitive << clk.pos();
+ *          NVHLS_NEG_RESET_SIGNAL_IS(rst);
+ *        }
+ *        void run() {
+ *          ...
+ *          if (out != expected) Fail("pop returned the wrong word");
+ *          ...
+ *          Done();
+ *        }
+ *      };
+ *
+ *      int sc_main(int argc, char *argv[]) {
+ *        BatchBench<FifoInstance> batch("batch", 1000);
+ *        return batch.Run(sc_time(1, SC_MS));
+ *      }
+ * \endcode
+ * \par
+ *
+ */
+template <typename Instance>
+class BatchBench : public sc_module {
+ public:
+  sc_clock clk;
+  sc_signal<bool> rst;
+  std::vector<Instance*> instances;
+
+  SC_HAS_PROCESS(BatchBench);
+  BatchBench(sc_module_name name_, unsigned int dflt_instances,
+             const sc_time& period = sc_time(1, SC_NS))
+      : sc_module(name_),
+        clk("clk", period, 0.5, SC_ZERO_TIME, true),
+        rst("rst"),
+        start_wall(std::chrono::steady_clock::now()),
+        elab_s(0) {
+    unsigned int num = NumInstances(dflt_instances);
+    uint64 first_seed = FirstSeed();
+    remaining = num;
+    for (unsigned int i = 0; i < num; i++) {
+      std::ostringstream inst_name;
+      inst_name << "inst" << i;
+      Instance* inst = new Instance(inst_name.str().c_str(), i, first_seed + i);
+      inst->clk(clk);
+      inst->rst(rst);
+      inst->remaining = &remaining;
+      instances.push_back(inst);
+    }
+    SC_THREAD(reset);
+  }
+
+  static unsigned int NumInstances(unsigned int dflt) {
+    unsigned int num = dflt;
+#ifdef BATCH_INSTANCES
+    num = BATCH_INSTANCES;
+#endif
+    const char* env_num = std::getenv("BATCH_INSTANCES");
+    if (env_num != NULL) num = std::strtoul(env_num, NULL, 10);
+    return num;
+  }
+
+  static uint64 FirstSeed() {
+    const char* env_seed = std::getenv("BATCH_SEED");
+    if (env_seed != NULL) return std::strtoull(env_seed, NULL, 10);
+    return nvhls::RandStream::default_seed();
+  }
+
+  // Simulates until every instance is done or until limit, then reports; returns the number of
+  // instances that failed or timed out.
+  int Run(const sc_time& limit, std::ostream& os = std::cout) {
+    sc_report_handler::set_handler(ReportHandler);
+    sc_start(limit);
+    sc_report_handler::set_handler(sc_report_handler::default_handler);
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_wall).count();
+
+    unsigned int failed = 0;
+    for (unsigned int i = 0; i < instances.size(); i++) {
+      Instance* inst = instances[i];
+      if (inst->Passed()) continue;
+      failed++;
+      os << "BATCH " << name() << " instance " << i << " seed " << inst->seed << " FAIL: ";
+      if (inst->Errors() != 0)
+        os << inst->FirstError() << " (" << inst->Errors() << " errors)";
+      else
+        os << "not done at " << sc_time_stamp();
+      os << std::endl;
+    }
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << "BATCH " << name() << " instances=" << instances.size()
+       << " passed=" << instances.size() - failed << " failed=" << failed << std::fixed
+       << std::setprecision(3) << " elab_s=" << elab_s << " wall_s=" << wall << std::endl;
+    os.flags(flags);
+    os.precision(precision);
+    return failed;
+  }
+
+ protected:
+  unsigned int remaining;
+  std::chrono::steady_clock::time_point start_wall;
+  double elab_s;
+
+  void start_of_simulation() {
+    elab_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_wall).count();
+  }
+
+  void reset() {
+    rst.write(false);
+    wait(2 * clk.period());
+    rst.write(true);
+  }
+
+  // Charges SC_ERROR reports to the instance whose process raised them; everything else, and
+  // errors outside of any instance, go to the default handler.
+  static void ReportHandler(const sc_report& rep, const sc_actions& actions) {
+    if (rep.get_severity() == SC_ERROR) {
+      sc_process_handle handle = sc_get_current_process_handle();
+      sc_object* owner = handle.valid() ? handle.get_parent_object() : NULL;
+      while (owner != NULL && dynamic_cast<BatchInstance*>(owner) == NULL)
+        owner = owner->get_parent_object();
+      if (owner != NULL) {
+        std::string msg(rep.get_msg_type());
+        if (*rep.get_msg() != '\0') msg = msg + ": " + rep.get_msg();
+        dynamic_cast<BatchInstance*>(owner)->Fail(msg);
+        return;
+      }
+    }
+    sc_report_handler::default_handler(rep, actions);
+  }
+};
+
+#endif // BATCHBENCH_H_
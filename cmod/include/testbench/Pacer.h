@@ -20,5 +20,143 @@
 #include <nvhls_connections_utils.h>
 
 #include <connections/Pacer.h>
+#include <testbench/nvhls_rand.h>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+
+namespace nvhls {
+
+/**
+ * \brief Random stall generator that draws the RNG only on stall transitions
+ * \ingroup Pacer
+ *
+ * \par Overview
+ * GeometricPacer is a drop-in replacement for the Connections Pacer with the
+ * same stall_prob/hold_stall_prob Markov model: from the running state, each
+ * tic() starts a stall with probability stall_prob; while stalled, each tic()
+ * stays stalled with probability hold_stall_prob.  Instead of drawing a random
+ * number every tic(), it samples the geometric length of each run and stall
+ * phase once and counts down, so a port that rarely stalls costs one
+ * decrement per cycle.
+ *
+ * - Each pacer draws from its own nvhls::RandStream, seeded from RAND_SEED and
+ *   the pacer name, so ports do not disturb each other's stall patterns.  Give
+ *   every pacer a unique name, e.g. with SetName(std::string(name()) + ".pacer")
+ *   in the constructor of the module that owns a copy.
+ * - Cycles, stalled cycles, stalls and draws are counted per name.  With the
+ *   NVHLS_PACER_STATS environment variable set, PrintAllStats() runs at exit.
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <testbench/Pacer.h>
+ *
+ *      nvhls::GeometricPacer pacer(0.3, 0.7, "tb.src.pacer");
+ *      ...
+ *      while (pacer.tic()) wait();
+ *
+ * \endcode
+ * \par
+ *
+ */
+class GeometricPacer {
+ public:
+  struct Stats {
+    uint64 cycles;
+    uint64 stall_cycles;
+    uint64 stalls;
+    uint64 draws;
+    Stats() : cycles(0), stall_cycles(0), stalls(0), draws(0) {}
+  };
+
+  GeometricPacer(float stall_prob, float hold_stall_prob,
+                 const std::string& name = "pacer")
+      : stall_prob_(stall_prob), hold_stall_prob_(hold_stall_prob), rng_(name) {
+    SetName(name);
+  }
+
+  // Names (and reseeds) this pacer; copies keep sharing statistics by name
+  void SetName(const std::string& name) {
+    name_ = name;
+    rng_.seed(RandStream::default_seed(), name);
+    stats_ = &AllStats()[name];
+    reset();
+  }
+
+  void reset() {
+    stalled_ = false;
+    left_ = Draw(stall_prob_);
+  }
+
+  bool tic() {
+    stats_->cycles++;
+    while (left_ == 0) {
+      stalled_ = !stalled_;
+      if (stalled_) {
+        stats_->stalls++;
+        left_ = 1 + Draw(1.0 - hold_stall_prob_);
+      } else {
+        // The tic() that ends a stall is itself a running cycle
+        left_ = 1 + Draw(stall_prob_);
+      }
+    }
+    left_--;
+    if (stalled_) stats_->stall_cycles++;
+    return stalled_;
+  }
+
+  const std::string& name() const { return name_; }
+  const Stats& GetStats() const { return *stats_; }
+
+  static std::map<std::string, Stats>& AllStats() {
+    static std::map<std::string, Stats> stats;
+    static bool report_registered = false;
+    if (!report_registered) {
+      report_registered = true;
+      if (std::getenv("NVHLS_PACER_STATS") != NULL) atexit(PrintAllStatsAtExit);
+    }
+    return stats;
+  }
+
+  static void PrintAllStats(std::ostream& os = std::cout) {
+    std::map<std::string, Stats>& stats = AllStats();
+    for (std::map<std::string, Stats>::iterator it = stats.begin(); it != stats.end(); ++it) {
+      const Stats& s = it->second;
+      if (s.cycles == 0) continue;  // e.g. temporaries copied and renamed
+      os << "PACER " << it->first << " cycles=" << s.cycles
+         << " stall_cycles=" << s.stall_cycles << " stalls=" << s.stalls
+         << " draws=" << s.draws << " stall_rate="
+         << (s.cycles ? static_cast<double>(s.stall_cycles) / s.cycles : 0.0) << std::endl;
+    }
+  }
+
+ private:
+  static const uint64 kForever = ~static_cast<uint64>(0) >> 1;
+
+  float stall_prob_;
+  float hold_stall_prob_;
+  RandStream rng_;
+  std::string name_;
+  Stats* stats_;
+  bool stalled_;
+  uint64 left_;
+
+  static void PrintAllStatsAtExit() { PrintAllStats(std::cout); }
+
+  // Number of failures before the first success of probability p
+  uint64 Draw(double p) {
+    if (p >= 1.0) return 0;
+    if (p <= 0.0) return kForever;
+    stats_->draws++;
+    double u = (static_cast<double>(rng_.next() >> 11) + 1.0) / 9007199254740992.0;
+    double n = std::floor(std::log(u) / std::log1p(-p));
+    if (n >= static_cast<double>(kForever)) return kForever;
+    return static_cast<uint64>(n);
+  }
+};
+
+}  // namespace nvhls
 
 #endif // PACER_H_
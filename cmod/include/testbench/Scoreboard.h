@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SCOREBOARD_H_
+#define SCOREBOARD_H_
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace nvhls {
+
+// Describes how an observed value differs from the expected one in the
+// reports of AsyncScoreboard.  Overload it for output types without
+// operator<<.
+template <typename T>
+void scoreboard_diff(std::ostream& os, const T& expected, const T& observed) {
+  os << "is " << observed << ", expected " << expected;
+}
+
+template <typename T>
+void scoreboard_diff(std::ostream& os, const std::vector<T>& expected,
+                     const std::vector<T>& observed) {
+  if (expected.size() != observed.size()) {
+    os << "has " << observed.size() << " elements, expected " << expected.size();
+    return;
+  }
+  for (unsigned i = 0; i < expected.size(); i++) {
+    if (!(expected[i] == observed[i])) {
+      os << "element " << i << " ";
+      scoreboard_diff(os, expected[i], observed[i]);
+      return;
+    }
+  }
+}
+
+/**
+ * \brief A scoreboard that runs the golden model of a testbench on worker threads
+ * \ingroup Scoreboard
+ *
+ * \tparam Input  Everything the golden model needs to compute one expected output
+ * \tparam Output Output of the DUT; needs operator== and scoreboard_diff()
+ *
+ * \par Overview
+ * A testbench hands each observed DUT output to Check() together with the input it was computed
+ * from and the cycle at which it was observed.  Check() only queues the pair and returns: a pool of
+ * worker threads runs the golden model on the queued inputs and compares its results with the
+ * observed outputs while the simulation goes on.  Finish(), at the end of the test, waits for the
+ * queue to drain, joins the workers and reports the mismatches in the order of the Check() calls,
+ * each with its check number and cycle stamp, so the report does not depend on the number of
+ * threads:
+ *
+ * \code
+ * ERROR: <name>: check <n> at cycle <cycle>: <scoreboard_diff>
+ * SCOREBOARD <name> checks=<n> errors=<n> threads=<n>
+ * \endcode
+ *
+ * The model is called concurrently on different inputs, so it must not touch shared state: it
+ * cannot draw from rand() or nvhls::get_rand(), and the simulation thread must not change what an
+ * Input refers to after Check().  A model with state, like the reference memory of a memory test,
+ * can still run off the simulation thread with a single worker, which runs the checks in order.
+ *
+ * The number of workers defaults to the number of hardware threads and can be set in the
+ * constructor or with the NVHLS_SCOREBOARD_THREADS environment variable.  The workers start at the
+ * first Check().
+ *
+ * \par A Simple Example
+ * \code
+ *      #include <testbench/Scoreboard.h>
+ *
+ *      struct GemmJob { unsigned m, n, k; std::vector<int> a, b; };
+ *      std::vector<int> Gemm(const GemmJob& job);   // the golden model
+ *
+ *      nvhls::AsyncScoreboard<GemmJob, std::vector<int> > sb("gemm", Gemm);
+ *      ...
+ *      sb.Check(job, observed_c, cycle);            // in the testbench thread
+ *      ...
+ *      if (sb.Finish() != 0) ...                    // at the end of the test
+ * \endcode
+ * \par
+ *
+ */
+template <typename Input, typename Output>
+class AsyncScoreboard {
+ public:
+  typedef std::function<Output(const Input&)> Model;
+
+  AsyncScoreboard(const std::string& name, Model model, unsigned int num_threads = 0)
+      : name_(name),
+        model_(model),
+        num_threads_(num_threads),
+        checks_(0),
+        errors_(0),
+        stop_(false) {
+    const char* env_threads = std::getenv("NVHLS_SCOREBOARD_THREADS");
+    if (num_threads_ == 0 && env_threads != NULL) num_threads_ = std::atoi(env_threads);
+    if (num_threads_ == 0) num_threads_ = std::thread::hardware_concurrency();
+    if (num_threads_ == 0) num_threads_ = 1;
+  }
+
+  ~AsyncScoreboard() { Join(); }
+
+  // Queues the check of one observed output; does not wait for the model
+  void Check(const Input& input, const Output& observed, uint64_t cycle) {
+    if (workers_.empty()) {
+      stop_ = false;
+      for (unsigned int i = 0; i < num_threads_; i++)
+        workers_.push_back(std::thread(&AsyncScoreboard::Work, this));
+    }
+    Job job = {checks_++, cycle, input, observed};
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jobs_.push_back(job);
+    }
+    cv_.notify_one();
+  }
+
+  // Waits for all queued checks, reports the mismatches not reported yet to os and returns the
+  // number of mismatches of all checks so far
+  unsigned long Finish(std::ostream& os = std::cout) {
+    Join();
+    std::sort(mismatches_.begin(), mismatches_.end());
+    for (unsigned int i = 0; i < mismatches_.size(); i++) os << mismatches_[i].report;
+    mismatches_.clear();
+    os << std::dec << "SCOREBOARD " << name_ << " checks=" << checks_ << " errors=" << errors_
+       << " threads=" << num_threads_ << std::endl;
+    return errors_;
+  }
+
+  unsigned long Checks() const { return checks_; }
+  unsigned int NumThreads() const { return num_threads_; }
+
+ private:
+  struct Job {
+    uint64_t index;
+    uint64_t cycle;
+    Input input;
+    Output observed;
+  };
+
+  struct Mismatch {
+    uint64_t index;
+    std::string report;
+    bool operator<(const Mismatch& other) const { return index < other.index; }
+  };
+
+  void Work() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      cv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+      if (jobs_.empty()) return;
+      Job job = jobs_.front();
+      jobs_.pop_front();
+      lock.unlock();
+      Output expected = model_(job.input);
+      bool match = (expected == job.observed);
+      Mismatch m;
+      if (!match) {
+        std::ostringstream report;
+        report << "ERROR: " << name_ << ": check " << job.index << " at cycle " << job.cycle
+               << ": ";
+        scoreboard_diff(report, expected, job.observed);
+        report << std::endl;
+        m.index = job.index;
+        m.report = report.str();
+      }
+      lock.lock();
+      if (!match) {
+        errors_++;
+        mismatches_.push_back(m);
+      }
+    }
+  }
+
+  void Join() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (unsigned int i = 0; i < workers_.size(); i++) workers_[i].join();
+    workers_.clear();
+  }
+
+  std::string name_;
+  Model model_;
+  unsigned int num_threads_;
+  uint64_t checks_;
+  unsigned long errors_;
+  bool stop_;
+  std::deque<Job> jobs_;
+  std::vector<Mismatch> mismatches_;
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+}  // namespace nvhls
+
+#endif  // SCOREBOARD_H_
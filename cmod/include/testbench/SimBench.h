@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SIMBENCH_H_
+#define SIMBENCH_H_
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_module.h>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+/**
+ * \brief Simulation throughput measurement for the cmod benchmarks
+ * \ingroup SimBench
+ *
+ * \par Overview
+ * SimBench times a window of simulation in wall-clock seconds and reports the simulated cycles and
+ * messages per wall-second.  The window spans from Start() to Stop(), so elaboration and reset are
+ * not included.  The report is a single line of the form
+ *
+ * \code
+ * BENCH <name> sim_mode=<0|1|2> cycles=<n> msgs=<n> wall_s=<t> cycles_per_s=<r> msgs_per_s=<r>
+ * \endcode
+ *
+ * which cmod/benchmarks/Makefile collects into a summary.  The window length in cycles is taken from
+ * the BENCH_CYCLES environment variable if set, otherwise from the BENCH_CYCLES define, otherwise from
+ * the default passed to NumCycles().
+ *
+ * BenchSource and BenchSink are free-running endpoints that push a new message and pop a message in
+ * every cycle in which the channel allows it.
+ */
+class SimBench {
+ public:
+  SimBench(const std::string& name_, const sc_time& period_ = sc_time(1, SC_NS))
+      : name(name_), period(period_), msgs(0), running(false) {}
+
+  // Simulation mode this binary was compiled for, following SIM_MODE of cmod_Makefile
+  static int SimMode() {
+#if defined(CONNECTIONS_FAST_SIM)
+    return 2;
+#elif defined(CONNECTIONS_ACCURATE_SIM)
+    return 1;
+#else
+    return 0;
+#endif
+  }
+
+  static unsigned long NumCycles(unsigned long dflt) {
+    unsigned long cycles = dflt;
+#ifdef BENCH_CYCLES
+    cycles = BENCH_CYCLES;
+#endif
+    const char* env_cycles = std::getenv("BENCH_CYCLES");
+    if (env_cycles != NULL) cycles = std::strtoul(env_cycles, NULL, 10);
+    return cycles;
+  }
+
+  void Start() {
+    start_sim = sc_time_stamp();
+    start_wall = std::chrono::steady_clock::now();
+    msgs = 0;
+    running = true;
+  }
+
+  void Stop() {
+    stop_sim = sc_time_stamp();
+    stop_wall = std::chrono::steady_clock::now();
+    running = false;
+  }
+
+  void AddMsgs(unsigned long n = 1) {
+    if (running) msgs += n;
+  }
+
+  unsigned long Cycles() const {
+    return static_cast<unsigned long>((stop_sim - start_sim) / period);
+  }
+
+  unsigned long Msgs() const { return msgs; }
+
+  double WallSeconds() const {
+    return std::chrono::duration<double>(stop_wall - start_wall).count();
+  }
+
+  void Report(std::ostream& os = std::cout) const {
+    double wall = WallSeconds();
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << "BENCH " << name << " sim_mode=" << SimMode() << " cycles=" << Cycles()
+       << " msgs=" << msgs << std::fixed << std::setprecision(3) << " wall_s=" << wall
+       << std::setprecision(0) << " cycles_per_s=" << (wall > 0 ? Cycles() / wall : 0)
+       << " msgs_per_s=" << (wall > 0 ? msgs / wall : 0) << std::endl;
+    os.flags(flags);
+    os.precision(precision);
+  }
+
+ private:
+  std::string name;
+  sc_time period;
+  unsigned long msgs;
+  bool running;
+  sc_time start_sim, stop_sim;
+  std::chrono::steady_clock::time_point start_wall, stop_wall;
+};
+
+/**
+ * \brief A source that pushes gen(i) for i = 0, 1, ... as fast as the channel accepts messages
+ * \ingroup SimBench
+ */
+template <typename T>
+class BenchSource : public sc_module {
+ public:
+  typedef T (*Gen)(unsigned long);
+
+  sc_in<bool> clk;
+  sc_in<bool> rst;
+  Connections::Out<T> out;
+
+  SC_HAS_PROCESS(BenchSource);
+  BenchSource(sc_module_name name_, Gen gen_)
+      : sc_module(name_), clk("clk"), rst("rst"), out("out"), gen(gen_) {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+ protected:
+  Gen gen;
+
+  void run() {
+    out.Reset();
+    unsigned long i = 0;
+    T msg = gen(i);
+    while (1) {
+      wait();
+      if (out.PushNB(msg)) {
+        msg = gen(++i);
+      }
+    }
+  }
+};
+
+/**
+ * \brief A sink that pops a message every cycle and counts it in a SimBench
+ * \ingroup SimBench
+ */
+template <typename T>
+class BenchSink : public sc_module {
+ public:
+  sc_in<bool> clk;
+  sc_in<bool> rst;
+  Connections::In<T> in;
+
+  SC_HAS_PROCESS(BenchSink);
+  BenchSink(sc_module_name name_, SimBench& bench_)
+      : sc_module(name_), clk("clk"), rst("rst"), in("in"), bench(bench_) {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+ protected:
+  SimBench& bench;
+
+  void run() {
+    in.Reset();
+    T msg;
+    while (1) {
+      wait();
+      if (in.PopNB(msg)) {
+        bench.AddMsgs();
+      }
+    }
+  }
+};
+
+#endif // SIMBENCH_H_
@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STREAMBENCH_H_
+#define STREAMBENCH_H_
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_module.h>
+#include <nvhls_assert.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace nvhls {
+
+/**
+ * \brief Latency and throughput summary of one stream of messages
+ * \ingroup StreamBench
+ *
+ * \par Overview
+ * StreamStats collects the receive cycle and the latency in cycles of every message of a stream and
+ * reports them as a single line of the form
+ *
+ * \code
+ * STREAM <name> msgs=<n> cycles=<n> throughput=<msgs/cycle> lat_min=<n> lat_avg=<r> lat_p50=<n>
+ *        lat_p99=<n> lat_max=<n> errors=<n>
+ * \endcode
+ *
+ * The cycle count spans from the first to the last received message, so the reported throughput is
+ * the steady-state rate of the stream and does not include the time to fill the pipeline.
+ */
+class StreamStats {
+ public:
+  StreamStats() : first(0), last(0), errors(0) {}
+
+  void Clear() {
+    latency.clear();
+    first = last = 0;
+    errors = 0;
+  }
+
+  void Add(unsigned long cycle, unsigned long lat) {
+    if (latency.empty()) first = cycle;
+    last = cycle;
+    latency.push_back(lat);
+  }
+
+  void AddError() { errors++; }
+
+  unsigned long Msgs() const { return latency.size(); }
+  unsigned long Errors() const { return errors; }
+  unsigned long Cycles() const { return latency.empty() ? 0 : last - first + 1; }
+
+  double Throughput() const {
+    return Cycles() ? static_cast<double>(Msgs()) / Cycles() : 0.0;
+  }
+
+  unsigned long LatencyMin() const {
+    return latency.empty() ? 0 : *std::min_element(latency.begin(), latency.end());
+  }
+
+  unsigned long LatencyMax() const {
+    return latency.empty() ? 0 : *std::max_element(latency.begin(), latency.end());
+  }
+
+  double LatencyMean() const {
+    if (latency.empty()) return 0.0;
+    double sum = 0;
+    for (unsigned long i = 0; i < latency.size(); i++) sum += latency[i];
+    return sum / latency.size();
+  }
+
+  // Nearest-rank percentile, p in [0, 100]
+  unsigned long LatencyPercentile(double p) const {
+    if (latency.empty()) return 0;
+    std::vector<unsigned long> sorted(latency);
+    unsigned long rank = static_cast<unsigned long>(p / 100.0 * sorted.size() + 0.5);
+    rank = std::min<unsigned long>(std::max<unsigned long>(rank, 1), sorted.size()) - 1;
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank];
+  }
+
+  void Report(const std::string& name, std::ostream& os = std::cout) const {
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << std::dec << "STREAM " << name << " msgs=" << Msgs() << " cycles=" << Cycles()
+       << std::fixed << std::setprecision(3) << " throughput=" << Throughput()
+       << " lat_min=" << LatencyMin() << " lat_avg=" << LatencyMean()
+       << " lat_p50=" << LatencyPercentile(50) << " lat_p99=" << LatencyPercentile(99)
+       << " lat_max=" << LatencyMax() << " errors=" << errors << std::endl;
+    os.flags(flags);
+    os.precision(precision);
+  }
+
+ private:
+  std::vector<unsigned long> latency;
+  unsigned long first, last;
+  unsigned long errors;
+};
+
+/**
+ * \brief A source that injects a preloaded vector of messages at a configurable rate
+ * \ingroup StreamBench
+ *
+ * \tparam T Message type
+ *
+ * \par Overview
+ * StreamSource starts after reset and makes messages due at \a rate messages per cycle, in (0, 1].
+ * With rate 1 a message is due every cycle; with rate 0.25 every fourth cycle.  Due messages are
+ * pushed in order with PushNB() as soon as the channel accepts them, so back-pressure delays a
+ * message but does not lower the offered load.  The cycle at which each message became due is kept
+ * and is the start of the latency a StreamSink measures.
+ *
+ * Cycles are counted from the first clock edge after reset, in the same way in StreamSource and
+ * StreamSink, so both must be on the same clock and reset.
+ *
+ * \par A Simple Example
+ * \code
+ *      nvhls::StreamSource<Data> src("src", msgs, 0.5);
+ *      nvhls::StreamSink<Data> sink("sink");
+ *      ...
+ *      sink.Expect(msgs);
+ *      sink.SetSource(src);
+ * \endcode
+ */
+template <typename T>
+class StreamSource : public sc_module {
+ public:
+  sc_in<bool> clk;
+  sc_in<bool> rst;
+  Connections::Out<T> out;
+
+  SC_HAS_PROCESS(StreamSource);
+  StreamSource(sc_module_name name_, const std::vector<T>& msgs_ = std::vector<T>(),
+               double rate_ = 1.0)
+      : sc_module(name_), clk("clk"), rst("rst"), out("out"), msgs(msgs_), sent(0) {
+    SetRate(rate_);
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  // Appends messages to the stimulus; must be called before reset is released
+  void Load(const std::vector<T>& msgs_) { msgs.insert(msgs.end(), msgs_.begin(), msgs_.end()); }
+
+  void SetRate(double rate_) {
+    NVHLS_ASSERT_MSG(rate_ > 0.0 && rate_ <= 1.0, "StreamSource rate must be in (0, 1]");
+    rate = rate_;
+  }
+
+  unsigned long Size() const { return msgs.size(); }
+  unsigned long Sent() const { return sent; }
+  bool Done() const { return sent == msgs.size(); }
+
+  // Cycle at which message i became due; valid once the message is due
+  unsigned long DueCycle(unsigned long i) const { return due[i]; }
+
+ protected:
+  std::vector<T> msgs;
+  std::vector<unsigned long> due;
+  double rate;
+  unsigned long sent;
+
+  void run() {
+    out.Reset();
+    due.clear();
+    sent = 0;
+    unsigned long cycle = 0;
+    double credit = 0;
+    while (1) {
+      wait();
+      cycle++;
+      if (due.size() < msgs.size()) {
+        credit += rate;
+        if (credit >= 1.0) {
+          credit -= 1.0;
+          due.push_back(cycle);
+        }
+      }
+      if (sent < due.size() && out.PushNB(msgs[sent])) {
+        sent++;
+      }
+    }
+  }
+};
+
+/**
+ * \brief A sink that pops messages at a configurable rate and reports latency and throughput
+ * \ingroup StreamBench
+ *
+ * \tparam T Message type
+ *
+ * \par Overview
+ * StreamSink pops at most one message per cycle and is ready in a fraction \a rate, in (0, 1], of
+ * the cycles.  Every received message is timestamped.  If a StreamSource is
+ * set with SetSource(), the latency of message i is its receive cycle minus the cycle at which the
+ * source made it due, which assumes that the design under test keeps the order of the stream.
+ * Without a source the latency is reported as 0.
+ *
+ * If expected messages are given with Expect(), every received message is compared against them,
+ * mismatches are counted as errors, and sc_stop() is called once all of them arrived.  The summary
+ * of StreamStats is printed at the end of the simulation, and Stats() gives access to it from the
+ * testbench.
+ */
+template <typename T>
+class StreamSink : public sc_module {
+ public:
+  sc_in<bool> clk;
+  sc_in<bool> rst;
+  Connections::In<T> in;
+
+  SC_HAS_PROCESS(StreamSink);
+  StreamSink(sc_module_name name_, double rate_ = 1.0)
+      : sc_module(name_), clk("clk"), rst("rst"), in("in"), rate(1.0), src(NULL), stop(true) {
+    SetRate(rate_);
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void Expect(const std::vector<T>& msgs_, bool stop_ = true) {
+    expected = msgs_;
+    stop = stop_;
+  }
+
+  void SetSource(const StreamSource<T>& src_) { src = &src_; }
+
+  void SetRate(double rate_) {
+    NVHLS_ASSERT_MSG(rate_ > 0.0 && rate_ <= 1.0, "StreamSink rate must be in (0, 1]");
+    rate = rate_;
+  }
+
+  const StreamStats& Stats() const { return stats; }
+
+ protected:
+  std::vector<T> expected;
+  double rate;
+  const StreamSource<T>* src;
+  bool stop;
+  StreamStats stats;
+
+  void run() {
+    in.Reset();
+    stats.Clear();
+    unsigned long cycle = 0;
+    double credit = 0;
+    while (1) {
+      wait();
+      cycle++;
+      credit = std::min(credit + rate, 1.0);
+      T msg;
+      if (credit >= 1.0 && in.PopNB(msg)) {
+        credit -= 1.0;
+        Receive(cycle, msg);
+      }
+    }
+  }
+
+  void Receive(unsigned long cycle, const T& msg) {
+    unsigned long i = stats.Msgs();
+    stats.Add(cycle, src ? cycle - src->DueCycle(i) : 0);
+    if (i < expected.size() && !(msg == expected[i])) {
+      std::cout << "FAILED: " << name() << " msg[" << i << "] != ref[" << i << "] (" << std::hex
+                << msg << " != " << expected[i] << std::dec << ")" << std::endl;
+      stats.AddError();
+    }
+    if (stop && i + 1 == expected.size()) {
+      sc_stop();
+    }
+  }
+
+  void end_of_simulation() { stats.Report(name()); }
+};
+
+}  // namespace nvhls
+
+#endif  // STREAMBENCH_H_
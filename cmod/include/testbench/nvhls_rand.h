@@ -21,8 +21,26 @@
 #include <nvhls_types.h>
 #include <mem_array.h>
 #include <TypeToBits.h>
+#include <string>
 
 namespace nvhls {
+
+// Seed recorded by set_random_seed(), read by RandStream
+inline bool& random_seed_set() {
+  static bool set = false;
+  return set;
+}
+
+inline unsigned int& random_seed_value() {
+  static unsigned int seed = 0;
+  return seed;
+}
+
+// Prints the simulated time at exit; see set_random_seed()
+inline void report_sim_time() {
+  cout << "NVHLS_SIM_TIME_PS " << sc_time_stamp().value() << endl;
+}
+
 /**
  * \brief Set random seed 
  * \ingroup set_random_seed
@@ -33,6 +51,9 @@ namespace nvhls {
  *        -# The setting of the RAND_SEED CFLAG at compile time (or via #define in a source file)
  *        -# A random seed based on the unix timestamp at runtime
  *
+ *      If the NVHLS_REPORT_SIM_TIME environment variable is set, the simulated time in ps is printed at exit as
+ *      "NVHLS_SIM_TIME_PS <time>", which regress_matrix.py uses to compute simulation speed.
+ *
  *      WARNING: The RAND_SEED will be overriden in cosimulation, causing SCVerify to always simulate with an
  *      effective seed of 0.  To work around this, call set_random_seed() inside an SC_THREAD instead of in sc_main.
  *
@@ -66,6 +87,13 @@ inline int set_random_seed() {
   const char* env_rand_seed = std::getenv("RAND_SEED");
   if (env_rand_seed != NULL) seed = atoi(env_rand_seed);
   srand(seed);
+  random_seed_value() = seed;
+  random_seed_set() = true;
+  static bool report_registered = false;
+  if (std::getenv("NVHLS_REPORT_SIM_TIME") != NULL && !report_registered) {
+    atexit(report_sim_time);
+    report_registered = true;
+  }
   cout << "================================" << endl;
   cout << dec << "SETTING RANDOM SEED = " << seed << endl;
   cout << "================================" << endl;
@@ -130,5 +158,131 @@ NVUINTW(bitwidth) get_rand() {
   return random;
 }
 
+/**
+ * \brief Reproducible random stream of one testbench component
+ * \ingroup set_random_seed
+ *
+ * \par Overview
+ *      A xoshiro256** generator whose state is derived, through splitmix64, from the seed and a stream name,
+ *      usually the hierarchical name of the component that owns it.  The default seed is the one chosen by
+ *      set_random_seed(), or the RAND_SEED environment variable and then the RAND_SEED define if
+ *      set_random_seed() has not been called (1 if neither is set).
+ *
+ *      Unlike rand(), each component draws from its own stream: adding, removing or reordering components does
+ *      not change the stimulus of the others, and streams can be drawn from concurrently.  The same seed and
+ *      name always give the same sequence on every platform.
+ *
+ *      RandStream is a uniform random bit generator, so it also works with the standard and Boost
+ *      distributions.
+ *
+ * \par A Simple Example
+ * \code
+ *   #include <nvhls_rand.h>
+ *
+ *   SC_MODULE(Source) {
+ *     nvhls::RandStream rng;
+ *     SC_CTOR(Source) : rng(name()) { ... }
+ *     void run() {
+ *       ...
+ *       NVUINTW(12) addr = rng.get_rand<12>();
+ *       payload_t data = rng.gen_random_payload<payload_t>();
+ *       if (rng.uniform(10) < 3) { ... }  // 30% of the time
+ *     }
+ *   };
+ *
+ * \endcode
+ * \par
+ *
+ */
+class RandStream {
+ public:
+  typedef uint64 result_type;
+
+  explicit RandStream(const std::string& name) { seed(default_seed(), name); }
+  RandStream(uint64 seed_value, const std::string& name) { seed(seed_value, name); }
+
+  void seed(uint64 seed_value, const std::string& name) {
+    // FNV-1a hash of the name, mixed with the seed
+    uint64 h = 0xcbf29ce484222325ull;
+    for (std::string::size_type i = 0; i < name.size(); i++) {
+      h = (h ^ static_cast<unsigned char>(name[i])) * 0x100000001b3ull;
+    }
+    uint64 x = seed_value ^ (h * 0x9e3779b97f4a7c15ull);
+    for (int i = 0; i < 4; i++) {
+      s_[i] = splitmix64(x);
+    }
+  }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return ~static_cast<result_type>(0); }
+
+  // 64 random bits
+  result_type operator()() { return next(); }
+
+  result_type next() {
+    uint64 result = rotl(s_[1] * 5, 7) * 9;
+    uint64 t = s_[1] << 17;
+    s_[2] ^= s_[0];
+    s_[3] ^= s_[1];
+    s_[1] ^= s_[2];
+    s_[0] ^= s_[3];
+    s_[2] ^= t;
+    s_[3] = rotl(s_[3], 45);
+    return result;
+  }
+
+  // Uniform integer in [0, n), for n < 2^32
+  unsigned int uniform(unsigned int n) {
+    return static_cast<unsigned int>(((next() >> 32) * n) >> 32);
+  }
+
+  // Fills out[0..n-1] with random words
+  void fill(uint64* out, unsigned int n) {
+    for (unsigned int i = 0; i < n; i++) {
+      out[i] = next();
+    }
+  }
+
+  template <int bitwidth>
+  NVUINTW(bitwidth) get_rand() {
+    NVUINTW(bitwidth) random = NVUINTW(bitwidth)(next());
+    // Only wide types shift; a variable count avoids shift-width warnings
+    int shift = 64;
+    for (int i = 64; i < bitwidth; i += 64) {
+      random = (random << shift) | NVUINTW(bitwidth)(next());
+    }
+    return random;
+  }
+
+  template <typename Payload>
+  Payload gen_random_payload() {
+    return NVUINTToType<Payload>(get_rand<Wrapped<Payload>::width>());
+  }
+
+  // Seed of set_random_seed(), else the RAND_SEED environment variable or define, else 1
+  static uint64 default_seed() {
+    if (random_seed_set()) return random_seed_value();
+    const char* env_rand_seed = std::getenv("RAND_SEED");
+    if (env_rand_seed != NULL) return atoi(env_rand_seed);
+#ifdef RAND_SEED
+    return (RAND_SEED);
+#else
+    return 1;
+#endif
+  }
+
+ private:
+  uint64 s_[4];
+
+  static uint64 rotl(uint64 x, int k) { return (x << k) | (x >> (64 - k)); }
+
+  static uint64 splitmix64(uint64& x) {
+    uint64 z = (x += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+  }
+};
+
 }
 #endif
@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License")
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# This script runs a designs x seeds x modes regression of the cmod unittests
+# in parallel and writes a JSON summary with pass/fail, wall-clock time and
+# simulation speed of every run. It is normally invoked through
+# "make -f regress_Makefile matrix".
+#
+# Each mode (a SIM_MODE:RAND_STALL pair) gets its own copy of the cmod tree
+# under the work directory, so the designs of all modes build in parallel.
+# Every seed then runs in its own copy of the built design directory, as some
+# tests write files next to their binaries. Simulated time is taken from the
+# NVHLS_SIM_TIME_PS line that nvhls::set_random_seed() prints at exit when
+# NVHLS_REPORT_SIM_TIME is set.
+
+import argparse
+import json
+import os
+import re
+import shutil
+import socket
+import subprocess
+import sys
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+ROOT = os.path.dirname(os.path.abspath(__file__))
+SIM_TIME_RE = re.compile(r'^NVHLS_SIM_TIME_PS\s+(\d+)', re.M)
+
+
+def parse_mode(text):
+    sim_mode, _, rand_stall = text.partition(':')
+    return {'SIM_MODE': int(sim_mode), 'RAND_STALL': int(rand_stall or 0)}
+
+
+def mode_name(mode):
+    return 'SIM_MODE%d_RAND_STALL%d' % (mode['SIM_MODE'], mode['RAND_STALL'])
+
+
+def make_vars(mode):
+    # ROOT keeps submodules (e.g. rapidjson) pointing at the original tree
+    return ['SIM_MODE=%d' % mode['SIM_MODE'], 'RAND_STALL=%d' % mode['RAND_STALL'],
+            'ROOT=%s' % os.path.dirname(ROOT)]
+
+
+def ignore_outputs(work):
+    def ignore(path, names):
+        skip = [n for n in names if n.startswith('sim_') or n.endswith('.o')]
+        if os.path.abspath(path) == ROOT:
+            skip += [n for n in names if os.path.join(path, n) == work]
+        return skip
+    return ignore
+
+
+def run_cmd(cmd, cwd, log, env=None, timeout=None):
+    start = time.time()
+    with open(log, 'w') as f:
+        try:
+            rc = subprocess.call(cmd, cwd=cwd, stdout=f, stderr=subprocess.STDOUT,
+                                 env=env, timeout=timeout)
+        except subprocess.TimeoutExpired:
+            f.write('\nTIMEOUT after %d s\n' % timeout)
+            rc = None
+    return rc, time.time() - start
+
+
+def build(job):
+    rc, wall = run_cmd(['make'] + make_vars(job['mode']), job['dir'], job['log'])
+    job.update(status='pass' if rc == 0 else 'fail', wall_s=round(wall, 3))
+    return job
+
+
+def run(job, args):
+    shutil.rmtree(job['dir'], ignore_errors=True)
+    shutil.copytree(job['build_dir'], job['dir'], symlinks=True)
+    env = dict(os.environ, RAND_SEED=str(job['seed']), NVHLS_REPORT_SIM_TIME='1')
+    rc, wall = run_cmd(['make', 'run'] + make_vars(job['mode']), job['dir'], job['log'],
+                       env=env, timeout=args.timeout)
+    with open(job['log'], errors='replace') as f:
+        text = f.read()
+    sim_ps = sum(int(t) for t in SIM_TIME_RE.findall(text))
+    passed = rc == 0 and 'TESTBENCH FAIL' not in text
+    cycles = sim_ps / (args.clock_ns * 1000.0)
+    job.update(status='timeout' if rc is None else ('pass' if passed else 'fail'),
+               wall_s=round(wall, 3), sim_cycles=int(cycles),
+               cycles_per_s=round(cycles / wall, 1) if wall > 0 else 0)
+    if not args.keep:
+        shutil.rmtree(job['dir'], ignore_errors=True)
+    return job
+
+
+def public(job):
+    out = {'design': job['design'], 'sim_mode': job['mode']['SIM_MODE'],
+           'rand_stall': job['mode']['RAND_STALL']}
+    out.update((k, v) for k, v in job.items()
+               if k not in ('design', 'mode', 'dir', 'build_dir'))
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--designs', nargs='+', required=True, help='design directories relative to cmod')
+    parser.add_argument('-j', '--jobs', type=int, default=os.cpu_count(), help='parallel jobs')
+    parser.add_argument('--seeds', nargs='+', type=int, default=[1], help='RAND_SEED values')
+    parser.add_argument('--modes', nargs='+', default=['1:0'], help='SIM_MODE:RAND_STALL pairs')
+    parser.add_argument('--output', default='regress_summary.json', help='JSON summary file')
+    parser.add_argument('--work', default=os.path.join(ROOT, 'regress_work'), help='work directory')
+    parser.add_argument('--timeout', type=int, default=3600, help='timeout of each run in seconds')
+    parser.add_argument('--clock-ns', type=float, default=1.0, help='testbench clock period in ns')
+    parser.add_argument('--keep', action='store_true', help='keep the per-seed run directories')
+    args = parser.parse_args()
+
+    work = os.path.abspath(args.work)
+    modes = [parse_mode(m) for m in args.modes]
+    start = time.time()
+
+    shutil.rmtree(work, ignore_errors=True)
+    os.makedirs(os.path.join(work, 'logs'))
+    for mode in modes:
+        shutil.copytree(ROOT, os.path.join(work, mode_name(mode), 'cmod'),
+                        ignore=ignore_outputs(work), symlinks=True)
+
+    builds = []
+    for mode in modes:
+        for design in args.designs:
+            tag = '%s.%s' % (design.replace('/', '_'), mode_name(mode))
+            builds.append({'design': design, 'mode': mode,
+                           'dir': os.path.join(work, mode_name(mode), 'cmod', design),
+                           'log': os.path.join(work, 'logs', tag + '.build.log')})
+
+    with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        builds = list(pool.map(build, builds))
+
+        runs = []
+        for b in builds:
+            if b['status'] != 'pass':
+                continue
+            for seed in args.seeds:
+                tag = '%s.%s.seed%d' % (b['design'].replace('/', '_'), mode_name(b['mode']), seed)
+                runs.append({'design': b['design'], 'mode': b['mode'], 'seed': seed,
+                             'build_dir': b['dir'], 'dir': '%s.seed%d' % (b['dir'], seed),
+                             'log': os.path.join(work, 'logs', tag + '.log')})
+        runs = list(pool.map(lambda job: run(job, args), runs))
+
+    failed = [r for r in runs if r['status'] != 'pass']
+    summary = {
+        'timestamp': time.strftime('%Y-%m-%dT%H:%M:%S'),
+        'host': socket.gethostname(),
+        'jobs': args.jobs,
+        'seeds': args.seeds,
+        'modes': modes,
+        'wall_s': round(time.time() - start, 3),
+        'totals': {
+            'builds': len(builds),
+            'build_failures': sum(b['status'] != 'pass' for b in builds),
+            'runs': len(runs),
+            'run_failures': len(failed),
+            'sim_cycles': sum(r['sim_cycles'] for r in runs),
+            'run_wall_s': round(sum(r['wall_s'] for r in runs), 3),
+        },
+        'builds': [public(b) for b in builds],
+        'runs': [public(r) for r in runs],
+    }
+    with open(args.output, 'w') as f:
+        json.dump(summary, f, indent=2)
+
+    for b in builds:
+        if b['status'] != 'pass':
+            print('BUILD FAIL  %-45s %s  (%s)' % (b['design'], mode_name(b['mode']), b['log']))
+    for r in runs:
+        print('%-5s %-45s %s seed=%-4d %8.2f s %12.0f cycles/s' % (
+            r['status'].upper(), r['design'], mode_name(r['mode']), r['seed'],
+            r['wall_s'], r['cycles_per_s']))
+    t = summary['totals']
+    print('%d/%d runs passed, %d build failures, %.1f s wall; summary in %s' % (
+        t['runs'] - t['run_failures'], t['runs'], t['build_failures'], summary['wall_s'],
+        args.output))
+    return 1 if failed or t['build_failures'] else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -23,6 +23,10 @@
 #define NUM_ITERS 1000
 #endif
 
+#ifndef NUM_BENCH_CYCLES
+#define NUM_BENCH_CYCLES 24000
+#endif
+
 mask_t semi_random(const int& iter)
 {
     if (iter%17==0) 
@@ -71,21 +75,226 @@ mask_t reference_arbiter(const mask_t& valid)
               return iter;
       } while (i<=NUM_INPUTS);
     }
+    if (ARBITER_TYPE == Matrix) {
+      // least-recently-granted: order[0] has the highest priority
+      static int order[NUM_INPUTS];
+      static bool order_init = false;
+      if (!order_init) {
+          for (int i = 0; i < NUM_INPUTS; i++)
+              order[i] = i;
+          order_init = true;
+      }
+      if (valid == 0)
+          return 0;
+
+      for (int i = 0; i < NUM_INPUTS; i++) {
+          int idx = order[i];
+          if (valid[idx] == 1) {
+              for (int j = i; j < NUM_INPUTS - 1; j++)
+                  order[j] = order[j + 1];
+              order[NUM_INPUTS - 1] = idx;
+              mask_t result = 0;
+              result[idx] = 1;
+              return result;
+          }
+      }
+    }
     assert(0); // should never get here, valid!=0 but nothing was sellected
     return 0;
 }
 
+// Properties every arbiter must satisfy: the grant is one-hot, a subset of
+// valid, and non-zero whenever valid is non-zero.
+void check_grant(const mask_t& valid, const mask_t& select)
+{
+    assert((select & ~valid) == 0);
+    assert((select & (select - 1)) == 0);
+    assert((valid == 0) == (select == 0));
+}
+
+// Throughput-fairness benchmark: all requesters are saturated and each
+// requester's share of the granted cost units must match its weight share.
+static const unsigned int kBenchInputs = 4;
+static const unsigned int kBenchWeights[kBenchInputs] = {1, 2, 4, 8};
+
+template <typename arb_t>
+void set_bench_weights(arb_t& arb)
+{
+    for (unsigned i = 0; i < kBenchInputs; i++) {
+        arb.set_weight(i, kBenchWeights[i]);
+    }
+    arb.reset();
+}
+
+// Roundrobin and Matrix have no weights, every requester expects an equal share
+void set_bench_weights(Arbiter<kBenchInputs, Roundrobin>& arb) {}
+void set_bench_weights(Arbiter<kBenchInputs, Matrix>& arb) {}
+
+template <typename arb_t>
+typename arb_t::Mask bench_pick(arb_t& arb, const typename arb_t::Mask& valid, const unsigned cost[kBenchInputs])
+{
+    return arb.pick(valid);
+}
+
+typedef Arbiter<kBenchInputs, DeficitRoundRobin> drr_bench_t;
+drr_bench_t::Mask bench_pick(drr_bench_t& arb, const drr_bench_t::Mask& valid, const unsigned cost[kBenchInputs])
+{
+    drr_bench_t::Weight cost_w[kBenchInputs];
+    for (unsigned i = 0; i < kBenchInputs; i++) {
+        cost_w[i] = cost[i];
+    }
+    return arb.pick(valid, cost_w);
+}
+
+template <arbiter_type Type>
+void run_fairness_benchmark(const char* name, bool weighted, bool random_cost)
+{
+    typedef Arbiter<kBenchInputs, Type> arb_t;
+    arb_t arb;
+    set_bench_weights(arb);
+
+    unsigned long long served[kBenchInputs] = {0};
+    unsigned long long total = 0, busy_cycles = 0;
+    unsigned cost[kBenchInputs];
+    for (unsigned i = 0; i < kBenchInputs; i++) {
+        cost[i] = random_cost ? (1 + rand() % 8) : 1;
+    }
+    typename arb_t::Mask valid = ~static_cast<typename arb_t::Mask>(0);
+
+    for (int cycle = 0; cycle < NUM_BENCH_CYCLES; cycle++) {
+        typename arb_t::Mask select = bench_pick(arb, valid, cost);
+        for (unsigned i = 0; i < kBenchInputs; i++) {
+            if (select[i] == 1) {
+                served[i] += cost[i];
+                total += cost[i];
+                ++busy_cycles;
+                // next packet of this requester
+                cost[i] = random_cost ? (1 + rand() % 8) : 1;
+            }
+        }
+    }
+
+    unsigned weight_sum = 0;
+    for (unsigned i = 0; i < kBenchInputs; i++) {
+        weight_sum += weighted ? kBenchWeights[i] : 1;
+    }
+    DCOUT(name << (random_cost ? " (random cost)" : "") << ": grant cycles "
+          << (100.0 * busy_cycles / NUM_BENCH_CYCLES) << "%" << endl);
+    for (unsigned i = 0; i < kBenchInputs; i++) {
+        double expected = (weighted ? kBenchWeights[i] : 1) / static_cast<double>(weight_sum);
+        double measured = served[i] / static_cast<double>(total);
+        DCOUT("  requester " << i << ": expected share " << expected
+              << " measured share " << measured << endl);
+        assert(measured > expected - 0.02 && measured < expected + 0.02);
+    }
+}
+
+// Compare the simulation-only pick_host() against the synthesizable
+// pick_hls() on random valid masks. Both arbiters must produce identical
+// grants every cycle.
+template <unsigned int N>
+void check_host_pick_equivalence()
+{
+    typedef Arbiter<N, Roundrobin> arb_t;
+    arb_t arb_hls, arb_host;
+    for (int i = 0; i < NUM_ITERS; i++) {
+        typename arb_t::Mask valid = 0;
+        if (i % 17 != 0) {
+            valid = nvhls::get_rand<N>();
+            if (i % 5 == 0) {
+                // sparse masks exercise the wrap-around path
+                valid &= nvhls::get_rand<N>() & nvhls::get_rand<N>();
+            }
+        }
+        typename arb_t::Mask ref = arb_hls.pick_hls(valid);
+        typename arb_t::Mask dut = arb_host.pick_host(valid);
+        if (ref != dut) {
+            DCOUT("pick_host mismatch: size=" << N << " iter=" << i << " valid=" << valid
+                  << " pick_hls=" << ref << " pick_host=" << dut << endl);
+            assert(0);
+        }
+    }
+}
+
+// LockableArbiter: requesters send packets of random length and the grant
+// is held from the header to the tail of every packet, with random bubbles.
+// The held requester must keep the grant, nothing may be granted in a
+// bubble, and a plain Arbiter fed the same requests in the cycles without
+// hold must make the same grants, since a held grant does not update the
+// priorities.
+template <arbiter_type Type>
+void check_lockable_arbiter()
+{
+    const unsigned N = 4;
+    typedef LockableArbiter<N, Type> arb_t;
+    typedef typename arb_t::Mask mask;
+    arb_t arb;
+    Arbiter<N, Type> ref;
+    unsigned flits_left[N] = {0};
+    bool held = false;
+    mask owner = 0;
+    for (int i = 0; i < NUM_ITERS; i++) {
+        mask valid = 0;
+        for (unsigned r = 0; r < N; r++) {
+            if (flits_left[r] == 0 && rand() % 2 == 0) {
+                flits_left[r] = 1 + rand() % 5;
+            }
+            // bubbles of the packet in progress
+            if (flits_left[r] != 0 && rand() % 4 != 0) {
+                valid[r] = 1;
+            }
+        }
+        mask select = arb.pick(valid, held);
+        if (held) {
+            assert(select == (owner & valid));
+        } else {
+            assert(select == ref.pick(valid));
+            check_grant(valid, select);
+        }
+        assert(arb.last_grant() == (select != 0 ? select : owner));
+        for (unsigned r = 0; r < N; r++) {
+            if (select[r] == 1) {
+                owner = select;
+                held = (--flits_left[r] != 0);
+            }
+        }
+    }
+}
+
 CCS_MAIN(int argc, char *argv[]) { 
     nvhls::set_random_seed();
     mask_t valid,select,ref;
 
     for (int i = 0; i< NUM_ITERS; i++) {
         valid = semi_random(i);
-        ref = reference_arbiter(valid);
         CCS_DESIGN(ArbiterTop)(valid, select);
-        assert(ref == select);
+        if (ARBITER_TYPE == Roundrobin || ARBITER_TYPE == Static || ARBITER_TYPE == Matrix) {
+            ref = reference_arbiter(valid);
+            assert(ref == select);
+        } else {
+            check_grant(valid, select);
+        }
     }
 
+    run_fairness_benchmark<Roundrobin>("Roundrobin", false, false);
+    run_fairness_benchmark<Weighted>("Weighted", true, false);
+    run_fairness_benchmark<DeficitRoundRobin>("DeficitRoundRobin", true, false);
+    run_fairness_benchmark<DeficitRoundRobin>("DeficitRoundRobin", true, true);
+    run_fairness_benchmark<Matrix>("Matrix", false, false);
+
+    check_host_pick_equivalence<2>();
+    check_host_pick_equivalence<3>();
+    check_host_pick_equivalence<5>();
+    check_host_pick_equivalence<16>();
+    check_host_pick_equivalence<31>();
+    check_host_pick_equivalence<63>();
+    check_host_pick_equivalence<64>();
+
+    check_lockable_arbiter<Roundrobin>();
+    check_lockable_arbiter<Static>();
+    check_lockable_arbiter<Weighted>();
+    check_lockable_arbiter<Matrix>();
+
     DCOUT("CMODEL PASS" << endl);
     CCS_RETURN(0) ;
 }
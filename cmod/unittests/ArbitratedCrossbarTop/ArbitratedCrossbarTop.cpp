@@ -22,8 +22,14 @@ void ArbitratedCrossbarTop(DataInArray data_in, OutputIdxArray dest_in,
            ValidInArray valid_in, DataOutArray data_out,
            ValidOutArray valid_out, ReadyArray ready) {
   // Instantiate DUT and reset it
+#ifdef VOQ_ISLIP_ITERS
+  static VOQArbitratedCrossbar<Word_t, NUM_INPUTS, NUM_OUTPUTS,
+                               LEN_INPUT_BUFFER, LEN_OUTPUT_BUFFER, VOQ_ISLIP_ITERS> dut;
+#else
   static ArbitratedCrossbar<Word_t, NUM_INPUTS, NUM_OUTPUTS,
-                              LEN_INPUT_BUFFER, LEN_OUTPUT_BUFFER> dut;
+                              LEN_INPUT_BUFFER, LEN_OUTPUT_BUFFER, ARBITER_TYPE,
+                              PIPELINE_STAGES, SPEEDUP> dut;
+#endif
   Word_t data_in_local[NUM_INPUTS];
   OutputIdx dest_in_local[NUM_INPUTS];
   bool valid_in_local[NUM_INPUTS];
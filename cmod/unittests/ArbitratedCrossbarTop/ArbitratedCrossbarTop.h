@@ -37,6 +37,21 @@ typedef NVUINT16 Word_t;
 #define LEN_OUTPUT_BUFFER 2
 #endif
 
+#ifndef ARBITER_TYPE
+#define ARBITER_TYPE Roundrobin
+#endif
+
+#ifndef PIPELINE_STAGES
+#define PIPELINE_STAGES 0
+#endif
+
+#ifndef SPEEDUP
+#define SPEEDUP 1
+#endif
+
+// Define VOQ_ISLIP_ITERS to test VOQArbitratedCrossbar with that many iSLIP
+// iterations instead of ArbitratedCrossbar
+
 typedef Word_t DataInArray[NUM_INPUTS];
 typedef Word_t DataOutArray[NUM_OUTPUTS];
 static const int log2_outputs = nvhls::index_width<NUM_OUTPUTS>::val;
@@ -23,6 +23,232 @@
 
 const int g_test_len = 100;
 const int TB_FIFO_LEN = g_test_len + 50;
+const int g_bench_cycles = 4000;
+
+// Saturation throughput benchmark: every input always offers a packet to a
+// uniformly random output, and draws a new destination once the packet is
+// accepted. Returns delivered packets per output per cycle.
+template <typename xbar_t, unsigned int N>
+double saturation_throughput(const char* name)
+{
+    xbar_t xbar;
+    Word_t data_in[N], data_out[N];
+    typename xbar_t::OutputIdx dest_in[N];
+    bool valid_in[N], valid_out[N], ready[N];
+    for (unsigned in = 0; in < N; in++) {
+        data_in[in] = in;
+        dest_in[in] = rand() % N;
+        valid_in[in] = true;
+    }
+    unsigned long long delivered = 0;
+    for (int cycle = 0; cycle < g_bench_cycles; cycle++) {
+        xbar.run(data_in, dest_in, valid_in, data_out, valid_out, ready);
+        for (unsigned out = 0; out < N; out++) {
+            delivered += valid_out[out] ? 1 : 0;
+        }
+        for (unsigned in = 0; in < N; in++) {
+            if (ready[in]) {
+                dest_in[in] = rand() % N;
+            }
+        }
+    }
+    double throughput = delivered / (static_cast<double>(g_bench_cycles) * N);
+    cout << "Saturation throughput " << name << " " << N << "x" << N << ": " << throughput << endl;
+    return throughput;
+}
+
+template <unsigned int N>
+void run_saturation_benchmark()
+{
+    double fifo = saturation_throughput<ArbitratedCrossbar<Word_t, N, N, 4, 0>, N>("ArbitratedCrossbar");
+    // Deeper queues hide the blocking of the source, which holds its packet
+    // while the queue for its destination is full
+    double voq = saturation_throughput<VOQArbitratedCrossbar<Word_t, N, N, 16, 0>, N>("VOQArbitratedCrossbar");
+    assert(voq > 0.93);
+    assert(voq > fifo);
+}
+
+// Backpressure check for the pipelined crossbar: the consumer only pops an
+// output every few cycles, so the output buffers fill up and the credit check
+// must keep the pipeline from pushing into a full buffer. Packets of every
+// input/output pair must arrive in order, and all of them must arrive.
+template <unsigned int Stages>
+void check_pipeline_backpressure()
+{
+    const unsigned N = 4;
+    typedef ArbitratedCrossbar<Word_t, N, N, 4, 2, Roundrobin, Stages> xbar_t;
+    xbar_t xbar;
+    Word_t data_in[N], data_out[N];
+    typename xbar_t::OutputIdx dest_in[N];
+    bool valid_in[N], valid_out[N], ready[N];
+    unsigned seq[N] = {0};
+    int last_seq[N][N];
+    unsigned long long sent = 0, received = 0;
+    for (unsigned in = 0; in < N; in++) {
+        dest_in[in] = rand() % N;
+        for (unsigned out = 0; out < N; out++) {
+            last_seq[out][in] = -1;
+        }
+    }
+    for (int cycle = 0; cycle < g_bench_cycles; cycle++) {
+        bool sending = cycle < g_bench_cycles - 100;
+        for (unsigned in = 0; in < N; in++) {
+            data_in[in] = (in << 12) | (seq[in] & 0xfff);
+            valid_in[in] = sending;
+        }
+        xbar.run(data_in, dest_in, valid_in, data_out, valid_out, ready);
+        for (unsigned in = 0; in < N; in++) {
+            if (valid_in[in] && ready[in]) {
+                ++sent;
+                ++seq[in];
+                dest_in[in] = rand() % N;
+            }
+        }
+        bool popped[N];
+        for (unsigned out = 0; out < N; out++) {
+            popped[out] = valid_out[out] && (rand() % 3 == 0 || !sending);
+            if (popped[out]) {
+                unsigned in = data_out[out] >> 12;
+                int s = data_out[out] & 0xfff;
+                assert(s > last_seq[out][in]);
+                last_seq[out][in] = s;
+                ++received;
+            }
+        }
+        xbar.pop_all_lanes(popped);
+    }
+    assert(xbar.isAllInputEmpty() && xbar.isAllOutputEmpty());
+    assert(sent == received);
+    cout << "Pipeline backpressure check with " << Stages << " stages: " << received << " packets" << endl;
+}
+
+// Bursty traffic benchmark for the internal speedup: every input always
+// offers packets, in bursts of 1 to 2 * kBurst - 1 packets to one uniformly
+// random output, and every output is popped every cycle. Packets of every
+// input/output pair must arrive in order. Returns delivered packets per
+// output per cycle.
+template <unsigned int Speedup>
+double bursty_throughput()
+{
+    const unsigned N = 8;
+    const unsigned kBurst = 4;
+    typedef ArbitratedCrossbar<Word_t, N, N, 4, 8, Roundrobin, 0, Speedup> xbar_t;
+    xbar_t xbar;
+    Word_t data_in[N], data_out[N];
+    typename xbar_t::OutputIdx dest_in[N];
+    bool valid_in[N], valid_out[N], ready[N];
+    unsigned seq[N] = {0}, burst_left[N] = {0};
+    int last_seq[N][N];
+    for (unsigned in = 0; in < N; in++) {
+        valid_in[in] = true;
+        for (unsigned out = 0; out < N; out++) {
+            last_seq[out][in] = -1;
+        }
+    }
+    unsigned long long delivered = 0;
+    for (int cycle = 0; cycle < g_bench_cycles; cycle++) {
+        for (unsigned in = 0; in < N; in++) {
+            if (burst_left[in] == 0) {
+                dest_in[in] = rand() % N;
+                burst_left[in] = 1 + rand() % (2 * kBurst - 1);
+            }
+            data_in[in] = (in << 12) | (seq[in] & 0xfff);
+        }
+        xbar.run(data_in, dest_in, valid_in, data_out, valid_out, ready);
+        for (unsigned in = 0; in < N; in++) {
+            if (ready[in]) {
+                ++seq[in];
+                --burst_left[in];
+            }
+        }
+        for (unsigned out = 0; out < N; out++) {
+            if (valid_out[out]) {
+                unsigned in = data_out[out] >> 12;
+                int s = data_out[out] & 0xfff;
+                assert(s > last_seq[out][in] || last_seq[out][in] - s > 0x800);
+                last_seq[out][in] = s;
+                ++delivered;
+            }
+        }
+        xbar.pop_all_lanes(valid_out);
+    }
+    double throughput = delivered / (static_cast<double>(g_bench_cycles) * N);
+    cout << "Bursty throughput ArbitratedCrossbar " << N << "x" << N << " speedup " << Speedup
+         << ": " << throughput << endl;
+    return throughput;
+}
+
+void run_speedup_benchmark()
+{
+    double s1 = bursty_throughput<1>();
+    double s2 = bursty_throughput<2>();
+    double s4 = bursty_throughput<4>();
+    assert(s2 > s1);
+    assert(s4 > s1);
+}
+
+// Packet hold check: every input sends packets of 1 to 6 flits to uniformly
+// random outputs, with random bubbles, and the testbench holds an output from
+// its header flit to its tail flit. Flits of different packets must not
+// interleave on any output with hold, and all flits must arrive. Returns the
+// number of flits that interleaved with another packet.
+unsigned long long check_packet_hold(bool use_hold)
+{
+    const unsigned N = 4;
+    const unsigned kTail = 1 << 11;
+    typedef ArbitratedCrossbar<Word_t, N, N, 4, 0> xbar_t;
+    xbar_t xbar;
+    Word_t data_in[N], data_out[N];
+    typename xbar_t::InputIdx source[N];
+    typename xbar_t::OutputIdx dest_in[N];
+    bool valid_in[N], valid_out[N], ready[N], hold[N];
+    unsigned flits_left[N] = {0};
+    bool open[N];
+    unsigned owner[N];
+    unsigned long long sent = 0, received = 0, interleaved = 0;
+    for (unsigned out = 0; out < N; out++) {
+        open[out] = false;
+        owner[out] = 0;
+    }
+    for (int cycle = 0; cycle < g_bench_cycles; cycle++) {
+        bool sending = cycle < g_bench_cycles - 100;
+        for (unsigned in = 0; in < N; in++) {
+            // Packets that started are finished, or their output stays held
+            if (flits_left[in] == 0 && sending) {
+                dest_in[in] = rand() % N;
+                flits_left[in] = 1 + rand() % 6;
+            }
+            data_in[in] = (in << 12) | (flits_left[in] == 1 ? kTail : 0) | (sent & 0x7ff);
+            valid_in[in] = flits_left[in] != 0 && rand() % 4 != 0;
+        }
+        for (unsigned out = 0; out < N; out++) {
+            hold[out] = use_hold && open[out];
+        }
+        xbar.run(data_in, dest_in, valid_in, data_out, valid_out, ready, source, hold);
+        for (unsigned in = 0; in < N; in++) {
+            if (valid_in[in] && ready[in]) {
+                ++sent;
+                --flits_left[in];
+            }
+        }
+        for (unsigned out = 0; out < N; out++) {
+            if (valid_out[out]) {
+                unsigned in = data_out[out] >> 12;
+                assert(in == source[out]);
+                if (open[out] && in != owner[out]) {
+                    ++interleaved;
+                }
+                open[out] = (data_out[out] & kTail) == 0;
+                owner[out] = in;
+                ++received;
+            }
+        }
+    }
+    assert(sent == received);
+    cout << "Packet " << (use_hold ? "hold" : "interleaving") << " check: " << received
+         << " flits, " << interleaved << " interleaved" << endl;
+    return interleaved;
+}
 
 CCS_MAIN(int argc, char *argv[]) {
 
@@ -144,6 +370,15 @@ CCS_MAIN(int argc, char *argv[]) {
       expected_fifo_empty = fifo_empty_local;
     }
 
+    run_saturation_benchmark<8>();
+    run_saturation_benchmark<16>();
+    check_pipeline_backpressure<0>();
+    check_pipeline_backpressure<1>();
+    check_pipeline_backpressure<3>();
+    run_speedup_benchmark();
+    assert(check_packet_hold(true) == 0);
+    assert(check_packet_hold(false) > 0);
+
     if(sim_pass) {
       cout << "\n[PASSED] All tests successful." << endl;
     }
@@ -41,6 +41,10 @@
 #define DATA_TYPE NVUINT32
 #endif
 
+#ifndef WRITE_BUFFER_DEPTH
+#define WRITE_BUFFER_DEPTH 0
+#endif
+
 const unsigned int kNumBanks = NUM_BANKS;
 const unsigned int kNumReadPorts = NUM_READ_PORTS;
 const unsigned int kNumWritePorts = NUM_WRITE_PORTS;
@@ -150,6 +150,46 @@ CCS_MAIN (int argc, char *argv[]) {
     }
   }
 
+  // Mixed reads and writes to a few addresses: every read must see the
+  // writes acknowledged before it or in the same cycle, in port order.
+  const unsigned kHotAddresses = 2 * kNumBanks;
+  for (unsigned i = 0; i < 1000; i++) {
+    for (unsigned k = 0; k < kNumWritePorts; k++) {
+      if (!write_req_valid[k] && (rand() % 2)) {
+        write_address[k] = rand() % kHotAddresses;
+        write_data[k] = get_rand_data();
+        write_req_valid[k] = true;
+      }
+    }
+    for (unsigned k = 0; k < kNumReadPorts; k++) {
+      if (!read_req_valid[k] && (rand() % 2)) {
+        read_address[k] = rand() % kHotAddresses;
+        read_req_valid[k] = true;
+      }
+    }
+    CCS_DESIGN(ArbitratedScratchpadDPTop)(read_address, read_req_valid,
+                      write_address, write_req_valid, write_data,
+                      read_ack, write_ack,
+                      port_read_out, port_read_out_valid);
+    for (unsigned k = 0; k < kNumWritePorts; k++) {
+      if (write_req_valid[k] && write_ack[k]) {
+        ref_mem[write_address[k]] = write_data[k];
+        write_req_valid[k] = false;
+      }
+    }
+    for (unsigned k = 0; k < kNumReadPorts; k++) {
+      if (read_req_valid[k] && read_ack[k]) {
+        assert(port_read_out_valid[k]);
+        if (port_read_out[k] != ref_mem[read_address[k]]) {
+          cout << "Read mismatch on port " << k << " address " << read_address[k]
+               << ": got " << port_read_out[k] << " expected " << ref_mem[read_address[k]] << endl;
+          assert(false);
+        }
+        read_req_valid[k] = false;
+      }
+    }
+  }
+
   CCS_RETURN(0);
 
 }
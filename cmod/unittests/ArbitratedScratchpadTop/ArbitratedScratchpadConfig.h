@@ -41,6 +41,18 @@
 #define LEN_INPUT_BUFFER 0
 #endif
 
+#ifndef ARBITER_TYPE
+#define ARBITER_TYPE Roundrobin
+#endif
+
+#ifndef BANK_MAP
+#define BANK_MAP BankLowBits
+#endif
+
+#ifndef BANK_BYPASS
+#define BANK_BYPASS false
+#endif
+
 const unsigned NumBanks            = NUM_BANKS;
 const unsigned ScratchpadCapacity  = NUM_BANKS * NUM_BANK_ENTRIES;
 const unsigned ScratchpadAddrWidth = nvhls::nbits<ScratchpadCapacity - 1>::val;
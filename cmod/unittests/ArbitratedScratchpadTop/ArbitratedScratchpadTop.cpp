@@ -23,7 +23,8 @@ void ArbitratedScratchpadTop(tb_cli_req_t& curr_cli_req,
                              tb_cli_rsp_t& curr_cli_rsp,
                              bool ready[NumInputs]) {
   // Instantiate DUT and reset it
-  static ArbitratedScratchpad<DataType, ScratchpadCapacity, NumInputs, NumBanks, InputQueueLength> dut;
+  static ArbitratedScratchpad<DataType, ScratchpadCapacity, NumInputs, NumBanks, InputQueueLength, ARBITER_TYPE,
+                              BANK_MAP, BANK_BYPASS> dut;
   tb_cli_req_t curr_cli_req_local = curr_cli_req;
   tb_cli_rsp_t curr_cli_rsp_local;
   bool ready_local[NumInputs];
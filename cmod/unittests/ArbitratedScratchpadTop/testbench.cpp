@@ -38,6 +38,16 @@ typedef NVUINTC(ScratchpadAddrWidth) LoadAddrType;
 const int LoadAddrFifoLen = NUM_ITERS*2;
 FIFO<LoadAddrType, LoadAddrFifoLen> load_addr_fifo[NumBanks][NumInputs];
 
+// Bank of an address with the DUT's bank mapping
+typedef ArbitratedScratchpad<DataType, ScratchpadCapacity, NumInputs, NumBanks,
+                             InputQueueLength, ARBITER_TYPE, BANK_MAP, BANK_BYPASS> tb_spad_t;
+unsigned tb_bank(const NVUINTC(ScratchpadAddrWidth)& addr) {
+  tb_spad_t::bank_sel_t bank;
+  tb_spad_t::bank_addr_t bank_addr;
+  tb_spad_t::map_address(addr, bank, bank_addr);
+  return bank.to_uint();
+}
+
 // *************************************************
 // Use a reference memory class for testing the code
 // *************************************************
@@ -110,6 +120,306 @@ bool memmodel::check_response(tb_cli_rsp_t cli_rsp) {
 // Set up checker code
 static memmodel refmem(false);
 
+// *************************************************
+// Bank utilization benchmark: every lane issues kBenchRequests loads back to
+// back, either with a stride of NumBanks words between lanes and iterations
+// (all on one bank with BankLowBits) or to random addresses.
+// *************************************************
+const unsigned kBenchRequests = 256;
+
+template <scratchpad_bank_map BankMap, bool BankBypass>
+double bank_utilization(const char* name, bool strided)
+{
+  ArbitratedScratchpad<DataType, ScratchpadCapacity, NumInputs, NumBanks, 4,
+                       Roundrobin, BankMap, BankBypass> spad;
+  tb_cli_req_t req;
+  tb_cli_rsp_t rsp;
+  bool ready[NumInputs];
+  unsigned issued[NumInputs] = {0};
+  req.type.val = CLITYPE_T::LOAD;
+  bool done = false;
+  while (!done) {
+    for (unsigned i = 0; i < NumInputs; i++) {
+      unsigned idx = issued[i] * NumInputs + i;
+      req.valids[i] = issued[i] < kBenchRequests;
+      req.addr[i] = strided ? ((idx * NumBanks) % ScratchpadCapacity) : (rand() % ScratchpadCapacity);
+      req.data[i] = 0;
+    }
+    spad.load_store(req, rsp, ready);
+    done = true;
+    for (unsigned i = 0; i < NumInputs; i++) {
+      if (req.valids[i] && ready[i]) {
+        issued[i]++;
+      }
+      done = done && (issued[i] == kBenchRequests);
+    }
+  }
+  cout << "Bank utilization " << name << (strided ? " strided" : " random") << ": "
+       << spad.BankUtilization() << " (" << spad.Bypasses() << " bypasses)" << endl;
+  return spad.BankUtilization();
+}
+
+void run_bank_utilization_benchmark()
+{
+  double low_strided = bank_utilization<BankLowBits, false>("BankLowBits", true);
+  double xor_strided = bank_utilization<BankXorSwizzle, false>("BankXorSwizzle", true);
+  double low_random = bank_utilization<BankLowBits, false>("BankLowBits", false);
+  double bypass_random = bank_utilization<BankLowBits, true>("BankLowBits+BankBypass", false);
+  bank_utilization<BankXorSwizzle, true>("BankXorSwizzle+BankBypass", true);
+  if (NumBanks > 1) {
+    assert(xor_strided > low_strided);
+    assert(bypass_random > low_random);
+  }
+}
+
+
+// *************************************************
+// Wide row check: NumBanks lanes mix unit-stride row accesses, which take the
+// WideRow fast path, with single-lane accesses that go through arbitration.
+// Lane l only stores to addresses of bank l, so stores of different lanes
+// never race.
+// *************************************************
+typedef cli_req_t<DataType, ScratchpadAddrWidth, NumBanks> wide_req_t;
+typedef cli_rsp_t<DataType, NumBanks> wide_rsp_t;
+
+void run_wide_row_check()
+{
+  ArbitratedScratchpad<DataType, ScratchpadCapacity, NumBanks, NumBanks, 4,
+                       Roundrobin, BankLowBits, false, true> spad;
+  static DataType ref[ScratchpadCapacity];
+  FIFO<LoadAddrType, 64> pending[NumBanks][NumBanks];
+  wide_req_t req;
+  wide_rsp_t rsp;
+  bool ready[NumBanks];
+  const unsigned kRows = ScratchpadCapacity / NumBanks;
+
+  // Fill the memory with row stores; with empty queues these are never stalled
+  req.type.val = CLITYPE_T::STORE;
+  for (unsigned row = 0; row < kRows; row++) {
+    for (unsigned l = 0; l < NumBanks; l++) {
+      req.valids[l] = true;
+      req.addr[l] = row * NumBanks + l;
+      req.data[l] = rand();
+      ref[row * NumBanks + l] = req.data[l];
+    }
+    spad.load_store(req, rsp, ready);
+    for (unsigned l = 0; l < NumBanks; l++) {
+      assert(ready[l]);
+    }
+  }
+
+  // Mix row stores with stores of single lanes, then drain the queues
+  req.type.val = CLITYPE_T::STORE;
+  for (int it = 0; it < NUM_ITERS + 100; it++) {
+    bool drain = it >= NUM_ITERS;
+    bool row_access = rand() % 2;
+    unsigned row = rand() % kRows;
+    for (unsigned l = 0; l < NumBanks; l++) {
+      req.valids[l] = !drain && (row_access ? (rand() % 4 != 0) : (rand() % 2 == 0));
+      req.addr[l] = (row_access ? row : (rand() % kRows)) * NumBanks + l;
+      req.data[l] = rand();
+    }
+    spad.load_store(req, rsp, ready);
+    for (unsigned l = 0; l < NumBanks; l++) {
+      if (req.valids[l] && ready[l]) {
+        ref[req.addr[l]] = req.data[l];
+      }
+    }
+  }
+
+  // Mix row loads with loads of random addresses
+  req.type.val = CLITYPE_T::LOAD;
+  unsigned outstanding = 0;
+  for (int it = 0; it < NUM_ITERS || outstanding > 0; it++) {
+    bool drain = it >= NUM_ITERS;
+    bool row_access = rand() % 2;
+    unsigned row = rand() % kRows;
+    for (unsigned l = 0; l < NumBanks; l++) {
+      req.valids[l] = !drain && (row_access ? (rand() % 4 != 0) : (rand() % 2 == 0));
+      req.addr[l] = row_access ? (row * NumBanks + l) : (rand() % ScratchpadCapacity);
+    }
+    spad.load_store(req, rsp, ready);
+    for (unsigned l = 0; l < NumBanks; l++) {
+      if (req.valids[l] && ready[l]) {
+        pending[tb_bank(req.addr[l])][l].push(req.addr[l]);
+        outstanding++;
+      }
+    }
+    for (unsigned l = 0; l < NumBanks; l++) {
+      if (rsp.valids[l]) {
+        bool matched = false;
+        for (unsigned b = 0; b < NumBanks && !matched; b++) {
+          if (!pending[b][l].isEmpty() && ref[pending[b][l].peek()] == rsp.data[l]) {
+            pending[b][l].pop();
+            matched = true;
+          }
+        }
+        assert(matched);
+        outstanding--;
+      }
+    }
+  }
+  spad.DumpStats(cout);
+  assert(spad.WideRowFraction() > 0.0);
+}
+
+
+// *************************************************
+// Atomics on a few hot addresses. Lanes of one request may hit the same
+// address, so the order of their updates follows the bank arbitration: the
+// check runs one commutative operation per phase and compares the final
+// values, then runs every operation on a single lane and checks the returned
+// old values.
+// *************************************************
+typedef ArbitratedScratchpad<DataType, ScratchpadCapacity, NumInputs, NumBanks, 4,
+                             Roundrobin, BankLowBits, false, false, true> atomic_spad_t;
+
+// Issue req until every valid lane is accepted, then wait for the responses.
+// Returns the number of cycles.
+unsigned atomic_issue(atomic_spad_t& spad, atomic_spad_t::req_t req, DataType old[NumInputs])
+{
+  atomic_spad_t::rsp_t rsp;
+  bool ready[NumInputs];
+  bool has_rsp = (req.type.val != CLITYPE_T::STORE);
+  unsigned issue = 0;
+  unsigned pending = 0;
+  unsigned cycles = 0;
+  for (unsigned i = 0; i < NumInputs; i++) {
+    issue += req.valids[i];
+  }
+  while (issue > 0 || pending > 0) {
+    spad.load_store(req, rsp, ready);
+    cycles++;
+    for (unsigned i = 0; i < NumInputs; i++) {
+      if (req.valids[i] && ready[i]) {
+        req.valids[i] = false;
+        issue--;
+        pending += has_rsp;
+      }
+      if (rsp.valids[i]) {
+        old[i] = rsp.data[i];
+        pending--;
+      }
+    }
+  }
+  return cycles;
+}
+
+void run_atomic_check()
+{
+  atomic_spad_t spad;
+  atomic_spad_t::req_t req;
+  DataType old[NumInputs];
+  const unsigned kHot = NumBanks + 1;
+  DataType ref[kHot];
+
+  for (unsigned i = 0; i < NumInputs; i++) {
+    req.valids[i] = false;
+    req.cmp[i] = 0;
+  }
+  req.type.val = CLITYPE_T::STORE;
+  for (unsigned a = 0; a < kHot; a++) {
+    req.valids[0] = true;
+    req.addr[0] = a;
+    req.data[0] = 1000 + rand() % 1000;
+    ref[a] = req.data[0];
+    atomic_issue(spad, req, old);
+  }
+
+  const unsigned ops[] = {CLITYPE_T::ATOMIC_ADD, CLITYPE_T::ATOMIC_MIN, CLITYPE_T::ATOMIC_MAX};
+  for (unsigned op = 0; op < 3; op++) {
+    req.type.val = ops[op];
+    for (int it = 0; it < NUM_ITERS / 10; it++) {
+      for (unsigned i = 0; i < NumInputs; i++) {
+        req.valids[i] = rand() % 2;
+        req.addr[i] = rand() % kHot;
+        req.data[i] = rand() % 2000;
+        if (req.valids[i]) {
+          ref[req.addr[i]] = CLITYPE_T::AtomicResult(req.type.val, ref[req.addr[i]], req.data[i], req.cmp[i]);
+        }
+      }
+      atomic_issue(spad, req, old);
+    }
+  }
+
+  const unsigned all_ops[] = {CLITYPE_T::LOAD, CLITYPE_T::ATOMIC_ADD, CLITYPE_T::ATOMIC_MIN,
+                              CLITYPE_T::ATOMIC_MAX, CLITYPE_T::ATOMIC_SWAP, CLITYPE_T::ATOMIC_CAS};
+  for (unsigned i = 0; i < NumInputs; i++) {
+    req.valids[i] = false;
+  }
+  for (int it = 0; it < NUM_ITERS / 10; it++) {
+    unsigned addr = rand() % kHot;
+    req.type.val = all_ops[rand() % 6];
+    req.valids[0] = true;
+    req.addr[0] = addr;
+    req.data[0] = rand() % 2000;
+    req.cmp[0] = (rand() % 2) ? ref[addr] : DataType(rand() % 2000);
+    atomic_issue(spad, req, old);
+    assert(old[0] == ref[addr]);
+    if (req.type.val != CLITYPE_T::LOAD) {
+      ref[addr] = CLITYPE_T::AtomicResult(req.type.val, ref[addr], req.data[0], req.cmp[0]);
+    }
+  }
+  cout << "Atomic check: " << spad.AtomicOps() << " atomics" << endl;
+}
+
+// Histogram throughput: bank atomics against read-modify-write through the
+// client, which has to wait for the load response before the store
+void atomic_histogram(unsigned bins)
+{
+  const unsigned kUpdates = 256 * NumInputs;
+  atomic_spad_t spad;
+  atomic_spad_t::req_t req;
+  DataType old[NumInputs];
+
+  req.type.val = CLITYPE_T::ATOMIC_ADD;
+  unsigned atomic_cycles = 0;
+  for (unsigned done = 0; done < kUpdates; done += NumInputs) {
+    for (unsigned i = 0; i < NumInputs; i++) {
+      req.valids[i] = true;
+      req.addr[i] = rand() % bins;
+      req.data[i] = 1;
+      req.cmp[i] = 0;
+    }
+    atomic_cycles += atomic_issue(spad, req, old);
+  }
+  unsigned long long total = 0;
+  req.type.val = CLITYPE_T::LOAD;
+  for (unsigned i = 0; i < NumInputs; i++) {
+    req.valids[i] = false;
+  }
+  for (unsigned b = 0; b < bins; b++) {
+    req.valids[0] = true;
+    req.addr[0] = b;
+    atomic_issue(spad, req, old);
+    total += old[0].to_uint64();
+  }
+  assert(total == kUpdates);
+
+  unsigned rmw_cycles = 0;
+  for (unsigned done = 0; done < kUpdates; done++) {
+    req.type.val = CLITYPE_T::LOAD;
+    req.valids[0] = true;
+    req.addr[0] = rand() % bins;
+    rmw_cycles += atomic_issue(spad, req, old);
+    req.type.val = CLITYPE_T::STORE;
+    req.data[0] = old[0] + 1;
+    rmw_cycles += atomic_issue(spad, req, old);
+  }
+  cout << "Histogram with " << bins << " bins: atomics "
+       << static_cast<double>(kUpdates) / atomic_cycles << " updates/cycle, client read-modify-write "
+       << static_cast<double>(kUpdates) / rmw_cycles << " updates/cycle" << endl;
+  assert(atomic_cycles < rmw_cycles);
+}
+
+void run_atomic_benchmark()
+{
+  atomic_histogram(1);
+  atomic_histogram(NumBanks);
+  atomic_histogram(64);
+}
+
+
 // *************************************************
 // Testbench
 // *************************************************
@@ -193,7 +503,7 @@ CCS_MAIN(int argc, char *argv[]) {
 
             // Push the load address into a FIFO since the load request could be
 	    // serviced out of order in the event of a bank conflict.
-	    int bank_idx = curr_cli_req.addr[j] % NumBanks;
+	    int bank_idx = tb_bank(curr_cli_req.addr[j]);
 	    load_addr_fifo[bank_idx][j].push(curr_cli_req.addr[j]);
           }
         }
@@ -291,7 +601,7 @@ CCS_MAIN(int argc, char *argv[]) {
 	// Push the load address into a FIFO since the load request could be
 	// serviced out of order in the event of a bank conflict.
 	if(curr_cli_req.valids[i]) {
-	  int bank_idx = curr_cli_req.addr[i] % NumBanks;
+	  int bank_idx = tb_bank(curr_cli_req.addr[i]);
 	  load_addr_fifo[bank_idx][i].push(curr_cli_req.addr[i]);
 	  cout << "Pushing addr"          << curr_cli_req.addr[i]
                << " into load_addr_fifo[" << bank_idx << "][" << i << "]" << endl;
@@ -301,6 +611,14 @@ CCS_MAIN(int argc, char *argv[]) {
     assert(!requested || served); // At least one request should have been served or nothing was requested
     refmem.check_response(curr_cli_rsp);
   }
+
+  run_bank_utilization_benchmark();
+  if (BANK_MAP == BankLowBits) {
+    run_wide_row_check();
+  }
+  run_atomic_check();
+  run_atomic_benchmark();
+
   DCOUT("CMODEL PASS" << endl);
   CCS_RETURN(0);
 }
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <nvhls_assert.h>
+#include <nvhls_int.h>
+#include <fifo.h>
+#include <mem_array.h>
+#include <chrono>
+#include <iomanip>
+
+// Checks which assertions NVHLS_ASSERT_LEVEL checks and times a FIFO and a
+// mem_array_sep, whose bounds checks are cheap and whose X checks are
+// paranoid assertions. Built once per level; compare the ns/iteration of
+// sim_test, sim_test_cheap and sim_test_off.
+
+static const unsigned int kIters = 1 << 20;
+
+static unsigned int evaluated = 0;
+
+static bool Fails() {
+  evaluated++;
+  return false;
+}
+
+// Returns whether assertion stmt failed, i.e. its condition was checked.
+#define FIRES(stmt)                  \
+  ([]() -> bool {                    \
+    try {                            \
+      stmt;                          \
+    } catch (const sc_report&) {     \
+      return true;                   \
+    }                                \
+    return false;                    \
+  }())
+
+int sc_main(int argc, char *argv[]) {
+  int errors = 0;
+  const int level = NVHLS_ASSERT_LEVEL;
+  sc_report_handler::set_actions("NVHLS assertion failed", SC_FATAL, SC_THROW);
+
+  bool cheap = FIRES(NVHLS_ASSERT_MSG(Fails(), "cheap"));
+  bool plain = FIRES(NVHLS_ASSERT(Fails()));
+  bool paranoid = FIRES(NVHLS_PARANOID_ASSERT_MSG(Fails(), "paranoid"));
+  CMOD_PARANOID_ASSERT_MSG(true || Fails(), "never fails");
+  if (cheap != (level >= 1) || plain != (level >= 1) || paranoid != (level >= 2)) {
+    cout << "Level " << level << " checked cheap=" << cheap << " plain=" << plain
+         << " paranoid=" << paranoid << endl;
+    errors++;
+  }
+  if (evaluated != (level >= 1) * 2u + (level >= 2)) {
+    cout << "Level " << level << " evaluated " << evaluated << " conditions" << endl;
+    errors++;
+  }
+
+  FIFO<NVUINTW(32), 16> fifo;
+  mem_array_sep<NVUINTW(32), 64, 1, 4> mem;
+  fifo.reset();
+  for (unsigned int i = 0; i < 64; i++)
+    mem.write(i, 0, 0);
+  NVUINTW(32) sum = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < kIters; i++) {
+    fifo.push(i);
+    mem.write(i % 64, 0, fifo.pop());
+    sum += mem.read((i * 7) % 64);
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  cout << "NVHLS_ASSERT_LEVEL " << level << ": " << std::fixed << std::setprecision(1)
+       << ns / kIters << " ns/iteration (sum " << sum << ")" << endl;
+
+  if (errors == 0)
+    cout << "Simulation PASSED" << endl;
+  else
+    cout << "Simulation FAILED" << endl;
+  return errors;
+}
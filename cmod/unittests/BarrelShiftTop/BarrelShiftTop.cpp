@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_shift.h>
+#include <hls_globals.h>
+#include "BarrelShiftTop.h"
+
+void BarrelShiftTop(const bool& in_valid, const Data& in, const Shift& shift,
+                    Data& left_out, bool& right_valid, Data& right_out) {
+  static RightShifter right_shifter;
+  left_out = nvhls::barrel_left_shift<Data, true>(in, shift);
+  right_valid = right_shifter.run(in_valid, in, shift, right_out);
+}
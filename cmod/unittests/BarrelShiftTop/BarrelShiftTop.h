@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef BARREL_SHIFT_TOP_H
+#define BARREL_SHIFT_TOP_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_shift.h>
+#include <hls_globals.h>
+
+#ifndef NUM_BITS
+#define NUM_BITS 16
+#endif
+
+#ifndef STAGES_PER_CYCLE
+#define STAGES_PER_CYCLE 2
+#endif
+
+typedef NVINTC(NUM_BITS) Data;
+// One extra bit so that shifts past the width are exercised
+typedef NVUINTC(nvhls::nbits<NUM_BITS>::val + 1) Shift;
+
+typedef nvhls::PipelinedRightShift<Data, Shift, STAGES_PER_CYCLE, nvhls::RoundNearestEven> RightShifter;
+
+void BarrelShiftTop(const bool& in_valid, const Data& in, const Shift& shift,
+                    Data& left_out, bool& right_valid, Data& right_out);
+
+#endif
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <deque>
+#include <match_scverify.h>
+#include <testbench/nvhls_rand.h>
+
+#include "BarrelShiftTop.h"
+
+#ifndef NUM_ITERS
+#define NUM_ITERS 2000
+#endif
+
+// Reference models on 128-bit host integers, valid for widths up to 32 bits
+typedef __int128 wide_t;
+
+template <unsigned int W, bool is_signed>
+wide_t ref_left_shift(wide_t x, unsigned int s, bool saturate) {
+  wide_t max_val = is_signed ? ((wide_t(1) << (W - 1)) - 1) : ((wide_t(1) << W) - 1);
+  wide_t min_val = is_signed ? -(wide_t(1) << (W - 1)) : 0;
+  bool overflow;
+  wide_t full = 0;
+  if (s >= 64) {
+    overflow = (x != 0);
+  } else {
+    full = x * (wide_t(1) << s);
+    overflow = (full > max_val) || (full < min_val);
+  }
+  if (overflow && saturate) {
+    return (x < 0) ? min_val : max_val;
+  }
+  // wrap to W bits
+  wide_t mod = wide_t(1) << W;
+  wide_t r = ((full % mod) + mod) % mod;
+  if (is_signed && (r > max_val)) r -= mod;
+  return r;
+}
+
+template <unsigned int W>
+wide_t ref_right_shift(wide_t x, unsigned int s, nvhls::shift_round_mode round, wide_t rnd) {
+  wide_t q, frac;
+  bool up = false;
+  if (s >= 2 * W) {
+    q = (x < 0) ? -1 : 0;
+    frac = (x < 0) ? ((wide_t(1) << W) - 1) : 0;
+    up = (x < 0) && (round == nvhls::RoundNearestEven);
+  } else {
+    wide_t div = wide_t(1) << s;
+    q = (x >= 0) ? (x / div) : -((-x + div - 1) / div);
+    wide_t rem = x - q * div;
+    frac = (s <= W) ? (rem << (W - s)) : (rem >> (s - W));
+    if (round == nvhls::RoundNearestEven)
+      up = (2 * rem > div) || ((2 * rem == div) && (q & 1));
+  }
+  if (round == nvhls::RoundStochastic) up = (frac > rnd);
+  return q + (up ? 1 : 0);
+}
+
+template <typename T>
+wide_t to_wide(const T& v, bool is_signed) {
+  return is_signed ? wide_t(v.to_int64()) : wide_t(v.to_uint64());
+}
+
+// Checks barrel_left_shift and all rounding modes of barrel_right_shift
+// against the reference models
+template <unsigned int W, bool is_signed>
+bool check_combinational() {
+  typedef typename nvhls::shift_int_t<W, is_signed>::type T;
+  typedef NVUINTW(nvhls::nbits<W>::val + 1) S;
+  typedef NVUINTW(W) R;
+  bool ok = true;
+  for (int i = 0; i < NUM_ITERS; i++) {
+    T x = nvhls::get_rand<W>();
+    if (rand() & 1) x = x >> (rand() % W);
+    S s = rand() % (1 << Wrapped<S>::width);
+    R rnd = nvhls::get_rand<W>();
+    wide_t xw = to_wide(x, is_signed);
+    unsigned int sh = s.to_uint();
+
+    T l_sat = nvhls::barrel_left_shift<T, true>(x, s);
+    T l_wrap = nvhls::barrel_left_shift<T, false>(x, s);
+    T r_trunc = nvhls::barrel_right_shift<T, nvhls::RoundTruncate>(x, s);
+    T r_rne = nvhls::barrel_right_shift<T, nvhls::RoundNearestEven>(x, s);
+    T r_sto = nvhls::barrel_right_shift<T, nvhls::RoundStochastic>(x, s, rnd);
+
+    wide_t rw = wide_t(rnd.to_uint64());
+    if ((to_wide(l_sat, is_signed) != ref_left_shift<W, is_signed>(xw, sh, true)) ||
+        (to_wide(l_wrap, is_signed) != ref_left_shift<W, is_signed>(xw, sh, false)) ||
+        (to_wide(r_trunc, is_signed) != ref_right_shift<W>(xw, sh, nvhls::RoundTruncate, rw)) ||
+        (to_wide(r_rne, is_signed) != ref_right_shift<W>(xw, sh, nvhls::RoundNearestEven, rw)) ||
+        (to_wide(r_sto, is_signed) != ref_right_shift<W>(xw, sh, nvhls::RoundStochastic, rw))) {
+      std::cout << "ERROR: W=" << W << " signed=" << is_signed << " x=" << x << " shift=" << sh
+                << " left=" << l_sat << "/" << l_wrap << " right=" << r_trunc << "/" << r_rne
+                << "/" << r_sto << std::endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+// Checks that the pipelined shifter matches the combinational one after its
+// latency of cycles
+template <unsigned int W, unsigned int StagesPerCycle>
+bool check_pipelined() {
+  typedef NVINTW(W) T;
+  typedef NVUINTW(nvhls::nbits<W>::val + 1) S;
+  typedef nvhls::PipelinedLeftShift<T, S, StagesPerCycle, true> Left;
+  typedef nvhls::PipelinedRightShift<T, S, StagesPerCycle, nvhls::RoundNearestEven> Right;
+  Left left;
+  Right right;
+  std::deque<T> expected_left, expected_right;
+  std::deque<bool> expected_valid;
+  for (unsigned int i = 0; i < Left::Latency; i++) expected_valid.push_back(false);
+  bool ok = true;
+  for (int i = 0; i < NUM_ITERS; i++) {
+    bool valid = (rand() % 4 != 0);
+    T x = nvhls::get_rand<W>();
+    S s = rand() % (1 << Wrapped<S>::width);
+    T l_out, r_out;
+    bool l_valid = left.run(valid, x, s, l_out);
+    bool r_valid = right.run(valid, x, s, r_out);
+    expected_valid.push_back(valid);
+    if (valid) {
+      expected_left.push_back(nvhls::barrel_left_shift<T, true>(x, s));
+      expected_right.push_back(nvhls::barrel_right_shift<T, nvhls::RoundNearestEven>(x, s));
+    }
+    bool exp_valid = expected_valid.front();
+    expected_valid.pop_front();
+    if ((l_valid != exp_valid) || (r_valid != exp_valid)) {
+      std::cout << "ERROR: pipelined valid mismatch at cycle " << i << std::endl;
+      ok = false;
+    } else if (exp_valid) {
+      if ((l_out != expected_left.front()) || (r_out != expected_right.front())) {
+        std::cout << "ERROR: pipelined output mismatch at cycle " << i << std::endl;
+        ok = false;
+      }
+      expected_left.pop_front();
+      expected_right.pop_front();
+    }
+  }
+  return ok;
+}
+
+CCS_MAIN(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  bool ok = true;
+
+  ok = check_combinational<1, false>() && ok;
+  ok = check_combinational<5, true>() && ok;
+  ok = check_combinational<8, false>() && ok;
+  ok = check_combinational<8, true>() && ok;
+  ok = check_combinational<NUM_BITS, false>() && ok;
+  ok = check_combinational<NUM_BITS, true>() && ok;
+  ok = check_combinational<32, true>() && ok;
+  ok = check_pipelined<NUM_BITS, 1>() && ok;
+  ok = check_pipelined<NUM_BITS, 2>() && ok;
+  ok = check_pipelined<NUM_BITS, 3>() && ok;
+  ok = check_pipelined<NUM_BITS, 8>() && ok;
+
+  // Drive the design: saturating left shift and a right shift with
+  // round-to-nearest-even behind RightShifter::Latency registers
+  std::deque<Data> expected;
+  for (int i = 0; i < NUM_ITERS; i++) {
+    bool in_valid = (i < NUM_ITERS - static_cast<int>(RightShifter::Latency));
+    Data in = nvhls::get_rand<NUM_BITS>();
+    Shift shift = rand() % (1 << Wrapped<Shift>::width);
+    Data left_out, right_out;
+    bool right_valid;
+    CCS_DESIGN(BarrelShiftTop)(in_valid, in, shift, left_out, right_valid, right_out);
+    Data left_ref = static_cast<long long>(ref_left_shift<NUM_BITS, true>(in.to_int64(), shift.to_uint(), true));
+    if (left_out != left_ref) {
+      std::cout << "ERROR: left_shift " << in << " << " << shift << " = " << left_out
+                << " expected " << left_ref << std::endl;
+      ok = false;
+    }
+    if (in_valid) {
+      expected.push_back(static_cast<long long>(ref_right_shift<NUM_BITS>(in.to_int64(), shift.to_uint(),
+                                                   nvhls::RoundNearestEven, 0)));
+    }
+    if (right_valid) {
+      if (expected.empty() || (right_out != expected.front())) {
+        std::cout << "ERROR: right_shift output " << right_out << std::endl;
+        ok = false;
+      } else {
+        expected.pop_front();
+      }
+    }
+  }
+  if (!expected.empty()) {
+    std::cout << "ERROR: " << expected.size() << " right_shift outputs missing" << std::endl;
+    ok = false;
+  }
+
+  if (ok) {
+    std::cout << "PASS" << std::endl;
+  } else {
+    std::cout << "FAIL" << std::endl;
+  }
+  CCS_RETURN(0);
+}
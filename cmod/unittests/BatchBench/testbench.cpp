@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <fifo.h>
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <testbench/BatchBench.h>
+#include <deque>
+#include <sstream>
+
+// Runs kInstances seeds of a banked FIFO test as one BatchBench. Every
+// instance issues kOps random push, pop, peek, isEmpty and isFull operations,
+// one per cycle, and checks them against a std::deque per bank. Instance
+// kBadRef corrupts its reference model and instance kBadReport raises an
+// SC_ERROR, so the batch must report exactly these two instances as failed
+// and all others as passed.
+
+static const unsigned int kInstances = 200;
+static const unsigned int kOps = 2000;
+static const unsigned int kBadRef = 3;
+static const unsigned int kBadReport = 5;
+
+static const unsigned int kFifoLen = 3;
+static const unsigned int kNumBanks = 4;
+typedef NVUINTW(16) Word;
+typedef FIFO<Word, kFifoLen, kNumBanks> Fifo;
+
+enum FifoOp { push = 0, pop, peek, isEmpty, isFull, MAXOP };
+
+class FifoInstance : public BatchInstance {
+ public:
+  Fifo fifo;
+  std::deque<Word> ref_q[kNumBanks];
+
+  SC_HAS_PROCESS(FifoInstance);
+  FifoInstance(sc_module_name name, unsigned int index, uint64 seed)
+      : BatchInstance(name, index, seed) {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  template <typename T>
+  void Check(unsigned int i, const char* op, unsigned int bank, const T& got, const T& expected) {
+    if (got == expected) return;
+    std::ostringstream msg;
+    msg << op << " of bank " << bank << " returned " << got << " instead of " << expected
+        << " at op " << i;
+    Fail(msg.str());
+  }
+
+  void run() {
+    fifo.reset();
+    for (unsigned int b = 0; b < kNumBanks; b++) ref_q[b].clear();
+    bool corrupt = (index == kBadRef);
+    wait();
+    for (unsigned int i = 0; i < kOps; i++) {
+      unsigned int bank = rng.uniform(kNumBanks);
+      unsigned int size = ref_q[bank].size();
+      unsigned int op;
+      // No pop or peek of an empty bank and no push to a full one: these
+      // fail NVHLS_ASSERT in the FIFO and would end the whole batch
+      do {
+        op = rng.uniform(MAXOP);
+      } while ((size == 0 && (op == pop || op == peek)) || (size == kFifoLen && op == push));
+
+      switch (op) {
+        case push: {
+          Word data = rng.get_rand<16>();
+          fifo.push(data, bank);
+          ref_q[bank].push_back(data);
+          if (corrupt && i >= kOps / 2) {
+            ref_q[bank].back() = ~data;
+            corrupt = false;
+          }
+          break;
+        }
+        case pop:
+          Check(i, "pop", bank, fifo.pop(bank), ref_q[bank].front());
+          ref_q[bank].pop_front();
+          break;
+        case peek:
+          Check(i, "peek", bank, fifo.peek(bank), ref_q[bank].front());
+          break;
+        case isEmpty:
+          Check(i, "isEmpty", bank, fifo.isEmpty(bank), ref_q[bank].empty());
+          break;
+        case isFull:
+          Check(i, "isFull", bank, fifo.isFull(bank), ref_q[bank].size() == kFifoLen);
+          break;
+      }
+      if (index == kBadReport && i == kOps / 4) SC_REPORT_ERROR("FifoInstance", "injected error");
+      wait();
+    }
+    // Drain every bank, so a corrupted word is seen even if it was not
+    // popped yet
+    for (unsigned int b = 0; b < kNumBanks; b++) {
+      for (; !ref_q[b].empty(); ref_q[b].pop_front())
+        Check(kOps, "pop", b, fifo.pop(b), ref_q[b].front());
+    }
+    Done();
+    while (1) wait();
+  }
+};
+
+int sc_main(int argc, char *argv[]) {
+  BatchBench<FifoInstance> batch("batch", kInstances);
+  batch.Run(sc_time(10 * kOps, SC_NS));
+
+  bool passed = true;
+  for (unsigned int i = 0; i < batch.instances.size(); i++) {
+    FifoInstance* inst = batch.instances[i];
+    bool bad = (i == kBadRef || i == kBadReport);
+    if (!inst->IsDone() || inst->Passed() == bad) {
+      std::cout << "FAILED: instance " << i << (bad ? " passed" : " failed") << std::endl;
+      passed = false;
+    }
+  }
+  if (batch.instances.size() > kBadReport &&
+      batch.instances[kBadReport]->FirstError().find("injected error") == std::string::npos) {
+    std::cout << "FAILED: SC_ERROR not charged to instance " << kBadReport << std::endl;
+    passed = false;
+  }
+
+  if (!passed) {
+    DCOUT("TESTBENCH FAIL" << endl);
+    return 1;
+  }
+  DCOUT("TESTBENCH PASS" << endl);
+  return 0;
+}
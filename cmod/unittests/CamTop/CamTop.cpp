@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <hls_globals.h>
+#include "CamTop.h"
+
+void CamTop(const Op& op, const Key& key, const Value& value, bool& hit, Value& value_out,
+            Index& index, Key& evicted_key) {
+  static Cam cam;
+  hit = false;
+  value_out = 0;
+  index = 0;
+  evicted_key = 0;
+  if (op == CamLookup) {
+    hit = cam.lookup(key, value_out, index);
+  } else if (op == CamWrite) {
+    hit = cam.write(key, value, index, evicted_key, value_out);
+  } else if (op == CamInvalidate) {
+    hit = cam.invalidate(key);
+  }
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CAM_TOP_H
+#define CAM_TOP_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <hls_globals.h>
+#include <CAM.h>
+
+#ifndef NUM_ENTRIES
+#define NUM_ENTRIES 16
+#endif
+
+#ifndef REPLACEMENT
+#define REPLACEMENT CamPseudoLRU
+#endif
+
+typedef NVUINTW(16) Key;
+typedef NVUINTW(32) Value;
+typedef CAM<Key, Value, NUM_ENTRIES, REPLACEMENT> Cam;
+typedef Cam::Index Index;
+
+enum cam_op { CamLookup = 0, CamWrite = 1, CamInvalidate = 2 };
+typedef NVUINTW(2) Op;
+
+// CamLookup: hit, value_out and index of key.
+// CamWrite: index of key; hit if an entry was evicted, with its key in
+// evicted_key and its value in value_out.
+// CamInvalidate: hit if key was present.
+void CamTop(const Op& op, const Key& key, const Value& value, bool& hit, Value& value_out,
+            Index& index, Key& evicted_key);
+
+#endif
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <match_scverify.h>
+#include <testbench/nvhls_rand.h>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "CamTop.h"
+
+#ifndef NUM_ITERS
+#define NUM_ITERS 20000
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+// Reference: key -> (value, entry) and the free entries. A new key takes the
+// lowest free entry, or the entry of the key the DUT evicts.
+struct Reference {
+  std::map<unsigned int, std::pair<unsigned int, unsigned int> > entries;
+  std::set<unsigned int> free_entries;
+
+  Reference() {
+    for (unsigned int i = 0; i < NUM_ENTRIES; i++) free_entries.insert(i);
+  }
+};
+
+// Random lookups, writes and invalidates of keys from a space three times the
+// size of the CAM, checked against the reference. Returns the ns per access.
+double check_traffic() {
+  Reference ref;
+  const unsigned int key_space = 3 * NUM_ENTRIES;
+  unsigned int evictions = 0;
+  Clock::time_point start = Clock::now();
+  for (unsigned int i = 0; i < NUM_ITERS; i++) {
+    unsigned int r = rand() % 8;
+    Op op = (r < 4) ? CamLookup : (r < 7) ? CamWrite : CamInvalidate;
+    Key key = rand() % key_space;
+    Value value = rand();
+    bool hit;
+    Value value_out;
+    Index index;
+    Key evicted_key;
+    CCS_DESIGN(CamTop)(op, key, value, hit, value_out, index, evicted_key);
+
+    unsigned int k = key.to_uint();
+    bool present = ref.entries.count(k) > 0;
+    if (op == CamLookup) {
+      assert(hit == present);
+      if (hit) {
+        assert(value_out == ref.entries[k].first);
+        assert(index == ref.entries[k].second);
+      }
+    } else if (op == CamWrite) {
+      if (present) {
+        assert(!hit);
+        assert(index == ref.entries[k].second);
+      } else if (!ref.free_entries.empty()) {
+        assert(!hit);
+        assert(index == *ref.free_entries.begin());
+        ref.free_entries.erase(ref.free_entries.begin());
+      } else {
+        // A full CAM evicts a valid entry of another key
+        unsigned int ek = evicted_key.to_uint();
+        assert(hit);
+        assert(ek != k);
+        assert(ref.entries.count(ek) > 0);
+        assert(value_out == ref.entries[ek].first);
+        assert(index == ref.entries[ek].second);
+        ref.entries.erase(ek);
+        evictions++;
+      }
+      ref.entries[k] = std::make_pair(value.to_uint(), index.to_uint());
+    } else {
+      assert(hit == present);
+      if (present) {
+        ref.free_entries.insert(ref.entries[k].second);
+        ref.entries.erase(k);
+      }
+    }
+  }
+  double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / NUM_ITERS;
+  assert(evictions > 0);
+  return ns;
+}
+
+// Round robin evicts in fill order, pseudo-LRU never evicts the entry used
+// last and random covers all entries
+template <unsigned int Entries>
+void check_policies() {
+  typedef NVUINTW(16) K;
+  typedef NVUINTW(8) V;
+  K ek;
+  V ev;
+
+  CAM<K, V, Entries, CamRoundRobin> rr;
+  typename CAM<K, V, Entries, CamRoundRobin>::Index rr_index;
+  for (unsigned int i = 0; i < Entries; i++) {
+    assert(!rr.write(i, i, rr_index, ek, ev));
+    assert(rr_index == i);
+  }
+  assert(rr.isFull());
+  for (unsigned int i = 0; i < 3 * Entries; i++) {
+    V v;
+    assert(rr.lookup(i, v, rr_index));  // lookups do not change the order
+    assert(rr.write(Entries + i, 0, rr_index, ek, ev));
+    assert(ek == i);
+    assert(rr_index == i % Entries);
+  }
+
+  CAM<K, V, Entries, CamPseudoLRU> plru;
+  typename CAM<K, V, Entries, CamPseudoLRU>::Index plru_index;
+  for (unsigned int i = 0; i < Entries; i++) {
+    plru.write(i, i, plru_index, ek, ev);
+  }
+  std::vector<unsigned int> keys(Entries);
+  for (unsigned int i = 0; i < Entries; i++) keys[i] = i;
+  for (unsigned int i = 0; i < 20 * Entries; i++) {
+    unsigned int used = rand() % Entries;
+    V v;
+    assert(plru.lookup(keys[used], v, plru_index));
+    unsigned int new_key = 1000 + i;
+    bool evicted = plru.write(new_key, 0, plru_index, ek, ev);
+    assert(evicted);
+    assert(Entries == 1 || ek != keys[used]);
+    keys[plru_index.to_uint()] = new_key;
+  }
+
+  CAM<K, V, Entries, CamRandom> rnd;
+  typename CAM<K, V, Entries, CamRandom>::Index rnd_index;
+  std::set<unsigned int> victims;
+  for (unsigned int i = 0; i < 50 * Entries; i++) {
+    rnd.write(i, 0, rnd_index, ek, ev);
+    assert(rnd_index < Entries);
+    if (i >= Entries) victims.insert(rnd_index.to_uint());
+  }
+  assert(victims.size() == Entries);
+}
+
+// Keys wider than 64 bits always use the parallel compare
+void check_wide_keys() {
+  typedef NVUINTW(80) K;
+  typedef NVUINTW(8) V;
+  CAM<K, V, 8, CamRoundRobin> cam;
+  CAM<K, V, 8, CamRoundRobin>::Index index;
+  K ek;
+  V ev, v;
+  K base = 1;
+  base <<= 70;
+  for (unsigned int i = 0; i < 8; i++) {
+    assert(!cam.write(base + i, i, index, ek, ev));
+  }
+  assert(!cam.lookup(K(0), v, index));
+  assert(cam.lookup(base + 3, v, index) && v == 3 && index == 3);
+  assert(cam.invalidate(base + 3));
+  assert(!cam.write(base + 9, 9, index, ek, ev) && index == 3);
+  assert(cam.write(base + 10, 10, index, ek, ev) && ek == base && index == 0);
+  assert(cam.match(base + 9) == 8);
+}
+
+CCS_MAIN(int argc, char *argv[])
+{
+  nvhls::set_random_seed();
+
+  double ns = check_traffic();
+  check_policies<1>();
+  check_policies<2>();
+  check_policies<16>();
+  check_policies<64>();
+  check_wide_keys();
+  std::cout << NUM_ENTRIES << "-entry CAM: " << ns << " ns per access" << std::endl;
+
+  DCOUT("CMODEL PASS" << endl);
+  CCS_RETURN(0) ;
+}
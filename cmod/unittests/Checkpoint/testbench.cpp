@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <nvhls_module.h>
+#include <nvhls_checkpoint.h>
+#include <nvhls_int.h>
+#include <fifo.h>
+#include <mem_array.h>
+#include <testbench/nvhls_rand.h>
+
+// Saves a checkpoint of CheckpointDut at cycle SAVE_CYCLE, runs on to
+// END_CYCLE, restores the checkpoint and runs the same number of cycles again.
+// The second run must end in exactly the same state as the first.
+
+#define SAVE_CYCLE 500
+#define END_CYCLE 1000
+
+class CheckpointDut : public match::Module {
+ public:
+  typedef NVUINTW(32) Word;
+  typedef NVUINTW(16) Data;
+
+  Word lfsr;
+  Word checksum;
+  FIFO<Data, 8> fifo;
+  mem_array_sep<Data, 64, 1> mem;
+
+  SC_HAS_PROCESS(CheckpointDut);
+  CheckpointDut(sc_module_name name_) : match::Module(name_) {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    RegisterCheckpoint("lfsr", lfsr);
+    RegisterCheckpoint("checksum", checksum);
+    RegisterCheckpoint("fifo", fifo);
+    RegisterCheckpoint("mem", mem);
+  }
+
+  void run() {
+    lfsr = 0xace1u;
+    checksum = 0;
+    fifo.reset();
+    for (int i = 0; i < 64; i++) {
+      mem.write(i, 0, 0);
+    }
+    wait();
+    while (1) {
+      wait();
+      // Galois LFSR, x^32 + x^22 + x^2 + x + 1
+      lfsr = (lfsr >> 1) ^ ((lfsr[0] == 1) ? Word(0x80200003u) : Word(0));
+      NVUINTW(6) addr = nvhls::get_slc<6>(lfsr, 8);
+      if (lfsr[3] == 1 && !fifo.isFull()) {
+        fifo.push(nvhls::get_slc<16>(lfsr, 16));
+      }
+      if (lfsr[5] == 1 && !fifo.isEmpty()) {
+        Data d = fifo.pop();
+        mem.write(addr, 0, d ^ mem.read(addr));
+      }
+      checksum = (checksum << 1 | checksum >> 31) ^ Word(mem.read(addr));
+    }
+  }
+};
+
+SC_MODULE(testbench) {
+  CheckpointDut dut;
+  match::Checkpointer checkpointer;
+  sc_clock clk;
+  sc_signal<bool> rst;
+  int errors;
+
+  SC_CTOR(testbench)
+      : dut("dut"), checkpointer("checkpointer", SAVE_CYCLE, "checkpoint.output.bin"),
+        clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true), rst("rst"), errors(0) {
+    dut.clk(clk);
+    dut.rst(rst);
+    checkpointer.clk(clk);
+    checkpointer.rst(rst);
+    SC_THREAD(run);
+  }
+
+  // Waits until the checkpointer has counted the given cycle
+  void wait_cycle(uint64 cycle) {
+    while (checkpointer.Cycle() < cycle) {
+      wait(clk.negedge_event());
+      wait(SC_ZERO_TIME);
+    }
+  }
+
+  void run() {
+    rst = 0;
+    wait(2, SC_NS);
+    rst = 1;
+
+    wait_cycle(END_CYCLE);
+    CheckpointDut::Word lfsr = dut.lfsr, checksum = dut.checksum;
+    cout << "cycle " << checkpointer.Cycle() << " lfsr=" << hex << lfsr
+         << " checksum=" << checksum << dec << endl;
+
+    if (!checkpointer.Restore("checkpoint.output.bin") ||
+        checkpointer.Cycle() != SAVE_CYCLE) {
+      errors++;
+    }
+    wait_cycle(END_CYCLE);
+    cout << "cycle " << checkpointer.Cycle() << " lfsr=" << hex << dut.lfsr
+         << " checksum=" << dut.checksum << dec << endl;
+    if (dut.lfsr != lfsr || dut.checksum != checksum) {
+      cout << "Restored run diverged from the original run" << endl;
+      errors++;
+    }
+    sc_stop();
+  }
+};
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  sc_report_handler::set_actions(SC_ERROR, SC_DISPLAY);
+  testbench tb("tb");
+  sc_start();
+
+  bool rc = (sc_report_handler::get_count(SC_ERROR) > 0);
+  if (rc || tb.errors != 0) {
+    DCOUT("TESTBENCH FAIL" << endl);
+  } else {
+    DCOUT("TESTBENCH PASS" << endl);
+  }
+  return rc || tb.errors != 0;
+}
@@ -0,0 +1,328 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <match_scverify.h>
+#include <nvhls_types.h>
+#include <comptrees.h>
+#include <nvhls_sort.h>
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#ifndef NUM_ITERS
+#define NUM_ITERS 2000
+#endif
+
+template <unsigned int Width>
+NVUINTW(Width) get_rand_bits() {
+  NVUINTW(Width) x = 0;
+  for (unsigned int i = 0; i < Width; i++) {
+    x[i] = (rand() % 8 == 0);
+  }
+  // mostly sparse vectors, some dense ones and some empty ones
+  if (rand() % 4 == 0) x = ~x;
+  if (rand() % 16 == 0) x = 0;
+  return x;
+}
+
+// Checks PriEncTree, PriEncOneHot, PriEncFirstK, Thermometer and PrefixCount
+// against a linear scan from the LSB
+template <unsigned int Width, unsigned int K>
+bool check_prienc() {
+  typedef NVUINTW(Width) vec_t;
+  typedef NVINTW(nvhls::index_width<Width>::val + 1) idx_t;
+  typedef PriEncFirstK<vec_t, bool, idx_t, Width, K> FirstK;
+  typedef NVUINTW(nvhls::nbits<Width>::val) count_t;
+  bool ok = true;
+  for (int iter = 0; iter < NUM_ITERS; iter++) {
+    vec_t x = get_rand_bits<Width>();
+    bool comp_value = rand() % 2;
+
+    int ref_idx[K];
+    unsigned int ref_count = 0, ref_prefix[Width], ref_total = 0;
+    vec_t ref_onehot = 0, ref_thermo = 0;
+    bool found = false;
+    for (unsigned int i = 0; i < Width; i++) {
+      bool match = (x[i] == comp_value);
+      ref_prefix[i] = ref_total;
+      ref_total += match;
+      if (match && !found) ref_onehot[i] = 1;
+      found = found || match;
+      ref_thermo[i] = found;
+      if (match && ref_count < K) ref_idx[ref_count++] = i;
+    }
+    for (unsigned int j = ref_count; j < K; j++) ref_idx[j] = -1;
+
+    idx_t first = PriEncTree<vec_t, bool, idx_t, Width>::val(x, comp_value);
+    vec_t onehot = PriEncOneHot<vec_t, bool, vec_t, Width>::val(x, comp_value);
+    vec_t thermo = Thermometer<vec_t, bool, vec_t, Width>::val(x, comp_value);
+    idx_t idx[K];
+    typename FirstK::count_t count = FirstK::val(x, comp_value, idx);
+    count_t prefix[Width];
+    count_t total = PrefixCount<vec_t, bool, count_t, Width>::val(x, comp_value, prefix);
+
+    bool iter_ok = (first == ref_idx[0]) && (onehot == ref_onehot) && (thermo == ref_thermo) &&
+                   (onehot == (thermo & ~(thermo << 1))) && (count == ref_count) &&
+                   (total == ref_total);
+    for (unsigned int j = 0; j < K; j++) {
+      iter_ok = iter_ok && (idx[j] == ref_idx[j]);
+    }
+    for (unsigned int i = 0; i < Width; i++) {
+      iter_ok = iter_ok && (prefix[i] == ref_prefix[i]);
+    }
+    if (!iter_ok) {
+      std::cout << "Width " << Width << " K " << K << ": mismatch for input " << x
+                << " comp_value " << comp_value << std::endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+// Composition of affine maps x -> a * x + b, associative but not
+// commutative: apply(f, g) is f followed by g
+struct Affine {
+  NVUINT16 a, b;
+};
+
+struct PrefixOpAffine {
+  static Affine apply(const Affine& f, const Affine& g) {
+    Affine h;
+    h.a = g.a * f.a;
+    h.b = g.a * f.b + g.b;
+    return h;
+  }
+};
+
+// Checks ParallelPrefix with addition, max and the non-commutative affine
+// composition against a sequential scan, and Popcount (host builtin and
+// tree) against a bit loop
+template <unsigned int N, prefix_network Network>
+bool check_scan() {
+  bool ok = true;
+  for (int iter = 0; iter < NUM_ITERS; iter++) {
+    NVUINT16 sum[N], max[N], ref_sum[N], ref_max[N];
+    Affine aff[N], ref_aff[N];
+    for (unsigned int i = 0; i < N; i++) {
+      sum[i] = rand();
+      max[i] = rand();
+      aff[i].a = rand();
+      aff[i].b = rand();
+      ref_sum[i] = (i == 0) ? sum[i] : NVUINT16(ref_sum[i - 1] + sum[i]);
+      ref_max[i] = (i == 0 || max[i] > ref_max[i - 1]) ? max[i] : ref_max[i - 1];
+      ref_aff[i] = (i == 0) ? aff[i] : PrefixOpAffine::apply(ref_aff[i - 1], aff[i]);
+    }
+    ParallelPrefix<NVUINT16, N, PrefixOpAdd<NVUINT16>, Network>::val(sum);
+    ParallelPrefix<NVUINT16, N, PrefixOpMax<NVUINT16>, Network>::val(max);
+    ParallelPrefix<Affine, N, PrefixOpAffine, Network>::val(aff);
+    bool iter_ok = true;
+    for (unsigned int i = 0; i < N; i++) {
+      iter_ok = iter_ok && (sum[i] == ref_sum[i]) && (max[i] == ref_max[i]) &&
+                (aff[i].a == ref_aff[i].a) && (aff[i].b == ref_aff[i].b);
+    }
+    if (!iter_ok) {
+      std::cout << "ParallelPrefix N " << N << " network " << Network << ": mismatch" << std::endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+template <unsigned int Width>
+bool check_popcount() {
+  typedef NVUINTW(Width) vec_t;
+  typedef NVUINTW(nvhls::nbits<Width>::val) count_t;
+  bool ok = true;
+  for (int iter = 0; iter < NUM_ITERS; iter++) {
+    vec_t x = get_rand_bits<Width>();
+    unsigned int ref = 0;
+    for (unsigned int i = 0; i < Width; i++) ref += (x[i] == 1);
+    count_t fast = Popcount<vec_t, count_t, Width>::val(x);
+    count_t tree = Popcount<vec_t, count_t, Width>::val(x, 0);
+    if (fast != ref || tree != ref) {
+      std::cout << "Popcount width " << Width << ": mismatch for input " << x << std::endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+template <typename T>
+T get_rand_elem(unsigned int range) {
+  T x = 0;
+  x = (static_cast<uint64>(rand()) << 40) ^ (static_cast<uint64>(rand()) << 20) ^ rand();
+  // small ranges produce many equal keys
+  if (range > 0) x = x % range;
+  return x;
+}
+
+// Checks SortNetwork and PipelinedSort against std::sort, and that the
+// host kernels match the network stages
+template <typename T, unsigned int N, typename Network, bool Ascending, unsigned int S>
+bool check_sort() {
+  typedef nvhls::SortNetwork<T, N, Network, Ascending> Sorter;
+  typedef nvhls::PipelinedSort<T, N, S, Network, Ascending> PipeSorter;
+  PipeSorter pipe;
+  std::deque<std::vector<T> > expected;
+  std::deque<bool> expected_valid(PipeSorter::Latency, false);
+  bool ok = true;
+  for (int iter = 0; iter < NUM_ITERS; iter++) {
+    T a[N], b[N], out[N];
+    std::vector<T> ref;
+    unsigned int range = (iter % 2) ? 0 : 7;
+    for (unsigned int i = 0; i < N; i++) {
+      a[i] = get_rand_elem<T>(range);
+      b[i] = a[i];
+      ref.push_back(a[i]);
+    }
+    std::sort(ref.begin(), ref.end());
+    if (!Ascending) std::reverse(ref.begin(), ref.end());
+
+    Sorter::stages(a, 0, Sorter::NumStages);
+    nvhls::nv_scvector<T, N> vec;
+    for (unsigned int i = 0; i < N; i++) vec[i] = b[i];
+    Sorter::sort(vec);
+
+    bool in_valid = (rand() % 4 != 0);
+    bool out_valid = pipe.run(in_valid, b, out);
+    expected_valid.push_back(in_valid);
+    if (in_valid) expected.push_back(ref);
+    bool exp_valid = expected_valid.front();
+    expected_valid.pop_front();
+
+    bool iter_ok = (out_valid == exp_valid);
+    for (unsigned int i = 0; i < N; i++) {
+      iter_ok = iter_ok && (a[i] == ref[i]) && (vec[i] == ref[i]);
+    }
+    if (exp_valid) {
+      for (unsigned int i = 0; i < N; i++) iter_ok = iter_ok && (out[i] == expected.front()[i]);
+      expected.pop_front();
+    }
+    if (!iter_ok) {
+      std::cout << "Sort N " << N << " S " << S << ": mismatch in iteration " << iter << std::endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+// Checks TopK and PipelinedTopK against std::sort, and that the host kernels
+// return the same elements and indices as the network stages
+template <typename T, unsigned int N, unsigned int K, bool is_max, unsigned int S>
+bool check_top_k() {
+  typedef nvhls::TopK<T, N, K, is_max> Selector;
+  typedef nvhls::PipelinedTopK<T, N, K, S, is_max> PipeSelector;
+  typedef typename Selector::idx_t idx_t;
+  PipeSelector pipe;
+  std::deque<std::vector<std::pair<T, idx_t> > > expected;
+  std::deque<bool> expected_valid(PipeSelector::Latency, false);
+  bool ok = true;
+  for (int iter = 0; iter < NUM_ITERS; iter++) {
+    T in[N], out[K], pipe_out[K];
+    idx_t idx[K], pipe_idx[K];
+    std::vector<T> ref;
+    unsigned int range = (iter % 2) ? 0 : 5;
+    for (unsigned int i = 0; i < N; i++) {
+      in[i] = get_rand_elem<T>(range);
+      ref.push_back(in[i]);
+    }
+    std::sort(ref.begin(), ref.end());
+    if (is_max) std::reverse(ref.begin(), ref.end());
+
+    typename Selector::elem_t a[N];
+    Selector::load(in, a);
+    Selector::stages(a, 0, Selector::NumStages);
+    nvhls::nv_scvector<T, N> vec;
+    for (unsigned int i = 0; i < N; i++) vec[i] = in[i];
+    Selector::select(vec, out, idx);
+
+    bool iter_ok = true;
+    std::vector<bool> used(N, false);
+    std::vector<std::pair<T, idx_t> > result;
+    for (unsigned int j = 0; j < K; j++) {
+      iter_ok = iter_ok && (out[j] == ref[j]) && (in[idx[j]] == out[j]) && !used[idx[j]];
+      iter_ok = iter_ok && (a[j].key == out[j]) && (a[j].idx == idx[j]);
+      used[idx[j]] = true;
+      result.push_back(std::make_pair(out[j], idx[j]));
+    }
+
+    bool in_valid = (rand() % 4 != 0);
+    bool out_valid = pipe.run(in_valid, in, pipe_out, pipe_idx);
+    expected_valid.push_back(in_valid);
+    if (in_valid) expected.push_back(result);
+    bool exp_valid = expected_valid.front();
+    expected_valid.pop_front();
+    iter_ok = iter_ok && (out_valid == exp_valid);
+    if (exp_valid) {
+      for (unsigned int j = 0; j < K; j++) {
+        iter_ok = iter_ok && (pipe_out[j] == expected.front()[j].first) &&
+                  (pipe_idx[j] == expected.front()[j].second);
+      }
+      expected.pop_front();
+    }
+    if (!iter_ok) {
+      std::cout << "TopK N " << N << " K " << K << " S " << S << ": mismatch in iteration " << iter
+                << std::endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+CCS_MAIN(int argc, char *argv[]) {
+  bool ok = true;
+  ok = check_prienc<1, 1>() && ok;
+  ok = check_prienc<2, 2>() && ok;
+  ok = check_prienc<5, 3>() && ok;
+  ok = check_prienc<16, 4>() && ok;
+  ok = check_prienc<33, 2>() && ok;
+  ok = check_prienc<64, 8>() && ok;
+  ok = check_prienc<100, 1>() && ok;
+  ok = check_scan<1, PrefixKoggeStone>() && ok;
+  ok = check_scan<2, PrefixBrentKung>() && ok;
+  ok = check_scan<7, PrefixKoggeStone>() && ok;
+  ok = check_scan<7, PrefixBrentKung>() && ok;
+  ok = check_scan<7, PrefixSklansky>() && ok;
+  ok = check_scan<16, PrefixKoggeStone>() && ok;
+  ok = check_scan<16, PrefixBrentKung>() && ok;
+  ok = check_scan<16, PrefixSklansky>() && ok;
+  ok = check_scan<33, PrefixBrentKung>() && ok;
+  ok = check_scan<33, PrefixSklansky>() && ok;
+  ok = check_popcount<1>() && ok;
+  ok = check_popcount<13>() && ok;
+  ok = check_popcount<64>() && ok;
+  ok = check_popcount<65>() && ok;
+  ok = check_popcount<200>() && ok;
+  ok = check_sort<NVUINT8, 1, nvhls::BitonicNetwork, true, 1>() && ok;
+  ok = check_sort<NVUINT16, 16, nvhls::BitonicNetwork, true, 3>() && ok;
+  ok = check_sort<NVINT12, 32, nvhls::BitonicNetwork, false, 4>() && ok;
+  ok = check_sort<NVUINT16, 16, nvhls::OddEvenMergeNetwork, true, 2>() && ok;
+  ok = check_sort<NVINT64, 64, nvhls::OddEvenMergeNetwork, false, 21>() && ok;
+  ok = check_sort<NVUINT64, 8, nvhls::OddEvenMergeNetwork, true, 1>() && ok;
+  ok = check_sort<NVUINT128, 8, nvhls::BitonicNetwork, true, 2>() && ok;
+  ok = check_top_k<NVUINT16, 64, 4, true, 2>() && ok;
+  ok = check_top_k<NVINT8, 32, 1, true, 1>() && ok;
+  ok = check_top_k<NVINT32, 16, 16, false, 3>() && ok;
+  ok = check_top_k<NVUINT64, 128, 8, false, 4>() && ok;
+  ok = check_top_k<NVINT8, 2, 2, true, 1>() && ok;
+
+  if (ok) {
+    std::cout << "PASS" << std::endl;
+  } else {
+    std::cout << "FAIL" << std::endl;
+  }
+  CCS_RETURN(0);
+}
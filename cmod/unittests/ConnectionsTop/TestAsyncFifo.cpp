@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+//========================================================================
+// TestAsyncFifo.cpp
+//========================================================================
+
+#include <vector>
+#include <algorithm>
+#include <iomanip>
+#include <systemc.h>
+#include <mc_scverify.h>
+
+#include <nvhls_connections.h>
+#include <testbench/nvhls_rand.h>
+
+// Every harness runs an AsyncFifo between a source and a sink on two
+// different clocks. The simulation stops once all sinks have seen their
+// messages. With no stalls, the sink also checks that the FIFO sustains
+// about one message per cycle of the slower clock.
+
+static unsigned int num_tests = 0;
+static unsigned int num_done = 0;
+
+//------------------------------------------------------------------------
+// CdcSource: offers an incrementing sequence, stalling at random
+//------------------------------------------------------------------------
+
+template< typename T >
+class CdcSource : public sc_module {
+  SC_HAS_PROCESS(CdcSource);
+
+ public:
+  sc_in_clk           clk;
+  sc_in<bool>         rst;
+  Connections::Out<T, Connections::DIRECT_PORT> out;
+  unsigned int        stall_pct;
+
+  CdcSource(sc_module_name name, unsigned int stall_pct_)
+    : sc_module(name), clk("clk"), rst("rst"), out("out"), stall_pct(stall_pct_)
+  {
+#ifdef CONNECTIONS_SIM_ONLY
+    out.disable_spawn();
+#endif
+    SC_THREAD(tick);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void tick() {
+    out.val.write(false);
+    out.msg.write(0);
+    unsigned int next = 0;
+    bool val = false;
+    wait();
+    while (1) {
+      // A valid message is held until it is accepted
+      if (!val)
+        val = (unsigned int)(rand() % 100) >= stall_pct;
+      out.val.write(val);
+      out.msg.write(next);
+      wait();
+      if (val && out.rdy.read()) {
+        next++;
+        val = false;
+      }
+    }
+  }
+};
+
+//------------------------------------------------------------------------
+// CdcSink: takes messages, stalling at random, and checks their order
+//------------------------------------------------------------------------
+
+template< typename T >
+class CdcSink : public sc_module {
+  SC_HAS_PROCESS(CdcSink);
+
+ public:
+  sc_in_clk           clk;
+  sc_in<bool>         rst;
+  Connections::In<T, Connections::DIRECT_PORT> in_;
+  unsigned int        stall_pct;
+  unsigned int        max_count;
+  double              slow_period;
+  unsigned int        count;
+  sc_time             first;
+
+  CdcSink(sc_module_name name, unsigned int stall_pct_, unsigned int max_count_,
+          double slow_period_)
+    : sc_module(name), clk("clk"), rst("rst"), in_("in_"), stall_pct(stall_pct_),
+      max_count(max_count_), slow_period(slow_period_), count(0)
+  {
+#ifdef CONNECTIONS_SIM_ONLY
+    in_.disable_spawn();
+#endif
+    SC_THREAD(tick);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void tick() {
+    in_.rdy.write(false);
+    wait();
+    while (count < max_count) {
+      bool rdy = (unsigned int)(rand() % 100) >= stall_pct;
+      in_.rdy.write(rdy);
+      wait();
+      if (rdy && in_.val.read()) {
+        T msg = in_.msg.read();
+        if (msg != count) {
+          std::cout << "FAILED: " << name() << " msg[" << count << "] = " << msg
+                    << std::endl;
+          sc_stop();
+        }
+        if (count == 0)
+          first = sc_time_stamp();
+        count++;
+      }
+    }
+    in_.rdy.write(false);
+
+    // Messages per cycle of the slower clock, after the first one arrived
+    double elapsed = (sc_time_stamp() - first).to_seconds() * 1e9;
+    double throughput = (count - 1) * slow_period / elapsed;
+    std::cout << name() << ": " << count << " messages, " << std::fixed
+              << std::setprecision(3) << throughput
+              << " per slow clock cycle" << std::endl;
+    if (stall_pct == 0 && throughput < 0.95) {
+      std::cout << "FAILED: " << name() << " does not sustain full throughput"
+                << std::endl;
+      sc_stop();
+    }
+    if (++num_done == num_tests) {
+      std::cout << "PASS" << std::endl;
+      sc_stop();
+    }
+    while (1) wait();
+  }
+};
+
+//------------------------------------------------------------------------
+// TestHarness
+//------------------------------------------------------------------------
+
+template< typename T, unsigned int NumEntries >
+class TestHarness : public sc_module {
+  SC_HAS_PROCESS(TestHarness);
+
+ public:
+  sc_clock                      enq_clk;
+  sc_clock                      deq_clk;
+  sc_signal< bool >             enq_rst;
+  sc_signal< bool >             deq_rst;
+  CdcSource<T>                  src;
+  CdcSink<T>                    sink;
+
+  Connections::AsyncFifo<T, NumEntries, 2, Connections::DIRECT_PORT> fifo;
+
+  Connections::Combinational<T, Connections::DIRECT_PORT> enq_chan;
+  Connections::Combinational<T, Connections::DIRECT_PORT> deq_chan;
+
+  TestHarness(sc_module_name name, double enq_period, double deq_period,
+              unsigned int stall_pct, unsigned int max_count)
+    : sc_module(name),
+      enq_clk("enq_clk", enq_period, SC_NS, 0.5, 0, SC_NS, true),
+      deq_clk("deq_clk", deq_period, SC_NS, 0.5, 0, SC_NS, true),
+      enq_rst("enq_rst"),
+      deq_rst("deq_rst"),
+      src("src", stall_pct),
+      sink("sink", stall_pct, max_count, std::max(enq_period, deq_period)),
+      fifo("fifo")
+    {
+      src.clk(enq_clk);
+      src.rst(enq_rst);
+      sink.clk(deq_clk);
+      sink.rst(deq_rst);
+      fifo.enq_clk(enq_clk);
+      fifo.enq_rst(enq_rst);
+      fifo.deq_clk(deq_clk);
+      fifo.deq_rst(deq_rst);
+
+      src.out(enq_chan);
+      fifo.enq(enq_chan);
+      fifo.deq(deq_chan);
+      sink.in_(deq_chan);
+
+      num_tests++;
+      SC_THREAD(reset);
+    }
+
+    void reset() {
+      enq_rst.write(0);
+      deq_rst.write(0);
+      wait( 10, SC_NS );
+      enq_rst.write(1);
+      deq_rst.write(1);
+    }
+};
+
+//------------------------------------------------------------------------
+// sc_main
+//------------------------------------------------------------------------
+
+int sc_main(int argc, char* argv[]) {
+  nvhls::set_random_seed();
+  typedef sc_uint<32> Bits;
+  static const unsigned int MAX_COUNT = 400;
+
+  // Clock periods in ns: equal, enq faster, deq faster, close to 1:1, and
+  // random stalls on both sides.
+  TestHarness<Bits, 8> same("same", 1.0, 1.0, 0, MAX_COUNT);
+  TestHarness<Bits, 8> enq_fast("enq_fast", 1.0, 2.5, 0, MAX_COUNT);
+  TestHarness<Bits, 8> deq_fast("deq_fast", 2.5, 1.0, 0, MAX_COUNT);
+  TestHarness<Bits, 8> near("near", 1.0, 1.3, 0, MAX_COUNT);
+  TestHarness<Bits, 4> stalls("stalls", 1.0, 1.7, 30, MAX_COUNT);
+  sc_start();
+  return 0;
+}
@@ -52,8 +52,8 @@ class TestHarness : public sc_module {
     : sc_module(name),
       clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
       rst("rst"),
-      src("src", Pacer(0.3, 0.7), src_msgs),
-      sink("sink", Pacer(0.5, 0.7), sink_msgs),
+      src("src", nvhls::GeometricPacer(0.3, 0.7), src_msgs),
+      sink("sink", nvhls::GeometricPacer(0.5, 0.7), sink_msgs),
       buffer("buffer"),
       cycle(0)
     {
@@ -121,6 +121,13 @@ int sc_main(int argc, char* argv[]) {
   }
 
   TestHarness<Bits> test("test", src_msgs, sink_msgs);
+#ifdef CHROME_TRACE
+  // Record the buffer handshakes for chrome://tracing or ui.perfetto.dev
+  match::ChromeTrace::Get().Open("buffer_trace.output.json");
+#endif
   sc_start();
+#ifdef CHROME_TRACE
+  match::ChromeTrace::Get().Close();
+#endif
   return 0;
 }
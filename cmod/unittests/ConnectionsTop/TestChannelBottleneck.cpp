@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//========================================================================
+// TestChannelBottleneck.cpp
+//========================================================================
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_channel_bottleneck.h>
+
+static bool test_failed = false;
+
+static void Expect(bool ok, const char* msg) {
+  if (!ok) {
+    std::cout << "FAILED: " << msg << std::endl;
+    test_failed = true;
+  }
+}
+
+//------------------------------------------------------------------------
+// TestHarness: src -> Buffer a -> relay -> Buffer b -> slow sink
+//------------------------------------------------------------------------
+// The source and the relay can move a message every cycle, but the sink only
+// takes one every SINK_II cycles. Both buffers fill up, and every stall of
+// a, which the relay drains, must be traced through b to the sink: the root
+// cause is the consumer of b.
+
+class TestHarness : public sc_module {
+  SC_HAS_PROCESS(TestHarness);
+
+ public:
+  typedef NVUINTW(16) Msg;
+  static const unsigned int MAX_COUNT = 400;
+  static const unsigned int SINK_II = 4;
+
+  sc_clock                                   clk;
+  sc_signal< bool >                          rst;
+  Connections::Buffer< Msg, 2 >              a;
+  Connections::Buffer< Msg, 2 >              b;
+
+  Connections::Out< Msg >                    src;
+  Connections::In< Msg >                     relay_in;
+  Connections::Out< Msg >                    relay_out;
+  Connections::In< Msg >                     sink;
+  Connections::Combinational< Msg >          src_chan;
+  Connections::Combinational< Msg >          a_chan;
+  Connections::Combinational< Msg >          mid_chan;
+  Connections::Combinational< Msg >          b_chan;
+
+  bool done;
+
+  TestHarness(sc_module_name name)
+    : sc_module(name),
+      clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+      rst("rst"),
+      a("a"),
+      b("b"),
+      done(false)
+    {
+      a.clk(clk);
+      a.rst(rst);
+      b.clk(clk);
+      b.rst(rst);
+
+      src(src_chan);
+      a.enq(src_chan);
+      a.deq(a_chan);
+      relay_in(a_chan);
+      relay_out(mid_chan);
+      b.enq(mid_chan);
+      b.deq(b_chan);
+      sink(b_chan);
+
+      SC_THREAD(reset);
+
+      SC_THREAD(send);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+      SC_THREAD(relay);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+      SC_THREAD(receive);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+    }
+
+    void reset() {
+      rst.write(false);
+      wait(10, SC_NS);
+      rst.write(true);
+    }
+
+    void send() {
+      src.Reset();
+      wait();
+      for (unsigned int i = 0; i < MAX_COUNT; i++)
+        src.Push(i);
+      while (1) wait();
+    }
+
+    void relay() {
+      relay_in.Reset();
+      relay_out.Reset();
+      Msg m;
+      bool full = false;
+      wait();
+      while (1) {
+        if (full && relay_out.PushNB(m))
+          full = false;
+        if (!full)
+          full = relay_in.PopNB(m);
+        wait();
+      }
+    }
+
+    void receive() {
+      sink.Reset();
+      wait();
+      unsigned int i = 0, cycle = 0;
+      while (i < MAX_COUNT) {
+        Msg m;
+        if (cycle % SINK_II == 0 && sink.PopNB(m)) {
+          Expect(m == i, "message corrupted");
+          i++;
+        }
+        cycle++;
+        wait();
+      }
+      done = true;
+      sc_stop();
+    }
+};
+
+//------------------------------------------------------------------------
+// Analysis checks
+//------------------------------------------------------------------------
+
+static const unsigned int MARK_EVERY = 16;
+
+// Marks every MARK_EVERY-th message at the deq of a.
+static bool MarkA(const std::string& channel, const std::vector<unsigned char>& msg) {
+  unsigned int value = msg[0] | (msg[1] << 8);
+  return channel == "test.a" && value % MARK_EVERY == 0;
+}
+
+static void CheckAnalysis(const char* filename) {
+  // With the topology: rooted at the sink
+  match::ChannelBottlenecks chained;
+  chained.AddEdge("test.a", "test.b");
+  chained.SetMark(MarkA);
+  std::ifstream in(filename, std::ios::binary);
+  Expect(chained.Analyze(in), "analysis failed");
+  chained.Report(std::cout, 5);
+  const std::vector<match::ChannelBottlenecks::Cause>& causes = chained.Causes();
+  Expect(chained.PeriodPs() == 1000, "wrong cycle inferred");
+  Expect(!causes.empty() && causes[0].channel == "test.b" && !causes[0].full,
+         "consumer of b is not the top cause");
+  Expect(!causes.empty() && causes[0].cycles * 2 > chained.StallCycles(),
+         "consumer of b is not the main cause");
+  for (unsigned int i = 0; i < causes.size(); i++)
+    Expect(causes[i].channel != "test.a" || causes[i].full, "stall blamed on the relay");
+  Expect(chained.MarkedTransactions() == TestHarness::MAX_COUNT / MARK_EVERY,
+         "marked transactions missing");
+  Expect(chained.MarkedStallCycles() > 0 && !causes.empty() &&
+             causes[0].marked_cycles * 2 > chained.MarkedStallCycles(),
+         "marked stalls not attributed to the consumer of b");
+
+  // Without the topology: every channel blames its own consumer
+  match::ChannelBottlenecks local;
+  in.clear();
+  in.seekg(0);
+  Expect(local.Analyze(in), "analysis failed");
+  bool found_a = false;
+  for (unsigned int i = 0; i < local.Causes().size(); i++)
+    found_a |= local.Causes()[i].channel == "test.a" && !local.Causes()[i].full;
+  Expect(found_a, "stalls of a not charged to its consumer without edges");
+  Expect(local.StallCycles() == chained.StallCycles(), "stall cycles depend on the topology");
+
+  std::istringstream bad("not a dump");
+  Expect(!local.Analyze(bad), "bad dump accepted");
+}
+
+//------------------------------------------------------------------------
+// sc_main
+//------------------------------------------------------------------------
+
+int sc_main(int argc, char* argv[]) {
+  TestHarness test("test");
+
+  match::ChannelDump& dump = match::ChannelDump::Get();
+  Expect(dump.Open("channel_bottleneck.output.bin"), "cannot open dump");
+  sc_start();
+  dump.Close();
+
+  Expect(test.done, "messages missing");
+  CheckAnalysis("channel_bottleneck.output.bin");
+  if (test_failed) {
+    std::cout << "FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "PASS" << std::endl;
+  return 0;
+}
@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//========================================================================
+// TestChannelCounters.cpp
+//========================================================================
+
+#include <vector>
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_connections_counters.h>
+#include <axi/AxiCounterBank.h>
+#include <testbench/nvhls_rand.h>
+
+static bool test_failed = false;
+
+//------------------------------------------------------------------------
+// TestHarness: two CountedChannels read through an AxiCounterBank
+//------------------------------------------------------------------------
+// Channel 0 is a Buffer with a producer that sends every cycle and a
+// consumer that stalls at random, so it must count stalls. Channel 1 is a
+// Pipeline with a producer that sends every third cycle and a consumer that
+// is always ready, so it must count idle cycles and no stalls. Once all
+// messages have arrived intact and in order, the counters are disabled and
+// read over AXI: each channel must count every message as a transfer, and
+// the transfers, stalls and idle cycles of each channel must add up to the
+// cycles of the bank. Then the counters are cleared and must read zero.
+
+class TestHarness : public sc_module {
+  SC_HAS_PROCESS(TestHarness);
+
+ public:
+  typedef NVUINTW(32) Msg;
+  typedef axi::cfg::lite regCfg;
+  typedef axi::axi4<regCfg> reg_;
+  typedef AxiCounterBank<regCfg, 2, 32, 16> Bank;
+  typedef Bank::Counter Counter;
+  static const unsigned int MAX_COUNT = 500;
+  static const unsigned int STALL_PCT = 50;
+  static const unsigned int SLOW_INTERVAL = 3;
+  static const unsigned int BASE_ADDR = 0x100;
+
+  sc_clock                                   clk;
+  sc_signal< bool >                          rst;
+  Connections::CountedChannel<Msg, Connections::Buffer<Msg, 4> > buffer;
+  Connections::CountedChannel<Msg, Connections::Pipeline<Msg> >  pipeline;
+  Bank                                       bank;
+
+  Connections::Out< Msg >                    src[2];
+  Connections::In< Msg >                     sink[2];
+  Connections::Combinational< Msg >          enq[2];
+  Connections::Combinational< Msg >          deq[2];
+
+  sc_signal< bool >                          enable;
+  sc_signal< bool >                          clear;
+  sc_signal< Counter >                       transfers[2];
+  sc_signal< Counter >                       stalls[2];
+  sc_signal< Counter >                       idle[2];
+  sc_signal< NVUINTW(16) >                   base_addr;
+
+  reg_::read::master<>                       reg_rd;
+  reg_::write::master<>                      reg_wr;
+  reg_::read::chan<>                         reg_read;
+  reg_::write::chan<>                        reg_write;
+
+  std::vector<Msg> msgs;
+  unsigned int received[2];
+
+  TestHarness(sc_module_name name)
+    : sc_module(name),
+      clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+      rst("rst"),
+      buffer("buffer"),
+      pipeline("pipeline"),
+      bank("bank"),
+      reg_rd("reg_rd"),
+      reg_wr("reg_wr"),
+      reg_read("reg_read"),
+      reg_write("reg_write")
+    {
+      for (unsigned int i = 0; i < MAX_COUNT; ++i)
+        msgs.push_back(nvhls::get_rand<32>());
+      received[0] = received[1] = 0;
+
+      buffer.clk(clk);
+      buffer.rst(rst);
+      pipeline.clk(clk);
+      pipeline.rst(rst);
+      bank.clk(clk);
+      bank.reset_bar(rst);
+
+      src[0](enq[0]);
+      buffer.enq(enq[0]);
+      buffer.deq(deq[0]);
+      sink[0](deq[0]);
+      src[1](enq[1]);
+      pipeline.enq(enq[1]);
+      pipeline.deq(deq[1]);
+      sink[1](deq[1]);
+
+      buffer.enable(enable);
+      buffer.clear(clear);
+      buffer.transfers(transfers[0]);
+      buffer.stalls(stalls[0]);
+      buffer.idle(idle[0]);
+      pipeline.enable(enable);
+      pipeline.clear(clear);
+      pipeline.transfers(transfers[1]);
+      pipeline.stalls(stalls[1]);
+      pipeline.idle(idle[1]);
+
+      bank.enable(enable);
+      bank.clear(clear);
+      for (int i = 0; i < 2; i++) {
+        bank.transfers[i](transfers[i]);
+        bank.stalls[i](stalls[i]);
+        bank.idle[i](idle[i]);
+      }
+      bank.baseAddr(base_addr);
+      base_addr.write(BASE_ADDR);
+      reg_rd(reg_read);
+      reg_wr(reg_write);
+      bank.if_axi_rd(reg_read);
+      bank.if_axi_wr(reg_write);
+
+      SC_THREAD(reset);
+
+      SC_THREAD(send_fast);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+      SC_THREAD(send_slow);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+      SC_THREAD(receive_stalling);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+      SC_THREAD(receive_ready);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+      SC_THREAD(check);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+    }
+
+    void reset() {
+      rst.write(false);
+      wait(10, SC_NS);
+      rst.write(true);
+    }
+
+    void send_fast() {
+      src[0].Reset();
+      wait();
+      for (unsigned int i = 0; i < MAX_COUNT; i++)
+        src[0].Push(msgs[i]);
+      while (1) wait();
+    }
+
+    void send_slow() {
+      src[1].Reset();
+      wait();
+      for (unsigned int i = 0; i < MAX_COUNT; i++) {
+        src[1].Push(msgs[i]);
+        wait(SLOW_INTERVAL - 1);
+      }
+      while (1) wait();
+    }
+
+    void Receive(unsigned int channel, const Msg& m) {
+      if (m != msgs[received[channel]]) {
+        std::cout << "FAILED: channel " << channel << " message " << received[channel]
+                  << ": " << std::hex << m << " != " << msgs[received[channel]] << std::dec
+                  << std::endl;
+        test_failed = true;
+      }
+      received[channel]++;
+    }
+
+    void receive_stalling() {
+      sink[0].Reset();
+      wait();
+      while (1) {
+        Msg m;
+        bool stall = static_cast<unsigned int>(rand() % 100) < STALL_PCT;
+        if (!stall && sink[0].PopNB(m))
+          Receive(0, m);
+        wait();
+      }
+    }
+
+    void receive_ready() {
+      sink[1].Reset();
+      wait();
+      while (1) {
+        Msg m;
+        if (sink[1].PopNB(m))
+          Receive(1, m);
+        wait();
+      }
+    }
+
+    unsigned int ReadReg(unsigned int idx, bool expect_ok = true) {
+      reg_::AddrPayload ar;
+      ar.addr = BASE_ADDR + idx * Bank::bytesPerReg;
+      reg_rd.ar.Push(ar);
+      reg_::ReadPayload r = reg_rd.r.Pop();
+      if ((r.resp == reg_::Enc::XRESP::OKAY) != expect_ok) {
+        std::cout << "FAILED: unexpected read response from register " << idx << std::endl;
+        test_failed = true;
+      }
+      return static_cast<unsigned int>(r.data);
+    }
+
+    void WriteReg(unsigned int idx, unsigned int data, bool expect_ok = true) {
+      reg_::AddrPayload aw;
+      aw.addr = BASE_ADDR + idx * Bank::bytesPerReg;
+      reg_wr.aw.Push(aw);
+      reg_::WritePayload w;
+      w.data = data;
+      w.wstrb = ~0;
+      reg_wr.w.Push(w);
+      reg_::WRespPayload b = reg_wr.b.Pop();
+      if ((b.resp == reg_::Enc::XRESP::OKAY) != expect_ok) {
+        std::cout << "FAILED: unexpected write response to register " << idx << std::endl;
+        test_failed = true;
+      }
+    }
+
+    void Expect(bool ok, const char* msg) {
+      if (!ok) {
+        std::cout << "FAILED: " << msg << std::endl;
+        test_failed = true;
+      }
+    }
+
+    void CheckSums(const char* when) {
+      unsigned int cycles = ReadReg(Bank::CYCLES);
+      for (unsigned int c = 0; c < 2; c++) {
+        unsigned int base = Bank::channelsBase + c * Bank::regsPerChannel;
+        unsigned int t = ReadReg(base + Bank::TRANSFERS);
+        unsigned int s = ReadReg(base + Bank::STALLS);
+        unsigned int i = ReadReg(base + Bank::IDLE);
+        std::cout << when << ": channel " << c << ": " << t << " transfers, " << s
+                  << " stalls, " << i << " idle in " << cycles << " cycles" << std::endl;
+        Expect(t + s + i == cycles, "counters do not add up to the cycles");
+      }
+    }
+
+    void check() {
+      reg_rd.reset();
+      reg_wr.reset();
+      wait();
+      while (received[0] < MAX_COUNT || received[1] < MAX_COUNT)
+        wait();
+
+      Expect(ReadReg(Bank::CTRL) == Bank::CTRL_ENABLE, "counters not enabled after reset");
+      WriteReg(Bank::CTRL, 0);
+      Expect(ReadReg(Bank::CTRL) == 0, "counters not disabled");
+      CheckSums("Traffic");
+      unsigned int base0 = Bank::channelsBase, base1 = base0 + Bank::regsPerChannel;
+      Expect(ReadReg(base0 + Bank::TRANSFERS) == MAX_COUNT, "buffer transfers");
+      Expect(ReadReg(base1 + Bank::TRANSFERS) == MAX_COUNT, "pipeline transfers");
+      Expect(ReadReg(base0 + Bank::STALLS) > 0, "no stalls behind the stalling consumer");
+      Expect(ReadReg(base1 + Bank::STALLS) == 0, "stalls behind the ready consumer");
+      Expect(ReadReg(base1 + Bank::IDLE) > 0, "no idle cycles behind the slow producer");
+
+      // Out-of-range and read-only accesses
+      ReadReg(Bank::numReg, false);
+      WriteReg(Bank::CYCLES, 0, false);
+
+      // Clear, then count idle cycles for a while
+      WriteReg(Bank::CTRL, Bank::CTRL_CLEAR);
+      Expect(ReadReg(Bank::CYCLES) == 0, "cycles not cleared");
+      for (unsigned int c = 0; c < 2; c++) {
+        unsigned int base = Bank::channelsBase + c * Bank::regsPerChannel;
+        Expect(ReadReg(base + Bank::TRANSFERS) == 0 && ReadReg(base + Bank::STALLS) == 0 &&
+                   ReadReg(base + Bank::IDLE) == 0,
+               "channel counters not cleared");
+      }
+      WriteReg(Bank::CTRL, Bank::CTRL_ENABLE);
+      wait(20);
+      WriteReg(Bank::CTRL, 0);
+      CheckSums("Idle");
+
+      sc_stop();
+    }
+};
+
+//------------------------------------------------------------------------
+// sc_main
+//------------------------------------------------------------------------
+
+int sc_main(int argc, char* argv[]) {
+  nvhls::set_random_seed();
+  TestHarness test("test");
+  sc_start();
+  if (test_failed) {
+    std::cout << "FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "PASS" << std::endl;
+  return 0;
+}
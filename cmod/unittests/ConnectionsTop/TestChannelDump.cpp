@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//========================================================================
+// TestChannelDump.cpp
+//========================================================================
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_channel_dump.h>
+#include <testbench/nvhls_rand.h>
+
+static bool test_failed = false;
+
+static void Expect(bool ok, const char* msg) {
+  if (!ok) {
+    std::cout << "FAILED: " << msg << std::endl;
+    test_failed = true;
+  }
+}
+
+//------------------------------------------------------------------------
+// TestHarness: src -> Pipeline -> Buffer -> sink, and an unselected chain
+//------------------------------------------------------------------------
+// The sink stops taking messages for STALL_CYCLES cycles, which fills the
+// Buffer. The dump selects the main chain, triggers on the Buffer being full
+// and records for WINDOW_NS. The file must start with the trigger, hold only
+// samples of the selected channels inside the window, and its buffer
+// transfers must be consecutive messages in the order they were sent.
+
+class TestHarness : public sc_module {
+  SC_HAS_PROCESS(TestHarness);
+
+ public:
+  typedef NVUINTW(24) Msg;
+  static const unsigned int MAX_COUNT = 400;
+  static const unsigned int STALL_START = 100;
+  static const unsigned int STALL_CYCLES = 20;
+
+  sc_clock                                   clk;
+  sc_signal< bool >                          rst;
+  Connections::Pipeline< Msg >               pipe;
+  Connections::Buffer< Msg, 4 >              buffer;
+  Connections::Pipeline< Msg >               other;
+
+  Connections::Out< Msg >                    src;
+  Connections::In< Msg >                     sink;
+  Connections::Out< Msg >                    other_src;
+  Connections::In< Msg >                     other_sink;
+  Connections::Combinational< Msg >          enq_chan;
+  Connections::Combinational< Msg >          mid_chan;
+  Connections::Combinational< Msg >          deq_chan;
+  Connections::Combinational< Msg >          other_enq;
+  Connections::Combinational< Msg >          other_deq;
+
+  std::vector<Msg> msgs;
+  bool done;
+
+  TestHarness(sc_module_name name)
+    : sc_module(name),
+      clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+      rst("rst"),
+      pipe("pipe"),
+      buffer("buffer"),
+      other("other"),
+      done(false)
+    {
+      for (unsigned int i = 0; i < MAX_COUNT; ++i)
+        msgs.push_back(nvhls::get_rand<24>());
+
+      pipe.clk(clk);
+      pipe.rst(rst);
+      buffer.clk(clk);
+      buffer.rst(rst);
+      other.clk(clk);
+      other.rst(rst);
+
+      src(enq_chan);
+      pipe.enq(enq_chan);
+      pipe.deq(mid_chan);
+      buffer.enq(mid_chan);
+      buffer.deq(deq_chan);
+      sink(deq_chan);
+      other_src(other_enq);
+      other.enq(other_enq);
+      other.deq(other_deq);
+      other_sink(other_deq);
+
+      SC_THREAD(reset);
+
+      SC_THREAD(send);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+      SC_THREAD(receive);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+      SC_THREAD(other_traffic);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+    }
+
+    void reset() {
+      rst.write(false);
+      wait(10, SC_NS);
+      rst.write(true);
+    }
+
+    void send() {
+      src.Reset();
+      wait();
+      for (unsigned int i = 0; i < MAX_COUNT; i++)
+        src.Push(msgs[i]);
+      while (1) wait();
+    }
+
+    void receive() {
+      sink.Reset();
+      wait();
+      unsigned int i = 0, cycle = 0;
+      while (i < MAX_COUNT) {
+        Msg m;
+        bool stall = cycle >= STALL_START && cycle < STALL_START + STALL_CYCLES;
+        if (!stall && sink.PopNB(m)) {
+          Expect(m == msgs[i], "message corrupted");
+          i++;
+        }
+        cycle++;
+        wait();
+      }
+      done = true;
+      sc_stop();
+    }
+
+    void other_traffic() {
+      other_src.Reset();
+      other_sink.Reset();
+      wait();
+      for (unsigned int i = 0;; i++) {
+        other_src.PushNB(i);
+        Msg m;
+        other_sink.PopNB(m);
+        wait();
+      }
+    }
+};
+
+//------------------------------------------------------------------------
+// Dump checks
+//------------------------------------------------------------------------
+
+static const double WINDOW_NS = 50;
+
+static void CheckDump(const char* filename, const TestHarness& test) {
+  std::ifstream in(filename, std::ios::binary);
+  match::BinaryTraceReader reader(in);
+  char magic[4];
+  unsigned int version;
+  Expect(in.read(magic, 4) && memcmp(magic, "MCHD", 4) == 0 && reader.Int(version) &&
+             version == match::ChannelDump::kVersion,
+         "bad dump header");
+
+  std::vector<std::string> names;
+  std::vector<unsigned int> widths;
+  uint64 trigger_ps = 0;
+  bool triggered = false;
+  unsigned int samples = 0, transfers = 0, first = 0;
+  unsigned char type;
+  while (reader.Int(type)) {
+    uint64 time_ps;
+    unsigned int id, capacity, width, occupancy;
+    unsigned char flags;
+    std::string name;
+    if (type == match::ChannelDump::kChannelRecord) {
+      reader.Int(id);
+      reader.Int(capacity);
+      reader.Int(width);
+      reader.String(name);
+      Expect(id == names.size(), "channel ids not consecutive");
+      Expect(name == "test.pipe" || name == "test.buffer", "unselected channel dumped");
+      names.push_back(name);
+      widths.push_back(width);
+    } else if (type == match::ChannelDump::kTriggerRecord) {
+      reader.Int(time_ps);
+      reader.String(name);
+      Expect(!triggered && samples == 0, "trigger not first");
+      Expect(name == "test.buffer", "wrong channel triggered");
+      triggered = true;
+      trigger_ps = time_ps;
+    } else if (type == match::ChannelDump::kSampleRecord) {
+      reader.Int(time_ps);
+      reader.Int(id);
+      reader.Int(flags);
+      reader.Int(occupancy);
+      Expect(triggered && time_ps >= trigger_ps &&
+                 time_ps < trigger_ps + static_cast<uint64>(WINDOW_NS * 1000),
+             "sample outside the window");
+      samples++;
+      if (flags & match::ChannelDump::kMsg) {
+        std::vector<unsigned char> bytes((widths[id] + 7) / 8);
+        in.read(reinterpret_cast<char*>(&bytes[0]), bytes.size());
+        unsigned int value = 0;
+        for (unsigned int b = 0; b < bytes.size() && b < 4; b++)
+          value |= bytes[b] << (8 * b);
+        bool transfer = (flags & match::ChannelDump::kDeqVal) &&
+                        (flags & match::ChannelDump::kDeqRdy);
+        if (names[id] == "test.buffer" && transfer) {
+          // Transfers are consecutive messages
+          if (transfers == 0) {
+            while (first < TestHarness::MAX_COUNT && test.msgs[first] != value)
+              first++;
+          }
+          Expect(first + transfers < TestHarness::MAX_COUNT &&
+                     test.msgs[first + transfers] == value,
+                 "dumped transfers out of order");
+          transfers++;
+        }
+      }
+    } else {
+      Expect(false, "bad record type");
+      break;
+    }
+  }
+  Expect(triggered, "trigger did not fire");
+  Expect(names.size() == 2, "selected channels missing");
+  Expect(transfers > 0, "no transfers dumped");
+  std::cout << "Dump: trigger at " << trigger_ps << " ps, " << samples << " samples, "
+            << transfers << " buffer transfers" << std::endl;
+
+  // VCD conversion
+  in.clear();
+  in.seekg(0);
+  std::ostringstream vcd;
+  Expect(match::ChannelDumpToVcd(in, vcd), "VCD conversion failed");
+  Expect(vcd.str().find("$scope module buffer $end") != std::string::npos &&
+             vcd.str().find("deq_msg $end") != std::string::npos &&
+             vcd.str().find("$enddefinitions $end") != std::string::npos,
+         "VCD header incomplete");
+  std::ofstream("channel_dump.output.vcd") << vcd.str();
+}
+
+//------------------------------------------------------------------------
+// sc_main
+//------------------------------------------------------------------------
+
+int sc_main(int argc, char* argv[]) {
+  nvhls::set_random_seed();
+  TestHarness test("test");
+
+  match::ChannelDump& dump = match::ChannelDump::Get();
+  dump.Select("test.pipe");
+  dump.Select("test.buffer");
+  dump.TriggerOnFull("test.buffer", sc_time(WINDOW_NS, SC_NS));
+  Expect(dump.Open("channel_dump.output.bin"), "cannot open dump");
+  sc_start();
+  dump.Close();
+
+  Expect(test.done, "messages missing");
+  CheckDump("channel_dump.output.bin", test);
+  if (test_failed) {
+    std::cout << "FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "PASS" << std::endl;
+  return 0;
+}
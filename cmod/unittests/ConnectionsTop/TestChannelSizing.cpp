@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//========================================================================
+// TestChannelSizing.cpp
+//========================================================================
+
+#include <fstream>
+#include <sstream>
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_annotate.h>
+
+static bool test_failed = false;
+
+static void Expect(bool ok, const char* msg) {
+  if (!ok) {
+    std::cout << "FAILED: " << msg << std::endl;
+    test_failed = true;
+  }
+}
+
+typedef NVUINTW(16) Msg;
+
+//------------------------------------------------------------------------
+// Blocks
+//------------------------------------------------------------------------
+
+// Pushes burst messages back to back, then idles for idle cycles
+class Source : public sc_module {
+  SC_HAS_PROCESS(Source);
+
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  Connections::Out<Msg> out;
+  const unsigned int burst, idle;
+
+  Source(sc_module_name name, unsigned int burst_, unsigned int idle_)
+      : sc_module(name), clk("clk"), rst("rst"), out("out"), burst(burst_), idle(idle_) {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void run() {
+    out.Reset();
+    wait();
+    for (Msg i = 0;; i++) {
+      out.Push(i);
+      if ((i + 1) % burst == 0) {
+        for (unsigned int c = 0; c < idle; c++)
+          wait();
+      }
+    }
+  }
+};
+
+// Pops a message at most every ii cycles
+class Sink : public sc_module {
+  SC_HAS_PROCESS(Sink);
+
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  Connections::In<Msg> in;
+  const unsigned int ii;
+
+  Sink(sc_module_name name, unsigned int ii_)
+      : sc_module(name), clk("clk"), rst("rst"), in("in"), ii(ii_) {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void run() {
+    in.Reset();
+    wait();
+    while (1) {
+      in.Pop();
+      for (unsigned int c = 1; c < ii; c++)
+        wait();
+    }
+  }
+};
+
+// Source -> Buffer -> Sink
+template <unsigned int Capacity>
+class Chain : public sc_module {
+ public:
+  Source src;
+  Connections::Buffer<Msg, Capacity> buf;
+  Sink sink;
+  Connections::Combinational<Msg> in, out;
+
+  Chain(sc_module_name name, sc_clock& clk, sc_signal<bool>& rst, unsigned int burst,
+        unsigned int idle, unsigned int ii)
+      : sc_module(name), src("src", burst, idle), buf("buf"), sink("sink", ii) {
+    src.clk(clk);
+    src.rst(rst);
+    buf.clk(clk);
+    buf.rst(rst);
+    sink.clk(clk);
+    sink.rst(rst);
+    src.out(in);
+    buf.enq(in);
+    buf.deq(out);
+    sink.in(out);
+  }
+};
+
+//------------------------------------------------------------------------
+// TestHarness
+//------------------------------------------------------------------------
+// burst: bursts of BURST messages into a Buffer of 2 that drains at half
+//        the rate, so the producer stalls in every burst;
+// wide:  the same traffic into a Buffer of 16, which never stalls;
+// slow:  one message every 4 cycles into a Buffer of 8, which never holds
+//        more than 1;
+// bound: a producer that never idles into a consumer at half its rate.
+
+class TestHarness : public sc_module {
+  SC_HAS_PROCESS(TestHarness);
+
+ public:
+  static const unsigned int BURST = 8;
+  static const unsigned int IDLE = 24;
+
+  sc_clock clk;
+  sc_signal<bool> rst;
+  Chain<2> burst;
+  Chain<16> wide;
+  Chain<8> slow;
+  Chain<2> bound;
+
+  TestHarness(sc_module_name name)
+      : sc_module(name),
+        clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+        rst("rst"),
+        burst("burst", clk, rst, BURST, IDLE, 2),
+        wide("wide", clk, rst, BURST, IDLE, 2),
+        slow("slow", clk, rst, 1, 3, 1),
+        bound("bound", clk, rst, 1, 0, 2) {
+    SC_THREAD(reset);
+  }
+
+  void reset() {
+    rst.write(false);
+    wait(10, SC_NS);
+    rst.write(true);
+  }
+};
+
+static const nvhls::ChannelSizing::Channel* Find(const nvhls::ChannelSizing& sizing,
+                                                 const std::string& name) {
+  for (unsigned int i = 0; i < sizing.Channels().size(); i++) {
+    if (sizing.Channels()[i].name == name)
+      return &sizing.Channels()[i];
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------
+// sc_main
+//------------------------------------------------------------------------
+
+static const unsigned int RUN_CYCLES = 2000;
+
+int sc_main(int argc, char* argv[]) {
+  TestHarness test("test");
+  Connections::ChannelProfiler::Get().Enable();
+  sc_start(RUN_CYCLES, SC_NS);
+
+  // The profile of this run, read back as by a follow-up run
+  std::stringstream profile;
+  Connections::ChannelProfiler::Get().Save(profile);
+  std::cout << profile.str();
+  nvhls::ChannelSizing sizing(true, 32);
+  Expect(sizing.Load(profile), "profile not loaded");
+  sizing.Propose();
+  sizing.Report(std::cout);
+
+  const nvhls::ChannelSizing::Channel* burst = Find(sizing, "test.burst.buf");
+  const nvhls::ChannelSizing::Channel* wide = Find(sizing, "test.wide.buf");
+  const nvhls::ChannelSizing::Channel* slow = Find(sizing, "test.slow.buf");
+  const nvhls::ChannelSizing::Channel* bound = Find(sizing, "test.bound.buf");
+  Expect(burst && wide && slow && bound, "channels missing from the profile");
+  if (burst && wide && slow && bound) {
+    Expect(burst->blocked > 0 && burst->proposed > 2 && !burst->consumer_bound,
+           "stalled burst channel not grown");
+    // The channel that does not stall needs no more than the proposal
+    Expect(wide->blocked == 0 && wide->max_occupancy <= burst->proposed,
+           "burst channel proposal too small");
+    Expect(wide->proposed == wide->max_occupancy, "wide channel not shrunk");
+    Expect(slow->max_occupancy == 1 && slow->proposed == 1, "slow channel not shrunk");
+    Expect(bound->consumer_bound && bound->proposed == 32, "consumer-bound channel not found");
+  }
+
+  // Applied to a Connections annotation of the burst channel
+  {
+    std::ofstream json("channel_sizing.output.json");
+    json << "{\"channels\": {"
+         << "\"burst.in_BA\": {\"latency\": 0, \"capacity\": 0,"
+         << " \"src_name\": \"burst.src.out\", \"dest_name\": \"burst.buf.enq\"},"
+         << "\"burst.out_BA\": {\"latency\": 0, \"capacity\": 0,"
+         << " \"src_name\": \"burst.buf.deq\", \"dest_name\": \"burst.sink.in\"}}}" << std::endl;
+  }
+  Expect(sizing.Apply("channel_sizing.output.json", "channel_sizing.sized.input.json", "test") == 1,
+         "annotation not applied");
+  std::ifstream file("channel_sizing.sized.input.json");
+  std::stringstream text;
+  text << file.rdbuf();
+  rapidjson::Document doc;
+  doc.Parse(text.str().c_str());
+  Expect(!doc.HasParseError() && doc.IsObject() && doc.HasMember("channels"),
+         "sized annotation not valid");
+  if (burst && !doc.HasParseError() && doc.IsObject() && doc.HasMember("channels")) {
+    const rapidjson::Value& channels = doc["channels"];
+    Expect(channels["burst.in_BA"]["capacity"].GetUint() == burst->proposed - 2,
+           "enq channel capacity not raised");
+    Expect(channels["burst.out_BA"]["capacity"].GetUint() == 0, "deq channel capacity changed");
+  }
+
+  if (test_failed) {
+    std::cout << "FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "PASS" << std::endl;
+  return 0;
+}
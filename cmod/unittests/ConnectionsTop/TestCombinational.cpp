@@ -46,8 +46,8 @@ class TestHarnessBlocking : public sc_module {
     : sc_module(name),
       clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
       rst("rst"),
-      src("src", Pacer(0.3, 0.7), src_msgs),
-      sink("sink", Pacer(0.2, 0.5), sink_msgs),
+      src("src", nvhls::GeometricPacer(0.3, 0.7), src_msgs),
+      sink("sink", nvhls::GeometricPacer(0.2, 0.5), sink_msgs),
       cycle(0)
     {
       src.clk(clk);
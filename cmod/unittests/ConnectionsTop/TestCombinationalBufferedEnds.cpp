@@ -25,11 +25,17 @@
 #include "TestSource.h"
 #include "TestSink.h"
 
+// Build with -DBUFFERED_PORTS_BYPASS=true to test the bypass mode of
+// InBuffered and OutBuffered
+#ifndef BUFFERED_PORTS_BYPASS
+#define BUFFERED_PORTS_BYPASS false
+#endif
+
 //------------------------------------------------------------------------
 // TestHarnessBuffered
 //------------------------------------------------------------------------
 
-template< typename T, int W >
+template< typename T, int W, bool Bypass >
 class TestHarnessBuffered : public sc_module {
   SC_HAS_PROCESS(TestHarnessBuffered);
 
@@ -37,8 +43,8 @@ class TestHarnessBuffered : public sc_module {
   // Module Interface
   sc_clock              clk;
   sc_signal< bool >     rst;
-  TestSourceBuffered<T, W> src;
-  TestSinkBuffered<T, W>   sink;
+  TestSourceBuffered<T, W, Bypass> src;
+  TestSinkBuffered<T, W, Bypass>   sink;
 
   Connections::Combinational<T> chan;
 
@@ -46,8 +52,8 @@ class TestHarnessBuffered : public sc_module {
     : sc_module(name),
       clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
       rst("rst"),
-      src("src", Pacer(0.3, 0.7), src_msgs),
-      sink("sink", Pacer(0.2, 0.5), sink_msgs),
+      src("src", nvhls::GeometricPacer(0.3, 0.7), src_msgs),
+      sink("sink", nvhls::GeometricPacer(0.2, 0.5), sink_msgs),
       cycle(0)
     {
       src.clk(clk);
@@ -104,7 +110,7 @@ int sc_main(int argc, char* argv[]) {
     sink_msgs.push_back(i);
   }
 
-  TestHarnessBuffered<Bits, kBufferSize> test("test_blocking", src_msgs, sink_msgs);
+  TestHarnessBuffered<Bits, kBufferSize, BUFFERED_PORTS_BYPASS> test("test_blocking", src_msgs, sink_msgs);
   sc_start();
   return 0;
 }
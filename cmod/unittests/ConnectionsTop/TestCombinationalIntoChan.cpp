@@ -37,7 +37,7 @@ class TestHarnessBlocking : public sc_module {
   // Module Interface
   sc_clock              clk;
   sc_signal< bool >     rst;
-  Pacer                 src_pacer;
+  nvhls::GeometricPacer src_pacer;
   TestSinkBlocking<T>   sink;
 
   Connections::Combinational<T> chan;
@@ -47,8 +47,8 @@ class TestHarnessBlocking : public sc_module {
     : sc_module(name),
       clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
       rst("rst"),
-      src_pacer(0.3, 0.7),
-      sink("sink", Pacer(0.2, 0.5), sink_msgs),
+      src_pacer(0.3, 0.7, std::string(this->name()) + ".src_pacer"),
+      sink("sink", nvhls::GeometricPacer(0.2, 0.5), sink_msgs),
       src_msgs(src_msgs_),
       cycle(0)
     {
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+//========================================================================
+// TestCreditLink.cpp
+//========================================================================
+
+#include <vector>
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_connections_credit.h>
+#include <testbench/nvhls_rand.h>
+
+#ifndef STAGES
+#define STAGES 2
+#endif
+#ifndef CREDITS
+#define CREDITS (2 * STAGES + 3)
+#endif
+
+static bool test_failed = false;
+
+//------------------------------------------------------------------------
+// TestHarness: OutCredit -> CreditPipe -> InCredit
+//------------------------------------------------------------------------
+// The first MAX_COUNT messages go to a sink that is always ready and must
+// arrive one per cycle once Credits covers the round trip of 2 * STAGES + 3
+// cycles. The next MAX_COUNT go to a sink that stalls at random and must
+// still arrive intact and in order, without overflowing the InCredit.
+
+class TestHarness : public sc_module {
+  SC_HAS_PROCESS(TestHarness);
+
+ public:
+  typedef NVUINTW(48) Msg;
+  static const unsigned int MAX_COUNT = 500;
+  static const unsigned int STALL_PCT = 30;
+  static const unsigned int ROUND_TRIP = 2 * STAGES + 3;
+
+  sc_clock                                   clk;
+  sc_signal< bool >                          rst;
+  Connections::OutCredit<Msg, CREDITS>       tx;
+  Connections::CreditPipe<Msg, STAGES>       pipe;
+  Connections::InCredit<Msg, CREDITS>        rx;
+  Connections::CreditLink<Msg>               tx_link;
+  Connections::CreditLink<Msg>               rx_link;
+
+  Connections::Out< Msg >                    src;
+  Connections::In< Msg >                     sink;
+  Connections::Combinational< Msg >          enq;
+  Connections::Combinational< Msg >          deq;
+
+  std::vector<Msg> msgs;
+
+  TestHarness(sc_module_name name)
+    : sc_module(name),
+      clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+      rst("rst"),
+      tx("tx"),
+      pipe("pipe"),
+      rx("rx"),
+      tx_link("tx_link"),
+      rx_link("rx_link"),
+      src("src"),
+      sink("sink"),
+      enq("enq"),
+      deq("deq")
+    {
+      for (unsigned int i = 0; i < 2 * MAX_COUNT; ++i)
+        msgs.push_back(nvhls::get_rand<48>());
+
+      tx.clk(clk);
+      tx.rst(rst);
+      pipe.clk(clk);
+      pipe.rst(rst);
+      rx.clk(clk);
+      rx.rst(rst);
+
+      src(enq);
+      tx.enq(enq);
+      tx.Bind(tx_link);
+      pipe.BindIn(tx_link);
+      pipe.BindOut(rx_link);
+      rx.Bind(rx_link);
+      rx.deq(deq);
+      sink(deq);
+
+      SC_THREAD(reset);
+
+      SC_THREAD(send);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+      SC_THREAD(receive);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+    }
+
+    void reset() {
+      rst.write(false);
+      wait(10, SC_NS);
+      rst.write(true);
+    }
+
+    void send() {
+      src.Reset();
+      wait();
+      unsigned int i = 0;
+      while (1) {
+        if (i < 2 * MAX_COUNT && src.PushNB(msgs[i])) i++;
+        wait();
+      }
+    }
+
+    void receive() {
+      sink.Reset();
+      wait();
+      unsigned int i = 0, cycle = 0, first = 0, last = 0;
+      while (i < 2 * MAX_COUNT) {
+        Msg m;
+        bool stall = (i >= MAX_COUNT) &&
+                     (static_cast<unsigned int>(rand() % 100) < STALL_PCT);
+        if (!stall && sink.PopNB(m)) {
+          if (m != msgs[i]) {
+            std::cout << "FAILED: message " << i << ": " << std::hex << m
+                      << " != " << msgs[i] << std::dec << std::endl;
+            test_failed = true;
+          }
+          if (i == 0) first = cycle;
+          if (i == MAX_COUNT - 1) last = cycle;
+          i++;
+        }
+        cycle++;
+        wait();
+      }
+      unsigned int cycles = last - first + 1;
+      std::cout << STAGES << " stages, " << CREDITS << " credits: " << MAX_COUNT
+                << " messages in " << cycles << " cycles" << std::endl;
+      // Throughput is min(1, Credits / round trip)
+      unsigned int expected = (CREDITS >= ROUND_TRIP)
+          ? MAX_COUNT : (MAX_COUNT * ROUND_TRIP + CREDITS - 1) / CREDITS;
+      if (cycles > expected + ROUND_TRIP) {
+        std::cout << "FAILED: expected at most " << expected + ROUND_TRIP
+                  << " cycles" << std::endl;
+        test_failed = true;
+      }
+      sc_stop();
+    }
+};
+
+//------------------------------------------------------------------------
+// sc_main
+//------------------------------------------------------------------------
+
+int sc_main(int argc, char* argv[]) {
+  nvhls::set_random_seed();
+  TestHarness test("test");
+  sc_start();
+  if (test_failed) {
+    std::cout << "FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "PASS" << std::endl;
+  return 0;
+}
@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+//========================================================================
+// TestDirectCombinational.cpp
+//========================================================================
+
+#include <vector>
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_connections_direct.h>
+#include <CombinationalBufferedPorts.h>
+#include <testbench/nvhls_rand.h>
+
+static bool test_failed = false;
+
+typedef NVUINTW(16) Msg;
+static const unsigned int NUM_STAGES = 16;
+static const unsigned int MAX_COUNT = 1000;
+static const unsigned int STALL_PCT = 30;
+// Cycles allowed on top of one message per cycle
+static const unsigned int SLACK = 2 * NUM_STAGES + 8;
+
+// Sends i = 0 .. 2 * MAX_COUNT - 1, the first MAX_COUNT back to back and the
+// rest with random stalls
+template <bool Direct>
+class Source : public sc_module {
+  SC_HAS_PROCESS(Source);
+
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  typename Connections::CombinationalSel<Msg, Direct>::out_t out;
+
+  Source(sc_module_name name) : sc_module(name), clk("clk"), rst("rst"), out("out") {
+    SC_THREAD(send);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void send() {
+    out.Reset();
+    wait();
+    unsigned int i = 0;
+    while (1) {
+      bool stall = (i >= MAX_COUNT) &&
+                   (static_cast<unsigned int>(rand() % 100) < STALL_PCT);
+      if (!stall && i < 2 * MAX_COUNT && out.PushNB(i)) i++;
+      wait();
+    }
+  }
+};
+
+// Forwards every message with a register, so a chain of stages sustains one
+// message per cycle
+template <bool Direct>
+class Stage : public sc_module {
+  SC_HAS_PROCESS(Stage);
+
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  typename Connections::CombinationalSel<Msg, Direct>::in_t in;
+  typename Connections::CombinationalSel<Msg, Direct>::out_t out;
+
+  Stage(sc_module_name name) : sc_module(name), clk("clk"), rst("rst"), in("in"), out("out") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void run() {
+    in.Reset();
+    out.Reset();
+    Msg m;
+    bool held = false;
+    wait();
+    while (1) {
+      if (!held) held = in.PopNB(m);
+      if (held && out.PushNB(m)) held = false;
+      wait();
+    }
+  }
+};
+
+// Forwards messages between two threads of one module through a
+// CombinationalBufferedPorts, in the style of ConnectionsRecipes/Adder4
+template <bool Direct>
+class BufferedStage : public sc_module {
+  SC_HAS_PROCESS(BufferedStage);
+
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  typename Connections::CombinationalSel<Msg, Direct>::in_t in;
+  typename Connections::CombinationalSel<Msg, Direct>::out_t out;
+
+  Connections::CombinationalBufferedPorts<Msg, 2, 2,
+      typename Connections::CombinationalSel<Msg, Direct>::chan_t> chan;
+
+  BufferedStage(sc_module_name name)
+      : sc_module(name), clk("clk"), rst("rst"), in("in"), out("out") {
+    SC_THREAD(write);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    SC_THREAD(read);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void write() {
+    in.Reset();
+    chan.ResetWrite();
+    wait();
+    while (1) {
+      Msg m;
+      if (!chan.FullWrite() && in.PopNB(m)) chan.Push(m);
+      chan.TransferNBWrite();
+      wait();
+    }
+  }
+
+  void read() {
+    out.Reset();
+    chan.ResetRead();
+    wait();
+    while (1) {
+      chan.TransferNBRead();
+      if (!chan.EmptyRead() && out.PushNB(chan.PeekRead())) chan.IncrHeadRead();
+      wait();
+    }
+  }
+};
+
+// Takes 2 * MAX_COUNT messages, checks their order and that the first
+// MAX_COUNT, taken back to back, arrive one per cycle
+template <bool Direct>
+class Sink : public sc_module {
+  SC_HAS_PROCESS(Sink);
+
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  typename Connections::CombinationalSel<Msg, Direct>::in_t in;
+  bool done;
+
+  Sink(sc_module_name name) : sc_module(name), clk("clk"), rst("rst"), in("in"), done(false) {
+    SC_THREAD(receive);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void receive() {
+    in.Reset();
+    wait();
+    unsigned int i = 0, cycle = 0, first = 0, last = 0;
+    while (i < 2 * MAX_COUNT) {
+      Msg m;
+      bool stall = (i >= MAX_COUNT) &&
+                   (static_cast<unsigned int>(rand() % 100) < STALL_PCT);
+      if (!stall && in.PopNB(m)) {
+        if (m != i) {
+          std::cout << "FAILED: " << name() << ": message " << i << " is " << m << std::endl;
+          test_failed = true;
+        }
+        if (i == 0) first = cycle;
+        if (i == MAX_COUNT - 1) last = cycle;
+        i++;
+      }
+      cycle++;
+      wait();
+    }
+    unsigned int cycles = last - first + 1;
+    std::cout << name() << ": " << MAX_COUNT << " messages in " << cycles << " cycles" << std::endl;
+    if (Direct && cycles > MAX_COUNT + SLACK) {
+      std::cout << "FAILED: " << name() << ": expected one message per cycle" << std::endl;
+      test_failed = true;
+    }
+    done = true;
+  }
+};
+
+//------------------------------------------------------------------------
+// Chain
+//------------------------------------------------------------------------
+// Source -> NUM_STAGES Stages -> BufferedStage -> Sink, over Combinational
+// channels or, with Direct, DirectCombinational
+
+template <bool Direct>
+class Chain : public sc_module {
+ public:
+  typedef typename Connections::CombinationalSel<Msg, Direct>::chan_t Chan;
+
+  sc_in_clk clk;
+  sc_in<bool> rst;
+
+  Source<Direct> src;
+  Stage<Direct>* stage[NUM_STAGES];
+  BufferedStage<Direct> buffered;
+  Sink<Direct> sink;
+  Chan chan[NUM_STAGES + 2];
+
+  Chain(sc_module_name name)
+      : sc_module(name), clk("clk"), rst("rst"), src("src"), buffered("buffered"), sink("sink") {
+    src.clk(clk);
+    src.rst(rst);
+    src.out(chan[0]);
+    for (unsigned int i = 0; i < NUM_STAGES; ++i) {
+      stage[i] = new Stage<Direct>(sc_gen_unique_name("stage"));
+      stage[i]->clk(clk);
+      stage[i]->rst(rst);
+      stage[i]->in(chan[i]);
+      stage[i]->out(chan[i + 1]);
+    }
+    buffered.clk(clk);
+    buffered.rst(rst);
+    buffered.in(chan[NUM_STAGES]);
+    buffered.out(chan[NUM_STAGES + 1]);
+    sink.clk(clk);
+    sink.rst(rst);
+    sink.in(chan[NUM_STAGES + 1]);
+  }
+};
+
+//------------------------------------------------------------------------
+// TestHarness
+//------------------------------------------------------------------------
+
+class TestHarness : public sc_module {
+  SC_HAS_PROCESS(TestHarness);
+
+ public:
+  sc_clock clk;
+  sc_signal<bool> rst;
+
+  Chain<false> comb;
+  Chain<true> direct;
+
+  TestHarness(sc_module_name name)
+      : sc_module(name),
+        clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+        rst("rst"),
+        comb("comb"),
+        direct("direct") {
+    comb.clk(clk);
+    comb.rst(rst);
+    direct.clk(clk);
+    direct.rst(rst);
+
+    SC_THREAD(reset);
+
+    SC_THREAD(watch);
+    sensitive << clk.pos();
+  }
+
+  void reset() {
+    rst.write(false);
+    wait(10, SC_NS);
+    rst.write(true);
+  }
+
+  // Stops once both sinks are done, or after a time limit
+  void watch() {
+    for (unsigned int cycle = 0; cycle < 20 * MAX_COUNT; ++cycle) {
+      if (comb.sink.done && direct.sink.done) {
+        sc_stop();
+        return;
+      }
+      wait();
+    }
+    std::cout << "FAILED: timeout" << std::endl;
+    test_failed = true;
+    sc_stop();
+  }
+};
+
+//------------------------------------------------------------------------
+// sc_main
+//------------------------------------------------------------------------
+
+int sc_main(int argc, char* argv[]) {
+  nvhls::set_random_seed();
+  TestHarness test("test");
+  sc_start();
+  if (test_failed) {
+    std::cout << "FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "PASS" << std::endl;
+  return 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+//========================================================================
+// TestFastForward.cpp
+//========================================================================
+
+#include <vector>
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <testbench/nvhls_rand.h>
+
+bool test_failed = false;
+
+//------------------------------------------------------------------------
+// TestHarnessFastForward
+//------------------------------------------------------------------------
+// A slow external model sends bursts of messages after long timed waits,
+// through a Buffer to a consumer that is blocked in Pop() in between. The
+// FastForwardClock skips the idle cycles between the bursts; every message
+// must still take the same number of cycles from Push() to Pop(), and the
+// ticked and skipped cycles must add up to the simulated time. Once the last
+// burst has drained no event is pending, so the clock stops and sc_start()
+// returns.
+
+template< typename T >
+class TestHarnessFastForward : public sc_module {
+  SC_HAS_PROCESS(TestHarnessFastForward);
+
+ public:
+  static const unsigned int NumBursts = 20;
+  static const unsigned int BurstSize = 5;
+  static const unsigned int MaxGapNs = 2000;
+
+  match::FastForwardClock ffclk;
+  sc_signal< bool >       rst;
+
+  Connections::Out<T>           src;
+  Connections::In<T>            sink;
+  Connections::Buffer<T,2>      buffer;
+  Connections::Combinational<T> enq_chan;
+  Connections::Combinational<T> deq_chan;
+
+  std::vector<sc_time> sent;
+  std::vector<sc_time> received;
+
+  TestHarnessFastForward(sc_module_name name)
+    : sc_module(name),
+      ffclk("ffclk", sc_time(1, SC_NS)),
+      rst("rst"),
+      src("src"),
+      sink("sink"),
+      buffer("buffer")
+    {
+      buffer.clk(ffclk.clk);
+      buffer.rst(rst);
+
+      src(enq_chan);
+      buffer.enq(enq_chan);
+      buffer.deq(deq_chan);
+      sink(deq_chan);
+
+      SC_THREAD(reset);
+
+      SC_THREAD(send);
+      sensitive << ffclk.clk.posedge_event();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+      SC_THREAD(receive);
+      sensitive << ffclk.clk.posedge_event();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+    }
+
+    void reset() {
+      rst.write(0);
+      wait( 10, SC_NS );
+      rst.write(1);
+    }
+
+    void send() {
+      src.Reset();
+      wait();
+      for (unsigned int b = 0; b < NumBursts; b++) {
+        // Waiting on a timer, not on the clock
+        wait(sc_time(rand() % MaxGapNs, SC_NS));
+        wait();
+        for (unsigned int i = 0; i < BurstSize; i++) {
+          sent.push_back(sc_time_stamp());
+          src.Push(sent.size() - 1);
+        }
+      }
+      while (1) wait();
+    }
+
+    void receive() {
+      sink.Reset();
+      wait();
+      while (1) {
+        T msg = sink.Pop();
+        if (msg != received.size()) {
+          std::cout << "FAILED: message " << msg << " received as message "
+                    << received.size() << std::endl;
+          test_failed = true;
+        }
+        received.push_back(sc_time_stamp());
+      }
+    }
+
+    void check() {
+      match::Quiescence& tracker = match::Quiescence::Get();
+      tracker.Report(std::cout);
+      if (received.size() != NumBursts * BurstSize) {
+        std::cout << "FAILED: " << received.size() << " of "
+                  << NumBursts * BurstSize << " messages received" << std::endl;
+        test_failed = true;
+        return;
+      }
+      for (unsigned int i = 1; i < received.size(); i++) {
+        if (received[i] - sent[i] != received[0] - sent[0]) {
+          std::cout << "FAILED: message " << i << " took " << received[i] - sent[i]
+                    << " instead of " << received[0] - sent[0] << std::endl;
+          test_failed = true;
+        }
+      }
+      if (tracker.skipped_cycles == 0) {
+        std::cout << "FAILED: no cycle was skipped" << std::endl;
+        test_failed = true;
+      }
+      uint64 cycles = static_cast<uint64>(sc_time_stamp() / ffclk.Period());
+      if (tracker.ticked_cycles + tracker.skipped_cycles != cycles) {
+        std::cout << "FAILED: " << tracker.ticked_cycles << " ticked and "
+                  << tracker.skipped_cycles << " skipped cycles in " << cycles
+                  << " cycles" << std::endl;
+        test_failed = true;
+      }
+    }
+};
+
+//------------------------------------------------------------------------
+// sc_main
+//------------------------------------------------------------------------
+
+int sc_main(int argc, char* argv[]) {
+  nvhls::set_random_seed();
+  TestHarnessFastForward<NVUINT32> test("test_fast_forward");
+  sc_start();
+  test.check();
+  return test_failed ? 1 : 0;
+}
@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+//========================================================================
+// TestForkJoin.cpp
+//========================================================================
+
+#include <vector>
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_connections_fork_join.h>
+#include <nvhls_perf_assert.h>
+#include <testbench/nvhls_rand.h>
+
+static bool test_failed = false;
+
+typedef NVUINTW(16) Msg;
+static const unsigned int NUM_PORTS = 3;
+static const unsigned int MAX_COUNT = 500;
+static const unsigned int STALL_PCT = 30;
+// Cycles allowed on top of one message per cycle
+static const unsigned int SLACK = 4;
+// The back-to-back messages may also miss at most SLACK cycles in any WINDOW
+static const unsigned int WINDOW = 100;
+
+// Every producer sends (id << 12) | i for i = 0 .. 2 * MAX_COUNT - 1, the
+// first MAX_COUNT back to back and the rest with random stalls
+class Sender : public sc_module {
+  SC_HAS_PROCESS(Sender);
+
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  Connections::Out<Msg> out;
+  unsigned int id;
+
+  Sender(sc_module_name name, unsigned int id_)
+      : sc_module(name), clk("clk"), rst("rst"), out("out"), id(id_) {
+    SC_THREAD(send);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void send() {
+    out.Reset();
+    wait();
+    unsigned int i = 0;
+    while (1) {
+      bool stall = (i >= MAX_COUNT) &&
+                   (static_cast<unsigned int>(rand() % 100) < STALL_PCT);
+      if (!stall && i < 2 * MAX_COUNT && out.PushNB((id << 12) | i)) i++;
+      wait();
+    }
+  }
+};
+
+// Takes num_srcs * 2 * MAX_COUNT messages from Senders and checks that the
+// messages of every Sender arrive in order. The first num_srcs * MAX_COUNT
+// are taken back to back and must arrive one per cycle, the rest with
+// random stalls.
+class Receiver : public sc_module {
+  SC_HAS_PROCESS(Receiver);
+
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  Connections::In<Msg> in;
+  unsigned int num_srcs;
+  bool done;
+  match::ThroughputMonitor fast_throughput;
+
+  Receiver(sc_module_name name, unsigned int num_srcs_)
+      : sc_module(name), clk("clk"), rst("rst"), in("in"), num_srcs(num_srcs_), done(false),
+        fast_throughput(std::string(this->name()) + "_fast") {
+    SC_THREAD(receive);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void receive() {
+    in.Reset();
+    wait();
+    std::vector<unsigned int> next(num_srcs, 0);
+    unsigned int total = num_srcs * 2 * MAX_COUNT, fast = num_srcs * MAX_COUNT;
+    unsigned int i = 0, cycle = 0, first = 0, last = 0;
+    while (i < total) {
+      Msg m;
+      bool stall = (i >= fast) &&
+                   (static_cast<unsigned int>(rand() % 100) < STALL_PCT);
+      if (!stall && in.PopNB(m)) {
+        unsigned int src = m >> 12, seq = m & 0xfff;
+        if (src >= num_srcs || seq != next[src]) {
+          std::cout << "FAILED: " << name() << ": message " << i << " is " << std::hex << m
+                    << std::dec << std::endl;
+          test_failed = true;
+        } else {
+          next[src]++;
+        }
+        if (i == 0) first = cycle;
+        if (i == fast - 1) last = cycle;
+        if (i < fast) fast_throughput.Transfer();
+        i++;
+      }
+      cycle++;
+      wait();
+    }
+    unsigned int cycles = last - first + 1;
+    std::cout << name() << ": " << fast << " messages in " << cycles << " cycles" << std::endl;
+    if (cycles > fast + SLACK) {
+      std::cout << "FAILED: " << name() << ": expected one message per cycle" << std::endl;
+      test_failed = true;
+    }
+    done = true;
+  }
+};
+
+//------------------------------------------------------------------------
+// TestHarness
+//------------------------------------------------------------------------
+// Sender -> Fork -> NUM_PORTS Receivers, NUM_PORTS Senders -> Merge ->
+// Receiver, and NUM_PORTS Senders -> Join -> join receiver, which checks
+// that every JoinMessage carries message i of all Senders.
+
+class TestHarness : public sc_module {
+  SC_HAS_PROCESS(TestHarness);
+
+ public:
+  typedef Connections::Join<Msg, NUM_PORTS>::Joined Joined;
+
+  sc_clock clk;
+  sc_signal<bool> rst;
+
+  Sender fork_src;
+  Connections::Fork<Msg, NUM_PORTS> fork;
+  Receiver* fork_dst[NUM_PORTS];
+  Connections::Combinational<Msg> fork_in, fork_out[NUM_PORTS];
+
+  Sender* merge_src[NUM_PORTS];
+  Connections::Merge<Msg, NUM_PORTS> merge;
+  Receiver merge_dst;
+  Connections::Combinational<Msg> merge_in[NUM_PORTS], merge_out;
+
+  Sender* join_src[NUM_PORTS];
+  Connections::Join<Msg, NUM_PORTS> join;
+  Connections::In<Joined> join_dst;
+  Connections::Combinational<Msg> join_in[NUM_PORTS];
+  Connections::Combinational<Joined> join_out;
+  bool join_done;
+  match::ThroughputMonitor join_fast_throughput;
+
+  match::PerfAssert perf;
+
+  TestHarness(sc_module_name name)
+      : sc_module(name),
+        clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+        rst("rst"),
+        fork_src("fork_src", 0),
+        fork("fork"),
+        merge("merge"),
+        merge_dst("merge_dst", NUM_PORTS),
+        join("join"),
+        join_dst("join_dst"),
+        join_done(false),
+        join_fast_throughput("join_fast") {
+    fork_src.clk(clk);
+    fork_src.rst(rst);
+    fork_src.out(fork_in);
+    fork.clk(clk);
+    fork.rst(rst);
+    fork.enq(fork_in);
+
+    merge.clk(clk);
+    merge.rst(rst);
+    merge.deq(merge_out);
+    merge_dst.clk(clk);
+    merge_dst.rst(rst);
+    merge_dst.in(merge_out);
+    perf.MinThroughput(merge_dst.fast_throughput, 1.0 - SLACK / double(WINDOW), WINDOW);
+
+    join.clk(clk);
+    join.rst(rst);
+    join.deq(join_out);
+    join_dst(join_out);
+    perf.MinThroughput(join_fast_throughput, 1.0 - SLACK / double(WINDOW), WINDOW);
+
+    for (unsigned int i = 0; i < NUM_PORTS; ++i) {
+      fork_dst[i] = new Receiver(sc_gen_unique_name("fork_dst"), 1);
+      fork_dst[i]->clk(clk);
+      fork_dst[i]->rst(rst);
+      fork.deq[i](fork_out[i]);
+      fork_dst[i]->in(fork_out[i]);
+      perf.MinThroughput(fork_dst[i]->fast_throughput, 1.0 - SLACK / double(WINDOW), WINDOW);
+
+      merge_src[i] = new Sender(sc_gen_unique_name("merge_src"), i);
+      merge_src[i]->clk(clk);
+      merge_src[i]->rst(rst);
+      merge_src[i]->out(merge_in[i]);
+      merge.enq[i](merge_in[i]);
+
+      join_src[i] = new Sender(sc_gen_unique_name("join_src"), i);
+      join_src[i]->clk(clk);
+      join_src[i]->rst(rst);
+      join_src[i]->out(join_in[i]);
+      join.enq[i](join_in[i]);
+    }
+
+    SC_THREAD(reset);
+
+    SC_THREAD(receive_join);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    SC_THREAD(watch);
+    sensitive << clk.pos();
+  }
+
+  void reset() {
+    rst.write(false);
+    wait(10, SC_NS);
+    rst.write(true);
+  }
+
+  void receive_join() {
+    join_dst.Reset();
+    wait();
+    unsigned int i = 0, cycle = 0, first = 0, last = 0;
+    while (i < 2 * MAX_COUNT) {
+      Joined m;
+      bool stall = (i >= MAX_COUNT) &&
+                   (static_cast<unsigned int>(rand() % 100) < STALL_PCT);
+      if (!stall && join_dst.PopNB(m)) {
+        for (unsigned int k = 0; k < NUM_PORTS; ++k) {
+          if (m[k] != ((k << 12) | i)) {
+            std::cout << "FAILED: join message " << i << " port " << k << " is " << std::hex
+                      << m[k] << std::dec << std::endl;
+            test_failed = true;
+          }
+        }
+        if (i == 0) first = cycle;
+        if (i == MAX_COUNT - 1) last = cycle;
+        if (i < MAX_COUNT) join_fast_throughput.Transfer();
+        i++;
+      }
+      cycle++;
+      wait();
+    }
+    unsigned int cycles = last - first + 1;
+    std::cout << "join: " << MAX_COUNT << " messages in " << cycles << " cycles" << std::endl;
+    if (cycles > MAX_COUNT + SLACK) {
+      std::cout << "FAILED: join: expected one message per cycle" << std::endl;
+      test_failed = true;
+    }
+    join_done = true;
+  }
+
+  // Stops once every receiver is done, or after a time limit
+  void watch() {
+    for (unsigned int cycle = 0; cycle < 20 * MAX_COUNT; ++cycle) {
+      bool done = merge_dst.done && join_done;
+      for (unsigned int i = 0; i < NUM_PORTS; ++i)
+        done = done && fork_dst[i]->done;
+      if (done) {
+        sc_stop();
+        return;
+      }
+      wait();
+    }
+    std::cout << "FAILED: timeout" << std::endl;
+    test_failed = true;
+    sc_stop();
+  }
+};
+
+//------------------------------------------------------------------------
+// sc_main
+//------------------------------------------------------------------------
+
+int sc_main(int argc, char* argv[]) {
+  nvhls::set_random_seed();
+  TestHarness test("test");
+  sc_start();
+  if (!test.perf.Check(std::cout)) test_failed = true;
+  if (test_failed) {
+    std::cout << "FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "PASS" << std::endl;
+  return 0;
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+//========================================================================
+// TestHostBridge.cpp
+//========================================================================
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_host_bridge.h>
+
+typedef NVUINTW(32) Msg;
+static const unsigned int NUM_MSGS = 200000;
+static const unsigned int HOST_BATCH = 16;
+static const double TIMEOUT_SECONDS = 60;
+
+static std::atomic<bool> host_done(false);
+static std::atomic<bool> test_failed(false);
+
+//------------------------------------------------------------------------
+// Host threads: a driver pushes 0 .. NUM_MSGS - 1 in batches, a monitor
+// checks that every message comes back incremented and in order
+//------------------------------------------------------------------------
+
+template <typename Bridge>
+void HostDriver(Bridge* bridge) {
+  Msg batch[HOST_BATCH];
+  unsigned int i = 0;
+  while (i < NUM_MSGS && !host_done.load()) {
+    unsigned int n = 0;
+    for (; n < HOST_BATCH && i + n < NUM_MSGS; n++) batch[n] = i + n;
+    unsigned int sent = 0;
+    while (sent < n && !host_done.load()) {
+      unsigned int k = bridge->HostPushBatch(batch + sent, n - sent);
+      if (k == 0) std::this_thread::yield();
+      sent += k;
+    }
+    i += n;
+  }
+}
+
+template <typename Bridge>
+void HostMonitor(Bridge* bridge) {
+  Msg batch[HOST_BATCH];
+  unsigned int i = 0;
+  while (i < NUM_MSGS && !host_done.load()) {
+    unsigned int n = bridge->HostPopBatch(batch, HOST_BATCH);
+    if (n == 0) std::this_thread::yield();
+    for (unsigned int k = 0; k < n; k++, i++) {
+      if (batch[k] != i + 1) {
+        std::cout << "FAILED: message " << i << " is " << batch[k] << std::endl;
+        test_failed = true;
+      }
+    }
+  }
+  host_done = true;
+}
+
+// Host-only reference: the same traffic through a polled mutex-protected
+// queue and through an SpscRing, in messages per second
+template <typename Push, typename Pop>
+double HostRate(Push push, Pop pop) {
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::thread producer([&] {
+    for (unsigned int i = 0; i < NUM_MSGS; i++)
+      while (!push(i)) std::this_thread::yield();
+  });
+  for (unsigned int i = 0; i < NUM_MSGS; i++) {
+    unsigned int v;
+    while (!pop(v)) std::this_thread::yield();
+    if (v != i) test_failed = true;
+  }
+  producer.join();
+  std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+  return NUM_MSGS / secs.count();
+}
+
+//------------------------------------------------------------------------
+// TestHarness: driver -> to_sim -> increment -> from_sim -> monitor
+//------------------------------------------------------------------------
+
+class TestHarness : public sc_module {
+  SC_HAS_PROCESS(TestHarness);
+
+ public:
+  sc_clock clk;
+  sc_signal<bool> rst;
+
+  Connections::HostToSim<Msg> to_sim;
+  Connections::SimToHost<Msg> from_sim;
+  Connections::In<Msg> dut_in;
+  Connections::Out<Msg> dut_out;
+  Connections::Combinational<Msg> chan_in, chan_out;
+  unsigned long cycles;
+
+  TestHarness(sc_module_name name)
+      : sc_module(name),
+        clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+        rst("rst"),
+        to_sim("to_sim"),
+        from_sim("from_sim"),
+        dut_in("dut_in"),
+        dut_out("dut_out"),
+        cycles(0) {
+    to_sim.clk(clk);
+    to_sim.rst(rst);
+    to_sim.out(chan_in);
+    dut_in(chan_in);
+    dut_out(chan_out);
+    from_sim.clk(clk);
+    from_sim.rst(rst);
+    from_sim.in(chan_out);
+
+    SC_THREAD(reset);
+
+    SC_THREAD(increment);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    SC_THREAD(watch);
+    sensitive << clk.pos();
+  }
+
+  void reset() {
+    rst.write(false);
+    wait(10, SC_NS);
+    rst.write(true);
+  }
+
+  void increment() {
+    dut_in.Reset();
+    dut_out.Reset();
+    wait();
+    while (1) {
+      Msg m = dut_in.Pop();
+      dut_out.Push(m + 1);
+    }
+  }
+
+  // Stops once the monitor has every message, or after a wall-clock limit
+  void watch() {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (!host_done.load()) {
+      wait();
+      cycles++;
+      if ((cycles & 1023) == 0) {
+        std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+        if (secs.count() > TIMEOUT_SECONDS) {
+          std::cout << "FAILED: timeout after " << cycles << " cycles, "
+                    << from_sim.Forwarded() << " messages back" << std::endl;
+          test_failed = true;
+          host_done = true;
+        }
+      }
+    }
+    sc_stop();
+  }
+};
+
+//------------------------------------------------------------------------
+// sc_main
+//------------------------------------------------------------------------
+
+int sc_main(int argc, char* argv[]) {
+  std::mutex lock;
+  std::deque<unsigned int> queue;
+  double mutex_rate = HostRate(
+      [&](unsigned int v) {
+        std::lock_guard<std::mutex> guard(lock);
+        queue.push_back(v);
+        return true;
+      },
+      [&](unsigned int& v) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (queue.empty()) return false;
+        v = queue.front();
+        queue.pop_front();
+        return true;
+      });
+  match::SpscRing<unsigned int, 1024> ring;
+  double ring_rate = HostRate([&](unsigned int v) { return ring.Push(v); },
+                              [&](unsigned int& v) { return ring.Pop(v); });
+  std::cout << "host only: mutex queue " << mutex_rate << " msgs/s, SpscRing " << ring_rate
+            << " msgs/s" << std::endl;
+
+  TestHarness test("test");
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::thread driver(HostDriver<Connections::HostToSim<Msg> >, &test.to_sim);
+  std::thread monitor(HostMonitor<Connections::SimToHost<Msg> >, &test.from_sim);
+  sc_start();
+  host_done = true;
+  driver.join();
+  monitor.join();
+  std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+  std::cout << "bridge: " << NUM_MSGS << " messages in " << test.cycles << " cycles, "
+            << NUM_MSGS / secs.count() << " msgs/s" << std::endl;
+  if (test_failed) {
+    std::cout << "FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "PASS" << std::endl;
+  return 0;
+}
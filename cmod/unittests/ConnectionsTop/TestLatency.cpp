@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+//========================================================================
+// TestLatency.cpp
+//========================================================================
+
+#include <vector>
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_latency.h>
+#include <nvhls_perf_assert.h>
+#include <testbench/nvhls_rand.h>
+
+//------------------------------------------------------------------------
+// TestHarness: src -> relay (RELAY_CYCLES delay) -> sink with Tagged messages
+//------------------------------------------------------------------------
+// The relay takes about RELAY_CYCLES + 2 cycles per message and a message
+// waits up to one such period in src before the relay takes it, so perf
+// fails if the p99 latency exceeds three periods or the relay delivers fewer
+// than one message per two periods in any WINDOW cycles.
+
+class TestHarness : public sc_module {
+  SC_HAS_PROCESS(TestHarness);
+
+ public:
+  typedef NVUINTW(32) Data;
+  typedef match::Tagged<Data> Msg;
+  static const unsigned int MAX_COUNT = 50;
+  static const unsigned int RELAY_CYCLES = 3;
+  static const unsigned int PERIOD = RELAY_CYCLES + 2;
+  static const unsigned int WINDOW = 8 * PERIOD;
+
+  sc_clock                         clk;
+  sc_signal< bool >                rst;
+
+  Connections::Out< Msg >          src;
+  Connections::In< Msg >           relay_in;
+  Connections::Out< Msg >          relay_out;
+  Connections::In< Msg >           sink;
+  Connections::Combinational< Msg > chan_a;
+  Connections::Combinational< Msg > chan_b;
+
+  match::LatencyRecorder           latency;
+  match::ThroughputMonitor         throughput;
+  match::PerfAssert                perf;
+  bool                             passed;
+
+  TestHarness(sc_module_name name)
+    : sc_module(name),
+      clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+      rst("rst"),
+      src("src"),
+      relay_in("relay_in"),
+      relay_out("relay_out"),
+      sink("sink"),
+      chan_a("chan_a"),
+      chan_b("chan_b"),
+      latency("relay_latency", sc_time(1, SC_NS)),
+      throughput("relay_throughput", sc_time(1, SC_NS)),
+      passed(false)
+    {
+      perf.MaxLatency(latency, 99, 3 * PERIOD, "relay_latency");
+      perf.MinThroughput(throughput, 1.0 / (2 * PERIOD), WINDOW);
+
+      src(chan_a);
+      relay_in(chan_a);
+      relay_out(chan_b);
+      sink(chan_b);
+
+      SC_THREAD(reset);
+
+      SC_THREAD(send);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+      SC_THREAD(relay);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+      SC_THREAD(receive);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+    }
+
+    void reset() {
+      rst.write(false);
+      wait(10, SC_NS);
+      rst.write(true);
+    }
+
+    void send() {
+      src.Reset();
+      wait();
+      for (unsigned int i = 0; i < MAX_COUNT; ++i) {
+        Msg m(i);
+        m.Stamp();
+        src.Push(m);
+        if (rand() & 1)
+          wait();
+      }
+      while (1) wait();
+    }
+
+    void relay() {
+      relay_in.Reset();
+      relay_out.Reset();
+      wait();
+      while (1) {
+        Msg m = relay_in.Pop();
+        wait(RELAY_CYCLES);
+        relay_out.Push(m);
+      }
+    }
+
+    void receive() {
+      sink.Reset();
+      wait();
+      for (unsigned int i = 0; i < MAX_COUNT; ++i) {
+        Msg m = sink.Pop();
+        latency.Record(m);
+        throughput.Transfer();
+        if (m.msg != i) {
+          std::cout << "FAILED: message " << i << " is " << m.msg << std::endl;
+          sc_stop();
+          return;
+        }
+      }
+      latency.Print(std::cout);
+      passed = (latency.count() == MAX_COUNT) && (latency.min() >= RELAY_CYCLES);
+      std::cout << (passed ? "PASS" : "FAILED: latency below relay delay") << std::endl;
+      sc_stop();
+    }
+};
+
+//------------------------------------------------------------------------
+// sc_main
+//------------------------------------------------------------------------
+
+int sc_main(int argc, char* argv[]) {
+  nvhls::set_random_seed();
+  TestHarness test("test");
+  sc_start();
+  bool perf_passed = test.perf.Check(std::cout);
+  return (test.passed && perf_passed) ? 0 : 1;
+}
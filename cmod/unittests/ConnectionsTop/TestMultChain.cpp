@@ -65,8 +65,8 @@ class TestHarness : public sc_module {
     : sc_module(name),
       clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
       rst("rst"),
-      src("src", Pacer(0.3, 0.7), src_msgs),
-      sink("sink", Pacer(0.5, 0.7), sink_msgs),
+      src("src", nvhls::GeometricPacer(0.3, 0.7), src_msgs),
+      sink("sink", nvhls::GeometricPacer(0.5, 0.7), sink_msgs),
       dut("dut"),
       cycle(0)
     {
@@ -25,6 +25,14 @@
 #include "TestSource.h"
 #include "TestSink.h"
 
+// Credit return batching of InNetworkCredit, see the sim_credit_batch target
+#ifndef CREDIT_BATCH
+#define CREDIT_BATCH 1
+#endif
+#ifndef CREDIT_TIMEOUT
+#define CREDIT_TIMEOUT 0
+#endif
+
 //------------------------------------------------------------------------
 // TestHarness
 //------------------------------------------------------------------------
@@ -47,7 +55,8 @@ class TestHarness: public sc_module {
   const static unsigned int CreditWidth = 3;
 
   Connections::OutNetworkCredit<T,DestWidthPerHop,MaxHops,PacketIdWidth,CreditWidth> enq_net;
-  Connections::InNetworkCredit<T,DestWidthPerHop,MaxHops,PacketIdWidth,CreditWidth> deq_net;
+  Connections::InNetworkCredit<T,DestWidthPerHop,MaxHops,PacketIdWidth,CreditWidth,
+                               CREDIT_BATCH,CREDIT_TIMEOUT> deq_net;
 
   Connections::Combinational<T> enq_chan;
   Connections::Combinational<T> deq_chan;
@@ -74,8 +83,8 @@ class TestHarness: public sc_module {
     : sc_module(name),
       clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
       rst("rst"),
-      src("src", Pacer(0.3, 0.7), src_msgs),
-      sink("sink", Pacer(0.5, 0.7), sink_msgs),
+      src("src", nvhls::GeometricPacer(0.3, 0.7), src_msgs),
+      sink("sink", nvhls::GeometricPacer(0.5, 0.7), sink_msgs),
       enq_net("enq_net"),
       deq_net("deq_net"),
       enq_chan("enq_chan"),
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+//========================================================================
+// TestNetworkTable.cpp
+//========================================================================
+
+#include <vector>
+#include <systemc.h>
+#include "TestSource.h"
+#include "TestSink.h"
+#include <nvhls_connections.h>
+#include <testbench/Pacer.h>
+#include <testbench/nvhls_rand.h>
+
+bool test_failed = false;
+
+//------------------------------------------------------------------------
+// TestHarnessNetworkTable
+//------------------------------------------------------------------------
+// The route table is driven by plain signals here, standing in for the
+// regOut ports of an AxiSlaveToReg. The harness remaps logical destination 1
+// while packets are in flight and then switches the sender to destination 2.
+
+template< typename T >
+class TestHarnessNetworkTable : public sc_module {
+  SC_HAS_PROCESS(TestHarnessNetworkTable);
+
+ public:
+  static const unsigned int LogicalIdWidth = 2;
+  static const unsigned int NumEntries = 1 << LogicalIdWidth;
+  typedef Connections::OutNetworkTable<T,LogicalIdWidth,4,1,2> OutNet;
+  typedef typename OutNet::Packet_t Packet_t;
+  typedef typename OutNet::Entry_t Entry_t;
+
+  // Module Interface
+  sc_clock              clk;
+  sc_signal< bool >     rst;
+  TestSourceBlocking<T> src;
+  TestSinkBlocking<T>   sink;
+
+  OutNet                     enq_net;
+  Connections::InNetwork<T,4,1,2> deq_net;
+
+  Connections::Combinational<T> enq_chan;
+  Connections::Combinational<T> deq_chan;
+
+  Connections::Combinational<Packet_t> net_chan;
+
+  Connections::Out< sc_lv<LogicalIdWidth> > dest_id;
+  Connections::Combinational< sc_lv<LogicalIdWidth> > dest_id_chan;
+
+  sc_signal<Entry_t> table[NumEntries];
+
+  TestHarnessNetworkTable(sc_module_name name,
+                          std::vector<T>& src_msgs,
+                          std::vector<T>& sink_msgs)
+    : sc_module(name),
+      clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+      rst("rst"),
+      src("src", nvhls::GeometricPacer(0.3, 0.7), src_msgs),
+      sink("sink", nvhls::GeometricPacer(0.5, 0.7), sink_msgs),
+      enq_net("enq_net"),
+      deq_net("deq_net"),
+      enq_chan("enq_chan"),
+      deq_chan("deq_chan"),
+      net_chan("net_chan"),
+      dest_id("dest_id"),
+      dest_id_chan("dest_id_chan"),
+      cycle(0)
+    {
+      for (unsigned int i = 0; i < NumEntries; i++)
+        route_seen[i] = false;
+
+      src.clk(clk);
+      src.rst(rst);
+
+      sink.clk(clk);
+      sink.rst(rst);
+
+      enq_net.clk(clk);
+      enq_net.rst(rst);
+
+      deq_net.clk(clk);
+      deq_net.rst(rst);
+
+      dest_id(dest_id_chan);
+      enq_net.dest_id(dest_id_chan);
+      for (unsigned int i = 0; i < NumEntries; i++)
+        enq_net.table[i](table[i]);
+
+      src.out(enq_chan);
+      enq_net.enq(enq_chan);
+      enq_net.deq(net_chan);
+      deq_net.enq(net_chan);
+      deq_net.deq(deq_chan);
+      sink.in_(deq_chan);
+
+      SC_THREAD(reset);
+
+      SC_METHOD(check_route);
+      sensitive << clk.posedge_event();
+
+      SC_METHOD(line_trace);
+      sensitive << clk.posedge_event();
+    }
+
+    // Table entry <Packet Id>:<Route>
+    static Entry_t entry(unsigned int route, unsigned int vc) {
+      return (vc << 4) | route;
+    }
+
+    // Every packet carries the entry of the current logical destination
+    void check_route() {
+      if (rst.read() && net_chan.val.read() && net_chan.rdy.read()) {
+        sc_lv<Wrapped<Packet_t>::width> pbits = net_chan.msg.read();
+        Marshaller<Wrapped<Packet_t>::width> pmarshaller(pbits);
+        Packet_t packet;
+        packet.Marshall(pmarshaller);
+        Entry_t ref = table[enq_net.dest_state.read().to_uint()].read();
+        if (packet.dest != nvhls::get_slc<4>(ref, 0) ||
+            packet.packet_id != nvhls::get_slc<2>(ref, 4)) {
+          std::cout << "FAILED: route " << packet.dest << " id " << packet.packet_id
+                    << " do not match table entry " << ref << std::endl;
+          test_failed = true;
+        }
+        for (unsigned int i = 0; i < NumEntries; i++) {
+          if (packet.dest == (1u << i))
+            route_seen[i] = true;
+        }
+      }
+    }
+
+    void line_trace() {
+      if (rst.read()) {
+        std::cout << std::dec << "[" << std::setw(3) << cycle++ << "] ";
+        src.line_trace();
+        enq_net.line_trace();
+        deq_net.line_trace();
+        sink.line_trace();
+        std::cout << std::endl;
+      }
+    }
+
+    void reset() {
+      dest_id.Reset();
+      dest_id_chan.ResetWrite();
+      // Logical destination i starts as route 1 << i on VC i
+      for (unsigned int i = 0; i < NumEntries; i++)
+        table[i].write(entry(1 << i, i));
+      std::cout << "@" << sc_time_stamp() <<" Asserting reset" << std::endl;
+      rst.write(false);
+      wait( 10, SC_NS );
+      rst.write(true);
+      std::cout << "@" << sc_time_stamp() <<" De-Asserting reset" << std::endl;
+
+      cycle = 0;
+
+      src.Go();
+      sink.Go();
+      dest_id.Push(1);
+
+      // Remap logical destination 1 to route 8 on VC 3
+      wait( 40, SC_NS );
+      table[1].write(entry(8, 3));
+
+      // Move the sender to logical destination 2
+      wait( 40, SC_NS );
+      dest_id.Push(2);
+    }
+
+    bool all_routes_seen() const {
+      return route_seen[1] && route_seen[2] && route_seen[3];
+    }
+
+ private:
+  unsigned int cycle;
+  bool route_seen[NumEntries];
+};
+
+//------------------------------------------------------------------------
+// sc_main
+//------------------------------------------------------------------------
+
+int sc_main(int argc, char* argv[]) {
+  nvhls::set_random_seed();
+  typedef sc_lv<32> Bits;
+  static const unsigned int MAX_COUNT = 100;
+
+  // Generate source and sink messages
+  std::vector<Bits> src_msgs;
+  std::vector<Bits> sink_msgs;
+  for (unsigned int i = 0; i < MAX_COUNT; ++i ) {
+    src_msgs.push_back( i );
+    sink_msgs.push_back( i );
+  }
+
+  TestHarnessNetworkTable<Bits> test("test_net_table", src_msgs, sink_msgs);
+  sc_start();
+  if (!test.all_routes_seen()) {
+    std::cout << "FAILED: not every table entry was used" << std::endl;
+    test_failed = true;
+  }
+  return test_failed ? 1 : 0;
+}
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//========================================================================
+// TestPortAdapter.cpp
+//========================================================================
+
+#include <vector>
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_connections_adapter.h>
+#include <testbench/nvhls_rand.h>
+
+static bool test_failed = false;
+
+typedef NVUINTW(16) Msg;
+static const Connections::connections_port_t kFast = Connections::TLM_PORT;
+static const Connections::connections_port_t kAccurate = Connections::MARSHALL_PORT;
+
+//------------------------------------------------------------------------
+// Block: a relay that adds one, then a Buffer, all of port type PortType
+//------------------------------------------------------------------------
+
+template <Connections::connections_port_t PortType>
+class Block : public sc_module {
+  SC_HAS_PROCESS(Block);
+
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  Connections::In<Msg, PortType> in;
+  Connections::Out<Msg, PortType> out;
+
+  Connections::Combinational<Msg, PortType> chan;
+  Connections::Buffer<Msg, 4, PortType> buffer;
+  Connections::Out<Msg, PortType> relay_out;
+
+  Block(sc_module_name name)
+      : sc_module(name), clk("clk"), rst("rst"), in("in"), out("out"), buffer("buffer") {
+    buffer.clk(clk);
+    buffer.rst(rst);
+    relay_out(chan);
+    buffer.enq(chan);
+    buffer.deq(out);
+
+    SC_THREAD(relay);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void relay() {
+    in.Reset();
+    relay_out.Reset();
+    Msg msg;
+    bool full = false;
+    wait();
+    while (1) {
+      if (full && relay_out.PushNB(msg))
+        full = false;
+      if (!full && in.PopNB(msg)) {
+        msg = msg + 1;
+        full = true;
+      }
+      wait();
+    }
+  }
+};
+
+//------------------------------------------------------------------------
+// TestHarness: the same Block in fast and in accurate ports
+//------------------------------------------------------------------------
+// Both paths are driven and drained by TLM_PORT threads, as in a
+// CONNECTIONS_FAST_SIM testbench. The fast path is a Block<TLM_PORT>; the
+// mixed path is a Block<MARSHALL_PORT> between two PortAdapters. Both must
+// deliver every message plus one, in order, and the adapters must not slow
+// the mixed path down: it may take only a few more cycles than the fast one.
+
+class TestHarness : public sc_module {
+  SC_HAS_PROCESS(TestHarness);
+
+ public:
+  static const unsigned int MAX_COUNT = 500;
+
+  sc_clock clk;
+  sc_signal<bool> rst;
+
+  Block<kFast> fast;
+  Block<kAccurate> accurate;
+  Connections::PortAdapter<Msg, kFast, kAccurate> to_accurate;
+  Connections::PortAdapter<Msg, kAccurate, kFast> from_accurate;
+
+  Connections::Out<Msg, kFast> fast_src, mixed_src;
+  Connections::In<Msg, kFast> fast_sink, mixed_sink;
+  Connections::Combinational<Msg, kFast> fast_enq, fast_deq, mixed_enq, mixed_deq;
+  Connections::Combinational<Msg, kAccurate> accurate_enq, accurate_deq;
+
+  std::vector<Msg> msgs;
+  unsigned int done;
+  unsigned int fast_cycles, mixed_cycles;
+
+  TestHarness(sc_module_name name)
+      : sc_module(name),
+        clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+        rst("rst"),
+        fast("fast"),
+        accurate("accurate"),
+        to_accurate("to_accurate"),
+        from_accurate("from_accurate"),
+        done(0),
+        fast_cycles(0),
+        mixed_cycles(0) {
+    for (unsigned int i = 0; i < MAX_COUNT; i++)
+      msgs.push_back(nvhls::get_rand<16>());
+
+    fast.clk(clk);
+    fast.rst(rst);
+    accurate.clk(clk);
+    accurate.rst(rst);
+    to_accurate.clk(clk);
+    to_accurate.rst(rst);
+    from_accurate.clk(clk);
+    from_accurate.rst(rst);
+
+    fast_src(fast_enq);
+    fast.in(fast_enq);
+    fast.out(fast_deq);
+    fast_sink(fast_deq);
+
+    mixed_src(mixed_enq);
+    to_accurate.enq(mixed_enq);
+    to_accurate.deq(accurate_enq);
+    accurate.in(accurate_enq);
+    accurate.out(accurate_deq);
+    from_accurate.enq(accurate_deq);
+    from_accurate.deq(mixed_deq);
+    mixed_sink(mixed_deq);
+
+    SC_THREAD(reset);
+
+    SC_THREAD(send_fast);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    SC_THREAD(send_mixed);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    SC_THREAD(receive_fast);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    SC_THREAD(receive_mixed);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void reset() {
+    rst.write(false);
+    wait(10, SC_NS);
+    rst.write(true);
+  }
+
+  void send_fast() {
+    fast_src.Reset();
+    wait();
+    for (unsigned int i = 0; i < MAX_COUNT; i++)
+      fast_src.Push(msgs[i]);
+    while (1) wait();
+  }
+
+  void send_mixed() {
+    mixed_src.Reset();
+    wait();
+    for (unsigned int i = 0; i < MAX_COUNT; i++)
+      mixed_src.Push(msgs[i]);
+    while (1) wait();
+  }
+
+  void receive_fast() { receive(fast_sink, "fast", fast_cycles); }
+
+  void receive_mixed() { receive(mixed_sink, "mixed", mixed_cycles); }
+
+  // Checks the messages and counts the cycles from the first to the last
+  void receive(Connections::In<Msg, kFast>& sink, const char* path, unsigned int& cycles) {
+    sink.Reset();
+    wait();
+    unsigned int cycle = 0, first = 0;
+    unsigned int i = 0;
+    while (i < MAX_COUNT) {
+      Msg m;
+      if (sink.PopNB(m)) {
+        if (i == 0)
+          first = cycle;
+        if (m != static_cast<Msg>(msgs[i] + 1)) {
+          std::cout << "FAILED: " << path << " message " << i << " is " << m << std::endl;
+          test_failed = true;
+        }
+        i++;
+        cycles = cycle - first + 1;
+      }
+      cycle++;
+      wait();
+    }
+    Done();
+  }
+
+  void Done() {
+    if (++done == 2)
+      sc_stop();
+    while (1) wait();
+  }
+};
+
+//------------------------------------------------------------------------
+// sc_main
+//------------------------------------------------------------------------
+
+int sc_main(int argc, char* argv[]) {
+  nvhls::set_random_seed();
+  TestHarness test("test");
+  sc_start();
+
+  if (test.done != 2) {
+    std::cout << "FAILED: messages missing" << std::endl;
+    test_failed = true;
+  }
+  std::cout << TestHarness::MAX_COUNT << " messages in " << test.fast_cycles
+            << " cycles on the fast path, " << test.mixed_cycles << " on the mixed path"
+            << std::endl;
+  if (test.mixed_cycles > test.fast_cycles + 8) {
+    std::cout << "FAILED: PortAdapters slow the mixed path down" << std::endl;
+    test_failed = true;
+  }
+  if (test_failed) {
+    std::cout << "FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "PASS" << std::endl;
+  return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+//========================================================================
+// TestSerdesCompact.cpp
+//========================================================================
+
+#include <vector>
+#include <systemc.h>
+#include <nvhls_serdes.h>
+#include <nvhls_connections.h>
+#include <testbench/nvhls_rand.h>
+
+//------------------------------------------------------------------------
+// TestHarness: compact_serializer -> compact_deserializer
+//------------------------------------------------------------------------
+
+class TestHarness : public sc_module {
+  SC_HAS_PROCESS(TestHarness);
+
+ public:
+  typedef Packet<64, 4, 1, 8> Packet_t;
+  typedef Flit<16, 0, 0, 8, FlitId2bit, WormHole> Flit_t;
+  typedef compact_serializer<Packet_t, Flit_t> Ser_t;
+  typedef compact_deserializer<Packet_t, Flit_t> Deser_t;
+  static const unsigned int MAX_COUNT = 50;
+
+  // Body flits carry 24 instead of 16 bits, which saves one of five flits
+  static_assert(Ser_t::num_flits < serializer<Packet_t, Flit_t, WormHole>::num_flits,
+                "compact_serializer does not save flits");
+
+  sc_clock                              clk;
+  sc_signal< bool >                     rst;
+  Ser_t                                 ser;
+  Deser_t                               deser;
+
+  Connections::Out< Packet_t >          src;
+  Connections::In< Packet_t >           sink;
+  Connections::Combinational< Packet_t > ser_in;
+  Connections::Combinational< Flit_t >   deser_in;
+  Connections::Combinational< Packet_t > deser_out;
+
+  std::vector<Packet_t> packets;
+
+  TestHarness(sc_module_name name)
+    : sc_module(name),
+      clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+      rst("rst"),
+      ser("serializer"),
+      deser("deserializer"),
+      src("src"),
+      sink("sink"),
+      ser_in("ser_in"),
+      deser_in("deser_in"),
+      deser_out("deser_out")
+    {
+      for (unsigned int i = 0; i < MAX_COUNT; ++i) {
+        Packet_t p;
+        p.dest = rand() & 0xf;
+        p.packet_id = rand() & 0xff;
+        p.data = (static_cast<NVUINTW(64)>(rand()) << 32) | rand();
+        packets.push_back(p);
+      }
+
+      ser.clk(clk);
+      ser.rst(rst);
+      deser.clk(clk);
+      deser.rst(rst);
+
+      src(ser_in);
+      ser.in_packet(ser_in);
+      ser.out_flit(deser_in);
+      deser.in_flit(deser_in);
+      deser.out_packet(deser_out);
+      sink(deser_out);
+
+      SC_THREAD(reset);
+
+      SC_THREAD(send);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+      SC_THREAD(receive);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+    }
+
+    void reset() {
+      rst.write(false);
+      wait(10, SC_NS);
+      rst.write(true);
+    }
+
+    void send() {
+      src.Reset();
+      wait();
+      for (unsigned int i = 0; i < MAX_COUNT; ++i) {
+        src.Push(packets[i]);
+        wait();
+      }
+      while (1) wait();
+    }
+
+    void receive() {
+      sink.Reset();
+      wait();
+      for (unsigned int i = 0; i < MAX_COUNT; ++i) {
+        Packet_t p = sink.Pop();
+        if (p.data != packets[i].data || p.dest != packets[i].dest ||
+            p.packet_id != packets[i].packet_id) {
+          std::cout << "FAILED: packet " << i << ": " << std::hex << p.data
+                    << " != " << packets[i].data << std::dec << std::endl;
+          sc_stop();
+          return;
+        }
+      }
+      std::cout << "PASS: " << MAX_COUNT << " packets in " << Ser_t::num_flits + 1
+                << " flits each" << std::endl;
+      sc_stop();
+    }
+};
+
+//------------------------------------------------------------------------
+// sc_main
+//------------------------------------------------------------------------
+
+int sc_main(int argc, char* argv[]) {
+  nvhls::set_random_seed();
+  TestHarness test("test");
+  sc_start();
+  return 0;
+}
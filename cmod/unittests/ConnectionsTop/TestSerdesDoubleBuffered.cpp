@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+//========================================================================
+// TestSerdesDoubleBuffered.cpp
+//========================================================================
+
+#include <vector>
+#include <systemc.h>
+#include <nvhls_serdes.h>
+#include <nvhls_connections.h>
+#include <TypeToBits.h>
+#include <testbench/nvhls_rand.h>
+
+static int harnesses_running = 0;
+static bool test_failed = false;
+
+//------------------------------------------------------------------------
+// TestHarness: serializer and double_buffered_serializer side by side
+//------------------------------------------------------------------------
+// Both serializers get the same back-to-back packets. The flits of the
+// double-buffered serializer must match the flits of serializer, and with
+// the cycle-accurate Connections view they must come one per cycle.
+
+template <typename Packet_t, typename Flit_t, RouterType Rtype>
+class TestHarness : public sc_module {
+  SC_HAS_PROCESS(TestHarness);
+
+ public:
+  typedef serializer<Packet_t, Flit_t, Rtype> Ser_t;
+  typedef double_buffered_serializer<Packet_t, Flit_t, Rtype> DBSer_t;
+  static const unsigned int MAX_COUNT = 50;
+  static const unsigned int FLITS_PER_PACKET =
+      (Rtype == WormHole) ? Ser_t::num_flits + 1 : Ser_t::num_flits;
+
+  sc_clock                              clk;
+  sc_signal< bool >                     rst;
+  Ser_t                                 ser;
+  DBSer_t                               db_ser;
+
+  Connections::Out< Packet_t >          src;
+  Connections::Out< Packet_t >          db_src;
+  Connections::In< Flit_t >             sink;
+  Connections::In< Flit_t >             db_sink;
+  Connections::Combinational< Packet_t > ser_in;
+  Connections::Combinational< Packet_t > db_ser_in;
+  Connections::Combinational< Flit_t >   ser_out;
+  Connections::Combinational< Flit_t >   db_ser_out;
+
+  std::vector<Packet_t> packets;
+  std::vector<Flit_t> flits;
+  std::vector<Flit_t> db_flits;
+  std::vector<sc_time> db_times;
+  bool done;
+
+  TestHarness(sc_module_name name)
+    : sc_module(name),
+      clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+      rst("rst"),
+      ser("serializer"),
+      db_ser("db_serializer"),
+      src("src"),
+      db_src("db_src"),
+      sink("sink"),
+      db_sink("db_sink"),
+      ser_in("ser_in"),
+      db_ser_in("db_ser_in"),
+      ser_out("ser_out"),
+      db_ser_out("db_ser_out"),
+      done(false)
+    {
+      for (unsigned int i = 0; i < MAX_COUNT; ++i) {
+        Packet_t p;
+        p.dest = rand() & 0xf;
+        p.packet_id = rand() & 0x3;
+        p.data = (static_cast<NVUINTW(64)>(rand()) << 32) | rand();
+        packets.push_back(p);
+      }
+
+      ser.clk(clk);
+      ser.rst(rst);
+      db_ser.clk(clk);
+      db_ser.rst(rst);
+
+      src(ser_in);
+      ser.in_packet(ser_in);
+      ser.out_flit(ser_out);
+      sink(ser_out);
+
+      db_src(db_ser_in);
+      db_ser.in_packet(db_ser_in);
+      db_ser.out_flit(db_ser_out);
+      db_sink(db_ser_out);
+
+      harnesses_running++;
+
+      SC_THREAD(reset);
+
+      SC_THREAD(send);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+      SC_THREAD(receive);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+      SC_THREAD(db_receive);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+    }
+
+    void reset() {
+      rst.write(false);
+      wait(10, SC_NS);
+      rst.write(true);
+    }
+
+    void send() {
+      src.Reset();
+      db_src.Reset();
+      wait();
+      unsigned int sent = 0, db_sent = 0;
+      while (sent < MAX_COUNT || db_sent < MAX_COUNT) {
+        if (sent < MAX_COUNT && src.PushNB(packets[sent]))
+          sent++;
+        if (db_sent < MAX_COUNT && db_src.PushNB(packets[db_sent]))
+          db_sent++;
+        wait();
+      }
+      while (1) wait();
+    }
+
+    void receive() {
+      sink.Reset();
+      wait();
+      while (flits.size() < MAX_COUNT * FLITS_PER_PACKET) {
+        flits.push_back(sink.Pop());
+        wait();
+      }
+      check();
+      while (1) wait();
+    }
+
+    void db_receive() {
+      db_sink.Reset();
+      wait();
+      while (db_flits.size() < MAX_COUNT * FLITS_PER_PACKET) {
+        db_flits.push_back(db_sink.Pop());
+        db_times.push_back(sc_time_stamp());
+        wait();
+      }
+      check();
+      while (1) wait();
+    }
+
+    void check() {
+      if (done || flits.size() < MAX_COUNT * FLITS_PER_PACKET ||
+          db_flits.size() < MAX_COUNT * FLITS_PER_PACKET)
+        return;
+      done = true;
+      for (unsigned int i = 0; i < flits.size(); ++i) {
+        if (TypeToNVUINT(db_flits[i]) != TypeToNVUINT(flits[i])) {
+          std::cout << name() << " FAILED: flit " << i << ": " << std::hex
+                    << TypeToNVUINT(db_flits[i]) << " != " << TypeToNVUINT(flits[i])
+                    << std::dec << std::endl;
+          test_failed = true;
+        }
+      }
+      unsigned int gaps = 0;
+      for (unsigned int i = 1; i < db_times.size(); ++i) {
+        if (db_times[i] - db_times[i - 1] > clk.period())
+          gaps++;
+      }
+#ifdef CONNECTIONS_ACCURATE_SIM
+      if (gaps != 0) {
+        std::cout << name() << " FAILED: " << gaps
+                  << " idle cycles between flits of back-to-back packets" << std::endl;
+        test_failed = true;
+      }
+#endif
+      std::cout << name() << ": " << MAX_COUNT << " packets of "
+                << FLITS_PER_PACKET << " flits in "
+                << (db_times.back() - db_times.front()) / clk.period() + 1
+                << " cycles, " << gaps << " gaps" << std::endl;
+      if (--harnesses_running == 0)
+        sc_stop();
+    }
+};
+
+//------------------------------------------------------------------------
+// sc_main
+//------------------------------------------------------------------------
+
+int sc_main(int argc, char* argv[]) {
+  nvhls::set_random_seed();
+  TestHarness<Packet<64, 4, 1, 2>, Flit<16, 4, 1, 2, FlitId2bit>, StoreForward>
+      store_forward("store_forward");
+  TestHarness<Packet<64, 4, 1, 2>, Flit<16, 0, 0, 2, FlitId2bit, WormHole>, WormHole>
+      wormhole("wormhole");
+  sc_start();
+  if (test_failed) {
+    std::cout << "FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "PASS" << std::endl;
+  return 0;
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+//========================================================================
+// TestSerdesPacking.cpp
+//========================================================================
+
+#include <vector>
+#include <iomanip>
+#include <systemc.h>
+#include <nvhls_serdes.h>
+#include <nvhls_connections.h>
+#include <testbench/nvhls_rand.h>
+
+//------------------------------------------------------------------------
+// TestHarness: packing_serializer -> unpacking_deserializer
+//------------------------------------------------------------------------
+
+class TestHarness : public sc_module {
+  SC_HAS_PROCESS(TestHarness);
+
+ public:
+  typedef Packet<32, 4> Packet_t;
+  typedef Flit<256, 4, 1, 0, FlitId2bit, StoreForward> Flit_t;
+  typedef packing_serializer<Packet_t, Flit_t, 6, 1> Ser_t;
+  typedef unpacking_deserializer<Packet_t, Flit_t, 6> Deser_t;
+  static const unsigned int MAX_COUNT = 300;
+
+  sc_clock                              clk;
+  sc_signal< bool >                     rst;
+  Ser_t                                 ser;
+  Deser_t                               deser;
+
+  Connections::Out< Packet_t >          src;
+  Connections::In< Packet_t >           sink;
+  Connections::Combinational< Packet_t > ser_in;
+  Connections::Combinational< Flit_t >   link;
+  Connections::Combinational< Packet_t > deser_out;
+
+  std::vector<Packet_t> packets;
+
+  TestHarness(sc_module_name name)
+    : sc_module(name),
+      clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+      rst("rst"),
+      ser("serializer"),
+      deser("deserializer"),
+      src("src"),
+      sink("sink"),
+      ser_in("ser_in"),
+      link("link"),
+      deser_out("deser_out"),
+      num_flits(0)
+    {
+      // Runs of packets to the same dest, so that some flits are cut short
+      unsigned int dest = 1;
+      for (unsigned int i = 0; i < MAX_COUNT; ++i) {
+        if (rand() % 8 == 0)
+          dest = rand() & 0xf;
+        Packet_t p;
+        p.dest = dest;
+        p.data = rand();
+        packets.push_back(p);
+      }
+
+      ser.clk(clk);
+      ser.rst(rst);
+      deser.clk(clk);
+      deser.rst(rst);
+
+      src(ser_in);
+      ser.in_packet(ser_in);
+      ser.out_flit(link);
+      deser.in_flit(link);
+      deser.out_packet(deser_out);
+      sink(deser_out);
+
+      SC_THREAD(reset);
+
+      SC_THREAD(send);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+      SC_THREAD(receive);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+      SC_METHOD(count_flits);
+      sensitive << clk.posedge_event();
+    }
+
+    void reset() {
+      rst.write(false);
+      wait(10, SC_NS);
+      rst.write(true);
+    }
+
+    void count_flits() {
+      if (link.val.read() && link.rdy.read())
+        num_flits++;
+    }
+
+    void send() {
+      src.Reset();
+      wait();
+      for (unsigned int i = 0; i < MAX_COUNT; ++i) {
+        src.Push(packets[i]);
+        // Mostly back-to-back, with some idle cycles that flush the flit
+        if (rand() % 10 == 0)
+          wait(3);
+      }
+      while (1) wait();
+    }
+
+    void receive() {
+      sink.Reset();
+      wait();
+      for (unsigned int i = 0; i < MAX_COUNT; ++i) {
+        Packet_t p = sink.Pop();
+        if (p.data != packets[i].data || p.dest != packets[i].dest) {
+          std::cout << "FAILED: packet " << i << " = " << std::hex << p.data
+                    << " dest " << p.dest << ", expected " << packets[i].data
+                    << " dest " << packets[i].dest << std::dec << std::endl;
+          sc_stop();
+          return;
+        }
+      }
+      std::cout << MAX_COUNT << " packets in " << num_flits << " flits ("
+                << std::fixed << std::setprecision(2)
+                << (double)MAX_COUNT / num_flits << " per flit)" << std::endl;
+      if (num_flits * 2 > MAX_COUNT) {
+        std::cout << "FAILED: packets are not packed" << std::endl;
+      } else {
+        std::cout << "PASS" << std::endl;
+      }
+      sc_stop();
+    }
+
+ private:
+  unsigned int num_flits;
+};
+
+//------------------------------------------------------------------------
+// sc_main
+//------------------------------------------------------------------------
+
+int sc_main(int argc, char* argv[]) {
+  nvhls::set_random_seed();
+  TestHarness test("test");
+  sc_start();
+  return 0;
+}
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+//========================================================================
+// TestSerdesRetry.cpp
+//========================================================================
+
+#include <vector>
+#include <systemc.h>
+#include <nvhls_serdes.h>
+#include <nvhls_link_retry.h>
+#include <nvhls_connections.h>
+#include <TypeToBits.h>
+#include <testbench/nvhls_rand.h>
+
+static bool test_failed = false;
+
+//------------------------------------------------------------------------
+// ErrorLink: flips one random bit of some flits
+//------------------------------------------------------------------------
+
+template <typename link_flit_t>
+class ErrorLink : public sc_module {
+  SC_HAS_PROCESS(ErrorLink);
+
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  Connections::In<link_flit_t> in;
+  Connections::Out<link_flit_t> out;
+  const unsigned int error_pct;
+  unsigned int corrupted;
+
+  ErrorLink(sc_module_name name, unsigned int error_pct_)
+    : sc_module(name), clk("clk"), rst("rst"), in("in"), out("out"),
+      error_pct(error_pct_), corrupted(0) {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void run() {
+    in.Reset();
+    out.Reset();
+    wait();
+    while (1) {
+      link_flit_t link = in.Pop();
+      if (static_cast<unsigned int>(rand() % 100) < error_pct) {
+        NVUINTW(link_flit_t::width) bits = TypeToNVUINT(link);
+        unsigned int b = rand() % link_flit_t::width;
+        bits[b] = (bits[b] == 1) ? 0 : 1;
+        link = NVUINTToType<link_flit_t>(bits);
+        corrupted++;
+      }
+      out.Push(link);
+      wait();
+    }
+  }
+};
+
+//------------------------------------------------------------------------
+// TestHarness: serializer -> retry link with bit errors -> deserializer
+//------------------------------------------------------------------------
+
+class TestHarness : public sc_module {
+  SC_HAS_PROCESS(TestHarness);
+
+ public:
+  typedef Packet<64, 4, 1, 2> Packet_t;
+  typedef Flit<16, 0, 0, 2, FlitId2bit, WormHole> Flit_t;
+  typedef retry_link_sender<Flit_t, 8> Sender_t;
+  typedef retry_link_receiver<Flit_t, 8> Receiver_t;
+  typedef Sender_t::link_flit_t LinkFlit_t;
+  typedef Sender_t::link_ack_t LinkAck_t;
+  static const unsigned int MAX_COUNT = 200;
+  static const unsigned int ERROR_PCT = 5;
+
+  sc_clock                                 clk;
+  sc_signal< bool >                        rst;
+  serializer<Packet_t, Flit_t, WormHole>   ser;
+  Sender_t                                 sender;
+  ErrorLink<LinkFlit_t>                    link;
+  Receiver_t                               receiver;
+  deserializer<Packet_t, Flit_t, 0, WormHole> deser;
+
+  Connections::Out< Packet_t >             src;
+  Connections::In< Packet_t >              sink;
+  Connections::Combinational< Packet_t >   ser_in;
+  Connections::Combinational< Flit_t >     ser_out;
+  Connections::Combinational< LinkFlit_t > link_tx;
+  Connections::Combinational< LinkFlit_t > link_rx;
+  Connections::Combinational< LinkAck_t >  link_ack;
+  Connections::Combinational< Flit_t >     deser_in;
+  Connections::Combinational< Packet_t >   deser_out;
+
+  std::vector<Packet_t> packets;
+
+  TestHarness(sc_module_name name)
+    : sc_module(name),
+      clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+      rst("rst"),
+      ser("serializer"),
+      sender("sender"),
+      link("link", ERROR_PCT),
+      receiver("receiver"),
+      deser("deserializer"),
+      src("src"),
+      sink("sink"),
+      ser_in("ser_in"),
+      ser_out("ser_out"),
+      link_tx("link_tx"),
+      link_rx("link_rx"),
+      link_ack("link_ack"),
+      deser_in("deser_in"),
+      deser_out("deser_out")
+    {
+      for (unsigned int i = 0; i < MAX_COUNT; ++i) {
+        Packet_t p;
+        p.dest = rand() & 0xf;
+        p.packet_id = rand() & 0x3;
+        p.data = (static_cast<NVUINTW(64)>(rand()) << 32) | rand();
+        packets.push_back(p);
+      }
+
+      ser.clk(clk);
+      ser.rst(rst);
+      sender.clk(clk);
+      sender.rst(rst);
+      link.clk(clk);
+      link.rst(rst);
+      receiver.clk(clk);
+      receiver.rst(rst);
+      deser.clk(clk);
+      deser.rst(rst);
+
+      src(ser_in);
+      ser.in_packet(ser_in);
+      ser.out_flit(ser_out);
+      sender.in_flit(ser_out);
+      sender.out_link(link_tx);
+      link.in(link_tx);
+      link.out(link_rx);
+      receiver.in_link(link_rx);
+      receiver.out_flit(deser_in);
+      receiver.out_ack(link_ack);
+      sender.in_ack(link_ack);
+      deser.in_flit(deser_in);
+      deser.out_packet(deser_out);
+      sink(deser_out);
+
+      SC_THREAD(reset);
+
+      SC_THREAD(send);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+      SC_THREAD(receive);
+      sensitive << clk.pos();
+      NVHLS_NEG_RESET_SIGNAL_IS(rst);
+    }
+
+    void reset() {
+      rst.write(false);
+      wait(10, SC_NS);
+      rst.write(true);
+    }
+
+    void send() {
+      src.Reset();
+      wait();
+      for (unsigned int i = 0; i < MAX_COUNT; ++i) {
+        src.Push(packets[i]);
+        wait();
+      }
+      while (1) wait();
+    }
+
+    void receive() {
+      sink.Reset();
+      wait();
+      for (unsigned int i = 0; i < MAX_COUNT; ++i) {
+        Packet_t p = sink.Pop();
+        if (p.dest != packets[i].dest || p.packet_id != packets[i].packet_id ||
+            p.data != packets[i].data) {
+          std::cout << "FAILED: packet " << i << ": " << std::hex << p.data
+                    << " != " << packets[i].data << std::dec << std::endl;
+          test_failed = true;
+        }
+        wait();
+      }
+      // Let copies still on the link drain, then every corrupted flit must
+      // have been caught
+      for (unsigned int c = 0; c < 20; ++c)
+        wait();
+      if (receiver.crc_error_count != link.corrupted || sender.retry_count == 0) {
+        std::cout << "FAILED: " << link.corrupted << " corrupted flits, "
+                  << receiver.crc_error_count << " CRC errors, "
+                  << sender.retry_count << " retries" << std::endl;
+        test_failed = true;
+      }
+      std::cout << MAX_COUNT << " packets, " << link.corrupted << " corrupted flits, "
+                << receiver.crc_error_count << " CRC errors, "
+                << sender.retry_count << " retries" << std::endl;
+      sc_stop();
+    }
+};
+
+//------------------------------------------------------------------------
+// sc_main
+//------------------------------------------------------------------------
+
+int sc_main(int argc, char* argv[]) {
+  nvhls::set_random_seed();
+  // The parallel CRC must match a bit-serial LFSR
+  typedef crc_gen<41, 16, 0x1021> Crc_t;
+  for (unsigned int i = 0; i < 1000; ++i) {
+    Crc_t::Data d = (static_cast<Crc_t::Data>(rand()) << 20) ^ rand();
+    Crc_t::Crc crc = 0;
+    for (int b = 40; b >= 0; --b) {
+      bool feedback = (crc[15] == 1) ^ (d[b] == 1);
+      crc <<= 1;
+      if (feedback)
+        crc ^= 0x1021;
+    }
+    if (Crc_t::Compute(d) != crc) {
+      std::cout << "FAILED: CRC of " << std::hex << d << " is " << Crc_t::Compute(d)
+                << " instead of " << crc << std::dec << std::endl;
+      test_failed = true;
+    }
+  }
+  TestHarness test("test");
+  sc_start();
+  if (test_failed) {
+    std::cout << "FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "PASS" << std::endl;
+  return 0;
+}
@@ -40,9 +40,9 @@ class TestSinkBlocking : public sc_module {
   sc_in_clk            clk;
   sc_in<bool>          rst;
   Connections::In< T > in_;
-  Pacer pacer;
+  nvhls::GeometricPacer pacer;
 
-  TestSinkBlocking(sc_module_name name, const Pacer& pacer_, std::vector<T>& data)
+  TestSinkBlocking(sc_module_name name, const nvhls::GeometricPacer& pacer_, std::vector<T>& data)
     : sc_module(name),
       clk("clk"),
       rst("rst"),
@@ -51,6 +51,7 @@ class TestSinkBlocking : public sc_module {
       msgs(data),
       count(0)
   {
+    pacer.SetName(std::string(this->name()) + ".pacer");
     SC_CTHREAD(tick, clk.pos());
     NVHLS_NEG_RESET_SIGNAL_IS(rst);
   }
@@ -120,9 +121,9 @@ class TestSinkNonBlocking : public sc_module {
   sc_in_clk            clk;
   sc_in<bool>          rst;
   Connections::In< T > in_;
-  Pacer pacer;
+  nvhls::GeometricPacer pacer;
 
-  TestSinkNonBlocking(sc_module_name name, const Pacer& pacer_, std::vector<T>& data)
+  TestSinkNonBlocking(sc_module_name name, const nvhls::GeometricPacer& pacer_, std::vector<T>& data)
     : sc_module(name),
       clk("clk"),
       rst("rst"),
@@ -131,6 +132,7 @@ class TestSinkNonBlocking : public sc_module {
       msgs(data),
       count(0)
   {
+    pacer.SetName(std::string(this->name()) + ".pacer");
     SC_CTHREAD(tick, clk.pos());
     NVHLS_NEG_RESET_SIGNAL_IS(rst);
   }
@@ -193,7 +195,7 @@ class TestSinkNonBlocking : public sc_module {
 // TestSinkBuffered
 //------------------------------------------------------------------------
 
-template< typename T, int W >
+template< typename T, int W, bool Bypass = false >
 class TestSinkBuffered : public sc_module {
   SC_HAS_PROCESS(TestSinkBuffered);
 
@@ -201,10 +203,10 @@ class TestSinkBuffered : public sc_module {
   // Module Interface
   sc_in_clk            clk;
   sc_in<bool>          rst;
-  Connections::InBuffered< T, W > in_;
-  Pacer pacer;
+  Connections::InBuffered< T, W, Connections::AUTO_PORT, Bypass > in_;
+  nvhls::GeometricPacer pacer;
 
-  TestSinkBuffered(sc_module_name name, const Pacer& pacer_, std::vector<T>& data)
+  TestSinkBuffered(sc_module_name name, const nvhls::GeometricPacer& pacer_, std::vector<T>& data)
     : sc_module(name),
       clk("clk"),
       rst("rst"),
@@ -213,6 +215,7 @@ class TestSinkBuffered : public sc_module {
       count(0),
       msgs(data)
   {
+    pacer.SetName(std::string(this->name()) + ".pacer");
     SC_CTHREAD(tick, clk.pos());
     NVHLS_NEG_RESET_SIGNAL_IS(rst);
   }
@@ -222,7 +225,8 @@ class TestSinkBuffered : public sc_module {
     go = false;
     typename std::vector<T>::iterator it = msgs.begin();
     while (1) {
-      in_.TransferNB();
+      // In bypass mode the port is read by Empty() and TransferNB() comes last
+      if (!Bypass) in_.TransferNB();
       if (go) {
         T msg;
         if (!in_.Empty()) {
@@ -238,12 +242,14 @@ class TestSinkBuffered : public sc_module {
           if (it == msgs.end())
             sc_stop();
         }
+        if (Bypass) in_.TransferNB();
         wait();
         while (pacer.tic()) {
           cout << "@" << sc_time_stamp() << "\t" << name() << " STALL" << endl;
           wait();
         }
       } else {
+        if (Bypass) in_.TransferNB();
         wait();
       }
     }
@@ -40,10 +40,10 @@ class TestSourceBlocking : public sc_module {
   sc_in_clk           clk;
   sc_in<bool>         rst;
   Connections::Out<T> out;
-  Pacer pacer;
+  nvhls::GeometricPacer pacer;
   std::vector<T>& msgs;
 
-  TestSourceBlocking(sc_module_name name, const Pacer& pacer_, std::vector<T>& data)
+  TestSourceBlocking(sc_module_name name, const nvhls::GeometricPacer& pacer_, std::vector<T>& data)
     : sc_module(name),
       clk("clk"),
       rst("rst"),
@@ -51,6 +51,7 @@ class TestSourceBlocking : public sc_module {
       pacer(pacer_),
       msgs(data)
   {
+    pacer.SetName(std::string(this->name()) + ".pacer");
     SC_CTHREAD(tick, clk.pos());
     NVHLS_NEG_RESET_SIGNAL_IS(rst);
   }
@@ -115,10 +116,10 @@ class TestSourceNonBlocking : public sc_module {
   sc_in_clk           clk;
   sc_in<bool>         rst;
   Connections::Out<T> out;
-  Pacer pacer;
+  nvhls::GeometricPacer pacer;
   std::vector<T>& msgs;
 
-  TestSourceNonBlocking(sc_module_name name, const Pacer& pacer_, std::vector<T>& data)
+  TestSourceNonBlocking(sc_module_name name, const nvhls::GeometricPacer& pacer_, std::vector<T>& data)
     : sc_module(name),
       clk("clk"),
       rst("rst"),
@@ -126,6 +127,7 @@ class TestSourceNonBlocking : public sc_module {
       pacer(pacer_),
       msgs(data)
   {
+    pacer.SetName(std::string(this->name()) + ".pacer");
     SC_CTHREAD(tick, clk.pos());
     NVHLS_NEG_RESET_SIGNAL_IS(rst);
   }
@@ -178,7 +180,7 @@ class TestSourceNonBlocking : public sc_module {
 // TestSourceNonBlocking
 //------------------------------------------------------------------------
 
-template< typename T, int W >
+template< typename T, int W, bool Bypass = false >
 class TestSourceBuffered : public sc_module {
   SC_HAS_PROCESS(TestSourceBuffered);
 
@@ -186,11 +188,11 @@ class TestSourceBuffered : public sc_module {
   // Module Interface
   sc_in_clk           clk;
   sc_in<bool>         rst;
-  Connections::OutBuffered<T, W> out;
-  Pacer pacer;
+  Connections::OutBuffered<T, W, Connections::AUTO_PORT, Bypass> out;
+  nvhls::GeometricPacer pacer;
   std::vector<T>& msgs;
 
-  TestSourceBuffered(sc_module_name name, const Pacer& pacer_, std::vector<T>& data)
+  TestSourceBuffered(sc_module_name name, const nvhls::GeometricPacer& pacer_, std::vector<T>& data)
     : sc_module(name),
       clk("clk"),
       rst("rst"),
@@ -198,6 +200,7 @@ class TestSourceBuffered : public sc_module {
       pacer(pacer_),
       msgs(data)
   {
+    pacer.SetName(std::string(this->name()) + ".pacer");
     SC_CTHREAD(tick, clk.pos());
     NVHLS_NEG_RESET_SIGNAL_IS(rst);
   }
@@ -209,6 +212,8 @@ class TestSourceBuffered : public sc_module {
     typename std::vector<T>::iterator it = msgs.begin();
     while (1) {
       out.TransferNB();
+      NVHLS_ASSERT_MSG(out.AlmostFull(0) == out.Full() && out.AlmostFull(W) &&
+                       out.AlmostEmpty(0) == out.Empty(), "Buffered port watermarks disagree with Full/Empty");
       if (go && !done) {
         if (!out.Full()) {
           out.Push(*it);
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+//========================================================================
+// TestWideBuffer.cc
+//========================================================================
+
+#include <vector>
+#include <deque>
+#include <iomanip>
+#include <systemc.h>
+#include <mc_scverify.h>
+
+#include <nvhls_connections.h>
+#include <testbench/nvhls_rand.h>
+
+// The producer and consumer drive the val/rdy signals of several ports in
+// the same cycle, so the channel is tested with DIRECT_PORT ports.
+
+//------------------------------------------------------------------------
+// WideSource: offers up to N messages per cycle on out[0..k-1]
+//------------------------------------------------------------------------
+
+template< typename T, unsigned int N >
+class WideSource : public sc_module {
+  SC_HAS_PROCESS(WideSource);
+
+ public:
+  sc_in_clk           clk;
+  sc_in<bool>         rst;
+  Connections::Out<T, Connections::DIRECT_PORT> out[N];
+  unsigned int        max_count;
+  unsigned int        num_cycles_full;
+
+  WideSource(sc_module_name name, unsigned int max_count_)
+    : sc_module(name), clk("clk"), rst("rst"), max_count(max_count_), num_cycles_full(0)
+  {
+#ifdef CONNECTIONS_SIM_ONLY
+    for (unsigned int i = 0; i < N; ++i)
+      out[i].disable_spawn();
+#endif
+    SC_THREAD(tick);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void tick() {
+    for (unsigned int i = 0; i < N; ++i) {
+      out[i].val.write(false);
+      out[i].msg.write(0);
+    }
+    unsigned int next = 0;
+    unsigned int offered = 0;
+    wait();
+    while (1) {
+      // Keep offering the messages that were not accepted, add new ones
+      if (offered == 0 || rand() % 2) {
+        offered = N;
+      }
+      if (next + offered > max_count)
+        offered = max_count - next;
+      for (unsigned int i = 0; i < N; ++i) {
+        out[i].val.write(i < offered);
+        out[i].msg.write(next + i);
+      }
+      wait();
+      unsigned int accepted = 0;
+      for (unsigned int i = 0; i < offered; ++i) {
+        if (out[i].rdy.read())
+          accepted++;
+      }
+      if (offered > 0 && accepted == offered)
+        num_cycles_full++;
+      next += accepted;
+      offered -= accepted;
+    }
+  }
+};
+
+//------------------------------------------------------------------------
+// WideSink: takes up to M messages per cycle from in[0..k-1] and checks
+// their order
+//------------------------------------------------------------------------
+
+template< typename T, unsigned int M >
+class WideSink : public sc_module {
+  SC_HAS_PROCESS(WideSink);
+
+ public:
+  sc_in_clk           clk;
+  sc_in<bool>         rst;
+  Connections::In<T, Connections::DIRECT_PORT> in[M];
+  unsigned int        max_count;
+  unsigned int        count;
+  unsigned int        cycles;
+  unsigned int        max_per_cycle;
+
+  WideSink(sc_module_name name, unsigned int max_count_)
+    : sc_module(name), clk("clk"), rst("rst"), max_count(max_count_), count(0), cycles(0),
+      max_per_cycle(0)
+  {
+#ifdef CONNECTIONS_SIM_ONLY
+    for (unsigned int j = 0; j < M; ++j)
+      in[j].disable_spawn();
+#endif
+    SC_THREAD(tick);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void tick() {
+    for (unsigned int j = 0; j < M; ++j)
+      in[j].rdy.write(false);
+    wait();
+    while (1) {
+      // Take messages in order: a random prefix of the ports, mostly all
+      unsigned int take = (rand() % 4 == 0) ? rand() % (M + 1) : M;
+      for (unsigned int j = 0; j < M; ++j)
+        in[j].rdy.write(j < take);
+      wait();
+      cycles++;
+      unsigned int taken = 0;
+      for (unsigned int j = 0; j < take; ++j) {
+        if (in[j].val.read()) {
+          T msg = in[j].msg.read();
+          if (msg != count) {
+            std::cout << "FAILED: msg[" << count << "] = " << msg << std::endl;
+            sc_stop();
+          }
+          count++;
+          taken++;
+        }
+      }
+      if (taken > max_per_cycle)
+        max_per_cycle = taken;
+      if (count == max_count) {
+        std::cout << "PASS: " << count << " messages in " << cycles << " cycles, up to "
+                  << max_per_cycle << " per cycle" << std::endl;
+        sc_stop();
+      }
+    }
+  }
+};
+
+//------------------------------------------------------------------------
+// TestHarness
+//------------------------------------------------------------------------
+
+template< typename T, unsigned int NumEntries, unsigned int N, unsigned int M >
+class TestHarness : public sc_module {
+  SC_HAS_PROCESS(TestHarness);
+
+ public:
+  sc_clock                      clk;
+  sc_signal< bool >             rst;
+  WideSource<T, N>              src;
+  WideSink<T, M>                sink;
+
+  Connections::WideBuffer<T, NumEntries, N, M, Connections::DIRECT_PORT> buffer;
+
+  Connections::Combinational<T, Connections::DIRECT_PORT> enq_chan[N];
+  Connections::Combinational<T, Connections::DIRECT_PORT> deq_chan[M];
+
+  TestHarness(sc_module_name name, unsigned int max_count)
+    : sc_module(name),
+      clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+      rst("rst"),
+      src("src", max_count),
+      sink("sink", max_count),
+      buffer("buffer"),
+      cycle(0)
+    {
+      src.clk(clk);
+      src.rst(rst);
+      sink.clk(clk);
+      sink.rst(rst);
+      buffer.clk(clk);
+      buffer.rst(rst);
+
+      for (unsigned int i = 0; i < N; ++i) {
+        src.out[i](enq_chan[i]);
+        buffer.enq[i](enq_chan[i]);
+      }
+      for (unsigned int j = 0; j < M; ++j) {
+        buffer.deq[j](deq_chan[j]);
+        sink.in[j](deq_chan[j]);
+      }
+
+      SC_THREAD(reset);
+
+      SC_METHOD(line_trace);
+      sensitive << clk.posedge_event();
+    }
+
+    void line_trace() {
+      if (rst.read()) {
+        std::cout << std::dec << "[" << std::setw(3) << cycle++ << "] ";
+        buffer.line_trace();
+        std::cout << std::endl;
+      }
+    }
+
+    void reset() {
+      std::cout << "@" << sc_time_stamp() <<" Asserting reset" << std::endl;
+      rst.write(0);
+      wait( 10, SC_NS );
+      rst.write(1);
+      std::cout << "@" << sc_time_stamp() <<" De-Asserting reset" << std::endl;
+      cycle = 0;
+    }
+
+ private:
+  unsigned int cycle;
+};
+
+//------------------------------------------------------------------------
+// sc_main
+//------------------------------------------------------------------------
+
+int sc_main(int argc, char* argv[]) {
+  nvhls::set_random_seed();
+  typedef sc_uint<32> Bits;
+  static const unsigned int MAX_COUNT = 400;
+
+  TestHarness<Bits, 8, 4, 2> test("test", MAX_COUNT);
+  sc_start();
+  return 0;
+}
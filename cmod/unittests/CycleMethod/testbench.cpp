@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_cycle_method.h>
+#include <nvhls_cycle_thread.h>
+#include <sys/resource.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+// A pipeline of kStages stages between a Connections source and sink. By
+// default the stages are CycleProcesses clocked by one CycleMethodHost, with
+// a MethodIn and a MethodOut at the ends; with CO_STAGES they are
+// CycleThreads under the same host, and with THREAD_STAGES every stage is an
+// SC_THREAD with Connections ports. All must deliver the same values in
+// order; compare the reported speed and peak memory of sim_test,
+// sim_test_coro and sim_test_thread. NUM_STAGES sets the number of stages.
+
+#ifndef NUM_STAGES
+#define NUM_STAGES 32
+#endif
+
+static const unsigned int kStages = NUM_STAGES;
+static const unsigned int kMessages = 20000;
+typedef NVUINT32 Msg;
+
+static Msg Work(Msg value, unsigned int stage) { return value * 3 + stage; }
+
+template <typename In_t, typename Out_t>
+class MethodStage : public match::CycleProcess {
+ public:
+  MethodStage(unsigned int id_, In_t& in_, Out_t& out_) : id(id_), in(in_), out(out_) {}
+
+  void Reset() { held = false; }
+
+  void Eval() {
+    if (!held && in.PopNB(reg)) {
+      reg = Work(reg, id);
+      held = true;
+    }
+    if (held && out.PushNB(reg)) {
+      held = false;
+    }
+  }
+
+ private:
+  unsigned int id;
+  In_t& in;
+  Out_t& out;
+  Msg reg;
+  bool held;
+};
+
+template <typename In_t, typename Out_t>
+class CoStage : public match::CycleThread {
+ public:
+  CoStage(unsigned int id_, In_t& in_, Out_t& out_) : id(id_), in(in_), out(out_) {}
+
+  void Eval() {
+    NVHLS_CO_BEGIN;
+    while (1) {
+      NVHLS_CO_POP(in, reg);
+      reg = Work(reg, id);
+      NVHLS_CO_PUSH(out, reg);
+      NVHLS_CO_WAIT();
+    }
+    NVHLS_CO_END;
+  }
+
+ private:
+  unsigned int id;
+  In_t& in;
+  Out_t& out;
+  Msg reg;
+};
+
+#ifdef CO_STAGES
+#define STAGE_CLASS CoStage
+#else
+#define STAGE_CLASS MethodStage
+#endif
+
+SC_MODULE(ThreadStage) {
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  Connections::In<Msg> in;
+  Connections::Out<Msg> out;
+  unsigned int id;
+
+  SC_HAS_PROCESS(ThreadStage);
+  ThreadStage(sc_module_name name, unsigned int id_)
+      : sc_module(name), clk("clk"), rst("rst"), in("in"), out("out"), id(id_) {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void run() {
+    in.Reset();
+    out.Reset();
+    Msg reg;
+    bool held = false;
+    wait();
+    while (1) {
+      if (!held && in.PopNB(reg)) {
+        reg = Work(reg, id);
+        held = true;
+      }
+      if (held && out.PushNB(reg)) {
+        held = false;
+      }
+      wait();
+    }
+  }
+};
+
+SC_MODULE(testbench) {
+  typedef match::CycleChannel<Msg> Chan;
+  typedef match::MethodIn<Msg> MIn;
+  typedef match::MethodOut<Msg> MOut;
+
+  sc_clock clk;
+  sc_signal<bool> rst;
+  Connections::Out<Msg> src;
+  Connections::In<Msg> sink;
+  Connections::Combinational<Msg> src_chan;
+  Connections::Combinational<Msg> sink_chan;
+
+#ifdef THREAD_STAGES
+  std::vector<ThreadStage*> stages;
+  std::vector<Connections::Combinational<Msg>*> links;
+#else
+  match::ParallelSim sim;
+  match::CycleMethodHost host;
+  MIn first;
+  MOut last;
+  std::vector<Chan*> links;
+  std::vector<match::CycleProcess*> stages;
+#endif
+  bool passed;
+  double wall_s;
+  uint64_t cycles;
+
+  SC_HAS_PROCESS(testbench);
+  testbench(sc_module_name name)
+      : sc_module(name),
+        clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+        rst("rst"),
+        src("src"),
+        sink("sink"),
+#ifndef THREAD_STAGES
+        host("host", sim),
+        first("first", sim),
+        last("last", sim),
+#endif
+        passed(false),
+        wall_s(0),
+        cycles(0) {
+    src(src_chan);
+    sink(sink_chan);
+#ifdef THREAD_STAGES
+    for (unsigned int i = 0; i <= kStages; i++)
+      links.push_back(new Connections::Combinational<Msg>());
+    for (unsigned int i = 0; i < kStages; i++) {
+      ThreadStage* stage = new ThreadStage(sc_gen_unique_name("stage"), i);
+      stage->clk(clk);
+      stage->rst(rst);
+      stage->in((i == 0) ? src_chan : *links[i]);
+      stage->out((i == kStages - 1) ? sink_chan : *links[i + 1]);
+      stages.push_back(stage);
+    }
+#else
+    host.clk(clk);
+    host.rst(rst);
+    first.clk(clk);
+    first.rst(rst);
+    first.in(src_chan);
+    last.clk(clk);
+    last.rst(rst);
+    last.out(sink_chan);
+    for (unsigned int i = 0; i + 1 < kStages; i++)
+      links.push_back(new Chan(sim));
+    stages.push_back(new STAGE_CLASS<MIn, Chan>(0, first, *links[0]));
+    for (unsigned int i = 1; i + 1 < kStages; i++)
+      stages.push_back(new STAGE_CLASS<Chan, Chan>(i, *links[i - 1], *links[i]));
+    stages.push_back(new STAGE_CLASS<Chan, MOut>(kStages - 1, *links[kStages - 2], last));
+    for (unsigned int i = 0; i < kStages; i++)
+      sim.Add(stages[i]);
+#endif
+
+    SC_THREAD(reset);
+
+    SC_THREAD(send);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    SC_THREAD(receive);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void reset() {
+    rst.write(false);
+    wait(10, SC_NS);
+    rst.write(true);
+  }
+
+  void send() {
+    src.Reset();
+    wait();
+    for (unsigned int i = 0; i < kMessages; i++) {
+      src.Push(i);
+      wait();
+    }
+    while (1) wait();
+  }
+
+  void receive() {
+    sink.Reset();
+    wait();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    sc_time t0 = sc_time_stamp();
+    passed = true;
+    for (unsigned int i = 0; i < kMessages; i++) {
+      Msg expected = i;
+      for (unsigned int s = 0; s < kStages; s++)
+        expected = Work(expected, s);
+      Msg msg = sink.Pop();
+      if (msg != expected) {
+        std::cout << "FAILED: message " << i << ": " << std::hex << msg << " != " << expected
+                  << std::dec << std::endl;
+        passed = false;
+        break;
+      }
+      wait();
+    }
+    wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    cycles = static_cast<uint64_t>((sc_time_stamp() - t0) / clk.period());
+    sc_stop();
+  }
+};
+
+int sc_main(int argc, char* argv[]) {
+  testbench tb("tb");
+  sc_start();
+#ifdef THREAD_STAGES
+  const char* mode = "SC_THREAD stages";
+#elif defined(CO_STAGES)
+  const char* mode = "CycleThread stages";
+#else
+  const char* mode = "SC_METHOD host";
+#endif
+  std::cout << kMessages << " messages through " << kStages << " stages (" << mode << ") in "
+            << tb.cycles << " cycles, " << tb.wall_s << " s, "
+            << (tb.wall_s > 0 ? tb.cycles / tb.wall_s : 0) << " cycles/s" << std::endl;
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  std::cout << "Peak resident memory: " << usage.ru_maxrss << " KB" << std::endl;
+  if (!tb.passed) {
+    std::cout << "Simulation FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "Simulation PASSED" << std::endl;
+  return 0;
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <damq.h>
+#include <hls_globals.h>
+#include <nvhls_assert.h>
+#include "DamqTop.h"
+
+void DamqTop( const OpType& op, const DataType& data, const BankIdx& idx, OutType& out)
+{
+    static Damq_ damq;
+    out = 0;
+    NVHLS_ASSERT_MSG(idx < NUM_QUEUES, "Queue index is less than number of queues");
+    switch (op)
+    {
+        case push:          damq.push(data, idx); break;
+        case pop:           out = damq.pop(idx); break;
+        case incrHead:      damq.incrHead(idx); break;
+        case peek:          out = damq.peek(idx); break;
+        case isEmpty:       out = damq.isEmpty(idx); break;
+        case isFull:        out = damq.isFull(idx); break;
+        case reset:         damq.reset(); break;
+        case numAvailable:  out = damq.NumAvailable(idx); break;
+        // The low bits of data give the offset
+        case peekAt:        out = damq.peekAt(Damq_::FifoIdx(data), idx); break;
+        default:
+            NVHLS_ASSERT_MSG(0, "op not supported");
+            damq.reset(); break;
+    }
+}
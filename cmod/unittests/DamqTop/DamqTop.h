@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef DAMQ_TOP_H
+#define DAMQ_TOP_H
+
+#include <damq.h>
+#include <hls_globals.h>
+#include <nvhls_assert.h>
+
+#ifndef DAMQ_ENTRIES
+#define DAMQ_ENTRIES 8
+#endif
+
+#ifndef WORD_WIDTH
+#define WORD_WIDTH 16
+#endif
+
+#ifndef NUM_QUEUES
+#define NUM_QUEUES 4
+#endif
+
+#ifndef MIN_RESERVE
+#define MIN_RESERVE 1
+#endif
+
+
+typedef NVUINTC(WORD_WIDTH) MemWord_t;
+
+
+enum DamqOp {
+    push=0,
+    pop,
+    incrHead,
+    peek,
+    isEmpty,
+    isFull,
+    reset,
+    numAvailable,
+    peekAt,
+    MAXOP
+};
+
+typedef DAMQ<MemWord_t, DAMQ_ENTRIES, NUM_QUEUES, MIN_RESERVE> Damq_;
+typedef MemWord_t DataType;
+typedef DataType OutType;
+typedef Damq_::BankIdx BankIdx;
+typedef NVUINTC(nvhls::nbits<MAXOP -1 >::val) OpType;
+
+void DamqTop( const OpType& op, const DataType& data, const BankIdx& idx, OutType& out);
+
+#endif
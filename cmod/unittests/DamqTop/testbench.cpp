@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include "DamqTop.h"
+#include <match_scverify.h>
+#include <testbench/nvhls_rand.h>
+
+#include <deque>
+
+#ifndef NUM_ITER
+#define NUM_ITER 10000
+#endif
+
+// Entries a queue can still take: the free entries that are not reserved for
+// the other queues
+unsigned int ref_available(std::deque<MemWord_t> ref_q[NUM_QUEUES], unsigned int idx)
+{
+    unsigned int used = 0, reserved = 0;
+    for (int j = 0; j < NUM_QUEUES; ++j)
+    {
+        used += ref_q[j].size();
+        if (j != (int)idx && ref_q[j].size() < MIN_RESERVE)
+            reserved += MIN_RESERVE - ref_q[j].size();
+    }
+    return DAMQ_ENTRIES - used - reserved;
+}
+
+OpType semi_rand_op(int size, unsigned int available)
+{
+    OpType op;
+
+    do {
+        op = rand()%MAXOP;
+    } while (   // avoid data access while empty and pushing while full, both would fail assertions;
+                // reset is rare so that the shared entries fill up
+                ((size == 0) && (op==pop || op==incrHead || op==peek || op==peekAt)) ||
+                (available == 0 && op==push) ||
+                (op==reset && rand()%16 != 0));
+
+    return op;
+}
+
+CCS_MAIN(int argc, char *argv[]) {
+
+    nvhls::set_random_seed();
+
+    MemWord_t data;
+    OpType op;
+    BankIdx idx;
+    OutType out;
+
+    std::deque<MemWord_t> ref_q[NUM_QUEUES];
+    unsigned int max_size = 0;
+
+    for (int i=0; i< NUM_ITER; ++i)
+    {
+        // Skew the traffic towards queue 0 so that it takes the shared entries
+        idx = (rand()%2) ? 0 : rand()%NUM_QUEUES;
+        unsigned int available = ref_available(ref_q, idx);
+        op = semi_rand_op(ref_q[idx].size(), available);
+        data = rand();
+        if (op == peekAt)
+            data = rand()%ref_q[idx].size();
+        CCS_DESIGN(DamqTop)(op, data, idx, out);
+
+        switch (op)
+        {
+            case push:
+                            assert(available > 0);
+                            ref_q[idx].push_back(data);
+                            if (ref_q[idx].size() > max_size)
+                                max_size = ref_q[idx].size();
+                            break;
+
+            case pop:
+                            assert(out == ref_q[idx].front());
+                            ref_q[idx].pop_front();
+                            break;
+
+            case incrHead:
+                            ref_q[idx].pop_front();
+                            break;
+
+            case peek:
+                            assert(out == ref_q[idx].front());
+                            break;
+
+            case isEmpty:
+                            assert(out == ref_q[idx].empty());
+                            break;
+
+            case isFull:
+                            assert(out == (available == 0));
+                            break;
+
+            case reset:
+                            for (int j=0; j< NUM_QUEUES; ++j)
+                            {
+                                ref_q[j].clear();
+                            }
+                            break;
+
+            case numAvailable:
+                            assert(out == available);
+                            break;
+
+            case peekAt:
+                            assert(out == ref_q[idx][data.to_uint64()]);
+                            break;
+
+            default:
+            assert(0);
+        }
+    }
+
+    // Queue 0 should have used more than a static share of the entries,
+    // if its limit allows it
+    DCOUT("Largest queue occupancy: " << max_size << " of " << DAMQ_ENTRIES << endl);
+    if (DAMQ_ENTRIES - (NUM_QUEUES - 1) * MIN_RESERVE > DAMQ_ENTRIES / NUM_QUEUES)
+        assert(max_size > DAMQ_ENTRIES / NUM_QUEUES);
+
+    DCOUT("CMODEL PASS" << endl);
+    CCS_RETURN(0) ;
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_divsqrt.h>
+#include <hls_globals.h>
+#include "DivSqrtTop.h"
+
+void DivSqrtTop(const bool& in_valid, const Data& num, const Data& den,
+                bool& div_valid, Data& quo, Data& rem,
+                bool& recip_valid, Reciprocal::out_t& recip,
+                bool& sqrt_valid, SquareRoot::out_t& root) {
+  static Divider divider;
+  static Reciprocal reciprocal;
+  static SquareRoot square_root;
+  // The reciprocal takes the divisor normalized to [1, 2)
+  Data norm = den;
+  norm[NUM_BITS - 1] = 1;
+  div_valid = divider.run(in_valid, num, den, quo, rem);
+  recip_valid = reciprocal.run(in_valid, norm, recip);
+  sqrt_valid = square_root.run(in_valid, num, root);
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef DIV_SQRT_TOP_H
+#define DIV_SQRT_TOP_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_divsqrt.h>
+#include <hls_globals.h>
+
+#ifndef NUM_BITS
+#define NUM_BITS 16
+#endif
+
+#ifndef ITERS_PER_CYCLE
+#define ITERS_PER_CYCLE 2
+#endif
+
+typedef NVUINTC(NUM_BITS) Data;
+
+typedef nvhls::PipelinedDivide<Data, ITERS_PER_CYCLE> Divider;
+typedef nvhls::PipelinedReciprocal<Data, NUM_BITS, ITERS_PER_CYCLE> Reciprocal;
+typedef nvhls::PipelinedSquareRoot<Data, ITERS_PER_CYCLE> SquareRoot;
+
+void DivSqrtTop(const bool& in_valid, const Data& num, const Data& den,
+                bool& div_valid, Data& quo, Data& rem,
+                bool& recip_valid, Reciprocal::out_t& recip,
+                bool& sqrt_valid, SquareRoot::out_t& root);
+
+#endif
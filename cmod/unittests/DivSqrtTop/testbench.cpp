@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <deque>
+#include <match_scverify.h>
+#include <testbench/nvhls_rand.h>
+
+#include "DivSqrtTop.h"
+
+#ifndef NUM_ITERS
+#define NUM_ITERS 2000
+#endif
+
+// Reference models on 128-bit host integers, valid for widths up to 48 bits
+typedef unsigned __int128 wide_t;
+
+wide_t ref_sqrt(wide_t x) {
+  wide_t r = 0;
+  for (int b = 63; b >= 0; b--) {
+    wide_t t = r | (wide_t(1) << b);
+    if (t * t <= x) r = t;
+  }
+  return r;
+}
+
+// Random operand of W bits with a random number of leading zeros, so that
+// small quotients and roots are exercised as well
+template <unsigned int W>
+NVUINTW(W) rand_operand() {
+  NVUINTW(W) x = nvhls::get_rand<W>();
+  if (rand() & 1) x = x >> (rand() % W);
+  return x;
+}
+
+// Checks divide, reciprocal and square_root against the reference models
+template <unsigned int W>
+bool check_combinational() {
+  typedef NVUINTW(W) T;
+  typedef typename nvhls::reciprocal_traits<T, W>::out_t R;
+  typedef typename nvhls::sqrt_traits<T>::out_t S;
+  bool ok = true;
+  for (int i = 0; i < NUM_ITERS; i++) {
+    T num = rand_operand<W>();
+    T den = (i % 16 == 0) ? T(0) : rand_operand<W>();
+    T quo, rem;
+    nvhls::divide<T>(num, den, quo, rem);
+    wide_t n = num.to_uint64(), d = den.to_uint64();
+    wide_t ref_quo = (d == 0) ? ((wide_t(1) << W) - 1) : (n / d);
+    wide_t ref_rem = (d == 0) ? n : (n % d);
+
+    T x = num;
+    x[W - 1] = 1;
+    R recip = nvhls::reciprocal<W, T>(x);
+    wide_t ref_recip = (wide_t(1) << (2 * W - 1)) / wide_t(x.to_uint64());
+
+    S root = nvhls::square_root<T>(num);
+    if ((wide_t(quo.to_uint64()) != ref_quo) || (wide_t(rem.to_uint64()) != ref_rem) ||
+        (wide_t(recip.to_uint64()) != ref_recip) || (wide_t(root.to_uint64()) != ref_sqrt(n))) {
+      std::cout << "ERROR: W=" << W << " num=" << num << " den=" << den << " quo=" << quo
+                << " rem=" << rem << " recip(" << x << ")=" << recip << " sqrt=" << root
+                << std::endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+// Checks that the iterations give the same state as the host model, which
+// C++ simulation uses in place of them
+template <unsigned int W>
+bool check_iterations() {
+  typedef NVUINTW(W) T;
+  static const unsigned int XW = W + (W & 1);
+  bool ok = true;
+  for (int i = 0; i < NUM_ITERS; i++) {
+    T num = rand_operand<W>();
+    T den = (i % 16 == 0) ? T(0) : rand_operand<W>();
+    T x = den;
+    x[W - 1] = 1;
+
+    nvhls::div_state<W, W, true> div_host = nvhls::divide_init<W, true>(num, den);
+    nvhls::div_state<W, W, false> div_iter = nvhls::divide_init<W, false>(num, den);
+    nvhls::div_stages(div_iter, 0, W);
+    nvhls::div_state<W, W + 1, true> recip_host = nvhls::reciprocal_init<W, W + 1, true>(x);
+    nvhls::div_state<W, W + 1, false> recip_iter = nvhls::reciprocal_init<W, W + 1, false>(x);
+    nvhls::div_stages(recip_iter, 0, W + 1);
+    nvhls::sqrt_state<XW, true> sqrt_host = nvhls::sqrt_init<XW, true>(num);
+    nvhls::sqrt_state<XW, false> sqrt_iter = nvhls::sqrt_init<XW, false>(num);
+    nvhls::sqrt_stages(sqrt_iter, 0, XW / 2);
+
+    if ((div_host.quo != div_iter.quo) || (div_host.rem != div_iter.rem) ||
+        (recip_host.quo != recip_iter.quo) || (recip_host.rem != recip_iter.rem) ||
+        (sqrt_host.root != sqrt_iter.root) || (sqrt_host.rem != sqrt_iter.rem)) {
+      std::cout << "ERROR: W=" << W << " host model differs from iterations for num=" << num
+                << " den=" << den << std::endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+// Checks that the pipelined units match the combinational ones after their
+// latency of cycles
+template <unsigned int W, unsigned int ItersPerCycle>
+bool check_pipelined() {
+  typedef NVUINTW(W) T;
+  typedef nvhls::PipelinedDivide<T, ItersPerCycle> Div;
+  typedef nvhls::PipelinedReciprocal<T, W, ItersPerCycle> Recip;
+  typedef nvhls::PipelinedSquareRoot<T, ItersPerCycle> Sqrt;
+  typedef typename Recip::out_t R;
+  typedef typename Sqrt::out_t S;
+  Div div;
+  Recip recip;
+  Sqrt sqrt;
+  std::deque<bool> div_exp_valid, recip_exp_valid, sqrt_exp_valid;
+  std::deque<T> div_exp;
+  std::deque<R> recip_exp;
+  std::deque<S> sqrt_exp;
+  for (unsigned int i = 0; i < Div::Latency; i++) div_exp_valid.push_back(false);
+  for (unsigned int i = 0; i < Recip::Latency; i++) recip_exp_valid.push_back(false);
+  for (unsigned int i = 0; i < Sqrt::Latency; i++) sqrt_exp_valid.push_back(false);
+  bool ok = true;
+  for (int i = 0; i < NUM_ITERS; i++) {
+    bool valid = (rand() % 4 != 0);
+    T num = rand_operand<W>();
+    T den = rand_operand<W>();
+    T x = den;
+    x[W - 1] = 1;
+    T quo, rem;
+    R r_out;
+    S s_out;
+    bool d_valid = div.run(valid, num, den, quo, rem);
+    bool r_valid = recip.run(valid, x, r_out);
+    bool s_valid = sqrt.run(valid, num, s_out);
+    div_exp_valid.push_back(valid);
+    recip_exp_valid.push_back(valid);
+    sqrt_exp_valid.push_back(valid);
+    if (valid) {
+      T q, m;
+      nvhls::divide<T>(num, den, q, m);
+      div_exp.push_back(q);
+      div_exp.push_back(m);
+      recip_exp.push_back(nvhls::reciprocal<W, T>(x));
+      sqrt_exp.push_back(nvhls::square_root<T>(num));
+    }
+    if ((d_valid != div_exp_valid.front()) || (r_valid != recip_exp_valid.front()) ||
+        (s_valid != sqrt_exp_valid.front())) {
+      std::cout << "ERROR: pipelined valid mismatch at cycle " << i << std::endl;
+      ok = false;
+    }
+    if (d_valid && div_exp_valid.front()) {
+      if ((quo != div_exp[0]) || (rem != div_exp[1])) {
+        std::cout << "ERROR: pipelined divide mismatch at cycle " << i << std::endl;
+        ok = false;
+      }
+      div_exp.pop_front();
+      div_exp.pop_front();
+    }
+    if (r_valid && recip_exp_valid.front()) {
+      if (r_out != recip_exp.front()) {
+        std::cout << "ERROR: pipelined reciprocal mismatch at cycle " << i << std::endl;
+        ok = false;
+      }
+      recip_exp.pop_front();
+    }
+    if (s_valid && sqrt_exp_valid.front()) {
+      if (s_out != sqrt_exp.front()) {
+        std::cout << "ERROR: pipelined square root mismatch at cycle " << i << std::endl;
+        ok = false;
+      }
+      sqrt_exp.pop_front();
+    }
+    div_exp_valid.pop_front();
+    recip_exp_valid.pop_front();
+    sqrt_exp_valid.pop_front();
+  }
+  return ok;
+}
+
+CCS_MAIN(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  bool ok = true;
+
+  ok = check_combinational<2>() && ok;
+  ok = check_combinational<7>() && ok;
+  ok = check_combinational<NUM_BITS>() && ok;
+  ok = check_combinational<32>() && ok;
+  // Reciprocals of more than 64 bits always take the iterations
+  ok = check_combinational<40>() && ok;
+  ok = check_iterations<2>() && ok;
+  ok = check_iterations<9>() && ok;
+  ok = check_iterations<NUM_BITS>() && ok;
+  ok = check_iterations<32>() && ok;
+  ok = check_pipelined<NUM_BITS, 1>() && ok;
+  ok = check_pipelined<NUM_BITS, 2>() && ok;
+  ok = check_pipelined<NUM_BITS, 3>() && ok;
+  ok = check_pipelined<NUM_BITS, 64>() && ok;
+
+  // Drive the design: each result must come out Latency cycles after its
+  // inputs, equal to the reference models
+  std::deque<wide_t> div_exp, recip_exp, sqrt_exp;
+  for (int i = 0; i < NUM_ITERS; i++) {
+    bool in_valid = (i < NUM_ITERS - static_cast<int>(Divider::Latency + Reciprocal::Latency + SquareRoot::Latency));
+    Data num = rand_operand<NUM_BITS>();
+    Data den = rand_operand<NUM_BITS>();
+    bool div_valid, recip_valid, sqrt_valid;
+    Data quo, rem;
+    Reciprocal::out_t recip;
+    SquareRoot::out_t root;
+    CCS_DESIGN(DivSqrtTop)(in_valid, num, den, div_valid, quo, rem, recip_valid, recip, sqrt_valid, root);
+    if (in_valid) {
+      wide_t n = num.to_uint64(), d = den.to_uint64();
+      wide_t x = d | (wide_t(1) << (NUM_BITS - 1));
+      div_exp.push_back(d == 0 ? ((wide_t(1) << NUM_BITS) - 1) : n / d);
+      recip_exp.push_back((wide_t(1) << (2 * NUM_BITS - 1)) / x);
+      sqrt_exp.push_back(ref_sqrt(n));
+    }
+    if (div_valid) {
+      if (div_exp.empty() || (wide_t(quo.to_uint64()) != div_exp.front())) {
+        std::cout << "ERROR: divide output " << quo << std::endl;
+        ok = false;
+      } else {
+        div_exp.pop_front();
+      }
+    }
+    if (recip_valid) {
+      if (recip_exp.empty() || (wide_t(recip.to_uint64()) != recip_exp.front())) {
+        std::cout << "ERROR: reciprocal output " << recip << std::endl;
+        ok = false;
+      } else {
+        recip_exp.pop_front();
+      }
+    }
+    if (sqrt_valid) {
+      if (sqrt_exp.empty() || (wide_t(root.to_uint64()) != sqrt_exp.front())) {
+        std::cout << "ERROR: square root output " << root << std::endl;
+        ok = false;
+      } else {
+        sqrt_exp.pop_front();
+      }
+    }
+  }
+  if (!div_exp.empty() || !recip_exp.empty() || !sqrt_exp.empty()) {
+    std::cout << "ERROR: outputs missing" << std::endl;
+    ok = false;
+  }
+
+  if (ok) {
+    std::cout << "PASS" << std::endl;
+  } else {
+    std::cout << "FAIL" << std::endl;
+  }
+  CCS_RETURN(0);
+}
@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DoubleBufferedScratchpadTop.h"
+
+void DoubleBufferedScratchpadTop(producer_req_t& producer_req, producer_rsp_t& producer_rsp,
+                                 bool producer_ready[NUM_PRODUCER_PORTS], bool producer_done,
+                                 consumer_req_t& consumer_req, consumer_rsp_t& consumer_rsp,
+                                 bool consumer_ready[NUM_CONSUMER_PORTS], bool consumer_done,
+                                 bool& swapped) {
+  static dbuf_t dbuf;
+  dbuf.run(producer_req, producer_rsp, producer_ready, producer_done,
+           consumer_req, consumer_rsp, consumer_ready, consumer_done, swapped);
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DOUBLE_BUFFERED_SCRATCHPAD_TOP_H
+#define DOUBLE_BUFFERED_SCRATCHPAD_TOP_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <DoubleBufferedScratchpad.h>
+
+#ifndef NUM_BANKS
+#define NUM_BANKS 4
+#endif
+
+#ifndef NUM_BANK_ENTRIES
+#define NUM_BANK_ENTRIES 64
+#endif
+
+#ifndef NUM_PRODUCER_PORTS
+#define NUM_PRODUCER_PORTS 2
+#endif
+
+#ifndef NUM_CONSUMER_PORTS
+#define NUM_CONSUMER_PORTS 4
+#endif
+
+#ifndef LEN_INPUT_BUFFER
+#define LEN_INPUT_BUFFER 2
+#endif
+
+typedef NVUINT32 DataType;
+typedef DoubleBufferedScratchpad<DataType, NUM_BANKS * NUM_BANK_ENTRIES, NUM_PRODUCER_PORTS,
+                                 NUM_CONSUMER_PORTS, NUM_BANKS, LEN_INPUT_BUFFER> dbuf_t;
+typedef dbuf_t::producer_req_t producer_req_t;
+typedef dbuf_t::producer_rsp_t producer_rsp_t;
+typedef dbuf_t::consumer_req_t consumer_req_t;
+typedef dbuf_t::consumer_rsp_t consumer_rsp_t;
+
+void DoubleBufferedScratchpadTop(producer_req_t& producer_req, producer_rsp_t& producer_rsp,
+                                 bool producer_ready[NUM_PRODUCER_PORTS], bool producer_done,
+                                 consumer_req_t& consumer_req, consumer_rsp_t& consumer_rsp,
+                                 bool consumer_ready[NUM_CONSUMER_PORTS], bool consumer_done,
+                                 bool& swapped);
+
+#endif
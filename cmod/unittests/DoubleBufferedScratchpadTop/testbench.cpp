@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DoubleBufferedScratchpadTop.h"
+#include <match_scverify.h>
+#include <testbench/nvhls_rand.h>
+
+#include <deque>
+#include <vector>
+#include <algorithm>
+
+#ifndef NUM_TILES
+#define NUM_TILES 16
+#endif
+
+// The producer fills tile t while the consumer reads back tile t-1. Both
+// sides access the buffer in a random order with random stalls.
+const unsigned kTileWords = NUM_BANKS * NUM_BANK_ENTRIES;
+
+DataType tile_word(unsigned tile, unsigned addr) {
+  return DataType((tile * 0x9e3779b1u) ^ (addr * 2654435761u));
+}
+
+// Per-lane address list of one tile, lane l gets every kLanes-th address of
+// a random permutation
+template <unsigned kLanes>
+void tile_order(std::deque<unsigned> order[kLanes]) {
+  std::vector<unsigned> perm(kTileWords);
+  for (unsigned a = 0; a < kTileWords; a++) {
+    perm[a] = a;
+  }
+  for (unsigned a = kTileWords - 1; a > 0; a--) {
+    std::swap(perm[a], perm[rand() % (a + 1)]);
+  }
+  for (unsigned a = 0; a < kTileWords; a++) {
+    order[a % kLanes].push_back(perm[a]);
+  }
+}
+
+CCS_MAIN(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+
+  producer_req_t producer_req;
+  producer_rsp_t producer_rsp;
+  bool producer_ready[NUM_PRODUCER_PORTS];
+  consumer_req_t consumer_req;
+  consumer_rsp_t consumer_rsp;
+  bool consumer_ready[NUM_CONSUMER_PORTS];
+  bool swapped;
+
+  std::deque<unsigned> produce[NUM_PRODUCER_PORTS];
+  std::deque<unsigned> consume[NUM_CONSUMER_PORTS];
+  std::deque<unsigned> pending[NUM_BANKS][NUM_CONSUMER_PORTS];
+  unsigned outstanding = 0;
+  unsigned checked = 0;
+  unsigned tile = 0;
+  unsigned cycles = 0;
+  unsigned busy_cycles = 0;
+  int errors = 0;
+
+  producer_req.type.val = CLITYPE_T::STORE;
+  consumer_req.type.val = CLITYPE_T::LOAD;
+  tile_order<NUM_PRODUCER_PORTS>(produce);
+
+  while (tile <= NUM_TILES) {
+    // The producer fills NUM_TILES tiles; the consumer reads tiles 0 to
+    // NUM_TILES - 1 after they were swapped over
+    bool producer_done = true;
+    for (unsigned l = 0; l < NUM_PRODUCER_PORTS; l++) {
+      producer_req.valids[l] = (tile < NUM_TILES) && !produce[l].empty() && (rand() % 4 != 0);
+      if (!produce[l].empty() && tile < NUM_TILES) {
+        producer_req.addr[l] = produce[l].front();
+        producer_req.data[l] = tile_word(tile, produce[l].front());
+        producer_done = false;
+      }
+    }
+    bool consumer_done = (outstanding == 0);
+    for (unsigned l = 0; l < NUM_CONSUMER_PORTS; l++) {
+      consumer_req.valids[l] = !consume[l].empty() && (rand() % 4 != 0);
+      if (!consume[l].empty()) {
+        consumer_req.addr[l] = consume[l].front();
+        consumer_done = false;
+      }
+    }
+    busy_cycles += !producer_done || !consumer_done;
+
+    DoubleBufferedScratchpadTop(producer_req, producer_rsp, producer_ready, producer_done,
+                                consumer_req, consumer_rsp, consumer_ready, consumer_done,
+                                swapped);
+    cycles++;
+
+    for (unsigned l = 0; l < NUM_PRODUCER_PORTS; l++) {
+      if (producer_req.valids[l] && producer_ready[l]) {
+        produce[l].pop_front();
+      }
+      assert(!producer_rsp.valids[l]);
+    }
+    for (unsigned l = 0; l < NUM_CONSUMER_PORTS; l++) {
+      if (consumer_req.valids[l] && consumer_ready[l]) {
+        unsigned addr = consume[l].front();
+        consume[l].pop_front();
+        pending[addr % NUM_BANKS][l].push_back(addr);
+        outstanding++;
+      }
+    }
+    // Loads of a lane return in order per bank
+    for (unsigned l = 0; l < NUM_CONSUMER_PORTS; l++) {
+      if (consumer_rsp.valids[l]) {
+        bool matched = false;
+        for (unsigned b = 0; b < NUM_BANKS && !matched; b++) {
+          if (!pending[b][l].empty() &&
+              consumer_rsp.data[l] == tile_word(tile - 1, pending[b][l].front())) {
+            pending[b][l].pop_front();
+            matched = true;
+          }
+        }
+        if (!matched) {
+          DCOUT("ERROR: unexpected data " << consumer_rsp.data[l] << " on consumer lane " << l
+                << " in tile " << tile - 1 << endl);
+          errors++;
+        }
+        outstanding--;
+        checked++;
+      }
+    }
+
+    if (swapped) {
+      assert(producer_done && consumer_done && outstanding == 0);
+      tile++;
+      if (tile < NUM_TILES) {
+        tile_order<NUM_PRODUCER_PORTS>(produce);
+      }
+      if (tile <= NUM_TILES) {
+        tile_order<NUM_CONSUMER_PORTS>(consume);
+      }
+    }
+    assert(cycles < 100 * NUM_TILES * kTileWords);
+  }
+
+  if (checked != NUM_TILES * kTileWords) {
+    DCOUT("ERROR: checked " << checked << " loads, expected " << NUM_TILES * kTileWords << endl);
+    errors++;
+  }
+  DCOUT(NUM_TILES << " tiles in " << cycles << " cycles, " << busy_cycles
+        << " with at least one side busy" << endl);
+
+  if (errors == 0) {
+    DCOUT("CMODEL PASS" << endl);
+  } else {
+    DCOUT("CMODEL FAIL" << endl);
+  }
+  CCS_RETURN(errors != 0);
+}
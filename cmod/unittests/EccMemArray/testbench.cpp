@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <ecc_mem_array.h>
+#include <testbench/nvhls_rand.h>
+
+// Checks ecc_mem_array: clean reads, correction of every single-bit error of
+// the codeword, detection of double-bit errors, the error counters and the
+// one-cycle-late results of RegisteredDecode.
+
+#define NUM_ENTRIES 64
+
+typedef NVUINTW(64) Word;
+typedef ecc_mem_array<Word, NUM_ENTRIES, 4> EccMem;
+typedef ecc_mem_array<Word, NUM_ENTRIES, 4, true> EccMemReg;
+
+int errors = 0;
+
+void Check(bool cond, const char* what) {
+  if (!cond) {
+    DCOUT("ERROR: " << what << endl);
+    errors++;
+  }
+}
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+
+  Check(EccMem::CheckWidth == 7 && EccMem::CodeWidth == 72, "64-bit data is not a (72,64) code");
+  Check(ecc_mem_array<NVUINTW(32), 8>::CodeWidth == 39, "32-bit data is not a (39,32) code");
+  Check(ecc_mem_array<NVUINTW(8), 8>::CodeWidth == 13, "8-bit data is not a (13,8) code");
+
+  EccMem mem;
+  Word ref[NUM_ENTRIES];
+  for (int i = 0; i < NUM_ENTRIES; i++) {
+    ref[i] = nvhls::get_rand<64>();
+    mem.write(i / 4, i % 4, ref[i]);
+  }
+
+  ecc_status status;
+  for (int i = 0; i < NUM_ENTRIES; i++) {
+    Check(mem.read(i / 4, i % 4, status) == ref[i] && status == ECC_OK, "clean read");
+  }
+
+  // Every single-bit error of the codeword is corrected
+  unsigned long corrected = 0;
+  for (unsigned bit = 0; bit < EccMem::CodeWidth; bit++) {
+    int i = bit % NUM_ENTRIES;
+    mem.inject_error(i / 4, i % 4, bit);
+    Check(mem.read(i / 4, i % 4, status) == ref[i] && status == ECC_CORRECTED,
+          "single-bit error not corrected");
+    corrected++;
+    mem.inject_error(i / 4, i % 4, bit);
+  }
+  Check(mem.corrected_count == corrected, "corrected_count");
+
+  // Double-bit errors are detected
+  unsigned long detected = 0;
+  for (int n = 0; n < 500; n++) {
+    int i = rand() % NUM_ENTRIES;
+    unsigned b0 = rand() % EccMem::CodeWidth;
+    unsigned b1 = (b0 + 1 + rand() % (EccMem::CodeWidth - 1)) % EccMem::CodeWidth;
+    mem.inject_error(i / 4, i % 4, b0);
+    mem.inject_error(i / 4, i % 4, b1);
+    mem.read(i / 4, i % 4, status);
+    Check(status == ECC_UNCORRECTABLE, "double-bit error not detected");
+    detected++;
+    mem.inject_error(i / 4, i % 4, b0);
+    mem.inject_error(i / 4, i % 4, b1);
+  }
+  Check(mem.uncorrectable_count == detected, "uncorrectable_count");
+  Check(mem.corrected_count == corrected, "corrected_count changed by double-bit errors");
+  mem.clear_counters();
+  Check(mem.corrected_count == 0 && mem.uncorrectable_count == 0, "clear_counters");
+
+  // RegisteredDecode returns the previous read one call later
+  EccMemReg reg;
+  for (int i = 0; i < NUM_ENTRIES; i++) {
+    reg.write(i / 4, i % 4, ref[i]);
+  }
+  reg.read(0, 0, status);
+  for (int i = 1; i < NUM_ENTRIES; i++) {
+    if (i == 5) reg.inject_error(i / 4, i % 4, 3);
+    Word w = reg.read(i / 4, i % 4, status);
+    Check(w == ref[i - 1], "registered read is not one call late");
+    Check(status == ((i == 6) ? ECC_CORRECTED : ECC_OK), "registered read status");
+  }
+
+  if (errors != 0) {
+    DCOUT("TESTBENCH FAIL" << endl);
+  } else {
+    DCOUT("TESTBENCH PASS" << endl);
+  }
+  return errors != 0;
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_module.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Elaboration benchmark: builds num_channels Connections::Buffers, each inside
+// a match::Module tile, in chains of kChainLength tiles between one driver and
+// one checker thread. Reports the time to construct the design, to elaborate
+// it (up to the first delta cycle) and to simulate kCycles cycles, and checks
+// that every chain delivers its messages in order. The number of channels is
+// the first argument and defaults to 1000.
+
+static const unsigned int kChainLength = 8;
+static const unsigned int kCycles = 100;
+typedef NVUINT32 Msg;
+
+typedef std::chrono::steady_clock Clock;
+
+static double Seconds(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+class Tile : public match::Module {
+ public:
+  Connections::Buffer<Msg, 2> buffer;
+
+  Tile(sc_module_name name) : match::Module(name), buffer("buffer") {
+    buffer.clk(clk);
+    buffer.rst(rst);
+  }
+};
+
+SC_MODULE(testbench) {
+  sc_clock clk;
+  sc_signal<bool> rst;
+  unsigned int num_chains;
+  std::vector<Tile*> tiles;
+  std::vector<Connections::Combinational<Msg>*> chans;
+  std::vector<Connections::Out<Msg>*> srcs;
+  std::vector<Connections::In<Msg>*> sinks;
+  std::vector<unsigned int> sent, received;
+  bool passed;
+
+  SC_HAS_PROCESS(testbench);
+  testbench(sc_module_name name, unsigned int num_channels)
+      : sc_module(name),
+        clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+        rst("rst"),
+        num_chains((num_channels + kChainLength - 1) / kChainLength),
+        sent(num_chains, 0),
+        received(num_chains, 0),
+        passed(true) {
+    for (unsigned int c = 0; c < num_chains; c++) {
+      Connections::Out<Msg>* src = new Connections::Out<Msg>(sc_gen_unique_name("src"));
+      Connections::In<Msg>* sink = new Connections::In<Msg>(sc_gen_unique_name("sink"));
+      Connections::Combinational<Msg>* prev = new Connections::Combinational<Msg>();
+      (*src)(*prev);
+      chans.push_back(prev);
+      for (unsigned int i = 0; i < kChainLength; i++) {
+        Tile* tile = new Tile(sc_gen_unique_name("tile"));
+        Connections::Combinational<Msg>* next = new Connections::Combinational<Msg>();
+        tile->clk(clk);
+        tile->rst(rst);
+        tile->buffer.enq(*prev);
+        tile->buffer.deq(*next);
+        tiles.push_back(tile);
+        chans.push_back(next);
+        prev = next;
+      }
+      (*sink)(*prev);
+      srcs.push_back(src);
+      sinks.push_back(sink);
+    }
+
+    SC_THREAD(reset);
+
+    SC_THREAD(drive);
+    sensitive << clk.posedge_event();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    SC_THREAD(check);
+    sensitive << clk.posedge_event();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void reset() {
+    rst.write(false);
+    wait(2, SC_NS);
+    rst.write(true);
+  }
+
+  void drive() {
+    for (unsigned int c = 0; c < num_chains; c++)
+      srcs[c]->Reset();
+    wait();
+    while (1) {
+      for (unsigned int c = 0; c < num_chains; c++) {
+        if (srcs[c]->PushNB(sent[c]))
+          sent[c]++;
+      }
+      wait();
+    }
+  }
+
+  void check() {
+    for (unsigned int c = 0; c < num_chains; c++)
+      sinks[c]->Reset();
+    wait();
+    while (1) {
+      for (unsigned int c = 0; c < num_chains; c++) {
+        Msg msg;
+        if (sinks[c]->PopNB(msg)) {
+          if (msg != received[c]) {
+            std::cout << "FAILED: chain " << c << " delivered " << msg << " instead of "
+                      << received[c] << std::endl;
+            passed = false;
+          }
+          received[c]++;
+        }
+      }
+      wait();
+    }
+  }
+};
+
+int sc_main(int argc, char* argv[]) {
+  unsigned int num_channels = (argc > 1) ? std::atoi(argv[1]) : 1000;
+
+  Clock::time_point start = Clock::now();
+  testbench* tb = new testbench("tb", num_channels);
+  double construct_s = Seconds(start);
+
+  start = Clock::now();
+  sc_start(SC_ZERO_TIME);
+  double elaborate_s = Seconds(start);
+
+  start = Clock::now();
+  sc_start(kCycles, SC_NS);
+  double simulate_s = Seconds(start);
+
+  std::cout << tb->tiles.size() << " channels: construct " << construct_s << " s, elaborate "
+            << elaborate_s << " s, " << kCycles << " cycles " << simulate_s << " s" << std::endl;
+
+  for (unsigned int c = 0; c < tb->num_chains; c++) {
+    if (tb->received[c] == 0) {
+      std::cout << "FAILED: chain " << c << " delivered no message" << std::endl;
+      tb->passed = false;
+      break;
+    }
+  }
+  if (!tb->passed) {
+    std::cout << "Simulation FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "Simulation PASSED" << std::endl;
+  return 0;
+}
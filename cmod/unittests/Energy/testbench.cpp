@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fstream>
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_module.h>
+#include <nvhls_energy.h>
+#include <crossbar.h>
+#include <fifo.h>
+#include <mem_array.h>
+
+// Loads an energy table from a file, runs a match::Module that uses a FIFO,
+// a mem_array_sep and a crossbar and one that sends messages through a
+// Connections::Buffer, and checks the energy DumpStats() charges to each.
+
+static const unsigned int kOps = 100;
+static const unsigned int kMsgs = 50;
+static const unsigned int kLanes = 4;
+
+typedef NVUINTW(16) Lane;
+typedef NVUINTW(32) Word;
+
+class Tile : public match::Module {
+ public:
+  FIFO<Lane, 4> fifo;
+  mem_array_sep<Word, 16, 1> mem;
+  bool done;
+
+  SC_HAS_PROCESS(Tile);
+  Tile(sc_module_name name_) : match::Module(name_), done(false) {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void run() {
+    fifo.reset();
+    wait();
+    for (unsigned int i = 0; i < kOps; i++) {
+      fifo.push(i);
+      fifo.pop();
+      mem.write(i % 16, 0, i);
+      mem.read(i % 16);
+      Lane in[kLanes], out[kLanes];
+      NVUINTW(nvhls::index_width<kLanes>::val) source[kLanes];
+      for (unsigned int l = 0; l < kLanes; l++) {
+        in[l] = l;
+        source[l] = kLanes - 1 - l;
+      }
+      crossbar<Lane, kLanes, kLanes>(in, source, out);
+      wait();
+    }
+    done = true;
+    while (1) wait();
+  }
+};
+
+class Link : public match::Module {
+ public:
+  Connections::Combinational<Word> enq_chan, deq_chan;
+  Connections::Buffer<Word, 4> buffer;
+  Connections::Out<Word> src;
+  Connections::In<Word> sink;
+  bool done;
+
+  SC_HAS_PROCESS(Link);
+  Link(sc_module_name name_) : match::Module(name_), buffer("buffer"), done(false) {
+    buffer.clk(clk);
+    buffer.rst(rst);
+    src(enq_chan);
+    buffer.enq(enq_chan);
+    buffer.deq(deq_chan);
+    sink(deq_chan);
+
+    SC_THREAD(send);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    SC_THREAD(receive);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void send() {
+    src.Reset();
+    wait();
+    for (unsigned int i = 0; i < kMsgs; i++)
+      src.Push(i);
+    while (1) wait();
+  }
+
+  void receive() {
+    sink.Reset();
+    wait();
+    for (unsigned int i = 0; i < kMsgs; i++)
+      sink.Pop();
+    done = true;
+    while (1) wait();
+  }
+};
+
+SC_MODULE(testbench) {
+  Tile tile;
+  Link link;
+  sc_clock clk;
+  sc_signal<bool> rst;
+
+  SC_CTOR(testbench)
+      : tile("tile"), link("link"), clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+        rst("rst") {
+    tile.clk(clk);
+    tile.rst(rst);
+    link.clk(clk);
+    link.rst(rst);
+    SC_THREAD(run);
+  }
+
+  void run() {
+    rst = 0;
+    wait(2, SC_NS);
+    rst = 1;
+    while (!(tile.done && link.done))
+      wait(10, SC_NS);
+    wait(10, SC_NS);
+    sc_stop();
+  }
+};
+
+// Expected energy in fJ of stat name, from the table written below
+static int Check(const std::vector<std::pair<std::string, uint64> >& stats,
+                 const std::string& name, uint64 expected) {
+  for (unsigned int i = 0; i < stats.size(); i++) {
+    if (stats[i].first == name) {
+      if (stats[i].second == expected)
+        return 0;
+      cout << name << " is " << stats[i].second << " fJ, expected " << expected << endl;
+      return 1;
+    }
+  }
+  cout << name << " missing" << endl;
+  return 1;
+}
+
+int sc_main(int argc, char *argv[]) {
+  int errors = 0;
+  {
+    std::ofstream table("energy.output.json");
+    table << "{\"fifo.push\": {\"op\": 0.5, \"bit\": 0.01},\n"
+          << " \"fifo.pop\": 0.25,\n"
+          << " \"mem_array_sep.read\": {\"bit\": 0.125},\n"
+          << " \"mem_array_sep.write\": {\"op\": 1, \"bit\": 0.25},\n"
+          << " \"crossbar\": {\"op\": 0.1, \"bit\": 0.005},\n"
+          << " \"channel.transfer\": {\"op\": 2, \"bit\": 0.5}}\n";
+  }
+  if (!match::Energy::Get().Load("energy.output.json")) {
+    cout << "Could not load energy.output.json" << endl;
+    errors++;
+  }
+
+  testbench tb("tb");
+  sc_start();
+  tb.tile.DumpStats(cout, 0, NULL);
+  tb.link.DumpStats(cout, 0, NULL);
+  match::Energy::Get().Report(cout);
+
+  std::vector<std::pair<std::string, uint64> > stats;
+  tb.tile.CollectStats(stats);
+  tb.link.CollectStats(stats);
+  uint64 push = kOps * (500 + 10 * 16), pop = kOps * 250;
+  uint64 read = kOps * 125 * 32, write = kOps * (1000 + 250 * 32);
+  uint64 xbar = kOps * kLanes * (100 + 5 * 16);
+  errors += Check(stats, "tb.tile.energy_fJ.fifo.push", push);
+  errors += Check(stats, "tb.tile.energy_fJ.fifo.pop", pop);
+  errors += Check(stats, "tb.tile.energy_fJ.mem_array_sep.read", read);
+  errors += Check(stats, "tb.tile.energy_fJ.mem_array_sep.write", write);
+  errors += Check(stats, "tb.tile.energy_fJ.crossbar", xbar);
+  errors += Check(stats, "tb.tile.energy_fJ", push + pop + read + write + xbar);
+  errors += Check(stats, "tb.link.energy_fJ.channel.transfer", kMsgs * (2000 + 500 * 32));
+
+  if (errors == 0)
+    cout << "Simulation PASSED" << endl;
+  else
+    cout << "Simulation FAILED" << endl;
+  return errors;
+}
@@ -34,6 +34,26 @@ void FifoTop( const OpType& op, const DataType& data, const BankIdx& idx, OutTyp
         case reset:     fifo.reset(); break;
         case get_head:  out = fifo.get_head(idx); break;
         case get_tail:  out = fifo.get_tail(idx); break;
+        // The low bits of data select the banks, limited to the ones that
+        // can take the operation; bank i pushes data + i
+        case push_all: {
+            DataType wr_data[NUM_BANKS];
+            for (unsigned i = 0; i < NUM_BANKS; i++) wr_data[i] = data + i;
+            Fifo_::BankMask mask = Fifo_::BankMask(data) & Fifo_::BankMask(~fifo.FullMask());
+            fifo.push_all(wr_data, mask);
+            out = mask;
+            break;
+        }
+        case pop_all: {
+            DataType rd_data[NUM_BANKS];
+            Fifo_::BankMask mask = Fifo_::BankMask(data) & Fifo_::BankMask(~fifo.EmptyMask());
+            fifo.pop_all(rd_data, mask);
+            if (mask[idx] == 1) out = rd_data[idx];
+            break;
+        }
+        // The watermark is data modulo FIFO_LENGTH + 1
+        case almostFull:  out = fifo.almostFull(data.to_uint64() % (FIFO_LENGTH + 1), idx); break;
+        case almostEmpty: out = fifo.almostEmpty(data.to_uint64() % (FIFO_LENGTH + 1), idx); break;
         default:
             NVHLS_ASSERT_MSG(0, "op not supported");
             fifo.reset(); break;
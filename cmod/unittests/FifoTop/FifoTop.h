@@ -46,6 +46,10 @@ enum FifoOp {
     reset,
     get_head,
     get_tail,
+    push_all,
+    pop_all,
+    almostFull,
+    almostEmpty,
     MAXOP
 };
 
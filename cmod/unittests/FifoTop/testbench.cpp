@@ -113,6 +113,40 @@ CCS_MAIN(int argc, char *argv[]) {
                             assert(out == (ref_tail[idx]%(FIFO_LENGTH)));
                             break;
 
+            case push_all:
+                            for (int j=0; j< NUM_BANKS; ++j)
+                            {
+                                bool sel = ((data.to_uint64() >> j) & 1) && ref_q[j].size() < FIFO_LENGTH;
+                                assert(((out.to_uint64() >> j) & 1) == sel);
+                                if (sel) {
+                                    ref_q[j].push_back(data + j);
+                                    ++ref_tail[j];
+                                }
+                            }
+                            break;
+
+            case pop_all:
+                            for (int j=0; j< NUM_BANKS; ++j)
+                            {
+                                bool sel = ((data.to_uint64() >> j) & 1) && !ref_q[j].empty();
+                                if (sel) {
+                                    if (j == idx) assert(out == ref_q[j].front());
+                                    ref_q[j].pop_front();
+                                    ++ref_head[j];
+                                } else if (j == idx) {
+                                    assert(out == 0);
+                                }
+                            }
+                            break;
+
+            case almostFull:
+                            assert(out == (FIFO_LENGTH - ref_q[idx].size() <= data.to_uint64() % (FIFO_LENGTH + 1)));
+                            break;
+
+            case almostEmpty:
+                            assert(out == (ref_q[idx].size() <= data.to_uint64() % (FIFO_LENGTH + 1)));
+                            break;
+
             default:
             assert(0);
         }
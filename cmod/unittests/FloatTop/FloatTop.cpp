@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_float.h>
+#include <hls_globals.h>
+#include "FloatTop.h"
+
+void FloatTop(const bool& in_valid, const Data& a, const Data& b, const Data& c,
+              bool& add_valid, Data& sum, bool& mul_valid, Data& prod,
+              bool& fma_valid, Data& fma_out) {
+  static Adder adder;
+  static Multiplier multiplier;
+  static Fma fma;
+  add_valid = adder.run(in_valid, a, b, sum);
+  mul_valid = multiplier.run(in_valid, a, b, prod);
+  fma_valid = fma.run(in_valid, a, b, c, fma_out);
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef FLOAT_TOP_H
+#define FLOAT_TOP_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_float.h>
+#include <hls_globals.h>
+
+// Format of the design, bf16 by default
+#ifndef EXP_BITS
+#define EXP_BITS 8
+#endif
+
+#ifndef MANT_BITS
+#define MANT_BITS 7
+#endif
+
+#ifndef STEPS_PER_STAGE
+#define STEPS_PER_STAGE 1
+#endif
+
+typedef nvhls::float_format<EXP_BITS, MANT_BITS> Format;
+typedef Format::bits_t Data;
+
+typedef nvhls::PipelinedFpAdd<Format, STEPS_PER_STAGE> Adder;
+typedef nvhls::PipelinedFpMul<Format, STEPS_PER_STAGE> Multiplier;
+typedef nvhls::PipelinedFpFma<Format, STEPS_PER_STAGE> Fma;
+
+void FloatTop(const bool& in_valid, const Data& a, const Data& b, const Data& c,
+              bool& add_valid, Data& sum, bool& mul_valid, Data& prod,
+              bool& fma_valid, Data& fma_out);
+
+#endif
@@ -0,0 +1,379 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <algorithm>
+#include <deque>
+#include <match_scverify.h>
+#include <testbench/nvhls_rand.h>
+
+#include "FloatTop.h"
+
+#ifndef NUM_ITERS
+#define NUM_ITERS 20000
+#endif
+
+// Reference model: exact results on 128-bit host integers, rounded to
+// nearest even by ref_round. Formats up to fp32.
+typedef __int128 wide_t;
+
+struct ref_val {
+  bool sign, nan, inf;
+  wide_t mag;  // value is mag * 2^exp
+  int exp;
+};
+
+template <typename Fmt>
+ref_val ref_decode(unsigned long long code) {
+  static const unsigned int E = Fmt::exp_width;
+  static const unsigned int M = Fmt::mant_width;
+  ref_val v;
+  unsigned long long e = (code >> M) & ((1ULL << E) - 1);
+  unsigned long long f = code & ((1ULL << M) - 1);
+  v.sign = (code >> (E + M)) & 1;
+  v.nan = (e == Fmt::exp_max) && (f != 0);
+  v.inf = (e == Fmt::exp_max) && (f == 0);
+  v.mag = (e == 0) ? f : (f | (1ULL << M));
+  v.exp = ((e == 0) ? 1 : static_cast<int>(e)) - Fmt::bias - static_cast<int>(M);
+  return v;
+}
+
+static int msb(wide_t x) {
+  int n = 0;
+  while ((x >> 1) != 0) {
+    x >>= 1;
+    n++;
+  }
+  return n;
+}
+
+template <typename Fmt>
+unsigned long long ref_nan() {
+  return (static_cast<unsigned long long>(Fmt::exp_max) << Fmt::mant_width) | (1ULL << (Fmt::mant_width - 1));
+}
+
+template <typename Fmt>
+unsigned long long ref_round(bool sign, wide_t mag, int exp) {
+  static const int M = Fmt::mant_width;
+  unsigned long long s = static_cast<unsigned long long>(sign) << (Fmt::exp_width + M);
+  if (mag == 0) return s;
+  int top = msb(mag) + exp;
+  int q = (top < 1 - Fmt::bias) ? (1 - Fmt::bias - M) : (top - M);
+  int shift = q - exp;
+  wide_t m;
+  if (shift > msb(mag) + 1) {
+    m = 0;
+  } else if (shift > 0) {
+    m = mag >> shift;
+    wide_t rem = mag - (m << shift);
+    wide_t half = wide_t(1) << (shift - 1);
+    if ((rem > half) || ((rem == half) && (m & 1))) m++;
+  } else {
+    m = mag << -shift;
+  }
+  if (m == (wide_t(1) << (M + 1))) {
+    m >>= 1;
+    q++;
+  }
+  if (m < (wide_t(1) << M)) return s | static_cast<unsigned long long>(m);
+  int e = q + M + Fmt::bias;
+  if (e >= static_cast<int>(Fmt::exp_max)) return s | (static_cast<unsigned long long>(Fmt::exp_max) << M);
+  return s | (static_cast<unsigned long long>(e) << M) |
+         static_cast<unsigned long long>(m - (wide_t(1) << M));
+}
+
+// Exact sum of two values; an operand far below the other is replaced by a
+// tiny one of the same sign, which rounds the same
+template <typename Fmt>
+unsigned long long ref_sum(bool sa, wide_t ma, int ea, bool sb, wide_t mb, int eb, bool zero_sign) {
+  if (ma == 0 && mb == 0) return ref_round<Fmt>(zero_sign, 0, 0);
+  if (ma != 0 && mb != 0) {
+    // Below both the LSB of the larger operand and the rounding position
+    int floor_a = std::min(ea, ea + msb(ma) - static_cast<int>(Fmt::mant_width) - 3) - 2;
+    int floor_b = std::min(eb, eb + msb(mb) - static_cast<int>(Fmt::mant_width) - 3) - 2;
+    if (eb + msb(mb) < floor_a) { mb = 1; eb = floor_a; }
+    if (ea + msb(ma) < floor_b) { ma = 1; ea = floor_b; }
+  }
+  if (ma == 0) { ea = eb; }
+  if (mb == 0) { eb = ea; }
+  int e = (ea < eb) ? ea : eb;
+  wide_t a = (sa ? -ma : ma) << (ea - e);
+  wide_t b = (sb ? -mb : mb) << (eb - e);
+  wide_t r = a + b;
+  if (r == 0) return ref_round<Fmt>(false, 0, 0);
+  return ref_round<Fmt>(r < 0, (r < 0) ? -r : r, e);
+}
+
+template <typename Fmt>
+unsigned long long ref_add(unsigned long long x, unsigned long long y) {
+  ref_val a = ref_decode<Fmt>(x), b = ref_decode<Fmt>(y);
+  if (a.nan || b.nan || (a.inf && b.inf && a.sign != b.sign)) return ref_nan<Fmt>();
+  if (a.inf || b.inf) return ref_round<Fmt>(a.inf ? a.sign : b.sign, wide_t(1), 1 << 20);
+  return ref_sum<Fmt>(a.sign, a.mag, a.exp, b.sign, b.mag, b.exp, a.sign && b.sign);
+}
+
+template <typename Fmt>
+unsigned long long ref_mul(unsigned long long x, unsigned long long y) {
+  ref_val a = ref_decode<Fmt>(x), b = ref_decode<Fmt>(y);
+  bool sign = a.sign != b.sign;
+  if (a.nan || b.nan || (a.inf && b.mag == 0) || (b.inf && a.mag == 0)) return ref_nan<Fmt>();
+  if (a.inf || b.inf) return ref_round<Fmt>(sign, wide_t(1), 1 << 20);
+  return ref_round<Fmt>(sign, a.mag * b.mag, a.exp + b.exp);
+}
+
+template <typename Fmt>
+unsigned long long ref_fma(unsigned long long x, unsigned long long y, unsigned long long z) {
+  ref_val a = ref_decode<Fmt>(x), b = ref_decode<Fmt>(y), c = ref_decode<Fmt>(z);
+  bool sign = a.sign != b.sign;
+  bool prod_inf = a.inf || b.inf;
+  if (a.nan || b.nan || c.nan || (a.inf && b.mag == 0) || (b.inf && a.mag == 0) ||
+      (prod_inf && c.inf && sign != c.sign))
+    return ref_nan<Fmt>();
+  if (prod_inf || c.inf) return ref_round<Fmt>(prod_inf ? sign : c.sign, wide_t(1), 1 << 20);
+  return ref_sum<Fmt>(sign, a.mag * b.mag, a.exp + b.exp, c.sign, c.mag, c.exp, sign && c.sign);
+}
+
+// The hardware steps, without the native float model of C++ simulation
+template <typename Fmt>
+typename Fmt::bits_t steps_add(typename Fmt::bits_t a, typename Fmt::bits_t b) {
+  nvhls::fp_sum_state<Fmt, Fmt::mant_width + 1> s = nvhls::fp_add_init<Fmt, false>(a, b);
+  if (!s.special) {
+    nvhls::fp_sum(s);
+    nvhls::fp_round(s);
+  }
+  return s.result;
+}
+
+template <typename Fmt>
+typename Fmt::bits_t steps_mul(typename Fmt::bits_t a, typename Fmt::bits_t b) {
+  nvhls::fp_sum_state<Fmt, 2 * Fmt::mant_width + 2> s = nvhls::fp_mul_init<Fmt, false>(a, b);
+  if (!s.special) {
+    nvhls::fp_mul_normalize(s);
+    nvhls::fp_round(s);
+  }
+  return s.result;
+}
+
+// Random operand: special and boundary values now and then, otherwise
+// random bits, or near to other so that additions cancel
+template <typename Fmt>
+unsigned long long rand_code(unsigned long long other) {
+  static const unsigned int W = Fmt::width;
+  static const unsigned int M = Fmt::mant_width;
+  unsigned long long mask = (W >= 64) ? ~0ULL : ((1ULL << W) - 1);
+  unsigned long long r = nvhls::get_rand<64>().to_uint64();
+  switch (rand() % 16) {
+    case 0: return 0;                                                    // +0
+    case 1: return 1ULL << (W - 1);                                      // -0
+    case 2: return static_cast<unsigned long long>(Fmt::exp_max) << M;   // inf
+    case 3: return r & ((1ULL << M) - 1);                                // subnormal
+    case 4: return ((static_cast<unsigned long long>(Fmt::exp_max) << M) - 1) ^ (r & 1ULL << (W - 1)); // max
+    case 5: return static_cast<unsigned long long>(Fmt::bias) << M;      // 1.0
+    case 6: case 7: case 8: return (other ^ (1ULL << (W - 1)) ^ (r & ((1ULL << (M / 2 + 1)) - 1))) & mask;
+    default: return r & mask;
+  }
+}
+
+template <typename Fmt>
+bool check_result(const char* op, unsigned long long got, unsigned long long ref,
+                  unsigned long long a, unsigned long long b, unsigned long long c) {
+  if (got == ref) return true;
+  std::cout << std::hex << "ERROR: E" << std::dec << Fmt::exp_width << "M" << Fmt::mant_width
+            << std::hex << " " << op << "(" << a << ", " << b << ", " << c << ") = " << got
+            << " expected " << ref << std::dec << std::endl;
+  return false;
+}
+
+// Checks the steps and the C++ simulation model of add, mul and fma against
+// the reference for random operands, and fma against add and mul
+template <typename Fmt>
+bool check_format() {
+  typedef typename Fmt::bits_t T;
+  bool ok = true;
+  T one = static_cast<unsigned long long>(Fmt::bias) << Fmt::mant_width;
+  for (int i = 0; i < NUM_ITERS && ok; i++) {
+    unsigned long long a = rand_code<Fmt>(0);
+    unsigned long long b = rand_code<Fmt>(a);
+    unsigned long long c = rand_code<Fmt>(a);
+    T ta = a, tb = b, tc = c;
+    unsigned long long add = ref_add<Fmt>(a, b), mul = ref_mul<Fmt>(a, b), fma = ref_fma<Fmt>(a, b, c);
+    ok = check_result<Fmt>("steps_add", steps_add<Fmt>(ta, tb).to_uint64(), add, a, b, 0) && ok;
+    ok = check_result<Fmt>("fp_add", nvhls::fp_add<Fmt>(ta, tb).to_uint64(), add, a, b, 0) && ok;
+    ok = check_result<Fmt>("steps_mul", steps_mul<Fmt>(ta, tb).to_uint64(), mul, a, b, 0) && ok;
+    ok = check_result<Fmt>("fp_mul", nvhls::fp_mul<Fmt>(ta, tb).to_uint64(), mul, a, b, 0) && ok;
+    ok = check_result<Fmt>("fp_fma", nvhls::fp_fma<Fmt>(ta, tb, tc).to_uint64(), fma, a, b, c) && ok;
+    ok = check_result<Fmt>("fp_fma(a, 1, c)", nvhls::fp_fma<Fmt>(ta, one, tc).to_uint64(),
+                           ref_add<Fmt>(a, c), a, one.to_uint64(), c) && ok;
+  }
+  return ok;
+}
+
+// All pairs of an 8-bit format
+template <typename Fmt>
+bool check_exhaustive() {
+  typedef typename Fmt::bits_t T;
+  bool ok = true;
+  for (unsigned int a = 0; a < 256 && ok; a++) {
+    for (unsigned int b = 0; b < 256; b++) {
+      T ta = a, tb = b;
+      ok = check_result<Fmt>("fp_add", nvhls::fp_add<Fmt>(ta, tb).to_uint64(), ref_add<Fmt>(a, b), a, b, 0) && ok;
+      ok = check_result<Fmt>("steps_mul", steps_mul<Fmt>(ta, tb).to_uint64(), ref_mul<Fmt>(a, b), a, b, 0) && ok;
+    }
+  }
+  return ok;
+}
+
+// Checks that the pipelined units match the combinational ones after their
+// latency of cycles
+template <typename Fmt, unsigned int StepsPerStage>
+bool check_pipelined() {
+  typedef typename Fmt::bits_t T;
+  typedef nvhls::PipelinedFpAdd<Fmt, StepsPerStage> Add;
+  typedef nvhls::PipelinedFpMul<Fmt, StepsPerStage> Mul;
+  typedef nvhls::PipelinedFpFma<Fmt, StepsPerStage> FmaUnit;
+  Add add;
+  Mul mul;
+  FmaUnit fma;
+  std::deque<T> add_exp, mul_exp, fma_exp;
+  std::deque<bool> add_v, mul_v, fma_v;
+  for (unsigned int i = 0; i < Add::Latency; i++) add_v.push_back(false);
+  for (unsigned int i = 0; i < Mul::Latency; i++) mul_v.push_back(false);
+  for (unsigned int i = 0; i < FmaUnit::Latency; i++) fma_v.push_back(false);
+  bool ok = true;
+  for (int i = 0; i < NUM_ITERS / 10; i++) {
+    bool valid = (rand() % 4 != 0);
+    unsigned long long ca = rand_code<Fmt>(0);
+    T a = ca, b = rand_code<Fmt>(ca), c = rand_code<Fmt>(ca);
+    T add_out, mul_out, fma_out;
+    bool add_valid = add.run(valid, a, b, add_out);
+    bool mul_valid = mul.run(valid, a, b, mul_out);
+    bool fma_valid = fma.run(valid, a, b, c, fma_out);
+    add_v.push_back(valid);
+    mul_v.push_back(valid);
+    fma_v.push_back(valid);
+    if (valid) {
+      add_exp.push_back(nvhls::fp_add<Fmt>(a, b));
+      mul_exp.push_back(nvhls::fp_mul<Fmt>(a, b));
+      fma_exp.push_back(nvhls::fp_fma<Fmt>(a, b, c));
+    }
+    if ((add_valid != add_v.front()) || (mul_valid != mul_v.front()) || (fma_valid != fma_v.front())) {
+      std::cout << "ERROR: pipelined valid mismatch at cycle " << i << std::endl;
+      ok = false;
+    }
+    if (add_valid && add_v.front()) {
+      ok = (add_out == add_exp.front()) && ok;
+      add_exp.pop_front();
+    }
+    if (mul_valid && mul_v.front()) {
+      ok = (mul_out == mul_exp.front()) && ok;
+      mul_exp.pop_front();
+    }
+    if (fma_valid && fma_v.front()) {
+      ok = (fma_out == fma_exp.front()) && ok;
+      fma_exp.pop_front();
+    }
+    add_v.pop_front();
+    mul_v.pop_front();
+    fma_v.pop_front();
+  }
+  if (!ok) std::cout << "ERROR: pipelined units differ from fp_add, fp_mul or fp_fma" << std::endl;
+  return ok;
+}
+
+// Checks the vector forms element by element
+template <typename Fmt>
+bool check_vector() {
+  typedef typename Fmt::bits_t T;
+  static const unsigned int N = 8;
+  nvhls::nv_scvector<T, N> x, y, z, sum, prod, fma;
+  for (unsigned int i = 0; i < N; i++) {
+    x[i] = rand_code<Fmt>(0);
+    y[i] = rand_code<Fmt>(x[i].to_uint64());
+    z[i] = rand_code<Fmt>(0);
+  }
+  nvhls::vector_fp_add<Fmt, N>(x, y, sum);
+  nvhls::vector_fp_mul<Fmt, N>(x, y, prod);
+  nvhls::vector_fp_fma<Fmt, N>(x, y, z, fma);
+  bool ok = true;
+  for (unsigned int i = 0; i < N; i++) {
+    if ((sum[i] != nvhls::fp_add<Fmt>(x[i], y[i])) || (prod[i] != nvhls::fp_mul<Fmt>(x[i], y[i])) ||
+        (fma[i] != nvhls::fp_fma<Fmt>(x[i], y[i], z[i]))) {
+      std::cout << "ERROR: vector element " << i << " differs" << std::endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+CCS_MAIN(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  bool ok = true;
+
+  ok = check_exhaustive<nvhls::fp8_e4m3_format>() && ok;
+  ok = check_exhaustive<nvhls::fp8_e5m2_format>() && ok;
+  ok = check_format<nvhls::fp8_e4m3_format>() && ok;
+  ok = check_format<nvhls::fp8_e5m2_format>() && ok;
+  ok = check_format<nvhls::fp16_format>() && ok;
+  ok = check_format<nvhls::bf16_format>() && ok;
+  ok = check_format<nvhls::fp32_format>() && ok;
+  // Not native: C++ simulation runs the steps
+  ok = check_format<nvhls::float_format<6, 12> >() && ok;
+  ok = check_format<Format>() && ok;
+  ok = check_pipelined<Format, 1>() && ok;
+  ok = check_pipelined<Format, 2>() && ok;
+  ok = check_pipelined<Format, 3>() && ok;
+  ok = check_pipelined<Format, 4>() && ok;
+  ok = check_vector<Format>() && ok;
+
+  // Drive the design: each result must come out Latency cycles after its
+  // operands, equal to the reference model
+  std::deque<unsigned long long> add_exp, mul_exp, fma_exp;
+  int drain = Fma::Latency;
+  for (int i = 0; i < NUM_ITERS / 10; i++) {
+    bool in_valid = (i < NUM_ITERS / 10 - drain);
+    unsigned long long a = rand_code<Format>(0), b = rand_code<Format>(a), c = rand_code<Format>(a);
+    bool add_valid, mul_valid, fma_valid;
+    Data sum, prod, fma_out;
+    CCS_DESIGN(FloatTop)(in_valid, a, b, c, add_valid, sum, mul_valid, prod, fma_valid, fma_out);
+    if (in_valid) {
+      add_exp.push_back(ref_add<Format>(a, b));
+      mul_exp.push_back(ref_mul<Format>(a, b));
+      fma_exp.push_back(ref_fma<Format>(a, b, c));
+    }
+    if (add_valid) {
+      ok = !add_exp.empty() && check_result<Format>("FloatTop add", sum.to_uint64(), add_exp.front(), 0, 0, 0) && ok;
+      if (!add_exp.empty()) add_exp.pop_front();
+    }
+    if (mul_valid) {
+      ok = !mul_exp.empty() && check_result<Format>("FloatTop mul", prod.to_uint64(), mul_exp.front(), 0, 0, 0) && ok;
+      if (!mul_exp.empty()) mul_exp.pop_front();
+    }
+    if (fma_valid) {
+      ok = !fma_exp.empty() && check_result<Format>("FloatTop fma", fma_out.to_uint64(), fma_exp.front(), 0, 0, 0) && ok;
+      if (!fma_exp.empty()) fma_exp.pop_front();
+    }
+  }
+  if (!add_exp.empty() || !mul_exp.empty() || !fma_exp.empty()) {
+    std::cout << "ERROR: outputs missing" << std::endl;
+    ok = false;
+  }
+
+  if (ok) {
+    std::cout << "PASS" << std::endl;
+  } else {
+    std::cout << "FAIL" << std::endl;
+  }
+  CCS_RETURN(0);
+}
@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <hls_globals.h>
+#include "HashTableTop.h"
+
+void HashTableTop(bool& req_valid, const req_t& req, bool& rsp_valid, rsp_t& rsp) {
+  static hash_table_t hash_table;
+  if (hash_table.run(req_valid, req, rsp_valid, rsp)) {
+    req_valid = false;
+  }
+}
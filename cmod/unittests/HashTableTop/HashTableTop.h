@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HASH_TABLE_TOP_H
+#define HASH_TABLE_TOP_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <hls_globals.h>
+#include <HashTable.h>
+
+#ifndef BUCKETS
+#define BUCKETS 64
+#endif
+
+#ifndef WAYS
+#define WAYS 4
+#endif
+
+#ifndef HASH
+#define HASH HashTableH3
+#endif
+
+typedef NVUINT32 Key;
+typedef NVUINT16 Value;
+typedef HashTable<Key, Value, BUCKETS, WAYS, HASH> hash_table_t;
+typedef hash_table_t::req_t req_t;
+typedef hash_table_t::rsp_t rsp_t;
+
+void HashTableTop(bool& req_valid, const req_t& req, bool& rsp_valid, rsp_t& rsp);
+
+
+#endif
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "HashTableTop.h"
+#include <match_scverify.h>
+#include <testbench/nvhls_rand.h>
+
+#include <iostream>
+#include <map>
+#include <set>
+
+#ifndef NUM_ITERS
+#define NUM_ITERS 20000
+#endif
+
+// Random lookups, inserts and removes of keys from a space a little larger
+// than the configured HashTableTop, checked against a std::map. Lookups and
+// removes must be taken in the cycle they are offered. Each configuration of
+// a few sizes, ways and hash functions is then filled with distinct random
+// keys until its first full response, which must come at a load factor that
+// cuckoo hashing with that many ways reaches, and all keys must still be
+// found.
+
+static bool step_dut(req_t req, rsp_t& rsp) {
+  bool req_valid = true, rsp_valid = false;
+  CCS_DESIGN(HashTableTop)(req_valid, req, rsp_valid, rsp);
+  assert(rsp_valid == !req_valid);
+  return rsp_valid;
+}
+
+void check_traffic() {
+  std::map<unsigned int, unsigned int> ref;
+  const unsigned int key_space = BUCKETS * WAYS * 3 / 2;
+  req_t req;
+  rsp_t rsp;
+  unsigned int offered = 0, cycles = 0, full = 0;
+
+  // Requests wait until the buckets are cleared
+  req.op = HashTableLookup;
+  req.key = 0;
+  req.value = 0;
+  while (!step_dut(req, rsp)) cycles++;
+  assert(cycles == BUCKETS);
+  assert(rsp.hit == 0);
+
+  for (unsigned int i = 0; i < NUM_ITERS; i++) {
+    unsigned int r = rand() % 8;
+    req.op = (r < 3) ? HashTableLookup : (r < 7) ? HashTableInsert : HashTableRemove;
+    // Spread the keys over the whole key width
+    unsigned int k = (rand() % key_space) * 2654435761u;
+    req.key = k;
+    req.value = rand() & 0xffff;
+    offered++;
+    while (!step_dut(req, rsp)) {
+      assert(req.op == HashTableInsert);
+      cycles++;
+    }
+    cycles++;
+
+    bool present = ref.count(k) > 0;
+    assert(rsp.op == req.op);
+    if (req.op == HashTableLookup) {
+      assert(rsp.hit == present);
+      if (present) assert(rsp.value == ref[k]);
+    } else if (req.op == HashTableInsert) {
+      assert(rsp.hit == present);
+      if (rsp.full == 1) {
+        assert(!present);
+        full++;
+      } else {
+        ref[k] = req.value.to_uint();
+      }
+    } else {
+      assert(rsp.hit == present);
+      ref.erase(k);
+    }
+  }
+  std::cout << "HashTableTop: " << offered << " requests in " << cycles << " cycles, "
+            << full << " inserts full, " << ref.size() << " keys stored" << std::endl;
+}
+
+template <unsigned int Buckets, unsigned int Ways, hash_table_hash Hash>
+void check_fill(double min_load) {
+  typedef HashTable<Key, Value, Buckets, Ways, Hash> table_t;
+  table_t* table = new table_t;
+  typename table_t::req_t req;
+  typename table_t::rsp_t rsp;
+  bool rsp_valid;
+  while (!table->isReady()) table->run(false, req, rsp_valid, rsp);
+
+  std::set<unsigned int> keys;
+  req.op = HashTableInsert;
+  while (true) {
+    unsigned int k = (static_cast<unsigned int>(rand()) << 16) ^ rand();
+    if (keys.count(k)) continue;
+    req.key = k;
+    req.value = k & 0xffff;
+    while (!table->run(true, req, rsp_valid, rsp)) {}
+    assert(rsp_valid && rsp.hit == 0);
+    if (rsp.full == 1) break;
+    keys.insert(k);
+  }
+  double load = table->LoadFactor();
+  assert(table->Occupancy() == keys.size());
+  std::cout << Buckets << " buckets x " << Ways << " ways, "
+            << ((Hash == HashTableH3) ? "H3" : "XOR-fold") << ": full at load factor " << load
+            << ", probe depth " << table->ProbeDepth() << ", max " << table->MaxProbeDepth()
+            << std::endl;
+  assert(load >= min_load);
+
+  req.op = HashTableLookup;
+  for (std::set<unsigned int>::iterator it = keys.begin(); it != keys.end(); ++it) {
+    req.key = *it;
+    assert(table->run(true, req, rsp_valid, rsp));
+    assert(rsp.hit == 1 && rsp.value == (*it & 0xffff));
+  }
+
+  // A remove makes room again
+  req.op = HashTableRemove;
+  req.key = *keys.begin();
+  assert(table->run(true, req, rsp_valid, rsp) && rsp.hit == 1);
+  keys.erase(keys.begin());
+  if (Buckets * Ways >= 4096) table->DumpStats(std::cout);
+  delete table;
+}
+
+CCS_MAIN(int argc, char *argv[])
+{
+  nvhls::set_random_seed();
+
+  check_traffic();
+  check_fill<256, 2, HashTableH3>(0.3);
+  check_fill<256, 2, HashTableXorFold>(0.3);
+  check_fill<256, 4, HashTableH3>(0.8);
+  check_fill<256, 4, HashTableXorFold>(0.8);
+  check_fill<4096, 4, HashTableH3>(0.8);
+  check_fill<1024, 8, HashTableH3>(0.9);
+
+  DCOUT("CMODEL PASS" << endl);
+  CCS_RETURN(0) ;
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LINE_BUFFER_TOP_H
+#define LINE_BUFFER_TOP_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <hls_globals.h>
+#include <LineBuffer.h>
+
+#ifndef WIDTH
+#define WIDTH 16
+#endif
+
+#ifndef WINDOW
+#define WINDOW 3
+#endif
+
+#ifndef PADDING
+#define PADDING LineBufferZero
+#endif
+
+typedef NVUINT8 Pixel;
+typedef LineBufferCore<Pixel, WIDTH, WINDOW, PADDING> line_buffer_t;
+typedef line_buffer_t::pixel_t pixel_t;
+typedef line_buffer_t::window_t window_t;
+
+void LineBufferTop(bool& in_valid, const pixel_t& in, bool& out_valid, window_t& out);
+
+
+#endif
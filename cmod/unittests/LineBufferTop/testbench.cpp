@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LineBufferTop.h"
+#include <match_scverify.h>
+#include <testbench/nvhls_rand.h>
+
+#include <deque>
+#include <vector>
+
+#ifndef NUM_FRAMES
+#define NUM_FRAMES 6
+#endif
+
+// Streams NUM_FRAMES frames of K to 3 * K rows back to back through a line
+// buffer and checks every window against the frame, for the configured
+// LineBufferTop and for every padding mode of a few window sizes. Each
+// configuration runs once with random input gaps and output stalls and once
+// at full rate, where the line buffer must take a pixel every cycle and
+// only add the K / 2 * (Width + 1) flush steps after the last frame.
+
+struct Frame {
+  unsigned height;
+  std::vector<unsigned> pixels;
+};
+
+template <unsigned W, unsigned K, line_buffer_padding Padding>
+struct Reference {
+  static const unsigned Lag = LineBufferCore<Pixel, W, K, Padding>::Lag;
+
+  static unsigned pixel(const Frame& f, int r, int c) {
+    if (Padding == LineBufferReplicate) {
+      r = (r < 0) ? 0 : ((r >= static_cast<int>(f.height)) ? f.height - 1 : r);
+      c = (c < 0) ? 0 : ((c >= static_cast<int>(W)) ? W - 1 : c);
+    }
+    if (r < 0 || c < 0 || r >= static_cast<int>(f.height) || c >= static_cast<int>(W)) {
+      return 0;
+    }
+    return f.pixels[r * W + c];
+  }
+
+  // Windows of a frame in output order, window_t::data flattened
+  static void windows(const Frame& f, std::deque<std::vector<unsigned> >& out) {
+    unsigned rows = (Padding == LineBufferValid) ? f.height - K + 1 : f.height;
+    unsigned cols = (Padding == LineBufferValid) ? W - K + 1 : W;
+    int offset = (Padding == LineBufferValid) ? 0 : -static_cast<int>(Lag);
+    for (unsigned r = 0; r < rows; r++) {
+      for (unsigned c = 0; c < cols; c++) {
+        std::vector<unsigned> w;
+        for (unsigned i = 0; i < K; i++) {
+          for (unsigned j = 0; j < K; j++) {
+            w.push_back(pixel(f, r + offset + i, c + offset + j));
+          }
+        }
+        w.push_back((r == rows - 1) && (c == cols - 1));
+        out.push_back(w);
+      }
+    }
+  }
+};
+
+template <unsigned W, unsigned K, line_buffer_padding Padding>
+struct CoreStep {
+  LineBufferCore<Pixel, W, K, Padding> core;
+  void operator()(bool& in_valid, const line_buffer_pixel_t<Pixel>& in, bool& out_valid,
+                  line_buffer_window_t<Pixel, K>& out) {
+    if (core.run(in_valid, in, out_valid, out)) {
+      in_valid = false;
+    }
+  }
+};
+
+struct DutStep {
+  void operator()(bool& in_valid, const pixel_t& in, bool& out_valid, window_t& out) {
+    CCS_DESIGN(LineBufferTop)(in_valid, in, out_valid, out);
+  }
+};
+
+template <unsigned W, unsigned K, line_buffer_padding Padding, typename Step>
+int run_frames(Step& step, bool gaps) {
+  typedef Reference<W, K, Padding> ref_t;
+  std::deque<line_buffer_pixel_t<Pixel> > pixels;
+  std::deque<std::vector<unsigned> > expected;
+  for (unsigned f = 0; f < NUM_FRAMES; f++) {
+    Frame frame;
+    frame.height = K + rand() % (2 * K + 1);
+    for (unsigned p = 0; p < frame.height * W; p++) {
+      frame.pixels.push_back(rand() % 256);
+      line_buffer_pixel_t<Pixel> px;
+      px.data = frame.pixels.back();
+      px.last = (p == frame.height * W - 1);
+      pixels.push_back(px);
+    }
+    ref_t::windows(frame, expected);
+  }
+  const unsigned num_pixels = pixels.size();
+  const unsigned num_windows = expected.size();
+
+  bool in_valid = false, out_valid;
+  line_buffer_pixel_t<Pixel> in;
+  line_buffer_window_t<Pixel, K> out;
+  unsigned steps = 0, cycles = 0;
+  while (!expected.empty() && cycles < 100 * num_pixels) {
+    cycles++;
+    if (!in_valid && !pixels.empty() && (!gaps || rand() % 3 != 0)) {
+      in = pixels.front();
+      pixels.pop_front();
+      in_valid = true;
+    }
+    if (gaps && rand() % 4 == 0) {
+      continue;  // output stall
+    }
+    bool was_valid = in_valid;
+    step(in_valid, in, out_valid, out);
+    if (!gaps && was_valid && in_valid) {
+      std::cout << "ERROR: pixel not taken at full rate" << std::endl;
+      return 1;
+    }
+    steps++;
+    if (out_valid) {
+      const std::vector<unsigned>& w = expected.front();
+      for (unsigned i = 0; i < K; i++) {
+        for (unsigned j = 0; j < K; j++) {
+          if (out.data[i][j] != w[i * K + j]) {
+            std::cout << "ERROR: window " << num_windows - expected.size() << " [" << i << "]["
+                      << j << "] is " << out.data[i][j] << ", expected " << w[i * K + j]
+                      << std::endl;
+            return 1;
+          }
+        }
+      }
+      if (out.last != w[K * K]) {
+        std::cout << "ERROR: last flag of window " << num_windows - expected.size() << std::endl;
+        return 1;
+      }
+      expected.pop_front();
+    }
+  }
+  if (!expected.empty()) {
+    std::cout << "ERROR: " << expected.size() << " windows missing" << std::endl;
+    return 1;
+  }
+  unsigned flush = (Padding == LineBufferValid) ? 0 : ref_t::Lag * (W + 1);
+  if (!gaps && steps != num_pixels + flush) {
+    std::cout << "ERROR: " << steps << " steps for " << num_pixels << " pixels, expected "
+              << num_pixels + flush << std::endl;
+    return 1;
+  }
+  std::cout << "Width " << W << " K " << K << " padding " << Padding << (gaps ? " gaps" : "")
+            << ": " << num_windows << " windows from " << num_pixels << " pixels in " << cycles
+            << " cycles" << std::endl;
+  return 0;
+}
+
+template <unsigned W, unsigned K, line_buffer_padding Padding>
+int check_config() {
+  int errors = 0;
+  {
+    CoreStep<W, K, Padding> step;
+    errors += run_frames<W, K, Padding>(step, false);
+  }
+  {
+    CoreStep<W, K, Padding> step;
+    errors += run_frames<W, K, Padding>(step, true);
+  }
+  return errors;
+}
+
+CCS_MAIN(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+
+  DutStep dut;
+  int errors = run_frames<WIDTH, WINDOW, PADDING>(dut, true);
+  errors += run_frames<WIDTH, WINDOW, PADDING>(dut, false);
+
+  errors += check_config<8, 2, LineBufferValid>();
+  errors += check_config<8, 3, LineBufferValid>();
+  errors += check_config<8, 3, LineBufferZero>();
+  errors += check_config<8, 3, LineBufferReplicate>();
+  errors += check_config<9, 5, LineBufferValid>();
+  errors += check_config<9, 5, LineBufferZero>();
+  errors += check_config<9, 5, LineBufferReplicate>();
+  errors += check_config<7, 7, LineBufferReplicate>();
+
+  if (errors != 0) {
+    DCOUT("TESTBENCH FAIL" << endl);
+    CCS_RETURN(1);
+  }
+  DCOUT("CMODEL PASS" << endl);
+  CCS_RETURN(0);
+}
@@ -50,6 +50,43 @@ Count reference_lzd(const Data& in)
 }
 
 
+// Checks leading_ones_tree (the synthesis view) and leading_ones/lzd (which
+// use the host fast path in C++ simulation up to 64 bits) for width W
+template <unsigned int W>
+void check_width()
+{
+    typedef NVUINTW(W) Vec;
+    typedef NVINTW(W + 1) SignedVec;
+    enum { P2 = nvhls::next_pow2<W>::val };
+    for (int i = 0; i < NUM_ITERS; ++i)
+    {
+        Vec data = nvhls::get_rand<W>();
+        data >>= (rand() % W);
+        int ref = -1;
+        for (int b = W - 1; b >= 0; --b)
+        {
+            if (data[b] != 0) { ref = b; break; }
+        }
+
+        typename nvhls::nvhls_t<P2>::nvuint_t padded = data;
+        typename nvhls::leading_ones_tree<P2>::idx_t tree_idx;
+        bool valid = nvhls::leading_ones_tree<P2>::find(padded, 0, tree_idx);
+        assert(valid == (ref >= 0));
+        if (valid) assert(static_cast<int>(tree_idx) == ref);
+
+        unsigned int lo = nvhls::leading_ones<W, Vec, NVUINTW(nvhls::index_width<W>::val)>(data);
+        assert(static_cast<int>(lo) == ((ref >= 0) ? ref : 0));
+
+        unsigned int lz = nvhls::lzd(data);
+        assert(lz == static_cast<unsigned int>((ref >= 0) ? (W - 1 - ref) : (W - 1)));
+
+        // The same positive value as signed type with one extra bit
+        if (ref >= 0) {
+            SignedVec sdata = data;
+            assert(nvhls::lzd(sdata) == static_cast<unsigned int>(W - 1 - ref));
+        }
+    }
+}
 
 CCS_MAIN(int argc, char *argv[]) 
 {
@@ -66,6 +103,17 @@ CCS_MAIN(int argc, char *argv[])
         assert(count == count_ref);
     }
 
+    check_width<1>();
+    check_width<3>();
+    check_width<8>();
+    check_width<13>();
+    check_width<32>();
+    check_width<63>();
+    check_width<64>();
+    check_width<65>();
+    check_width<100>();
+    check_width<128>();
+
     DCOUT("CMODEL PASS" << endl);
     CCS_RETURN(0) ;
 }
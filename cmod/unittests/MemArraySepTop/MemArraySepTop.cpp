@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <mem_array.h>
+#include <hls_globals.h>
+#include "MemArraySepTop.h"
+
+void MemArraySepTop(const bool& is_write, const local_index_t& idx, const bank_index_t& bank_sel,
+                    const word_t& write_data, const write_mask_t& write_mask, word_t& read_data) {
+  static mem_t mem;
+  if (is_write) {
+    mem.write(idx, bank_sel, write_data, write_mask);
+  } else {
+    read_data = mem.read(idx, bank_sel);
+  }
+}
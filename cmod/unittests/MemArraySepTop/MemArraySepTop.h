@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MEM_ARRAY_SEP_TOP_H
+#define MEM_ARRAY_SEP_TOP_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <mem_array.h>
+#include <hls_globals.h>
+
+#ifndef WORD_WIDTH
+#define WORD_WIDTH 512
+#endif
+
+#ifndef NUM_BYTE_ENABLES
+#define NUM_BYTE_ENABLES 64
+#endif
+
+#ifndef NUM_ENTRIES
+#define NUM_ENTRIES 1024
+#endif
+
+#ifndef NUM_BANKS
+#define NUM_BANKS 4
+#endif
+
+typedef NVUINTW(WORD_WIDTH) word_t;
+typedef mem_array_sep<word_t, NUM_ENTRIES, NUM_BANKS, NUM_BYTE_ENABLES> mem_t;
+typedef mem_t::LocalIndex local_index_t;
+typedef mem_t::BankIndex bank_index_t;
+typedef mem_t::WriteMask write_mask_t;
+
+void MemArraySepTop(const bool& is_write, const local_index_t& idx, const bank_index_t& bank_sel,
+                    const word_t& write_data, const write_mask_t& write_mask, word_t& read_data);
+
+#endif
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <match_scverify.h>
+#include <testbench/nvhls_rand.h>
+#include <ctime>
+#include <vector>
+
+#include "MemArraySepTop.h"
+
+#ifndef NUM_ITERS
+#define NUM_ITERS 5000
+#endif
+
+#ifndef NUM_BENCH_OPS
+#define NUM_BENCH_OPS 100000
+#endif
+
+static const unsigned kSliceWidth = WORD_WIDTH / NUM_BYTE_ENABLES;
+static const unsigned kEntriesPerBank = NUM_ENTRIES / NUM_BANKS;
+
+// Reference model: one integer per slice of every entry
+std::vector<unsigned long long> ref_mem(NUM_ENTRIES * NUM_BYTE_ENABLES, 0);
+
+unsigned long long get_ref_slice(const word_t& w, unsigned i)
+{
+    return nvhls::get_slc<kSliceWidth>(w, i * kSliceWidth).to_uint64();
+}
+
+void ref_write(unsigned idx, unsigned bank_sel, const word_t& data, const write_mask_t& mask)
+{
+    for (unsigned i = 0; i < NUM_BYTE_ENABLES; i++) {
+        if (mask[i] == 1) {
+            ref_mem[(bank_sel * kEntriesPerBank + idx) * NUM_BYTE_ENABLES + i] = get_ref_slice(data, i);
+        }
+    }
+}
+
+bool ref_check(unsigned idx, unsigned bank_sel, const word_t& data)
+{
+    for (unsigned i = 0; i < NUM_BYTE_ENABLES; i++) {
+        if (ref_mem[(bank_sel * kEntriesPerBank + idx) * NUM_BYTE_ENABLES + i] != get_ref_slice(data, i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+write_mask_t random_mask(const int& iter)
+{
+    if (iter % 3 == 0) {
+        return ~static_cast<write_mask_t>(0);
+    }
+    return nvhls::get_rand<NUM_BYTE_ENABLES>();
+}
+
+// Throughput of a mix of full writes, partial writes and reads on the
+// selected mem_array_sep store. Build with MEM_ARRAY_SIM_USE_SLICES to
+// measure the per-slice store as a baseline.
+void run_throughput_benchmark()
+{
+    static mem_t mem;
+    mem.clear();
+    const unsigned kNumPatterns = 64;
+    word_t data[kNumPatterns];
+    write_mask_t masks[kNumPatterns];
+    for (unsigned i = 0; i < kNumPatterns; i++) {
+        data[i] = nvhls::get_rand<WORD_WIDTH>();
+        masks[i] = nvhls::get_rand<NUM_BYTE_ENABLES>();
+    }
+    word_t sink = 0;
+    std::clock_t start = std::clock();
+    for (unsigned op = 0; op < NUM_BENCH_OPS; op++) {
+        unsigned idx = (op * 7) % kEntriesPerBank;
+        unsigned bank_sel = op % NUM_BANKS;
+        switch (op % 4) {
+          case 0:
+          case 1:
+            mem.write(idx, bank_sel, data[op % kNumPatterns]);
+            break;
+          case 2:
+            mem.write(idx, bank_sel, data[op % kNumPatterns], masks[op % kNumPatterns]);
+            break;
+          default:
+            sink ^= mem.read(idx, bank_sel);
+        }
+    }
+    double seconds = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+    cout << "mem_array_sep<" << WORD_WIDTH << " bits, " << NUM_BYTE_ENABLES << " byte enables> "
+#if defined(MEM_ARRAY_SIM_USE_SLICES)
+         << "slice store"
+#else
+         << "word store"
+#endif
+         << ": " << (NUM_BENCH_OPS / seconds) << " ops/s"
+         << " (checksum " << get_ref_slice(sink, 0) << ")" << endl;
+}
+
+CCS_MAIN(int argc, char *argv[]) {
+    nvhls::set_random_seed();
+    word_t read_data;
+
+    // Initialize every entry, so that reads never return X
+    for (unsigned bank_sel = 0; bank_sel < NUM_BANKS; bank_sel++) {
+        for (unsigned idx = 0; idx < kEntriesPerBank; idx++) {
+            word_t data = nvhls::get_rand<WORD_WIDTH>();
+            write_mask_t mask = ~static_cast<write_mask_t>(0);
+            CCS_DESIGN(MemArraySepTop)(true, idx, bank_sel, data, mask, read_data);
+            ref_write(idx, bank_sel, data, mask);
+        }
+    }
+
+    for (int i = 0; i < NUM_ITERS; i++) {
+        unsigned idx = rand() % kEntriesPerBank;
+        unsigned bank_sel = rand() % NUM_BANKS;
+        word_t data = nvhls::get_rand<WORD_WIDTH>();
+        write_mask_t mask = random_mask(i);
+        bool is_write = (rand() % 2) == 0;
+        CCS_DESIGN(MemArraySepTop)(is_write, idx, bank_sel, data, mask, read_data);
+        if (is_write) {
+            ref_write(idx, bank_sel, data, mask);
+        } else if (!ref_check(idx, bank_sel, read_data)) {
+            DCOUT("Mismatch iter=" << i << " bank=" << bank_sel << " idx=" << idx << endl);
+            assert(0);
+        }
+    }
+
+    run_throughput_benchmark();
+
+    DCOUT("CMODEL PASS" << endl);
+    CCS_RETURN(0) ;
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_module.h>
+#include <nvhls_memory.h>
+#include <fifo.h>
+#include <mem_array.h>
+#include <axi/testbench/SparseMem.h>
+
+// Builds match::Modules holding FIFOs, a mem_array_sep, a SparseMem and a
+// Connections::Buffer, and checks the bytes that match::Memory charges to
+// each Module: a FIFO inside a plain sc_module is charged to the Module
+// around it, a FIFO constructed while the simulation runs is not counted,
+// and the SparseMem grows by one page per page written.
+
+static const unsigned int kPages = 3;
+
+typedef NVUINTW(16) Lane;
+typedef NVUINTW(32) Word;
+typedef FIFO<Lane, 4> LaneFifo;
+typedef mem_array_sep<Word, 16, 1> WordMem;
+typedef SparseMem<32, 64> Mem;
+
+// A plain sc_module: its FIFO is charged to the enclosing match::Module
+SC_MODULE(Wrapper) {
+  LaneFifo fifo;
+
+  SC_CTOR(Wrapper) {}
+};
+
+class Tile : public match::Module {
+ public:
+  LaneFifo fifo;
+  WordMem mem;
+  Mem smem;
+  Wrapper wrapper;
+  bool done;
+
+  SC_HAS_PROCESS(Tile);
+  Tile(sc_module_name name_) : match::Module(name_), wrapper("wrapper"), done(false) {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void run() {
+    wait();
+    // Constructed while the simulation runs: not counted
+    static LaneFifo late_fifo;
+    late_fifo.reset();
+    late_fifo.push(1);
+    for (unsigned int p = 0; p < kPages; p++) {
+      smem.Write(p << 12, p);
+      smem.Write((p << 12) + 8, p);
+      wait();
+    }
+    done = true;
+    while (1) wait();
+  }
+};
+
+class Link : public match::Module {
+ public:
+  Connections::Combinational<Word> enq_chan, deq_chan;
+  Connections::Buffer<Word, 4> buffer;
+
+  Link(sc_module_name name_) : match::Module(name_), buffer("buffer") {
+    buffer.clk(clk);
+    buffer.rst(rst);
+    buffer.enq(enq_chan);
+    buffer.deq(deq_chan);
+  }
+};
+
+SC_MODULE(testbench) {
+  Tile tile;
+  Link link;
+  sc_clock clk;
+  sc_signal<bool> rst;
+
+  SC_CTOR(testbench)
+      : tile("tile"), link("link"), clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+        rst("rst") {
+    tile.clk(clk);
+    tile.rst(rst);
+    link.clk(clk);
+    link.rst(rst);
+    SC_THREAD(run);
+  }
+
+  void run() {
+    rst = 0;
+    wait(2, SC_NS);
+    rst = 1;
+    while (!tile.done)
+      wait(10, SC_NS);
+    sc_stop();
+  }
+};
+
+static int Check(const std::vector<std::pair<std::string, uint64> >& stats,
+                 const std::string& name, uint64 expected) {
+  for (unsigned int i = 0; i < stats.size(); i++) {
+    if (stats[i].first == name) {
+      if (stats[i].second == expected)
+        return 0;
+      cout << name << " is " << stats[i].second << " bytes, expected " << expected << endl;
+      return 1;
+    }
+  }
+  cout << name << " missing" << endl;
+  return 1;
+}
+
+int sc_main(int argc, char *argv[]) {
+  int errors = 0;
+  match::Memory::Get().Enable();
+
+  testbench tb("tb");
+  sc_start();
+  tb.tile.DumpStats(cout, 0, NULL);
+  tb.link.DumpStats(cout, 0, NULL);
+  match::Memory::Get().Report(cout);
+
+  std::vector<std::pair<std::string, uint64> > stats;
+  tb.tile.CollectStats(stats);
+  tb.link.CollectStats(stats);
+  uint64 fifo = 2 * sizeof(LaneFifo);
+  uint64 mem = sizeof(WordMem) + 16 * match::HeapBytes<sc_lv<32> >::value;
+  uint64 smem = sizeof(Mem) + kPages * (Mem::pageBytes + Mem::pageBytes / 4);
+  errors += Check(stats, "tb.tile.mem_bytes.FIFO", fifo);
+  errors += Check(stats, "tb.tile.mem_bytes.mem_array_sep", mem);
+  errors += Check(stats, "tb.tile.mem_bytes.SparseMem", smem);
+  errors += Check(stats, "tb.tile.mem_bytes", fifo + mem + smem);
+  errors += Check(stats, "tb.link.mem_bytes", sizeof(tb.link.buffer));
+
+  if (errors == 0)
+    cout << "Simulation PASSED" << endl;
+  else
+    cout << "Simulation FAILED" << endl;
+  return errors;
+}
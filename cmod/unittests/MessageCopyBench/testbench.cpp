@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <testbench/nvhls_rand.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// Message copy cost versus message width. The first table times the
+// construction, copy and comparison of NVUINTW and sc_lv messages, the
+// operations a channel that keeps messages in sc_signals performs for every
+// message. The second sends kFlowMsgs messages of each width through a
+// Connections::Buffer, one width after the other, and reports the time per
+// message; with SIM_MODE=2 the Buffer is the pooled TLM_PORT channel, with
+// SIM_MODE=1 the signal-based one. Every message must arrive intact and in
+// order.
+
+static const unsigned int kOps = 1 << 18;
+static const unsigned int kSlots = 16;
+static const unsigned int kFlowMsgs = 5000;
+
+typedef std::chrono::steady_clock Clock;
+
+static double NsPerOp(Clock::time_point start, unsigned int ops) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+}
+
+template <int W>
+static void Fill(NVUINTW(W)& msg) { msg = nvhls::get_rand<W>(); }
+
+template <int W>
+static void Fill(sc_lv<W>& msg) {
+  for (int lo = 0; lo < W; lo += 32)
+    msg.range((lo + 32 < W ? lo + 32 : W) - 1, lo) = sc_uint<32>(rand());
+}
+
+template <typename T, int W>
+static void BenchType(const char* type) {
+  std::vector<T> src(kSlots), dst(kSlots);
+  for (unsigned int i = 0; i < kSlots; i++)
+    Fill<W>(src[i]);
+  unsigned int equal = 0;
+
+  Clock::time_point start = Clock::now();
+  for (unsigned int i = 0; i < kOps; i++) {
+    T msg;
+    dst[i % kSlots] = msg;
+  }
+  double construct_ns = NsPerOp(start, kOps);
+
+  start = Clock::now();
+  for (unsigned int i = 0; i < kOps; i++)
+    dst[i % kSlots] = src[(i * 7) % kSlots];
+  double copy_ns = NsPerOp(start, kOps);
+
+  start = Clock::now();
+  for (unsigned int i = 0; i < kOps; i++)
+    equal += (dst[i % kSlots] == src[(i * 5) % kSlots]);
+  double compare_ns = NsPerOp(start, kOps);
+
+  std::cout << std::setw(8) << type << std::setw(6) << W << std::fixed << std::setprecision(1)
+            << std::setw(12) << construct_ns << std::setw(10) << copy_ns << std::setw(10)
+            << compare_ns << "   (" << equal << " equal)" << std::endl;
+}
+
+template <int W>
+SC_MODULE(FlowBench) {
+  typedef NVUINTW(W) Msg;
+
+  sc_in_clk clk;
+  sc_in<bool> rst;
+  Connections::Out<Msg> src;
+  Connections::In<Msg> sink;
+  Connections::Combinational<Msg> enq_chan, deq_chan;
+  Connections::Buffer<Msg, 4> buffer;
+  std::vector<Msg> msgs;
+  double ns_per_msg;
+  bool passed;
+  bool go;           // set when the previous flow is done
+  bool* done;        // go of the next flow
+
+  SC_CTOR(FlowBench)
+      : clk("clk"), rst("rst"), buffer("buffer"), ns_per_msg(0), passed(false), go(false),
+        done(0) {
+    for (unsigned int i = 0; i < kFlowMsgs; i++)
+      msgs.push_back(nvhls::get_rand<W>());
+    buffer.clk(clk);
+    buffer.rst(rst);
+    src(enq_chan);
+    buffer.enq(enq_chan);
+    buffer.deq(deq_chan);
+    sink(deq_chan);
+
+    SC_THREAD(send);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+
+    SC_THREAD(receive);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+
+  void send() {
+    src.Reset();
+    wait();
+    while (!go) wait();
+    for (unsigned int i = 0; i < kFlowMsgs; i++)
+      src.Push(msgs[i]);
+    while (1) wait();
+  }
+
+  void receive() {
+    sink.Reset();
+    wait();
+    while (!go) wait();
+    Clock::time_point start = Clock::now();
+    passed = true;
+    for (unsigned int i = 0; i < kFlowMsgs; i++) {
+      if (sink.Pop() != msgs[i]) {
+        std::cout << "FAILED: " << W << "-bit message " << i << " corrupted" << std::endl;
+        passed = false;
+      }
+    }
+    ns_per_msg = NsPerOp(start, kFlowMsgs);
+    if (done) *done = true;
+    while (1) wait();
+  }
+};
+
+SC_MODULE(testbench) {
+  sc_clock clk;
+  sc_signal<bool> rst;
+  FlowBench<64> flow_64;
+  FlowBench<512> flow_512;
+  FlowBench<4096> flow_4096;
+
+  SC_CTOR(testbench)
+      : clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+        rst("rst"),
+        flow_64("flow_64"),
+        flow_512("flow_512"),
+        flow_4096("flow_4096") {
+    flow_64.clk(clk);
+    flow_64.rst(rst);
+    flow_512.clk(clk);
+    flow_512.rst(rst);
+    flow_4096.clk(clk);
+    flow_4096.rst(rst);
+    flow_64.go = true;
+    flow_64.done = &flow_512.go;
+    flow_512.done = &flow_4096.go;
+    SC_THREAD(run);
+  }
+
+  void run() {
+    rst.write(false);
+    wait(10, SC_NS);
+    rst.write(true);
+    while (!(flow_64.ns_per_msg > 0 && flow_512.ns_per_msg > 0 && flow_4096.ns_per_msg > 0))
+      wait(100, SC_NS);
+    sc_stop();
+  }
+};
+
+int sc_main(int argc, char* argv[]) {
+  nvhls::set_random_seed();
+
+  std::cout << "    type width  construct      copy   compare   (ns per message)" << std::endl;
+  BenchType<NVUINTW(64), 64>("NVUINTW");
+  BenchType<NVUINTW(512), 512>("NVUINTW");
+  BenchType<NVUINTW(4096), 4096>("NVUINTW");
+  BenchType<sc_lv<64>, 64>("sc_lv");
+  BenchType<sc_lv<512>, 512>("sc_lv");
+  BenchType<sc_lv<4096>, 4096>("sc_lv");
+
+  testbench tb("tb");
+  sc_start();
+  std::cout << "Buffer flow, ns per message: 64-bit " << tb.flow_64.ns_per_msg << ", 512-bit "
+            << tb.flow_512.ns_per_msg << ", 4096-bit " << tb.flow_4096.ns_per_msg << std::endl;
+
+  if (!tb.flow_64.passed || !tb.flow_512.passed || !tb.flow_4096.passed) {
+    DCOUT("TESTBENCH FAIL" << endl);
+    return 1;
+  }
+  DCOUT("TESTBENCH PASS" << endl);
+  return 0;
+}
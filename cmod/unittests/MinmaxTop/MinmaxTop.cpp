@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <comptrees.h>
+#include <hls_globals.h>
+#include "MinmaxTop.h"
+
+void MinmaxTop(const bool& in_valid, const Elems& in, bool& out_valid, Index& out_idx, Elem& out_val) {
+  static ArgmaxTree argmax;
+  out_valid = argmax.run(in_valid, in, out_idx, out_val);
+}
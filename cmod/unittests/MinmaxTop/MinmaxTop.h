@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MINMAX_TOP_H
+#define MINMAX_TOP_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <comptrees.h>
+#include <hls_globals.h>
+
+#ifndef NUM_ELEMS
+#define NUM_ELEMS 256
+#endif
+
+#ifndef ELEM_WIDTH
+#define ELEM_WIDTH 8
+#endif
+
+#ifndef LEVELS_PER_STAGE
+#define LEVELS_PER_STAGE 2
+#endif
+
+typedef NVUINTC(ELEM_WIDTH) Elem;
+typedef NVUINTC(ELEM_WIDTH * NUM_ELEMS) Elems;
+typedef NVUINTC(nvhls::index_width<NUM_ELEMS>::val) Index;
+
+typedef PipelinedMinmax<Elems, Elem, Index, true, NUM_ELEMS, LEVELS_PER_STAGE> ArgmaxTree;
+
+void MinmaxTop(const bool& in_valid, const Elems& in, bool& out_valid, Index& out_idx, Elem& out_val);
+
+#endif
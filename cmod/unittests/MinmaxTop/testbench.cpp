@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <ctime>
+#include <deque>
+#include <match_scverify.h>
+
+#include "MinmaxTop.h"
+
+#ifndef NUM_ITERS
+#define NUM_ITERS 2000
+#endif
+
+#ifndef NUM_BENCH_ITERS
+#define NUM_BENCH_ITERS 20000
+#endif
+
+// Random packed elements; a small range produces many ties
+template <unsigned int W, unsigned int N>
+NVUINTW(W * N) get_rand_elems(unsigned int range) {
+  NVUINTW(W * N) x = 0;
+  for (unsigned int i = 0; i < N; i++) {
+    NVUINTW(W) e = (range > 0) ? (rand() % range) : rand();
+    x = nvhls::set_slc(x, e, i * W);
+  }
+  return x;
+}
+
+// Index of the largest (smallest) element with the Minmax tie rule: the
+// first leaf pair holding one, and within it the upper element
+template <unsigned int W, unsigned int N, bool is_max>
+unsigned int ref_minmax(NVUINTW(W * N) x) {
+  unsigned int best = 0;
+  for (unsigned int i = 1; i < N; i++) {
+    NVUINTW(W) e = nvhls::get_slc<W>(x, i * W);
+    NVUINTW(W) b = nvhls::get_slc<W>(x, best * W);
+    if (is_max ? (e > b) : (e < b)) best = i;
+  }
+  if ((best % 2 == 0) && (best + 1 < N) &&
+      (nvhls::get_slc<W>(x, best * W) == nvhls::get_slc<W>(x, (best + 1) * W))) {
+    best++;
+  }
+  return best;
+}
+
+// Checks PipelinedMinmax against the reference, and against Minmax for a
+// power-of-2 N, with bubbles in the input
+template <unsigned int W, unsigned int N, bool is_max, unsigned int K>
+bool check_pipelined() {
+  typedef NVUINTW(W) elem_t;
+  typedef NVUINTW(W * N) arr_t;
+  typedef NVUINTW(nvhls::index_width<N>::val) idx_t;
+  typedef PipelinedMinmax<arr_t, elem_t, idx_t, is_max, N, K> Tree;
+  Tree tree;
+  std::deque<unsigned int> expected;
+  std::deque<bool> expected_valid(Tree::Latency, false);
+  bool ok = true;
+  for (int iter = 0; iter < NUM_ITERS; iter++) {
+    arr_t x = get_rand_elems<W, N>((iter % 2) ? 0 : 4);
+    unsigned int ref = ref_minmax<W, N, is_max>(x);
+    if ((N & (N - 1)) == 0) {
+      idx_t comb = Minmax<arr_t, elem_t, idx_t, is_max, N>::minmax(x, 0, N - 1);
+      if (comb != ref) {
+        std::cout << "ERROR: Minmax N " << N << " returned " << comb << " expected " << ref << std::endl;
+        ok = false;
+      }
+    }
+    bool in_valid = (rand() % 4 != 0);
+    idx_t out_idx;
+    elem_t out_val;
+    bool out_valid = tree.run(in_valid, x, out_idx, out_val);
+    expected_valid.push_back(in_valid);
+    if (in_valid) expected.push_back(ref);
+    bool exp_valid = expected_valid.front();
+    expected_valid.pop_front();
+    if (out_valid != exp_valid) {
+      std::cout << "ERROR: PipelinedMinmax N " << N << " K " << K << " valid mismatch" << std::endl;
+      ok = false;
+    }
+    if (exp_valid) {
+      if (out_idx != expected.front()) {
+        std::cout << "ERROR: PipelinedMinmax N " << N << " K " << K << " returned " << out_idx
+                  << " expected " << expected.front() << std::endl;
+        ok = false;
+      }
+      expected.pop_front();
+    }
+  }
+  return ok;
+}
+
+CCS_MAIN(int argc, char *argv[]) {
+  bool ok = true;
+
+  ok = check_pipelined<8, 1, true, 1>() && ok;
+  ok = check_pipelined<8, 2, false, 1>() && ok;
+  ok = check_pipelined<8, 7, true, 1>() && ok;
+  ok = check_pipelined<8, 7, false, 2>() && ok;
+  ok = check_pipelined<4, 64, true, 1>() && ok;
+  ok = check_pipelined<4, 64, false, 4>() && ok;
+  ok = check_pipelined<16, 100, true, 3>() && ok;
+  ok = check_pipelined<8, 256, true, 2>() && ok;
+  ok = check_pipelined<8, 256, false, 8>() && ok;
+
+  // Drive the design with a new input every cycle: after the first Latency
+  // cycles it returns one result per cycle
+  std::deque<unsigned int> expected;
+  unsigned int num_out = 0;
+  std::clock_t start = std::clock();
+  for (int i = 0; i < NUM_BENCH_ITERS + static_cast<int>(ArgmaxTree::Latency); i++) {
+    bool in_valid = (i < NUM_BENCH_ITERS);
+    Elems in = get_rand_elems<ELEM_WIDTH, NUM_ELEMS>(0);
+    bool out_valid;
+    Index out_idx;
+    Elem out_val;
+    CCS_DESIGN(MinmaxTop)(in_valid, in, out_valid, out_idx, out_val);
+    if (in_valid) {
+      expected.push_back(ref_minmax<ELEM_WIDTH, NUM_ELEMS, true>(in));
+    }
+    if (out_valid) {
+      if (expected.empty() || (out_idx != expected.front())) {
+        std::cout << "ERROR: MinmaxTop output " << out_idx << std::endl;
+        ok = false;
+      } else {
+        expected.pop_front();
+      }
+      num_out++;
+    }
+  }
+  double seconds = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+  if (num_out != NUM_BENCH_ITERS) {
+    std::cout << "ERROR: " << num_out << " results in " << NUM_BENCH_ITERS + ArgmaxTree::Latency
+              << " cycles, expected " << NUM_BENCH_ITERS << std::endl;
+    ok = false;
+  }
+  std::cout << "MinmaxTop: " << NUM_ELEMS << " elements, latency " << ArgmaxTree::Latency << ", "
+            << num_out << " results in " << NUM_BENCH_ITERS + ArgmaxTree::Latency << " cycles, "
+            << (NUM_BENCH_ITERS / seconds) << " results/s simulated" << std::endl;
+
+  if (ok) {
+    std::cout << "PASS" << std::endl;
+  } else {
+    std::cout << "FAIL" << std::endl;
+  }
+  CCS_RETURN(0);
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <sstream>
+#include <systemc.h>
+#include <nvhls_module.h>
+
+// Checks the counters of match::Modules: stats registered with RegisterStat()
+// and RegisterStatIndexed() and incremented through their handles are merged
+// with the stats of the same names incremented by name, per Module in
+// CollectStats() and DumpStats(), and summed over the children in the
+// DumpStats() totals and the aggregator. Also checks the buckets, count, min,
+// max and mean that DumpStats() prints for a linear histogram, a log2
+// histogram and a time series.
+
+class Leaf : public match::Module {
+ public:
+  Leaf(sc_module_name name_) : match::Module(name_) {
+    hits_ = RegisterStat("hits");
+    lanes_ = RegisterStatIndexed("lane", 2);
+    RegisterStat("unused");  // Never incremented: not reported
+    latency_ = RegisterHistogram("latency", 4, 10);
+    size_ = RegisterLog2Histogram("size", 4);
+    flits_ = RegisterTimeSeries("flits", sc_time(10, SC_NS));
+  }
+
+  void Count(unsigned int n) {
+    for (unsigned int i = 0; i < n; i++) {
+      IncrStat(hits_);
+      IncrStatIndexed(lanes_, i % 2);
+    }
+    // By name, on top of the registered counters
+    IncrStat("hits", 10);
+    IncrStatIndexed("lane", 1, 5);
+    IncrStat("misses");
+  }
+
+  void Sample(uint64 latency, uint64 size) {
+    RecordSample(latency_, latency);
+    RecordSample(size_, size);
+  }
+
+  void Flits(uint64 n) { RecordSample(flits_, n); }
+
+ private:
+  StatHandle hits_, lanes_;
+  DistHandle latency_, size_, flits_;
+};
+
+class Top : public match::Module {
+ public:
+  Leaf a, b;
+
+  Top(sc_module_name name_) : match::Module(name_), a("a"), b("b") {
+    a.clk(clk);
+    a.rst(rst);
+    b.clk(clk);
+    b.rst(rst);
+  }
+};
+
+SC_MODULE(testbench) {
+  Top top;
+  sc_clock clk;
+  sc_signal<bool> rst;
+
+  SC_CTOR(testbench)
+      : top("top"), clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true), rst("rst") {
+    top.clk(clk);
+    top.rst(rst);
+  }
+};
+
+// Collects the stats outside the testbench hierarchy.
+class Aggregator : public match::Module {
+ public:
+  Aggregator(sc_module_name name_) : match::Module(name_) {}
+};
+
+static int Check(const std::vector<std::pair<std::string, uint64> >& stats,
+                 const std::string& name, uint64 expected) {
+  for (unsigned int i = 0; i < stats.size(); i++) {
+    if (stats[i].first == name) {
+      if (stats[i].second == expected)
+        return 0;
+      cout << name << " is " << stats[i].second << ", expected " << expected << endl;
+      return 1;
+    }
+  }
+  cout << name << " missing" << endl;
+  return 1;
+}
+
+static int CheckLine(const std::string& text, const std::string& line) {
+  if (text.find("\n" + line + "\n") != std::string::npos)
+    return 0;
+  cout << "DumpStats() has no line \"" << line << "\"" << endl;
+  return 1;
+}
+
+int sc_main(int argc, char *argv[]) {
+  int errors = 0;
+  testbench tb("tb");
+  Aggregator agg("agg");
+  tb.top.a.Count(3);
+  tb.top.b.Count(5);
+  const uint64 latencies[] = {0, 9, 10, 25, 100};
+  const uint64 sizes[] = {0, 1, 3, 4, 100};
+  for (unsigned int i = 0; i < 5; i++)
+    tb.top.a.Sample(latencies[i], sizes[i]);
+  tb.top.a.Flits(3);
+  tb.top.a.Flits(4);
+  sc_start(25, SC_NS);
+  tb.top.a.Flits(2);
+
+  std::vector<std::pair<std::string, uint64> > stats;
+  tb.top.CollectStats(stats);
+  errors += Check(stats, "tb.top.a.hits", 13);
+  errors += Check(stats, "tb.top.a.lane_0", 2);
+  errors += Check(stats, "tb.top.a.lane_1", 6);
+  errors += Check(stats, "tb.top.a.misses", 1);
+  errors += Check(stats, "tb.top.b.hits", 15);
+  errors += Check(stats, "tb.top.b.lane_0", 3);
+  errors += Check(stats, "tb.top.b.lane_1", 7);
+  errors += Check(stats, "tb.top.b.misses", 1);
+  if (stats.size() != 8) {
+    cout << stats.size() << " stats collected, expected 8" << endl;
+    errors++;
+  }
+
+  std::ostringstream text;
+  tb.top.DumpStats(text, 0, &agg);
+  cout << text.str();
+  std::string dump = "\n" + text.str();
+  errors += CheckLine(dump, "  tb.top.a:");
+  errors += CheckLine(dump, "    hits: 13");
+  errors += CheckLine(dump, "    lane_1: 6");
+  errors += CheckLine(dump, "    latency: count 5, min 0, max 100, mean 28.8");
+  errors += CheckLine(dump, "      [0, 10): 2");
+  errors += CheckLine(dump, "      [10, 20): 1");
+  errors += CheckLine(dump, "      [20, 30): 1");
+  errors += CheckLine(dump, "      [30, inf): 1");
+  errors += CheckLine(dump, "    size: count 5, min 0, max 100, mean 21.6");
+  errors += CheckLine(dump, "      [0, 1): 1");
+  errors += CheckLine(dump, "      [1, 2): 1");
+  errors += CheckLine(dump, "      [2, 4): 1");
+  errors += CheckLine(dump, "      [4, inf): 2");
+  errors += CheckLine(dump, "    flits: count 3, min 2, max 4, mean 3");
+  // The first bound prints as "0 s" or "0 ns" depending on the SystemC version
+  if (dump.find(", 10 ns): 7\n") == std::string::npos) {
+    cout << "DumpStats() has no first time-series bucket of 7" << endl;
+    errors++;
+  }
+  errors += CheckLine(dump, "      [20 ns, 30 ns): 2");
+  if (dump.find("[10 ns, 20 ns)") != std::string::npos) {
+    cout << "DumpStats() prints an empty time-series bucket" << endl;
+    errors++;
+  }
+  errors += CheckLine(dump, "  tb.top.b:");
+  errors += CheckLine(dump, "    hits: 15");
+  errors += CheckLine(dump, "    lane_1: 7");
+  errors += CheckLine(dump, "Totals:");
+  errors += CheckLine(dump, "  hits: 28");
+  errors += CheckLine(dump, "  lane_0: 5");
+  errors += CheckLine(dump, "  lane_1: 13");
+  errors += CheckLine(dump, "  misses: 2");
+  if (dump.find("unused") != std::string::npos) {
+    cout << "DumpStats() prints a stat that was never incremented" << endl;
+    errors++;
+  }
+
+  stats.clear();
+  agg.CollectStats(stats, false);
+  errors += Check(stats, "agg.hits", 28);
+  errors += Check(stats, "agg.lane_0", 5);
+  errors += Check(stats, "agg.lane_1", 13);
+  errors += Check(stats, "agg.misses", 2);
+
+  if (errors == 0)
+    cout << "Simulation PASSED" << endl;
+  else
+    cout << "Simulation FAILED" << endl;
+  return errors;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <match_scverify.h>
+#include <testbench/nvhls_rand.h>
+
+#include "MultiArbiterTop.h"
+
+#ifndef NUM_ITERS
+#define NUM_ITERS 1000
+#endif
+
+#ifndef NUM_BENCH_CYCLES
+#define NUM_BENCH_CYCLES 10000
+#endif
+
+mask_t semi_random(const int& iter)
+{
+    if (iter%17==0) {
+        //sprinkle zero valids
+        return 0;
+    }
+    mask_t result = nvhls::get_rand<NUM_INPUTS>();
+    if (iter%5==0) {
+        // sparse masks
+        result &= nvhls::get_rand<NUM_INPUTS>();
+    }
+    return result;
+}
+
+// Reference model: scan from the roundrobin pointer and grant the first
+// NUM_GRANTS valid requesters, then move the pointer past the last grant.
+void reference_arbiter(const mask_t& valid, mask_t grants[NUM_GRANTS])
+{
+    static unsigned ptr = 0;
+    unsigned granted = 0;
+    unsigned last = 0;
+    for (unsigned k = 0; k < NUM_GRANTS; k++) {
+        grants[k] = 0;
+    }
+    for (unsigned i = 0; i < NUM_INPUTS && granted < NUM_GRANTS; i++) {
+        unsigned idx = (ptr + i) % NUM_INPUTS;
+        if (valid[idx] == 1) {
+            grants[granted][idx] = 1;
+            granted++;
+            last = idx;
+        }
+    }
+    if (granted > 0) {
+        ptr = (last + 1) % NUM_INPUTS;
+    }
+}
+
+unsigned popcount(const mask_t& mask)
+{
+    unsigned count = 0;
+    for (unsigned i = 0; i < NUM_INPUTS; i++) {
+        count += (mask[i] == 1) ? 1 : 0;
+    }
+    return count;
+}
+
+// Saturated benchmark: every requester must get NUM_GRANTS/NUM_INPUTS of the grants
+void run_fairness_benchmark()
+{
+    arbiter_t arb;
+    unsigned long long served[NUM_INPUTS] = {0};
+    mask_t valid = ~static_cast<mask_t>(0);
+    for (int cycle = 0; cycle < NUM_BENCH_CYCLES; cycle++) {
+        mask_t select = arb.pick(valid);
+        assert(popcount(select) == ((NUM_GRANTS < NUM_INPUTS) ? NUM_GRANTS : NUM_INPUTS));
+        for (unsigned i = 0; i < NUM_INPUTS; i++) {
+            served[i] += (select[i] == 1) ? 1 : 0;
+        }
+    }
+    double expected = ((NUM_GRANTS < NUM_INPUTS) ? NUM_GRANTS : NUM_INPUTS) / static_cast<double>(NUM_INPUTS);
+    for (unsigned i = 0; i < NUM_INPUTS; i++) {
+        double measured = served[i] / static_cast<double>(NUM_BENCH_CYCLES);
+        DCOUT("requester " << i << ": expected grant rate " << expected
+              << " measured grant rate " << measured << endl);
+        assert(measured > expected - 0.01 && measured < expected + 0.01);
+    }
+}
+
+CCS_MAIN(int argc, char *argv[]) {
+    nvhls::set_random_seed();
+    mask_t valid, select;
+    mask_t grants[NUM_GRANTS], ref[NUM_GRANTS];
+
+    for (int i = 0; i < NUM_ITERS; i++) {
+        valid = semi_random(i);
+        CCS_DESIGN(MultiArbiterTop)(valid, grants, select);
+        reference_arbiter(valid, ref);
+
+        mask_t all = 0;
+        for (unsigned k = 0; k < NUM_GRANTS; k++) {
+            if (grants[k] != ref[k]) {
+                DCOUT("Mismatch iter=" << i << " valid=" << valid << " slot=" << k
+                      << " grant=" << grants[k] << " ref=" << ref[k] << endl);
+                assert(0);
+            }
+            assert((grants[k] & (grants[k] - 1)) == 0);
+            assert((all & grants[k]) == 0);
+            all |= grants[k];
+        }
+        assert(all == select);
+        assert((select & ~valid) == 0);
+    }
+
+    run_fairness_benchmark();
+
+    DCOUT("CMODEL PASS" << endl);
+    CCS_RETURN(0) ;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MULTIPLY_TOP_H
+#define MULTIPLY_TOP_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <nvhls_mult.h>
+#include <hls_globals.h>
+
+#ifndef NUM_BITS
+#define NUM_BITS 64
+#endif
+
+#ifndef LEVELS_PER_STAGE
+#define LEVELS_PER_STAGE 2
+#endif
+
+#ifndef KARATSUBA_THRESHOLD
+#define KARATSUBA_THRESHOLD 16
+#endif
+
+typedef NVUINTC(NUM_BITS) Data;
+typedef NVUINTC(2 * NUM_BITS) Product;
+
+typedef nvhls::PipelinedMultiply<Data, Data, LEVELS_PER_STAGE> Multiplier;
+
+void MultiplyTop(const bool& in_valid, const Data& a, const Data& b,
+                 bool& booth_valid, Product& booth_out, Product& karatsuba_out);
+
+#endif
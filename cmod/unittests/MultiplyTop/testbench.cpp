@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <deque>
+#include <match_scverify.h>
+#include <testbench/nvhls_rand.h>
+
+#include "MultiplyTop.h"
+
+#ifndef NUM_ITERS
+#define NUM_ITERS 2000
+#endif
+
+// Random operand of W bits with a random number of leading zeros, and all
+// ones or zero now and then
+template <unsigned int W>
+NVUINTW(W) rand_operand() {
+  NVUINTW(W) x = nvhls::get_rand<W>();
+  int kind = rand() % 16;
+  if (kind == 0) x = 0;
+  if (kind == 1) x = ~x | x;
+  if (kind >= 8) x = x >> (rand() % W);
+  return x;
+}
+
+// Reference product by shift and add
+template <unsigned int AW, unsigned int BW>
+NVUINTW(AW + BW) ref_mult(NVUINTW(AW) a, NVUINTW(BW) b) {
+  NVUINTW(AW + BW) p = 0;
+  NVUINTW(AW + BW) x = a;
+  for (unsigned int i = 0; i < BW; i++) {
+    if (b[i] == 1) p = p + x;
+    x = x << 1;
+  }
+  return p;
+}
+
+// Checks booth_multiply and karatsuba_multiply against the reference
+template <unsigned int AW, unsigned int BW>
+bool check_booth() {
+  bool ok = true;
+  for (int i = 0; i < NUM_ITERS; i++) {
+    NVUINTW(AW) a = rand_operand<AW>();
+    NVUINTW(BW) b = rand_operand<BW>();
+    NVUINTW(AW + BW) p = nvhls::booth_multiply<NVUINTW(AW), NVUINTW(BW)>(a, b);
+    if (p != ref_mult<AW, BW>(a, b)) {
+      std::cout << "ERROR: booth_multiply " << AW << "x" << BW << " " << a << " * " << b
+                << " = " << p << std::endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+template <unsigned int W, unsigned int Threshold>
+bool check_karatsuba() {
+  bool ok = true;
+  for (int i = 0; i < NUM_ITERS; i++) {
+    NVUINTW(W) a = rand_operand<W>();
+    NVUINTW(W) b = rand_operand<W>();
+    NVUINTW(2 * W) p = nvhls::karatsuba_multiply<Threshold, NVUINTW(W)>(a, b);
+    if (p != ref_mult<W, W>(a, b)) {
+      std::cout << "ERROR: karatsuba_multiply<" << Threshold << "> " << W << "x" << W << " "
+                << a << " * " << b << " = " << p << std::endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+// Checks that the pipelined multiplier matches the combinational one after
+// its latency of cycles
+template <unsigned int W, unsigned int LevelsPerStage>
+bool check_pipelined() {
+  typedef NVUINTW(W) T;
+  typedef nvhls::PipelinedMultiply<T, T, LevelsPerStage> Mult;
+  Mult mult;
+  std::deque<typename Mult::out_t> expected;
+  std::deque<bool> expected_valid;
+  for (unsigned int i = 0; i < Mult::Latency; i++) expected_valid.push_back(false);
+  bool ok = true;
+  for (int i = 0; i < NUM_ITERS; i++) {
+    bool valid = (rand() % 4 != 0);
+    T a = rand_operand<W>();
+    T b = rand_operand<W>();
+    typename Mult::out_t out;
+    bool out_valid = mult.run(valid, a, b, out);
+    expected_valid.push_back(valid);
+    if (valid) expected.push_back(nvhls::booth_multiply<T, T>(a, b));
+    bool exp_valid = expected_valid.front();
+    expected_valid.pop_front();
+    if (out_valid != exp_valid) {
+      std::cout << "ERROR: pipelined valid mismatch at cycle " << i << std::endl;
+      ok = false;
+    } else if (exp_valid) {
+      if (out != expected.front()) {
+        std::cout << "ERROR: pipelined output mismatch at cycle " << i << std::endl;
+        ok = false;
+      }
+      expected.pop_front();
+    }
+  }
+  return ok;
+}
+
+CCS_MAIN(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  bool ok = true;
+
+  ok = check_booth<1, 1>() && ok;
+  ok = check_booth<2, 3>() && ok;
+  ok = check_booth<7, 12>() && ok;
+  ok = check_booth<16, 16>() && ok;
+  ok = check_booth<32, 32>() && ok;
+  ok = check_booth<64, 64>() && ok;
+  ok = check_booth<NUM_BITS, NUM_BITS>() && ok;
+  ok = check_karatsuba<5, 2>() && ok;
+  ok = check_karatsuba<32, 4>() && ok;
+  ok = check_karatsuba<33, 8>() && ok;
+  ok = check_karatsuba<64, 16>() && ok;
+  ok = check_karatsuba<NUM_BITS, KARATSUBA_THRESHOLD>() && ok;
+  ok = check_pipelined<NUM_BITS, 1>() && ok;
+  ok = check_pipelined<NUM_BITS, 2>() && ok;
+  ok = check_pipelined<NUM_BITS, 3>() && ok;
+  ok = check_pipelined<NUM_BITS, 64>() && ok;
+
+  // Drive the design: the Booth product comes out Multiplier::Latency cycles
+  // after its operands, the Karatsuba product in the same cycle
+  std::deque<Product> expected;
+  for (int i = 0; i < NUM_ITERS; i++) {
+    bool in_valid = (i < NUM_ITERS - static_cast<int>(Multiplier::Latency));
+    Data a = rand_operand<NUM_BITS>();
+    Data b = rand_operand<NUM_BITS>();
+    bool booth_valid;
+    Product booth_out, karatsuba_out;
+    CCS_DESIGN(MultiplyTop)(in_valid, a, b, booth_valid, booth_out, karatsuba_out);
+    Product ref = ref_mult<NUM_BITS, NUM_BITS>(a, b);
+    if (karatsuba_out != ref) {
+      std::cout << "ERROR: karatsuba " << a << " * " << b << " = " << karatsuba_out << std::endl;
+      ok = false;
+    }
+    if (in_valid) expected.push_back(ref);
+    if (booth_valid) {
+      if (expected.empty() || (booth_out != expected.front())) {
+        std::cout << "ERROR: booth output " << booth_out << std::endl;
+        ok = false;
+      } else {
+        expected.pop_front();
+      }
+    }
+  }
+  if (!expected.empty()) {
+    std::cout << "ERROR: " << expected.size() << " booth outputs missing" << std::endl;
+    ok = false;
+  }
+
+  if (ok) {
+    std::cout << "PASS" << std::endl;
+  } else {
+    std::cout << "FAIL" << std::endl;
+  }
+  CCS_RETURN(0);
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <ctime>
+#include <match_scverify.h>
+#include <nvhls_types.h>
+#include <nvhls_native_int.h>
+#include <TypeToBits.h>
+
+#ifndef NUM_ITERS
+#define NUM_ITERS 20000
+#endif
+
+#ifndef NUM_BENCH_OPS
+#define NUM_BENCH_OPS 2000000
+#endif
+
+template <unsigned int W, bool S>
+struct sc_ref_t {
+  typedef sc_uint<W> type;
+};
+
+template <unsigned int W>
+struct sc_ref_t<W, true> {
+  typedef sc_int<W> type;
+};
+
+uint64 rand64() {
+  uint64 r = static_cast<uint64>(rand()) ^ (static_cast<uint64>(rand()) << 21) ^
+             (static_cast<uint64>(rand()) << 42);
+  // bias towards small magnitudes and corner values
+  switch (rand() % 8) {
+    case 0: return r & 0xF;
+    case 1: return ~static_cast<uint64>(0) - (r & 0x3);
+    case 2: return static_cast<uint64>(1) << (rand() % 64);
+    default: return r;
+  }
+}
+
+// Compares native_int<W, S> against sc_uint/sc_int of the same width for a
+// random mix of operations
+template <unsigned int W, bool S>
+bool check_width() {
+  typedef nvhls::native_int<W, S> N;
+  typedef typename sc_ref_t<W, S>::type R;
+  bool ok = true;
+  for (int it = 0; it < NUM_ITERS; it++) {
+    uint64 a_bits = rand64(), b_bits = rand64();
+    N a = a_bits, b = b_bits;
+    R ra = a_bits, rb = b_bits;
+    unsigned int lo = rand() % W;
+    unsigned int hi = lo + rand() % (W - lo);
+    int s = rand() % W;
+    bool bit = rand() & 1;
+
+    N n_res;
+    R r_res;
+    int op = rand() % 16;
+    switch (op) {
+      case 0: n_res = a + b; r_res = ra + rb; break;
+      case 1: n_res = a - b; r_res = ra - rb; break;
+      case 2: n_res = a * b; r_res = ra * rb; break;
+      case 3: if (b != 0) { n_res = a / b; r_res = ra / rb; } break;
+      case 4: if (b != 0) { n_res = a % b; r_res = ra % rb; } break;
+      case 5: n_res = (a & b) | (a ^ ~b); r_res = (ra & rb) | (ra ^ ~rb); break;
+      case 6: n_res = a; n_res += b; n_res *= b; r_res = ra; r_res += rb; r_res *= rb; break;
+      case 7: n_res = a; n_res <<= s; r_res = ra; r_res <<= s; break;
+      case 8: n_res = a; n_res >>= s; r_res = ra; r_res >>= s; break;
+      case 9: n_res = a.range(hi, lo); r_res = ra.range(hi, lo); break;
+      case 10: n_res = a; n_res.range(hi, lo) = b; r_res = ra; r_res.range(hi, lo) = rb; break;
+      case 11: n_res = a; n_res[lo] = bit; r_res = ra; r_res[lo] = bit; break;
+      case 12: n_res = a; n_res++; --n_res; n_res--; r_res = ra; r_res++; --r_res; r_res--; break;
+      case 13: n_res = (a < b) + 2 * (a == b) + 4 * (a > 0); r_res = (ra < rb) + 2 * (ra == rb) + 4 * (ra > 0); break;
+      case 14: n_res = a.xor_reduce() + 2 * a.and_reduce() + 4 * a[lo]; r_res = ra.xor_reduce() + 2 * ra.and_reduce() + 4 * ra[lo]; break;
+      case 15: {
+        // marshalling round trip
+        n_res = BitsToType<N>(TypeToBits<N>(a));
+        r_res = ra;
+        break;
+      }
+    }
+    if ((n_res.to_uint64() != r_res.to_uint64()) || (n_res.to_int64() != r_res.to_int64())) {
+      std::cout << "ERROR: op=" << op << " W=" << W << " S=" << S << " a=" << a << " b=" << b << " native=" << n_res
+                << " sc=" << r_res << std::endl;
+      ok = false;
+    }
+  }
+  // ac_int style slices
+  N a = rand64();
+  N c = a;
+  c.set_slc(W / 2, a.template slc<(W + 1) / 2>(0));
+  R rc = a.to_uint64();
+  rc.range(W - 1, W / 2) = a.range((W + 1) / 2 - 1, 0);
+  if (c.to_uint64() != rc.to_uint64()) {
+    std::cout << "ERROR: W=" << W << " S=" << S << " set_slc/slc mismatch" << std::endl;
+    ok = false;
+  }
+  return ok;
+}
+
+// Multiply-accumulate throughput of a scalar type
+template <typename In, typename Acc>
+double bench_mac() {
+  srand(1);
+  In a[16], b[16];
+  for (int i = 0; i < 16; i++) {
+    a[i] = rand();
+    b[i] = rand();
+  }
+  Acc acc = 0;
+  std::clock_t start = std::clock();
+  for (int i = 0; i < NUM_BENCH_OPS; i++) {
+    acc += a[i % 16] * b[(i + 3) % 16];
+  }
+  double seconds = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+  std::cout << "  (acc " << acc << ")";
+  return NUM_BENCH_OPS / seconds;
+}
+
+CCS_MAIN(int argc, char *argv[]) {
+  bool ok = true;
+  ok = check_width<1, false>() && ok;
+  ok = check_width<2, true>() && ok;
+  ok = check_width<5, false>() && ok;
+  ok = check_width<8, false>() && ok;
+  ok = check_width<8, true>() && ok;
+  ok = check_width<13, true>() && ok;
+  ok = check_width<32, false>() && ok;
+  ok = check_width<32, true>() && ok;
+  ok = check_width<33, false>() && ok;
+  ok = check_width<63, true>() && ok;
+  ok = check_width<64, false>() && ok;
+  ok = check_width<64, true>() && ok;
+
+  double sc_rate = bench_mac<sc_uint<8>, sc_uint<32> >();
+  std::cout << " sc_uint MAC: " << sc_rate << " ops/s" << std::endl;
+  double native_rate = bench_mac<nvhls::native_int<8, false>, nvhls::native_int<32, false> >();
+  std::cout << " native_int MAC: " << native_rate << " ops/s" << std::endl;
+
+  if (ok) {
+    std::cout << "PASS" << std::endl;
+  } else {
+    std::cout << "FAIL" << std::endl;
+  }
+  CCS_RETURN(0);
+}
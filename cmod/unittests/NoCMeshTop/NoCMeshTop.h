@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __NOCMESHTOP_H__
+#define __NOCMESHTOP_H__
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_packet.h>
+#include <NoCMesh.h>
+
+SC_MODULE(NoCMeshTop) {
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+
+  enum {
+    kXDim = 4,
+    kYDim = 4,
+    kNumLPorts = 1,
+    kNumVChannels = 1,
+    kBufferSize = 8,
+    kNumLocal = kXDim * kYDim * kNumLPorts
+  };
+
+  typedef Flit<64, 0, 0, 0, FlitId2bit, WormHole> Flit_t;
+#ifdef NOC_MESH_MODEL
+  typedef NoCMeshModel<kXDim, kYDim, kNumLPorts, kNumVChannels, kBufferSize, Flit_t> Mesh_t;
+#else
+  typedef NoCMesh<kXDim, kYDim, kNumLPorts, kNumVChannels, kBufferSize, Flit_t> Mesh_t;
+#endif
+  typedef Mesh_t::Credit_ret_t Credit_ret_t;
+  enum { kCoordWidth = Mesh_t::coord_width };
+
+  Mesh_t mesh;
+
+  Connections::In<Flit_t> in_port[kNumLocal];
+  Connections::Out<Flit_t> out_port[kNumLocal];
+  Connections::In<Credit_ret_t> in_credit[kNumLocal * kNumVChannels];
+  Connections::Out<Credit_ret_t> out_credit[kNumLocal * kNumVChannels];
+
+  SC_HAS_PROCESS(NoCMeshTop);
+  NoCMeshTop(sc_module_name name)
+      : sc_module(name), clk("clk"), rst("rst"), mesh("mesh") {
+    mesh.clk(clk);
+    mesh.rst(rst);
+
+    for (int i = 0; i < kNumLocal; i++) {
+      mesh.in_port[i](in_port[i]);
+      mesh.out_port[i](out_port[i]);
+    }
+    for (int i = 0; i < kNumLocal * kNumVChannels; i++) {
+      mesh.in_credit[i](in_credit[i]);
+      mesh.out_credit[i](out_credit[i]);
+    }
+  }
+};
+
+#endif
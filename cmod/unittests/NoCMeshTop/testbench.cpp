@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NoCMeshTop.h"
+#include <systemc.h>
+#include <mc_scverify.h>
+#include <testbench/nvhls_rand.h>
+#include <nvhls_connections.h>
+
+#define NVHLS_VERIFY_BLOCKS (NoCMeshTop)
+#include <nvhls_verify.h>
+
+#include <algorithm>
+#include <deque>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+// Synthetic traffic on a 4x4 mesh: every node injects fixed-length packets
+// with a Bernoulli process. Each phase runs one (pattern, injection rate)
+// pair and the testbench reports average and 99th percentile packet latency
+// (creation to tail arrival, including source queueing) and accepted
+// throughput per phase.
+
+using namespace ::std;
+typedef NoCMeshTop::Flit_t Flit_t;
+typedef NoCMeshTop::Credit_ret_t Credit_ret_t;
+static const int kXDim = NoCMeshTop::kXDim;
+static const int kYDim = NoCMeshTop::kYDim;
+static const int kNumNodes = kXDim * kYDim;
+static const int kBufferSize = NoCMeshTop::kBufferSize;
+static const int kCoordWidth = NoCMeshTop::kCoordWidth;
+static const int kPacketFlits = 4;
+static const int kPhaseCycles = 2000;
+static const int kDrainCycles = 500;
+// Flit data: <Creation Cycle>:<Source>:<Phase>:...:<Y>:<X>:<Local Dst>
+static const int kPhaseLsb = 16;
+static const int kSrcLsb = 24;
+static const int kCycleLsb = 32;
+
+enum TrafficPattern { Uniform, Transpose, Hotspot };
+static const char* pattern_name[] = {"uniform", "transpose", "hotspot"};
+static const double rates[] = {0.05, 0.1, 0.2, 0.3, 0.4};
+static const int kNumRates = sizeof(rates) / sizeof(rates[0]);
+static const int kNumPhases = 3 * kNumRates;
+
+// Set by the testbench at the start of each phase, -1 stops injection
+int cur_phase = -1;
+unsigned long long cycle = 0;
+vector<vector<unsigned int> > latency(kNumPhases);
+unsigned int sent_cnt = 0, recv_cnt = 0;
+
+int pick_dest(int src, TrafficPattern pattern) {
+  int x = src % kXDim, y = src / kXDim;
+  switch (pattern) {
+    case Transpose:
+      return (x * kXDim + y);
+    case Hotspot:
+      // A fifth of the traffic goes to the node in the middle of the mesh
+      if (rand() % 5 == 0)
+        return (kYDim / 2) * kXDim + kXDim / 2;
+      // fall through
+    default:
+      return rand() % kNumNodes;
+  }
+}
+
+SC_MODULE(Source) {
+  Connections::Out<Flit_t> out;
+  Connections::In<Credit_ret_t> credit;
+  sc_in<bool> clk;
+  sc_in<bool> rst;
+  const int id;
+  int credit_reg;
+
+  void run() {
+    out.Reset();
+    credit.Reset();
+    credit_reg = kBufferSize;
+    deque<Flit_t> queue;
+
+    wait();
+    while (1) {
+      Credit_ret_t temp;
+      if (credit.PopNB(temp))
+        credit_reg += temp;
+
+      if (cur_phase >= 0 &&
+          rand() < rates[cur_phase % kNumRates] / kPacketFlits * RAND_MAX) {
+        int dest = pick_dest(id, TrafficPattern(cur_phase / kNumRates));
+        if (dest != id) {
+          NVUINT64 src = id, phase = cur_phase, now = cycle;
+          NVUINT64 x = dest % kXDim, y = dest / kXDim;
+          Flit_t flit;
+          flit.data = (now << kCycleLsb) | (src << kSrcLsb) |
+                      (phase << kPhaseLsb) | (y << (1 + kCoordWidth)) |
+                      (x << 1) | 1;
+          for (int i = 0; i < kPacketFlits; i++) {
+            flit.flit_id.set((i == 0) ? FlitId2bit::HEAD
+                             : (i == kPacketFlits - 1) ? FlitId2bit::TAIL
+                                                       : FlitId2bit::BODY);
+            queue.push_back(flit);
+          }
+        }
+      }
+
+      if (!queue.empty() && credit_reg > 0 && out.PushNB(queue.front())) {
+        queue.pop_front();
+        credit_reg--;
+        ++sent_cnt;
+      }
+      wait();
+    }
+  }
+
+  SC_HAS_PROCESS(Source);
+  Source(sc_module_name name_, const int& id_)
+      : sc_module(name_),
+        out("out"),
+        credit("credit"),
+        clk("clk"),
+        rst("rst"),
+        id(id_) {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+};
+
+SC_MODULE(Dest) {
+  Connections::In<Flit_t> in;
+  Connections::Out<Credit_ret_t> credit;
+  sc_in<bool> clk;
+  sc_in<bool> rst;
+  const int id;
+  int credit_reg;
+
+  void run() {
+    in.Reset();
+    credit.Reset();
+    credit_reg = 0;
+    // Source of the packet in flight, one packet at a time on a single VC
+    int open_src = -1;
+    Flit_t flit;
+
+    wait();
+    while (1) {
+      if (in.PopNB(flit)) {
+        ++credit_reg;
+        ++recv_cnt;
+        int x = nvhls::get_slc<kCoordWidth>(flit.data, 1).to_int();
+        int y = nvhls::get_slc<kCoordWidth>(flit.data, 1 + kCoordWidth).to_int();
+        int src = nvhls::get_slc<8>(flit.data, kSrcLsb).to_int();
+        if (y * kXDim + x != id)
+          SC_REPORT_ERROR("Dest", "Flit delivered to the wrong node");
+        if (flit.flit_id.isHeader()) {
+          if (open_src != -1)
+            SC_REPORT_ERROR("Dest", "Header flit inside an open packet");
+          open_src = src;
+        } else if (src != open_src) {
+          SC_REPORT_ERROR("Dest", "Flit does not belong to the open packet");
+        }
+        if (flit.flit_id.isTail()) {
+          int phase = nvhls::get_slc<8>(flit.data, kPhaseLsb).to_int();
+          unsigned long long created =
+              nvhls::get_slc<32>(flit.data, kCycleLsb).to_uint64();
+          latency[phase].push_back(cycle - created);
+          open_src = -1;
+        }
+      }
+
+      if (credit_reg > 0) {
+        Credit_ret_t temp = 1;
+        if (credit.PushNB(temp))
+          credit_reg--;
+      }
+      wait();
+    }
+  }
+
+  SC_HAS_PROCESS(Dest);
+  Dest(sc_module_name name_, const int& id_)
+      : sc_module(name_),
+        in("in"),
+        credit("credit"),
+        clk("clk"),
+        rst("rst"),
+        id(id_) {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+};
+
+SC_MODULE(testbench) {
+  NVHLS_DESIGN(NoCMeshTop) noc;
+
+  typedef Connections::Combinational<Credit_ret_t> CreditChan;
+  typedef Connections::Combinational<Flit_t> DataChan;
+
+  sc_clock clk;
+  sc_signal<bool> rst;
+
+  SC_CTOR(testbench)
+      : noc("noc"),
+        clk("clk", 1.0, SC_NS, 0.5, 0, SC_NS, true),
+        rst("rst") {
+
+    Connections::set_sim_clk(&clk);
+
+    noc.clk(clk);
+    noc.rst(rst);
+
+    for (int i = 0; i < kNumNodes; ++i) {
+      ostringstream sname, dname;
+      sname << "source_" << i;
+      dname << "dest_" << i;
+      Source* source = new Source(sname.str().c_str(), i);
+      Dest* dest = new Dest(dname.str().c_str(), i);
+      DataChan* in_chan = new DataChan();
+      DataChan* out_chan = new DataChan();
+      CreditChan* in_credit_chan = new CreditChan();
+      CreditChan* out_credit_chan = new CreditChan();
+
+      source->clk(clk);
+      source->rst(rst);
+      source->out(*in_chan);
+      source->credit(*out_credit_chan);
+      noc.in_port[i](*in_chan);
+      noc.out_credit[i](*out_credit_chan);
+
+      dest->clk(clk);
+      dest->rst(rst);
+      dest->in(*out_chan);
+      dest->credit(*in_credit_chan);
+      noc.out_port[i](*out_chan);
+      noc.in_credit[i](*in_credit_chan);
+    }
+
+    SC_THREAD(count);
+    sensitive << clk.pos();
+    SC_THREAD(run);
+  }
+
+  void count() {
+    while (1) {
+      wait();
+      ++cycle;
+    }
+  }
+
+  void run() {
+    rst = 0;
+    wait(2, SC_NS);
+    rst = 1;
+    for (int phase = 0; phase < kNumPhases; phase++) {
+      cur_phase = phase;
+      wait(kPhaseCycles, SC_NS);
+      // Stop injection so that the next phase starts from an empty network
+      // as far as possible; packets keep their phase in the flit data
+      cur_phase = -1;
+      wait(kDrainCycles, SC_NS);
+    }
+    wait(20 * kDrainCycles, SC_NS);
+
+    cout << setw(10) << "pattern" << setw(8) << "rate" << setw(10)
+         << "accepted" << setw(10) << "avg_lat" << setw(10) << "p99_lat"
+         << endl;
+    for (int phase = 0; phase < kNumPhases; phase++) {
+      vector<unsigned int>& lat = latency[phase];
+      sort(lat.begin(), lat.end());
+      double sum = 0;
+      for (unsigned i = 0; i < lat.size(); i++)
+        sum += lat[i];
+      double accepted =
+          double(lat.size() * kPacketFlits) / (kNumNodes * kPhaseCycles);
+      cout << setw(10) << pattern_name[phase / kNumRates] << setw(8)
+           << rates[phase % kNumRates] << setw(10) << setprecision(3)
+           << accepted << setw(10)
+           << (lat.empty() ? 0 : sum / lat.size()) << setw(10)
+           << (lat.empty() ? 0 : lat[(lat.size() * 99) / 100]) << endl;
+    }
+    cout << "sent flits = " << sent_cnt << ", received flits = " << recv_cnt
+         << endl;
+    if (sent_cnt != recv_cnt)
+      SC_REPORT_ERROR("testbench", "Flits lost in the network");
+    sc_stop();
+  }
+};
+
+int sc_main(int argc, char* argv[]) {
+  nvhls::set_random_seed();
+  testbench my_testbench("my_testbench");
+  sc_report_handler::set_actions(SC_ERROR, SC_DISPLAY);
+  sc_start();
+  bool rc = (sc_report_handler::get_count(SC_ERROR) > 0);
+  if (rc)
+    cout << "Simulation FAILED\n";
+  else
+    cout << "Simulation PASSED\n";
+  return rc;
+};
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <nvhls_array.h>
+#include <nvhls_types.h>
+#include <TypeToBits.h>
+#include <testbench/nvhls_rand.h>
+
+// Built with NVHLS_ARRAY_PACKED: checks that nv_arrays of narrow elements are
+// packed, that their element proxies behave like the element type and that
+// Marshall() keeps the element-by-element layout.
+
+#define NUM_ITERS 2000
+
+template <typename Type, unsigned int Len>
+int CheckArray(const char* name) {
+  static const int W = Wrapped<Type>::width;
+  typedef nvhls::nv_array<Type, Len> Array;
+  int errors = 0;
+  Array a;
+  Type ref[Len];
+  for (unsigned int i = 0; i < Len; i++) {
+    ref[i] = 0;
+    if (a[i] != ref[i]) errors++;
+  }
+  for (int it = 0; it < NUM_ITERS; it++) {
+    unsigned int i = rand() % Len;
+    unsigned int v = rand();
+    switch (rand() % 6) {
+      case 0:
+        a[i] = v;
+        ref[i] = v;
+        break;
+      case 1:
+        a[i] += v;
+        ref[i] += v;
+        break;
+      case 2:
+        a[i] ^= v;
+        ref[i] ^= v;
+        break;
+      case 3:
+        a[i]++;
+        ref[i]++;
+        break;
+      case 4:
+        a[i] = a[(i + 1) % Len];
+        ref[i] = ref[(i + 1) % Len];
+        break;
+      default: {
+        Type t = a[i];
+        if (t != ref[i] || !(a[i] == ref[i]) || (a[i] < ref[i])) errors++;
+      }
+    }
+  }
+
+  Array b(a), c;
+  c = a;
+  const Array& cr = c;
+  NVUINTW(Array::width) bits = 0;
+  for (unsigned int i = 0; i < Len; i++) {
+    if (a[i] != ref[i] || b[i] != ref[i] || cr[i] != ref[i]) errors++;
+    bits = nvhls::set_slc(bits, TypeToNVUINT(ref[i]), i * W);
+  }
+  Array d = NVUINTToType<Array>(bits);
+  if (TypeToNVUINT(a) != bits || nvhls::type_bits<Array, false>::ToBits(a) != TypeToBits(bits))
+    errors++;
+  for (unsigned int i = 0; i < Len; i++) {
+    if (d[i] != ref[i]) errors++;
+  }
+
+  cout << name << ": " << (nvhls::nv_array_packed<Type>::value ? "packed" : "unpacked")
+       << ", " << sizeof(Array) << " bytes vs " << sizeof(ref) << ", " << errors
+       << " mismatches" << endl;
+  return errors;
+}
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  int errors = 0;
+  errors += CheckArray<NVUINTW(1), 100>("NVUINT1 x 100");
+  errors += CheckArray<NVUINTW(3), 50>("NVUINT3 x 50");
+  errors += CheckArray<NVUINTW(8), 17>("NVUINT8 x 17");
+  errors += CheckArray<NVINTW(5), 40>("NVINT5 x 40");
+  errors += CheckArray<NVUINTW(16), 9>("NVUINT16 x 9");
+  errors += CheckArray<NVUINTW(16), 300>("NVUINT16 x 300");
+
+  if (!nvhls::nv_array_packed<NVUINTW(8)>::value || !nvhls::nv_array_packed<bool>::value ||
+      nvhls::nv_array_packed<NVUINTW(16)>::value ||
+      sizeof(nvhls::nv_array<NVUINTW(1), 128>) != 2 * sizeof(uint64)) {
+    cout << "Unexpected packing" << endl;
+    errors++;
+  }
+  nvhls::nv_array<bool, 70> flags;
+  flags[69] = true;
+  flags[3] = flags[69];
+  if (!flags[3] || flags[4] || !(flags[69] == true)) errors++;
+
+  if (errors != 0) {
+    DCOUT("TESTBENCH FAIL" << endl);
+  } else {
+    DCOUT("TESTBENCH PASS" << endl);
+  }
+  return errors != 0;
+}
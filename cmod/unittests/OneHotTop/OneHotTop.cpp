@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <hls_globals.h>
+#include <one_hot_to_bin.h>
+#include "OneHotTop.h"
+
+void OneHotTop(const OneHot& one_hot_in, const Index& bin_in, Index& bin_out,
+               OneHot& one_hot_out) {
+  one_hot_to_bin<NUM_BITS, nvhls::index_width<NUM_BITS>::val>(one_hot_in, bin_out);
+  bin_to_one_hot<nvhls::index_width<NUM_BITS>::val, NUM_BITS>(bin_in, one_hot_out);
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <match_scverify.h>
+#include <testbench/nvhls_rand.h>
+#include <Arbiter.h>
+#include <one_hot_to_bin.h>
+
+#include "OneHotTop.h"
+
+#ifndef NUM_ITERS
+#define NUM_ITERS 1000
+#endif
+
+// Checks one_hot_to_bin, bin_to_one_hot and arbitrate_and_encode for a
+// OneHotLen-bit vector and a BinLen-bit index
+template <unsigned OneHotLen, unsigned BinLen>
+void check_width()
+{
+    typedef NVUINTW(OneHotLen) Vec;
+    typedef NVUINTW(BinLen) Bin;
+    Arbiter<OneHotLen> arbiter;
+    for (int i = 0; i < NUM_ITERS; ++i)
+    {
+        // One-hot and random vectors; the index of a vector with several
+        // bits set is the OR of their indices
+        Vec data = 0;
+        unsigned pos = rand() % OneHotLen;
+        data[pos] = 1;
+        if (rand() & 0x1) data = nvhls::get_rand<OneHotLen>();
+        unsigned ref = 0;
+        for (unsigned b = 0; b < OneHotLen; ++b)
+        {
+            if (data[b] != 0) ref |= b;
+        }
+        ref &= (1u << BinLen) - 1;
+        Bin bin;
+        one_hot_to_bin<OneHotLen, BinLen>(data, bin);
+        assert(static_cast<unsigned>(bin) == ref);
+
+        // Decoding, including indices beyond OneHotLen
+        Bin bin_in = nvhls::get_rand<BinLen>();
+        Vec one_hot;
+        bin_to_one_hot<BinLen, OneHotLen>(bin_in, one_hot);
+        for (unsigned b = 0; b < OneHotLen; ++b)
+        {
+            assert(one_hot[b] == (b == static_cast<unsigned>(bin_in)));
+        }
+
+        // Fused arbitration matches pick() and one_hot_to_bin
+        Arbiter<OneHotLen> arbiter_ref = arbiter;
+        Vec valid = nvhls::get_rand<OneHotLen>();
+        Vec grant, grant_ref = arbiter_ref.pick(valid);
+        Bin grant_id, grant_id_ref;
+        one_hot_to_bin<OneHotLen, BinLen>(grant_ref, grant_id_ref);
+        bool granted = arbitrate_and_encode<OneHotLen, BinLen>(arbiter, valid, grant, grant_id);
+        assert(granted == (valid != 0));
+        assert(grant == grant_ref);
+        assert(grant_id == grant_id_ref);
+    }
+}
+
+CCS_MAIN(int argc, char *argv[]) 
+{
+    nvhls::set_random_seed();
+
+    for (int i = 0; i < NUM_ITERS; ++i) 
+    { 
+        OneHot one_hot_in = 0;
+        unsigned pos = rand() % NUM_BITS;
+        one_hot_in[pos] = 1;
+        Index bin_in = rand() % NUM_BITS;
+        Index bin_out;
+        OneHot one_hot_out;
+
+        CCS_DESIGN(OneHotTop)(one_hot_in, bin_in, bin_out, one_hot_out);
+        assert(static_cast<unsigned>(bin_out) == pos);
+        OneHot one_hot_ref = 0;
+        one_hot_ref[static_cast<unsigned>(bin_in)] = 1;
+        assert(one_hot_out == one_hot_ref);
+    }
+
+    check_width<1, 1>();
+    check_width<2, 1>();
+    check_width<5, 3>();
+    check_width<8, 3>();
+    check_width<8, 2>();
+    check_width<13, 5>();
+    check_width<64, 6>();
+    check_width<100, 7>();
+
+    DCOUT("CMODEL PASS" << endl);
+    CCS_RETURN(0) ;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <testbench/Pacer.h>
+#include <testbench/nvhls_rand.h>
+#include <cmath>
+
+// Checks that nvhls::GeometricPacer matches the stall statistics of the
+// per-cycle Markov model of the Connections Pacer, draws far fewer random
+// numbers than it has cycles, and is reproducible per name.
+
+#define NUM_CYCLES 1000000
+
+// Per-cycle reference of the stall_prob/hold_stall_prob model
+class ReferencePacer {
+ public:
+  ReferencePacer(double stall_prob, double hold_stall_prob)
+      : stall_prob_(stall_prob), hold_stall_prob_(hold_stall_prob), stalled_(false), rng_("ref") {}
+  bool tic() {
+    double rnd = static_cast<double>(rng_.next() >> 11) / 9007199254740992.0;
+    stalled_ = stalled_ ? (rnd < hold_stall_prob_) : (rnd < stall_prob_);
+    return stalled_;
+  }
+
+ private:
+  double stall_prob_, hold_stall_prob_;
+  bool stalled_;
+  nvhls::RandStream rng_;
+};
+
+struct Summary {
+  double stall_rate;
+  double mean_stall_len;
+  double mean_run_len;
+};
+
+template <typename P>
+Summary Run(P& pacer) {
+  unsigned long stalled = 0, stalls = 0, runs = 0;
+  bool prev = true;
+  for (int i = 0; i < NUM_CYCLES; i++) {
+    bool s = pacer.tic();
+    stalled += s;
+    if (s && !prev) stalls++;
+    if (!s && prev) runs++;
+    prev = s;
+  }
+  Summary sum;
+  sum.stall_rate = static_cast<double>(stalled) / NUM_CYCLES;
+  sum.mean_stall_len = stalls ? static_cast<double>(stalled) / stalls : 0;
+  sum.mean_run_len = runs ? static_cast<double>(NUM_CYCLES - stalled) / runs : 0;
+  return sum;
+}
+
+bool Close(double a, double b) { return std::fabs(a - b) <= 0.04 * std::fmax(1.0, std::fabs(b)); }
+
+int Check(float stall_prob, float hold_stall_prob) {
+  std::stringstream name;
+  name << "pacer_" << stall_prob << "_" << hold_stall_prob;
+  nvhls::GeometricPacer pacer(stall_prob, hold_stall_prob, name.str());
+  ReferencePacer ref(stall_prob, hold_stall_prob);
+  Summary g = Run(pacer);
+  Summary r = Run(ref);
+  const nvhls::GeometricPacer::Stats& st = pacer.GetStats();
+  int errors = 0;
+  if (!Close(g.stall_rate, r.stall_rate) || !Close(g.mean_stall_len, r.mean_stall_len) ||
+      !Close(g.mean_run_len, r.mean_run_len))
+    errors++;
+  if (st.cycles != NUM_CYCLES || st.draws > 2 * st.stalls + 2) errors++;
+  cout << name.str() << ": stall rate " << g.stall_rate << " (ref " << r.stall_rate
+       << "), stall length " << g.mean_stall_len << " (ref " << r.mean_stall_len
+       << "), run length " << g.mean_run_len << " (ref " << r.mean_run_len << "), "
+       << st.draws << " draws" << endl;
+  return errors;
+}
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  int errors = 0;
+  errors += Check(0.3, 0.7);
+  errors += Check(0.2, 0.5);
+  errors += Check(0.05, 0.9);
+  errors += Check(0.5, 0.0);
+  errors += Check(1.0, 0.0);
+
+  // Never stalls, and never draws after reset
+  nvhls::GeometricPacer never(0.0, 0.5, "never");
+  for (int i = 0; i < 1000; i++) {
+    if (never.tic()) errors++;
+  }
+  if (never.GetStats().draws != 0) errors++;
+
+  // Same name, same pattern; copies share statistics
+  nvhls::GeometricPacer a(0.3, 0.7, "tb.a"), b(0.3, 0.7, "tb.b");
+  nvhls::GeometricPacer a2(a);
+  a2.SetName("tb.a");
+  int diff_ab = 0;
+  for (int i = 0; i < 1000; i++) {
+    bool sa = a.tic();
+    if (sa != a2.tic()) errors++;
+    if (sa != b.tic()) diff_ab++;
+  }
+  if (diff_ab == 0 || a.GetStats().cycles != 2000) errors++;
+
+  nvhls::GeometricPacer::PrintAllStats(cout);
+  if (errors != 0) {
+    DCOUT("TESTBENCH FAIL" << endl);
+  } else {
+    DCOUT("TESTBENCH PASS" << endl);
+  }
+  return errors != 0;
+}
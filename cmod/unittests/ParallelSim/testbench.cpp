@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <nvhls_parallel_sim.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+// A ring of tiles, one partition each.  Every tile injects tokens, does a
+// fixed amount of integer work per token it receives and forwards the token
+// until it has visited every tile.  The run with one thread is the reference
+// for the run with several threads, which must produce identical checksums.
+
+static const unsigned int kTiles = 16;
+static const unsigned int kWork = 1024;
+static const uint64_t kCycles = 20000;
+static const uint64_t kStopCycle = 12345;
+
+struct Token {
+  unsigned int origin;
+  unsigned int hops;
+  uint64_t value;
+};
+
+class Tile : public match::CycleProcess {
+ public:
+  Tile(match::ParallelSim& sim_, unsigned int id_, match::CycleChannel<Token>& in_,
+       match::CycleChannel<Token>& out_)
+      : sim(sim_), id(id_), in(in_), out(out_) {}
+
+  uint64_t checksum;
+  uint64_t delivered;
+
+  void Reset() {
+    checksum = id;
+    delivered = 0;
+    injected = 0;
+    held = false;
+  }
+
+  void Eval() {
+    if (!held) {
+      if (in.PopNB(reg)) {
+        for (unsigned int i = 0; i < kWork; i++) {
+          reg.value = reg.value * 6364136223846793005ULL + 1442695040888963407ULL;
+        }
+        checksum ^= reg.value + id;
+        if (++reg.hops == kTiles) {
+          delivered++;
+        } else {
+          held = true;
+        }
+      } else if (!out.Full()) {
+        reg.origin = id;
+        reg.hops = 0;
+        reg.value = (static_cast<uint64_t>(id) << 32) | injected++;
+        held = true;
+      }
+    }
+    if (held && out.PushNB(reg)) {
+      held = false;
+    }
+    if (id == 0 && sim.Cycle() == kStopCycle) {
+      sim.Stop();
+    }
+  }
+
+ private:
+  match::ParallelSim& sim;
+  unsigned int id;
+  match::CycleChannel<Token>& in;
+  match::CycleChannel<Token>& out;
+  Token reg;
+  bool held;
+  uint64_t injected;
+};
+
+struct Result {
+  std::vector<uint64_t> checksum;
+  uint64_t delivered;
+  uint64_t cycles;
+  double wall_s;
+};
+
+static Result RunRing(unsigned int threads, uint64_t cycles) {
+  match::ParallelSim sim;
+  sim.SetNumThreads(threads);
+  std::vector<match::CycleChannel<Token>*> chan;
+  std::vector<Tile*> tile;
+  for (unsigned int i = 0; i < kTiles; i++) {
+    chan.push_back(new match::CycleChannel<Token>(sim, i));
+  }
+  for (unsigned int i = 0; i < kTiles; i++) {
+    tile.push_back(new Tile(sim, i, *chan[i], *chan[(i + 1) % kTiles]));
+    sim.Add(tile[i], i);
+  }
+  sim.Reset();
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  Result r;
+  r.cycles = sim.Run(cycles);
+  r.wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  r.delivered = 0;
+  for (unsigned int i = 0; i < kTiles; i++) {
+    r.checksum.push_back(tile[i]->checksum);
+    r.delivered += tile[i]->delivered;
+    delete tile[i];
+    delete chan[i];
+  }
+  std::cout << "threads=" << threads << " cycles=" << r.cycles << " delivered=" << r.delivered
+            << " wall_s=" << r.wall_s
+            << " cycles_per_s=" << (r.wall_s > 0 ? r.cycles / r.wall_s : 0) << std::endl;
+  return r;
+}
+
+int sc_main(int argc, char *argv[]) {
+  bool pass = true;
+  unsigned int threads = match::ParallelSim().NumThreads();
+  if (threads < 2) threads = 4;
+
+  // Stop() ends the run after the cycle in which it is called
+  Result ref = RunRing(1, kCycles);
+  Result par = RunRing(threads, kCycles);
+  pass &= (ref.cycles == kStopCycle + 1) && (par.cycles == kStopCycle + 1);
+  pass &= (ref.delivered > 0) && (ref.delivered == par.delivered);
+  pass &= (ref.checksum == par.checksum);
+
+  // More threads than partitions
+  Result over = RunRing(2 * kTiles, kCycles);
+  pass &= (over.checksum == ref.checksum);
+
+  if (ref.wall_s > 0 && par.wall_s > 0)
+    std::cout << "speedup with " << threads << " threads: " << ref.wall_s / par.wall_s << std::endl;
+
+  if (pass)
+    std::cout << "TESTBENCH PASS" << std::endl;
+  else
+    std::cout << "TESTBENCH FAIL" << std::endl;
+  return pass ? 0 : 1;
+}
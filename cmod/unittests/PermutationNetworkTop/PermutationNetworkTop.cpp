@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <permutation_network.h>
+#include <hls_globals.h>
+#include "PermutationNetworkTop.h"
+
+void PermutationNetworkTop(
+    DATA_TYPE data_in[NUM_LANES],
+    bool valid_in[NUM_LANES],
+    Src_t source[NUM_LANES],
+    bool valid_source[NUM_LANES],
+    DATA_TYPE data_out[NUM_LANES],
+    bool valid_out[NUM_LANES])
+{
+    static BenesNetwork<DATA_TYPE, NUM_LANES, NUM_PIPELINE_STAGES> network;
+    network.run(data_in, valid_in, source, valid_source, data_out, valid_out);
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PERMUTATION_NETWORK_TOP_H
+#define PERMUTATION_NETWORK_TOP_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <permutation_network.h>
+#include <hls_globals.h>
+
+#ifndef NUM_LANES
+#define NUM_LANES 16
+#endif
+
+#ifndef NUM_PIPELINE_STAGES
+#define NUM_PIPELINE_STAGES 2
+#endif
+
+#ifndef DATA_TYPE
+#define DATA_TYPE NVINT32
+#endif
+
+typedef NVUINTC(nvhls::index_width<NUM_LANES>::val) Src_t;
+
+void PermutationNetworkTop(
+    DATA_TYPE data_in[NUM_LANES],
+    bool valid_in[NUM_LANES],
+    Src_t source[NUM_LANES],
+    bool valid_source[NUM_LANES],
+    DATA_TYPE data_out[NUM_LANES],
+    bool valid_out[NUM_LANES]);
+
+#endif
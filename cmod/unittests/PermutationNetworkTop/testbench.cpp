@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <match_scverify.h>
+#include <testbench/nvhls_rand.h>
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "PermutationNetworkTop.h"
+
+#ifndef NUM_ITERS
+#define NUM_ITERS 1000
+#endif
+
+typedef DATA_TYPE Word_t;
+
+struct Expected {
+  Word_t data[NUM_LANES];
+  bool valid[NUM_LANES];
+};
+
+// crossbar() behavior, except that only the lowest output selecting an input
+// is valid
+Expected Reference(Word_t data_in[NUM_LANES], bool valid_in[NUM_LANES],
+                   Src_t source[NUM_LANES], bool valid_source[NUM_LANES]) {
+  Expected e;
+  bool used[NUM_LANES] = {};
+  for (unsigned out = 0; out < NUM_LANES; out++) {
+    unsigned in = source[out].to_uint64();
+    e.valid[out] = valid_source[out] && !used[in] && valid_in[in];
+    e.data[out] = e.valid[out] ? data_in[in] : Word_t(0);
+    if (valid_source[out]) used[in] = true;
+  }
+  return e;
+}
+
+CCS_MAIN(int argc, char *argv[]) {
+
+  nvhls::set_random_seed();
+
+  Word_t data_in[NUM_LANES];
+  Src_t source[NUM_LANES];
+  Word_t data_out[NUM_LANES];
+  bool valid_in[NUM_LANES];
+  bool valid_src[NUM_LANES];
+  bool valid_out[NUM_LANES];
+  std::deque<Expected> expected;
+  int errors = 0;
+
+  for (int test = 0; test < NUM_ITERS + NUM_PIPELINE_STAGES; test++) {
+    std::vector<unsigned> perm(NUM_LANES);
+    for (unsigned i = 0; i < NUM_LANES; i++) perm[i] = i;
+    std::random_shuffle(perm.begin(), perm.end());
+    for (unsigned i = 0; i < NUM_LANES; i++) {
+      data_in[i] = rand();
+      valid_in[i] = rand() % 4;
+      valid_src[i] = rand() % 8;
+      // Mostly full permutations, sometimes arbitrary selections
+      source[i] = (test % 4 == 0) ? unsigned(rand() % NUM_LANES) : perm[i];
+    }
+    if (test < NUM_ITERS) {
+      expected.push_back(Reference(data_in, valid_in, source, valid_src));
+    }
+
+    CCS_DESIGN(PermutationNetworkTop)(data_in, valid_in, source, valid_src, data_out, valid_out);
+
+    if (test >= NUM_PIPELINE_STAGES) {
+      Expected e = expected.front();
+      expected.pop_front();
+      for (unsigned out = 0; out < NUM_LANES; out++) {
+        if (valid_out[out] != e.valid[out] || data_out[out] != e.data[out]) {
+          DCOUT("ERROR: test " << test << " output " << out << ": " << data_out[out]
+                << " valid " << valid_out[out] << ", expected " << e.data[out]
+                << " valid " << e.valid[out] << endl);
+          errors++;
+        }
+      }
+    }
+  }
+
+  // The butterfly routes every cyclic shift and every XOR of the lane index
+  for (unsigned k = 0; k < NUM_LANES; k++) {
+    for (int xor_perm = 0; xor_perm < 2; xor_perm++) {
+      for (unsigned i = 0; i < NUM_LANES; i++) {
+        data_in[i] = rand();
+        valid_in[i] = true;
+        valid_src[i] = true;
+        source[i] = xor_perm ? (i ^ k) : ((i + k) % NUM_LANES);
+      }
+      bool routed = butterfly<Word_t, NUM_LANES>(data_in, valid_in, source, valid_src, data_out, valid_out);
+      Expected e = Reference(data_in, valid_in, source, valid_src);
+      for (unsigned out = 0; out < NUM_LANES; out++) {
+        if (!routed || !valid_out[out] || data_out[out] != e.data[out]) {
+          DCOUT("ERROR: butterfly " << (xor_perm ? "xor " : "shift ") << k << " output " << out << endl);
+          errors++;
+        }
+      }
+    }
+  }
+
+  // Other selections: the outputs that the butterfly reports valid are right
+  for (int test = 0; test < NUM_ITERS; test++) {
+    for (unsigned i = 0; i < NUM_LANES; i++) {
+      data_in[i] = rand();
+      valid_in[i] = rand() % 4;
+      valid_src[i] = rand() % 2;
+      source[i] = rand() % NUM_LANES;
+    }
+    butterfly<Word_t, NUM_LANES>(data_in, valid_in, source, valid_src, data_out, valid_out);
+    Expected e = Reference(data_in, valid_in, source, valid_src);
+    for (unsigned out = 0; out < NUM_LANES; out++) {
+      if (valid_out[out] ? (!e.valid[out] || data_out[out] != e.data[out]) : (data_out[out] != 0)) {
+        DCOUT("ERROR: butterfly test " << test << " output " << out << endl);
+        errors++;
+      }
+    }
+  }
+
+  if (errors == 0) {
+    DCOUT("CMODEL PASS" << endl);
+  } else {
+    DCOUT("CMODEL FAIL: " << errors << " errors" << endl);
+  }
+  CCS_RETURN(errors != 0);
+}
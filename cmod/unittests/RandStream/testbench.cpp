@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <nvhls_types.h>
+#include <testbench/nvhls_rand.h>
+#include <boost/random/uniform_int_distribution.hpp>
+
+// Checks that nvhls::RandStream sequences depend only on the seed and the
+// stream name, that streams do not interfere with each other or with rand(),
+// and that the typed generators fill every bit.
+
+#define NUM_DRAWS 10000
+
+struct Payload {
+  NVUINTW(7) a;
+  NVUINTW(90) b;
+  static const unsigned int width = 97;
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& a;
+    m& b;
+  }
+};
+
+int sc_main(int argc, char *argv[]) {
+  unsigned int seed = nvhls::set_random_seed();
+  int errors = 0;
+
+  // Same seed and name: same sequence, however the draws are interleaved with
+  // other streams and with rand()
+  nvhls::RandStream a("tb.src0"), b("tb.src1"), a2(seed, "tb.src0");
+  int same_ab = 0;
+  for (int i = 0; i < NUM_DRAWS; i++) {
+    uint64 va = a.next();
+    if (i % 3 == 0) {
+      b.next();
+      rand();
+    }
+    if (va != a2.next()) errors++;
+    if (va == b.next()) same_ab++;
+  }
+  if (same_ab != 0) errors++;
+
+  // Known first output for seed 1, to catch platform or algorithm changes
+  uint64 first = nvhls::RandStream(1, "tb.src0").next();
+  if (first != 0x312e31fb395cd557ull || first == nvhls::RandStream(2, "tb.src0").next())
+    errors++;
+
+  // uniform() stays in range and hits every value
+  int hist[10] = {0};
+  for (int i = 0; i < NUM_DRAWS; i++) {
+    unsigned int v = a.uniform(10);
+    if (v >= 10) errors++;
+    else hist[v]++;
+  }
+  for (int i = 0; i < 10; i++) {
+    if (hist[i] < NUM_DRAWS / 20) errors++;
+  }
+
+  // Typed generators set every bit
+  NVUINTW(130) or_bits = 0, and_bits = ~NVUINTW(130)(0);
+  NVUINTW(7) or_a = 0;
+  for (int i = 0; i < 200; i++) {
+    NVUINTW(130) v = a.get_rand<130>();
+    or_bits |= v;
+    and_bits &= v;
+    or_a |= a.gen_random_payload<Payload>().a;
+  }
+  if (or_bits != ~NVUINTW(130)(0) || and_bits != 0 || or_a != 0x7f) errors++;
+
+  // Works as a Boost uniform random bit generator
+  boost::random::uniform_int_distribution<> dist(3, 5);
+  for (int i = 0; i < 100; i++) {
+    int v = dist(a);
+    if (v < 3 || v > 5) errors++;
+  }
+
+  if (errors != 0) {
+    DCOUT("TESTBENCH FAIL" << endl);
+  } else {
+    DCOUT("TESTBENCH PASS" << endl);
+  }
+  return errors != 0;
+}
@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <RegFile.h>
+#include <hls_globals.h>
+#include "RegFileTop.h"
+
+void RegFileTop(addr_t read_addr[NUM_READ_PORTS], data_t read_data[NUM_READ_PORTS],
+                addr_t write_addr[NUM_WRITE_PORTS], bool write_en[NUM_WRITE_PORTS],
+                data_t write_data[NUM_WRITE_PORTS]) {
+  static regfile_t regfile;
+  regfile.run(read_addr, read_data, write_addr, write_en, write_data);
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef REGFILE_TOP_H
+#define REGFILE_TOP_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <RegFile.h>
+#include <hls_globals.h>
+
+#ifndef NUM_ENTRIES
+#define NUM_ENTRIES 32
+#endif
+
+#ifndef NUM_READ_PORTS
+#define NUM_READ_PORTS 4
+#endif
+
+#ifndef NUM_WRITE_PORTS
+#define NUM_WRITE_PORTS 2
+#endif
+
+#ifndef REGFILE_IMPL
+#define REGFILE_IMPL RegFileFlops
+#endif
+
+#ifndef FORWARDING
+#define FORWARDING true
+#endif
+
+typedef NVUINT32 data_t;
+typedef RegFile<data_t, NUM_ENTRIES, NUM_READ_PORTS, NUM_WRITE_PORTS, REGFILE_IMPL, FORWARDING> regfile_t;
+typedef regfile_t::Address addr_t;
+
+void RegFileTop(addr_t read_addr[NUM_READ_PORTS], data_t read_data[NUM_READ_PORTS],
+                addr_t write_addr[NUM_WRITE_PORTS], bool write_en[NUM_WRITE_PORTS],
+                data_t write_data[NUM_WRITE_PORTS]);
+
+#endif
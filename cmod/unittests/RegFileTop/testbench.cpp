@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <match_scverify.h>
+#include <testbench/nvhls_rand.h>
+
+#include "RegFileTop.h"
+
+#ifndef NUM_ITERS
+#define NUM_ITERS 10000
+#endif
+
+// Reference model: reads see the previous cycle's state, or with forwarding
+// the highest-numbered write port writing the same entry in this cycle
+unsigned ref_regs[NUM_ENTRIES];
+
+void reference_regfile(addr_t read_addr[NUM_READ_PORTS], unsigned ref_data[NUM_READ_PORTS],
+                       addr_t write_addr[NUM_WRITE_PORTS], bool write_en[NUM_WRITE_PORTS],
+                       data_t write_data[NUM_WRITE_PORTS])
+{
+    for (unsigned r = 0; r < NUM_READ_PORTS; r++) {
+        ref_data[r] = ref_regs[read_addr[r].to_uint()];
+        if (FORWARDING) {
+            for (unsigned w = 0; w < NUM_WRITE_PORTS; w++) {
+                if (write_en[w] && write_addr[w] == read_addr[r]) {
+                    ref_data[r] = write_data[w].to_uint();
+                }
+            }
+        }
+    }
+    for (unsigned w = 0; w < NUM_WRITE_PORTS; w++) {
+        if (write_en[w]) {
+            ref_regs[write_addr[w].to_uint()] = write_data[w].to_uint();
+        }
+    }
+}
+
+CCS_MAIN(int argc, char *argv[]) {
+    nvhls::set_random_seed();
+    addr_t read_addr[NUM_READ_PORTS], write_addr[NUM_WRITE_PORTS];
+    data_t read_data[NUM_READ_PORTS], write_data[NUM_WRITE_PORTS];
+    bool write_en[NUM_WRITE_PORTS];
+    unsigned ref_data[NUM_READ_PORTS];
+
+    // Initialize every entry through write port 0, so that reads never
+    // return undefined contents
+    for (unsigned i = 0; i < NUM_ENTRIES; i++) {
+        for (unsigned r = 0; r < NUM_READ_PORTS; r++) {
+            read_addr[r] = 0;
+        }
+        for (unsigned w = 0; w < NUM_WRITE_PORTS; w++) {
+            write_en[w] = (w == 0);
+            write_addr[w] = i;
+            write_data[w] = i;
+        }
+        CCS_DESIGN(RegFileTop)(read_addr, read_data, write_addr, write_en, write_data);
+        reference_regfile(read_addr, ref_data, write_addr, write_en, write_data);
+    }
+
+    for (int i = 0; i < NUM_ITERS; i++) {
+        // A small address window makes read/write and write/write
+        // collisions frequent
+        unsigned window = (i % 2 == 0) ? 4 : NUM_ENTRIES;
+        for (unsigned r = 0; r < NUM_READ_PORTS; r++) {
+            read_addr[r] = rand() % window;
+        }
+        for (unsigned w = 0; w < NUM_WRITE_PORTS; w++) {
+            write_en[w] = (rand() % 4) != 0;
+            write_addr[w] = rand() % window;
+            write_data[w] = nvhls::get_rand<32>();
+        }
+        CCS_DESIGN(RegFileTop)(read_addr, read_data, write_addr, write_en, write_data);
+        reference_regfile(read_addr, ref_data, write_addr, write_en, write_data);
+        for (unsigned r = 0; r < NUM_READ_PORTS; r++) {
+            if (read_data[r].to_uint() != ref_data[r]) {
+                DCOUT("Mismatch iter=" << i << " port=" << r << " addr=" << read_addr[r]
+                      << " data=" << read_data[r] << " ref=" << ref_data[r] << endl);
+                assert(0);
+            }
+        }
+    }
+
+    DCOUT("CMODEL PASS" << endl);
+    CCS_RETURN(0) ;
+}
@@ -33,6 +33,10 @@
 #define ROB_INFLIGHT 3 
 #endif
 
+#ifndef ROB_ID_ALLOC
+#define ROB_ID_ALLOC RobIdLinear
+#endif
+
 
 enum RobOp {
     canAccept=0,
@@ -46,7 +50,7 @@ enum RobOp {
 };
 
 typedef ROB_DATA DataType;
-typedef ReorderBuf<DataType, ROB_DEPTH, ROB_INFLIGHT> Rob;
+typedef ReorderBuf<DataType, ROB_DEPTH, ROB_INFLIGHT, ROB_ID_ALLOC> Rob;
 typedef NVUINTC(nvhls::nbits<MAXOP -1 >::val) OpType;
 
 void ReorderBufTop( const OpType& op, 
@@ -19,11 +19,17 @@
 #include <testbench/nvhls_rand.h>
 
 #include <deque>
+#include <ctime>
+#include <vector>
 
 #ifndef NUM_ITER
 #define NUM_ITER 10000
 #endif
 
+#ifndef NUM_BENCH_OPS
+#define NUM_BENCH_OPS 100000
+#endif
+
 
 template <typename Data, unsigned int Depth, unsigned int InFlight>
 class RobRef
@@ -160,6 +166,152 @@ OpType semi_rand_op(Ref& ref)
     return op;
 }
 
+// Random test of ReorderBufWide against RobRef: every cycle may add one
+// request, up to M responses and pop up to M ready entries
+template <unsigned int Depth, unsigned int InFlight, unsigned int M>
+void test_wide_rob()
+{
+    typedef ReorderBufWide<ROB_DATA, Depth, InFlight, M, ROB_ID_ALLOC> WideRob;
+    typedef RobRef<ROB_DATA, Depth, InFlight> WideRef;
+    WideRob rob;
+    WideRef ref;
+    unsigned long long popped = 0;
+
+    for (int i=0; i< NUM_ITER; ++i)
+    {
+        assert(rob.canAcceptRequest() == ref.canAcceptRequest());
+        if (ref.canAcceptRequest() && (rand()%4 != 0)) {
+            ref.addRequest(rob.addRequest());
+        }
+
+        typename WideRob::Id rsp_id[M];
+        ROB_DATA rsp_data[M];
+        bool rsp_valid[M];
+        for (unsigned k = 0; k < M; k++) {
+            rsp_valid[k] = ref.waitsForAnyResponse() && (rand()%2 == 0);
+            if (rsp_valid[k]) {
+                rsp_id[k] = ref.randomPendingResponseId();
+                rsp_data[k] = rand();
+                ref.addResponse(rsp_id[k], rsp_data[k]);
+            }
+        }
+        rob.addResponses(rsp_id, rsp_data, rsp_valid);
+
+        assert(rob.topResponseReady() == ref.topResponseReady());
+        ROB_DATA out_data[M];
+        unsigned num = rob.popResponses(out_data);
+        for (unsigned k = 0; k < num; k++) {
+            assert(out_data[k] == ref.popResponse());
+        }
+        // All ready head entries up to M must have been drained
+        assert((num == M) || !ref.topResponseReady());
+        assert(rob.isEmpty() == ref.isEmpty());
+        popped += num;
+    }
+    DCOUT("ReorderBufWide<" << Depth << ", " << InFlight << ", " << M << ">: "
+          << popped / static_cast<double>(NUM_ITER) << " entries popped per cycle" << endl);
+}
+
+// Random test of ReorderBufStreams against one RobRef per stream: every
+// cycle may add a request to a random stream, add a response and pop a
+// ready entry, either of any ready stream or of a random stream. Counts the
+// pops whose entry is not the oldest one in the buffer, which a single
+// in-order ReorderBuf would have blocked.
+template <unsigned int Depth, unsigned int InFlight, unsigned int Streams>
+void test_stream_rob()
+{
+    typedef ReorderBufStreams<ROB_DATA, Depth, InFlight, Streams, ROB_ID_ALLOC> StreamRob;
+    typedef RobRef<ROB_DATA, Depth, InFlight> StreamRef;
+    StreamRob rob;
+    std::vector<StreamRef> ref(Streams);
+    // Request number of every entry, per stream, to find the oldest entry
+    std::vector<std::deque<unsigned long long> > seq(Streams);
+    unsigned long long next_seq = 0, popped = 0, overtaken = 0;
+    unsigned int inflight = 0, occupancy = 0;
+
+    for (int i=0; i< NUM_ITER; ++i)
+    {
+        bool can_accept = (inflight < InFlight) && (occupancy < Depth);
+        assert(rob.canAcceptRequest() == can_accept);
+        if (can_accept && (rand()%4 != 0)) {
+            unsigned s = rand() % Streams;
+            ref[s].addRequest(rob.addRequest(s));
+            seq[s].push_back(next_seq++);
+            inflight++;
+            occupancy++;
+        }
+
+        std::vector<unsigned> waiting;
+        for (unsigned s = 0; s < Streams; s++) {
+            if (ref[s].waitsForAnyResponse()) waiting.push_back(s);
+        }
+        if (!waiting.empty() && (rand()%3 != 0)) {
+            unsigned s = waiting[rand() % waiting.size()];
+            typename StreamRob::Id id = ref[s].randomPendingResponseId();
+            ROB_DATA data = rand();
+            ref[s].addResponse(id, data);
+            rob.addResponse(id, data);
+            inflight--;
+        }
+
+        bool any_ready = false;
+        for (unsigned s = 0; s < Streams; s++) {
+            assert(rob.streamReady(s) == ref[s].topResponseReady());
+            any_ready = any_ready || ref[s].topResponseReady();
+        }
+        assert(rob.topResponseReady() == any_ready);
+
+        if (any_ready && (rand()%4 != 0)) {
+            typename StreamRob::Stream stream = rand() % Streams;
+            ROB_DATA data;
+            if (ref[stream].topResponseReady() && (rand()%2 == 0)) {
+                data = rob.popStreamResponse(stream);
+            } else {
+                data = rob.popResponse(stream);
+            }
+            unsigned s = stream;
+            assert(s < Streams);
+            assert(data == ref[s].popResponse());
+            unsigned long long oldest = seq[s].front();
+            for (unsigned k = 0; k < Streams; k++) {
+                if (!seq[k].empty() && seq[k].front() < oldest) {
+                    overtaken++;
+                    break;
+                }
+            }
+            seq[s].pop_front();
+            occupancy--;
+            popped++;
+        }
+        assert(rob.isEmpty() == (occupancy == 0));
+    }
+    DCOUT("ReorderBufStreams<" << Depth << ", " << InFlight << ", " << Streams << ">: "
+          << popped << " entries popped, " << overtaken << " ahead of an older entry" << endl);
+}
+
+// Simulation speed of ID allocation with InFlight IDs in use: every
+// operation releases a random ID and allocates a new one
+template <unsigned int InFlight, rob_id_alloc IdAlloc>
+void benchmark_id_alloc(const char* name)
+{
+    typedef ReorderBufIdAlloc<InFlight, IdAlloc> Alloc;
+    Alloc ids;
+    std::vector<typename Alloc::Id> used;
+    for (unsigned i = 0; i < InFlight; i++) {
+        used.push_back(ids.alloc());
+    }
+    assert(ids.isFull());
+    std::clock_t start = std::clock();
+    for (unsigned op = 0; op < NUM_BENCH_OPS; op++) {
+        unsigned k = rand() % InFlight;
+        ids.release(used[k]);
+        used[k] = ids.alloc();
+    }
+    double seconds = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+    DCOUT("ID allocation " << name << " InFlight=" << InFlight << ": "
+          << (NUM_BENCH_OPS / seconds) << " allocations/s" << endl);
+}
+
 CCS_MAIN(int argc, char *argv[]) {
 
     nvhls::set_random_seed();
@@ -218,6 +370,19 @@ CCS_MAIN(int argc, char *argv[]) {
         }
     }
 
+    test_wide_rob<8, 6, 1>();
+    test_wide_rob<8, 6, 2>();
+    test_wide_rob<16, 12, 4>();
+    test_wide_rob<12, 12, 3>();
+
+    test_stream_rob<8, 6, 1>();
+    test_stream_rob<16, 8, 4>();
+    test_stream_rob<12, 12, 5>();
+
+    benchmark_id_alloc<256, RobIdLinear>("RobIdLinear");
+    benchmark_id_alloc<256, RobIdPriEnc>("RobIdPriEnc");
+    benchmark_id_alloc<256, RobIdFreeList>("RobIdFreeList");
+
     DCOUT("CMODEL PASS" << endl);
     CCS_RETURN(0) ;
 }
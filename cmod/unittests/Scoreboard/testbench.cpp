@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <testbench/Scoreboard.h>
+#include <testbench/nvhls_rand.h>
+#include <chrono>
+#include <map>
+#include <sstream>
+
+// Checks that nvhls::AsyncScoreboard reports exactly the injected mismatches,
+// in check order with their cycle stamps and with the same report for one and
+// several worker threads, that a stateful reference memory checks in order on
+// a single worker, and times Check() against the model it offloads.
+
+#define NUM_CHECKS 2000
+#define MODEL_ROUNDS 20000
+
+struct HashJob {
+  uint64_t seed;
+};
+
+// Deliberately slow golden model
+uint64_t SlowHash(const HashJob& job) {
+  uint64_t x = job.seed;
+  for (int i = 0; i < MODEL_ROUNDS; i++) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+  }
+  return x;
+}
+
+// Every 97th check observes a wrong value; the cycle of check i is 3 * i + 10
+int RunHash(unsigned int threads, std::string& errors_out) {
+  nvhls::AsyncScoreboard<HashJob, uint64_t> sb("hash", SlowHash, threads);
+  std::ostringstream expected;
+  std::vector<HashJob> jobs(NUM_CHECKS);
+  std::vector<uint64_t> outputs(NUM_CHECKS);
+  for (unsigned int i = 0; i < NUM_CHECKS; i++) {
+    jobs[i].seed = i * 0x9e3779b97f4a7c15ULL;
+    outputs[i] = SlowHash(jobs[i]);
+  }
+  int injected = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < NUM_CHECKS; i++) {
+    uint64_t observed = outputs[i];
+    if (i % 97 == 5) {
+      observed ^= 1;
+      injected++;
+      expected << "ERROR: hash: check " << i << " at cycle " << 3 * i + 10 << ": is " << observed
+               << ", expected " << (observed ^ 1) << std::endl;
+    }
+    sb.Check(jobs[i], observed, 3 * i + 10);
+  }
+  std::chrono::steady_clock::time_point queued = std::chrono::steady_clock::now();
+  std::ostringstream report;
+  unsigned long errors = sb.Finish(report);
+  std::chrono::steady_clock::time_point done = std::chrono::steady_clock::now();
+  std::string lines = report.str();
+  errors_out = lines.substr(0, lines.rfind("SCOREBOARD"));
+  std::cout << lines.substr(errors_out.size());
+  std::cout << "hash, " << sb.NumThreads() << " threads: queueing "
+            << std::chrono::duration<double>(queued - start).count() << " s, draining "
+            << std::chrono::duration<double>(done - queued).count() << " s" << std::endl;
+
+  int fails = 0;
+  if (errors != static_cast<unsigned long>(injected) || sb.Checks() != NUM_CHECKS) fails++;
+  if (errors_out != expected.str()) {
+    std::cout << "ERROR: unexpected mismatch report" << std::endl << errors_out;
+    fails++;
+  }
+  return fails;
+}
+
+// A reference memory: writes update it, reads return the current value
+struct MemOp {
+  bool write;
+  unsigned addr;
+  int data;
+};
+
+struct RefMem {
+  std::map<unsigned, int> mem;
+  int operator()(const MemOp& op) {
+    if (op.write) return mem[op.addr] = op.data;
+    return mem.count(op.addr) ? mem[op.addr] : 0;
+  }
+};
+
+int RunMemory() {
+  RefMem ref;
+  nvhls::AsyncScoreboard<MemOp, int> sb("memory", std::ref(ref), 1);
+  std::map<unsigned, int> dut;
+  nvhls::RandStream rng(1, "memory");
+  unsigned long injected = 0;
+  for (unsigned int i = 0; i < 10000; i++) {
+    MemOp op = {rng.next() % 2 == 0, static_cast<unsigned>(rng.next() % 64),
+                static_cast<int>(rng.next() % 1000)};
+    int observed = op.write ? (dut[op.addr] = op.data) : (dut.count(op.addr) ? dut[op.addr] : 0);
+    if (i >= 7000 && !op.write && injected == 0) {
+      observed++;
+      injected++;
+    }
+    sb.Check(op, observed, i);
+  }
+  std::ostringstream report;
+  unsigned long errors = sb.Finish(report);
+  std::string lines = report.str();
+  std::cout << lines.substr(lines.rfind("SCOREBOARD"));
+  return errors != injected;
+}
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  int errors = 0;
+  std::string one, many;
+  errors += RunHash(1, one);
+  errors += RunHash(4, many);
+  if (one != many) {
+    std::cout << "ERROR: the report depends on the number of threads" << std::endl;
+    errors++;
+  }
+  errors += RunMemory();
+
+  if (errors != 0) {
+    DCOUT("TESTBENCH FAIL" << endl);
+  } else {
+    DCOUT("TESTBENCH PASS" << endl);
+  }
+  return errors != 0;
+}
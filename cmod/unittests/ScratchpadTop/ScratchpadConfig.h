@@ -29,6 +29,15 @@
   #define SCRATCHPAD_CAPACITY SCRATCHPAD_BANKS * 256
 #endif
 #define SCRATCHPAD_ADDR_WIDTH nvhls::nbits<SCRATCHPAD_CAPACITY-1>::val
+#ifndef SCRATCHPAD_ATOMICS
+  #define SCRATCHPAD_ATOMICS false
+#endif
+#ifndef SCRATCHPAD_RSP_QUEUE_DEPTH
+  #define SCRATCHPAD_RSP_QUEUE_DEPTH 0
+#endif
+#ifndef SCRATCHPAD_LANES_PER_WORD
+  #define SCRATCHPAD_LANES_PER_WORD 1
+#endif
 
 
 // Some convenience typedefs
@@ -27,9 +27,10 @@ SC_MODULE (ScratchpadTop) {
   static const int N = SCRATCHPAD_BANKS;
   static const int CAPACITY_IN_BYTES = SCRATCHPAD_CAPACITY ;
   static const int ADDR_WIDTH = SCRATCHPAD_ADDR_WIDTH;
-  Connections::In< cli_req_t<data32_t, ADDR_WIDTH,N> > cli_req;
+  Connections::In< cli_req_t<data32_t, ADDR_WIDTH,N,SCRATCHPAD_ATOMICS> > cli_req;
   Connections::Out< cli_rsp_t<data32_t, N> > cli_rsp;
-  Scratchpad<data32_t, SCRATCHPAD_BANKS,SCRATCHPAD_CAPACITY> myscratchpad;
+  Scratchpad<data32_t, SCRATCHPAD_BANKS,SCRATCHPAD_CAPACITY,SCRATCHPAD_ATOMICS,SCRATCHPAD_RSP_QUEUE_DEPTH,
+             SCRATCHPAD_LANES_PER_WORD> myscratchpad;
 
   SC_HAS_PROCESS(ScratchpadTop);
   ScratchpadTop(sc_module_name name) : sc_module(name),
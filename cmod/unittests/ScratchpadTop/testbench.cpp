@@ -34,7 +34,7 @@
 #endif
 
 //#define DEBUG 1
-typedef cli_req_t<data32_t, SCRATCHPAD_ADDR_WIDTH, SCRATCHPAD_BANKS> tb_cli_req_t;
+typedef cli_req_t<data32_t, SCRATCHPAD_ADDR_WIDTH, SCRATCHPAD_BANKS, SCRATCHPAD_ATOMICS> tb_cli_req_t;
 typedef cli_rsp_t<data32_t, SCRATCHPAD_BANKS> tb_cli_rsp_t;
 
 // *************************************************
@@ -49,6 +49,7 @@ public:
   memmodel(bool init_to_zero);
   
   void exec_store ( tb_cli_req_t cli_req );
+  tb_cli_rsp_t exec_atomic ( tb_cli_req_t cli_req );
   bool check_response ( tb_cli_rsp_t cli_rsp, tb_cli_req_t cli_req );
   data32_t read ( NVUINTC(SCRATCHPAD_ADDR_WIDTH) addr );
 
@@ -74,6 +75,20 @@ void memmodel::exec_store ( tb_cli_req_t cli_req ) {
   }
 }
 
+// Atomic lanes are applied in lane order
+tb_cli_rsp_t memmodel::exec_atomic ( tb_cli_req_t cli_req ) {
+  tb_cli_rsp_t rsp;
+  for (int i=0; i<SCRATCHPAD_BANKS; i++) {
+    rsp.valids[i] = cli_req.valids[i];
+    if (cli_req.valids[i] == true) {
+      rsp.data[i] = mem[cli_req.addr[i]];
+      mem[cli_req.addr[i]] = ScratchpadAtomicResult(cli_req.opcode, mem[cli_req.addr[i]],
+                                                    cli_req.data[i], cli_req.cmp[SCRATCHPAD_ATOMICS ? i : 0]);
+    }
+  }
+  return rsp;
+}
+
 data32_t memmodel::read ( NVUINTC(SCRATCHPAD_ADDR_WIDTH) addr ) {
   return mem[addr];
 }
@@ -95,6 +110,7 @@ bool memmodel::check_response ( tb_cli_rsp_t cli_rsp, tb_cli_req_t cli_req ) {
 static memmodel refmem(false);
 
 typedef deque<tb_cli_req_t> Fifo;
+typedef deque<tb_cli_rsp_t> RspFifo;
 
 // Input and Output for Testbench
 SC_MODULE (TbIO) {
@@ -106,6 +122,7 @@ SC_MODULE (TbIO) {
   tb_cli_rsp_t curr_cli_rsp;
 
   Fifo fifo;
+  RspFifo atomic_rsps;
 
   void source();
   void sink();
@@ -181,7 +198,67 @@ void TbIO::source() {
     // Push the requested load addresses into a fifo here for checking in the sink function:
     fifo.push_back(curr_cli_req);
   }
-  
+
+  /*
+    Atomics: lanes either access their own bank or share the address of
+    lane 0, and the expected responses come from the memory model
+  */
+  if (SCRATCHPAD_ATOMICS) {
+    // The load checks read the memory model, so let them finish first
+    while (!fifo.empty()) wait();
+    const ScratchpadOpcode atomic_ops[] = {ATOMIC_ADD, ATOMIC_MIN, ATOMIC_MAX, ATOMIC_SWAP, ATOMIC_CAS};
+    for (int i=0; i<1000; i++) {
+      wait();
+      int row = rand() % (SCRATCHPAD_CAPACITY/SCRATCHPAD_BANKS);
+      curr_cli_req.opcode = atomic_ops[rand() % 5];
+      for (int j=0; j<SCRATCHPAD_BANKS; j++) {
+        bool hot = (j > 0) && (rand() % 2);
+        curr_cli_req.valids[j] = (rand() % 4 != 0);
+        curr_cli_req.addr[j] = SCRATCHPAD_BANKS*row + (hot ? 0 : j);
+        curr_cli_req.data[j] = rand() % 256;
+        curr_cli_req.cmp[SCRATCHPAD_ATOMICS ? j : 0] = (rand() % 2) ? refmem.read(curr_cli_req.addr[j]) : 0;
+      }
+      cli_req.Push(curr_cli_req);
+      fifo.push_back(curr_cli_req);
+      atomic_rsps.push_back(refmem.exec_atomic(curr_cli_req));
+    }
+  }
+
+  /*
+    Sub-word lanes: every request picks a word in each bank and every lane a
+    random bank and entry of that word, so lanes share words and entries.
+    Stores have random valids, loads read on all lanes.
+  */
+  if (SCRATCHPAD_LANES_PER_WORD > 1) {
+    const int rows = SCRATCHPAD_CAPACITY / (SCRATCHPAD_BANKS * SCRATCHPAD_LANES_PER_WORD);
+    for (int i=0; i<2000; i++) {
+      bool store = (rand() % 2);
+      // The load checks read the memory model, so let them finish first
+      if (store) {
+        while (!fifo.empty()) wait();
+      }
+      wait();
+      int row[SCRATCHPAD_BANKS];
+      for (int b=0; b<SCRATCHPAD_BANKS; b++) {
+        row[b] = rand() % rows;
+      }
+      curr_cli_req.opcode = store ? STORE : LOAD;
+      for (int j=0; j<SCRATCHPAD_BANKS; j++) {
+        int b = rand() % SCRATCHPAD_BANKS;
+        curr_cli_req.valids[j] = !store || (rand() % 4 != 0);
+        curr_cli_req.addr[j] = (row[b] * SCRATCHPAD_BANKS + b) * SCRATCHPAD_LANES_PER_WORD +
+                               rand() % SCRATCHPAD_LANES_PER_WORD;
+        curr_cli_req.data[j] = rand();
+      }
+      cli_req.Push(curr_cli_req);
+      if (store) {
+        refmem.exec_store(curr_cli_req);
+      } else {
+        fifo.push_back(curr_cli_req);
+      }
+    }
+  }
+
 
   // Wait for any transactions in the DUT to clear out
   wait(20, SC_NS);
@@ -205,6 +282,10 @@ void TbIO::sink() {
     wait(2, SC_NS);
     while (1) {
       wait();
+      // Stall the response channel now and then to exercise the response queue
+      if ((SCRATCHPAD_RSP_QUEUE_DEPTH > 0) && (rand() % 4 == 0)) {
+        continue;
+      }
       curr_cli_rsp = cli_rsp.Pop();
       ref_cli_req = fifo.front();
       DCOUT("=========================================================" << endl);
@@ -216,7 +297,18 @@ void TbIO::sink() {
 	  DCOUT("  Lane " << j << ": No valid data received." << endl);
 	}
       }
-      pass = refmem.check_response(curr_cli_rsp, ref_cli_req);
+      if (ScratchpadIsAtomic(ref_cli_req.opcode)) {
+        tb_cli_rsp_t expected = atomic_rsps.front();
+        atomic_rsps.pop_front();
+        pass = true;
+        for (int j=0; j<SCRATCHPAD_BANKS; j++) {
+          if (ref_cli_req.valids[j] == true) {
+            pass = pass && (curr_cli_rsp.valids[j] == true) && (curr_cli_rsp.data[j] == expected.data[j]);
+          }
+        }
+      } else {
+        pass = refmem.check_response(curr_cli_rsp, ref_cli_req);
+      }
       if (!pass) {
 	DCOUT("ERROR: Mismatch " << "\n");
 	DCOUT("@" << sc_time_stamp() << "\t **FAIL**" << endl);
@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <hls_globals.h>
+#include "SparseStreamTop.h"
+
+void SparseStreamTop(bool& bitmap_valid, const bitmap_t& bitmap, bool& values_valid,
+                     const values_t& values, bool& out_valid, dense_t& out) {
+  static decoder_t decoder;
+  decoder.run(bitmap_valid, bitmap, values_valid, values, out_valid, out);
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SPARSE_STREAM_TOP_H
+#define SPARSE_STREAM_TOP_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <hls_globals.h>
+#include <SparseStream.h>
+
+#ifndef LANES
+#define LANES 16
+#endif
+
+#ifndef DATA_WIDTH
+#define DATA_WIDTH 8
+#endif
+
+typedef NVINTW(DATA_WIDTH) Elem;
+typedef BitmapDecoderCore<Elem, LANES> decoder_t;
+typedef decoder_t::bitmap_t bitmap_t;
+typedef decoder_t::values_t values_t;
+typedef decoder_t::dense_t dense_t;
+
+void SparseStreamTop(bool& bitmap_valid, const bitmap_t& bitmap, bool& values_valid,
+                     const values_t& values, bool& out_valid, dense_t& out);
+
+
+#endif
@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SparseStreamTop.h"
+#include <match_scverify.h>
+#include <testbench/nvhls_rand.h>
+
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#ifndef COLS
+#define COLS (4 * LANES)
+#endif
+
+#ifndef NUM_TENSORS
+#define NUM_TENSORS 8
+#endif
+
+// Checks SparseLanes compaction and expansion against a scan, then encodes
+// tensors of several densities with a BitmapEncoderCore, decodes them with
+// the SparseStreamTop BitmapDecoderCore and decodes the same tensors from CSR
+// with a CsrDecoderCore. Every dense vector must come back unchanged. Each
+// density runs once with random gaps on every input and once at full rate,
+// where every core must take one dense vector per cycle. The full-rate runs
+// report the compressed size of both formats relative to the dense one and
+// the cycles per dense vector.
+
+typedef BitmapEncoderCore<Elem, LANES> encoder_t;
+typedef CsrDecoderCore<Elem, LANES, COLS> csr_t;
+typedef SparseLanes<Elem, LANES> lanes_t;
+
+static const unsigned int kRows = 2 * LANES;
+static const unsigned int kVectorsPerTensor = kRows * COLS / LANES;
+
+template <unsigned int Lanes>
+void check_lanes() {
+  typedef SparseLanes<NVUINT16, Lanes> l_t;
+  for (unsigned int iter = 0; iter < 1000; iter++) {
+    typename l_t::Vector in, packed, dense;
+    typename l_t::Mask mask = 0;
+    std::vector<unsigned int> ref;
+    for (unsigned int i = 0; i < Lanes; i++) {
+      in[i] = rand() & 0xffff;
+      mask[i] = (rand() % 3 == 0);
+      if (mask[i] == 1) ref.push_back(in[i].to_uint());
+    }
+    typename l_t::Count count = l_t::compact(in, mask, packed);
+    assert(count == ref.size());
+    assert(l_t::popcount(mask) == ref.size());
+    for (unsigned int k = 0; k < Lanes; k++) {
+      assert(packed[k] == ((k < ref.size()) ? ref[k] : 0));
+    }
+    l_t::expand(packed, mask, dense);
+    for (unsigned int i = 0; i < Lanes; i++) {
+      assert(dense[i] == ((mask[i] == 1) ? in[i] : NVUINT16(0)));
+    }
+  }
+}
+
+struct Tensor {
+  std::vector<dense_t> vectors;  // row-major, COLS / LANES vectors per row
+};
+
+Tensor random_tensor(unsigned int density_pct) {
+  Tensor t;
+  for (unsigned int v = 0; v < kVectorsPerTensor; v++) {
+    dense_t d;
+    for (unsigned int i = 0; i < LANES; i++) {
+      Elem e = 0;
+      if (static_cast<unsigned int>(rand() % 100) < density_pct) {
+        while (e == 0) e = rand();
+      }
+      d.data[i] = e;
+    }
+    d.last = (v == kVectorsPerTensor - 1);
+    t.vectors.push_back(d);
+  }
+  return t;
+}
+
+bool same(const dense_t& a, const dense_t& b) {
+  if (a.last != b.last) return false;
+  for (unsigned int i = 0; i < LANES; i++) {
+    if (a.data[i] != b.data[i]) return false;
+  }
+  return true;
+}
+
+// An input register in front of a core, refilled from its queue as a port
+// would be; gaps leaves it empty in some cycles
+template <typename T>
+struct Feed {
+  std::deque<T> queue;
+  bool valid;
+  T reg;
+  Feed() : valid(false) {}
+  void refill(bool gaps) {
+    if (!valid && !queue.empty() && (!gaps || rand() % 3 != 0)) {
+      reg = queue.front();
+      queue.pop_front();
+      valid = true;
+    }
+  }
+  bool drained() { return !valid && queue.empty(); }
+};
+
+void check_density(unsigned int density_pct, bool gaps) {
+  std::vector<Tensor> tensors;
+  Feed<dense_t> dense_feed;
+  for (unsigned int t = 0; t < NUM_TENSORS; t++) {
+    tensors.push_back(random_tensor(density_pct));
+    for (unsigned int v = 0; v < kVectorsPerTensor; v++) {
+      dense_feed.queue.push_back(tensors[t].vectors[v]);
+    }
+  }
+  const unsigned int num_vectors = NUM_TENSORS * kVectorsPerTensor;
+
+  // Encode
+  encoder_t encoder;
+  Feed<bitmap_t> bitmap_feed;
+  Feed<values_t> values_feed;
+  unsigned int enc_cycles = 0;
+  while (!dense_feed.drained() || enc_cycles == 0) {
+    dense_feed.refill(gaps);
+    bool bitmap_valid, values_valid;
+    bitmap_t bitmap;
+    values_t values;
+    encoder.run(dense_feed.valid, dense_feed.reg, bitmap_valid, bitmap, values_valid, values);
+    if (bitmap_valid) bitmap_feed.queue.push_back(bitmap);
+    if (values_valid) {
+      assert(values.count == LANES || values.last == 1);
+      values_feed.queue.push_back(values);
+    }
+    enc_cycles++;
+  }
+  // A final short beat may still be pending
+  for (unsigned int i = 0; i < 2; i++) {
+    bool bitmap_valid = false, values_valid = false, in_valid = false;
+    bitmap_t bitmap;
+    values_t values;
+    encoder.run(in_valid, dense_feed.reg, bitmap_valid, bitmap, values_valid, values);
+    assert(!bitmap_valid);
+    if (values_valid) values_feed.queue.push_back(values);
+  }
+  assert(bitmap_feed.queue.size() == num_vectors);
+  unsigned int num_beats = values_feed.queue.size();
+
+  // Decode the bitmap stream with the DUT
+  unsigned int dec_cycles = 0, out_count = 0;
+  while (out_count < num_vectors) {
+    bitmap_feed.refill(gaps);
+    values_feed.refill(gaps);
+    bool out_valid;
+    dense_t out;
+    CCS_DESIGN(SparseStreamTop)(bitmap_feed.valid, bitmap_feed.reg, values_feed.valid,
+                                values_feed.reg, out_valid, out);
+    if (out_valid) {
+      assert(same(out, tensors[out_count / kVectorsPerTensor]
+                           .vectors[out_count % kVectorsPerTensor]));
+      out_count++;
+    }
+    dec_cycles++;
+    assert(dec_cycles < 10 * num_vectors + 100);
+  }
+  assert(values_feed.drained());
+
+  // Decode the same tensors from CSR
+  Feed<csr_t::row_ptr_t> ptr_feed;
+  Feed<csr_t::values_t> csr_feed;
+  unsigned int csr_beats = 0;
+  for (unsigned int t = 0; t < NUM_TENSORS; t++) {
+    unsigned int nnz = 0, fill = 0;
+    csr_t::values_t beat;
+    for (unsigned int r = 0; r < kRows; r++) {
+      for (unsigned int c = 0; c < COLS; c++) {
+        Elem e = tensors[t].vectors[r * (COLS / LANES) + c / LANES].data[c % LANES];
+        if (e == 0) continue;
+        beat.data[fill] = e;
+        beat.col[fill] = c;
+        nnz++;
+        if (++fill == LANES) {
+          beat.count = LANES;
+          beat.last = 0;
+          csr_feed.queue.push_back(beat);
+          fill = 0;
+        }
+      }
+      csr_t::row_ptr_t ptr;
+      ptr.ptr = nnz;
+      ptr.last = (r == kRows - 1);
+      ptr_feed.queue.push_back(ptr);
+    }
+    if (fill > 0) {
+      beat.count = fill;
+      csr_feed.queue.push_back(beat);
+    }
+    if (!csr_feed.queue.empty()) csr_feed.queue.back().last = 1;
+  }
+  csr_beats = csr_feed.queue.size();
+  csr_t csr;
+  unsigned int csr_cycles = 0;
+  out_count = 0;
+  while (out_count < num_vectors) {
+    ptr_feed.refill(gaps);
+    csr_feed.refill(gaps);
+    bool out_valid;
+    dense_t out;
+    csr.run(ptr_feed.valid, ptr_feed.reg, csr_feed.valid, csr_feed.reg, out_valid, out);
+    if (out_valid) {
+      assert(same(out, tensors[out_count / kVectorsPerTensor]
+                           .vectors[out_count % kVectorsPerTensor]));
+      out_count++;
+    }
+    csr_cycles++;
+    assert(csr_cycles < 10 * num_vectors + 100);
+  }
+  assert(ptr_feed.drained() && csr_feed.drained());
+
+  if (!gaps) {
+    // One vector per cycle, plus the first beat and one flush per tensor
+    assert(enc_cycles <= num_vectors + NUM_TENSORS);
+    assert(dec_cycles <= num_vectors + 1);
+    assert(csr_cycles <= num_vectors + 1);
+    double dense_bits = static_cast<double>(num_vectors) * LANES * DATA_WIDTH;
+    double bitmap_bits = static_cast<double>(num_vectors) * bitmap_t::width +
+                         static_cast<double>(num_beats) * values_t::width;
+    double csr_bits = static_cast<double>(NUM_TENSORS * kRows) * csr_t::row_ptr_t::width +
+                      static_cast<double>(csr_beats) * csr_t::values_t::width;
+    std::cout << std::fixed << std::setprecision(3) << std::setw(7) << density_pct
+              << std::setw(10) << bitmap_bits / dense_bits << std::setw(10)
+              << csr_bits / dense_bits << std::setw(10)
+              << enc_cycles / static_cast<double>(num_vectors) << std::setw(10)
+              << dec_cycles / static_cast<double>(num_vectors) << std::setw(10)
+              << csr_cycles / static_cast<double>(num_vectors) << std::endl;
+  }
+}
+
+CCS_MAIN(int argc, char *argv[])
+{
+  nvhls::set_random_seed();
+
+  check_lanes<1>();
+  check_lanes<5>();
+  check_lanes<LANES>();
+  check_lanes<32>();
+
+  std::cout << LANES << " lanes of " << DATA_WIDTH << " bits, " << COLS
+            << " columns: size relative to dense and cycles per dense vector" << std::endl;
+  std::cout << "density    bitmap       csr   encoder   decoder       csr" << std::endl;
+  unsigned int densities[] = {0, 5, 10, 25, 50, 75, 100};
+  for (unsigned int i = 0; i < sizeof(densities) / sizeof(densities[0]); i++) {
+    check_density(densities[i], true);
+    check_density(densities[i], false);
+  }
+
+  DCOUT("CMODEL PASS" << endl);
+  CCS_RETURN(0) ;
+}
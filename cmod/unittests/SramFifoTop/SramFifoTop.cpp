@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <sram_fifo.h>
+#include <hls_globals.h>
+#include "SramFifoTop.h"
+
+void SramFifoTop(const bool& push_valid, const DataType& push_data, bool& push_ready,
+                 const bool& pop_ready, bool& pop_valid, DataType& pop_data)
+{
+    static SramFifo_ fifo;
+    pop_valid = !fifo.isEmpty();
+    pop_data = 0;
+    if (pop_valid) {
+        pop_data = fifo.peek();
+        if (pop_ready) fifo.pop();
+    }
+    push_ready = !fifo.isFull();
+    if (push_ready && push_valid) {
+        fifo.push(push_data);
+    }
+    fifo.tick();
+}
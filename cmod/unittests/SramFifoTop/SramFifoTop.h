@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef SRAM_FIFO_TOP_H
+#define SRAM_FIFO_TOP_H
+
+#include <sram_fifo.h>
+#include <hls_globals.h>
+
+#ifndef SRAM_DEPTH
+#define SRAM_DEPTH 64
+#endif
+
+#ifndef PREFETCH_DEPTH
+#define PREFETCH_DEPTH 2
+#endif
+
+#ifndef DUAL_PORT
+#define DUAL_PORT true
+#endif
+
+#ifndef WORD_WIDTH
+#define WORD_WIDTH 16
+#endif
+
+typedef NVUINTC(WORD_WIDTH) DataType;
+typedef SramFifo<DataType, SRAM_DEPTH, PREFETCH_DEPTH, DUAL_PORT> SramFifo_;
+
+// One call is one cycle: pop if requested and an entry is at the head, push if
+// requested and not full, then tick
+void SramFifoTop(const bool& push_valid, const DataType& push_data, bool& push_ready,
+                 const bool& pop_ready, bool& pop_valid, DataType& pop_data);
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include "SramFifoTop.h"
+#include <match_scverify.h>
+#include <testbench/nvhls_rand.h>
+
+#include <deque>
+
+#ifndef NUM_ITER
+#define NUM_ITER 20000
+#endif
+
+std::deque<DataType> ref_q;
+int errors = 0;
+
+// Runs one cycle and checks the popped entry against the reference
+bool Cycle(bool push_valid, bool pop_ready)
+{
+    DataType push_data = rand();
+    bool push_ready, pop_valid;
+    DataType pop_data;
+    CCS_DESIGN(SramFifoTop)(push_valid, push_data, push_ready, pop_ready, pop_valid, pop_data);
+    bool popped = pop_valid && pop_ready;
+    if (popped) {
+        if (ref_q.empty() || pop_data != ref_q.front()) {
+            DCOUT("ERROR: popped " << pop_data << endl);
+            errors++;
+        }
+        if (!ref_q.empty()) ref_q.pop_front();
+    }
+    if (push_valid && push_ready) ref_q.push_back(push_data);
+    return popped;
+}
+
+// Pops with a backlog of fill entries for cycles cycles while pushing every
+// cycle, and returns the number of pops
+unsigned int Stream(unsigned int fill, unsigned int cycles)
+{
+    for (unsigned int i = 0; i < fill; i++) Cycle(true, false);
+    unsigned int pops = 0;
+    for (unsigned int i = 0; i < cycles; i++) pops += Cycle(true, true);
+    while (!ref_q.empty()) Cycle(false, true);
+    for (int i = 0; i < 4; i++) Cycle(false, true);
+    return pops;
+}
+
+CCS_MAIN(int argc, char *argv[]) {
+
+    nvhls::set_random_seed();
+
+    // Random traffic, including runs that fill the FIFO
+    for (int i = 0; i < NUM_ITER; ++i) {
+        int phase = (i / 1000) % 3;
+        bool push_valid = (phase == 0) ? (rand() % 4 != 0) : (rand() % 2 == 0);
+        bool pop_ready = (phase == 2) ? (rand() % 4 != 0) : (rand() % 3 == 0);
+        Cycle(push_valid, pop_ready);
+    }
+    while (!ref_q.empty()) Cycle(false, true);
+
+    // A push into an empty FIFO can be popped in the next cycle
+    Cycle(true, false);
+    if (!Cycle(false, true)) {
+        DCOUT("ERROR: pushed entry not available in the next cycle" << endl);
+        errors++;
+    }
+
+    // Streaming through the SRAM body: one entry per cycle with a dual-port
+    // SRAM and at least two prefetch entries, half rate with a single port
+    unsigned int cycles = 1000;
+    unsigned int pops = Stream(SRAM_DEPTH / 2, cycles);
+    DCOUT("Streaming through the SRAM: " << pops << " pops in " << cycles << " cycles" << endl);
+    if (DUAL_PORT && PREFETCH_DEPTH >= 2 && pops != cycles) {
+        DCOUT("ERROR: expected one pop per cycle" << endl);
+        errors++;
+    }
+    if (!DUAL_PORT && pops < cycles / 2) {
+        DCOUT("ERROR: expected at least half rate" << endl);
+        errors++;
+    }
+
+    if (errors == 0) {
+        DCOUT("CMODEL PASS" << endl);
+    } else {
+        DCOUT("CMODEL FAIL: " << errors << " errors" << endl);
+    }
+    CCS_RETURN(errors != 0);
+}
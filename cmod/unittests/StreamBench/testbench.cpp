@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <testbench/StreamBench.h>
+#include <testbench/nvhls_rand.h>
+#include <cmath>
+#include <vector>
+
+// Drives two Connections::Buffer channels with nvhls::StreamSource and
+// nvhls::StreamSink: one at half the injection rate with a full-rate sink, one
+// at full injection rate with a sink that drains every fourth cycle.  Checks
+// the data, the measured throughput and the latency of both streams.
+
+#define NUM_MSGS 2000
+
+typedef NVUINTW(32) Data;
+
+SC_MODULE(testbench) {
+  sc_clock clk;
+  sc_signal<bool> rst;
+
+  nvhls::StreamSource<Data> src_half, src_full;
+  nvhls::StreamSink<Data> sink_full, sink_quarter;
+  Connections::Buffer<Data, 4> buf_a, buf_b;
+  Connections::Combinational<Data> enq_a, deq_a, enq_b, deq_b;
+
+  int errors;
+
+  SC_CTOR(testbench)
+      : clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true),
+        rst("rst"),
+        src_half("src_half"),
+        src_full("src_full"),
+        sink_full("sink_full"),
+        sink_quarter("sink_quarter", 0.25),
+        buf_a("buf_a"),
+        buf_b("buf_b"),
+        errors(0) {
+    std::vector<Data> msgs;
+    for (int i = 0; i < NUM_MSGS; i++) {
+      msgs.push_back(nvhls::get_rand<32>());
+    }
+    src_half.Load(msgs);
+    src_half.SetRate(0.5);
+    src_full.Load(msgs);
+    sink_full.Expect(msgs, false);
+    sink_full.SetSource(src_half);
+    sink_quarter.Expect(msgs, false);
+    sink_quarter.SetSource(src_full);
+
+    src_half.clk(clk); src_half.rst(rst); src_half.out(enq_a);
+    buf_a.clk(clk); buf_a.rst(rst); buf_a.enq(enq_a); buf_a.deq(deq_a);
+    sink_full.clk(clk); sink_full.rst(rst); sink_full.in(deq_a);
+
+    src_full.clk(clk); src_full.rst(rst); src_full.out(enq_b);
+    buf_b.clk(clk); buf_b.rst(rst); buf_b.enq(enq_b); buf_b.deq(deq_b);
+    sink_quarter.clk(clk); sink_quarter.rst(rst); sink_quarter.in(deq_b);
+
+    SC_THREAD(run);
+  }
+
+  void Check(bool cond, const char* what) {
+    if (!cond) {
+      std::cout << "ERROR: " << what << std::endl;
+      errors++;
+    }
+  }
+
+  void run() {
+    rst.write(0);
+    wait(10, SC_NS);
+    rst.write(1);
+    while (sink_full.Stats().Msgs() < NUM_MSGS || sink_quarter.Stats().Msgs() < NUM_MSGS) {
+      wait(100, SC_NS);
+    }
+
+    const nvhls::StreamStats& a = sink_full.Stats();
+    Check(a.Errors() == 0, "sink_full data mismatch");
+    Check(std::fabs(a.Throughput() - 0.5) < 0.01, "sink_full throughput is not the injection rate");
+    Check(a.LatencyMax() - a.LatencyMin() <= 1, "sink_full latency is not constant below saturation");
+
+    const nvhls::StreamStats& b = sink_quarter.Stats();
+    Check(b.Errors() == 0, "sink_quarter data mismatch");
+    Check(std::fabs(b.Throughput() - 0.25) < 0.01, "sink_quarter throughput is not the drain rate");
+    // Above saturation the source backs up and message i waits about 3 * i cycles
+    Check(b.LatencyMax() > 2 * NUM_MSGS, "sink_quarter latency does not grow with the backlog");
+    Check(b.LatencyPercentile(50) < b.LatencyPercentile(99), "sink_quarter latency percentiles");
+
+    sc_stop();
+  }
+};
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+
+  // Nearest-rank percentiles and throughput of a known stream
+  nvhls::StreamStats stats;
+  for (unsigned long i = 1; i <= 100; i++) {
+    stats.Add(2 * i, i);
+  }
+  bool stats_ok = stats.Msgs() == 100 && stats.Cycles() == 199 && stats.LatencyMin() == 1 &&
+                  stats.LatencyMax() == 100 && stats.LatencyPercentile(50) == 50 &&
+                  stats.LatencyPercentile(99) == 99 && std::fabs(stats.LatencyMean() - 50.5) < 1e-9;
+
+  testbench tb("tb");
+  sc_start();
+
+  if (!stats_ok || tb.errors != 0) {
+    DCOUT("TESTBENCH FAIL" << endl);
+    return 1;
+  }
+  DCOUT("TESTBENCH PASS" << endl);
+  return 0;
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SYSTOLIC_ARRAY_TOP_H
+#define SYSTOLIC_ARRAY_TOP_H
+
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <hls_globals.h>
+#include <SystolicArray.h>
+
+#ifndef ROWS
+#define ROWS 4
+#endif
+
+#ifndef COLS
+#define COLS 4
+#endif
+
+#ifndef DATAFLOW
+#define DATAFLOW WeightStationary
+#endif
+
+typedef NVINT8 InType;
+typedef NVINT32 AccType;
+typedef SystolicArray<InType, AccType, ROWS, COLS, DATAFLOW> array_t;
+typedef systolic_weight_t<InType, ROWS, COLS> weight_t;
+typedef systolic_in_t<InType, ROWS, COLS, DATAFLOW> in_t;
+typedef nvhls::nv_scvector<AccType, COLS> OutVector;
+
+void SystolicArrayTop(bool& weight_valid, const weight_t& weight, bool& in_valid,
+                      const in_t& in, bool& out_valid, OutVector& out);
+
+
+#endif
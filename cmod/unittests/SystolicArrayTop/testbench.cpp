@@ -0,0 +1,613 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SystolicArrayTop.h"
+#include <match_scverify.h>
+#include <testbench/nvhls_rand.h>
+#include <testbench/Scoreboard.h>
+#include <ArbitratedScratchpad.h>
+
+#include <deque>
+#include <iomanip>
+#include <vector>
+
+#ifndef NUM_TILES
+#define NUM_TILES 32
+#endif
+
+// Checks both dataflows against a reference GEMM with random inputs, random
+// stalls and back-to-back tiles, then runs the configured dataflow through
+// SystolicArrayTop. A GEMM benchmark then computes C = A * B for several
+// shapes from scratchpads, through SystolicFeeder and SystolicDrainer, and
+// reports cycles and the utilization M * N * K / (cycles * ROWS * COLS). The
+// reference GEMM of the benchmark runs on the workers of an
+// nvhls::AsyncScoreboard while the next shape is simulated.
+
+static const unsigned kMaxCycles = 1000000;
+
+template <systolic_dataflow D>
+struct ClassStep {
+  SystolicArray<InType, AccType, ROWS, COLS, D> array;
+  void operator()(bool& weight_valid, const weight_t& weight, bool& in_valid,
+                  const systolic_in_t<InType, ROWS, COLS, D>& in, bool& out_valid,
+                  OutVector& out) {
+    systolic_array_step(array, weight_valid, weight, in_valid, in, out_valid, out);
+  }
+};
+
+struct DutStep {
+  void operator()(bool& weight_valid, const weight_t& weight, bool& in_valid, const in_t& in,
+                  bool& out_valid, OutVector& out) {
+    CCS_DESIGN(SystolicArrayTop)(weight_valid, weight, in_valid, in, out_valid, out);
+  }
+};
+
+int small_rand() { return (rand() % 16) - 8; }
+
+bool check_row(const OutVector& out, const std::vector<int>& ref, unsigned row) {
+  for (unsigned n = 0; n < COLS; n++) {
+    if (out[n] != ref[n]) {
+      std::cout << "ERROR: output row " << row << " column " << n << " is " << out[n]
+                << ", expected " << ref[n] << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+template <systolic_dataflow D>
+struct CoreTest;
+
+// NUM_TILES tiles of B, each followed by 1 to 3 * ROWS rows of A. The
+// weights of a tile go into the bank that is not in use while the previous
+// tile streams.
+template <>
+struct CoreTest<WeightStationary> {
+  template <typename Step>
+  static int run(Step& step) {
+    typedef systolic_in_t<InType, ROWS, COLS, WeightStationary> ws_in_t;
+    std::vector<std::vector<std::vector<int> > > b(NUM_TILES);
+    std::vector<std::vector<std::vector<int> > > a(NUM_TILES);
+    std::deque<std::vector<int> > expected;
+    for (unsigned t = 0; t < NUM_TILES; t++) {
+      b[t].resize(ROWS, std::vector<int>(COLS));
+      for (unsigned k = 0; k < ROWS; k++) {
+        for (unsigned n = 0; n < COLS; n++) {
+          b[t][k][n] = small_rand();
+        }
+      }
+      a[t].resize(1 + rand() % (3 * ROWS), std::vector<int>(ROWS));
+      for (unsigned m = 0; m < a[t].size(); m++) {
+        std::vector<int> c(COLS, 0);
+        for (unsigned k = 0; k < ROWS; k++) {
+          a[t][m][k] = small_rand();
+          for (unsigned n = 0; n < COLS; n++) {
+            c[n] += a[t][m][k] * b[t][k][n];
+          }
+        }
+        expected.push_back(c);
+      }
+    }
+
+    bool weight_held = false, in_held = false, out_valid;
+    weight_t weight;
+    ws_in_t in;
+    OutVector out;
+    unsigned w_tile = 0, w_row = 0, loaded_tiles = 0, a_tile = 0, a_row = 0;
+    bool held_last = false;
+    unsigned rows = 0, cycles = 0;
+    while (!expected.empty() && cycles < kMaxCycles) {
+      cycles++;
+      // A bank may be reloaded once every activation of its previous tile
+      // has been sent
+      if (!weight_held && w_tile < NUM_TILES && w_tile < a_tile + 2) {
+        weight.row = w_row;
+        weight.bank = w_tile % 2;
+        for (unsigned n = 0; n < COLS; n++) {
+          weight.weights[n] = b[w_tile][w_row][n];
+        }
+        weight_held = true;
+        held_last = (w_row == ROWS - 1);
+        if (++w_row == ROWS) {
+          w_row = 0;
+          w_tile++;
+        }
+      }
+      if (!in_held && a_tile < loaded_tiles && (rand() % 4 != 0)) {
+        for (unsigned k = 0; k < ROWS; k++) {
+          in.a[k] = a[a_tile][a_row][k];
+        }
+        in.bank = a_tile % 2;
+        in_held = true;
+        if (++a_row == a[a_tile].size()) {
+          a_row = 0;
+          a_tile++;
+        }
+      }
+      if (rand() % 4 == 0) {
+        continue;  // output stall
+      }
+      bool was_held = weight_held;
+      step(weight_held, weight, in_held, in, out_valid, out);
+      if (was_held && !weight_held && held_last) {
+        loaded_tiles++;
+      }
+      if (out_valid) {
+        if (expected.empty() || !check_row(out, expected.front(), rows)) {
+          return 1;
+        }
+        expected.pop_front();
+        rows++;
+      }
+    }
+    if (!expected.empty()) {
+      std::cout << "ERROR: weight stationary array stopped after " << rows << " rows"
+                << std::endl;
+      return 1;
+    }
+    std::cout << "weight stationary: " << rows << " rows in " << cycles << " cycles"
+              << std::endl;
+    return 0;
+  }
+};
+
+// NUM_TILES tiles of 1 to 2 * ROWS steps each; tiles shorter than ROWS steps
+// wait for SystolicArray::ready().
+template <>
+struct CoreTest<OutputStationary> {
+  template <typename Step>
+  static int run(Step& step) {
+    typedef systolic_in_t<InType, ROWS, COLS, OutputStationary> os_in_t;
+    std::deque<os_in_t> steps;
+    std::deque<std::vector<int> > expected;
+    for (unsigned t = 0; t < NUM_TILES; t++) {
+      unsigned len = 1 + rand() % (2 * ROWS);
+      std::vector<std::vector<int> > c(ROWS, std::vector<int>(COLS, 0));
+      for (unsigned k = 0; k < len; k++) {
+        os_in_t s;
+        std::vector<int> a_col(ROWS), b_row(COLS);
+        for (unsigned m = 0; m < ROWS; m++) {
+          a_col[m] = small_rand();
+          s.a[m] = a_col[m];
+        }
+        for (unsigned n = 0; n < COLS; n++) {
+          b_row[n] = small_rand();
+          s.b[n] = b_row[n];
+        }
+        s.bank = 0;
+        s.last = (k == len - 1);
+        steps.push_back(s);
+        for (unsigned m = 0; m < ROWS; m++) {
+          for (unsigned n = 0; n < COLS; n++) {
+            c[m][n] += a_col[m] * b_row[n];
+          }
+        }
+      }
+      for (unsigned m = 0; m < ROWS; m++) {
+        expected.push_back(c[m]);
+      }
+    }
+
+    bool weight_held = false, in_held = false, out_valid;
+    weight_t weight;
+    os_in_t in;
+    OutVector out;
+    unsigned rows = 0, cycles = 0;
+    while (!expected.empty() && cycles < kMaxCycles) {
+      cycles++;
+      if (!in_held && !steps.empty() && (rand() % 4 != 0)) {
+        in = steps.front();
+        steps.pop_front();
+        in_held = true;
+      }
+      if (rand() % 4 == 0) {
+        continue;  // output stall
+      }
+      step(weight_held, weight, in_held, in, out_valid, out);
+      if (out_valid) {
+        if (expected.empty() || !check_row(out, expected.front(), rows)) {
+          return 1;
+        }
+        expected.pop_front();
+        rows++;
+      }
+    }
+    if (!expected.empty()) {
+      std::cout << "ERROR: output stationary array stopped after " << rows << " rows"
+                << std::endl;
+      return 1;
+    }
+    std::cout << "output stationary: " << rows << " rows in " << cycles << " cycles"
+              << std::endl;
+    return 0;
+  }
+};
+
+// GEMM benchmark. A (M x K), B (K x N) and C (M x N) are row-major in
+// separate scratchpads, one bank per lane of the array edge that reads or
+// writes them. BankXorSwizzle spreads the strided column accesses of the
+// output-stationary dataflow over the banks.
+static const unsigned kSpadEntries = 1024;
+static const unsigned kQueueLen = 4;
+typedef ArbitratedScratchpad<AccType, kSpadEntries, ROWS, ROWS, kQueueLen, Roundrobin,
+                             BankXorSwizzle> a_spad_t;
+typedef ArbitratedScratchpad<AccType, kSpadEntries, COLS, COLS, kQueueLen, Roundrobin,
+                             BankXorSwizzle> b_spad_t;
+typedef ArbitratedScratchpad<AccType, kSpadEntries, COLS, COLS, kQueueLen, Roundrobin,
+                             BankXorSwizzle, false, false, true> c_spad_t;
+
+struct gemm_shape {
+  unsigned m, n, k;
+};
+
+struct out_dest {
+  unsigned addr, lanes;
+};
+
+unsigned min_u(unsigned x, unsigned y) { return (x < y) ? x : y; }
+
+// Stores data from address 0 through a SystolicDrainer
+template <typename Spad>
+void spad_fill(Spad& spad, const std::vector<int>& data) {
+  SystolicDrainer<Spad> fill;
+  unsigned next = 0;
+  while (next < data.size() || !fill.isIdle() || !spad.isIdle()) {
+    if (next < data.size() && fill.ready()) {
+      unsigned lanes = min_u(Spad::num_inputs, data.size() - next);
+      typename SystolicDrainer<Spad>::Vector v;
+      for (unsigned i = 0; i < Spad::num_inputs; i++) {
+        v[i] = (i < lanes) ? data[next + i] : 0;
+      }
+      fill.push(v, next, 1, lanes);
+      next += lanes;
+    }
+    typename Spad::req_t req;
+    typename Spad::rsp_t rsp;
+    bool ready[Spad::num_inputs];
+    fill.request(req);
+    systolic_spad_access(spad, req, rsp, ready);
+    fill.response(req, ready);
+  }
+}
+
+template <typename Spad>
+int spad_read(Spad& spad, unsigned addr) {
+  typename Spad::bank_sel_t bank;
+  typename Spad::bank_addr_t bank_addr;
+  Spad::map_address(addr, bank, bank_addr);
+  return spad.banks.read(bank_addr, bank).to_int();
+}
+
+template <typename Feeder, typename Spad>
+void feeder_cycle(Feeder& feeder, Spad& spad) {
+  typename Spad::req_t req;
+  typename Spad::rsp_t rsp;
+  bool ready[Spad::num_inputs];
+  feeder.request(req);
+  systolic_spad_access(spad, req, rsp, ready);
+  feeder.response(req, rsp, ready);
+}
+
+template <typename Drainer, typename Spad>
+void drainer_cycle(Drainer& drainer, Spad& spad) {
+  typename Spad::req_t req;
+  typename Spad::rsp_t rsp;
+  bool ready[Spad::num_inputs];
+  drainer.request(req);
+  systolic_spad_access(spad, req, rsp, ready);
+  drainer.response(req, ready);
+}
+
+template <systolic_dataflow D>
+struct Gemm;
+
+// Tiles of ROWS values of k by COLS columns of C, k innermost. Every tile
+// streams all M rows of A, and the drainer adds its partial sums to C with
+// ATOMIC_ADD.
+template <>
+struct Gemm<WeightStationary> {
+  static unsigned run(const gemm_shape& s, a_spad_t& a_spad, b_spad_t& b_spad, c_spad_t& c_spad) {
+    std::vector<unsigned> tile_n0, tile_k0;
+    for (unsigned n0 = 0; n0 < s.n; n0 += COLS) {
+      for (unsigned k0 = 0; k0 < s.k; k0 += ROWS) {
+        tile_n0.push_back(n0);
+        tile_k0.push_back(k0);
+      }
+    }
+    const unsigned num_tiles = tile_n0.size();
+    ClassStep<WeightStationary> step;
+    SystolicFeeder<a_spad_t, kQueueLen> a_feeder;
+    SystolicFeeder<b_spad_t, kQueueLen> b_feeder;
+    SystolicDrainer<c_spad_t, kQueueLen, true> c_drainer;
+    std::deque<out_dest> dests;
+
+    bool weight_held = false, in_held = false, out_held = false, held_last = false;
+    weight_t weight;
+    systolic_in_t<InType, ROWS, COLS, WeightStationary> in;
+    OutVector out;
+    unsigned a_started = 0, b_started = 0;
+    unsigned w_tile = 0, w_row = 0, loaded_tiles = 0, a_tile = 0, a_row = 0;
+    unsigned cycles = 0;
+    while (cycles < kMaxCycles) {
+      if (a_tile == num_tiles && dests.empty() && c_drainer.isIdle() && c_spad.isIdle()) {
+        break;
+      }
+      cycles++;
+      if (b_started < num_tiles && b_feeder.IssueDone()) {
+        unsigned n0 = tile_n0[b_started], k0 = tile_k0[b_started];
+        b_feeder.start(k0 * s.n + n0, min_u(ROWS, s.k - k0), s.n, 1, min_u(COLS, s.n - n0));
+        b_started++;
+      }
+      if (a_started < num_tiles && a_feeder.IssueDone()) {
+        unsigned k0 = tile_k0[a_started];
+        a_feeder.start(k0, s.m, s.k, 1, min_u(ROWS, s.k - k0));
+        a_started++;
+      }
+      feeder_cycle(a_feeder, a_spad);
+      feeder_cycle(b_feeder, b_spad);
+      drainer_cycle(c_drainer, c_spad);
+
+      if (!weight_held && b_feeder.valid() && w_tile < a_tile + 2) {
+        unsigned tile_rows = min_u(ROWS, s.k - tile_k0[w_tile]);
+        typename SystolicFeeder<b_spad_t, kQueueLen>::Vector v = b_feeder.peek();
+        b_feeder.pop();
+        weight.row = w_row;
+        weight.bank = w_tile % 2;
+        for (unsigned n = 0; n < COLS; n++) {
+          weight.weights[n] = v[n];
+        }
+        weight_held = true;
+        held_last = (w_row == tile_rows - 1);
+        if (++w_row == tile_rows) {
+          w_row = 0;
+          w_tile++;
+        }
+      }
+      if (!in_held && a_tile < loaded_tiles && a_feeder.valid()) {
+        typename SystolicFeeder<a_spad_t, kQueueLen>::Vector v = a_feeder.peek();
+        a_feeder.pop();
+        for (unsigned k = 0; k < ROWS; k++) {
+          in.a[k] = v[k];
+        }
+        in.bank = a_tile % 2;
+        in_held = true;
+        out_dest d = {a_row * s.n + tile_n0[a_tile], min_u(COLS, s.n - tile_n0[a_tile])};
+        dests.push_back(d);
+        if (++a_row == s.m) {
+          a_row = 0;
+          a_tile++;
+        }
+      }
+      if (out_held && c_drainer.ready()) {
+        typename SystolicDrainer<c_spad_t>::Vector v;
+        for (unsigned n = 0; n < COLS; n++) {
+          v[n] = out[n];
+        }
+        c_drainer.push(v, dests.front().addr, 1, dests.front().lanes);
+        dests.pop_front();
+        out_held = false;
+      }
+      if (!out_held) {
+        bool was_held = weight_held;
+        step(weight_held, weight, in_held, in, out_held, out);
+        if (was_held && !weight_held && held_last) {
+          loaded_tiles++;
+        }
+      }
+    }
+    return cycles;
+  }
+};
+
+// Tiles of ROWS rows by COLS columns of C, each streaming all K columns of A
+// and rows of B; the drainer stores every row of C once.
+template <>
+struct Gemm<OutputStationary> {
+  static unsigned run(const gemm_shape& s, a_spad_t& a_spad, b_spad_t& b_spad, c_spad_t& c_spad) {
+    std::vector<unsigned> tile_m0, tile_n0;
+    for (unsigned m0 = 0; m0 < s.m; m0 += ROWS) {
+      for (unsigned n0 = 0; n0 < s.n; n0 += COLS) {
+        tile_m0.push_back(m0);
+        tile_n0.push_back(n0);
+      }
+    }
+    const unsigned num_tiles = tile_m0.size();
+    ClassStep<OutputStationary> step;
+    SystolicFeeder<a_spad_t, kQueueLen> a_feeder;
+    SystolicFeeder<b_spad_t, kQueueLen> b_feeder;
+    SystolicDrainer<c_spad_t, kQueueLen> c_drainer;
+    std::deque<out_dest> dests;
+
+    bool weight_held = false, in_held = false, out_held = false;
+    weight_t weight;
+    systolic_in_t<InType, ROWS, COLS, OutputStationary> in;
+    OutVector out;
+    unsigned a_started = 0, b_started = 0, in_tile = 0, in_k = 0;
+    unsigned cycles = 0;
+    while (cycles < kMaxCycles) {
+      if (in_tile == num_tiles && dests.empty() && c_drainer.isIdle() && c_spad.isIdle()) {
+        break;
+      }
+      cycles++;
+      if (a_started < num_tiles && a_feeder.IssueDone()) {
+        unsigned m0 = tile_m0[a_started];
+        a_feeder.start(m0 * s.k, s.k, 1, s.k, min_u(ROWS, s.m - m0));
+        a_started++;
+      }
+      if (b_started < num_tiles && b_feeder.IssueDone()) {
+        unsigned n0 = tile_n0[b_started];
+        b_feeder.start(n0, s.k, s.n, 1, min_u(COLS, s.n - n0));
+        b_started++;
+      }
+      feeder_cycle(a_feeder, a_spad);
+      feeder_cycle(b_feeder, b_spad);
+      drainer_cycle(c_drainer, c_spad);
+
+      if (!in_held && a_feeder.valid() && b_feeder.valid()) {
+        typename SystolicFeeder<a_spad_t, kQueueLen>::Vector va = a_feeder.peek();
+        typename SystolicFeeder<b_spad_t, kQueueLen>::Vector vb = b_feeder.peek();
+        a_feeder.pop();
+        b_feeder.pop();
+        for (unsigned m = 0; m < ROWS; m++) {
+          in.a[m] = va[m];
+        }
+        for (unsigned n = 0; n < COLS; n++) {
+          in.b[n] = vb[n];
+        }
+        in.last = (in_k == s.k - 1);
+        in_held = true;
+        if (++in_k == s.k) {
+          unsigned m0 = tile_m0[in_tile], n0 = tile_n0[in_tile];
+          for (unsigned m = 0; m < ROWS; m++) {
+            out_dest d = {(m0 + m) * s.n + n0, (m0 + m < s.m) ? min_u(COLS, s.n - n0) : 0};
+            dests.push_back(d);
+          }
+          in_k = 0;
+          in_tile++;
+        }
+      }
+      if (out_held && c_drainer.ready()) {
+        typename SystolicDrainer<c_spad_t>::Vector v;
+        for (unsigned n = 0; n < COLS; n++) {
+          v[n] = out[n];
+        }
+        c_drainer.push(v, dests.front().addr, 1, dests.front().lanes);
+        dests.pop_front();
+        out_held = false;
+      }
+      if (!out_held) {
+        step(weight_held, weight, in_held, in, out_held, out);
+      }
+    }
+    return cycles;
+  }
+};
+
+// Inputs of one GEMM of the benchmark
+struct gemm_job {
+  gemm_shape s;
+  std::vector<int> a, b;
+};
+
+// C, row-major with n columns
+struct gemm_c {
+  unsigned n;
+  std::vector<int> c;
+  bool operator==(const gemm_c& other) const { return c == other.c; }
+};
+
+void scoreboard_diff(std::ostream& os, const gemm_c& expected, const gemm_c& observed) {
+  for (unsigned i = 0; i < expected.c.size(); i++) {
+    if (observed.c[i] != expected.c[i]) {
+      os << "C[" << i / expected.n << "][" << i % expected.n << "] is " << observed.c[i]
+         << ", expected " << expected.c[i];
+      return;
+    }
+  }
+}
+
+// Reference GEMM, run by the scoreboard
+gemm_c ref_gemm(const gemm_job& job) {
+  const gemm_shape& s = job.s;
+  gemm_c ref = {s.n, std::vector<int>(s.m * s.n, 0)};
+  for (unsigned m = 0; m < s.m; m++) {
+    for (unsigned n = 0; n < s.n; n++) {
+      for (unsigned k = 0; k < s.k; k++) {
+        ref.c[m * s.n + n] += job.a[m * s.k + k] * job.b[k * s.n + n];
+      }
+    }
+  }
+  return ref;
+}
+
+typedef nvhls::AsyncScoreboard<gemm_job, gemm_c> gemm_scoreboard_t;
+
+// Runs C = A * B with dataflow D, hands C to the scoreboard stamped with the
+// benchmark cycle at which it is complete, and returns the utilization
+template <systolic_dataflow D>
+double run_gemm(const gemm_shape& s, gemm_scoreboard_t& sb, unsigned long& cycle) {
+  gemm_job job = {s, std::vector<int>(s.m * s.k), std::vector<int>(s.k * s.n)};
+  for (unsigned i = 0; i < job.a.size(); i++) {
+    job.a[i] = small_rand();
+  }
+  for (unsigned i = 0; i < job.b.size(); i++) {
+    job.b[i] = small_rand();
+  }
+  a_spad_t a_spad;
+  b_spad_t b_spad;
+  c_spad_t c_spad;
+  spad_fill(a_spad, job.a);
+  spad_fill(b_spad, job.b);
+  spad_fill(c_spad, std::vector<int>(s.m * s.n, 0));
+
+  unsigned cycles = Gemm<D>::run(s, a_spad, b_spad, c_spad);
+  cycle += cycles;
+  gemm_c c = {s.n, std::vector<int>(s.m * s.n)};
+  for (unsigned i = 0; i < c.c.size(); i++) {
+    c.c[i] = spad_read(c_spad, i);
+  }
+  sb.Check(job, c, cycle);
+  return static_cast<double>(s.m) * s.n * s.k / (static_cast<double>(cycles) * ROWS * COLS);
+}
+
+// Check 2 * i of the scoreboard is the weight-stationary GEMM of shape i,
+// check 2 * i + 1 the output-stationary one
+int run_gemm_benchmark() {
+  const gemm_shape shapes[] = {{16, 16, 16}, {64, 8, 8}, {8, 8, 64}, {32, 32, 4}, {13, 10, 7}};
+  const unsigned num_shapes = sizeof(shapes) / sizeof(shapes[0]);
+  double ws[num_shapes], os[num_shapes];
+  gemm_scoreboard_t sb("gemm", ref_gemm);
+  unsigned long cycle = 0;
+  std::cout << "GEMM on a " << ROWS << "x" << COLS << " array, utilization:" << std::endl;
+  std::cout << "       M x   N x   K        WS      OS" << std::endl;
+  for (unsigned i = 0; i < num_shapes; i++) {
+    ws[i] = run_gemm<WeightStationary>(shapes[i], sb, cycle);
+    os[i] = run_gemm<OutputStationary>(shapes[i], sb, cycle);
+    std::cout << std::setw(8) << shapes[i].m << " x" << std::setw(4) << shapes[i].n << " x"
+              << std::setw(4) << shapes[i].k << std::fixed << std::setprecision(3)
+              << std::setw(10) << ws[i] << std::setw(8) << os[i] << std::endl;
+  }
+  std::cout.unsetf(std::ios::floatfield);
+  if (sb.Finish() != 0) {
+    return 1;
+  }
+  // Long streams keep the array busy: many rows of A for weight stationary,
+  // a long K for output stationary
+  if (ws[1] < 0.75 || os[2] < 0.75) {
+    std::cout << "ERROR: utilization of a streaming shape below 0.75" << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+CCS_MAIN(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+
+  ClassStep<WeightStationary> ws;
+  ClassStep<OutputStationary> os;
+  DutStep dut;
+  int errors = CoreTest<WeightStationary>::run(ws);
+  errors += CoreTest<OutputStationary>::run(os);
+  errors += CoreTest<DATAFLOW>::run(dut);
+  errors += run_gemm_benchmark();
+
+  if (errors != 0) {
+    DCOUT("TESTBENCH FAIL" << endl);
+    CCS_RETURN(1);
+  }
+  DCOUT("CMODEL PASS" << endl);
+  CCS_RETURN(0);
+}
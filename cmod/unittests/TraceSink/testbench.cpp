@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <fstream>
+#include <sstream>
+#include <systemc.h>
+#include <nvhls_module.h>
+#include <nvhls_trace_sink.h>
+
+// Traces through BinaryTraceSink and checks the records with
+// PrintBinaryTrace(). With a file argument, sim_test only pretty-prints that
+// trace file: ./sim_test trace.bin
+
+#define NUM_CYCLES 100
+
+class TraceDut : public match::Module {
+ public:
+  SC_HAS_PROCESS(TraceDut);
+  TraceDut(sc_module_name name_) : match::Module(name_) {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+    this->SetTraceLevel(2);
+  }
+
+  void run() {
+    int cycle = 0;
+    wait();
+    while (1) {
+      wait();
+      T(1) << "cycle " << cycle << EndT;
+      T(3) << "not traced " << cycle << EndT;  // Above the trace level
+      if (cycle % 10 == 0)
+        T(2) << "tenth " << cycle << EndT;
+      cycle++;
+    }
+  }
+};
+
+SC_MODULE(testbench) {
+  TraceDut dut1, dut2;
+  sc_clock clk;
+  sc_signal<bool> rst;
+
+  SC_CTOR(testbench)
+      : dut1("dut1"), dut2("dut2"),
+        clk("clk", 1, SC_NS, 0.5, 0, SC_NS, true), rst("rst") {
+    dut1.clk(clk);
+    dut1.rst(rst);
+    dut2.clk(clk);
+    dut2.rst(rst);
+    SC_THREAD(run);
+  }
+
+  void run() {
+    rst = 0;
+    wait(2, SC_NS);
+    rst = 1;
+    wait(NUM_CYCLES, SC_NS);
+    sc_stop();
+  }
+};
+
+int sc_main(int argc, char *argv[]) {
+  if (argc > 1) {
+    std::ifstream in(argv[1], std::ios::binary);
+    return match::PrintBinaryTrace(in, std::cout) ? 0 : 1;
+  }
+
+  int errors = 0;
+  testbench tb("tb");
+  match::BinaryTraceSink* sink = new match::BinaryTraceSink("trace.output.bin", 256);
+  match::Tracer::SetSink(sink);
+  sc_start();
+  match::Tracer::SetSink(NULL);
+  delete sink;
+
+  std::ifstream in("trace.output.bin", std::ios::binary);
+  std::stringstream text;
+  if (!match::PrintBinaryTrace(in, text)) {
+    cout << "Could not read trace.output.bin" << endl;
+    errors++;
+  }
+  int num_cycle = 0, num_tenth = 0, num_dut1 = 0;
+  std::string line;
+  while (std::getline(text, line)) {
+    if (line.find(" ps: tb.dut1: ") != std::string::npos)
+      num_dut1++;
+    else if (line.find(" ps: tb.dut2: ") == std::string::npos)
+      errors++;
+    if (line.find(": cycle ") != std::string::npos)
+      num_cycle++;
+    else if (line.find(": tenth ") != std::string::npos)
+      num_tenth++;
+    else
+      errors++;
+  }
+  std::ifstream in_level1("trace.output.bin", std::ios::binary);
+  std::stringstream text_level1;
+  match::PrintBinaryTrace(in_level1, text_level1, 1);
+  if (text_level1.str().find("tenth") != std::string::npos)
+    errors++;
+  cout << num_cycle << " cycle messages, " << num_tenth << " tenth messages" << endl;
+  if (num_cycle == 0 || num_tenth == 0 || num_cycle != 10 * num_tenth ||
+      2 * num_dut1 != num_cycle + num_tenth)
+    errors++;
+
+  if (errors == 0)
+    cout << "Simulation PASSED" << endl;
+  else
+    cout << "Simulation FAILED" << endl;
+  return errors;
+}
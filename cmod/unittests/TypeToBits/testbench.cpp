@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <nvhls_int.h>
+#include <nvhls_types.h>
+#include <TypeToBits.h>
+#include <testbench/nvhls_rand.h>
+#include <ctime>
+
+// Checks that the packed_bits fast path of TypeToBits, BitsToType,
+// TypeToNVUINT and NVUINTToType produces the same bits as the Marshaller for
+// random values of integer types and of a struct that opts in, that
+// nvhls::marshall_array produces the same bits as marshalling the elements
+// one by one, and reports the speedups.
+
+#define NUM_ITERS 10000
+
+struct Flit {
+  NVUINTW(5) dest;
+  NVINTW(7) delta;
+  NVUINTW(40) data;
+  bool last;
+  static const unsigned int width = 5 + 7 + 40 + 1;
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    m& dest;
+    m& delta;
+    m& data;
+    m& last;
+  }
+};
+
+// A struct that marshalls like Flit, without packed_bits
+struct SlowFlit : public Flit {};
+
+namespace nvhls {
+template <>
+struct packed_bits<Flit> {
+  static const bool value = true;
+  static const unsigned int words = 1;
+  static void Pack(const Flit& in, uint64* w) {
+    w[0] = in.dest.to_uint64() | ((in.delta.to_uint64() & 0x7f) << 5) |
+           (in.data.to_uint64() << 12) | (static_cast<uint64>(in.last) << 52);
+  }
+  static void Unpack(const uint64* w, Flit& out) {
+    out.dest = w[0] & 0x1f;
+    out.delta = (w[0] >> 5) & 0x7f;
+    out.data = (w[0] >> 12) & 0xffffffffffull;
+    out.last = (w[0] >> 52) & 1;
+  }
+};
+}  // namespace nvhls
+
+template <typename T>
+NVUINTW(Wrapped<T>::width) RandomBits() {
+  static const int W = Wrapped<T>::width;
+  NVUINTW(W) r = 0;
+  for (int lo = 0; lo < W; lo += 32) {
+    int hi = (lo + 31 < W) ? lo + 31 : W - 1;
+    r.range(hi, lo) = static_cast<uint64>(static_cast<unsigned int>(rand()));
+  }
+  return r;
+}
+
+// Compares the fast path of T with the Marshaller on random values
+template <typename T>
+int CheckType(const char* name) {
+  static const int W = Wrapped<T>::width;
+  typedef NVUINTW(W) U;
+  int errors = 0;
+  for (int i = 0; i < NUM_ITERS; i++) {
+    U u = RandomBits<T>();
+    sc_lv<W> ref_bits = nvhls::type_bits<U, false>::ToBits(u);
+    T ref = nvhls::type_bits<T, false>::FromBits(ref_bits);
+    T fast = NVUINTToType<T>(u);
+    sc_lv<W> ref_back = nvhls::type_bits<T, false>::ToBits(ref);
+    if (TypeToBits<T>(fast) != ref_back || BitsToType<T>(ref_bits) != ref ||
+        TypeToNVUINT<T>(ref) != u) {
+      errors++;
+    }
+  }
+  cout << name << ": " << (nvhls::packed_bits<T>::value ? "packed" : "marshalled")
+       << ", " << errors << " mismatches" << endl;
+  return errors;
+}
+
+bool operator!=(const Flit& a, const Flit& b) {
+  return a.dest != b.dest || a.delta != b.delta || a.data != b.data || a.last != b.last;
+}
+
+// N lanes of T marshalled with marshall_array, and the same lanes
+// marshalled one by one
+template <typename T, unsigned int N>
+struct Lanes {
+  T data[N];
+  static const unsigned int width = Wrapped<T>::width * N;
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    nvhls::marshall_array(m, data);
+  }
+};
+
+template <typename T, unsigned int N>
+struct SlowLanes {
+  T data[N];
+  static const unsigned int width = Wrapped<T>::width * N;
+
+  template <unsigned int Size>
+  void Marshall(Marshaller<Size>& m) {
+    for (unsigned int i = 0; i < N; i++) m& data[i];
+  }
+};
+
+// Compares marshall_array with the element-by-element Marshall on random
+// lanes in both directions
+template <typename T, unsigned int N>
+int CheckLanes(const char* name) {
+  typedef Lanes<T, N> L;
+  typedef SlowLanes<T, N> S;
+  static const int W = L::width;
+  int errors = 0;
+  for (int i = 0; i < NUM_ITERS / 10; i++) {
+    NVUINTW(W) u = RandomBits<L>();
+    sc_lv<W> bits = nvhls::type_bits<NVUINTW(W), false>::ToBits(u);
+    L fast = nvhls::type_bits<L, false>::FromBits(bits);
+    S slow = nvhls::type_bits<S, false>::FromBits(bits);
+    for (unsigned int k = 0; k < N; k++) {
+      if (fast.data[k] != slow.data[k]) errors++;
+    }
+    if (nvhls::type_bits<L, false>::ToBits(fast) != bits) errors++;
+  }
+  cout << name << ": " << (nvhls::packed_bits_array<T, N>::value ? "packed" : "marshalled")
+       << ", " << errors << " mismatches" << endl;
+  return errors;
+}
+
+// Times Marshaller round trips of lanes of type L
+template <typename L>
+double TimeLanes(NVUINTW(L::width) u) {
+  std::clock_t start = std::clock();
+  for (int i = 0; i < NUM_ITERS; i++) {
+    sc_lv<L::width> bits = nvhls::type_bits<NVUINTW(L::width), false>::ToBits(u);
+    L l = nvhls::type_bits<L, false>::FromBits(bits);
+    u = nvhls::type_bits<NVUINTW(L::width), false>::FromBits(
+            nvhls::type_bits<L, false>::ToBits(l)) + 1;
+  }
+  double t = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+  return (u == 0) ? -t : t;  // Keeps u live
+}
+
+// Times TypeToNVUINT/NVUINTToType round trips of T
+template <typename T>
+double TimeRoundTrips(NVUINTW(Wrapped<T>::width) u) {
+  std::clock_t start = std::clock();
+  for (int i = 0; i < 50 * NUM_ITERS; i++) {
+    u = TypeToNVUINT<T>(NVUINTToType<T>(u)) + 1;
+  }
+  double t = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+  return (u == 0) ? -t : t;  // Keeps u live
+}
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  int errors = 0;
+  errors += CheckType<bool>("bool");
+  errors += CheckType<NVUINTW(1)>("NVUINT1");
+  errors += CheckType<NVUINTW(17)>("NVUINT17");
+  errors += CheckType<NVINTW(23)>("NVINT23");
+  errors += CheckType<NVUINTW(64)>("NVUINT64");
+  errors += CheckType<NVINTW(64)>("NVINT64");
+  errors += CheckType<NVUINTW(100)>("NVUINT100");
+  errors += CheckType<NVINTW(130)>("NVINT130");
+  errors += CheckType<sc_uint<33> >("sc_uint<33>");
+  errors += CheckType<Flit>("Flit");
+
+  errors += CheckLanes<NVUINTW(3), 100>("NVUINT3 x 100");
+  errors += CheckLanes<NVINTW(23), 17>("NVINT23 x 17");
+  errors += CheckLanes<NVUINTW(70), 5>("NVUINT70 x 5");
+  errors += CheckLanes<bool, 65>("bool x 65");
+  errors += CheckLanes<Flit, 9>("Flit x 9");
+  errors += CheckLanes<SlowFlit, 4>("SlowFlit x 4");
+
+  if (!nvhls::packed_bits<Flit>::value || nvhls::packed_bits<SlowFlit>::value)
+    errors++;
+  double fast = TimeRoundTrips<Flit>(1);
+  double slow = TimeRoundTrips<SlowFlit>(1);
+  cout << "Flit round trips: packed " << fast << " s, marshalled " << slow << " s" << endl;
+  double bulk = TimeLanes<Lanes<NVUINTW(3), 100> >(1);
+  double lanes = TimeLanes<SlowLanes<NVUINTW(3), 100> >(1);
+  cout << "NVUINT3 x 100 lane round trips: marshall_array " << bulk << " s, one by one "
+       << lanes << " s" << endl;
+
+  if (errors != 0) {
+    DCOUT("TESTBENCH FAIL" << endl);
+  } else {
+    DCOUT("TESTBENCH PASS" << endl);
+  }
+  return errors != 0;
+}
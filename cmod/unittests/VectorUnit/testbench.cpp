@@ -16,6 +16,9 @@
 #include <stdio.h>
 #include "VectorUnit.h"
 #include <match_scverify.h>
+#include <nvhls_bfp_vector.h>
+#include <ctime>
+#include <deque>
 
 #ifndef NUM_ITER
 #define NUM_ITER 10000
@@ -29,7 +32,372 @@ void get_rand_vector(VectorType& data) {
 }
 
 
+#ifndef NUM_BENCH_ITER
+#define NUM_BENCH_ITER 200000
+#endif
+
+template <typename T>
+void get_rand_scalar(T& data) {
+  data = (static_cast<uint64>(rand()) << 40) ^ (static_cast<uint64>(rand()) << 20) ^ rand();
+}
+
+template <typename T, unsigned int L>
+void get_rand_vector64(nvhls::nv_scvector<T, L>& data) {
+  for (unsigned i = 0; i < L; i++) {
+    get_rand_scalar(data[i]);
+  }
+}
+
+// Checks every vector operation against element-by-element reference loops
+// for a mix of widths and signedness; the vector functions use the host
+// kernels in C++ simulation for nvint/nvuint of up to 64 bits
+template <typename T1, typename T2, typename TO, unsigned int L>
+void check_vector_ops() {
+  typedef nvhls::nv_scvector<T1, L> V1;
+  typedef nvhls::nv_scvector<T2, L> V2;
+  typedef nvhls::nv_scvector<TO, L> VO;
+  for (int iter = 0; iter < 1000; iter++) {
+    V1 a;
+    V2 b;
+    VO c, out, ref;
+    TO s_out, s_ref;
+    T2 acc;
+    get_rand_vector64(a);
+    get_rand_vector64(b);
+    get_rand_vector64(c);
+    get_rand_scalar(acc);
+
+    nvhls::vector_mul<T1, T2, TO, L, true>(a, b, out);
+    for (unsigned i = 0; i < L; i++) ref[i] = a[i] * b[i];
+    assert(out == ref);
+    nvhls::vector_add<T1, T2, TO, L, true>(a, b, out);
+    for (unsigned i = 0; i < L; i++) ref[i] = a[i] + b[i];
+    assert(out == ref);
+    nvhls::vector_sub<T1, T2, TO, L, true>(a, b, out);
+    for (unsigned i = 0; i < L; i++) ref[i] = a[i] - b[i];
+    assert(out == ref);
+    nvhls::vector_mac<T1, T2, TO, TO, L, true>(a, b, c, out);
+    for (unsigned i = 0; i < L; i++) ref[i] = a[i] * b[i] + c[i];
+    assert(out == ref);
+
+    nvhls::reduction<T1, TO, L, true>(a, s_out);
+    s_ref = 0;
+    for (unsigned i = 0; i < L; i++) s_ref += a[i];
+    assert(s_out == s_ref);
+    nvhls::dp<T1, T2, TO, L, true>(a, b, s_out);
+    s_ref = 0;
+    for (unsigned i = 0; i < L; i++) s_ref += a[i] * b[i];
+    assert(s_out == s_ref);
+    nvhls::dpacc<T1, T2, T2, TO, L, true>(a, b, acc, s_out);
+    s_ref = acc;
+    for (unsigned i = 0; i < L; i++) s_ref += a[i] * b[i];
+    assert(s_out == s_ref);
+  }
+}
+
+// Checks the adder-tree policies and the pipelined trees against reference
+// loops
+template <typename T1, typename T2, typename TO, unsigned int L, unsigned int K>
+void check_adder_trees() {
+  typedef nvhls::nv_scvector<T1, L> V1;
+  typedef nvhls::nv_scvector<T2, L> V2;
+  typedef nvhls::PipelinedDP<T1, T2, TO, L, K> PipeDP;
+  nvhls::PipelinedReduction<T1, TO, L, K> pipe_reduce;
+  PipeDP pipe_dp;
+  std::deque<TO> expected_reduce, expected_dp;
+  std::deque<bool> expected_valid(PipeDP::Latency, false);
+  for (int iter = 0; iter < 1000; iter++) {
+    V1 a;
+    V2 b;
+    TO out, ref_reduce = 0, ref_dp = 0;
+    get_rand_vector64(a);
+    get_rand_vector64(b);
+    for (unsigned i = 0; i < L; i++) {
+      ref_reduce += a[i];
+      ref_dp += a[i] * b[i];
+    }
+
+    nvhls::reduction<T1, TO, L, nvhls::AdderTreeBalanced>(a, out);
+    assert(out == ref_reduce);
+    nvhls::reduction<T1, TO, L, nvhls::AdderTreeCompressor>(a, out);
+    assert(out == ref_reduce);
+    nvhls::dp<T1, T2, TO, L, nvhls::AdderTreeBalanced>(a, b, out);
+    assert(out == ref_dp);
+    nvhls::dp<T1, T2, TO, L, nvhls::AdderTreeCompressor>(a, b, out);
+    assert(out == ref_dp);
+
+    // pipelined trees, with bubbles
+    bool in_valid = (rand() % 4 != 0);
+    TO reduce_out, dp_out;
+    bool reduce_valid = pipe_reduce.run(in_valid, a, reduce_out);
+    bool dp_valid = pipe_dp.run(in_valid, a, b, dp_out);
+    expected_valid.push_back(in_valid);
+    if (in_valid) {
+      expected_reduce.push_back(ref_reduce);
+      expected_dp.push_back(ref_dp);
+    }
+    bool exp_valid = expected_valid.front();
+    expected_valid.pop_front();
+    assert(reduce_valid == exp_valid);
+    assert(dp_valid == exp_valid);
+    if (exp_valid) {
+      assert(reduce_out == expected_reduce.front());
+      assert(dp_out == expected_dp.front());
+      expected_reduce.pop_front();
+      expected_dp.pop_front();
+    }
+  }
+}
+
+// Fills a vector with values whose magnitude varies from block to block, so
+// that the quantized blocks get different exponents
+template <typename T, unsigned int L>
+void get_rand_bfp_input(nvhls::nv_scvector<T, L>& data, unsigned int block_size) {
+  const unsigned int W = Wrapped<T>::width;
+  unsigned int drop = 0;
+  for (unsigned i = 0; i < L; i++) {
+    if (i % block_size == 0) drop = rand() % W;
+    T x;
+    get_rand_scalar(x);
+    data[i] = x >> drop;
+  }
+}
+
+// Checks quantization, packing and the block-floating-point dot products
+// against int64 reference arithmetic
+template <typename In1, typename In2, typename M1, typename M2, unsigned int EW, unsigned int L,
+          unsigned int B, typename TO, typename TE>
+void check_bfp() {
+  typedef nvhls::nv_bfpvector<M1, EW, L, B> BV1;
+  typedef nvhls::nv_bfpvector<M2, EW, L, B> BV2;
+  const long long max1 = (1LL << (Wrapped<M1>::width - Wrapped<M1>::is_signed)) - 1;
+  for (int iter = 0; iter < 1000; iter++) {
+    nvhls::nv_scvector<In1, L> x;
+    nvhls::nv_scvector<In2, L> y;
+    get_rand_bfp_input(x, B);
+    get_rand_bfp_input(y, B);
+    BV1 a;
+    BV2 b;
+    a.quantize(x);
+    b.quantize(y);
+
+    // |x - m * 2^e| <= 2^(e-1), unless the mantissa saturated
+    for (unsigned i = 0; i < L; i++) {
+      long long e = a.block_exp(i).to_int64();
+      long long m = a.mant[i].to_int64();
+      long long err = x[i].to_int64() - (m << e);
+      assert(e >= 0);
+      assert((2 * err <= (1LL << e) && -2 * err <= (1LL << e)) || m == max1);
+    }
+
+    // packed representation round trip
+    BV1 a_copy(a.to_rawbits());
+    assert(a_copy == a);
+
+    long long partial[L / B + 1], e[L / B + 1];
+    for (unsigned blk = 0; blk < L / B; blk++) {
+      partial[blk] = 0;
+      for (unsigned j = 0; j < B; j++) {
+        partial[blk] += a.mant[blk * B + j].to_int64() * b.mant[blk * B + j].to_int64();
+      }
+      e[blk] = a.exp[blk].to_int64() + b.exp[blk].to_int64();
+    }
+    TO acc;
+    get_rand_scalar(acc);
+    acc = acc >> 2;
+    TE acc_exp = rand() % (1 << EW);
+    partial[L / B] = acc.to_int64();
+    e[L / B] = acc_exp.to_int64();
+
+    for (unsigned with_acc = 0; with_acc < 2; with_acc++) {
+      unsigned n = L / B + with_acc;
+      long long e_max = e[0], ref = 0;
+      for (unsigned blk = 0; blk < n; blk++) e_max = std::max(e_max, e[blk]);
+      for (unsigned blk = 0; blk < n; blk++) {
+        long long shift = std::min(e_max - e[blk], 63LL);
+        ref += (partial[blk] >> shift);
+      }
+      TO out;
+      TE out_exp;
+      if (with_acc)
+        nvhls::dpacc(a, b, acc, acc_exp, out, out_exp);
+      else
+        nvhls::dp(a, b, out, out_exp);
+      TO out_ref = ref;
+      assert(out == out_ref);
+      assert(out_exp.to_int64() == e_max);
+    }
+  }
+}
+
+template <typename T>
+__int128 ref_value(const T& v) {
+  return Wrapped<T>::is_signed ? static_cast<__int128>(v.to_int64())
+                               : static_cast<__int128>(v.to_uint64());
+}
+
+// Reference requantization: floor division by 2^shift, rounding up past
+// half and at half towards even, then clamping to the range of TO
+template <typename TO>
+TO ref_requant(__int128 x, unsigned int shift, bool nearest, bool saturate) {
+  const unsigned int W = Wrapped<TO>::width;
+  __int128 q = x >> shift;
+  if (nearest && shift > 0) {
+    __int128 rem = x - q * (static_cast<__int128>(1) << shift);
+    __int128 half = static_cast<__int128>(1) << (shift - 1);
+    if (rem > half || (rem == half && (q & 1))) q++;
+  }
+  if (saturate) {
+    __int128 hi = Wrapped<TO>::is_signed ? (static_cast<__int128>(1) << (W - 1)) - 1
+                                         : (static_cast<__int128>(1) << W) - 1;
+    __int128 lo = Wrapped<TO>::is_signed ? -(static_cast<__int128>(1) << (W - 1)) : 0;
+    q = (q > hi) ? hi : ((q < lo) ? lo : q);
+  }
+  TO out = static_cast<uint64>(q);
+  return out;
+}
+
+// Checks the saturating and rounding vector operations for every policy
+// against 128-bit reference arithmetic
+template <typename T1, typename T2, typename T3, typename TO, unsigned int L, unsigned int S>
+void check_quant_ops() {
+  typedef nvhls::nv_scvector<T1, L> V1;
+  typedef nvhls::nv_scvector<T2, L> V2;
+  typedef nvhls::nv_scvector<T3, L> V3;
+  typedef nvhls::nv_scvector<TO, L> VO;
+  typedef nvhls::Requant<S, nvhls::RoundNearestEven, true> NearestSat;
+  typedef nvhls::Requant<S, nvhls::RoundTruncate, true> TruncSat;
+  typedef nvhls::Requant<S, nvhls::RoundNearestEven, false> NearestWrap;
+  for (int iter = 0; iter < 1000; iter++) {
+    V1 a;
+    V2 b;
+    V3 c;
+    VO out;
+    get_rand_vector64(a);
+    get_rand_vector64(b);
+    get_rand_vector64(c);
+
+    nvhls::vector_add_quant<NearestSat>(a, b, out);
+    for (unsigned i = 0; i < L; i++)
+      assert(out[i] == ref_requant<TO>(ref_value(a[i]) + ref_value(b[i]), S, true, true));
+    nvhls::vector_sub_quant<TruncSat>(a, b, out);
+    for (unsigned i = 0; i < L; i++)
+      assert(out[i] == ref_requant<TO>(ref_value(a[i]) - ref_value(b[i]), S, false, true));
+    nvhls::vector_mul_quant<NearestWrap>(a, b, out);
+    for (unsigned i = 0; i < L; i++)
+      assert(out[i] == ref_requant<TO>(ref_value(a[i]) * ref_value(b[i]), S, true, false));
+    nvhls::vector_mac_quant<NearestSat>(a, b, c, out);
+    for (unsigned i = 0; i < L; i++)
+      assert(out[i] == ref_requant<TO>(ref_value(a[i]) * ref_value(b[i]) + ref_value(c[i]), S,
+                                       true, true));
+    nvhls::vector_mac_quant<TruncSat>(a, b, c, out);
+    for (unsigned i = 0; i < L; i++)
+      assert(out[i] == ref_requant<TO>(ref_value(a[i]) * ref_value(b[i]) + ref_value(c[i]), S,
+                                       false, true));
+  }
+}
+
+// Checks the fixed lane permutations and the run-time gather against
+// reference loops
+template <typename T, unsigned int L>
+void check_permute() {
+  typedef nvhls::nv_scvector<T, L> V;
+  typedef nvhls::nv_scvector<NVUINTW(nvhls::index_width<L>::val), L> Index;
+  for (int iter = 0; iter < 1000; iter++) {
+    V a, b, out, ref;
+    nvhls::nv_scvector<T, 2 * L> out2;
+    Index index;
+    get_rand_vector64(a);
+    get_rand_vector64(b);
+
+    nvhls::vector_permute<nvhls::PermuteRotate<3> >(a, out);
+    for (unsigned i = 0; i < L; i++) ref[i] = a[(i + 3) % L];
+    assert(out == ref);
+    nvhls::vector_permute<nvhls::PermuteReverse>(a, out);
+    for (unsigned i = 0; i < L; i++) ref[i] = a[L - 1 - i];
+    assert(out == ref);
+    nvhls::vector_permute<nvhls::PermuteBroadcast<L - 1> >(a, out);
+    for (unsigned i = 0; i < L; i++) ref[i] = a[L - 1];
+    assert(out == ref);
+    // Transposes of 2 x (L / 2): the interleave of the two halves
+    nvhls::vector_permute<nvhls::PermuteTranspose<2, L / 2> >(a, out);
+    for (unsigned i = 0; i < L; i++) ref[i] = a[(i % 2) * (L / 2) + i / 2];
+    assert(out == ref);
+    nvhls::vector_permute<nvhls::PermuteInterleave<2> >(a, out);
+    assert(out == ref);
+    nvhls::vector_permute<nvhls::PermuteDeinterleave<2> >(ref, out);
+    assert(out == a);
+    nvhls::vector_interleave(a, b, out2);
+    for (unsigned i = 0; i < L; i++) assert(out2[2 * i] == a[i] && out2[2 * i + 1] == b[i]);
+
+    for (unsigned i = 0; i < L; i++) index[i] = rand() % L;
+    nvhls::vector_gather(a, index, out);
+    for (unsigned i = 0; i < L; i++) ref[i] = a[index[i]];
+    assert(out == ref);
+  }
+}
+
+// Checks the transpose of every R x C tile of a vector
+template <typename T, unsigned int L, unsigned int R, unsigned int C>
+void check_transpose_tiles() {
+  nvhls::nv_scvector<T, L> a, out;
+  get_rand_vector64(a);
+  nvhls::vector_permute<nvhls::PermuteTranspose<R, C> >(a, out);
+  for (unsigned t = 0; t < L; t += R * C)
+    for (unsigned r = 0; r < R; r++)
+      for (unsigned c = 0; c < C; c++) assert(out[t + c * R + r] == a[t + r * C + c]);
+}
+
+// Dot-product throughput of a 64-element int8 vector
+void bench_dp() {
+  typedef nvhls::nv_scvector<NVINT8, 64> V;
+  V a, b;
+  get_rand_vector(a);
+  get_rand_vector(b);
+  NVINT32 out, checksum = 0;
+  std::clock_t start = std::clock();
+  for (int i = 0; i < NUM_BENCH_ITER; i++) {
+    a[i % 64] = i;
+    nvhls::dp<NVINT8, NVINT8, NVINT32, 64, true>(a, b, out);
+    checksum ^= out;
+  }
+  double seconds = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+  std::cout << "dp<NVINT8, 64>: " << (NUM_BENCH_ITER / seconds) << " dot products/s (checksum "
+            << checksum << ")" << std::endl;
+}
+
 CCS_MAIN(int argc, char *argv[]) {
+    check_vector_ops<NVUINT8, NVUINT8, NVUINT32, 16>();
+    check_vector_ops<NVINT8, NVINT8, NVINT32, 13>();
+    check_vector_ops<NVUINT16, NVINT4, NVINT20, 5>();
+    check_vector_ops<NVINT32, NVUINT32, NVUINT32, 9>();
+    check_vector_ops<NVUINT32, NVUINT32, NVUINT64, 8>();
+    check_vector_ops<NVINT40, NVINT30, NVINT64, 3>();
+    check_vector_ops<NVUINT64, NVINT64, NVINT48, 7>();
+    check_vector_ops<NVUINT8, NVUINT8, NVUINT128, 4>();
+    check_adder_trees<NVUINT8, NVUINT8, NVUINT20, 64, 1>();
+    check_adder_trees<NVINT8, NVINT8, NVINT22, 256, 3>();
+    check_adder_trees<NVINT16, NVUINT4, NVINT24, 100, 2>();
+    check_adder_trees<NVUINT32, NVUINT32, NVUINT64, 7, 8>();
+    check_adder_trees<NVUINT8, NVINT8, NVINT16, 1, 1>();
+    check_adder_trees<NVUINT8, NVUINT8, NVUINT128, 3, 1>();
+    check_bfp<NVINT16, NVINT16, NVINT8, NVINT8, 6, 64, 16, NVINT24, NVINT7>();
+    check_bfp<NVINT16, NVINT12, NVINT8, NVINT4, 5, 32, 8, NVINT20, NVINT6>();
+    check_bfp<NVUINT12, NVUINT12, NVUINT4, NVUINT4, 5, 12, 4, NVUINT12, NVINT6>();
+    check_bfp<NVINT32, NVINT16, NVINT8, NVINT8, 6, 8, 8, NVINT24, NVINT7>();
+    check_permute<NVUINT8, 16>();
+    check_permute<NVINT20, 12>();
+    check_permute<NVUINT64, 32>();
+    check_permute<NVUINT128, 6>();
+    check_transpose_tiles<NVUINT8, 32, 4, 4>();
+    check_transpose_tiles<NVINT20, 24, 2, 3>();
+    check_quant_ops<NVINT8, NVINT8, NVINT16, NVINT8, 16, 6>();
+    check_quant_ops<NVUINT8, NVINT8, NVINT20, NVUINT8, 13, 4>();
+    check_quant_ops<NVINT16, NVINT16, NVINT32, NVINT16, 9, 1>();
+    check_quant_ops<NVUINT16, NVUINT12, NVUINT8, NVUINT10, 7, 0>();
+    check_quant_ops<NVINT32, NVINT32, NVINT40, NVINT24, 5, 20>();
+    bench_dp();
+
     InVectorType in1, in2, in3;
     OpType op;
     OutVectorType out, out_ref;
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __WHVCMESHROUTERTOP_H__
+#define __WHVCMESHROUTERTOP_H__
+
+#include <systemc.h>
+#include <nvhls_connections.h>
+#include <nvhls_packet.h>
+#include <WHVCRouter.h>
+
+#ifndef ROUTING_ALGO
+#define ROUTING_ALGO XYRouting
+#endif
+#ifndef LOOKAHEAD
+#define LOOKAHEAD false
+#endif
+#ifndef MULTICAST
+#define MULTICAST false
+#endif
+// Two VCs with VC 0 as express VC, or a single VC without packet id
+#ifdef EXPRESS_VC
+#define NUM_VCHANNELS 2
+#define PACKETIDWIDTH 1
+#else
+#define EXPRESS_VC -1
+#define NUM_VCHANNELS 1
+#define PACKETIDWIDTH 0
+#endif
+// Four local ports with a binary local destination, or one 1-hot local port
+#ifdef CONCENTRATED
+#define NUM_LPORTS 4
+#else
+#define CONCENTRATED false
+#define NUM_LPORTS 1
+#endif
+
+SC_MODULE(WHVCMeshRouterTop) {
+ public:
+  sc_in_clk clk;
+  sc_in<bool> rst;
+
+  enum {
+    kNumVChannels = NUM_VCHANNELS,
+    kBufferSize = 8,
+    kNumLPorts = NUM_LPORTS,
+    kNumRPorts = 4,
+    kCoordWidth = 2,
+    kPosX = 1,
+    kPosY = 1,
+    kLocalWidth = CONCENTRATED ? nvhls::index_width<kNumLPorts>::val : kNumLPorts,
+    kLogBufferSize = nvhls::index_width<kBufferSize+1>::val,
+    kNumPorts = kNumLPorts + kNumRPorts,
+    kNumCredits = (kNumLPorts + kNumRPorts)*kNumVChannels
+  };
+  typedef NVUINTC(kLogBufferSize) Credit_t;
+  typedef NVUINTC(1) Credit_ret_t;
+
+  typedef Flit<64, 0, 0, PACKETIDWIDTH, FlitId2bit, WormHole> Flit_t;
+  WHVCMeshRouter<kNumLPorts, kNumVChannels, kBufferSize, Flit_t, kCoordWidth, ROUTING_ALGO, LOOKAHEAD, EXPRESS_VC, MULTICAST, CONCENTRATED> router;
+
+  Connections::In<Flit_t> in_port[kNumPorts];
+  Connections::Out<Flit_t> out_port[kNumPorts];
+  Connections::In<Credit_ret_t> in_credit[kNumCredits];
+  Connections::Out<Credit_ret_t> out_credit[kNumCredits];
+
+  SC_HAS_PROCESS(WHVCMeshRouterTop);
+  WHVCMeshRouterTop(sc_module_name name)
+      : sc_module(name), clk("clk"), rst("rst"), router("router", kPosX, kPosY) {
+    router.clk(clk);
+    router.rst(rst);
+
+    for (int i = 0; i < kNumPorts; i++) {
+      router.in_port[i](in_port[i]);
+      router.out_port[i](out_port[i]);
+      for (int j = 0; j < kNumVChannels; j++) {
+        router.in_credit[i * kNumVChannels + j](
+            in_credit[i * kNumVChannels + j]);
+        router.out_credit[i * kNumVChannels + j](
+            out_credit[i * kNumVChannels + j]);
+      }
+    }
+  }
+};
+
+#endif
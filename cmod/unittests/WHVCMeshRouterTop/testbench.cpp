@@ -0,0 +1,379 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "WHVCMeshRouterTop.h"
+#include <systemc.h>
+#include <mc_scverify.h>
+#include <testbench/Pacer.h>
+#include <nvhls_connections.h>
+
+#define NVHLS_VERIFY_BLOCKS (WHVCMeshRouterTop)
+#include <nvhls_verify.h>
+
+#include <deque>
+#include <map>
+#include <sstream>
+
+using namespace ::std;
+typedef WHVCMeshRouterTop::Flit_t Flit_t;
+typedef WHVCMeshRouterTop::Credit_t Credit_t;
+typedef WHVCMeshRouterTop::Credit_ret_t Credit_ret_t;
+static const int kNumVChannels = WHVCMeshRouterTop::kNumVChannels;
+static const int kBufferSize = WHVCMeshRouterTop::kBufferSize;
+static const int kNumLPorts = WHVCMeshRouterTop::kNumLPorts;
+static const int kLocalWidth = WHVCMeshRouterTop::kLocalWidth;
+static const int kNumPorts = WHVCMeshRouterTop::kNumPorts;
+static const int kCoordWidth = WHVCMeshRouterTop::kCoordWidth;
+static const int kPosX = WHVCMeshRouterTop::kPosX;
+static const int kPosY = WHVCMeshRouterTop::kPosY;
+static const int kPortEast = kNumLPorts, kPortWest = kNumLPorts + 1,
+                 kPortNorth = kNumLPorts + 2, kPortSouth = kNumLPorts + 3;
+// Header: <Packet>:<Source>:<Y>:<X>:<Local Dst>, or with multicast
+// <Packet>:<Source>:<Nodes>:<Local Dst>; other flits: <Source>:<Sequence>.
+// Local Dst is 1-hot, or the binary local port when concentrated
+static const int kSrcLsb = 32;
+static const int kPktLsb = 40;
+static const int kNumNodes = 1 << (2 * kCoordWidth);
+typedef deque<Flit_t> flits_t;
+
+unsigned int sent_cnt = 0, recv_cnt = 0;
+// Multicast: nodes that did not get each packet yet
+map<unsigned int, unsigned int> pending;
+bool stop_sending = false;
+
+// Deterministic output port at router (at_x, at_y) for destination (x, y)
+// and local port local
+int next_port(int at_x, int at_y, int x, int y, int local) {
+  int port_x = (x > at_x) ? kPortEast : kPortWest;
+  int port_y = (y > at_y) ? kPortNorth : kPortSouth;
+  if (x == at_x && y == at_y)
+    return local;
+  if (ROUTING_ALGO == YXRouting)
+    return (y != at_y) ? port_y : port_x;
+  return (x != at_x) ? port_x : port_y;
+}
+
+// Returns true if a header with destination (x, y, local) may leave on port
+bool route_ok(int x, int y, int local, int port) {
+  int dx = x - kPosX, dy = y - kPosY;
+  int port_x = (dx > 0) ? kPortEast : kPortWest;
+  int port_y = (dy > 0) ? kPortNorth : kPortSouth;
+  if (ROUTING_ALGO != WestFirstAdaptive || dx <= 0 || dy == 0)
+    return port == next_port(kPosX, kPosY, x, y, local);
+  // East and north/south are both productive
+  return (port == port_x) || (port == port_y);
+}
+
+// Returns true if the lookahead route of a header leaving on port is the
+// route at the neighbor on that port
+bool lookahead_ok(const Flit_t& flit, int x, int y, int local, int port) {
+  static const int at_x[] = {kPosX + 1, kPosX - 1, kPosX, kPosX};
+  static const int at_y[] = {kPosY, kPosY, kPosY + 1, kPosY - 1};
+  if (!LOOKAHEAD || port < kNumLPorts)
+    return true;
+  int lsb = kLocalWidth + 2 * kCoordWidth;
+  int next_dest = nvhls::get_slc<kNumPorts>(flit.data, lsb).to_int();
+  int p = next_port(at_x[port - kNumLPorts], at_y[port - kNumLPorts], x, y, local);
+  return next_dest == (1 << p);
+}
+
+// Checks the nodes of a multicast header that leaves on port and marks them
+// as delivered: a local copy delivers to this router, a remote copy must only
+// keep the nodes that are routed through port
+bool multicast_ok(const Flit_t& flit, int port) {
+  unsigned int pkt = nvhls::get_slc<16>(flit.data, kPktLsb).to_uint();
+  unsigned int nodes = nvhls::get_slc<kNumNodes>(flit.data, kLocalWidth).to_uint();
+  unsigned int delivered = nodes;
+  if (port < kNumLPorts) {
+    delivered = 1 << ((kPosY << kCoordWidth) | kPosX);
+    if ((nodes & delivered) == 0)
+      return false;
+  } else {
+    for (int n = 0; n < kNumNodes; n++) {
+      if (((nodes >> n) & 1) &&
+          next_port(kPosX, kPosY, n % (1 << kCoordWidth), n >> kCoordWidth, 0) != port)
+        return false;
+    }
+  }
+  if (pending.count(pkt) == 0 || (delivered & ~pending[pkt]) != 0)
+    return false;
+  pending[pkt] &= ~delivered;
+  if (pending[pkt] == 0)
+    pending.erase(pkt);
+  return true;
+}
+
+SC_MODULE(Source) {
+  Connections::Out<Flit_t> out;
+  Connections::In<Credit_ret_t> credit[kNumVChannels];
+  sc_in<bool> clk;
+  sc_in<bool> rst;
+  const unsigned int id;
+  Credit_t credit_reg[kNumVChannels];
+  Pacer pacer;
+
+  flits_t generate_packet(int vc) {
+    static unsigned int seq = 0, pkt = 0;
+    flits_t packet;
+    Flit_t flit;
+    int num_flits = (rand() % 6) + 1;
+    NVUINT64 src = id;
+#if (PACKETIDWIDTH > 0)
+    flit.packet_id = vc;
+#endif
+    for (int i = 0; i < num_flits; i++) {
+      if (num_flits == 1) {
+        flit.flit_id.set(FlitId2bit::SNGL);
+      } else if (i == 0) {
+        flit.flit_id.set(FlitId2bit::HEAD);
+      } else if (i == num_flits - 1) {
+        flit.flit_id.set(FlitId2bit::TAIL);
+      } else {
+        flit.flit_id.set(FlitId2bit::BODY);
+      }
+      if (flit.flit_id.isHeader() && MULTICAST) {
+        NVUINT64 nodes = 0;
+        while (nodes == 0)
+          nodes = rand() % (1 << kNumNodes);
+        NVUINT64 key = ++pkt;
+        flit.data = (key << kPktLsb) | (src << kSrcLsb) | (nodes << kLocalWidth) | 1;
+        pending[pkt] = nodes.to_uint();
+      } else if (flit.flit_id.isHeader()) {
+        NVUINT64 x = rand() % (1 << kCoordWidth);
+        NVUINT64 y = rand() % (1 << kCoordWidth);
+        NVUINT64 local = CONCENTRATED ? (rand() % kNumLPorts) : 1;
+        flit.data = (src << kSrcLsb) | (y << (kLocalWidth + kCoordWidth)) |
+                    (x << kLocalWidth) | local;
+      } else {
+        flit.data = (src << kSrcLsb) | (++seq);
+      }
+      packet.push_back(flit);
+    }
+    return packet;
+  }
+
+  void run() {
+    for (int vc = 0; vc < kNumVChannels; vc++) {
+      credit[vc].Reset();
+      credit_reg[vc] = kBufferSize;
+    }
+    out.Reset();
+    flits_t packet[kNumVChannels];
+
+    while (1) {
+      wait();
+
+      Credit_ret_t temp;
+      for (int vc = 0; vc < kNumVChannels; vc++) {
+        if (credit[vc].PopNB(temp))
+          credit_reg[vc] += temp;
+        if (packet[vc].empty() && !stop_sending)
+          packet[vc] = generate_packet(vc);
+      }
+
+      // Random VC, nothing is sent this cycle if it has no credits
+      int vc = rand() % kNumVChannels;
+      if (credit_reg[vc] > 0 && !packet[vc].empty() &&
+          out.PushNB(packet[vc].front())) {
+        cout << "@" << sc_time_stamp() << " Source ID: " << id
+             << " :: Write = " << packet[vc].front() << endl;
+        packet[vc].pop_front();
+        credit_reg[vc] -= 1;
+        ++sent_cnt;
+      }
+
+      while (pacer.tic())
+        wait();
+    }
+  }
+
+  SC_HAS_PROCESS(Source);
+  Source(sc_module_name name_, const unsigned int& id_, const Pacer& pacer_)
+      : sc_module(name_),
+        out("out"),
+        clk("clk"),
+        rst("rst"),
+        id(id_),
+        pacer(pacer_) {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+};
+
+SC_MODULE(Dest) {
+  Connections::In<Flit_t> in;
+  Connections::Out<Credit_ret_t> credit[kNumVChannels];
+  sc_in<bool> clk;
+  sc_in<bool> rst;
+  const unsigned int id;
+  Credit_t credit_reg[kNumVChannels];
+  Pacer pacer;
+
+  void run() {
+    // Source of the packet currently in flight on this port, per VC
+    int open_src[kNumVChannels];
+    for (int vc = 0; vc < kNumVChannels; vc++) {
+      credit[vc].Reset();
+      credit_reg[vc] = 0;
+      open_src[vc] = -1;
+    }
+    in.Reset();
+    Flit_t flit;
+
+    wait();
+    while (1) {
+      if (in.PopNB(flit)) {
+        cout << "@" << sc_time_stamp() << hex << ": " << name()
+             << " received flit: " << flit << dec << endl;
+        int vc = flit.get_packet_id();
+        ++credit_reg[vc];
+        ++recv_cnt;
+        int src = nvhls::get_slc<8>(flit.data, kSrcLsb).to_int();
+        if (flit.flit_id.isHeader() && MULTICAST) {
+          if (open_src[vc] != -1 || !multicast_ok(flit, id))
+            SC_REPORT_ERROR("Dest", "Wrong nodes in multicast header flit");
+          open_src[vc] = src;
+        } else if (flit.flit_id.isHeader()) {
+          int x = nvhls::get_slc<kCoordWidth>(flit.data, kLocalWidth).to_int();
+          int y = nvhls::get_slc<kCoordWidth>(flit.data, kLocalWidth + kCoordWidth).to_int();
+          int local = CONCENTRATED ? nvhls::get_slc<kLocalWidth>(flit.data, 0).to_int() : 0;
+          if (open_src[vc] != -1 || !route_ok(x, y, local, id))
+            SC_REPORT_ERROR("Dest", "Header flit on wrong port");
+          if (!lookahead_ok(flit, x, y, local, id))
+            SC_REPORT_ERROR("Dest", "Wrong lookahead route in header flit");
+          open_src[vc] = src;
+        } else if (src != open_src[vc]) {
+          SC_REPORT_ERROR("Dest", "Flit does not belong to the open packet");
+        }
+        if (flit.flit_id.isTail())
+          open_src[vc] = -1;
+      }
+
+      // flush out credits
+      for (int vc = 0; vc < kNumVChannels; vc++) {
+        if (credit_reg[vc] > 0) {
+          Credit_ret_t temp = 1;
+          if (credit[vc].PushNB(temp))
+            credit_reg[vc]--;
+        }
+      }
+
+      wait();
+
+      while (pacer.tic())
+        wait();
+    }
+  };
+
+  SC_HAS_PROCESS(Dest);
+  Dest(sc_module_name name_, const unsigned int& id_, const Pacer& pacer_)
+      : sc_module(name_),
+        in("in"),
+        clk("clk"),
+        rst("rst"),
+        id(id_),
+        pacer(pacer_) {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    NVHLS_NEG_RESET_SIGNAL_IS(rst);
+  }
+};
+
+SC_MODULE(testbench) {
+  NVHLS_DESIGN(WHVCMeshRouterTop) router;
+
+  typedef Connections::Combinational<Credit_ret_t> CreditChan;
+  typedef Connections::Combinational<Flit_t> DataChan;
+
+  sc_clock clk;
+  sc_signal<bool> rst;
+
+  SC_CTOR(testbench)
+      : router("router"),
+        clk("clk", 1.0, SC_NS, 0.5, 0, SC_NS, true),
+        rst("rst") {
+
+    Connections::set_sim_clk(&clk);
+
+    router.clk(clk);
+    router.rst(rst);
+
+    for (int i = 0; i < kNumPorts; ++i) {
+      ostringstream dname, sname;
+      dname << "dest_on_port_" << i;
+      sname << "source_on_port_" << i;
+      // Slower sinks on some ports give the adaptive router a choice
+      Dest* dest = new Dest(dname.str().c_str(), i, Pacer(0.1 * i, 0.8));
+      Source* source = new Source(sname.str().c_str(), i, Pacer(0.2, 0.8));
+      DataChan* out_chan = new DataChan();
+      DataChan* in_chan = new DataChan();
+
+      dest->clk(clk);
+      dest->rst(rst);
+      dest->in(*out_chan);
+      router.out_port[i](*out_chan);
+
+      source->clk(clk);
+      source->rst(rst);
+      source->out(*in_chan);
+      router.in_port[i](*in_chan);
+
+      for (int vc = 0; vc < kNumVChannels; ++vc) {
+        CreditChan* in_credit_chan = new CreditChan();
+        CreditChan* out_credit_chan = new CreditChan();
+        dest->credit[vc](*in_credit_chan);
+        router.in_credit[i * kNumVChannels + vc](*in_credit_chan);
+        source->credit[vc](*out_credit_chan);
+        router.out_credit[i * kNumVChannels + vc](*out_credit_chan);
+      }
+    }
+
+    SC_THREAD(run);
+  }
+
+  void run() {
+    rst = 0;
+    cout << "@" << sc_time_stamp() << " Asserting Reset " << endl;
+    wait(2, SC_NS);
+    cout << "@" << sc_time_stamp() << " Deasserting Reset " << endl;
+    rst = 1;
+    wait(5000, SC_NS);
+    // Let the sources finish their packets and drain the router
+    stop_sending = true;
+    wait(1000, SC_NS);
+    cout << "@" << sc_time_stamp() << " Stop " << endl;
+    cout << "sent flits = " << sent_cnt << ", received flits = " << recv_cnt << endl;
+    if (recv_cnt == 0 || (!MULTICAST && sent_cnt != recv_cnt))
+      SC_REPORT_ERROR("testbench", "Flits lost in the router");
+    if (!pending.empty())
+      SC_REPORT_ERROR("testbench", "Multicast packets missed some nodes");
+    sc_stop();
+  }
+};
+
+int sc_main(int argc, char* argv[]) {
+  nvhls::set_random_seed();
+  testbench my_testbench("my_testbench");
+  sc_report_handler::set_actions(SC_ERROR, SC_DISPLAY);
+  sc_start();
+  bool rc = (sc_report_handler::get_count(SC_ERROR) > 0);
+  if (rc)
+    cout << "Simulation FAILED\n";
+  else
+    cout << "Simulation PASSED\n";
+  return rc;
+};
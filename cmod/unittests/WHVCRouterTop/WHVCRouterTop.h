@@ -22,13 +22,25 @@
 #include <nvhls_packet.h>
 #include <WHVCRouter.h>
 
+#ifdef WHVC_VC_CLASSES
+// Shallow VC 0, deep VC 1 in a higher arbitration class
+struct WHVCRouterTopVCs {
+  static constexpr int Depth(int vc) { return (vc == 0) ? 2 : 8; }
+  static constexpr int Class(int vc) { return (vc == 0) ? 0 : 1; }
+};
+#endif
+
 SC_MODULE(WHVCRouterTop) {
  public:
   sc_in_clk clk;
   sc_in<bool> rst;
 
   enum { 
+#ifdef WHVC_VC_CLASSES
+    kNumVChannels = 2,
+#else
     kNumVChannels = 1,
+#endif
     kBufferSize = 8,
     kFlitDataWidth = 64,
     kFlitIDWidth = 2,
@@ -42,8 +54,14 @@ SC_MODULE(WHVCRouterTop) {
   typedef NVUINTC(kLogBufferSize) Credit_t;
   typedef NVUINTC(1) Credit_ret_t;
 
+#ifdef WHVC_VC_CLASSES
+  typedef WHVCRouterTopVCs VCConfig;
+  typedef Flit<64, 0, 0, 1, FlitId2bit, WormHole> Flit_t;
+#else
+  typedef WHVCUniformVCs<kBufferSize> VCConfig;
   typedef Flit<64, 0, 0, 0, FlitId2bit, WormHole> Flit_t;
-  WHVCSourceRouter<kNumLPorts, kNumRPorts, kNumVChannels, kBufferSize, Flit_t, kNumMaxHops> router;
+#endif
+  WHVCSourceRouter<kNumLPorts, kNumRPorts, kNumVChannels, kBufferSize, Flit_t, kNumMaxHops, VCConfig> router;
 
   Connections::In<Flit_t> in_port[kNumPorts];
   Connections::Out<Flit_t> out_port[kNumPorts];
@@ -29,11 +29,13 @@
 #include <deque>
 #include <utility>
 #include <sstream>
+#include <fstream>
 
 using namespace ::std;
 typedef WHVCRouterTop::Flit_t Flit_t;
 typedef WHVCRouterTop::Credit_t Credit_t;
 typedef WHVCRouterTop::Credit_ret_t Credit_ret_t;
+typedef WHVCRouterTop::VCConfig VCConfig;
 static const int kNumVChannels = WHVCRouterTop::kNumVChannels;
 static const int kBufferSize = WHVCRouterTop::kBufferSize;
 static const int kNumLPorts = WHVCRouterTop::kNumLPorts;
@@ -271,7 +273,7 @@ SC_MODULE(Source) {
     // reset
     for (int i = 0; i < kNumVChannels; i++) {
       credit[i].Reset();
-      credit_reg[i] = kBufferSize;
+      credit_reg[i] = VCConfig::Depth(i);
     }
 
     vector<flits_t> packet(kNumVChannels);
@@ -291,6 +293,7 @@ SC_MODULE(Source) {
         if (credit[i].PopNB(temp)) {
           credit_reg[i] += temp;
           assert(credit_reg[i] >= temp);
+          assert(credit_reg[i] <= VCConfig::Depth(i));
         }
       }
 
@@ -341,9 +344,9 @@ SC_MODULE(Source) {
     } else if (rand() % 20 < 2) {
       num_flits = 1;
     }
-    //#if (PACKETIDWIDTH > 0)
-    //  flit.packet_id = vc;
-    //#endif
+#ifdef WHVC_VC_CLASSES
+    flit.packet_id = vc;
+#endif
     for (int i = 0; i < num_flits; i++) {
 
       // Packet id should be unique for every source. It will be used to detect
@@ -652,6 +655,29 @@ SC_MODULE(testbench) {
     rst = 1;
     wait(5000, SC_NS);
     cout << "@" << sc_time_stamp() << " Stop " << endl;
+#ifndef CCS_SCVERIFY
+    // Router statistics, also written as JSON for post-processing
+    match::Stats& stats = router.router.stats;
+    stats.DumpStats(cout);
+    ofstream json("router_stats.output.json");
+    stats.DumpStatsJson(json);
+    uint64 flits_in = 0, flits_out = 0;
+    for (int i = 0; i < kNumPorts * kNumVChannels; ++i) {
+      flits_in += stats.GetStatIndexed("flits_in", i);
+      flits_out += stats.GetStatIndexed("flits_out", i);
+    }
+    if (stats.GetStat("cycles") == 0 || flits_in == 0 || flits_out == 0)
+      SC_REPORT_ERROR("testbench", "Router statistics are empty");
+    // No input VC may hold more flits than its depth
+    for (int i = 0; i < kNumPorts * kNumVChannels; ++i) {
+      for (int n = VCConfig::Depth(i % kNumVChannels) + 1; n <= kBufferSize; ++n) {
+        ostringstream hist;
+        hist << "ififo_occupancy_" << i << "_hist_" << n;
+        if (stats.GetStat(hist.str()) != 0)
+          SC_REPORT_ERROR("testbench", "Input VC holds more flits than its depth");
+      }
+    }
+#endif
     sc_stop();
   }
 };
@@ -23,6 +23,189 @@
 #include <axi/testbench/Slave.h>
 #include "AxiAddRemoveWRespTop.h"
 #include <testbench/nvhls_rand.h>
+#include <deque>
+#include <iomanip>
+
+// Write bandwidth versus outstanding depth: a master that streams kWrites
+// bursts of kBurst beats writes through AxiRemoveWriteResponse and
+// AxiAddWriteResponse, both tracking Depth writes, to a slave that answers
+// kLatency cycles after the last beat of each write. AxiAddWriteResponse
+// only lets Depth writes wait for their response, so the bandwidth is
+// about min(1, Depth * kBurst / round trip) beats per cycle.
+static const unsigned int kWrites = 200;
+static const unsigned int kBurst = 4;
+static const unsigned int kLatency = 16;
+
+template <int Depth>
+class WriteBench : public sc_module {
+  SC_HAS_PROCESS(WriteBench);
+
+ public:
+  typedef axi::axi4<axi::cfg::standard> axi_Wresp;
+  typedef axi::axi4<axi::cfg::no_wresp> axi_noWresp;
+
+  sc_in<bool> clk;
+  sc_in<bool> reset_bar;
+
+  typename axi_Wresp::read::template master<> m_rd;
+  typename axi_Wresp::write::template master<> m_wr;
+  typename axi_Wresp::read::template chan<> m_rd_chan;
+  typename axi_Wresp::write::template chan<> m_wr_chan;
+  AxiRemoveWriteResponse<axi::cfg::standard, axi::cfg::no_wresp, Depth> remove_wresp;
+  typename axi_noWresp::read::template chan<> int_rd_chan;
+  typename axi_noWresp::write::template chan<> int_wr_chan;
+  AxiAddWriteResponse<axi::cfg::no_wresp, axi::cfg::standard, Depth> add_wresp;
+  typename axi_Wresp::read::template chan<> s_rd_chan;
+  typename axi_Wresp::write::template chan<> s_wr_chan;
+  typename axi_Wresp::read::template slave<> s_rd;
+  typename axi_Wresp::write::template slave<> s_wr;
+
+  double start_ns, end_ns;
+  bool done, passed;
+
+  WriteBench(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        reset_bar("reset_bar"),
+        m_rd("m_rd"),
+        m_wr("m_wr"),
+        m_rd_chan("m_rd_chan"),
+        m_wr_chan("m_wr_chan"),
+        remove_wresp("remove_wresp"),
+        int_rd_chan("int_rd_chan"),
+        int_wr_chan("int_wr_chan"),
+        add_wresp("add_wresp"),
+        s_rd_chan("s_rd_chan"),
+        s_wr_chan("s_wr_chan"),
+        s_rd("s_rd"),
+        s_wr("s_wr"),
+        start_ns(0),
+        end_ns(0),
+        done(false),
+        passed(true) {
+    remove_wresp.clk(clk);
+    remove_wresp.rst(reset_bar);
+    add_wresp.clk(clk);
+    add_wresp.rst(reset_bar);
+
+    m_rd(m_rd_chan);
+    m_wr(m_wr_chan);
+    remove_wresp.axiM_read(m_rd_chan);
+    remove_wresp.axiM_write(m_wr_chan);
+    remove_wresp.axiS_read(int_rd_chan);
+    remove_wresp.axiS_write(int_wr_chan);
+    add_wresp.axiM_read(int_rd_chan);
+    add_wresp.axiM_write(int_wr_chan);
+    add_wresp.axiS_read(s_rd_chan);
+    add_wresp.axiS_write(s_wr_chan);
+    s_rd(s_rd_chan);
+    s_wr(s_wr_chan);
+
+    SC_THREAD(issue);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(data);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(resp);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(slave);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+  }
+
+  void issue() {
+    m_rd.reset();
+    m_wr.aw.Reset();
+    wait();
+    start_ns = sc_time_stamp().to_seconds() * 1e9;
+    for (unsigned int i = 0; i < kWrites;) {
+      typename axi_Wresp::AddrPayload aw;
+      aw.id = i % 16;
+      aw.addr = i * kBurst * 8;
+      aw.len = kBurst - 1;
+      if (m_wr.aw.PushNB(aw)) i++;
+      wait();
+    }
+    while (1) wait();
+  }
+
+  void data() {
+    m_wr.w.Reset();
+    wait();
+    for (unsigned int i = 0; i < kWrites * kBurst;) {
+      typename axi_Wresp::WritePayload w;
+      w.data = i;
+      w.wstrb = 0xFF;
+      w.last = (i % kBurst == kBurst - 1);
+      if (m_wr.w.PushNB(w)) i++;
+      wait();
+    }
+    while (1) wait();
+  }
+
+  void resp() {
+    m_wr.b.Reset();
+    wait();
+    for (unsigned int i = 0; i < kWrites;) {
+      typename axi_Wresp::WRespPayload b;
+      if (m_wr.b.PopNB(b)) {
+        if (b.id != i % 16) {
+          SC_REPORT_ERROR("WriteBench", "write response out of order");
+          passed = false;
+        }
+        i++;
+      }
+      wait();
+    }
+    end_ns = sc_time_stamp().to_seconds() * 1e9;
+    done = true;
+    while (1) wait();
+  }
+
+  void slave() {
+    s_rd.reset();
+    s_wr.reset();
+    // Writes whose data is arriving, and responses with the time they are due
+    std::deque<typename axi_Wresp::AddrPayload> writes;
+    std::deque<std::pair<double, typename axi_Wresp::WRespPayload> > resps;
+    unsigned int beat = 0, beats = 0;
+    wait();
+    while (1) {
+      double now = sc_time_stamp().to_seconds() * 1e9;
+      if (!resps.empty() && resps.front().first <= now) {
+        if (s_wr.b.PushNB(resps.front().second)) resps.pop_front();
+      }
+      typename axi_Wresp::AddrPayload aw;
+      if (s_wr.aw.PopNB(aw)) writes.push_back(aw);
+      typename axi_Wresp::WritePayload w;
+      if (!writes.empty() && s_wr.w.PopNB(w)) {
+        if (w.data != beats || (w.last == 1) != (beat == kBurst - 1)) {
+          SC_REPORT_ERROR("WriteBench", "write data corrupted");
+          passed = false;
+        }
+        beats++;
+        if (++beat == kBurst) {
+          typename axi_Wresp::WRespPayload b;
+          b.id = writes.front().id;
+          b.resp = axi_Wresp::Enc::XRESP::OKAY;
+          resps.push_back(std::make_pair(now + kLatency, b));
+          writes.pop_front();
+          beat = 0;
+        }
+      }
+      wait();
+    }
+  }
+
+  double BeatsPerCycle() const {
+    return (end_ns > start_ns) ? kWrites * kBurst / (end_ns - start_ns) : 0;
+  }
+};
 
 SC_MODULE(testbench) {
 
@@ -43,6 +226,11 @@ SC_MODULE(testbench) {
   Slave<axi::cfg::standard> slave;
   Master<axi::cfg::standard, Mcfg> master;
   CCS_DESIGN(AxiAddRemoveWRespTop) dut;
+  WriteBench<1> bench_1;
+  WriteBench<2> bench_2;
+  WriteBench<4> bench_4;
+  WriteBench<8> bench_8;
+  WriteBench<16> bench_16;
 
   sc_clock clk;
   sc_signal<bool> reset_bar;
@@ -57,6 +245,11 @@ SC_MODULE(testbench) {
       : slave("slave"),
         master("master"),
         dut("dut"),
+        bench_1("bench_1"),
+        bench_2("bench_2"),
+        bench_4("bench_4"),
+        bench_8("bench_8"),
+        bench_16("bench_16"),
         clk("clk", 1.0, SC_NS, 0.5, 0, SC_NS, true),
         reset_bar("reset_bar"),
         axi_read_m("axi_read_m"),
@@ -84,6 +277,17 @@ SC_MODULE(testbench) {
     dut.axi_write_s(axi_write_s);
     slave.if_wr(axi_write_s);
 
+    bench_1.clk(clk);
+    bench_1.reset_bar(reset_bar);
+    bench_2.clk(clk);
+    bench_2.reset_bar(reset_bar);
+    bench_4.clk(clk);
+    bench_4.reset_bar(reset_bar);
+    bench_8.clk(clk);
+    bench_8.reset_bar(reset_bar);
+    bench_16.clk(clk);
+    bench_16.reset_bar(reset_bar);
+
     master.done(done);
     SC_THREAD(run);
   }
@@ -97,11 +301,32 @@ SC_MODULE(testbench) {
 
     while (1) {
       wait(1, SC_NS);
-      if (done) {
+      if (done && bench_1.done && bench_2.done && bench_4.done && bench_8.done &&
+          bench_16.done) {
+        Report();
         sc_stop();
       }
     }
   }
+
+  void Report() {
+    double bw[] = {bench_1.BeatsPerCycle(), bench_2.BeatsPerCycle(), bench_4.BeatsPerCycle(),
+                   bench_8.BeatsPerCycle(), bench_16.BeatsPerCycle()};
+    bool passed = bench_1.passed && bench_2.passed && bench_4.passed && bench_8.passed &&
+                  bench_16.passed;
+    std::cout << "Write bandwidth, " << kBurst << "-beat bursts, " << kLatency
+              << "-cycle write response latency:" << std::endl;
+    std::cout << "  outstanding  beats/cycle" << std::endl;
+    for (unsigned int i = 0; i < 5; i++) {
+      std::cout << std::setw(13) << (1 << i) << std::setw(13) << std::fixed
+                << std::setprecision(3) << bw[i] << std::endl;
+      // More outstanding writes must never cost bandwidth
+      if (i > 0 && bw[i] < bw[i - 1] * 0.98) passed = false;
+    }
+    // 16 outstanding writes cover the round trip
+    if (bw[4] < 0.9) passed = false;
+    if (!passed) SC_REPORT_ERROR("testbench", "write bandwidth benchmark failed");
+  }
 };
 
 int sc_main(int argc, char *argv[]) {
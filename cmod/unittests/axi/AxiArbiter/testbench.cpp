@@ -86,7 +86,11 @@ SC_MODULE(testbench) {
   sc_signal<bool> reset_bar;
   nvhls::nv_array<sc_signal<bool>, numMasters> done;
 
+#ifdef AXI_ARBITER_REMAP_IDS
+  AxiArbiter<axi::cfg::standard, numMasters, maxInFlight, true> axi_arbiter;
+#else
   AxiArbiter<axi::cfg::standard, numMasters, maxInFlight> axi_arbiter;
+#endif
 
   nvhls::nv_array<typename axi::axi4<axi::cfg::standard>::read::template chan<>, numMasters>
       axi_read_m;
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __AXIDMATOP_H__
+#define __AXIDMATOP_H__
+
+#include <axi/AxiDma.h>
+#include <axi/axi4_configs.h>
+
+#ifndef AXI_DMA_MAX_BURST
+#define AXI_DMA_MAX_BURST 16
+#endif
+
+SC_MODULE(AxiDmaTop) {
+ public:
+  // AxiSlaveToMem does not support write strobes
+  typedef axi::cfg::no_wstrb axiCfg;
+  typedef axi::axi4<axiCfg> axi4_;
+
+ private:
+  AxiDma<axiCfg, AXI_DMA_MAX_BURST> dma;
+
+ public:
+  typename axi4_::read::template master<> if_rd;
+  typename axi4_::write::template master<> if_wr;
+
+  sc_in<bool> reset_bar;
+  sc_in<bool> clk;
+  Connections::In<typename axi4_::Addr> startIn;
+  Connections::Out<AxiDmaIrq<axiCfg> > irqOut;
+
+  SC_CTOR(AxiDmaTop)
+      : dma("dma"),
+        if_rd("if_rd"),
+        if_wr("if_wr"),
+        reset_bar("reset_bar"),
+        clk("clk"),
+        startIn("startIn"),
+        irqOut("irqOut") {
+    dma.clk(clk);
+    dma.reset_bar(reset_bar);
+    dma.if_rd(if_rd);
+    dma.if_wr(if_wr);
+    dma.startIn(startIn);
+    dma.irqOut(irqOut);
+  }
+};
+
+#endif
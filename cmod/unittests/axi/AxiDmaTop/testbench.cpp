@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+
+#include <axi/axi4.h>
+#include <axi/AxiArbiter.h>
+#include <axi/AxiSlaveToMem.h>
+#include <nvhls_connections.h>
+#include <testbench/nvhls_rand.h>
+#include "AxiDmaTop.h"
+#include <mc_scverify.h>
+
+#include <map>
+#include <vector>
+
+typedef AxiDmaTop::axiCfg axiCfg;
+typedef AxiDmaTop::axi4_ axi4_;
+typedef axi4_::Addr Addr;
+typedef axi4_::Data Data;
+
+static const int bytesPerBeat = axi4_::DATA_WIDTH >> 3;
+static const int memBytes = 0x20000;
+static const int loadBurst = 16;
+
+SC_MODULE(testbench) {
+  CCS_DESIGN(AxiDmaTop) dma;
+  AxiArbiter<axiCfg, 2, 16> arbiter;
+  AxiSlaveToMem<axiCfg, memBytes> mem;
+
+  sc_clock clk;
+  sc_signal<bool> reset_bar;
+  sc_signal<bool> done;
+
+  // Port 0 of the arbiter loads and checks memory, port 1 is the DMA
+  axi4_::read::template chan<> host_read;
+  axi4_::write::template chan<> host_write;
+  axi4_::read::template chan<> dma_read;
+  axi4_::write::template chan<> dma_write;
+  axi4_::read::template chan<> mem_read;
+  axi4_::write::template chan<> mem_write;
+
+  Connections::Combinational<Addr> startChan;
+  Connections::Combinational<AxiDmaIrq<axiCfg> > irqChan;
+
+  axi4_::read::template master<> if_rd;
+  axi4_::write::template master<> if_wr;
+  Connections::Out<Addr> startOut;
+  Connections::In<AxiDmaIrq<axiCfg> > irqIn;
+
+  // Contents written by the host, and the expected memory after the copies
+  std::map<Addr, Data> model;
+
+  SC_CTOR(testbench)
+      : dma("dma"),
+        arbiter("arbiter"),
+        mem("mem"),
+        clk("clk", 1.0, SC_NS, 0.5, 0, SC_NS, true),
+        reset_bar("reset_bar"),
+        host_read("host_read"),
+        host_write("host_write"),
+        dma_read("dma_read"),
+        dma_write("dma_write"),
+        mem_read("mem_read"),
+        mem_write("mem_write"),
+        if_rd("if_rd"),
+        if_wr("if_wr"),
+        startOut("startOut"),
+        irqIn("irqIn") {
+    dma.clk(clk);
+    arbiter.clk(clk);
+    mem.clk(clk);
+    dma.reset_bar(reset_bar);
+    arbiter.reset_bar(reset_bar);
+    mem.reset_bar(reset_bar);
+
+    if_rd(host_read);
+    if_wr(host_write);
+    dma.if_rd(dma_read);
+    dma.if_wr(dma_write);
+    startOut(startChan);
+    dma.startIn(startChan);
+    dma.irqOut(irqChan);
+    irqIn(irqChan);
+
+    arbiter.axi_rd_m_ar[0](host_read.ar);
+    arbiter.axi_rd_m_r[0](host_read.r);
+    arbiter.axi_wr_m_aw[0](host_write.aw);
+    arbiter.axi_wr_m_w[0](host_write.w);
+    arbiter.axi_wr_m_b[0](host_write.b);
+    arbiter.axi_rd_m_ar[1](dma_read.ar);
+    arbiter.axi_rd_m_r[1](dma_read.r);
+    arbiter.axi_wr_m_aw[1](dma_write.aw);
+    arbiter.axi_wr_m_w[1](dma_write.w);
+    arbiter.axi_wr_m_b[1](dma_write.b);
+    arbiter.axi_rd_s(mem_read);
+    arbiter.axi_wr_s(mem_write);
+    mem.if_rd(mem_read);
+    mem.if_wr(mem_write);
+
+    SC_THREAD(run);
+
+    SC_THREAD(host);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+  }
+
+  unsigned long Cycle() { return static_cast<unsigned long>(sc_time_stamp().to_seconds() * 1e9); }
+
+  void Write(Addr addr, const std::vector<Data>& words) {
+    for (unsigned int i = 0; i < words.size(); i += loadBurst) {
+      axi4_::AddrPayload aw;
+      unsigned int len = std::min<unsigned int>(loadBurst, words.size() - i);
+      aw.addr = addr + i * bytesPerBeat;
+      aw.len = len - 1;
+      if_wr.aw.Push(aw);
+      for (unsigned int j = 0; j < len; j++) {
+        axi4_::WritePayload w;
+        w.data = words[i + j];
+        w.last = (j == len - 1);
+        if_wr.w.Push(w);
+        model[addr + (i + j) * bytesPerBeat] = words[i + j];
+      }
+      if_wr.b.Pop();
+    }
+  }
+
+  // Random source data; regions are 128-byte aligned so bursts stay within 4KB
+  void Fill(Addr addr, unsigned int bytes) {
+    std::vector<Data> words;
+    for (unsigned int i = 0; i < bytes / bytesPerBeat; i++) {
+      words.push_back(nvhls::get_rand<axi4_::DATA_WIDTH>());
+    }
+    Write(addr, words);
+  }
+
+  void WriteDesc(Addr addr, const AxiDmaDesc& desc) {
+    std::vector<Data> words;
+    AxiDmaDesc::Bits bits = desc.ToBits();
+    for (unsigned int i = 0; i < AxiDmaDesc::width / axi4_::DATA_WIDTH; i++) {
+      words.push_back(nvhls::get_slc<axi4_::DATA_WIDTH>(bits, i * axi4_::DATA_WIDTH));
+    }
+    Write(addr, words);
+  }
+
+  AxiDmaDesc Desc(Addr src, Addr dst, unsigned int rowBytes, unsigned int rows,
+                  unsigned int srcStride, unsigned int dstStride, Addr next, bool irq) {
+    AxiDmaDesc desc;
+    desc.src = src;
+    desc.dst = dst;
+    desc.rowBytes = rowBytes;
+    desc.rows = rows;
+    desc.srcStride = srcStride;
+    desc.dstStride = dstStride;
+    desc.next = next;
+    desc.ctrl = irq ? AxiDmaDesc::CTRL_IRQ : 0;
+    return desc;
+  }
+
+  // Reference model of a descriptor
+  void Copy(const AxiDmaDesc& desc, std::vector<Addr>& written) {
+    for (unsigned int r = 0; r < desc.rows; r++) {
+      for (unsigned int b = 0; b < desc.rowBytes; b += bytesPerBeat) {
+        Addr src = desc.src + r * desc.srcStride + b;
+        Addr dst = desc.dst + r * desc.dstStride + b;
+        model[dst] = model[src];
+        written.push_back(dst);
+      }
+    }
+  }
+
+  void ExpectIrq(Addr desc, bool chainEnd) {
+    AxiDmaIrq<axiCfg> irq = irqIn.Pop();
+    if (irq.desc != desc || irq.chainEnd != chainEnd || irq.resp != axi4_::Enc::XRESP::OKAY) {
+      SC_REPORT_ERROR("testbench", "Unexpected AxiDma interrupt");
+      cout << hex << "Expected desc=" << desc << " chainEnd=" << chainEnd << ", got desc="
+           << irq.desc << " chainEnd=" << irq.chainEnd << " resp=" << irq.resp << dec << endl;
+    }
+  }
+
+  void Check(const std::vector<Addr>& written) {
+    for (unsigned int i = 0; i < written.size(); i++) {
+      axi4_::AddrPayload ar;
+      ar.addr = written[i];
+      if_rd.ar.Push(ar);
+      axi4_::ReadPayload r = if_rd.r.Pop();
+      if (r.data != model[written[i]]) {
+        SC_REPORT_ERROR("testbench", "Memory contents mismatch");
+        cout << hex << "Address " << written[i] << ": expected " << model[written[i]]
+             << ", read " << r.data << dec << endl;
+      }
+    }
+  }
+
+  void host() {
+    if_rd.reset();
+    if_wr.reset();
+    startOut.Reset();
+    irqIn.Reset();
+    done = 0;
+    wait();
+
+    // A chain of a 1D copy across a destination 4KB boundary, a 2D copy whose
+    // source rows cross a 4KB boundary, and a gather of single words
+    const Addr d0 = 0x100, d1 = 0x120, d2 = 0x140, d3 = 0x160;
+    AxiDmaDesc desc0 = Desc(0x1000, 0x8f00, 0x400, 1, 0, 0, d1, true);
+    AxiDmaDesc desc1 = Desc(0x2f40, 0xa000, 96, 8, 128, 256, d2, false);
+    AxiDmaDesc desc2 = Desc(0x4000, 0xb000, 8, 64, 64, 8, 0, true);
+    Fill(0x1000, 0x400);
+    Fill(0x2f00, 9 * 128);
+    Fill(0x4000, 64 * 64);
+    WriteDesc(d0, desc0);
+    WriteDesc(d1, desc1);
+    WriteDesc(d2, desc2);
+
+    std::vector<Addr> written;
+    Copy(desc0, written);
+    Copy(desc1, written);
+    Copy(desc2, written);
+
+    startOut.Push(d0);
+    ExpectIrq(d0, false);
+    ExpectIrq(d2, true);
+    Check(written);
+    cout << "@" << sc_time_stamp() << " Chain of three descriptors checked" << endl;
+
+    // Bandwidth of one large copy
+    const unsigned int benchBytes = 0x8000;
+    AxiDmaDesc desc3 = Desc(0x10000, 0x18000, benchBytes, 1, 0, 0, 0, false);
+    Fill(0x10000, benchBytes);
+    WriteDesc(d3, desc3);
+    written.clear();
+    Copy(desc3, written);
+
+    unsigned long start = Cycle();
+    startOut.Push(d3);
+    ExpectIrq(d3, true);
+    unsigned long cycles = Cycle() - start;
+    Check(written);
+
+    double bw = static_cast<double>(benchBytes) / cycles;
+    cout << "AxiDma (MaxBurst=" << AXI_DMA_MAX_BURST << ") copied " << benchBytes << " bytes in "
+         << cycles << " cycles: " << bw << " bytes/cycle, " << 100.0 * bw / bytesPerBeat
+         << "% of the AxiSlaveToMem peak of " << bytesPerBeat
+         << " bytes/cycle (one read and one write beat per cycle)" << endl;
+
+    done = 1;
+    while (1) {
+      wait();
+    }
+  }
+
+  void run() {
+    // reset
+    reset_bar = 1;
+    wait(20, SC_NS);
+    reset_bar = 0;
+    wait(2, SC_NS);
+    reset_bar = 1;
+
+    while (1) {
+      wait(1, SC_NS);
+      if (done) {
+        sc_stop();
+      }
+    }
+  }
+};
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  testbench tb("tb");
+  sc_report_handler::set_actions(SC_ERROR, SC_DISPLAY);
+  sc_start();
+  bool rc = (sc_report_handler::get_count(SC_ERROR) > 0);
+  if (rc)
+    DCOUT("TESTBENCH FAIL" << endl);
+  else
+    DCOUT("TESTBENCH PASS" << endl);
+  return rc;
+};
@@ -24,7 +24,25 @@
 #include <testbench/nvhls_rand.h>
 
 // A simple AXI testbench example.  A Master and Slave are wired together
-// directly with no DUT in between.
+// directly with no DUT in between.  With AXI_TRACE_BINARY defined the CSV files
+// are first converted to binary traces, which are then replayed.  With
+// AXI_TRACE_TIMED defined the Master replays requests_timed.csv, which has
+// absolute issue cycles and dependencies, with up to TIMED_WINDOW requests
+// outstanding.
+
+#define TIMED_WINDOW 4
+#define TIMED_REQUESTS 10
+
+#ifdef AXI_TRACE_BINARY
+#define MEM_FILE "mem.bin"
+#define REQUEST_FILE "requests.bin"
+#elif defined(AXI_TRACE_TIMED)
+#define MEM_FILE "mem.csv"
+#define REQUEST_FILE "requests_timed.csv"
+#else
+#define MEM_FILE "mem.csv"
+#define REQUEST_FILE "requests.csv"
+#endif
 
 SC_MODULE(testbench) {
 
@@ -40,8 +58,12 @@ SC_MODULE(testbench) {
   typename axi::axi4<axi::cfg::standard>::write::template chan<> axi_write;
 
   SC_CTOR(testbench)
-      : slave("slave", "mem.csv"),
-        master("master", "requests.csv"),
+      : slave("slave", MEM_FILE),
+#ifdef AXI_TRACE_TIMED
+        master("master", REQUEST_FILE, TIMED_WINDOW),
+#else
+        master("master", REQUEST_FILE),
+#endif
         clk("clk", 1.0, SC_NS, 0.5, 0, SC_NS, true),
         reset_bar("reset_bar"),
         axi_read("axi_read"),
@@ -76,6 +98,15 @@ SC_MODULE(testbench) {
     while (1) {
       wait(1, SC_NS);
       if (done) {
+#ifdef AXI_TRACE_TIMED
+        std::cout << master.name() << ": " << master.NumRequests() << " requests, up to "
+                  << master.MaxOutstanding() << " outstanding, " << master.LateIssues()
+                  << " issued late" << std::endl;
+        if (master.NumRequests() != TIMED_REQUESTS || master.MaxOutstanding() < 2 ||
+            master.MaxOutstanding() > TIMED_WINDOW) {
+          SC_REPORT_ERROR("testbench", "unexpected outstanding requests in the timed replay");
+        }
+#endif
         sc_stop();
       }
     }
@@ -84,6 +115,14 @@ SC_MODULE(testbench) {
 
 int sc_main(int argc, char *argv[]) {
   nvhls::set_random_seed();
+#ifdef AXI_TRACE_BINARY
+  const int dataBytes = axi::cfg::standard::dataWidth >> 3;
+  if (!TraceReader::ConvertCSV("mem.csv", MEM_FILE, dataBytes) ||
+      !TraceReader::ConvertCSV("requests.csv", REQUEST_FILE, dataBytes)) {
+    DCOUT("TESTBENCH FAIL" << endl);
+    return 1;
+  }
+#endif
   testbench tb("tb");
   sc_report_handler::set_actions(SC_ERROR, SC_DISPLAY);
   sc_start();
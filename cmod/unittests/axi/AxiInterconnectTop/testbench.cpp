@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+
+#include <axi/axi4.h>
+#include <mc_scverify.h>
+#include <axi/testbench/Master.h>
+#include <axi/testbench/Slave.h>
+#include <axi/AxiInterconnect.h>
+#include <testbench/nvhls_rand.h>
+
+#ifndef NUM_MASTERS
+#define NUM_MASTERS 2
+#endif
+#ifndef NUM_SLAVES
+#define NUM_SLAVES 2
+#endif
+// Timing config of the testbench Slaves, e.g. slaveTimingDram
+#ifndef SLAVE_TIMING
+#define SLAVE_TIMING slaveTimingIdeal
+#endif
+
+// Only the low 20 address bits are decoded, so every master issues random
+// traffic across all slaves in its own 1MB window.
+static const int kNumAddrBitsToInspect = 20;
+
+template <int m>
+struct InterconnectMasterCfg {
+  enum {
+    numWrites = 100,
+    numReads = 100,
+    readDelay = 0,
+    seed = m,
+    useFile = false,
+  };
+  static const uint64_t addrBoundLower = static_cast<uint64_t>(m) << kNumAddrBitsToInspect;
+  static const uint64_t addrBoundUpper = addrBoundLower + (1 << kNumAddrBitsToInspect) - 1;
+};
+
+// Instantiates one Master per port, each with its own config type
+template <int m, int N>
+struct MasterBuilder {
+  template <typename TB>
+  static void Build(TB& tb) {
+    typedef Master<axi::cfg::standard, InterconnectMasterCfg<m> > M;
+    M* master = new M(sc_gen_unique_name("master"));
+    master->clk(tb.clk);
+    master->reset_bar(tb.reset_bar);
+    master->if_rd(tb.axi_read_m[m]);
+    master->if_wr(tb.axi_write_m[m]);
+    master->done(tb.done[m]);
+    MasterBuilder<m + 1, N>::Build(tb);
+  }
+};
+
+template <int N>
+struct MasterBuilder<N, N> {
+  template <typename TB>
+  static void Build(TB&) {}
+};
+
+SC_MODULE(testbench) {
+  enum { numMasters = NUM_MASTERS, numSlaves = NUM_SLAVES };
+  typedef axi::axi4<axi::cfg::standard> axi_;
+
+  nvhls::nv_array<Slave<axi::cfg::standard, SLAVE_TIMING>, numSlaves> slave;
+
+  sc_clock clk;
+  sc_signal<bool> reset_bar;
+  nvhls::nv_array<sc_signal<bool>, numMasters> done;
+
+  AxiInterconnect<axi::cfg::standard, numMasters, numSlaves, 16, kNumAddrBitsToInspect> interconnect;
+
+  nvhls::nv_array<typename axi_::read::template chan<>, numMasters> axi_read_m;
+  nvhls::nv_array<typename axi_::write::template chan<>, numMasters> axi_write_m;
+  nvhls::nv_array<typename axi_::read::template chan<>, numSlaves> axi_read_s;
+  nvhls::nv_array<typename axi_::write::template chan<>, numSlaves> axi_write_s;
+
+  sc_signal<NVUINTW(kNumAddrBitsToInspect)> addrBound[numSlaves][2];
+
+  SC_CTOR(testbench)
+      : slave("slave"),
+        clk("clk", 1.0, SC_NS, 0.5, 0, SC_NS, true),
+        reset_bar("reset_bar"),
+        interconnect("interconnect"),
+        axi_read_m("axi_read_m"),
+        axi_write_m("axi_write_m"),
+        axi_read_s("axi_read_s"),
+        axi_write_s("axi_write_s") {
+
+    Connections::set_sim_clk(&clk);
+
+    interconnect.clk(clk);
+    interconnect.reset_bar(reset_bar);
+
+    MasterBuilder<0, numMasters>::Build(*this);
+
+    for (int i = 0; i < numMasters; i++) {
+      interconnect.axi_rd_m_ar[i](axi_read_m[i].ar);
+      interconnect.axi_rd_m_r[i](axi_read_m[i].r);
+      interconnect.axi_wr_m_aw[i](axi_write_m[i].aw);
+      interconnect.axi_wr_m_w[i](axi_write_m[i].w);
+      interconnect.axi_wr_m_b[i](axi_write_m[i].b);
+    }
+
+    static const unsigned int slaveSpan = (1 << kNumAddrBitsToInspect) / numSlaves;
+    for (int i = 0; i < numSlaves; i++) {
+      slave[i].clk(clk);
+      slave[i].reset_bar(reset_bar);
+      slave[i].if_rd(axi_read_s[i]);
+      slave[i].if_wr(axi_write_s[i]);
+      interconnect.axi_rd_s_ar[i](axi_read_s[i].ar);
+      interconnect.axi_rd_s_r[i](axi_read_s[i].r);
+      interconnect.axi_wr_s_aw[i](axi_write_s[i].aw);
+      interconnect.axi_wr_s_w[i](axi_write_s[i].w);
+      interconnect.axi_wr_s_b[i](axi_write_s[i].b);
+      interconnect.addrBound[i][0](addrBound[i][0]);
+      interconnect.addrBound[i][1](addrBound[i][1]);
+      addrBound[i][0].write(i * slaveSpan);
+      addrBound[i][1].write((i + 1) * slaveSpan - 1);
+    }
+
+    SC_THREAD(run);
+  }
+
+  void run() {
+    reset_bar = 1;
+    wait(2, SC_NS);
+    reset_bar = 0;
+    wait(2, SC_NS);
+    reset_bar = 1;
+    sc_time start = sc_time_stamp();
+
+    while (1) {
+      wait(1, SC_NS);
+      int doneCount = 0;
+      for (int i = 0; i < numMasters; i++) {
+        if (done[i])
+          doneCount++;
+      }
+      if (doneCount == numMasters) {
+        double cycles = (sc_time_stamp() - start) / sc_time(1, SC_NS);
+        unsigned transactions = numMasters * (InterconnectMasterCfg<0>::numReads +
+                                              InterconnectMasterCfg<0>::numWrites);
+        std::cout << "AxiInterconnect " << numMasters << "x" << numSlaves << ": "
+                  << transactions << " transactions in " << cycles << " cycles, "
+                  << transactions / cycles << " transactions/cycle" << std::endl;
+        for (int i = 0; i < numSlaves; i++) {
+          slave[i].PrintStats();
+        }
+        sc_stop();
+      }
+    }
+  }
+};
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  testbench tb("tb");
+  sc_report_handler::set_actions(SC_ERROR, SC_DISPLAY);
+  sc_start();
+  bool rc = (sc_report_handler::get_count(SC_ERROR) > 0);
+  if (rc)
+    DCOUT("TESTBENCH FAIL" << endl);
+  else
+    DCOUT("TESTBENCH PASS" << endl);
+  return rc;
+};
@@ -19,11 +19,38 @@
 
 #include <axi/AxiMasterGate.h>
 #include <axi/axi4_configs.h>
+#ifdef AXI_MASTER_GATE_STREAM
+#include <axi/AxiMasterGate/AxiWriteCombiner.h>
+#include <axi/AxiMasterGate/AxiReadPrefetcher.h>
+#endif
+#ifdef AXI_MASTER_GATE_CACHE
+#include <axi/AxiMasterGate/AxiCache.h>
+#endif
 
 SC_MODULE(AxiMasterGateTop) {
 
  private:
+#ifdef AXI_MASTER_GATE_OOO
+  AxiMasterGate<axi::cfg::standard, 8, 4, true> gate;
+#elif defined(AXI_MASTER_GATE_PER_ID)
+  AxiMasterGate<axi::cfg::standard, 8, 4, false, true> gate;
+#else
   AxiMasterGate<axi::cfg::standard> gate;
+#endif
+#ifdef AXI_MASTER_GATE_STREAM
+  AxiWriteCombiner<axi::cfg::standard> combiner;
+  AxiReadPrefetcher<axi::cfg::standard> prefetcher;
+#endif
+#ifdef AXI_MASTER_GATE_CACHE
+  AxiCache<axi::cfg::standard> cache;
+#endif
+#if defined(AXI_MASTER_GATE_STREAM) || defined(AXI_MASTER_GATE_CACHE)
+
+  Connections::Combinational<WrRequest<axi::cfg::standard> > gateWrRequest;
+  Connections::Combinational<WrResp<axi::cfg::standard> > gateWrResp;
+  Connections::Combinational<RdRequest<axi::cfg::standard> > gateRdRequest;
+  Connections::Combinational<RdResp<axi::cfg::standard> > gateRdResp;
+#endif
 
  public:
   typedef axi::axi4<axi::cfg::standard> axi4_;
@@ -40,6 +67,13 @@ SC_MODULE(AxiMasterGateTop) {
 
   SC_CTOR(AxiMasterGateTop)
       : gate("gate"),
+#ifdef AXI_MASTER_GATE_STREAM
+        combiner("combiner"),
+        prefetcher("prefetcher"),
+#endif
+#ifdef AXI_MASTER_GATE_CACHE
+        cache("cache"),
+#endif
         if_rd("if_rd"),
         if_wr("if_wr"),
         reset_bar("reset_bar"),
@@ -50,11 +84,57 @@ SC_MODULE(AxiMasterGateTop) {
     gate.if_rd(if_rd);
     gate.if_wr(if_wr);
 
+#ifdef AXI_MASTER_GATE_STREAM
+    combiner.clk(clk);
+    combiner.reset_bar(reset_bar);
+    combiner.wrRequestIn(wrRequestIn);
+    combiner.wrRespOut(wrRespOut);
+    combiner.wrRequestOut(gateWrRequest);
+    combiner.wrRespIn(gateWrResp);
+    gate.wrRequestIn(gateWrRequest);
+    gate.wrRespOut(gateWrResp);
+
+    prefetcher.clk(clk);
+    prefetcher.reset_bar(reset_bar);
+    prefetcher.rdRequestIn(rdRequestIn);
+    prefetcher.rdRespOut(rdRespOut);
+    prefetcher.rdRequestOut(gateRdRequest);
+    prefetcher.rdRespIn(gateRdResp);
+    gate.rdRequestIn(gateRdRequest);
+    gate.rdRespOut(gateRdResp);
+#elif defined(AXI_MASTER_GATE_CACHE)
+    cache.clk(clk);
+    cache.reset_bar(reset_bar);
+    cache.wrRequestIn(wrRequestIn);
+    cache.wrRespOut(wrRespOut);
+    cache.rdRequestIn(rdRequestIn);
+    cache.rdRespOut(rdRespOut);
+    cache.wrRequestOut(gateWrRequest);
+    cache.wrRespIn(gateWrResp);
+    cache.rdRequestOut(gateRdRequest);
+    cache.rdRespIn(gateRdResp);
+    gate.wrRequestIn(gateWrRequest);
+    gate.wrRespOut(gateWrResp);
+    gate.rdRequestIn(gateRdRequest);
+    gate.rdRespOut(gateRdResp);
+#else
     gate.wrRequestIn(wrRequestIn);
     gate.wrRespOut(wrRespOut);
     gate.rdRequestIn(rdRequestIn);
     gate.rdRespOut(rdRespOut);
+#endif
+  }
+
+#if defined(AXI_MASTER_GATE_STREAM) && !defined(__SYNTHESIS__)
+  void PrintStats() {
+    combiner.PrintStats();
+    prefetcher.PrintStats();
   }
+#endif
+
+#if defined(AXI_MASTER_GATE_CACHE) && !defined(__SYNTHESIS__)
+  void PrintStats() { cache.PrintStats(); }
+#endif
 };
 
 #endif
@@ -30,7 +30,11 @@ typedef axi::axi4<axi::cfg::standard> axi4_;
 SC_MODULE(testbench) {
   Slave<axi::cfg::standard> slave;
   CCS_DESIGN(AxiMasterGateTop) master;
+#if defined(AXI_MASTER_GATE_OOO) || defined(AXI_MASTER_GATE_PER_ID)
+  Host<axi::cfg::standard, true> host;
+#else
   Host<axi::cfg::standard> host;
+#endif
 
   sc_clock clk;
   sc_signal<bool> reset_bar;
@@ -96,6 +100,9 @@ SC_MODULE(testbench) {
     while (1) {
       wait(1, SC_NS);
       if (done_write && done_read) {
+#if defined(AXI_MASTER_GATE_STREAM) || defined(AXI_MASTER_GATE_CACHE)
+        master.PrintStats();
+#endif
         sc_stop();
       }
     }
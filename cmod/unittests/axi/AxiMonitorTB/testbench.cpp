@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+
+#include <axi/axi4.h>
+#include <mc_scverify.h>
+#include <axi/testbench/Master.h>
+#include <axi/testbench/Slave.h>
+#include <axi/testbench/AxiMonitor.h>
+#include <axi/testbench/MasterFromFile.h>
+#include <axi/testbench/SlaveFromFile.h>
+#include <testbench/nvhls_rand.h>
+
+// The default build records the traffic between a random Master and a Slave
+// with an AxiMonitor into monitor.bin (and a beat log in monitor.csv).  With
+// AXI_MONITOR_REPLAY defined, MasterFromFile and SlaveFromFile replay
+// monitor.bin; MasterFromFile checks every read against the recorded data.
+// REPLAY_WINDOW sets the outstanding requests of the replay.
+
+#ifndef REPLAY_WINDOW
+#define REPLAY_WINDOW 1
+#endif
+
+static const char* kTraceFile = "monitor.bin";
+
+SC_MODULE(testbench) {
+  typedef axi::axi4<axi::cfg::standard> axi_;
+
+#ifdef AXI_MONITOR_REPLAY
+  SlaveFromFile<axi::cfg::standard> slave;
+  MasterFromFile<axi::cfg::standard> master;
+#else
+  Slave<axi::cfg::standard> slave;
+  Master<axi::cfg::standard, masterCfg> master;
+  AxiMonitor<axi::cfg::standard> monitor;
+#endif
+
+  sc_clock clk;
+  sc_signal<bool> reset_bar;
+  sc_signal<bool> done;
+
+  typename axi_::read::template chan<> axi_read_m;
+  typename axi_::write::template chan<> axi_write_m;
+  typename axi_::read::template chan<> axi_read_s;
+  typename axi_::write::template chan<> axi_write_s;
+
+  SC_CTOR(testbench)
+#ifdef AXI_MONITOR_REPLAY
+      : slave("slave", kTraceFile),
+        master("master", kTraceFile, REPLAY_WINDOW),
+#else
+      : slave("slave"),
+        master("master"),
+        monitor("monitor", kTraceFile, "monitor.csv"),
+#endif
+        clk("clk", 1.0, SC_NS, 0.5, 0, SC_NS, true),
+        reset_bar("reset_bar"),
+        axi_read_m("axi_read_m"),
+        axi_write_m("axi_write_m"),
+        axi_read_s("axi_read_s"),
+        axi_write_s("axi_write_s") {
+
+    Connections::set_sim_clk(&clk);
+
+    slave.clk(clk);
+    master.clk(clk);
+    slave.reset_bar(reset_bar);
+    master.reset_bar(reset_bar);
+    master.done(done);
+
+#ifdef AXI_MONITOR_REPLAY
+    master.if_rd(axi_read_m);
+    slave.if_rd(axi_read_m);
+    master.if_wr(axi_write_m);
+    slave.if_wr(axi_write_m);
+#else
+    monitor.clk(clk);
+    monitor.reset_bar(reset_bar);
+
+    master.if_rd(axi_read_m);
+    monitor.if_rd_m(axi_read_m);
+    monitor.if_rd_s(axi_read_s);
+    slave.if_rd(axi_read_s);
+
+    master.if_wr(axi_write_m);
+    monitor.if_wr_m(axi_write_m);
+    monitor.if_wr_s(axi_write_s);
+    slave.if_wr(axi_write_s);
+#endif
+
+    SC_THREAD(run);
+  }
+
+  void run() {
+    reset_bar = 1;
+    wait(2, SC_NS);
+    reset_bar = 0;
+    wait(2, SC_NS);
+    reset_bar = 1;
+
+    while (1) {
+      wait(1, SC_NS);
+      if (done) {
+#ifndef AXI_MONITOR_REPLAY
+        monitor.Flush();
+        std::cout << monitor.name() << ": recorded " << monitor.NumRecords()
+                  << " records to " << kTraceFile << std::endl;
+#else
+        std::cout << master.name() << ": replayed " << master.NumRequests() << " requests, up to "
+                  << master.MaxOutstanding() << " outstanding" << std::endl;
+        if (master.MaxOutstanding() > REPLAY_WINDOW) {
+          SC_REPORT_ERROR("testbench", "more requests outstanding than the replay window");
+        }
+#endif
+        sc_stop();
+      }
+    }
+  }
+};
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  testbench tb("tb");
+  sc_report_handler::set_actions(SC_ERROR, SC_DISPLAY);
+  sc_start();
+  bool rc = (sc_report_handler::get_count(SC_ERROR) > 0);
+  if (rc)
+    DCOUT("TESTBENCH FAIL" << endl);
+  else
+    DCOUT("TESTBENCH PASS" << endl);
+  return rc;
+};
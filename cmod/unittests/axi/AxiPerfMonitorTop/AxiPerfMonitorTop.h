@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AXI_PERF_MONITOR_TOP_H
+#define AXI_PERF_MONITOR_TOP_H
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+
+#include <axi/axi4.h>
+#include <axi/AxiPerfMonitor.h>
+
+struct perfMonitorCfg {
+  enum {
+    numClasses = 2,
+    counterWidth = 32,
+    latencyWidth = 12,
+    histBins = 8,
+    histShift = 2,
+    timedPerId = 4,
+  };
+};
+
+class AxiPerfMonitorTop : public sc_module {
+ public:
+  typedef axi::cfg::standard axiCfg;
+  typedef axi::cfg::lite regCfg;
+  typedef axi::axi4<axiCfg> axi_;
+  typedef axi::axi4<regCfg> reg_;
+  typedef AxiPerfMonitor<axiCfg, perfMonitorCfg, regCfg, 16> Monitor;
+  enum { baseAddress = 0x400, numAddrBitsToInspect = 16 };
+
+  sc_in<bool> clk;
+  sc_in<bool> reset_bar;
+
+  typename axi_::read::template slave<> axi_rd_m;
+  typename axi_::write::template slave<> axi_wr_m;
+  typename axi_::read::template master<> axi_rd_s;
+  typename axi_::write::template master<> axi_wr_s;
+  typename reg_::read::template slave<> if_reg_rd;
+  typename reg_::write::template slave<> if_reg_wr;
+
+  Monitor monitor;
+
+  sc_signal<NVUINTW(numAddrBitsToInspect)> baseAddr;
+
+  SC_HAS_PROCESS(AxiPerfMonitorTop);
+
+  AxiPerfMonitorTop(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        reset_bar("reset_bar"),
+        axi_rd_m("axi_rd_m"),
+        axi_wr_m("axi_wr_m"),
+        axi_rd_s("axi_rd_s"),
+        axi_wr_s("axi_wr_s"),
+        if_reg_rd("if_reg_rd"),
+        if_reg_wr("if_reg_wr"),
+        monitor("monitor") {
+    monitor.clk(clk);
+    monitor.reset_bar(reset_bar);
+
+    monitor.axi_rd_m(axi_rd_m);
+    monitor.axi_wr_m(axi_wr_m);
+    monitor.axi_rd_s(axi_rd_s);
+    monitor.axi_wr_s(axi_wr_s);
+    monitor.if_reg_rd(if_reg_rd);
+    monitor.if_reg_wr(if_reg_wr);
+
+    monitor.baseAddr(baseAddr);
+    baseAddr.write(baseAddress);
+  }
+};
+
+#endif
@@ -0,0 +1,456 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+
+#include <axi/axi4.h>
+#include <mc_scverify.h>
+#include "AxiPerfMonitorTop.h"
+#include <deque>
+#include <vector>
+
+// A read master and a write master issue bursts of various lengths with all
+// AXI IDs through the AxiPerfMonitor to a slave whose latency depends on the
+// ID. The upper ID bit selects one of the two classes. The slave records the
+// latency of every transaction from accepting its request to sending its last
+// read beat or its write response. The masters are paced so that the slave
+// never holds back a request, and no ID has more transactions in flight than
+// the monitor can time. When the traffic is done, the register
+// window is read back: bytes and transactions must match exactly, the latency
+// sum, minimum and maximum must be within kTolerance cycles per transaction of
+// the slave's, every transaction must be in the histogram, and out-of-range
+// and read-only accesses must return SLVERR. Finally the counters are cleared
+// and read back as zero.
+
+static const unsigned int kReads = 300;
+static const unsigned int kWrites = 300;
+static const unsigned int kReadInterval = 4;
+static const unsigned int kWriteInterval = 3;
+static const unsigned int kTolerance = 4;
+static const unsigned int kTimeout = 100000;
+
+SC_MODULE(testbench) {
+  typedef AxiPerfMonitorTop::axi_ axi_;
+  typedef AxiPerfMonitorTop::reg_ reg_;
+  typedef AxiPerfMonitorTop::Monitor Monitor;
+
+  enum {
+    numClasses = perfMonitorCfg::numClasses,
+    histBins = perfMonitorCfg::histBins,
+    bytesPerBeat = axi_::DATA_WIDTH >> 3,
+    bytesPerReg = reg_::DATA_WIDTH >> 3,
+  };
+
+  // Reference statistics of one direction and class
+  struct Stats {
+    unsigned long bytes, transactions, latency_sum;
+    unsigned int latency_min, latency_max;
+    Stats() : bytes(0), transactions(0), latency_sum(0), latency_min(~0u), latency_max(0) {}
+    void Add(unsigned int latency) {
+      transactions++;
+      latency_sum += latency;
+      if (latency < latency_min) latency_min = latency;
+      if (latency > latency_max) latency_max = latency;
+    }
+  };
+
+  CCS_DESIGN(AxiPerfMonitorTop) dut;
+
+  sc_clock clk;
+  sc_signal<bool> reset_bar;
+
+  typename axi_::read::template master<> m_rd;
+  typename axi_::write::template master<> m_wr;
+  typename axi_::read::template slave<> s_rd;
+  typename axi_::write::template slave<> s_wr;
+  typename reg_::read::template master<> reg_rd;
+  typename reg_::write::template master<> reg_wr;
+
+  typename axi_::read::template chan<> axi_read_m;
+  typename axi_::write::template chan<> axi_write_m;
+  typename axi_::read::template chan<> axi_read_s;
+  typename axi_::write::template chan<> axi_write_s;
+  typename reg_::read::template chan<> reg_read;
+  typename reg_::write::template chan<> reg_write;
+
+  Stats ref[2][numClasses];
+  unsigned int reads_done, writes_done;
+  bool done, passed;
+
+  SC_CTOR(testbench)
+      : dut("dut"),
+        clk("clk", 1.0, SC_NS, 0.5, 0, SC_NS, true),
+        reset_bar("reset_bar"),
+        m_rd("m_rd"),
+        m_wr("m_wr"),
+        s_rd("s_rd"),
+        s_wr("s_wr"),
+        reg_rd("reg_rd"),
+        reg_wr("reg_wr"),
+        axi_read_m("axi_read_m"),
+        axi_write_m("axi_write_m"),
+        axi_read_s("axi_read_s"),
+        axi_write_s("axi_write_s"),
+        reg_read("reg_read"),
+        reg_write("reg_write"),
+        reads_done(0),
+        writes_done(0),
+        done(false),
+        passed(true) {
+
+    Connections::set_sim_clk(&clk);
+
+    dut.clk(clk);
+    dut.reset_bar(reset_bar);
+
+    m_rd(axi_read_m);
+    m_wr(axi_write_m);
+    dut.axi_rd_m(axi_read_m);
+    dut.axi_wr_m(axi_write_m);
+    dut.axi_rd_s(axi_read_s);
+    dut.axi_wr_s(axi_write_s);
+    s_rd(axi_read_s);
+    s_wr(axi_write_s);
+    reg_rd(reg_read);
+    reg_wr(reg_write);
+    dut.if_reg_rd(reg_read);
+    dut.if_reg_wr(reg_write);
+
+    SC_THREAD(read_issue);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(read_resp);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(write_issue);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(write_data);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(write_resp);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(slave_read);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(slave_write);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(check_registers);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(run);
+  }
+
+  static double Now() { return sc_time_stamp().to_seconds() * 1e9; }
+
+  static unsigned int ClassOf(unsigned int id) { return id >> (axi_::ID_WIDTH - 1); }
+
+  // The slave latency grows with the ID, and more for the upper class
+  static unsigned int SlaveLatency(bool write, unsigned int id) {
+    return (write ? 12 : 6) + (id & 7) * 2 + ClassOf(id) * 16;
+  }
+
+  static unsigned int ReadLen(unsigned int i) { return i % 4; }
+  static unsigned int WriteLen(unsigned int i) { return (i / 3) % 2; }
+
+  void Check(bool ok, const char* msg) {
+    if (!ok) {
+      SC_REPORT_ERROR("testbench", msg);
+      passed = false;
+    }
+  }
+
+  void read_issue() {
+    m_rd.ar.Reset();
+    wait();
+    for (unsigned int i = 0; i < kReads; i++) {
+      typename axi_::AddrPayload ar;
+      ar.id = i % 16;
+      ar.addr = 0x1000 + i * 4 * bytesPerBeat;
+      ar.len = ReadLen(i);
+      m_rd.ar.Push(ar);
+      ref[0][ClassOf(i % 16)].bytes += (ReadLen(i) + 1) * bytesPerBeat;
+      wait(kReadInterval - 1);
+    }
+    while (1) wait();
+  }
+
+  void read_resp() {
+    m_rd.r.Reset();
+    wait();
+    while (1) {
+      typename axi_::ReadPayload r = m_rd.r.Pop();
+      if (r.last == 1)
+        reads_done++;
+    }
+  }
+
+  void write_issue() {
+    m_wr.aw.Reset();
+    wait();
+    for (unsigned int i = 0; i < kWrites; i++) {
+      typename axi_::AddrPayload aw;
+      aw.id = (i * 5) % 16;
+      aw.addr = 0x80000 + i * 2 * bytesPerBeat;
+      aw.len = WriteLen(i);
+      m_wr.aw.Push(aw);
+      ref[1][ClassOf((i * 5) % 16)].bytes += (WriteLen(i) + 1) * bytesPerBeat;
+      wait(kWriteInterval - 1);
+    }
+    while (1) wait();
+  }
+
+  void write_data() {
+    m_wr.w.Reset();
+    wait();
+    for (unsigned int i = 0; i < kWrites; i++) {
+      for (unsigned int beat = 0; beat <= WriteLen(i); beat++) {
+        typename axi_::WritePayload w;
+        w.data = i;
+        w.wstrb = ~0;
+        w.last = (beat == WriteLen(i));
+        m_wr.w.Push(w);
+      }
+    }
+    while (1) wait();
+  }
+
+  void write_resp() {
+    m_wr.b.Reset();
+    wait();
+    while (1) {
+      typename axi_::WRespPayload b = m_wr.b.Pop();
+      Check(b.resp == axi_::Enc::XRESP::OKAY, "write failed");
+      writes_done++;
+    }
+  }
+
+  // Returns read beats in order, one per cycle, once the first is due
+  void slave_read() {
+    s_rd.reset();
+    struct Pending {
+      double accepted, due;
+      typename axi_::AddrPayload ar;
+    };
+    std::deque<Pending> reads;
+    unsigned int beat = 0;
+    wait();
+    while (1) {
+      double now = Now();
+      if (!reads.empty() && reads.front().due <= now) {
+        typename axi_::AddrPayload& ar = reads.front().ar;
+        typename axi_::ReadPayload r;
+        r.id = ar.id;
+        r.resp = axi_::Enc::XRESP::OKAY;
+        r.data = beat;
+        r.last = (beat == ar.len);
+        if (s_rd.r.PushNB(r)) {
+          if (beat == ar.len) {
+            unsigned int id = static_cast<unsigned int>(ar.id.to_uint64());
+            ref[0][ClassOf(id)].Add(static_cast<unsigned int>(now - reads.front().accepted));
+            reads.pop_front();
+            beat = 0;
+          } else {
+            beat++;
+          }
+        }
+      }
+      Pending p;
+      if (s_rd.ar.PopNB(p.ar)) {
+        p.accepted = now;
+        p.due = now + SlaveLatency(false, static_cast<unsigned int>(p.ar.id.to_uint64()));
+        reads.push_back(p);
+      }
+      wait();
+    }
+  }
+
+  // Responds to each write in order, once its last beat is in and it is due
+  void slave_write() {
+    s_wr.reset();
+    struct Pending {
+      double accepted, due;
+      typename axi_::AddrPayload aw;
+    };
+    std::deque<Pending> writes, resps;
+    unsigned int beat = 0;
+    wait();
+    while (1) {
+      double now = Now();
+      if (!resps.empty() && resps.front().due <= now) {
+        typename axi_::WRespPayload b;
+        b.id = resps.front().aw.id;
+        b.resp = axi_::Enc::XRESP::OKAY;
+        if (s_wr.b.PushNB(b)) {
+          unsigned int id = static_cast<unsigned int>(b.id.to_uint64());
+          ref[1][ClassOf(id)].Add(static_cast<unsigned int>(now - resps.front().accepted));
+          resps.pop_front();
+        }
+      }
+      Pending p;
+      if (s_wr.aw.PopNB(p.aw)) {
+        p.accepted = now;
+        p.due = now + SlaveLatency(true, static_cast<unsigned int>(p.aw.id.to_uint64()));
+        writes.push_back(p);
+      }
+      typename axi_::WritePayload w;
+      if (!writes.empty() && s_wr.w.PopNB(w)) {
+        Check((w.last == 1) == (beat == writes.front().aw.len), "write burst length mismatch");
+        if (beat++ == writes.front().aw.len) {
+          resps.push_back(writes.front());
+          writes.pop_front();
+          beat = 0;
+        }
+      }
+      wait();
+    }
+  }
+
+  NVUINTW(reg_::DATA_WIDTH) ReadReg(unsigned int idx, bool expect_ok = true) {
+    typename reg_::AddrPayload ar;
+    ar.addr = AxiPerfMonitorTop::baseAddress + idx * bytesPerReg;
+    reg_rd.ar.Push(ar);
+    typename reg_::ReadPayload r = reg_rd.r.Pop();
+    Check((r.resp == reg_::Enc::XRESP::OKAY) == expect_ok, "unexpected register read response");
+    return r.data;
+  }
+
+  void WriteReg(unsigned int idx, unsigned int data, bool expect_ok = true) {
+    typename reg_::AddrPayload aw;
+    aw.addr = AxiPerfMonitorTop::baseAddress + idx * bytesPerReg;
+    reg_wr.aw.Push(aw);
+    typename reg_::WritePayload w;
+    w.data = data;
+    w.wstrb = ~0;
+    reg_wr.w.Push(w);
+    typename reg_::WRespPayload b = reg_wr.b.Pop();
+    Check((b.resp == reg_::Enc::XRESP::OKAY) == expect_ok, "unexpected register write response");
+  }
+
+  static unsigned int StatReg(unsigned int dir, unsigned int cls, unsigned int stat) {
+    return Monitor::statsBase + (dir * numClasses + cls) * Monitor::statSlots + stat;
+  }
+
+  static unsigned int HistReg(unsigned int dir, unsigned int cls, unsigned int bin) {
+    return Monitor::histBase + dir * numClasses * histBins + cls * histBins + bin;
+  }
+
+  void check_registers() {
+    reg_rd.reset();
+    reg_wr.reset();
+    wait();
+    while (reads_done < kReads || writes_done < kWrites)
+      wait();
+
+    Check(ReadReg(Monitor::CTRL) == Monitor::CTRL_ENABLE, "monitor not enabled after reset");
+    Check(ReadReg(Monitor::CYCLES) > 0, "no cycles counted");
+    Check(ReadReg(Monitor::UNTIMED) == 0, "transactions left untimed");
+    for (unsigned int dir = 0; dir < 2; dir++) {
+      for (unsigned int cls = 0; cls < numClasses; cls++) {
+        Stats& s = ref[dir][cls];
+        unsigned long bytes = ReadReg(StatReg(dir, cls, Monitor::BYTES));
+        unsigned long transactions = ReadReg(StatReg(dir, cls, Monitor::TRANSACTIONS));
+        unsigned long sum = ReadReg(StatReg(dir, cls, Monitor::LATENCY_SUM));
+        unsigned int min = ReadReg(StatReg(dir, cls, Monitor::LATENCY_MIN));
+        unsigned int max = ReadReg(StatReg(dir, cls, Monitor::LATENCY_MAX));
+        unsigned long hist = 0;
+        for (unsigned int bin = 0; bin < histBins; bin++)
+          hist += ReadReg(HistReg(dir, cls, bin));
+        std::cout << (dir ? "Writes" : "Reads") << " of class " << cls << ": " << transactions
+                  << " transactions, " << bytes << " bytes, latency min " << min << " max "
+                  << max << " mean " << static_cast<double>(sum) / transactions
+                  << " (slave: min " << s.latency_min << " max " << s.latency_max << " mean "
+                  << static_cast<double>(s.latency_sum) / s.transactions << ")" << std::endl;
+        Check(bytes == s.bytes, "byte count mismatch");
+        Check(transactions == s.transactions, "transaction count mismatch");
+        Check(hist == transactions, "histogram does not cover every transaction");
+        Check(sum >= s.latency_sum && sum <= s.latency_sum + kTolerance * s.transactions,
+              "latency sum out of range");
+        Check(min >= s.latency_min && min <= s.latency_min + kTolerance, "latency min out of range");
+        Check(max >= s.latency_max && max <= s.latency_max + kTolerance, "latency max out of range");
+      }
+    }
+
+    // Out-of-range and read-only accesses
+    ReadReg(Monitor::numReg, false);
+    WriteReg(Monitor::CYCLES, 0, false);
+
+    // Clear, then read back zero counters and histograms
+    WriteReg(Monitor::CTRL, Monitor::CTRL_ENABLE | Monitor::CTRL_CLEAR);
+    while (ReadReg(Monitor::CTRL) & Monitor::CTRL_CLEAR)
+      wait();
+    Check(ReadReg(Monitor::UNTIMED) == 0, "untimed count not cleared");
+    for (unsigned int dir = 0; dir < 2; dir++) {
+      for (unsigned int cls = 0; cls < numClasses; cls++) {
+        Check(ReadReg(StatReg(dir, cls, Monitor::BYTES)) == 0, "byte count not cleared");
+        Check(ReadReg(StatReg(dir, cls, Monitor::TRANSACTIONS)) == 0,
+              "transaction count not cleared");
+        Check(ReadReg(StatReg(dir, cls, Monitor::LATENCY_MAX)) == 0, "latency max not cleared");
+        Check(ReadReg(StatReg(dir, cls, Monitor::LATENCY_MIN)) ==
+                  (1u << perfMonitorCfg::latencyWidth) - 1,
+              "latency min not cleared");
+        for (unsigned int bin = 0; bin < histBins; bin++)
+          Check(ReadReg(HistReg(dir, cls, bin)) == 0, "histogram not cleared");
+      }
+    }
+
+    // Disabled: the cycle counter stops
+    WriteReg(Monitor::CTRL, 0);
+    NVUINTW(reg_::DATA_WIDTH) cycles = ReadReg(Monitor::CYCLES);
+    wait(10);
+    Check(ReadReg(Monitor::CYCLES) == cycles, "cycles counted while disabled");
+    Check(ReadReg(Monitor::CTRL) == 0, "monitor not disabled");
+
+    done = true;
+    while (1) wait();
+  }
+
+  void run() {
+    reset_bar = 1;
+    wait(2, SC_NS);
+    reset_bar = 0;
+    wait(2, SC_NS);
+    reset_bar = 1;
+
+    for (unsigned int t = 0; !done && t < kTimeout; t++)
+      wait(1, SC_NS);
+    Check(done, "timed out");
+    sc_stop();
+  }
+};
+
+int sc_main(int argc, char *argv[]) {
+  testbench tb("tb");
+  sc_report_handler::set_actions(SC_ERROR, SC_DISPLAY);
+  sc_start();
+  bool rc = !tb.passed || (sc_report_handler::get_count(SC_ERROR) > 0);
+  if (rc)
+    DCOUT("TESTBENCH FAIL" << endl);
+  else
+    DCOUT("TESTBENCH PASS" << endl);
+  return rc;
+};
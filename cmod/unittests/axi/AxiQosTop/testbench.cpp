@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+
+#include <axi/axi4.h>
+#include <mc_scverify.h>
+#include <axi/AxiArbiter.h>
+#include <axi/AxiQosRegulator.h>
+#include <testbench/nvhls_rand.h>
+#include <deque>
+#include <iomanip>
+
+// A real-time master issues single-beat reads with the highest QoS at a fixed
+// interval; a best-effort master floods 16-beat reads and another one floods
+// 16-beat writes, both with the lowest QoS. They share one slave through an
+// AxiArbiter, with an AxiQosRegulator in front of each best-effort master.
+// The slave returns one read beat per cycle, in order, kSlaveLatency cycles
+// after it accepts a read. The test checks the data of every beat, that the
+// regulated masters stay within their budget, and that no real-time read takes
+// longer than kRtMaxLatency cycles. With AXI_QOS_UNREGULATED the regulators
+// pass everything through and the latencies are only reported.
+
+struct qosCfg : public axi::cfg::standard {
+  enum { useQoS = 1 };
+};
+
+struct beCfg {
+#ifdef AXI_QOS_UNREGULATED
+  enum { bytesPerPeriod = 0, period = 1, bucketBytes = 256, maxOutstanding = 0 };
+#else
+  enum { bytesPerPeriod = 3, period = 1, bucketBytes = 256, maxOutstanding = 2 };
+#endif
+};
+
+static const unsigned int kRtReads = 200;
+static const unsigned int kRtInterval = 40;
+static const unsigned int kRtMaxLatency = 64;
+static const unsigned int kBurst = 16;
+static const unsigned int kSlaveLatency = 8;
+static const unsigned int kSlaveDepth = 8;
+
+SC_MODULE(testbench) {
+  typedef axi::axi4<qosCfg> axi_;
+  typedef AxiQosRegulator<qosCfg, beCfg> Regulator;
+
+  enum {
+    numMasters = 3,
+    maxInFlight = 8,
+    bytesPerBeat = axi_::DATA_WIDTH >> 3,
+  };
+
+  sc_clock clk;
+  sc_signal<bool> reset_bar;
+
+  AxiArbiter<qosCfg, numMasters, maxInFlight> axi_arbiter;
+  Regulator be_rd_regulator;
+  Regulator be_wr_regulator;
+
+  // Master ports of the testbench masters; the unused sides are only reset
+  typename axi_::read::template master<> rt_rd;
+  typename axi_::write::template master<> rt_wr;
+  typename axi_::read::template master<> be_rd;
+  typename axi_::write::template master<> be_rd_wr;
+  typename axi_::read::template master<> be_wr_rd;
+  typename axi_::write::template master<> be_wr;
+  typename axi_::read::template slave<> s_rd;
+  typename axi_::write::template slave<> s_wr;
+
+  nvhls::nv_array<typename axi_::read::template chan<>, numMasters> axi_read_m;
+  nvhls::nv_array<typename axi_::write::template chan<>, numMasters> axi_write_m;
+  typename axi_::read::template chan<> be_rd_read;
+  typename axi_::write::template chan<> be_rd_write;
+  typename axi_::read::template chan<> be_wr_read;
+  typename axi_::write::template chan<> be_wr_write;
+  typename axi_::read::template chan<> axi_read_s;
+  typename axi_::write::template chan<> axi_write_s;
+
+  bool rt_done, passed;
+  unsigned int rt_max_latency;
+  double rt_total_latency, start_ns, end_ns;
+  unsigned long be_rd_bytes, be_wr_bytes;
+
+  SC_CTOR(testbench)
+      : clk("clk", 1.0, SC_NS, 0.5, 0, SC_NS, true),
+        reset_bar("reset_bar"),
+        axi_arbiter("axi_arbiter"),
+        be_rd_regulator("be_rd_regulator"),
+        be_wr_regulator("be_wr_regulator"),
+        rt_rd("rt_rd"),
+        rt_wr("rt_wr"),
+        be_rd("be_rd"),
+        be_rd_wr("be_rd_wr"),
+        be_wr_rd("be_wr_rd"),
+        be_wr("be_wr"),
+        s_rd("s_rd"),
+        s_wr("s_wr"),
+        axi_read_m("axi_read_m"),
+        axi_write_m("axi_write_m"),
+        be_rd_read("be_rd_read"),
+        be_rd_write("be_rd_write"),
+        be_wr_read("be_wr_read"),
+        be_wr_write("be_wr_write"),
+        axi_read_s("axi_read_s"),
+        axi_write_s("axi_write_s"),
+        rt_done(false),
+        passed(true),
+        rt_max_latency(0),
+        rt_total_latency(0),
+        start_ns(0),
+        end_ns(0),
+        be_rd_bytes(0),
+        be_wr_bytes(0) {
+
+    Connections::set_sim_clk(&clk);
+
+    axi_arbiter.clk(clk);
+    axi_arbiter.reset_bar(reset_bar);
+    be_rd_regulator.clk(clk);
+    be_rd_regulator.reset_bar(reset_bar);
+    be_wr_regulator.clk(clk);
+    be_wr_regulator.reset_bar(reset_bar);
+
+    // Port 0: real-time master
+    rt_rd(axi_read_m[0]);
+    rt_wr(axi_write_m[0]);
+    // Port 1: best-effort reads, through a regulator
+    be_rd(be_rd_read);
+    be_rd_wr(be_rd_write);
+    be_rd_regulator.axi_rd_m(be_rd_read);
+    be_rd_regulator.axi_wr_m(be_rd_write);
+    be_rd_regulator.axi_rd_s(axi_read_m[1]);
+    be_rd_regulator.axi_wr_s(axi_write_m[1]);
+    // Port 2: best-effort writes, through a regulator
+    be_wr_rd(be_wr_read);
+    be_wr(be_wr_write);
+    be_wr_regulator.axi_rd_m(be_wr_read);
+    be_wr_regulator.axi_wr_m(be_wr_write);
+    be_wr_regulator.axi_rd_s(axi_read_m[2]);
+    be_wr_regulator.axi_wr_s(axi_write_m[2]);
+
+    for (int i = 0; i < numMasters; i++) {
+      axi_arbiter.axi_rd_m_ar[i](axi_read_m[i].ar);
+      axi_arbiter.axi_rd_m_r[i](axi_read_m[i].r);
+      axi_arbiter.axi_wr_m_aw[i](axi_write_m[i].aw);
+      axi_arbiter.axi_wr_m_w[i](axi_write_m[i].w);
+      axi_arbiter.axi_wr_m_b[i](axi_write_m[i].b);
+    }
+    axi_arbiter.axi_rd_s(axi_read_s);
+    axi_arbiter.axi_wr_s(axi_write_s);
+    s_rd(axi_read_s);
+    s_wr(axi_write_s);
+
+    SC_THREAD(rt_master);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(be_read_issue);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(be_read_resp);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(be_write_issue);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(be_write_data);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(be_write_resp);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(slave_read);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(slave_write);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(run);
+  }
+
+  static double Now() { return sc_time_stamp().to_seconds() * 1e9; }
+
+  // Read data is a function of the address, so every master can check it
+  static NVUINTW(axi_::DATA_WIDTH) ReadData(NVUINTW(axi_::ADDR_WIDTH) addr) {
+    return static_cast<NVUINTW(axi_::DATA_WIDTH)>(addr) * 3 + 1;
+  }
+
+  void Check(bool ok, const char* msg) {
+    if (!ok) {
+      SC_REPORT_ERROR("testbench", msg);
+      passed = false;
+    }
+  }
+
+  void rt_master() {
+    rt_rd.reset();
+    rt_wr.reset();
+    wait();
+    for (unsigned int i = 0; i < kRtReads; i++) {
+      typename axi_::AddrPayload ar;
+      ar.id = 0;
+      ar.addr = 0x10000000 + i * bytesPerBeat;
+      ar.len = 0;
+      ar.qos = axi_::Enc::AXQOS::HIGHEST;
+      rt_rd.ar.Push(ar);
+      double issued = Now();
+      typename axi_::ReadPayload r = rt_rd.r.Pop();
+      unsigned int latency = static_cast<unsigned int>(Now() - issued);
+      Check(r.data == ReadData(ar.addr) && r.last == 1, "real-time read data corrupted");
+      rt_total_latency += latency;
+      if (latency > rt_max_latency)
+        rt_max_latency = latency;
+      while (Now() - issued < kRtInterval)
+        wait();
+    }
+    end_ns = Now();
+    rt_done = true;
+    while (1) wait();
+  }
+
+  void be_read_issue() {
+    be_rd.ar.Reset();
+    be_rd_wr.reset();
+    wait();
+    start_ns = Now();
+    for (unsigned int i = 0;;) {
+      typename axi_::AddrPayload ar;
+      ar.id = 1;
+      ar.addr = 0x20000000 + i * kBurst * bytesPerBeat;
+      ar.len = kBurst - 1;
+      ar.qos = axi_::Enc::AXQOS::LOWEST;
+      if (be_rd.ar.PushNB(ar)) i++;
+      wait();
+    }
+  }
+
+  void be_read_resp() {
+    be_rd.r.Reset();
+    wait();
+    for (unsigned int beat = 0;; beat++) {
+      typename axi_::ReadPayload r = be_rd.r.Pop();
+      NVUINTW(axi_::ADDR_WIDTH) addr = 0x20000000 + beat * bytesPerBeat;
+      Check(r.data == ReadData(addr) && (r.last == 1) == (beat % kBurst == kBurst - 1),
+            "best-effort read data corrupted");
+      if (!rt_done)
+        be_rd_bytes += bytesPerBeat;
+    }
+  }
+
+  void be_write_issue() {
+    be_wr.aw.Reset();
+    be_wr_rd.reset();
+    wait();
+    for (unsigned int i = 0;;) {
+      typename axi_::AddrPayload aw;
+      aw.id = 2;
+      aw.addr = 0x40000000 + i * kBurst * bytesPerBeat;
+      aw.len = kBurst - 1;
+      aw.qos = axi_::Enc::AXQOS::LOWEST;
+      if (be_wr.aw.PushNB(aw)) i++;
+      wait();
+    }
+  }
+
+  void be_write_data() {
+    be_wr.w.Reset();
+    wait();
+    for (unsigned int i = 0;;) {
+      typename axi_::WritePayload w;
+      w.data = i;
+      w.wstrb = ~0;
+      w.last = (i % kBurst == kBurst - 1);
+      if (be_wr.w.PushNB(w)) i++;
+      wait();
+    }
+  }
+
+  void be_write_resp() {
+    be_wr.b.Reset();
+    wait();
+    while (1) {
+      typename axi_::WRespPayload b = be_wr.b.Pop();
+      Check(b.resp == axi_::Enc::XRESP::OKAY, "best-effort write failed");
+      if (!rt_done)
+        be_wr_bytes += kBurst * bytesPerBeat;
+    }
+  }
+
+  void slave_read() {
+    s_rd.reset();
+    // Accepted reads with the time their first beat is due
+    std::deque<std::pair<double, typename axi_::AddrPayload> > reads;
+    unsigned int beat = 0;
+    wait();
+    while (1) {
+      double now = Now();
+      if (!reads.empty() && reads.front().first <= now) {
+        typename axi_::AddrPayload& ar = reads.front().second;
+        typename axi_::ReadPayload r;
+        r.id = ar.id;
+        r.resp = axi_::Enc::XRESP::OKAY;
+        r.data = ReadData(ar.addr + beat * bytesPerBeat);
+        r.last = (beat == ar.len);
+        if (s_rd.r.PushNB(r)) {
+          if (beat == ar.len) {
+            reads.pop_front();
+            beat = 0;
+          } else {
+            beat++;
+          }
+        }
+      }
+      typename axi_::AddrPayload ar;
+      if (reads.size() < kSlaveDepth && s_rd.ar.PopNB(ar))
+        reads.push_back(std::make_pair(now + kSlaveLatency, ar));
+      wait();
+    }
+  }
+
+  void slave_write() {
+    s_wr.reset();
+    std::deque<typename axi_::AddrPayload> writes;
+    std::deque<std::pair<double, typename axi_::WRespPayload> > resps;
+    unsigned int beat = 0, beats = 0;
+    wait();
+    while (1) {
+      double now = Now();
+      if (!resps.empty() && resps.front().first <= now) {
+        if (s_wr.b.PushNB(resps.front().second)) resps.pop_front();
+      }
+      typename axi_::AddrPayload aw;
+      if (s_wr.aw.PopNB(aw)) writes.push_back(aw);
+      typename axi_::WritePayload w;
+      if (!writes.empty() && s_wr.w.PopNB(w)) {
+        Check(w.data == beats && (w.last == 1) == (beat == writes.front().len),
+              "best-effort write data corrupted");
+        beats++;
+        if (beat++ == writes.front().len) {
+          typename axi_::WRespPayload b;
+          b.id = writes.front().id;
+          b.resp = axi_::Enc::XRESP::OKAY;
+          resps.push_back(std::make_pair(now + kSlaveLatency, b));
+          writes.pop_front();
+          beat = 0;
+        }
+      }
+      wait();
+    }
+  }
+
+  void run() {
+    reset_bar = 1;
+    wait(2, SC_NS);
+    reset_bar = 0;
+    wait(2, SC_NS);
+    reset_bar = 1;
+
+    while (!rt_done)
+      wait(1, SC_NS);
+    Report();
+    sc_stop();
+  }
+
+  void Report() {
+    double cycles = end_ns - start_ns;
+    double rd_bw = be_rd_bytes / cycles, wr_bw = be_wr_bytes / cycles;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Real-time reads: " << kRtReads << ", mean latency "
+              << rt_total_latency / kRtReads << " cycles, max latency " << rt_max_latency
+              << " cycles" << std::endl;
+    std::cout << "Best-effort bandwidth: reads " << rd_bw << " B/cycle, writes " << wr_bw
+              << " B/cycle" << std::endl;
+    std::cout << "Regulator stall cycles: reads " << be_rd_regulator.rate_stall_cycles
+              << " (rate) " << be_rd_regulator.outstanding_stall_cycles
+              << " (outstanding), writes " << be_wr_regulator.rate_stall_cycles << " (rate) "
+              << be_wr_regulator.outstanding_stall_cycles << " (outstanding)" << std::endl;
+#ifndef AXI_QOS_UNREGULATED
+    // The bucket may drain once on top of the rate; the best-effort masters
+    // must still get most of their budget.
+    double budget = beCfg::bytesPerPeriod / static_cast<double>(beCfg::period);
+    Check(be_rd_bytes <= budget * cycles + beCfg::bucketBytes &&
+              be_wr_bytes <= budget * cycles + beCfg::bucketBytes,
+          "best-effort master exceeded its budget");
+    Check(rd_bw > 0.8 * budget && wr_bw > 0.8 * budget,
+          "best-effort master throttled below its budget");
+    Check(rt_max_latency <= kRtMaxLatency, "real-time read latency bound exceeded");
+#endif
+  }
+};
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  testbench tb("tb");
+  sc_report_handler::set_actions(SC_ERROR, SC_DISPLAY);
+  sc_start();
+  bool rc = (sc_report_handler::get_count(SC_ERROR) > 0);
+  if (rc)
+    DCOUT("TESTBENCH FAIL" << endl);
+  else
+    DCOUT("TESTBENCH PASS" << endl);
+  return rc;
+};
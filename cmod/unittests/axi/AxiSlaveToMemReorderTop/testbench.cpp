@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2016-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+
+#include <axi/axi4.h>
+#include <mc_scverify.h>
+#include <testbench/nvhls_rand.h>
+#include <algorithm>
+#include <deque>
+#include <sstream>
+#include <vector>
+#include "AxiSlaveToMemReorderTop.h"
+
+/*
+ * Fills the slave memory through the write channel, then issues random read
+ * bursts with random IDs and checks that:
+ * - read data matches what was written,
+ * - responses with the same ID arrive in request order,
+ * - beats of different bursts are not interleaved unless the slave allows it.
+ * The number of bursts that completed ahead of an older request is reported.
+ */
+SC_MODULE(ReorderMaster) {
+  typedef axi::axi4<axi::cfg::no_wstrb> axi4_;
+  static const int kDebugLevel = 4;
+  static const int bytesPerBeat = axi4_::DATA_WIDTH >> 3;
+  static const int numWords = AxiSlaveToMemReorderTop::kCapacity / bytesPerBeat;
+  static const int numIds = 1 << axi4_::ID_WIDTH;
+  static const int numReads = 400;
+  static const int maxOutstanding = 16;
+  static const int maxBurstLen = 8;
+#ifdef REORDER_SCHED_RR
+  static const bool allowInterleave = true;
+#else
+  static const bool allowInterleave = false;
+#endif
+
+  typename axi4_::read::template master<> if_rd;
+  typename axi4_::write::template master<> if_wr;
+
+  sc_in<bool> reset_bar;
+  sc_in<bool> clk;
+  sc_out<bool> done;
+
+  struct Req {
+    unsigned addr;
+    unsigned len;
+    unsigned seq;
+  };
+
+  SC_CTOR(ReorderMaster)
+      : if_rd("if_rd"), if_wr("if_wr"), reset_bar("reset_bar"), clk("clk") {
+    SC_THREAD(run);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+  }
+
+  static typename axi4_::Data DataOf(unsigned addr) {
+    typename axi4_::Data d = 0xf00dcafe12345678ULL ^ (static_cast<uint64>(addr) * 0x9e3779b1ULL);
+    return d;
+  }
+
+  void Error(const std::string& msg) {
+    SC_REPORT_ERROR(name(), msg.c_str());
+  }
+
+  void run() {
+    if_rd.reset();
+    if_wr.reset();
+    done = 0;
+    wait(20);
+
+    // Fill the memory with bursts of maxBurstLen beats
+    typename axi4_::AddrPayload aw;
+    typename axi4_::WritePayload w;
+    typename axi4_::WRespPayload b;
+    for (unsigned addr = 0; addr < numWords * bytesPerBeat; addr += maxBurstLen * bytesPerBeat) {
+      aw.addr = addr;
+      aw.len = maxBurstLen - 1;
+      aw.id = (addr / (maxBurstLen * bytesPerBeat)) % numIds;
+      if_wr.aw.Push(aw);
+      for (int i = 0; i < maxBurstLen; i++) {
+        w.data = DataOf(addr + i * bytesPerBeat);
+        w.last = (i == maxBurstLen - 1);
+        if_wr.w.Push(w);
+      }
+      b = if_wr.b.Pop();
+      if (b.resp != axi4_::Enc::XRESP::OKAY) Error("write response error");
+    }
+    CDCOUT(sc_time_stamp() << " " << name() << " Memory filled" << endl, kDebugLevel);
+
+    std::vector<std::deque<Req> > outstanding(numIds);
+    std::vector<unsigned> beat(numIds, 0);
+    std::deque<unsigned> order;  // request sequence numbers, oldest first
+    unsigned issued = 0, completed = 0, num_outstanding = 0, num_reordered = 0;
+    int cur_id = -1;
+
+    while (completed < numReads) {
+      wait();
+
+      if (issued < numReads && num_outstanding < maxOutstanding) {
+        Req req;
+        req.len = nvhls::get_rand<32>().to_uint() % maxBurstLen;
+        req.addr = (nvhls::get_rand<32>().to_uint() % (numWords - req.len)) * bytesPerBeat;
+        req.seq = issued;
+        typename axi4_::AddrPayload ar;
+        ar.addr = req.addr;
+        ar.len = req.len;
+        ar.id = nvhls::get_rand<32>().to_uint() % numIds;
+        if (if_rd.ar.PushNB(ar)) {
+          outstanding[ar.id.to_uint()].push_back(req);
+          order.push_back(req.seq);
+          issued++;
+          num_outstanding++;
+        }
+      }
+
+      typename axi4_::ReadPayload r;
+      if (if_rd.r.PopNB(r)) {
+        unsigned id = r.id.to_uint();
+        if (outstanding[id].empty()) {
+          Error("read response for an ID with no outstanding request");
+          continue;
+        }
+        if (!allowInterleave && cur_id != -1 && cur_id != static_cast<int>(id))
+          Error("read data interleaved across bursts");
+        Req& req = outstanding[id].front();
+        unsigned addr = req.addr + beat[id] * bytesPerBeat;
+        if (r.data != DataOf(addr)) {
+          std::ostringstream msg;
+          msg << "incorrect read data, id=" << id << " addr=" << hex << addr;
+          Error(msg.str());
+        }
+        if (r.resp != axi4_::Enc::XRESP::OKAY) Error("read response error");
+        bool last = (beat[id] == req.len);
+        if (r.last != last) Error("RLAST does not match burst length");
+        if (last) {
+          if (order.front() != req.seq) num_reordered++;
+          order.erase(std::find(order.begin(), order.end(), req.seq));
+          outstanding[id].pop_front();
+          beat[id] = 0;
+          cur_id = -1;
+          completed++;
+          num_outstanding--;
+        } else {
+          beat[id]++;
+          cur_id = id;
+        }
+      }
+    }
+
+    std::cout << name() << ": " << completed << " read bursts, " << num_reordered
+              << " completed ahead of an older request" << std::endl;
+    if (num_reordered == 0) Error("no reordering observed");
+    done = 1;
+  }
+};
+
+SC_MODULE(testbench) {
+  typedef typename axi::axi4<axi::cfg::no_wstrb> axi_;
+
+  CCS_DESIGN(AxiSlaveToMemReorderTop) slave;
+  ReorderMaster master;
+
+  sc_clock clk;
+  sc_signal<bool> reset_bar;
+  sc_signal<bool> done;
+
+  axi_::read::template chan<> axi_read;
+  axi_::write::template chan<> axi_write;
+
+  SC_CTOR(testbench)
+      : slave("slave"),
+        master("master"),
+
+        clk("clk", 1.0, SC_NS, 0.5, 0, SC_NS, true),
+        reset_bar("reset_bar"),
+        axi_read("axi_read"),
+        axi_write("axi_write") {
+    slave.clk(clk);
+    master.clk(clk);
+
+    slave.reset_bar(reset_bar);
+    master.reset_bar(reset_bar);
+
+    master.if_rd(axi_read);
+    slave.axi_read(axi_read);
+
+    master.if_wr(axi_write);
+    slave.axi_write(axi_write);
+
+    master.done(done);
+    SC_THREAD(run);
+  }
+
+  void run() {
+    reset_bar = 1;
+    wait(2, SC_NS);
+    reset_bar = 0;
+    wait(2, SC_NS);
+    reset_bar = 1;
+
+    while (1) {
+      wait(1, SC_NS);
+      if (done) {
+        sc_stop();
+      }
+    }
+  }
+};
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  testbench tb("tb");
+  sc_report_handler::set_actions(SC_ERROR, SC_DISPLAY);
+  sc_start();
+  bool rc = (sc_report_handler::get_count(SC_ERROR) > 0);
+  if (rc)
+    DCOUT("TESTBENCH FAIL" << endl);
+  else
+    DCOUT("TESTBENCH PASS" << endl);
+  return rc;
+};
@@ -22,10 +22,34 @@
 
 #include <axi/AxiSlaveToMem.h>
 
+#ifdef AXI_SLAVE_ALL_BURSTS
+// no_wstrb with FIXED and WRAP bursts, as AxiSlaveToMem ignores write strobes
+struct memAllBurstsCfg {
+  enum {
+    dataWidth = 64,
+    useVariableBeatSize = 0,
+    useMisalignedAddresses = 0,
+    useLast = 1,
+    useWriteStrobes = 0,
+    useBurst = 1, useFixedBurst = 1, useWrapBurst = 1, maxBurstSize = 256,
+    useQoS = 0, useLock = 0, useProt = 0, useCache = 0, useRegion = 0,
+    aUserWidth = 0, wUserWidth = 0, bUserWidth = 0, rUserWidth = 0,
+    addrWidth = 32,
+    idWidth = 4,
+    useWriteResponses = 1,
+  };
+};
+#endif
+
 class AxiSlaveToMemTop : public sc_module {
  public:
   static const int kDebugLevel = 4;
-  typedef typename axi::axi4<axi::cfg::no_wstrb> axi_;
+#ifdef AXI_SLAVE_ALL_BURSTS
+  typedef memAllBurstsCfg axiCfg;
+#else
+  typedef axi::cfg::no_wstrb axiCfg;
+#endif
+  typedef typename axi::axi4<axiCfg> axi_;
 
   sc_in<bool> clk;
   sc_in<bool> reset_bar;
@@ -33,7 +57,7 @@ class AxiSlaveToMemTop : public sc_module {
   typename axi_::read::template slave<> axi_read;
   typename axi_::write::template slave<> axi_write;
 
-  AxiSlaveToMem<axi::cfg::no_wstrb, 8 * 256> slave;
+  AxiSlaveToMem<axiCfg, 8 * 256> slave;
 
   SC_HAS_PROCESS(AxiSlaveToMemTop);
 
@@ -23,7 +23,7 @@
 #include "AxiSlaveToMemTop.h"
 
 SC_MODULE(testbench) {
-  typedef typename axi::axi4<axi::cfg::no_wstrb> axi_;
+  typedef AxiSlaveToMemTop::axi_ axi_;
 
   struct memMasterCfg {
     enum {
@@ -37,7 +37,7 @@ SC_MODULE(testbench) {
   };
 
   CCS_DESIGN(AxiSlaveToMemTop) slave;
-  Master<axi::cfg::no_wstrb, memMasterCfg> master;
+  Master<AxiSlaveToMemTop::axiCfg, memMasterCfg> master;
 
   sc_clock clk;
   sc_signal<bool> reset_bar;
@@ -26,7 +26,12 @@ class AxiSlaveToRegTop : public sc_module {
  public:
   static const int kDebugLevel = 4;
 
-  typedef axi::axi4<axi::cfg::standard> axi_;
+#ifdef AXI_SLAVE_ALL_BURSTS
+  typedef axi::cfg::all_bursts axiCfg;
+#else
+  typedef axi::cfg::standard axiCfg;
+#endif
+  typedef axi::axi4<axiCfg> axi_;
   enum { numReg = 128, baseAddress = 0x100, numAddrBitsToInspect = 16 };
 
   sc_in<bool> clk;
@@ -35,7 +40,7 @@ class AxiSlaveToRegTop : public sc_module {
   typename axi_::read::template slave<> axi_read;
   typename axi_::write::template slave<> axi_write;
 
-  AxiSlaveToReg<axi::cfg::standard, numReg, numAddrBitsToInspect> slave;
+  AxiSlaveToReg<axiCfg, numReg, numAddrBitsToInspect> slave;
 
   sc_signal<NVUINTW(numAddrBitsToInspect)> baseAddr;
   sc_out<NVUINTW(axi_::DATA_WIDTH)> regOut[numReg];
@@ -43,7 +43,7 @@ SC_MODULE(testbench) {
     };
   };
 
-  Master<axi::cfg::standard, Mcfg> master;
+  Master<AxiSlaveToRegTop::axiCfg, Mcfg> master;
   CCS_DESIGN(AxiSlaveToRegTop) slave;
 
   sc_clock clk;
@@ -53,7 +53,7 @@ SC_MODULE(testbench) {
   typename axi_::read::template chan<> axi_read;
   typename axi_::write::template chan<> axi_write;
 
-  sc_signal<NVUINTW(axi::axi4<axi::cfg::standard>::DATA_WIDTH)> regOut[numReg];
+  sc_signal<NVUINTW(axi_::DATA_WIDTH)> regOut[numReg];
 
   SC_CTOR(testbench)
       : master("master"),
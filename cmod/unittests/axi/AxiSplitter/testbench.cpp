@@ -25,17 +25,51 @@
 #include <axi/AxiArbiter.h>
 #include <testbench/nvhls_rand.h>
 
+// With AXI_SPLITTER_ALL_BURSTS, the masters also issue FIXED and WRAP bursts
+#ifdef AXI_SPLITTER_ALL_BURSTS
+typedef axi::cfg::all_bursts TbCfg;
+#else
+typedef axi::cfg::standard TbCfg;
+#endif
+
+#if defined(AXI_SPLITTER_REGIONS) || defined(AXI_SPLITTER_SPLIT_BURSTS)
+// Exposes the address decode and the burst segmentation of a splitter with
+// split_bursts
+template <typename axiCfg, int numSlaves, int numAddrBitsToInspect, int numRegions>
+class SplitSplitter
+    : public AxiSplitter<axiCfg, numSlaves, numAddrBitsToInspect, false, false, true, numRegions> {
+ public:
+  typedef AxiSplitter<axiCfg, numSlaves, numAddrBitsToInspect, false, false, true, numRegions> Base;
+  SplitSplitter(sc_module_name name) : Base(name) {}
+  using Base::route;
+  using Base::segmentBeats;
+  using Base::splitBurst;
+  using Base::nextPieceAddr;
+};
+#endif
+
 SC_MODULE(testbench) {
  public:
   enum { numSlaves = 2, numAddrBitsToInspect = 20 };
+#ifdef AXI_SPLITTER_REGIONS
+  // Each slave owns two regions that are not aligned to their size, and a
+  // disabled region covers the whole map
+  enum { numRegions = 5 };
+#endif
 
   struct master0Cfg {
     enum {
       numWrites = 100,
       numReads = 100,
       readDelay = 0,
+#ifdef AXI_SPLITTER_SPLIT_BURSTS
+      // Bursts straddle the boundary between the two slaves
+      addrBoundLower = 0x70000,
+      addrBoundUpper = 0x8FFFF,
+#else
       addrBoundLower = 0,
       addrBoundUpper = 0x7FFFF,
+#endif
       seed = 0,
       useFile = false,
     };
@@ -45,41 +79,56 @@ SC_MODULE(testbench) {
       numWrites = 100,
       numReads = 100,
       readDelay = 0,
+#ifdef AXI_SPLITTER_SPLIT_BURSTS
+      addrBoundLower = 0x90000,
+#else
       addrBoundLower = 0x80000,
+#endif
       addrBoundUpper = 0xFFFFF,
       seed = 0,
       useFile = false,
     };
   };
 
-  Master<axi::cfg::standard, master0Cfg> master0;
-  Master<axi::cfg::standard, master1Cfg> master1;
-  nvhls::nv_array<Slave<axi::cfg::standard>, numSlaves> slave;
+  Master<TbCfg, master0Cfg> master0;
+  Master<TbCfg, master1Cfg> master1;
+  nvhls::nv_array<Slave<TbCfg>, numSlaves> slave;
 
   sc_clock clk;
   sc_signal<bool> reset_bar;
   nvhls::nv_array<sc_signal<bool>, numSlaves> done;
 
-  nvhls::nv_array<typename axi::axi4<axi::cfg::standard>::read::template chan<>, numSlaves>
+  nvhls::nv_array<typename axi::axi4<TbCfg>::read::template chan<>, numSlaves>
       axi_read_m_tb;
-  nvhls::nv_array<typename axi::axi4<axi::cfg::standard>::write::template chan<>, numSlaves>
+  nvhls::nv_array<typename axi::axi4<TbCfg>::write::template chan<>, numSlaves>
       axi_write_m_tb;
 
-  AxiArbiter<axi::cfg::standard, numSlaves, 16> axi_arbiter;
+  AxiArbiter<TbCfg, numSlaves, 16> axi_arbiter;
 
-  typename axi::axi4<axi::cfg::standard>::read::template chan<> axi_read_tb_int;
-  typename axi::axi4<axi::cfg::standard>::write::template chan<> axi_write_tb_int;
+  typename axi::axi4<TbCfg>::read::template chan<> axi_read_tb_int;
+  typename axi::axi4<TbCfg>::write::template chan<> axi_write_tb_int;
 
-  AxiSplitter<axi::cfg::standard, numSlaves, numAddrBitsToInspect> axi_splitter;
+#if defined(AXI_SPLITTER_REGIONS)
+  SplitSplitter<TbCfg, numSlaves, numAddrBitsToInspect, numRegions> axi_splitter;
+#elif defined(AXI_SPLITTER_SPLIT_BURSTS)
+  SplitSplitter<TbCfg, numSlaves, numAddrBitsToInspect, 0> axi_splitter;
+#else
+  AxiSplitter<TbCfg, numSlaves, numAddrBitsToInspect> axi_splitter;
+#endif
 
-  nvhls::nv_array<typename axi::axi4<axi::cfg::standard>::read::template chan<>, numSlaves>
+  nvhls::nv_array<typename axi::axi4<TbCfg>::read::template chan<>, numSlaves>
       axi_read_s;
-  nvhls::nv_array<typename axi::axi4<axi::cfg::standard>::write::template chan<>, numSlaves>
+  nvhls::nv_array<typename axi::axi4<TbCfg>::write::template chan<>, numSlaves>
       axi_write_s;
-  typename axi::axi4<axi::cfg::standard>::read::template chan<> axi_read_m;
-  typename axi::axi4<axi::cfg::standard>::write::template chan<> axi_write_m;
+  typename axi::axi4<TbCfg>::read::template chan<> axi_read_m;
+  typename axi::axi4<TbCfg>::write::template chan<> axi_write_m;
 
+#ifdef AXI_SPLITTER_REGIONS
+  typedef NVUINTW(TbCfg::dataWidth) Reg;
+  sc_signal<Reg> regionTable[numRegions][3];
+#else
   sc_signal<NVUINTW(numAddrBitsToInspect)> addrBound[numSlaves][2];
+#endif
 
   SC_CTOR(testbench)
       : master0("master0"),
@@ -134,11 +183,27 @@ SC_MODULE(testbench) {
       axi_splitter.axi_wr_s_aw[i](axi_write_s[i].aw);
       axi_splitter.axi_wr_s_w[i](axi_write_s[i].w);
       axi_splitter.axi_wr_s_b[i](axi_write_s[i].b);
+#ifndef AXI_SPLITTER_REGIONS
       for (int j = 0; j < 2; j++) {
         axi_splitter.addrBound[i][j](addrBound[i][j]);
         addrBound[i][j].write(addrBound_val[i][j]);
       }
+#endif
+    }
+
+#ifdef AXI_SPLITTER_REGIONS
+    for (int r = 0; r < numRegions; r++) {
+      for (int k = 0; k < 3; k++) {
+        axi_splitter.regionTable[r][k](regionTable[r][k]);
+        Reg val = regionVal[r][k];
+        if (k == 2) {
+          // Region 2 is disabled
+          val = (r == 2) ? Reg(0) : axi_splitter.regionCtrl(regionVal[r][k]);
+        }
+        regionTable[r][k].write(val);
+      }
     }
+#endif
 
     axi_arbiter.axi_rd_s(axi_read_tb_int);
     axi_arbiter.axi_wr_s(axi_write_tb_int);
@@ -148,7 +213,72 @@ SC_MODULE(testbench) {
     SC_THREAD(run);
   }
 
+#ifdef AXI_SPLITTER_REGIONS
+  // Base, limit and slave of each region
+  static const unsigned int regionVal[numRegions][3];
+
+  // Checks the decode of the region table at the region edges
+  void check_routes() {
+    const unsigned int addr[] = {0x0, 0x2FFFF, 0x30000, 0x7FFFF, 0x80000, 0xA6FFF, 0xA7000, 0xFFFFF};
+    const unsigned int dest[] = {0, 0, 1, 1, 1, 1, 0, 0};
+    for (int i = 0; i < 8; i++) {
+      typename axi::axi4<TbCfg>::Addr a = addr[i];
+      NVUINTW(numAddrBitsToInspect) lower, upper;
+      if (axi_splitter.route(a, lower, upper) != dest[i]) {
+        SC_REPORT_ERROR("testbench", "region table routed an address to the wrong slave");
+      }
+    }
+  }
+#endif
+
+#ifdef AXI_SPLITTER_SPLIT_BURSTS
+  // Checks the first piece of INCR bursts that start unaligned or next to a
+  // page or range boundary, and the address of the piece after it. FIXED and
+  // WRAP bursts next to a page boundary are not split.
+  void check_segments() {
+    typedef axi::axi4<TbCfg> axi4_;
+    typedef typename axi4_::Addr Addr;
+    const unsigned int addr[] = {0x10FF9, 0x10FC1, 0x7FFFC, 0x7FF00, 0x10000};
+    const unsigned int beats[] = {4, 16, 4, 64, 256};
+    const unsigned int seg[] = {1, 8, 1, 32, 256};
+    const unsigned int next[] = {0x11000, 0x11000, 0x80000, 0x80000, 0x10800};
+    typename axi4_::AddrPayload req;
+    for (int i = 0; i < 5; i++) {
+      Addr a = addr[i];
+      NVUINTW(numAddrBitsToInspect) lower, upper;
+      axi_splitter.route(a, lower, upper);
+      unsigned int s = axi_splitter.segmentBeats(req, a, beats[i], upper).to_uint();
+      unsigned int n = axi_splitter.nextPieceAddr(a, s).to_uint();
+      if (s != seg[i] || n != next[i]) {
+        SC_REPORT_ERROR("testbench", "split burst piece has the wrong length or next address");
+      }
+    }
+#ifdef AXI_SPLITTER_ALL_BURSTS
+    const unsigned int burst[] = {axi4_::Enc::AXBURST::FIXED, axi4_::Enc::AXBURST::WRAP};
+    for (int i = 0; i < 2; i++) {
+      req.burst = burst[i];
+      req.len = 3;
+      req.addr = 0x10FF0;
+      NVUINTW(numAddrBitsToInspect) lower, upper;
+      axi_splitter.route(req.addr, lower, upper);
+      if (axi_splitter.splitBurst(req) ||
+          axi_splitter.segmentBeats(req, req.addr, 4, upper) != 4) {
+        SC_REPORT_ERROR("testbench", "FIXED or WRAP burst was split");
+      }
+    }
+#endif
+  }
+#endif
+
   void run() {
+#ifdef AXI_SPLITTER_REGIONS
+    wait(SC_ZERO_TIME);
+    check_routes();
+#endif
+#ifdef AXI_SPLITTER_SPLIT_BURSTS
+    wait(SC_ZERO_TIME);
+    check_segments();
+#endif
     reset_bar = 1;
     wait(2, SC_NS);
     reset_bar = 0;
@@ -169,6 +299,16 @@ SC_MODULE(testbench) {
   }
 };
 
+#ifdef AXI_SPLITTER_REGIONS
+const unsigned int testbench::regionVal[testbench::numRegions][3] = {
+    {0x00000, 0x2FFFF, 0},
+    {0x30000, 0x7FFFF, 1},
+    {0x00000, 0xFFFFF, 1},
+    {0x80000, 0xA6FFF, 1},
+    {0xA7000, 0xFFFFF, 0},
+};
+#endif
+
 int sc_main(int argc, char *argv[]) {
   nvhls::set_random_seed();
   testbench tb("tb");
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __AXISTREAMTOP_H__
+#define __AXISTREAMTOP_H__
+
+#include <axi/axi4_configs.h>
+#include <axi/axi4_stream.h>
+#include <axi/AxiStreamFifo.h>
+#include <axi/AxiStreamWidthConverter.h>
+#include <axi/AxiMasterGate.h>
+#include <axi/AxiMasterGate/AxiStreamToMem.h>
+
+SC_MODULE(AxiStreamTop) {
+ public:
+  typedef axi::axi4<axi::cfg::standard> axi4_;
+  typedef axi::axi4_stream<axi::cfg::stream> axis_;
+  typedef axi::axi4_stream<axi::cfg::stream_narrow> axisNarrow_;
+
+ private:
+  // 64-bit stream -> 32-bit packet FIFO -> 64-bit stream -> DMA -> AXI
+  AxiStreamWidthConverter<axi::cfg::stream, axi::cfg::stream_narrow> down;
+  AxiStreamFifo<axi::cfg::stream_narrow, 16, true> fifo;
+  AxiStreamWidthConverter<axi::cfg::stream_narrow, axi::cfg::stream> up;
+  AxiStreamToMem<axi::cfg::stream, axi::cfg::standard> dma;
+  AxiMasterGate<axi::cfg::standard> gate;
+
+  typename axisNarrow_::template chan<> narrow_in;
+  typename axisNarrow_::template chan<> narrow_out;
+  typename axis_::template chan<> wide;
+
+  Connections::Combinational<WrRequest<axi::cfg::standard> > gateWrRequest;
+  Connections::Combinational<WrResp<axi::cfg::standard> > gateWrResp;
+
+ public:
+  typename axi4_::read::template master<> if_rd;
+  typename axi4_::write::template master<> if_wr;
+
+  sc_in<bool> reset_bar;
+  sc_in<bool> clk;
+  typename axis_::template slave<> axis_in;
+  Connections::In<AxiStreamDmaDesc<axi::cfg::standard> > descIn;
+  Connections::Out<AxiStreamDmaStatus<axi::cfg::standard> > statusOut;
+  // Read path of the gate, used to read the buffers back
+  Connections::In<RdRequest<axi::cfg::standard> > rdRequestIn;
+  Connections::Out<RdResp<axi::cfg::standard> > rdRespOut;
+
+  SC_CTOR(AxiStreamTop)
+      : down("down"),
+        fifo("fifo"),
+        up("up"),
+        dma("dma"),
+        gate("gate"),
+        narrow_in("narrow_in"),
+        narrow_out("narrow_out"),
+        wide("wide"),
+        if_rd("if_rd"),
+        if_wr("if_wr"),
+        reset_bar("reset_bar"),
+        clk("clk"),
+        axis_in("axis_in"),
+        descIn("descIn"),
+        statusOut("statusOut"),
+        rdRequestIn("rdRequestIn"),
+        rdRespOut("rdRespOut") {
+    down.clk(clk);
+    down.reset_bar(reset_bar);
+    down.axis_in(axis_in);
+    down.axis_out(narrow_in);
+
+    fifo.clk(clk);
+    fifo.reset_bar(reset_bar);
+    fifo.axis_in(narrow_in);
+    fifo.axis_out(narrow_out);
+
+    up.clk(clk);
+    up.reset_bar(reset_bar);
+    up.axis_in(narrow_out);
+    up.axis_out(wide);
+
+    dma.clk(clk);
+    dma.reset_bar(reset_bar);
+    dma.axis_in(wide);
+    dma.descIn(descIn);
+    dma.statusOut(statusOut);
+    dma.wrRequestOut(gateWrRequest);
+    dma.wrRespIn(gateWrResp);
+
+    gate.clk(clk);
+    gate.reset_bar(reset_bar);
+    gate.if_rd(if_rd);
+    gate.if_wr(if_wr);
+    gate.wrRequestIn(gateWrRequest);
+    gate.wrRespOut(gateWrResp);
+    gate.rdRequestIn(rdRequestIn);
+    gate.rdRespOut(rdRespOut);
+  }
+};
+
+#endif
@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+
+#include <axi/axi4.h>
+#include <nvhls_connections.h>
+#include <testbench/nvhls_rand.h>
+#include "AxiStreamTop.h"
+#include <axi/testbench/Slave.h>
+#include <mc_scverify.h>
+
+#include <vector>
+
+typedef axi::axi4<axi::cfg::standard> axi4_;
+typedef axi::axi4_stream<axi::cfg::stream> axis_;
+typedef AxiStreamDmaDesc<axi::cfg::standard> Desc;
+typedef AxiStreamDmaStatus<axi::cfg::standard> Status;
+
+static const int numPackets = 24;
+static const int maxPacketBeats = 40;
+static const int maxBufferBeats = 64;
+static const int bytesPerBeat = axi4_::DATA_WIDTH >> 3;
+
+SC_MODULE(testbench) {
+  CCS_DESIGN(AxiStreamTop) dut;
+  Slave<axi::cfg::standard> slave;
+
+  sc_clock clk;
+  sc_signal<bool> reset_bar;
+  sc_signal<bool> done;
+
+  axi4_::read::template chan<> axi_read;
+  axi4_::write::template chan<> axi_write;
+  axis_::template chan<> axis_chan;
+
+  Connections::Combinational<Desc> descChan;
+  Connections::Combinational<Status> statusChan;
+  Connections::Combinational<RdRequest<axi::cfg::standard> > rdRequestChan;
+  Connections::Combinational<RdResp<axi::cfg::standard> > rdRespChan;
+
+  axis_::template master<> axis_src;
+  Connections::Out<Desc> descOut;
+  Connections::In<Status> statusIn;
+  Connections::Out<RdRequest<axi::cfg::standard> > rdRequestOut;
+  Connections::In<RdResp<axi::cfg::standard> > rdRespIn;
+
+  // Stimulus and the expected result, computed up front
+  std::vector<axis_::Payload> beats;
+  std::vector<Desc> descs;
+  std::vector<Status> statuses;
+  std::vector<axi4_::Addr> word_addr;
+  std::vector<axi4_::Data> word_data;
+  std::vector<axis_::Bytes> word_keep;
+
+  SC_CTOR(testbench)
+      : dut("dut"),
+        slave("slave"),
+        clk("clk", 1.0, SC_NS, 0.5, 0, SC_NS, true),
+        reset_bar("reset_bar"),
+        axi_read("axi_read"),
+        axi_write("axi_write"),
+        axis_chan("axis_chan"),
+        axis_src("axis_src"),
+        descOut("descOut"),
+        statusIn("statusIn"),
+        rdRequestOut("rdRequestOut"),
+        rdRespIn("rdRespIn") {
+    dut.clk(clk);
+    slave.clk(clk);
+    dut.reset_bar(reset_bar);
+    slave.reset_bar(reset_bar);
+
+    dut.if_rd(axi_read);
+    slave.if_rd(axi_read);
+    dut.if_wr(axi_write);
+    slave.if_wr(axi_write);
+
+    axis_src(axis_chan);
+    dut.axis_in(axis_chan);
+    descOut(descChan);
+    dut.descIn(descChan);
+    dut.statusOut(statusChan);
+    statusIn(statusChan);
+    rdRequestOut(rdRequestChan);
+    dut.rdRequestIn(rdRequestChan);
+    dut.rdRespOut(rdRespChan);
+    rdRespIn(rdRespChan);
+
+    Generate();
+
+    SC_THREAD(run);
+
+    SC_THREAD(source);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(issue);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+
+    SC_THREAD(check);
+    sensitive << clk.pos();
+    async_reset_signal_is(reset_bar, false);
+  }
+
+  // Random packets, and buffers that start just below a 4KB boundary and
+  // follow each other in memory
+  void Generate() {
+    for (int p = 0; p < numPackets; p++) {
+      int len = 1 + nvhls::get_rand<32>().to_uint() % maxPacketBeats;
+      for (int i = 0; i < len; i++) {
+        axis_::Payload beat;
+        beat.data = nvhls::get_rand<axis_::DATA_WIDTH>();
+        if (i == len - 1) {
+          int kept = 1 + nvhls::get_rand<32>().to_uint() % bytesPerBeat;
+          beat.keep = (1 << kept) - 1;
+          beat.last = 1;
+        }
+        beats.push_back(beat);
+      }
+    }
+
+    axi4_::Addr addr = 0x1000 - 3 * bytesPerBeat;
+    unsigned int next = 0;
+    while (next < beats.size()) {
+      Desc desc;
+      desc.addr = addr;
+      desc.maxBeats = 1 + nvhls::get_rand<32>().to_uint() % maxBufferBeats;
+      descs.push_back(desc);
+
+      Status status;
+      status.bytes = 0;
+      status.resp = axi4_::Enc::XRESP::OKAY;
+      status.eop = 0;
+      for (unsigned int i = 0; i < desc.maxBeats && next < beats.size(); i++) {
+        axis_::Payload beat = beats[next++];
+        axis_::Bytes keep = axis_::KeepOf(beat);
+        for (int j = 0; j < bytesPerBeat; j++) {
+          if (keep[j] == 1) {
+            status.bytes += 1;
+          }
+        }
+        word_addr.push_back(addr + i * bytesPerBeat);
+        word_data.push_back(beat.data);
+        word_keep.push_back(keep);
+        if (axis_::LastOf(beat)) {
+          status.eop = 1;
+          break;
+        }
+      }
+      statuses.push_back(status);
+      addr += desc.maxBeats * bytesPerBeat;
+    }
+  }
+
+  void source() {
+    axis_src.reset();
+    wait();
+    for (unsigned int i = 0; i < beats.size(); i++) {
+      while (nvhls::get_rand<32>().to_uint() % 4 == 0) {
+        wait();
+      }
+      axis_src.write(beats[i]);
+    }
+    while (1) {
+      wait();
+    }
+  }
+
+  void issue() {
+    descOut.Reset();
+    wait();
+    for (unsigned int i = 0; i < descs.size(); i++) {
+      while (nvhls::get_rand<32>().to_uint() % 8 == 0) {
+        wait();
+      }
+      descOut.Push(descs[i]);
+    }
+    while (1) {
+      wait();
+    }
+  }
+
+  void check() {
+    statusIn.Reset();
+    rdRequestOut.Reset();
+    rdRespIn.Reset();
+    done = 0;
+    wait();
+
+    for (unsigned int i = 0; i < statuses.size(); i++) {
+      Status status = statusIn.Pop();
+      if (status.bytes != statuses[i].bytes || status.eop != statuses[i].eop ||
+          status.resp != statuses[i].resp) {
+        SC_REPORT_ERROR("testbench", "AxiStreamToMem status mismatch");
+        cout << "Descriptor " << i << ": expected bytes=" << statuses[i].bytes
+             << " eop=" << statuses[i].eop << ", got bytes=" << status.bytes
+             << " eop=" << status.eop << " resp=" << status.resp << endl;
+      }
+    }
+    cout << "@" << sc_time_stamp() << " " << statuses.size() << " buffers completed" << endl;
+
+    // Every buffer has been acknowledged; read the words back
+    for (unsigned int i = 0; i < word_addr.size(); i++) {
+      RdRequest<axi::cfg::standard> req;
+      req.addr = word_addr[i];
+      req.len = 0;
+      req.size = nvhls::log2_ceil<bytesPerBeat>::val;
+      req.burst = axi4_::Enc::AXBURST::INCR;
+      req.cache = 0;
+      req.auser = 0;
+      rdRequestOut.Push(req);
+      RdResp<axi::cfg::standard> resp = rdRespIn.Pop();
+      for (int j = 0; j < bytesPerBeat; j++) {
+        if (word_keep[i][j] == 1 &&
+            nvhls::get_slc<8>(resp.data, 8 * j) != nvhls::get_slc<8>(word_data[i], 8 * j)) {
+          SC_REPORT_ERROR("testbench", "Memory contents mismatch");
+          cout << hex << "Address " << word_addr[i] << ": expected " << word_data[i]
+               << ", read " << resp.data << dec << endl;
+          break;
+        }
+      }
+    }
+    cout << "@" << sc_time_stamp() << " " << word_addr.size() << " words read back" << endl;
+    done = 1;
+    while (1) {
+      wait();
+    }
+  }
+
+  void run() {
+    // reset
+    reset_bar = 1;
+    wait(20, SC_NS);
+    reset_bar = 0;
+    wait(2, SC_NS);
+    reset_bar = 1;
+
+    while (1) {
+      wait(1, SC_NS);
+      if (done) {
+        sc_stop();
+      }
+    }
+  }
+};
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  testbench tb("tb");
+  sc_report_handler::set_actions(SC_ERROR, SC_DISPLAY);
+  sc_start();
+  bool rc = (sc_report_handler::get_count(SC_ERROR) > 0);
+  if (rc)
+    DCOUT("TESTBENCH FAIL" << endl);
+  else
+    DCOUT("TESTBENCH PASS" << endl);
+  return rc;
+};
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2016-2020, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+
+#include <axi/axi4.h>
+#include <mc_scverify.h>
+#include <axi/testbench/TrafficGen.h>
+#include <axi/AxiInterconnect.h>
+#include <axi/AxiSlaveToMem.h>
+#include <testbench/nvhls_rand.h>
+
+// Two open-loop TrafficGens drive an AxiInterconnect with two AxiSlaveToMem
+// slaves, each serving half of a 64KB address space.  Generator 0 issues
+// random traffic over the whole space; generator 1 sends most of its traffic
+// to a hotspot in the second slave, so the two contend there.  Each generator
+// prints its accepted load and latency histograms.  Set TRAFFIC_RATE to sweep
+// the offered load ("make run_sweep").
+
+static const int kNumAddrBitsToInspect = 16;
+static const int kMemBytes = 1 << kNumAddrBitsToInspect;
+
+typedef axi::cfg::no_wstrb TrafficAxiCfg;
+
+struct RandomTrafficCfg : public trafficGenCfg {
+  enum {
+    numTransactions = 1000,
+    readPercent = 50,
+    injectionRate = 100,
+    minBeats = 1,
+    maxBeats = 8,
+    addrPattern = AxiTrafficRandom,
+    stride = 256,
+    hotspotPercent = 0,
+    maxOutstanding = 8,
+    histBinCycles = 8,
+    histBins = 32,
+    seed = 1,
+  };
+  static const uint64_t addrBoundLower = 0;
+  static const uint64_t addrBoundUpper = kMemBytes - 1;
+};
+
+struct HotspotTrafficCfg : public RandomTrafficCfg {
+  enum {
+    addrPattern = AxiTrafficHotspot,
+    hotspotPercent = 80,
+    seed = 2,
+  };
+  static const uint64_t hotspotBase = kMemBytes / 2;
+  static const uint64_t hotspotBytes = 0x1000;
+};
+
+SC_MODULE(testbench) {
+  typedef axi::axi4<TrafficAxiCfg> axi_;
+  enum { numMasters = 2, numSlaves = 2 };
+
+  TrafficGen<TrafficAxiCfg, RandomTrafficCfg> gen0;
+  TrafficGen<TrafficAxiCfg, HotspotTrafficCfg> gen1;
+  AxiInterconnect<TrafficAxiCfg, numMasters, numSlaves, 16, kNumAddrBitsToInspect> interconnect;
+  nvhls::nv_array<AxiSlaveToMem<TrafficAxiCfg, kMemBytes>, numSlaves> slave;
+
+  sc_clock clk;
+  sc_signal<bool> reset_bar;
+  sc_signal<bool> done[numMasters];
+
+  nvhls::nv_array<typename axi_::read::template chan<>, numMasters> axi_read_m;
+  nvhls::nv_array<typename axi_::write::template chan<>, numMasters> axi_write_m;
+  nvhls::nv_array<typename axi_::read::template chan<>, numSlaves> axi_read_s;
+  nvhls::nv_array<typename axi_::write::template chan<>, numSlaves> axi_write_s;
+
+  sc_signal<NVUINTW(kNumAddrBitsToInspect)> addrBound[numSlaves][2];
+
+  SC_CTOR(testbench)
+      : gen0("gen0"),
+        gen1("gen1"),
+        interconnect("interconnect"),
+        slave("slave"),
+        clk("clk", 1.0, SC_NS, 0.5, 0, SC_NS, true),
+        reset_bar("reset_bar"),
+        axi_read_m("axi_read_m"),
+        axi_write_m("axi_write_m"),
+        axi_read_s("axi_read_s"),
+        axi_write_s("axi_write_s") {
+
+    Connections::set_sim_clk(&clk);
+
+    gen0.clk(clk);
+    gen0.reset_bar(reset_bar);
+    gen0.if_rd(axi_read_m[0]);
+    gen0.if_wr(axi_write_m[0]);
+    gen0.done(done[0]);
+
+    gen1.clk(clk);
+    gen1.reset_bar(reset_bar);
+    gen1.if_rd(axi_read_m[1]);
+    gen1.if_wr(axi_write_m[1]);
+    gen1.done(done[1]);
+
+    interconnect.clk(clk);
+    interconnect.reset_bar(reset_bar);
+
+    for (int i = 0; i < numMasters; i++) {
+      interconnect.axi_rd_m_ar[i](axi_read_m[i].ar);
+      interconnect.axi_rd_m_r[i](axi_read_m[i].r);
+      interconnect.axi_wr_m_aw[i](axi_write_m[i].aw);
+      interconnect.axi_wr_m_w[i](axi_write_m[i].w);
+      interconnect.axi_wr_m_b[i](axi_write_m[i].b);
+    }
+
+    static const unsigned int slaveSpan = kMemBytes / numSlaves;
+    for (int i = 0; i < numSlaves; i++) {
+      slave[i].clk(clk);
+      slave[i].reset_bar(reset_bar);
+      slave[i].if_rd(axi_read_s[i]);
+      slave[i].if_wr(axi_write_s[i]);
+      interconnect.axi_rd_s_ar[i](axi_read_s[i].ar);
+      interconnect.axi_rd_s_r[i](axi_read_s[i].r);
+      interconnect.axi_wr_s_aw[i](axi_write_s[i].aw);
+      interconnect.axi_wr_s_w[i](axi_write_s[i].w);
+      interconnect.axi_wr_s_b[i](axi_write_s[i].b);
+      interconnect.addrBound[i][0](addrBound[i][0]);
+      interconnect.addrBound[i][1](addrBound[i][1]);
+      addrBound[i][0].write(i * slaveSpan);
+      addrBound[i][1].write((i + 1) * slaveSpan - 1);
+    }
+
+    SC_THREAD(run);
+  }
+
+  void run() {
+    reset_bar = 1;
+    wait(2, SC_NS);
+    reset_bar = 0;
+    wait(2, SC_NS);
+    reset_bar = 1;
+
+    while (1) {
+      wait(1, SC_NS);
+      if (done[0] && done[1]) {
+        gen0.PrintStats();
+        gen1.PrintStats();
+        if (gen0.ReadLatency().Count() + gen0.WriteLatency().Count() != RandomTrafficCfg::numTransactions ||
+            gen1.ReadLatency().Count() + gen1.WriteLatency().Count() != HotspotTrafficCfg::numTransactions) {
+          SC_REPORT_ERROR("testbench", "Not every transaction was recorded in the latency histograms");
+        }
+        sc_stop();
+      }
+    }
+  }
+};
+
+int sc_main(int argc, char *argv[]) {
+  nvhls::set_random_seed();
+  testbench tb("tb");
+  sc_report_handler::set_actions(SC_ERROR, SC_DISPLAY);
+  sc_start();
+  bool rc = (sc_report_handler::get_count(SC_ERROR) > 0);
+  if (rc)
+    DCOUT("TESTBENCH FAIL" << endl);
+  else
+    DCOUT("TESTBENCH PASS" << endl);
+  return rc;
+};
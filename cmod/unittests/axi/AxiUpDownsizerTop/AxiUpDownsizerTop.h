@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2017-2019, NVIDIA CORPORATION.  All rights reserved.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License")
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AXI_UP_DOWNSIZER_TOP_H
+#define AXI_UP_DOWNSIZER_TOP_H
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+
+#include <axi/axi4.h>
+#include <axi/AxiUpsizer.h>
+#include <axi/AxiDownsizer.h>
+
+// A 128-bit config and a 32-bit config with shorter bursts, so that wide
+// bursts are split across several narrow bursts.
+struct wideCfg {
+  enum {
+    dataWidth = 128,
+    useVariableBeatSize = 0,
+    useMisalignedAddresses = 0,
+    useLast = 1,
+    useWriteStrobes = 1,
+    useBurst = 1, useFixedBurst = 0, useWrapBurst = 0, maxBurstSize = 256,
+    useQoS = 0, useLock = 0, useProt = 0, useCache = 0, useRegion = 0,
+    aUserWidth = 0, wUserWidth = 0, bUserWidth = 0, rUserWidth = 0,
+    addrWidth = 32,
+    idWidth = 4,
+    useWriteResponses = 1,
+  };
+};
+
+struct narrowCfg {
+  enum {
+    dataWidth = 32,
+    useVariableBeatSize = 0,
+    useMisalignedAddresses = 0,
+    useLast = 1,
+    useWriteStrobes = 1,
+    useBurst = 1, useFixedBurst = 0, useWrapBurst = 0, maxBurstSize = 64,
+    useQoS = 0, useLock = 0, useProt = 0, useCache = 0, useRegion = 0,
+    aUserWidth = 0, wUserWidth = 0, bUserWidth = 0, rUserWidth = 0,
+    addrWidth = 32,
+    idWidth = 4,
+    useWriteResponses = 1,
+  };
+};
+
+/**
+ * By default a wide master is downsized to the narrow bus and upsized back
+ * to a wide slave.  With AXI_UPSIZER_ONLY a narrow master, whose bursts start
+ * and end at arbitrary lanes of the wide bus, is upsized to a wide slave.
+ */
+class AxiUpDownsizerTop : public sc_module {
+ public:
+
+  static const int kDebugLevel = 4;
+  sc_in<bool> clk;
+  sc_in<bool> reset_bar;
+
+  typedef axi::axi4<wideCfg> axi_wide;
+  typedef axi::axi4<narrowCfg> axi_narrow;
+
+#ifdef AXI_UPSIZER_ONLY
+  typedef narrowCfg masterCfg;
+  typedef axi_narrow axi_m;
+#else
+  typedef wideCfg masterCfg;
+  typedef axi_wide axi_m;
+#endif
+  typedef wideCfg slaveCfg;
+  typedef axi_wide axi_s;
+
+  typename axi_m::read::template slave<> axi_read_m;
+  typename axi_m::write::template slave<> axi_write_m;
+
+#ifndef AXI_UPSIZER_ONLY
+  AxiDownsizer<wideCfg, narrowCfg> axi_downsizer;
+
+  typename axi_narrow::read::template chan<> axi_read_int;
+  typename axi_narrow::write::template chan<> axi_write_int;
+#endif
+
+  AxiUpsizer<narrowCfg, wideCfg> axi_upsizer;
+
+  typename axi_s::read::template master<> axi_read_s;
+  typename axi_s::write::template master<> axi_write_s;
+
+  SC_HAS_PROCESS(AxiUpDownsizerTop);
+
+  AxiUpDownsizerTop(sc_module_name name)
+      : sc_module(name),
+        clk("clk"),
+        reset_bar("reset_bar"),
+        axi_read_m("axi_read_m"),
+        axi_write_m("axi_write_m"),
+#ifndef AXI_UPSIZER_ONLY
+        axi_downsizer("axi_downsizer"),
+        axi_read_int("axi_read_int"),
+        axi_write_int("axi_write_int"),
+#endif
+        axi_upsizer("axi_upsizer"),
+        axi_read_s("axi_read_s"),
+        axi_write_s("axi_write_s")
+    {
+
+    axi_upsizer.clk(clk);
+    axi_upsizer.rst(reset_bar);
+
+#ifdef AXI_UPSIZER_ONLY
+    axi_upsizer.axiM_read(axi_read_m);
+    axi_upsizer.axiM_write(axi_write_m);
+#else
+    axi_downsizer.clk(clk);
+    axi_downsizer.rst(reset_bar);
+
+    axi_downsizer.axiM_read(axi_read_m);
+    axi_downsizer.axiM_write(axi_write_m);
+
+    axi_downsizer.axiS_read(axi_read_int);
+    axi_downsizer.axiS_write(axi_write_int);
+
+    axi_upsizer.axiM_read(axi_read_int);
+    axi_upsizer.axiM_write(axi_write_int);
+#endif
+
+    axi_upsizer.axiS_read(axi_read_s);
+    axi_upsizer.axiS_write(axi_write_s);
+  }
+};
+
+#endif
@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License")
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# This script collects the QoR of the units of an HLS regression run into a
+# JSON record, appends it to a history file and compares it against a
+# stored baseline. It is normally invoked through "make -f regress_Makefile
+# qor" after the regression, or "qor_baseline" to store a new baseline.
+#
+# Area, latency, throughput, II and worst slack are parsed from the most
+# recent rtl.rpt of each unit with the parser of hls_sweep.py. A unit
+# regresses when, against the baseline,
+#   area grows by more than --area-tol percent
+#   latency or II grow by more than --latency-tol or --ii-tol cycles
+#   throughput grows by more than --throughput-tol cycles
+#   worst slack drops by more than --slack-tol ns, or becomes negative
+# or when a value of the baseline is missing from the record, e.g. because
+# the unit failed. Units without a baseline are reported as new.
+
+import argparse
+import datetime
+import glob
+import json
+import os
+import subprocess
+import sys
+
+from hls_sweep import HLS, QOR, parse_qor
+
+
+def latest_rpt(design):
+    rpts = glob.glob(os.path.join(HLS, design, 'Catapult*', '*', 'rtl.rpt'))
+    return max(rpts, key=os.path.getmtime) if rpts else None
+
+
+def git_revision():
+    try:
+        out = subprocess.check_output(['git', 'rev-parse', '--short', 'HEAD'], cwd=HLS,
+                                      stderr=subprocess.DEVNULL)
+        return out.decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def collect(designs):
+    units = {}
+    for design in designs:
+        rpt = latest_rpt(design)
+        qor = parse_qor(rpt) if rpt else dict.fromkeys(QOR)
+        qor['rpt'] = os.path.relpath(rpt, HLS) if rpt else None
+        units[design] = qor
+    return {'date': datetime.datetime.now().isoformat(timespec='seconds'),
+            'revision': git_revision(), 'units': units}
+
+
+def regressions(new, base, args):
+    """List of (metric, baseline, new) that regress beyond the thresholds"""
+    out = []
+    for key in QOR:
+        b, n = base.get(key), new.get(key)
+        if b is None:
+            continue
+        if n is None:
+            out.append((key, b, n))
+        elif key == 'area' and n > b * (1 + args.area_tol / 100.0):
+            out.append((key, b, n))
+        elif key in ('latency', 'ii', 'throughput') and n > b + getattr(args, key + '_tol'):
+            out.append((key, b, n))
+        elif key == 'slack' and (n < b - args.slack_tol or (n < 0 <= b)):
+            out.append((key, b, n))
+    return out
+
+
+def compare(record, baseline, args):
+    failed = 0
+    for design, new in sorted(record['units'].items()):
+        base = baseline['units'].get(design)
+        if base is None:
+            print('NEW     %s' % design)
+            continue
+        regs = regressions(new, base, args)
+        if regs:
+            failed += 1
+            print('REGRESS %s' % design)
+            for key, b, n in regs:
+                print('  %-10s baseline=%-12s new=%s' % (key, b, n))
+        else:
+            deltas = ['%s %s->%s' % (k, base[k], new[k]) for k in QOR
+                      if base.get(k) is not None and new.get(k) != base[k]]
+            print('PASS    %s%s' % (design, ('  (' + ', '.join(deltas) + ')') if deltas else ''))
+    print('%d/%d units regressed against the baseline of %s (revision %s)' % (
+        failed, len(record['units']), baseline.get('date'), baseline.get('revision')))
+    return failed
+
+
+def main():
+    parser = argparse.ArgumentParser(description='HLS QoR record and baseline comparison')
+    parser.add_argument('--designs', nargs='+', required=True, help='unit directories relative to hls')
+    parser.add_argument('--output', default='qor_record.json', help='JSON record of this run')
+    parser.add_argument('--history', help='JSON lines file the record is appended to')
+    parser.add_argument('--baseline', help='JSON record to compare against')
+    parser.add_argument('--area-tol', type=float, default=2.0, help='allowed area growth in percent')
+    parser.add_argument('--latency-tol', type=float, default=0, help='allowed latency growth in cycles')
+    parser.add_argument('--throughput-tol', type=float, default=0,
+                        help='allowed throughput growth in cycles')
+    parser.add_argument('--ii-tol', type=float, default=0, help='allowed II growth in cycles')
+    parser.add_argument('--slack-tol', type=float, default=0.05, help='allowed worst slack drop in ns')
+    args = parser.parse_args()
+
+    record = collect(args.designs)
+    with open(args.output, 'w') as f:
+        json.dump(record, f, indent=2, sort_keys=True)
+        f.write('\n')
+    if args.history:
+        with open(args.history, 'a') as f:
+            f.write(json.dumps(record, sort_keys=True) + '\n')
+    missing = [d for d, q in record['units'].items() if q['rpt'] is None]
+    for d in missing:
+        print('NO RPT  %s' % d)
+    print('QoR of %d units in %s' % (len(record['units']) - len(missing), args.output))
+
+    if not args.baseline:
+        return 0
+    if not os.path.exists(args.baseline):
+        print('No baseline %s; store one with "make -f regress_Makefile qor_baseline"' % args.baseline)
+        return 0
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    return 1 if compare(record, baseline, args) else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License")
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# This script synthesizes every point of a design-space sweep of the hls
+# units in parallel Catapult jobs and collects area, latency, throughput, II
+# and slack of each point into one CSV table, plus a Pareto report per unit.
+# It is normally invoked through "make -f regress_Makefile sweep".
+#
+# A point is one combination of the swept values:
+#   --define NAME=v1,v2   compiler define, passed through SWEEP_FLAGS of
+#                         hls_Makefile; it replaces a same-named define of
+#                         the unit's COMPILER_FLAGS
+#   --make NAME=v1,v2     make variable of the unit Makefile, e.g.
+#                         ARBITER_TYPE of unittests/ArbiterTop
+#   --clk-periods p1 p2   CLK_PERIOD in ns
+#
+# Every point runs "make hls" without SCVerify in its own copy of the unit
+# directory, so Catapult projects of the same unit do not collide. QoR is
+# parsed from the rtl.rpt of the solution; a value that is not found is left
+# empty. The Pareto front of a unit minimizes area, latency in ns and II in ns
+# over the points that synthesized and, where slack was reported, met timing.
+
+import argparse
+import csv
+import glob
+import itertools
+import os
+import re
+import shutil
+import subprocess
+import sys
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+HLS = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(HLS)
+NUM = r'(-?\d+(?:\.\d+)?)'
+AREA_RE = re.compile(r'^\s*Total Area Score:(.*)$', re.M)
+TOTAL_RE = re.compile(r'^\s*Design Total:(.*)$', re.M)
+SLACK_RE = re.compile(r'[Ss]lack[^-\d\n]*' + NUM)
+QOR = ['area', 'latency', 'throughput', 'ii', 'slack']
+
+
+def parse_sweep(items):
+    sweep = []
+    for item in items:
+        name, _, values = item.partition('=')
+        if not name or not values:
+            sys.exit('bad sweep argument %r, expected NAME=v1,v2,...' % item)
+        sweep.append((name, values.split(',')))
+    return sweep
+
+
+def last_number(text):
+    nums = re.findall(NUM, text)
+    return float(nums[-1]) if nums else None
+
+
+def parse_qor(rpt):
+    """Area, latency, throughput, II and worst slack from a Catapult rtl.rpt"""
+    qor = dict.fromkeys(QOR)
+    with open(rpt, errors='replace') as f:
+        text = f.read()
+    m = AREA_RE.findall(text)
+    if m:
+        qor['area'] = last_number(m[-1])
+    m = TOTAL_RE.findall(text)
+    if m:
+        # Real Operation(s) count, Latency, Throughput, Reset Length, II
+        nums = [float(n) for n in re.findall(NUM, m[-1])]
+        for key, idx in (('latency', 1), ('throughput', 2), ('ii', 4)):
+            if len(nums) > idx:
+                qor[key] = nums[idx]
+    slacks = [float(s) for s in SLACK_RE.findall(text)]
+    if slacks:
+        qor['slack'] = min(slacks)
+    return qor
+
+
+def point_name(point):
+    return '_'.join('%s%s' % (k, v) for k, v in point) or 'default'
+
+
+def prepare(job):
+    # Copy the unit directory and the hls files its go_hls.tcl sources
+    # relatively, keeping the directory depth
+    hls_copy = os.path.join(job['dir'], 'hls')
+    shutil.rmtree(job['dir'], ignore_errors=True)
+    os.makedirs(hls_copy)
+    for f in os.listdir(HLS):
+        if os.path.isfile(os.path.join(HLS, f)):
+            shutil.copy(os.path.join(HLS, f), hls_copy)
+    ignore = shutil.ignore_patterns('Catapult*', 'catapult*', '*.log', 'qor', 'sweep_work')
+    shutil.copytree(os.path.join(HLS, job['design']), os.path.join(hls_copy, job['design']),
+                    ignore=ignore)
+    return os.path.join(hls_copy, job['design'])
+
+
+def run(job, args):
+    cwd = prepare(job)
+    cmd = ['make', 'hls', 'ROOT=%s' % ROOT, 'RUN_SCVERIFY=%d' % args.scverify]
+    cmd += ['%s=%s' % kv for kv in job['make']]
+    if job['defines']:
+        cmd.append('SWEEP_FLAGS=%s' % ' '.join('%s=%s' % kv for kv in job['defines']))
+    if job['clk_period'] is not None:
+        cmd.append('CLK_PERIOD=%s' % job['clk_period'])
+    start = time.time()
+    with open(job['log'], 'w') as f:
+        f.write(' '.join(cmd) + '\n')
+        f.flush()
+        try:
+            rc = subprocess.call(cmd, cwd=cwd, stdout=f, stderr=subprocess.STDOUT,
+                                 timeout=args.timeout)
+        except subprocess.TimeoutExpired:
+            f.write('\nTIMEOUT after %d s\n' % args.timeout)
+            rc = None
+    job['wall_s'] = round(time.time() - start, 1)
+    rpts = glob.glob(os.path.join(cwd, 'Catapult*', '*', 'rtl.rpt'))
+    job.update(dict.fromkeys(QOR))
+    if rpts:
+        job.update(parse_qor(max(rpts, key=os.path.getmtime)))
+    ok = rc == 0 and job['area'] is not None
+    job['status'] = 'timeout' if rc is None else ('pass' if ok else 'fail')
+    if job['clk_period'] is None:
+        job['clk_period'] = args.default_clk
+    period = float(job['clk_period'])
+    for key in ('latency', 'ii'):
+        job[key + '_ns'] = None if job[key] is None else round(job[key] * period, 3)
+    if not args.keep and job['status'] == 'pass':
+        shutil.rmtree(job['dir'], ignore_errors=True)
+    return job
+
+
+def dominates(a, b):
+    keys = ('area', 'latency_ns', 'ii_ns')
+    va = [a[k] if a[k] is not None else float('inf') for k in keys]
+    vb = [b[k] if b[k] is not None else float('inf') for k in keys]
+    return all(x <= y for x, y in zip(va, vb)) and any(x < y for x, y in zip(va, vb))
+
+
+def pareto(jobs):
+    feasible = [j for j in jobs if j['status'] == 'pass' and (j['slack'] is None or j['slack'] >= 0)]
+    return [j for j in feasible if not any(dominates(o, j) for o in feasible)]
+
+
+def write_csv(path, jobs, params):
+    cols = ['design', 'point'] + params + ['clk_period', 'status'] + QOR + \
+        ['latency_ns', 'ii_ns', 'pareto', 'wall_s', 'log']
+    with open(path, 'w', newline='') as f:
+        w = csv.DictWriter(f, fieldnames=cols, extrasaction='ignore')
+        w.writeheader()
+        for j in jobs:
+            row = dict(j, **dict(j['make'] + j['defines']))
+            w.writerow(row)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Parallel Catapult design-space sweep')
+    parser.add_argument('--designs', nargs='+', required=True, help='unit directories relative to hls')
+    parser.add_argument('--define', action='append', default=[], metavar='NAME=v1,v2',
+                        help='swept compiler define')
+    parser.add_argument('--make', action='append', default=[], metavar='NAME=v1,v2',
+                        help='swept make variable of the unit Makefile')
+    parser.add_argument('--clk-periods', nargs='+', default=[None], help='swept CLK_PERIOD values in ns')
+    parser.add_argument('--default-clk', type=float, default=2.0,
+                        help='CLK_PERIOD of hls_Makefile, used when CLK_PERIOD is not swept')
+    parser.add_argument('-j', '--jobs', type=int, default=4, help='parallel Catapult jobs')
+    parser.add_argument('--output', default='sweep_summary.csv', help='CSV table of all points')
+    parser.add_argument('--work', default=os.path.join(HLS, 'sweep_work'), help='work directory')
+    parser.add_argument('--timeout', type=int, default=4 * 3600, help='timeout of each point in seconds')
+    parser.add_argument('--scverify', type=int, default=0, help='RUN_SCVERIFY of every point')
+    parser.add_argument('--keep', action='store_true', help='keep the work directory of passing points')
+    args = parser.parse_args()
+
+    defines = parse_sweep(args.define)
+    make_vars = parse_sweep(args.make)
+    params = [n for n, _ in make_vars + defines]
+    work = os.path.abspath(args.work)
+    shutil.rmtree(work, ignore_errors=True)
+    os.makedirs(os.path.join(work, 'logs'))
+
+    axes = [[(n, v) for v in vals] for n, vals in make_vars + defines]
+    jobs = []
+    for design in args.designs:
+        for combo in itertools.product(*axes):
+            for clk in args.clk_periods:
+                point = list(combo) + ([('CLK_PERIOD', clk)] if clk is not None else [])
+                tag = '%s.%s' % (design.replace('/', '_'), point_name(point))
+                jobs.append({'design': design, 'point': point_name(point),
+                             'make': list(combo[:len(make_vars)]),
+                             'defines': list(combo[len(make_vars):]),
+                             'clk_period': clk,
+                             'dir': os.path.join(work, tag),
+                             'log': os.path.join(work, 'logs', tag + '.log')})
+
+    with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        jobs = list(pool.map(lambda job: run(job, args), jobs))
+
+    for design in args.designs:
+        units = [j for j in jobs if j['design'] == design]
+        front = pareto(units)
+        for j in units:
+            j['pareto'] = int(j in front)
+        front.sort(key=lambda j: (j['area'], j['latency_ns'] or 0, j['ii_ns'] or 0))
+        path = os.path.join(work, 'pareto_%s.csv' % design.replace('/', '_'))
+        write_csv(path, front, params)
+        print('Pareto front of %s (%d of %d points), %s' % (design, len(front), len(units), path))
+        for j in front:
+            print('  %-40s area=%-12s latency_ns=%-8s ii_ns=%-8s slack=%s' % (
+                j['point'], j['area'], j['latency_ns'], j['ii_ns'], j['slack']))
+
+    write_csv(args.output, jobs, params)
+    failed = [j for j in jobs if j['status'] != 'pass']
+    for j in failed:
+        print('%-7s %s %s  (%s)' % (j['status'].upper(), j['design'], j['point'], j['log']))
+    print('%d/%d points synthesized; table in %s' % (len(jobs) - len(failed), len(jobs), args.output))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,243 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2019, NVIDIA CORPORATION.  All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License")
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# This script generates <unit>_verilator_wrapper.h, the SystemC wrapper of
+# nvhls_verify.h that replaces a unit of NVHLS_VERIFY_BLOCKS by its Verilated
+# Catapult RTL when the testbench is built with NVHLS_VERIFY_ISVERILATOR, and
+# with --build also verilates the RTL. It is normally invoked through
+# "make verilator" of hls_Makefile, and the cmod testbench is then built with
+# VERILATOR_BLOCKS=<unit>.
+#
+# The wrapper has the ports of the SystemC unit, declared with decltype() of
+# its members, so the testbench binds it unchanged:
+#   - RTL ports <p>_val, <p>_rdy and <p>_msg are the Connections port p; val
+#     and rdy are bound to the Verilated model directly, msg is copied.
+#   - Ports named by --clock are bound directly, so the RTL sees clock edges
+#     in the same delta cycle as the testbench.
+#   - Every other port is copied with TypeToBits()/BitsToType(), so it can be
+#     of any type a Connections port can carry.
+#   - --array P maps the RTL ports P_<i>[_<j>...] to the elements of the array
+#     member P.
+# The Verilated model is built with "verilator --sc --pins-bv 2", the port
+# types that match::VerilatorPin of nvhls_verilator.h expects, and with
+# --threads for multi-threaded evaluation. Like the VCS-MX flow it needs the
+# signal-level Connections ports of SIM_MODE 0 or 1.
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+COMMENT_RE = re.compile(r'//[^\n]*|/\*.*?\*/', re.S)
+DECL_RE = re.compile(r'^\s*(input|output|inout)\b\s*(?:wire\b|reg\b|logic\b)?\s*(?:signed\b)?\s*'
+                     r'(?:\[\s*(\d+)\s*:\s*(\d+)\s*\])?\s*(.*)$', re.S)
+IDENT_RE = re.compile(r'^[A-Za-z_]\w*$')
+
+
+def decl(text):
+    d = DECL_RE.match(text)
+    if not d:
+        return None, text
+    width = abs(int(d.group(2)) - int(d.group(3))) + 1 if d.group(2) else 1
+    return (d.group(1), width), d.group(4)
+
+
+def parse_ports(path, module):
+    """Returns [(name, direction, width)] of the ports of module, in order."""
+    with open(path) as f:
+        text = COMMENT_RE.sub('', f.read())
+    m = re.search(r'\bmodule\s+%s\s*\((.*?)\)\s*;(.*?)\bendmodule' % re.escape(module), text, re.S)
+    if not m:
+        sys.exit('%s: module %s not found' % (path, module))
+    order, ports = [], {}
+    state = None
+    for item in m.group(1).split(','):
+        d, names = decl(item)
+        state = d or state
+        name = names.split()[-1] if names.split() else ''
+        order.append(name)
+        if d or state:
+            ports[name] = state
+    for stmt in m.group(2).split(';'):
+        d, names = decl(stmt)
+        if d:
+            for name in names.split(','):
+                ports[name.strip()] = d
+    result = []
+    for name in order:
+        if not IDENT_RE.match(name) or name not in ports:
+            sys.exit('%s: cannot parse port %r of %s' % (path, name, module))
+        direction, width = ports[name]
+        if direction == 'inout':
+            sys.exit('%s: inout port %s is not supported' % (path, name))
+        result.append((name, direction, width))
+    return result
+
+
+def member(name, arrays):
+    """Returns the member expression of the SystemC unit for an RTL name."""
+    for base in arrays:
+        m = re.match(r'^%s((?:_\d+)+)$' % re.escape(base), name)
+        if m:
+            return base, base + ''.join('[%s]' % i for i in m.group(1)[1:].split('_'))
+    return name, name
+
+
+def generate(unit, module, rtl, ports, clocks, arrays):
+    by_name = dict((p[0], p) for p in ports)
+    members, binds, pins, to_rtl, from_rtl, sensitive_in, sensitive_out = [], [], [], [], [], [], []
+    done = set()
+    for name, direction, width in ports:
+        if name in done:
+            continue
+        prefix = name[:-4]
+        conn = name[-4:] in ('_val', '_rdy', '_msg') and (prefix + '_val') in by_name and \
+            (prefix + '_rdy') in by_name
+        if conn:
+            base, port = member(prefix, arrays)
+            val, rdy = by_name[prefix + '_val'], by_name[prefix + '_rdy']
+            if val[1] == rdy[1] or val[2] != 1 or rdy[2] != 1:
+                sys.exit('%s: %s_val and %s_rdy are not a Connections port' % (rtl, prefix, prefix))
+            binds.append('rtl.%s(%s.val);' % (val[0], port))
+            binds.append('rtl.%s(%s.rdy);' % (rdy[0], port))
+            done.update([val[0], rdy[0]])
+            msg = by_name.get(prefix + '_msg')
+            if msg:
+                pin = msg[0] + '_pin'
+                pins.append((pin, msg[2]))
+                binds.append('rtl.%s(%s);' % (msg[0], pin))
+                if msg[1] == 'input':
+                    to_rtl.append('match::PortToPin<%d>(%s.msg, %s);' % (msg[2], port, pin))
+                    sensitive_in.append(port + '.msg')
+                else:
+                    from_rtl.append('match::PinToPort<%d>(%s, %s.msg);' % (msg[2], pin, port))
+                    sensitive_out.append(pin)
+                done.add(msg[0])
+        else:
+            base, port = member(name, arrays)
+            done.add(name)
+            if name in clocks:
+                binds.append('rtl.%s(%s);' % (name, port))
+            else:
+                pin = name + '_pin'
+                pins.append((pin, width))
+                binds.append('rtl.%s(%s);' % (name, pin))
+                if direction == 'input':
+                    to_rtl.append('match::PortToPin<%d>(%s, %s);' % (width, port, pin))
+                    sensitive_in.append(port)
+                else:
+                    from_rtl.append('match::PinToPort<%d>(%s, %s);' % (width, pin, port))
+                    sensitive_out.append(pin)
+        if base not in members:
+            members.append(base)
+
+    cls = '%s_verilator_wrapper' % unit
+    named = [m for m in members if not any(m == a for a in arrays)]
+    inits = ['sc_module(name)'] + ['%s("%s")' % (m, m) for m in named] + ['rtl("rtl")'] + \
+        ['%s("%s")' % (p, p) for p, _ in pins]
+    guard = '%s_VERILATOR_WRAPPER_H' % unit.upper()
+    out = []
+    out.append('// Generated by hls/verilator_wrapper.py from %s; do not edit.' % rtl)
+    out.append('')
+    out.append('#ifndef %s' % guard)
+    out.append('#define %s' % guard)
+    out.append('')
+    out.append('#include <systemc.h>')
+    out.append('#include <nvhls_verilator.h>')
+    out.append('#include "V%s.h"' % module)
+    out.append('')
+    out.append('// Verilated RTL of %s (Verilog module %s) with the ports of %s' % (unit, module, unit))
+    out.append('class %s : public sc_module {' % cls)
+    out.append(' public:')
+    for m in members:
+        out.append('  decltype(%s::%s) %s;' % (unit, m, m))
+    out.append('')
+    out.append('  SC_HAS_PROCESS(%s);' % cls)
+    out.append('  %s(sc_module_name name = sc_gen_unique_name("%s"))' % (cls, unit))
+    out.append('      : ' + ',\n        '.join(inits) + ' {')
+    for b in binds:
+        out.append('    ' + b)
+    if to_rtl:
+        out.append('')
+        out.append('    SC_METHOD(ToRtl);')
+        out.append('    sensitive << ' + ' << '.join(sensitive_in) + ';')
+    if from_rtl:
+        out.append('')
+        out.append('    SC_METHOD(FromRtl);')
+        out.append('    sensitive << ' + ' << '.join(sensitive_out) + ';')
+    out.append('  }')
+    out.append('')
+    out.append(' private:')
+    out.append('  V%s rtl;' % module)
+    for p, w in pins:
+        out.append('  sc_signal<match::VerilatorPin<%d>::type> %s;' % (w, p))
+    if to_rtl:
+        out.append('')
+        out.append('  void ToRtl() {')
+        out.extend('    ' + s for s in to_rtl)
+        out.append('  }')
+    if from_rtl:
+        out.append('')
+        out.append('  void FromRtl() {')
+        out.extend('    ' + s for s in from_rtl)
+        out.append('  }')
+    out.append('};')
+    out.append('')
+    out.append('#endif  // %s' % guard)
+    return '\n'.join(out) + '\n'
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Verilator co-simulation wrapper of a Catapult unit')
+    parser.add_argument('unit', help='SystemC unit, as named in NVHLS_VERIFY_BLOCKS')
+    parser.add_argument('rtl', help='Verilog of the unit, e.g. Catapult/<unit>.v1/concat_rtl.v')
+    parser.add_argument('--module', help='top Verilog module (default: unit)')
+    parser.add_argument('--clock', action='append', default=None,
+                        help='port bound directly to the RTL (default: clk)')
+    parser.add_argument('--array', action='append', default=[],
+                        help='array member whose elements are the RTL ports <array>_<i>')
+    parser.add_argument('--output', help='wrapper header (default: <unit>_verilator_wrapper.h '
+                        'in the --build directory or here)')
+    parser.add_argument('--build', metavar='DIR', help='also verilate and compile the RTL into DIR')
+    parser.add_argument('--threads', type=int, default=1, help='Verilator evaluation threads')
+    parser.add_argument('--cflags', default='-std=c++11',
+                        help='C++ flags of the model; the standard must match SystemC and the testbench')
+    parser.add_argument('--verilator', default='verilator', help='Verilator executable')
+    parser.add_argument('--verilator-args', default='-Wno-fatal', help='extra Verilator arguments')
+    args = parser.parse_args()
+
+    module = args.module or args.unit
+    clocks = args.clock or ['clk']
+    ports = parse_ports(args.rtl, module)
+    output = args.output or os.path.join(args.build or '.', '%s_verilator_wrapper.h' % args.unit)
+    if args.build:
+        os.makedirs(args.build, exist_ok=True)
+    with open(output, 'w') as f:
+        f.write(generate(args.unit, module, args.rtl, ports, clocks, args.array))
+    print('%s: %d RTL ports of %s' % (output, len(ports), module))
+
+    if args.build:
+        cmd = [args.verilator, '--sc', '--pins-bv', '2', '--build', '-Mdir', args.build,
+               '--top-module', module, '--threads', str(args.threads),
+               '-CFLAGS', args.cflags] + args.verilator_args.split() + [args.rtl]
+        print(' '.join(cmd))
+        return subprocess.call(cmd)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())